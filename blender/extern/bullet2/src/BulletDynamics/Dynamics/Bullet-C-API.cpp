@@ -354,11 +354,11 @@ double plNearestPoints(float p1[3], float p2[3], float p3[3], float q1[3], float
 	// btVoronoiSimplexSolver sGjkSimplexSolver;
 	// btGjkEpaPenetrationDepthSolver penSolverPtr;	
 	
-	static btSimplexSolverInterface sGjkSimplexSolver;
+	// no statics here, cloth collision calls this from several threads
+	btSimplexSolverInterface sGjkSimplexSolver;
 	sGjkSimplexSolver.reset();
 	
-	static btGjkEpaPenetrationDepthSolver Solver0;
-	static btMinkowskiPenetrationDepthSolver Solver1;
+	btMinkowskiPenetrationDepthSolver Solver1;
 		
 	btConvexPenetrationDepthSolver* Solver = NULL;
 	
@@ -75,6 +75,12 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 {
 	return (__sync_sub_and_fetch(p, x));
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	return __sync_val_compare_and_swap(v, old, _new);
+}
 #elif (defined(_MSC_VER))
 ATOMIC_INLINE uint64_t
 atomic_add_uint64(uint64_t *p, uint64_t x)
@@ -87,6 +93,12 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 {
 	return (InterlockedExchangeAdd64(p, -((int64_t)x)));
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	return InterlockedCompareExchange64((int64_t *)v, _new, old);
+}
 #elif (defined(__APPLE__))
 ATOMIC_INLINE uint64_t
 atomic_add_uint64(uint64_t *p, uint64_t x)
@@ -99,6 +111,18 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 {
 	return (uint64_t)(OSAtomicAdd64(-((int64_t)x), (int64_t *)p));
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	uint64_t init_val;
+	do {
+		if (OSAtomicCompareAndSwap64((int64_t)old, (int64_t)_new, (int64_t *)v))
+			return old;
+		init_val = *v;
+	} while (init_val == old);
+	return init_val;
+}
 #  elif (defined(__amd64__) || defined(__x86_64__))
 ATOMIC_INLINE uint64_t
 atomic_add_uint64(uint64_t *p, uint64_t x)
@@ -122,6 +146,18 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 	    );
 	return (x);
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	uint64_t ret;
+	asm volatile (
+	    "lock; cmpxchgq %2,%1"
+	    : "=a" (ret), "+m" (*v) /* Outputs. */
+	    : "r" (_new), "0" (old) /* Inputs. */
+	    : "memory");
+	return ret;
+}
 #  elif (defined(JEMALLOC_ATOMIC9))
 ATOMIC_INLINE uint64_t
 atomic_add_uint64(uint64_t *p, uint64_t x)
@@ -142,6 +178,21 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 
 	return (atomic_fetchadd_long(p, (unsigned long)(-(long)x)) - x);
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	uint64_t init_val;
+
+	assert(sizeof(uint64_t) == sizeof(unsigned long));
+
+	do {
+		if (atomic_cmpset_long(v, old, _new))
+			return old;
+		init_val = *v;
+	} while (init_val == old);
+	return init_val;
+}
 #  elif (defined(JE_FORCE_SYNC_COMPARE_AND_SWAP_8))
 ATOMIC_INLINE uint64_t
 atomic_add_uint64(uint64_t *p, uint64_t x)
@@ -154,6 +205,12 @@ atomic_sub_uint64(uint64_t *p, uint64_t x)
 {
 	return (__sync_sub_and_fetch(p, x));
 }
+
+ATOMIC_INLINE uint64_t
+atomic_cas_uint64(uint64_t *v, uint64_t old, uint64_t _new)
+{
+	return __sync_val_compare_and_swap(v, old, _new);
+}
 #  else
 #    error "Missing implementation for 64-bit atomic operations"
 #  endif
@@ -173,6 +230,12 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 {
 	return (__sync_sub_and_fetch(p, x));
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	return __sync_val_compare_and_swap(v, old, _new);
+}
 #elif (defined(_MSC_VER))
 ATOMIC_INLINE uint32_t
 atomic_add_uint32(uint32_t *p, uint32_t x)
@@ -185,6 +248,12 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 {
 	return (InterlockedExchangeAdd(p, -((int32_t)x)));
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	return InterlockedCompareExchange((long *)v, _new, old);
+}
 #elif (defined(__APPLE__))
 ATOMIC_INLINE uint32_t
 atomic_add_uint32(uint32_t *p, uint32_t x)
@@ -197,6 +266,18 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 {
 	return (uint32_t)(OSAtomicAdd32(-((int32_t)x), (int32_t *)p));
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	uint32_t init_val;
+	do {
+		if (OSAtomicCompareAndSwap32((int32_t)old, (int32_t)_new, (int32_t *)v))
+			return old;
+		init_val = *v;
+	} while (init_val == old);
+	return init_val;
+}
 #elif (defined(__i386__) || defined(__amd64__) || defined(__x86_64__))
 ATOMIC_INLINE uint32_t
 atomic_add_uint32(uint32_t *p, uint32_t x)
@@ -220,6 +301,18 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 	    );
 	return (x);
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	uint32_t ret;
+	asm volatile (
+	    "lock; cmpxchgl %2,%1"
+	    : "=a" (ret), "+m" (*v) /* Outputs. */
+	    : "r" (_new), "0" (old) /* Inputs. */
+	    : "memory");
+	return ret;
+}
 #elif (defined(JEMALLOC_ATOMIC9))
 ATOMIC_INLINE uint32_t
 atomic_add_uint32(uint32_t *p, uint32_t x)
@@ -232,6 +325,18 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 {
 	return (atomic_fetchadd_32(p, (uint32_t)(-(int32_t)x)) - x);
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	uint32_t init_val;
+	do {
+		if (atomic_cmpset_32(v, old, _new))
+			return old;
+		init_val = *v;
+	} while (init_val == old);
+	return init_val;
+}
 #elif (defined(JE_FORCE_SYNC_COMPARE_AND_SWAP_4))
 ATOMIC_INLINE uint32_t
 atomic_add_uint32(uint32_t *p, uint32_t x)
@@ -244,6 +349,12 @@ atomic_sub_uint32(uint32_t *p, uint32_t x)
 {
 	return (__sync_sub_and_fetch(p, x));
 }
+
+ATOMIC_INLINE uint32_t
+atomic_cas_uint32(uint32_t *v, uint32_t old, uint32_t _new)
+{
+	return __sync_val_compare_and_swap(v, old, _new);
+}
 #else
 #  error "Missing implementation for 32-bit atomic operations"
 #endif
@@ -276,6 +387,19 @@ atomic_sub_z(size_t *p, size_t x)
 #endif
 }
 
+/* returns the value of *v before the operation, it was set to _new if that equals old */
+ATOMIC_INLINE size_t
+atomic_cas_z(size_t *v, size_t old, size_t _new)
+{
+	assert(sizeof(size_t) == 1 << LG_SIZEOF_PTR);
+
+#if (LG_SIZEOF_PTR == 3)
+	return ((size_t)atomic_cas_uint64((uint64_t *)v, (uint64_t)old, (uint64_t)_new));
+#elif (LG_SIZEOF_PTR == 2)
+	return ((size_t)atomic_cas_uint32((uint32_t *)v, (uint32_t)old, (uint32_t)_new));
+#endif
+}
+
 /******************************************************************************/
 /* unsigned operations. */
 ATOMIC_INLINE unsigned
@@ -1072,7 +1072,7 @@ int AUD_doesPlayback()
 	return -1;
 }
 
-int AUD_readSound(AUD_Sound *sound, sample_t *buffer, int length, int samples_per_second)
+int AUD_readSound(AUD_Sound *sound, sample_t *buffer, int length, int samples_per_second, short *interrupt)
 {
 	AUD_DeviceSpecs specs;
 	sample_t *buf;
@@ -1123,6 +1123,11 @@ int AUD_readSound(AUD_Sound *sound, sample_t *buffer, int length, int samples_pe
 			length = i;
 			break;
 		}
+
+		if (interrupt && *interrupt) {
+			length = i + 1;
+			break;
+		}
 	}
 
 	if (overallmax > 1.0f) {
@@ -32,8 +32,6 @@
 #include <cmath>
 #include <cstring>
 
-#define CC m_channels + channel
-
 AUD_LinearResampleReader::AUD_LinearResampleReader(boost::shared_ptr<AUD_IReader> reader,
 												   AUD_Specs specs) :
 	AUD_ResampleReader(reader, specs.rate),
@@ -158,16 +156,24 @@ void AUD_LinearResampleReader::read(int& length, bool& eos, sample_t* buffer)
 	if(length == 0)
 		return;
 
-	for(int channel = 0; channel < m_channels; channel++)
+	// position and weight are the same for all channels, so compute them once
+	// per frame and interpolate the interleaved channels in the inner loop
+	for(int i = 0; i < length; i++)
 	{
-		for(int i = 0; i < length; i++)
-		{
-			spos = (i + 1) / factor + m_cache_pos;
+		spos = (i + 1) / factor + m_cache_pos;
 
-			low = buf[(int)floor(spos) * CC];
-			high = buf[(int)ceil(spos) * CC];
+		int ipos = (int)floor(spos);
+		float fpos = spos - ipos;
+		sample_t* lowbuf = buf + ipos * m_channels;
+		sample_t* highbuf = fpos > 0.0f ? lowbuf + m_channels : lowbuf;
+		sample_t* outbuf = buffer + i * m_channels;
+
+		for(int channel = 0; channel < m_channels; channel++)
+		{
+			low = lowbuf[channel];
+			high = highbuf[channel];
 
-			buffer[i * CC] = low + (spos - floor(spos)) * (high - low);
+			outbuf[channel] = low + fpos * (high - low);
 		}
 	}
 
@@ -32,6 +32,10 @@
 
 #include <cstring>
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 AUD_Mixer::AUD_Mixer(AUD_DeviceSpecs specs) :
 	m_specs(specs)
 {
@@ -91,16 +95,43 @@ void AUD_Mixer::mix(sample_t* buffer, int start, int length, float volume)
 	length = (AUD_MIN(m_length, length + start) - start) * m_specs.channels;
 	start *= m_specs.channels;
 
-	for(int i = 0; i < length; i++)
-		out[i + start] += buffer[i] * volume;
+	out += start;
+
+	int i = 0;
+
+#ifdef __SSE__
+	// four samples at a time, the strip buffers don't have any alignment
+	// guarantee, so use unaligned loads and stores
+	__m128 vol = _mm_set1_ps(volume);
+
+	for(; i + 4 <= length; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+		                                  _mm_mul_ps(_mm_loadu_ps(buffer + i), vol)));
+#endif
+
+	for(; i < length; i++)
+		out[i] += buffer[i] * volume;
 }
 
 void AUD_Mixer::read(data_t* buffer, float volume)
 {
 	sample_t* out = m_buffer.getBuffer();
+	int length = m_length * m_specs.channels;
+	int i = 0;
+
+	if(volume != 1.0f)
+	{
+#ifdef __SSE__
+		// the mixing buffer is 16 byte aligned
+		__m128 vol = _mm_set1_ps(volume);
 
-	for(int i = 0; i < m_length * m_specs.channels; i++)
-		out[i] *= volume;
+		for(; i + 4 <= length; i += 4)
+			_mm_store_ps(out + i, _mm_mul_ps(_mm_load_ps(out + i), vol));
+#endif
+
+		for(; i < length; i++)
+			out[i] *= volume;
+	}
 
-	m_convert(buffer, (data_t*) out, m_length * m_specs.channels);
+	m_convert(buffer, (data_t*) out, length);
 }
@@ -0,0 +1,361 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+/* Cycles Benchmark
+ *
+ * Renders XML scenes in the background on each of the given devices, with a
+ * fixed number of samples and seed, and writes kernel load, scene update,
+ * BVH build and render times along with peak memory usage as JSON. Used to
+ * qualify hardware and to catch performance regressions, with the reference
+ * scenes in the bench directory. */
+
+#include <stdio.h>
+
+#include "buffers.h"
+#include "camera.h"
+#include "device.h"
+#include "integrator.h"
+#include "scene.h"
+#include "session.h"
+
+#include "util_args.h"
+#include "util_foreach.h"
+#include "util_path.h"
+#include "util_progress.h"
+#include "util_string.h"
+#include "util_system.h"
+#include "util_time.h"
+
+#include "cycles_xml.h"
+
+CCL_NAMESPACE_BEGIN
+
+struct BenchOptions {
+	vector<string> filepaths;
+	vector<DeviceInfo> devices;
+	int width, height;
+	int samples;
+	int seed;
+	int threads;
+	int tile_size;
+	string output_path;
+	bool quiet;
+} options;
+
+struct BenchResult {
+	string filepath;
+	string device;
+	int width, height;
+	int samples;
+	bool success;
+
+	double kernel_load_time;
+	double scene_update_time;
+	double bvh_build_time;
+	double render_time;
+	size_t memory_peak;
+
+	/* full render statistics of the session */
+	string stats;
+};
+
+static string bench_json_string(const string& str)
+{
+	string result = "\"";
+
+	for(size_t i = 0; i < str.size(); i++) {
+		unsigned char c = str[i];
+
+		if(c == '"' || c == '\\')
+			result += string("\\") + (char)c;
+		else if(c < 0x20)
+			result += string_printf("\\u%04x", c);
+		else
+			result += (char)c;
+	}
+
+	return result + "\"";
+}
+
+static BenchResult bench_run(const string& filepath, const DeviceInfo& device_info)
+{
+	BenchResult result;
+
+	result.filepath = filepath;
+	result.device = device_info.description;
+	result.samples = options.samples;
+	result.success = false;
+	result.kernel_load_time = 0.0;
+	result.scene_update_time = 0.0;
+	result.bvh_build_time = 0.0;
+	result.render_time = 0.0;
+	result.memory_peak = 0;
+
+	/* session */
+	SessionParams session_params;
+
+	session_params.device = device_info;
+	session_params.background = true;
+	session_params.samples = options.samples;
+	session_params.threads = options.threads;
+	session_params.use_render_stats = true;
+
+	if(options.tile_size > 0)
+		session_params.tile_size = make_int2(options.tile_size, options.tile_size);
+
+	/* scene */
+	SceneParams scene_params;
+
+	/* QBVH traversal is only implemented for SSE capable CPU kernels */
+	if(device_info.type != DEVICE_CPU || !system_cpu_support_sse2())
+		scene_params.use_qbvh = false;
+
+	Scene *scene = new Scene(scene_params, device_info);
+	xml_read_file(scene, filepath.c_str());
+
+	/* fixed seed, so runs render exactly the same samples */
+	scene->integrator->seed = options.seed;
+	scene->integrator->tag_update(scene);
+
+	result.width = (options.width > 0)? options.width: scene->camera->width;
+	result.height = (options.height > 0)? options.height: scene->camera->height;
+
+	BufferParams buffer_params;
+	buffer_params.width = result.width;
+	buffer_params.height = result.height;
+	buffer_params.full_width = result.width;
+	buffer_params.full_height = result.height;
+
+	Session *session = new Session(session_params);
+	session->reset(buffer_params, session_params.samples);
+	session->scene = scene;
+
+	/* load kernels before starting, so compilation is not counted as
+	 * render time */
+	double start_time = time_dt();
+	bool kernels_loaded = session->load_kernels();
+	result.kernel_load_time = time_dt() - start_time;
+
+	if(kernels_loaded) {
+		start_time = time_dt();
+
+		session->start();
+		session->wait();
+
+		double total_time = time_dt() - start_time;
+
+		string status, substatus;
+		session->progress.get_status(status, substatus);
+
+		result.success = !session->progress.get_cancel() && status != "Error" &&
+		                 session->device->error_message() == "";
+		result.scene_update_time = session->stats.get_update_time("Total");
+		result.bvh_build_time = session->stats.get_update_time("BVH");
+		result.render_time = max(total_time - result.scene_update_time, 0.0);
+		result.memory_peak = session->stats.mem_peak;
+		result.stats = session->render_stats_json();
+	}
+
+	/* also frees the scene */
+	delete session;
+
+	return result;
+}
+
+static string bench_result_json(const BenchResult& result)
+{
+	double pixel_samples = (double)result.width*(double)result.height*(double)result.samples;
+	double pixel_samples_per_second = (result.render_time > 0.0)? pixel_samples/result.render_time: 0.0;
+
+	string json = "\t{\n";
+
+	json += "\t\t\"scene\": " + bench_json_string(path_filename(result.filepath)) + ",\n";
+	json += "\t\t\"device\": " + bench_json_string(result.device) + ",\n";
+	json += string_printf("\t\t\"success\": %s,\n", (result.success)? "true": "false");
+	json += string_printf("\t\t\"width\": %d,\n", result.width);
+	json += string_printf("\t\t\"height\": %d,\n", result.height);
+	json += string_printf("\t\t\"samples\": %d,\n", result.samples);
+	json += string_printf("\t\t\"seed\": %d,\n", options.seed);
+	json += string_printf("\t\t\"kernel_load_time\": %f,\n", result.kernel_load_time);
+	json += string_printf("\t\t\"scene_update_time\": %f,\n", result.scene_update_time);
+	json += string_printf("\t\t\"bvh_build_time\": %f,\n", result.bvh_build_time);
+	json += string_printf("\t\t\"render_time\": %f,\n", result.render_time);
+	json += string_printf("\t\t\"samples_per_second\": %f,\n", pixel_samples_per_second);
+	json += string_printf("\t\t\"memory_peak\": %llu", (unsigned long long)result.memory_peak);
+
+	if(result.stats != "")
+		json += ",\n\t\t\"stats\": " + result.stats;
+
+	json += "\n\t}";
+
+	return json;
+}
+
+static int files_parse(int argc, const char *argv[])
+{
+	for(int i = 0; i < argc; i++)
+		options.filepaths.push_back(argv[i]);
+
+	return 0;
+}
+
+static void options_parse(int argc, const char **argv)
+{
+	options.width = 0;
+	options.height = 0;
+	options.samples = 64;
+	options.seed = 0;
+	options.threads = 0;
+	options.tile_size = 0;
+	options.output_path = "";
+	options.quiet = false;
+
+	/* device names */
+	string device_names = "";
+	string devicenames = "cpu";
+	bool list = false;
+
+	vector<DeviceType>& types = Device::available_types();
+
+	foreach(DeviceType type, types) {
+		if(device_names != "")
+			device_names += ", ";
+
+		device_names += Device::string_from_type(type);
+	}
+
+	/* parse options */
+	ArgParse ap;
+	bool help = false;
+
+	ap.options ("Usage: cycles_bench [options] file.xml ...",
+		"%*", files_parse, "",
+		"--device %s", &devicenames, ("Comma separated devices to benchmark: " + device_names).c_str(),
+		"--samples %d", &options.samples, "Number of samples to render",
+		"--seed %d", &options.seed, "Seed for the sampling pattern",
+		"--threads %d", &options.threads, "CPU Rendering Threads",
+		"--tile-size %d", &options.tile_size, "Tile size in pixels",
+		"--width  %d", &options.width, "Image width in pixels, scene resolution by default",
+		"--height %d", &options.height, "Image height in pixels, scene resolution by default",
+		"--output %s", &options.output_path, "File path to write JSON results to, printed if not set",
+		"--quiet", &options.quiet, "Don't print a summary of each run",
+		"--list-devices", &list, "List information about all available devices",
+		"--help", &help, "Print help message",
+		NULL);
+
+	if(ap.parse(argc, argv) < 0) {
+		fprintf(stderr, "%s\n", ap.geterror().c_str());
+		ap.usage();
+		exit(EXIT_FAILURE);
+	}
+	else if(list) {
+		vector<DeviceInfo>& devices = Device::available_devices();
+		printf("Devices:\n");
+
+		foreach(DeviceInfo& info, devices) {
+			printf("    %s%s\n",
+				info.description.c_str(),
+				(info.display_device)? " (display)": "");
+		}
+
+		exit(EXIT_SUCCESS);
+	}
+	else if(help || options.filepaths.size() == 0) {
+		ap.usage();
+		exit(EXIT_SUCCESS);
+	}
+
+	if(options.samples <= 0) {
+		fprintf(stderr, "Invalid number of samples: %d\n", options.samples);
+		exit(EXIT_FAILURE);
+	}
+
+	/* find matching devices */
+	vector<string> tokens;
+	string_split(tokens, devicenames, ",");
+
+	vector<DeviceInfo>& devices = Device::available_devices();
+
+	foreach(string& devicename, tokens) {
+		DeviceType device_type = Device::type_from_string(devicename.c_str());
+		bool device_available = false;
+
+		foreach(DeviceInfo& device, devices) {
+			if(device_type == device.type) {
+				options.devices.push_back(device);
+				device_available = true;
+				break;
+			}
+		}
+
+		if(device_type == DEVICE_NONE || !device_available) {
+			fprintf(stderr, "Unknown device: %s\n", devicename.c_str());
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+CCL_NAMESPACE_END
+
+using namespace ccl;
+
+int main(int argc, const char **argv)
+{
+	path_init();
+	options_parse(argc, argv);
+
+	string json = "[\n";
+	bool success = true;
+	bool first = true;
+
+	foreach(string& filepath, options.filepaths) {
+		foreach(DeviceInfo& device_info, options.devices) {
+			BenchResult result = bench_run(filepath, device_info);
+
+			if(!options.quiet) {
+				fprintf(stderr, "%s on %s: %s, %.2fs render, %.2fs scene update, %.2fs BVH\n",
+					path_filename(filepath).c_str(), device_info.description.c_str(),
+					(result.success)? "ok": "failed",
+					result.render_time, result.scene_update_time, result.bvh_build_time);
+			}
+
+			json += (first)? "": ",\n";
+			json += bench_result_json(result);
+
+			success = success && result.success;
+			first = false;
+		}
+	}
+
+	json += "\n]\n";
+
+	if(options.output_path != "") {
+		FILE *f = fopen(options.output_path.c_str(), "w");
+
+		if(!f) {
+			fprintf(stderr, "Failed to write benchmark results to %s\n", options.output_path.c_str());
+			return EXIT_FAILURE;
+		}
+
+		fputs(json.c_str(), f);
+		fclose(f);
+	}
+	else
+		fputs(json.c_str(), stdout);
+
+	return (success)? EXIT_SUCCESS: EXIT_FAILURE;
+}
+
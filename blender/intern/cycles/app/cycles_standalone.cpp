@@ -28,6 +28,7 @@
 #include "util_path.h"
 #include "util_progress.h"
 #include "util_string.h"
+#include "util_system.h"
 #include "util_time.h"
 
 #ifdef WITH_CYCLES_STANDALONE_GUI
@@ -327,6 +328,10 @@ static void options_parse(int argc, const char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	/* QBVH traversal is only implemented for SSE capable CPU kernels */
+	if(options.session_params.device.type != DEVICE_CPU || !system_cpu_support_sse2())
+		options.scene_params.use_qbvh = false;
+
 	/* load scene */
 	scene_init(options.width, options.height);
 }
@@ -15,6 +15,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <sstream>
 #include <algorithm>
@@ -83,16 +85,25 @@ static bool xml_read_int(int *value, pugi::xml_node node, const char *name)
 	return false;
 }
 
+/* arrays are parsed in place, meshes can have millions of values and
+ * splitting them into strings first takes longer than the rendering */
 static bool xml_read_int_array(vector<int>& value, pugi::xml_node node, const char *name)
 {
 	pugi::xml_attribute attr = node.attribute(name);
 
 	if(attr) {
-		vector<string> tokens;
-		string_split(tokens, attr.value());
+		const char *str = attr.value();
+		char *end;
 
-		foreach(const string& token, tokens)
-			value.push_back(atoi(token.c_str()));
+		for(;;) {
+			long v = strtol(str, &end, 10);
+
+			if(end == str)
+				break;
+
+			value.push_back((int)v);
+			str = end;
+		}
 
 		return true;
 	}
@@ -117,11 +128,18 @@ static bool xml_read_float_array(vector<float>& value, pugi::xml_node node, cons
 	pugi::xml_attribute attr = node.attribute(name);
 
 	if(attr) {
-		vector<string> tokens;
-		string_split(tokens, attr.value());
+		const char *str = attr.value();
+		char *end;
+
+		for(;;) {
+			double v = strtod(str, &end);
 
-		foreach(const string& token, tokens)
-			value.push_back(atof(token.c_str()));
+			if(end == str)
+				break;
+
+			value.push_back((float)v);
+			str = end;
+		}
 
 		return true;
 	}
@@ -444,6 +462,15 @@ static void xml_read_shader_graph(const XMLReadState& state, Shader *shader, pug
 			xml_read_enum(&diel->distribution, GlassBsdfNode::distribution_enum, node, "distribution");
 			snode = diel;
 		}
+		else if(string_iequals(node.name(), "subsurface_scattering")) {
+			SubsurfaceScatteringNode *sss = new SubsurfaceScatteringNode();
+
+			ustring falloff;
+			if(xml_read_enum(&falloff, SubsurfaceScatteringNode::falloff_enum, node, "falloff"))
+				sss->closure = (ClosureType)SubsurfaceScatteringNode::falloff_enum[falloff];
+
+			snode = sss;
+		}
 		else if(string_iequals(node.name(), "emission")) {
 			EmissionNode *emission = new EmissionNode();
 			xml_read_bool(&emission->total_power, node, "total_power");
@@ -649,8 +676,78 @@ static Mesh *xml_add_mesh(Scene *scene, const Transform& tfm)
 	return mesh;
 }
 
+/* Binary mesh data, referenced by <mesh data="file"/>, read without any parsing.
+ * Layout in native byte order:
+ *
+ *   char magic[8]                "CYMESH01"
+ *   int num_P, num_nverts, num_verts
+ *   float P[num_P * 3]
+ *   int nverts[num_nverts]
+ *   int verts[num_verts] */
+
+#define XML_MESH_BINARY_MAGIC "CYMESH01"
+
+static bool xml_read_mesh_binary(const string& path, vector<float3>& P, vector<int>& verts, vector<int>& nverts)
+{
+	vector<uint8_t> binary;
+	const size_t header_size = 8 + sizeof(int) * 3;
+
+	if(!path_read_binary(path, binary) || binary.size() < header_size ||
+	   memcmp(&binary[0], XML_MESH_BINARY_MAGIC, 8) != 0)
+	{
+		fprintf(stderr, "%s is not a mesh data file.\n", path.c_str());
+		return false;
+	}
+
+	int num[3];
+	memcpy(num, &binary[8], sizeof(num));
+
+	if(num[0] < 0 || num[1] < 0 || num[2] < 0 ||
+	   binary.size() != header_size + sizeof(float) * 3 * num[0] + sizeof(int) * (num[1] + num[2]))
+	{
+		fprintf(stderr, "%s has an invalid size.\n", path.c_str());
+		return false;
+	}
+
+	const uint8_t *data = &binary[header_size];
+
+	/* float3 is padded to 16 bytes, so points are copied one at a time */
+	P.resize(num[0]);
+	for(int i = 0; i < num[0]; i++, data += sizeof(float) * 3) {
+		float co[3];
+		memcpy(co, data, sizeof(co));
+		P[i] = make_float3(co[0], co[1], co[2]);
+	}
+
+	nverts.resize(num[1]);
+	if(num[1])
+		memcpy(&nverts[0], data, sizeof(int) * num[1]);
+	data += sizeof(int) * num[1];
+
+	verts.resize(num[2]);
+	if(num[2])
+		memcpy(&verts[0], data, sizeof(int) * num[2]);
+
+	return true;
+}
+
 static void xml_read_mesh(const XMLReadState& state, pugi::xml_node node)
 {
+	/* read vertices and polygons, RIB style */
+	vector<float3> P;
+	vector<int> verts, nverts;
+	string data;
+
+	if(xml_read_string(&data, node, "data")) {
+		if(!xml_read_mesh_binary(path_join(state.base, data), P, verts, nverts))
+			return;
+	}
+	else {
+		xml_read_float3_array(P, node, "P");
+		xml_read_int_array(verts, node, "verts");
+		xml_read_int_array(nverts, node, "nverts");
+	}
+
 	/* add mesh */
 	Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
 	mesh->used_shaders.push_back(state.shader);
@@ -661,14 +758,6 @@ static void xml_read_mesh(const XMLReadState& state, pugi::xml_node node)
 
 	mesh->displacement_method = state.displacement_method;
 
-	/* read vertices and polygons, RIB style */
-	vector<float3> P;
-	vector<int> verts, nverts;
-
-	xml_read_float3_array(P, node, "P");
-	xml_read_int_array(verts, node, "verts");
-	xml_read_int_array(nverts, node, "nverts");
-
 	if(xml_equal_string(node, "subdivision", "catmull-clark")) {
 		/* create subd mesh */
 		SubdMesh sdmesh;
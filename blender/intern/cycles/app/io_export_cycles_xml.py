@@ -17,12 +17,13 @@
 # XML exporter for generating test files, not intended for end users
 
 import os
+import array
 import xml.etree.ElementTree as etree
 import xml.dom.minidom as dom
 
 import bpy
 from bpy_extras.io_utils import ExportHelper
-from bpy.props import PointerProperty, StringProperty
+from bpy.props import BoolProperty, PointerProperty, StringProperty
 
 def strip(root):
     root.text = None
@@ -39,6 +40,16 @@ def write(node, fname):
 
     f = open(fname, "w")
     f.write(s)
+
+def write_mesh_binary(P, nverts, verts, fname):
+    # layout read by xml_read_mesh_binary() in cycles_xml.cpp, native byte order
+    f = open(fname, "wb")
+    f.write(b"CYMESH01")
+    array.array('i', (len(P) // 3, len(nverts), len(verts))).tofile(f)
+    array.array('f', P).tofile(f)
+    array.array('i', nverts).tofile(f)
+    array.array('i', verts).tofile(f)
+    f.close()
     
 class CyclesXMLSettings(bpy.types.PropertyGroup):
     @classmethod
@@ -89,6 +100,13 @@ class ExportCyclesXML(bpy.types.Operator, ExportHelper):
 
     filename_ext = ".xml"
 
+    use_binary = BoolProperty(
+            name="Binary Mesh Data",
+            description="Write the mesh data to a binary file next to the .xml file, "
+                        "which is much faster to load for large meshes",
+            default=True,
+            )
+
     @classmethod
     def poll(cls, context):
         return (context.active_object is not None)
@@ -108,23 +126,27 @@ class ExportCyclesXML(bpy.types.Operator, ExportHelper):
         if not mesh:
             raise Exception("No mesh data in active object")
 
-        # generate mesh node
-        nverts = ""
-        verts = ""
-        P = ""
+        # generate mesh data
+        P = [0.0] * (len(mesh.vertices) * 3)
+        mesh.vertices.foreach_get("co", P)
 
-        for v in mesh.vertices:
-            P += "%f %f %f  " % (v.co[0], v.co[1], v.co[2])
+        nverts = [len(p.vertices) for p in mesh.polygons]
+        verts = [0] * len(mesh.loops)
+        mesh.loops.foreach_get("vertex_index", verts)
 
-        for i, f in enumerate(mesh.faces):
-            nverts += str(len(f.vertices)) + " "
+        bpy.data.meshes.remove(mesh)
 
-            for v in f.vertices:
-                verts += str(v) + " "
-            verts += " "
+        if self.use_binary:
+            binpath = os.path.splitext(filepath)[0] + ".bin"
+            write_mesh_binary(P, nverts, verts, binpath)
+
+            node = etree.Element('mesh', attrib={'data': os.path.basename(binpath)})
+        else:
+            node = etree.Element('mesh', attrib={
+                'nverts': " ".join(str(n) for n in nverts),
+                'verts': " ".join(str(v) for v in verts),
+                'P': " ".join("%f" % co for co in P)})
 
-        node = etree.Element('mesh', attrib={'nverts': nverts, 'verts': verts, 'P': P})
-        
         # write to file
         write(node, filepath)
 
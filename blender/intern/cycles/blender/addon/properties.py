@@ -21,7 +21,8 @@ from bpy.props import (BoolProperty,
                        EnumProperty,
                        FloatProperty,
                        IntProperty,
-                       PointerProperty)
+                       PointerProperty,
+                       StringProperty)
 
 # enums
 
@@ -337,6 +338,43 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=0.0,
                 )
 
+        cls.use_adaptive_sampling = BoolProperty(
+                name="Adaptive Sampling",
+                description="Stop sampling pixels and tiles once their noise is below the threshold, "
+                            "only used for final renders",
+                default=False,
+                )
+        cls.adaptive_threshold = FloatProperty(
+                name="Adaptive Threshold",
+                description="Noise level relative to pixel brightness at which a pixel is considered converged, "
+                            "lower values give less noise but take longer to render",
+                min=0.0001, max=1.0,
+                default=0.01,
+                precision=4,
+                )
+        cls.adaptive_min_samples = IntProperty(
+                name="Adaptive Min Samples",
+                description="Minimum number of samples taken for every pixel before checking for convergence",
+                min=2, max=2147483647,
+                default=16,
+                )
+
+        cls.time_limit = FloatProperty(
+                name="Time Limit",
+                description="Render time limit in seconds for final renders, samples are distributed over "
+                            "the tiles to finish close to it, with at most the given number of samples "
+                            "(0 for no limit)",
+                min=0.0, max=1e8,
+                default=0.0,
+                )
+
+        cls.use_light_tree = BoolProperty(
+                name="Light Tree",
+                description="Sample mesh lights depending on their distance and orientation to the shading point, "
+                            "reduces noise in scenes with many small emitting objects",
+                default=False,
+                )
+
         cls.debug_tile_size = IntProperty(
                 name="Tile Size",
                 description="",
@@ -382,6 +420,19 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.use_ray_packets = BoolProperty(
+                name="Ray Packets",
+                description="Trace camera rays of neighboring pixels together, faster for scenes with coherent "
+                            "primary rays, not used with instancing, motion blur or hair (CPU only)",
+                default=False,
+                )
+        cls.texture_cache_size = IntProperty(
+                name="Texture Cache",
+                description="Memory limit in megabytes for loading tiled image textures on demand, "
+                            "zero loads all images entirely (CPU only)",
+                min=0, max=1048576,
+                default=0,
+                )
         cls.use_cache = BoolProperty(
                 name="Cache BVH",
                 description="Cache last built BVH to disk for faster re-render if no geometry changed",
@@ -402,6 +453,18 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                             "but time can be saved by manually stopping the render when the noise is low enough)",
                 default=False,
                 )
+        cls.use_render_stats = BoolProperty(
+                name="Render Statistics",
+                description="Write scene update and tile render times as JSON after final renders, "
+                            "along with ray, BVH and shader counts in builds with kernel statistics",
+                default=False,
+                )
+        cls.render_stats_path = StringProperty(
+                name="Statistics File",
+                description="File to write render statistics to, printed to the console if empty",
+                subtype='FILE_PATH',
+                default="",
+                )
 
     @classmethod
     def unregister(cls):
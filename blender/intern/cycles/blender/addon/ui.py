@@ -143,6 +143,17 @@ class CyclesRender_PT_sampling(CyclesButtonsPanel, Panel):
         if cscene.feature_set == 'EXPERIMENTAL' and (device_type == 'NONE' or cscene.device == 'CPU'):
             layout.row().prop(cscene, "sampling_pattern", text="Pattern")
 
+        row = layout.row()
+        row.prop(cscene, "use_adaptive_sampling")
+        sub = row.row(align=True)
+        sub.active = cscene.use_adaptive_sampling
+        sub.prop(cscene, "adaptive_threshold", text="Threshold")
+        sub.prop(cscene, "adaptive_min_samples", text="Min Samples")
+
+        layout.row().prop(cscene, "time_limit")
+
+        layout.row().prop(cscene, "use_light_tree")
+
         for rl in scene.render.layers:
             if rl.samples > 0:
                 layout.separator()
@@ -282,11 +293,17 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
         col.label(text="Final Render:")
         col.prop(cscene, "use_cache")
         col.prop(rd, "use_persistent_data", text="Persistent Images")
+        col.prop(cscene, "texture_cache_size")
+        col.prop(cscene, "use_render_stats")
+        sub = col.column()
+        sub.active = cscene.use_render_stats
+        sub.prop(cscene, "render_stats_path", text="")
 
         col.separator()
 
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
+        col.prop(cscene, "use_ray_packets")
 
 
 class CyclesRender_PT_opengl(CyclesButtonsPanel, Panel):
@@ -27,6 +27,7 @@
 #include "subd_split.h"
 
 #include "util_foreach.h"
+#include "util_task.h"
 
 #include "mikktspace.h"
 
@@ -216,37 +217,47 @@ static void create_mesh(Scene *scene, Mesh *mesh, BL::Mesh b_mesh, const vector<
 	int numtris = 0;
 
 	BL::Mesh::vertices_iterator v;
-	BL::Mesh::tessfaces_iterator f;
 
-	for(b_mesh.tessfaces.begin(f); f != b_mesh.tessfaces.end(); ++f) {
-		int4 vi = get_int4(f->vertices_raw());
-		numtris += (vi[3] == 0)? 1: 2;
-	}
+	/* copy vertex and face data in bulk, per element access through the
+	 * C++ api is too slow for big meshes */
+	vector<float> co(numverts*3, 0.0f);
+	vector<float> no(numverts*3, 0.0f);
+	vector<int> face_verts(numfaces*4, 0);
+	vector<int> face_material(numfaces, 0);
+	vector<int> face_smooth(numfaces, 0);
+
+	rna_collection_raw_get(&b_mesh.ptr, "vertices", "co", PROP_RAW_FLOAT, co);
+	rna_collection_raw_get(&b_mesh.ptr, "vertices", "normal", PROP_RAW_FLOAT, no);
+	rna_collection_raw_get(&b_mesh.ptr, "tessfaces", "vertices_raw", PROP_RAW_INT, face_verts);
+	rna_collection_raw_get(&b_mesh.ptr, "tessfaces", "material_index", PROP_RAW_INT, face_material);
+	rna_collection_raw_get(&b_mesh.ptr, "tessfaces", "use_smooth", PROP_RAW_INT, face_smooth);
+
+	for(int fi = 0; fi < numfaces; fi++)
+		numtris += (face_verts[fi*4 + 3] == 0)? 1: 2;
 
 	/* reserve memory */
 	mesh->reserve(numverts, numtris, 0, 0);
 
 	/* create vertex coordinates and normals */
-	int i = 0;
-	for(b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v, ++i)
-		mesh->verts[i] = get_float3(v->co());
+	for(int i = 0; i < numverts; i++)
+		mesh->verts[i] = make_float3(co[i*3], co[i*3 + 1], co[i*3 + 2]);
 
 	Attribute *attr_N = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 	float3 *N = attr_N->data_float3();
 
-	for(b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v, ++N)
-		*N = get_float3(v->normal());
+	for(int i = 0; i < numverts; i++)
+		N[i] = make_float3(no[i*3], no[i*3 + 1], no[i*3 + 2]);
 
 	/* create faces */
 	vector<int> nverts(numfaces);
-	int fi = 0, ti = 0;
+	int ti = 0;
 
-	for(b_mesh.tessfaces.begin(f); f != b_mesh.tessfaces.end(); ++f, ++fi) {
-		int4 vi = get_int4(f->vertices_raw());
+	for(int fi = 0; fi < numfaces; fi++) {
+		int *vi = &face_verts[fi*4];
 		int n = (vi[3] == 0)? 3: 4;
-		int mi = clamp(f->material_index(), 0, used_shaders.size()-1);
+		int mi = clamp(face_material[fi], 0, used_shaders.size()-1);
 		int shader = used_shaders[mi];
-		bool smooth = f->use_smooth();
+		bool smooth = (face_smooth[fi] != 0);
 
 		if(n == 4) {
 			if(len_squared(cross(mesh->verts[vi[1]] - mesh->verts[vi[0]], mesh->verts[vi[2]] - mesh->verts[vi[0]])) == 0.0f ||
@@ -405,6 +416,34 @@ static void create_subd_mesh(Mesh *mesh, BL::Mesh b_mesh, PointerRNA *cmesh, con
 
 /* Sync */
 
+/* Mesh data to be created after the object loop, along with the previous mesh
+ * data to detect changes */
+
+struct BlenderSync::MeshSync {
+	MeshSync(BL::Object b_ob_)
+	: b_ob(b_ob_), b_mesh(PointerRNA_NULL)
+	{
+	}
+
+	Mesh *mesh;
+	BL::Object b_ob;
+	BL::Mesh b_mesh;
+	PointerRNA cmesh;
+	vector<uint> used_shaders;
+	bool use_surfaces;
+	bool use_subdivision;
+	bool was_updated;
+
+	vector<float3> oldverts;
+	vector<Mesh::Triangle> oldtriangle;
+	vector<uint> oldshader;
+	vector<bool> oldsmooth;
+	vector<Mesh::CurveKey> oldcurve_keys;
+	AttributeSet oldattributes;
+	AttributeSet oldcurve_attributes;
+	Mesh::DisplacementMethod olddisplacement_method;
+};
+
 Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tris)
 {
 	/* test if we can instance or if the object is modified */
@@ -460,13 +499,26 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 	mesh_synced.insert(mesh);
 
 	/* create derived mesh */
-	PointerRNA cmesh = RNA_pointer_get(&b_ob_data.ptr, "cycles");
-
-	vector<Mesh::Triangle> oldtriangle = mesh->triangles;
-	
-	/* compares curve_keys rather than strands in order to handle quick hair
-	 * adjustsments in dynamic BVH - other methods could probably do this better*/
-	vector<Mesh::CurveKey> oldcurve_keys = mesh->curve_keys;
+	MeshSync *msync = new MeshSync(b_ob);
+
+	msync->mesh = mesh;
+	msync->cmesh = RNA_pointer_get(&b_ob_data.ptr, "cycles");
+	msync->used_shaders = used_shaders;
+	msync->use_surfaces = render_layer.use_surfaces && !hide_tris;
+	msync->use_subdivision = false;
+	msync->was_updated = mesh->need_update;
+
+	/* keep old data to detect if the mesh changed, compares curve_keys rather
+	 * than strands in order to handle quick hair adjustsments in dynamic BVH -
+	 * other methods could probably do this better */
+	msync->oldverts.swap(mesh->verts);
+	msync->oldtriangle.swap(mesh->triangles);
+	msync->oldshader.swap(mesh->shader);
+	msync->oldsmooth.swap(mesh->smooth);
+	msync->oldcurve_keys.swap(mesh->curve_keys);
+	msync->oldattributes.attributes.swap(mesh->attributes.attributes);
+	msync->oldcurve_attributes.attributes.swap(mesh->curve_attributes.attributes);
+	msync->olddisplacement_method = mesh->displacement_method;
 
 	mesh->clear();
 	mesh->used_shaders = used_shaders;
@@ -477,56 +529,118 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 			b_ob.update_from_editmode();
 
 		bool need_undeformed = mesh->need_attribute(scene, ATTR_STD_GENERATED);
-		BL::Mesh b_mesh = object_to_mesh(b_data, b_ob, b_scene, true, !preview, need_undeformed);
+		msync->b_mesh = object_to_mesh(b_data, b_ob, b_scene, true, !preview, need_undeformed);
 
-		if(b_mesh) {
-			if(render_layer.use_surfaces && !hide_tris) {
-				if(cmesh.data && experimental && RNA_boolean_get(&cmesh, "use_subdivision"))
-					create_subd_mesh(mesh, b_mesh, &cmesh, used_shaders);
-				else
-					create_mesh(scene, mesh, b_mesh, used_shaders);
-			}
+		if(msync->cmesh.data && experimental && RNA_boolean_get(&msync->cmesh, "use_subdivision"))
+			msync->use_subdivision = true;
+	}
+
+	/* mesh data is created after all objects are synced, tag update already
+	 * so objects using this mesh get synced too */
+	mesh->tag_update(scene, false);
+	mesh_sync_queue.push_back(msync);
+
+	return mesh;
+}
+
+void BlenderSync::create_mesh_task(MeshSync *msync)
+{
+	if(msync->use_subdivision)
+		create_subd_mesh(msync->mesh, msync->b_mesh, &msync->cmesh, msync->used_shaders);
+	else
+		create_mesh(scene, msync->mesh, msync->b_mesh, msync->used_shaders);
+}
 
+static bool attributes_equal(const AttributeSet& a, const AttributeSet& b)
+{
+	if(a.attributes.size() != b.attributes.size())
+		return false;
+
+	foreach(const Attribute& attr, a.attributes) {
+		Attribute *other = (attr.std == ATTR_STD_NONE)? b.find(attr.name): b.find(attr.std);
+
+		if(!other || other->name != attr.name || other->buffer.size() != attr.buffer.size())
+			return false;
+		if(attr.buffer.size() && memcmp(&attr.buffer[0], &other->buffer[0], attr.buffer.size()) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+template<typename T>
+static bool vector_equal(const vector<T>& a, const vector<T>& b)
+{
+	if(a.size() != b.size())
+		return false;
+
+	return a.size() == 0 || memcmp(&a[0], &b[0], sizeof(T)*a.size()) == 0;
+}
+
+void BlenderSync::sync_meshes_finish()
+{
+	/* convert meshes in parallel, one task per mesh datablock. blender data is
+	 * only read here, meshes were already created in the object loop */
+	BLI_begin_threaded_malloc();
+
+	TaskPool pool;
+
+	foreach(MeshSync *msync, mesh_sync_queue)
+		if(msync->b_mesh && msync->use_surfaces)
+			pool.push(function_bind(&BlenderSync::create_mesh_task, this, msync));
+
+	pool.wait_work();
+
+	BLI_end_threaded_malloc();
+
+	foreach(MeshSync *msync, mesh_sync_queue) {
+		Mesh *mesh = msync->mesh;
+		BL::Mesh b_mesh = msync->b_mesh;
+
+		if(b_mesh) {
 			if(render_layer.use_hair)
-				sync_curves(mesh, b_mesh, b_ob, 0);
+				sync_curves(mesh, b_mesh, msync->b_ob, 0);
 
 			/* free derived mesh */
 			b_data.meshes.remove(b_mesh);
 		}
-	}
 
-	/* displacement method */
-	if(cmesh.data) {
-		const int method = RNA_enum_get(&cmesh, "displacement_method");
+		/* displacement method */
+		if(msync->cmesh.data) {
+			const int method = RNA_enum_get(&msync->cmesh, "displacement_method");
 
-		if(method == 0 || !experimental)
-			mesh->displacement_method = Mesh::DISPLACE_BUMP;
-		else if(method == 1)
-			mesh->displacement_method = Mesh::DISPLACE_TRUE;
-		else
-			mesh->displacement_method = Mesh::DISPLACE_BOTH;
-	}
+			if(method == 0 || !experimental)
+				mesh->displacement_method = Mesh::DISPLACE_BUMP;
+			else if(method == 1)
+				mesh->displacement_method = Mesh::DISPLACE_TRUE;
+			else
+				mesh->displacement_method = Mesh::DISPLACE_BOTH;
+		}
 
-	/* tag update */
-	bool rebuild = false;
+		/* tag update */
+		bool rebuild = !vector_equal(msync->oldtriangle, mesh->triangles) ||
+		               !vector_equal(msync->oldcurve_keys, mesh->curve_keys);
 
-	if(oldtriangle.size() != mesh->triangles.size())
-		rebuild = true;
-	else if(oldtriangle.size()) {
-		if(memcmp(&oldtriangle[0], &mesh->triangles[0], sizeof(Mesh::Triangle)*oldtriangle.size()) != 0)
-			rebuild = true;
-	}
+		if(rebuild) {
+			mesh->tag_update(scene, true);
+		}
+		else if(!msync->was_updated &&
+		        vector_equal(msync->oldverts, mesh->verts) &&
+		        vector_equal(msync->oldshader, mesh->shader) &&
+		        msync->oldsmooth == mesh->smooth &&
+		        msync->olddisplacement_method == mesh->displacement_method &&
+		        attributes_equal(msync->oldattributes, mesh->attributes) &&
+		        attributes_equal(msync->oldcurve_attributes, mesh->curve_attributes))
+		{
+			/* mesh is exactly the same as before, which happens a lot for
+			 * animation renders, no need to update it on the device */
+			mesh->need_update = false;
+		}
 
-	if(oldcurve_keys.size() != mesh->curve_keys.size())
-		rebuild = true;
-	else if(oldcurve_keys.size()) {
-		if(memcmp(&oldcurve_keys[0], &mesh->curve_keys[0], sizeof(Mesh::CurveKey)*oldcurve_keys.size()) != 0)
-			rebuild = true;
+		delete msync;
 	}
-	
-	mesh->tag_update(scene, rebuild);
 
-	return mesh;
+	mesh_sync_queue.clear();
 }
 
 void BlenderSync::sync_mesh_motion(BL::Object b_ob, Mesh *mesh, int motion)
@@ -479,6 +479,12 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, int motion)
 		}
 	}
 
+	/* create mesh data for meshes that need to be synced */
+	if(!motion) {
+		progress.set_sync_status("Synchronizing meshes");
+		sync_meshes_finish();
+	}
+
 	progress.set_sync_status("");
 
 	if(!cancel && !motion) {
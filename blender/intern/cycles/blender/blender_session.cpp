@@ -15,12 +15,14 @@
  */
 
 #include "background.h"
+#include "bake.h"
 #include "buffers.h"
 #include "camera.h"
 #include "device.h"
 #include "integrator.h"
 #include "film.h"
 #include "light.h"
+#include "object.h"
 #include "scene.h"
 #include "session.h"
 #include "shader.h"
@@ -28,6 +30,7 @@
 #include "util_color.h"
 #include "util_foreach.h"
 #include "util_function.h"
+#include "util_path.h"
 #include "util_progress.h"
 #include "util_time.h"
 
@@ -79,8 +82,9 @@ BlenderSession::~BlenderSession()
 
 void BlenderSession::create_session()
 {
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
+	bool is_cpu = session_params.device.type == DEVICE_CPU;
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, is_cpu);
 
 	/* reset status/progress */
 	last_status = "";
@@ -131,8 +135,9 @@ void BlenderSession::reset_session(BL::BlendData b_data_, BL::Scene b_scene_)
 	b_render = b_engine.render();
 	b_scene = b_scene_;
 
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
+	bool is_cpu = session_params.device.type == DEVICE_CPU;
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, is_cpu);
 
 	width = render_resolution_x(b_render);
 	height = render_resolution_y(b_render);
@@ -376,6 +381,12 @@ void BlenderSession::render()
 				if(pass_type != PASS_NONE)
 					Pass::add(pass_type, passes);
 			}
+
+			/* internal pass for adaptive sampling */
+			PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+
+			if(get_boolean(cscene, "use_adaptive_sampling"))
+				Pass::add(PASS_ADAPTIVE, passes);
 		}
 
 		/* free result without merging */
@@ -407,6 +418,10 @@ void BlenderSession::render()
 			break;
 	}
 
+	/* write render statistics */
+	if(session_params.use_render_stats)
+		write_render_stats();
+
 	/* clear callback */
 	session->write_render_tile_cb = NULL;
 	session->update_render_tile_cb = NULL;
@@ -421,19 +436,129 @@ void BlenderSession::render()
 	sync = NULL;
 }
 
-void BlenderSession::do_write_update_render_result(BL::RenderResult b_rr, BL::RenderLayer b_rlay, RenderTile& rtile, bool do_update_only)
+static ShaderEvalType get_shader_type(const string& pass_type, bool object_space)
 {
-	RenderBuffers *buffers = rtile.buffers;
+	const char *shader_type = pass_type.c_str();
+
+	if(strcmp(shader_type, "COMBINED") == 0)
+		return SHADER_EVAL_COMBINED;
+	else if(strcmp(shader_type, "AO") == 0)
+		return SHADER_EVAL_AO;
+	else if(strcmp(shader_type, "NORMAL") == 0)
+		return (object_space)? SHADER_EVAL_NORMAL_OBJECT: SHADER_EVAL_NORMAL;
+	else if(strcmp(shader_type, "DIFFUSE_COLOR") == 0)
+		return SHADER_EVAL_DIFFUSE_COLOR;
+	else if(strcmp(shader_type, "EMIT") == 0)
+		return SHADER_EVAL_EMISSION;
+	else
+		return SHADER_EVAL_BAKE;
+}
 
-	/* copy data from device */
-	if(!buffers->copy_from_device())
+void BlenderSession::bake(BL::Object b_object, const string& pass_type, BL::BakePixel pixel_array, int num_pixels, int depth, float result[])
+{
+	/* normals in tangent and camera space are not supported, those fall
+	 * back to world space */
+	bool object_space = (b_scene.render().bake_normal_space() == BL::RenderSettings::bake_normal_space_OBJECT);
+	ShaderEvalType shader_type = get_shader_type(pass_type, object_space);
+
+	if(shader_type == SHADER_EVAL_BAKE)
+		return;
+
+	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
+	BufferParams buffer_params = BlenderSync::get_buffer_params(b_render, b_scene, b_v3d, b_rv3d, scene->camera, width, height);
+
+	/* full data sync, like a render of the first render layer */
+	scene->film->tag_update(scene);
+	scene->integrator->tag_update(scene);
+
+	sync->sync_camera(b_render, b_engine.camera_override(), width, height);
+	sync->sync_data(b_v3d, b_engine.camera_override());
+
+	/* update scene, number of samples is needed by the sampling pattern */
+	session->reset(buffer_params, session_params.samples);
+
+	if(!session->load_kernels())
+		return;
+
+	session->update_scene();
+
+	if(session->progress.get_cancel())
+		return;
+
+	/* find the object, triangles are only known after the scene update */
+	size_t object_index = ~0;
+	int tri_offset = 0;
+
+	for(size_t i = 0; i < scene->objects.size(); i++) {
+		if(strcmp(scene->objects[i]->name.c_str(), b_object.name().c_str()) == 0) {
+			object_index = i;
+			tri_offset = scene->objects[i]->mesh->tri_offset;
+			break;
+		}
+	}
+
+	if(object_index == ~0)
 		return;
 
+	/* fill points to bake, pixel_array is a linked list of num_pixels */
+	BakeData *bake_data = scene->bake_manager->init(object_index, tri_offset, num_pixels);
+	BL::BakePixel bp = pixel_array;
+
+	for(int i = 0; i < num_pixels; i++) {
+		float uv[2] = {bp.uv()[0], bp.uv()[1]};
+		bake_data->set(i, bp.primitive_id(), uv);
+		bp = bp.next();
+	}
+
+	scene->bake_manager->num_samples = session_params.samples;
+	scene->bake_manager->bake(session->device, &scene->dscene, scene, session->progress, shader_type, bake_data, result);
+
+	/* free all memory used (host and device), so we wouldn't leave render
+	 * engine with extra memory allocated */
+	session->device_free();
+
+	delete sync;
+	sync = NULL;
+}
+
+void BlenderSession::write_render_stats()
+{
+	PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+	string filepath = get_string(cscene, "render_stats_path");
+	string json = session->render_stats_json();
+
+	if(filepath == "") {
+		printf("%s", json.c_str());
+		fflush(stdout);
+	}
+	else {
+		filepath = blender_absolute_path(b_data, b_scene, filepath);
+
+		if(!path_write_text(filepath, json))
+			fprintf(stderr, "Cycles: failed to write render statistics to %s\n", filepath.c_str());
+	}
+}
+
+void BlenderSession::do_write_update_render_result(BL::RenderResult b_rr, BL::RenderLayer b_rlay, RenderTile& rtile, bool do_update_only)
+{
+	RenderBuffers *buffers = rtile.buffers;
 	BufferParams& params = buffers->params;
 	float exposure = scene->film->exposure;
 
 	vector<float> pixels(params.width*params.height*4);
 
+	/* updates only show the combined pass, read it back as half floats
+	 * instead of the full buffer when the device supports it */
+	if(do_update_only && buffers->copy_combined_from_device(rtile.sample, &pixels[0])) {
+		b_rlay.rect(&pixels[0]);
+		b_engine.update_result(b_rr);
+		return;
+	}
+
+	/* copy data from device */
+	if(!buffers->copy_from_device())
+		return;
+
 	if (!do_update_only) {
 		/* copy each pass */
 		BL::RenderLayer::passes_iterator b_iter;
@@ -478,8 +603,9 @@ void BlenderSession::synchronize()
 		return;
 
 	/* on session/scene parameter changes, we recreate session entirely */
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
+	bool is_cpu = session_params.device.type == DEVICE_CPU;
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, is_cpu);
 
 	if(session->params.modified(session_params) ||
 	   scene->params.modified(scene_params))
@@ -35,6 +35,7 @@
 #include "util_debug.h"
 #include "util_foreach.h"
 #include "util_opengl.h"
+#include "util_system.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -179,6 +180,17 @@ void BlenderSync::sync_integrator()
 	integrator->layer_flag = render_layer.layer;
 
 	integrator->sample_clamp = get_float(cscene, "sample_clamp");
+
+	integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
+	bool use_light_tree = get_boolean(cscene, "use_light_tree");
+
+	if(integrator->use_light_tree != use_light_tree) {
+		scene->light_manager->tag_update(scene);
+		integrator->use_light_tree = use_light_tree;
+	}
+
 #ifdef __CAMERA_MOTION__
 	if(!preview) {
 		if(integrator->motion_blur != r.use_motion_blur()) {
@@ -333,7 +345,7 @@ void BlenderSync::sync_render_layers(BL::SpaceView3D b_v3d, const char *layer)
 
 /* Scene Parameters */
 
-SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background)
+SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background, bool is_cpu)
 {
 	BL::RenderSettings r = b_scene.render();
 	SceneParams params;
@@ -358,6 +370,20 @@ SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background)
 	else
 		params.persistent_data = false;
 
+	/* on demand loaded image textures are only supported on the CPU */
+	if(is_cpu)
+		params.texture_cache_size = get_int(cscene, "texture_cache_size");
+
+	/* QBVH traversal is only implemented for SSE capable CPU kernels */
+	if(!is_cpu || !system_cpu_support_sse2())
+		params.use_qbvh = false;
+
+	/* packet traversal is only implemented for the binary BVH on the CPU */
+	if(is_cpu && get_boolean(cscene, "use_ray_packets")) {
+		params.use_ray_packets = true;
+		params.use_qbvh = false;
+	}
+
 	return params;
 }
 
@@ -475,6 +501,12 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine b_engine, BL::Use
 
 	params.progressive_refine = get_boolean(cscene, "use_progressive_refine");
 
+	/* render statistics, only for final renders */
+	params.use_render_stats = background && get_boolean(cscene, "use_render_stats");
+
+	/* time limit, only for final renders */
+	params.time_limit = (background)? (double)get_float(cscene, "time_limit"): 0.0;
+
 	if(background) {
 		if(params.progressive_refine)
 			params.progressive = true;
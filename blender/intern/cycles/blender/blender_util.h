@@ -33,6 +33,8 @@ void BKE_image_user_frame_calc(void *iuser, int cfra, int fieldnr);
 void BKE_image_user_file_path(void *iuser, void *ima, char *path);
 unsigned char *BKE_image_get_pixels_for_frame(void *image, int frame);
 float *BKE_image_get_float_pixels_for_frame(void *image, int frame);
+void BLI_begin_threaded_malloc(void);
+void BLI_end_threaded_malloc(void);
 }
 
 CCL_NAMESPACE_BEGIN
@@ -42,6 +44,20 @@ static inline BL::Mesh object_to_mesh(BL::BlendData data, BL::Object object, BL:
 	return data.meshes.new_from_object(scene, object, apply_modifiers, (render)? 2: 1, true, calc_undeformed);
 }
 
+/* copy a property of all items in a collection into an array at once, which
+ * is much faster than iterating over the items with the C++ api. the array
+ * size must be the number of items times the property array length */
+template<typename T>
+static inline bool rna_collection_raw_get(PointerRNA *ptr, const char *collection, const char *propname, RawPropertyType type, vector<T>& array)
+{
+	PropertyRNA *prop = RNA_struct_find_property(ptr, collection);
+
+	if(!prop || array.size() == 0)
+		return false;
+
+	return RNA_property_collection_raw_get(NULL, ptr, prop, propname, &array[0], type, array.size()) != 0;
+}
+
 static inline void colorramp_to_array(BL::ColorRamp ramp, float4 *data, int size)
 {
 	for(int i = 0; i < size; i++) {
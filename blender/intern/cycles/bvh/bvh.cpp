@@ -73,37 +73,76 @@ BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
 
 bool BVH::cache_read(CacheData& key)
 {
-	key.add(system_cpu_bits());
+	/* the key only stores pointers to the data, so everything added must stay
+	 * alive until the file name is computed below */
+	int version = BVH_CACHE_VERSION;
+	int cpu_bits = system_cpu_bits();
+
+	key.add(version);
+	key.add(cpu_bits);
 	key.add(&params, sizeof(params));
 
+	/* curve keys contain padding after the radius, so they are hashed without
+	 * it, otherwise uninitialized memory would end up in the key */
+	vector<float4> curve_keys_data;
+
+	foreach(Object *ob, objects) {
+		foreach(const Mesh::CurveKey& curve_key, ob->mesh->curve_keys) {
+			float3 co = curve_key.co;
+			curve_keys_data.push_back(make_float4(co.x, co.y, co.z, curve_key.radius));
+		}
+	}
+
 	foreach(Object *ob, objects) {
 		key.add(ob->mesh->verts);
 		key.add(ob->mesh->triangles);
-		key.add(ob->mesh->curve_keys);
 		key.add(ob->mesh->curves);
 		key.add(&ob->bounds, sizeof(ob->bounds));
 		key.add(&ob->visibility, sizeof(ob->visibility));
 		key.add(&ob->mesh->transform_applied, sizeof(bool));
 	}
 
-	CacheData value;
+	key.add(curve_keys_data);
 
-	if(Cache::global.lookup(key, value)) {
-		cache_filename = key.get_filename();
+	/* compute the file name now, while curve_keys_data still exists */
+	key.get_filename();
 
-		value.read(pack.root_index);
-		value.read(pack.SAH);
+	CacheData value;
 
-		value.read(pack.nodes);
-		value.read(pack.object_node);
-		value.read(pack.tri_woop);
-		value.read(pack.prim_segment);
-		value.read(pack.prim_visibility);
-		value.read(pack.prim_index);
-		value.read(pack.prim_object);
-		value.read(pack.is_leaf);
+	if(Cache::global.lookup(key, value)) {
+		int file_version;
+		bool ok = value.read(file_version) && (file_version == BVH_CACHE_VERSION);
+
+		ok = ok && value.read(pack.root_index);
+		ok = ok && value.read(pack.SAH);
+
+		ok = ok && value.read(pack.nodes);
+		ok = ok && value.read(pack.object_node);
+		ok = ok && value.read(pack.tri_woop);
+		ok = ok && value.read(pack.prim_segment);
+		ok = ok && value.read(pack.prim_visibility);
+		ok = ok && value.read(pack.prim_index);
+		ok = ok && value.read(pack.prim_object);
+		ok = ok && value.read(pack.is_leaf);
+
+		/* sanity check, arrays indexed by primitive must match */
+		size_t num_prims = pack.prim_index.size();
+		size_t nsize = (params.use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
+
+		ok = ok && (pack.prim_segment.size() == num_prims);
+		ok = ok && (pack.prim_visibility.size() == num_prims);
+		ok = ok && (pack.prim_object.size() == num_prims);
+		ok = ok && (pack.tri_woop.size() == num_prims*TRI_NODE_SIZE);
+		ok = ok && (pack.nodes.size() % nsize == 0);
+
+		if(ok) {
+			cache_filename = key.get_filename();
+			return true;
+		}
 
-		return true;
+		/* corrupted or outdated cache file, build again */
+		fprintf(stderr, "Cycles: invalid BVH cache file %s, rebuilding.\n", key.get_filename().c_str());
+		pack = PackedBVH();
 	}
 
 	return false;
@@ -112,7 +151,9 @@ bool BVH::cache_read(CacheData& key)
 void BVH::cache_write(CacheData& key)
 {
 	CacheData value;
+	int version = BVH_CACHE_VERSION;
 
+	value.add(version);
 	value.add(pack.root_index);
 	value.add(pack.SAH);
 
@@ -182,15 +223,6 @@ void BVH::build(Progress& progress)
 	pack.prim_index = prim_index;
 	pack.prim_object = prim_object;
 
-	/* compute SAH */
-	if(!params.top_level)
-		pack.SAH = root->computeSubtreeSAHCost(params);
-
-	if(progress.get_cancel()) {
-		root->deleteSubtree();
-		return;
-	}
-
 	/* pack triangles */
 	progress.set_substatus("Packing BVH triangles and strands");
 	pack_primitives();
@@ -208,6 +240,10 @@ void BVH::build(Progress& progress)
 	/* free build nodes */
 	root->deleteSubtree();
 
+	/* compute SAH, for comparing against after refitting */
+	if(!params.top_level)
+		pack.SAH = packed_SAH();
+
 	if(progress.get_cancel()) return;
 
 	/* cache write */
@@ -223,15 +259,75 @@ void BVH::build(Progress& progress)
 
 /* Refitting */
 
-void BVH::refit(Progress& progress)
+bool BVH::refit(Progress& progress)
 {
 	progress.set_substatus("Packing BVH primitives");
 	pack_primitives();
 
-	if(progress.get_cancel()) return;
+	if(progress.get_cancel()) return true;
 
 	progress.set_substatus("Refitting BVH nodes");
 	refit_nodes();
+
+	/* bounds of nodes may start overlapping a lot as primitives move, tell
+	 * the caller to do a full rebuild once the BVH got too slow to traverse */
+	if(pack.SAH > 0.0f && packed_SAH() > pack.SAH * params.max_refit_sah_ratio)
+		return false;
+
+	return true;
+}
+
+void BVH::refit_primitives(int start, int end, BoundBox& bbox, uint& visibility)
+{
+	for(int prim = start; prim < end; prim++) {
+		int pidx = pack.prim_index[prim];
+		int tob = pack.prim_object[prim];
+		Object *ob = objects[tob];
+
+		if(pidx == -1) {
+			/* object instance */
+			bbox.grow(ob->bounds);
+		}
+		else {
+			/* primitives */
+			const Mesh *mesh = ob->mesh;
+
+			if(pack.prim_segment[prim] != ~0) {
+				/* curves */
+				int str_offset = (params.top_level)? mesh->curve_offset: 0;
+				int k0 = mesh->curves[pidx - str_offset].first_key + pack.prim_segment[prim]; // XXX!
+				int k1 = k0 + 1;
+
+				float3 p[4];
+				p[0] = mesh->curve_keys[max(k0 - 1,mesh->curves[pidx - str_offset].first_key)].co;
+				p[1] = mesh->curve_keys[k0].co;
+				p[2] = mesh->curve_keys[k1].co;
+				p[3] = mesh->curve_keys[min(k1 + 1,mesh->curves[pidx - str_offset].first_key + mesh->curves[pidx - str_offset].num_keys - 1)].co;
+				float3 lower;
+				float3 upper;
+				curvebounds(&lower.x, &upper.x, p, 0);
+				curvebounds(&lower.y, &upper.y, p, 1);
+				curvebounds(&lower.z, &upper.z, p, 2);
+				float mr = max(mesh->curve_keys[k0].radius,mesh->curve_keys[k1].radius);
+				bbox.grow(lower, mr);
+				bbox.grow(upper, mr);
+
+				visibility |= PATH_RAY_CURVE;
+			}
+			else {
+				/* triangles */
+				int tri_offset = (params.top_level)? mesh->tri_offset: 0;
+				const int *vidx = mesh->triangles[pidx - tri_offset].v;
+				const float3 *vpos = &mesh->verts[0];
+
+				bbox.grow(vpos[vidx[0]]);
+				bbox.grow(vpos[vidx[1]]);
+				bbox.grow(vpos[vidx[2]]);
+			}
+		}
+
+		visibility |= ob->visibility;
+	}
 }
 
 /* Triangles */
@@ -391,7 +487,7 @@ void BVH::pack_instances(size_t nodes_size)
 			if(mesh_map.find(mesh) == mesh_map.end()) {
 				prim_index_size += bvh->pack.prim_index.size();
 				tri_woop_size += bvh->pack.tri_woop.size();
-				nodes_size += bvh->pack.nodes.size()*nsize;
+				nodes_size += bvh->pack.nodes.size();
 
 				mesh_map[mesh] = 1;
 			}
@@ -616,55 +712,7 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 
 	if(leaf) {
 		/* refit leaf node */
-		for(int prim = c0; prim < c1; prim++) {
-			int pidx = pack.prim_index[prim];
-			int tob = pack.prim_object[prim];
-			Object *ob = objects[tob];
-
-			if(pidx == -1) {
-				/* object instance */
-				bbox.grow(ob->bounds);
-			}
-			else {
-				/* primitives */
-				const Mesh *mesh = ob->mesh;
-
-				if(pack.prim_segment[prim] != ~0) {
-					/* curves */
-					int str_offset = (params.top_level)? mesh->curve_offset: 0;
-					int k0 = mesh->curves[pidx - str_offset].first_key + pack.prim_segment[prim]; // XXX!
-					int k1 = k0 + 1;
-
-					float3 p[4];
-					p[0] = mesh->curve_keys[max(k0 - 1,mesh->curves[pidx - str_offset].first_key)].co;
-					p[1] = mesh->curve_keys[k0].co;
-					p[2] = mesh->curve_keys[k1].co;
-					p[3] = mesh->curve_keys[min(k1 + 1,mesh->curves[pidx - str_offset].first_key + mesh->curves[pidx - str_offset].num_keys - 1)].co;
-					float3 lower;
-					float3 upper;
-					curvebounds(&lower.x, &upper.x, p, 0);
-					curvebounds(&lower.y, &upper.y, p, 1);
-					curvebounds(&lower.z, &upper.z, p, 2);
-					float mr = max(mesh->curve_keys[k0].radius,mesh->curve_keys[k1].radius);
-					bbox.grow(lower, mr);
-					bbox.grow(upper, mr);
-
-					visibility |= PATH_RAY_CURVE;
-				}
-				else {
-					/* triangles */
-					int tri_offset = (params.top_level)? mesh->tri_offset: 0;
-					const int *vidx = mesh->triangles[pidx - tri_offset].v;
-					const float3 *vpos = &mesh->verts[0];
-
-					bbox.grow(vpos[vidx[0]]);
-					bbox.grow(vpos[vidx[1]]);
-					bbox.grow(vpos[vidx[2]]);
-				}
-			}
-
-			visibility |= ob->visibility;
-		}
+		refit_primitives(c0, c1, bbox, visibility);
 
 		pack_node(idx, bbox, bbox, c0, c1, visibility, visibility);
 	}
@@ -684,14 +732,57 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 	}
 }
 
+static BoundBox regular_node_bounds(const int4 *data, int child)
+{
+	BoundBox bounds;
+
+	bounds.min = make_float3(__int_as_float(data[0][child]), __int_as_float(data[1][child]), __int_as_float(data[2][child]));
+	bounds.max = make_float3(__int_as_float(data[0][child+2]), __int_as_float(data[1][child+2]), __int_as_float(data[2][child+2]));
+
+	return bounds;
+}
+
+float RegularBVH::packed_SAH()
+{
+	const int4 *data = &pack.nodes[0];
+	bool leaf = (pack.is_leaf[0])? true: false;
+
+	BoundBox bounds = regular_node_bounds(data, 0);
+	if(!leaf)
+		bounds.grow(regular_node_bounds(data, 1));
+
+	float area = bounds.safe_area();
+
+	if(area == 0.0f)
+		return 0.0f;
+
+	return packed_SAH_node(0, leaf, area) / area;
+}
+
+float RegularBVH::packed_SAH_node(int idx, bool leaf, float area)
+{
+	const int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+
+	int c0 = data[3].x;
+	int c1 = data[3].y;
+
+	if(leaf)
+		return area * params.triangle_cost((c0 < 0)? 1: c1 - c0);
+
+	float area0 = regular_node_bounds(data, 0).safe_area();
+	float area1 = regular_node_bounds(data, 1).safe_area();
+
+	return area * params.node_cost(2) +
+		packed_SAH_node((c0 < 0)? -c0-1: c0, (c0 < 0), area0) +
+		packed_SAH_node((c1 < 0)? -c1-1: c1, (c1 < 0), area1);
+}
+
 /* QBVH */
 
 QBVH::QBVH(const BVHParams& params_, const vector<Object*>& objects_)
 : BVH(params_, objects_)
 {
 	params.use_qbvh = true;
-
-	/* todo: use visibility */
 }
 
 void QBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
@@ -710,6 +801,7 @@ void QBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
 		data[6].x = __int_as_float(leaf->m_lo);
 		data[6].y = __int_as_float(leaf->m_hi);
 	}
+	data[6].z = __uint_as_float(leaf->m_visibility);
 
 	memcpy(&pack.nodes[e.idx * BVH_QNODE_SIZE], data, sizeof(float4)*BVH_QNODE_SIZE);
 }
@@ -730,20 +822,21 @@ void QBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num)
 		data[5][i] = bb_max.z;
 
 		data[6][i] = __int_as_float(en[i].encodeIdx());
-		data[7][i] = 0.0f;
+		data[7][i] = __uint_as_float(en[i].node->m_visibility);
 	}
 
 	for(int i = num; i < 4; i++) {
-		data[0][i] = 0.0f;
-		data[1][i] = 0.0f;
-		data[2][i] = 0.0f;
-
-		data[3][i] = 0.0f;
-		data[4][i] = 0.0f;
-		data[5][i] = 0.0f;
+		/* empty child slots get inverted bounds so they are never hit by a
+		 * ray, and index 0, which can't be a child since it's the root */
+		data[0][i] = FLT_MAX;
+		data[1][i] = -FLT_MAX;
+		data[2][i] = FLT_MAX;
+		data[3][i] = -FLT_MAX;
+		data[4][i] = FLT_MAX;
+		data[5][i] = -FLT_MAX;
 
 		data[6][i] = __int_as_float(0);
-		data[7][i] = 0.0f;
+		data[7][i] = __uint_as_float(0);
 	}
 
 	memcpy(&pack.nodes[e.idx * BVH_QNODE_SIZE], data, sizeof(float4)*BVH_QNODE_SIZE);
@@ -751,9 +844,51 @@ void QBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num)
 
 /* Quad SIMD Nodes */
 
+static int qbvh_collect_children(const BVHNode *node, const BVHNode *nodes[4])
+{
+	/* every QBVH inner node takes the children of both binary children,
+	 * effectively collapsing every other level of the binary tree */
+	const BVHNode *node0 = node->get_child(0);
+	const BVHNode *node1 = node->get_child(1);
+	int numnodes = 0;
+
+	if(node0->is_leaf()) {
+		nodes[numnodes++] = node0;
+	}
+	else {
+		nodes[numnodes++] = node0->get_child(0);
+		nodes[numnodes++] = node0->get_child(1);
+	}
+
+	if(node1->is_leaf()) {
+		nodes[numnodes++] = node1;
+	}
+	else {
+		nodes[numnodes++] = node1->get_child(0);
+		nodes[numnodes++] = node1->get_child(1);
+	}
+
+	return numnodes;
+}
+
+static size_t qbvh_count_nodes(const BVHNode *node)
+{
+	if(node->is_leaf())
+		return 1;
+
+	const BVHNode *nodes[4];
+	int numnodes = qbvh_collect_children(node, nodes);
+	size_t count = 1;
+
+	for(int i = 0; i < numnodes; i++)
+		count += qbvh_count_nodes(nodes[i]);
+
+	return count;
+}
+
 void QBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 {
-	size_t node_size = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
+	size_t node_size = qbvh_count_nodes(root);
 
 	/* resize arrays */
 	pack.nodes.clear();
@@ -784,30 +919,9 @@ void QBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 			pack_leaf(e, leaf);
 		}
 		else {
-			/* inner node */
-			const BVHNode *node = e.node;
-			const BVHNode *node0 = node->get_child(0);
-			const BVHNode *node1 = node->get_child(1);
-
-			/* collect nodes */
+			/* inner node, collect nodes */
 			const BVHNode *nodes[4];
-			int numnodes = 0;
-
-			if(node0->is_leaf()) {
-				nodes[numnodes++] = node0;
-			}
-			else {
-				nodes[numnodes++] = node0->get_child(0);
-				nodes[numnodes++] = node0->get_child(1);
-			}
-
-			if(node1->is_leaf()) {
-				nodes[numnodes++] = node1;
-			}
-			else {
-				nodes[numnodes++] = node1->get_child(0);
-				nodes[numnodes++] = node1->get_child(1);
-			}
+			int numnodes = qbvh_collect_children(e.node, nodes);
 
 			/* push entries on the stack */
 			for(int i = 0; i < numnodes; i++)
@@ -824,8 +938,110 @@ void QBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 
 void QBVH::refit_nodes()
 {
-	assert(0); /* todo */
+	assert(!params.top_level);
+
+	BoundBox bbox = BoundBox::empty;
+	uint visibility = 0;
+	refit_node(0, (pack.is_leaf[0])? true: false, bbox, visibility);
 }
 
-CCL_NAMESPACE_END
+void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+{
+	float4 *data = (float4*)&pack.nodes[idx*BVH_QNODE_SIZE];
+
+	if(leaf) {
+		/* refit leaf node, only the primitive range is stored in the leaf
+		 * itself, bounds are stored in the parent node */
+		int c0 = __float_as_int(data[6].x);
+		int c1 = __float_as_int(data[6].y);
+
+		refit_primitives(c0, c1, bbox, visibility);
+
+		data[6].z = __uint_as_float(visibility);
+	}
+	else {
+		/* refit inner node, set bbox from children */
+		for(int i = 0; i < 4; i++) {
+			int c = __float_as_int(data[6][i]);
 
+			/* empty child slot */
+			if(c == 0)
+				continue;
+
+			BoundBox cbbox = BoundBox::empty;
+			uint cvisibility = 0;
+
+			refit_node((c < 0)? -c-1: c, (c < 0), cbbox, cvisibility);
+
+			data[0][i] = cbbox.min.x;
+			data[1][i] = cbbox.max.x;
+			data[2][i] = cbbox.min.y;
+			data[3][i] = cbbox.max.y;
+			data[4][i] = cbbox.min.z;
+			data[5][i] = cbbox.max.z;
+			data[7][i] = __uint_as_float(cvisibility);
+
+			bbox.grow(cbbox);
+			visibility |= cvisibility;
+		}
+	}
+}
+
+float QBVH::packed_SAH()
+{
+	if(pack.is_leaf[0]) {
+		/* single leaf, there are no bounds stored to compare against */
+		return 0.0f;
+	}
+
+	const float4 *data = (const float4*)&pack.nodes[0];
+	BoundBox bounds = BoundBox::empty;
+
+	for(int i = 0; i < 4; i++) {
+		if(__float_as_int(data[6][i]) != 0) {
+			bounds.grow(make_float3(data[0][i], data[2][i], data[4][i]));
+			bounds.grow(make_float3(data[1][i], data[3][i], data[5][i]));
+		}
+	}
+
+	float area = bounds.safe_area();
+
+	if(area == 0.0f)
+		return 0.0f;
+
+	return packed_SAH_node(0, false, area) / area;
+}
+
+float QBVH::packed_SAH_node(int idx, bool leaf, float area)
+{
+	const float4 *data = (const float4*)&pack.nodes[idx*BVH_QNODE_SIZE];
+
+	if(leaf) {
+		int c0 = __float_as_int(data[6].x);
+		int c1 = __float_as_int(data[6].y);
+
+		return area * params.triangle_cost((c0 < 0)? 1: c1 - c0);
+	}
+
+	float SAH = 0.0f;
+	int num = 0;
+
+	for(int i = 0; i < 4; i++) {
+		int c = __float_as_int(data[6][i]);
+
+		/* empty child slot */
+		if(c == 0)
+			continue;
+
+		BoundBox cbounds;
+		cbounds.min = make_float3(data[0][i], data[2][i], data[4][i]);
+		cbounds.max = make_float3(data[1][i], data[3][i], data[5][i]);
+
+		SAH += packed_SAH_node((c < 0)? -c-1: c, (c < 0), cbounds.safe_area());
+		num++;
+	}
+
+	return SAH + area * params.node_cost(num);
+}
+
+CCL_NAMESPACE_END
@@ -40,6 +40,9 @@ class Progress;
 #define BVH_ALIGN		4096
 #define TRI_NODE_SIZE	3
 
+/* increase when the packed BVH layout changes, to invalidate disk caches */
+#define BVH_CACHE_VERSION	3
+
 /* Packed BVH
  *
  * BVH stored as it will be used for traversal on the rendering device. */
@@ -68,7 +71,8 @@ struct PackedBVH {
 	/* index of the root node. */
 	int root_index;
 
-	/* surface area heuristic, for building top level BVH */
+	/* surface area heuristic cost of the packed nodes after building, to
+	 * detect when refitting degraded the BVH too much */
 	float SAH;
 
 	PackedBVH()
@@ -92,7 +96,7 @@ public:
 	virtual ~BVH() {}
 
 	void build(Progress& progress);
-	void refit(Progress& progress);
+	bool refit(Progress& progress);
 
 	void clear_cache_except();
 
@@ -111,9 +115,13 @@ protected:
 	/* merge instance BVH's */
 	void pack_instances(size_t nodes_size);
 
+	/* refit */
+	void refit_primitives(int start, int end, BoundBox& bbox, uint& visibility);
+
 	/* for subclasses to implement */
 	virtual void pack_nodes(const array<int>& prims, const BVHNode *root) = 0;
 	virtual void refit_nodes() = 0;
+	virtual float packed_SAH() = 0;
 };
 
 /* Regular BVH
@@ -135,6 +143,10 @@ protected:
 	/* refit */
 	void refit_nodes();
 	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+
+	/* SAH */
+	float packed_SAH();
+	float packed_SAH_node(int idx, bool leaf, float area);
 };
 
 /* QBVH
@@ -154,6 +166,11 @@ protected:
 
 	/* refit */
 	void refit_nodes();
+	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+
+	/* SAH */
+	float packed_SAH();
+	float packed_SAH_node(int idx, bool leaf, float area);
 };
 
 CCL_NAMESPACE_END
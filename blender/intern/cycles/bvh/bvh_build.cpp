@@ -26,6 +26,7 @@
 #include "scene.h"
 #include "curves.h"
 
+#include "util_algorithm.h"
 #include "util_debug.h"
 #include "util_foreach.h"
 #include "util_progress.h"
@@ -46,6 +47,60 @@ public:
 	BVHObjectBinning range;
 };
 
+/* BVH Spatial Split Build Task
+ *
+ * Spatial splits may duplicate references and insert them into the reference
+ * array, so each task builds its subtree from its own copy of the references
+ * in the range, with its own scratch memory for finding splits. */
+
+class BVHSpatialSplitBuildTask : public Task {
+public:
+	BVHSpatialSplitBuildTask(BVHBuild *build, InnerNode *node, int child, const BVHRange& range_,
+	                         const vector<BVHReference>& references_, int level)
+	: range(range_.bounds(), 0, range_.size()),
+	  references(references_.begin() + range_.start(), references_.begin() + range_.end())
+	{
+		run = function_bind(&BVHBuild::thread_build_spatial_split_node, build, node, child,
+		                    &range, &references, level, &storage);
+	}
+
+	BVHRange range;
+	vector<BVHReference> references;
+	BVHSpatialStorage storage;
+};
+
+/* BVH Reference Chunk
+ *
+ * Part of the triangles and curves of a mesh, for which references are added
+ * by a single task into space reserved for them in the reference array. A
+ * chunk without mesh holds the reference to an object instance. Curve
+ * segments split into multiple references are stored in the chunk itself,
+ * as their number is not known in advance. */
+
+struct BVHReferenceChunk {
+	BVHReferenceChunk(Mesh *mesh_, int object_, int offset_)
+	: mesh(mesh_), object(object_),
+	  tri_start(0), tri_end(0), curve_start(0), curve_end(0),
+	  offset(offset_), num(0),
+	  bounds(BoundBox::empty), center(BoundBox::empty)
+	{
+	}
+
+	Mesh *mesh;
+	int object;
+	int tri_start, tri_end;
+	int curve_start, curve_end;
+
+	/* place in the reference array, and number of valid references added */
+	int offset;
+	int num;
+
+	vector<BVHReference> split_references;
+
+	BoundBox bounds;
+	BoundBox center;
+};
+
 /* Constructor / Destructor */
 
 BVHBuild::BVHBuild(const vector<Object*>& objects_,
@@ -68,9 +123,13 @@ BVHBuild::~BVHBuild()
 
 /* Adding References */
 
-void BVHBuild::add_reference_mesh(BoundBox& root, BoundBox& center, Mesh *mesh, int i)
+void BVHBuild::add_reference_mesh(BVHReferenceChunk *chunk)
 {
-	for(uint j = 0; j < mesh->triangles.size(); j++) {
+	BVHReference *refs = &references[chunk->offset];
+	Mesh *mesh = chunk->mesh;
+	int i = chunk->object;
+
+	for(int j = chunk->tri_start; j < chunk->tri_end; j++) {
 		Mesh::Triangle t = mesh->triangles[j];
 		BoundBox bounds = BoundBox::empty;
 
@@ -80,13 +139,13 @@ void BVHBuild::add_reference_mesh(BoundBox& root, BoundBox& center, Mesh *mesh,
 		}
 
 		if(bounds.valid()) {
-			references.push_back(BVHReference(bounds, j, i, ~0));
-			root.grow(bounds);
-			center.grow(bounds.center2());
+			refs[chunk->num++] = BVHReference(bounds, j, i, ~0);
+			chunk->bounds.grow(bounds);
+			chunk->center.grow(bounds.center2());
 		}
 	}
 
-	for(uint j = 0; j < mesh->curves.size(); j++) {
+	for(int j = chunk->curve_start; j < chunk->curve_end; j++) {
 		Mesh::Curve curve = mesh->curves[j];
 
 		for(int k = 0; k < curve.num_keys - 1; k++) {
@@ -107,71 +166,146 @@ void BVHBuild::add_reference_mesh(BoundBox& root, BoundBox& center, Mesh *mesh,
 			bounds.grow(lower, mr);
 			bounds.grow(upper, mr);
 
-			if(bounds.valid()) {
-				references.push_back(BVHReference(bounds, j, i, k));
-				root.grow(bounds);
-				center.grow(bounds.center2());
-			}
+			if(bounds.valid())
+				add_reference_curve(chunk, BVHReference(bounds, j, i, k), 0);
 		}
 	}
 }
 
-void BVHBuild::add_reference_object(BoundBox& root, BoundBox& center, Object *ob, int i)
+void BVHBuild::add_reference_curve(BVHReferenceChunk *chunk, const BVHReference& ref, int depth)
 {
-	references.push_back(BVHReference(ob->bounds, -1, i, false));
-	root.grow(ob->bounds);
-	center.grow(ob->bounds.center2());
+	/* long diagonal segments have mostly empty bounds, split them in halves
+	 * along the longest axis for as long as that reduces the surface area */
+	const BoundBox& bounds = ref.bounds();
+
+	if(!params.top_level && depth < BVHParams::MAX_CURVE_SPLIT_DEPTH) {
+		float3 size = bounds.size();
+		int dim = (size.x > size.y)? ((size.x > size.z)? 0: 2): ((size.y > size.z)? 1: 2);
+		float pos = bounds.center()[dim];
+
+		BVHReference left, right;
+		BVHSpatialSplit::split_reference(this, left, right, ref, dim, pos);
+
+		if(left.bounds().valid() && right.bounds().valid() &&
+		   left.bounds().safe_area() + right.bounds().safe_area() < 0.75f*bounds.safe_area()) {
+			add_reference_curve(chunk, left, depth + 1);
+			add_reference_curve(chunk, right, depth + 1);
+			return;
+		}
+	}
+
+	if(depth == 0)
+		references[chunk->offset + chunk->num++] = ref;
+	else
+		chunk->split_references.push_back(ref);
+
+	chunk->bounds.grow(bounds);
+	chunk->center.grow(bounds.center2());
 }
 
-static size_t count_curve_segments(Mesh *mesh)
+void BVHBuild::add_reference_object(BVHReferenceChunk *chunk)
 {
-	size_t num = 0, num_curves = mesh->curves.size();
+	Object *ob = objects[chunk->object];
 
-	for(size_t i = 0; i < num_curves; i++)
-		num += mesh->curves[i].num_keys - 1;
-	
-	return num;
+	references[chunk->offset] = BVHReference(ob->bounds, -1, chunk->object, false);
+	chunk->bounds.grow(ob->bounds);
+	chunk->center.grow(ob->bounds.center2());
+	chunk->num = 1;
 }
 
 void BVHBuild::add_references(BVHRange& root)
 {
-	/* reserve space for references */
+	/* split objects into chunks of primitives, and reserve space for their
+	 * references, object instances are added right away */
+	vector<BVHReferenceChunk> chunks;
 	size_t num_alloc_references = 0;
+	int i = 0;
 
 	foreach(Object *ob, objects) {
-		if(params.top_level) {
-			if(ob->mesh->transform_applied) {
-				num_alloc_references += ob->mesh->triangles.size();
-				num_alloc_references += count_curve_segments(ob->mesh);
-			}
-			else
-				num_alloc_references++;
+		Mesh *mesh = ob->mesh;
+
+		if(params.top_level && !mesh->transform_applied) {
+			chunks.push_back(BVHReferenceChunk(NULL, i, num_alloc_references));
+			num_alloc_references++;
 		}
 		else {
-			num_alloc_references += ob->mesh->triangles.size();
-			num_alloc_references += count_curve_segments(ob->mesh);
+			int num_triangles = mesh->triangles.size();
+			int num_curves = mesh->curves.size();
+
+			for(int start = 0; start < num_triangles; start += THREAD_TASK_SIZE) {
+				BVHReferenceChunk chunk(mesh, i, num_alloc_references);
+
+				chunk.tri_start = start;
+				chunk.tri_end = min(start + THREAD_TASK_SIZE, num_triangles);
+				num_alloc_references += chunk.tri_end - chunk.tri_start;
+
+				chunks.push_back(chunk);
+			}
+
+			int start = 0, num_segments = 0;
+
+			for(int j = 0; j < num_curves; j++) {
+				num_segments += max(mesh->curves[j].num_keys - 1, 0);
+
+				if(num_segments >= THREAD_TASK_SIZE || j == num_curves - 1) {
+					BVHReferenceChunk chunk(mesh, i, num_alloc_references);
+
+					chunk.curve_start = start;
+					chunk.curve_end = j + 1;
+					num_alloc_references += num_segments;
+
+					chunks.push_back(chunk);
+
+					start = j + 1;
+					num_segments = 0;
+				}
+			}
 		}
+
+		i++;
+	}
+
+	references.resize(num_alloc_references);
+
+	/* add references from objects, with a task per chunk for large builds */
+	bool use_threads = (num_alloc_references >= THREAD_TASK_SIZE);
+
+	foreach(BVHReferenceChunk& chunk, chunks) {
+		if(!chunk.mesh)
+			add_reference_object(&chunk);
+		else if(use_threads)
+			task_pool.push(function_bind(&BVHBuild::add_reference_mesh, this, &chunk));
+		else
+			add_reference_mesh(&chunk);
 	}
 
-	references.reserve(num_alloc_references);
+	task_pool.wait_work();
+
+	if(progress.get_cancel()) return;
 
-	/* add references from objects */
+	/* pack references without gaps left by invalid primitives, in the same
+	 * order as they were added, and merge bounds */
 	BoundBox bounds = BoundBox::empty, center = BoundBox::empty;
-	int i = 0;
+	int num_references = 0;
 
-	foreach(Object *ob, objects) {
-		if(params.top_level) {
-			if(ob->mesh->transform_applied)
-				add_reference_mesh(bounds, center, ob->mesh, i);
-			else
-				add_reference_object(bounds, center, ob, i);
+	foreach(BVHReferenceChunk& chunk, chunks) {
+		if(chunk.offset != num_references) {
+			std::copy(references.begin() + chunk.offset,
+			          references.begin() + chunk.offset + chunk.num,
+			          references.begin() + num_references);
 		}
-		else
-			add_reference_mesh(bounds, center, ob->mesh, i);
 
-		i++;
+		num_references += chunk.num;
+		bounds.grow(chunk.bounds);
+		center.grow(chunk.center);
+	}
+
+	references.resize(num_references);
 
-		if(progress.get_cancel()) return;
+	/* append split curve references */
+	foreach(BVHReferenceChunk& chunk, chunks) {
+		references.insert(references.end(), chunk.split_references.begin(), chunk.split_references.end());
+		vector<BVHReference>().swap(chunk.split_references);
 	}
 
 	/* happens mostly on empty meshes */
@@ -198,8 +332,6 @@ BVHNode* BVHBuild::run()
 		params.use_spatial_split = false;
 
 	spatial_min_overlap = root.bounds().safe_area() * params.spatial_split_alpha;
-	spatial_right_bounds.clear();
-	spatial_right_bounds.resize(max(root.size(), (int)BVHParams::NUM_SPATIAL_BINS) - 1);
 
 	/* init progress updates */
 	progress_start_time = time_dt();
@@ -207,19 +339,32 @@ BVHNode* BVHBuild::run()
 	progress_total = references.size();
 	progress_original_total = progress_total;
 
-	prim_segment.resize(references.size());
-	prim_index.resize(references.size());
-	prim_object.resize(references.size());
-
 	/* build recursively */
 	BVHNode *rootnode;
 
 	if(params.use_spatial_split) {
-		/* singlethreaded spatial split build */
-		rootnode = build_node(root, 0);
+		/* multithreaded spatial split build, the number of primitives is not
+		 * known in advance due to duplicates, so leaves append to the arrays */
+		BVHSpatialStorage storage;
+		storage.right_bounds.resize(max(root.size(), (int)BVHParams::NUM_SPATIAL_BINS) - 1);
+
+		prim_segment.clear();
+		prim_index.clear();
+		prim_object.clear();
+
+		prim_segment.reserve(references.size());
+		prim_index.reserve(references.size());
+		prim_object.reserve(references.size());
+
+		rootnode = build_node(root, references, 0, &storage);
+		task_pool.wait_work();
 	}
 	else {
 		/* multithreaded binning build */
+		prim_segment.resize(references.size());
+		prim_index.resize(references.size());
+		prim_object.resize(references.size());
+
 		BVHObjectBinning rootbin(root, (references.size())? &references[0]: NULL);
 		rootnode = build_node(rootbin, 0);
 		task_pool.wait_work();
@@ -231,7 +376,7 @@ BVHNode* BVHBuild::run()
 			rootnode->deleteSubtree();
 			rootnode = NULL;
 		}
-		else if(!params.use_spatial_split) {
+		else {
 			/*rotate(rootnode, 4, 5);*/
 			rootnode->update_visibility();
 		}
@@ -277,6 +422,32 @@ void BVHBuild::thread_build_node(InnerNode *inner, int child, BVHObjectBinning *
 	}
 }
 
+void BVHBuild::thread_build_spatial_split_node(InnerNode *inner, int child, BVHRange *range,
+                                               vector<BVHReference> *references, int level,
+                                               BVHSpatialStorage *storage)
+{
+	if(progress.get_cancel())
+		return;
+
+	/* scratch memory for splits, child ranges are never larger than this one */
+	storage->right_bounds.resize(max(range->size(), (int)BVHParams::NUM_SPATIAL_BINS) - 1);
+
+	/* build nodes */
+	BVHNode *node = build_node(*range, *references, level, storage);
+
+	/* set child in inner node */
+	inner->children[child] = node;
+
+	/* update progress, including duplicates created while building locally */
+	if(range->size() < THREAD_TASK_SIZE) {
+		thread_scoped_lock lock(build_mutex);
+
+		progress_count += references->size();
+		progress_total += references->size() - range->size();
+		progress_update();
+	}
+}
+
 /* multithreaded binning builder */
 BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 {
@@ -289,7 +460,7 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
 		/* make leaf node when threshold reached or SAH tells us */
 		if(params.small_enough_for_leaf(size, level) || (size <= params.max_leaf_size && leafSAH < splitSAH))
-			return create_leaf_node(range);
+			return create_leaf_node(range, references);
 	}
 
 	/* perform split */
@@ -317,48 +488,55 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	return inner;
 }
 
-/* single threaded spatial split builder */
-BVHNode* BVHBuild::build_node(const BVHRange& range, int level)
+/* multithreaded spatial split builder */
+BVHNode* BVHBuild::build_node(const BVHRange& range, vector<BVHReference>& references,
+                              int level, BVHSpatialStorage *storage)
 {
-	/* progress update */
-	progress_update();
 	if(progress.get_cancel())
 		return NULL;
 
 	/* small enough or too deep => create leaf. */
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
-		if(params.small_enough_for_leaf(range.size(), level)) {
-			progress_count += range.size();
-			return create_leaf_node(range);
-		}
+		if(params.small_enough_for_leaf(range.size(), level))
+			return create_leaf_node(range, references);
 	}
 
 	/* splitting test */
-	BVHMixedSplit split(this, range, level);
+	BVHMixedSplit split(this, storage, references, range, level);
 
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
-		if(split.no_split) {
-			progress_count += range.size();
-			return create_leaf_node(range);
-		}
+		if(split.no_split)
+			return create_leaf_node(range, references);
 	}
 	
 	/* do split */
 	BVHRange left, right;
-	split.split(this, left, right, range);
+	split.split(this, references, left, right, range);
+
+	if(range.size() < THREAD_TASK_SIZE) {
+		/* local build, duplicates made in the left subtree are inserted
+		 * before the right range, so modify its start */
+		size_t num_references = references.size();
+		BVHNode *leftnode = build_node(left, references, level + 1, storage);
+
+		right.set_start(right.start() + references.size() - num_references);
+		BVHNode *rightnode = build_node(right, references, level + 1, storage);
+
+		return new InnerNode(range.bounds(), leftnode, rightnode);
+	}
 
-	progress_total += left.size() + right.size() - range.size();
-	size_t total = progress_total;
+	/* threaded build */
+	{
+		thread_scoped_lock lock(build_mutex);
+		progress_total += left.size() + right.size() - range.size();
+	}
 
-	/* leaft node */
-	BVHNode *leftnode = build_node(left, level + 1);
+	InnerNode *inner = new InnerNode(range.bounds());
 
-	/* right node (modify start for splits) */
-	right.set_start(right.start() + progress_total - total);
-	BVHNode *rightnode = build_node(right, level + 1);
+	task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 0, left, references, level + 1), true);
+	task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 1, right, references, level + 1), true);
 
-	/* inner node */
-	return new InnerNode(range.bounds(), leftnode, rightnode);
+	return inner;
 }
 
 /* Create Nodes */
@@ -399,7 +577,21 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
 	}
 }
 
-BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
+BVHNode* BVHBuild::create_leaf_node(const BVHRange& range, vector<BVHReference>& references)
+{
+	BVHReference *refs = (range.size())? &references[range.start()]: NULL;
+
+	if(params.use_spatial_split) {
+		/* spatial split tasks work on their own reference arrays, so leaf
+		 * primitives are appended to the output arrays instead */
+		thread_scoped_lock lock(build_mutex);
+		return create_leaf_node(range, refs, prim_index.size());
+	}
+
+	return create_leaf_node(range, refs, range.start());
+}
+
+BVHNode* BVHBuild::create_leaf_node(const BVHRange& range, BVHReference *refs, int start)
 {
 	vector<int>& p_segment = prim_segment;
 	vector<int>& p_index = prim_index;
@@ -409,10 +601,10 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	uint visibility = 0;
 
 	for(int i = 0; i < range.size(); i++) {
-		BVHReference& ref = references[range.start() + i];
+		BVHReference& ref = refs[i];
 
 		if(ref.prim_index() != -1) {
-			if(range.start() + num == prim_index.size()) {
+			if(start + num == prim_index.size()) {
 				assert(params.use_spatial_split);
 
 				p_segment.push_back(ref.prim_segment());
@@ -420,9 +612,9 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 				p_object.push_back(ref.prim_object());
 			}
 			else {
-				p_segment[range.start() + num] = ref.prim_segment();
-				p_index[range.start() + num] = ref.prim_index();
-				p_object[range.start() + num] = ref.prim_object();
+				p_segment[start + num] = ref.prim_segment();
+				p_index[start + num] = ref.prim_index();
+				p_object[start + num] = ref.prim_object();
 			}
 
 			bounds.grow(ref.bounds());
@@ -431,7 +623,7 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 		}
 		else {
 			if(ob_num < i)
-				references[range.start() + ob_num] = ref;
+				refs[ob_num] = ref;
 			ob_num++;
 		}
 	}
@@ -439,7 +631,7 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	BVHNode *leaf = NULL;
 	
 	if(num > 0) {
-		leaf = new LeafNode(bounds, visibility, range.start(), range.start() + num);
+		leaf = new LeafNode(bounds, visibility, start, start + num);
 
 		if(num == range.size())
 			return leaf;
@@ -447,8 +639,8 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 
 	/* while there may be multiple triangles in a leaf, for object primitives
 	 * we want there to be the only one, so we keep splitting */
-	const BVHReference *ref = (ob_num)? &references[range.start()]: NULL;
-	BVHNode *oleaf = create_object_leaf_nodes(ref, range.start() + num, ob_num);
+	const BVHReference *ref = (ob_num)? refs: NULL;
+	BVHNode *oleaf = create_object_leaf_nodes(ref, start + num, ob_num);
 	
 	if(leaf)
 		return new InnerNode(range.bounds(), leaf, oleaf);
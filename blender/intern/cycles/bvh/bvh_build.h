@@ -31,10 +31,12 @@ CCL_NAMESPACE_BEGIN
 
 class BVHBuildTask;
 class BVHParams;
+class BVHSpatialSplitBuildTask;
 class InnerNode;
 class Mesh;
 class Object;
 class Progress;
+struct BVHReferenceChunk;
 
 /* BVH Builder */
 
@@ -58,21 +60,28 @@ protected:
 	friend class BVHObjectSplit;
 	friend class BVHSpatialSplit;
 	friend class BVHBuildTask;
+	friend class BVHSpatialSplitBuildTask;
 
 	/* adding references */
-	void add_reference_mesh(BoundBox& root, BoundBox& center, Mesh *mesh, int i);
-	void add_reference_object(BoundBox& root, BoundBox& center, Object *ob, int i);
+	void add_reference_mesh(BVHReferenceChunk *chunk);
+	void add_reference_curve(BVHReferenceChunk *chunk, const BVHReference& ref, int depth);
+	void add_reference_object(BVHReferenceChunk *chunk);
 	void add_references(BVHRange& root);
 
 	/* building */
-	BVHNode *build_node(const BVHRange& range, int level);
+	BVHNode *build_node(const BVHRange& range, vector<BVHReference>& references,
+	                    int level, BVHSpatialStorage *storage);
 	BVHNode *build_node(const BVHObjectBinning& range, int level);
-	BVHNode *create_leaf_node(const BVHRange& range);
+	BVHNode *create_leaf_node(const BVHRange& range, vector<BVHReference>& references);
+	BVHNode *create_leaf_node(const BVHRange& range, BVHReference *refs, int start);
 	BVHNode *create_object_leaf_nodes(const BVHReference *ref, int start, int num);
 
 	/* threads */
 	enum { THREAD_TASK_SIZE = 4096 };
 	void thread_build_node(InnerNode *node, int child, BVHObjectBinning *range, int level);
+	void thread_build_spatial_split_node(InnerNode *node, int child, BVHRange *range,
+	                                     vector<BVHReference> *references, int level,
+	                                     BVHSpatialStorage *storage);
 	thread_mutex build_mutex;
 
 	/* progress */
@@ -104,8 +113,6 @@ protected:
 
 	/* spatial splitting */
 	float spatial_min_overlap;
-	vector<BoundBox> spatial_right_bounds;
-	BVHSpatialBin spatial_bins[3][BVHParams::NUM_SPATIAL_BINS];
 
 	/* threads */
 	TaskPool task_pool;
@@ -19,6 +19,7 @@
 #define __BVH_PARAMS_H__
 
 #include "util_boundbox.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -48,13 +49,16 @@ public:
 	/* QBVH */
 	int use_qbvh;
 
-	int pad;
+	/* refitting, rebuild instead when the SAH cost got worse than this
+	 * factor times the cost of the original build */
+	float max_refit_sah_ratio;
 
 	/* fixed parameters */
 	enum {
 		MAX_DEPTH = 64,
 		MAX_SPATIAL_DEPTH = 48,
-		NUM_SPATIAL_BINS = 32
+		NUM_SPATIAL_BINS = 32,
+		MAX_CURVE_SPLIT_DEPTH = 2
 	};
 
 	BVHParams()
@@ -71,7 +75,7 @@ public:
 		top_level = false;
 		use_cache = false;
 		use_qbvh = false;
-		pad = false;
+		max_refit_sah_ratio = 1.5f;
 	}
 
 	/* SAH costs */
@@ -171,6 +175,20 @@ struct BVHSpatialBin
 	}
 };
 
+/* BVH Spatial Storage
+ *
+ * Scratch memory for finding object and spatial splits. Each build task owns
+ * its own storage, so that multiple ranges can be split at the same time. */
+
+struct BVHSpatialStorage
+{
+	/* right to left sweep bounds, for object and spatial splits */
+	vector<BoundBox> right_bounds;
+
+	/* bins for spatial splits */
+	BVHSpatialBin bins[3][BVHParams::NUM_SPATIAL_BINS];
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_PARAMS_H__ */
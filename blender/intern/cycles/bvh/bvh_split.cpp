@@ -28,22 +28,23 @@ CCL_NAMESPACE_BEGIN
 
 /* Object Split */
 
-BVHObjectSplit::BVHObjectSplit(BVHBuild *builder, const BVHRange& range, float nodeSAH)
+BVHObjectSplit::BVHObjectSplit(BVHBuild *builder, BVHSpatialStorage *storage, vector<BVHReference>& references,
+                               const BVHRange& range, float nodeSAH)
 : sah(FLT_MAX), dim(0), num_left(0), left_bounds(BoundBox::empty), right_bounds(BoundBox::empty)
 {
-	const BVHReference *ref_ptr = &builder->references[range.start()];
+	const BVHReference *ref_ptr = &references[range.start()];
 	float min_sah = FLT_MAX;
 
 	for(int dim = 0; dim < 3; dim++) {
 		/* sort references */
-		bvh_reference_sort(range.start(), range.end(), &builder->references[0], dim);
+		bvh_reference_sort(range.start(), range.end(), &references[0], dim);
 
 		/* sweep right to left and determine bounds. */
 		BoundBox right_bounds = BoundBox::empty;
 
 		for(int i = range.size() - 1; i > 0; i--) {
 			right_bounds.grow(ref_ptr[i].bounds());
-			builder->spatial_right_bounds[i - 1] = right_bounds;
+			storage->right_bounds[i - 1] = right_bounds;
 		}
 
 		/* sweep left to right and select lowest SAH. */
@@ -51,7 +52,7 @@ BVHObjectSplit::BVHObjectSplit(BVHBuild *builder, const BVHRange& range, float n
 
 		for(int i = 1; i < range.size(); i++) {
 			left_bounds.grow(ref_ptr[i - 1].bounds());
-			right_bounds = builder->spatial_right_bounds[i - 1];
+			right_bounds = storage->right_bounds[i - 1];
 
 			float sah = nodeSAH +
 				left_bounds.safe_area() * builder->params.triangle_cost(i) +
@@ -70,10 +71,11 @@ BVHObjectSplit::BVHObjectSplit(BVHBuild *builder, const BVHRange& range, float n
 	}
 }
 
-void BVHObjectSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right, const BVHRange& range)
+void BVHObjectSplit::split(BVHBuild *builder, vector<BVHReference>& references,
+                           BVHRange& left, BVHRange& right, const BVHRange& range)
 {
 	/* sort references according to split */
-	bvh_reference_sort(range.start(), range.end(), &builder->references[0], this->dim);
+	bvh_reference_sort(range.start(), range.end(), &references[0], this->dim);
 
 	/* split node ranges */
 	left = BVHRange(this->left_bounds, range.start(), this->num_left);
@@ -83,49 +85,49 @@ void BVHObjectSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right, c
 
 /* Spatial Split */
 
-BVHSpatialSplit::BVHSpatialSplit(BVHBuild *builder, const BVHRange& range, float nodeSAH)
+BVHSpatialSplit::BVHSpatialSplit(BVHBuild *builder, BVHSpatialStorage *storage, const vector<BVHReference>& references,
+                                 const BVHRange& range, float nodeSAH)
 : sah(FLT_MAX), dim(0), pos(0.0f)
 {
-	/* initialize bins. */
 	float3 origin = range.bounds().min;
 	float3 binSize = (range.bounds().max - origin) * (1.0f / (float)BVHParams::NUM_SPATIAL_BINS);
-	float3 invBinSize = 1.0f / binSize;
 
-	for(int dim = 0; dim < 3; dim++) {
-		for(int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
-			BVHSpatialBin& bin = builder->spatial_bins[dim][i];
+	/* chop references into bins. large ranges are split into chunks that are
+	 * binned in parallel, each into their own bins, and then merged. */
+	int num_chunks = min(TaskScheduler::num_threads(), range.size() / BVHBuild::THREAD_TASK_SIZE);
 
-			bin.bounds = BoundBox::empty;
-			bin.enter = 0;
-			bin.exit = 0;
-		}
+	if(num_chunks <= 1) {
+		bin_references(builder, storage, &references, &range, range.start(), range.end());
 	}
+	else {
+		vector<BVHSpatialStorage> chunk_storage(num_chunks);
+		int chunk_size = (range.size() + num_chunks - 1) / num_chunks;
+		TaskPool pool;
 
-	/* chop references into bins. */
-	for(unsigned int refIdx = range.start(); refIdx < range.end(); refIdx++) {
-		const BVHReference& ref = builder->references[refIdx];
-		float3 firstBinf = (ref.bounds().min - origin) * invBinSize;
-		float3 lastBinf = (ref.bounds().max - origin) * invBinSize;
-		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
-		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+		for(int chunk = 0; chunk < num_chunks; chunk++) {
+			int start = range.start() + chunk * chunk_size;
+			int end = min(start + chunk_size, range.end());
 
-		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
-		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+			pool.push(function_bind(&BVHSpatialSplit::bin_references,
+				builder, &chunk_storage[chunk], &references, &range, start, end));
+		}
+
+		pool.wait_work();
 
 		for(int dim = 0; dim < 3; dim++) {
-			BVHReference currRef = ref;
+			for(int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+				BVHSpatialBin& bin = storage->bins[dim][i];
 
-			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
-				BVHReference leftRef, rightRef;
+				bin = chunk_storage[0].bins[dim][i];
 
-				split_reference(builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
-				builder->spatial_bins[dim][i].bounds.grow(leftRef.bounds());
-				currRef = rightRef;
-			}
+				for(int chunk = 1; chunk < num_chunks; chunk++) {
+					const BVHSpatialBin& chunk_bin = chunk_storage[chunk].bins[dim][i];
 
-			builder->spatial_bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
-			builder->spatial_bins[dim][firstBin[dim]].enter++;
-			builder->spatial_bins[dim][lastBin[dim]].exit++;
+					bin.bounds.grow(chunk_bin.bounds);
+					bin.enter += chunk_bin.enter;
+					bin.exit += chunk_bin.exit;
+				}
+			}
 		}
 	}
 
@@ -135,8 +137,8 @@ BVHSpatialSplit::BVHSpatialSplit(BVHBuild *builder, const BVHRange& range, float
 		BoundBox right_bounds = BoundBox::empty;
 
 		for(int i = BVHParams::NUM_SPATIAL_BINS - 1; i > 0; i--) {
-			right_bounds.grow(builder->spatial_bins[dim][i].bounds);
-			builder->spatial_right_bounds[i - 1] = right_bounds;
+			right_bounds.grow(storage->bins[dim][i].bounds);
+			storage->right_bounds[i - 1] = right_bounds;
 		}
 
 		/* sweep left to right and select lowest SAH. */
@@ -145,13 +147,13 @@ BVHSpatialSplit::BVHSpatialSplit(BVHBuild *builder, const BVHRange& range, float
 		int rightNum = range.size();
 
 		for(int i = 1; i < BVHParams::NUM_SPATIAL_BINS; i++) {
-			left_bounds.grow(builder->spatial_bins[dim][i - 1].bounds);
-			leftNum += builder->spatial_bins[dim][i - 1].enter;
-			rightNum -= builder->spatial_bins[dim][i - 1].exit;
+			left_bounds.grow(storage->bins[dim][i - 1].bounds);
+			leftNum += storage->bins[dim][i - 1].enter;
+			rightNum -= storage->bins[dim][i - 1].exit;
 
 			float sah = nodeSAH +
 				left_bounds.safe_area() * builder->params.triangle_cost(leftNum) +
-				builder->spatial_right_bounds[i - 1].safe_area() * builder->params.triangle_cost(rightNum);
+				storage->right_bounds[i - 1].safe_area() * builder->params.triangle_cost(rightNum);
 
 			if(sah < this->sah) {
 				this->sah = sah;
@@ -162,7 +164,8 @@ BVHSpatialSplit::BVHSpatialSplit(BVHBuild *builder, const BVHRange& range, float
 	}
 }
 
-void BVHSpatialSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right, const BVHRange& range)
+void BVHSpatialSplit::split(BVHBuild *builder, vector<BVHReference>& refs,
+                            BVHRange& left, BVHRange& right, const BVHRange& range)
 {
 	/* Categorize references and compute bounds.
 	 *
@@ -170,7 +173,6 @@ void BVHSpatialSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right,
 	 * Uncategorized/split:		[left_end, right_start[
 	 * Right-hand side:			[right_start, refs.size()[ */
 
-	vector<BVHReference>& refs = builder->references;
 	int left_start = range.start();
 	int left_end = left_start;
 	int right_start = range.end();
@@ -243,6 +245,53 @@ void BVHSpatialSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right,
 	right = BVHRange(right_bounds, right_start, right_end - right_start);
 }
 
+void BVHSpatialSplit::bin_references(BVHBuild *builder, BVHSpatialStorage *storage, const vector<BVHReference> *references,
+                                     const BVHRange *range, int start, int end)
+{
+	/* initialize bins. */
+	float3 origin = range->bounds().min;
+	float3 binSize = (range->bounds().max - origin) * (1.0f / (float)BVHParams::NUM_SPATIAL_BINS);
+	float3 invBinSize = 1.0f / binSize;
+
+	for(int dim = 0; dim < 3; dim++) {
+		for(int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+			BVHSpatialBin& bin = storage->bins[dim][i];
+
+			bin.bounds = BoundBox::empty;
+			bin.enter = 0;
+			bin.exit = 0;
+		}
+	}
+
+	/* chop references into bins. */
+	for(int refIdx = start; refIdx < end; refIdx++) {
+		const BVHReference& ref = (*references)[refIdx];
+		float3 firstBinf = (ref.bounds().min - origin) * invBinSize;
+		float3 lastBinf = (ref.bounds().max - origin) * invBinSize;
+		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
+		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+
+		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
+		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+
+		for(int dim = 0; dim < 3; dim++) {
+			BVHReference currRef = ref;
+
+			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
+				BVHReference leftRef, rightRef;
+
+				split_reference(builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
+				storage->bins[dim][i].bounds.grow(leftRef.bounds());
+				currRef = rightRef;
+			}
+
+			storage->bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
+			storage->bins[dim][firstBin[dim]].enter++;
+			storage->bins[dim][lastBin[dim]].exit++;
+		}
+	}
+}
+
 void BVHSpatialSplit::split_reference(BVHBuild *builder, BVHReference& left, BVHReference& right, const BVHReference& ref, int dim, float pos)
 {
 	/* initialize boundboxes */
@@ -281,33 +330,50 @@ void BVHSpatialSplit::split_reference(BVHBuild *builder, BVHReference& left, BVH
 		}
 	}
 	else {
-		/* curve split: NOTE - Currently ignores curve width and needs to be fixed.*/
-		const int k0 = mesh->curves[ref.prim_index()].first_key + ref.prim_segment();
+		/* curve split: the interpolated segment lies within the convex hull of
+		 * its bezier control points, clip the hull against the plane and grow
+		 * the result by the curve radius */
+		const Mesh::Curve& curve = mesh->curves[ref.prim_index()];
+		const int k0 = curve.first_key + ref.prim_segment();
 		const int k1 = k0 + 1;
-		const float3* v0 = &mesh->curve_keys[k0].co;
-		const float3* v1 = &mesh->curve_keys[k1].co;
-
-		float v0p = (*v0)[dim];
-		float v1p = (*v1)[dim];
-
-		/* insert vertex to the boxes it belongs to. */
-		if(v0p <= pos)
-			left_bounds.grow(*v0);
-
-		if(v0p >= pos)
-			right_bounds.grow(*v0);
-
-		if(v1p <= pos)
-			left_bounds.grow(*v1);
-
-		if(v1p >= pos)
-			right_bounds.grow(*v1);
-
-		/* edge intersects the plane => insert intersection to both boxes. */
-		if((v0p < pos && v1p > pos) || (v0p > pos && v1p < pos)) {
-			float3 t = lerp(*v0, *v1, clamp((pos - v0p) / (v1p - v0p), 0.0f, 1.0f));
-			left_bounds.grow(t);
-			right_bounds.grow(t);
+		const int ka = max(k0 - 1, curve.first_key);
+		const int kb = min(k1 + 1, curve.first_key + curve.num_keys - 1);
+
+		const float3 p0 = mesh->curve_keys[ka].co;
+		const float3 p1 = mesh->curve_keys[k0].co;
+		const float3 p2 = mesh->curve_keys[k1].co;
+		const float3 p3 = mesh->curve_keys[kb].co;
+
+		/* same tension as the cardinal curve in the kernel */
+		const float fc = 0.71f;
+		float3 v[4];
+		v[0] = p1;
+		v[1] = p1 + (fc/3.0f)*(p2 - p0);
+		v[2] = p2 - (fc/3.0f)*(p3 - p1);
+		v[3] = p2;
+
+		float radius = max(mesh->curve_keys[k0].radius, mesh->curve_keys[k1].radius);
+
+		for(int i = 0; i < 4; i++) {
+			float vip = v[i][dim];
+
+			/* insert control point to the boxes its radius reaches into. */
+			if(vip - radius <= pos)
+				left_bounds.grow(v[i], radius);
+
+			if(vip + radius >= pos)
+				right_bounds.grow(v[i], radius);
+
+			/* hull edge intersects the plane => insert intersection to both boxes. */
+			for(int j = i + 1; j < 4; j++) {
+				float vjp = v[j][dim];
+
+				if((vip < pos && vjp > pos) || (vip > pos && vjp < pos)) {
+					float3 t = lerp(v[i], v[j], clamp((pos - vip) / (vjp - vip), 0.0f, 1.0f));
+					left_bounds.grow(t, radius);
+					right_bounds.grow(t, radius);
+				}
+			}
 		}
 	}
 
@@ -108,9 +108,17 @@ public:
 	virtual void pixels_copy_from(device_memory& mem, int y, int w, int h);
 	virtual void pixels_free(device_memory& mem);
 
+	/* synchronous conversion of the combined pass to half floats in regular
+	 * memory, so a render buffer can be read back at a fraction of its size.
+	 * safe to call from within a running task, returns false if unsupported */
+	virtual bool film_convert_half(DeviceTask& task, device_ptr buffer, device_ptr rgba_half) { return false; }
+
 	/* open shading language, only for CPU device */
 	virtual void *osl_memory() { return NULL; }
 
+	/* image textures loaded on demand, only for CPU device */
+	virtual void image_cache_set(void *image_cache) {}
+
 	/* load/compile kernels, must be called before adding tasks */ 
 	virtual bool load_kernels(bool experimental) { return true; }
 
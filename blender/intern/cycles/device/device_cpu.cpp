@@ -54,6 +54,10 @@ public:
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		kernel_globals.image_cache = NULL;
+		kernel_globals.image_cache_tdata = NULL;
+		kernel_globals.counters = NULL;
+		kernel_globals.packet_isect = NULL;
 
 		/* do now to avoid thread issues */
 		system_cpu_support_sse2();
@@ -123,6 +127,11 @@ public:
 #endif
 	}
 
+	void image_cache_set(void *image_cache)
+	{
+		kernel_globals.image_cache = (KernelImageCache*)image_cache;
+	}
+
 	void thread_run(DeviceTask *task)
 	{
 		if(task->type == DeviceTask::PATH_TRACE)
@@ -142,6 +151,64 @@ public:
 		}
 	};
 
+	/* adaptive sampling, check if all pixels in the tile converged so the
+	 * remaining samples can be skipped */
+	bool tile_converged(RenderTile& tile)
+	{
+		KernelFilm *kfilm = &kernel_globals.__data.film;
+
+		if(!(kfilm->pass_flag & PASS_ADAPTIVE))
+			return false;
+
+		float *buffer = (float*)tile.buffer;
+
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				int index = tile.offset + x + y*tile.stride;
+
+				if(buffer[index*kfilm->pass_stride + kfilm->pass_adaptive + 1] == 0.0f)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	/* renders with a time limit stop sampling a tile once its share of the
+	 * remaining time is used up */
+	bool tile_time_limit_reached(RenderTile& tile)
+	{
+		return (tile.stop_time > 0.0 && time_dt() >= tile.stop_time);
+	}
+
+	void tile_update_skipped_samples(DeviceTask& task, RenderTile& tile)
+	{
+		KernelFilm *kfilm = &kernel_globals.__data.film;
+		int end_sample = tile.start_sample + tile.num_samples;
+		uint64_t num_pixel_samples = 0;
+
+		if(kfilm->pass_flag & PASS_ADAPTIVE) {
+			/* count samples not taken by converged pixels, the flag stores the
+			 * number of samples after which the pixel converged */
+			float *buffer = (float*)tile.buffer;
+
+			for(int y = tile.y; y < tile.y + tile.h; y++) {
+				for(int x = tile.x; x < tile.x + tile.w; x++) {
+					int index = tile.offset + x + y*tile.stride;
+					int converged_sample = (int)buffer[index*kfilm->pass_stride + kfilm->pass_adaptive + 1];
+
+					if(converged_sample > 0 && converged_sample < end_sample)
+						num_pixel_samples += end_sample - max(converged_sample, tile.start_sample);
+				}
+			}
+		}
+
+		/* samples left when the tile was terminated early */
+		int num_tile_samples = end_sample - tile.sample;
+
+		task.update_skipped_samples(num_tile_samples, num_pixel_samples);
+	}
+
 	void thread_path_trace(DeviceTask& task)
 	{
 		if(task_pool.canceled()) {
@@ -155,6 +222,16 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+		if(kg.image_cache)
+			kg.image_cache_tdata = kg.image_cache->thread_init();
+
+#ifdef WITH_CYCLES_STATS
+		kg.counters = new RenderCounters();
+#endif
+
+		/* trace camera rays in packets of neighbouring pixels */
+		bool use_ray_packets = (kg.__data.bvh.use_ray_packets != 0);
+
 		RenderTile tile;
 		
 		while(task.acquire_tile(this, tile)) {
@@ -171,16 +248,32 @@ public:
 							break;
 					}
 
-					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_sse3_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+					if(use_ray_packets) {
+						for(int y = tile.y; y < tile.y + tile.h; y += RAY_PACKET_WIDTH) {
+							for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_WIDTH) {
+								int w = min(RAY_PACKET_WIDTH, tile.x + tile.w - x);
+								int h = min(RAY_PACKET_WIDTH, tile.y + tile.h - y);
+
+								kernel_cpu_sse3_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, w, h, tile.offset, tile.stride);
+							}
+						}
+					}
+					else {
+						for(int y = tile.y; y < tile.y + tile.h; y++) {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_sse3_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(tile_converged(tile) || tile_time_limit_reached(tile))
+						break;
 				}
 			}
 			else if(system_cpu_support_sse2()) {
@@ -190,16 +283,32 @@ public:
 							break;
 					}
 
-					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_sse2_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+					if(use_ray_packets) {
+						for(int y = tile.y; y < tile.y + tile.h; y += RAY_PACKET_WIDTH) {
+							for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_WIDTH) {
+								int w = min(RAY_PACKET_WIDTH, tile.x + tile.w - x);
+								int h = min(RAY_PACKET_WIDTH, tile.y + tile.h - y);
+
+								kernel_cpu_sse2_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, w, h, tile.offset, tile.stride);
+							}
+						}
+					}
+					else {
+						for(int y = tile.y; y < tile.y + tile.h; y++) {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_sse2_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(tile_converged(tile) || tile_time_limit_reached(tile))
+						break;
 				}
 			}
 			else
@@ -211,19 +320,45 @@ public:
 							break;
 					}
 
-					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+					if(use_ray_packets) {
+						for(int y = tile.y; y < tile.y + tile.h; y += RAY_PACKET_WIDTH) {
+							for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_WIDTH) {
+								int w = min(RAY_PACKET_WIDTH, tile.x + tile.w - x);
+								int h = min(RAY_PACKET_WIDTH, tile.y + tile.h - y);
+
+								kernel_cpu_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, w, h, tile.offset, tile.stride);
+							}
+						}
+					}
+					else {
+						for(int y = tile.y; y < tile.y + tile.h; y++) {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(tile_converged(tile) || tile_time_limit_reached(tile))
+						break;
 				}
 			}
 
+			if(!(task.get_cancel() || task_pool.canceled()))
+				tile_update_skipped_samples(task, tile);
+
+#ifdef WITH_CYCLES_STATS
+			if(stats.use_render_stats) {
+				stats.add_counters(*kg.counters);
+				kg.counters->reset();
+			}
+#endif
+
 			task.release_tile(tile);
 
 			if(task_pool.canceled()) {
@@ -232,6 +367,13 @@ public:
 			}
 		}
 
+		if(kg.image_cache)
+			kg.image_cache->thread_free(kg.image_cache_tdata);
+
+#ifdef WITH_CYCLES_STATS
+		delete kg.counters;
+#endif
+
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
@@ -297,10 +439,17 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+		if(kg.image_cache)
+			kg.image_cache_tdata = kg.image_cache->thread_init();
+
+#ifdef WITH_CYCLES_STATS
+		kg.counters = new RenderCounters();
+#endif
+
 #ifdef WITH_OPTIMIZED_KERNEL
 		if(system_cpu_support_sse3()) {
 			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
-				kernel_cpu_sse3_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x);
+				kernel_cpu_sse3_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x, task.sample);
 
 				if(task_pool.canceled())
 					break;
@@ -308,7 +457,7 @@ public:
 		}
 		else if(system_cpu_support_sse2()) {
 			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
-				kernel_cpu_sse2_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x);
+				kernel_cpu_sse2_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x, task.sample);
 
 				if(task_pool.canceled())
 					break;
@@ -318,13 +467,22 @@ public:
 #endif
 		{
 			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
-				kernel_cpu_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x);
+				kernel_cpu_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x, task.sample);
 
 				if(task_pool.canceled())
 					break;
 			}
 		}
 
+		if(kg.image_cache)
+			kg.image_cache->thread_free(kg.image_cache_tdata);
+
+#ifdef WITH_CYCLES_STATS
+		if(stats.use_render_stats)
+			stats.add_counters(*kg.counters);
+		delete kg.counters;
+#endif
+
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
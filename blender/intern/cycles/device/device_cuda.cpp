@@ -47,6 +47,13 @@ public:
 	bool first_error;
 	bool use_texture_storage;
 
+	/* read only buffers that don't fit in device memory are allocated in
+	 * pinned host memory mapped into the device address space, the kernel
+	 * then reads them over the bus at reduced speed */
+	bool can_map_host;
+	size_t map_host_reserve;
+	map<device_ptr, void*> map_host_pointers;
+
 	struct PixelMem {
 		GLuint cuPBO;
 		CUgraphicsResource cuPBOresource;
@@ -176,6 +183,8 @@ public:
 		first_error = true;
 		background = background_;
 		use_texture_storage = true;
+		can_map_host = false;
+		map_host_reserve = 0;
 
 		cuDevId = info.num;
 		cuDevice = 0;
@@ -190,15 +199,22 @@ public:
 			return;
 
 		CUresult result;
+		unsigned int ctx_flags = 0;
+		int can_map_host_memory = 0;
+
+		cuDeviceGetAttribute(&can_map_host_memory, CU_DEVICE_ATTRIBUTE_CAN_MAP_HOST_MEMORY, cuDevice);
+
+		if(can_map_host_memory)
+			ctx_flags |= CU_CTX_MAP_HOST;
 
 		if(background) {
-			result = cuCtxCreate(&cuContext, 0, cuDevice);
+			result = cuCtxCreate(&cuContext, ctx_flags, cuDevice);
 		}
 		else {
-			result = cuGLCtxCreate(&cuContext, 0, cuDevice);
+			result = cuGLCtxCreate(&cuContext, ctx_flags, cuDevice);
 
 			if(result != CUDA_SUCCESS) {
-				result = cuCtxCreate(&cuContext, 0, cuDevice);
+				result = cuCtxCreate(&cuContext, ctx_flags, cuDevice);
 				background = true;
 			}
 		}
@@ -215,6 +231,18 @@ public:
 		 * actually slightly faster in tests. */
 		use_texture_storage = (cuDevArchitecture < 350);
 
+		/* keep part of the device memory free for render buffers, RNG state
+		 * and kernel launches, other data goes to host memory beyond that */
+		size_t free_size, total_size;
+
+		if(can_map_host_memory && cuMemGetInfo(&free_size, &total_size) == CUDA_SUCCESS) {
+			can_map_host = true;
+			map_host_reserve = (size_t)256*1024*1024;
+
+			if(map_host_reserve > total_size/4)
+				map_host_reserve = total_size/4;
+		}
+
 		cuda_pop_context();
 	}
 
@@ -363,19 +391,70 @@ public:
 		return (result == CUDA_SUCCESS);
 	}
 
-	void mem_alloc(device_memory& mem, MemoryType type)
+	bool device_memory_available(size_t size)
+	{
+		size_t free_size, total_size;
+
+		if(cuMemGetInfo(&free_size, &total_size) != CUDA_SUCCESS)
+			return true;
+
+		return (free_size >= size + map_host_reserve);
+	}
+
+	void *map_host_pointer(device_ptr device_pointer)
+	{
+		map<device_ptr, void*>::iterator it = map_host_pointers.find(device_pointer);
+		return (it != map_host_pointers.end())? it->second: NULL;
+	}
+
+	void cuda_mem_alloc(device_memory& mem, bool allow_map_host)
 	{
 		cuda_push_context();
-		CUdeviceptr device_pointer;
+		CUdeviceptr device_pointer = 0;
 		size_t size = mem.memory_size();
-		cuda_assert(cuMemAlloc(&device_pointer, size))
-		mem.device_pointer = (device_ptr)device_pointer;
-		stats.mem_alloc(size);
+		CUresult result = CUDA_ERROR_OUT_OF_MEMORY;
+
+		allow_map_host = allow_map_host && can_map_host;
+
+		if(!allow_map_host || device_memory_available(size))
+			result = cuMemAlloc(&device_pointer, size);
+
+		if(result == CUDA_ERROR_OUT_OF_MEMORY && allow_map_host) {
+			/* fall back to mapped host memory */
+			void *host_pointer = NULL;
+
+			result = cuMemHostAlloc(&host_pointer, size, CU_MEMHOSTALLOC_DEVICEMAP|CU_MEMHOSTALLOC_WRITECOMBINED);
+
+			if(result == CUDA_SUCCESS) {
+				result = cuMemHostGetDevicePointer(&device_pointer, host_pointer, 0);
+
+				if(result == CUDA_SUCCESS)
+					map_host_pointers[(device_ptr)device_pointer] = host_pointer;
+				else
+					cuMemFreeHost(host_pointer);
+			}
+		}
+
+		if(!cuda_error_(result, "cuMemAlloc")) {
+			mem.device_pointer = (device_ptr)device_pointer;
+			stats.mem_alloc(size);
+		}
+
 		cuda_pop_context();
 	}
 
+	void mem_alloc(device_memory& mem, MemoryType type)
+	{
+		cuda_mem_alloc(mem, type == MEM_READ_ONLY);
+	}
+
 	void mem_copy_to(device_memory& mem)
 	{
+		if(void *host_pointer = map_host_pointer(mem.device_pointer)) {
+			memcpy(host_pointer, (void*)mem.data_pointer, mem.memory_size());
+			return;
+		}
+
 		cuda_push_context();
 		if(mem.device_pointer)
 			cuda_assert(cuMemcpyHtoD(cuda_device_ptr(mem.device_pointer), (void*)mem.data_pointer, mem.memory_size()))
@@ -387,6 +466,11 @@ public:
 		size_t offset = elem*y*w;
 		size_t size = elem*w*h;
 
+		if(void *host_pointer = map_host_pointer(mem.device_pointer)) {
+			memcpy((uchar*)mem.data_pointer + offset, (uchar*)host_pointer + offset, size);
+			return;
+		}
+
 		cuda_push_context();
 		if(mem.device_pointer) {
 			cuda_assert(cuMemcpyDtoH((uchar*)mem.data_pointer + offset,
@@ -402,6 +486,11 @@ public:
 	{
 		memset((void*)mem.data_pointer, 0, mem.memory_size());
 
+		if(void *host_pointer = map_host_pointer(mem.device_pointer)) {
+			memset(host_pointer, 0, mem.memory_size());
+			return;
+		}
+
 		cuda_push_context();
 		if(mem.device_pointer)
 			cuda_assert(cuMemsetD8(cuda_device_ptr(mem.device_pointer), 0, mem.memory_size()))
@@ -411,8 +500,15 @@ public:
 	void mem_free(device_memory& mem)
 	{
 		if(mem.device_pointer) {
+			void *host_pointer = map_host_pointer(mem.device_pointer);
+
 			cuda_push_context();
-			cuda_assert(cuMemFree(cuda_device_ptr(mem.device_pointer)))
+			if(host_pointer) {
+				cuda_assert(cuMemFreeHost(host_pointer))
+				map_host_pointers.erase(mem.device_pointer);
+			}
+			else
+				cuda_assert(cuMemFree(cuda_device_ptr(mem.device_pointer)))
 			cuda_pop_context();
 
 			mem.device_pointer = 0;
@@ -505,7 +601,8 @@ public:
 			else {
 				cuda_pop_context();
 
-				mem_alloc(mem, MEM_READ_ONLY);
+				/* texture references are bound to device memory only */
+				cuda_mem_alloc(mem, false);
 				mem_copy_to(mem);
 
 				cuda_push_context();
@@ -711,6 +808,17 @@ public:
 		cuda_pop_context();
 	}
 
+	bool film_convert_half(DeviceTask& task, device_ptr buffer, device_ptr rgba_half)
+	{
+		/* outside of background render non-byte output is a pixel buffer object */
+		if(!background)
+			return false;
+
+		film_convert(task, buffer, 0, rgba_half);
+
+		return !have_error();
+	}
+
 	void shader(DeviceTask& task)
 	{
 		if(have_error())
@@ -743,6 +851,9 @@ public:
 		cuda_assert(cuParamSeti(cuDisplace, offset, task.shader_x))
 		offset += sizeof(task.shader_x);
 
+		cuda_assert(cuParamSeti(cuDisplace, offset, task.sample))
+		offset += sizeof(task.sample);
+
 		cuda_assert(cuParamSetSize(cuDisplace, offset))
 
 		/* launch kernel: todo find optimal size, cache config for fermi */
@@ -972,8 +1083,15 @@ public:
 					tile.sample = sample + 1;
 
 					task->update_progress(tile);
+
+					/* renders with a time limit stop at the tile's stop time */
+					if(tile.stop_time > 0.0 && time_dt() >= tile.stop_time)
+						break;
 				}
 
+				if(!task->get_cancel())
+					task->update_skipped_samples(end_sample - tile.sample, 0);
+
 				task->release_tile(tile);
 			}
 		}
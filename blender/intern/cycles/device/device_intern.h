@@ -20,11 +20,12 @@
 CCL_NAMESPACE_BEGIN
 
 class Device;
+class NetworkTileScheduler;
 
 Device *device_cpu_create(DeviceInfo& info, Stats &stats);
 Device *device_opencl_create(DeviceInfo& info, Stats &stats, bool background);
 Device *device_cuda_create(DeviceInfo& info, Stats &stats, bool background);
-Device *device_network_create(DeviceInfo& info, Stats &stats, const char *address);
+Device *device_network_create(DeviceInfo& info, Stats &stats, const char *address, NetworkTileScheduler *tile_scheduler = NULL);
 Device *device_multi_create(DeviceInfo& info, Stats &stats, bool background);
 
 void device_cpu_info(vector<DeviceInfo>& devices);
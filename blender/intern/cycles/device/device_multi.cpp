@@ -26,6 +26,7 @@
 #include "util_foreach.h"
 #include "util_list.h"
 #include "util_map.h"
+#include "util_thread.h"
 #include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
@@ -43,6 +44,9 @@ public:
 
 	list<SubDevice> devices;
 	device_ptr unique_ptr;
+#ifdef WITH_NETWORK
+	NetworkTileScheduler *tile_scheduler;
+#endif
 
 	MultiDevice(DeviceInfo& info, Stats &stats, bool background_)
 	: Device(stats), unique_ptr(1)
@@ -55,17 +59,27 @@ public:
 			devices.push_back(SubDevice(device));
 		}
 
-#if 0 //def WITH_NETWORK
-		/* try to add network devices */
-		ServerDiscovery discovery(true);
-		time_sleep(1.0);
+#ifdef WITH_NETWORK
+		tile_scheduler = NULL;
+
+		if(info.type == DEVICE_NETWORK) {
+			/* render farm, add all servers that reply to discovery, with one
+			 * tile scheduler shared between them for work stealing */
+			tile_scheduler = new NetworkTileScheduler(background);
+
+			ServerDiscovery discovery(true);
+			time_sleep(1.0);
 
-		list<string> servers = discovery.get_server_list();
+			list<string> servers = discovery.get_server_list();
 
-		foreach(string& server, servers) {
-			device = device_network_create(info, server.c_str());
-			if(device)
-				devices.push_back(SubDevice(device));
+			if(servers.empty())
+				servers.push_back("127.0.0.1");
+
+			foreach(string& server, servers) {
+				device = device_network_create(info, stats, server.c_str(), tile_scheduler);
+				if(device)
+					devices.push_back(SubDevice(device));
+			}
 		}
 #endif
 	}
@@ -74,6 +88,10 @@ public:
 	{
 		foreach(SubDevice& sub, devices)
 			delete sub.device;
+
+#ifdef WITH_NETWORK
+		delete tile_scheduler;
+#endif
 	}
 
 	const string& error_message()
@@ -301,8 +319,22 @@ public:
 
 	void task_wait()
 	{
+		if(devices.size() == 1) {
+			devices.front().device->task_wait();
+			return;
+		}
+
+		/* wait for all devices at the same time, network devices handle
+		 * tile requests from their server while waiting */
+		list<thread*> threads;
+
 		foreach(SubDevice& sub, devices)
-			sub.device->task_wait();
+			threads.push_back(new thread(function_bind(&Device::task_wait, sub.device)));
+
+		foreach(thread *t, threads) {
+			t->join();
+			delete t;
+		}
 	}
 
 	void task_cancel()
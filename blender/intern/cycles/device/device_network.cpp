@@ -19,6 +19,7 @@
 #include "device_network.h"
 
 #include "util_foreach.h"
+#include "util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -31,9 +32,10 @@ public:
 	tcp::socket socket;
 	device_ptr mem_counter;
 	DeviceTask the_task; /* todo: handle multiple tasks */
+	NetworkTileScheduler *tile_scheduler;
 
-	NetworkDevice(Stats &stats, const char *address)
-	: Device(stats), socket(io_service)
+	NetworkDevice(Stats &stats, const char *address, NetworkTileScheduler *tile_scheduler_)
+	: Device(stats), socket(io_service), tile_scheduler(tile_scheduler_)
 	{
 		stringstream portstr;
 		portstr << SERVER_PORT;
@@ -166,6 +168,50 @@ public:
 		snd.write();
 	}
 
+	bool acquire_tile(RenderTile& tile)
+	{
+		if(the_task.acquire_tile(this, tile)) {
+			if(tile_scheduler)
+				tile_scheduler->add_tile(this, tile);
+
+			return true;
+		}
+
+		/* no tiles left, render a copy of a tile from a slower server, which
+		 * needs its own buffers on this device */
+		BufferParams params;
+
+		if(the_task.need_finish_queue || !tile_scheduler || !tile_scheduler->steal_tile(this, tile, params))
+			return false;
+
+		RenderBuffers *tilebuffers = new RenderBuffers(this);
+		tilebuffers->reset(this, params);
+
+		tile.buffer = tilebuffers->buffer.device_pointer;
+		tile.rng_state = tilebuffers->rng_state.device_pointer;
+		tile.buffers = tilebuffers;
+
+		return true;
+	}
+
+	void release_tile(RenderTile& tile)
+	{
+		if(!tile_scheduler || tile_scheduler->release_tile(this, tile))
+			the_task.release_tile(tile);
+		else
+			delete tile.buffers;
+	}
+
+	void send_dropped_tiles(RPCSend& snd)
+	{
+		list<RenderTile> dropped_tiles;
+
+		if(tile_scheduler)
+			tile_scheduler->get_dropped_tiles(this, dropped_tiles);
+
+		snd.add(dropped_tiles);
+	}
+
 	void task_wait()
 	{
 		RPCSend snd(socket, "task_wait");
@@ -173,18 +219,27 @@ public:
 
 		list<RenderTile> the_tiles;
 
-		/* todo: run this threaded for connecting to multiple clients */
 		for(;;) {
 			RPCReceive rcv(socket);
 			RenderTile tile;
 
 			if(rcv.name == "acquire_tile") {
+				/* servers request multiple tiles at once to hide latency */
+				int num_tiles;
+				list<RenderTile> tiles;
+
+				rcv.read(num_tiles);
+
 				/* todo: watch out for recursive calls! */
-				if(the_task.acquire_tile(this, tile)) { /* write return as bool */
+				while((int)tiles.size() < num_tiles && acquire_tile(tile)) {
 					the_tiles.push_back(tile);
+					tiles.push_back(tile);
+				}
 
+				if(tiles.size()) {
 					RPCSend snd(socket, "acquire_tile");
-					snd.add(tile);
+					snd.add(tiles);
+					send_dropped_tiles(snd);
 					snd.write();
 				}
 				else {
@@ -196,7 +251,7 @@ public:
 				rcv.read(tile);
 
 				for(list<RenderTile>::iterator it = the_tiles.begin(); it != the_tiles.end(); it++) {
-					if(tile.x == it->x && tile.y == it->y && tile.start_sample == it->start_sample) {
+					if(network_tile_equal(tile, *it)) {
 						tile.buffers = it->buffers;
 						the_tiles.erase(it);
 						break;
@@ -205,9 +260,10 @@ public:
 
 				assert(tile.buffers != NULL);
 
-				the_task.release_tile(tile);
+				release_tile(tile);
 
 				RPCSend snd(socket, "release_tile");
+				send_dropped_tiles(snd);
 				snd.write();
 			}
 			else if(rcv.name == "task_wait_done")
@@ -222,9 +278,15 @@ public:
 	}
 };
 
-Device *device_network_create(DeviceInfo& info, Stats &stats, const char *address)
+Device *device_network_create(DeviceInfo& info, Stats &stats, const char *address, NetworkTileScheduler *tile_scheduler)
 {
-	return new NetworkDevice(stats, address);
+	try {
+		return new NetworkDevice(stats, address, tile_scheduler);
+	}
+	catch(exception& e) {
+		fprintf(stderr, "Network device %s connection error: %s\n", address, e.what());
+		return NULL;
+	}
 }
 
 void device_network_info(vector<DeviceInfo>& devices)
@@ -232,7 +294,7 @@ void device_network_info(vector<DeviceInfo>& devices)
 	DeviceInfo info;
 
 	info.type = DEVICE_NETWORK;
-	info.description = "Network Device";
+	info.description = "Network Render Farm";
 	info.id = "NETWORK";
 	info.num = 0;
 	info.advanced_shading = true; /* todo: get this info from device */
@@ -424,6 +486,14 @@ protected:
 		else if(rcv.name == "task_wait") {
 			device->task_wait();
 
+			/* give back tiles that were not started, when canceled */
+			{
+				thread_scoped_lock acquire_lock(acquire_mutex);
+
+				dropped_tiles.splice(dropped_tiles.end(), tile_queue);
+				release_dropped_tiles();
+			}
+
 			RPCSend snd(socket, "task_wait_done");
 			snd.write();
 		}
@@ -436,30 +506,46 @@ protected:
 	{
 		thread_scoped_lock acquire_lock(acquire_mutex);
 
-		bool result = false;
+		/* request a batch of tiles when we run out, so that the next tile is
+		 * available without waiting for a round-trip to the client */
+		if(tile_queue.empty()) {
+			RPCSend snd(socket, "acquire_tile");
+			snd.add(num_tiles_in_flight());
+			snd.write();
 
-		RPCSend snd(socket, "acquire_tile");
-		snd.write();
+			while(1) {
+				RPCReceive rcv(socket);
 
-		while(1) {
-			RPCReceive rcv(socket);
+				if(rcv.name == "acquire_tile") {
+					list<RenderTile> tiles;
+					rcv.read(tiles);
 
-			if(rcv.name == "acquire_tile") {
-				rcv.read(tile);
+					foreach(RenderTile& rtile, tiles) {
+						if(rtile.buffer) rtile.buffer = ptr_map[rtile.buffer];
+						if(rtile.rng_state) rtile.rng_state = ptr_map[rtile.rng_state];
 
-				if(tile.buffer) tile.buffer = ptr_map[tile.buffer];
-				if(tile.rng_state) tile.rng_state = ptr_map[tile.rng_state];
+						tile_queue.push_back(rtile);
+					}
 
-				result = true;
-				break;
+					read_dropped_tiles(rcv);
+					break;
+				}
+				else if(rcv.name == "acquire_tile_none")
+					break;
+				else
+					process(rcv);
 			}
-			else if(rcv.name == "acquire_tile_none")
-				break;
-			else
-				process(rcv);
+
+			release_dropped_tiles();
 		}
 
-		return result;
+		if(tile_queue.empty())
+			return false;
+
+		tile = tile_queue.front();
+		tile_queue.pop_front();
+
+		return true;
 	}
 
 	void task_update_progress_sample()
@@ -476,6 +562,19 @@ protected:
 	{
 		thread_scoped_lock acquire_lock(acquire_mutex);
 
+		release_tile(tile);
+		release_dropped_tiles();
+	}
+
+	int num_tiles_in_flight()
+	{
+		/* one tile for each thread, plus one extra so that threads finishing
+		 * at the same time do not have to wait */
+		return max(TaskScheduler::num_threads(), 1) + 1;
+	}
+
+	void release_tile(RenderTile& tile)
+	{
 		if(tile.buffer) tile.buffer = ptr_imap[tile.buffer];
 		if(tile.rng_state) tile.rng_state = ptr_imap[tile.rng_state];
 
@@ -486,13 +585,45 @@ protected:
 		while(1) {
 			RPCReceive rcv(socket);
 
-			if(rcv.name == "release_tile")
+			if(rcv.name == "release_tile") {
+				read_dropped_tiles(rcv);
 				break;
+			}
 			else
 				process(rcv);
 		}
 	}
 
+	void read_dropped_tiles(RPCReceive& rcv)
+	{
+		/* tiles stolen by another server, remove them from the queue if we
+		 * did not start rendering them yet */
+		list<RenderTile> tiles;
+		rcv.read(tiles);
+
+		foreach(RenderTile& rtile, tiles) {
+			for(list<RenderTile>::iterator it = tile_queue.begin(); it != tile_queue.end(); it++) {
+				if(network_tile_equal(rtile, *it)) {
+					dropped_tiles.push_back(*it);
+					tile_queue.erase(it);
+					break;
+				}
+			}
+		}
+	}
+
+	void release_dropped_tiles()
+	{
+		/* release without any samples rendered, the client discards them */
+		while(!dropped_tiles.empty()) {
+			RenderTile tile = dropped_tiles.front();
+			dropped_tiles.pop_front();
+
+			tile.sample = tile.start_sample;
+			release_tile(tile);
+		}
+	}
+
 	bool task_get_cancel()
 	{
 		return false;
@@ -509,6 +640,10 @@ protected:
 
 	thread_mutex acquire_mutex;
 
+	/* tiles acquired from the client but not started yet */
+	list<RenderTile> tile_queue;
+	list<RenderTile> dropped_tiles;
+
 	/* todo: free memory and device (osl) on network error */
 };
 
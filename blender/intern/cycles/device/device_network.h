@@ -31,10 +31,12 @@
 
 #include "buffers.h"
 
+#include "util_algorithm.h"
 #include "util_foreach.h"
 #include "util_list.h"
 #include "util_map.h"
 #include "util_string.h"
+#include "util_thread.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -98,16 +100,27 @@ public:
 		archive & task.offset & task.stride;
 		archive & task.shader_input & task.shader_output & task.shader_eval_type;
 		archive & task.shader_x & task.shader_w;
+		archive & task.need_finish_queue & task.integrator_branched;
 	}
 
 	void add(const RenderTile& tile)
 	{
 		archive & tile.x & tile.y & tile.w & tile.h;
 		archive & tile.start_sample & tile.num_samples & tile.sample;
-		archive & tile.offset & tile.stride;
+		archive & tile.resolution & tile.offset & tile.stride;
 		archive & tile.buffer & tile.rng_state;
 	}
 
+	void add(const list<RenderTile>& tiles)
+	{
+		int num_tiles = tiles.size();
+
+		archive & num_tiles;
+
+		foreach(const RenderTile& tile, tiles)
+			add(tile);
+	}
+
 	void write()
 	{
 		boost::system::error_code error;
@@ -235,9 +248,10 @@ public:
 
 		*archive & type & task.x & task.y & task.w & task.h;
 		*archive & task.rgba_byte & task.rgba_half & task.buffer & task.sample & task.num_samples;
-		*archive & task.resolution & task.offset & task.stride;
+		*archive & task.offset & task.stride;
 		*archive & task.shader_input & task.shader_output & task.shader_eval_type;
 		*archive & task.shader_x & task.shader_w;
+		*archive & task.need_finish_queue & task.integrator_branched;
 
 		task.type = (DeviceTask::Type)type;
 	}
@@ -247,11 +261,24 @@ public:
 		*archive & tile.x & tile.y & tile.w & tile.h;
 		*archive & tile.start_sample & tile.num_samples & tile.sample;
 		*archive & tile.resolution & tile.offset & tile.stride;
-		*archive & tile.buffer & tile.rng_state & tile.rgba_byte & tile.rgba_half;
+		*archive & tile.buffer & tile.rng_state;
 
 		tile.buffers = NULL;
 	}
 
+	void read(list<RenderTile>& tiles)
+	{
+		int num_tiles;
+
+		*archive & num_tiles;
+
+		for(int i = 0; i < num_tiles; i++) {
+			RenderTile tile;
+			read(tile);
+			tiles.push_back(tile);
+		}
+	}
+
 	string name;
 
 protected:
@@ -261,6 +288,127 @@ protected:
 	boost::archive::text_iarchive *archive;
 };
 
+/* Network Tile Scheduler
+ *
+ * Shared by the network devices of a render farm, to keep track of which
+ * server renders which tile. Servers request multiple tiles at once to keep
+ * their threads busy without waiting for a round-trip per tile. Once the tile
+ * manager runs out of tiles, idle servers steal a copy of the oldest tile still
+ * in flight on another server, so a slow server does not hold up the render.
+ * The first copy of a tile to be released gets written, others are discarded. */
+
+static inline bool network_tile_equal(const RenderTile& a, const RenderTile& b)
+{
+	return (a.x == b.x && a.y == b.y && a.start_sample == b.start_sample);
+}
+
+class NetworkTileScheduler {
+public:
+	NetworkTileScheduler(bool background_)
+	: background(background_)
+	{
+	}
+
+	/* tile acquired from the tile manager by device */
+	void add_tile(Device *device, const RenderTile& tile)
+	{
+		thread_scoped_lock lock(mutex);
+
+		Entry entry;
+		entry.tile = tile;
+		entry.tile.buffers = NULL;
+		entry.params = tile.buffers->params;
+		entry.devices.push_back(device);
+		entry.done = false;
+
+		entries.push_back(entry);
+	}
+
+	/* find a tile rendered by another device to render a copy of, only done
+	 * when each tile has its own buffers, that is for background renders
+	 * without progressive refine */
+	bool steal_tile(Device *device, RenderTile& tile, BufferParams& params)
+	{
+		thread_scoped_lock lock(mutex);
+
+		if(!background)
+			return false;
+
+		foreach(Entry& entry, entries) {
+			if(entry.done || entry.devices.size() != 1 || entry.devices.front() == device)
+				continue;
+
+			/* the original device should drop the tile if it did not start it yet */
+			entry.drop_devices.push_back(entry.devices.front());
+			entry.devices.push_back(device);
+
+			tile = entry.tile;
+			params = entry.params;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	/* tiles stolen from device, which it no longer needs to render */
+	void get_dropped_tiles(Device *device, list<RenderTile>& tiles)
+	{
+		thread_scoped_lock lock(mutex);
+
+		foreach(Entry& entry, entries) {
+			list<Device*>::iterator it = std::find(entry.drop_devices.begin(), entry.drop_devices.end(), device);
+
+			if(it != entry.drop_devices.end()) {
+				entry.drop_devices.erase(it);
+				tiles.push_back(entry.tile);
+			}
+		}
+	}
+
+	/* returns true if the tile should be written, false if another copy of the
+	 * tile was or will be written instead */
+	bool release_tile(Device *device, const RenderTile& tile)
+	{
+		thread_scoped_lock lock(mutex);
+
+		for(list<Entry>::iterator it = entries.begin(); it != entries.end(); it++) {
+			if(!network_tile_equal(it->tile, tile))
+				continue;
+
+			it->devices.remove(device);
+			it->drop_devices.remove(device);
+
+			/* incomplete copies are only written when it was the last copy, for
+			 * example when the render was canceled */
+			bool complete = (tile.sample == tile.start_sample + tile.num_samples);
+			bool write = !it->done && (complete || it->devices.empty());
+
+			if(write)
+				it->done = true;
+			if(it->devices.empty())
+				entries.erase(it);
+
+			return write;
+		}
+
+		return true;
+	}
+
+protected:
+	struct Entry {
+		RenderTile tile;
+		BufferParams params;
+		list<Device*> devices;
+		list<Device*> drop_devices;
+		bool done;
+	};
+
+	thread_mutex mutex;
+	list<Entry> entries;
+	bool background;
+};
+
 /* Server auto discovery */
 
 class ServerDiscovery {
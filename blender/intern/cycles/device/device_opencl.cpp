@@ -1046,6 +1046,7 @@ public:
 		cl_int d_shader_eval_type = task.shader_eval_type;
 		cl_int d_shader_x = task.shader_x;
 		cl_int d_shader_w = task.shader_w;
+		cl_int d_sample = task.sample;
 
 		/* sample arguments */
 		cl_uint narg = 0;
@@ -1062,6 +1063,7 @@ public:
 		ciErr |= clSetKernelArg(ckShaderKernel, narg++, sizeof(d_shader_eval_type), (void*)&d_shader_eval_type);
 		ciErr |= clSetKernelArg(ckShaderKernel, narg++, sizeof(d_shader_x), (void*)&d_shader_x);
 		ciErr |= clSetKernelArg(ckShaderKernel, narg++, sizeof(d_shader_w), (void*)&d_shader_w);
+		ciErr |= clSetKernelArg(ckShaderKernel, narg++, sizeof(d_sample), (void*)&d_sample);
 
 		opencl_assert(ciErr);
 
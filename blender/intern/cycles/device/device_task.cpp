@@ -107,5 +107,14 @@ void DeviceTask::update_progress(RenderTile &rtile)
 	}
 }
 
+void DeviceTask::update_skipped_samples(int num_tile_samples, uint64_t num_pixel_samples)
+{
+	if (type != PATH_TRACE)
+		return;
+
+	if(update_progress_skipped_samples && (num_tile_samples > 0 || num_pixel_samples > 0))
+		update_progress_skipped_samples(num_tile_samples, num_pixel_samples);
+}
+
 CCL_NAMESPACE_END
 
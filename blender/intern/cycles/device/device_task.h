@@ -56,9 +56,11 @@ public:
 	void split_max_size(list<DeviceTask>& tasks, int max_size);
 
 	void update_progress(RenderTile &rtile);
+	void update_skipped_samples(int num_tile_samples, uint64_t num_pixel_samples);
 
 	boost::function<bool(Device *device, RenderTile&)> acquire_tile;
 	boost::function<void(void)> update_progress_sample;
+	boost::function<void(int, uint64_t)> update_progress_skipped_samples;
 	boost::function<void(RenderTile&)> update_tile_sample;
 	boost::function<void(RenderTile&)> release_tile;
 	boost::function<bool(void)> get_cancel;
@@ -23,6 +23,7 @@
 
 #include "kernel_film.h"
 #include "kernel_path.h"
+#include "kernel_bake.h"
 #include "kernel_displace.h"
 
 __kernel void kernel_ocl_path_trace(
@@ -115,7 +116,7 @@ __kernel void kernel_ocl_shader(
 	__global type *name,
 #include "kernel_textures.h"
 
-	int type, int sx, int sw)
+	int type, int sx, int sw, int sample)
 {
 	KernelGlobals kglobals, *kg = &kglobals;
 
@@ -128,6 +129,6 @@ __kernel void kernel_ocl_shader(
 	int x = sx + get_global_id(0);
 
 	if(x < sx + sw)
-		kernel_shader_evaluate(kg, input, output, (ShaderEvalType)type, x);
+		kernel_shader_evaluate(kg, input, output, (ShaderEvalType)type, x, sample);
 }
 
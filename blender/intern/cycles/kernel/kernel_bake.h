@@ -0,0 +1,213 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __BAKING__
+
+/* ShaderData setup from a point on a triangle of an object, for baking */
+
+__device void shader_setup_from_bake(KernelGlobals *kg, ShaderData *sd,
+	int object, int prim, float u, float v)
+{
+	float3 P, Ng;
+	int shader;
+
+	P = triangle_point_MT(kg, prim, u, v);
+	Ng = triangle_normal_MT(kg, prim, &shader);
+
+	/* meshes of instanced objects are stored in object space */
+	bool instanced = !(kernel_tex_fetch(__object_flag, object) & SD_TRANSFORM_APPLIED);
+
+	if(instanced) {
+		Transform tfm = object_fetch_transform(kg, object, OBJECT_TRANSFORM);
+		Transform itfm = object_fetch_transform(kg, object, OBJECT_INVERSE_TRANSFORM);
+
+		P = transform_point(&tfm, P);
+		Ng = normalize(transform_direction_transposed(&itfm, Ng));
+	}
+
+	/* look at the surface from the front */
+	shader_setup_from_sample(kg, sd, P, Ng, Ng, shader, (instanced)? object: ~object,
+		prim, u, v, 0.0f, TIME_INVALID, 0, ~0);
+}
+
+/* Light arriving at the surface point, starting the path at the surface
+ * instead of at the camera, using the regular path integration for the
+ * direct light and indirect bounces */
+
+__device float3 kernel_bake_combined(KernelGlobals *kg, ShaderData *sd, RNG *rng, int sample, int num_samples)
+{
+	PathRadiance L;
+	PathState state;
+	float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
+	float min_ray_pdf = FLT_MAX;
+	float ray_pdf = 0.0f;
+	float ray_t = 0.0f;
+	int rng_offset = PRNG_BASE_NUM;
+
+	path_radiance_init(&L, kernel_data.film.use_light_pass);
+	path_state_init(&state);
+
+	float rbsdf = path_rng_1D(kg, rng, sample, num_samples, rng_offset + PRNG_BSDF);
+	shader_eval_surface(kg, sd, rbsdf, state.flag, SHADER_CONTEXT_MAIN);
+
+#ifdef __EMISSION__
+	/* emission, seen directly so no MIS */
+	if(sd->flag & SD_EMISSION) {
+		float3 emission = indirect_primitive_emission(kg, sd, 0.0f, state.flag, ray_pdf);
+		path_radiance_accum_emission(&L, throughput, emission, state.bounce);
+	}
+#endif
+
+	/* direct light and first bounce */
+	Ray ray;
+
+	ray.t = FLT_MAX;
+#ifdef __OBJECT_MOTION__
+	ray.time = sd->time;
+#endif
+
+	if(kernel_path_integrate_lighting(kg, rng, sample, num_samples, sd,
+		&throughput, &min_ray_pdf, &ray_pdf, &state, rng_offset, &L, &ray, &ray_t))
+	{
+		/* indirect light */
+		kernel_path_indirect(kg, rng, sample, ray, NULL,
+			throughput, num_samples, num_samples,
+			min_ray_pdf, ray_pdf, state, rng_offset + PRNG_BOUNCE_NUM, &L);
+	}
+
+	float3 L_sum = path_radiance_sum(kg, &L);
+
+#ifdef __CLAMP_SAMPLE__
+	path_radiance_clamp(&L, &L_sum, kernel_data.integrator.sample_clamp);
+#endif
+
+	return L_sum;
+}
+
+/* Fraction of the hemisphere above the surface point that is not occluded
+ * within the ambient occlusion distance */
+
+__device float3 kernel_bake_ao(KernelGlobals *kg, ShaderData *sd, RNG *rng, int sample, int num_samples)
+{
+	PathState state;
+	float bsdf_u, bsdf_v;
+	float3 ao_D;
+	float ao_pdf;
+
+	path_state_init(&state);
+	path_rng_2D(kg, rng, sample, num_samples, PRNG_BASE_NUM + PRNG_BSDF_U, &bsdf_u, &bsdf_v);
+	sample_cos_hemisphere(sd->N, bsdf_u, bsdf_v, &ao_D, &ao_pdf);
+
+	if(dot(sd->Ng, ao_D) <= 0.0f || ao_pdf == 0.0f)
+		return make_float3(0.0f, 0.0f, 0.0f);
+
+	Ray light_ray;
+	float3 ao_shadow;
+
+	light_ray.P = ray_offset(sd->P, sd->Ng);
+	light_ray.D = ao_D;
+	light_ray.t = kernel_data.background.ao_distance;
+#ifdef __OBJECT_MOTION__
+	light_ray.time = sd->time;
+#endif
+#ifdef __RAY_DIFFERENTIALS__
+	light_ray.dP = sd->dP;
+	light_ray.dD = differential3_zero();
+#endif
+
+	if(shadow_blocked(kg, &state, &light_ray, &ao_shadow))
+		return make_float3(0.0f, 0.0f, 0.0f);
+
+	return ao_shadow;
+}
+
+__device void kernel_bake_evaluate(KernelGlobals *kg, __global uint4 *input, __global float4 *output, ShaderEvalType type, int i, int sample)
+{
+	uint4 in = input[i];
+	float3 out = make_float3(0.0f, 0.0f, 0.0f);
+
+	/* texels not covered by any triangle have no primitive */
+	if(in.y != ~0) {
+		ShaderData sd;
+		int object = in.x;
+		int prim = in.y;
+		float u = __uint_as_float(in.z);
+		float v = __uint_as_float(in.w);
+
+#ifdef __CMJ__
+		int num_samples = kernel_data.integrator.aa_samples;
+#else
+		int num_samples = 0;
+#endif
+		RNG rng = cmj_hash(i, kernel_data.integrator.seed);
+
+		shader_setup_from_bake(kg, &sd, object, prim, u, v);
+
+		switch(type) {
+			case SHADER_EVAL_COMBINED:
+				out = kernel_bake_combined(kg, &sd, &rng, sample, num_samples);
+				break;
+			case SHADER_EVAL_AO:
+				out = kernel_bake_ao(kg, &sd, &rng, sample, num_samples);
+				break;
+			case SHADER_EVAL_NORMAL:
+			case SHADER_EVAL_NORMAL_OBJECT: {
+				/* shading normal, including bump mapping */
+				float rbsdf = path_rng_1D(kg, &rng, sample, num_samples, PRNG_BASE_NUM + PRNG_BSDF);
+				shader_eval_surface(kg, &sd, rbsdf, PATH_RAY_CAMERA, SHADER_CONTEXT_MAIN);
+
+				out = sd.N;
+
+				if(type == SHADER_EVAL_NORMAL_OBJECT)
+					object_inverse_normal_transform(kg, &sd, &out);
+				break;
+			}
+			case SHADER_EVAL_DIFFUSE_COLOR: {
+				float rbsdf = path_rng_1D(kg, &rng, sample, num_samples, PRNG_BASE_NUM + PRNG_BSDF);
+				shader_eval_surface(kg, &sd, rbsdf, PATH_RAY_CAMERA, SHADER_CONTEXT_MAIN);
+
+				out = shader_bsdf_diffuse(kg, &sd);
+				break;
+			}
+			case SHADER_EVAL_EMISSION: {
+				float rbsdf = path_rng_1D(kg, &rng, sample, num_samples, PRNG_BASE_NUM + PRNG_BSDF);
+				shader_eval_surface(kg, &sd, rbsdf, PATH_RAY_CAMERA, SHADER_CONTEXT_MAIN);
+
+				if(sd.flag & SD_EMISSION)
+					out = shader_emissive_eval(kg, &sd);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	/* accumulate samples, w counts the samples so the result can be
+	 * normalized after the last one */
+	float4 result = make_float4(out.x, out.y, out.z, 1.0f);
+
+	if(sample == 0)
+		output[i] = result;
+	else
+		output[i] += result;
+}
+
+#endif
+
+CCL_NAMESPACE_END
+
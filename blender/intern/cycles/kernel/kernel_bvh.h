@@ -33,6 +33,11 @@ CCL_NAMESPACE_BEGIN
 #define BVH_NODE_SIZE 4
 #define TRI_NODE_SIZE 3
 
+/* QBVH nodes push up to three children per level, so they need a bigger
+ * stack even though the tree is half as deep */
+#define BVH_QSTACK_SIZE 384
+#define BVH_QNODE_SIZE 8
+
 /* silly workaround for float extended precision that happens when compiling
  * without sse support on x86, it results in different results for float ops
  * that you would otherwise expect to compare correctly */
@@ -744,6 +749,148 @@ __device_inline void bvh_triangle_intersect_subsurface(KernelGlobals *kg, Inters
 }
 #endif
 
+#ifdef __QBVH__
+
+/* QBVH Utilities
+ *
+ * Each QBVH node is 8x float4: min/max x, min/max y and min/max z of the four
+ * children, followed by the child indices and child visibility flags. Ray
+ * parameters are splatted across SSE registers once and then reused for
+ * every node, until an instance push or pop changes them. */
+
+typedef struct QBVHRay {
+	__m128 P[3];
+	__m128 idir[3];
+	int near_x, near_y, near_z;
+	int far_x, far_y, far_z;
+} QBVHRay;
+
+__device_inline void qbvh_ray_setup(QBVHRay *qray, float3 P, float3 idir)
+{
+	qray->P[0] = _mm_set_ps1(P.x);
+	qray->P[1] = _mm_set_ps1(P.y);
+	qray->P[2] = _mm_set_ps1(P.z);
+
+	qray->idir[0] = _mm_set_ps1(idir.x);
+	qray->idir[1] = _mm_set_ps1(idir.y);
+	qray->idir[2] = _mm_set_ps1(idir.z);
+
+	/* pick the near and far planes depending on the ray direction, so we
+	 * don't need a min/max per axis during traversal */
+	qray->near_x = (idir.x >= 0.0f)? 0: 1;
+	qray->near_y = (idir.y >= 0.0f)? 2: 3;
+	qray->near_z = (idir.z >= 0.0f)? 4: 5;
+	qray->far_x = qray->near_x ^ 1;
+	qray->far_y = qray->near_y ^ 1;
+	qray->far_z = qray->near_z ^ 1;
+}
+
+__device_inline int qbvh_node_visibility_mask(const __m128 *bvh_nodes, const uint visibility)
+{
+#ifdef __VISIBILITY_FLAG__
+	const __m128i vis = _mm_and_si128(_mm_castps_si128(bvh_nodes[7]), _mm_set1_epi32(visibility));
+	return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(vis, _mm_setzero_si128()))) & 0xf;
+#else
+	return 0xf;
+#endif
+}
+
+/* Intersect ray against the four child boxes, returns a bitmask of the hit
+ * children and their entry distances */
+__device_inline int qbvh_node_intersect(KernelGlobals *kg, const int nodeAddr, const QBVHRay *qray,
+	const float t, const uint visibility, __m128 *dist)
+{
+	const __m128 *bvh_nodes = (__m128*)kg->__bvh_nodes.data + nodeAddr*BVH_QNODE_SIZE;
+
+	const __m128 tnear_x = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_x], qray->P[0]), qray->idir[0]);
+	const __m128 tnear_y = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_y], qray->P[1]), qray->idir[1]);
+	const __m128 tnear_z = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_z], qray->P[2]), qray->idir[2]);
+	const __m128 tfar_x = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_x], qray->P[0]), qray->idir[0]);
+	const __m128 tfar_y = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_y], qray->P[1]), qray->idir[1]);
+	const __m128 tfar_z = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_z], qray->P[2]), qray->idir[2]);
+
+	const __m128 tnear = _mm_max_ps(_mm_max_ps(tnear_x, tnear_y), _mm_max_ps(tnear_z, _mm_setzero_ps()));
+	const __m128 tfar = _mm_min_ps(_mm_min_ps(tfar_x, tfar_y), _mm_min_ps(tfar_z, _mm_set_ps1(t)));
+
+	*dist = tnear;
+
+	return _mm_movemask_ps(_mm_cmple_ps(tnear, tfar)) & qbvh_node_visibility_mask(bvh_nodes, visibility);
+}
+
+#ifdef __HAIR__
+/* Same as above, but with the boxes of curve children enlarged for the
+ * minimum hair width */
+__device_inline int qbvh_node_intersect_hair(KernelGlobals *kg, const int nodeAddr, const QBVHRay *qray,
+	const float t, const uint visibility, float difl, float extmax, __m128 *dist)
+{
+	const __m128 *bvh_nodes = (__m128*)kg->__bvh_nodes.data + nodeAddr*BVH_QNODE_SIZE;
+
+	const __m128 tnear_x = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_x], qray->P[0]), qray->idir[0]);
+	const __m128 tnear_y = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_y], qray->P[1]), qray->idir[1]);
+	const __m128 tnear_z = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->near_z], qray->P[2]), qray->idir[2]);
+	const __m128 tfar_x = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_x], qray->P[0]), qray->idir[0]);
+	const __m128 tfar_y = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_y], qray->P[1]), qray->idir[1]);
+	const __m128 tfar_z = _mm_mul_ps(_mm_sub_ps(bvh_nodes[qray->far_z], qray->P[2]), qray->idir[2]);
+
+	__m128 tnear = _mm_max_ps(_mm_max_ps(tnear_x, tnear_y), _mm_max_ps(tnear_z, _mm_setzero_ps()));
+	__m128 tfar = _mm_min_ps(_mm_min_ps(tfar_x, tfar_y), _mm_min_ps(tfar_z, _mm_set_ps1(t)));
+
+	/* enlarge only the children containing curves */
+	const __m128i curve_flag = _mm_set1_epi32(PATH_RAY_CURVE);
+	const __m128 curve = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(bvh_nodes[7]), curve_flag), curve_flag));
+
+	const __m128 tnear_curve = _mm_max_ps(_mm_mul_ps(_mm_set_ps1(1.0f - difl), tnear), _mm_sub_ps(tnear, _mm_set_ps1(extmax)));
+	const __m128 tfar_curve = _mm_min_ps(_mm_mul_ps(_mm_set_ps1(1.0f + difl), tfar), _mm_add_ps(tfar, _mm_set_ps1(extmax)));
+
+	tnear = _mm_or_ps(_mm_and_ps(curve, tnear_curve), _mm_andnot_ps(curve, tnear));
+	tfar = _mm_or_ps(_mm_and_ps(curve, tfar_curve), _mm_andnot_ps(curve, tfar));
+
+	*dist = tnear;
+
+	return _mm_movemask_ps(_mm_cmple_ps(tnear, tfar)) & qbvh_node_visibility_mask(bvh_nodes, visibility);
+}
+#endif
+
+/* Push the hit children of a node on the traversal stack sorted by distance,
+ * farthest first, and return the closest child to continue traversal with */
+__device_inline int qbvh_node_push_children(KernelGlobals *kg, const int nodeAddr, int mask, const __m128 dist,
+	int *traversalStack, int *stackPtr)
+{
+	const float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_QNODE_SIZE+6);
+
+	union { __m128 m128; float v[4]; } udist;
+	udist.m128 = dist;
+
+	int child[4];
+	float child_dist[4];
+	int num_child = 0;
+
+	/* insertion sort, at most four children */
+	for(int i = 0; i < 4; i++) {
+		if(mask & (1 << i)) {
+			int j = num_child++;
+
+			while(j > 0 && child_dist[j-1] < udist.v[i]) {
+				child[j] = child[j-1];
+				child_dist[j] = child_dist[j-1];
+				j--;
+			}
+
+			child[j] = __float_as_int(cnodes[i]);
+			child_dist[j] = udist.v[i];
+		}
+	}
+
+	for(int i = 0; i < num_child-1; i++) {
+		++(*stackPtr);
+		traversalStack[*stackPtr] = child[i];
+	}
+
+	return child[num_child-1];
+}
+
+#endif /* __QBVH__ */
+
 /* BVH intersection function variations */
 
 #define BVH_INSTANCING			1
@@ -809,6 +956,132 @@ __device_inline void bvh_triangle_intersect_subsurface(KernelGlobals *kg, Inters
 #include "kernel_bvh_subsurface.h"
 #endif
 
+#if defined(__QBVH__)
+#define BVH_FUNCTION_NAME qbvh_intersect
+#define BVH_FUNCTION_FEATURES 0
+#include "kernel_qbvh_traversal.h"
+#endif
+
+#if defined(__QBVH__) && defined(__INSTANCING__)
+#define BVH_FUNCTION_NAME qbvh_intersect_instancing
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING
+#include "kernel_qbvh_traversal.h"
+#endif
+
+#if defined(__QBVH__) && defined(__HAIR__)
+#define BVH_FUNCTION_NAME qbvh_intersect_hair
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_HAIR|BVH_HAIR_MINIMUM_WIDTH
+#include "kernel_qbvh_traversal.h"
+#endif
+
+#if defined(__QBVH__) && defined(__OBJECT_MOTION__)
+#define BVH_FUNCTION_NAME qbvh_intersect_motion
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_MOTION
+#include "kernel_qbvh_traversal.h"
+#endif
+
+#if defined(__QBVH__) && defined(__HAIR__) && defined(__OBJECT_MOTION__)
+#define BVH_FUNCTION_NAME qbvh_intersect_hair_motion
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_HAIR|BVH_HAIR_MINIMUM_WIDTH|BVH_MOTION
+#include "kernel_qbvh_traversal.h"
+#endif
+
+#if defined(__QBVH__) && defined(__SUBSURFACE__)
+#define BVH_FUNCTION_NAME qbvh_intersect_subsurface
+#define BVH_FUNCTION_FEATURES 0
+#include "kernel_qbvh_subsurface.h"
+#endif
+
+#if defined(__QBVH__) && defined(__SUBSURFACE__) && defined(__INSTANCING__)
+#define BVH_FUNCTION_NAME qbvh_intersect_subsurface_instancing
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING
+#include "kernel_qbvh_subsurface.h"
+#endif
+
+#if defined(__QBVH__) && defined(__SUBSURFACE__) && defined(__HAIR__)
+#define BVH_FUNCTION_NAME qbvh_intersect_subsurface_hair
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_HAIR
+#include "kernel_qbvh_subsurface.h"
+#endif
+
+#if defined(__QBVH__) && defined(__SUBSURFACE__) && defined(__OBJECT_MOTION__)
+#define BVH_FUNCTION_NAME qbvh_intersect_subsurface_motion
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_MOTION
+#include "kernel_qbvh_subsurface.h"
+#endif
+
+#if defined(__QBVH__) && defined(__SUBSURFACE__) && defined(__HAIR__) && defined(__OBJECT_MOTION__)
+#define BVH_FUNCTION_NAME qbvh_intersect_subsurface_hair_motion
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING|BVH_HAIR|BVH_MOTION
+#include "kernel_qbvh_subsurface.h"
+#endif
+
+#ifdef __RAY_PACKETS__
+#include "kernel_bvh_packet.h"
+#endif
+
+#ifdef __QBVH__
+/* QBVH is only used on the CPU, so there's no need for the GPU specific
+ * dispatching done below */
+#ifdef __HAIR__
+__device_inline bool qbvh_scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, Intersection *isect, uint *lcg_state, float difl, float extmax)
+#else
+__device_inline bool qbvh_scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, Intersection *isect)
+#endif
+{
+#ifdef __OBJECT_MOTION__
+	if(kernel_data.bvh.have_motion) {
+#ifdef __HAIR__
+		if(kernel_data.bvh.have_curves)
+			return qbvh_intersect_hair_motion(kg, ray, isect, visibility, lcg_state, difl, extmax);
+#endif /* __HAIR__ */
+
+		return qbvh_intersect_motion(kg, ray, isect, visibility);
+	}
+#endif /* __OBJECT_MOTION__ */
+
+#ifdef __HAIR__
+	if(kernel_data.bvh.have_curves)
+		return qbvh_intersect_hair(kg, ray, isect, visibility, lcg_state, difl, extmax);
+#endif /* __HAIR__ */
+
+#ifdef __INSTANCING__
+	if(kernel_data.bvh.have_instancing)
+		return qbvh_intersect_instancing(kg, ray, isect, visibility);
+#endif /* __INSTANCING__ */
+
+	return qbvh_intersect(kg, ray, isect, visibility);
+}
+
+#ifdef __SUBSURFACE__
+__device_inline uint qbvh_scene_intersect_subsurface(KernelGlobals *kg, const Ray *ray, Intersection *isect, int subsurface_object, uint *lcg_state, int max_hits)
+{
+#ifdef __OBJECT_MOTION__
+	if(kernel_data.bvh.have_motion) {
+#ifdef __HAIR__
+		if(kernel_data.bvh.have_curves)
+			return qbvh_intersect_subsurface_hair_motion(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+#endif /* __HAIR__ */
+
+		return qbvh_intersect_subsurface_motion(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+	}
+#endif /* __OBJECT_MOTION__ */
+
+#ifdef __HAIR__
+	if(kernel_data.bvh.have_curves)
+		return qbvh_intersect_subsurface_hair(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+#endif /* __HAIR__ */
+
+#ifdef __INSTANCING__
+	if(kernel_data.bvh.have_instancing)
+		return qbvh_intersect_subsurface_instancing(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+#endif /* __INSTANCING__ */
+
+	return qbvh_intersect_subsurface(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+}
+#endif /* __SUBSURFACE__ */
+#endif /* __QBVH__ */
+
 /* to work around titan bug when using arrays instead of textures */
 #if !defined(__KERNEL_CUDA__) || defined(__KERNEL_CUDA_TEX_STORAGE__)
 __device_inline
@@ -821,6 +1094,27 @@ bool scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, I
 bool scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, Intersection *isect)
 #endif
 {
+#ifdef __RAY_PACKETS__
+	/* camera ray was already traced as part of a packet */
+	if(kg->packet_isect) {
+		*isect = *kg->packet_isect;
+		kg->packet_isect = NULL;
+		return (isect->prim != ~0);
+	}
+#endif
+
+	kernel_stats_ray(kg, visibility);
+
+#ifdef __QBVH__
+	if(kernel_data.bvh.use_qbvh) {
+#ifdef __HAIR__
+		return qbvh_scene_intersect(kg, ray, visibility, isect, lcg_state, difl, extmax);
+#else
+		return qbvh_scene_intersect(kg, ray, visibility, isect);
+#endif
+	}
+#endif /* __QBVH__ */
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -865,6 +1159,13 @@ __device_noinline
 #endif
 uint scene_intersect_subsurface(KernelGlobals *kg, const Ray *ray, Intersection *isect, int subsurface_object, uint *lcg_state, int max_hits)
 {
+	kernel_stats_subsurface_ray(kg);
+
+#ifdef __QBVH__
+	if(kernel_data.bvh.use_qbvh)
+		return qbvh_scene_intersect_subsurface(kg, ray, isect, subsurface_object, lcg_state, max_hits);
+#endif /* __QBVH__ */
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Ray Packet Traversal
+ *
+ * Traverses a packet of coherent rays through the BVH together, so node data
+ * is fetched and the traversal decisions are made once for the whole packet
+ * instead of once per ray. Ray box tests are done four rays at a time with
+ * SSE. Rays in a packet are expected to have the same direction signs, which
+ * the caller ensures by grouping rays by octant.
+ *
+ * Each stack entry stores the first ray that hit the node, rays before it
+ * missed the node and are skipped for the entire subtree. Only the binary
+ * BVH without instancing, motion blur or hair is supported, other scenes use
+ * single ray traversal. */
+
+#define RAY_PACKET_SIZE (RAY_PACKET_WIDTH*RAY_PACKET_WIDTH)
+
+typedef struct RayPacket {
+	/* rays in SoA layout, padded to a multiple of four with inactive
+	 * rays, all rays with negative t are inactive */
+	float P[3][RAY_PACKET_SIZE];
+	float idir[3][RAY_PACKET_SIZE];
+	float t[RAY_PACKET_SIZE];
+	int num_rays;
+} RayPacket;
+
+__device_inline bool bvh_packet_supported(KernelGlobals *kg)
+{
+	return !(kernel_data.bvh.use_qbvh ||
+	         kernel_data.bvh.have_motion ||
+	         kernel_data.bvh.have_curves ||
+	         kernel_data.bvh.have_instancing);
+}
+
+__device_inline void bvh_packet_init(RayPacket *packet)
+{
+	packet->num_rays = 0;
+}
+
+__device_inline void bvh_packet_add_ray(RayPacket *packet, const Ray *ray)
+{
+	int i = packet->num_rays++;
+	float3 idir = bvh_inverse_direction(ray->D);
+
+	packet->P[0][i] = ray->P.x;
+	packet->P[1][i] = ray->P.y;
+	packet->P[2][i] = ray->P.z;
+	packet->idir[0][i] = idir.x;
+	packet->idir[1][i] = idir.y;
+	packet->idir[2][i] = idir.z;
+
+	/* camera rays with zero length were not generated, skip them */
+	packet->t[i] = (ray->t != 0.0f)? ray->t: -1.0f;
+}
+
+__device_inline void bvh_packet_pad(RayPacket *packet)
+{
+	while(packet->num_rays & 3) {
+		int i = packet->num_rays++;
+
+		for(int a = 0; a < 3; a++) {
+			packet->P[a][i] = 0.0f;
+			packet->idir[a][i] = 1.0f;
+		}
+
+		packet->t[i] = -1.0f;
+	}
+}
+
+/* find the first ray starting from first that hits the box, or num_rays if
+ * none of the rays do */
+__device_inline int bvh_packet_first_hit(const RayPacket *packet, int first, const float bmin[3], const float bmax[3])
+{
+	int num_rays = packet->num_rays;
+
+#ifdef __KERNEL_SSE2__
+	const __m128 zero = _mm_setzero_ps();
+
+	for(int i = first & ~3; i < num_rays; i += 4) {
+		__m128 tmin = zero;
+		__m128 tmax = _mm_loadu_ps(&packet->t[i]);
+
+		for(int a = 0; a < 3; a++) {
+			__m128 P = _mm_loadu_ps(&packet->P[a][i]);
+			__m128 idir = _mm_loadu_ps(&packet->idir[a][i]);
+			__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(bmin[a]), P), idir);
+			__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(bmax[a]), P), idir);
+
+			tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+			tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+		}
+
+		int mask = _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+
+		/* rays before first already missed a parent node */
+		if(i < first)
+			mask &= ~((1 << (first - i)) - 1);
+
+		if(mask) {
+			int j = 0;
+			while(!(mask & (1 << j)))
+				j++;
+			return i + j;
+		}
+	}
+#else
+	for(int i = first; i < num_rays; i++) {
+		float tmin = 0.0f;
+		float tmax = packet->t[i];
+
+		for(int a = 0; a < 3; a++) {
+			NO_EXTENDED_PRECISION float t0 = (bmin[a] - packet->P[a][i]) * packet->idir[a][i];
+			NO_EXTENDED_PRECISION float t1 = (bmax[a] - packet->P[a][i]) * packet->idir[a][i];
+
+			tmin = max(tmin, min(t0, t1));
+			tmax = min(tmax, max(t0, t1));
+		}
+
+		if(tmin <= tmax)
+			return i;
+	}
+#endif
+
+	return num_rays;
+}
+
+__device void bvh_intersect_packet(KernelGlobals *kg, RayPacket *packet, Intersection *isects, const uint visibility)
+{
+	/* traversal stack, with first active ray for each node */
+	int traversalStack[BVH_STACK_SIZE];
+	int firstStack[BVH_STACK_SIZE];
+	traversalStack[0] = ENTRYPOINT_SENTINEL;
+	firstStack[0] = 0;
+
+	int stackPtr = 0;
+	int nodeAddr = kernel_data.bvh.root;
+	int first = 0;
+	int num_rays = packet->num_rays;
+
+	for(int i = 0; i < num_rays; i++) {
+		isects[i].t = packet->t[i];
+		isects[i].object = ~0;
+		isects[i].prim = ~0;
+		isects[i].u = 0.0f;
+		isects[i].v = 0.0f;
+
+		if(packet->t[i] >= 0.0f)
+			kernel_stats_ray(kg, visibility);
+	}
+
+	while(nodeAddr != ENTRYPOINT_SENTINEL) {
+		if(nodeAddr >= 0) {
+			/* inner node, find first ray hitting each child */
+			kernel_stats_bvh_node(kg);
+
+			float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
+			float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
+			float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
+			float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+3);
+
+			float c0min[3] = {node0.x, node1.x, node2.x};
+			float c0max[3] = {node0.z, node1.z, node2.z};
+			float c1min[3] = {node0.y, node1.y, node2.y};
+			float c1max[3] = {node0.w, node1.w, node2.w};
+
+			int first0 = num_rays;
+			int first1 = num_rays;
+
+#ifdef __VISIBILITY_FLAG__
+			if(__float_as_uint(cnodes.z) & visibility)
+#endif
+				first0 = bvh_packet_first_hit(packet, first, c0min, c0max);
+
+#ifdef __VISIBILITY_FLAG__
+			if(__float_as_uint(cnodes.w) & visibility)
+#endif
+				first1 = bvh_packet_first_hit(packet, first, c1min, c1max);
+
+			int nodeAddrChild0 = __float_as_int(cnodes.x);
+			int nodeAddrChild1 = __float_as_int(cnodes.y);
+
+			if(first0 < num_rays && first1 < num_rays) {
+				/* both children were hit, continue with the one hit by the
+				 * earliest ray in the packet and push the other */
+				if(first1 < first0) {
+					int tmp = nodeAddrChild0;
+					nodeAddrChild0 = nodeAddrChild1;
+					nodeAddrChild1 = tmp;
+
+					tmp = first0;
+					first0 = first1;
+					first1 = tmp;
+				}
+
+				++stackPtr;
+				traversalStack[stackPtr] = nodeAddrChild1;
+				firstStack[stackPtr] = first1;
+
+				nodeAddr = nodeAddrChild0;
+				first = first0;
+			}
+			else if(first0 < num_rays) {
+				nodeAddr = nodeAddrChild0;
+				first = first0;
+			}
+			else if(first1 < num_rays) {
+				nodeAddr = nodeAddrChild1;
+				first = first1;
+			}
+			else {
+				nodeAddr = traversalStack[stackPtr];
+				first = firstStack[stackPtr];
+				--stackPtr;
+			}
+		}
+		else {
+			/* leaf node, intersect triangles with all active rays */
+			float4 leaf = kernel_tex_fetch(__bvh_nodes, (-nodeAddr-1)*BVH_NODE_SIZE+(BVH_NODE_SIZE-1));
+			int primAddr = __float_as_int(leaf.x);
+			int primAddr2 = __float_as_int(leaf.y);
+
+			for(int i = first; i < num_rays; i++) {
+				if(packet->t[i] < 0.0f)
+					continue;
+
+				float3 P = make_float3(packet->P[0][i], packet->P[1][i], packet->P[2][i]);
+				float3 idir = make_float3(packet->idir[0][i], packet->idir[1][i], packet->idir[2][i]);
+
+				for(int prim = primAddr; prim < primAddr2; prim++) {
+					if(bvh_triangle_intersect(kg, &isects[i], P, idir, visibility, ~0, prim)) {
+						if(visibility == PATH_RAY_SHADOW_OPAQUE) {
+							/* shadow ray early termination */
+							packet->t[i] = -1.0f;
+							break;
+						}
+
+						packet->t[i] = isects[i].t;
+					}
+				}
+			}
+
+			/* pop */
+			nodeAddr = traversalStack[stackPtr];
+			first = firstStack[stackPtr];
+			--stackPtr;
+		}
+	}
+}
+
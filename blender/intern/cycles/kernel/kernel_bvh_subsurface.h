@@ -89,6 +89,8 @@ __device uint BVH_FUNCTION_NAME(KernelGlobals *kg, const Ray *ray, Intersection
 			/* traverse internal nodes */
 			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL)
 			{
+				kernel_stats_bvh_node(kg);
+
 				bool traverseChild0, traverseChild1;
 				int nodeAddrChild1;
 
@@ -98,6 +98,8 @@ __device bool BVH_FUNCTION_NAME
 			/* traverse internal nodes */
 			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL)
 			{
+				kernel_stats_bvh_node(kg);
+
 				bool traverseChild0, traverseChild1;
 				int nodeAddrChild1;
 
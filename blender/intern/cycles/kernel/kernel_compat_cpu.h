@@ -127,6 +127,24 @@ template<typename T> struct texture_image  {
 	int width, height;
 };
 
+/* Image Cache
+ *
+ * Interface for image textures that are not kept in memory entirely, but
+ * loaded on demand in tiles on the host side. Used for images for which no
+ * texture data was copied to the kernel. */
+
+struct KernelImageCacheThreadData;
+
+class KernelImageCache {
+public:
+	virtual ~KernelImageCache() {}
+
+	virtual KernelImageCacheThreadData *thread_init() = 0;
+	virtual void thread_free(KernelImageCacheThreadData *tdata) = 0;
+
+	virtual float4 interp(KernelImageCacheThreadData *tdata, int id, float x, float y) = 0;
+};
+
 typedef texture<float4> texture_float4;
 typedef texture<float2> texture_float2;
 typedef texture<float> texture_float;
@@ -143,7 +161,7 @@ typedef texture_image<uchar4> texture_image_uchar4;
 #define kernel_tex_fetch_m128(tex, index) (kg->tex.fetch_m128(index))
 #define kernel_tex_fetch_m128i(tex, index) (kg->tex.fetch_m128i(index))
 #define kernel_tex_lookup(tex, t, offset, size) (kg->tex.lookup(t, offset, size))
-#define kernel_tex_image_interp(tex, x, y) ((tex < MAX_FLOAT_IMAGES) ? kg->texture_float_images[tex].interp(x, y) : kg->texture_byte_images[tex - MAX_FLOAT_IMAGES].interp(x, y))
+#define kernel_tex_image_interp(tex, x, y) kernel_tex_image_interp_cpu(kg, tex, x, y)
 
 #define kernel_data (kg->__data)
 
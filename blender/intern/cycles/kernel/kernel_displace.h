@@ -16,8 +16,15 @@
 
 CCL_NAMESPACE_BEGIN
 
-__device void kernel_shader_evaluate(KernelGlobals *kg, __global uint4 *input, __global float4 *output, ShaderEvalType type, int i)
+__device void kernel_shader_evaluate(KernelGlobals *kg, __global uint4 *input, __global float4 *output, ShaderEvalType type, int i, int sample)
 {
+#ifdef __BAKING__
+	if(type >= SHADER_EVAL_BAKE) {
+		kernel_bake_evaluate(kg, input, output, type, i, sample);
+		return;
+	}
+#endif
+
 	ShaderData sd;
 	uint4 in = input[i];
 	float3 out;
@@ -172,7 +172,8 @@ __device_noinline float3 indirect_primitive_emission(KernelGlobals *kg, ShaderDa
 #endif
 		/* multiple importance sampling, get triangle light pdf,
 		 * and compute weight with respect to BSDF pdf */
-		float pdf = triangle_light_pdf(kg, sd->Ng, sd->I, t);
+		float area_pdf = triangle_light_area_pdf(kg, sd->P + sd->I*t, sd->object, sd->prim);
+		float pdf = triangle_light_pdf(kg, area_pdf, sd->Ng, sd->I, t);
 		float mis_weight = power_heuristic(bsdf_pdf, pdf);
 
 		return L*mis_weight;
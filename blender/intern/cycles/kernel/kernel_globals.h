@@ -16,6 +16,10 @@
 
 /* Constant Globals */
 
+#ifdef __KERNEL_STATS__
+#include "util_stats.h"
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 /* On the CPU, we pass along the struct KernelGlobals to nearly everywhere in
@@ -31,6 +35,8 @@ struct OSLThreadData;
 struct OSLShadingSystem;
 #endif
 
+class RenderCounters;
+
 #define MAX_BYTE_IMAGES   512
 #define MAX_FLOAT_IMAGES  5
 
@@ -44,6 +50,17 @@ typedef struct KernelGlobals {
 
 	KernelData __data;
 
+	/* images loaded on demand, used when there is no texture data */
+	KernelImageCache *image_cache;
+	KernelImageCacheThreadData *image_cache_tdata;
+
+	/* per thread render statistics, only used with __KERNEL_STATS__ */
+	RenderCounters *counters;
+
+	/* intersection of the camera ray found by packet traversal, used by
+	 * the next scene intersection instead of tracing the ray again */
+	const Intersection *packet_isect;
+
 #ifdef __OSL__
 	/* On the CPU, we also have the OSL globals here. Most data structures are shared
 	 * with SVM, the difference is in the shaders and object/mesh attributes. */
@@ -54,6 +71,20 @@ typedef struct KernelGlobals {
 
 } KernelGlobals;
 
+__device_inline float4 kernel_tex_image_interp_cpu(KernelGlobals *kg, int id, float x, float y)
+{
+	if(id < MAX_FLOAT_IMAGES) {
+		if(kg->texture_float_images[id].data || !kg->image_cache)
+			return kg->texture_float_images[id].interp(x, y);
+	}
+	else {
+		if(kg->texture_byte_images[id - MAX_FLOAT_IMAGES].data || !kg->image_cache)
+			return kg->texture_byte_images[id - MAX_FLOAT_IMAGES].interp(x, y);
+	}
+
+	return kg->image_cache->interp(kg->image_cache_tdata, id, x, y);
+}
+
 #endif
 
 /* For CUDA, constant memory textures must be globals, so we can't put them
@@ -90,6 +121,43 @@ typedef struct KernelGlobals {
 
 #endif
 
+/* Render Statistics
+ *
+ * Counters for profiling the kernel, gathered per thread on the CPU when
+ * built with WITH_CYCLES_STATS. Otherwise these compile to nothing. */
+
+#ifdef __KERNEL_STATS__
+
+__device_inline int kernel_stats_shader_index(int shader)
+{
+	return min(shader & SHADER_MASK, (int)RenderCounters::MAX_SHADERS - 1);
+}
+
+__device_inline void kernel_stats_ray(KernelGlobals *kg, uint visibility)
+{
+	if(visibility & PATH_RAY_SHADOW)
+		kg->counters->num_rays[RenderCounters::RAY_SHADOW]++;
+	else if(visibility & PATH_RAY_CAMERA)
+		kg->counters->num_rays[RenderCounters::RAY_CAMERA]++;
+	else
+		kg->counters->num_rays[RenderCounters::RAY_INDIRECT]++;
+}
+
+#define kernel_stats_subsurface_ray(kg) ((kg)->counters->num_rays[RenderCounters::RAY_SUBSURFACE]++)
+#define kernel_stats_bvh_node(kg) ((kg)->counters->num_bvh_nodes++)
+#define kernel_stats_shader_eval(kg, shader) ((kg)->counters->num_shader_evals[kernel_stats_shader_index(shader)]++)
+#define kernel_stats_svm_node(kg, shader) ((kg)->counters->num_svm_nodes[kernel_stats_shader_index(shader)]++)
+
+#else
+
+#define kernel_stats_ray(kg, visibility)
+#define kernel_stats_subsurface_ray(kg)
+#define kernel_stats_bvh_node(kg)
+#define kernel_stats_shader_eval(kg, shader)
+#define kernel_stats_svm_node(kg, shader)
+
+#endif
+
 /* Interpolated lookup table access */
 
 __device float lookup_table_read(KernelGlobals *kg, float x, int offset, int size)
@@ -457,10 +457,9 @@ __device void triangle_light_sample(KernelGlobals *kg, int prim, int object,
 	object_transform_light_sample(kg, ls, object, time);
 }
 
-__device float triangle_light_pdf(KernelGlobals *kg,
+__device float triangle_light_pdf(KernelGlobals *kg, float pdf,
 	const float3 Ng, const float3 I, float t)
 {
-	float pdf = kernel_data.integrator.pdf_triangles;
 	float cos_pi = fabsf(dot(Ng, I));
 
 	if(cos_pi == 0.0f)
@@ -515,14 +514,14 @@ __device void curve_segment_light_sample(KernelGlobals *kg, int prim, int object
 
 /* Light Distribution */
 
-__device int light_distribution_sample(KernelGlobals *kg, float randt)
+__device int light_distribution_sample_range(KernelGlobals *kg, float randt, int start, int num)
 {
 	/* this is basically std::upper_bound as used by pbrt, to find a point light or
 	 * triangle to emit from, proportional to area. a good improvement would be to
 	 * also sample proportional to power, though it's not so well defined with
 	 * OSL shaders. */
-	int first = 0;
-	int len = kernel_data.integrator.num_distribution + 1;
+	int first = start;
+	int len = num + 1;
 
 	while(len > 0) {
 		int half_len = len >> 1;
@@ -539,7 +538,172 @@ __device int light_distribution_sample(KernelGlobals *kg, float randt)
 
 	/* clamping should not be needed but float rounding errors seem to
 	 * make this fail on rare occasions */
-	return clamp(first-1, 0, kernel_data.integrator.num_distribution-1);
+	return clamp(first-1, start, start+num-1);
+}
+
+__device int light_distribution_sample(KernelGlobals *kg, float randt)
+{
+	return light_distribution_sample_range(kg, randt, 0, kernel_data.integrator.num_distribution);
+}
+
+/* Light Tree
+ *
+ * Triangles are picked by traversing the light tree from the root, choosing
+ * the child nodes proportional to an estimate of their contribution to the
+ * shading point, based on their emitting area, distance and orientation. */
+
+__device float light_tree_node_importance(KernelGlobals *kg, int node, float3 P)
+{
+	float4 data0 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 0);
+	float4 data1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+	float4 data2 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 2);
+
+	float energy = data0.w;
+
+	if(energy == 0.0f)
+		return 0.0f;
+
+	float3 bmin = float4_to_float3(data0);
+	float3 bmax = float4_to_float3(data1);
+	float3 axis = float4_to_float3(data2);
+	float cos_theta_o = data2.w;
+
+	float3 D = 0.5f*(bmin + bmax) - P;
+	float dist2 = len_squared(D);
+	float radius2 = 0.25f*len_squared(bmax - bmin);
+
+	/* the angle between the normals and the direction to the shading point
+	 * is at least the angle to the cone axis, minus the cone angle and the
+	 * angle spanned by the bounds. emitters are two sided. */
+	float cos_theta = 1.0f;
+
+	if(dist2 > radius2) {
+		float cos_theta_d = fabsf(dot(axis, D))/sqrtf(dist2);
+		float theta = safe_acosf(cos_theta_d) - safe_acosf(cos_theta_o) - safe_asinf(sqrtf(radius2/dist2));
+
+		if(theta > 0.0f)
+			cos_theta = cosf(theta);
+	}
+
+	/* clamp distance to the size of the bounds, to avoid arbitrarily large
+	 * weights for nodes close to or containing the shading point */
+	return energy*cos_theta/max(dist2, radius2);
+}
+
+__device float light_tree_left_probability(KernelGlobals *kg, int node, int right, float3 P)
+{
+	float importance_left = light_tree_node_importance(kg, node + 1, P);
+	float importance_right = light_tree_node_importance(kg, right, P);
+	float importance = importance_left + importance_right;
+
+	return (importance > 0.0f)? importance_left/importance: 0.5f;
+}
+
+__device int light_tree_sample(KernelGlobals *kg, float3 P, float *randt, float *pdf)
+{
+	/* traverse down to a leaf, reusing the random number at every level */
+	int node = 0;
+	float r = *randt;
+	float node_pdf = 1.0f;
+
+	for(;;) {
+		float4 data3 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 3);
+		int right = __float_as_int(data3.x);
+
+		if(right == -1)
+			break;
+
+		float p_left = light_tree_left_probability(kg, node, right, P);
+
+		if(r < p_left) {
+			node = node + 1;
+			r = r/p_left;
+			node_pdf *= p_left;
+		}
+		else {
+			node = right;
+			r = (r - p_left)/(1.0f - p_left);
+			node_pdf *= 1.0f - p_left;
+		}
+	}
+
+	*randt = r;
+	*pdf = node_pdf;
+
+	return node;
+}
+
+__device float light_tree_pdf(KernelGlobals *kg, float3 P, int leaf)
+{
+	/* probability of picking leaf, children are stored after their parent so
+	 * leaf is below the right child if its index is the same or higher */
+	int node = 0;
+	float node_pdf = 1.0f;
+
+	while(node != leaf) {
+		float4 data3 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 3);
+		int right = __float_as_int(data3.x);
+		float p_left = light_tree_left_probability(kg, node, right, P);
+
+		if(leaf >= right) {
+			node = right;
+			node_pdf *= 1.0f - p_left;
+		}
+		else {
+			node = node + 1;
+			node_pdf *= p_left;
+		}
+	}
+
+	return node_pdf;
+}
+
+__device int light_tree_sample_triangle(KernelGlobals *kg, float randt, float3 P, float *pdf)
+{
+	float leaf_pdf;
+	int leaf = light_tree_sample(kg, P, &randt, &leaf_pdf);
+
+	float4 data0 = kernel_tex_fetch(__light_tree_nodes, leaf*LIGHT_TREE_NODE_SIZE + 0);
+	float4 data3 = kernel_tex_fetch(__light_tree_nodes, leaf*LIGHT_TREE_NODE_SIZE + 3);
+	int first = __float_as_int(data3.y);
+	int num = __float_as_int(data3.z);
+
+	/* pick triangle in leaf proportional to area */
+	float cdf_first = kernel_tex_fetch(__light_distribution, first).x;
+	float cdf_last = kernel_tex_fetch(__light_distribution, first + num).x;
+	int index = light_distribution_sample_range(kg, cdf_first + randt*(cdf_last - cdf_first), first, num);
+
+	/* pdf per unit area, same for all triangles in the leaf */
+	float energy = data0.w;
+	*pdf = (energy > 0.0f)? kernel_data.integrator.pdf_light_tree*leaf_pdf/energy: 0.0f;
+
+	return index;
+}
+
+__device float triangle_light_area_pdf(KernelGlobals *kg, float3 P, int object, int prim)
+{
+	if(!kernel_data.integrator.use_light_tree)
+		return kernel_data.integrator.pdf_triangles;
+
+	/* find leaf of the triangle */
+	uint map_offset = kernel_tex_fetch(__light_tree_prim_map, object*2 + 0);
+
+	if(map_offset == ~0)
+		return 0.0f;
+
+	uint tri_offset = kernel_tex_fetch(__light_tree_prim_map, object*2 + 1);
+	uint leaf = kernel_tex_fetch(__light_tree_prim_map, map_offset + prim - tri_offset);
+
+	if(leaf == ~0)
+		return 0.0f;
+
+	float4 data0 = kernel_tex_fetch(__light_tree_nodes, leaf*LIGHT_TREE_NODE_SIZE + 0);
+	float energy = data0.w;
+
+	if(energy == 0.0f)
+		return 0.0f;
+
+	return kernel_data.integrator.pdf_light_tree*light_tree_pdf(kg, P, leaf)/energy;
 }
 
 /* Generic Light */
@@ -547,7 +711,13 @@ __device int light_distribution_sample(KernelGlobals *kg, float randt)
 __device void light_sample(KernelGlobals *kg, float randt, float randu, float randv, float time, float3 P, LightSample *ls)
 {
 	/* sample index */
-	int index = light_distribution_sample(kg, randt);
+	int index;
+	float area_pdf = kernel_data.integrator.pdf_triangles;
+
+	if(kernel_data.integrator.use_light_tree && randt < kernel_data.integrator.pdf_light_tree)
+		index = light_tree_sample_triangle(kg, randt/kernel_data.integrator.pdf_light_tree, P, &area_pdf);
+	else
+		index = light_distribution_sample(kg, randt);
 
 	/* fetch light data */
 	float4 l = kernel_tex_fetch(__light_distribution, index);
@@ -568,7 +738,7 @@ __device void light_sample(KernelGlobals *kg, float randt, float randu, float ra
 
 		/* compute incoming direction, distance and pdf */
 		ls->D = normalize_len(ls->P - P, &ls->t);
-		ls->pdf = triangle_light_pdf(kg, ls->Ng, -ls->D, ls->t);
+		ls->pdf = triangle_light_pdf(kg, area_pdf, ls->Ng, -ls->D, ls->t);
 		ls->shader |= __float_as_int(l.z) & (~SHADER_MASK);
 	}
 	else {
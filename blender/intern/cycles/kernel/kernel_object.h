@@ -222,6 +222,13 @@ __device_inline float3 object_dupli_generated(KernelGlobals *kg, int object)
 	return make_float3(f.x, f.y, f.z);
 }
 
+__device_inline uint object_mesh_index(KernelGlobals *kg, int object)
+{
+	int offset = object*OBJECT_SIZE + OBJECT_DUPLI;
+	float4 f = kernel_tex_fetch(__objects, offset);
+	return __float_as_uint(f.w);
+}
+
 __device_inline float3 object_dupli_uv(KernelGlobals *kg, int object)
 {
 	if(object == ~0)
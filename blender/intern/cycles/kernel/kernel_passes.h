@@ -164,5 +164,85 @@ __device_inline void kernel_write_light_passes(KernelGlobals *kg, __global float
 #endif
 }
 
+
+/* Adaptive Sampling
+ *
+ * The adaptive pass accumulates the squared luminance of the samples to
+ * estimate the variance of each pixel, and stores the number of samples after
+ * which the pixel was found to be converged. Converged pixels are not sampled
+ * anymore, instead their passes are scaled so they keep the mean of the
+ * samples taken, and the whole tile can still be divided by the same number
+ * of samples in the end. */
+
+__device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg, __global float *buffer, int sample)
+{
+#ifdef __PASSES__
+	int flag = kernel_data.film.pass_flag;
+
+	if(!(flag & PASS_ADAPTIVE) || sample == 0)
+		return false;
+
+	int pass_adaptive = kernel_data.film.pass_adaptive;
+
+	if(buffer[pass_adaptive + 1] == 0.0f)
+		return false;
+
+	/* scale all passes as if this sample was taken, except for the ones that
+	 * are only written for the first sample and the convergence flag itself */
+	int pass_stride = kernel_data.film.pass_stride;
+	float scale = (float)(sample + 1)/(float)sample;
+
+	for(int i = 0; i < pass_stride; i++) {
+		if(i == pass_adaptive + 1)
+			continue;
+		if((flag & PASS_DEPTH) && i == kernel_data.film.pass_depth)
+			continue;
+		if((flag & PASS_OBJECT_ID) && i == kernel_data.film.pass_object_id)
+			continue;
+		if((flag & PASS_MATERIAL_ID) && i == kernel_data.film.pass_material_id)
+			continue;
+
+		buffer[i] *= scale;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+__device_inline void kernel_write_adaptive_pass(KernelGlobals *kg, __global float *buffer, int sample, float4 L)
+{
+#ifdef __PASSES__
+	if(!(kernel_data.film.pass_flag & PASS_ADAPTIVE))
+		return;
+
+	__global float *adaptive_buffer = buffer + kernel_data.film.pass_adaptive;
+	float luminance = average(make_float3(L.x, L.y, L.z));
+
+	kernel_write_pass_float(adaptive_buffer, sample, luminance*luminance);
+
+	if(sample == 0)
+		adaptive_buffer[1] = 0.0f;
+
+	int num_samples = sample + 1;
+
+	if(num_samples < max(kernel_data.integrator.adaptive_min_samples, 2))
+		return;
+
+	/* standard error of the mean, relative to the mean with a lower bound so
+	 * that dark pixels do not need to be sampled forever */
+	__global float *combined_buffer = buffer + kernel_data.film.pass_combined;
+	float inv_num_samples = 1.0f/(float)num_samples;
+	float mean = average(make_float3(combined_buffer[0], combined_buffer[1], combined_buffer[2]))*inv_num_samples;
+	float mean_sq = adaptive_buffer[0]*inv_num_samples;
+	float variance = max(mean_sq - mean*mean, 0.0f)*num_samples/(float)(num_samples - 1);
+	float error = sqrtf(variance*inv_num_samples);
+
+	if(error <= kernel_data.integrator.adaptive_threshold*max(mean, 0.01f))
+		adaptive_buffer[1] = (float)num_samples;
+#endif
+}
+
 CCL_NAMESPACE_END
 
@@ -357,7 +357,7 @@ __device void kernel_path_indirect(KernelGlobals *kg, RNG *rng, int sample, Ray
 
 #endif
 
-#ifdef __SUBSURFACE__
+#if defined(__SUBSURFACE__) || defined(__BAKING__)
 
 __device_inline bool kernel_path_integrate_lighting(KernelGlobals *kg, RNG *rng,
 	int sample, int num_samples,
@@ -1206,6 +1206,10 @@ __device void kernel_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* converged pixels are not sampled anymore */
+	if(kernel_adaptive_pixel_converged(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -1222,6 +1226,7 @@ __device void kernel_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_adaptive_pass(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
@@ -1238,6 +1243,10 @@ __device void kernel_branched_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* converged pixels are not sampled anymore */
+	if(kernel_adaptive_pixel_converged(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -1254,10 +1263,132 @@ __device void kernel_branched_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_adaptive_pass(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
 #endif
 
+#ifdef __RAY_PACKETS__
+/* Path trace a block of at most RAY_PACKET_WIDTH by RAY_PACKET_WIDTH pixels,
+ * tracing the camera rays together in packets. Bounces are incoherent, so
+ * the rest of each path is traced per pixel as before. */
+
+__device void kernel_path_trace_packet(KernelGlobals *kg,
+	__global float *buffer, __global uint *rng_state,
+	int sample, int x, int y, int w, int h, int offset, int stride)
+{
+	if(!bvh_packet_supported(kg)) {
+		for(int py = y; py < y + h; py++) {
+			for(int px = x; px < x + w; px++) {
+#ifdef __BRANCHED_PATH__
+				if(kernel_data.integrator.branched)
+					kernel_branched_path_trace(kg, buffer, rng_state, sample, px, py, offset, stride);
+				else
+#endif
+					kernel_path_trace(kg, buffer, rng_state, sample, px, py, offset, stride);
+			}
+		}
+
+		return;
+	}
+
+	int pass_stride = kernel_data.film.pass_stride;
+
+	/* initialize random numbers and camera rays, skipping converged pixels */
+	RNG rng[RAY_PACKET_SIZE];
+	Ray rays[RAY_PACKET_SIZE];
+	int pixel_index[RAY_PACKET_SIZE];
+	int octant[RAY_PACKET_SIZE];
+	int octant_count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	int num_pixels = 0;
+
+	for(int py = y; py < y + h; py++) {
+		for(int px = x; px < x + w; px++) {
+			int index = offset + px + py*stride;
+
+			if(kernel_adaptive_pixel_converged(kg, buffer + index*pass_stride, sample))
+				continue;
+
+			int i = num_pixels++;
+			kernel_path_trace_setup(kg, rng_state + index, sample, px, py, &rng[i], &rays[i]);
+
+			float3 D = rays[i].D;
+			octant[i] = ((D.x < 0.0f)? 1: 0) | ((D.y < 0.0f)? 2: 0) | ((D.z < 0.0f)? 4: 0);
+			octant_count[octant[i]]++;
+			pixel_index[i] = index;
+		}
+	}
+
+	/* sort rays by direction octant, and trace one packet per octant */
+	int octant_start[8];
+	int order[RAY_PACKET_SIZE];
+
+	for(int o = 0, start = 0; o < 8; o++) {
+		octant_start[o] = start;
+		start += octant_count[o];
+	}
+
+	for(int i = 0; i < num_pixels; i++)
+		order[octant_start[octant[i]]++] = i;
+
+	PathState state;
+	path_state_init(&state);
+	uint visibility = path_state_ray_visibility(kg, &state);
+
+	Intersection isects[RAY_PACKET_SIZE];
+	Intersection packet_isects[RAY_PACKET_SIZE];
+	RayPacket packet;
+
+	for(int start = 0; start < num_pixels; ) {
+		int end = start + 1;
+
+		while(end < num_pixels && octant[order[end]] == octant[order[start]])
+			end++;
+
+		bvh_packet_init(&packet);
+
+		for(int j = start; j < end; j++)
+			bvh_packet_add_ray(&packet, &rays[order[j]]);
+
+		bvh_packet_pad(&packet);
+		bvh_intersect_packet(kg, &packet, packet_isects, visibility);
+
+		for(int j = start; j < end; j++)
+			isects[order[j]] = packet_isects[j - start];
+
+		start = end;
+	}
+
+	/* integrate each path, starting from the camera ray intersection */
+	for(int i = 0; i < num_pixels; i++) {
+		float4 L;
+
+		if(rays[i].t != 0.0f) {
+			kg->packet_isect = &isects[i];
+
+#ifdef __BRANCHED_PATH__
+			if(kernel_data.integrator.branched)
+				L = kernel_branched_path_integrate(kg, &rng[i], sample, rays[i], buffer + pixel_index[i]*pass_stride);
+			else
+#endif
+				L = kernel_path_integrate(kg, &rng[i], sample, rays[i], buffer + pixel_index[i]*pass_stride);
+
+			kg->packet_isect = NULL;
+		}
+		else
+			L = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+		/* accumulate result in output buffer */
+		__global float *pixel_buffer = buffer + pixel_index[i]*pass_stride;
+
+		kernel_write_pass_float4(pixel_buffer, sample, L);
+		kernel_write_adaptive_pass(kg, pixel_buffer, sample, L);
+
+		path_rng_end(kg, rng_state + pixel_index[i], rng[i]);
+	}
+}
+#endif
+
 CCL_NAMESPACE_END
 
@@ -33,8 +33,9 @@ __device_inline int find_attribute(KernelGlobals *kg, ShaderData *sd, uint id, A
 	else
 #endif
 	{
-		/* for SVM, find attribute by unique id */
-		uint attr_offset = sd->object*kernel_data.bvh.attributes_map_stride;
+		/* for SVM, find attribute by unique id, instances of a mesh share
+		 * the same attribute map */
+		uint attr_offset = object_mesh_index(kg, sd->object)*kernel_data.bvh.attributes_map_stride;
 #ifdef __HAIR__
 		attr_offset = (sd->segment == ~0)? attr_offset: attr_offset + ATTR_PRIM_CURVE;
 #endif
@@ -32,6 +32,7 @@
 #include "kernel_globals.h"
 #include "kernel_film.h"
 #include "kernel_path.h"
+#include "kernel_bake.h"
 #include "kernel_displace.h"
 
 CCL_NAMESPACE_BEGIN
@@ -48,6 +49,11 @@ void kernel_cpu_sse2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *
 		kernel_path_trace(kg, buffer, rng_state, sample, x, y, offset, stride);
 }
 
+void kernel_cpu_sse2_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state, int sample, int x, int y, int w, int h, int offset, int stride)
+{
+	kernel_path_trace_packet(kg, buffer, rng_state, sample, x, y, w, h, offset, stride);
+}
+
 /* Film */
 
 void kernel_cpu_sse2_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer, float sample_scale, int x, int y, int offset, int stride)
@@ -62,9 +68,9 @@ void kernel_cpu_sse2_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, floa
 
 /* Shader Evaluate */
 
-void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output, int type, int i)
+void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output, int type, int i, int sample)
 {
-	kernel_shader_evaluate(kg, input, output, (ShaderEvalType)type, i);
+	kernel_shader_evaluate(kg, input, output, (ShaderEvalType)type, i, sample);
 }
 
 CCL_NAMESPACE_END
@@ -30,6 +30,8 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_SIZE 		11
 #define OBJECT_VECTOR_SIZE	6
 #define LIGHT_SIZE			4
+#define LIGHT_TREE_NODE_SIZE	4
+#define RAY_PACKET_WIDTH	8
 #define FILTER_TABLE_SIZE	256
 #define RAMP_TABLE_SIZE		256
 #define PARTICLE_SIZE 		5
@@ -56,6 +58,14 @@ CCL_NAMESPACE_BEGIN
 #endif
 #define __SUBSURFACE__
 #define __CMJ__
+#ifdef __KERNEL_SSE2__
+#define __QBVH__
+#endif
+#define __RAY_PACKETS__
+#define __BAKING__
+#ifdef WITH_CYCLES_STATS
+#define __KERNEL_STATS__
+#endif
 #endif
 
 #ifdef __KERNEL_CUDA__
@@ -63,6 +73,7 @@ CCL_NAMESPACE_BEGIN
 #if __CUDA_ARCH__ >= 200
 #define __KERNEL_ADV_SHADING__
 #define __BRANCHED_PATH__
+#define __BAKING__
 #endif
 #endif
 
@@ -153,7 +164,17 @@ CCL_NAMESPACE_BEGIN
 
 typedef enum ShaderEvalType {
 	SHADER_EVAL_DISPLACE,
-	SHADER_EVAL_BACKGROUND
+	SHADER_EVAL_BACKGROUND,
+
+	/* bake types, all types after SHADER_EVAL_BAKE evaluate a surface point
+	 * on an object and accumulate the result over samples */
+	SHADER_EVAL_BAKE,
+	SHADER_EVAL_COMBINED,
+	SHADER_EVAL_AO,
+	SHADER_EVAL_NORMAL,
+	SHADER_EVAL_NORMAL_OBJECT,
+	SHADER_EVAL_DIFFUSE_COLOR,
+	SHADER_EVAL_EMISSION
 } ShaderEvalType;
 
 /* Path Tracing
@@ -268,7 +289,8 @@ typedef enum PassType {
 	PASS_MIST = 2097152,
 	PASS_SUBSURFACE_DIRECT = 4194304,
 	PASS_SUBSURFACE_INDIRECT = 8388608,
-	PASS_SUBSURFACE_COLOR = 16777216
+	PASS_SUBSURFACE_COLOR = 16777216,
+	PASS_ADAPTIVE = 33554432
 } PassType;
 
 #define PASS_ALL (~0)
@@ -693,7 +715,7 @@ typedef struct KernelFilm {
 	int pass_emission;
 	int pass_background;
 	int pass_ao;
-	int pass_pad1;
+	int pass_adaptive;
 
 	int pass_shadow;
 	float pass_shadow_scale;
@@ -769,8 +791,16 @@ typedef struct KernelIntegrator {
 	/* sampler */
 	int sampling_pattern;
 
+	/* adaptive sampling */
+	float adaptive_threshold;
+	int adaptive_min_samples;
+
+	/* light tree */
+	int use_light_tree;
+	float pdf_light_tree;
+
 	/* padding */
-	int pad;
+	int pad1;
 } KernelIntegrator;
 
 typedef struct KernelBVH {
@@ -780,8 +810,10 @@ typedef struct KernelBVH {
 	int have_motion;
 	int have_curves;
 	int have_instancing;
+	int use_qbvh;
+	int use_ray_packets;
 
-	int pad1, pad2, pad3;
+	int pad1;
 } KernelBVH;
 
 typedef enum CurveFlag {
@@ -142,6 +142,9 @@ CCL_NAMESPACE_END
 #include "svm_noise.h"
 #include "svm_texture.h"
 
+#include "svm_color_util.h"
+#include "svm_math_util.h"
+
 #include "svm_attribute.h"
 #include "svm_gradient.h"
 #include "svm_blackbody.h"
@@ -188,6 +191,8 @@ __device_noinline void svm_eval_nodes(KernelGlobals *kg, ShaderData *sd, ShaderT
 	float closure_weight = 1.0f;
 	int offset = sd->shader & SHADER_MASK;
 
+	kernel_stats_shader_eval(kg, sd->shader);
+
 #ifdef __MULTI_CLOSURE__
 	sd->num_closure = 0;
 	sd->randb_closure = randb;
@@ -198,6 +203,8 @@ __device_noinline void svm_eval_nodes(KernelGlobals *kg, ShaderData *sd, ShaderT
 	while(1) {
 		uint4 node = read_node(kg, &offset);
 
+		kernel_stats_svm_node(kg, sd->shader);
+
 		switch(node.x) {
 			case NODE_SHADER_JUMP: {
 				if(type == SHADER_TYPE_SURFACE) offset = node.y;
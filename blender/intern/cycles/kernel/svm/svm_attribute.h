@@ -25,7 +25,7 @@ __device void svm_node_attr_init(KernelGlobals *kg, ShaderData *sd,
 	if(sd->object != ~0) {
 		/* find attribute by unique id */
 		uint id = node.y;
-		uint attr_offset = sd->object*kernel_data.bvh.attributes_map_stride;
+		uint attr_offset = object_mesh_index(kg, sd->object)*kernel_data.bvh.attributes_map_stride;
 #ifdef __HAIR__
 		attr_offset = (sd->segment == ~0)? attr_offset: attr_offset + ATTR_PRIM_CURVE;
 #endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include "bake.h"
+#include "device.h"
+#include "scene.h"
+
+#include "util_foreach.h"
+#include "util_string.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* number of points shaded per device task, to keep memory usage bounded
+ * for large images, while still giving each device enough work */
+#define BAKE_BATCH_SIZE (1024*1024)
+
+BakeData::BakeData(const int object, const int tri_offset, const int num_pixels):
+m_object(object),
+m_tri_offset(tri_offset),
+m_num_pixels(num_pixels)
+{
+	m_primitive.resize(num_pixels);
+	m_u.resize(num_pixels);
+	m_v.resize(num_pixels);
+}
+
+BakeData::~BakeData()
+{
+	m_primitive.clear();
+	m_u.clear();
+	m_v.clear();
+}
+
+void BakeData::set(int i, int prim, float uv[2])
+{
+	m_primitive[i] = (prim == -1)? -1: m_tri_offset + prim;
+	m_u[i] = uv[0];
+	m_v[i] = uv[1];
+}
+
+int BakeData::object()
+{
+	return m_object;
+}
+
+size_t BakeData::size()
+{
+	return m_num_pixels;
+}
+
+uint4 BakeData::data(int i)
+{
+	return make_uint4(
+		m_object,
+		m_primitive[i],
+		__float_as_int(m_u[i]),
+		__float_as_int(m_v[i])
+		);
+}
+
+BakeManager::BakeManager()
+{
+	m_bake_data = NULL;
+	num_samples = 1;
+}
+
+BakeManager::~BakeManager()
+{
+	if(m_bake_data)
+		delete m_bake_data;
+}
+
+BakeData *BakeManager::init(const int object, const int tri_offset, const int num_pixels)
+{
+	if(m_bake_data)
+		delete m_bake_data;
+
+	m_bake_data = new BakeData(object, tri_offset, num_pixels);
+	return m_bake_data;
+}
+
+bool BakeManager::is_light_pass(ShaderEvalType type)
+{
+	return (type == SHADER_EVAL_COMBINED || type == SHADER_EVAL_AO);
+}
+
+bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress,
+                       ShaderEvalType shader_type, BakeData *bake_data, float result[])
+{
+	size_t num_pixels = bake_data->size();
+
+	/* passes without lighting are noise free with a single sample */
+	int total_samples = (is_light_pass(shader_type))? max(num_samples, 1): 1;
+
+	/* needs to be up to date for attribute access */
+	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+
+	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += BAKE_BATCH_SIZE) {
+		size_t shader_size = (size_t)min(BAKE_BATCH_SIZE, (int)(num_pixels - shader_offset));
+
+		/* setup input for device task */
+		device_vector<uint4> d_input;
+		uint4 *d_input_data = d_input.resize(shader_size);
+
+		for(size_t i = 0; i < shader_size; i++)
+			d_input_data[i] = bake_data->data(shader_offset + i);
+
+		/* run device task, one sample of all points at a time so
+		 * the progress can be reported and the bake cancelled */
+		device_vector<float4> d_output;
+		d_output.resize(shader_size);
+
+		device->mem_alloc(d_input, MEM_READ_ONLY);
+		device->mem_copy_to(d_input);
+		device->mem_alloc(d_output, MEM_WRITE_ONLY);
+
+		for(int sample = 0; sample < total_samples; sample++) {
+			DeviceTask task(DeviceTask::SHADER);
+			task.shader_input = d_input.device_pointer;
+			task.shader_output = d_output.device_pointer;
+			task.shader_eval_type = shader_type;
+			task.shader_x = 0;
+			task.shader_w = d_output.size();
+			task.sample = sample;
+
+			device->task_add(task);
+			device->task_wait();
+
+			if(progress.get_cancel())
+				break;
+
+			progress.set_status("Baking", string_printf("Sample %d/%d, Pixels %d/%d",
+				sample + 1, total_samples, (int)(shader_offset + shader_size), (int)num_pixels));
+		}
+
+		device->mem_copy_from(d_output, 0, 1, d_output.size(), sizeof(float4));
+		device->mem_free(d_input);
+		device->mem_free(d_output);
+
+		if(progress.get_cancel())
+			return false;
+
+		/* read result, w holds the number of accumulated samples */
+		float4 *offset = (float4*)d_output.data_pointer;
+
+		for(size_t i = 0; i < shader_size; i++) {
+			float4 out = offset[i];
+			float *res = &result[(shader_offset + i) * 4];
+			float invw = (out.w > 0.0f)? 1.0f/out.w: 0.0f;
+
+			res[0] = out.x * invw;
+			res[1] = out.y * invw;
+			res[2] = out.z * invw;
+			res[3] = (bake_data->data(shader_offset + i).y != ~0)? 1.0f: 0.0f;
+		}
+	}
+
+	return true;
+}
+
+CCL_NAMESPACE_END
+
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __BAKE_H__
+#define __BAKE_H__
+
+#include "kernel_types.h"
+
+#include "util_progress.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Device;
+class DeviceScene;
+class Scene;
+
+/* Bake Data
+ *
+ * Points on the surface of one object to bake, one per texel. Each point is a
+ * triangle of the object's mesh with barycentric coordinates, texels that are
+ * not covered by any triangle have no primitive. */
+
+class BakeData {
+public:
+	BakeData(const int object, const int tri_offset, const int num_pixels);
+	~BakeData();
+
+	void set(int i, int prim, float uv[2]);
+	int object();
+	size_t size();
+	uint4 data(int i);
+
+private:
+	int m_object;
+	int m_tri_offset;
+	size_t m_num_pixels;
+	vector<int> m_primitive;
+	vector<float> m_u;
+	vector<float> m_v;
+};
+
+class BakeManager {
+public:
+	BakeManager();
+	~BakeManager();
+
+	BakeData *init(const int object, const int tri_offset, const int num_pixels);
+
+	/* evaluate the points, writing RGBA per point to result */
+	bool bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress,
+	          ShaderEvalType shader_type, BakeData *bake_data, float result[]);
+
+	static bool is_light_pass(ShaderEvalType type);
+
+	int num_samples;
+
+private:
+	BakeData *m_bake_data;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __BAKE_H__ */
+
@@ -93,6 +93,9 @@ RenderTile::RenderTile()
 	rng_state = 0;
 
 	buffers = NULL;
+
+	start_time = 0.0;
+	stop_time = 0.0;
 }
 
 /* Render Buffers */
@@ -118,6 +121,11 @@ void RenderBuffers::device_free()
 		device->mem_free(rng_state);
 		rng_state.clear();
 	}
+
+	if(combined_half.device_pointer) {
+		device->mem_free(combined_half);
+		combined_half.clear();
+	}
 }
 
 void RenderBuffers::reset(Device *device, BufferParams& params_)
@@ -156,6 +164,55 @@ bool RenderBuffers::copy_from_device()
 	return true;
 }
 
+static float buffer_half_to_float(half h)
+{
+	/* inverse of float4_store_half, which writes no negative, nan or inf
+	 * values and flushes denormals to zero */
+	union { uint i; float f; } out;
+	out.i = (h == 0)? 0: ((uint)h << 13) + 0x38000000;
+	return out.f;
+}
+
+bool RenderBuffers::copy_combined_from_device(int sample, float *pixels)
+{
+	/* only read back the combined pass converted to half floats, half the
+	 * data of the combined pass alone and less with more passes. the passes
+	 * themselves stay in full float, as every sample accumulates into them */
+	if(!buffer.device_pointer)
+		return false;
+
+	if(!combined_half.device_pointer) {
+		combined_half.resize(params.width, params.height);
+		device->mem_alloc(combined_half, MEM_WRITE_ONLY);
+	}
+
+	DeviceTask task(DeviceTask::FILM_CONVERT);
+
+	task.x = params.full_x;
+	task.y = params.full_y;
+	task.w = params.width;
+	task.h = params.height;
+	task.sample = sample - 1;
+	params.get_offset_stride(task.offset, task.stride);
+
+	if(!device->film_convert_half(task, buffer.device_pointer, combined_half.device_pointer))
+		return false;
+
+	device->mem_copy_from(combined_half, 0, params.width, params.height, sizeof(half4));
+
+	half4 *in = (half4*)combined_half.data_pointer;
+	int size = params.width*params.height;
+
+	for(int i = 0; i < size; i++, in++, pixels += 4) {
+		pixels[0] = buffer_half_to_float(in->x);
+		pixels[1] = buffer_half_to_float(in->y);
+		pixels[2] = buffer_half_to_float(in->z);
+		pixels[3] = clamp(buffer_half_to_float(in->w), 0.0f, 1.0f);
+	}
+
+	return true;
+}
+
 bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels)
 {
 	int pass_offset = 0;
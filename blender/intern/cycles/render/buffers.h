@@ -70,6 +70,8 @@ public:
 	device_vector<float> buffer;
 	/* random number generator state */
 	device_vector<uint> rng_state;
+	/* combined pass as half floats, for reading back render result updates */
+	device_vector<half4> combined_half;
 
 	RenderBuffers(Device *device);
 	~RenderBuffers();
@@ -77,6 +79,7 @@ public:
 	void reset(Device *device, BufferParams& params);
 
 	bool copy_from_device();
+	bool copy_combined_from_device(int sample, float *pixels);
 	bool get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels);
 
 protected:
@@ -142,6 +145,13 @@ public:
 
 	RenderBuffers *buffers;
 
+	/* time the tile was acquired, for render statistics */
+	double start_time;
+
+	/* time after which no more samples are started, for renders with a
+	 * time limit, zero if unlimited */
+	double stop_time;
+
 	RenderTile();
 };
 
@@ -155,6 +155,11 @@ void Pass::add(PassType type, vector<Pass>& passes)
 			pass.components = 4;
 			pass.exposure = false;
 			break;
+		case PASS_ADAPTIVE:
+			pass.components = 4;
+			pass.filter = false;
+			pass.exposure = false;
+			break;
 	}
 
 	passes.push_back(pass);
@@ -391,6 +396,9 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 				kfilm->pass_shadow = kfilm->pass_stride;
 				kfilm->use_light_pass = 1;
 				break;
+			case PASS_ADAPTIVE:
+				kfilm->pass_adaptive = kfilm->pass_stride;
+				break;
 			case PASS_NONE:
 				break;
 		}
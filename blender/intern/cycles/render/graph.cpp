@@ -128,6 +128,30 @@ void ShaderNode::attributes(AttributeRequestSet *attributes)
 	}
 }
 
+bool ShaderNode::equal_inputs(const ShaderNode *other) const
+{
+	if(inputs.size() != other->inputs.size() || bump != other->bump)
+		return false;
+
+	for(size_t i = 0; i < inputs.size(); i++) {
+		ShaderInput *a = inputs[i];
+		ShaderInput *b = other->inputs[i];
+
+		if(a->link != b->link || a->default_value != b->default_value)
+			return false;
+
+		/* unlinked inputs must have the same constant value */
+		if(!a->link) {
+			if(a->value.x != b->value.x || a->value.y != b->value.y || a->value.z != b->value.z)
+				return false;
+			if(a->value_string != b->value_string)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /* Graph */
 
 ShaderGraph::ShaderGraph()
@@ -256,7 +280,8 @@ void ShaderGraph::find_dependencies(set<ShaderNode*>& dependencies, ShaderInput
 	/* find all nodes that this input depends on directly and indirectly */
 	ShaderNode *node = (input->link)? input->link->parent: NULL;
 
-	if(node) {
+	/* nodes already found have their dependencies in the set too */
+	if(node && dependencies.find(node) == dependencies.end()) {
 		foreach(ShaderInput *in, node->inputs)
 			find_dependencies(dependencies, in);
 
@@ -389,8 +414,9 @@ void ShaderGraph::remove_unneeded_nodes()
 			}
 		
 			/* remove unused mix closure input when factor is 0.0 or 1.0 */
-			/* check for closure links and make sure factor link is disconnected */
-			if(mix->outputs[0]->links.size() && mix->inputs[1]->link && mix->inputs[2]->link && !mix->inputs[0]->link) {
+			/* make sure factor link is disconnected, an unlinked closure input
+			 * means an empty closure, which is left out as well */
+			if(mix->outputs[0]->links.size() && !mix->inputs[0]->link) {
 				/* factor 0.0 */
 				if(mix->inputs[0]->value.x == 0.0f) {
 					ShaderOutput *output = mix->inputs[1]->link;
@@ -464,14 +490,89 @@ void ShaderGraph::break_cycles(ShaderNode *node, vector<bool>& visited, vector<b
 	on_stack[node->id] = false;
 }
 
+void ShaderGraph::constant_fold(set<ShaderNode*>& done, ShaderNode *node)
+{
+	if(done.find(node) != done.end())
+		return;
+
+	done.insert(node);
+
+	/* fold dependencies first, so constants propagate through the graph */
+	foreach(ShaderInput *input, node->inputs)
+		if(input->link)
+			constant_fold(done, input->link->parent);
+
+	foreach(ShaderOutput *socket, node->outputs) {
+		float3 optimized_value = make_float3(0.0f, 0.0f, 0.0f);
+
+		if(socket->links.empty() || !node->constant_fold(socket, &optimized_value))
+			continue;
+
+		/* temp. copy of the output links list.
+		 * socket->links is modified when we disconnect!
+		 */
+		vector<ShaderInput*> links(socket->links);
+
+		foreach(ShaderInput *to, links) {
+			if(socket->type == SHADER_SOCKET_CLOSURE) {
+				/* zero weight closure, an unlinked closure input is empty */
+				disconnect(to);
+			}
+			else if(to->default_value == ShaderInput::NONE && to->parent != output()) {
+				/* inputs with a default value would get linked to e.g. texture
+				 * coordinates again, and an unlinked displacement input on the
+				 * output node means no displacement, so those keep the link */
+				disconnect(to);
+				to->set(optimized_value);
+			}
+		}
+	}
+}
+
+void ShaderGraph::deduplicate_nodes(set<ShaderNode*>& done, map<ustring, vector<ShaderNode*> >& candidates, ShaderNode *node)
+{
+	if(done.find(node) != done.end())
+		return;
+
+	done.insert(node);
+
+	/* deduplicate dependencies first, so identical subgraphs end up with the
+	 * same input links and collapse from the bottom up */
+	foreach(ShaderInput *input, node->inputs)
+		if(input->link)
+			deduplicate_nodes(done, candidates, input->link->parent);
+
+	vector<ShaderNode*>& same_name = candidates[node->name];
+
+	foreach(ShaderNode *other, same_name) {
+		if(other->equals(node)) {
+			/* relink outputs to the identical node, this node is then left
+			 * unused and removed */
+			for(size_t i = 0; i < node->outputs.size(); i++) {
+				vector<ShaderInput*> links(node->outputs[i]->links);
+
+				foreach(ShaderInput *to, links) {
+					disconnect(to);
+					connect(other->outputs[i], to);
+				}
+			}
+
+			return;
+		}
+	}
+
+	same_name.push_back(node);
+}
+
 void ShaderGraph::clean()
 {
 	/* remove proxy and unnecessary mix nodes */
 	remove_unneeded_nodes();
 
-	/* we do two things here: find cycles and break them, and remove unused
-	 * nodes that don't feed into the output. how cycles are broken is
-	 * undefined, they are invalid input, the important thing is to not crash */
+	/* we do three things here: find cycles and break them, simplify the
+	 * graph, and remove unused nodes that don't feed into the output. how
+	 * cycles are broken is undefined, they are invalid input, the important
+	 * thing is to not crash */
 
 	vector<bool> visited(num_node_ids, false);
 	vector<bool> on_stack(num_node_ids, false);
@@ -479,9 +580,28 @@ void ShaderGraph::clean()
 	/* break cycles */
 	break_cycles(output(), visited, on_stack);
 
+	/* fold constant subtrees and zero weight closures */
+	set<ShaderNode*> folded;
+	constant_fold(folded, output());
+
+	/* mix closures with a factor that became constant can now be removed */
+	remove_unneeded_nodes();
+
+	/* merge nodes computing the same result */
+	set<ShaderNode*> deduplicated;
+	map<ustring, vector<ShaderNode*> > candidates;
+	deduplicate_nodes(deduplicated, candidates, output());
+
+	/* find nodes that still feed into the output */
+	set<ShaderNode*> used;
+	used.insert(output());
+
+	foreach(ShaderInput *input, output()->inputs)
+		find_dependencies(used, input);
+
 	/* disconnect unused nodes */
 	foreach(ShaderNode *node, nodes) {
-		if(!visited[node->id]) {
+		if(used.find(node) == used.end()) {
 			foreach(ShaderInput *to, node->inputs) {
 				ShaderOutput *from = to->link;
 
@@ -497,7 +617,7 @@ void ShaderGraph::clean()
 	list<ShaderNode*> newnodes;
 
 	foreach(ShaderNode *node, nodes) {
-		if(visited[node->id])
+		if(used.find(node) != used.end())
 			newnodes.push_back(node);
 		else
 			delete node;
@@ -192,6 +192,16 @@ public:
 	virtual bool has_converter_blackbody() { return false; }
 	virtual bool has_bssrdf_bump() { return false; }
 
+	/* constant folding: return true and the value of the output socket if it
+	 * does not depend on any linked input. for closure outputs, returning true
+	 * means the closure has zero weight and can be left out entirely */
+	virtual bool constant_fold(ShaderOutput *socket, float3 *optimized_value) { return false; }
+
+	/* node deduplication: return true if the other node, which has the same
+	 * name, computes exactly the same outputs as this node */
+	virtual bool equals(const ShaderNode *other) const { return false; }
+	bool equal_inputs(const ShaderNode *other) const;
+
 	vector<ShaderInput*> inputs;
 	vector<ShaderOutput*> outputs;
 
@@ -253,6 +263,8 @@ protected:
 	void copy_nodes(set<ShaderNode*>& nodes, map<ShaderNode*, ShaderNode*>& nnodemap);
 
 	void break_cycles(ShaderNode *node, vector<bool>& visited, vector<bool>& on_stack);
+	void constant_fold(set<ShaderNode*>& done, ShaderNode *node);
+	void deduplicate_nodes(set<ShaderNode*>& done, map<ustring, vector<ShaderNode*> >& candidates, ShaderNode *node);
 	void clean();
 	void bump_from_displacement();
 	void refine_bump_nodes();
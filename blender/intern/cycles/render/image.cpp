@@ -16,6 +16,7 @@
 
 #include "device.h"
 #include "image.h"
+#include "image_cache.h"
 #include "scene.h"
 
 #include "util_foreach.h"
@@ -34,6 +35,8 @@ ImageManager::ImageManager()
 	need_update = true;
 	pack_images = false;
 	osl_texture_system = NULL;
+	image_cache = NULL;
+	texture_cache_size = 0;
 	animation_frame = 0;
 
 	tex_num_images = TEX_NUM_IMAGES;
@@ -47,6 +50,8 @@ ImageManager::~ImageManager()
 		assert(!images[slot]);
 	for(size_t slot = 0; slot < float_images.size(); slot++)
 		assert(!float_images[slot]);
+
+	delete image_cache;
 }
 
 void ImageManager::set_pack_images(bool pack_images_)
@@ -66,6 +71,14 @@ void ImageManager::set_extended_image_limits(void)
 	tex_image_byte_start = TEX_EXTENDED_IMAGE_BYTE_START;
 }
 
+void ImageManager::set_texture_cache_size(size_t memory_limit)
+{
+	texture_cache_size = memory_limit;
+
+	if(image_cache)
+		image_cache->set_memory_limit(memory_limit);
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
 	if(frame != animation_frame) {
@@ -482,6 +495,14 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			device->tex_free(tex_img);
 		}
 
+		string name;
+
+		if(slot >= 10) name = string_printf("__tex_image_float_0%d", slot);
+		else name = string_printf("__tex_image_float_00%d", slot);
+
+		if(device_cache_image(device, img, slot, is_float, tex_img, name))
+			return;
+
 		if(!file_load_float_image(img, tex_img)) {
 			/* on failure to load, we set a 1x1 pixels pink image */
 			float *pixels = (float*)tex_img.resize(1, 1);
@@ -492,11 +513,6 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			pixels[3] = TEX_IMAGE_MISSING_A;
 		}
 
-		string name;
-
-		if(slot >= 10) name = string_printf("__tex_image_float_0%d", slot);
-		else name = string_printf("__tex_image_float_00%d", slot);
-
 		if(!pack_images) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(), tex_img, true, true);
@@ -513,6 +529,14 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			device->tex_free(tex_img);
 		}
 
+		string name;
+
+		if(slot >= 10) name = string_printf("__tex_image_0%d", slot);
+		else name = string_printf("__tex_image_00%d", slot);
+
+		if(device_cache_image(device, img, slot, is_float, tex_img, name))
+			return;
+
 		if(!file_load_image(img, tex_img)) {
 			/* on failure to load, we set a 1x1 pixels pink image */
 			uchar *pixels = (uchar*)tex_img.resize(1, 1);
@@ -523,11 +547,6 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			pixels[3] = (TEX_IMAGE_MISSING_A * 255);
 		}
 
-		string name;
-
-		if(slot >= 10) name = string_printf("__tex_image_0%d", slot);
-		else name = string_printf("__tex_image_00%d", slot);
-
 		if(!pack_images) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(), tex_img, true, true);
@@ -537,6 +556,30 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 	img->need_load = false;
 }
 
+template<typename T>
+bool ImageManager::device_cache_image(Device *device, Image *img, int slot, bool is_float,
+	device_vector<T>& tex_img, const string& name)
+{
+	if(!image_cache)
+		return false;
+
+	/* builtin images are always loaded entirely */
+	if(img->builtin_data || !image_cache->add_image(slot, img->filename, is_float))
+		return false;
+
+	/* no texture data, so the kernel will use the image cache instead */
+	tex_img.clear();
+
+	if(!pack_images) {
+		thread_scoped_lock device_lock(device_mutex);
+		device->tex_alloc(name.c_str(), tex_img, true, true);
+	}
+
+	img->need_load = false;
+
+	return true;
+}
+
 void ImageManager::device_free_image(Device *device, DeviceScene *dscene, int slot)
 {
 	Image *img;
@@ -552,6 +595,9 @@ void ImageManager::device_free_image(Device *device, DeviceScene *dscene, int sl
 	}
 
 	if(img) {
+		if(image_cache)
+			image_cache->remove_image(slot);
+
 		if(osl_texture_system) {
 #ifdef WITH_OSL
 			ustring filename(images[slot]->filename);
@@ -592,6 +638,11 @@ void ImageManager::device_update(Device *device, DeviceScene *dscene, Progress&
 	if(!need_update)
 		return;
 
+	if(texture_cache_size && !image_cache && !osl_texture_system && !pack_images) {
+		image_cache = new ImageCache(texture_cache_size);
+		device->image_cache_set(image_cache);
+	}
+
 	TaskPool pool;
 
 	for(size_t slot = 0; slot < images.size(); slot++) {
@@ -42,6 +42,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class ImageCache;
 class Progress;
 
 class ImageManager {
@@ -59,6 +60,7 @@ public:
 	void set_osl_texture_system(void *texture_system);
 	void set_pack_images(bool pack_images_);
 	void set_extended_image_limits(void);
+	void set_texture_cache_size(size_t memory_limit);
 	bool set_animation_frame_update(int frame);
 
 	bool need_update;
@@ -87,10 +89,16 @@ private:
 	void *osl_texture_system;
 	bool pack_images;
 
+	/* load tiled images on demand, only supported on the CPU */
+	ImageCache *image_cache;
+	size_t texture_cache_size;
+
 	bool file_load_image(Image *img, device_vector<uchar4>& tex_img);
 	bool file_load_float_image(Image *img, device_vector<float4>& tex_img);
 
 	void device_load_image(Device *device, DeviceScene *dscene, int slot, Progress *progess);
+	template<typename T> bool device_cache_image(Device *device, Image *img, int slot, bool is_float,
+		device_vector<T>& tex_img, const string& name);
 	void device_free_image(Device *device, DeviceScene *dscene, int slot);
 
 	void device_pack_images(Device *device, DeviceScene *dscene, Progress& progess);
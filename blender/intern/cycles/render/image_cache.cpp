@@ -0,0 +1,382 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include "image_cache.h"
+
+#include "util_image.h"
+#include "util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Image */
+
+struct ImageCache::Image {
+	string filename;
+	uint id;
+	bool is_float;
+
+	int x, y, z;
+	int width, height, components;
+	int tile_width, tile_height;
+	int num_tiles_x, num_tiles_y;
+
+	/* file stays open for reading tiles, not thread safe */
+	ImageInput *in;
+	thread_mutex mutex;
+};
+
+/* Thread Data */
+
+struct KernelImageCacheThreadData {
+	KernelImageCacheThreadData()
+	: next(0)
+	{
+		for(int i = 0; i < ImageCache::THREAD_CACHE_SIZE; i++)
+			keys[i] = ~(uint64_t)0;
+	}
+
+	/* recently used tiles, replaced round robin */
+	uint64_t keys[ImageCache::THREAD_CACHE_SIZE];
+	ImageCache::TilePtr tiles[ImageCache::THREAD_CACHE_SIZE];
+	int next;
+};
+
+/* Image Cache */
+
+ImageCache::ImageCache(size_t memory_limit_)
+{
+	memory_limit = memory_limit_;
+	memory_size = 0;
+	next_image_id = 0;
+}
+
+ImageCache::~ImageCache()
+{
+	for(size_t slot = 0; slot < images.size(); slot++)
+		remove_image(slot);
+}
+
+bool ImageCache::add_image(int slot, const string& filename, bool is_float)
+{
+	remove_image(slot);
+
+	ImageInput *in = ImageInput::create(filename);
+
+	if(!in)
+		return false;
+
+	ImageSpec spec;
+
+	if(!in->open(filename, spec)) {
+		delete in;
+		return false;
+	}
+
+	/* only tiled files can be read in parts efficiently, other files can be
+	 * loaded entirely just as well */
+	bool tiled = (spec.tile_width > 0 && spec.tile_height > 0 && spec.tile_depth <= 1);
+
+	if(!tiled || !(spec.nchannels >= 1 && spec.nchannels <= 4)) {
+		in->close();
+		delete in;
+		return false;
+	}
+
+	Image *img = new Image();
+
+	img->filename = filename;
+	img->id = next_image_id++;
+	img->is_float = is_float;
+	img->x = spec.x;
+	img->y = spec.y;
+	img->z = spec.z;
+	img->width = spec.width;
+	img->height = spec.height;
+	img->components = spec.nchannels;
+	img->tile_width = spec.tile_width;
+	img->tile_height = spec.tile_height;
+	img->num_tiles_x = (spec.width + spec.tile_width - 1)/spec.tile_width;
+	img->num_tiles_y = (spec.height + spec.tile_height - 1)/spec.tile_height;
+	img->in = in;
+
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	if(slot >= (int)images.size())
+		images.resize(slot + 1, NULL);
+
+	images[slot] = img;
+
+	return true;
+}
+
+void ImageCache::remove_image(int slot)
+{
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	if(slot >= (int)images.size() || !images[slot])
+		return;
+
+	Image *img = images[slot];
+	images[slot] = NULL;
+
+	/* free tiles of this image, tiles still in use by a thread cache are
+	 * freed once the thread no longer holds them */
+	uint64_t key_begin = ((uint64_t)img->id) << 32;
+	uint64_t key_end = ((uint64_t)img->id + 1) << 32;
+
+	map<uint64_t, TilePtr>::iterator begin = tiles.lower_bound(key_begin);
+	map<uint64_t, TilePtr>::iterator end = tiles.lower_bound(key_end);
+
+	for(map<uint64_t, TilePtr>::iterator it = begin; it != end; it++) {
+		memory_size -= it->second->memory_size;
+		lru.erase(it->second->lru_it);
+	}
+
+	tiles.erase(begin, end);
+
+	img->in->close();
+	delete img->in;
+	delete img;
+}
+
+void ImageCache::set_memory_limit(size_t memory_limit_)
+{
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	memory_limit = memory_limit_;
+	evict_tiles();
+}
+
+size_t ImageCache::memory_used()
+{
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	return memory_size;
+}
+
+KernelImageCacheThreadData *ImageCache::thread_init()
+{
+	return new KernelImageCacheThreadData();
+}
+
+void ImageCache::thread_free(KernelImageCacheThreadData *tdata)
+{
+	delete tdata;
+}
+
+static int image_cache_wrap_periodic(int x, int width)
+{
+	x %= width;
+	if(x < 0)
+		x += width;
+	return x;
+}
+
+static float image_cache_frac(float x, int *ix)
+{
+	int i = float_to_int(x) - ((x < 0.0f)? 1: 0);
+	*ix = i;
+	return x - (float)i;
+}
+
+float4 ImageCache::interp(KernelImageCacheThreadData *tdata, int slot, float x, float y)
+{
+	Image *img = (slot < (int)images.size())? images[slot]: NULL;
+
+	if(!img)
+		return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	/* same interpolation as texture_image on the CPU */
+	int width = img->width;
+	int height = img->height;
+	int ix, iy, nix, niy;
+	float tx = image_cache_frac(x*width - 0.5f, &ix);
+	float ty = image_cache_frac(y*height - 0.5f, &iy);
+
+	ix = image_cache_wrap_periodic(ix, width);
+	iy = image_cache_wrap_periodic(iy, height);
+
+	nix = image_cache_wrap_periodic(ix+1, width);
+	niy = image_cache_wrap_periodic(iy+1, height);
+
+	float4 r = (1.0f - ty)*(1.0f - tx)*read_pixel(img, tdata, ix, iy);
+	r += (1.0f - ty)*tx*read_pixel(img, tdata, nix, iy);
+	r += ty*(1.0f - tx)*read_pixel(img, tdata, ix, niy);
+	r += ty*tx*read_pixel(img, tdata, nix, niy);
+
+	return r;
+}
+
+float4 ImageCache::read_pixel(Image *img, KernelImageCacheThreadData *tdata, int x, int y)
+{
+	/* images are stored bottom to top in the kernel, files top to bottom */
+	y = img->height - 1 - y;
+
+	int tile_x = x/img->tile_width;
+	int tile_y = y/img->tile_height;
+	uint64_t key = (((uint64_t)img->id) << 32) | (uint64_t)(tile_y*img->num_tiles_x + tile_x);
+
+	/* lookup in thread cache first, to avoid locking */
+	Tile *tile = NULL;
+	TilePtr tile_ptr;
+
+	if(tdata) {
+		for(int i = 0; i < THREAD_CACHE_SIZE; i++) {
+			if(tdata->keys[i] == key) {
+				tile = tdata->tiles[i].get();
+				break;
+			}
+		}
+	}
+
+	if(!tile) {
+		tile_ptr = get_tile(img, tile_x, tile_y);
+		tile = tile_ptr.get();
+
+		if(tdata) {
+			tdata->keys[tdata->next] = key;
+			tdata->tiles[tdata->next] = tile_ptr;
+			tdata->next = (tdata->next + 1) % THREAD_CACHE_SIZE;
+		}
+	}
+
+	int index = (x - tile_x*img->tile_width) + (y - tile_y*img->tile_height)*img->tile_width;
+
+	if(img->is_float)
+		return tile->float_pixels[index];
+
+	uchar4 p = tile->byte_pixels[index];
+	float f = 1.0f/255.0f;
+	return make_float4(p.x*f, p.y*f, p.z*f, p.w*f);
+}
+
+ImageCache::TilePtr ImageCache::get_tile(Image *img, int tile_x, int tile_y)
+{
+	uint64_t key = (((uint64_t)img->id) << 32) | (uint64_t)(tile_y*img->num_tiles_x + tile_x);
+
+	{
+		thread_scoped_lock cache_lock(cache_mutex);
+
+		map<uint64_t, TilePtr>::iterator it = tiles.find(key);
+
+		if(it != tiles.end()) {
+			/* move to front of least recently used list */
+			lru.splice(lru.begin(), lru, it->second->lru_it);
+			return it->second;
+		}
+	}
+
+	/* load outside of cache lock, so other threads can continue */
+	TilePtr tile = load_tile(img, tile_x, tile_y);
+
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	/* another thread may have loaded the same tile in the meantime */
+	map<uint64_t, TilePtr>::iterator it = tiles.find(key);
+
+	if(it != tiles.end())
+		return it->second;
+
+	lru.push_front(key);
+	tile->lru_it = lru.begin();
+	tiles[key] = tile;
+	memory_size += tile->memory_size;
+
+	evict_tiles();
+
+	return tile;
+}
+
+ImageCache::TilePtr ImageCache::load_tile(Image *img, int tile_x, int tile_y)
+{
+	TilePtr tile(new Tile());
+
+	int components = img->components;
+	int num_pixels = img->tile_width*img->tile_height;
+	int x = img->x + tile_x*img->tile_width;
+	int y = img->y + tile_y*img->tile_height;
+
+	if(img->is_float) {
+		vector<float> pixels(num_pixels*components, 0.0f);
+
+		{
+			thread_scoped_lock image_lock(img->mutex);
+			img->in->read_tile(x, y, img->z, TypeDesc::FLOAT, &pixels[0]);
+		}
+
+		tile->float_pixels.resize(num_pixels);
+
+		for(int i = 0; i < num_pixels; i++) {
+			float *p = &pixels[i*components];
+			float4& r = tile->float_pixels[i];
+
+			if(components == 1)
+				r = make_float4(p[0], p[0], p[0], 1.0f);
+			else if(components == 2)
+				r = make_float4(p[0], p[0], p[0], p[1]);
+			else if(components == 3)
+				r = make_float4(p[0], p[1], p[2], 1.0f);
+			else
+				r = make_float4(p[0], p[1], p[2], p[3]);
+		}
+
+		tile->memory_size = num_pixels*sizeof(float4);
+	}
+	else {
+		vector<uchar> pixels(num_pixels*components, 0);
+
+		{
+			thread_scoped_lock image_lock(img->mutex);
+			img->in->read_tile(x, y, img->z, TypeDesc::UINT8, &pixels[0]);
+		}
+
+		tile->byte_pixels.resize(num_pixels);
+
+		for(int i = 0; i < num_pixels; i++) {
+			uchar *p = &pixels[i*components];
+			uchar4& r = tile->byte_pixels[i];
+
+			if(components == 1)
+				r = make_uchar4(p[0], p[0], p[0], 255);
+			else if(components == 2)
+				r = make_uchar4(p[0], p[0], p[0], p[1]);
+			else if(components == 3)
+				r = make_uchar4(p[0], p[1], p[2], 255);
+			else
+				r = make_uchar4(p[0], p[1], p[2], p[3]);
+		}
+
+		tile->memory_size = num_pixels*sizeof(uchar4);
+	}
+
+	return tile;
+}
+
+void ImageCache::evict_tiles()
+{
+	/* free least recently used tiles until we are within the memory limit,
+	 * always keeping the most recent tile */
+	while(memory_size > memory_limit && lru.size() > 1) {
+		map<uint64_t, TilePtr>::iterator it = tiles.find(lru.back());
+
+		memory_size -= it->second->memory_size;
+		tiles.erase(it);
+		lru.pop_back();
+	}
+}
+
+CCL_NAMESPACE_END
+
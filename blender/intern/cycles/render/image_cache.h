@@ -0,0 +1,99 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include <boost/shared_ptr.hpp>
+
+#include "kernel_types.h"
+#include "kernel_compat_cpu.h"
+
+#include "util_list.h"
+#include "util_map.h"
+#include "util_string.h"
+#include "util_thread.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Image Cache
+ *
+ * Image textures for the CPU device that are loaded on demand in tiles, rather
+ * than decoded entirely up front. Tiles are read from tiled image files the
+ * first time the kernel looks them up, and the least recently used tiles are
+ * freed when the cache goes over its memory limit. This way memory usage
+ * depends on the tiles actually used by the render, not the total size of
+ * all textures in the scene. */
+
+class ImageCache : public KernelImageCache {
+public:
+	ImageCache(size_t memory_limit);
+	~ImageCache();
+
+	/* add image for given texture slot, returns false if the file can't be
+	 * loaded in tiles, in which case it should be loaded entirely instead */
+	bool add_image(int slot, const string& filename, bool is_float);
+	void remove_image(int slot);
+
+	void set_memory_limit(size_t memory_limit);
+	size_t memory_used();
+
+	/* kernel threads keep their own list of recently used tiles */
+	KernelImageCacheThreadData *thread_init();
+	void thread_free(KernelImageCacheThreadData *tdata);
+
+	/* kernel lookup, bilinear interpolation with periodic wrapping */
+	float4 interp(KernelImageCacheThreadData *tdata, int slot, float x, float y);
+
+protected:
+	friend struct KernelImageCacheThreadData;
+
+	struct Image;
+
+	struct Tile {
+		Tile() : memory_size(0) {}
+
+		vector<uchar4> byte_pixels;
+		vector<float4> float_pixels;
+		size_t memory_size;
+		list<uint64_t>::iterator lru_it;
+	};
+
+	typedef boost::shared_ptr<Tile> TilePtr;
+
+	enum { THREAD_CACHE_SIZE = 8 };
+
+	float4 read_pixel(Image *img, KernelImageCacheThreadData *tdata, int x, int y);
+	TilePtr get_tile(Image *img, int tile_x, int tile_y);
+	TilePtr load_tile(Image *img, int tile_x, int tile_y);
+	void evict_tiles();
+
+	thread_mutex cache_mutex;
+	map<uint64_t, TilePtr> tiles;
+	list<uint64_t> lru;
+	size_t memory_limit;
+	size_t memory_size;
+
+	vector<Image*> images;
+	uint next_image_id;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __IMAGE_CACHE_H__ */
+
@@ -58,6 +58,11 @@ Integrator::Integrator()
 
 	sampling_pattern = SAMPLING_PATTERN_SOBOL;
 
+	adaptive_threshold = 0.01f;
+	adaptive_min_samples = 16;
+
+	use_light_tree = false;
+
 	need_update = true;
 }
 
@@ -115,6 +120,9 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 
 	kintegrator->sampling_pattern = sampling_pattern;
 
+	kintegrator->adaptive_threshold = adaptive_threshold;
+	kintegrator->adaptive_min_samples = adaptive_min_samples;
+
 	/* sobol directions table */
 	int max_samples = 1;
 
@@ -172,7 +180,10 @@ bool Integrator::modified(const Integrator& integrator)
 		mesh_light_samples == integrator.mesh_light_samples &&
 		subsurface_samples == integrator.subsurface_samples &&
 		motion_blur == integrator.motion_blur &&
-		sampling_pattern == integrator.sampling_pattern);
+		sampling_pattern == integrator.sampling_pattern &&
+		adaptive_threshold == integrator.adaptive_threshold &&
+		adaptive_min_samples == integrator.adaptive_min_samples &&
+		use_light_tree == integrator.use_light_tree);
 }
 
 void Integrator::tag_update(Scene *scene)
@@ -19,6 +19,7 @@
 #include "integrator.h"
 #include "film.h"
 #include "light.h"
+#include "light_tree.h"
 #include "mesh.h"
 #include "object.h"
 #include "scene.h"
@@ -196,6 +197,19 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
 	float totarea = 0.0f;
 
+	/* light tree emitters, and map from triangles to the tree leaves, with
+	 * for each object the map offset and triangle offset first */
+	bool use_light_tree = scene->integrator->use_light_tree && num_triangles > 0;
+	vector<LightTree::Emitter> emitters;
+	vector<int> emitter_map_index;
+	vector<uint> prim_map;
+
+	if(use_light_tree) {
+		emitters.reserve(num_triangles);
+		emitter_map_index.reserve(num_triangles);
+		prim_map.resize(scene->objects.size()*2, ~0);
+	}
+
 	/* triangles */
 	size_t offset = 0;
 	int j = 0;
@@ -243,6 +257,14 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 				use_light_visibility = true;
 			}
 
+			size_t map_offset = prim_map.size();
+
+			if(use_light_tree) {
+				prim_map[j*2 + 0] = map_offset;
+				prim_map[j*2 + 1] = mesh->tri_offset;
+				prim_map.resize(map_offset + mesh->triangles.size(), ~0);
+			}
+
 			for(size_t i = 0; i < mesh->triangles.size(); i++) {
 				Shader *shader = scene->shaders[mesh->shader[i]];
 
@@ -264,7 +286,24 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 						p3 = transform_point(&tfm, p3);
 					}
 
-					totarea += triangle_area(p1, p2, p3);
+					float area = triangle_area(p1, p2, p3);
+					totarea += area;
+
+					if(use_light_tree) {
+						LightTree::Emitter emitter;
+						float3 N = cross(p2 - p1, p3 - p1);
+
+						emitter.bounds = BoundBox(p1);
+						emitter.bounds.grow(p2);
+						emitter.bounds.grow(p3);
+						emitter.centroid = (p1 + p2 + p3)*(1.0f/3.0f);
+						emitter.axis = (len_squared(N) > 0.0f)? normalize(N): make_float3(0.0f, 0.0f, 1.0f);
+						emitter.energy = area;
+						emitter.index = emitters.size();
+
+						emitters.push_back(emitter);
+						emitter_map_index.push_back(map_offset + i);
+					}
 				}
 			}
 
@@ -308,6 +347,31 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		j++;
 	}
 
+	/* build light tree, and store triangles in the order of its leaves, so
+	 * that each leaf refers to a contiguous range of the distribution */
+	LightTree light_tree;
+
+	if(use_light_tree) {
+		progress.set_status("Updating Lights", "Building light tree");
+
+		vector<float4> triangle_distribution(distribution, distribution + num_triangles);
+		light_tree.build(emitters);
+
+		totarea = 0.0f;
+
+		for(size_t i = 0; i < num_triangles; i++) {
+			int index = emitters[i].index;
+
+			distribution[i] = triangle_distribution[index];
+			distribution[i].x = totarea;
+			totarea += emitters[i].energy;
+
+			prim_map[emitter_map_index[index]] = light_tree.emitter_leaf[i];
+		}
+
+		if(progress.get_cancel()) return;
+	}
+
 	float trianglearea = totarea;
 
 	/* point lights */
@@ -376,6 +440,21 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 
 		kintegrator->use_lamp_mis = use_lamp_mis;
 
+		/* light tree selects among triangles, with the same probability for
+		 * all triangles together as the distribution */
+		kintegrator->use_light_tree = use_light_tree && trianglearea > 0.0f;
+		kintegrator->pdf_light_tree = 0.0f;
+
+		if(kintegrator->use_light_tree) {
+			kintegrator->pdf_light_tree = distribution[num_triangles].x;
+
+			dscene->light_tree_nodes.copy(&light_tree.nodes[0], light_tree.nodes.size());
+			dscene->light_tree_prim_map.copy(&prim_map[0], prim_map.size());
+
+			device->tex_alloc("__light_tree_nodes", dscene->light_tree_nodes);
+			device->tex_alloc("__light_tree_prim_map", dscene->light_tree_prim_map);
+		}
+
 		/* bit of an ugly hack to compensate for emitting triangles influencing
 		 * amount of samples we get for this pass */
 		kfilm->pass_shadow_scale = 1.0f;
@@ -398,6 +477,8 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		kintegrator->pdf_lights = 0.0f;
 		kintegrator->inv_pdf_lights = 0.0f;
 		kintegrator->use_lamp_mis = false;
+		kintegrator->use_light_tree = false;
+		kintegrator->pdf_light_tree = 0.0f;
 		kfilm->pass_shadow_scale = 1.0f;
 	}
 }
@@ -668,11 +749,15 @@ void LightManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->light_data);
 	device->tex_free(dscene->light_background_marginal_cdf);
 	device->tex_free(dscene->light_background_conditional_cdf);
+	device->tex_free(dscene->light_tree_nodes);
+	device->tex_free(dscene->light_tree_prim_map);
 
 	dscene->light_distribution.clear();
 	dscene->light_data.clear();
 	dscene->light_background_marginal_cdf.clear();
 	dscene->light_background_conditional_cdf.clear();
+	dscene->light_tree_nodes.clear();
+	dscene->light_tree_prim_map.clear();
 }
 
 void LightManager::tag_update(Scene *scene)
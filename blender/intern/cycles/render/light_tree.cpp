@@ -0,0 +1,304 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include "light_tree.h"
+
+#include "util_algorithm.h"
+#include "util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Partitioning */
+
+struct LightTreeBinLess {
+	LightTreeBinLess(int dim_, float3 cmin_, float scale_, int bin_)
+	: dim(dim_), cmin(cmin_), scale(scale_), bin(bin_)
+	{
+	}
+
+	bool operator()(const LightTree::Emitter& emitter) const
+	{
+		return light_tree_bin(emitter) <= bin;
+	}
+
+	int light_tree_bin(const LightTree::Emitter& emitter) const
+	{
+		int b = (int)((emitter.centroid[dim] - cmin[dim])*scale);
+		return clamp(b, 0, LightTree::NUM_BINS-1);
+	}
+
+	int dim;
+	float3 cmin;
+	float scale;
+	int bin;
+};
+
+struct LightTreeCentroidLess {
+	LightTreeCentroidLess(int dim_)
+	: dim(dim_)
+	{
+	}
+
+	bool operator()(const LightTree::Emitter& a, const LightTree::Emitter& b) const
+	{
+		return a.centroid[dim] < b.centroid[dim];
+	}
+
+	int dim;
+};
+
+/* Light Tree */
+
+LightTree::LightTree()
+{
+}
+
+void LightTree::build(vector<Emitter>& emitters)
+{
+	nodes.clear();
+	emitter_leaf.clear();
+
+	if(emitters.size() == 0)
+		return;
+
+	emitter_leaf.resize(emitters.size(), 0);
+	nodes.reserve(emitters.size()*2*NODE_SIZE);
+
+	recursive_build(emitters, 0, emitters.size());
+}
+
+int LightTree::recursive_build(vector<Emitter>& emitters, int start, int end)
+{
+	Node node = make_node(emitters, start, end);
+	int num = end - start;
+
+	/* find axis with largest centroid extent */
+	BoundBox centroid_bounds(BoundBox::empty);
+
+	for(int i = start; i < end; i++)
+		centroid_bounds.grow(emitters[i].centroid);
+
+	float3 extent = centroid_bounds.max - centroid_bounds.min;
+	int dim = (extent.x >= extent.y && extent.x >= extent.z)? 0: (extent.y >= extent.z)? 1: 2;
+
+	/* create leaf if small enough, or if emitters can't be separated */
+	if(num <= MAX_LEAF_SIZE || extent[dim] == 0.0f) {
+		int index = add_node(node, -1, start, num);
+
+		for(int i = start; i < end; i++)
+			emitter_leaf[i] = index;
+
+		return index;
+	}
+
+	/* bin emitters by centroid */
+	float scale = NUM_BINS/extent[dim];
+	LightTreeBinLess binner(dim, centroid_bounds.min, scale, 0);
+
+	Node bins[NUM_BINS];
+	int bin_count[NUM_BINS];
+
+	for(int b = 0; b < NUM_BINS; b++)
+		bin_count[b] = 0;
+
+	for(int i = start; i < end; i++) {
+		const Emitter& emitter = emitters[i];
+		int b = binner.light_tree_bin(emitter);
+
+		if(bin_count[b] == 0) {
+			bins[b].bounds = emitter.bounds;
+			bins[b].cone.axis = emitter.axis;
+			bins[b].cone.theta_o = 0.0f;
+			bins[b].energy = emitter.energy;
+		}
+		else {
+			Cone cone;
+			cone.axis = emitter.axis;
+			cone.theta_o = 0.0f;
+
+			bins[b].bounds.grow(emitter.bounds);
+			bins[b].cone = merge_cones(bins[b].cone, cone);
+			bins[b].energy += emitter.energy;
+		}
+
+		bin_count[b]++;
+	}
+
+	/* sweep from right to left, and then find the split with the lowest
+	 * cost, weighting area by energy and spread of orientation */
+	float right_cost[NUM_BINS];
+	Node right;
+	int right_num = 0;
+
+	for(int b = NUM_BINS-1; b > 0; b--) {
+		if(bin_count[b]) {
+			if(right_num) {
+				right.bounds.grow(bins[b].bounds);
+				right.cone = merge_cones(right.cone, bins[b].cone);
+				right.energy += bins[b].energy;
+			}
+			else
+				right = bins[b];
+
+			right_num += bin_count[b];
+		}
+
+		right_cost[b] = (right_num)? right.energy*right.bounds.safe_area()*orientation_measure(right.cone): 0.0f;
+	}
+
+	Node left;
+	int left_num = 0;
+	int best_bin = -1;
+	float best_cost = FLT_MAX;
+
+	for(int b = 0; b < NUM_BINS-1; b++) {
+		if(bin_count[b]) {
+			if(left_num) {
+				left.bounds.grow(bins[b].bounds);
+				left.cone = merge_cones(left.cone, bins[b].cone);
+				left.energy += bins[b].energy;
+			}
+			else
+				left = bins[b];
+
+			left_num += bin_count[b];
+		}
+
+		if(left_num == 0 || left_num == num)
+			continue;
+
+		float cost = left.energy*left.bounds.safe_area()*orientation_measure(left.cone) + right_cost[b+1];
+
+		if(cost < best_cost) {
+			best_cost = cost;
+			best_bin = b;
+		}
+	}
+
+	/* partition emitters */
+	int mid;
+
+	if(best_bin != -1) {
+		binner.bin = best_bin;
+		mid = std::partition(emitters.begin() + start, emitters.begin() + end, binner) - emitters.begin();
+	}
+	else {
+		mid = (start + end)/2;
+		std::nth_element(emitters.begin() + start, emitters.begin() + mid, emitters.begin() + end, LightTreeCentroidLess(dim));
+	}
+
+	/* left child is stored directly after this node, right child index is
+	 * filled in once the left subtree is done */
+	int index = add_node(node, 0, 0, 0);
+
+	recursive_build(emitters, start, mid);
+	int right_index = recursive_build(emitters, mid, end);
+
+	nodes[index*NODE_SIZE + 3].x = __int_as_float(right_index);
+
+	return index;
+}
+
+LightTree::Node LightTree::make_node(const vector<Emitter>& emitters, int start, int end)
+{
+	Node node;
+
+	node.bounds = emitters[start].bounds;
+	node.cone.axis = emitters[start].axis;
+	node.cone.theta_o = 0.0f;
+	node.energy = emitters[start].energy;
+
+	for(int i = start + 1; i < end; i++) {
+		Cone cone;
+		cone.axis = emitters[i].axis;
+		cone.theta_o = 0.0f;
+
+		node.bounds.grow(emitters[i].bounds);
+		node.cone = merge_cones(node.cone, cone);
+		node.energy += emitters[i].energy;
+	}
+
+	return node;
+}
+
+int LightTree::add_node(const Node& node, int right_child, int first, int num)
+{
+	int index = nodes.size()/NODE_SIZE;
+	float3 bmin = node.bounds.min;
+	float3 bmax = node.bounds.max;
+	float3 axis = node.cone.axis;
+
+	nodes.push_back(make_float4(bmin.x, bmin.y, bmin.z, node.energy));
+	nodes.push_back(make_float4(bmax.x, bmax.y, bmax.z, 0.0f));
+	nodes.push_back(make_float4(axis.x, axis.y, axis.z, cosf(node.cone.theta_o)));
+	nodes.push_back(make_float4(__int_as_float(right_child), __int_as_float(first), __int_as_float(num), 0.0f));
+
+	return index;
+}
+
+LightTree::Cone LightTree::merge_cones(const Cone& a_, const Cone& b_)
+{
+	/* emitters are two sided, so cones bound normals in both directions and
+	 * never need to be wider than 90 degrees */
+	Cone a = a_, b = b_;
+
+	if(b.theta_o > a.theta_o)
+		swap(a, b);
+
+	if(dot(a.axis, b.axis) < 0.0f)
+		b.axis = -b.axis;
+
+	float theta_d = safe_acosf(dot(a.axis, b.axis));
+
+	if(theta_d + b.theta_o <= a.theta_o)
+		return a;
+
+	Cone cone;
+	cone.theta_o = 0.5f*(a.theta_o + theta_d + b.theta_o);
+
+	if(cone.theta_o >= M_PI_2_F) {
+		cone.axis = a.axis;
+		cone.theta_o = M_PI_2_F;
+		return cone;
+	}
+
+	float3 rotation_axis = cross(a.axis, b.axis);
+
+	if(len_squared(rotation_axis) == 0.0f) {
+		cone.axis = a.axis;
+		return cone;
+	}
+
+	cone.axis = normalize(rotate_around_axis(a.axis, normalize(rotation_axis), cone.theta_o - a.theta_o));
+
+	return cone;
+}
+
+float LightTree::orientation_measure(const Cone& cone)
+{
+	/* solid angle measure of the normal cone extended by the emission
+	 * spread, with emission over the entire hemisphere */
+	float theta_o = cone.theta_o;
+	float theta_w = min(theta_o + M_PI_2_F, M_PI_F);
+	float sin_theta_o = sinf(theta_o);
+	float cos_theta_o = cosf(theta_o);
+
+	return M_2PI_F*(1.0f - cos_theta_o) +
+		M_PI_2_F*(2.0f*theta_w*sin_theta_o - cosf(theta_o - 2.0f*theta_w) - 2.0f*theta_o*sin_theta_o + cos_theta_o);
+}
+
+CCL_NAMESPACE_END
+
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel_types.h"
+
+#include "util_boundbox.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Bounding volume hierarchy over emissive triangles, used to pick lights
+ * relative to the shading point instead of only proportional to their area.
+ * Each node stores the bounds, total emitting area and a cone bounding the
+ * normals of the emitters below it, from which the kernel estimates how much
+ * light the node contributes to a shading point.
+ *
+ * Nodes are stored depth first, with the left child directly after its parent
+ * and the index of the right child stored in the node. Leaves refer to a
+ * range of emitters, in the order in which they are stored after building. */
+
+class LightTree {
+public:
+	struct Emitter {
+		BoundBox bounds;
+		float3 centroid;
+		float3 axis;
+		float energy;
+		int index;
+	};
+
+	LightTree();
+
+	/* build tree, this reorders the emitters to the order of the leaves */
+	void build(vector<Emitter>& emitters);
+
+	/* packed nodes for the kernel, and leaf node for each emitter */
+	vector<float4> nodes;
+	vector<int> emitter_leaf;
+
+	enum { NODE_SIZE = LIGHT_TREE_NODE_SIZE, MAX_LEAF_SIZE = 1, NUM_BINS = 12 };
+
+protected:
+	struct Cone {
+		float3 axis;
+		float theta_o;
+	};
+
+	struct Node {
+		BoundBox bounds;
+		Cone cone;
+		float energy;
+	};
+
+	int recursive_build(vector<Emitter>& emitters, int start, int end);
+	int add_node(const Node& node, int right_child, int first, int num);
+	Node make_node(const vector<Emitter>& emitters, int start, int end);
+
+	static Cone merge_cones(const Cone& a, const Cone& b);
+	static float orientation_measure(const Cone& cone);
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
+
@@ -31,6 +31,7 @@
 #include "util_foreach.h"
 #include "util_progress.h"
 #include "util_set.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -389,12 +390,21 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 		vector<Object*> objects;
 		objects.push_back(&object);
 
-		if(bvh && !need_update_rebuild) {
+		/* refit when only vertex positions changed, as long as the BVH was
+		 * built with the same parameters and refitting keeps it fast enough */
+		bool rebuild = (!bvh || need_update_rebuild ||
+		                bvh->params.use_qbvh != params->use_qbvh ||
+		                bvh->params.use_spatial_split != params->use_bvh_spatial_split);
+
+		if(!rebuild) {
 			progress->set_status(msg, "Refitting BVH");
 			bvh->objects = objects;
-			bvh->refit(*progress);
+
+			if(!bvh->refit(*progress) && !progress->get_cancel())
+				rebuild = true;
 		}
-		else {
+
+		if(rebuild) {
 			progress->set_status(msg, "Building BVH");
 
 			BVHParams bparams;
@@ -455,6 +465,12 @@ void MeshManager::update_osl_attributes(Device *device, Scene *scene, vector<Att
 
 	og->attribute_map.resize(scene->objects.size()*ATTR_PRIM_TYPES);
 
+	/* index of each mesh, instances look up the attributes of their mesh */
+	map<Mesh*, size_t> mesh_index_map;
+
+	for(size_t j = 0; j < scene->meshes.size(); j++)
+		mesh_index_map[scene->meshes[j]] = j;
+
 	for(size_t i = 0; i < scene->objects.size(); i++) {
 		/* set object name to object index map */
 		Object *object = scene->objects[i];
@@ -475,13 +491,7 @@ void MeshManager::update_osl_attributes(Device *device, Scene *scene, vector<Att
 		}
 
 		/* find mesh attributes */
-		size_t j;
-
-		for(j = 0; j < scene->meshes.size(); j++)
-			if(scene->meshes[j] == object->mesh)
-				break;
-
-		AttributeRequestSet& attributes = mesh_attributes[j];
+		AttributeRequestSet& attributes = mesh_attributes[mesh_index_map[object->mesh]];
 
 		/* set object attributes */
 		foreach(AttributeRequest& req, attributes.requests) {
@@ -545,24 +555,16 @@ void MeshManager::update_svm_attributes(Device *device, DeviceScene *dscene, Sce
 	if(attr_map_stride == 0)
 		return;
 	
-	/* create attribute map */
-	uint4 *attr_map = dscene->attributes_map.resize(attr_map_stride*scene->objects.size());
+	/* create attribute map, one per mesh so that all objects instancing
+	 * the mesh share it */
+	uint4 *attr_map = dscene->attributes_map.resize(attr_map_stride*scene->meshes.size());
 	memset(attr_map, 0, dscene->attributes_map.size()*sizeof(uint));
 
-	for(size_t i = 0; i < scene->objects.size(); i++) {
-		Object *object = scene->objects[i];
-		Mesh *mesh = object->mesh;
-
-		/* find mesh attributes */
-		size_t j;
-
-		for(j = 0; j < scene->meshes.size(); j++)
-			if(scene->meshes[j] == mesh)
-				break;
-
-		AttributeRequestSet& attributes = mesh_attributes[j];
+	for(size_t i = 0; i < scene->meshes.size(); i++) {
+		Mesh *mesh = scene->meshes[i];
+		AttributeRequestSet& attributes = mesh_attributes[i];
 
-		/* set object attributes */
+		/* set mesh attributes */
 		int index = i*attr_map_stride;
 
 		foreach(AttributeRequest& req, attributes.requests) {
@@ -867,6 +869,8 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	}
 
 	dscene->data.bvh.root = pack.root_index;
+	dscene->data.bvh.use_qbvh = scene->params.use_qbvh;
+	dscene->data.bvh.use_ray_packets = scene->params.use_ray_packets;
 }
 
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
@@ -918,7 +922,8 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 		if(progress.get_cancel()) return;
 	}
 
-	/* update bvh */
+	/* update bvh, the time is recorded separately from the total mesh update */
+	double bvh_time = time_dt();
 	size_t i = 0, num_bvh = 0;
 
 	foreach(Mesh *mesh, scene->meshes)
@@ -954,6 +959,8 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	device_update_bvh(device, dscene, scene, progress);
 
+	device->stats.add_update_time("BVH", time_dt() - bvh_time);
+
 	need_update = false;
 }
 
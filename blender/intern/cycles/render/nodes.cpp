@@ -20,11 +20,25 @@
 #include "osl.h"
 #include "sky_model.h"
 
+#include "util_color.h"
 #include "util_foreach.h"
 #include "util_transform.h"
 
+/* kernel functions shared with constant folding */
+#include "svm_color_util.h"
+#include "svm_math_util.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Constant Folding */
+
+static bool input_is_constant(ShaderInput *input)
+{
+	/* unlinked inputs with a default value get linked to e.g. texture
+	 * coordinates later on, so they are not constant */
+	return !input->link && input->default_value == ShaderInput::NONE;
+}
+
 /* Texture Mapping */
 
 TextureMapping::TextureMapping()
@@ -1311,6 +1325,44 @@ ConvertNode::ConvertNode(ShaderSocketType from_, ShaderSocketType to_, bool auto
 		assert(0);
 }
 
+bool ConvertNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *in = inputs[0];
+
+	if(!input_is_constant(in))
+		return false;
+
+	/* int and string conversions are left to the compiler */
+	if(from == SHADER_SOCKET_FLOAT) {
+		if(to == SHADER_SOCKET_INT)
+			return false;
+
+		*optimized_value = make_float3(in->value.x, in->value.x, in->value.x);
+	}
+	else if(from == SHADER_SOCKET_COLOR || from == SHADER_SOCKET_VECTOR ||
+	        from == SHADER_SOCKET_POINT || from == SHADER_SOCKET_NORMAL)
+	{
+		if(to == SHADER_SOCKET_INT)
+			return false;
+		else if(to == SHADER_SOCKET_FLOAT && from == SHADER_SOCKET_COLOR)
+			*optimized_value = make_float3(linear_rgb_to_gray(in->value), 0.0f, 0.0f);
+		else if(to == SHADER_SOCKET_FLOAT)
+			*optimized_value = make_float3((in->value.x + in->value.y + in->value.z)*(1.0f/3.0f), 0.0f, 0.0f);
+		else
+			*optimized_value = in->value;
+	}
+	else
+		return false;
+
+	return true;
+}
+
+bool ConvertNode::equals(const ShaderNode *other) const
+{
+	const ConvertNode *convert = static_cast<const ConvertNode*>(other);
+	return from == convert->from && to == convert->to && equal_inputs(other);
+}
+
 void ConvertNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *in = inputs[0];
@@ -1434,6 +1486,13 @@ BsdfNode::BsdfNode(bool scattering_)
 	}
 }
 
+bool BsdfNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	/* closure with black color has zero weight */
+	ShaderInput *color_in = input("Color");
+	return input_is_constant(color_in) && is_zero(color_in->value);
+}
+
 void BsdfNode::compile(SVMCompiler& compiler, ShaderInput *param1, ShaderInput *param2, ShaderInput *param3, ShaderInput *param4)
 {
 	ShaderInput *color_in = input("Color");
@@ -1806,6 +1865,15 @@ EmissionNode::EmissionNode()
 	add_output("Emission", SHADER_SOCKET_CLOSURE);
 }
 
+bool EmissionNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *color_in = input("Color");
+	ShaderInput *strength_in = input("Strength");
+
+	return (input_is_constant(color_in) && is_zero(color_in->value)) ||
+	       (input_is_constant(strength_in) && strength_in->value.x == 0.0f);
+}
+
 void EmissionNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *color_in = input("Color");
@@ -2058,6 +2126,11 @@ GeometryNode::GeometryNode()
 	add_output("Backfacing", SHADER_SOCKET_FLOAT);
 }
 
+bool GeometryNode::equals(const ShaderNode *other) const
+{
+	return equal_inputs(other);
+}
+
 void GeometryNode::attributes(AttributeRequestSet *attributes)
 {
 	if(!output("Tangent")->links.empty())
@@ -2148,6 +2221,12 @@ TextureCoordinateNode::TextureCoordinateNode()
 	from_dupli = false;
 }
 
+bool TextureCoordinateNode::equals(const ShaderNode *other) const
+{
+	const TextureCoordinateNode *texco = static_cast<const TextureCoordinateNode*>(other);
+	return from_dupli == texco->from_dupli && equal_inputs(other);
+}
+
 void TextureCoordinateNode::attributes(AttributeRequestSet *attributes)
 {
 	if(!from_dupli) {
@@ -2613,6 +2692,17 @@ ValueNode::ValueNode()
 	add_output("Value", SHADER_SOCKET_FLOAT);
 }
 
+bool ValueNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	*optimized_value = make_float3(value, 0.0f, 0.0f);
+	return true;
+}
+
+bool ValueNode::equals(const ShaderNode *other) const
+{
+	return value == static_cast<const ValueNode*>(other)->value;
+}
+
 void ValueNode::compile(SVMCompiler& compiler)
 {
 	ShaderOutput *val_out = output("Value");
@@ -2637,6 +2727,18 @@ ColorNode::ColorNode()
 	add_output("Color", SHADER_SOCKET_COLOR);
 }
 
+bool ColorNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	*optimized_value = value;
+	return true;
+}
+
+bool ColorNode::equals(const ShaderNode *other) const
+{
+	const ColorNode *color = static_cast<const ColorNode*>(other);
+	return value.x == color->value.x && value.y == color->value.y && value.z == color->value.z;
+}
+
 void ColorNode::compile(SVMCompiler& compiler)
 {
 	ShaderOutput *color_out = output("Color");
@@ -2665,6 +2767,12 @@ AddClosureNode::AddClosureNode()
 	add_output("Closure",  SHADER_SOCKET_CLOSURE);
 }
 
+bool AddClosureNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	/* adding two empty closures */
+	return !inputs[0]->link && !inputs[1]->link;
+}
+
 void AddClosureNode::compile(SVMCompiler& compiler)
 {
 	/* handled in the SVM compiler */
@@ -2688,6 +2796,12 @@ MixClosureNode::MixClosureNode()
 	add_output("Closure",  SHADER_SOCKET_CLOSURE);
 }
 
+bool MixClosureNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	/* mixing two empty closures */
+	return !input("Closure1")->link && !input("Closure2")->link;
+}
+
 void MixClosureNode::compile(SVMCompiler& compiler)
 {
 	/* handled in the SVM compiler */
@@ -2741,6 +2855,25 @@ InvertNode::InvertNode()
 	add_output("Color",  SHADER_SOCKET_COLOR);
 }
 
+bool InvertNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *fac_in = input("Fac");
+	ShaderInput *color_in = input("Color");
+
+	if(input_is_constant(fac_in) && input_is_constant(color_in)) {
+		float3 color = color_in->value;
+		*optimized_value = interp(color, make_float3(1.0f, 1.0f, 1.0f) - color, fac_in->value.x);
+		return true;
+	}
+
+	return false;
+}
+
+bool InvertNode::equals(const ShaderNode *other) const
+{
+	return equal_inputs(other);
+}
+
 void InvertNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *fac_in = input("Fac");
@@ -2802,6 +2935,31 @@ static ShaderEnum mix_type_init()
 
 ShaderEnum MixNode::type_enum = mix_type_init();
 
+bool MixNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *fac_in = input("Fac");
+	ShaderInput *color1_in = input("Color1");
+	ShaderInput *color2_in = input("Color2");
+
+	if(input_is_constant(fac_in) && input_is_constant(color1_in) && input_is_constant(color2_in)) {
+		float3 color = svm_mix((NodeMix)type_enum[type], fac_in->value.x, color1_in->value, color2_in->value);
+
+		if(use_clamp)
+			color = svm_mix_clamp(color);
+
+		*optimized_value = color;
+		return true;
+	}
+
+	return false;
+}
+
+bool MixNode::equals(const ShaderNode *other) const
+{
+	const MixNode *mix = static_cast<const MixNode*>(other);
+	return type == mix->type && use_clamp == mix->use_clamp && equal_inputs(other);
+}
+
 void MixNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *fac_in = input("Fac");
@@ -2840,6 +2998,25 @@ CombineRGBNode::CombineRGBNode()
 	add_output("Image", SHADER_SOCKET_COLOR);
 }
 
+bool CombineRGBNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *red_in = input("R");
+	ShaderInput *green_in = input("G");
+	ShaderInput *blue_in = input("B");
+
+	if(input_is_constant(red_in) && input_is_constant(green_in) && input_is_constant(blue_in)) {
+		*optimized_value = make_float3(red_in->value.x, green_in->value.x, blue_in->value.x);
+		return true;
+	}
+
+	return false;
+}
+
+bool CombineRGBNode::equals(const ShaderNode *other) const
+{
+	return equal_inputs(other);
+}
+
 void CombineRGBNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *red_in = input("R");
@@ -2904,6 +3081,34 @@ GammaNode::GammaNode()
 	add_output("Color", SHADER_SOCKET_COLOR);
 }
 
+bool GammaNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *color_in = input("Color");
+	ShaderInput *gamma_in = input("Gamma");
+
+	if(input_is_constant(color_in) && input_is_constant(gamma_in)) {
+		float3 color = color_in->value;
+		float gamma = gamma_in->value.x;
+
+		if(color.x > 0.0f)
+			color.x = powf(color.x, gamma);
+		if(color.y > 0.0f)
+			color.y = powf(color.y, gamma);
+		if(color.z > 0.0f)
+			color.z = powf(color.z, gamma);
+
+		*optimized_value = color;
+		return true;
+	}
+
+	return false;
+}
+
+bool GammaNode::equals(const ShaderNode *other) const
+{
+	return equal_inputs(other);
+}
+
 void GammaNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *color_in = input("Color");
@@ -2964,6 +3169,28 @@ SeparateRGBNode::SeparateRGBNode()
 	add_output("B", SHADER_SOCKET_FLOAT);
 }
 
+bool SeparateRGBNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *color_in = input("Image");
+
+	if(!input_is_constant(color_in))
+		return false;
+
+	if(socket == output("R"))
+		*optimized_value = make_float3(color_in->value.x, 0.0f, 0.0f);
+	else if(socket == output("G"))
+		*optimized_value = make_float3(color_in->value.y, 0.0f, 0.0f);
+	else
+		*optimized_value = make_float3(color_in->value.z, 0.0f, 0.0f);
+
+	return true;
+}
+
+bool SeparateRGBNode::equals(const ShaderNode *other) const
+{
+	return equal_inputs(other);
+}
+
 void SeparateRGBNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *color_in = input("Image");
@@ -3069,6 +3296,11 @@ AttributeNode::AttributeNode()
 	add_output("Fac",  SHADER_SOCKET_FLOAT);
 }
 
+bool AttributeNode::equals(const ShaderNode *other) const
+{
+	return attribute == static_cast<const AttributeNode*>(other)->attribute && equal_inputs(other);
+}
+
 void AttributeNode::attributes(AttributeRequestSet *attributes)
 {
 	ShaderOutput *color_out = output("Color");
@@ -3373,6 +3605,30 @@ static ShaderEnum math_type_init()
 
 ShaderEnum MathNode::type_enum = math_type_init();
 
+bool MathNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *value1_in = input("Value1");
+	ShaderInput *value2_in = input("Value2");
+
+	if(input_is_constant(value1_in) && input_is_constant(value2_in)) {
+		float value = svm_math((NodeMath)type_enum[type], value1_in->value.x, value2_in->value.x);
+
+		if(use_clamp)
+			value = clamp(value, 0.0f, 1.0f);
+
+		*optimized_value = make_float3(value, 0.0f, 0.0f);
+		return true;
+	}
+
+	return false;
+}
+
+bool MathNode::equals(const ShaderNode *other) const
+{
+	const MathNode *math = static_cast<const MathNode*>(other);
+	return type == math->type && use_clamp == math->use_clamp && equal_inputs(other);
+}
+
 void MathNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *value1_in = input("Value1");
@@ -3428,6 +3684,34 @@ static ShaderEnum vector_math_type_init()
 
 ShaderEnum VectorMathNode::type_enum = vector_math_type_init();
 
+bool VectorMathNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *vector1_in = input("Vector1");
+	ShaderInput *vector2_in = input("Vector2");
+
+	if(input_is_constant(vector1_in) && input_is_constant(vector2_in)) {
+		float value;
+		float3 vector;
+
+		svm_vector_math(&value, &vector, (NodeVectorMath)type_enum[type], vector1_in->value, vector2_in->value);
+
+		if(socket == output("Value"))
+			*optimized_value = make_float3(value, 0.0f, 0.0f);
+		else
+			*optimized_value = vector;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool VectorMathNode::equals(const ShaderNode *other) const
+{
+	const VectorMathNode *math = static_cast<const VectorMathNode*>(other);
+	return type == math->type && equal_inputs(other);
+}
+
 void VectorMathNode::compile(SVMCompiler& compiler)
 {
 	ShaderInput *vector1_in = input("Vector1");
@@ -190,6 +190,9 @@ public:
 	ConvertNode(ShaderSocketType from, ShaderSocketType to, bool autoconvert = false);
 	SHADER_NODE_BASE_CLASS(ConvertNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	ShaderSocketType from, to;
 };
 
@@ -206,6 +209,8 @@ public:
 	BsdfNode(bool scattering = false);
 	SHADER_NODE_BASE_CLASS(BsdfNode);
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+
 	void compile(SVMCompiler& compiler, ShaderInput *param1, ShaderInput *param2, ShaderInput *param3 = NULL, ShaderInput *param4 = NULL);
 
 	ClosureType closure;
@@ -285,6 +290,8 @@ class EmissionNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(EmissionNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+
 	bool has_surface_emission() { return true; }
 
 	bool total_power;
@@ -336,12 +343,14 @@ public:
 class GeometryNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(GeometryNode)
+	bool equals(const ShaderNode *other) const;
 	void attributes(AttributeRequestSet *attributes);
 };
 
 class TextureCoordinateNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(TextureCoordinateNode)
+	bool equals(const ShaderNode *other) const;
 	void attributes(AttributeRequestSet *attributes);
 	
 	bool from_dupli;
@@ -379,6 +388,9 @@ class ValueNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(ValueNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	float value;
 };
 
@@ -386,17 +398,24 @@ class ColorNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(ColorNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	float3 value;
 };
 
 class AddClosureNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(AddClosureNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
 };
 
 class MixClosureNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MixClosureNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
 };
 
 class MixClosureWeightNode : public ShaderNode {
@@ -407,12 +426,18 @@ public:
 class InvertNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(InvertNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
 };
 
 class MixNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MixNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	bool use_clamp;
 
 	ustring type;
@@ -422,6 +447,9 @@ public:
 class CombineRGBNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(CombineRGBNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
 };
 
 class CombineHSVNode : public ShaderNode {
@@ -432,6 +460,9 @@ public:
 class GammaNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(GammaNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
 };
 
 class BrightContrastNode : public ShaderNode {
@@ -442,6 +473,9 @@ public:
 class SeparateRGBNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(SeparateRGBNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
 };
 
 class SeparateHSVNode : public ShaderNode {
@@ -457,6 +491,7 @@ public:
 class AttributeNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(AttributeNode)
+	bool equals(const ShaderNode *other) const;
 	void attributes(AttributeRequestSet *attributes);
 
 	ustring attribute;
@@ -500,6 +535,9 @@ class MathNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MathNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	bool use_clamp;
 
 	ustring type;
@@ -517,6 +555,9 @@ class VectorMathNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(VectorMathNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) const;
+
 	ustring type;
 	static ShaderEnum type_enum;
 };
@@ -155,10 +155,15 @@ void ObjectManager::device_update_transforms(Device *device, DeviceScene *dscene
 	float4 *objects_vector = NULL;
 	int i = 0;
 	map<Mesh*, float> surface_area_map;
+	map<Mesh*, uint> mesh_index_map;
 	Scene::MotionType need_motion = scene->need_motion(device->info.advanced_shading);
 	bool have_motion = false;
 	bool have_curves = false;
 
+	/* instances share the attribute map of their mesh */
+	for(size_t j = 0; j < scene->meshes.size(); j++)
+		mesh_index_map[scene->meshes[j]] = j;
+
 	objects = dscene->objects.resize(OBJECT_SIZE*scene->objects.size());
 	if(need_motion == Scene::MOTION_PASS)
 		objects_vector = dscene->objects_vector.resize(OBJECT_VECTOR_SIZE*scene->objects.size());
@@ -276,7 +281,7 @@ void ObjectManager::device_update_transforms(Device *device, DeviceScene *dscene
 #endif
 
 		/* dupli object coords */
-		objects[offset+9] = make_float4(ob->dupli_generated[0], ob->dupli_generated[1], ob->dupli_generated[2], 0.0f);
+		objects[offset+9] = make_float4(ob->dupli_generated[0], ob->dupli_generated[1], ob->dupli_generated[2], __uint_as_float(mesh_index_map[mesh]));
 		objects[offset+10] = make_float4(ob->dupli_uv[0], ob->dupli_uv[1], 0.0f, 0.0f);
 
 		/* object flag */
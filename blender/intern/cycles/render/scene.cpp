@@ -17,6 +17,7 @@
 #include <stdlib.h>
 
 #include "background.h"
+#include "bake.h"
 #include "camera.h"
 #include "curves.h"
 #include "device.h"
@@ -34,6 +35,7 @@
 
 #include "util_foreach.h"
 #include "util_progress.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -54,6 +56,7 @@ Scene::Scene(const SceneParams& params_, const DeviceInfo& device_info_)
 	image_manager = new ImageManager();
 	particle_system_manager = new ParticleSystemManager();
 	curve_system_manager = new CurveSystemManager();
+	bake_manager = new BakeManager();
 
 	/* OSL only works on the CPU */
 	if(device_info_.type == DEVICE_CPU)
@@ -61,8 +64,13 @@ Scene::Scene(const SceneParams& params_, const DeviceInfo& device_info_)
 	else
 		shader_manager = ShaderManager::create(this, SceneParams::SVM);
 
-	if (device_info_.type == DEVICE_CPU)
+	if (device_info_.type == DEVICE_CPU) {
 		image_manager->set_extended_image_limits();
+
+		/* on demand loading of tiled images */
+		if(params.texture_cache_size > 0)
+			image_manager->set_texture_cache_size((size_t)params.texture_cache_size * 1024 * 1024);
+	}
 }
 
 Scene::~Scene()
@@ -122,6 +130,7 @@ void Scene::free_memory(bool final)
 		delete particle_system_manager;
 		delete curve_system_manager;
 		delete image_manager;
+		delete bake_manager;
 	}
 }
 
@@ -140,6 +149,9 @@ void Scene::device_update(Device *device_, Progress& progress)
 	 * - Light manager needs final mesh data to compute emission CDF.
 	 */
 	
+	/* time spent in each manager is recorded for render statistics */
+	double update_time;
+
 	image_manager->set_pack_images(device->info.pack_images);
 
 	progress.set_status("Updating Background");
@@ -148,12 +160,16 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Shaders");
+	update_time = time_dt();
 	shader_manager->device_update(device, &dscene, this, progress);
+	device->stats.add_update_time("Shaders", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Images");
+	update_time = time_dt();
 	image_manager->device_update(device, &dscene, progress);
+	device->stats.add_update_time("Images", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
@@ -163,22 +179,30 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Objects");
+	update_time = time_dt();
 	object_manager->device_update(device, &dscene, this, progress);
+	device->stats.add_update_time("Objects", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Hair Systems");
+	update_time = time_dt();
 	curve_system_manager->device_update(device, &dscene, this, progress);
+	device->stats.add_update_time("Hair Systems", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Meshes");
+	update_time = time_dt();
 	mesh_manager->device_update(device, &dscene, this, progress);
+	device->stats.add_update_time("Meshes", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Lights");
+	update_time = time_dt();
 	light_manager->device_update(device, &dscene, this, progress);
+	device->stats.add_update_time("Lights", time_dt() - update_time);
 
 	if(progress.get_cancel()) return;
 
@@ -32,6 +32,7 @@
 CCL_NAMESPACE_BEGIN
 
 class AttributeRequestSet;
+class BakeManager;
 class Background;
 class Camera;
 class Device;
@@ -88,6 +89,8 @@ public:
 	device_vector<float4> light_data;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
+	device_vector<float4> light_tree_nodes;
+	device_vector<uint> light_tree_prim_map;
 
 	/* particles */
 	device_vector<float4> particles;
@@ -123,7 +126,9 @@ public:
 	bool use_bvh_cache;
 	bool use_bvh_spatial_split;
 	bool use_qbvh;
+	bool use_ray_packets;
 	bool persistent_data;
+	int texture_cache_size; /* megabytes, zero to load images entirely */
 
 	SceneParams()
 	{
@@ -136,7 +141,9 @@ public:
 #else
 		use_qbvh = false;
 #endif
+		use_ray_packets = false;
 		persistent_data = false;
+		texture_cache_size = 0;
 	}
 
 	bool modified(const SceneParams& params)
@@ -145,7 +152,9 @@ public:
 		&& use_bvh_cache == params.use_bvh_cache
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_qbvh == params.use_qbvh
-		&& persistent_data == params.persistent_data); }
+		&& use_ray_packets == params.use_ray_packets
+		&& persistent_data == params.persistent_data
+		&& texture_cache_size == params.texture_cache_size); }
 };
 
 /* Scene */
@@ -174,6 +183,7 @@ public:
 	ObjectManager *object_manager;
 	ParticleSystemManager *particle_system_manager;
 	CurveSystemManager *curve_system_manager;
+	BakeManager *bake_manager;
 
 	/* default shaders */
 	int default_surface;
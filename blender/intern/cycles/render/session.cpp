@@ -23,6 +23,7 @@
 #include "integrator.h"
 #include "scene.h"
 #include "session.h"
+#include "shader.h"
 
 #include "util_foreach.h"
 #include "util_function.h"
@@ -48,6 +49,8 @@ Session::Session(const SessionParams& params_)
 
 	TaskScheduler::init(params.threads);
 
+	stats.use_render_stats = params.use_render_stats;
+	stats.time_limit = (params.background)? params.time_limit: 0.0;
 	device = Device::create(params.device, stats, params.background);
 
 	if(params.background) {
@@ -66,6 +69,7 @@ Session::Session(const SessionParams& params_)
 	reset_time = 0.0;
 	preview_time = 0.0;
 	paused_time = 0.0;
+	pixel_sample_time = 0.0;
 	last_update_time = 0.0;
 
 	delayed_reset.do_reset = false;
@@ -196,7 +200,7 @@ void Session::run_gpu()
 
 	while(!progress.get_cancel()) {
 		/* advance to next tile */
-		bool no_tiles = !tile_manager.next();
+		bool no_tiles = time_limit_reached() || !tile_manager.next();
 
 		if(params.background) {
 			/* if no work left and in background mode, we can stop immediately */
@@ -259,10 +263,15 @@ void Session::run_gpu()
 			update_status_time();
 
 			/* path trace */
+			double render_time = time_dt();
+
 			path_trace();
 
 			device->task_wait();
 
+			if(!delayed_reset.do_reset)
+				update_pixel_sample_time(time_dt() - render_time);
+
 			if(device->error_message() != "")
 				progress.set_cancel(device->error_message());
 
@@ -362,6 +371,13 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	rtile.start_sample = tile_manager.state.sample;
 	rtile.num_samples = tile_manager.state.num_samples;
 	rtile.resolution = tile_manager.state.resolution_divider;
+	rtile.start_time = time_dt();
+	rtile.stop_time = 0.0;
+
+	/* with a time limit the tile stops sampling after its share of the
+	 * remaining time, progressive refine stops after a whole sample */
+	if(params.background && params.time_limit > 0.0 && !params.progressive_refine)
+		rtile.stop_time = tile_stop_time(tile);
 
 	tile_lock.unlock();
 
@@ -445,6 +461,9 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
+	if(params.use_render_stats)
+		stats.add_tile(rtile.x, rtile.y, rtile.w, rtile.h, rtile.sample - rtile.start_sample, time_dt() - rtile.start_time);
+
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
 			/* todo: optimize this by making it thread safe and removing lock */
@@ -457,6 +476,44 @@ void Session::release_tile(RenderTile& rtile)
 	update_status_time();
 }
 
+bool Session::time_limit_reached()
+{
+	if(!params.background || params.time_limit <= 0.0)
+		return false;
+
+	return (time_dt() - start_time >= params.time_limit);
+}
+
+double Session::tile_stop_time(Tile& tile)
+{
+	double current_time = time_dt();
+	double remaining_time = start_time + params.time_limit - current_time;
+
+	/* always render at least one sample */
+	if(remaining_time <= 0.0)
+		return current_time;
+
+	/* pixels left to render in this tile and tiles that did not start yet */
+	int64_t tile_pixels = (int64_t)tile.w*tile.h;
+	int64_t remaining_pixels = tile_pixels;
+
+	foreach(Tile& other, tile_manager.state.tiles)
+		if(!other.rendering)
+			remaining_pixels += (int64_t)other.w*other.h;
+
+	/* tiles are rendered in parallel by every CPU thread or GPU */
+	int num_parallel;
+
+	if(params.device.type == DEVICE_CPU)
+		num_parallel = max(TaskScheduler::num_threads(), 1);
+	else
+		num_parallel = max((int)params.device.multi_devices.size(), 1);
+
+	double share = (double)(tile_pixels*num_parallel)/(double)remaining_pixels;
+
+	return current_time + remaining_time*min(share, 1.0);
+}
+
 void Session::run_cpu()
 {
 	bool tiles_written = false;
@@ -475,8 +532,9 @@ void Session::run_cpu()
 
 	while(!progress.get_cancel()) {
 		/* advance to next tile */
-		bool no_tiles = !tile_manager.next();
+		bool no_tiles = time_limit_reached() || !tile_manager.next();
 		bool need_tonemap = false;
+		double render_time = 0.0;
 
 		if(params.background) {
 			/* if no work left and in background mode, we can stop immediately */
@@ -541,6 +599,8 @@ void Session::run_cpu()
 			update_status_time();
 
 			/* path trace */
+			render_time = time_dt();
+
 			path_trace();
 
 			/* update status and timing */
@@ -566,6 +626,8 @@ void Session::run_cpu()
 				reset_(delayed_reset.params, delayed_reset.samples);
 			}
 			else if(need_tonemap) {
+				update_pixel_sample_time(time_dt() - render_time);
+
 				/* tonemap only if we do not reset, we don't we don't
 				 * want to show the result of an incomplete sample*/
 				tonemap();
@@ -587,21 +649,8 @@ void Session::run_cpu()
 void Session::run()
 {
 	/* load kernels */
-	if(!kernels_loaded) {
-		progress.set_status("Loading render kernels (may take a few minutes the first time)");
-
-		if(!device->load_kernels(params.experimental)) {
-			string message = device->error_message();
-			if(message == "")
-				message = "Failed loading render kernel, see console for errors";
-
-			progress.set_status("Error", message);
-			progress.set_update();
-			return;
-		}
-
-		kernels_loaded = true;
-	}
+	if(!load_kernels())
+		return;
 
 	/* session thread loop */
 	progress.set_status("Waiting for render to start");
@@ -642,6 +691,13 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 		}
 	}
 
+	/* start at a resolution low enough to show the first sample quickly,
+	 * based on how long previous samples took */
+	if(!params.background && pixel_sample_time > 0.0) {
+		double start_pixels = params.start_resolution_time / pixel_sample_time;
+		tile_manager.set_start_pixels((start_pixels < (double)INT_MAX)? (int)start_pixels: INT_MAX);
+	}
+
 	tile_manager.reset(buffer_params, samples);
 
 	start_time = time_dt();
@@ -707,6 +763,45 @@ void Session::wait()
 	session_thread = NULL;
 }
 
+bool Session::load_kernels()
+{
+	if(kernels_loaded)
+		return true;
+
+	progress.set_status("Loading render kernels (may take a few minutes the first time)");
+
+	if(!device->load_kernels(params.experimental)) {
+		string message = device->error_message();
+		if(message == "")
+			message = "Failed loading render kernel, see console for errors";
+
+		progress.set_status("Error", message);
+		progress.set_update();
+		return false;
+	}
+
+	kernels_loaded = true;
+	return true;
+}
+
+void Session::update_pixel_sample_time(double render_time)
+{
+	if(params.background)
+		return;
+
+	int resolution = tile_manager.state.resolution_divider;
+	int width = max(1, tile_manager.params.width/resolution);
+	int height = max(1, tile_manager.params.height/resolution);
+	int num_samples = max(1, tile_manager.state.num_samples);
+	double time = render_time/((double)width*height*num_samples);
+
+	/* average with previous samples, single samples are noisy */
+	if(pixel_sample_time == 0.0)
+		pixel_sample_time = time;
+	else
+		pixel_sample_time = 0.5*(pixel_sample_time + time);
+}
+
 void Session::update_scene()
 {
 	thread_scoped_lock scene_lock(scene->mutex);
@@ -740,8 +835,12 @@ void Session::update_scene()
 
 	/* update scene */
 	if(scene->need_update()) {
+		double update_time = time_dt();
+
 		progress.set_status("Updating Scene");
 		scene->device_update(device, progress);
+
+		device->stats.add_update_time("Total", time_dt() - update_time);
 	}
 }
 
@@ -782,6 +881,17 @@ void Session::update_status_time(bool show_pause, bool show_done)
 
 			substatus += string_printf(", Sample %d/%d", sample, num_samples);
 		}
+
+		uint64_t skipped_pixel_samples = progress.get_skipped_pixel_samples();
+
+		if(skipped_pixel_samples > 0) {
+			/* pixel samples saved by adaptive sampling */
+			uint64_t num_pixel_samples = (uint64_t)tile_manager.params.width *
+				tile_manager.params.height * tile_manager.num_samples;
+
+			substatus += string_printf(", Adaptive %.1f%% Saved",
+				100.0 * (double)skipped_pixel_samples / (double)num_pixel_samples);
+		}
 	}
 	else if(tile_manager.num_samples == USHRT_MAX)
 		substatus = string_printf("Path Tracing Sample %d", sample+1);
@@ -818,6 +928,11 @@ void Session::update_progress_sample()
 	progress.increment_sample();
 }
 
+void Session::update_progress_skipped_samples(int num_samples, uint64_t num_pixel_samples)
+{
+	progress.add_skipped_samples(num_samples, num_pixel_samples);
+}
+
 void Session::path_trace()
 {
 	/* add path trace task */
@@ -828,6 +943,7 @@ void Session::path_trace()
 	task.get_cancel = function_bind(&Progress::get_cancel, &this->progress);
 	task.update_tile_sample = function_bind(&Session::update_tile_sample, this, _1);
 	task.update_progress_sample = function_bind(&Session::update_progress_sample, this);
+	task.update_progress_skipped_samples = function_bind(&Session::update_progress_skipped_samples, this, _1, _2);
 	task.need_finish_queue = params.progressive_refine;
 	task.integrator_branched = scene->integrator->method == Integrator::BRANCHED_PATH;
 
@@ -905,4 +1021,20 @@ void Session::device_free()
 	 */
 }
 
+string Session::render_stats_json()
+{
+	vector<string> shader_names;
+
+	if(scene) {
+		foreach(Shader *shader, scene->shaders)
+			shader_names.push_back(shader->name);
+	}
+
+	int tile;
+	double total_time, tile_time;
+	progress.get_tile(tile, total_time, tile_time);
+
+	return stats.render_stats_json(shader_names, total_time);
+}
+
 CCL_NAMESPACE_END
@@ -55,9 +55,16 @@ public:
 
 	bool display_buffer_linear;
 
+	bool use_render_stats;
+
 	double cancel_timeout;
 	double reset_timeout;
 	double text_timeout;
+	double start_resolution_time;
+
+	/* render time limit in seconds for final renders, samples are
+	 * distributed over tiles to finish close to it, zero if unlimited */
+	double time_limit;
 
 	enum { OSL, SVM } shadingsystem;
 
@@ -76,9 +83,13 @@ public:
 
 		display_buffer_linear = false;
 
+		use_render_stats = false;
+
 		cancel_timeout = 0.1;
 		reset_timeout = 0.1;
 		text_timeout = 1.0;
+		start_resolution_time = 0.02;
+		time_limit = 0.0;
 
 		shadingsystem = SVM;
 		tile_order = TILE_CENTER;
@@ -97,9 +108,12 @@ public:
 		&& start_resolution == params.start_resolution
 		&& threads == params.threads
 		&& display_buffer_linear == params.display_buffer_linear
+		&& use_render_stats == params.use_render_stats
 		&& cancel_timeout == params.cancel_timeout
 		&& reset_timeout == params.reset_timeout
 		&& text_timeout == params.text_timeout
+		&& start_resolution_time == params.start_resolution_time
+		&& time_limit == params.time_limit
 		&& tile_order == params.tile_order
 		&& shadingsystem == params.shadingsystem); }
 
@@ -137,6 +151,12 @@ public:
 	void set_pause(bool pause);
 
 	void device_free();
+
+	/* render statistics as JSON, if enabled in the session parameters */
+	string render_stats_json();
+
+	bool load_kernels();
+	void update_scene();
 protected:
 	struct DelayedReset {
 		thread_mutex mutex;
@@ -147,7 +167,6 @@ protected:
 
 	void run();
 
-	void update_scene();
 	void update_status_time(bool show_pause = false, bool show_done = false);
 
 	void tonemap();
@@ -166,7 +185,12 @@ protected:
 	void update_tile_sample(RenderTile& tile);
 	void release_tile(RenderTile& tile);
 
+	bool time_limit_reached();
+	double tile_stop_time(Tile& tile);
+
 	void update_progress_sample();
+	void update_pixel_sample_time(double render_time);
+	void update_progress_skipped_samples(int num_samples, uint64_t num_pixel_samples);
 
 	bool device_use_gl;
 
@@ -192,6 +216,10 @@ protected:
 	double preview_time;
 	double paused_time;
 
+	/* measured render time per pixel sample in the viewport, to choose the
+	 * start resolution after a reset */
+	double pixel_sample_time;
+
 	/* progressive refine */
 	double last_update_time;
 	bool update_progressive_refine(bool cancel);
@@ -28,6 +28,7 @@ TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, i
 	tile_size = tile_size_;
 	tile_order = tile_order_;
 	start_resolution = start_resolution_;
+	start_pixels = INT_MAX;
 	num_devices = num_devices_;
 	preserve_tile_device = preserve_tile_device_;
 	background = background_;
@@ -48,7 +49,11 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	int w = params.width, h = params.height;
 
 	if(start_resolution != INT_MAX) {
-		while(w*h > start_resolution*start_resolution) {
+		/* the start resolution may be lowered further if the first
+		 * sample would otherwise take too long */
+		int max_pixels = min(start_resolution*start_resolution, start_pixels);
+
+		while(w*h > max_pixels && (w > 1 || h > 1)) {
 			w = max(1, w/2); 
 			h = max(1, h/2); 
 
@@ -80,6 +80,7 @@ public:
 	bool done();
 	
 	void set_tile_order(TileOrder tile_order_) { tile_order = tile_order_; }
+	void set_start_pixels(int start_pixels_) { start_pixels = max(start_pixels_, 1); }
 protected:
 
 	void set_tiles();
@@ -88,6 +89,7 @@ protected:
 	int2 tile_size;
 	TileOrder tile_order;
 	int start_resolution;
+	int start_pixels;
 	int num_devices;
 
 	/* in some cases it is important that the same tile will be returned for the same
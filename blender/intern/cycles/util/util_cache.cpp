@@ -79,22 +79,47 @@ void Cache::insert(CacheData& key, CacheData& value)
 {
 	string filename = data_filename(key);
 	path_create_directories(filename);
-	FILE *f = fopen(filename.c_str(), "wb");
+
+	/* write to a temporary file first and move it in place when done, so that
+	 * other processes sharing the cache never see partially written files */
+#if (BOOST_FILESYSTEM_VERSION == 2)
+	string tmp_filename = filename + ".tmp";
+#else
+	string tmp_filename = boost::filesystem::unique_path(filename + ".%%%%%%%%.tmp").string();
+#endif
+	FILE *f = fopen(tmp_filename.c_str(), "wb");
 
 	if(!f) {
-		fprintf(stderr, "Failed to open file %s for writing.\n", filename.c_str());
+		fprintf(stderr, "Failed to open file %s for writing.\n", tmp_filename.c_str());
 		return;
 	}
 
+	bool ok = true;
+
 	foreach(CacheBuffer& buffer, value.buffers) {
 		if(!fwrite(&buffer.size, sizeof(buffer.size), 1, f))
-			fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+			ok = false;
 		if(buffer.size)
 			if(!fwrite(buffer.data, buffer.size, 1, f))
-				fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+				ok = false;
 	}
 	
-	fclose(f);
+	if(fclose(f) != 0)
+		ok = false;
+
+	boost::system::error_code ec;
+
+	if(ok) {
+		boost::filesystem::rename(tmp_filename, filename, ec);
+
+		if(ec)
+			ok = false;
+	}
+
+	if(!ok) {
+		fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+		boost::filesystem::remove(tmp_filename, ec);
+	}
 }
 
 bool Cache::lookup(CacheData& key, CacheData& value)
@@ -125,7 +150,7 @@ void Cache::clear_except(const string& name, const set<string>& except)
 			string filename = it->path().filename().string();
 #endif
 
-			if(boost::starts_with(filename, name))
+			if(boost::starts_with(filename, name) && !boost::ends_with(filename, ".tmp"))
 				if(except.find(filename) == except.end())
 					boost::filesystem::remove(it->path());
 		}
@@ -96,54 +96,66 @@ public:
 		buffers.push_back(buffer);
 	}
 
-	template<typename T> void read(array<T>& data)
+	/* read functions return false on failure, so corrupted or truncated cache
+	 * files can be detected and the data computed again instead */
+	template<typename T> bool read(array<T>& data)
 	{
 		size_t size;
 
 		if(!fread(&size, sizeof(size), 1, f)) {
 			fprintf(stderr, "Failed to read vector size from cache.\n");
-			return;
+			return false;
 		}
 
-		if(!size)
-			return;
+		if(size % sizeof(T) != 0) {
+			fprintf(stderr, "Invalid vector size in cache (%lu).\n", (unsigned long)size);
+			return false;
+		}
+
+		if(!size) {
+			data.clear();
+			return true;
+		}
 
 		data.resize(size/sizeof(T));
 
 		if(!fread(&data[0], size, 1, f)) {
 			fprintf(stderr, "Failed to read vector data from cache (%lu).\n", (unsigned long)size);
-			return;
+			return false;
 		}
+
+		return true;
 	}
 
-	void read(int& data)
+	template<typename T> bool read_value(T& data, const char *type_name)
 	{
 		size_t size;
 
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read int size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read int from cache.\n");
+		if(!fread(&size, sizeof(size), 1, f) || size != sizeof(data)) {
+			fprintf(stderr, "Failed to read %s size from cache.\n", type_name);
+			return false;
+		}
+		if(!fread(&data, sizeof(data), 1, f)) {
+			fprintf(stderr, "Failed to read %s from cache.\n", type_name);
+			return false;
+		}
+
+		return true;
 	}
 
-	void read(float& data)
+	bool read(int& data)
 	{
-		size_t size;
-
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read float size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read float from cache.\n");
+		return read_value(data, "int");
 	}
 
-	void read(size_t& data)
+	bool read(float& data)
 	{
-		size_t size;
+		return read_value(data, "float");
+	}
 
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read size_t size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read size_t from cache.\n");
+	bool read(size_t& data)
+	{
+		return read_value(data, "size_t");
 	}
 };
 
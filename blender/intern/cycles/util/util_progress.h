@@ -36,6 +36,7 @@ public:
 	{
 		tile = 0;
 		sample = 0;
+		skipped_pixel_samples = 0;
 		start_time = time_dt();
 		total_time = 0.0f;
 		tile_time = 0.0f;
@@ -62,6 +63,7 @@ public:
 		progress.get_tile(tile, total_time, tile_time);
 
 		sample = progress.get_sample();
+		skipped_pixel_samples = progress.get_skipped_pixel_samples();
 
 		return *this;
 	}
@@ -70,6 +72,7 @@ public:
 	{
 		tile = 0;
 		sample = 0;
+		skipped_pixel_samples = 0;
 		start_time = time_dt();
 		total_time = 0.0f;
 		tile_time = 0.0f;
@@ -140,6 +143,7 @@ public:
 		thread_scoped_lock lock(progress_mutex);
 
 		sample = 0;
+		skipped_pixel_samples = 0;
 	}
 
 	void increment_sample()
@@ -149,11 +153,27 @@ public:
 		sample++;
 	}
 
+	/* samples not taken by a tile because its pixels converged with adaptive
+	 * sampling or its time limit was reached, they still count towards the
+	 * total so progress stays correct */
+	void add_skipped_samples(int num_samples, uint64_t num_pixel_samples)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		sample += num_samples;
+		skipped_pixel_samples += num_pixel_samples;
+	}
+
 	int get_sample()
 	{
 		return sample;
 	}
 
+	uint64_t get_skipped_pixel_samples()
+	{
+		return skipped_pixel_samples;
+	}
+
 	/* status messages */
 
 	void set_status(const string& status_, const string& substatus_ = "")
@@ -240,6 +260,7 @@ protected:
 
 	int tile;    /* counter for rendered tiles */
 	int sample;  /* counter of rendered samples, global for all tiles */
+	uint64_t skipped_pixel_samples; /* pixel samples saved by adaptive sampling */
 
 	double start_time;
 	double total_time;
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include "util_algorithm.h"
+#include "util_stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Render Counters */
+
+void RenderCounters::reset()
+{
+	memset(this, 0, sizeof(*this));
+}
+
+void RenderCounters::add(const RenderCounters& other)
+{
+	for(int i = 0; i < NUM_RAY_TYPES; i++)
+		num_rays[i] += other.num_rays[i];
+
+	num_bvh_nodes += other.num_bvh_nodes;
+
+	for(int i = 0; i < MAX_SHADERS; i++) {
+		num_shader_evals[i] += other.num_shader_evals[i];
+		num_svm_nodes[i] += other.num_svm_nodes[i];
+	}
+}
+
+/* Statistics */
+
+void Stats::reset_render_stats()
+{
+	thread_scoped_lock lock(render_stats_mutex);
+
+	update_times.clear();
+	tiles.clear();
+	counters.reset();
+	have_counters = false;
+}
+
+void Stats::add_update_time(const string& name, double time)
+{
+	if(!use_render_stats)
+		return;
+
+	thread_scoped_lock lock(render_stats_mutex);
+
+	for(size_t i = 0; i < update_times.size(); i++) {
+		if(update_times[i].first == name) {
+			update_times[i].second += time;
+			return;
+		}
+	}
+
+	update_times.push_back(std::pair<string, double>(name, time));
+}
+
+double Stats::get_update_time(const string& name)
+{
+	thread_scoped_lock lock(render_stats_mutex);
+
+	for(size_t i = 0; i < update_times.size(); i++)
+		if(update_times[i].first == name)
+			return update_times[i].second;
+
+	return 0.0;
+}
+
+void Stats::add_tile(int x, int y, int w, int h, int num_samples, double time)
+{
+	if(!use_render_stats)
+		return;
+
+	thread_scoped_lock lock(render_stats_mutex);
+
+	TileStats tile;
+	tile.x = x;
+	tile.y = y;
+	tile.w = w;
+	tile.h = h;
+	tile.num_samples = num_samples;
+	tile.time = time;
+
+	tiles.push_back(tile);
+}
+
+void Stats::add_counters(const RenderCounters& counters_)
+{
+	if(!use_render_stats)
+		return;
+
+	thread_scoped_lock lock(render_stats_mutex);
+
+	counters.add(counters_);
+	have_counters = true;
+}
+
+static string json_string(const string& str)
+{
+	string result = "\"";
+
+	for(size_t i = 0; i < str.size(); i++) {
+		unsigned char c = str[i];
+
+		if(c == '"' || c == '\\')
+			result += string("\\") + (char)c;
+		else if(c < 0x20)
+			result += string_printf("\\u%04x", c);
+		else
+			result += (char)c;
+	}
+
+	return result + "\"";
+}
+
+static string json_uint64(uint64_t value)
+{
+	return string_printf("%llu", (unsigned long long)value);
+}
+
+string Stats::render_stats_json(const vector<string>& shader_names, double render_time)
+{
+	thread_scoped_lock lock(render_stats_mutex);
+
+	string json = "{\n";
+
+	json += string_printf("\t\"render_time\": %f,\n", render_time);
+	json += "\t\"memory_peak\": " + json_uint64(mem_peak) + ",\n";
+
+	/* scene update */
+	json += "\t\"scene_update\": {";
+
+	for(size_t i = 0; i < update_times.size(); i++) {
+		json += (i == 0)? "\n": ",\n";
+		json += "\t\t" + json_string(update_times[i].first) + string_printf(": %f", update_times[i].second);
+	}
+
+	json += "\n\t},\n";
+
+	/* tiles */
+	json += "\t\"tiles\": [";
+
+	for(size_t i = 0; i < tiles.size(); i++) {
+		const TileStats& tile = tiles[i];
+
+		json += (i == 0)? "\n": ",\n";
+		json += string_printf("\t\t{\"x\": %d, \"y\": %d, \"width\": %d, \"height\": %d, \"samples\": %d, \"time\": %f}",
+			tile.x, tile.y, tile.w, tile.h, tile.num_samples, tile.time);
+	}
+
+	json += "\n\t]";
+
+	/* achieved samples, these differ between tiles for renders with a
+	 * time limit or adaptive sampling */
+	if(tiles.size()) {
+		int min_samples = tiles[0].num_samples;
+		int max_samples = tiles[0].num_samples;
+		double pixel_samples = 0.0, num_pixels = 0.0;
+
+		for(size_t i = 0; i < tiles.size(); i++) {
+			const TileStats& tile = tiles[i];
+			double tile_pixels = (double)tile.w*(double)tile.h;
+
+			min_samples = min(min_samples, tile.num_samples);
+			max_samples = max(max_samples, tile.num_samples);
+			pixel_samples += tile_pixels*tile.num_samples;
+			num_pixels += tile_pixels;
+		}
+
+		json += ",\n\t\"samples\": {\n";
+		json += string_printf("\t\t\"min\": %d,\n\t\t\"max\": %d,\n\t\t\"average\": %f", min_samples, max_samples,
+			(num_pixels > 0.0)? pixel_samples/num_pixels: 0.0);
+		if(time_limit > 0.0)
+			json += string_printf(",\n\t\t\"time_limit\": %f", time_limit);
+		json += "\n\t}";
+	}
+
+	/* kernel counters */
+	if(have_counters) {
+		const char *ray_names[RenderCounters::NUM_RAY_TYPES] = {"camera", "shadow", "indirect", "subsurface"};
+		uint64_t num_rays = 0;
+
+		json += ",\n\t\"rays\": {\n";
+
+		for(int i = 0; i < RenderCounters::NUM_RAY_TYPES; i++) {
+			json += string_printf("\t\t\"%s\": ", ray_names[i]) + json_uint64(counters.num_rays[i]) + ",\n";
+			num_rays += counters.num_rays[i];
+		}
+
+		json += "\t\t\"per_second\": {\n";
+
+		for(int i = 0; i < RenderCounters::NUM_RAY_TYPES; i++) {
+			double rate = (render_time > 0.0)? counters.num_rays[i]/render_time: 0.0;
+			json += string_printf("\t\t\t\"%s\": %f%s\n", ray_names[i], rate, (i == RenderCounters::NUM_RAY_TYPES-1)? "": ",");
+		}
+
+		json += "\t\t}\n\t},\n";
+
+		json += "\t\"bvh\": {\n";
+		json += "\t\t\"nodes_visited\": " + json_uint64(counters.num_bvh_nodes) + ",\n";
+		json += string_printf("\t\t\"nodes_per_ray\": %f\n", (num_rays)? (double)counters.num_bvh_nodes/num_rays: 0.0);
+		json += "\t},\n";
+
+		/* shaders */
+		json += "\t\"shaders\": [";
+
+		bool first = true;
+
+		for(int i = 0; i < RenderCounters::MAX_SHADERS; i++) {
+			uint64_t num_evals = counters.num_shader_evals[i];
+			uint64_t num_nodes = counters.num_svm_nodes[i];
+
+			if(num_evals == 0)
+				continue;
+
+			string name = (i < (int)shader_names.size())? shader_names[i]: string_printf("%d", i);
+
+			json += (first)? "\n": ",\n";
+			json += "\t\t{\"name\": " + json_string(name);
+			json += ", \"evaluations\": " + json_uint64(num_evals);
+			json += ", \"svm_nodes\": " + json_uint64(num_nodes);
+			json += string_printf(", \"svm_nodes_per_evaluation\": %f}", (double)num_nodes/num_evals);
+
+			first = false;
+		}
+
+		json += "\n\t]";
+	}
+
+	json += "\n}\n";
+
+	return json;
+}
+
+CCL_NAMESPACE_END
+
@@ -17,11 +17,49 @@
 #ifndef __UTIL_STATS_H__
 #define __UTIL_STATS_H__
 
+#include "util_string.h"
+#include "util_thread.h"
+#include "util_types.h"
+#include "util_vector.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Render Counters
+ *
+ * Counters gathered per thread by the CPU kernel, only when built with
+ * WITH_CYCLES_STATS, as counting in the kernel is not free. */
+
+class RenderCounters {
+public:
+	enum RayType {
+		RAY_CAMERA = 0,
+		RAY_SHADOW,
+		RAY_INDIRECT,
+		RAY_SUBSURFACE,
+		NUM_RAY_TYPES
+	};
+
+	enum { MAX_SHADERS = 1024 };
+
+	RenderCounters() { reset(); }
+
+	void reset();
+	void add(const RenderCounters& other);
+
+	uint64_t num_rays[NUM_RAY_TYPES];
+	uint64_t num_bvh_nodes;
+	uint64_t num_shader_evals[MAX_SHADERS];
+	uint64_t num_svm_nodes[MAX_SHADERS];
+};
+
+/* Statistics
+ *
+ * Device memory usage, and optionally render statistics for profiling, which
+ * can be written out as JSON after rendering. */
+
 class Stats {
 public:
-	Stats() : mem_used(0), mem_peak(0) {}
+	Stats() : mem_used(0), mem_peak(0), use_render_stats(false), time_limit(0.0), have_counters(false) {}
 
 	void mem_alloc(size_t size) {
 		mem_used += size;
@@ -35,8 +73,36 @@ public:
 
 	size_t mem_used;
 	size_t mem_peak;
+
+	/* render statistics, only gathered if enabled */
+	bool use_render_stats;
+
+	/* render time limit, the samples achieved per tile are reported with it */
+	double time_limit;
+
+	void reset_render_stats();
+	void add_update_time(const string& name, double time);
+	double get_update_time(const string& name);
+	void add_tile(int x, int y, int w, int h, int num_samples, double time);
+	void add_counters(const RenderCounters& counters);
+
+	string render_stats_json(const vector<string>& shader_names, double render_time);
+
+protected:
+	struct TileStats {
+		int x, y, w, h;
+		int num_samples;
+		double time;
+	};
+
+	thread_mutex render_stats_mutex;
+	vector<std::pair<string, double> > update_times;
+	vector<TileStats> tiles;
+	RenderCounters counters;
+	bool have_counters;
 };
 
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_STATS_H__ */
+
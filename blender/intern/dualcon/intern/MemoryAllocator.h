@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define HEAP_BASE 16
 #define UCHAR unsigned char
@@ -63,7 +64,9 @@ virtual int getBytes( ) = 0;
 /**
  * Dynamic memory allocator - allows allocation/deallocation
  *
- * Note: there are 4 bytes overhead for each allocated yet unused object.
+ * Note: deallocated objects are kept in a free list that is linked
+ * through the objects themselves, so there is no per-object overhead.
+ * N must be at least the size of a pointer.
  */
 template < int N >
 class MemoryAllocator : public VirtualMemoryAllocator
@@ -71,25 +74,22 @@ class MemoryAllocator : public VirtualMemoryAllocator
 private:
 
 /// Constants
-int HEAP_UNIT, HEAP_MASK;
+int HEAP_UNIT;
 
 /// Data array
 UCHAR **data;
 
-/// Allocation stack
-UCHAR ***stack;
-
 /// Number of data blocks
 int datablocknum;
 
-/// Number of stack blocks
-int stackblocknum;
+/// Number of never used objects left in the last data block
+int available;
 
-/// Size of stack
-int stacksize;
+/// Deallocated objects, each one stores the address of the next one
+UCHAR *freelist;
 
-/// Number of available objects on stack
-int available;
+/// Number of objects in the free list
+int freenum;
 
 /**
  * Allocate a memory block
@@ -101,26 +101,9 @@ void allocateDataBlock( )
 	data = ( UCHAR ** )realloc(data, sizeof (UCHAR *) * datablocknum);
 	data[datablocknum - 1] = ( UCHAR * )malloc(HEAP_UNIT * N);
 
-	// Update allocation stack
-	for (int i = 0; i < HEAP_UNIT; i++)
-	{
-		stack[0][i] = (data[datablocknum - 1] + i * N);
-	}
 	available = HEAP_UNIT;
 }
 
-/**
- * Allocate a stack block, to store more deallocated objects
- */
-void allocateStackBlock( )
-{
-	// Allocate a stack block
-	stackblocknum += 1;
-	stacksize += HEAP_UNIT;
-	stack = ( UCHAR *** )realloc(stack, sizeof (UCHAR * *) * stackblocknum);
-	stack[stackblocknum - 1] = ( UCHAR ** )malloc(HEAP_UNIT * sizeof (UCHAR *) );
-}
-
 
 public:
 /**
@@ -129,22 +112,14 @@ public:
 MemoryAllocator( )
 {
 	HEAP_UNIT = 1 << HEAP_BASE;
-	HEAP_MASK = (1 << HEAP_BASE) - 1;
 
 	data = ( UCHAR ** )malloc(sizeof(UCHAR *) );
 	data[0] = ( UCHAR * )malloc(HEAP_UNIT * N);
 	datablocknum = 1;
-
-	stack = ( UCHAR *** )malloc(sizeof (UCHAR * *) );
-	stack[0] = ( UCHAR ** )malloc(HEAP_UNIT * sizeof (UCHAR *) );
-	stackblocknum = 1;
-	stacksize = HEAP_UNIT;
 	available = HEAP_UNIT;
 
-	for (int i = 0; i < HEAP_UNIT; i++)
-	{
-		stack[0][i] = (data[0] + i * N);
-	}
+	freelist = NULL;
+	freenum = 0;
 }
 
 /**
@@ -157,12 +132,7 @@ void destroy( )
 	{
 		free(data[i]);
 	}
-	for (i = 0; i < stackblocknum; i++)
-	{
-		free(stack[i]);
-	}
 	free(data);
-	free(stack);
 }
 
 /**
@@ -170,14 +140,23 @@ void destroy( )
  */
 void *allocate( )
 {
+	if (freelist)
+	{
+		UCHAR *obj = freelist;
+
+		// objects aren't necessarily pointer aligned, so copy the link
+		memcpy(&freelist, obj, sizeof(UCHAR *));
+		freenum--;
+		return (void *)obj;
+	}
+
 	if (available == 0)
 	{
 		allocateDataBlock( );
 	}
 
-	// printf("Allocating %d\n", header[ allocated ]) ;
 	available--;
-	return (void *)stack[available >> HEAP_BASE][available & HEAP_MASK];
+	return (void *)(data[datablocknum - 1] + available * N);
 }
 
 /**
@@ -185,15 +164,9 @@ void *allocate( )
  */
 void deallocate(void *obj)
 {
-	if (available == stacksize)
-	{
-		allocateStackBlock( );
-	}
-
-	// printf("De-allocating %d\n", ( obj - data ) / N ) ;
-	stack[available >> HEAP_BASE][available & HEAP_MASK] = (UCHAR *)obj;
-	available++;
-	// printf("%d %d\n", allocated, header[ allocated ]) ;
+	memcpy(obj, &freelist, sizeof(UCHAR *));
+	freelist = (UCHAR *)obj;
+	freenum++;
 }
 
 /**
@@ -201,7 +174,7 @@ void deallocate(void *obj)
  */
 void printInfo( )
 {
-	printf("Bytes: %d Used: %d Allocated: %d Maxfree: %d\n", getBytes(), getAllocated(), getAll(), stacksize);
+	printf("Bytes: %d Used: %d Allocated: %d Free: %d\n", getBytes(), getAllocated(), getAll(), freenum);
 }
 
 /**
@@ -209,7 +182,7 @@ void printInfo( )
  */
 int getAllocated( )
 {
-	return HEAP_UNIT * datablocknum - available;
+	return HEAP_UNIT * datablocknum - available - freenum;
 };
 
 int getAll( )
@@ -343,11 +343,10 @@ void Octree::addTriangle(Triangle *trian, int triind)
 
 	/* Add triangle to the octree */
 	int64_t errorvec = (int64_t)(0);
-	CubeTriangleIsect *proj = new CubeTriangleIsect(cube, trig, errorvec, triind);
-	root = (Node *)addTriangle(&root->internal, proj, maxDepth);
+	CubeTriangleIsect proj(cube, trig, errorvec, triind);
+	root = (Node *)addTriangle(&root->internal, &proj, maxDepth);
 
-	delete proj->inherit;
-	delete proj;
+	delete proj.inherit;
 }
 
 #if 0
@@ -371,7 +370,8 @@ InternalNode *Octree::addTriangle(InternalNode *node, CubeTriangleIsect *p, int
 		{0,  1, -1},
 		{0,  0,  1}};
 	unsigned char boxmask = p->getBoxMask();
-	CubeTriangleIsect *subp = new CubeTriangleIsect(p);
+	/* Kept on the stack, this runs for every node each triangle touches */
+	CubeTriangleIsect subp(p);
 	
 	int count = 0;
 	int tempdiff[3] = {0, 0, 0};
@@ -384,11 +384,11 @@ InternalNode *Octree::addTriangle(InternalNode *node, CubeTriangleIsect *p, int
 
 		/* Quick pruning using bounding box */
 		if (boxmask & (1 << i)) {
-			subp->shift(tempdiff);
+			subp.shift(tempdiff);
 			tempdiff[0] = tempdiff[1] = tempdiff[2] = 0;
 
 			/* Pruning using intersection test */
-			if (subp->isIntersecting()) {
+			if (subp.isIntersecting()) {
 				if (!node->has_child(i)) {
 					if (height == 1)
 						node = addLeafChild(node, i, count, createLeaf(0));
@@ -398,9 +398,9 @@ InternalNode *Octree::addTriangle(InternalNode *node, CubeTriangleIsect *p, int
 				Node *chd = node->get_child(count);
 
 				if (node->is_child_leaf(i))
-					node->set_child(count, (Node *)updateCell(&chd->leaf, subp));
+					node->set_child(count, (Node *)updateCell(&chd->leaf, &subp));
 				else
-					node->set_child(count, (Node *)addTriangle(&chd->internal, subp, height - 1));
+					node->set_child(count, (Node *)addTriangle(&chd->internal, &subp, height - 1));
 			}
 		}
 
@@ -408,8 +408,6 @@ InternalNode *Octree::addTriangle(InternalNode *node, CubeTriangleIsect *p, int
 			count++;
 	}
 
-	delete subp;
-
 	return node;
 }
 
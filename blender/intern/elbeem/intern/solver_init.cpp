@@ -855,6 +855,46 @@ bool LbmFsgrSolver::initializeSolverMemory()
 		return false;
 	}
 
+#if PARALLEL==1
+	// first touch the finest level in the same y ranges the threads of the
+	// main loop work on, so on multi socket machines the pages end up on
+	// the memory node of the thread using them (see GRID_REGION_START)
+	{
+		const int Nj = mLevel[mMaxRefine].lSizey;
+		const LONGINT rowSize = (LONGINT)mLevel[mMaxRefine].lSizex;
+		const LONGINT planeSize = rowSize * (LONGINT)Nj;
+#if COMPRESSGRIDS==1
+		// both sets share one array, offset by two planes
+		LbmFloat *cellSets[2] = { mLevel[mMaxRefine].mprsCells[1], NULL };
+		const int cellPlanes = mLevel[mMaxRefine].lSizez + 2;
+#else // COMPRESSGRIDS==1
+		LbmFloat *cellSets[2] = { mLevel[mMaxRefine].mprsCells[0], mLevel[mMaxRefine].mprsCells[1] };
+		const int cellPlanes = mLevel[mMaxRefine].lSizez;
+#endif // COMPRESSGRIDS==1
+#pragma omp parallel default(shared) num_threads(mNumOMPThreads)
+		{
+			const int id = omp_get_thread_num();
+			const int Nthrds = omp_get_num_threads();
+			const LONGINT jstart = (id * Nj) / Nthrds;
+			const LONGINT jend   = ((id+1) * Nj) / Nthrds;
+
+			for(int s=0; s<2; s++) {
+				if(!cellSets[s]) continue;
+				for(int k=0; k<cellPlanes; k++) {
+					memset(cellSets[s] + (k*planeSize + jstart*rowSize) * dTotalNum, 0,
+					       sizeof(LbmFloat) * (jend-jstart) * rowSize * dTotalNum);
+				}
+			}
+			for(int s=0; s<2; s++) {
+				for(int k=0; k<mLevel[mMaxRefine].lSizez; k++) {
+					memset(mLevel[mMaxRefine].mprsFlags[s] + k*planeSize + jstart*rowSize, 0,
+					       sizeof(CellFlagType) * (jend-jstart) * rowSize);
+				}
+			}
+		}
+	}
+#endif // PARALLEL==1
+
 	LbmFloat lcfdimFac = 8.0;
 	if(LBMDIM==2) lcfdimFac = 4.0;
 	for(int i=mMaxRefine-1; i>=0; i--) {
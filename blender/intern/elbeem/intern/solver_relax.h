@@ -436,55 +436,24 @@
 
 
 
+// non-equilibrium stress tensor from the second moments, for D3Q19
+// sum(c_a*c_b*feq) = rho/3*delta_ab + u_a*u_b, so lcsmeq isn't needed
 #define  COLL_CALCULATE_NONEQTENSOR(csolev, srcArray )  \
-	lcsmqadd  = (srcArray##NE - lcsmeq[ dNE ]); \
-	lcsmqadd -= (srcArray##NW - lcsmeq[ dNW ]); \
-	lcsmqadd -= (srcArray##SE - lcsmeq[ dSE ]); \
-	lcsmqadd += (srcArray##SW - lcsmeq[ dSW ]); \
+	lcsmqadd  = srcArray##NE - srcArray##NW - srcArray##SE + srcArray##SW - ux*uy; \
 	lcsmqo = (lcsmqadd*    lcsmqadd); \
-	lcsmqadd  = (srcArray##ET - lcsmeq[  dET ]); \
-	lcsmqadd -= (srcArray##EB - lcsmeq[  dEB ]); \
-	lcsmqadd -= (srcArray##WT - lcsmeq[  dWT ]); \
-	lcsmqadd += (srcArray##WB - lcsmeq[  dWB ]); \
+	lcsmqadd  = srcArray##ET - srcArray##EB - srcArray##WT + srcArray##WB - ux*uz; \
 	lcsmqo += (lcsmqadd*    lcsmqadd); \
-	lcsmqadd  = (srcArray##NT - lcsmeq[  dNT ]); \
-	lcsmqadd -= (srcArray##NB - lcsmeq[  dNB ]); \
-	lcsmqadd -= (srcArray##ST - lcsmeq[  dST ]); \
-	lcsmqadd += (srcArray##SB - lcsmeq[  dSB ]); \
+	lcsmqadd  = srcArray##NT - srcArray##NB - srcArray##ST + srcArray##SB - uy*uz; \
 	lcsmqo += (lcsmqadd*    lcsmqadd); \
 	lcsmqo *= 2.0; \
-	lcsmqadd  = (srcArray##E  -  lcsmeq[ dE  ]); \
-	lcsmqadd += (srcArray##W  -  lcsmeq[ dW  ]); \
-	lcsmqadd += (srcArray##NE -  lcsmeq[ dNE ]); \
-	lcsmqadd += (srcArray##NW -  lcsmeq[ dNW ]); \
-	lcsmqadd += (srcArray##SE -  lcsmeq[ dSE ]); \
-	lcsmqadd += (srcArray##SW -  lcsmeq[ dSW ]); \
-	lcsmqadd += (srcArray##ET  - lcsmeq[ dET ]); \
-	lcsmqadd += (srcArray##EB  - lcsmeq[ dEB ]); \
-	lcsmqadd += (srcArray##WT  - lcsmeq[ dWT ]); \
-	lcsmqadd += (srcArray##WB  - lcsmeq[ dWB ]); \
+	lcsmqadd  = srcArray##E  + srcArray##W  + srcArray##NE + srcArray##NW + srcArray##SE + srcArray##SW \
+	          + srcArray##ET + srcArray##EB + srcArray##WT + srcArray##WB - rho*(1.0/3.0) - ux*ux; \
 	lcsmqo += (lcsmqadd*    lcsmqadd); \
-	lcsmqadd  = (srcArray##N  -  lcsmeq[ dN  ]); \
-	lcsmqadd += (srcArray##S  -  lcsmeq[ dS  ]); \
-	lcsmqadd += (srcArray##NE -  lcsmeq[ dNE ]); \
-	lcsmqadd += (srcArray##NW -  lcsmeq[ dNW ]); \
-	lcsmqadd += (srcArray##SE -  lcsmeq[ dSE ]); \
-	lcsmqadd += (srcArray##SW -  lcsmeq[ dSW ]); \
-	lcsmqadd += (srcArray##NT  - lcsmeq[ dNT ]); \
-	lcsmqadd += (srcArray##NB  - lcsmeq[ dNB ]); \
-	lcsmqadd += (srcArray##ST  - lcsmeq[ dST ]); \
-	lcsmqadd += (srcArray##SB  - lcsmeq[ dSB ]); \
+	lcsmqadd  = srcArray##N  + srcArray##S  + srcArray##NE + srcArray##NW + srcArray##SE + srcArray##SW \
+	          + srcArray##NT + srcArray##NB + srcArray##ST + srcArray##SB - rho*(1.0/3.0) - uy*uy; \
 	lcsmqo += (lcsmqadd*    lcsmqadd); \
-	lcsmqadd  = (srcArray##T  -  lcsmeq[ dT  ]); \
-	lcsmqadd += (srcArray##B  -  lcsmeq[ dB  ]); \
-	lcsmqadd += (srcArray##NT -  lcsmeq[ dNT ]); \
-	lcsmqadd += (srcArray##NB -  lcsmeq[ dNB ]); \
-	lcsmqadd += (srcArray##ST -  lcsmeq[ dST ]); \
-	lcsmqadd += (srcArray##SB -  lcsmeq[ dSB ]); \
-	lcsmqadd += (srcArray##ET  - lcsmeq[ dET ]); \
-	lcsmqadd += (srcArray##EB  - lcsmeq[ dEB ]); \
-	lcsmqadd += (srcArray##WT  - lcsmeq[ dWT ]); \
-	lcsmqadd += (srcArray##WB  - lcsmeq[ dWB ]); \
+	lcsmqadd  = srcArray##T  + srcArray##B  + srcArray##NT + srcArray##NB + srcArray##ST + srcArray##SB \
+	          + srcArray##ET + srcArray##EB + srcArray##WT + srcArray##WB - rho*(1.0/3.0) - uz*uz; \
 	lcsmqo += (lcsmqadd*    lcsmqadd); \
 	lcsmqo = sqrt(lcsmqo); \
 
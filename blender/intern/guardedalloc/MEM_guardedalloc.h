@@ -171,6 +171,28 @@ extern "C" {
 	/** Get the peak memory usage in bytes, including mmap allocations. */
 	extern size_t (*MEM_get_peak_memory)(void) ATTR_WARN_UNUSED_RESULT;
 
+	/** Memory held by all blocks allocated with the same name. */
+	typedef struct MEM_StatsEntry {
+		const char *name;
+		unsigned int items;
+		size_t len;
+		/* blocks allocated after the serial passed to MEM_get_memory_stats */
+		unsigned int items_new;
+		size_t len_new;
+		/* allocations made since the oldest of these blocks, a measure of its lifetime */
+		size_t age_max;
+	} MEM_StatsEntry;
+
+	typedef void (*MEM_StatsFunc)(void *userdata, const MEM_StatsEntry *entry);
+
+	/** Number of allocations made so far, store it to compare a later state against. */
+	extern size_t (*MEM_get_memory_serial)(void) ATTR_WARN_UNUSED_RESULT;
+
+	/**
+	 * Call \a func for every allocation name holding memory, largest first.
+	 * Only the guarded allocator (--debug-memory) keeps names, returns false otherwise. */
+	extern bool (*MEM_get_memory_stats)(size_t serial_since, MEM_StatsFunc func, void *userdata);
+
 #define MEM_SAFE_FREE(v) if (v) { MEM_freeN(v); v = NULL; } (void)0
 
 /* overhead for lockfree allocator (use to avoid slop-space) */
@@ -60,6 +60,8 @@ uintptr_t (*MEM_get_mapped_memory_in_use)(void) = MEM_lockfree_get_mapped_memory
 unsigned int (*MEM_get_memory_blocks_in_use)(void) = MEM_lockfree_get_memory_blocks_in_use;
 void (*MEM_reset_peak_memory)(void) = MEM_lockfree_reset_peak_memory;
 uintptr_t (*MEM_get_peak_memory)(void) = MEM_lockfree_get_peak_memory;
+size_t (*MEM_get_memory_serial)(void) = MEM_lockfree_get_memory_serial;
+bool (*MEM_get_memory_stats)(size_t serial_since, MEM_StatsFunc func, void *userdata) = MEM_lockfree_get_memory_stats;
 
 #ifndef NDEBUG
 const char *(*MEM_name_ptr)(void *vmemh) = MEM_lockfree_name_ptr;
@@ -88,6 +90,8 @@ void MEM_use_guarded_allocator(void)
 	MEM_get_memory_blocks_in_use = MEM_guarded_get_memory_blocks_in_use;
 	MEM_reset_peak_memory = MEM_guarded_reset_peak_memory;
 	MEM_get_peak_memory = MEM_guarded_get_peak_memory;
+	MEM_get_memory_serial = MEM_guarded_get_memory_serial;
+	MEM_get_memory_stats = MEM_guarded_get_memory_stats;
 
 #ifndef NDEBUG
 	MEM_name_ptr = MEM_guarded_name_ptr;
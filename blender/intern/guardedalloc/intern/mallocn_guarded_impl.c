@@ -114,6 +114,7 @@ typedef struct MemHead {
 	const char *nextname;
 	int tag2;
 	int mmap;  /* if true, memory was mmapped */
+	size_t serial;  /* allocation number, see MEM_get_memory_serial */
 #ifdef DEBUG_MEMCOUNTER
 	int _count;
 #endif
@@ -195,6 +196,7 @@ static const char *check_memlist(MemHead *memh);
 
 static unsigned int totblock = 0;
 static size_t mem_in_use = 0, mmap_in_use = 0, peak_mem = 0;
+static size_t mem_serial = 0;
 
 static volatile struct localListBase _membase;
 static volatile struct localListBase *membase = &_membase;
@@ -481,6 +483,7 @@ static void make_memhead_header(MemHead *memh, size_t len, const char *str)
 	atomic_add_z(&mem_in_use, len);
 
 	mem_lock_thread();
+	memh->serial = ++mem_serial;
 	addtail(membase, &memh->next);
 	if (memh->next) {
 		memh->nextname = MEMNEXT(memh->next)->name;
@@ -580,6 +583,10 @@ typedef struct MemPrintBlock {
 	const char *name;
 	uintptr_t len;
 	int items;
+	/* only used by MEM_guarded_get_memory_stats */
+	int items_new;
+	uintptr_t len_new;
+	size_t serial_min;
 } MemPrintBlock;
 
 static int compare_name(const void *p1, const void *p2)
@@ -680,6 +687,101 @@ void MEM_guarded_printmemlist_stats(void)
 #endif
 }
 
+size_t MEM_guarded_get_memory_serial(void)
+{
+	size_t serial;
+
+	mem_lock_thread();
+	serial = mem_serial;
+	mem_unlock_thread();
+
+	return serial;
+}
+
+bool MEM_guarded_get_memory_stats(size_t serial_since, MEM_StatsFunc func, void *userdata)
+{
+	MemHead *membl;
+	MemPrintBlock *pb, *printblock;
+	unsigned int totpb, a, b;
+	size_t serial_curr;
+
+	mem_lock_thread();
+
+	/* put memory blocks into array, same as MEM_guarded_printmemlist_stats */
+	printblock = malloc(sizeof(MemPrintBlock) * (totblock ? totblock : 1));
+	serial_curr = mem_serial;
+
+	pb = printblock;
+	totpb = 0;
+
+	membl = membase->first;
+	if (membl) membl = MEMNEXT(membl);
+
+	while (membl) {
+		const bool is_new = (membl->serial > serial_since);
+
+		pb->name = membl->name;
+		pb->len = membl->len;
+		pb->items = 1;
+		pb->items_new = is_new ? 1 : 0;
+		pb->len_new = is_new ? membl->len : 0;
+		pb->serial_min = membl->serial;
+
+		totpb++;
+		pb++;
+
+		if (membl->next)
+			membl = MEMNEXT(membl->next);
+		else break;
+	}
+
+	mem_unlock_thread();
+
+	/* sort by name and add together blocks with the same name */
+	if (totpb) {
+		qsort(printblock, totpb, sizeof(MemPrintBlock), compare_name);
+		for (a = 0, b = 0; a < totpb; a++) {
+			if (a == b) {
+				continue;
+			}
+			else if (strcmp(printblock[a].name, printblock[b].name) == 0) {
+				printblock[b].len += printblock[a].len;
+				printblock[b].items++;
+				printblock[b].len_new += printblock[a].len_new;
+				printblock[b].items_new += printblock[a].items_new;
+				if (printblock[a].serial_min < printblock[b].serial_min) {
+					printblock[b].serial_min = printblock[a].serial_min;
+				}
+			}
+			else {
+				b++;
+				memcpy(&printblock[b], &printblock[a], sizeof(MemPrintBlock));
+			}
+		}
+		totpb = b + 1;
+
+		qsort(printblock, totpb, sizeof(MemPrintBlock), compare_len);
+	}
+
+	/* call outside the lock, func may allocate */
+	for (a = 0, pb = printblock; a < totpb; a++, pb++) {
+		MEM_StatsEntry entry;
+
+		entry.name = pb->name;
+		entry.items = (unsigned int)pb->items;
+		entry.len = pb->len;
+		entry.items_new = (unsigned int)pb->items_new;
+		entry.len_new = pb->len_new;
+		entry.age_max = serial_curr - pb->serial_min;
+
+		func(userdata, &entry);
+	}
+
+	free(printblock);
+
+	return true;
+}
+
 static const char mem_printmemlist_pydict_script[] =
 "mb_userinfo = {}\n"
 "totmem = 0\n"
@@ -99,6 +99,8 @@ uintptr_t MEM_lockfree_get_mapped_memory_in_use(void);
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void);
 void MEM_lockfree_reset_peak_memory(void);
 uintptr_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+size_t MEM_lockfree_get_memory_serial(void) ATTR_WARN_UNUSED_RESULT;
+bool MEM_lockfree_get_memory_stats(size_t serial_since, MEM_StatsFunc func, void *userdata);
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
@@ -125,6 +127,8 @@ uintptr_t MEM_guarded_get_mapped_memory_in_use(void);
 unsigned int MEM_guarded_get_memory_blocks_in_use(void);
 void MEM_guarded_reset_peak_memory(void);
 uintptr_t MEM_guarded_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+size_t MEM_guarded_get_memory_serial(void) ATTR_WARN_UNUSED_RESULT;
+bool MEM_guarded_get_memory_stats(size_t serial_since, MEM_StatsFunc func, void *userdata);
 #ifndef NDEBUG
 const char *MEM_guarded_name_ptr(void *vmemh);
 #endif
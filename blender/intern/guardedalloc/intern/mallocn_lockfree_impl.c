@@ -81,6 +81,22 @@ static void print_error(const char *str, ...)
 	}
 }
 
+/* raise *maximum_value to value, without a lock and without writing the
+ * shared value again once the peak is reached */
+static void update_maximum(size_t *maximum_value, size_t value)
+{
+	size_t prev_value = *maximum_value;
+
+	while (prev_value < value) {
+		size_t cur_value = atomic_cas_z(maximum_value, prev_value, value);
+
+		if (cur_value == prev_value) {
+			break;
+		}
+		prev_value = cur_value;
+	}
+}
+
 #if defined(WIN32)
 static void mem_lock_thread(void)
 {
@@ -223,9 +239,7 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 		memh->len = len;
 		atomic_add_u(&totblock, 1);
 		atomic_add_z(&mem_in_use, len);
-
-		/* TODO(sergey): Not strictly speaking thread-safe. */
-		peak_mem = mem_in_use > peak_mem ? mem_in_use : peak_mem;
+		update_maximum(&peak_mem, mem_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
@@ -250,9 +264,7 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 		memh->len = len;
 		atomic_add_u(&totblock, 1);
 		atomic_add_z(&mem_in_use, len);
-
-		/* TODO(sergey): Not strictly speaking thread-safe. */
-		peak_mem = mem_in_use > peak_mem ? mem_in_use : peak_mem;
+		update_maximum(&peak_mem, mem_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
@@ -282,10 +294,8 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
 		atomic_add_u(&totblock, 1);
 		atomic_add_z(&mem_in_use, len);
 		atomic_add_z(&mmap_in_use, len);
-
-		/* TODO(sergey): Not strictly speaking thread-safe. */
-		peak_mem = mem_in_use > peak_mem ? mem_in_use : peak_mem;
-		peak_mem = mmap_in_use > peak_mem ? mmap_in_use : peak_mem;
+		update_maximum(&peak_mem, mem_in_use);
+		update_maximum(&peak_mem, mmap_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
@@ -370,6 +380,18 @@ uintptr_t MEM_lockfree_get_peak_memory(void)
 	return peak_mem;
 }
 
+/* blocks don't store names or serials, statistics need the guarded allocator */
+size_t MEM_lockfree_get_memory_serial(void)
+{
+	return 0;
+}
+
+bool MEM_lockfree_get_memory_stats(size_t UNUSED(serial_since), MEM_StatsFunc UNUSED(func),
+                                   void *UNUSED(userdata))
+{
+	return false;
+}
+
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh)
 {
@@ -590,7 +590,13 @@ void RB_body_set_scale(rbRigidBody *object, const float scale[3])
 	/* apply scaling factor from matrix above to the collision shape */
 	btCollisionShape *cshape = body->getCollisionShape();
 	if (cshape) {
-		cshape->setLocalScaling(btVector3(scale[0], scale[1], scale[2]));
+		btVector3 bt_scale(scale[0], scale[1], scale[2]);
+
+		/* scale is synced every frame, rescaling shapes isn't free so skip it when nothing changed */
+		if (cshape->getLocalScaling() == bt_scale)
+			return;
+
+		cshape->setLocalScaling(bt_scale);
 		
 		/* GIimpact shapes have to be updated to take scaling into account */
 		if (cshape->getShapeType() == GIMPACT_SHAPE_PROXYTYPE)
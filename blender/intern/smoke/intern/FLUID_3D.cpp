@@ -93,6 +93,7 @@ FLUID_3D::FLUID_3D(int *res, float dx, float dtdef, int init_heat, int init_fire
 	_density      = new float[_totalCells];
 	_densityOld   = new float[_totalCells];
 	_obstacles    = new unsigned char[_totalCells]; // set 0 at end of step
+	_activeBricks = new unsigned char[2 * brickCount(_res)]; // set every step
 
 	// For threaded version:
 	_xVelocityTemp = new float[_totalCells];
@@ -277,6 +278,7 @@ FLUID_3D::~FLUID_3D()
 	if (_heat) delete[] _heat;
 	if (_heatOld) delete[] _heatOld;
 	if (_obstacles) delete[] _obstacles;
+	if (_activeBricks) delete[] _activeBricks;
 
 	if (_xVelocityTemp) delete[] _xVelocityTemp;
 	if (_yVelocityTemp) delete[] _yVelocityTemp;
@@ -400,30 +402,24 @@ void FLUID_3D::step(float dt, float gravity[3])
 	SWAP_POINTERS(_zVelocity, _zVelocityTemp);
 #if PARALLEL==1
 	}	// end of single
+	}	// end of parallel
 
-	#pragma omp barrier
-
-	#pragma omp for
-	for (int i=0; i<2; i++)
-	{
-		if (i==0)
-		{
-#endif
-			project();
-#if PARALLEL==1
-		}
-		else if (i==1)
-		{
+	/*
+	* The pressure solver splits its work in z-slabs itself,
+	* it would only get a single thread inside the region above.
+	*/
 #endif
-			if (_heat) {
-				diffuseHeat();
-			}
-#if PARALLEL==1
-		}
+	project();
+
+	if (_heat) {
+		diffuseHeat();
 	}
 
-	#pragma omp barrier
+	updateActiveBricks();
 
+#if PARALLEL==1
+	#pragma omp parallel
+	{
 	#pragma omp single
 	{
 #endif
@@ -1486,6 +1482,31 @@ void FLUID_3D::addVorticity(int zBegin, int zEnd)
 	if (_vorticity) delete[] _vorticity;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Find the bricks the scalar fields have to be advected in, from the
+// current fields which are read as "Old" ones by the advection
+//////////////////////////////////////////////////////////////////////
+void FLUID_3D::updateActiveBricks()
+{
+	float *fields[7];
+	int totfields = 0;
+
+	fields[totfields++] = _density;
+	if (_heat) {
+		fields[totfields++] = _heat;
+	}
+	if (_fuel) {
+		fields[totfields++] = _fuel;
+		fields[totfields++] = _react;
+	}
+	if (_color_r) {
+		fields[totfields++] = _color_r;
+		fields[totfields++] = _color_g;
+		fields[totfields++] = _color_b;
+	}
+
+	markActiveBricks(fields, totfields, _xVelocity, _yVelocity, _zVelocity, _dt / _dx, _res, _activeBricks);
+}
 
 void FLUID_3D::advectMacCormackBegin(int zBegin, int zEnd)
 {
@@ -1512,18 +1533,18 @@ void FLUID_3D::advectMacCormackEnd1(int zBegin, int zEnd)
 
 	// advectFieldMacCormack1(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res)
 
-	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _densityTemp, res, zBegin, zEnd);
+	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _densityTemp, res, zBegin, zEnd, _activeBricks);
 	if (_heat) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heatTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heatTemp, res, zBegin, zEnd, _activeBricks);
 	}
 	if (_fuel) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuelTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _reactTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuelTemp, res, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _reactTemp, res, zBegin, zEnd, _activeBricks);
 	}
 	if (_color_r) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_rTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_gTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_bTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_rTemp, res, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_gTemp, res, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_bTemp, res, zBegin, zEnd, _activeBricks);
 	}
 	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _xVelocityOld, _xVelocity, res, zBegin, zEnd);
 	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _yVelocityOld, _yVelocity, res, zBegin, zEnd);
@@ -1546,18 +1567,18 @@ void FLUID_3D::advectMacCormackEnd2(int zBegin, int zEnd)
 	// advectFieldMacCormack2(dt, xVelocity, yVelocity, zVelocity, oldField, newField, tempfield, temp, res, obstacles)
 
 	/* finish advection */
-	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _density, _densityTemp, t1, res, _obstacles, zBegin, zEnd);
+	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _density, _densityTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
 	if (_heat) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heat, _heatTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heat, _heatTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
 	}
 	if (_fuel) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuel, _fuelTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _react, _reactTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuel, _fuelTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _react, _reactTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
 	}
 	if (_color_r) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_r, _color_rTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_g, _color_gTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_b, _color_bTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_r, _color_rTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_g, _color_gTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_b, _color_bTemp, t1, res, _obstacles, zBegin, zEnd, _activeBricks);
 	}
 	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _xVelocityOld, _xVelocityTemp, _xVelocity, t1, res, _obstacles, zBegin, zEnd);
 	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _yVelocityOld, _yVelocityTemp, _yVelocity, t1, res, _obstacles, zBegin, zEnd);
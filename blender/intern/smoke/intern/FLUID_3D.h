@@ -43,6 +43,12 @@ using namespace std;
 using namespace BasicVector;
 struct WTURBULENCE;
 
+// scalar fields are advected in bricks of SMOKE_BRICK_SIZE^3 cells,
+// bricks that hold no values above SMOKE_BRICK_THRESHOLD and can't
+// receive any within the step are skipped (see markActiveBricks)
+#define SMOKE_BRICK_SIZE 8
+#define SMOKE_BRICK_THRESHOLD 1e-6f
+
 struct FLUID_3D  
 {
 	public:
@@ -113,6 +119,9 @@ struct FLUID_3D
 		unsigned char*  _obstacles; /* only used (useful) for static obstacles like domain boundaries */
 		unsigned char*  _obstaclesAnim;
 
+		// active bricks of the scalar fields, updated every step
+		unsigned char*  _activeBricks;
+
 		// Required for proper threading:
 		float* _xVelocityTemp;
 		float* _yVelocityTemp;
@@ -198,6 +207,7 @@ struct FLUID_3D
 	public:
 		// advection, accessed e.g. by WTURBULENCE class
 		//void advectMacCormack();
+		void updateActiveBricks();
 		void advectMacCormackBegin(int zBegin, int zEnd);
 		void advectMacCormackEnd1(int zBegin, int zEnd);
 		void advectMacCormackEnd2(int zBegin, int zEnd);
@@ -230,13 +240,20 @@ struct FLUID_3D
 
 		
 
+		// active brick helpers, the mask needs room for 2 * brickCount(res) entries
+		static int brickRes(int res) { return (res + SMOKE_BRICK_SIZE - 1) / SMOKE_BRICK_SIZE; };
+		static int brickCount(Vec3Int res) { return brickRes(res[0]) * brickRes(res[1]) * brickRes(res[2]); };
+		static int markActiveBricks(float** fields, int totfields, const float* velx, const float* vely, const float* velz,
+				const float dt, Vec3Int res, unsigned char* bricks);
+
 		// static advection functions, also used by WTURBULENCE
 		static void advectFieldSemiLagrange(const float dt, const float* velx, const float* vely,  const float* velz,
-				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks = NULL);
 		static void advectFieldMacCormack1(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks = NULL);
 		static void advectFieldMacCormack2(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* newField, float* tempResult, float* temp1,Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd);
+				float* oldField, float* newField, float* tempResult, float* temp1,Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd,
+				const unsigned char* bricks = NULL);
 
 
 		// temp ones for testing
@@ -247,9 +264,10 @@ struct FLUID_3D
 
 		// maccormack helper functions
 		static void clampExtrema(const float dt, const float* xVelocity, const float* yVelocity,  const float* zVelocity,
-				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks = NULL);
 		static void clampOutsideRays(const float dt, const float* xVelocity, const float* yVelocity,  const float* zVelocity,
-				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd,
+				const unsigned char* bricks = NULL);
 
 
 
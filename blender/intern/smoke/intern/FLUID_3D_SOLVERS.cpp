@@ -29,6 +29,9 @@
 
 #include "FLUID_3D.h"
 #include <cstring>
+#if PARALLEL==1
+#include <omp.h>
+#endif // PARALLEL 
 #define SOLVER_ACCURACY 1e-06
 
 //////////////////////////////////////////////////////////////////////
@@ -165,11 +168,335 @@ void FLUID_3D::solveHeat(float* field, float* b, unsigned char* skip)
 	if (_Acenter)  delete[] _Acenter;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Multigrid preconditioner for the pressure solve
+//
+// Coarse levels aggregate 2x2x2 cells of the level below. Their matrix
+// is the Galerkin product P^T A P of piecewise constant prolongation,
+// so obstacle cells of the fine grid never take part and the coupling
+// through obstacle walls stays zero on every level. Damped Jacobi with
+// as many sweeps after the coarse correction as before keeps the
+// V-cycle symmetric, which CG needs.
+//
+// All loops run over z-slabs like the rest of the step, Jacobi sweeps
+// are split in a residual and an update pass so slabs never read values
+// another slab is writing.
+//////////////////////////////////////////////////////////////////////
+#define MG_MAX_LEVELS		10
+#define MG_MIN_RES			4		// don't coarsen below this many interior cells
+#define MG_SWEEPS			2		// Jacobi sweeps before and after coarse correction
+#define MG_COARSE_SWEEPS	16		// Jacobi sweeps on the coarsest level
+#define MG_OMEGA			(2.0f / 3.0f)
+
+struct MG_LEVEL
+{
+	int xRes, yRes, zRes;	// including the border cells
+	int slabSize;
+	size_t totalCells;
+
+	// coarse levels only, diagonal is zero for cells without fluid
+	float *diag;
+	float *wx, *wy, *wz;	// coupling to the +x, +y, +z neighbour
+
+	float *x, *b, *r;
+};
+
+// number of z-slabs for a grid, same rules as FLUID_3D::step
+static int mgSlabCount(int zRes)
+{
+#if PARALLEL==1
+	const int threadval = omp_get_max_threads();
+	int stepParts = threadval * 2;
+
+	if ((zRes - 2) / stepParts < 4) stepParts = threadval;
+	if ((zRes - 2) / stepParts < 4) stepParts = (zRes - 2) / 4;
+
+	return (stepParts < 1) ? 1 : stepParts;
+#else
+	(void)zRes;
+	return 1;
+#endif
+}
+
+// interior z range [zBegin, zEnd) of one slab
+static void mgSlabRange(int part, int stepParts, int zRes, int &zBegin, int &zEnd)
+{
+	const float partSize = (float)(zRes - 2) / stepParts;
+
+	zBegin = 1 + (int)((float)part * partSize + 0.5f);
+	zEnd = 1 + (int)((float)(part + 1) * partSize + 0.5f);
+}
+
+static void mgLevelAlloc(MG_LEVEL &lev, int xRes, int yRes, int zRes)
+{
+	lev.xRes = xRes;
+	lev.yRes = yRes;
+	lev.zRes = zRes;
+	lev.slabSize = xRes * yRes;
+	lev.totalCells = (size_t)lev.slabSize * zRes;
+
+	float **arrays[7] = {&lev.diag, &lev.wx, &lev.wy, &lev.wz, &lev.x, &lev.b, &lev.r};
+	for (int i = 0; i < 7; i++) {
+		*arrays[i] = new float[lev.totalCells];
+		memset(*arrays[i], 0, sizeof(float) * lev.totalCells);
+	}
+}
+
+static void mgLevelFree(MG_LEVEL &lev)
+{
+	delete[] lev.diag;
+	delete[] lev.wx;
+	delete[] lev.wy;
+	delete[] lev.wz;
+	delete[] lev.x;
+	delete[] lev.b;
+	delete[] lev.r;
+}
+
+// coupling of a cell to its +x/+y/+z neighbour on the level below,
+// neighbours in the border aren't unknowns of the system
+static inline float mgCoupling(const MG_LEVEL &fine, const unsigned char *skip, size_t index, int offset, bool inside)
+{
+	if (!inside)
+		return 0.0f;
+	if (skip)
+		return (!skip[index] && !skip[index + offset]) ? 1.0f : 0.0f;
+
+	if (offset == 1) return fine.wx[index];
+	if (offset == fine.xRes) return fine.wy[index];
+	return fine.wz[index];
+}
+
+// diagonal of a cell on the level below, the fine level counts
+// non-obstacle neighbours like solvePressurePre always did
+static inline float mgDiagonal(const MG_LEVEL &fine, const unsigned char *skip, size_t index)
+{
+	if (!skip)
+		return fine.diag[index];
+	if (skip[index])
+		return 0.0f;
+
+	float Acenter = 0.0f;
+	if (!skip[index + 1]) Acenter += 1.0f;
+	if (!skip[index - 1]) Acenter += 1.0f;
+	if (!skip[index + fine.xRes]) Acenter += 1.0f;
+	if (!skip[index - fine.xRes]) Acenter += 1.0f;
+	if (!skip[index + fine.slabSize]) Acenter += 1.0f;
+	if (!skip[index - fine.slabSize]) Acenter += 1.0f;
+	return Acenter;
+}
+
+// Galerkin coarse matrix for the 2x2x2 blocks of the level below
+static void mgBuildCoarse(MG_LEVEL &coarse, const MG_LEVEL &fine, const unsigned char *skip, int zBegin, int zEnd)
+{
+	const int xLast = fine.xRes - 2, yLast = fine.yRes - 2, zLast = fine.zRes - 2;
+
+	for (int Z = zBegin; Z < zEnd; Z++)
+		for (int Y = 1; Y < coarse.yRes - 1; Y++)
+			for (int X = 1; X < coarse.xRes - 1; X++)
+			{
+				float diag = 0.0f, wx = 0.0f, wy = 0.0f, wz = 0.0f;
+
+				for (int z = 2 * Z - 1; z <= 2 * Z && z <= zLast; z++)
+					for (int y = 2 * Y - 1; y <= 2 * Y && y <= yLast; y++)
+						for (int x = 2 * X - 1; x <= 2 * X && x <= xLast; x++)
+						{
+							const size_t index = x + (size_t)y * fine.xRes + (size_t)z * fine.slabSize;
+							float w;
+
+							diag += mgDiagonal(fine, skip, index);
+
+							// couplings inside the block count twice, A is symmetric
+							w = mgCoupling(fine, skip, index, 1, x < xLast);
+							if (x == 2 * X - 1) diag -= 2.0f * w; else wx += w;
+
+							w = mgCoupling(fine, skip, index, fine.xRes, y < yLast);
+							if (y == 2 * Y - 1) diag -= 2.0f * w; else wy += w;
+
+							w = mgCoupling(fine, skip, index, fine.slabSize, z < zLast);
+							if (z == 2 * Z - 1) diag -= 2.0f * w; else wz += w;
+						}
+
+				const size_t index = X + (size_t)Y * coarse.xRes + (size_t)Z * coarse.slabSize;
+
+				// closed off pockets can end up with nothing to solve
+				coarse.diag[index] = (diag > 1e-6f) ? diag : 0.0f;
+				coarse.wx[index] = wx;
+				coarse.wy[index] = wy;
+				coarse.wz[index] = wz;
+			}
+}
+
+// r = b - Ax
+static void mgResidual(MG_LEVEL &lev, const unsigned char *skip, int zBegin, int zEnd)
+{
+	const int xRes = lev.xRes, slabSize = lev.slabSize;
+	const float *x = lev.x, *b = lev.b;
+	float *r = lev.r;
+
+	size_t index = (size_t)zBegin * slabSize + xRes + 1;
+	for (int z = zBegin; z < zEnd; z++, index += 2 * xRes)
+		for (int y = 1; y < lev.yRes - 1; y++, index += 2)
+			for (int i = 1; i < xRes - 1; i++, index++)
+			{
+				if (skip) {
+					if (skip[index]) {
+						r[index] = 0.0f;
+						continue;
+					}
+
+					// border values of x stay zero
+					float Ax = 0.0f, Acenter = 0.0f;
+					if (!skip[index + 1]) { Acenter += 1.0f; Ax -= x[index + 1]; }
+					if (!skip[index - 1]) { Acenter += 1.0f; Ax -= x[index - 1]; }
+					if (!skip[index + xRes]) { Acenter += 1.0f; Ax -= x[index + xRes]; }
+					if (!skip[index - xRes]) { Acenter += 1.0f; Ax -= x[index - xRes]; }
+					if (!skip[index + slabSize]) { Acenter += 1.0f; Ax -= x[index + slabSize]; }
+					if (!skip[index - slabSize]) { Acenter += 1.0f; Ax -= x[index - slabSize]; }
+
+					r[index] = b[index] - (Ax + Acenter * x[index]);
+				}
+				else {
+					if (lev.diag[index] == 0.0f) {
+						r[index] = 0.0f;
+						continue;
+					}
+
+					r[index] = b[index] - (lev.diag[index] * x[index] -
+						lev.wx[index] * x[index + 1] - lev.wx[index - 1] * x[index - 1] -
+						lev.wy[index] * x[index + xRes] - lev.wy[index - xRes] * x[index - xRes] -
+						lev.wz[index] * x[index + slabSize] - lev.wz[index - slabSize] * x[index - slabSize]);
+				}
+			}
+}
+
+// x = x + omega * D^-1 * r, the fine level diagonal comes in as inverse
+static void mgJacobiUpdate(MG_LEVEL &lev, const float *invDiag, int zBegin, int zEnd)
+{
+	const int xRes = lev.xRes;
+
+	size_t index = (size_t)zBegin * lev.slabSize + xRes + 1;
+	for (int z = zBegin; z < zEnd; z++, index += 2 * xRes)
+		for (int y = 1; y < lev.yRes - 1; y++, index += 2)
+			for (int i = 1; i < xRes - 1; i++, index++)
+			{
+				if (invDiag)
+					lev.x[index] += MG_OMEGA * invDiag[index] * lev.r[index];
+				else if (lev.diag[index] != 0.0f)
+					lev.x[index] += MG_OMEGA * lev.r[index] / lev.diag[index];
+			}
+}
+
+// b of the coarse level is the sum of the residuals of its block
+static void mgRestrict(MG_LEVEL &coarse, const MG_LEVEL &fine, int zBegin, int zEnd)
+{
+	const int xLast = fine.xRes - 2, yLast = fine.yRes - 2, zLast = fine.zRes - 2;
+
+	for (int Z = zBegin; Z < zEnd; Z++)
+		for (int Y = 1; Y < coarse.yRes - 1; Y++)
+			for (int X = 1; X < coarse.xRes - 1; X++)
+			{
+				float sum = 0.0f;
+
+				for (int z = 2 * Z - 1; z <= 2 * Z && z <= zLast; z++)
+					for (int y = 2 * Y - 1; y <= 2 * Y && y <= yLast; y++)
+						for (int x = 2 * X - 1; x <= 2 * X && x <= xLast; x++)
+							sum += fine.r[x + (size_t)y * fine.xRes + (size_t)z * fine.slabSize];
+
+				const size_t index = X + (size_t)Y * coarse.xRes + (size_t)Z * coarse.slabSize;
+				coarse.b[index] = (coarse.diag[index] != 0.0f) ? sum : 0.0f;
+				coarse.x[index] = 0.0f;
+			}
+}
+
+// add the coarse correction to every fluid cell of its block
+static void mgProlongate(MG_LEVEL &fine, const MG_LEVEL &coarse, const unsigned char *skip, int zBegin, int zEnd)
+{
+	const int xRes = fine.xRes;
+
+	size_t index = (size_t)zBegin * fine.slabSize + xRes + 1;
+	for (int z = zBegin; z < zEnd; z++, index += 2 * xRes)
+		for (int y = 1; y < fine.yRes - 1; y++, index += 2)
+			for (int x = 1; x < xRes - 1; x++, index++)
+			{
+				if (skip ? skip[index] : (fine.diag[index] == 0.0f))
+					continue;
+
+				fine.x[index] += coarse.x[(x + 1) / 2 + (size_t)((y + 1) / 2) * coarse.xRes + (size_t)((z + 1) / 2) * coarse.slabSize];
+			}
+}
+
+enum MG_OP {
+	MG_OP_BUILD,
+	MG_OP_RESIDUAL,
+	MG_OP_JACOBI,
+	MG_OP_RESTRICT,
+	MG_OP_PROLONGATE
+};
+
+// run one operation over all z-slabs of a level, other is the level
+// below for building and restriction and the level above for prolongation
+static void mgForSlabs(MG_OP op, MG_LEVEL &lev, MG_LEVEL *other, const unsigned char *skip, const float *invDiag)
+{
+	const int stepParts = mgSlabCount(lev.zRes);
+
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, lev.zRes, zBegin, zEnd);
+
+		switch (op) {
+			case MG_OP_BUILD:		mgBuildCoarse(lev, *other, skip, zBegin, zEnd); break;
+			case MG_OP_RESIDUAL:	mgResidual(lev, skip, zBegin, zEnd); break;
+			case MG_OP_JACOBI:		mgJacobiUpdate(lev, invDiag, zBegin, zEnd); break;
+			case MG_OP_RESTRICT:	mgRestrict(lev, *other, zBegin, zEnd); break;
+			case MG_OP_PROLONGATE:	mgProlongate(lev, *other, skip, zBegin, zEnd); break;
+		}
+	}
+}
+
+static void mgSmooth(MG_LEVEL &lev, const unsigned char *skip, const float *invDiag, int sweeps)
+{
+	for (int i = 0; i < sweeps; i++) {
+		mgForSlabs(MG_OP_RESIDUAL, lev, NULL, skip, NULL);
+		mgForSlabs(MG_OP_JACOBI, lev, NULL, NULL, invDiag);
+	}
+}
+
+// x = M^-1 * b with one V-cycle, level 0 is the simulation grid
+static void mgVCycle(MG_LEVEL *levels, int totLevels, const unsigned char *skip, const float *invDiag)
+{
+	memset(levels[0].x, 0, sizeof(float) * levels[0].totalCells);
+
+	for (int l = 0; l < totLevels - 1; l++) {
+		const unsigned char *lskip = (l == 0) ? skip : NULL;
+
+		mgSmooth(levels[l], lskip, (l == 0) ? invDiag : NULL, MG_SWEEPS);
+		mgForSlabs(MG_OP_RESIDUAL, levels[l], NULL, lskip, NULL);
+		mgForSlabs(MG_OP_RESTRICT, levels[l + 1], &levels[l], NULL, NULL);
+	}
+
+	mgSmooth(levels[totLevels - 1], (totLevels == 1) ? skip : NULL, (totLevels == 1) ? invDiag : NULL, MG_COARSE_SWEEPS);
+
+	for (int l = totLevels - 2; l >= 0; l--) {
+		const unsigned char *lskip = (l == 0) ? skip : NULL;
+
+		mgForSlabs(MG_OP_PROLONGATE, levels[l], &levels[l + 1], lskip, NULL);
+		mgSmooth(levels[l], lskip, (l == 0) ? invDiag : NULL, MG_SWEEPS);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// solve the poisson equation with multigrid preconditioned CG
+//////////////////////////////////////////////////////////////////////
 void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 {
-	int x, y, z;
-	size_t index;
-	float *_q, *_Precond, *_h, *_residual, *_direction;
+	float *_q, *_Precond, *_h, *_residual, *_direction, *_mgScratch;
+	MG_LEVEL levels[MG_MAX_LEVELS];
+	int totLevels = 1;
 
 	// i = 0
 	int i = 0;
@@ -179,58 +506,113 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	_q            = new float[_totalCells]; // set 0
 	_h			  = new float[_totalCells]; // set 0
 	_Precond	  = new float[_totalCells]; // set 0
+	_mgScratch	  = new float[_totalCells]; // set 0
 
 	memset(_residual, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_q, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_direction, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_h, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_Precond, 0, sizeof(float)*_xRes*_yRes*_zRes);
-
-	float deltaNew = 0.0f;
+	memset(_mgScratch, 0, sizeof(float)*_xRes*_yRes*_zRes);
+
+	// level 0 works on the solver arrays, obstacles come from skip
+	levels[0].xRes = _xRes;
+	levels[0].yRes = _yRes;
+	levels[0].zRes = _zRes;
+	levels[0].slabSize = _slabSize;
+	levels[0].totalCells = _totalCells;
+	levels[0].diag = levels[0].wx = levels[0].wy = levels[0].wz = NULL;
+	levels[0].b = _residual;
+	levels[0].x = _h;
+	levels[0].r = _mgScratch;
+
+	// coarsen while every side still has enough cells
+	while (totLevels < MG_MAX_LEVELS) {
+		const MG_LEVEL &fine = levels[totLevels - 1];
+		const int nx = fine.xRes - 2, ny = fine.yRes - 2, nz = fine.zRes - 2;
+
+		if (nx <= MG_MIN_RES || ny <= MG_MIN_RES || nz <= MG_MIN_RES)
+			break;
+
+		MG_LEVEL &coarse = levels[totLevels];
+		mgLevelAlloc(coarse, (nx + 1) / 2 + 2, (ny + 1) / 2 + 2, (nz + 1) / 2 + 2);
+		mgForSlabs(MG_OP_BUILD, coarse, &levels[totLevels - 1], (totLevels == 1) ? skip : NULL, NULL);
+		totLevels++;
+	}
+
+	const int stepParts = mgSlabCount(_zRes);
+	float *partMax = new float[stepParts];
+	double deltaSum = 0.0;
 
 	// r = b - Ax
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-		  for (x = 1; x < _xRes - 1; x++, index++)
-		  {
-			// if the cell is a variable
-			float Acenter = 0.0f;
-			if (!skip[index])
-			{
-			  // set the matrix to the Poisson stencil in order
-			  if (!skip[index + 1]) Acenter += 1.0f;
-			  if (!skip[index - 1]) Acenter += 1.0f;
-			  if (!skip[index + _xRes]) Acenter += 1.0f;
-			  if (!skip[index - _xRes]) Acenter += 1.0f;
-			  if (!skip[index + _slabSize]) Acenter += 1.0f;
-			  if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			  _residual[index] = b[index] - (Acenter * field[index] +  
-			  field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-			  field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-			  field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
-			  field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-			  field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
-			  field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
-			}
-			else
-			{
-			_residual[index] = 0.0f;
-			}
-
-			// P^-1
-			if(Acenter < 1.0f)
-				_Precond[index] = 0.0;
-			else
-				_Precond[index] = 1.0f / Acenter;
-
-			// p = P^-1 * r
-			_direction[index] = _residual[index] * _Precond[index];
-
-			deltaNew += _residual[index] * _direction[index];
-		  }
-
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+			  for (int x = 1; x < _xRes - 1; x++, index++)
+			  {
+				// if the cell is a variable
+				float Acenter = 0.0f;
+				if (!skip[index])
+				{
+				  // set the matrix to the Poisson stencil in order
+				  if (!skip[index + 1]) Acenter += 1.0f;
+				  if (!skip[index - 1]) Acenter += 1.0f;
+				  if (!skip[index + _xRes]) Acenter += 1.0f;
+				  if (!skip[index - _xRes]) Acenter += 1.0f;
+				  if (!skip[index + _slabSize]) Acenter += 1.0f;
+				  if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+				  _residual[index] = b[index] - (Acenter * field[index] +  
+				  field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+				  field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+				  field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
+				  field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+				  field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
+				  field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
+				}
+				else
+				{
+				_residual[index] = 0.0f;
+				}
+
+				// diagonal, for smoothing and the convergence test
+				if(Acenter < 1.0f)
+					_Precond[index] = 0.0;
+				else
+					_Precond[index] = 1.0f / Acenter;
+			  }
+	}
+
+	// p = M^-1 * r
+	mgVCycle(levels, totLevels, skip, _Precond);
+
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1) reduction(+:deltaSum)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+				{
+					_direction[index] = _h[index];
+					deltaSum += _residual[index] * _direction[index];
+				}
+	}
+
+	float deltaNew = (float)deltaSum;
 
   // While deltaNew > (eps^2) * delta0
   const float eps  = SOLVER_ACCURACY;
@@ -239,90 +621,142 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
   // while (i < _iterations)
   while ((i < _iterations) && (maxR > 0.001f * eps))
   {
+	double alphaSum = 0.0;
+
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1) reduction(+:alphaSum)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+		  for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
+			{
+			  // if the cell is a variable
+			  float Acenter = 0.0f;
+			  if (!skip[index])
+			  {
+				// set the matrix to the Poisson stencil in order
+				if (!skip[index + 1]) Acenter += 1.0f;
+				if (!skip[index - 1]) Acenter += 1.0f;
+				if (!skip[index + _xRes]) Acenter += 1.0f;
+				if (!skip[index - _xRes]) Acenter += 1.0f;
+				if (!skip[index + _slabSize]) Acenter += 1.0f;
+				if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+				_q[index] = Acenter * _direction[index] +  
+				_direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+				_direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+				_direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
+				_direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+				_direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
+				_direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
+			  }
+			  else
+			  {
+			  _q[index] = 0.0f;
+			  }
+
+			  alphaSum += _direction[index] * _q[index];
+			}
+	}
 
-	float alpha = 0.0f;
-
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-        {
-          // if the cell is a variable
-          float Acenter = 0.0f;
-          if (!skip[index])
-          {
-            // set the matrix to the Poisson stencil in order
-            if (!skip[index + 1]) Acenter += 1.0f;
-            if (!skip[index - 1]) Acenter += 1.0f;
-            if (!skip[index + _xRes]) Acenter += 1.0f;
-            if (!skip[index - _xRes]) Acenter += 1.0f;
-            if (!skip[index + _slabSize]) Acenter += 1.0f;
-            if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			_q[index] = Acenter * _direction[index] +  
-            _direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-            _direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-            _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
-            _direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-            _direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
-            _direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
-          }
-		  else
-		  {
-          _q[index] = 0.0f;
-		  }
-
-		  alpha += _direction[index] * _q[index];
-        }
-
-
+	float alpha = (float)alphaSum;
     if (fabs(alpha) > 0.0f)
       alpha = deltaNew / alpha;
 
 	float deltaOld = deltaNew;
-	deltaNew = 0.0f;
 
-	maxR = 0.0;
+    // x = x + alpha * d
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		float partMaxR = 0.0f;
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+		  for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
+			{
+			  field[index] += alpha * _direction[index];
 
-	float tmp;
+			  _residual[index] -= alpha * _q[index];
 
-    // x = x + alpha * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-		{
-          field[index] += alpha * _direction[index];
+			  // converged when the diagonally scaled residual is small, as before
+			  float tmp = _residual[index] * _residual[index] * _Precond[index];
+			  partMaxR = (tmp > partMaxR) ? tmp : partMaxR;
+			}
 
-		  _residual[index] -= alpha * _q[index];
+		partMax[part] = partMaxR;
+	}
 
-		  _h[index] = _Precond[index] * _residual[index];
+	maxR = 0.0f;
+	for (int part = 0; part < stepParts; part++)
+		maxR = (partMax[part] > maxR) ? partMax[part] : maxR;
 
-		  tmp = _residual[index] * _h[index];
-		  deltaNew += tmp;
-		  maxR = (tmp > maxR) ? tmp : maxR;
+	// h = M^-1 * r
+	mgVCycle(levels, totLevels, skip, _Precond);
 
-		}
+	deltaSum = 0.0;
 
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1) reduction(+:deltaSum)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+		  for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
+			  deltaSum += _residual[index] * _h[index];
+	}
+
+	deltaNew = (float)deltaSum;
 
     // beta = deltaNew / deltaOld
-    float beta = deltaNew / deltaOld;
+    float beta = (deltaOld != 0.0f) ? deltaNew / deltaOld : 0.0f;
 
     // d = h + beta * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-          _direction[index] = _h[index] + beta * _direction[index];
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static,1)
+#endif
+	for (int part = 0; part < stepParts; part++)
+	{
+		int zBegin, zEnd;
+		mgSlabRange(part, stepParts, _zRes, zBegin, zEnd);
+
+		size_t index = (size_t)zBegin * _slabSize + _xRes + 1;
+		for (int z = zBegin; z < zEnd; z++, index += 2 * _xRes)
+		  for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
+			  _direction[index] = _h[index] + beta * _direction[index];
+	}
 
     // i = i + 1
     i++;
   }
   // cout << i << " iterations converged to " << sqrt(maxR) << endl;
 
+	for (int l = 1; l < totLevels; l++)
+		mgLevelFree(levels[l]);
+
+	delete[] partMax;
+
 	if (_h) delete[] _h;
 	if (_Precond) delete[] _Precond;
 	if (_residual) delete[] _residual;
 	if (_direction) delete[] _direction;
 	if (_q)       delete[] _q;
+	if (_mgScratch) delete[] _mgScratch;
 }
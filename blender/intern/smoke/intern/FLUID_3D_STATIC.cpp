@@ -293,23 +293,133 @@ void FLUID_3D::copyBorderZ(float* field, Vec3Int res, int zBegin, int zEnd)
 	}
 }
 
+//////////////////////////////////////////////////////////////////////
+// grow the brick mask by radius bricks along one axis
+//////////////////////////////////////////////////////////////////////
+static void dilateBricks(const unsigned char* src, unsigned char* dst, const int bres[3], int axis, int radius)
+{
+	const int stride = (axis == 0) ? 1 : (axis == 1) ? bres[0] : bres[0] * bres[1];
+
+	for (int k = 0; k < bres[2]; k++)
+		for (int j = 0; j < bres[1]; j++)
+			for (int i = 0; i < bres[0]; i++)
+			{
+				const int pos[3] = {i, j, k};
+				const int index = i + j * bres[0] + k * bres[0] * bres[1];
+				const int lo = (pos[axis] - radius < 0) ? -pos[axis] : -radius;
+				const int hi = (pos[axis] + radius >= bres[axis]) ? bres[axis] - 1 - pos[axis] : radius;
+				unsigned char active = 0;
+
+				for (int d = lo; d <= hi && !active; d++)
+					active = src[index + d * stride];
+
+				dst[index] = active;
+			}
+}
+
+//////////////////////////////////////////////////////////////////////
+// mark the bricks that hold any of the given fields, grown by the
+// distance the MacCormack passes can carry values within one step.
+// Without velocities, dt is taken as that displacement in cells.
+// Returns the number of active bricks
+//////////////////////////////////////////////////////////////////////
+int FLUID_3D::markActiveBricks(float** fields, int totfields, const float* velx, const float* vely, const float* velz,
+		const float dt, Vec3Int res, unsigned char* bricks)
+{
+	const int bres[3] = {brickRes(res[0]), brickRes(res[1]), brickRes(res[2])};
+	const int totbricks = bres[0] * bres[1] * bres[2];
+	const int slabSize = res[0] * res[1];
+	unsigned char* marked = bricks + totbricks;
+	float* velMax = new float[bres[2]];
+
+#if PARALLEL==1
+#pragma omp parallel for schedule(static,1)
+#endif
+	for (int k = 0; k < bres[2]; k++)
+	{
+		float maxVel = 0.0f;
+
+		for (int j = 0; j < bres[1]; j++)
+			for (int i = 0; i < bres[0]; i++)
+			{
+				const int zEnd = MIN((k + 1) * SMOKE_BRICK_SIZE, res[2]);
+				const int yEnd = MIN((j + 1) * SMOKE_BRICK_SIZE, res[1]);
+				const int xEnd = MIN((i + 1) * SMOKE_BRICK_SIZE, res[0]);
+				unsigned char active = 0;
+
+				for (int z = k * SMOKE_BRICK_SIZE; z < zEnd; z++)
+					for (int y = j * SMOKE_BRICK_SIZE; y < yEnd; y++)
+						for (int x = i * SMOKE_BRICK_SIZE; x < xEnd; x++)
+						{
+							const int index = x + y * res[0] + z * slabSize;
+
+							if (velx) {
+								maxVel = MAX(maxVel, fabsf(velx[index]));
+								maxVel = MAX(maxVel, fabsf(vely[index]));
+								maxVel = MAX(maxVel, fabsf(velz[index]));
+							}
+							for (int f = 0; f < totfields && !active; f++)
+								active = (fabsf(fields[f][index]) > SMOKE_BRICK_THRESHOLD);
+						}
+
+				marked[i + j * bres[0] + k * bres[0] * bres[1]] = active;
+			}
+
+		velMax[k] = maxVel;
+	}
+
+	float maxVel = 0.0f;
+	for (int k = 0; k < bres[2]; k++)
+		maxVel = MAX(maxVel, velMax[k]);
+	delete[] velMax;
+
+	// forward and backward trace of the MacCormack step plus the interpolation stencils
+	const float disp = (velx) ? fabsf(dt) * maxVel : fabsf(dt);
+	const float reach = 2.0f * disp + 3.0f;
+	const int maxRes = MAX3(bres[0], bres[1], bres[2]);
+	const int radius = (reach < (float)(maxRes * SMOKE_BRICK_SIZE)) ?
+		(int)ceilf(reach / SMOKE_BRICK_SIZE) : maxRes;
+
+	dilateBricks(marked, bricks, bres, 0, radius);
+	dilateBricks(bricks, marked, bres, 1, radius);
+	dilateBricks(marked, bricks, bres, 2, radius);
+
+	int totactive = 0;
+	for (int i = 0; i < totbricks; i++)
+		totactive += bricks[i];
+
+	return totactive;
+}
+
 /////////////////////////////////////////////////////////////////////
 // advect field with the semi lagrangian method
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::advectFieldSemiLagrange(const float dt, const float* velx, const float* vely,  const float* velz,
-		float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd)
+		float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks)
 {
 	const int xres = res[0];
 	const int yres = res[1];
 	const int zres = res[2];
 	const int slabSize = res[0] * res[1];
+	const int bxres = brickRes(xres);
+	const int bslab = bxres * brickRes(yres);
 
 
 	for (int z = zBegin; z < zEnd; z++)
 		for (int y = 0; y < yres; y++)
+		{
+			const unsigned char* brickRow = (bricks) ?
+				bricks + (z / SMOKE_BRICK_SIZE) * bslab + (y / SMOKE_BRICK_SIZE) * bxres : NULL;
+
 			for (int x = 0; x < xres; x++)
 			{
 				const int index = x + y * xres + z * xres*yres;
+
+				// nothing can reach inactive bricks
+				if (brickRow && !brickRow[x / SMOKE_BRICK_SIZE]) {
+					newField[index] = 0.0f;
+					continue;
+				}
 				
         // backtrace
 				float xTrace = x - dt * velx[index];
@@ -360,6 +470,7 @@ void FLUID_3D::advectFieldSemiLagrange(const float dt, const float* velx, const
 							s1 * (t0 * oldField[i101] +
 								t1 * oldField[i111]));
 			}
+		}
 }
 
 
@@ -369,7 +480,7 @@ void FLUID_3D::advectFieldSemiLagrange(const float dt, const float* velx, const
 // comments are the pseudocode from selle's paper
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::advectFieldMacCormack1(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd)
+				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks)
 {
 	/*const int sx= res[0];
 	const int sy= res[1];
@@ -384,13 +495,14 @@ void FLUID_3D::advectFieldMacCormack1(const float dt, const float* xVelocity, co
 
 
 	// phiHatN1 = A(phiN)
-	advectFieldSemiLagrange(  dt, xVelocity, yVelocity, zVelocity, phiN, phiN1, res, zBegin, zEnd);		// uses wide data from old field and velocities (both are whole)
+	advectFieldSemiLagrange(  dt, xVelocity, yVelocity, zVelocity, phiN, phiN1, res, zBegin, zEnd, bricks);		// uses wide data from old field and velocities (both are whole)
 }
 
 
 
 void FLUID_3D::advectFieldMacCormack2(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* newField, float* tempResult, float* temp1, Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd)
+				float* oldField, float* newField, float* tempResult, float* temp1, Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd,
+				const unsigned char* bricks)
 {
 	float* phiHatN  = tempResult;
 	float* t1  = temp1;
@@ -403,26 +515,36 @@ void FLUID_3D::advectFieldMacCormack2(const float dt, const float* xVelocity, co
 
 
 	// phiHatN = A^R(phiHatN1)
-	advectFieldSemiLagrange( -1.0f*dt, xVelocity, yVelocity, zVelocity, phiHatN, t1, res, zBegin, zEnd);		// uses wide data from old field and velocities (both are whole)
+	advectFieldSemiLagrange( -1.0f*dt, xVelocity, yVelocity, zVelocity, phiHatN, t1, res, zBegin, zEnd, bricks);		// uses wide data from old field and velocities (both are whole)
 
 	// phiN1 = phiHatN1 + (phiN - phiHatN) / 2
 	const int border = 0; 
+	const int bxres = brickRes(sx);
+	const int bslab = bxres * brickRes(sy);
 	for (int z = zBegin+border; z < zEnd-border; z++)
-		for (int y = border; y < sy-border; y++)
+		for (int y = border; y < sy-border; y++) {
+			const unsigned char* brickRow = (bricks) ?
+				bricks + (z / SMOKE_BRICK_SIZE) * bslab + (y / SMOKE_BRICK_SIZE) * bxres : NULL;
+
 			for (int x = border; x < sx-border; x++) {
 				int index = x + y * sx + z * sx*sy;
+				if (brickRow && !brickRow[x / SMOKE_BRICK_SIZE]) {
+					phiN1[index] = 0.0f;
+					continue;
+				}
 				phiN1[index] = phiHatN[index] + (phiN[index] - t1[index]) * 0.50f;
 				//phiN1[index] = phiHatN1[index]; // debug, correction off
 			}
+		}
 	copyBorderX(phiN1, res, zBegin, zEnd);
 	copyBorderY(phiN1, res, zBegin, zEnd);
 	copyBorderZ(phiN1, res, zBegin, zEnd);
 
 	// clamp any newly created extrema
-	clampExtrema(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res, zBegin, zEnd);		// uses wide data from old field and velocities (both are whole)
+	clampExtrema(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res, zBegin, zEnd, bricks);		// uses wide data from old field and velocities (both are whole)
 
 	// if the error estimate was bad, revert to first order
-	clampOutsideRays(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res, obstacles, phiHatN, zBegin, zEnd);	// phiHatN is only used at cells within thread range, so its ok
+	clampOutsideRays(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res, obstacles, phiHatN, zBegin, zEnd, bricks);	// phiHatN is only used at cells within thread range, so its ok
 
 } 
 
@@ -431,12 +553,14 @@ void FLUID_3D::advectFieldMacCormack2(const float dt, const float* xVelocity, co
 // Clamp the extrema generated by the BFECC error correction
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::clampExtrema(const float dt, const float* velx, const float* vely,  const float* velz,
-		float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd)
+		float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd, const unsigned char* bricks)
 {
 	const int xres= res[0];
 	const int yres= res[1];
 	const int zres= res[2];
 	const int slabSize = res[0] * res[1];
+	const int bxres = brickRes(xres);
+	const int bslab = bxres * brickRes(yres);
 
 	int bb=0;
 	int bt=0;
@@ -447,9 +571,17 @@ void FLUID_3D::clampExtrema(const float dt, const float* velx, const float* vely
 
 	for (int z = zBegin+bb; z < zEnd-bt; z++)
 		for (int y = 1; y < yres-1; y++)
+		{
+			const unsigned char* brickRow = (bricks) ?
+				bricks + (z / SMOKE_BRICK_SIZE) * bslab + (y / SMOKE_BRICK_SIZE) * bxres : NULL;
+
 			for (int x = 1; x < xres-1; x++)
 			{
 				const int index = x + y * xres+ z * xres*yres;
+
+				// already zero
+				if (brickRow && !brickRow[x / SMOKE_BRICK_SIZE])
+					continue;
 				// backtrace
 				float xTrace = x - dt * velx[index];
 				float yTrace = y - dt * vely[index];
@@ -507,6 +639,7 @@ void FLUID_3D::clampExtrema(const float dt, const float* velx, const float* vely
 				newField[index] = (newField[index] > maxField) ? maxField : newField[index];
 				newField[index] = (newField[index] < minField) ? minField : newField[index];
 			}
+		}
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -515,12 +648,15 @@ void FLUID_3D::clampExtrema(const float dt, const float* velx, const float* vely
 // incorrect
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::clampOutsideRays(const float dt, const float* velx, const float* vely,  const float* velz,
-				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd)
+				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd,
+				const unsigned char* bricks)
 {
 	const int sx= res[0];
 	const int sy= res[1];
 	const int sz= res[2];
 	const int slabSize = res[0] * res[1];
+	const int bxres = brickRes(sx);
+	const int bslab = bxres * brickRes(sy);
 
 	int bb=0;
 	int bt=0;
@@ -530,9 +666,17 @@ void FLUID_3D::clampOutsideRays(const float dt, const float* velx, const float*
 
 	for (int z = zBegin+bb; z < zEnd-bt; z++)
 		for (int y = 1; y < sy-1; y++)
+		{
+			const unsigned char* brickRow = (bricks) ?
+				bricks + (z / SMOKE_BRICK_SIZE) * bslab + (y / SMOKE_BRICK_SIZE) * bxres : NULL;
+
 			for (int x = 1; x < sx-1; x++)
 			{
 				const int index = x + y * sx+ z * slabSize;
+
+				// already zero, as is the old advection
+				if (brickRow && !brickRow[x / SMOKE_BRICK_SIZE])
+					continue;
 				// backtrace
 				float xBackward = x + dt * velx[index];
 				float yBackward = y + dt * vely[index];
@@ -643,4 +787,5 @@ void FLUID_3D::clampOutsideRays(const float dt, const float* velx, const float*
 									t1 * oldField[i111])); 
 				}
 			} // xyz
+		}
 }
@@ -515,5 +515,45 @@ static inline float WNoiseDz(Vec3 p, float* data) {
   return result;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// all three derivatives of noise at once, they share the 3x3x3 stencil
+// so every tile value is only read once. The weights are separable, so
+// rows along x are summed first.
+//////////////////////////////////////////////////////////////////////////////////////////
+static inline void WNoiseGradient(Vec3 p, float* data, float grad[3]) { 
+  int c[3][3], mid, n = noiseTileSize;
+  float w[3][3], dw[3][3], t;
+
+  for (int i = 0; i < 3; i++) {
+    mid = (int)ceil(p[i] - 0.5f);
+    t = mid - (p[i] - 0.5f);
+    w[i][0] = t * t / 2; 
+    w[i][2] = (1 - t) * (1 - t) / 2;
+    w[i][1] = 1 - w[i][0] - w[i][2];
+    dw[i][0] = -t;
+    dw[i][2] = (1.f - t);
+    dw[i][1] = 2.0f * t - 1.0f;
+
+    c[i][0] = modFast128(mid - 1);
+    c[i][1] = modFast128(mid);
+    c[i][2] = modFast128(mid + 1);
+  }
+
+  grad[0] = grad[1] = grad[2] = 0.0f;
+
+  for (int z = 0; z < 3; z++)
+    for (int y = 0; y < 3; y++)
+    {
+      const float *row = data + c[2][z]*n*n + c[1][y]*n;
+      const float d0 = row[c[0][0]], d1 = row[c[0][1]], d2 = row[c[0][2]];
+      const float sum = w[0][0] * d0 + w[0][1] * d1 + w[0][2] * d2;
+      const float dsum = dw[0][0] * d0 + dw[0][1] * d1 + dw[0][2] * d2;
+
+      grad[0] += w[1][y] * w[2][z] * dsum;
+      grad[1] += dw[1][y] * w[2][z] * sum;
+      grad[2] += w[1][y] * dw[2][z] * sum;
+    }
+}
+
 #endif
 
@@ -343,6 +343,46 @@ static float minDz(int x, int y, int z, float* input, Vec3Int res)
   return finalD;
 }
 
+//////////////////////////////////////////////////////////////////////
+// mark the bricks of the big grid that hold density, fuel or color
+//////////////////////////////////////////////////////////////////////
+static int markBigBricks(float *density, float *fuel, float *react, float *color_r, float *color_g, float *color_b,
+                         const float *xvel, const float *yvel, const float *zvel, float dt, Vec3Int res, unsigned char *bricks)
+{
+  float *fields[6];
+  int totfields = 0;
+
+  fields[totfields++] = density;
+  if (fuel) {
+    fields[totfields++] = fuel;
+    fields[totfields++] = react;
+  }
+  if (color_r) {
+    fields[totfields++] = color_r;
+    fields[totfields++] = color_g;
+    fields[totfields++] = color_b;
+  }
+
+  return FLUID_3D::markActiveBricks(fields, totfields, xvel, yvel, zvel, dt, res, bricks);
+}
+
+//////////////////////////////////////////////////////////////////////
+// check whether any brick overlapping the given big grid cells is active
+//////////////////////////////////////////////////////////////////////
+static bool bigBricksActive(const unsigned char *bricks, Vec3Int res, int xBegin, int yBegin, int zBegin, int size)
+{
+  const int bxres = FLUID_3D::brickRes(res[0]);
+  const int bslab = bxres * FLUID_3D::brickRes(res[1]);
+
+  for (int k = zBegin / SMOKE_BRICK_SIZE; k <= MIN(zBegin + size - 1, res[2] - 1) / SMOKE_BRICK_SIZE; k++)
+    for (int j = yBegin / SMOKE_BRICK_SIZE; j <= MIN(yBegin + size - 1, res[1] - 1) / SMOKE_BRICK_SIZE; j++)
+      for (int i = xBegin / SMOKE_BRICK_SIZE; i <= MIN(xBegin + size - 1, res[0] - 1) / SMOKE_BRICK_SIZE; i++)
+        if (bricks[i + j * bxres + k * bslab])
+          return true;
+
+  return false;
+}
+
 //////////////////////////////////////////////////////////////////////
 // handle texture coordinates (advection, reset, eigenvalues), 
 // Beware -- uses big density maccormack as temporary arrays
@@ -612,24 +652,18 @@ Vec3 WTURBULENCE::WVelocityWithJacobian(Vec3 orgPos, float* xUnwarped, float* yU
   const Vec3 p2 = orgPos + Vec3(0,NOISE_TILE_SIZE/2.0,0);
   const Vec3 p3 = orgPos + Vec3(0,0,NOISE_TILE_SIZE/2.0);
 
-  Vec3 final;
-  final[0] = WNoiseDx(p1, _noiseTile);
-  final[1] = WNoiseDy(p1, _noiseTile);
-  final[2] = WNoiseDz(p1, _noiseTile);
+  float final[3];
+  WNoiseGradient(p1, _noiseTile, final);
   // UNUSED const float f1x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   const float f1y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   const float f1z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
 
-  final[0] = WNoiseDx(p2, _noiseTile);
-  final[1] = WNoiseDy(p2, _noiseTile);
-  final[2] = WNoiseDz(p2, _noiseTile);
+  WNoiseGradient(p2, _noiseTile, final);
   const float f2x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   // UNUSED const float f2y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   const float f2z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
 
-  final[0] = WNoiseDx(p3, _noiseTile);
-  final[1] = WNoiseDy(p3, _noiseTile);
-  final[2] = WNoiseDz(p3, _noiseTile);
+  WNoiseGradient(p3, _noiseTile, final);
   const float f3x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   const float f3y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   // UNUSED const float f3z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
@@ -830,6 +864,7 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 	float *highFreqEnergy = (float *)calloc(_totalCellsSm, sizeof(float));
 	float *eigMin  = (float *)calloc(_totalCellsSm, sizeof(float));
 	float *eigMax  = (float *)calloc(_totalCellsSm, sizeof(float));
+	unsigned char *bricks = (unsigned char *)calloc(2 * FLUID_3D::brickCount(_resBig), sizeof(unsigned char));
 
 	if (_fuelBig) {
 		tempFuelBig = (float *)calloc(_totalCellsBig, sizeof(float));
@@ -864,6 +899,17 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 	FLUID_3D::setNeumannY(highFreqEnergy, ressm, 0 , ressm[2]);
 	FLUID_3D::setNeumannZ(highFreqEnergy, ressm, 0 , ressm[2]);
 
+	// only add noise where the big fields are or where the coarse
+	// velocity can carry them within this step
+	float maxVelSm = 0.0f;
+	for (int x = 0; x < _totalCellsSm; x++) {
+		maxVelSm = MAX(maxVelSm, fabsf(xvel[x]));
+		maxVelSm = MAX(maxVelSm, fabsf(yvel[x]));
+		maxVelSm = MAX(maxVelSm, fabsf(zvel[x]));
+	}
+	markBigBricks(_densityBig, _fuelBig, _reactBig, _color_rBig, _color_gBig, _color_bBig,
+	              NULL, NULL, NULL, maxVelSm * dt, _resBig, bricks);
+
 
    int threadval = 1;
 #if PARALLEL==1
@@ -886,9 +932,10 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
     const int id  = omp_get_thread_num(); /*, num = omp_get_num_threads(); */
 #endif
 
-  // vector noise main loop
+  // vector noise main loop, slices differ a lot in cost because
+  // of noise culling and inactive bricks, so hand them out dynamically
 #if PARALLEL==1
-#pragma omp for schedule(static,1)
+#pragma omp for schedule(dynamic,1)
 #endif
   for (int zSmall = 0; zSmall < _zResSm; zSmall++)
   {
@@ -910,6 +957,7 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
     float xUnwarped[3], yUnwarped[3], zUnwarped[3];
     float xWarped[3], yWarped[3], zWarped[3];
     bool nonSingular = isNonsingular(LU);
+    const bool active = bigBricksActive(bricks, _resBig, xSmall * _amplify, ySmall * _amplify, zSmall * _amplify, _amplify);
 
 	xUnwarped[0] = 1.0f; xUnwarped[1] = 0.0f; xUnwarped[2] = 0.0f;
 	yUnwarped[0] = 0.0f; yUnwarped[1] = 1.0f; yUnwarped[2] = 0.0f;
@@ -985,7 +1033,8 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
       // add noise to velocity, but only if the turbulence is
       // sufficiently undeformed, and the energy is large enough
       // to make a difference
-      const bool addNoise = eigMax[indexSmall] < 2.0f &&
+      const bool addNoise = active &&
+                            eigMax[indexSmall] < 2.0f &&
                             eigMin[indexSmall] > 0.5f;
       if (addNoise && amplitude > _cullingThreshold) {
         // base amplitude for octave 0
@@ -1084,6 +1133,9 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
   // do the MacCormack advection, with substepping if necessary
   for(int substep = 0; substep < totalSubsteps; substep++)
   {
+	// follow the fields as they move between substeps
+	markBigBricks(_densityBigOld, _fuelBigOld, _reactBigOld, _color_rBigOld, _color_gBigOld, _color_bBigOld,
+	              bigUx, bigUy, bigUz, dtSubdiv, _resBig, bricks);
 
 #if PARALLEL==1
 	#pragma omp parallel
@@ -1096,20 +1148,20 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
 #endif
 		FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-		    _densityBigOld, tempDensityBig, _resBig, zBegin, zEnd);
+		    _densityBigOld, tempDensityBig, _resBig, zBegin, zEnd, bricks);
 		if (_fuelBig) {
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-				_fuelBigOld, tempFuelBig, _resBig, zBegin, zEnd);
+				_fuelBigOld, tempFuelBig, _resBig, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-				_reactBigOld, tempReactBig, _resBig, zBegin, zEnd);
+				_reactBigOld, tempReactBig, _resBig, zBegin, zEnd, bricks);
 		}
 		if (_color_rBig) {
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_rBigOld, tempColor_rBig, _resBig, zBegin, zEnd);
+				_color_rBigOld, tempColor_rBig, _resBig, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_gBigOld, tempColor_gBig, _resBig, zBegin, zEnd);
+				_color_gBigOld, tempColor_gBig, _resBig, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_bBigOld, tempColor_bBig, _resBig, zBegin, zEnd);
+				_color_bBigOld, tempColor_bBig, _resBig, zBegin, zEnd, bricks);
 		}
 #if PARALLEL==1
 	}
@@ -1123,20 +1175,20 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
 #endif
 		FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-		    _densityBigOld, _densityBig, tempDensityBig, tempBig, _resBig, NULL, zBegin, zEnd);
+		    _densityBigOld, _densityBig, tempDensityBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 		if (_fuelBig) {
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-				_fuelBigOld, _fuelBig, tempFuelBig, tempBig, _resBig, NULL, zBegin, zEnd);
+				_fuelBigOld, _fuelBig, tempFuelBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-				_reactBigOld, _reactBig, tempReactBig, tempBig, _resBig, NULL, zBegin, zEnd);
+				_reactBigOld, _reactBig, tempReactBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 		}
 		if (_color_rBig) {
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_rBigOld, _color_rBig, tempColor_rBig, tempBig, _resBig, NULL, zBegin, zEnd);
+				_color_rBigOld, _color_rBig, tempColor_rBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_gBigOld, _color_gBig, tempColor_gBig, tempBig, _resBig, NULL, zBegin, zEnd);
+				_color_gBigOld, _color_gBig, tempColor_gBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-				_color_bBigOld, _color_bBig, tempColor_bBig, tempBig, _resBig, NULL, zBegin, zEnd);
+				_color_bBigOld, _color_bBig, tempColor_bBig, tempBig, _resBig, NULL, zBegin, zEnd, bricks);
 		}
 #if PARALLEL==1
 	}
@@ -1185,6 +1237,7 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 
   free(eigMin);
   free(eigMax);
+  free(bricks);
   
   // output files
   // string prefix = string("./amplified.preview/density_bigxy_");
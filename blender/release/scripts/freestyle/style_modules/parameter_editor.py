@@ -27,12 +27,13 @@ import mathutils
 import time
 
 from ChainingIterators import pySketchyChainSilhouetteIterator, pySketchyChainingIterator
-from freestyle import BackboneStretcherShader, BezierCurveShader, BinaryPredicate1D, ChainPredicateIterator, \
-    ChainSilhouetteIterator, ConstantColorShader, ContourUP1D, Curvature2DAngleF0D, ExternalContourUP1D, \
-    FalseBP1D, FalseUP1D, GuidingLinesShader, Interface0DIterator, Nature, Noise, Normal2DF0D, Operators, \
-    PolygonalizationShader, QuantitativeInvisibilityF1D, QuantitativeInvisibilityUP1D, SamplingShader, \
-    SpatialNoiseShader, StrokeAttribute, StrokeShader, TipRemoverShader, TrueBP1D, TrueUP1D, UnaryPredicate0D, \
-    UnaryPredicate1D, VertexOrientation2DF0D, WithinImageBoundaryUP1D, ContextFunctions, TVertex
+from freestyle import AlphaModifierShader, BackboneStretcherShader, BezierCurveShader, BinaryPredicate1D, \
+    ChainPredicateIterator, ChainSilhouetteIterator, ColorModifierShader, ConstantColorShader, ContourUP1D, \
+    Curvature2DAngleF0D, ExternalContourUP1D, FalseBP1D, FalseUP1D, GuidingLinesShader, Interface0DIterator, Nature, \
+    Noise, Normal2DF0D, Operators, PolygonalizationShader, QuantitativeInvisibilityF1D, QuantitativeInvisibilityUP1D, \
+    SamplingShader, SpatialNoiseShader, StrokeAttribute, StrokeShader, ThicknessModifierShader, TipRemoverShader, \
+    TrueBP1D, TrueUP1D, UnaryPredicate0D, UnaryPredicate1D, VertexOrientation2DF0D, WithinImageBoundaryUP1D, \
+    ContextFunctions, TVertex
 from Functions0D import CurveMaterialF0D
 from PredicatesU1D import pyNatureUP1D
 from logical_operators import AndUP1D, NotUP1D, OrUP1D
@@ -191,122 +192,6 @@ class BaseThicknessShader(StrokeShader, ThicknessModifierMixIn):
             it.increment()
 
 
-# Along Stroke modifiers
-
-def iter_t2d_along_stroke(stroke):
-    total = stroke.length_2d
-    distance = 0.0
-    it = stroke.stroke_vertices_begin()
-    prev = it.object.point
-    while not it.is_end:
-        p = it.object.point
-        distance += (prev - p).length
-        prev = p.copy()  # need a copy because the point can be altered
-        t = min(distance / total, 1.0) if total > 0.0 else 0.0
-        yield it, t
-        it.increment()
-
-
-class ColorAlongStrokeShader(ColorRampModifier):
-    def shade(self, stroke):
-        for it, t in iter_t2d_along_stroke(stroke):
-            sv = it.object
-            a = sv.attribute.color
-            b = self.evaluate(t)
-            sv.attribute.color = self.blend_ramp(a, b)
-
-
-class AlphaAlongStrokeShader(CurveMappingModifier):
-    def shade(self, stroke):
-        for it, t in iter_t2d_along_stroke(stroke):
-            sv = it.object
-            a = sv.attribute.alpha
-            b = self.evaluate(t)
-            sv.attribute.alpha = self.blend(a, b)
-
-
-class ThicknessAlongStrokeShader(ThicknessBlenderMixIn, CurveMappingModifier):
-    def __init__(self, thickness_position, thickness_ratio,
-                 blend, influence, mapping, invert, curve, value_min, value_max):
-        ThicknessBlenderMixIn.__init__(self, thickness_position, thickness_ratio)
-        CurveMappingModifier.__init__(self, blend, influence, mapping, invert, curve)
-        self.__value_min = value_min
-        self.__value_max = value_max
-
-    def shade(self, stroke):
-        for it, t in iter_t2d_along_stroke(stroke):
-            sv = it.object
-            a = sv.attribute.thickness
-            b = self.__value_min + self.evaluate(t) * (self.__value_max - self.__value_min)
-            c = self.blend_thickness(a[0], a[1], b)
-            self.set_thickness(sv, c[0], c[1])
-
-
-# Distance from Camera modifiers
-
-def iter_distance_from_camera(stroke, range_min, range_max):
-    normfac = range_max - range_min  # normalization factor
-    it = stroke.stroke_vertices_begin()
-    while not it.is_end:
-        p = it.object.point_3d  # in the camera coordinate
-        distance = p.length
-        if distance < range_min:
-            t = 0.0
-        elif distance > range_max:
-            t = 1.0
-        else:
-            t = (distance - range_min) / normfac
-        yield it, t
-        it.increment()
-
-
-class ColorDistanceFromCameraShader(ColorRampModifier):
-    def __init__(self, blend, influence, ramp, range_min, range_max):
-        ColorRampModifier.__init__(self, blend, influence, ramp)
-        self.__range_min = range_min
-        self.__range_max = range_max
-
-    def shade(self, stroke):
-        for it, t in iter_distance_from_camera(stroke, self.__range_min, self.__range_max):
-            sv = it.object
-            a = sv.attribute.color
-            b = self.evaluate(t)
-            sv.attribute.color = self.blend_ramp(a, b)
-
-
-class AlphaDistanceFromCameraShader(CurveMappingModifier):
-    def __init__(self, blend, influence, mapping, invert, curve, range_min, range_max):
-        CurveMappingModifier.__init__(self, blend, influence, mapping, invert, curve)
-        self.__range_min = range_min
-        self.__range_max = range_max
-
-    def shade(self, stroke):
-        for it, t in iter_distance_from_camera(stroke, self.__range_min, self.__range_max):
-            sv = it.object
-            a = sv.attribute.alpha
-            b = self.evaluate(t)
-            sv.attribute.alpha = self.blend(a, b)
-
-
-class ThicknessDistanceFromCameraShader(ThicknessBlenderMixIn, CurveMappingModifier):
-    def __init__(self, thickness_position, thickness_ratio,
-                 blend, influence, mapping, invert, curve, range_min, range_max, value_min, value_max):
-        ThicknessBlenderMixIn.__init__(self, thickness_position, thickness_ratio)
-        CurveMappingModifier.__init__(self, blend, influence, mapping, invert, curve)
-        self.__range_min = range_min
-        self.__range_max = range_max
-        self.__value_min = value_min
-        self.__value_max = value_max
-
-    def shade(self, stroke):
-        for it, t in iter_distance_from_camera(stroke, self.__range_min, self.__range_max):
-            sv = it.object
-            a = sv.attribute.thickness
-            b = self.__value_min + self.evaluate(t) * (self.__value_max - self.__value_min)
-            c = self.blend_thickness(a[0], a[1], b)
-            self.set_thickness(sv, c[0], c[1])
-
-
 # Distance from Object modifiers
 
 def iter_distance_from_object(stroke, object, range_min, range_max):
@@ -1303,16 +1188,14 @@ def process(layer_name, lineset_name):
     shaders_list.append(BaseColorShader(color.r, color.g, color.b, linestyle.alpha))
     shaders_list.append(BaseThicknessShader(linestyle.thickness, thickness_position,
                                             linestyle.thickness_ratio))
+    # the Along Stroke and Distance from Camera modifiers are applied by native shaders
+    native_modifiers = {'ALONG_STROKE', 'DISTANCE_FROM_CAMERA'}
+    persp_camera = (scene.camera.data.type == 'PERSP')
     for m in linestyle.color_modifiers:
         if not m.use:
             continue
-        if m.type == 'ALONG_STROKE':
-            shaders_list.append(ColorAlongStrokeShader(
-                m.blend, m.influence, m.color_ramp))
-        elif m.type == 'DISTANCE_FROM_CAMERA':
-            shaders_list.append(ColorDistanceFromCameraShader(
-                m.blend, m.influence, m.color_ramp,
-                m.range_min, m.range_max))
+        if m.type in native_modifiers:
+            shaders_list.append(ColorModifierShader(m))
         elif m.type == 'DISTANCE_FROM_OBJECT':
             shaders_list.append(ColorDistanceFromObjectShader(
                 m.blend, m.influence, m.color_ramp, m.target,
@@ -1324,13 +1207,8 @@ def process(layer_name, lineset_name):
     for m in linestyle.alpha_modifiers:
         if not m.use:
             continue
-        if m.type == 'ALONG_STROKE':
-            shaders_list.append(AlphaAlongStrokeShader(
-                m.blend, m.influence, m.mapping, m.invert, m.curve))
-        elif m.type == 'DISTANCE_FROM_CAMERA':
-            shaders_list.append(AlphaDistanceFromCameraShader(
-                m.blend, m.influence, m.mapping, m.invert, m.curve,
-                m.range_min, m.range_max))
+        if m.type in native_modifiers:
+            shaders_list.append(AlphaModifierShader(m))
         elif m.type == 'DISTANCE_FROM_OBJECT':
             shaders_list.append(AlphaDistanceFromObjectShader(
                 m.blend, m.influence, m.mapping, m.invert, m.curve, m.target,
@@ -1342,16 +1220,9 @@ def process(layer_name, lineset_name):
     for m in linestyle.thickness_modifiers:
         if not m.use:
             continue
-        if m.type == 'ALONG_STROKE':
-            shaders_list.append(ThicknessAlongStrokeShader(
-                thickness_position, linestyle.thickness_ratio,
-                m.blend, m.influence, m.mapping, m.invert, m.curve,
-                m.value_min, m.value_max))
-        elif m.type == 'DISTANCE_FROM_CAMERA':
-            shaders_list.append(ThicknessDistanceFromCameraShader(
-                thickness_position, linestyle.thickness_ratio,
-                m.blend, m.influence, m.mapping, m.invert, m.curve,
-                m.range_min, m.range_max, m.value_min, m.value_max))
+        if m.type in native_modifiers:
+            shaders_list.append(ThicknessModifierShader(
+                m, thickness_position, linestyle.thickness_ratio, persp_camera))
         elif m.type == 'DISTANCE_FROM_OBJECT':
             shaders_list.append(ThicknessDistanceFromObjectShader(
                 thickness_position, linestyle.thickness_ratio,
@@ -185,14 +185,18 @@ def modules_refresh(module_cache=addons_fake_modules):
 
 
 def modules(module_cache=addons_fake_modules, refresh=True):
-    if refresh:
+    # reading every addon's bl_info is only needed to list them,
+    # so it's done on first use instead of at startup (see reset_all)
+    if refresh or ((module_cache is addons_fake_modules) and modules._is_first):
         modules_refresh(module_cache)
+        modules._is_first = False
 
     mod_list = list(module_cache.values())
     mod_list.sort(key=lambda mod: (mod.bl_info["category"],
                                    mod.bl_info["name"],
                                    ))
     return mod_list
+modules._is_first = True
 
 
 def check(module_name):
@@ -374,9 +378,6 @@ def reset_all(reload_scripts=False):
     """
     import sys
 
-    # initializes addons_fake_modules
-    modules_refresh()
-
     # RELEASE SCRIPTS: official scripts distributed in Blender releases
     paths_list = paths()
 
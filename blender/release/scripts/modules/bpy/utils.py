@@ -37,6 +37,8 @@ __all__ = (
     "unregister_manual_map",
     "make_rna_paths",
     "manual_map",
+    "memory_serial",
+    "memory_stats",
     "resource_path",
     "script_path_user",
     "script_path_pref",
@@ -49,6 +51,7 @@ __all__ = (
     )
 
 from _bpy import register_class, unregister_class, blend_paths, resource_path
+from _bpy import memory_serial, memory_stats
 from _bpy import script_paths as _bpy_script_paths
 from _bpy import user_resource as _user_resource
 
@@ -238,11 +241,13 @@ def load_scripts(reload_scripts=False, refresh_scripts=False):
     _addon_utils.reset_all(reload_scripts)
 
     # run the active integration preset
-    filepath = preset_find(_user_preferences.inputs.active_keyconfig,
-                           "keyconfig")
+    # (key-maps are never initialized without a user interface)
+    if not _bpy.app.background:
+        filepath = preset_find(_user_preferences.inputs.active_keyconfig,
+                               "keyconfig")
 
-    if filepath:
-        keyconfig_set(filepath)
+        if filepath:
+            keyconfig_set(filepath)
 
     if reload_scripts:
         import gc
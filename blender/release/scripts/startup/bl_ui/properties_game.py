@@ -657,6 +657,7 @@ class WORLD_PT_game_physics(WorldButtonsPanel, Panel):
             sub = col.column()
             sub.active = gs.use_occlusion_culling
             sub.prop(gs, "occlusion_culling_resolution", text="Resolution")
+            sub.prop(gs, "use_occlusion_queries")
 
         else:
             split = layout.split()
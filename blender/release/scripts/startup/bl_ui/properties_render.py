@@ -279,6 +279,7 @@ class RENDER_PT_performance(RenderButtonsPanel, Panel):
         sub.active = rd.use_compositing
         sub.prop(rd, "use_free_image_textures")
         sub.prop(rd, "use_free_unused_nodes")
+        col.prop(rd, "use_persistent_data")
         sub = col.column()
         sub.active = rd.use_raytrace
         sub.label(text="Acceleration structure:")
@@ -393,7 +394,9 @@ class RENDER_PT_output(RenderButtonsPanel, Panel):
         col.prop(rd, "use_overwrite")
         col.prop(rd, "use_placeholder")
 
-        split.prop(rd, "use_file_extension")
+        col = split.column()
+        col.prop(rd, "use_file_extension")
+        col.prop(rd, "use_async_write")
 
         layout.template_image_settings(image_settings, color_management=False)
 
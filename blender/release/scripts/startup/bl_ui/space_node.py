@@ -387,6 +387,7 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
+        col.prop(tree, "edit_resolution", text="Resolution")
         col.prop(tree, "chunk_size")
 
         col = layout.column()
@@ -395,6 +396,7 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
         col.prop(snode, "show_highlight")
+        col.prop(snode, "show_timings")
         col.prop(snode, "use_hidden_preview")
 
 
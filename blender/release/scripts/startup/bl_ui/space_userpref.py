@@ -431,6 +431,12 @@ class USERPREF_PT_system(Panel):
         col.prop(system, "gl_texture_limit", text="Limit Size")
         col.prop(system, "texture_time_out", text="Time Out")
         col.prop(system, "texture_collection_rate", text="Collection Rate")
+        col.prop(system, "texture_memory_limit", text="Memory Limit")
+
+        col.separator()
+
+        col.label(text="Level of Detail:")
+        col.prop(system, "viewport_lod_size", text="Size")
 
         col.separator()
 
@@ -443,6 +449,7 @@ class USERPREF_PT_system(Panel):
         col.label(text="Sequencer / Clip Editor:")
         col.prop(system, "prefetch_frames")
         col.prop(system, "memory_cache_limit")
+        col.prop(system, "sequencer_disk_cache_limit")
 
         # 3. Column
         column = split.column()
@@ -851,6 +858,7 @@ class USERPREF_PT_file(Panel):
         sub.label(text="Scripts:")
         sub.label(text="Sounds:")
         sub.label(text="Temp:")
+        sub.label(text="Sequencer Cache:")
         sub.label(text="I18n Branches:")
         sub.label(text="Image Editor:")
         sub.label(text="Animation Player:")
@@ -862,6 +870,7 @@ class USERPREF_PT_file(Panel):
         sub.prop(paths, "script_directory", text="")
         sub.prop(paths, "sound_directory", text="")
         sub.prop(paths, "temporary_directory", text="")
+        sub.prop(paths, "sequencer_cache_directory", text="")
         sub.prop(paths, "i18n_branches_directory", text="")
         sub.prop(paths, "image_editor", text="")
         subsplit = sub.split(percentage=0.3)
@@ -181,6 +181,9 @@ struct DerivedMesh {
 	int deformedOnly; /* set by modifier stack if only deformed from original */
 	BVHCache bvhCache;
 	struct GPUDrawObject *drawObject;
+	/* decimated copy for viewport level of detail, see DM_get_lod_proxy */
+	struct DerivedMesh *lod_proxy;
+	struct DMLodJob *lod_job;
 	DerivedMeshType type;
 	float auto_bump_scale;
 	DMDirtyFlag dirty;
@@ -479,6 +482,11 @@ void DM_from_template(DerivedMesh *dm, DerivedMesh *source,
  */
 int DM_release(DerivedMesh *dm);
 
+/* decimated copy of dm with about face_ratio of its faces, built in the
+ * background on first request, returns NULL until it's ready */
+DerivedMesh *DM_get_lod_proxy(DerivedMesh *dm, float face_ratio);
+void DM_lod_proxy_exit(void);
+
 /** utility function to convert a DerivedMesh to a Mesh
  */
 void DM_to_mesh(DerivedMesh *dm, struct Mesh *me, struct Object *ob, CustomDataMask mask);
@@ -676,6 +684,8 @@ float (*editbmesh_get_vertex_cos(struct BMEditMesh *em, int *numVerts_r))[3];
 int editbmesh_modifier_is_enabled(struct Scene *scene, struct ModifierData *md, DerivedMesh *dm);
 void makeDerivedMesh(struct Scene *scene, struct Object *ob, struct BMEditMesh *em, 
                      CustomDataMask dataMask, int build_shapekey_layers);
+/* free the modifier results cached for the object */
+void mesh_free_modifier_cache(struct Object *ob);
 
 /** returns an array of deform matrices for crazyspace correction, and the
  * number of modifiers left */
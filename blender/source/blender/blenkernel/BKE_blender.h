@@ -100,6 +100,7 @@ extern void BKE_reset_undo(void);
 extern void BKE_undo_number(struct bContext *C, int nr);
 extern const char *BKE_undo_get_name(int nr, int *active);
 extern int BKE_undo_save_file(const char *filename);
+extern int BKE_undo_memfile_copy(struct MemFile *memfile);
 extern struct Main *BKE_undo_get_main(struct Scene **scene);
 
 /* copybuffer */
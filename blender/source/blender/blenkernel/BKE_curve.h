@@ -48,6 +48,8 @@ typedef struct CurveCache {
 	ListBase disp;
 	ListBase bev;
 	struct Path *path;
+	/* bevel displists per spline of the last evaluation, see displist.c */
+	ListBase bevel_cache;
 } CurveCache;
 
 #define KNOTSU(nu)      ( (nu)->orderu + (nu)->pntsu + (((nu)->flagu & CU_NURB_CYCLIC) ? ((nu)->orderu - 1) : 0) )
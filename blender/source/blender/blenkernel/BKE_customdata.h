@@ -222,6 +222,12 @@ void CustomData_free_elem(struct CustomData *data, int index, int count);
 void CustomData_interp(const struct CustomData *source, struct CustomData *dest,
                        int *src_indices, float *weights, float *sub_weights,
                        int count, int dest_index);
+/* same as calling CustomData_interp() for dest_count consecutive dest elements
+ * from the same source elements, element i using weights + i * weights_stride.
+ * finds the layers and source data only once */
+void CustomData_interp_strided(const struct CustomData *source, struct CustomData *dest,
+                               int *src_indices, float *weights, int weights_stride,
+                               int count, int dest_index, int dest_count);
 void CustomData_bmesh_interp_n(struct CustomData *data, void **src_blocks, const float *weights,
                                const float *sub_weights, int count, void *dest_block, int n);
 void CustomData_bmesh_interp(struct CustomData *data, void **src_blocks,
@@ -310,6 +316,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 /* adds flag to the layer flags */
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void **block);
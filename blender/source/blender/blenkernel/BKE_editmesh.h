@@ -84,6 +84,7 @@ typedef struct BMEditMesh {
 
 /* editmesh.c */
 void        BKE_editmesh_tessface_calc(BMEditMesh *em);
+void        BKE_editmesh_update_verts_moved(BMEditMesh *em, struct BMVert **verts, const int verts_len);
 BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate);
 BMEditMesh *BKE_editmesh_copy(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_from_object(struct Object *ob);
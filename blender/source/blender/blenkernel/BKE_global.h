@@ -129,10 +129,12 @@ enum {
 	G_DEBUG_WM =        (1 << 5), /* operator, undo */
 	G_DEBUG_JOBS =      (1 << 6), /* jobs time profiling */
 	G_DEBUG_FREESTYLE = (1 << 7), /* freestyle messages */
+	G_DEBUG_UPDATE_TIMING = (1 << 8), /* scene update time profiling */
+	G_DEBUG_DRAW_TIMING = (1 << 9),   /* viewport draw time profiling */
 };
 
 #define G_DEBUG_ALL  (G_DEBUG | G_DEBUG_FFMPEG | G_DEBUG_PYTHON | G_DEBUG_EVENTS | G_DEBUG_WM | G_DEBUG_JOBS | \
-                      G_DEBUG_FREESTYLE)
+                      G_DEBUG_FREESTYLE | G_DEBUG_UPDATE_TIMING | G_DEBUG_DRAW_TIMING)
 
 
 /* G.fileflags */
@@ -147,6 +147,11 @@ int BKE_image_has_ibuf(struct Image *ima, struct ImageUser *iuser);
 struct ImBuf *BKE_image_acquire_ibuf(struct Image *ima, struct ImageUser *iuser, void **lock_r);
 void BKE_image_release_ibuf(struct Image *ima, struct ImBuf *ibuf, void *lock);
 
+/* read-ahead for image sequences, loads the frames shown at the tot_frames scene frames
+ * following cfra (preceding when direction is negative) in parallel, can run in a thread */
+void BKE_image_sequence_prefetch(struct Image *ima, struct ImageUser *iuser, int cfra,
+                                 int tot_frames, int direction, short *stop);
+
 struct ImagePool *BKE_image_pool_new(void);
 void BKE_image_pool_free(struct ImagePool *pool);
 struct ImBuf *BKE_image_pool_acquire_ibuf(struct Image *ima, struct ImageUser *iuser, struct ImagePool *pool);
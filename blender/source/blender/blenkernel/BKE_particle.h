@@ -61,6 +61,7 @@ struct RNG;
 struct SurfaceModifierData;
 struct BVHTreeRay;
 struct BVHTreeRayHit; 
+struct SPHGrid;
 struct EdgeHash;
 
 #define PARTICLE_P              ParticleData * pa; int p
@@ -153,6 +154,7 @@ typedef struct ParticleThreadContext {
 	/* path caching */
 	int editupdate, between, steps;
 	int totchild, totparent, parent_pass;
+	int clearcache;
 
 	float cfra;
 
@@ -271,6 +273,7 @@ int psys_uses_gravity(struct ParticleSimulationData *sim);
 /* free */
 void BKE_particlesettings_free(struct ParticleSettings *part);
 void psys_free_path_cache(struct ParticleSystem *psys, struct PTCacheEdit *edit);
+void psys_free_child_path_cache(struct ParticleSystem *psys);
 void psys_free(struct Object *ob, struct ParticleSystem *psys);
 
 void psys_render_set(struct Object *ob, struct ParticleSystem *psys, float viewmat[4][4], float winmat[4][4], int winx, int winy, int timeoffset);
@@ -312,6 +315,7 @@ int psys_get_particle_state(struct ParticleSimulationData *sim, int p, struct Pa
 void psys_sph_init(struct ParticleSimulationData *sim, struct SPHData *sphdata);
 void psys_sph_finalise(struct SPHData *sphdata);
 void psys_sph_density(struct BVHTree *tree, struct SPHData *data, float co[3], float vars[2]);
+void psys_sph_grid_free(struct SPHGrid *grid);
 
 /* for anim.c */
 void psys_get_dupli_texture(struct ParticleSystem *psys, struct ParticleSettings *part,
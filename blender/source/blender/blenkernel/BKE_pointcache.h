@@ -108,6 +108,8 @@ typedef struct PTCacheData {
 
 typedef struct PTCacheFile {
 	FILE *fp;
+	/* set instead of fp when the file is written by a thread once closed */
+	struct PTCacheWriteFile *write_behind;
 
 	int frame, old_format;
 	unsigned int totpoint, type;
@@ -114,6 +114,7 @@ void  BKE_scene_frame_set(struct Scene *scene, double cfra);
 void BKE_scene_update_tagged(struct Main *bmain, struct Scene *sce);
 
 void BKE_scene_update_for_newframe(struct Main *bmain, struct Scene *sce, unsigned int lay);
+void BKE_scene_update_for_newframe_ex(struct Main *bmain, struct Scene *sce, unsigned int lay, bool do_clear_recalc);
 
 struct SceneRenderLayer *BKE_scene_add_render_layer(struct Scene *sce, const char *name);
 int BKE_scene_remove_render_layer(struct Main *main, struct Scene *scene, struct SceneRenderLayer *srl);
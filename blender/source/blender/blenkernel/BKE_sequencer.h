@@ -34,6 +34,7 @@ struct bContext;
 struct StripColorBalance;
 struct Editing;
 struct ImBuf;
+struct ListBase;
 struct Main;
 struct Mask;
 struct MovieClip;
@@ -174,6 +175,8 @@ struct ImBuf *BKE_sequencer_give_ibuf_threaded(SeqRenderData context, float cfra
 struct ImBuf *BKE_sequencer_give_ibuf_direct(SeqRenderData context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(SeqRenderData context, float cfra, int chan_shown, struct ListBase *seqbasep);
 void BKE_sequencer_give_ibuf_prefetch_request(SeqRenderData context, float cfra, int chan_shown);
+void BKE_sequencer_prefetch_stop(void);
+void BKE_sequencer_prefetch_free(void);
 
 /* **********************************************************************
  * sequencer.c
@@ -228,6 +231,7 @@ int BKE_sequencer_input_have_to_preprocess(SeqRenderData context, struct Sequenc
 
 struct SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Scene *scene, struct Sequence *seq);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
+void BKE_sequencer_proxy_rebuild_batch(struct ListBase *contexts, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, short stop);
 
 /* **********************************************************************
@@ -132,7 +132,14 @@ int sound_scene_playing(struct Scene *scene);
 
 void sound_free_waveform(struct bSound *sound);
 
-void sound_read_waveform(struct bSound *sound);
+/* Reads the waveform, can be called from a job thread, 'stop' may be NULL */
+void sound_read_waveform(struct bSound *sound, short *stop);
+
+/* Tags the waveform as loading, returns false if it's already loaded or being loaded */
+bool sound_request_waveform(struct bSound *sound);
+
+/* Clears the loading tag of a requested waveform that won't be read */
+void sound_cancel_waveform(struct bSound *sound);
 
 void sound_update_scene(struct Scene *scene);
 
@@ -0,0 +1,71 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): Blender Foundation 2014
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+#ifndef __BKE_UPDATE_TIMING_H__
+#define __BKE_UPDATE_TIMING_H__
+
+/** \file BKE_update_timing.h
+ *  \ingroup bke
+ *
+ * Collects evaluation times of objects, modifiers, constraints and drivers
+ * for the last scene update, enabled with G_DEBUG_UPDATE_TIMING.
+ */
+
+#include "BLI_utildefines.h"
+
+struct ListBase;
+
+typedef enum eUpdateTimingType {
+	UPDATE_TIMING_OBJECT     = 0,
+	UPDATE_TIMING_MODIFIER   = 1,
+	UPDATE_TIMING_CONSTRAINT = 2,
+	UPDATE_TIMING_DRIVER     = 3,
+} eUpdateTimingType;
+
+typedef struct UpdateTimingEntry {
+	struct UpdateTimingEntry *next, *prev;
+	int type;               /* eUpdateTimingType */
+	char owner[64];         /* name of the owning ID, without the ID code */
+	char name[128];         /* modifier, constraint or driver path, empty for objects */
+	double time;            /* seconds */
+} UpdateTimingEntry;
+
+bool BKE_update_timing_enabled(void);
+
+/* begin/end a scene update, nested calls are part of the outermost one */
+void BKE_update_timing_begin(void);
+void BKE_update_timing_end(void);
+
+/* thread safe, may be called from threaded object updates */
+void BKE_update_timing_add(eUpdateTimingType type, const char *owner, const char *name, double time);
+
+/* entries of the last finished scene update that evaluated anything,
+ * sorted slowest first */
+struct ListBase *BKE_update_timing_entries(void);
+double BKE_update_timing_total(void);
+/* changes every time a new result is stored */
+int BKE_update_timing_serial(void);
+const char *BKE_update_timing_type_name(eUpdateTimingType type);
+void BKE_update_timing_print(int max_entries);
+
+void BKE_update_timing_free(void);
+
+#endif  /* __BKE_UPDATE_TIMING_H__ */
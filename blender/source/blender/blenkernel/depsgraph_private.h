@@ -89,6 +89,7 @@ typedef struct DagNode {
 	int DFS_dist;       /* DFS distance */
 	int DFS_dvtm;       /* DFS discovery time */
 	int DFS_fntm;       /* DFS Finishing time */
+	unsigned int num_pending_parents;  /* threaded update, number of parents not evaluated yet */
 	struct DagAdjList *child;
 	struct DagAdjList *parent;
 	struct DagNode *next;
@@ -1655,7 +1655,6 @@ static void ccgSubSurf__calcSubdivLevel(CCGSubSurf *ss,
 	int nextLvl = curLvl + 1;
 	int ptrIdx, cornerIdx, i;
 	int vertDataSize = ss->meshIFC.vertDataSize;
-	float *q = ss->q, *r = ss->r;
 
 	#pragma omp parallel for private(ptrIdx) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
 	for (ptrIdx = 0; ptrIdx < numEffectedF; ptrIdx++) {
@@ -1734,274 +1733,294 @@ static void ccgSubSurf__calcSubdivLevel(CCGSubSurf *ss,
 		}
 	}
 
-	/* exterior edge midpoints
-	 * - old exterior edge points
-	 * - new interior face midpoints
-	 */
-	for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
-		CCGEdge *e = (CCGEdge *) effectedE[ptrIdx];
-		float sharpness = EDGE_getSharpness(e, curLvl);
-		int x, j;
-
-		if (_edge_isBoundary(e) || sharpness > 1.0f) {
-			for (x = 0; x < edgeSize - 1; x++) {
-				int fx = x * 2 + 1;
-				const float *co0 = EDGE_getCo(e, curLvl, x + 0);
-				const float *co1 = EDGE_getCo(e, curLvl, x + 1);
-				float *co  = EDGE_getCo(e, nextLvl, fx);
+	#pragma omp parallel private(ptrIdx) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
+	{
+		float *q, *r;
 
-				VertDataCopy(co, co0, ss);
-				VertDataAdd(co, co1, ss);
-				VertDataMulN(co, 0.5f, ss);
-			}
+		#pragma omp critical
+		{
+			q = MEM_mallocN(ss->meshIFC.vertDataSize, "CCGSubsurf q");
+			r = MEM_mallocN(ss->meshIFC.vertDataSize, "CCGSubsurf r");
 		}
-		else {
-			for (x = 0; x < edgeSize - 1; x++) {
-				int fx = x * 2 + 1;
-				const float *co0 = EDGE_getCo(e, curLvl, x + 0);
-				const float *co1 = EDGE_getCo(e, curLvl, x + 1);
-				float *co  = EDGE_getCo(e, nextLvl, fx);
-				int numFaces = 0;
 
-				VertDataCopy(q, co0, ss);
-				VertDataAdd(q, co1, ss);
+		/* exterior edge midpoints
+		 * - old exterior edge points
+		 * - new interior face midpoints
+		 */
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
+			CCGEdge *e = (CCGEdge *) effectedE[ptrIdx];
+			float sharpness = EDGE_getSharpness(e, curLvl);
+			int x, j;
+
+			if (_edge_isBoundary(e) || sharpness > 1.0f) {
+				for (x = 0; x < edgeSize - 1; x++) {
+					int fx = x * 2 + 1;
+					const float *co0 = EDGE_getCo(e, curLvl, x + 0);
+					const float *co1 = EDGE_getCo(e, curLvl, x + 1);
+					float *co  = EDGE_getCo(e, nextLvl, fx);
 
-				for (j = 0; j < e->numFaces; j++) {
-					CCGFace *f = e->faces[j];
-					const int f_ed_idx = _face_getEdgeIndex(f, e);
-					VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx, 1, subdivLevels, vertDataSize), ss);
-					numFaces++;
+					VertDataCopy(co, co0, ss);
+					VertDataAdd(co, co1, ss);
+					VertDataMulN(co, 0.5f, ss);
 				}
+			}
+			else {
+				for (x = 0; x < edgeSize - 1; x++) {
+					int fx = x * 2 + 1;
+					const float *co0 = EDGE_getCo(e, curLvl, x + 0);
+					const float *co1 = EDGE_getCo(e, curLvl, x + 1);
+					float *co  = EDGE_getCo(e, nextLvl, fx);
+					int numFaces = 0;
+
+					VertDataCopy(q, co0, ss);
+					VertDataAdd(q, co1, ss);
+
+					for (j = 0; j < e->numFaces; j++) {
+						CCGFace *f = e->faces[j];
+						const int f_ed_idx = _face_getEdgeIndex(f, e);
+						VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx, 1, subdivLevels, vertDataSize), ss);
+						numFaces++;
+					}
 
-				VertDataMulN(q, 1.0f / (2.0f + numFaces), ss);
+					VertDataMulN(q, 1.0f / (2.0f + numFaces), ss);
 
-				VertDataCopy(r, co0, ss);
-				VertDataAdd(r, co1, ss);
-				VertDataMulN(r, 0.5f, ss);
+					VertDataCopy(r, co0, ss);
+					VertDataAdd(r, co1, ss);
+					VertDataMulN(r, 0.5f, ss);
 
-				VertDataCopy(co, q, ss);
-				VertDataSub(r, q, ss);
-				VertDataMulN(r, sharpness, ss);
-				VertDataAdd(co, r, ss);
+					VertDataCopy(co, q, ss);
+					VertDataSub(r, q, ss);
+					VertDataMulN(r, sharpness, ss);
+					VertDataAdd(co, r, ss);
+				}
 			}
 		}
-	}
 
-	/* exterior vertex shift
-	 * - old vertex points (shifting)
-	 * - old exterior edge points
-	 * - new interior face midpoints
-	 */
-	for (ptrIdx = 0; ptrIdx < numEffectedV; ptrIdx++) {
-		CCGVert *v = (CCGVert *) effectedV[ptrIdx];
-		const float *co = VERT_getCo(v, curLvl);
-		float *nCo = VERT_getCo(v, nextLvl);
-		int sharpCount = 0, allSharp = 1;
-		float avgSharpness = 0.0;
-		int j, seam = VERT_seam(v), seamEdges = 0;
-
-		for (j = 0; j < v->numEdges; j++) {
-			CCGEdge *e = v->edges[j];
-			float sharpness = EDGE_getSharpness(e, curLvl);
+		/* exterior vertex shift
+		 * - old vertex points (shifting)
+		 * - old exterior edge points
+		 * - new interior face midpoints
+		 */
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedV; ptrIdx++) {
+			CCGVert *v = (CCGVert *) effectedV[ptrIdx];
+			const float *co = VERT_getCo(v, curLvl);
+			float *nCo = VERT_getCo(v, nextLvl);
+			int sharpCount = 0, allSharp = 1;
+			float avgSharpness = 0.0;
+			int j, seam = VERT_seam(v), seamEdges = 0;
 
-			if (seam && _edge_isBoundary(e))
-				seamEdges++;
+			for (j = 0; j < v->numEdges; j++) {
+				CCGEdge *e = v->edges[j];
+				float sharpness = EDGE_getSharpness(e, curLvl);
 
-			if (sharpness != 0.0f) {
-				sharpCount++;
-				avgSharpness += sharpness;
-			}
-			else {
-				allSharp = 0;
-			}
-		}
+				if (seam && _edge_isBoundary(e))
+					seamEdges++;
 
-		if (sharpCount) {
-			avgSharpness /= sharpCount;
-			if (avgSharpness > 1.0f) {
-				avgSharpness = 1.0f;
+				if (sharpness != 0.0f) {
+					sharpCount++;
+					avgSharpness += sharpness;
+				}
+				else {
+					allSharp = 0;
+				}
 			}
-		}
 
-		if (seamEdges < 2 || seamEdges != v->numEdges)
-			seam = 0;
-
-		if (!v->numEdges || ss->meshIFC.simpleSubdiv) {
-			VertDataCopy(nCo, co, ss);
-		}
-		else if (_vert_isBoundary(v)) {
-			int numBoundary = 0;
-
-			VertDataZero(r, ss);
-			for (j = 0; j < v->numEdges; j++) {
-				CCGEdge *e = v->edges[j];
-				if (_edge_isBoundary(e)) {
-					VertDataAdd(r, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
-					numBoundary++;
+			if (sharpCount) {
+				avgSharpness /= sharpCount;
+				if (avgSharpness > 1.0f) {
+					avgSharpness = 1.0f;
 				}
 			}
 
-			VertDataCopy(nCo, co, ss);
-			VertDataMulN(nCo, 0.75f, ss);
-			VertDataMulN(r, 0.25f / numBoundary, ss);
-			VertDataAdd(nCo, r, ss);
-		}
-		else {
-			int cornerIdx = (1 + (1 << (curLvl))) - 2;
-			int numEdges = 0, numFaces = 0;
+			if (seamEdges < 2 || seamEdges != v->numEdges)
+				seam = 0;
 
-			VertDataZero(q, ss);
-			for (j = 0; j < v->numFaces; j++) {
-				CCGFace *f = v->faces[j];
-				VertDataAdd(q, FACE_getIFCo(f, nextLvl, _face_getVertIndex(f, v), cornerIdx, cornerIdx), ss);
-				numFaces++;
-			}
-			VertDataMulN(q, 1.0f / numFaces, ss);
-			VertDataZero(r, ss);
-			for (j = 0; j < v->numEdges; j++) {
-				CCGEdge *e = v->edges[j];
-				VertDataAdd(r, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
-				numEdges++;
+			if (!v->numEdges || ss->meshIFC.simpleSubdiv) {
+				VertDataCopy(nCo, co, ss);
 			}
-			VertDataMulN(r, 1.0f / numEdges, ss);
-
-			VertDataCopy(nCo, co, ss);
-			VertDataMulN(nCo, numEdges - 2.0f, ss);
-			VertDataAdd(nCo, q, ss);
-			VertDataAdd(nCo, r, ss);
-			VertDataMulN(nCo, 1.0f / numEdges, ss);
-		}
+			else if (_vert_isBoundary(v)) {
+				int numBoundary = 0;
 
-		if ((sharpCount > 1 && v->numFaces) || seam) {
-			VertDataZero(q, ss);
+				VertDataZero(r, ss);
+				for (j = 0; j < v->numEdges; j++) {
+					CCGEdge *e = v->edges[j];
+					if (_edge_isBoundary(e)) {
+						VertDataAdd(r, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+						numBoundary++;
+					}
+				}
 
-			if (seam) {
-				avgSharpness = 1.0f;
-				sharpCount = seamEdges;
-				allSharp = 1;
+				VertDataCopy(nCo, co, ss);
+				VertDataMulN(nCo, 0.75f, ss);
+				VertDataMulN(r, 0.25f / numBoundary, ss);
+				VertDataAdd(nCo, r, ss);
 			}
+			else {
+				int cornerIdx = (1 + (1 << (curLvl))) - 2;
+				int numEdges = 0, numFaces = 0;
 
-			for (j = 0; j < v->numEdges; j++) {
-				CCGEdge *e = v->edges[j];
-				float sharpness = EDGE_getSharpness(e, curLvl);
-
-				if (seam) {
-					if (_edge_isBoundary(e))
-						VertDataAdd(q, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+				VertDataZero(q, ss);
+				for (j = 0; j < v->numFaces; j++) {
+					CCGFace *f = v->faces[j];
+					VertDataAdd(q, FACE_getIFCo(f, nextLvl, _face_getVertIndex(f, v), cornerIdx, cornerIdx), ss);
+					numFaces++;
 				}
-				else if (sharpness != 0.0f) {
-					VertDataAdd(q, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+				VertDataMulN(q, 1.0f / numFaces, ss);
+				VertDataZero(r, ss);
+				for (j = 0; j < v->numEdges; j++) {
+					CCGEdge *e = v->edges[j];
+					VertDataAdd(r, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+					numEdges++;
 				}
-			}
-
-			VertDataMulN(q, (float) 1 / sharpCount, ss);
+				VertDataMulN(r, 1.0f / numEdges, ss);
 
-			if (sharpCount != 2 || allSharp) {
-				/* q = q + (co - q) * avgSharpness */
-				VertDataCopy(r, co, ss);
-				VertDataSub(r, q, ss);
-				VertDataMulN(r, avgSharpness, ss);
-				VertDataAdd(q, r, ss);
+				VertDataCopy(nCo, co, ss);
+				VertDataMulN(nCo, numEdges - 2.0f, ss);
+				VertDataAdd(nCo, q, ss);
+				VertDataAdd(nCo, r, ss);
+				VertDataMulN(nCo, 1.0f / numEdges, ss);
 			}
 
-			/* r = co * 0.75 + q * 0.25 */
-			VertDataCopy(r, co, ss);
-			VertDataMulN(r, 0.75f, ss);
-			VertDataMulN(q, 0.25f, ss);
-			VertDataAdd(r, q, ss);
+			if ((sharpCount > 1 && v->numFaces) || seam) {
+				VertDataZero(q, ss);
 
-			/* nCo = nCo + (r - nCo) * avgSharpness */
-			VertDataSub(r, nCo, ss);
-			VertDataMulN(r, avgSharpness, ss);
-			VertDataAdd(nCo, r, ss);
-		}
-	}
+				if (seam) {
+					avgSharpness = 1.0f;
+					sharpCount = seamEdges;
+					allSharp = 1;
+				}
 
-	/* exterior edge interior shift
-	 * - old exterior edge midpoints (shifting)
-	 * - old exterior edge midpoints
-	 * - new interior face midpoints
-	 */
-	for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
-		CCGEdge *e = (CCGEdge *) effectedE[ptrIdx];
-		float sharpness = EDGE_getSharpness(e, curLvl);
-		int sharpCount = 0;
-		float avgSharpness = 0.0;
-		int x, j;
+				for (j = 0; j < v->numEdges; j++) {
+					CCGEdge *e = v->edges[j];
+					float sharpness = EDGE_getSharpness(e, curLvl);
 
-		if (sharpness != 0.0f) {
-			sharpCount = 2;
-			avgSharpness += sharpness;
+					if (seam) {
+						if (_edge_isBoundary(e))
+							VertDataAdd(q, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+					}
+					else if (sharpness != 0.0f) {
+						VertDataAdd(q, _edge_getCoVert(e, v, curLvl, 1, vertDataSize), ss);
+					}
+				}
 
-			if (avgSharpness > 1.0f) {
-				avgSharpness = 1.0f;
-			}
-		}
-		else {
-			sharpCount = 0;
-			avgSharpness = 0;
-		}
+				VertDataMulN(q, (float) 1 / sharpCount, ss);
 
-		if (_edge_isBoundary(e)) {
-			for (x = 1; x < edgeSize - 1; x++) {
-				int fx = x * 2;
-				const float *co = EDGE_getCo(e, curLvl, x);
-				float *nCo = EDGE_getCo(e, nextLvl, fx);
+				if (sharpCount != 2 || allSharp) {
+					/* q = q + (co - q) * avgSharpness */
+					VertDataCopy(r, co, ss);
+					VertDataSub(r, q, ss);
+					VertDataMulN(r, avgSharpness, ss);
+					VertDataAdd(q, r, ss);
+				}
 
-				/* Average previous level's endpoints */
-				VertDataCopy(r, EDGE_getCo(e, curLvl, x - 1), ss);
-				VertDataAdd(r, EDGE_getCo(e, curLvl, x + 1), ss);
-				VertDataMulN(r, 0.5f, ss);
+				/* r = co * 0.75 + q * 0.25 */
+				VertDataCopy(r, co, ss);
+				VertDataMulN(r, 0.75f, ss);
+				VertDataMulN(q, 0.25f, ss);
+				VertDataAdd(r, q, ss);
 
-				/* nCo = nCo * 0.75 + r * 0.25 */
-				VertDataCopy(nCo, co, ss);
-				VertDataMulN(nCo, 0.75f, ss);
-				VertDataMulN(r, 0.25f, ss);
+				/* nCo = nCo + (r - nCo) * avgSharpness */
+				VertDataSub(r, nCo, ss);
+				VertDataMulN(r, avgSharpness, ss);
 				VertDataAdd(nCo, r, ss);
 			}
 		}
-		else {
-			for (x = 1; x < edgeSize - 1; x++) {
-				int fx = x * 2;
-				const float *co = EDGE_getCo(e, curLvl, x);
-				float *nCo = EDGE_getCo(e, nextLvl, fx);
-				int numFaces = 0;
 
-				VertDataZero(q, ss);
-				VertDataZero(r, ss);
-				VertDataAdd(r, EDGE_getCo(e, curLvl, x - 1), ss);
-				VertDataAdd(r, EDGE_getCo(e, curLvl, x + 1), ss);
-				for (j = 0; j < e->numFaces; j++) {
-					CCGFace *f = e->faces[j];
-					int f_ed_idx = _face_getEdgeIndex(f, e);
-					VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx - 1, 1, subdivLevels, vertDataSize), ss);
-					VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx + 1, 1, subdivLevels, vertDataSize), ss);
-
-					VertDataAdd(r, _face_getIFCoEdge(f, e, f_ed_idx, curLvl, x, 1, subdivLevels, vertDataSize), ss);
-					numFaces++;
+		/* exterior edge interior shift
+		 * - old exterior edge midpoints (shifting)
+		 * - old exterior edge midpoints
+		 * - new interior face midpoints
+		 */
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
+			CCGEdge *e = (CCGEdge *) effectedE[ptrIdx];
+			float sharpness = EDGE_getSharpness(e, curLvl);
+			int sharpCount = 0;
+			float avgSharpness = 0.0;
+			int x, j;
+
+			if (sharpness != 0.0f) {
+				sharpCount = 2;
+				avgSharpness += sharpness;
+
+				if (avgSharpness > 1.0f) {
+					avgSharpness = 1.0f;
 				}
-				VertDataMulN(q, 1.0f / (numFaces * 2.0f), ss);
-				VertDataMulN(r, 1.0f / (2.0f + numFaces), ss);
+			}
+			else {
+				sharpCount = 0;
+				avgSharpness = 0;
+			}
 
-				VertDataCopy(nCo, co, ss);
-				VertDataMulN(nCo, (float) numFaces, ss);
-				VertDataAdd(nCo, q, ss);
-				VertDataAdd(nCo, r, ss);
-				VertDataMulN(nCo, 1.0f / (2 + numFaces), ss);
+			if (_edge_isBoundary(e)) {
+				for (x = 1; x < edgeSize - 1; x++) {
+					int fx = x * 2;
+					const float *co = EDGE_getCo(e, curLvl, x);
+					float *nCo = EDGE_getCo(e, nextLvl, fx);
+
+					/* Average previous level's endpoints */
+					VertDataCopy(r, EDGE_getCo(e, curLvl, x - 1), ss);
+					VertDataAdd(r, EDGE_getCo(e, curLvl, x + 1), ss);
+					VertDataMulN(r, 0.5f, ss);
 
-				if (sharpCount == 2) {
-					VertDataCopy(q, co, ss);
-					VertDataMulN(q, 6.0f, ss);
-					VertDataAdd(q, EDGE_getCo(e, curLvl, x - 1), ss);
-					VertDataAdd(q, EDGE_getCo(e, curLvl, x + 1), ss);
-					VertDataMulN(q, 1 / 8.0f, ss);
+					/* nCo = nCo * 0.75 + r * 0.25 */
+					VertDataCopy(nCo, co, ss);
+					VertDataMulN(nCo, 0.75f, ss);
+					VertDataMulN(r, 0.25f, ss);
+					VertDataAdd(nCo, r, ss);
+				}
+			}
+			else {
+				for (x = 1; x < edgeSize - 1; x++) {
+					int fx = x * 2;
+					const float *co = EDGE_getCo(e, curLvl, x);
+					float *nCo = EDGE_getCo(e, nextLvl, fx);
+					int numFaces = 0;
+
+					VertDataZero(q, ss);
+					VertDataZero(r, ss);
+					VertDataAdd(r, EDGE_getCo(e, curLvl, x - 1), ss);
+					VertDataAdd(r, EDGE_getCo(e, curLvl, x + 1), ss);
+					for (j = 0; j < e->numFaces; j++) {
+						CCGFace *f = e->faces[j];
+						int f_ed_idx = _face_getEdgeIndex(f, e);
+						VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx - 1, 1, subdivLevels, vertDataSize), ss);
+						VertDataAdd(q, _face_getIFCoEdge(f, e, f_ed_idx, nextLvl, fx + 1, 1, subdivLevels, vertDataSize), ss);
+
+						VertDataAdd(r, _face_getIFCoEdge(f, e, f_ed_idx, curLvl, x, 1, subdivLevels, vertDataSize), ss);
+						numFaces++;
+					}
+					VertDataMulN(q, 1.0f / (numFaces * 2.0f), ss);
+					VertDataMulN(r, 1.0f / (2.0f + numFaces), ss);
 
-					VertDataSub(q, nCo, ss);
-					VertDataMulN(q, avgSharpness, ss);
+					VertDataCopy(nCo, co, ss);
+					VertDataMulN(nCo, (float) numFaces, ss);
 					VertDataAdd(nCo, q, ss);
+					VertDataAdd(nCo, r, ss);
+					VertDataMulN(nCo, 1.0f / (2 + numFaces), ss);
+
+					if (sharpCount == 2) {
+						VertDataCopy(q, co, ss);
+						VertDataMulN(q, 6.0f, ss);
+						VertDataAdd(q, EDGE_getCo(e, curLvl, x - 1), ss);
+						VertDataAdd(q, EDGE_getCo(e, curLvl, x + 1), ss);
+						VertDataMulN(q, 1 / 8.0f, ss);
+
+						VertDataSub(q, nCo, ss);
+						VertDataMulN(q, avgSharpness, ss);
+						VertDataAdd(nCo, q, ss);
+					}
 				}
 			}
 		}
+
+		#pragma omp critical
+		{
+			MEM_freeN(q);
+			MEM_freeN(r);
+		}
 	}
 
 	#pragma omp parallel private(ptrIdx) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
@@ -2161,8 +2180,7 @@ static void ccgSubSurf__sync(CCGSubSurf *ss)
 	int subdivLevels = ss->subdivLevels;
 	int vertDataSize = ss->meshIFC.vertDataSize;
 	int i, j, ptrIdx, S;
-	int curLvl, nextLvl;
-	void *q = ss->q, *r = ss->r;
+	int curLvl, nextLvl, edgeSize;
 
 	effectedV = MEM_mallocN(sizeof(*effectedV) * ss->vMap->numEntries, "CCGSubsurf effectedV");
 	effectedE = MEM_mallocN(sizeof(*effectedE) * ss->eMap->numEntries, "CCGSubsurf effectedE");
@@ -2195,177 +2213,201 @@ static void ccgSubSurf__sync(CCGSubSurf *ss)
 
 	curLvl = 0;
 	nextLvl = curLvl + 1;
+	edgeSize = ccg_edgesize(curLvl);
 
-	for (ptrIdx = 0; ptrIdx < numEffectedF; ptrIdx++) {
-		CCGFace *f = effectedF[ptrIdx];
-		void *co = FACE_getCenterData(f);
-		VertDataZero(co, ss);
-		for (i = 0; i < f->numVerts; i++) {
-			VertDataAdd(co, VERT_getCo(FACE_getVerts(f)[i], curLvl), ss);
-		}
-		VertDataMulN(co, 1.0f / f->numVerts, ss);
-
-		f->flags = 0;
-	}
-	for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
-		CCGEdge *e = effectedE[ptrIdx];
-		void *co = EDGE_getCo(e, nextLvl, 1);
-		float sharpness = EDGE_getSharpness(e, curLvl);
+	/* level 1 from the base mesh, each thread with its own scratch data */
+	#pragma omp parallel private(ptrIdx, i) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
+	{
+		void *q, *r;
 
-		if (_edge_isBoundary(e) || sharpness >= 1.0f) {
-			VertDataCopy(co, VERT_getCo(e->v0, curLvl), ss);
-			VertDataAdd(co, VERT_getCo(e->v1, curLvl), ss);
-			VertDataMulN(co, 0.5f, ss);
+		#pragma omp critical
+		{
+			q = MEM_mallocN(ss->meshIFC.vertDataSize, "CCGSubsurf q");
+			r = MEM_mallocN(ss->meshIFC.vertDataSize, "CCGSubsurf r");
 		}
-		else {
-			int numFaces = 0;
-			VertDataCopy(q, VERT_getCo(e->v0, curLvl), ss);
-			VertDataAdd(q, VERT_getCo(e->v1, curLvl), ss);
-			for (i = 0; i < e->numFaces; i++) {
-				CCGFace *f = e->faces[i];
-				VertDataAdd(q, (float *)FACE_getCenterData(f), ss);
-				numFaces++;
-			}
-			VertDataMulN(q, 1.0f / (2.0f + numFaces), ss);
 
-			VertDataCopy(r, VERT_getCo(e->v0, curLvl), ss);
-			VertDataAdd(r, VERT_getCo(e->v1, curLvl), ss);
-			VertDataMulN(r, 0.5f, ss);
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedF; ptrIdx++) {
+			CCGFace *f = effectedF[ptrIdx];
+			void *co = FACE_getCenterData(f);
+			VertDataZero(co, ss);
+			for (i = 0; i < f->numVerts; i++) {
+				VertDataAdd(co, VERT_getCo(FACE_getVerts(f)[i], curLvl), ss);
+			}
+			VertDataMulN(co, 1.0f / f->numVerts, ss);
 
-			VertDataCopy(co, q, ss);
-			VertDataSub(r, q, ss);
-			VertDataMulN(r, sharpness, ss);
-			VertDataAdd(co, r, ss);
+			f->flags = 0;
 		}
 
-		/* edge flags cleared later */
-	}
-	for (ptrIdx = 0; ptrIdx < numEffectedV; ptrIdx++) {
-		CCGVert *v = effectedV[ptrIdx];
-		void *co = VERT_getCo(v, curLvl);
-		void *nCo = VERT_getCo(v, nextLvl);
-		int sharpCount = 0, allSharp = 1;
-		float avgSharpness = 0.0;
-		int seam = VERT_seam(v), seamEdges = 0;
-
-		for (i = 0; i < v->numEdges; i++) {
-			CCGEdge *e = v->edges[i];
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedE; ptrIdx++) {
+			CCGEdge *e = effectedE[ptrIdx];
+			void *co = EDGE_getCo(e, nextLvl, 1);
 			float sharpness = EDGE_getSharpness(e, curLvl);
 
-			if (seam && _edge_isBoundary(e))
-				seamEdges++;
-
-			if (sharpness != 0.0f) {
-				sharpCount++;
-				avgSharpness += sharpness;
+			if (_edge_isBoundary(e) || sharpness >= 1.0f) {
+				VertDataCopy(co, VERT_getCo(e->v0, curLvl), ss);
+				VertDataAdd(co, VERT_getCo(e->v1, curLvl), ss);
+				VertDataMulN(co, 0.5f, ss);
 			}
 			else {
-				allSharp = 0;
-			}
-		}
+				int numFaces = 0;
+				VertDataCopy(q, VERT_getCo(e->v0, curLvl), ss);
+				VertDataAdd(q, VERT_getCo(e->v1, curLvl), ss);
+				for (i = 0; i < e->numFaces; i++) {
+					CCGFace *f = e->faces[i];
+					VertDataAdd(q, (float *)FACE_getCenterData(f), ss);
+					numFaces++;
+				}
+				VertDataMulN(q, 1.0f / (2.0f + numFaces), ss);
 
-		if (sharpCount) {
-			avgSharpness /= sharpCount;
-			if (avgSharpness > 1.0f) {
-				avgSharpness = 1.0f;
-			}
-		}
+				VertDataCopy(r, VERT_getCo(e->v0, curLvl), ss);
+				VertDataAdd(r, VERT_getCo(e->v1, curLvl), ss);
+				VertDataMulN(r, 0.5f, ss);
 
-		if (seamEdges < 2 || seamEdges != v->numEdges)
-			seam = 0;
+				VertDataCopy(co, q, ss);
+				VertDataSub(r, q, ss);
+				VertDataMulN(r, sharpness, ss);
+				VertDataAdd(co, r, ss);
+			}
 
-		if (!v->numEdges || ss->meshIFC.simpleSubdiv) {
-			VertDataCopy(nCo, co, ss);
+			/* edge flags cleared later */
 		}
-		else if (_vert_isBoundary(v)) {
-			int numBoundary = 0;
 
-			VertDataZero(r, ss);
+		#pragma omp for schedule(static)
+		for (ptrIdx = 0; ptrIdx < numEffectedV; ptrIdx++) {
+			CCGVert *v = effectedV[ptrIdx];
+			void *co = VERT_getCo(v, curLvl);
+			void *nCo = VERT_getCo(v, nextLvl);
+			int sharpCount = 0, allSharp = 1;
+			float avgSharpness = 0.0;
+			int seam = VERT_seam(v), seamEdges = 0;
+
 			for (i = 0; i < v->numEdges; i++) {
 				CCGEdge *e = v->edges[i];
-				if (_edge_isBoundary(e)) {
-					VertDataAdd(r, VERT_getCo(_edge_getOtherVert(e, v), curLvl), ss);
-					numBoundary++;
+				float sharpness = EDGE_getSharpness(e, curLvl);
+
+				if (seam && _edge_isBoundary(e))
+					seamEdges++;
+
+				if (sharpness != 0.0f) {
+					sharpCount++;
+					avgSharpness += sharpness;
+				}
+				else {
+					allSharp = 0;
 				}
 			}
-			VertDataCopy(nCo, co, ss);
-			VertDataMulN(nCo, 0.75f, ss);
-			VertDataMulN(r, 0.25f / numBoundary, ss);
-			VertDataAdd(nCo, r, ss);
-		}
-		else {
-			int numEdges = 0, numFaces = 0;
 
-			VertDataZero(q, ss);
-			for (i = 0; i < v->numFaces; i++) {
-				CCGFace *f = v->faces[i];
-				VertDataAdd(q, (float *)FACE_getCenterData(f), ss);
-				numFaces++;
+			if (sharpCount) {
+				avgSharpness /= sharpCount;
+				if (avgSharpness > 1.0f) {
+					avgSharpness = 1.0f;
+				}
 			}
-			VertDataMulN(q, 1.0f / numFaces, ss);
-			VertDataZero(r, ss);
-			for (i = 0; i < v->numEdges; i++) {
-				CCGEdge *e = v->edges[i];
-				VertDataAdd(r, VERT_getCo(_edge_getOtherVert(e, v), curLvl), ss);
-				numEdges++;
+
+			if (seamEdges < 2 || seamEdges != v->numEdges)
+				seam = 0;
+
+			if (!v->numEdges || ss->meshIFC.simpleSubdiv) {
+				VertDataCopy(nCo, co, ss);
 			}
-			VertDataMulN(r, 1.0f / numEdges, ss);
+			else if (_vert_isBoundary(v)) {
+				int numBoundary = 0;
 
-			VertDataCopy(nCo, co, ss);
-			VertDataMulN(nCo, numEdges - 2.0f, ss);
-			VertDataAdd(nCo, q, ss);
-			VertDataAdd(nCo, r, ss);
-			VertDataMulN(nCo, 1.0f / numEdges, ss);
-		}
+				VertDataZero(r, ss);
+				for (i = 0; i < v->numEdges; i++) {
+					CCGEdge *e = v->edges[i];
+					if (_edge_isBoundary(e)) {
+						VertDataAdd(r, VERT_getCo(_edge_getOtherVert(e, v), curLvl), ss);
+						numBoundary++;
+					}
+				}
+				VertDataCopy(nCo, co, ss);
+				VertDataMulN(nCo, 0.75f, ss);
+				VertDataMulN(r, 0.25f / numBoundary, ss);
+				VertDataAdd(nCo, r, ss);
+			}
+			else {
+				int numEdges = 0, numFaces = 0;
 
-		if (sharpCount > 1 || seam) {
-			VertDataZero(q, ss);
+				VertDataZero(q, ss);
+				for (i = 0; i < v->numFaces; i++) {
+					CCGFace *f = v->faces[i];
+					VertDataAdd(q, (float *)FACE_getCenterData(f), ss);
+					numFaces++;
+				}
+				VertDataMulN(q, 1.0f / numFaces, ss);
+				VertDataZero(r, ss);
+				for (i = 0; i < v->numEdges; i++) {
+					CCGEdge *e = v->edges[i];
+					VertDataAdd(r, VERT_getCo(_edge_getOtherVert(e, v), curLvl), ss);
+					numEdges++;
+				}
+				VertDataMulN(r, 1.0f / numEdges, ss);
 
-			if (seam) {
-				avgSharpness = 1.0f;
-				sharpCount = seamEdges;
-				allSharp = 1;
+				VertDataCopy(nCo, co, ss);
+				VertDataMulN(nCo, numEdges - 2.0f, ss);
+				VertDataAdd(nCo, q, ss);
+				VertDataAdd(nCo, r, ss);
+				VertDataMulN(nCo, 1.0f / numEdges, ss);
 			}
 
-			for (i = 0; i < v->numEdges; i++) {
-				CCGEdge *e = v->edges[i];
-				float sharpness = EDGE_getSharpness(e, curLvl);
+			if (sharpCount > 1 || seam) {
+				VertDataZero(q, ss);
 
 				if (seam) {
-					if (_edge_isBoundary(e)) {
+					avgSharpness = 1.0f;
+					sharpCount = seamEdges;
+					allSharp = 1;
+				}
+
+				for (i = 0; i < v->numEdges; i++) {
+					CCGEdge *e = v->edges[i];
+					float sharpness = EDGE_getSharpness(e, curLvl);
+
+					if (seam) {
+						if (_edge_isBoundary(e)) {
+							CCGVert *oV = _edge_getOtherVert(e, v);
+							VertDataAdd(q, VERT_getCo(oV, curLvl), ss);
+						}
+					}
+					else if (sharpness != 0.0f) {
 						CCGVert *oV = _edge_getOtherVert(e, v);
 						VertDataAdd(q, VERT_getCo(oV, curLvl), ss);
 					}
 				}
-				else if (sharpness != 0.0f) {
-					CCGVert *oV = _edge_getOtherVert(e, v);
-					VertDataAdd(q, VERT_getCo(oV, curLvl), ss);
-				}
-			}
 
-			VertDataMulN(q, (float) 1 / sharpCount, ss);
+				VertDataMulN(q, (float) 1 / sharpCount, ss);
 
-			if (sharpCount != 2 || allSharp) {
-				/* q = q + (co - q) * avgSharpness */
+				if (sharpCount != 2 || allSharp) {
+					/* q = q + (co - q) * avgSharpness */
+					VertDataCopy(r, co, ss);
+					VertDataSub(r, q, ss);
+					VertDataMulN(r, avgSharpness, ss);
+					VertDataAdd(q, r, ss);
+				}
+
+				/* r = co * 0.75 + q * 0.25 */
 				VertDataCopy(r, co, ss);
-				VertDataSub(r, q, ss);
+				VertDataMulN(r, 0.75f, ss);
+				VertDataMulN(q, 0.25f, ss);
+				VertDataAdd(r, q, ss);
+
+				/* nCo = nCo + (r - nCo) * avgSharpness */
+				VertDataSub(r, nCo, ss);
 				VertDataMulN(r, avgSharpness, ss);
-				VertDataAdd(q, r, ss);
+				VertDataAdd(nCo, r, ss);
 			}
 
-			/* r = co * 0.75 + q * 0.25 */
-			VertDataCopy(r, co, ss);
-			VertDataMulN(r, 0.75f, ss);
-			VertDataMulN(q, 0.25f, ss);
-			VertDataAdd(r, q, ss);
-
-			/* nCo = nCo + (r - nCo) * avgSharpness */
-			VertDataSub(r, nCo, ss);
-			VertDataMulN(r, avgSharpness, ss);
-			VertDataAdd(nCo, r, ss);
+			/* vert flags cleared later */
 		}
 
-		/* vert flags cleared later */
+		#pragma omp critical
+		{
+			MEM_freeN(q);
+			MEM_freeN(r);
+		}
 	}
 
 	if (ss->useAgeCounts) {
@@ -2388,11 +2430,14 @@ static void ccgSubSurf__sync(CCGSubSurf *ss)
 		}
 	}
 
+	#pragma omp parallel for private(i) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
 	for (i = 0; i < numEffectedE; i++) {
 		CCGEdge *e = effectedE[i];
 		VertDataCopy(EDGE_getCo(e, nextLvl, 0), VERT_getCo(e->v0, nextLvl), ss);
 		VertDataCopy(EDGE_getCo(e, nextLvl, 2), VERT_getCo(e->v1, nextLvl), ss);
 	}
+
+	#pragma omp parallel for private(i, S) if (numEffectedF * edgeSize * edgeSize * 4 >= CCG_OMP_LIMIT)
 	for (i = 0; i < numEffectedF; i++) {
 		CCGFace *f = effectedF[i];
 		for (S = 0; S < f->numVerts; S++) {
@@ -48,6 +48,10 @@
 #include "BLI_memarena.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
 
 #include "BKE_pbvh.h"
 #include "BKE_cdderivedmesh.h"
@@ -67,6 +71,7 @@
 #include "BKE_bvhutils.h"
 #include "BKE_deform.h"
 #include "BKE_global.h" /* For debug flag, DM_update_tessface_data() func. */
+#include "BKE_update_timing.h"
 
 #ifdef WITH_GAMEENGINE
 #include "BKE_navmesh_conversion.h"
@@ -75,6 +80,9 @@ static DerivedMesh *navmesh_dm_createNavMeshForVisualization(DerivedMesh *dm);
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
 #include "GL/glew.h"
 
 #include "GPU_buffers.h"
@@ -299,6 +307,8 @@ void DM_init(DerivedMesh *dm, DerivedMeshType type, int numVerts, int numEdges,
 	dm->needsFree = 1;
 	dm->auto_bump_scale = -1.0f;
 	dm->dirty = 0;
+	dm->lod_proxy = NULL;
+	dm->lod_job = NULL;
 
 	/* don't use CustomData_reset(...); because we dont want to touch customdata */
 	fill_vn_i(dm->vertData.typemap, CD_NUMTYPES, -1);
@@ -338,11 +348,125 @@ void DM_from_template(DerivedMesh *dm, DerivedMesh *source, DerivedMeshType type
 	dm->dirty = 0;
 }
 
+/* Level of detail proxies
+ *
+ * The decimation runs as a task on a copy in BMesh form, so the source
+ * mesh may be freed meanwhile, the job is then only flagged and frees its
+ * own result. */
+
+typedef struct DMLodJob {
+	BMesh *bm;
+	float face_ratio;
+	DerivedMesh *result;
+	bool done;
+	bool cancelled;
+} DMLodJob;
+
+static TaskPool *lod_task_pool = NULL;
+static ThreadMutex lod_mutex = BLI_MUTEX_INITIALIZER;
+
+static void dm_lod_job_free(DMLodJob *job)
+{
+	if (job->result) {
+		job->result->needsFree = 1;
+		job->result->release(job->result);
+	}
+	MEM_freeN(job);
+}
+
+static void dm_lod_task_run(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	DMLodJob *job = taskdata;
+	DerivedMesh *result;
+
+	BM_mesh_decimate_collapse(job->bm, job->face_ratio, NULL, false);
+	result = CDDM_from_bmesh(job->bm, FALSE);
+	BM_mesh_free(job->bm);
+	job->bm = NULL;
+
+	result->dirty = DM_DIRTY_NORMALS;
+	DM_ensure_normals(result);
+	DM_ensure_tessface(result);
+
+	BLI_mutex_lock(&lod_mutex);
+	job->result = result;
+	job->done = true;
+	if (job->cancelled)
+		dm_lod_job_free(job);
+	BLI_mutex_unlock(&lod_mutex);
+}
+
+DerivedMesh *DM_get_lod_proxy(DerivedMesh *dm, float face_ratio)
+{
+	DMLodJob *job;
+
+	if (dm->lod_proxy)
+		return dm->lod_proxy;
+
+	if (dm->lod_job) {
+		BLI_mutex_lock(&lod_mutex);
+		job = dm->lod_job;
+		if (job->done) {
+			/* owned by dm, drawing code may call release on it */
+			dm->lod_proxy = job->result;
+			dm->lod_proxy->needsFree = 0;
+			job->result = NULL;
+			dm_lod_job_free(job);
+			dm->lod_job = NULL;
+		}
+		BLI_mutex_unlock(&lod_mutex);
+
+		return dm->lod_proxy;
+	}
+
+	if (lod_task_pool == NULL)
+		lod_task_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+	/* the conversion reads dm, so it can't be part of the task */
+	job = MEM_callocN(sizeof(DMLodJob), "DMLodJob");
+	job->bm = DM_to_bmesh(dm, true);
+	job->face_ratio = face_ratio;
+	dm->lod_job = job;
+
+	BLI_task_pool_push(lod_task_pool, dm_lod_task_run, job, false, TASK_PRIORITY_LOW);
+
+	return NULL;
+}
+
+static void dm_lod_proxy_free(DerivedMesh *dm)
+{
+	if (dm->lod_job) {
+		BLI_mutex_lock(&lod_mutex);
+		if (dm->lod_job->done)
+			dm_lod_job_free(dm->lod_job);
+		else
+			dm->lod_job->cancelled = true;
+		BLI_mutex_unlock(&lod_mutex);
+		dm->lod_job = NULL;
+	}
+
+	if (dm->lod_proxy) {
+		dm->lod_proxy->needsFree = 1;
+		dm->lod_proxy->release(dm->lod_proxy);
+		dm->lod_proxy = NULL;
+	}
+}
+
+void DM_lod_proxy_exit(void)
+{
+	if (lod_task_pool) {
+		BLI_task_pool_work_and_wait(lod_task_pool);
+		BLI_task_pool_free(lod_task_pool);
+		lod_task_pool = NULL;
+	}
+}
+
 int DM_release(DerivedMesh *dm)
 {
 	if (dm->needsFree) {
 		bvhcache_free(&dm->bvhCache);
 		GPU_drawobject_free(dm);
+		dm_lod_proxy_free(dm);
 		CustomData_free(&dm->vertData, dm->numVertData);
 		CustomData_free(&dm->edgeData, dm->numEdgeData);
 		CustomData_free(&dm->faceData, dm->numTessFaceData);
@@ -1412,6 +1536,343 @@ static void dm_ensure_display_normals(DerivedMesh *dm)
 		CDDM_calc_normals_mapping_ex(dm, (dm->dirty & DM_DIRTY_NORMALS) ? false : true);
 	}
 }
+/* ---------------------- Modifier Stack Cache ---------------------- */
+
+/* The stack result after expensive modifiers is kept per object, so that
+ * changes to later modifiers don't evaluate the whole stack again. Results
+ * are identified by a hash of the base mesh and of everything that went into
+ * the modifiers up to that point (settings, data masks, linked objects). */
+
+/* only cache the result of modifiers that took longer than this, in seconds */
+#define MODIFIER_CACHE_MIN_TIME 0.01
+/* memory budget of the results cached for one object */
+#define MODIFIER_CACHE_MAX_MEMORY (256 * 1024 * 1024)
+
+typedef struct ModifierStackCache {
+	struct ModifierStackCache *next;
+	uint64_t hash;
+	int stack_index;
+	size_t memory;
+	DerivedMesh *dm;
+} ModifierStackCache;
+
+typedef struct ModifierCacheKey {
+	uint64_t hash;
+	bool valid;
+} ModifierCacheKey;
+
+static void modifier_cache_add(ModifierCacheKey *key, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	uint64_t h = key->hash;
+	size_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		uint64_t k;
+
+		memcpy(&k, p + i, 8);
+		k *= m;
+		k ^= k >> 47;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+	for (; i < len; i++) {
+		h ^= p[i];
+		h *= m;
+	}
+
+	key->hash = h;
+}
+
+static void modifier_cache_add_customdata(ModifierCacheKey *key, CustomData *data, int totelem)
+{
+	int i, j;
+
+	for (i = 0; i < data->totlayer; i++) {
+		CustomDataLayer *layer = &data->layers[i];
+
+		modifier_cache_add(key, &layer->type, sizeof(layer->type));
+		modifier_cache_add(key, layer->name, strlen(layer->name));
+
+		if (layer->type == CD_MDEFORMVERT) {
+			MDeformVert *dvert = layer->data;
+
+			for (j = 0; j < totelem; j++, dvert++) {
+				modifier_cache_add(key, &dvert->totweight, sizeof(dvert->totweight));
+				if (dvert->dw)
+					modifier_cache_add(key, dvert->dw, sizeof(*dvert->dw) * dvert->totweight);
+			}
+		}
+		else if (ELEM(layer->type, CD_MDISPS, CD_GRID_PAINT_MASK)) {
+			/* multires data, too large to compare */
+			key->valid = false;
+		}
+		else if (layer->data) {
+			modifier_cache_add(key, layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+		}
+	}
+}
+
+static void modifier_cache_add_id(void *userData, Object *UNUSED(ob), ID **idpoin)
+{
+	ModifierCacheKey *key = userData;
+	ID *id = *idpoin;
+
+	if (id == NULL)
+		return;
+
+	if (GS(id->name) == ID_OB) {
+		Object *lob = (Object *)id;
+
+		modifier_cache_add(key, &lob, sizeof(lob));
+		modifier_cache_add(key, lob->obmat, sizeof(lob->obmat));
+
+		if (lob->type == OB_MESH && lob->derivedFinal) {
+			/* evaluated before this object, as a dependency */
+			DerivedMesh *ldm = lob->derivedFinal;
+			int numVerts = ldm->getNumVerts(ldm);
+			float (*cos)[3] = MEM_mallocN(sizeof(*cos) * numVerts, "modifier cache cos");
+			int totelem[3] = {numVerts, ldm->getNumEdges(ldm), ldm->getNumPolys(ldm)};
+
+			ldm->getVertCos(ldm, cos);
+			modifier_cache_add(key, totelem, sizeof(totelem));
+			modifier_cache_add(key, cos, sizeof(*cos) * numVerts);
+			MEM_freeN(cos);
+		}
+		else if (lob->type != OB_EMPTY) {
+			/* changes to the data of other object types can't be detected */
+			key->valid = false;
+		}
+	}
+	else {
+		/* textures and other datablocks */
+		key->valid = false;
+	}
+}
+
+static void modifier_cache_add_object_link(void *userData, Object *ob, Object **obpoin)
+{
+	modifier_cache_add_id(userData, ob, (ID **)obpoin);
+}
+
+static bool modifier_cache_supported(ModifierData *md)
+{
+	ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+
+	if (mti->flags & eModifierTypeFlag_UsesPointCache)
+		return false;
+	if (mti->dependsOnTime && mti->dependsOnTime(md))
+		return false;
+
+	/* modifiers with run-time state or binding data */
+	if (ELEM6(md->type, eModifierType_ParticleSystem, eModifierType_ParticleInstance, eModifierType_Explode,
+	          eModifierType_MeshDeform, eModifierType_Multires, eModifierType_Surface))
+	{
+		return false;
+	}
+	if (ELEM3(md->type, eModifierType_Ocean, eModifierType_Fluidsim, eModifierType_Collision))
+		return false;
+
+	return true;
+}
+
+/* add the modifier to the key, after it the key identifies the stack result
+ * up to and including the modifier */
+static void modifier_cache_add_modifier(ModifierCacheKey *key, Object *ob, ModifierData *md,
+                                        CustomDataMask mask, CustomDataMask nextmask)
+{
+	ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+
+	if (!key->valid)
+		return;
+
+	if (!modifier_cache_supported(md) || (nextmask & (CD_MASK_ORCO | CD_MASK_CLOTH_ORCO))) {
+		key->valid = false;
+		return;
+	}
+
+	modifier_cache_add(key, &md, sizeof(md));
+	modifier_cache_add(key, &md->type, sizeof(md->type));
+	modifier_cache_add(key, &md->mode, sizeof(md->mode));
+	modifier_cache_add(key, &mask, sizeof(mask));
+	modifier_cache_add(key, &nextmask, sizeof(nextmask));
+
+	/* the settings, following the ModifierData header */
+	if (mti->structSize > sizeof(ModifierData))
+		modifier_cache_add(key, md + 1, mti->structSize - sizeof(ModifierData));
+
+	if (mti->foreachIDLink)
+		mti->foreachIDLink(md, ob, modifier_cache_add_id, key);
+	else if (mti->foreachObjectLink)
+		mti->foreachObjectLink(md, ob, modifier_cache_add_object_link, key);
+}
+
+static void modifier_cache_init_key(ModifierCacheKey *key, Scene *scene, Object *ob,
+                                    float (*deformedVerts)[3], int numVerts, CustomDataMask dataMask)
+{
+	Mesh *me = ob->data;
+
+	key->hash = 0;
+	key->valid = true;
+
+	modifier_cache_add(key, &me, sizeof(me));
+	modifier_cache_add(key, &dataMask, sizeof(dataMask));
+	modifier_cache_add(key, ob->obmat, sizeof(ob->obmat));
+	modifier_cache_add(key, &scene->r.mode, sizeof(scene->r.mode));
+	modifier_cache_add(key, &scene->r.simplify_subsurf, sizeof(scene->r.simplify_subsurf));
+
+	modifier_cache_add(key, &me->totvert, sizeof(me->totvert));
+	modifier_cache_add(key, &me->totedge, sizeof(me->totedge));
+	modifier_cache_add(key, &me->totloop, sizeof(me->totloop));
+	modifier_cache_add(key, &me->totpoly, sizeof(me->totpoly));
+	modifier_cache_add_customdata(key, &me->vdata, me->totvert);
+	modifier_cache_add_customdata(key, &me->edata, me->totedge);
+	modifier_cache_add_customdata(key, &me->ldata, me->totloop);
+	modifier_cache_add_customdata(key, &me->pdata, me->totpoly);
+
+	/* result of the leading deform modifiers and shape keys */
+	if (deformedVerts)
+		modifier_cache_add(key, deformedVerts, sizeof(*deformedVerts) * numVerts);
+}
+
+static ModifierStackCache *modifier_cache_find(Object *ob, int stack_index, uint64_t hash)
+{
+	ModifierStackCache *cache;
+
+	for (cache = ob->modifier_cache; cache; cache = cache->next) {
+		if (cache->stack_index == stack_index && cache->hash == hash)
+			return cache;
+	}
+
+	return NULL;
+}
+
+/* remove the results of the modifier and the ones after it */
+static void modifier_cache_clear_from(Object *ob, int stack_index)
+{
+	ModifierStackCache **cache_p = &ob->modifier_cache;
+
+	while (*cache_p) {
+		ModifierStackCache *cache = *cache_p;
+
+		if (cache->stack_index >= stack_index) {
+			*cache_p = cache->next;
+			cache->dm->needsFree = 1;
+			cache->dm->release(cache->dm);
+			MEM_freeN(cache);
+		}
+		else {
+			cache_p = &cache->next;
+		}
+	}
+}
+
+static void modifier_cache_store(Object *ob, int stack_index, uint64_t hash, DerivedMesh *dm)
+{
+	ModifierStackCache *cache, **cache_p;
+	size_t memory, used = 0;
+
+	modifier_cache_clear_from(ob, stack_index);
+
+	memory = (size_t)dm->getNumVerts(dm) * sizeof(MVert) +
+	         (size_t)dm->getNumEdges(dm) * sizeof(MEdge) +
+	         (size_t)dm->getNumLoops(dm) * sizeof(MLoop) +
+	         (size_t)dm->getNumPolys(dm) * sizeof(MPoly);
+
+	for (cache_p = &ob->modifier_cache; *cache_p; cache_p = &(*cache_p)->next)
+		used += (*cache_p)->memory;
+
+	if (used + memory > MODIFIER_CACHE_MAX_MEMORY)
+		return;
+
+	cache = MEM_callocN(sizeof(ModifierStackCache), "ModifierStackCache");
+	cache->hash = hash;
+	cache->stack_index = stack_index;
+	cache->memory = memory;
+	cache->dm = CDDM_copy(dm);
+	cache->dm->needsFree = 0;
+
+	*cache_p = cache;
+}
+
+/* the cache can only be used for the regular viewport evaluation of the stack */
+static bool modifier_cache_use(Object *ob, float (*inputVertexCos)[3], int useRenderParams, int useDeform,
+                               int needMapping, int index, int useCache, int build_shapekey_layers,
+                               int sculpt_mode, int do_preview)
+{
+	if (!useCache || useRenderParams || useDeform <= 0 || needMapping || index >= 0)
+		return false;
+	if (inputVertexCos || build_shapekey_layers || sculpt_mode || do_preview)
+		return false;
+
+	return (ob->mode == OB_MODE_OBJECT);
+}
+
+/* find the deepest cached result which is still valid for the remaining
+ * modifiers of the stack, walking them the same way mesh_calc_modifiers does */
+static ModifierStackCache *modifier_cache_lookup(const ModifierCacheKey *base_key, Scene *scene, Object *ob,
+                                                 ModifierData *md, CDMaskLink *curr, int stack_index,
+                                                 int required_mode, CustomDataMask dataMask)
+{
+	ModifierCacheKey key = *base_key;
+	ModifierStackCache *hit = NULL;
+	bool have_dm = false;
+
+	if (ob->modifier_cache == NULL)
+		return NULL;
+
+	for (; md && key.valid; md = md->next, curr = curr->next, stack_index++) {
+		ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+		CustomDataMask nextmask = (curr->next) ? curr->next->mask : dataMask;
+
+		if (!modifier_isEnabled(scene, md, required_mode)) continue;
+		if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) && have_dm) continue;
+
+		modifier_cache_add_modifier(&key, ob, md, curr->mask, nextmask);
+
+		if (mti->type != eModifierTypeType_OnlyDeform) {
+			ModifierStackCache *cache;
+
+			have_dm = true;
+			if (key.valid && (cache = modifier_cache_find(ob, stack_index, key.hash)))
+				hit = cache;
+		}
+	}
+
+	return hit;
+}
+
+void mesh_free_modifier_cache(Object *ob)
+{
+	modifier_cache_clear_from(ob, 0);
+}
+
+/* Apply deformed vertex coordinates to a DerivedMesh owned by the modifier
+ * stack, and return the CDDerivedMesh that replaces it. A CDDerivedMesh is
+ * changed in place instead of copied with all its layers: layers it still
+ * references from the Mesh are shared, and only the vertex layer gets
+ * duplicated when the coordinates are written. */
+static DerivedMesh *dm_apply_vert_coords_owned(DerivedMesh *dm, float (*deformedVerts)[3])
+{
+	if (!(dm->type == DM_TYPE_CDDM && dm->needsFree)) {
+		DerivedMesh *tdm = CDDM_copy(dm);
+		dm->release(dm);
+		dm = tdm;
+	}
+
+	CDDM_apply_vert_coords(dm, deformedVerts);
+
+	return dm;
+}
+
+static void modifier_timing_add(Object *ob, ModifierData *md, double start_time)
+{
+	BKE_update_timing_add(UPDATE_TIMING_MODIFIER, ob->id.name + 2, md->name, PIL_check_seconds_timer() - start_time);
+}
+
 /* new value for useDeform -1  (hack for the gameengine):
  * - apply only the modifier stack of the object, skipping the virtual modifiers,
  * - don't apply the key
@@ -1452,6 +1913,13 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 
 	VirtualModifierData virtualModifierData;
 
+	ModifierCacheKey cache_key;
+	ModifierStackCache *cache_hit = NULL;
+	int use_modifier_cache, stack_index = 0;
+
+	const bool do_timing = BKE_update_timing_enabled();
+	double mod_start_time = 0.0;
+
 	ModifierApplyFlag app_flags = useRenderParams ? MOD_APPLY_RENDER : 0;
 	ModifierApplyFlag deform_app_flags = app_flags;
 	if (useCache)
@@ -1505,7 +1973,7 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 			deformedVerts = inputVertexCos;
 		
 		/* Apply all leading deforming modifiers */
-		for (; md; md = md->next, curr = curr->next) {
+		for (; md; md = md->next, curr = curr->next, stack_index++) {
 			ModifierTypeInfo *mti = modifierType_getInfo(md->type);
 
 			md->scene = scene;
@@ -1514,10 +1982,16 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 			if (useDeform < 0 && mti->dependsOnTime && mti->dependsOnTime(md)) continue;
 
 			if (mti->type == eModifierTypeType_OnlyDeform && !sculpt_dyntopo) {
+				if (do_timing)
+					mod_start_time = PIL_check_seconds_timer();
+
 				if (!deformedVerts)
 					deformedVerts = BKE_mesh_vertexCos_get(me, &numVerts);
 
 				modwrap_deformVerts(md, ob, NULL, deformedVerts, numVerts, deform_app_flags);
+
+				if (do_timing)
+					modifier_timing_add(ob, md, mod_start_time);
 			}
 			else {
 				break;
@@ -1552,6 +2026,20 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 	}
 
 
+	/* Continue from the deepest cached stack result that is still valid,
+	 * results after it are outdated */
+	use_modifier_cache = modifier_cache_use(ob, inputVertexCos, useRenderParams, useDeform, needMapping,
+	                                        index, useCache, build_shapekey_layers, sculpt_mode,
+	                                        do_mod_wmcol || do_mod_mcol || do_init_wmcol);
+	if (use_modifier_cache) {
+		modifier_cache_init_key(&cache_key, scene, ob, deformedVerts, numVerts, dataMask);
+		cache_hit = modifier_cache_lookup(&cache_key, scene, ob, md, curr, stack_index, required_mode, dataMask);
+		modifier_cache_clear_from(ob, (cache_hit) ? cache_hit->stack_index + 1 : 0);
+	}
+	else if (ob->modifier_cache && !useRenderParams && useCache) {
+		mesh_free_modifier_cache(ob);
+	}
+
 	/* Now apply all remaining modifiers. If useDeform is off then skip
 	 * OnlyDeform ones. 
 	 */
@@ -1559,7 +2047,7 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 	orcodm = NULL;
 	clothorcodm = NULL;
 
-	for (; md; md = md->next, curr = curr->next) {
+	for (; md; md = md->next, curr = curr->next, stack_index++) {
 		ModifierTypeInfo *mti = modifierType_getInfo(md->type);
 
 		md->scene = scene;
@@ -1596,6 +2084,32 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 		if (needMapping && !modifier_supportsMapping(md)) continue;
 		if (useDeform < 0 && mti->dependsOnTime && mti->dependsOnTime(md)) continue;
 
+		if (use_modifier_cache) {
+			modifier_cache_add_modifier(&cache_key, ob, md, curr->mask, (curr->next) ? curr->next->mask : dataMask);
+			use_modifier_cache = cache_key.valid;
+		}
+
+		/* modifiers up to the cached result are skipped */
+		if (cache_hit) {
+			if (stack_index == cache_hit->stack_index) {
+				dm = CDDM_copy(cache_hit->dm);
+
+				if (deformedVerts) {
+					if (deformedVerts != inputVertexCos)
+						MEM_freeN(deformedVerts);
+
+					deformedVerts = NULL;
+				}
+
+				isPrevDeform = FALSE;
+				cache_hit = NULL;
+			}
+			continue;
+		}
+
+		if (do_timing)
+			mod_start_time = PIL_check_seconds_timer();
+
 		/* add an orco layer if needed by this modifier */
 		if (mti->requiredDataMask)
 			mask = mti->requiredDataMask(ob, md);
@@ -1641,6 +2155,7 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 		}
 		else {
 			DerivedMesh *ndm;
+			double start_time = PIL_check_seconds_timer();
 
 			/* determine which data layers are needed by following modifiers */
 			if (curr->next)
@@ -1651,11 +2166,7 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 			/* apply vertex coordinates or build a DerivedMesh as necessary */
 			if (dm) {
 				if (deformedVerts) {
-					DerivedMesh *tdm = CDDM_copy(dm);
-					dm->release(dm);
-					dm = tdm;
-
-					CDDM_apply_vert_coords(dm, deformedVerts);
+					dm = dm_apply_vert_coords_owned(dm, deformedVerts);
 				}
 			}
 			else {
@@ -1732,6 +2243,13 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 
 					deformedVerts = NULL;
 				}
+
+				/* keep the result of expensive modifiers */
+				if (use_modifier_cache && md->error == NULL &&
+				    PIL_check_seconds_timer() - start_time >= MODIFIER_CACHE_MIN_TIME)
+				{
+					modifier_cache_store(ob, stack_index, cache_key.hash, dm);
+				}
 			}
 
 			/* create an orco derivedmesh in parallel */
@@ -1785,6 +2303,9 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 
 		isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
 
+		if (do_timing)
+			modifier_timing_add(ob, md, mod_start_time);
+
 		/* grab modifiers until index i */
 		if ((index >= 0) && (BLI_findindex(&ob->modifiers, md) >= index))
 			break;
@@ -1801,11 +2322,7 @@ static void mesh_calc_modifiers(Scene *scene, Object *ob, float (*inputVertexCos
 	 * DerivedMesh then we need to build one.
 	 */
 	if (dm && deformedVerts) {
-		finaldm = CDDM_copy(dm);
-
-		dm->release(dm);
-
-		CDDM_apply_vert_coords(finaldm, deformedVerts);
+		finaldm = dm_apply_vert_coords_owned(dm, deformedVerts);
 
 #if 0 /* For later nice mod preview! */
 		/* In case we need modified weights in CD_PREVIEW_MCOL, we have to re-compute it. */
@@ -2051,11 +2568,14 @@ static void editbmesh_calc_modifiers(Scene *scene, Object *ob, BMEditMesh *em, D
 			/* apply vertex coordinates or build a DerivedMesh as necessary */
 			if (dm) {
 				if (deformedVerts) {
-					DerivedMesh *tdm = CDDM_copy(dm);
-					if (!(cage_r && dm == *cage_r)) dm->release(dm);
-					dm = tdm;
-
-					CDDM_apply_vert_coords(dm, deformedVerts);
+					if (cage_r && dm == *cage_r) {
+						/* the cage is kept, so work on a copy */
+						dm = CDDM_copy(dm);
+						CDDM_apply_vert_coords(dm, deformedVerts);
+					}
+					else {
+						dm = dm_apply_vert_coords_owned(dm, deformedVerts);
+					}
 				}
 				else if (cage_r && dm == *cage_r) {
 					/* dm may be changed by this modifier, so we need to copy it
@@ -2162,11 +2682,13 @@ static void editbmesh_calc_modifiers(Scene *scene, Object *ob, BMEditMesh *em, D
 	 * then we need to build one.
 	 */
 	if (dm && deformedVerts) {
-		*final_r = CDDM_copy(dm);
-
-		if (!(cage_r && dm == *cage_r)) dm->release(dm);
-
-		CDDM_apply_vert_coords(*final_r, deformedVerts);
+		if (cage_r && dm == *cage_r) {
+			*final_r = CDDM_copy(dm);
+			CDDM_apply_vert_coords(*final_r, deformedVerts);
+		}
+		else {
+			*final_r = dm_apply_vert_coords_owned(dm, deformedVerts);
+		}
 	}
 	else if (dm) {
 		*final_r = dm;
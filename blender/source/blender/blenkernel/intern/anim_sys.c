@@ -46,6 +46,8 @@
 
 #include "BLF_translation.h"
 
+#include "PIL_time.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_lamp_types.h"
 #include "DNA_material_types.h"
@@ -63,6 +65,7 @@
 #include "BKE_main.h"
 #include "BKE_library.h"
 #include "BKE_report.h"
+#include "BKE_update_timing.h"
 
 #include "RNA_access.h"
 
@@ -1278,117 +1281,138 @@ static short animsys_remap_path(AnimMapper *UNUSED(remap), char *path, char **ds
 /* less then 1.0 evaluates to false, use epsilon to avoid float error */
 #define ANIMSYS_FLOAT_AS_BOOL(value) ((value) > ((1.0f - FLT_EPSILON)))
 
-/* Write the given value to a setting using RNA, and return success */
-static short animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_index, float value)
+/* Property resolved for the last executed F-Curve
+ *  - F-Curves animating the elements of one array property are usually stored next to each
+ *    other (i.e. location[0..2]), so the path only needs to be resolved once for the whole run
+ *  - only valid while evaluating one list of F-Curves, since the data being pointed to may
+ *    get freed or reallocated in between evaluations
+ */
+typedef struct AnimsysPathCache {
+	const char *path;       /* path the property was resolved from (owned by the F-Curve) */
+	PointerRNA ptr;         /* struct the property belongs to */
+	PropertyRNA *prop;      /* property to write to */
+} AnimsysPathCache;
+
+/* Write the given value to an already resolved property, and return success */
+static short animsys_write_rna_property(PointerRNA *ptr, const char *path, PointerRNA *new_ptr_p, PropertyRNA *prop,
+                                        int array_index, float value)
 {
-	PropertyRNA *prop;
-	PointerRNA new_ptr;
+	PointerRNA new_ptr = *new_ptr_p;
 	
-	//printf("%p %s %i %f\n", ptr, path, array_index, value);
-	
-	/* get property to write to */
-	if (RNA_path_resolve_property(ptr, path, &new_ptr, &prop)) {
-		/* set value - only for animatable numerical values */
-		if (RNA_property_animateable(&new_ptr, prop)) {
-			int array_len = RNA_property_array_length(&new_ptr, prop);
-			int written = FALSE;
-			
-			if (array_len && array_index >= array_len) {
-				if (G.debug & G_DEBUG) {
-					printf("Animato: Invalid array index. ID = '%s',  '%s[%d]', array length is %d\n",
-					       (ptr && ptr->id.data) ? (((ID *)ptr->id.data)->name + 2) : "<No ID>",
-					       path, array_index, array_len - 1);
-				}
-				
-				return 0;
+	/* set value - only for animatable numerical values */
+	if (RNA_property_animateable(&new_ptr, prop)) {
+		int array_len = RNA_property_array_length(&new_ptr, prop);
+		int written = FALSE;
+		
+		if (array_len && array_index >= array_len) {
+			if (G.debug & G_DEBUG) {
+				printf("Animato: Invalid array index. ID = '%s',  '%s[%d]', array length is %d\n",
+				       (ptr && ptr->id.data) ? (((ID *)ptr->id.data)->name + 2) : "<No ID>",
+				       path, array_index, array_len - 1);
 			}
 			
-			switch (RNA_property_type(prop)) {
-				case PROP_BOOLEAN:
-					if (array_len) {
-						if (RNA_property_boolean_get_index(&new_ptr, prop, array_index) != ANIMSYS_FLOAT_AS_BOOL(value)) {
-							RNA_property_boolean_set_index(&new_ptr, prop, array_index, ANIMSYS_FLOAT_AS_BOOL(value));
-							written = TRUE;
-						}
-					}
-					else {
-						if (RNA_property_boolean_get(&new_ptr, prop) != ANIMSYS_FLOAT_AS_BOOL(value)) {
-							RNA_property_boolean_set(&new_ptr, prop, ANIMSYS_FLOAT_AS_BOOL(value));
-							written = TRUE;
-						}
+			return 0;
+		}
+		
+		switch (RNA_property_type(prop)) {
+			case PROP_BOOLEAN:
+				if (array_len) {
+					if (RNA_property_boolean_get_index(&new_ptr, prop, array_index) != ANIMSYS_FLOAT_AS_BOOL(value)) {
+						RNA_property_boolean_set_index(&new_ptr, prop, array_index, ANIMSYS_FLOAT_AS_BOOL(value));
+						written = TRUE;
 					}
-					break;
-				case PROP_INT:
-					if (array_len) {
-						if (RNA_property_int_get_index(&new_ptr, prop, array_index) != (int)value) {
-							RNA_property_int_set_index(&new_ptr, prop, array_index, (int)value);
-							written = TRUE;
-						}
+				}
+				else {
+					if (RNA_property_boolean_get(&new_ptr, prop) != ANIMSYS_FLOAT_AS_BOOL(value)) {
+						RNA_property_boolean_set(&new_ptr, prop, ANIMSYS_FLOAT_AS_BOOL(value));
+						written = TRUE;
 					}
-					else {
-						if (RNA_property_int_get(&new_ptr, prop) != (int)value) {
-							RNA_property_int_set(&new_ptr, prop, (int)value);
-							written = TRUE;
-						}
+				}
+				break;
+			case PROP_INT:
+				if (array_len) {
+					if (RNA_property_int_get_index(&new_ptr, prop, array_index) != (int)value) {
+						RNA_property_int_set_index(&new_ptr, prop, array_index, (int)value);
+						written = TRUE;
 					}
-					break;
-				case PROP_FLOAT:
-					if (array_len) {
-						if (RNA_property_float_get_index(&new_ptr, prop, array_index) != value) {
-							RNA_property_float_set_index(&new_ptr, prop, array_index, value);
-							written = TRUE;
-						}
+				}
+				else {
+					if (RNA_property_int_get(&new_ptr, prop) != (int)value) {
+						RNA_property_int_set(&new_ptr, prop, (int)value);
+						written = TRUE;
 					}
-					else {
-						if (RNA_property_float_get(&new_ptr, prop) != value) {
-							RNA_property_float_set(&new_ptr, prop, value);
-							written = TRUE;
-						}
+				}
+				break;
+			case PROP_FLOAT:
+				if (array_len) {
+					if (RNA_property_float_get_index(&new_ptr, prop, array_index) != value) {
+						RNA_property_float_set_index(&new_ptr, prop, array_index, value);
+						written = TRUE;
 					}
-					break;
-				case PROP_ENUM:
-					if (RNA_property_enum_get(&new_ptr, prop) != (int)value) {
-						RNA_property_enum_set(&new_ptr, prop, (int)value);
+				}
+				else {
+					if (RNA_property_float_get(&new_ptr, prop) != value) {
+						RNA_property_float_set(&new_ptr, prop, value);
 						written = TRUE;
 					}
-					break;
-				default:
-					/* nothing can be done here... so it is unsuccessful? */
-					return 0;
-			}
-			
-			/* RNA property update disabled for now - [#28525] [#28690] [#28774] [#28777] */
-#if 0
-			/* buffer property update for later flushing */
-			if (written && RNA_property_update_check(prop)) {
-				short skip_updates_hack = 0;
-				
-				/* optimization hacks: skip property updates for those properties
-				 * for we know that which the updates in RNA were really just for
-				 * flushing property editing via UI/Py
-				 */
-				if (new_ptr.type == &RNA_PoseBone) {
-					/* bone transforms - update pose (i.e. tag depsgraph) */
-					skip_updates_hack = 1;
 				}
-				
-				if (skip_updates_hack == 0)
-					RNA_property_update_cache_add(&new_ptr, prop);
+				break;
+			case PROP_ENUM:
+				if (RNA_property_enum_get(&new_ptr, prop) != (int)value) {
+					RNA_property_enum_set(&new_ptr, prop, (int)value);
+					written = TRUE;
+				}
+				break;
+			default:
+				/* nothing can be done here... so it is unsuccessful? */
+				return 0;
+		}
+		
+		/* RNA property update disabled for now - [#28525] [#28690] [#28774] [#28777] */
+#if 0
+		/* buffer property update for later flushing */
+		if (written && RNA_property_update_check(prop)) {
+			short skip_updates_hack = 0;
+			
+			/* optimization hacks: skip property updates for those properties
+			 * for we know that which the updates in RNA were really just for
+			 * flushing property editing via UI/Py
+			 */
+			if (new_ptr.type == &RNA_PoseBone) {
+				/* bone transforms - update pose (i.e. tag depsgraph) */
+				skip_updates_hack = 1;
 			}
+			
+			if (skip_updates_hack == 0)
+				RNA_property_update_cache_add(&new_ptr, prop);
+		}
 #endif
 
-			/* as long as we don't do property update, we still tag datablock
-			 * as having been updated. this flag does not cause any updates to
-			 * be run, it's for e.g. render engines to synchronize data */
-			if (written && new_ptr.id.data) {
-				ID *id = new_ptr.id.data;
-				id->flag |= LIB_ID_RECALC;
-				DAG_id_type_tag(G.main, GS(id->name));
-			}
+		/* as long as we don't do property update, we still tag datablock
+		 * as having been updated. this flag does not cause any updates to
+		 * be run, it's for e.g. render engines to synchronize data */
+		if (written && new_ptr.id.data) {
+			ID *id = new_ptr.id.data;
+			id->flag |= LIB_ID_RECALC;
+			DAG_id_type_tag(G.main, GS(id->name));
 		}
-		
-		/* successful */
-		return 1;
+	}
+	
+	/* successful */
+	return 1;
+}
+
+/* Write the given value to a setting using RNA, and return success */
+static short animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_index, float value)
+{
+	PropertyRNA *prop;
+	PointerRNA new_ptr;
+	
+	//printf("%p %s %i %f\n", ptr, path, array_index, value);
+	
+	/* get property to write to */
+	if (RNA_path_resolve_property(ptr, path, &new_ptr, &prop)) {
+		return animsys_write_rna_property(ptr, path, &new_ptr, prop, array_index, value);
 	}
 	else {
 		/* failed to get path */
@@ -1403,8 +1427,10 @@ static short animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_in
 	}
 }
 
-/* Simple replacement based data-setting of the FCurve using RNA */
-static short animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *fcu)
+/* Simple replacement based data-setting of the FCurve using RNA
+ *  - cache: optional, reuses the property resolved for the previous F-Curve when the paths match
+ */
+static short animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *fcu, AnimsysPathCache *cache)
 {
 	char *path = NULL;
 	short free_path = 0;
@@ -1414,8 +1440,25 @@ static short animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *
 	free_path = animsys_remap_path(remap, fcu->rna_path, &path);
 	
 	/* write value to setting */
-	if (path)
-		ok = animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
+	if (path) {
+		if (cache && !free_path) {
+			if ((cache->path == NULL) || !STREQ(cache->path, path)) {
+				/* resolve once for this run of F-Curves */
+				if (RNA_path_resolve_property(ptr, path, &cache->ptr, &cache->prop))
+					cache->path = path;
+				else
+					cache->path = NULL;
+			}
+			
+			if (cache->path)
+				ok = animsys_write_rna_property(ptr, path, &cache->ptr, cache->prop, fcu->array_index, fcu->curval);
+			else
+				ok = animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
+		}
+		else {
+			ok = animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
+		}
+	}
 	
 	/* free temp path-info */
 	if (free_path)
@@ -1430,6 +1473,7 @@ static short animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *
  */
 static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper *remap, float ctime)
 {
+	AnimsysPathCache cache = {NULL};
 	FCurve *fcu;
 	
 	/* calculate then execute each curve */
@@ -1439,7 +1483,7 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper
 			/* check if this curve should be skipped */
 			if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
 				calculate_fcurve(fcu, ctime);
-				animsys_execute_fcurve(ptr, remap, fcu); 
+				animsys_execute_fcurve(ptr, remap, fcu, &cache); 
 			}
 		}
 	}
@@ -1451,7 +1495,9 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper
 /* Evaluate Drivers */
 static void animsys_evaluate_drivers(PointerRNA *ptr, AnimData *adt, float ctime)
 {
+	AnimsysPathCache cache = {NULL};
 	FCurve *fcu;
+	const bool do_timing = BKE_update_timing_enabled();
 	
 	/* drivers are stored as F-Curves, but we cannot use the standard code, as we need to check if
 	 * the depsgraph requested that this driver be evaluated...
@@ -1465,11 +1511,18 @@ static void animsys_evaluate_drivers(PointerRNA *ptr, AnimData *adt, float ctime
 			/* check if driver itself is tagged for recalculation */
 			/* XXX driver recalc flag is not set yet by depsgraph! */
 			if ((driver) && !(driver->flag & DRIVER_FLAG_INVALID) /*&& (driver->flag & DRIVER_FLAG_RECALC)*/) {
+				double start_time = do_timing ? PIL_check_seconds_timer() : 0.0;
+
 				/* evaluate this using values set already in other places
 				 * NOTE: for 'layering' option later on, we should check if we should remove old value before adding
 				 *       new to only be done when drivers only changed */
 				calculate_fcurve(fcu, ctime);
-				ok = animsys_execute_fcurve(ptr, NULL, fcu);
+				
+				/* scripted expressions can change anything, so don't trust a previously resolved path */
+				if (driver->type == DRIVER_TYPE_PYTHON)
+					cache.path = NULL;
+				
+				ok = animsys_execute_fcurve(ptr, NULL, fcu, &cache);
 				
 				/* clear recalc flag */
 				driver->flag &= ~DRIVER_FLAG_RECALC;
@@ -1477,6 +1530,15 @@ static void animsys_evaluate_drivers(PointerRNA *ptr, AnimData *adt, float ctime
 				/* set error-flag if evaluation failed */
 				if (ok == 0)
 					driver->flag |= DRIVER_FLAG_INVALID; 
+
+				if (do_timing) {
+					char name[sizeof(((UpdateTimingEntry *)NULL)->name)];
+					ID *id = ptr->id.data;
+
+					BLI_snprintf(name, sizeof(name), "%s[%d]", fcu->rna_path ? fcu->rna_path : "", fcu->array_index);
+					BKE_update_timing_add(UPDATE_TIMING_DRIVER, id ? id->name + 2 : NULL, name,
+					                      PIL_check_seconds_timer() - start_time);
+				}
 			}
 		}
 	}
@@ -1521,6 +1583,7 @@ static void action_idcode_patch_check(ID *id, bAction *act)
 /* Evaluate Action Group */
 void animsys_evaluate_action_group(PointerRNA *ptr, bAction *act, bActionGroup *agrp, AnimMapper *remap, float ctime)
 {
+	AnimsysPathCache cache = {NULL};
 	FCurve *fcu;
 	
 	/* check if mapper is appropriate for use here (we set to NULL if it's inappropriate) */
@@ -1538,7 +1601,7 @@ void animsys_evaluate_action_group(PointerRNA *ptr, bAction *act, bActionGroup *
 		/* check if this curve should be skipped */
 		if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
 			calculate_fcurve(fcu, ctime);
-			animsys_execute_fcurve(ptr, remap, fcu); 
+			animsys_execute_fcurve(ptr, remap, fcu, &cache); 
 		}
 	}
 }
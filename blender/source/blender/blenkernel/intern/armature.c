@@ -35,11 +35,16 @@
 #include <stdio.h>
 #include <float.h>
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
 #include "BLI_utildefines.h"
+#include "BLI_task.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_armature_types.h"
@@ -776,6 +781,27 @@ static float dist_bone_deform(bPoseChannel *pchan, bPoseChanDeform *pdef_info, f
 	return contrib;
 }
 
+#ifdef __SSE__
+/* vec += (mat * co - co) * weight, done for every bone influence of every
+ * vertex, same order of operations as mul_m4_v3 */
+static void pchan_deform_accum_sse(float vec[3], float mat[4][4], const float co[3], const float weight)
+{
+	__m128 cop = _mm_mul_ps(_mm_loadu_ps(mat[0]), _mm_set1_ps(co[0]));
+	float delta[4];
+
+	cop = _mm_add_ps(cop, _mm_mul_ps(_mm_loadu_ps(mat[1]), _mm_set1_ps(co[1])));
+	cop = _mm_add_ps(cop, _mm_mul_ps(_mm_loadu_ps(mat[2]), _mm_set1_ps(co[2])));
+	cop = _mm_add_ps(cop, _mm_loadu_ps(mat[3]));
+
+	cop = _mm_sub_ps(cop, _mm_set_ps(0.0f, co[2], co[1], co[0]));
+	_mm_storeu_ps(delta, _mm_mul_ps(cop, _mm_set1_ps(weight)));
+
+	vec[0] += delta[0];
+	vec[1] += delta[1];
+	vec[2] += delta[2];
+}
+#endif
+
 static void pchan_bone_deform(bPoseChannel *pchan, bPoseChanDeform *pdef_info, float weight, float vec[3], DualQuat *dq,
                               float mat[3][3], const float co[3], float *contrib)
 {
@@ -788,15 +814,25 @@ static void pchan_bone_deform(bPoseChannel *pchan, bPoseChanDeform *pdef_info, f
 	copy_v3_v3(cop, co);
 
 	if (vec) {
-		if (pchan->bone->segments > 1)
+		if (pchan->bone->segments > 1) {
 			/* applies on cop and bbonemat */
 			b_bone_deform(pdef_info, pchan->bone, cop, NULL, (mat) ? bbonemat : NULL);
-		else
+
+			vec[0] += (cop[0] - co[0]) * weight;
+			vec[1] += (cop[1] - co[1]) * weight;
+			vec[2] += (cop[2] - co[2]) * weight;
+		}
+		else {
+#ifdef __SSE__
+			pchan_deform_accum_sse(vec, pchan->chan_mat, co, weight);
+#else
 			mul_m4_v3(pchan->chan_mat, cop);
 
-		vec[0] += (cop[0] - co[0]) * weight;
-		vec[1] += (cop[1] - co[1]) * weight;
-		vec[2] += (cop[2] - co[2]) * weight;
+			vec[0] += (cop[0] - co[0]) * weight;
+			vec[1] += (cop[1] - co[1]) * weight;
+			vec[2] += (cop[2] - co[2]) * weight;
+#endif
+		}
 
 		if (mat)
 			pchan_deform_mat_add(pchan, weight, bbonemat, mat);
@@ -813,111 +849,47 @@ static void pchan_bone_deform(bPoseChannel *pchan, bPoseChanDeform *pdef_info, f
 	(*contrib) += weight;
 }
 
-void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float (*vertexCos)[3],
-                           float (*defMats)[3][3], int numVerts, int deformflag,
-                           float (*prevCos)[3], const char *defgrp_name)
-{
+typedef struct ArmatureDeformData {
+	Object *armOb;
+	DerivedMesh *dm;
+	float (*vertexCos)[3];
+	float (*defMats)[3][3];
+	float (*prevCos)[3];
+	MDeformVert *dverts;
+	MDeformVert *dm_dverts;
 	bPoseChanDeform *pdef_info_array;
-	bPoseChanDeform *pdef_info = NULL;
-	bArmature *arm = armOb->data;
-	bPoseChannel *pchan, **defnrToPC = NULL;
-	int *defnrToPCIndex = NULL;
-	MDeformVert *dverts = NULL;
-	bDeformGroup *dg;
-	DualQuat *dualquats = NULL;
-	float obinv[4][4], premat[4][4], postmat[4][4];
-	const short use_envelope = deformflag & ARM_DEF_ENVELOPE;
-	const short use_quaternion = deformflag & ARM_DEF_QUATERNION;
-	const short invert_vgroup = deformflag & ARM_DEF_INVERT_VGROUP;
-	int defbase_tot = 0;       /* safety for vertexgroup index overflow */
-	int i, target_totvert = 0; /* safety for vertexgroup overflow */
-	int use_dverts = FALSE;
-	int armature_def_nr;
-	int totchan;
-
-	if (arm->edbo) return;
-
-	invert_m4_m4(obinv, target->obmat);
-	copy_m4_m4(premat, target->obmat);
-	mul_m4_m4m4(postmat, obinv, armOb->obmat);
-	invert_m4_m4(premat, postmat);
-
-	/* bone defmats are already in the channels, chan_mat */
-
-	/* initialize B_bone matrices and dual quaternions */
-	totchan = BLI_countlist(&armOb->pose->chanbase);
-
-	if (use_quaternion) {
-		dualquats = MEM_callocN(sizeof(DualQuat) * totchan, "dualquats");
-	}
-
-	pdef_info_array = MEM_callocN(sizeof(bPoseChanDeform) * totchan, "bPoseChanDeform");
-
-	totchan = 0;
-	pdef_info = pdef_info_array;
-	for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
-		if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-			if (pchan->bone->segments > 1)
-				pchan_b_bone_defmats(pchan, pdef_info, use_quaternion);
-
-			if (use_quaternion) {
-				pdef_info->dual_quat = &dualquats[totchan++];
-				mat4_to_dquat(pdef_info->dual_quat, pchan->bone->arm_mat, pchan->chan_mat);
-			}
-		}
-	}
-
-	/* get the def_nr for the overall armature vertex group if present */
-	armature_def_nr = defgroup_name_index(target, defgrp_name);
-
-	if (ELEM(target->type, OB_MESH, OB_LATTICE)) {
-		defbase_tot = BLI_countlist(&target->defbase);
-
-		if (target->type == OB_MESH) {
-			Mesh *me = target->data;
-			dverts = me->dvert;
-			if (dverts)
-				target_totvert = me->totvert;
-		}
-		else {
-			Lattice *lt = target->data;
-			dverts = lt->dvert;
-			if (dverts)
-				target_totvert = lt->pntsu * lt->pntsv * lt->pntsw;
-		}
-	}
-
-	/* get a vertex-deform-index to posechannel array */
-	if (deformflag & ARM_DEF_VGROUP) {
-		if (ELEM(target->type, OB_MESH, OB_LATTICE)) {
-			/* if we have a DerivedMesh, only use dverts if it has them */
-			if (dm) {
-				use_dverts = (dm->getVertData(dm, 0, CD_MDEFORMVERT) != NULL);
-			}
-			else if (dverts) {
-				use_dverts = TRUE;
-			}
-
-			if (use_dverts) {
-				defnrToPC = MEM_callocN(sizeof(*defnrToPC) * defbase_tot, "defnrToBone");
-				defnrToPCIndex = MEM_callocN(sizeof(*defnrToPCIndex) * defbase_tot, "defnrToIndex");
-				for (i = 0, dg = target->defbase.first; dg; i++, dg = dg->next) {
-					defnrToPC[i] = BKE_pose_channel_find_name(armOb->pose, dg->name);
-					/* exclude non-deforming bones */
-					if (defnrToPC[i]) {
-						if (defnrToPC[i]->bone->flag & BONE_NO_DEFORM) {
-							defnrToPC[i] = NULL;
-						}
-						else {
-							defnrToPCIndex[i] = BLI_findindex(&armOb->pose->chanbase, defnrToPC[i]);
-						}
-					}
-				}
-			}
-		}
-	}
-
-	for (i = 0; i < numVerts; i++) {
+	bPoseChannel **defnrToPC;
+	int *defnrToPCIndex;
+	float premat[4][4], postmat[4][4];
+	int defbase_tot, target_totvert, armature_def_nr;
+	short use_envelope, use_quaternion, invert_vgroup;
+	int use_dverts;
+} ArmatureDeformData;
+
+static void armature_deform_verts_range(void *userdata, int start, int stop)
+{
+	ArmatureDeformData *data = userdata;
+	Object *armOb = data->armOb;
+	DerivedMesh *dm = data->dm;
+	float (*vertexCos)[3] = data->vertexCos;
+	float (*defMats)[3][3] = data->defMats;
+	float (*prevCos)[3] = data->prevCos;
+	MDeformVert *dverts = data->dverts;
+	MDeformVert *dm_dverts = data->dm_dverts;
+	bPoseChanDeform *pdef_info_array = data->pdef_info_array;
+	bPoseChanDeform *pdef_info;
+	bPoseChannel *pchan, **defnrToPC = data->defnrToPC;
+	int *defnrToPCIndex = data->defnrToPCIndex;
+	float (*premat)[4] = data->premat, (*postmat)[4] = data->postmat;
+	const int defbase_tot = data->defbase_tot, target_totvert = data->target_totvert;
+	const int armature_def_nr = data->armature_def_nr;
+	const short use_envelope = data->use_envelope;
+	const short use_quaternion = data->use_quaternion;
+	const short invert_vgroup = data->invert_vgroup;
+	const int use_dverts = data->use_dverts;
+	int i;
+
+	for (i = start; i < stop; i++) {
 		MDeformVert *dvert;
 		DualQuat sumdq, *dq = NULL;
 		float *co, dco[3];
@@ -943,7 +915,7 @@ void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float
 
 		if (use_dverts || armature_def_nr != -1) {
 			if (dm)
-				dvert = dm->getVertData(dm, i, CD_MDEFORMVERT);
+				dvert = dm_dverts ? dm_dverts + i : NULL;
 			else if (dverts && i < target_totvert)
 				dvert = dverts + i;
 			else
@@ -1062,6 +1034,140 @@ void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float
 		}
 	}
 
+}
+
+void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float (*vertexCos)[3],
+                           float (*defMats)[3][3], int numVerts, int deformflag,
+                           float (*prevCos)[3], const char *defgrp_name)
+{
+	bPoseChanDeform *pdef_info_array;
+	bPoseChanDeform *pdef_info = NULL;
+	bArmature *arm = armOb->data;
+	bPoseChannel *pchan, **defnrToPC = NULL;
+	int *defnrToPCIndex = NULL;
+	MDeformVert *dverts = NULL, *dm_dverts = NULL;
+	bDeformGroup *dg;
+	DualQuat *dualquats = NULL;
+	float obinv[4][4], premat[4][4], postmat[4][4];
+	const short use_envelope = deformflag & ARM_DEF_ENVELOPE;
+	const short use_quaternion = deformflag & ARM_DEF_QUATERNION;
+	const short invert_vgroup = deformflag & ARM_DEF_INVERT_VGROUP;
+	int defbase_tot = 0;       /* safety for vertexgroup index overflow */
+	int i, target_totvert = 0; /* safety for vertexgroup overflow */
+	int use_dverts = FALSE;
+	int armature_def_nr;
+	int totchan;
+	ArmatureDeformData data;
+
+	if (arm->edbo) return;
+
+	invert_m4_m4(obinv, target->obmat);
+	copy_m4_m4(premat, target->obmat);
+	mul_m4_m4m4(postmat, obinv, armOb->obmat);
+	invert_m4_m4(premat, postmat);
+
+	/* bone defmats are already in the channels, chan_mat */
+
+	/* initialize B_bone matrices and dual quaternions */
+	totchan = BLI_countlist(&armOb->pose->chanbase);
+
+	if (use_quaternion) {
+		dualquats = MEM_callocN(sizeof(DualQuat) * totchan, "dualquats");
+	}
+
+	pdef_info_array = MEM_callocN(sizeof(bPoseChanDeform) * totchan, "bPoseChanDeform");
+
+	totchan = 0;
+	pdef_info = pdef_info_array;
+	for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
+		if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
+			if (pchan->bone->segments > 1)
+				pchan_b_bone_defmats(pchan, pdef_info, use_quaternion);
+
+			if (use_quaternion) {
+				pdef_info->dual_quat = &dualquats[totchan++];
+				mat4_to_dquat(pdef_info->dual_quat, pchan->bone->arm_mat, pchan->chan_mat);
+			}
+		}
+	}
+
+	/* get the def_nr for the overall armature vertex group if present */
+	armature_def_nr = defgroup_name_index(target, defgrp_name);
+
+	if (ELEM(target->type, OB_MESH, OB_LATTICE)) {
+		defbase_tot = BLI_countlist(&target->defbase);
+
+		if (target->type == OB_MESH) {
+			Mesh *me = target->data;
+			dverts = me->dvert;
+			if (dverts)
+				target_totvert = me->totvert;
+		}
+		else {
+			Lattice *lt = target->data;
+			dverts = lt->dvert;
+			if (dverts)
+				target_totvert = lt->pntsu * lt->pntsv * lt->pntsw;
+		}
+	}
+
+	/* look the layer up once, rather than per vertex */
+	if (dm)
+		dm_dverts = dm->getVertDataArray(dm, CD_MDEFORMVERT);
+
+	/* get a vertex-deform-index to posechannel array */
+	if (deformflag & ARM_DEF_VGROUP) {
+		if (ELEM(target->type, OB_MESH, OB_LATTICE)) {
+			/* if we have a DerivedMesh, only use dverts if it has them */
+			if (dm) {
+				use_dverts = (dm_dverts != NULL);
+			}
+			else if (dverts) {
+				use_dverts = TRUE;
+			}
+
+			if (use_dverts) {
+				defnrToPC = MEM_callocN(sizeof(*defnrToPC) * defbase_tot, "defnrToBone");
+				defnrToPCIndex = MEM_callocN(sizeof(*defnrToPCIndex) * defbase_tot, "defnrToIndex");
+				for (i = 0, dg = target->defbase.first; dg; i++, dg = dg->next) {
+					defnrToPC[i] = BKE_pose_channel_find_name(armOb->pose, dg->name);
+					/* exclude non-deforming bones */
+					if (defnrToPC[i]) {
+						if (defnrToPC[i]->bone->flag & BONE_NO_DEFORM) {
+							defnrToPC[i] = NULL;
+						}
+						else {
+							defnrToPCIndex[i] = BLI_findindex(&armOb->pose->chanbase, defnrToPC[i]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	data.armOb = armOb;
+	data.dm = dm;
+	data.vertexCos = vertexCos;
+	data.defMats = defMats;
+	data.prevCos = prevCos;
+	data.dverts = dverts;
+	data.dm_dverts = dm_dverts;
+	data.pdef_info_array = pdef_info_array;
+	data.defnrToPC = defnrToPC;
+	data.defnrToPCIndex = defnrToPCIndex;
+	copy_m4_m4(data.premat, premat);
+	copy_m4_m4(data.postmat, postmat);
+	data.defbase_tot = defbase_tot;
+	data.target_totvert = target_totvert;
+	data.armature_def_nr = armature_def_nr;
+	data.use_envelope = use_envelope;
+	data.use_quaternion = use_quaternion;
+	data.invert_vgroup = invert_vgroup;
+	data.use_dverts = use_dverts;
+
+	/* vertices are deformed independently */
+	BLI_task_parallel_range(0, numVerts, &data, armature_deform_verts_range);
+
 	if (dualquats)
 		MEM_freeN(dualquats);
 	if (defnrToPC)
@@ -82,6 +82,8 @@
 #include "BKE_screen.h"
 #include "BKE_sequencer.h"
 #include "BKE_sound.h"
+#include "BKE_update_timing.h"
+#include "BKE_DerivedMesh.h"
 
 #include "RE_pipeline.h"
 
@@ -112,6 +114,8 @@ char versionstr[48] = "";
 /* only to be called on exit blender */
 void free_blender(void)
 {
+	BKE_sequencer_prefetch_free();
+
 	/* samples are in a global list..., also sets G.main->sound->sample NULL */
 	free_main(G.main);
 	G.main = NULL;
@@ -127,6 +131,9 @@ void free_blender(void)
 
 	BKE_sequencer_cache_destruct();
 	IMB_moviecache_destruct();
+
+	BKE_update_timing_free();
+	DM_lod_proxy_exit();
 	
 	free_nodesystem();
 }
@@ -848,6 +855,30 @@ int BKE_undo_save_file(const char *filename)
 	return 1;
 }
 
+/* copy the last undo step, so it can be written to disk while the undo stack changes */
+int BKE_undo_memfile_copy(MemFile *memfile)
+{
+	MemFileChunk *chunk;
+
+	if ((U.uiflag & USER_GLOBALUNDO) == 0 || curundo == NULL) {
+		return 0;
+	}
+
+	for (chunk = curundo->memfile.chunks.first; chunk; chunk = chunk->next) {
+		MemFileChunk *chunk_copy = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
+
+		chunk_copy->buf = MEM_mallocN(chunk->size, "MemFileChunk buf");
+		memcpy(chunk_copy->buf, chunk->buf, chunk->size);
+		chunk_copy->size = chunk->size;
+		chunk_copy->ident = 0;
+
+		BLI_addtail(&memfile->chunks, chunk_copy);
+		memfile->size += chunk->size;
+	}
+
+	return 1;
+}
+
 /* sets curscene */
 Main *BKE_undo_get_main(Scene **scene)
 {
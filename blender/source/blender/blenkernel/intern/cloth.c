@@ -50,6 +50,10 @@
 
 // #include "PIL_time.h"  /* timing for debug prints */
 
+#ifdef _OPENMP
+#  define CLOTH_OPENMP_LIMIT 512
+#endif
+
 /* Our available solvers. */
 // 255 is the magic reserved number, so NEVER try to put 255 solvers in here!
 // 254 = MAX!
@@ -221,22 +225,23 @@ static BVHTree *bvhtree_build_from_cloth (ClothModifierData *clmd, float epsilon
 
 void bvhtree_update_from_cloth(ClothModifierData *clmd, int moving)
 {	
-	unsigned int i = 0;
+	int i = 0;
 	Cloth *cloth = clmd->clothObject;
 	BVHTree *bvhtree = cloth->bvhtree;
 	ClothVertex *verts = cloth->verts;
-	MFace *mfaces;
-	float co[12], co_moving[12];
-	int ret = 0;
+	int numfaces = cloth->numfaces;
 	
 	if (!bvhtree)
 		return;
 	
-	mfaces = cloth->mfaces;
-	
 	// update vertex position in bvh tree
-	if (verts && mfaces) {
-		for (i = 0; i < cloth->numfaces; i++, mfaces++) {
+	if (verts && cloth->mfaces) {
+		/* leaves only touch their own bounds, the branches are joined after */
+#pragma omp parallel for private(i) schedule(static) if (numfaces > CLOTH_OPENMP_LIMIT)
+		for (i = 0; i < numfaces; i++) {
+			MFace *mfaces = &cloth->mfaces[i];
+			float co[12], co_moving[12];
+
 			copy_v3_v3(&co[0*3], verts[mfaces->v1].txold);
 			copy_v3_v3(&co[1*3], verts[mfaces->v2].txold);
 			copy_v3_v3(&co[2*3], verts[mfaces->v3].txold);
@@ -254,15 +259,11 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, int moving)
 				if (mfaces->v4)
 					copy_v3_v3(&co_moving[3*3], verts[mfaces->v4].tx);
 				
-				ret = BLI_bvhtree_update_node(bvhtree, i, co, co_moving, (mfaces->v4 ? 4 : 3));
+				BLI_bvhtree_update_node(bvhtree, i, co, co_moving, (mfaces->v4 ? 4 : 3));
 			}
 			else {
-				ret = BLI_bvhtree_update_node(bvhtree, i, co, NULL, (mfaces->v4 ? 4 : 3));
+				BLI_bvhtree_update_node(bvhtree, i, co, NULL, (mfaces->v4 ? 4 : 3));
 			}
-			
-			// check if tree is already full
-			if (!ret)
-				break;
 		}
 		
 		BLI_bvhtree_update_tree(bvhtree);
@@ -271,38 +272,27 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, int moving)
 
 void bvhselftree_update_from_cloth(ClothModifierData *clmd, int moving)
 {	
-	unsigned int i = 0;
+	int i = 0;
 	Cloth *cloth = clmd->clothObject;
 	BVHTree *bvhtree = cloth->bvhselftree;
 	ClothVertex *verts = cloth->verts;
-	MFace *mfaces;
-	float co[12], co_moving[12];
-	int ret = 0;
+	int numverts = cloth->numverts;
 	
 	if (!bvhtree)
 		return;
 	
-	mfaces = cloth->mfaces;
-
 	// update vertex position in bvh tree
-	if (verts && mfaces) {
-		for (i = 0; i < cloth->numverts; i++, verts++) {
-			copy_v3_v3(&co[0*3], verts->txold);
-
+	if (verts && cloth->mfaces) {
+#pragma omp parallel for private(i) schedule(static) if (numverts > CLOTH_OPENMP_LIMIT)
+		for (i = 0; i < numverts; i++) {
 			// copy new locations into array
 			if (moving) {
 				// update moving positions
-				copy_v3_v3(&co_moving[0*3], verts->tx);
-
-				ret = BLI_bvhtree_update_node(bvhtree, i, co, co_moving, 1);
+				BLI_bvhtree_update_node(bvhtree, i, verts[i].txold, verts[i].tx, 1);
 			}
 			else {
-				ret = BLI_bvhtree_update_node(bvhtree, i, co, NULL, 1);
+				BLI_bvhtree_update_node(bvhtree, i, verts[i].txold, NULL, 1);
 			}
-
-			// check if tree is already full
-			if (!ret)
-				break;
 		}
 		
 		BLI_bvhtree_update_tree(bvhtree);
@@ -723,8 +713,9 @@ static void cloth_to_object (Object *ob,  ClothModifierData *clmd, float (*verte
 
 		for (i = 0; i < cloth->numverts; i++) {
 			copy_v3_v3 (vertexCos[i], cloth->verts[i].x);
-			mul_m4_v3(ob->imat, vertexCos[i]);	/* cloth is in global coords */
 		}
+
+		mul_m4_v3_array(ob->imat, vertexCos, cloth->numverts);	/* cloth is in global coords */
 	}
 }
 
@@ -68,6 +68,11 @@
 #include "eltopo-capi.h"
 #endif
 
+#ifdef _OPENMP
+/* below this many faces/pairs threading costs more than it saves */
+#  define COLLISION_OPENMP_LIMIT 256
+#endif
+
 
 /***********************************
 Collision modifier code start
@@ -77,15 +82,28 @@ Collision modifier code start
 void collision_move_object(CollisionModifierData *collmd, float step, float prevstep)
 {
 	float tv[3] = {0, 0, 0};
+	float co[3], co_new[3];
 	unsigned int i = 0;
+	int moved = 0;
 
 	for ( i = 0; i < collmd->numverts; i++ ) {
 		sub_v3_v3v3(tv, collmd->xnew[i].co, collmd->x[i].co);
-		VECADDS(collmd->current_x[i].co, collmd->x[i].co, tv, prevstep);
-		VECADDS(collmd->current_xnew[i].co, collmd->x[i].co, tv, step);
+		VECADDS(co, collmd->x[i].co, tv, prevstep);
+		VECADDS(co_new, collmd->x[i].co, tv, step);
+
+		if (!moved && (!equals_v3v3(co, collmd->current_x[i].co) || !equals_v3v3(co_new, collmd->current_xnew[i].co)))
+			moved = 1;
+
+		copy_v3_v3(collmd->current_x[i].co, co);
+		copy_v3_v3(collmd->current_xnew[i].co, co_new);
 		sub_v3_v3v3(collmd->current_v[i].co, collmd->current_xnew[i].co, collmd->current_x[i].co);
 	}
 
+	/* the tree was last fitted to these positions already (static colliders,
+	 * or several cloth steps within one collider frame), nothing to refit */
+	if (!moved)
+		return;
+
 	bvhtree_update_from_mvert ( collmd->bvhtree, collmd->mfaces, collmd->numfaces, collmd->current_x, collmd->current_xnew, collmd->numverts, 1 );
 }
 
@@ -118,15 +136,17 @@ BVHTree *bvhtree_build_from_mvert ( MFace *mfaces, unsigned int numfaces, MVert
 void bvhtree_update_from_mvert(BVHTree *bvhtree, MFace *faces, int numfaces, MVert *x, MVert *xnew, int UNUSED(numverts), int moving )
 {
 	int i;
-	MFace *mfaces = faces;
-	float co[12], co_moving[12];
-	int ret = 0;
 
 	if ( !bvhtree )
 		return;
 
 	if ( x ) {
-		for ( i = 0; i < numfaces; i++, mfaces++ ) {
+		/* leaves only touch their own bounds, the branches are joined after */
+#pragma omp parallel for private(i) schedule(static) if (numfaces > COLLISION_OPENMP_LIMIT)
+		for ( i = 0; i < numfaces; i++ ) {
+			MFace *mfaces = &faces[i];
+			float co[12], co_moving[12];
+
 			copy_v3_v3 ( &co[0*3], x[mfaces->v1].co );
 			copy_v3_v3 ( &co[1*3], x[mfaces->v2].co );
 			copy_v3_v3 ( &co[2*3], x[mfaces->v3].co );
@@ -142,15 +162,12 @@ void bvhtree_update_from_mvert(BVHTree *bvhtree, MFace *faces, int numfaces, MVe
 				if ( mfaces->v4 )
 					copy_v3_v3 ( &co_moving[3*3], xnew[mfaces->v4].co );
 
-				ret = BLI_bvhtree_update_node ( bvhtree, i, co, co_moving, ( mfaces->v4 ? 4 : 3 ) );
+				/* fails without side effects for faces not in the tree */
+				BLI_bvhtree_update_node ( bvhtree, i, co, co_moving, ( mfaces->v4 ? 4 : 3 ) );
 			}
 			else {
-				ret = BLI_bvhtree_update_node ( bvhtree, i, co, NULL, ( mfaces->v4 ? 4 : 3 ) );
+				BLI_bvhtree_update_node ( bvhtree, i, co, NULL, ( mfaces->v4 ? 4 : 3 ) );
 			}
-
-			// check if tree is already full
-			if ( !ret )
-				break;
 		}
 
 		BLI_bvhtree_update_tree ( bvhtree );
@@ -215,165 +232,198 @@ DO_INLINE void collision_interpolateOnTriangle ( float to[3], float v1[3], float
 	VECADDMUL(to, v3, w3);
 }
 
-static int cloth_collision_response_static ( ClothModifierData *clmd, CollisionModifierData *collmd, CollPair *collpair, CollPair *collision_end )
+/* impulses of one collision pair for its cloth vertices ap1, ap2, ap3 */
+typedef struct CollPairImpulse {
+	float i1[3], i2[3], i3[3];
+	int applied;
+} CollPairImpulse;
+
+/* only reads cloth and collider state, so pairs can be done in parallel */
+static int cloth_collision_pair_impulse ( ClothModifierData *clmd, CollisionModifierData *collmd, CollPair *collpair, float epsilon2,
+                                          float i1[3], float i2[3], float i3[3] )
 {
 	int result = 0;
 	Cloth *cloth1;
 	float w1, w2, w3, u1, u2, u3;
 	float v1[3], v2[3], relativeVelocity[3];
 	float magrelVel;
-	float epsilon2 = BLI_bvhtree_getepsilon ( collmd->bvhtree );
 
 	cloth1 = clmd->clothObject;
 
-	for ( ; collpair != collision_end; collpair++ ) {
-		float i1[3], i2[3], i3[3];
+	zero_v3(i1);
+	zero_v3(i2);
+	zero_v3(i3);
+
+	/* only handle static collisions here */
+	if ( collpair->flag & COLLISION_IN_FUTURE )
+		return 0;
 
-		zero_v3(i1);
-		zero_v3(i2);
-		zero_v3(i3);
+	/* compute barycentric coordinates for both collision points */
+	collision_compute_barycentric ( collpair->pa,
+		cloth1->verts[collpair->ap1].txold,
+		cloth1->verts[collpair->ap2].txold,
+		cloth1->verts[collpair->ap3].txold,
+		&w1, &w2, &w3 );
 
-		/* only handle static collisions here */
-		if ( collpair->flag & COLLISION_IN_FUTURE )
-			continue;
+	/* was: txold */
+	collision_compute_barycentric ( collpair->pb,
+		collmd->current_x[collpair->bp1].co,
+		collmd->current_x[collpair->bp2].co,
+		collmd->current_x[collpair->bp3].co,
+		&u1, &u2, &u3 );
 
-		/* compute barycentric coordinates for both collision points */
-		collision_compute_barycentric ( collpair->pa,
-			cloth1->verts[collpair->ap1].txold,
-			cloth1->verts[collpair->ap2].txold,
-			cloth1->verts[collpair->ap3].txold,
-			&w1, &w2, &w3 );
+	/* Calculate relative "velocity". */
+	collision_interpolateOnTriangle ( v1, cloth1->verts[collpair->ap1].tv, cloth1->verts[collpair->ap2].tv, cloth1->verts[collpair->ap3].tv, w1, w2, w3 );
 
-		/* was: txold */
-		collision_compute_barycentric ( collpair->pb,
-			collmd->current_x[collpair->bp1].co,
-			collmd->current_x[collpair->bp2].co,
-			collmd->current_x[collpair->bp3].co,
-			&u1, &u2, &u3 );
+	collision_interpolateOnTriangle ( v2, collmd->current_v[collpair->bp1].co, collmd->current_v[collpair->bp2].co, collmd->current_v[collpair->bp3].co, u1, u2, u3 );
 
-		/* Calculate relative "velocity". */
-		collision_interpolateOnTriangle ( v1, cloth1->verts[collpair->ap1].tv, cloth1->verts[collpair->ap2].tv, cloth1->verts[collpair->ap3].tv, w1, w2, w3 );
+	sub_v3_v3v3(relativeVelocity, v2, v1);
 
-		collision_interpolateOnTriangle ( v2, collmd->current_v[collpair->bp1].co, collmd->current_v[collpair->bp2].co, collmd->current_v[collpair->bp3].co, u1, u2, u3 );
+	/* Calculate the normal component of the relative velocity (actually only the magnitude - the direction is stored in 'normal'). */
+	magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
 
-		sub_v3_v3v3(relativeVelocity, v2, v1);
+	/* printf("magrelVel: %f\n", magrelVel); */
 
-		/* Calculate the normal component of the relative velocity (actually only the magnitude - the direction is stored in 'normal'). */
-		magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+	/* Calculate masses of points.
+	 * TODO */
 
-		/* printf("magrelVel: %f\n", magrelVel); */
+	/* If v_n_mag < 0 the edges are approaching each other. */
+	if ( magrelVel > ALMOST_ZERO ) {
+		/* Calculate Impulse magnitude to stop all motion in normal direction. */
+		float magtangent = 0, repulse = 0, d = 0;
+		double impulse = 0.0;
+		float vrel_t_pre[3];
+		float temp[3], spf;
 
-		/* Calculate masses of points.
-		 * TODO */
+		/* calculate tangential velocity */
+		copy_v3_v3 ( temp, collpair->normal );
+		mul_v3_fl(temp, magrelVel);
+		sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-		/* If v_n_mag < 0 the edges are approaching each other. */
-		if ( magrelVel > ALMOST_ZERO ) {
-			/* Calculate Impulse magnitude to stop all motion in normal direction. */
-			float magtangent = 0, repulse = 0, d = 0;
-			double impulse = 0.0;
-			float vrel_t_pre[3];
-			float temp[3], spf;
+		/* Decrease in magnitude of relative tangential velocity due to coulomb friction
+		 * in original formula "magrelVel" should be the "change of relative velocity in normal direction" */
+		magtangent = min_ff(clmd->coll_parms->friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
 
-			/* calculate tangential velocity */
-			copy_v3_v3 ( temp, collpair->normal );
-			mul_v3_fl(temp, magrelVel);
-			sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+		/* Apply friction impulse. */
+		if ( magtangent > ALMOST_ZERO ) {
+			normalize_v3(vrel_t_pre);
 
-			/* Decrease in magnitude of relative tangential velocity due to coulomb friction
-			 * in original formula "magrelVel" should be the "change of relative velocity in normal direction" */
-			magtangent = min_ff(clmd->coll_parms->friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+			impulse = magtangent / ( 1.0f + w1*w1 + w2*w2 + w3*w3 ); /* 2.0 * */
+			VECADDMUL ( i1, vrel_t_pre, w1 * impulse );
+			VECADDMUL ( i2, vrel_t_pre, w2 * impulse );
+			VECADDMUL ( i3, vrel_t_pre, w3 * impulse );
+		}
 
-			/* Apply friction impulse. */
-			if ( magtangent > ALMOST_ZERO ) {
-				normalize_v3(vrel_t_pre);
+		/* Apply velocity stopping impulse
+		 * I_c = m * v_N / 2.0
+		 * no 2.0 * magrelVel normally, but looks nicer DG */
+		impulse =  magrelVel / ( 1.0 + w1*w1 + w2*w2 + w3*w3 );
+
+		VECADDMUL ( i1, collpair->normal, w1 * impulse );
+		VECADDMUL ( i2, collpair->normal, w2 * impulse );
+		VECADDMUL ( i3, collpair->normal, w3 * impulse );
+
+		/* Apply repulse impulse if distance too short
+		 * I_r = -min(dt*kd, m(0, 1d/dt - v_n))
+		 * DG: this formula ineeds to be changed for this code since we apply impulses/repulses like this:
+		 * v += impulse; x_new = x + v;
+		 * We don't use dt!!
+		 * DG TODO: Fix usage of dt here! */
+		spf = (float)clmd->sim_parms->stepsPerFrame / clmd->sim_parms->timescale;
+
+		d = clmd->coll_parms->epsilon*8.0f/9.0f + epsilon2*8.0f/9.0f - collpair->distance;
+		if ( ( magrelVel < 0.1f*d*spf ) && ( d > ALMOST_ZERO ) ) {
+			repulse = MIN2 ( d*1.0f/spf, 0.1f*d*spf - magrelVel );
+
+			/* stay on the safe side and clamp repulse */
+			if ( impulse > ALMOST_ZERO )
+				repulse = min_ff( repulse, 5.0*impulse );
+			repulse = max_ff(impulse, repulse);
+
+			impulse = repulse / ( 1.0f + w1*w1 + w2*w2 + w3*w3 ); /* original 2.0 / 0.25 */
+			VECADDMUL ( i1, collpair->normal,  impulse );
+			VECADDMUL ( i2, collpair->normal,  impulse );
+			VECADDMUL ( i3, collpair->normal,  impulse );
+		}
 
-				impulse = magtangent / ( 1.0f + w1*w1 + w2*w2 + w3*w3 ); /* 2.0 * */
-				VECADDMUL ( i1, vrel_t_pre, w1 * impulse );
-				VECADDMUL ( i2, vrel_t_pre, w2 * impulse );
-				VECADDMUL ( i3, vrel_t_pre, w3 * impulse );
-			}
+		result = 1;
+	}
+	else {
+		/* Apply repulse impulse if distance too short
+		 * I_r = -min(dt*kd, max(0, 1d/dt - v_n))
+		 * DG: this formula ineeds to be changed for this code since we apply impulses/repulses like this:
+		 * v += impulse; x_new = x + v;
+		 * We don't use dt!! */
+		float spf = (float)clmd->sim_parms->stepsPerFrame / clmd->sim_parms->timescale;
 
-			/* Apply velocity stopping impulse
-			 * I_c = m * v_N / 2.0
-			 * no 2.0 * magrelVel normally, but looks nicer DG */
-			impulse =  magrelVel / ( 1.0 + w1*w1 + w2*w2 + w3*w3 );
-
-			VECADDMUL ( i1, collpair->normal, w1 * impulse );
-			cloth1->verts[collpair->ap1].impulse_count++;
-
-			VECADDMUL ( i2, collpair->normal, w2 * impulse );
-			cloth1->verts[collpair->ap2].impulse_count++;
-
-			VECADDMUL ( i3, collpair->normal, w3 * impulse );
-			cloth1->verts[collpair->ap3].impulse_count++;
-
-			/* Apply repulse impulse if distance too short
-			 * I_r = -min(dt*kd, m(0, 1d/dt - v_n))
-			 * DG: this formula ineeds to be changed for this code since we apply impulses/repulses like this:
-			 * v += impulse; x_new = x + v;
-			 * We don't use dt!!
-			 * DG TODO: Fix usage of dt here! */
-			spf = (float)clmd->sim_parms->stepsPerFrame / clmd->sim_parms->timescale;
-
-			d = clmd->coll_parms->epsilon*8.0f/9.0f + epsilon2*8.0f/9.0f - collpair->distance;
-			if ( ( magrelVel < 0.1f*d*spf ) && ( d > ALMOST_ZERO ) ) {
-				repulse = MIN2 ( d*1.0f/spf, 0.1f*d*spf - magrelVel );
-
-				/* stay on the safe side and clamp repulse */
-				if ( impulse > ALMOST_ZERO )
-					repulse = min_ff( repulse, 5.0*impulse );
-				repulse = max_ff(impulse, repulse);
-
-				impulse = repulse / ( 1.0f + w1*w1 + w2*w2 + w3*w3 ); /* original 2.0 / 0.25 */
-				VECADDMUL ( i1, collpair->normal,  impulse );
-				VECADDMUL ( i2, collpair->normal,  impulse );
-				VECADDMUL ( i3, collpair->normal,  impulse );
-			}
+		float d = clmd->coll_parms->epsilon*8.0f/9.0f + epsilon2*8.0f/9.0f - (float)collpair->distance;
+		if ( d > ALMOST_ZERO) {
+			/* stay on the safe side and clamp repulse */
+			float repulse = d*1.0f/spf;
+
+			float impulse = repulse / ( 3.0f * ( 1.0f + w1*w1 + w2*w2 + w3*w3 )); /* original 2.0 / 0.25 */
+
+			VECADDMUL ( i1, collpair->normal,  impulse );
+			VECADDMUL ( i2, collpair->normal,  impulse );
+			VECADDMUL ( i3, collpair->normal,  impulse );
 
 			result = 1;
 		}
-		else {
-			/* Apply repulse impulse if distance too short
-			 * I_r = -min(dt*kd, max(0, 1d/dt - v_n))
-			 * DG: this formula ineeds to be changed for this code since we apply impulses/repulses like this:
-			 * v += impulse; x_new = x + v;
-			 * We don't use dt!! */
-			float spf = (float)clmd->sim_parms->stepsPerFrame / clmd->sim_parms->timescale;
+	}
 
-			float d = clmd->coll_parms->epsilon*8.0f/9.0f + epsilon2*8.0f/9.0f - (float)collpair->distance;
-			if ( d > ALMOST_ZERO) {
-				/* stay on the safe side and clamp repulse */
-				float repulse = d*1.0f/spf;
+	return result;
+}
+
+static int cloth_collision_response_static ( ClothModifierData *clmd, CollisionModifierData *collmd, CollPair *collpair, CollPair *collision_end )
+{
+	int result = 0;
+	Cloth *cloth1 = clmd->clothObject;
+	float epsilon2 = BLI_bvhtree_getepsilon ( collmd->bvhtree );
+	int totpair = (int)(collision_end - collpair);
+	CollPairImpulse *impulses;
+	int p;
 
-				float impulse = repulse / ( 3.0f * ( 1.0f + w1*w1 + w2*w2 + w3*w3 )); /* original 2.0 / 0.25 */
+	if (totpair <= 0)
+		return 0;
 
-				VECADDMUL ( i1, collpair->normal,  impulse );
-				VECADDMUL ( i2, collpair->normal,  impulse );
-				VECADDMUL ( i3, collpair->normal,  impulse );
+	impulses = MEM_mallocN(sizeof(CollPairImpulse) * totpair, "collision impulses");
 
-				cloth1->verts[collpair->ap1].impulse_count++;
-				cloth1->verts[collpair->ap2].impulse_count++;
-				cloth1->verts[collpair->ap3].impulse_count++;
+#pragma omp parallel for private(p) schedule(static) if (totpair > COLLISION_OPENMP_LIMIT)
+	for (p = 0; p < totpair; p++) {
+		CollPairImpulse *imp = &impulses[p];
 
-				result = 1;
-			}
-		}
+		imp->applied = cloth_collision_pair_impulse(clmd, collmd, &collpair[p], epsilon2, imp->i1, imp->i2, imp->i3);
+	}
 
-		if (result) {
-			int i = 0;
+	/* pairs share vertices, apply in pair order so results don't depend on threading */
+	for (p = 0; p < totpair; p++) {
+		CollPair *pair = &collpair[p];
+		CollPairImpulse *imp = &impulses[p];
+		int i = 0;
 
-			for (i = 0; i < 3; i++) {
-				if (cloth1->verts[collpair->ap1].impulse_count > 0 && ABS(cloth1->verts[collpair->ap1].impulse[i]) < ABS(i1[i]))
-					cloth1->verts[collpair->ap1].impulse[i] = i1[i];
+		if (!imp->applied)
+			continue;
 
-				if (cloth1->verts[collpair->ap2].impulse_count > 0 && ABS(cloth1->verts[collpair->ap2].impulse[i]) < ABS(i2[i]))
-					cloth1->verts[collpair->ap2].impulse[i] = i2[i];
+		cloth1->verts[pair->ap1].impulse_count++;
+		cloth1->verts[pair->ap2].impulse_count++;
+		cloth1->verts[pair->ap3].impulse_count++;
 
-				if (cloth1->verts[collpair->ap3].impulse_count > 0 && ABS(cloth1->verts[collpair->ap3].impulse[i]) < ABS(i3[i]))
-					cloth1->verts[collpair->ap3].impulse[i] = i3[i];
-			}
+		for (i = 0; i < 3; i++) {
+			if (ABS(cloth1->verts[pair->ap1].impulse[i]) < ABS(imp->i1[i]))
+				cloth1->verts[pair->ap1].impulse[i] = imp->i1[i];
+
+			if (ABS(cloth1->verts[pair->ap2].impulse[i]) < ABS(imp->i2[i]))
+				cloth1->verts[pair->ap2].impulse[i] = imp->i2[i];
+
+			if (ABS(cloth1->verts[pair->ap3].impulse[i]) < ABS(imp->i3[i]))
+				cloth1->verts[pair->ap3].impulse[i] = imp->i3[i];
 		}
+
+		result = 1;
 	}
+
+	MEM_freeN(impulses);
+
 	return result;
 }
 
@@ -657,14 +707,33 @@ static void cloth_bvh_objcollisions_nearcheck ( ClothModifierData * clmd, Collis
 	CollPair **collisions, CollPair **collisions_index, int numresult, BVHTreeOverlap *overlap, double dt)
 {
 	int i;
+	CollPair *pairs;
+	int *numpairs;
 	
 	*collisions = (CollPair *) MEM_mallocN(sizeof(CollPair) * numresult * 64, "collision array" ); // * 4 since cloth_collision_static can return more than 1 collision
 	*collisions_index = *collisions;
 
+	pairs = *collisions;
+	numpairs = MEM_mallocN(sizeof(int) * numresult, "collision pair count");
+
+	/* each overlap gives at most 4 pairs, written to its own slots in parallel */
+#pragma omp parallel for private(i) schedule(dynamic, 64) if (numresult > COLLISION_OPENMP_LIMIT)
 	for ( i = 0; i < numresult; i++ ) {
-		*collisions_index = cloth_collision ( (ModifierData *)clmd, (ModifierData *)collmd,
-		                                      overlap+i, *collisions_index, dt );
+		CollPair *start = pairs + 4 * i;
+
+		numpairs[i] = (int)(cloth_collision ( (ModifierData *)clmd, (ModifierData *)collmd,
+		                                      overlap+i, start, dt ) - start);
 	}
+
+	/* pack them in overlap order */
+	for ( i = 0; i < numresult; i++ ) {
+		if (numpairs[i]) {
+			memmove(*collisions_index, pairs + 4 * i, sizeof(CollPair) * numpairs[i]);
+			*collisions_index += numpairs[i];
+		}
+	}
+
+	MEM_freeN(numpairs);
 }
 
 static int cloth_bvh_objcollisions_resolve ( ClothModifierData * clmd, CollisionModifierData *collmd, CollPair *collisions, CollPair *collisions_index)
@@ -45,6 +45,8 @@
 
 #include "BLF_translation.h"
 
+#include "PIL_time.h"
+
 #include "DNA_armature_types.h"
 #include "DNA_camera_types.h"
 #include "DNA_constraint_types.h"
@@ -77,6 +79,7 @@
 #include "BKE_object.h"
 #include "BKE_ipo.h"
 #include "BKE_global.h"
+#include "BKE_update_timing.h"
 #include "BKE_library.h"
 #include "BKE_idprop.h"
 #include "BKE_mesh.h"
@@ -4743,6 +4746,8 @@ void BKE_solve_constraints(ListBase *conlist, bConstraintOb *cob, float ctime)
 	bConstraint *con;
 	float oldmat[4][4];
 	float enf;
+	const bool do_timing = BKE_update_timing_enabled();
+	double start_time = 0.0;
 
 	/* check that there is a valid constraint object to evaluate */
 	if (cob == NULL)
@@ -4765,6 +4770,9 @@ void BKE_solve_constraints(ListBase *conlist, bConstraintOb *cob, float ctime)
 		 *  - value should have been set from animation data already
 		 */
 		enf = con->enforce;
+
+		if (do_timing)
+			start_time = PIL_check_seconds_timer();
 		
 		/* make copy of worldspace matrix pre-constraint for use with blending later */
 		copy_m4_m4(oldmat, cob->matrix);
@@ -4801,5 +4809,17 @@ void BKE_solve_constraints(ListBase *conlist, bConstraintOb *cob, float ctime)
 			copy_m4_m4(solution, cob->matrix);
 			blend_m4_m4m4(cob->matrix, oldmat, solution, enf);
 		}
+
+		if (do_timing && cob->ob) {
+			char name[sizeof(((UpdateTimingEntry *)NULL)->name)];
+
+			if (cob->pchan)
+				BLI_snprintf(name, sizeof(name), "%s / %s", cob->pchan->name, con->name);
+			else
+				BLI_strncpy(name, con->name, sizeof(name));
+
+			BKE_update_timing_add(UPDATE_TIMING_CONSTRAINT, cob->ob->id.name + 2, name,
+			                      PIL_check_seconds_timer() - start_time);
+		}
 	}
 }
@@ -2114,6 +2114,51 @@ void CustomData_interp(const CustomData *source, CustomData *dest,
 	if (count > SOURCE_BUF_SIZE) MEM_freeN(sources);
 }
 
+void CustomData_interp_strided(const CustomData *source, CustomData *dest,
+                               int *src_indices, float *weights, int weights_stride,
+                               int count, int dest_index, int dest_count)
+{
+	int src_i, dest_i;
+	int i, j;
+	void *source_buf[SOURCE_BUF_SIZE];
+	void **sources = source_buf;
+
+	if (count > SOURCE_BUF_SIZE)
+		sources = MEM_callocN(sizeof(*sources) * count,
+		                      "CustomData_interp_strided sources");
+
+	/* interpolates a layer at a time, matching layers like CustomData_interp */
+	dest_i = 0;
+	for (src_i = 0; src_i < source->totlayer; ++src_i) {
+		const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+		if (!typeInfo->interp) continue;
+
+		while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+			dest_i++;
+		}
+
+		if (dest_i >= dest->totlayer) break;
+
+		if (dest->layers[dest_i].type == source->layers[src_i].type) {
+			void *src_data = source->layers[src_i].data;
+			char *dest_data = (char *)dest->layers[dest_i].data + dest_index * typeInfo->size;
+
+			for (j = 0; j < count; ++j) {
+				sources[j] = (char *)src_data + typeInfo->size * src_indices[j];
+			}
+
+			for (i = 0; i < dest_count; i++) {
+				typeInfo->interp(sources, weights + i * weights_stride, NULL, count,
+				                 dest_data + i * typeInfo->size);
+			}
+
+			dest_i++;
+		}
+	}
+
+	if (count > SOURCE_BUF_SIZE) MEM_freeN(sources);
+}
+
 void CustomData_swap(struct CustomData *data, int index, const int *corner_indices)
 {
 	const LayerTypeInfo *typeInfo;
@@ -2537,9 +2582,8 @@ void CustomData_bmesh_free_block_data(CustomData *data, void **block)
 		memset(*block, 0, data->totsize);
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
-
 	if (*block)
 		CustomData_bmesh_free_block(data, block);
 
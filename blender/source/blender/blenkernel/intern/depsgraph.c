@@ -42,6 +42,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
+#include "BLI_threads.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_camera_types.h"
@@ -294,6 +295,71 @@ DagForest *dag_init(void)
 
 /* isdata = object data... */
 /* XXX this needs to be extended to be more flexible (so that not only objects are evaluated via depsgraph)... */
+/* Test whether a path of object animation changes the object data (pose,
+ * modifiers, shape keys...), other paths only need the object itself evaluated */
+static bool dag_rna_path_affects_data(const char *rna_path)
+{
+	static const char *data_paths[] = {
+	    "pose.", "data.", "modifiers[", "particle_systems[", "active_shape_key_index", "show_only_shape_key",
+	    NULL};
+	int i;
+
+	if (rna_path == NULL)
+		return false;
+
+	for (i = 0; data_paths[i]; i++) {
+		if (STRPREFIX(rna_path, data_paths[i]))
+			return true;
+	}
+
+	return false;
+}
+
+static bool dag_fcurves_affect_data(ListBase *curves)
+{
+	FCurve *fcu;
+
+	for (fcu = curves->first; fcu; fcu = fcu->next) {
+		if (dag_rna_path_affects_data(fcu->rna_path))
+			return true;
+	}
+
+	return false;
+}
+
+static bool dag_nla_strips_affect_data(ListBase *strips)
+{
+	NlaStrip *strip;
+
+	for (strip = strips->first; strip; strip = strip->next) {
+		if (strip->act && dag_fcurves_affect_data(&strip->act->curves))
+			return true;
+		if (dag_nla_strips_affect_data(&strip->strips))
+			return true;
+	}
+
+	return false;
+}
+
+/* Test whether object animation data changes the object data, so the animated
+ * object needs its data evaluated as well and not only its transform. */
+static bool dag_animdata_affects_data(AnimData *adt)
+{
+	NlaTrack *nlt;
+
+	if (adt->action && dag_fcurves_affect_data(&adt->action->curves))
+		return true;
+	if (dag_fcurves_affect_data(&adt->drivers))
+		return true;
+
+	for (nlt = adt->nla_tracks.first; nlt; nlt = nlt->next) {
+		if (dag_nla_strips_affect_data(&nlt->strips))
+			return true;
+	}
+
+	return false;
+}
+
 static void dag_add_driver_relation(AnimData *adt, DagForest *dag, DagNode *node, int isdata)
 {
 	FCurve *fcu;
@@ -302,7 +368,9 @@ static void dag_add_driver_relation(AnimData *adt, DagForest *dag, DagNode *node
 	for (fcu = adt->drivers.first; fcu; fcu = fcu->next) {
 		ChannelDriver *driver = fcu->driver;
 		DriverVar *dvar;
-		int isdata_fcu = (isdata) || (fcu->rna_path && strstr(fcu->rna_path, "modifiers["));
+		/* drivers of pose bones, modifiers and other object data need the data
+		 * evaluated when their targets change, other drivers only the object */
+		int isdata_fcu = (isdata) || dag_rna_path_affects_data(fcu->rna_path);
 		
 		/* loop over variables to get the target relationships */
 		for (dvar = driver->variables.first; dvar; dvar = dvar->next) {
@@ -1857,7 +1925,9 @@ static void dag_object_time_update_flags(Main *bmain, Scene *scene, Object *ob)
 		ob->adt->recalc |= ADT_RECALC_ANIM;
 	}
 	
-	if ((ob->adt) && (ob->type == OB_ARMATURE)) ob->recalc |= OB_RECALC_DATA;
+	/* the pose only needs to be evaluated again when it is animated, not for
+	 * armatures of which only the object transform is animated */
+	if ((ob->adt) && (ob->type == OB_ARMATURE) && dag_animdata_affects_data(ob->adt)) ob->recalc |= OB_RECALC_DATA;
 	
 	if (object_modifiers_use_time(ob)) ob->recalc |= OB_RECALC_DATA;
 	if ((ob->pose) && (ob->pose->flag & POSE_CONSTRAINTS_TIMEDEPEND)) ob->recalc |= OB_RECALC_DATA;
@@ -2679,6 +2749,72 @@ void DAG_pose_sort(Object *ob)
 	ugly_hack_sorry = 1;
 }
 
+/* ************************ DAG THREADED UPDATE ********************* */
+
+/* protects num_pending_parents of the nodes during threaded update */
+static ThreadMutex threaded_update_mutex = BLI_MUTEX_INITIALIZER;
+
+/* Count the parents of every node, and start the traversal by scheduling
+ * the nodes without any. */
+void DAG_threaded_update_begin(Scene *scene,
+                               void (*func)(void *node, void *user_data),
+                               void *user_data)
+{
+	DagNode *node;
+	DagAdjList *itA;
+
+	for (node = scene->theDag->DagNode.first; node; node = node->next)
+		node->num_pending_parents = 0;
+
+	for (node = scene->theDag->DagNode.first; node; node = node->next) {
+		for (itA = node->child; itA; itA = itA->next) {
+			if (itA->node != node)
+				itA->node->num_pending_parents++;
+		}
+	}
+
+	/* parent counts must all be known before any node is evaluated */
+	for (node = scene->theDag->DagNode.first; node; node = node->next) {
+		if (node->num_pending_parents == 0)
+			func(node, user_data);
+	}
+}
+
+/* Called after a node is evaluated, schedules the children for which
+ * this was the last pending parent. */
+void DAG_threaded_update_handle_node_updated(void *node_v,
+                                             void (*func)(void *node, void *user_data),
+                                             void *user_data)
+{
+	DagNode *node = node_v;
+	DagAdjList *itA;
+
+	for (itA = node->child; itA; itA = itA->next) {
+		DagNode *child_node = itA->node;
+		bool ready;
+
+		if (child_node == node)
+			continue;
+
+		BLI_mutex_lock(&threaded_update_mutex);
+		ready = (--child_node->num_pending_parents == 0);
+		BLI_mutex_unlock(&threaded_update_mutex);
+
+		if (ready)
+			func(child_node, user_data);
+	}
+}
+
+Object *DAG_get_node_object(void *node_v)
+{
+	DagNode *node = node_v;
+
+	if (node->type == ID_OB)
+		return node->ob;
+
+	return NULL;
+}
+
 /* ************************ DAG DEBUGGING ********************* */
 
 void DAG_print_dependencies(Main *bmain, Scene *scene, Object *ob)
@@ -43,9 +43,11 @@
 #include "DNA_material_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_memarena.h"
 #include "BLI_math.h"
 #include "BLI_scanfill.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -1362,6 +1364,393 @@ static void fillBevelCap(Nurb *nu, DispList *dlb, float *prev_fp, ListBase *disp
 	BLI_addtail(dispbase, dl);
 }
 
+/* Sweep the bevel object along one spline, adding the displists to dispbase */
+static void curve_bevel_spline_to_displist(Scene *scene, Curve *cu, BevList *bl, Nurb *nu,
+                                           ListBase *dlbev, float widfac, ListBase *dispbase)
+{
+	DispList *dl;
+	float *data;
+	BevPoint *bevp;
+	int a;
+
+	if (bl->nr == 0) /* blank bevel lists can happen */
+		return;
+
+	/* exception handling; curve without bevel or extrude, with width correction */
+	if (dlbev->first == NULL) {
+		dl = MEM_callocN(sizeof(DispList), "makeDispListbev");
+		dl->verts = MEM_callocN(3 * sizeof(float) * bl->nr, "dlverts");
+		BLI_addtail(dispbase, dl);
+
+		if (bl->poly != -1) dl->type = DL_POLY;
+		else dl->type = DL_SEGM;
+
+		if (dl->type == DL_SEGM) dl->flag = (DL_FRONT_CURVE | DL_BACK_CURVE);
+
+		dl->parts = 1;
+		dl->nr = bl->nr;
+		dl->col = nu->mat_nr;
+		dl->charidx = nu->charidx;
+
+		/* dl->rt will be used as flag for render face and */
+		/* CU_2D conflicts with R_NOPUNOFLIP */
+		dl->rt = nu->flag & ~CU_2D;
+
+		a = dl->nr;
+		bevp = (BevPoint *)(bl + 1);
+		data = dl->verts;
+		while (a--) {
+			data[0] = bevp->vec[0] + widfac * bevp->sina;
+			data[1] = bevp->vec[1] + widfac * bevp->cosa;
+			data[2] = bevp->vec[2];
+			bevp++;
+			data += 3;
+		}
+	}
+	else {
+		DispList *dlb;
+		ListBase bottom_capbase = {NULL, NULL};
+		ListBase top_capbase = {NULL, NULL};
+		float bottom_no[3] = {0.0f};
+		float top_no[3] = {0.0f};
+
+		for (dlb = dlbev->first; dlb; dlb = dlb->next) {
+			const float bevfac1 = min_ff(cu->bevfac1, cu->bevfac2);
+			const float bevfac2 = max_ff(cu->bevfac1, cu->bevfac2);
+			float firstblend = 0.0f, lastblend = 0.0f;
+			int i, start, steps;
+
+			if (bevfac2 - bevfac1 == 0.0f)
+				continue;
+
+			start = (int)(bevfac1 * (bl->nr - 1));
+			steps = 2 + (int)((bevfac2) * (bl->nr - 1)) - start;
+			firstblend = 1.0f - (bevfac1 * (bl->nr - 1) - (int)(bevfac1 * (bl->nr - 1)));
+			lastblend  =         bevfac2 * (bl->nr - 1) - (int)(bevfac2 * (bl->nr - 1));
+
+			if (start + steps > bl->nr) {
+				steps = bl->nr - start;
+				lastblend = 1.0f;
+			}
+
+			/* for each part of the bevel use a separate displblock */
+			dl = MEM_callocN(sizeof(DispList), "makeDispListbev1");
+			dl->verts = data = MEM_callocN(3 * sizeof(float) * dlb->nr * steps, "dlverts");
+			BLI_addtail(dispbase, dl);
+
+			dl->type = DL_SURF;
+
+			dl->flag = dlb->flag & (DL_FRONT_CURVE | DL_BACK_CURVE);
+			if (dlb->type == DL_POLY) dl->flag |= DL_CYCL_U;
+			if (bl->poly >= 0) dl->flag |= DL_CYCL_V;
+
+			dl->parts = steps;
+			dl->nr = dlb->nr;
+			dl->col = nu->mat_nr;
+			dl->charidx = nu->charidx;
+
+			/* dl->rt will be used as flag for render face and */
+			/* CU_2D conflicts with R_NOPUNOFLIP */
+			dl->rt = nu->flag & ~CU_2D;
+
+			dl->bevelSplitFlag = MEM_callocN(sizeof(*dl->col2) * ((steps + 0x1F) >> 5),
+			                                 "bevelSplitFlag");
+
+			/* for each point of poly make a bevel piece */
+			bevp = (BevPoint *)(bl + 1) + start;
+			for (i = start, a = 0; a < steps; i++, bevp++, a++) {
+				float fac = 1.0;
+				float *cur_data = data;
+
+				if (cu->taperobj == NULL) {
+					fac = bevp->radius;
+				}
+				else {
+					float len, taper_fac;
+
+					if (cu->flag & CU_MAP_TAPER) {
+						len = (steps - 3) + firstblend + lastblend;
+
+						if (a == 0)
+							taper_fac = 0.0f;
+						else if (a == steps - 1)
+							taper_fac = 1.0f;
+						else
+							taper_fac = ((float) a - (1.0f - firstblend)) / len;
+					}
+					else {
+						len = bl->nr - 1;
+						taper_fac = (float) i / len;
+
+						if (a == 0)
+							taper_fac += (1.0f - firstblend) / len;
+						else if (a == steps - 1)
+							taper_fac -= (1.0f - lastblend) / len;
+					}
+
+					fac = displist_calc_taper(scene, cu->taperobj, taper_fac);
+				}
+
+				if (bevp->split_tag) {
+					dl->bevelSplitFlag[a >> 5] |= 1 << (a & 0x1F);
+				}
+
+				/* rotate bevel piece and write in data */
+				if (a == 0)
+					rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - firstblend, widfac, fac, &data);
+				else if (a == steps - 1)
+					rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - lastblend, widfac, fac, &data);
+				else
+					rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, widfac, fac, &data);
+
+				if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC)) {
+					if (a == 1) {
+						fillBevelCap(nu, dlb, cur_data - 3 * dlb->nr, &bottom_capbase);
+						negate_v3_v3(bottom_no, bevp->dir);
+					}
+					if (a == steps - 1) {
+						fillBevelCap(nu, dlb, cur_data, &top_capbase);
+						copy_v3_v3(top_no, bevp->dir);
+					}
+				}
+			}
+
+			/* gl array drawing: using indices */
+			displist_surf_indices(dl);
+		}
+
+		if (bottom_capbase.first) {
+			BKE_displist_fill(&bottom_capbase, dispbase, bottom_no, false);
+			BKE_displist_fill(&top_capbase, dispbase, top_no, false);
+			BKE_displist_free(&bottom_capbase);
+			BKE_displist_free(&top_capbase);
+		}
+	}
+}
+
+/* Bevel displists of a spline from the previous evaluation, reused as long
+ * as the bevel points of the spline and the bevel settings are the same */
+typedef struct CurveBevelCacheSpline {
+	struct CurveBevelCacheSpline *next, *prev;
+	uint64_t hash;
+	ListBase disp;
+	bool used;
+} CurveBevelCacheSpline;
+
+void BKE_displist_bevel_cache_free(ListBase *bevel_cache)
+{
+	CurveBevelCacheSpline *cache;
+
+	for (cache = bevel_cache->first; cache; cache = cache->next)
+		BKE_displist_free(&cache->disp);
+
+	BLI_freelistN(bevel_cache);
+}
+
+/* FNV-1a */
+static uint64_t displist_hash_add(uint64_t hash, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+static uint64_t curve_bevel_settings_hash(Curve *cu, ListBase *dlbev, float widfac)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	const bool has_bevobj = (cu->bevobj != NULL);
+	Object *taperobj = cu->taperobj;
+	DispList *dl;
+
+	hash = displist_hash_add(hash, &widfac, sizeof(widfac));
+	hash = displist_hash_add(hash, &cu->bevfac1, sizeof(cu->bevfac1));
+	hash = displist_hash_add(hash, &cu->bevfac2, sizeof(cu->bevfac2));
+	hash = displist_hash_add(hash, &cu->flag, sizeof(cu->flag));
+	hash = displist_hash_add(hash, &has_bevobj, sizeof(has_bevobj));
+
+	for (dl = dlbev->first; dl; dl = dl->next) {
+		hash = displist_hash_add(hash, &dl->type, sizeof(dl->type));
+		hash = displist_hash_add(hash, &dl->flag, sizeof(dl->flag));
+		hash = displist_hash_add(hash, &dl->nr, sizeof(dl->nr));
+		hash = displist_hash_add(hash, dl->verts, sizeof(float) * 3 * dl->nr);
+	}
+
+	/* the taper curve is read through its displist, see displist_calc_taper */
+	if (taperobj && taperobj->type == OB_CURVE && taperobj->curve_cache &&
+	    (dl = taperobj->curve_cache->disp.first))
+	{
+		hash = displist_hash_add(hash, &dl->nr, sizeof(dl->nr));
+		hash = displist_hash_add(hash, dl->verts, sizeof(float) * 3 * dl->nr);
+	}
+
+	return hash;
+}
+
+static uint64_t curve_bevel_spline_hash(uint64_t hash, BevList *bl, Nurb *nu)
+{
+	hash = displist_hash_add(hash, &bl->nr, sizeof(bl->nr));
+	hash = displist_hash_add(hash, &bl->poly, sizeof(bl->poly));
+	hash = displist_hash_add(hash, bl + 1, sizeof(BevPoint) * bl->nr);
+	hash = displist_hash_add(hash, &nu->mat_nr, sizeof(nu->mat_nr));
+	hash = displist_hash_add(hash, &nu->flag, sizeof(nu->flag));
+	hash = displist_hash_add(hash, &nu->flagu, sizeof(nu->flagu));
+
+	return hash;
+}
+
+typedef struct CurveBevelSplinesData {
+	Scene *scene;
+	Curve *cu;
+	ListBase *dlbev;
+	float widfac;
+
+	BevList **bevlists;
+	Nurb **nurbs;
+	ListBase *dispbases;
+
+	/* only when caching, NULL otherwise */
+	uint64_t settings_hash;
+	uint64_t *hashes;
+	GHash *cache_map;
+	CurveBevelCacheSpline **cache_hits;
+} CurveBevelSplinesData;
+
+static void curve_bevel_splines_range(void *userdata, int start, int stop)
+{
+	CurveBevelSplinesData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BevList *bl = data->bevlists[i];
+		Nurb *nu = data->nurbs[i];
+
+		if (data->hashes) {
+			uint64_t hash = curve_bevel_spline_hash(data->settings_hash, bl, nu);
+			CurveBevelCacheSpline *cache;
+
+			data->hashes[i] = hash;
+			cache = BLI_ghash_lookup(data->cache_map, SET_UINT_IN_POINTER((unsigned int)(hash ^ (hash >> 32))));
+
+			if (cache && cache->hash == hash) {
+				DispList *dl;
+
+				/* characters can move in the text without changing their shape */
+				BKE_displist_copy(&data->dispbases[i], &cache->disp);
+				for (dl = data->dispbases[i].first; dl; dl = dl->next)
+					dl->charidx = nu->charidx;
+
+				data->cache_hits[i] = cache;
+				continue;
+			}
+		}
+
+		curve_bevel_spline_to_displist(data->scene, data->cu, bl, nu, data->dlbev, data->widfac,
+		                               &data->dispbases[i]);
+	}
+}
+
+/* Build the bevel displists of all splines, in parallel since the splines
+ * are independent. With a bevel cache, splines that did not change since
+ * the previous evaluation are copied from the cache instead. */
+static void curve_bevel_splines_to_displist(Scene *scene, Curve *cu, ListBase *bev, ListBase *nubase,
+                                            ListBase *dlbev, ListBase *dispbase, ListBase *bevel_cache)
+{
+	CurveBevelSplinesData data = {NULL};
+	CurveBevelCacheSpline *cache;
+	ListBase new_cache = {NULL, NULL};
+	BevList *bl;
+	Nurb *nu;
+	Object *taperobj = cu->taperobj;
+	bool use_threads = true;
+	int i, tot = 0;
+
+	for (bl = bev->first, nu = nubase->first; bl && nu; bl = bl->next, nu = nu->next)
+		tot++;
+
+	if (tot == 0)
+		return;
+
+	/* make sure the taper displist exists before threading, it is built
+	 * on first use otherwise */
+	if (taperobj && taperobj->type == OB_CURVE) {
+		displist_calc_taper(scene, taperobj, 0.0f);
+
+		if (taperobj->curve_cache == NULL || taperobj->curve_cache->disp.first == NULL)
+			use_threads = false;
+	}
+
+	data.scene = scene;
+	data.cu = cu;
+	data.dlbev = dlbev;
+	data.widfac = cu->width - 1.0f;
+	data.bevlists = MEM_mallocN(sizeof(*data.bevlists) * tot, "curve bevel lists");
+	data.nurbs = MEM_mallocN(sizeof(*data.nurbs) * tot, "curve bevel nurbs");
+	data.dispbases = MEM_callocN(sizeof(*data.dispbases) * tot, "curve bevel dispbases");
+
+	for (bl = bev->first, nu = nubase->first, i = 0; bl && nu; bl = bl->next, nu = nu->next, i++) {
+		data.bevlists[i] = bl;
+		data.nurbs[i] = nu;
+	}
+
+	if (bevel_cache) {
+		data.settings_hash = curve_bevel_settings_hash(cu, dlbev, data.widfac);
+		data.hashes = MEM_mallocN(sizeof(*data.hashes) * tot, "curve bevel hashes");
+		data.cache_hits = MEM_callocN(sizeof(*data.cache_hits) * tot, "curve bevel cache hits");
+		data.cache_map = BLI_ghash_int_new_ex(__func__, BLI_countlist(bevel_cache));
+
+		for (cache = bevel_cache->first; cache; cache = cache->next) {
+			BLI_ghash_insert(data.cache_map, SET_UINT_IN_POINTER((unsigned int)(cache->hash ^ (cache->hash >> 32))), cache);
+		}
+	}
+
+	if (use_threads)
+		BLI_task_parallel_range_ex(0, tot, &data, curve_bevel_splines_range, 8);
+	else
+		curve_bevel_splines_range(&data, 0, tot);
+
+	if (bevel_cache) {
+		/* keep the entries of this evaluation only */
+		for (i = 0; i < tot; i++) {
+			cache = data.cache_hits[i];
+
+			if (cache && !cache->used) {
+				BLI_remlink(bevel_cache, cache);
+			}
+			else {
+				cache = MEM_callocN(sizeof(CurveBevelCacheSpline), "CurveBevelCacheSpline");
+				cache->hash = data.hashes[i];
+				BKE_displist_copy(&cache->disp, &data.dispbases[i]);
+			}
+
+			cache->used = true;
+			BLI_addtail(&new_cache, cache);
+		}
+
+		for (cache = new_cache.first; cache; cache = cache->next)
+			cache->used = false;
+
+		BKE_displist_bevel_cache_free(bevel_cache);
+		*bevel_cache = new_cache;
+
+		BLI_ghash_free(data.cache_map, NULL, NULL);
+		MEM_freeN(data.hashes);
+		MEM_freeN(data.cache_hits);
+	}
+
+	for (i = 0; i < tot; i++)
+		BLI_movelisttolist(dispbase, &data.dispbases[i]);
+
+	MEM_freeN(data.bevlists);
+	MEM_freeN(data.nurbs);
+	MEM_freeN(data.dispbases);
+}
+
 static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispbase,
                                       DerivedMesh **derivedFinal, int forRender, int forOrco, int renderResolution)
 {
@@ -1400,171 +1789,8 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 			curve_to_displist(cu, &nubase, dispbase, forRender, renderResolution);
 		}
 		else {
-			float widfac = cu->width - 1.0f;
-			BevList *bl = ob->curve_cache->bev.first;
-			Nurb *nu = nubase.first;
-
-			for (; bl && nu; bl = bl->next, nu = nu->next) {
-				DispList *dl;
-				float *data;
-				BevPoint *bevp;
-				int a;
-
-				if (bl->nr) { /* blank bevel lists can happen */
-
-					/* exception handling; curve without bevel or extrude, with width correction */
-					if (dlbev.first == NULL) {
-						dl = MEM_callocN(sizeof(DispList), "makeDispListbev");
-						dl->verts = MEM_callocN(3 * sizeof(float) * bl->nr, "dlverts");
-						BLI_addtail(dispbase, dl);
-
-						if (bl->poly != -1) dl->type = DL_POLY;
-						else dl->type = DL_SEGM;
-
-						if (dl->type == DL_SEGM) dl->flag = (DL_FRONT_CURVE | DL_BACK_CURVE);
-
-						dl->parts = 1;
-						dl->nr = bl->nr;
-						dl->col = nu->mat_nr;
-						dl->charidx = nu->charidx;
-
-						/* dl->rt will be used as flag for render face and */
-						/* CU_2D conflicts with R_NOPUNOFLIP */
-						dl->rt = nu->flag & ~CU_2D;
-
-						a = dl->nr;
-						bevp = (BevPoint *)(bl + 1);
-						data = dl->verts;
-						while (a--) {
-							data[0] = bevp->vec[0] + widfac * bevp->sina;
-							data[1] = bevp->vec[1] + widfac * bevp->cosa;
-							data[2] = bevp->vec[2];
-							bevp++;
-							data += 3;
-						}
-					}
-					else {
-						DispList *dlb;
-						ListBase bottom_capbase = {NULL, NULL};
-						ListBase top_capbase = {NULL, NULL};
-						float bottom_no[3] = {0.0f};
-						float top_no[3] = {0.0f};
-
-						for (dlb = dlbev.first; dlb; dlb = dlb->next) {
-							const float bevfac1 = min_ff(cu->bevfac1, cu->bevfac2);
-							const float bevfac2 = max_ff(cu->bevfac1, cu->bevfac2);
-							float firstblend = 0.0f, lastblend = 0.0f;
-							int i, start, steps;
-
-							if (bevfac2 - bevfac1 == 0.0f)
-								continue;
-
-							start = (int)(bevfac1 * (bl->nr - 1));
-							steps = 2 + (int)((bevfac2) * (bl->nr - 1)) - start;
-							firstblend = 1.0f - (bevfac1 * (bl->nr - 1) - (int)(bevfac1 * (bl->nr - 1)));
-							lastblend  =         bevfac2 * (bl->nr - 1) - (int)(bevfac2 * (bl->nr - 1));
-
-							if (start + steps > bl->nr) {
-								steps = bl->nr - start;
-								lastblend = 1.0f;
-							}
-
-							/* for each part of the bevel use a separate displblock */
-							dl = MEM_callocN(sizeof(DispList), "makeDispListbev1");
-							dl->verts = data = MEM_callocN(3 * sizeof(float) * dlb->nr * steps, "dlverts");
-							BLI_addtail(dispbase, dl);
-
-							dl->type = DL_SURF;
-
-							dl->flag = dlb->flag & (DL_FRONT_CURVE | DL_BACK_CURVE);
-							if (dlb->type == DL_POLY) dl->flag |= DL_CYCL_U;
-							if (bl->poly >= 0) dl->flag |= DL_CYCL_V;
-
-							dl->parts = steps;
-							dl->nr = dlb->nr;
-							dl->col = nu->mat_nr;
-							dl->charidx = nu->charidx;
-
-							/* dl->rt will be used as flag for render face and */
-							/* CU_2D conflicts with R_NOPUNOFLIP */
-							dl->rt = nu->flag & ~CU_2D;
-
-							dl->bevelSplitFlag = MEM_callocN(sizeof(*dl->col2) * ((steps + 0x1F) >> 5),
-							                                 "bevelSplitFlag");
-
-							/* for each point of poly make a bevel piece */
-							bevp = (BevPoint *)(bl + 1) + start;
-							for (i = start, a = 0; a < steps; i++, bevp++, a++) {
-								float fac = 1.0;
-								float *cur_data = data;
-
-								if (cu->taperobj == NULL) {
-									fac = bevp->radius;
-								}
-								else {
-									float len, taper_fac;
-
-									if (cu->flag & CU_MAP_TAPER) {
-										len = (steps - 3) + firstblend + lastblend;
-
-										if (a == 0)
-											taper_fac = 0.0f;
-										else if (a == steps - 1)
-											taper_fac = 1.0f;
-										else
-											taper_fac = ((float) a - (1.0f - firstblend)) / len;
-									}
-									else {
-										len = bl->nr - 1;
-										taper_fac = (float) i / len;
-
-										if (a == 0)
-											taper_fac += (1.0f - firstblend) / len;
-										else if (a == steps - 1)
-											taper_fac -= (1.0f - lastblend) / len;
-									}
-
-									fac = displist_calc_taper(scene, cu->taperobj, taper_fac);
-								}
-
-								if (bevp->split_tag) {
-									dl->bevelSplitFlag[a >> 5] |= 1 << (a & 0x1F);
-								}
-
-								/* rotate bevel piece and write in data */
-								if (a == 0)
-									rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - firstblend, widfac, fac, &data);
-								else if (a == steps - 1)
-									rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - lastblend, widfac, fac, &data);
-								else
-									rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, widfac, fac, &data);
-
-								if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC)) {
-									if (a == 1) {
-										fillBevelCap(nu, dlb, cur_data - 3 * dlb->nr, &bottom_capbase);
-										negate_v3_v3(bottom_no, bevp->dir);
-									}
-									if (a == steps - 1) {
-										fillBevelCap(nu, dlb, cur_data, &top_capbase);
-										copy_v3_v3(top_no, bevp->dir);
-									}
-								}
-							}
-
-							/* gl array drawing: using indices */
-							displist_surf_indices(dl);
-						}
-
-						if (bottom_capbase.first) {
-							BKE_displist_fill(&bottom_capbase, dispbase, bottom_no, false);
-							BKE_displist_fill(&top_capbase, dispbase, top_no, false);
-							BKE_displist_free(&bottom_capbase);
-							BKE_displist_free(&top_capbase);
-						}
-					}
-				}
-
-			}
+			curve_bevel_splines_to_displist(scene, cu, &ob->curve_cache->bev, &nubase, &dlbev, dispbase,
+			                                (forRender || forOrco) ? NULL : &ob->curve_cache->bevel_cache);
 			BKE_displist_free(&dlbev);
 		}
 
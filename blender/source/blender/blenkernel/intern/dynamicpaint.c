@@ -3302,6 +3302,14 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 		Bounds3D mesh_bb = {0};
 		VolumeGrid *grid = bData->grid;
 
+#ifdef _OPENMP
+		int num_of_threads = omp_get_max_threads();
+#else
+		int num_of_threads = 1;
+#endif
+		/* per thread face nearest to the last proximity sample */
+		int *nearest_hint = NULL;
+
 		dm = CDDM_copy(brush->dm);
 		mvert = dm->getVertArray(dm);
 		mface = dm->getTessFaceArray(dm);
@@ -3341,6 +3349,8 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 				int c_index;
 				int total_cells = grid->dim[0] * grid->dim[1] * grid->dim[2];
 
+				nearest_hint = MEM_mallocN(sizeof(int) * num_of_threads, "Brush Nearest Hints");
+
 				/* loop through space partitioning grid */
 				for (c_index = 0; c_index < total_cells; c_index++) {
 					int id;
@@ -3349,6 +3359,9 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 					if (!grid->s_num[c_index] || !meshBrush_boundsIntersect(&grid->bounds[c_index], &mesh_bb, brush, brush_radius))
 						continue;
 
+					for (id = 0; id < num_of_threads; id++)
+						nearest_hint[id] = -1;
+
 					/* loop through cell points and process brush */
 				#pragma omp parallel for schedule(static)
 					for (id = 0; id < grid->s_num[c_index]; id++) {
@@ -3462,11 +3475,22 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 
 								/* If pure distance proximity, find the nearest point on the mesh */
 								if (!(brush->flags & MOD_DPAINT_PROX_PROJECT)) {
+#ifdef _OPENMP
+									int *hint = &nearest_hint[omp_get_thread_num()];
+#else
+									int *hint = &nearest_hint[0];
+#endif
+									/* Samples of a thread are neighbors within the cell, so the face nearest
+									 * to the previous one gives a tight initial distance for the search */
+									if (*hint != -1)
+										mesh_faces_nearest_point_dp(&treeData, *hint, ray_start, &nearest);
+
 									if (BLI_bvhtree_find_nearest(treeData.tree, ray_start, &nearest, mesh_faces_nearest_point_dp, &treeData) != -1) {
 										proxDist = sqrtf(nearest.dist);
 										copy_v3_v3(hitCo, nearest.co);
 										hQuad = (nearest.no[0] == 1.0f);
 										face = nearest.index;
+										*hint = nearest.index;
 									}
 								}
 								else { /* else cast a ray in defined projection direction */
@@ -3658,6 +3682,9 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 		free_bvhtree_from_mesh(&treeData);
 		dm->release(dm);
 
+		if (nearest_hint)
+			MEM_freeN(nearest_hint);
+
 	}
 
 	/* free brush velocity data */
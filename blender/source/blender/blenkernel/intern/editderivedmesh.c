@@ -1151,13 +1151,10 @@ static void emDM_getMinMax(DerivedMesh *dm, float r_min[3], float r_max[3])
 	BMesh *bm = bmdm->em->bm;
 	BMVert *eve;
 	BMIter iter;
-	int i;
 
 	if (bm->totvert) {
 		if (bmdm->vertexCos) {
-			BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
-				minmax_v3v3_v3(r_min, r_max, bmdm->vertexCos[i]);
-			}
+			minmax_v3_array(r_min, r_max, bmdm->vertexCos, bm->totvert);
 		}
 		else {
 			BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
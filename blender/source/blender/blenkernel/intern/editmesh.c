@@ -37,7 +37,6 @@
 
 #include "BLI_math.h"
 #include "BLI_memarena.h"
-#include "BLI_scanfill.h"
 
 #include "BKE_editmesh.h"
 #include "BKE_cdderivedmesh.h"
@@ -102,37 +101,14 @@ BMEditMesh *BKE_editmesh_from_object(Object *ob)
 
 static void editmesh_tessface_calc_intern(BMEditMesh *em)
 {
-	/* use this to avoid locking pthread for _every_ polygon
-	 * and calling the fill function */
-#define USE_TESSFACE_SPEEDUP
-
 	BMesh *bm = em->bm;
 
-	/* this assumes all faces can be scan-filled, which isn't always true,
+	/* this assumes all faces can be filled, which is true for two edged faces,
 	 * worst case we over alloc a little which is acceptable */
 	const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
 	const int looptris_tot_prev_alloc = em->looptris ? (MEM_allocN_len(em->looptris) / sizeof(*em->looptris)) : 0;
 
 	BMLoop *(*looptris)[3];
-	BMIter iter;
-	BMFace *efa;
-	BMLoop *l;
-	int i = 0;
-
-	ScanFillContext sf_ctx;
-	MemArena *sf_arena = NULL;
-
-#if 0
-	/* note, we could be clever and re-use this array but would need to ensure
-	 * its realloced at some point, for now just free it */
-	if (em->looptris) MEM_freeN(em->looptris);
-
-	/* Use em->tottri when set, this means no reallocs while transforming,
-	 * (unless scanfill fails), otherwise... */
-	/* allocate the length of totfaces, avoid many small reallocs,
-	 * if all faces are tri's it will be correct, quads == 2x allocs */
-	BLI_array_reserve(looptris, (em->tottri && em->tottri < bm->totface * 3) ? em->tottri : bm->totface);
-#else
 
 	/* this means no reallocs for quad dominant models, for */
 	if ((em->looptris != NULL) &&
@@ -147,139 +123,10 @@ static void editmesh_tessface_calc_intern(BMEditMesh *em)
 		looptris = MEM_mallocN(sizeof(*looptris) * looptris_tot, __func__);
 	}
 
-#endif
-
-	BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
-		/* don't consider two-edged faces */
-		if (UNLIKELY(efa->len < 3)) {
-			/* do nothing */
-		}
-
-#ifdef USE_TESSFACE_SPEEDUP
-
-		/* no need to ensure the loop order, we know its ok */
-
-		else if (efa->len == 3) {
-#if 0
-			int j;
-			BM_ITER_ELEM_INDEX (l, &liter, efa, BM_LOOPS_OF_FACE, j) {
-				looptris[i][j] = l;
-			}
-			i += 1;
-#else
-			/* more cryptic but faster */
-			BMLoop **l_ptr = looptris[i++];
-			l_ptr[0] = l = BM_FACE_FIRST_LOOP(efa);
-			l_ptr[1] = l = l->next;
-			l_ptr[2] = l->next;
-#endif
-		}
-		else if (efa->len == 4) {
-#if 0
-			BMLoop *ltmp[4];
-			int j;
-			BLI_array_grow_items(looptris, 2);
-			BM_ITER_ELEM_INDEX (l, &liter, efa, BM_LOOPS_OF_FACE, j) {
-				ltmp[j] = l;
-			}
-
-			looptris[i][0] = ltmp[0];
-			looptris[i][1] = ltmp[1];
-			looptris[i][2] = ltmp[2];
-			i += 1;
-
-			looptris[i][0] = ltmp[0];
-			looptris[i][1] = ltmp[2];
-			looptris[i][2] = ltmp[3];
-			i += 1;
-#else
-			/* more cryptic but faster */
-			BMLoop **l_ptr_a = looptris[i++];
-			BMLoop **l_ptr_b = looptris[i++];
-			(l_ptr_a[0] = l_ptr_b[0] = l = BM_FACE_FIRST_LOOP(efa));
-			(l_ptr_a[1]              = l = l->next);
-			(l_ptr_a[2] = l_ptr_b[1] = l = l->next);
-			(             l_ptr_b[2] = l->next);
-#endif
-		}
-
-#endif /* USE_TESSFACE_SPEEDUP */
-
-		else {
-			int j;
-			BMLoop *l_iter;
-			BMLoop *l_first;
-
-			ScanFillVert *sf_vert, *sf_vert_last = NULL, *sf_vert_first = NULL;
-			/* ScanFillEdge *e; */ /* UNUSED */
-			ScanFillFace *sf_tri;
-			int totfilltri;
-
-			if (UNLIKELY(sf_arena == NULL)) {
-				sf_arena = BLI_memarena_new(BLI_SCANFILL_ARENA_SIZE, __func__);
-			}
-
-			BLI_scanfill_begin_arena(&sf_ctx, sf_arena);
-
-			/* scanfill time */
-			j = 0;
-			l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
-			do {
-				sf_vert = BLI_scanfill_vert_add(&sf_ctx, l_iter->v->co);
-				sf_vert->tmp.p = l_iter;
-
-				if (sf_vert_last) {
-					/* e = */ BLI_scanfill_edge_add(&sf_ctx, sf_vert_last, sf_vert);
-				}
-
-				sf_vert_last = sf_vert;
-				if (sf_vert_first == NULL) {
-					sf_vert_first = sf_vert;
-				}
-
-				/*mark order */
-				BM_elem_index_set(l_iter, j++); /* set_loop */
-
-			} while ((l_iter = l_iter->next) != l_first);
-
-			/* complete the loop */
-			BLI_scanfill_edge_add(&sf_ctx, sf_vert_first, sf_vert);
-
-			totfilltri = BLI_scanfill_calc_ex(&sf_ctx, 0, efa->no);
-			BLI_assert(totfilltri <= efa->len - 2);
-			(void)totfilltri;
-
-			for (sf_tri = sf_ctx.fillfacebase.first; sf_tri; sf_tri = sf_tri->next) {
-				BMLoop **l_ptr = looptris[i++];
-				BMLoop *l1 = sf_tri->v1->tmp.p;
-				BMLoop *l2 = sf_tri->v2->tmp.p;
-				BMLoop *l3 = sf_tri->v3->tmp.p;
-
-				if (BM_elem_index_get(l1) > BM_elem_index_get(l2)) { SWAP(BMLoop *, l1, l2); }
-				if (BM_elem_index_get(l2) > BM_elem_index_get(l3)) { SWAP(BMLoop *, l2, l3); }
-				if (BM_elem_index_get(l1) > BM_elem_index_get(l2)) { SWAP(BMLoop *, l1, l2); }
-
-				l_ptr[0] = l1;
-				l_ptr[1] = l2;
-				l_ptr[2] = l3;
-			}
-
-			BLI_scanfill_end_arena(&sf_ctx, sf_arena);
-		}
-	}
-
-	if (sf_arena) {
-		BLI_memarena_free(sf_arena);
-		sf_arena = NULL;
-	}
-
-	em->tottri = i;
+	BM_bmesh_calc_tessellation(bm, looptris, &em->tottri);
 	em->looptris = looptris;
 
 	BLI_assert(em->tottri <= looptris_tot);
-
-#undef USE_TESSFACE_SPEEDUP
-
 }
 
 void BKE_editmesh_tessface_calc(BMEditMesh *em)
@@ -301,6 +148,75 @@ void BKE_editmesh_tessface_calc(BMEditMesh *em)
 #endif
 }
 
+/* moving more than 1/Nth of the vertices updates the whole mesh */
+#define EDITMESH_PARTIAL_UPDATE_FAC 8
+
+/* first triangle of a face, the tessellation is in face index order */
+static int editmesh_looptris_face_first(BMEditMesh *em, const int f_index)
+{
+	int lo = 0, hi = em->tottri;
+
+	while (lo < hi) {
+		const int mid = lo + (hi - lo) / 2;
+		if (BM_elem_index_get(em->looptris[mid][0]->f) < f_index) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/**
+ * Update normals and tessellation when only the coordinates of \a verts changed
+ * since the last #BKE_editmesh_tessface_calc, as when transforming vertices.
+ *
+ * Only the faces around \a verts get new normals, and only ngons among them are
+ * tessellated again since triangles and quads are split the same way whatever the
+ * vertex locations. Falls back to a full update when many vertices moved
+ * or faces were added or removed.
+ */
+void BKE_editmesh_update_verts_moved(BMEditMesh *em, BMVert **verts, const int verts_len)
+{
+	BMesh *bm = em->bm;
+	BMFace **faces;
+	MemArena *arena = NULL;
+	int faces_len, i;
+
+	if ((em->looptris == NULL) ||
+	    (bm->elem_table_dirty & BM_FACE) ||
+	    (verts_len > bm->totvert / EDITMESH_PARTIAL_UPDATE_FAC))
+	{
+		BM_mesh_normals_update(bm);
+		BKE_editmesh_tessface_calc(em);
+		return;
+	}
+
+	BM_mesh_normals_update_verts(bm, verts, verts_len, &faces, &faces_len);
+
+	/* the tessellation follows the face table, so does index order */
+	BM_mesh_elem_index_ensure(bm, BM_FACE);
+
+	for (i = 0; i < faces_len; i++) {
+		BMFace *f = faces[i];
+		if (f->len > 4) {
+			const int tri = editmesh_looptris_face_first(em, BM_elem_index_get(f));
+			BLI_assert(tri + f->len - 2 <= em->tottri && em->looptris[tri][0]->f == f);
+			BM_face_calc_looptris(f, &em->looptris[tri], &arena);
+		}
+	}
+
+	if (arena) {
+		BLI_memarena_free(arena);
+	}
+
+	if (faces) {
+		MEM_freeN(faces);
+	}
+}
+
 void BKE_editmesh_update_linked_customdata(BMEditMesh *em)
 {
 	BMesh *bm = em->bm;
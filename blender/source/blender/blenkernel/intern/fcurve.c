@@ -44,6 +44,8 @@
 #include "DNA_object_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_alloca.h"
+#include "BLI_expr_pylike_eval.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
@@ -1564,6 +1566,8 @@ void fcurve_free_driver(FCurve *fcu)
 		BPY_DECREF(driver->expr_comp);
 #endif
 
+	driver_free_simple_expr(driver);
+
 	/* free driver itself, then set F-Curve's point to this to NULL (as the curve may still be used) */
 	MEM_freeN(driver);
 	fcu->driver = NULL;
@@ -1582,6 +1586,7 @@ ChannelDriver *fcurve_copy_driver(ChannelDriver *driver)
 	/* copy all data */
 	ndriver = MEM_dupallocN(driver);
 	ndriver->expr_comp = NULL;
+	ndriver->expr_simple = NULL;
 	
 	/* copy variables */
 	ndriver->variables.first = ndriver->variables.last = NULL;
@@ -1627,6 +1632,116 @@ float driver_get_variable_value(ChannelDriver *driver, DriverVar *dvar)
 	return dvar->curval;
 }
 
+/* Scripted Expressions ------------------------------- */
+
+/* Scripted expression compiled for native evaluation (ChannelDriver.expr_simple)
+ * Keeps a copy of what it was compiled from, so edits to the expression or to the
+ * variable names are noticed without every editing path having to invalidate it.
+ */
+typedef struct DriverSimpleExpr {
+	ExprPyLike_Parsed *parsed;      /* invalid when the expression needs Python */
+	char expression[256];           /* ChannelDriver.expression it was compiled from */
+	int totvar;                     /* number of variables, 'frame' is passed after them */
+	char (*varnames)[64];           /* DriverVar.name of each variable */
+} DriverSimpleExpr;
+
+/* Free the natively compiled expression of the driver (if any) */
+void driver_free_simple_expr(ChannelDriver *driver)
+{
+	DriverSimpleExpr *sexpr = driver->expr_simple;
+	
+	if (sexpr) {
+		BLI_expr_pylike_free(sexpr->parsed);
+		
+		if (sexpr->varnames)
+			MEM_freeN(sexpr->varnames);
+		
+		MEM_freeN(sexpr);
+		driver->expr_simple = NULL;
+	}
+}
+
+/* Check whether the compiled expression is still up to date with the driver settings */
+static bool driver_simple_expr_matches(DriverSimpleExpr *sexpr, ChannelDriver *driver)
+{
+	DriverVar *dvar;
+	int i;
+	
+	if (!STREQ(sexpr->expression, driver->expression))
+		return false;
+	
+	for (dvar = driver->variables.first, i = 0; dvar; dvar = dvar->next, i++) {
+		if ((i >= sexpr->totvar) || !STREQ(sexpr->varnames[i], dvar->name))
+			return false;
+	}
+	
+	return (i == sexpr->totvar);
+}
+
+/* Compile the driver expression, with the variables and 'frame' as parameters */
+static DriverSimpleExpr *driver_compile_simple_expr(ChannelDriver *driver)
+{
+	DriverSimpleExpr *sexpr = MEM_callocN(sizeof(DriverSimpleExpr), "DriverSimpleExpr");
+	DriverVar *dvar;
+	const char **names;
+	int i;
+	
+	BLI_strncpy(sexpr->expression, driver->expression, sizeof(sexpr->expression));
+	
+	sexpr->totvar = BLI_countlist(&driver->variables);
+	if (sexpr->totvar)
+		sexpr->varnames = MEM_mallocN(sizeof(*sexpr->varnames) * sexpr->totvar, "DriverSimpleExpr varnames");
+	
+	names = BLI_array_alloca(names, sexpr->totvar + 1);
+	
+	for (dvar = driver->variables.first, i = 0; dvar; dvar = dvar->next, i++) {
+		BLI_strncpy(sexpr->varnames[i], dvar->name, sizeof(sexpr->varnames[i]));
+		names[i] = sexpr->varnames[i];
+	}
+	names[i] = "frame";
+	
+	sexpr->parsed = BLI_expr_pylike_parse(sexpr->expression, names, sexpr->totvar + 1);
+	
+	return sexpr;
+}
+
+/* Try to evaluate the scripted expression without Python
+ *	- returns false when the expression isn't supported natively, or it hits an error that
+ *	  Python should report, in which case the Python evaluation has to be used instead
+ */
+static bool driver_evaluate_simple_expr(ChannelDriver *driver, const float evaltime, float *r_value)
+{
+	DriverSimpleExpr *sexpr = driver->expr_simple;
+	DriverVar *dvar;
+	double *vars, result;
+	int i;
+	
+	/* (re)compile when needed, expressions which need Python are remembered too */
+	if (sexpr && !driver_simple_expr_matches(sexpr, driver)) {
+		driver_free_simple_expr(driver);
+		sexpr = NULL;
+	}
+	
+	if (sexpr == NULL)
+		driver->expr_simple = sexpr = driver_compile_simple_expr(driver);
+	
+	if (!BLI_expr_pylike_is_valid(sexpr->parsed))
+		return false;
+	
+	/* get the variable values, same as what gets passed to Python */
+	vars = BLI_array_alloca(vars, sexpr->totvar + 1);
+	
+	for (dvar = driver->variables.first, i = 0; dvar; dvar = dvar->next, i++)
+		vars[i] = (double)driver_get_variable_value(driver, dvar);
+	vars[i] = (double)evaltime;
+	
+	if (BLI_expr_pylike_eval(sexpr->parsed, vars, sexpr->totvar + 1, &result) != EXPR_PYLIKE_SUCCESS)
+		return false;
+	
+	*r_value = (float)result;
+	return true;
+}
+
 /* Evaluate an Channel-Driver to get a 'time' value to use instead of "evaltime"
  *	- "evaltime" is the frame at which F-Curve is being evaluated
  *  - has to return a float value
@@ -1704,22 +1819,26 @@ static float evaluate_driver(ChannelDriver *driver, const float evaltime)
 		}
 		case DRIVER_TYPE_PYTHON: /* expression */
 		{
-#ifdef WITH_PYTHON
 			/* check for empty or invalid expression */
 			if ( (driver->expression[0] == '\0') ||
 			     (driver->flag & DRIVER_FLAG_INVALID) )
 			{
 				driver->curval = 0.0f;
 			}
+			else if (driver_evaluate_simple_expr(driver, evaltime, &driver->curval)) {
+				/* simple arithmetic expression, evaluated without touching Python
+				 * (so it's also thread-safe and works without script auto-execution) */
+			}
 			else {
+#ifdef WITH_PYTHON
 				/* this evaluates the expression using Python, and returns its result:
 				 *  - on errors it reports, then returns 0.0f
 				 */
 				driver->curval = BPY_driver_exec(driver, evaltime);
-			}
 #else /* WITH_PYTHON*/
-			(void)evaltime;
+				driver->curval = 0.0f;
 #endif /* WITH_PYTHON*/
+			}
 			break;
 		}
 		default:
@@ -2033,55 +2152,72 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
 		}
 	}
 	else {
-		/* evaltime occurs somewhere in the middle of the curve */
-		for (a = 0; prevbezt && bezt && (a < fcu->totvert - 1); a++, prevbezt = bezt, bezt++) {
-			/* use if the key is directly on the frame, rare cases this is needed else we get 0.0 instead. */
-			if (fabsf(bezt->vec[1][0] - evaltime) < SMALL_NUMBER) {
-				cvalue = bezt->vec[1][1];
+		/* evaltime occurs somewhere in the middle of the curve,
+		 * binary search for the first keyframe at or after evaltime, that keyframe ends the segment.
+		 * This keeps evaluation logarithmic in the number of keyframes (baked/mocap curves have thousands) */
+		unsigned int lo = 1, hi = a;
+		
+		while (lo < hi) {
+			unsigned int mid = lo + ((hi - lo) / 2);
+			
+			if (bezts[mid].vec[1][0] < evaltime)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		
+		/* several keyframes may sit directly on the frame, the last one of those wins */
+		while ((lo < a) && (fabsf(bezts[lo + 1].vec[1][0] - evaltime) < SMALL_NUMBER))
+			lo++;
+		
+		bezt = bezts + lo;
+		prevbezt = bezt - 1;
+		
+		/* use if the key is directly on the frame, rare cases this is needed else we get 0.0 instead. */
+		if (fabsf(bezt->vec[1][0] - evaltime) < SMALL_NUMBER) {
+			cvalue = bezt->vec[1][1];
+		}
+		/* evaltime occurs within the interval defined by these two keyframes */
+		else if ((prevbezt->vec[1][0] <= evaltime) && (bezt->vec[1][0] >= evaltime)) {
+			/* value depends on interpolation mode */
+			if ((prevbezt->ipo == BEZT_IPO_CONST) || (fcu->flag & FCURVE_DISCRETE_VALUES)) {
+				/* constant (evaltime not relevant, so no interpolation needed) */
+				cvalue = prevbezt->vec[1][1];
 			}
-			/* evaltime occurs within the interval defined by these two keyframes */
-			else if ((prevbezt->vec[1][0] <= evaltime) && (bezt->vec[1][0] >= evaltime)) {
-				/* value depends on interpolation mode */
-				if ((prevbezt->ipo == BEZT_IPO_CONST) || (fcu->flag & FCURVE_DISCRETE_VALUES)) {
-					/* constant (evaltime not relevant, so no interpolation needed) */
-					cvalue = prevbezt->vec[1][1];
-				}
-				else if (prevbezt->ipo == BEZT_IPO_LIN) {
-					/* linear - interpolate between values of the two keyframes */
-					fac = bezt->vec[1][0] - prevbezt->vec[1][0];
-					
-					/* prevent division by zero */
-					if (fac) {
-						fac = (evaltime - prevbezt->vec[1][0]) / fac;
-						cvalue = prevbezt->vec[1][1] + (fac * (bezt->vec[1][1] - prevbezt->vec[1][1]));
-					}
-					else {
-						cvalue = prevbezt->vec[1][1];
-					}
+			else if (prevbezt->ipo == BEZT_IPO_LIN) {
+				/* linear - interpolate between values of the two keyframes */
+				fac = bezt->vec[1][0] - prevbezt->vec[1][0];
+				
+				/* prevent division by zero */
+				if (fac) {
+					fac = (evaltime - prevbezt->vec[1][0]) / fac;
+					cvalue = prevbezt->vec[1][1] + (fac * (bezt->vec[1][1] - prevbezt->vec[1][1]));
 				}
 				else {
-					/* bezier interpolation */
-					/* (v1, v2) are the first keyframe and its 2nd handle */
-					v1[0] = prevbezt->vec[1][0];
-					v1[1] = prevbezt->vec[1][1];
-					v2[0] = prevbezt->vec[2][0];
-					v2[1] = prevbezt->vec[2][1];
-					/* (v3, v4) are the last keyframe's 1st handle + the last keyframe */
-					v3[0] = bezt->vec[0][0];
-					v3[1] = bezt->vec[0][1];
-					v4[0] = bezt->vec[1][0];
-					v4[1] = bezt->vec[1][1];
-					
-					/* adjust handles so that they don't overlap (forming a loop) */
-					correct_bezpart(v1, v2, v3, v4);
-					
-					/* try to get a value for this position - if failure, try another set of points */
-					b = findzero(evaltime, v1[0], v2[0], v3[0], v4[0], opl);
-					if (b) {
-						berekeny(v1[1], v2[1], v3[1], v4[1], opl, 1);
-						cvalue = opl[0];
-						break;
-					}
+					cvalue = prevbezt->vec[1][1];
+				}
+			}
+			else {
+				/* bezier interpolation */
+				/* (v1, v2) are the first keyframe and its 2nd handle */
+				v1[0] = prevbezt->vec[1][0];
+				v1[1] = prevbezt->vec[1][1];
+				v2[0] = prevbezt->vec[2][0];
+				v2[1] = prevbezt->vec[2][1];
+				/* (v3, v4) are the last keyframe's 1st handle + the last keyframe */
+				v3[0] = bezt->vec[0][0];
+				v3[1] = bezt->vec[0][1];
+				v4[0] = bezt->vec[1][0];
+				v4[1] = bezt->vec[1][1];
+				
+				/* adjust handles so that they don't overlap (forming a loop) */
+				correct_bezpart(v1, v2, v3, v4);
+				
+				/* try to get a value for this position */
+				b = findzero(evaltime, v1[0], v2[0], v3[0], v4[0], opl);
+				if (b) {
+					berekeny(v1[1], v2[1], v3[1], v4[1], opl, 1);
+					cvalue = opl[0];
 				}
 			}
 		}
@@ -66,6 +66,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -815,6 +816,9 @@ void free_old_images(void)
 	static int lasttime = 0;
 	int ctime = (int)PIL_check_seconds_timer();
 
+	/* cheap unless textures were created since the last call */
+	GPU_free_images_memory_limit();
+
 	/*
 	 * Run garbage collector once for every collecting period of time
 	 * if textimeout is 0, that's the option to NOT run the collector
@@ -3105,6 +3109,94 @@ int BKE_image_has_ibuf(Image *ima, ImageUser *iuser)
 	return ibuf != NULL;
 }
 
+/* ******** Read-ahead for image sequences ********  */
+
+typedef struct ImagePrefetchData {
+	Image *ima;
+	ImageUser iuser;
+	const int *frames;
+	short *stop;
+} ImagePrefetchData;
+
+static void image_prefetch_range_func(void *userdata, int start, int stop)
+{
+	ImagePrefetchData *data = userdata;
+	Image *ima = data->ima;
+	ImageUser iuser = data->iuser;
+	char name[FILE_MAX];
+	int flag, i;
+
+	/* the image type is known to be a regular image at this point, no multilayer */
+	flag = IB_rect | imbuf_alpha_flags_for_image(ima);
+
+	for (i = start; i < stop && !*data->stop; i++) {
+		ImBuf *ibuf;
+
+		iuser.framenr = data->frames[i];
+		BKE_image_user_file_path(&iuser, ima, name);
+
+		/* reading and decoding happens outside of the image lock */
+		ibuf = IMB_loadiffname(name, flag, ima->colorspace_settings.name);
+
+		if (ibuf == NULL)
+			continue;
+
+		if (ima->flag & IMA_FIELDS) {
+			if (ima->flag & IMA_STD_FIELD) de_interlace_st(ibuf);
+			else de_interlace_ng(ibuf);
+		}
+
+		BLI_spin_lock(&image_spin);
+		if (ima->type == IMA_TYPE_IMAGE && image_get_ibuf(ima, 0, iuser.framenr) == NULL) {
+			image_assign_ibuf(ima, ibuf, 0, iuser.framenr);
+			ibuf = NULL;
+		}
+		BLI_spin_unlock(&image_spin);
+
+		/* frame got loaded in the meantime */
+		if (ibuf)
+			IMB_freeImBuf(ibuf);
+	}
+}
+
+void BKE_image_sequence_prefetch(Image *ima, ImageUser *iuser, int cfra,
+                                 int tot_frames, int direction, short *stop)
+{
+	ImagePrefetchData data;
+	int *frames;
+	int i, totframe = 0;
+
+	/* only sequences of regular images, after the first frame has been loaded */
+	if (ima->source != IMA_SRC_SEQUENCE || ima->type != IMA_TYPE_IMAGE || ima->ok != IMA_OK_LOADED)
+		return;
+
+	if (tot_frames <= 0)
+		return;
+
+	frames = MEM_mallocN(sizeof(int) * tot_frames, "image prefetch frames");
+
+	BLI_spin_lock(&image_spin);
+	for (i = 1; i <= tot_frames; i++) {
+		short is_in_range;
+		const int framenr = BKE_image_user_frame_get(iuser, cfra + i * direction, 0, &is_in_range);
+
+		if (is_in_range && image_get_ibuf(ima, 0, framenr) == NULL)
+			frames[totframe++] = framenr;
+	}
+	BLI_spin_unlock(&image_spin);
+
+	data.ima = ima;
+	data.iuser = *iuser;
+	data.frames = frames;
+	data.stop = stop;
+
+	BLI_task_parallel_range_ex(0, totframe, &data, image_prefetch_range_func, 2);
+
+	ima->lastused = clock() / CLOCKS_PER_SEC;
+
+	MEM_freeN(frames);
+}
+
 /* ******** Pool for image buffers ********  */
 
 typedef struct ImagePoolEntry {
@@ -54,8 +54,14 @@
 
 #ifdef _OPENMP
 #  define CLOTH_OPENMP_LIMIT 512
+/* plain long vector ops are memory bound, only worth threading for big meshes */
+#  define CLOTH_OPENMP_VECTOR_LIMIT 8192
 #endif
 
+/* number of partial sums in dot_lfvector, fixed so the summation order
+ * (and so the simulation) doesn't depend on the number of threads */
+#define CLOTH_DOT_PARTS 64
+
 #if 0  /* debug timing */
 #ifdef _WIN32
 #include <windows.h>
@@ -226,9 +232,10 @@ DO_INLINE void zero_lfvector(float (*to)[3], unsigned int verts)
 /* multiply long vector with scalar*/
 DO_INLINE void mul_lfvectorS(float (*to)[3], float (*fLongVector)[3], float scalar, unsigned int verts)
 {
-	unsigned int i = 0;
+	int i = 0;
 
-	for (i = 0; i < verts; i++) {
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		mul_fvector_S(to[i], fLongVector[i], scalar);
 	}
 }
@@ -251,6 +258,31 @@ DO_INLINE float dot_lfvector(float (*fLongVectorA)[3], float (*fLongVectorB)[3],
 // different results each time you run it!
 // schedule(guided, 2)
 //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
+	// instead sum a fixed number of ranges in parallel and add those up in order,
+	// that gives the same result for any thread count
+	if (verts > CLOTH_DOT_PARTS * 128) {
+		float partial[CLOTH_DOT_PARTS];
+		int part;
+
+#pragma omp parallel for private(part)
+		for (part = 0; part < CLOTH_DOT_PARTS; part++) {
+			long start = ((long)verts * part) / CLOTH_DOT_PARTS;
+			long end = ((long)verts * (part + 1)) / CLOTH_DOT_PARTS;
+			long j;
+			float sum = 0.0f;
+
+			for (j = start; j < end; j++) {
+				sum += dot_v3v3(fLongVectorA[j], fLongVectorB[j]);
+			}
+			partial[part] = sum;
+		}
+
+		for (part = 0; part < CLOTH_DOT_PARTS; part++) {
+			temp += partial[part];
+		}
+		return temp;
+	}
+
 	for (i = 0; i < (long)verts; i++) {
 		temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
 	}
@@ -259,9 +291,10 @@ DO_INLINE float dot_lfvector(float (*fLongVectorA)[3], float (*fLongVectorB)[3],
 /* A = B + C  --> for big vector */
 DO_INLINE void add_lfvector_lfvector(float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], unsigned int verts)
 {
-	unsigned int i = 0;
+	int i = 0;
 
-	for (i = 0; i < verts; i++) {
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		VECADD(to[i], fLongVectorA[i], fLongVectorB[i]);
 	}
 
@@ -269,9 +302,10 @@ DO_INLINE void add_lfvector_lfvector(float (*to)[3], float (*fLongVectorA)[3], f
 /* A = B + C * float --> for big vector */
 DO_INLINE void add_lfvector_lfvectorS(float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], float bS, unsigned int verts)
 {
-	unsigned int i = 0;
+	int i = 0;
 
-	for (i = 0; i < verts; i++) {
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
 
 	}
@@ -279,17 +313,20 @@ DO_INLINE void add_lfvector_lfvectorS(float (*to)[3], float (*fLongVectorA)[3],
 /* A = B * float + C * float --> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3], float (*fLongVectorA)[3], float aS, float (*fLongVectorB)[3], float bS, unsigned int verts)
 {
-	unsigned int i = 0;
+	int i = 0;
 
-	for (i = 0; i < verts; i++) {
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		VECADDSS(to[i], fLongVectorA[i], aS, fLongVectorB[i], bS);
 	}
 }
 /* A = B - C * float --> for big vector */
 DO_INLINE void sub_lfvector_lfvectorS(float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], float bS, unsigned int verts)
 {
-	unsigned int i = 0;
-	for (i = 0; i < verts; i++) {
+	int i = 0;
+
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		VECSUBS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
 	}
 
@@ -297,9 +334,10 @@ DO_INLINE void sub_lfvector_lfvectorS(float (*to)[3], float (*fLongVectorA)[3],
 /* A = B - C --> for big vector */
 DO_INLINE void sub_lfvector_lfvector(float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], unsigned int verts)
 {
-	unsigned int i = 0;
+	int i = 0;
 
-	for (i = 0; i < verts; i++) {
+#pragma omp parallel for private(i) if (verts > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < (int)verts; i++) {
 		sub_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
 	}
 
@@ -505,6 +543,15 @@ DO_INLINE void mulsub_fmatrix_fvector(float to[3], float matrix[3][3], float fro
 ///////////////////////////
 // SPARSE SYMMETRIC big matrix with 3x3 matrix entries
 ///////////////////////////
+/* For every vertex the off-diagonal (spring) blocks touching it, CSR style.
+ * An entry is (spring << 1) | side, side 0 meaning the vertex is the block
+ * row (spring->ij), side 1 meaning it is the block column (spring->kl).
+ * The diagonal block of vertex i is always entry i of the big matrix. */
+typedef struct BlockRows {
+	unsigned int *start; /* vcount + 1 offsets into entry */
+	unsigned int *entry; /* 2 * scount entries */
+} BlockRows;
+
 /* printf a big matrix on console: for debug output */
 #if 0
 static void print_bfmatrix(fmatrix3x3 *m3)
@@ -535,6 +582,46 @@ DO_INLINE void del_bfmatrix(fmatrix3x3 *matrix)
 	}
 }
 
+/* build block rows from the r/c layout of a big matrix */
+static BlockRows *create_blockrows(fmatrix3x3 *matrix)
+{
+	unsigned int vcount = matrix[0].vcount, scount = matrix[0].scount;
+	unsigned int i;
+	unsigned int *fill;
+	BlockRows *rows = (BlockRows *)MEM_callocN(sizeof(BlockRows), "cloth_implicit_blockrows");
+
+	rows->start = (unsigned int *)MEM_callocN(sizeof(unsigned int) * (vcount + 1), "cloth_implicit_blockrows_start");
+	rows->entry = (unsigned int *)MEM_callocN(sizeof(unsigned int) * (2 * scount + 1), "cloth_implicit_blockrows_entry");
+	fill = (unsigned int *)MEM_callocN(sizeof(unsigned int) * (vcount + 1), "cloth_implicit_blockrows_fill");
+
+	for (i = 0; i < scount; i++) {
+		rows->start[matrix[vcount + i].r + 1]++;
+		rows->start[matrix[vcount + i].c + 1]++;
+	}
+	for (i = 0; i < vcount; i++) {
+		rows->start[i + 1] += rows->start[i];
+	}
+
+	memcpy(fill, rows->start, sizeof(unsigned int) * (vcount + 1));
+	for (i = 0; i < scount; i++) {
+		rows->entry[fill[matrix[vcount + i].r]++] = (i << 1);
+		rows->entry[fill[matrix[vcount + i].c]++] = (i << 1) | 1;
+	}
+
+	MEM_freeN(fill);
+
+	return rows;
+}
+
+DO_INLINE void del_blockrows(BlockRows *rows)
+{
+	if (rows != NULL) {
+		MEM_freeN(rows->start);
+		MEM_freeN(rows->entry);
+		MEM_freeN(rows);
+	}
+}
+
 /* copy big matrix */
 DO_INLINE void cp_bfmatrix(fmatrix3x3 *to, fmatrix3x3 *from)
 {
@@ -579,34 +666,27 @@ DO_INLINE void mul_bfmatrix_S(fmatrix3x3 *matrix, float scalar)
 
 /* SPARSE SYMMETRIC multiply big matrix with long vector*/
 /* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector( float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/* every row is gathered on its own through the block rows, so rows
+ * can be done in parallel without write conflicts */
+DO_INLINE void mul_bfmatrix_lfvector( float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector, BlockRows *rows)
 {
-	unsigned int i = 0;
+	int i = 0;
 	unsigned int vcount = from[0].vcount;
-	lfVector *temp = create_lfvector(vcount);
-	
-	zero_lfvector(to, vcount);
 
-#pragma omp parallel sections private(i) if (vcount > CLOTH_OPENMP_LIMIT)
-	{
-#pragma omp section
-		{
-			for (i = from[0].vcount; i < from[0].vcount+from[0].scount; i++) {
-				muladd_fmatrix_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-			}
-		}
-#pragma omp section
-		{
-			for (i = 0; i < from[0].vcount+from[0].scount; i++) {
-				muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
-			}
+#pragma omp parallel for private(i) schedule(static) if (vcount > CLOTH_OPENMP_LIMIT)
+	for (i = 0; i < (int)vcount; i++) {
+		unsigned int j;
+
+		mul_fmatrix_fvector(to[i], from[i].m, fLongVector[i]);
+
+		for (j = rows->start[i]; j < rows->start[i + 1]; j++) {
+			unsigned int entry = rows->entry[j];
+			fmatrix3x3 *block = &from[vcount + (entry >> 1)];
+
+			/* use the vector value at the other end of the spring */
+			muladd_fmatrix_fvector(to[i], block->m, fLongVector[(entry & 1) ? block->r : block->c]);
 		}
 	}
-	add_lfvector_lfvector(to, to, temp, from[0].vcount);
-	
-	del_lfvector(temp);
-	
-	
 }
 
 /* SPARSE SYMMETRIC multiply big matrix with long vector (for diagonal preconditioner) */
@@ -691,10 +771,12 @@ DO_INLINE void addsub_bfmatrix_bfmatrix( fmatrix3x3 *to, fmatrix3x3 *from,  fmat
 /* VERIFIED */
 DO_INLINE void subadd_bfmatrixS_bfmatrixS( fmatrix3x3 *to, fmatrix3x3 *from, float aS,  fmatrix3x3 *matrix, float bS)
 {
-	unsigned int i = 0;
+	int i = 0;
+	int count = matrix[0].vcount + matrix[0].scount;
 
 	/* process diagonal elements */
-	for (i = 0; i < matrix[0].vcount+matrix[0].scount; i++) {
+#pragma omp parallel for private(i) if (count > CLOTH_OPENMP_VECTOR_LIMIT)
+	for (i = 0; i < count; i++) {
 		subadd_fmatrixS_fmatrixS(to[i].m, from[i].m, aS, matrix[i].m, bS);
 	}
 
@@ -706,6 +788,8 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS( fmatrix3x3 *to, fmatrix3x3 *from, flo
 typedef struct Implicit_Data  {
 	lfVector *X, *V, *Xnew, *Vnew, *olddV, *F, *B, *dV, *z;
 	fmatrix3x3 *A, *dFdV, *dFdX, *S, *P, *Pinv, *bigI, *M; 
+	BlockRows *rows; /* shared layout of the big matrices */
+	ClothSpring **springs; /* springs by matrix_index - numverts */
 } Implicit_Data;
 
 /* Init constraint matrix */
@@ -772,6 +856,7 @@ int implicit_init(Object *UNUSED(ob), ClothModifierData *clmd)
 	id->B = create_lfvector(cloth->numverts);
 	id->dV = create_lfvector(cloth->numverts);
 	id->z = create_lfvector(cloth->numverts);
+	id->springs = (ClothSpring **)MEM_callocN(sizeof(ClothSpring *) * (cloth->numsprings + 1), "cloth_implicit_springs");
 	
 	id->S[0].vcount = 0;
 
@@ -797,9 +882,12 @@ int implicit_init(Object *UNUSED(ob), ClothModifierData *clmd)
 				id->P[i+cloth->numverts].c = id->Pinv[i+cloth->numverts].c = id->bigI[i+cloth->numverts].c = id->M[i+cloth->numverts].c = spring->kl;
 
 		spring->matrix_index = i + cloth->numverts;
+		id->springs[i] = spring;
 		
 		search = search->next;
 	}
+
+	id->rows = create_blockrows(id->A);
 	
 	initdiag_bfmatrix(id->bigI, I);
 
@@ -839,6 +927,9 @@ int	implicit_free(ClothModifierData *clmd)
 			del_lfvector(id->dV);
 			del_lfvector(id->z);
 
+			del_blockrows(id->rows);
+			MEM_freeN(id->springs);
+
 			MEM_freeN(id);
 		}
 	}
@@ -893,7 +984,7 @@ DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
 	}
 }
 
-static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z, fmatrix3x3 *S)
+static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z, fmatrix3x3 *S, BlockRows *rows)
 {
 	// Solves for unknown X in equation AX=B
 	unsigned int conjgrad_loopcount=0, conjgrad_looplimit=100;
@@ -913,7 +1004,7 @@ static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z
 
 	// r = B - Mul(tmp, A, X);    // just use B if X known to be zero
 	cp_lfvector(r, lB, numverts);
-	mul_bfmatrix_lfvector(tmp, lA, ldV);
+	mul_bfmatrix_lfvector(tmp, lA, ldV, rows);
 	sub_lfvector_lfvector(r, r, tmp, numverts);
 
 	filter(r, S);
@@ -925,7 +1016,7 @@ static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z
 
 	while (s>starget && conjgrad_loopcount < conjgrad_looplimit) {
 		// Mul(q, A, d); // q = A*d;
-		mul_bfmatrix_lfvector(q, lA, d);
+		mul_bfmatrix_lfvector(q, lA, d, rows);
 
 		filter(q, S);
 
@@ -1335,26 +1426,49 @@ DO_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s,
 	}
 }
 
-DO_INLINE void cloth_apply_spring_force(ClothModifierData *UNUSED(clmd), ClothSpring *s, lfVector *lF, lfVector *UNUSED(X), lfVector *UNUSED(V), fmatrix3x3 *dFdV, fmatrix3x3 *dFdX)
+/* the off-diagonal blocks belong to one spring only */
+DO_INLINE void cloth_apply_spring_force(ClothSpring *s, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX)
 {
 	if (s->flags & CLOTH_SPRING_FLAG_NEEDED) {
 		if (!(s->type & CLOTH_SPRING_TYPE_BENDING)) {
-			sub_fmatrix_fmatrix(dFdV[s->ij].m, dFdV[s->ij].m, s->dfdv);
-			sub_fmatrix_fmatrix(dFdV[s->kl].m, dFdV[s->kl].m, s->dfdv);
 			add_fmatrix_fmatrix(dFdV[s->matrix_index].m, dFdV[s->matrix_index].m, s->dfdv);
 		}
 
-		VECADD(lF[s->ij], lF[s->ij], s->f);
-		
-		if (!(s->type & CLOTH_SPRING_TYPE_GOAL))
-			sub_v3_v3v3(lF[s->kl], lF[s->kl], s->f);
-		
-		sub_fmatrix_fmatrix(dFdX[s->kl].m, dFdX[s->kl].m, s->dfdx);
-		sub_fmatrix_fmatrix(dFdX[s->ij].m, dFdX[s->ij].m, s->dfdx);
 		add_fmatrix_fmatrix(dFdX[s->matrix_index].m, dFdX[s->matrix_index].m, s->dfdx);
 	}
 }
 
+/* sum force and diagonal blocks of vertex i over the springs touching it,
+ * so vertices can be done in parallel */
+DO_INLINE void cloth_gather_spring_force(unsigned int i, BlockRows *rows, ClothSpring **springs, lfVector *lF, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX)
+{
+	unsigned int j;
+
+	for (j = rows->start[i]; j < rows->start[i + 1]; j++) {
+		unsigned int entry = rows->entry[j];
+		ClothSpring *s = springs[entry >> 1];
+
+		if ((s->flags & CLOTH_SPRING_FLAG_DEACTIVATE) || !(s->flags & CLOTH_SPRING_FLAG_NEEDED))
+			continue;
+
+		if (!(s->type & CLOTH_SPRING_TYPE_BENDING)) {
+			sub_fmatrix_fmatrix(dFdV[i].m, dFdV[i].m, s->dfdv);
+		}
+
+		if (entry & 1) {
+			/* vertex is s->kl */
+			if (!(s->type & CLOTH_SPRING_TYPE_GOAL))
+				sub_v3_v3v3(lF[i], lF[i], s->f);
+		}
+		else {
+			/* vertex is s->ij */
+			VECADD(lF[i], lF[i], s->f);
+		}
+
+		sub_fmatrix_fmatrix(dFdX[i].m, dFdX[i].m, s->dfdx);
+	}
+}
+
 
 static void CalcFloat( float *v1, float *v2, float *v3, float *n)
 {
@@ -1534,7 +1648,7 @@ static void hair_velocity_smoothing(ClothModifierData *clmd, lfVector *lF, lfVec
 	free_collider_cache(&colliders);
 }
 
-static void cloth_calc_force(ClothModifierData *clmd, float UNUSED(frame), lfVector *lF, lfVector *lX, lfVector *lV, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX, ListBase *effectors, float time, fmatrix3x3 *M)
+static void cloth_calc_force(ClothModifierData *clmd, float UNUSED(frame), lfVector *lF, lfVector *lX, lfVector *lV, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX, ListBase *effectors, float time, fmatrix3x3 *M, BlockRows *rows, ClothSpring **springs)
 {
 	/* Collect forces and derivatives:  F, dFdX, dFdV */
 	Cloth 		*cloth 		= clmd->clothObject;
@@ -1544,6 +1658,8 @@ static void cloth_calc_force(ClothModifierData *clmd, float UNUSED(frame), lfVec
 	float 		tm2[3][3] 	= {{0}};
 	MFace 		*mfaces 	= cloth->mfaces;
 	unsigned int numverts = cloth->numverts;
+	int numsprings = cloth->numsprings;
+	int k;
 	LinkNode *search;
 	lfVector *winvec;
 	EffectedPoint epoint;
@@ -1661,30 +1777,26 @@ static void cloth_calc_force(ClothModifierData *clmd, float UNUSED(frame), lfVec
 		del_lfvector(winvec);
 	}
 		
-	// calculate spring forces
-	search = cloth->springs;
-	while (search) {
+	// calculate spring forces, each spring only writes to itself
+#pragma omp parallel for private(k) schedule(static) if (numsprings > CLOTH_OPENMP_LIMIT)
+	for (k = 0; k < numsprings; k++) {
 		// only handle active springs
-		ClothSpring *spring = search->link;
-		if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE))
-			cloth_calc_spring_force(clmd, search->link, lF, lX, lV, dFdV, dFdX, time);
-
-		search = search->next;
+		ClothSpring *spring = springs[k];
+		if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+			cloth_calc_spring_force(clmd, spring, lF, lX, lV, dFdV, dFdX, time);
+			cloth_apply_spring_force(spring, dFdV, dFdX);
+		}
 	}
 	
-	// apply spring forces
-	search = cloth->springs;
-	while (search) {
-		// only handle active springs
-		ClothSpring *spring = search->link;
-		if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE))
-			cloth_apply_spring_force(clmd, search->link, lF, lX, lV, dFdV, dFdX);
-		search = search->next;
+	// apply spring forces to the vertices
+#pragma omp parallel for private(k) schedule(static) if (numverts > CLOTH_OPENMP_LIMIT)
+	for (k = 0; k < (int)numverts; k++) {
+		cloth_gather_spring_force(k, rows, springs, lF, dFdV, dFdX);
 	}
 	// printf("\n");
 }
 
-static void simulate_implicit_euler(lfVector *Vnew, lfVector *UNUSED(lX), lfVector *lV, lfVector *lF, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX, float dt, fmatrix3x3 *A, lfVector *B, lfVector *dV, fmatrix3x3 *S, lfVector *z, lfVector *olddV, fmatrix3x3 *UNUSED(P), fmatrix3x3 *UNUSED(Pinv), fmatrix3x3 *M, fmatrix3x3 *UNUSED(bigI))
+static void simulate_implicit_euler(lfVector *Vnew, lfVector *UNUSED(lX), lfVector *lV, lfVector *lF, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX, float dt, fmatrix3x3 *A, lfVector *B, lfVector *dV, fmatrix3x3 *S, lfVector *z, lfVector *olddV, fmatrix3x3 *UNUSED(P), fmatrix3x3 *UNUSED(Pinv), fmatrix3x3 *M, fmatrix3x3 *UNUSED(bigI), BlockRows *rows)
 {
 	unsigned int numverts = dFdV[0].vcount;
 
@@ -1695,13 +1807,13 @@ static void simulate_implicit_euler(lfVector *Vnew, lfVector *UNUSED(lX), lfVect
 	
 	subadd_bfmatrixS_bfmatrixS(A, dFdV, dt, dFdX, (dt*dt));
 
-	mul_bfmatrix_lfvector(dFdXmV, dFdX, lV);
+	mul_bfmatrix_lfvector(dFdXmV, dFdX, lV, rows);
 
 	add_lfvectorS_lfvectorS(B, lF, dt, dFdXmV, (dt*dt), numverts);
 
 	// itstart();
 
-	cg_filtered(dV, A, B, z, S); /* conjugate gradient algorithm to solve Ax=b */
+	cg_filtered(dV, A, B, z, S, rows); /* conjugate gradient algorithm to solve Ax=b */
 	// cg_filtered_pre(dV, A, B, z, S, P, Pinv, bigI);
 
 	// itend();
@@ -1826,10 +1938,10 @@ int implicit_solver(Object *ob, float frame, ClothModifierData *clmd, ListBase *
 		mul_lfvectorS(id->V, id->V, clmd->sim_parms->vel_damping, numverts);
 
 		// calculate forces
-		cloth_calc_force(clmd, frame, id->F, id->X, id->V, id->dFdV, id->dFdX, effectors, step, id->M);
+		cloth_calc_force(clmd, frame, id->F, id->X, id->V, id->dFdV, id->dFdX, effectors, step, id->M, id->rows, id->springs);
 		
 		// calculate new velocity
-		simulate_implicit_euler(id->Vnew, id->X, id->V, id->F, id->dFdV, id->dFdX, dt, id->A, id->B, id->dV, id->S, id->z, id->olddV, id->P, id->Pinv, id->M, id->bigI);
+		simulate_implicit_euler(id->Vnew, id->X, id->V, id->F, id->dFdV, id->dFdX, dt, id->A, id->B, id->dV, id->S, id->z, id->olddV, id->P, id->Pinv, id->M, id->bigI, id->rows);
 		
 		// advance positions
 		add_lfvector_lfvectorS(id->Xnew, id->X, id->Vnew, dt, numverts);
@@ -1901,9 +2013,9 @@ int implicit_solver(Object *ob, float frame, ClothModifierData *clmd, ListBase *
 				cp_lfvector(id->V, id->Vnew, numverts);
 
 				// calculate 
-				cloth_calc_force(clmd, frame, id->F, id->X, id->V, id->dFdV, id->dFdX, effectors, step+dt, id->M);
+				cloth_calc_force(clmd, frame, id->F, id->X, id->V, id->dFdV, id->dFdX, effectors, step+dt, id->M, id->rows, id->springs);
 				
-				simulate_implicit_euler(id->Vnew, id->X, id->V, id->F, id->dFdV, id->dFdX, dt / 2.0f, id->A, id->B, id->dV, id->S, id->z, id->olddV, id->P, id->Pinv, id->M, id->bigI);
+				simulate_implicit_euler(id->Vnew, id->X, id->V, id->F, id->dFdV, id->dFdX, dt / 2.0f, id->A, id->B, id->dV, id->S, id->z, id->olddV, id->P, id->Pinv, id->M, id->bigI, id->rows);
 			}
 		}
 		else {
@@ -38,6 +38,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLF_translation.h"
@@ -779,6 +780,7 @@ void BKE_key_evaluate_relative(const int start, int end, const int tot, char *ba
 				poin += start * poinsize;
 				reffrom += key->elemsize * start;  // key elemsize yes!
 				from += key->elemsize * start;
+				if (weights) weights += start;
 				
 				for (b = start; b < end; b++) {
 				
@@ -1171,6 +1173,22 @@ void BKE_keyblock_free_per_block_weights(Key *key, float **per_keyblock_weights,
 	MEM_freeN(per_keyblock_weights);
 }
 
+typedef struct KeyEvaluateRelativeData {
+	Key *key;
+	KeyBlock *actkb;
+	float **per_keyblock_weights;
+	char *out;
+	int tot;
+} KeyEvaluateRelativeData;
+
+static void key_evaluate_relative_range(void *userdata, int start, int stop)
+{
+	KeyEvaluateRelativeData *data = userdata;
+
+	BKE_key_evaluate_relative(start, stop, data->tot, data->out, data->key, data->actkb,
+	                          data->per_keyblock_weights, KEY_MODE_DUMMY);
+}
+
 static void do_mesh_key(Scene *scene, Object *ob, Key *key, char *out, const int tot)
 {
 	KeyBlock *k[4], *actkb = BKE_keyblock_from_object(ob);
@@ -1206,7 +1224,23 @@ static void do_mesh_key(Scene *scene, Object *ob, Key *key, char *out, const int
 			WeightsArrayCache cache = {0, NULL};
 			float **per_keyblock_weights;
 			per_keyblock_weights = BKE_keyblock_get_per_block_weights(ob, key, &cache);
-			BKE_key_evaluate_relative(0, tot, tot, (char *)out, key, actkb, per_keyblock_weights, KEY_MODE_DUMMY);
+
+			/* in edit mode the active block is copied from the edit mesh for
+			 * every call, so only split up the vertices in object mode */
+			if (((Mesh *)ob->data)->edit_btmesh == NULL) {
+				KeyEvaluateRelativeData data;
+
+				data.key = key;
+				data.actkb = actkb;
+				data.per_keyblock_weights = per_keyblock_weights;
+				data.out = out;
+				data.tot = tot;
+
+				BLI_task_parallel_range(0, tot, &data, key_evaluate_relative_range);
+			}
+			else {
+				BKE_key_evaluate_relative(0, tot, tot, (char *)out, key, actkb, per_keyblock_weights, KEY_MODE_DUMMY);
+			}
 			BKE_keyblock_free_per_block_weights(key, per_keyblock_weights, &cache);
 		}
 		else {
@@ -38,6 +38,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -765,28 +766,25 @@ void curve_deform_verts(Scene *scene, Object *cuOb, Object *target,
 		}
 	}
 	else {
+		mul_m4_v3_array(cd.curvespace, vertexCos, numVerts);
+
 		if (cu->flag & CU_DEFORM_BOUNDS_OFF) {
 			for (a = 0; a < numVerts; a++) {
-				mul_m4_v3(cd.curvespace, vertexCos[a]);
 				calc_curve_deform(scene, cuOb, vertexCos[a], defaxis, &cd, NULL);
-				mul_m4_v3(cd.objectspace, vertexCos[a]);
 			}
 		}
 		else {
 			/* set mesh min max bounds */
 			INIT_MINMAX(cd.dmin, cd.dmax);
-				
-			for (a = 0; a < numVerts; a++) {
-				mul_m4_v3(cd.curvespace, vertexCos[a]);
-				minmax_v3v3_v3(cd.dmin, cd.dmax, vertexCos[a]);
-			}
+			minmax_v3_array(cd.dmin, cd.dmax, (const float (*)[3])vertexCos, numVerts);
 	
 			for (a = 0; a < numVerts; a++) {
-				/* already in 'cd.curvespace', prev for loop */
+				/* already in 'cd.curvespace', above */
 				calc_curve_deform(scene, cuOb, vertexCos[a], defaxis, &cd, NULL);
-				mul_m4_v3(cd.objectspace, vertexCos[a]);
 			}
 		}
+
+		mul_m4_v3_array(cd.objectspace, vertexCos, numVerts);
 	}
 	cu->flag = flag;
 }
@@ -826,11 +824,44 @@ void curve_deform_vector(Scene *scene, Object *cuOb, Object *target,
 
 }
 
+typedef struct LatticeDeformVertsData {
+	LatticeDeformData *lattice_deform_data;
+	DerivedMesh *dm;
+	MDeformVert *dvert;
+	float (*vertexCos)[3];
+	int defgrp_index;
+	float fac;
+} LatticeDeformVertsData;
+
+static void lattice_deform_verts_range(void *userdata, int start, int stop)
+{
+	LatticeDeformVertsData *data = userdata;
+	int a;
+
+	if (data->defgrp_index >= 0) {
+		MDeformVert *dvert;
+		float weight;
+
+		for (a = start; a < stop; a++) {
+			dvert = (data->dm) ? data->dm->getVertData(data->dm, a, CD_MDEFORMVERT) : data->dvert + a;
+			weight = defvert_find_weight(dvert, data->defgrp_index);
+
+			if (weight > 0.0f)
+				calc_latt_deform(data->lattice_deform_data, data->vertexCos[a], weight * data->fac);
+		}
+	}
+	else {
+		for (a = start; a < stop; a++) {
+			calc_latt_deform(data->lattice_deform_data, data->vertexCos[a], data->fac);
+		}
+	}
+}
+
 void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
                           float (*vertexCos)[3], int numVerts, const char *vgroup, float fac)
 {
 	LatticeDeformData *lattice_deform_data;
-	int a;
+	LatticeDeformVertsData data;
 	int use_vgroups;
 
 	if (laOb->type != OB_LATTICE)
@@ -856,29 +887,30 @@ void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
 		use_vgroups = FALSE;
 	}
 	
+	data.lattice_deform_data = lattice_deform_data;
+	data.dm = dm;
+	data.dvert = NULL;
+	data.vertexCos = vertexCos;
+	data.defgrp_index = -1;
+	data.fac = fac;
+
 	if (vgroup && vgroup[0] && use_vgroups) {
 		Mesh *me = target->data;
 		const int defgrp_index = defgroup_name_index(target, vgroup);
-		float weight;
-
-		if (defgrp_index >= 0 && (me->dvert || dm)) {
-			MDeformVert *dvert = me->dvert;
-			
-			for (a = 0; a < numVerts; a++, dvert++) {
-				if (dm) dvert = dm->getVertData(dm, a, CD_MDEFORMVERT);
 
-				weight = defvert_find_weight(dvert, defgrp_index);
-
-				if (weight > 0.0f)
-					calc_latt_deform(lattice_deform_data, vertexCos[a], weight * fac);
-			}
-		}
-	}
-	else {
-		for (a = 0; a < numVerts; a++) {
-			calc_latt_deform(lattice_deform_data, vertexCos[a], fac);
+		/* vertices are only deformed when they are in the group */
+		if (defgrp_index < 0 || !(me->dvert || dm)) {
+			end_latt_deform(lattice_deform_data);
+			return;
 		}
+
+		data.dvert = me->dvert;
+		data.defgrp_index = defgrp_index;
 	}
+
+	/* vertices are deformed independently, the lattice is only read */
+	BLI_task_parallel_range(0, numVerts, &data, lattice_deform_verts_range);
+
 	end_latt_deform(lattice_deform_data);
 }
 
@@ -42,10 +42,11 @@
 #include "BLI_math.h"
 #include "BLI_edgehash.h"
 #include "BLI_bitmap.h"
-#include "BLI_scanfill.h"
+#include "BLI_polyfill2d.h"
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_alloca.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -53,6 +54,8 @@
 
 #include "BLI_strict_flags.h"
 
+#include "atomic_ops.h"
+
 
 // #define DEBUG_TIME
 
@@ -159,8 +162,10 @@ void BKE_mesh_calc_normals_mapping_ex(
 	
 }
 
-static void mesh_calc_normals_poly_accum(MPoly *mp, MLoop *ml,
-                                         MVert *mvert, float polyno[3], float (*tnorms)[3])
+/* poly normal and the angle weights of its corners, kept apart from the
+ * accumulation so polys can be processed in parallel */
+static void mesh_calc_normals_poly_weights(MPoly *mp, MLoop *ml,
+                                           MVert *mvert, float polyno[3], float *loop_weights)
 {
 	const int nverts = mp->totloop;
 	float (*edgevecbuf)[3] = BLI_array_alloca(edgevecbuf, (size_t)nverts);
@@ -191,7 +196,7 @@ static void mesh_calc_normals_poly_accum(MPoly *mp, MLoop *ml,
 		}
 	}
 
-	/* accumulate angle weighted face normal */
+	/* angle weights of the face normal */
 	/* inline version of #accumulate_vertex_normals_poly */
 	{
 		const float *prev_edge = edgevecbuf[nverts - 1];
@@ -201,23 +206,90 @@ static void mesh_calc_normals_poly_accum(MPoly *mp, MLoop *ml,
 
 			/* calculate angle between the two poly edges incident on
 			 * this vertex */
-			const float fac = saacos(-dot_v3v3(cur_edge, prev_edge));
-
-			/* accumulate */
-			madd_v3_v3fl(tnorms[ml[i].v], polyno, fac);
+			loop_weights[i] = saacos(-dot_v3v3(cur_edge, prev_edge));
 			prev_edge = cur_edge;
 		}
 	}
+}
+
+typedef struct MeshCalcNormalsData {
+	MVert *mverts;
+	MLoop *mloop;
+	MPoly *mpolys;
+	float (*pnors)[3];
+	float (*tnorms)[3];
+	float *loop_weights;
+} MeshCalcNormalsData;
+
+static void mesh_calc_normals_poly_weights_cb(void *userdata, int start, int stop)
+{
+	MeshCalcNormalsData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		MPoly *mp = &data->mpolys[i];
+		mesh_calc_normals_poly_weights(mp, data->mloop + mp->loopstart, data->mverts,
+		                               data->pnors[i], data->loop_weights + mp->loopstart);
+	}
+}
 
+/* lock-free float add, a vertex is shared by polys which may be accumulated on other threads */
+BLI_INLINE void mesh_atomic_add_fl(float *p, const float x)
+{
+	union { uint32_t u; float f; } oldval, newval;
+
+	do {
+		oldval.f = *p;
+		newval.f = oldval.f + x;
+	} while (atomic_cas_uint32((uint32_t *)p, oldval.u, newval.u) != oldval.u);
+}
+
+static void mesh_calc_normals_poly_accum_cb(void *userdata, int start, int stop)
+{
+	MeshCalcNormalsData *data = userdata;
+	int i, j;
+
+	for (i = start; i < stop; i++) {
+		const MPoly *mp = &data->mpolys[i];
+		const MLoop *ml = data->mloop + mp->loopstart;
+		const float *loop_weights = data->loop_weights + mp->loopstart;
+		const float *pno = data->pnors[i];
+
+		for (j = 0; j < mp->totloop; j++) {
+			float *no = data->tnorms[ml[j].v];
+
+			mesh_atomic_add_fl(&no[0], pno[0] * loop_weights[j]);
+			mesh_atomic_add_fl(&no[1], pno[1] * loop_weights[j]);
+			mesh_atomic_add_fl(&no[2], pno[2] * loop_weights[j]);
+		}
+	}
+}
+
+static void mesh_calc_normals_vert_cb(void *userdata, int start, int stop)
+{
+	MeshCalcNormalsData *data = userdata;
+	int i;
+
+	/* following Mesh convention; we use vertex coordinate itself for normal in this case */
+	for (i = start; i < stop; i++) {
+		MVert *mv = &data->mverts[i];
+		float *no = data->tnorms[i];
+
+		if (UNLIKELY(normalize_v3(no) == 0.0f)) {
+			normalize_v3_v3(no, mv->co);
+		}
+
+		normal_float_to_short_v3(mv->no, no);
+	}
 }
 
 void BKE_mesh_calc_normals_poly(MVert *mverts, int numVerts, MLoop *mloop, MPoly *mpolys,
-                                int UNUSED(numLoops), int numPolys, float (*r_polynors)[3],
+                                int numLoops, int numPolys, float (*r_polynors)[3],
                                 const bool only_face_normals)
 {
+	MeshCalcNormalsData data;
 	float (*pnors)[3] = r_polynors;
-	float (*tnorms)[3];
-	int i;
+	int i, j;
 	MPoly *mp;
 
 	if (only_face_normals) {
@@ -230,36 +302,41 @@ void BKE_mesh_calc_normals_poly(MVert *mverts, int numVerts, MLoop *mloop, MPoly
 		return;
 	}
 
+	if (!pnors)
+		pnors = MEM_mallocN(sizeof(*pnors) * (size_t)numPolys, __func__);
+
+	data.mverts = mverts;
+	data.mloop = mloop;
+	data.mpolys = mpolys;
+	data.pnors = pnors;
+	data.tnorms = MEM_callocN(sizeof(*data.tnorms) * (size_t)numVerts, __func__);
+	data.loop_weights = MEM_mallocN(sizeof(*data.loop_weights) * (size_t)numLoops, __func__);
+
 	/* first go through and calculate normals for all the polys */
-	tnorms = MEM_callocN(sizeof(*tnorms) * (size_t)numVerts, __func__);
+	BLI_task_parallel_range_ex(0, numPolys, &data, mesh_calc_normals_poly_weights_cb, BKE_MESH_OMP_LIMIT);
 
-	if (pnors) {
-		mp = mpolys;
-		for (i = 0; i < numPolys; i++, mp++) {
-			mesh_calc_normals_poly_accum(mp, mloop + mp->loopstart, mverts, pnors[i], tnorms);
-		}
+	/* then add them to their vertices, polys share vertices so large meshes
+	 * accumulate with atomics, small ones don't need the overhead */
+	if (numPolys > BKE_MESH_OMP_LIMIT) {
+		BLI_task_parallel_range_ex(0, numPolys, &data, mesh_calc_normals_poly_accum_cb, BKE_MESH_OMP_LIMIT);
 	}
 	else {
-		float tpnor[3];  /* temp poly normal */
-		mp = mpolys;
-		for (i = 0; i < numPolys; i++, mp++) {
-			mesh_calc_normals_poly_accum(mp, mloop + mp->loopstart, mverts, tpnor, tnorms);
-		}
-	}
+		for (i = 0, mp = mpolys; i < numPolys; i++, mp++) {
+			const MLoop *ml = mloop + mp->loopstart;
+			const float *loop_weights = data.loop_weights + mp->loopstart;
 
-	/* following Mesh convention; we use vertex coordinate itself for normal in this case */
-	for (i = 0; i < numVerts; i++) {
-		MVert *mv = &mverts[i];
-		float *no = tnorms[i];
-
-		if (UNLIKELY(normalize_v3(no) == 0.0f)) {
-			normalize_v3_v3(no, mv->co);
+			for (j = 0; j < mp->totloop; j++) {
+				madd_v3_v3fl(data.tnorms[ml[j].v], pnors[i], loop_weights[j]);
+			}
 		}
-
-		normal_float_to_short_v3(mv->no, no);
 	}
 
-	MEM_freeN(tnorms);
+	BLI_task_parallel_range_ex(0, numVerts, &data, mesh_calc_normals_vert_cb, BKE_MESH_OMP_LIMIT);
+
+	MEM_freeN(data.tnorms);
+	MEM_freeN(data.loop_weights);
+	if (pnors != r_polynors)
+		MEM_freeN(pnors);
 }
 
 void BKE_mesh_calc_normals(Mesh *mesh)
@@ -1290,7 +1367,7 @@ int BKE_mesh_recalc_tessellation(CustomData *fdata,
 #define USE_TESSFACE_SPEEDUP
 #define USE_TESSFACE_QUADS // NEEDS FURTHER TESTING
 
-#define TESSFACE_SCANFILL (1 << 0)
+#define TESSFACE_SCANFILL (1 << 0)  /* ngon, filled with polyfill */
 #define TESSFACE_IS_QUAD  (1 << 1)
 
 	const int looptris_tot = poly_to_tri_count(totpoly, totloop);
@@ -1298,13 +1375,10 @@ int BKE_mesh_recalc_tessellation(CustomData *fdata,
 	MPoly *mp, *mpoly;
 	MLoop *ml, *mloop;
 	MFace *mface, *mf;
-	ScanFillContext sf_ctx;
-	ScanFillVert *sf_vert, *sf_vert_last, *sf_vert_first;
-	ScanFillFace *sf_tri;
-	MemArena *sf_arena = NULL;
+	MemArena *arena = NULL;
 	int *mface_to_poly_map;
 	int lindex[4]; /* only ever use 3 in this case */
-	int poly_index, j, mface_index;
+	int poly_index, mface_index;
 
 	const int numTex = CustomData_number_of_layers(pdata, CD_MTEXPOLY);
 	const int numCol = CustomData_number_of_layers(ldata, CD_MLOOPCOL);
@@ -1375,60 +1449,49 @@ int BKE_mesh_recalc_tessellation(CustomData *fdata,
 		}
 #endif /* USE_TESSFACE_SPEEDUP */
 		else {
-#define USE_TESSFACE_CALCNORMAL
-
-			unsigned int totfilltri;
-
-#ifdef USE_TESSFACE_CALCNORMAL
+			const unsigned int mp_totloop = (unsigned int)mp->totloop;
+			const unsigned int totfilltri = mp_totloop - 2;
+			float (*projverts)[2];
+			unsigned int (*tris)[3];
+			float axis_mat[3][3];
 			float normal[3];
-			zero_v3(normal);
-#endif
-			ml = mloop + mp->loopstart;
+			const float *co_prev;
+			unsigned int k;
 
-			if (UNLIKELY(sf_arena == NULL)) {
-				sf_arena = BLI_memarena_new(BLI_SCANFILL_ARENA_SIZE, __func__);
+			if (UNLIKELY(arena == NULL)) {
+				arena = BLI_memarena_new(BLI_POLYFILL_ARENA_SIZE, __func__);
 			}
 
-			BLI_scanfill_begin_arena(&sf_ctx, sf_arena);
-			sf_vert_first = NULL;
-			sf_vert_last = NULL;
-			for (j = 0; j < mp->totloop; j++, ml++) {
-				sf_vert = BLI_scanfill_vert_add(&sf_ctx, mvert[ml->v].co);
-
-				sf_vert->keyindex = (unsigned int)(mp->loopstart + j);
+			projverts = BLI_memarena_alloc(arena, (int)(sizeof(*projverts) * mp_totloop));
+			tris = BLI_memarena_alloc(arena, (int)(sizeof(*tris) * totfilltri));
 
-				if (sf_vert_last) {
-					BLI_scanfill_edge_add(&sf_ctx, sf_vert_last, sf_vert);
-#ifdef USE_TESSFACE_CALCNORMAL
-					add_newell_cross_v3_v3v3(normal, sf_vert_last->co, sf_vert->co);
-#endif
-				}
-
-				if (!sf_vert_first)
-					sf_vert_first = sf_vert;
-				sf_vert_last = sf_vert;
+			/* the normal is only used to project the polygon */
+			zero_v3(normal);
+			ml = mloop + mp->loopstart;
+			co_prev = mvert[ml[mp_totloop - 1].v].co;
+			for (k = 0; k < mp_totloop; k++) {
+				add_newell_cross_v3_v3v3(normal, co_prev, mvert[ml[k].v].co);
+				co_prev = mvert[ml[k].v].co;
 			}
-			BLI_scanfill_edge_add(&sf_ctx, sf_vert_last, sf_vert_first);
-#ifdef USE_TESSFACE_CALCNORMAL
-			add_newell_cross_v3_v3v3(normal, sf_vert_last->co, sf_vert_first->co);
 			if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
 				normal[2] = 1.0f;
 			}
-			totfilltri = BLI_scanfill_calc_ex(&sf_ctx, 0, normal);
-#else
-			totfilltri = BLI_scanfill_calc(&sf_ctx, 0);
-#endif
-			BLI_assert(totfilltri <= (unsigned int)(mp->totloop - 2));
-			(void)totfilltri;
 
-			for (sf_tri = sf_ctx.fillfacebase.first; sf_tri; sf_tri = sf_tri->next, mf++) {
+			axis_dominant_v3_to_m3(axis_mat, normal);
+			for (k = 0; k < mp_totloop; k++) {
+				mul_v2_m3v3(projverts[k], axis_mat, mvert[ml[k].v].co);
+			}
+
+			BLI_polyfill_calc_arena((const float (*)[2])projverts, mp_totloop, 0, tris, arena);
+
+			for (k = 0; k < totfilltri; k++) {
 				mface_to_poly_map[mface_index] = poly_index;
 				mf = &mface[mface_index];
 
 				/* set loop indices, transformed to vert indices later */
-				mf->v1 = sf_tri->v1->keyindex;
-				mf->v2 = sf_tri->v2->keyindex;
-				mf->v3 = sf_tri->v3->keyindex;
+				mf->v1 = mp_loopstart + tris[k][0];
+				mf->v2 = mp_loopstart + tris[k][1];
+				mf->v3 = mp_loopstart + tris[k][2];
 				mf->v4 = 0;
 
 				mf->mat_nr = mp->mat_nr;
@@ -1441,15 +1504,13 @@ int BKE_mesh_recalc_tessellation(CustomData *fdata,
 				mface_index++;
 			}
 
-			BLI_scanfill_end_arena(&sf_ctx, sf_arena);
-
-#undef USE_TESSFACE_CALCNORMAL
+			BLI_memarena_clear(arena);
 		}
 	}
 
-	if (sf_arena) {
-		BLI_memarena_free(sf_arena);
-		sf_arena = NULL;
+	if (arena) {
+		BLI_memarena_free(arena);
+		arena = NULL;
 	}
 
 	CustomData_free(fdata, totface);
@@ -43,6 +43,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_pbvh.h"
@@ -60,6 +61,7 @@
 
 #include "CCGSubSurf.h"
 
+#include <limits.h>
 #include <math.h>
 #include <string.h>
 
@@ -1001,101 +1003,59 @@ static void grid_tangent_matrix(float mat[3][3], const CCGKey *key,
 /* XXX WARNING: subsurf elements from dm and oldGridData *must* be of the same format (size),
  *              because this code uses CCGKey's info from dm to access oldGridData's normals
  *              (through the call to grid_tangent_matrix())! */
-static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl)
+/* Grids are threaded per face when there are enough grid elements. */
+static int multires_task_threshold(int totelem)
 {
-	CCGDerivedMesh *ccgdm = (CCGDerivedMesh *)dm;
+	return (totelem >= CCG_OMP_LIMIT) ? 1 : INT_MAX;
+}
+
+typedef struct MultiresDispRunData {
+	DispOp op;
+	MPoly *mpoly;
+	MDisps *mdisps;
+	GridPaintMask *grid_paint_mask;
 	CCGElem **gridData, **subGridData;
-	CCGKey key;
-	MPoly *mpoly = me->mpoly;
-	MDisps *mdisps = CustomData_get_layer(&me->ldata, CD_MDISPS);
-	GridPaintMask *grid_paint_mask = NULL;
+	CCGKey *key;
 	int *gridOffset;
-	int i, k, /*numGrids, */ gridSize, dGridSize, dSkip;
-	int totloop, totpoly;
-	
-	/* this happens in the dm made by bmesh_mdisps_space_set */
-	if (dm2 && CustomData_has_layer(&dm2->loopData, CD_MDISPS)) {
-		mpoly = CustomData_get_layer(&dm2->polyData, CD_MPOLY);
-		mdisps = CustomData_get_layer(&dm2->loopData, CD_MDISPS);
-		totloop = dm2->numLoopData;
-		totpoly = dm2->numPolyData;
-	}
-	else {
-		totloop = me->totloop;
-		totpoly = me->totpoly;
-	}
-	
-	if (!mdisps) {
-		if (op == CALC_DISPLACEMENTS)
-			mdisps = CustomData_add_layer(&me->ldata, CD_MDISPS, CD_DEFAULT, NULL, me->totloop);
-		else
-			return;
-	}
-
-	/*numGrids = dm->getNumGrids(dm);*/ /*UNUSED*/
-	gridSize = dm->getGridSize(dm);
-	gridData = dm->getGridData(dm);
-	gridOffset = dm->getGridOffset(dm);
-	dm->getGridKey(dm, &key);
-	subGridData = (oldGridData) ? oldGridData : gridData;
-
-	dGridSize = multires_side_tot[totlvl];
-	dSkip = (dGridSize - 1) / (gridSize - 1);
-
-	/* multires paint masks */
-	if (key.has_mask)
-		grid_paint_mask = CustomData_get_layer(&me->ldata, CD_GRID_PAINT_MASK);
-
-	k = 0; /*current loop/mdisp index within the mloop array*/
-
-	#pragma omp parallel for private(i) if (totloop * gridSize * gridSize >= CCG_OMP_LIMIT)
-
-	for (i = 0; i < totpoly; ++i) {
-		const int numVerts = mpoly[i].totloop;
-		int S, x, y, gIndex = gridOffset[i];
-
-		for (S = 0; S < numVerts; ++S, ++gIndex, ++k) {
-			GridPaintMask *gpm = grid_paint_mask ? &grid_paint_mask[gIndex] : NULL;
-			MDisps *mdisp = &mdisps[mpoly[i].loopstart + S];
-			CCGElem *grid = gridData[gIndex];
-			CCGElem *subgrid = subGridData[gIndex];
-			float (*dispgrid)[3] = NULL;
+	int gridSize, dGridSize, dSkip;
+} MultiresDispRunData;
 
-			/* when adding new faces in edit mode, need to allocate disps */
-			if (!mdisp->disps)
-			#pragma omp critical
-			{
-				multires_reallocate_mdisps(totloop, mdisps, totlvl);
-			}
+static void multires_disp_run_cb(void *userdata, int start, int stop)
+{
+	MultiresDispRunData *data = userdata;
+	CCGKey *key = data->key;
+	const DispOp op = data->op;
+	const int gridSize = data->gridSize;
+	const int dGridSize = data->dGridSize;
+	const int dSkip = data->dSkip;
+	int i;
 
-			dispgrid = mdisp->disps;
+	for (i = start; i < stop; ++i) {
+		const int numVerts = data->mpoly[i].totloop;
+		int S, x, y, gIndex = data->gridOffset[i];
 
-			/* if needed, reallocate multires paint mask */
-			if (gpm && gpm->level < key.level) {
-				gpm->level = key.level;
-				#pragma omp critical
-				{
-					if (gpm->data)
-						MEM_freeN(gpm->data);
-					gpm->data = MEM_callocN(sizeof(float) * key.grid_area, "gpm.data");
-				}
-			}
+		for (S = 0; S < numVerts; ++S, ++gIndex) {
+			GridPaintMask *gpm = data->grid_paint_mask ? &data->grid_paint_mask[gIndex] : NULL;
+			MDisps *mdisp = &data->mdisps[data->mpoly[i].loopstart + S];
+			CCGElem *grid = data->gridData[gIndex];
+			CCGElem *subgrid = data->subGridData[gIndex];
+			float (*dispgrid)[3] = mdisp->disps;
 
 			for (y = 0; y < gridSize; y++) {
 				for (x = 0; x < gridSize; x++) {
-					float *co = CCG_grid_elem_co(&key, grid, x, y);
-					float *sco = CCG_grid_elem_co(&key, subgrid, x, y);
-					float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
+					float *co = CCG_grid_elem_co(key, grid, x, y);
+					float *sco = CCG_grid_elem_co(key, subgrid, x, y);
+					float *disp_data = dispgrid[dGridSize * y * dSkip + x * dSkip];
 					float mat[3][3], disp[3], d[3], mask;
 
 					/* construct tangent space matrix */
-					grid_tangent_matrix(mat, &key, x, y, subgrid);
+					grid_tangent_matrix(mat, key, x, y, subgrid);
 
 					switch (op) {
 						case APPLY_DISPLACEMENTS:
 							/* Convert displacement to object space
 							 * and add to grid points */
-							mul_v3_m3v3(disp, mat, data);
+							mul_v3_m3v3(disp, mat, disp_data);
 							add_v3_v3v3(co, sco, disp);
 							break;
 						case CALC_DISPLACEMENTS:
@@ -1103,14 +1063,14 @@ static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm
 							 * grid points and convert to tangent space */
 							sub_v3_v3v3(disp, co, sco);
 							invert_m3(mat);
-							mul_v3_m3v3(data, mat, disp);
+							mul_v3_m3v3(disp_data, mat, disp);
 							break;
 						case ADD_DISPLACEMENTS:
 							/* Convert subdivided displacements to tangent
 							 * space and add to the original displacements */
 							invert_m3(mat);
 							mul_v3_m3v3(d, mat, co);
-							add_v3_v3(data, d);
+							add_v3_v3(disp_data, d);
 							break;
 					}
 
@@ -1118,18 +1078,18 @@ static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm
 						switch (op) {
 							case APPLY_DISPLACEMENTS:
 								/* Copy mask from gpm to DM */
-								*CCG_grid_elem_mask(&key, grid, x, y) =
-								    paint_grid_paint_mask(gpm, key.level, x, y);
+								*CCG_grid_elem_mask(key, grid, x, y) =
+								    paint_grid_paint_mask(gpm, key->level, x, y);
 								break;
 							case CALC_DISPLACEMENTS:
 								/* Copy mask from DM to gpm */
-								mask = *CCG_grid_elem_mask(&key, grid, x, y);
+								mask = *CCG_grid_elem_mask(key, grid, x, y);
 								gpm->data[y * gridSize + x] = CLAMPIS(mask, 0, 1);
 								break;
 							case ADD_DISPLACEMENTS:
 								/* Add mask displacement to gpm */
 								gpm->data[y * gridSize + x] +=
-								    *CCG_grid_elem_mask(&key, grid, x, y);
+								    *CCG_grid_elem_mask(key, grid, x, y);
 								break;
 						}
 					}
@@ -1137,6 +1097,90 @@ static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm
 			}
 		}
 	}
+}
+
+static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl)
+{
+	CCGDerivedMesh *ccgdm = (CCGDerivedMesh *)dm;
+	MultiresDispRunData data;
+	CCGKey key;
+	MPoly *mpoly = me->mpoly;
+	MDisps *mdisps = CustomData_get_layer(&me->ldata, CD_MDISPS);
+	GridPaintMask *grid_paint_mask = NULL;
+	int i, gridSize, dGridSize;
+	int totloop, totpoly;
+	
+	/* this happens in the dm made by bmesh_mdisps_space_set */
+	if (dm2 && CustomData_has_layer(&dm2->loopData, CD_MDISPS)) {
+		mpoly = CustomData_get_layer(&dm2->polyData, CD_MPOLY);
+		mdisps = CustomData_get_layer(&dm2->loopData, CD_MDISPS);
+		totloop = dm2->numLoopData;
+		totpoly = dm2->numPolyData;
+	}
+	else {
+		totloop = me->totloop;
+		totpoly = me->totpoly;
+	}
+	
+	if (!mdisps) {
+		if (op == CALC_DISPLACEMENTS)
+			mdisps = CustomData_add_layer(&me->ldata, CD_MDISPS, CD_DEFAULT, NULL, me->totloop);
+		else
+			return;
+	}
+
+	gridSize = dm->getGridSize(dm);
+	dm->getGridKey(dm, &key);
+
+	dGridSize = multires_side_tot[totlvl];
+
+	/* multires paint masks */
+	if (key.has_mask)
+		grid_paint_mask = CustomData_get_layer(&me->ldata, CD_GRID_PAINT_MASK);
+
+	/* when adding new faces in edit mode, need to allocate disps,
+	 * done before the threaded loop since it reallocates all of them */
+	for (i = 0; i < totloop; i++) {
+		if (!mdisps[i].disps) {
+			multires_reallocate_mdisps(totloop, mdisps, totlvl);
+			break;
+		}
+	}
+
+	/* if needed, reallocate multires paint masks */
+	if (grid_paint_mask) {
+		int *gridOffset = dm->getGridOffset(dm);
+
+		for (i = 0; i < totpoly; i++) {
+			int S;
+
+			for (S = 0; S < mpoly[i].totloop; S++) {
+				GridPaintMask *gpm = &grid_paint_mask[gridOffset[i] + S];
+
+				if (gpm->level < key.level) {
+					gpm->level = key.level;
+					if (gpm->data)
+						MEM_freeN(gpm->data);
+					gpm->data = MEM_callocN(sizeof(float) * key.grid_area, "gpm.data");
+				}
+			}
+		}
+	}
+
+	data.op = op;
+	data.mpoly = mpoly;
+	data.mdisps = mdisps;
+	data.grid_paint_mask = grid_paint_mask;
+	data.gridData = dm->getGridData(dm);
+	data.subGridData = (oldGridData) ? oldGridData : data.gridData;
+	data.key = &key;
+	data.gridOffset = dm->getGridOffset(dm);
+	data.gridSize = gridSize;
+	data.dGridSize = dGridSize;
+	data.dSkip = (dGridSize - 1) / (gridSize - 1);
+
+	BLI_task_parallel_range_ex(0, totpoly, &data, multires_disp_run_cb,
+	                           multires_task_threshold(totloop * gridSize * gridSize));
 	
 	if (op == APPLY_DISPLACEMENTS) {
 		ccgSubSurf_stitchFaces(ccgdm->ss, 0, NULL, 0);
@@ -1280,16 +1324,87 @@ void multires_modifier_update_hidden(DerivedMesh *dm)
 	}
 }
 
+typedef struct MultiresSetSpaceData {
+	MPoly *mpoly;
+	MDisps *mdisps;
+	CCGElem **subGridData;
+	CCGKey *key;
+	int *gridOffset;
+	int gridSize, dGridSize, dSkip;
+	int from, to;
+} MultiresSetSpaceData;
+
+static void multires_set_space_cb(void *userdata, int start, int stop)
+{
+	MultiresSetSpaceData *data = userdata;
+	CCGKey *key = data->key;
+	const int gridSize = data->gridSize;
+	const int dGridSize = data->dGridSize;
+	const int dSkip = data->dSkip;
+	const int from = data->from, to = data->to;
+	int i;
+
+	for (i = start; i < stop; ++i) {
+		const int numVerts = data->mpoly[i].totloop;
+		int S, x, y, gIndex = data->gridOffset[i];
+
+		for (S = 0; S < numVerts; ++S, ++gIndex) {
+			MDisps *mdisp = &data->mdisps[data->mpoly[i].loopstart + S];
+			CCGElem *subgrid = data->subGridData[gIndex];
+			float (*dispgrid)[3] = mdisp->disps;
+
+			for (y = 0; y < gridSize; y++) {
+				for (x = 0; x < gridSize; x++) {
+					float *disp_data = dispgrid[dGridSize * y * dSkip + x * dSkip];
+					float *co = CCG_grid_elem_co(key, subgrid, x, y);
+					float mat[3][3], dco[3];
+					
+					/* construct tangent space matrix */
+					grid_tangent_matrix(mat, key, x, y, subgrid);
+
+					/* convert to absolute coordinates in space */
+					if (from == MULTIRES_SPACE_TANGENT) {
+						mul_v3_m3v3(dco, mat, disp_data);
+						add_v3_v3(dco, co);
+					}
+					else if (from == MULTIRES_SPACE_OBJECT) {
+						add_v3_v3v3(dco, co, disp_data);
+					}
+					else if (from == MULTIRES_SPACE_ABSOLUTE) {
+						copy_v3_v3(dco, disp_data);
+					}
+					
+					/*now, convert to desired displacement type*/
+					if (to == MULTIRES_SPACE_TANGENT) {
+						invert_m3(mat);
+
+						sub_v3_v3(dco, co);
+						mul_v3_m3v3(disp_data, mat, dco);
+					}
+					else if (to == MULTIRES_SPACE_OBJECT) {
+						sub_v3_v3(dco, co);
+						mul_v3_m3v3(disp_data, mat, dco);
+					}
+					else if (to == MULTIRES_SPACE_ABSOLUTE) {
+						copy_v3_v3(disp_data, dco);
+					}
+				}
+			}
+		}
+	}
+}
+
 void multires_set_space(DerivedMesh *dm, Object *ob, int from, int to)
 {
 	DerivedMesh *ccgdm = NULL, *subsurf = NULL;
+	MultiresSetSpaceData data;
 	CCGElem **gridData, **subGridData = NULL;
 	CCGKey key;
 	MPoly *mpoly = CustomData_get_layer(&dm->polyData, CD_MPOLY);
 	MDisps *mdisps;
 	MultiresModifierData *mmd = get_multires_modifier(NULL, ob, 1);
-	int *gridOffset, totlvl;
-	int i, k, numGrids, gridSize, dGridSize, dSkip;
+	int totlvl;
+	int i, numGrids, gridSize, dGridSize;
 	
 	if (!mmd)
 		return;
@@ -1320,75 +1435,34 @@ void multires_set_space(DerivedMesh *dm, Object *ob, int from, int to)
 	
 	/* numGrids = ccgdm->dm->getNumGrids((DerivedMesh *)ccgdm); */ /*UNUSED*/
 	gridSize = ccgdm->getGridSize((DerivedMesh *)ccgdm);
-	gridData = ccgdm->getGridData((DerivedMesh *)ccgdm);
-	gridOffset = ccgdm->getGridOffset((DerivedMesh *)ccgdm);
 
 	dGridSize = multires_side_tot[totlvl];
-	dSkip = (dGridSize - 1) / (gridSize - 1);
-
-	k = 0; /*current loop/mdisp index within the mloop array*/
-
-	//#pragma omp parallel for private(i) if (dm->numLoopData * gridSize * gridSize >= CCG_OMP_LIMIT)
-
-	for (i = 0; i < dm->numPolyData; ++i) {
-		const int numVerts = mpoly[i].totloop;
-		int S, x, y, gIndex = gridOffset[i];
-						
-		for (S = 0; S < numVerts; ++S, ++gIndex, ++k) {
-			MDisps *mdisp = &mdisps[mpoly[i].loopstart + S];
-			/* CCGElem *grid = gridData[gIndex]; */ /* UNUSED */
-			CCGElem *subgrid = subGridData[gIndex];
-			float (*dispgrid)[3] = NULL;
-
-			/* when adding new faces in edit mode, need to allocate disps */
-			if (!mdisp->disps) {
-				mdisp->totdisp = gridSize * gridSize;
-				mdisp->level = totlvl;
-				mdisp->disps = MEM_callocN(sizeof(float) * 3 * mdisp->totdisp, "disp in multires_set_space");
-			}
-
-			dispgrid = mdisp->disps;
-
-			for (y = 0; y < gridSize; y++) {
-				for (x = 0; x < gridSize; x++) {
-					float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
-					float *co = CCG_grid_elem_co(&key, subgrid, x, y);
-					float mat[3][3], dco[3];
-					
-					/* construct tangent space matrix */
-					grid_tangent_matrix(mat, &key, x, y, subgrid);
 
-					/* convert to absolute coordinates in space */
-					if (from == MULTIRES_SPACE_TANGENT) {
-						mul_v3_m3v3(dco, mat, data);
-						add_v3_v3(dco, co);
-					}
-					else if (from == MULTIRES_SPACE_OBJECT) {
-						add_v3_v3v3(dco, co, data);
-					}
-					else if (from == MULTIRES_SPACE_ABSOLUTE) {
-						copy_v3_v3(dco, data);
-					}
-					
-					/*now, convert to desired displacement type*/
-					if (to == MULTIRES_SPACE_TANGENT) {
-						invert_m3(mat);
+	/* when adding new faces in edit mode, need to allocate disps */
+	for (i = 0; i < dm->numLoopData; i++) {
+		MDisps *mdisp = &mdisps[i];
 
-						sub_v3_v3(dco, co);
-						mul_v3_m3v3(data, mat, dco);
-					}
-					else if (to == MULTIRES_SPACE_OBJECT) {
-						sub_v3_v3(dco, co);
-						mul_v3_m3v3(data, mat, dco);
-					}
-					else if (to == MULTIRES_SPACE_ABSOLUTE) {
-						copy_v3_v3(data, dco);
-					}
-				}
-			}
+		if (!mdisp->disps) {
+			mdisp->totdisp = gridSize * gridSize;
+			mdisp->level = totlvl;
+			mdisp->disps = MEM_callocN(sizeof(float) * 3 * mdisp->totdisp, "disp in multires_set_space");
 		}
 	}
 
+	data.mpoly = mpoly;
+	data.mdisps = mdisps;
+	data.subGridData = subGridData;
+	data.key = &key;
+	data.gridOffset = ccgdm->getGridOffset((DerivedMesh *)ccgdm);
+	data.gridSize = gridSize;
+	data.dGridSize = dGridSize;
+	data.dSkip = (dGridSize - 1) / (gridSize - 1);
+	data.from = from;
+	data.to = to;
+
+	BLI_task_parallel_range_ex(0, dm->numPolyData, &data, multires_set_space_cb,
+	                           multires_task_threshold(dm->numLoopData * gridSize * gridSize));
+
 cleanup:
 	if (subsurf) {
 		subsurf->needsFree = 1;
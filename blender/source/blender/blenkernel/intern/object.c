@@ -66,6 +66,8 @@
 #include "BLI_linklist.h"
 #include "BLI_kdtree.h"
 
+#include "PIL_time.h"
+
 #include "BLF_translation.h"
 
 #include "BKE_pbvh.h"
@@ -106,6 +108,7 @@
 #include "BKE_rigidbody.h"
 #include "BKE_sca.h"
 #include "BKE_scene.h"
+#include "BKE_update_timing.h"
 #include "BKE_sequencer.h"
 #include "BKE_speaker.h"
 #include "BKE_softbody.h"
@@ -170,6 +173,7 @@ void BKE_object_free_curve_cache(Object *ob)
 {
 	if (ob->curve_cache) {
 		BKE_displist_free(&ob->curve_cache->disp);
+		BKE_displist_bevel_cache_free(&ob->curve_cache->bevel_cache);
 		BLI_freelistN(&ob->curve_cache->bev);
 		if (ob->curve_cache->path) {
 			free_path(ob->curve_cache->path);
@@ -321,6 +325,8 @@ void BKE_object_free(Object *ob)
 	int a;
 	
 	BKE_object_free_derived_caches(ob);
+	if (ob->modifier_cache)
+		mesh_free_modifier_cache(ob);
 	
 	/* disconnect specific data, but not for lib data (might be indirect data, can get relinked) */
 	if (ob->data) {
@@ -383,8 +389,12 @@ void BKE_object_free(Object *ob)
 
 	if (ob->pc_ids.first) BLI_freelistN(&ob->pc_ids);
 
+	BLI_freelistN(&ob->lodlevels);
+	ob->currentlod = NULL;
+
 	/* Free runtime curves data. */
 	if (ob->curve_cache) {
+		BKE_displist_bevel_cache_free(&ob->curve_cache->bevel_cache);
 		BLI_freelistN(&ob->curve_cache->bev);
 		if (ob->curve_cache->path)
 			free_path(ob->curve_cache->path);
@@ -392,6 +402,83 @@ void BKE_object_free(Object *ob)
 	}
 }
 
+/* ************************ Levels of Detail ************************ */
+
+/* Adds a level of detail, the first level is created for the object itself */
+void BKE_object_lod_add(Object *ob)
+{
+	LodLevel *lod = MEM_callocN(sizeof(LodLevel), "LoD Level");
+	LodLevel *last = ob->lodlevels.last;
+
+	/* If the lod list is empty, initialize it with the base lod level */
+	if (!last) {
+		LodLevel *base = MEM_callocN(sizeof(LodLevel), "Base LoD Level");
+		BLI_addtail(&ob->lodlevels, base);
+		base->source = ob;
+		last = ob->currentlod = base;
+	}
+
+	lod->distance = last->distance + 25.0f;
+
+	BLI_addtail(&ob->lodlevels, lod);
+}
+
+static int lod_cmp(void *a, void *b)
+{
+	LodLevel *loda = a;
+	LodLevel *lodb = b;
+
+	if (loda->distance < lodb->distance) return -1;
+	return loda->distance > lodb->distance;
+}
+
+/* Keeps the levels ordered by distance, the base level always stays first */
+void BKE_object_lod_sort(Object *ob)
+{
+	BLI_sortlist(&ob->lodlevels, lod_cmp);
+}
+
+bool BKE_object_lod_remove(Object *ob, int level)
+{
+	LodLevel *rem;
+
+	/* the base level can't be removed on its own */
+	if (level < 1 || level > BLI_countlist(&ob->lodlevels) - 1)
+		return false;
+
+	rem = BLI_findlink(&ob->lodlevels, level);
+
+	if (rem == ob->currentlod)
+		ob->currentlod = rem->prev;
+
+	BLI_remlink(&ob->lodlevels, rem);
+	MEM_freeN(rem);
+
+	/* If there are no more lod levels, clear the lod list */
+	if (BLI_countlist(&ob->lodlevels) == 1) {
+		LodLevel *base = ob->lodlevels.first;
+		BLI_remlink(&ob->lodlevels, base);
+		MEM_freeN(base);
+		ob->currentlod = NULL;
+	}
+
+	return true;
+}
+
+void BKE_object_lod_copy(Object *obn, Object *ob)
+{
+	LodLevel *lod;
+
+	BLI_duplicatelist(&obn->lodlevels, &ob->lodlevels);
+	obn->currentlod = obn->lodlevels.first;
+
+	/* the base level refers to the object itself */
+	for (lod = obn->lodlevels.first; lod; lod = lod->next) {
+		if (lod->source == ob)
+			lod->source = obn;
+	}
+}
+
 static void unlink_object__unlinkModifierLinks(void *userData, Object *ob, Object **obpoin)
 {
 	Object *unlinkOb = userData;
@@ -444,6 +531,14 @@ void BKE_object_unlink(Object *ob)
 			obt->parent = NULL;
 			DAG_id_tag_update(&obt->id, OB_RECALC_OB | OB_RECALC_DATA | OB_RECALC_TIME);
 		}
+
+		if (obt != ob && obt->lodlevels.first) {
+			LodLevel *lod;
+			for (lod = obt->lodlevels.first; lod; lod = lod->next) {
+				if (lod->source == ob)
+					lod->source = NULL;
+			}
+		}
 		
 		modifiers_foreachObjectLink(obt, unlink_object__unlinkModifierLinks, ob);
 		
@@ -1115,6 +1210,7 @@ static ParticleSystem *copy_particlesystem(ParticleSystem *psys)
 	psysn->frand = NULL;
 	psysn->pdd = NULL;
 	psysn->effectors = NULL;
+	psysn->sphgrid = NULL;
 	
 	psysn->pathcachebufs.first = psysn->pathcachebufs.last = NULL;
 	psysn->childcachebufs.first = psysn->childcachebufs.last = NULL;
@@ -1335,12 +1431,15 @@ Object *BKE_object_copy_ex(Main *bmain, Object *ob, int copy_caches)
 	
 	obn->derivedDeform = NULL;
 	obn->derivedFinal = NULL;
+	obn->modifier_cache = NULL;
 
 	obn->gpulamp.first = obn->gpulamp.last = NULL;
 	obn->pc_ids.first = obn->pc_ids.last = NULL;
 
 	obn->mpath = NULL;
 
+	BKE_object_lod_copy(obn, ob);
+
 	/* Copy runtime surve data. */
 	obn->curve_cache = NULL;
 
@@ -2692,6 +2791,9 @@ void BKE_object_handle_update_ex(Scene *scene, Object *ob,
                                  RigidBodyWorld *rbw)
 {
 	if (ob->recalc & OB_RECALC_ALL) {
+		const bool do_timing = BKE_update_timing_enabled();
+		double start_time = do_timing ? PIL_check_seconds_timer() : 0.0;
+
 		/* speed optimization for animation lookups */
 		if (ob->pose)
 			BKE_pose_channels_hash_make(ob->pose);
@@ -2873,6 +2975,9 @@ void BKE_object_handle_update_ex(Scene *scene, Object *ob,
 		}
 
 		ob->recalc &= ~OB_RECALC_ALL;
+
+		if (do_timing)
+			BKE_update_timing_add(UPDATE_TIMING_OBJECT, ob->id.name + 2, NULL, PIL_check_seconds_timer() - start_time);
 	}
 
 	/* the case when this is a group proxy, object_update is called in group.c */
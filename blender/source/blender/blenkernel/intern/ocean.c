@@ -60,6 +60,24 @@
 
 #define GRAVITY  9.81f
 
+/* number of recently simulated frames kept in memory, so scrubbing back and
+ * forth over the timeline doesn't need to redo the FFTs */
+#define OCEAN_FRAME_CACHE_SIZE 4
+/* upper limit for the memory used by those frames, high resolution oceans
+ * don't get cached at all */
+#define OCEAN_FRAME_CACHE_MAX_MEM (256 * 1024 * 1024)
+
+typedef struct OceanFrameResult {
+	/* simulation input the results were computed with */
+	float t;
+	float scale;
+	float chop_amount;
+	int valid;
+
+	double N_y;
+	double *data;   /* all computed arrays after each other */
+} OceanFrameResult;
+
 typedef struct Ocean {
 	/* ********* input parameters to the sim ********* */
 	float _V;
@@ -143,6 +161,11 @@ typedef struct Ocean {
 
 	/* two dimensional float array */
 	float *_k;                      /* init w	sim r */
+
+	/* ring buffer of recent results */
+	OceanFrameResult _frame_cache[OCEAN_FRAME_CACHE_SIZE];
+	int _frame_cache_len;           /* init w	sim r */
+	int _frame_cache_next;          /*			sim w */
 } Ocean;
 
 
@@ -495,6 +518,109 @@ void BKE_ocean_eval_ij(struct Ocean *oc, struct OceanResult *ocr, int i, int j)
 	BLI_rw_mutex_unlock(&oc->oceanmutex);
 }
 
+/* fills in the result arrays which are computed for this ocean, returns their number */
+static int ocean_result_arrays(struct Ocean *o, double *r_arrays[8])
+{
+	int tot = 0;
+
+	if (o->_do_disp_y) {
+		r_arrays[tot++] = o->_disp_y;
+	}
+	if (o->_do_chop) {
+		r_arrays[tot++] = o->_disp_x;
+		r_arrays[tot++] = o->_disp_z;
+	}
+	if (o->_do_jacobian) {
+		r_arrays[tot++] = o->_Jxx;
+		r_arrays[tot++] = o->_Jzz;
+		r_arrays[tot++] = o->_Jxz;
+	}
+	if (o->_do_normals) {
+		r_arrays[tot++] = o->_N_x;
+		r_arrays[tot++] = o->_N_z;
+	}
+
+	return tot;
+}
+
+static void ocean_frame_cache_init(struct Ocean *o)
+{
+	double *arrays[8];
+	size_t frame_size = (size_t)ocean_result_arrays(o, arrays) * (size_t)(o->_M * o->_N) * sizeof(double);
+
+	o->_frame_cache_next = 0;
+
+	if (frame_size == 0)
+		o->_frame_cache_len = 0;
+	else
+		o->_frame_cache_len = (int)MIN2((size_t)OCEAN_FRAME_CACHE_SIZE, OCEAN_FRAME_CACHE_MAX_MEM / frame_size);
+}
+
+static void ocean_frame_cache_free(struct Ocean *o)
+{
+	int i;
+
+	for (i = 0; i < OCEAN_FRAME_CACHE_SIZE; i++) {
+		if (o->_frame_cache[i].data)
+			MEM_freeN(o->_frame_cache[i].data);
+	}
+
+	memset(o->_frame_cache, 0, sizeof(o->_frame_cache));
+	o->_frame_cache_len = 0;
+	o->_frame_cache_next = 0;
+}
+
+/* copies back the results of an earlier simulation with the same input, returns false if there are none */
+static bool ocean_frame_cache_restore(struct Ocean *o, float t, float scale, float chop_amount)
+{
+	const size_t array_len = (size_t)(o->_M * o->_N);
+	double *arrays[8];
+	int i, a, tot;
+
+	for (i = 0; i < o->_frame_cache_len; i++) {
+		OceanFrameResult *fr = &o->_frame_cache[i];
+
+		if (fr->valid && fr->t == t && fr->scale == scale && fr->chop_amount == chop_amount) {
+			tot = ocean_result_arrays(o, arrays);
+			for (a = 0; a < tot; a++)
+				memcpy(arrays[a], fr->data + (size_t)a * array_len, array_len * sizeof(double));
+
+			o->_N_y = fr->N_y;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void ocean_frame_cache_store(struct Ocean *o, float t, float scale, float chop_amount)
+{
+	const size_t array_len = (size_t)(o->_M * o->_N);
+	OceanFrameResult *fr;
+	double *arrays[8];
+	int a, tot;
+
+	if (o->_frame_cache_len == 0)
+		return;
+
+	fr = &o->_frame_cache[o->_frame_cache_next];
+	o->_frame_cache_next = (o->_frame_cache_next + 1) % o->_frame_cache_len;
+
+	tot = ocean_result_arrays(o, arrays);
+
+	if (fr->data == NULL)
+		fr->data = MEM_mallocN(array_len * (size_t)tot * sizeof(double), "ocean frame cache");
+
+	for (a = 0; a < tot; a++)
+		memcpy(fr->data + (size_t)a * array_len, arrays[a], array_len * sizeof(double));
+
+	fr->t = t;
+	fr->scale = scale;
+	fr->chop_amount = chop_amount;
+	fr->N_y = o->_N_y;
+	fr->valid = TRUE;
+}
+
 void BKE_simulate_ocean(struct Ocean *o, float t, float scale, float chop_amount)
 {
 	int i, j;
@@ -503,6 +629,12 @@ void BKE_simulate_ocean(struct Ocean *o, float t, float scale, float chop_amount
 
 	BLI_rw_mutex_lock(&o->oceanmutex, THREAD_LOCK_WRITE);
 
+	/* scrubbing over frames which were simulated recently */
+	if (ocean_frame_cache_restore(o, t, scale, chop_amount)) {
+		BLI_rw_mutex_unlock(&o->oceanmutex);
+		return;
+	}
+
 	/* compute a new htilda */
 #pragma omp parallel for private(i, j)
 	for (i = 0; i < o->_M; ++i) {
@@ -719,6 +851,8 @@ void BKE_simulate_ocean(struct Ocean *o, float t, float scale, float chop_amount
 
 	} /* omp sections */
 
+	ocean_frame_cache_store(o, t, scale, chop_amount);
+
 	BLI_rw_mutex_unlock(&o->oceanmutex);
 }
 
@@ -890,6 +1024,8 @@ void BKE_init_ocean(struct Ocean *o, int M, int N, float Lx, float Lz, float V,
 		o->_Jxz_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_jxz, o->_Jxz, FFTW_ESTIMATE);
 	}
 
+	ocean_frame_cache_init(o);
+
 	BLI_rw_mutex_unlock(&o->oceanmutex);
 
 	set_height_normalize_factor(o);
@@ -903,6 +1039,8 @@ void BKE_free_ocean_data(struct Ocean *oc)
 
 	BLI_rw_mutex_lock(&oc->oceanmutex, THREAD_LOCK_WRITE);
 
+	ocean_frame_cache_free(oc);
+
 	if (oc->_do_disp_y) {
 		fftw_destroy_plan(oc->_disp_y_plan);
 		MEM_freeN(oc->_disp_y);
@@ -53,6 +53,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_kdtree.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_linklist.h"
 
@@ -123,6 +124,9 @@ int count_particles_mod(ParticleSystem *psys, int totgr, int cur)
 
 #define PATH_CACHE_BUF_SIZE 1024
 
+/* below this many child strands paths are cached on the calling thread */
+#define PSYS_CHILD_PATH_TASK_LIMIT 256
+
 static ParticleCacheKey **psys_alloc_path_cache_buffers(ListBase *bufs, int tot, int steps)
 {
 	LinkData *buf;
@@ -148,6 +152,35 @@ static ParticleCacheKey **psys_alloc_path_cache_buffers(ListBase *bufs, int tot,
 	return cache;
 }
 
+/* check if the buffers hold exactly tot paths of the given amount of keys, so they can be reused */
+static bool psys_path_cache_buffers_match(ListBase *bufs, int tot, int steps)
+{
+	LinkData *buf;
+	int totkey, totbufkey;
+
+	tot = MAX2(tot, 1);
+	totkey = 0;
+
+	for (buf = bufs->first; buf; buf = buf->next) {
+		totbufkey = MIN2(tot - totkey, PATH_CACHE_BUF_SIZE);
+
+		if (totbufkey <= 0 || MEM_allocN_len(buf->data) != sizeof(ParticleCacheKey) * totbufkey * steps)
+			return false;
+
+		totkey += totbufkey;
+	}
+
+	return (totkey == tot);
+}
+
+static void psys_clear_path_cache_buffers(ListBase *bufs)
+{
+	LinkData *buf;
+
+	for (buf = bufs->first; buf; buf = buf->next)
+		memset(buf->data, 0, MEM_allocN_len(buf->data));
+}
+
 static void psys_free_path_cache_buffers(ParticleCacheKey **cache, ListBase *bufs)
 {
 	LinkData *buf;
@@ -449,7 +482,7 @@ void free_keyed_keys(ParticleSystem *psys)
 		}
 	}
 }
-static void free_child_path_cache(ParticleSystem *psys)
+void psys_free_child_path_cache(ParticleSystem *psys)
 {
 	psys_free_path_cache_buffers(psys->childcache, &psys->childcachebufs);
 	psys->childcache = NULL;
@@ -467,7 +500,7 @@ void psys_free_path_cache(ParticleSystem *psys, PTCacheEdit *edit)
 		psys->pathcache = NULL;
 		psys->totcached = 0;
 
-		free_child_path_cache(psys);
+		psys_free_child_path_cache(psys);
 	}
 }
 void psys_free_children(ParticleSystem *psys)
@@ -478,7 +511,7 @@ void psys_free_children(ParticleSystem *psys)
 		psys->totchild = 0;
 	}
 
-	free_child_path_cache(psys);
+	psys_free_child_path_cache(psys);
 }
 void psys_free_particles(ParticleSystem *psys)
 {
@@ -573,6 +606,7 @@ void psys_free(Object *ob, ParticleSystem *psys)
 
 		BLI_bvhtree_free(psys->bvhtree);
 		BLI_kdtree_free(psys->tree);
+		psys_sph_grid_free(psys->sphgrid);
  
 		if (psys->fluid_springs)
 			MEM_freeN(psys->fluid_springs);
@@ -2394,9 +2428,10 @@ void psys_find_parents(ParticleSimulationData *sim)
 {
 	ParticleSettings *part = sim->psys->part;
 	KDTree *tree;
+	KDTreeNearest *nearest;
 	ChildParticle *cpa;
 	int p, totparent, totchild = sim->psys->totchild;
-	float co[3], orco[3];
+	float co[3], orco[3], (*orcos)[3];
 	int from = PART_FROM_FACE;
 	totparent = (int)(totchild * part->parents * 0.3f);
 
@@ -2412,9 +2447,23 @@ void psys_find_parents(ParticleSimulationData *sim)
 
 	BLI_kdtree_balance(tree);
 
-	for (; p < totchild; p++, cpa++) {
-		psys_particle_on_emitter(sim->psmd, from, cpa->num, DMCACHE_ISCHILD, cpa->fuv, cpa->foffset, co, 0, 0, 0, orco, 0);
-		cpa->parent = BLI_kdtree_find_nearest(tree, orco, NULL, NULL);
+	/* look up the parents of all children at once */
+	if (totchild > totparent) {
+		orcos = MEM_mallocN(sizeof(*orcos) * (totchild - totparent), "psys_find_parents orcos");
+		nearest = MEM_mallocN(sizeof(*nearest) * (totchild - totparent), "psys_find_parents nearest");
+
+		for (; p < totchild; p++, cpa++) {
+			psys_particle_on_emitter(sim->psmd, from, cpa->num, DMCACHE_ISCHILD, cpa->fuv, cpa->foffset, co, 0, 0, 0, orcos[p - totparent], 0);
+		}
+
+		BLI_kdtree_find_nearest_n_array(tree, (const float (*)[3])orcos, (unsigned int)(totchild - totparent), nearest, NULL, 1);
+
+		for (p = totparent, cpa = sim->psys->child + totparent; p < totchild; p++, cpa++) {
+			cpa->parent = (totparent > 0) ? nearest[p - totparent].index : -1;
+		}
+
+		MEM_freeN(orcos);
+		MEM_freeN(nearest);
 	}
 
 	BLI_kdtree_free(tree);
@@ -2496,7 +2545,9 @@ static int psys_threads_init_path(ParticleThread *threads, Scene *scene, float c
 	/* init random number generator */
 	seed = 31415926 + ctx->sim.psys->seed;
 	
-	if (ctx->editupdate || totchild < 10000)
+	/* edit updates only touch the recalculated strands, small
+	 * systems are left to the range threshold of the task scheduler */
+	if (ctx->editupdate)
 		totthread = 1;
 	
 	for (i = 0; i < totthread; i++) {
@@ -2802,86 +2853,76 @@ static void psys_thread_create_path(ParticleThread *thread, struct ChildParticle
 		child_keys->steps = -1;
 }
 
-static void *exec_child_path_cache(void *data)
+/* children are independent of each other, the range is split in
+ * small chunks so strands of uneven cost are balanced between threads */
+static void exec_child_path_cache_range(void *userdata, int start, int stop)
 {
-	ParticleThread *thread = (ParticleThread *)data;
+	ParticleThread *thread = (ParticleThread *)userdata;
 	ParticleThreadContext *ctx = thread->ctx;
 	ParticleSystem *psys = ctx->sim.psys;
 	ParticleCacheKey **cache = psys->childcache;
-	ChildParticle *cpa;
-	int i, totchild = ctx->totchild, first = 0;
+	ChildParticle *cpa = psys->child + start;
+	int i;
 
-	if (thread->tot > 1) {
-		first = ctx->parent_pass ? 0 : ctx->totparent;
-		totchild = ctx->parent_pass ? ctx->totparent : ctx->totchild;
-	}
-	
-	cpa = psys->child + first + thread->num;
-	for (i = first + thread->num; i < totchild; i += thread->tot, cpa += thread->tot)
-		psys_thread_create_path(thread, cpa, cache[i], i);
+	for (i = start; i < stop; i++, cpa++) {
+		/* reused buffers still hold the previous paths */
+		if (ctx->clearcache)
+			memset(cache[i], 0, sizeof(*cache[i]) * (ctx->steps + 1));
 
-	return 0;
+		psys_thread_create_path(thread, cpa, cache[i], i);
+	}
 }
 
 void psys_cache_child_paths(ParticleSimulationData *sim, float cfra, int editupdate)
 {
 	ParticleThread *pthreads;
 	ParticleThreadContext *ctx;
-	ListBase threads;
-	int i, totchild, totparent, totthread;
+	ParticleSystem *psys = sim->psys;
+	int totchild, totparent;
 
-	if (sim->psys->flag & PSYS_GLOBAL_HAIR)
+	if (psys->flag & PSYS_GLOBAL_HAIR) {
+		psys_free_child_path_cache(psys);
 		return;
+	}
 
 	pthreads = psys_threads_create(sim);
 
 	if (!psys_threads_init_path(pthreads, sim->scene, cfra, editupdate)) {
 		psys_threads_free(pthreads);
+		psys_free_child_path_cache(psys);
 		return;
 	}
 
 	ctx = pthreads[0].ctx;
 	totchild = ctx->totchild;
 	totparent = ctx->totparent;
+	ctx->clearcache = 0;
 
-	if (editupdate && sim->psys->childcache && totchild == sim->psys->totchildcache) {
-		; /* just overwrite the existing cache */
+	if (psys->childcache && totchild == psys->totchildcache &&
+	    psys_path_cache_buffers_match(&psys->childcachebufs, totchild, ctx->steps + 1))
+	{
+		/* edit updates just overwrite the recalculated paths,
+		 * otherwise the existing buffers are cleared and refilled */
+		if (!editupdate)
+			ctx->clearcache = 1;
 	}
 	else {
 		/* clear out old and create new empty path cache */
-		free_child_path_cache(sim->psys);
-		sim->psys->childcache = psys_alloc_path_cache_buffers(&sim->psys->childcachebufs, totchild, ctx->steps + 1);
-		sim->psys->totchildcache = totchild;
+		psys_free_child_path_cache(psys);
+		psys->childcache = psys_alloc_path_cache_buffers(&psys->childcachebufs, totchild, ctx->steps + 1);
+		psys->totchildcache = totchild;
 	}
 
-	totthread = pthreads[0].tot;
-
-	if (totthread > 1) {
-
+	if (pthreads[0].tot > 1) {
 		/* make virtual child parents thread safe by calculating them first */
 		if (totparent) {
-			BLI_init_threads(&threads, exec_child_path_cache, totthread);
-			
-			for (i = 0; i < totthread; i++) {
-				pthreads[i].ctx->parent_pass = 1;
-				BLI_insert_thread(&threads, &pthreads[i]);
-			}
-
-			BLI_end_threads(&threads);
-
-			for (i = 0; i < totthread; i++)
-				pthreads[i].ctx->parent_pass = 0;
+			BLI_task_parallel_range_ex(0, totparent, &pthreads[0], exec_child_path_cache_range, PSYS_CHILD_PATH_TASK_LIMIT);
 		}
 
-		BLI_init_threads(&threads, exec_child_path_cache, totthread);
-
-		for (i = 0; i < totthread; i++)
-			BLI_insert_thread(&threads, &pthreads[i]);
-
-		BLI_end_threads(&threads);
+		BLI_task_parallel_range_ex(totparent, totchild, &pthreads[0], exec_child_path_cache_range, PSYS_CHILD_PATH_TASK_LIMIT);
 	}
 	else
-		exec_child_path_cache(&pthreads[0]);
+		exec_child_path_cache_range(&pthreads[0], 0, totchild);
 
 	psys_threads_free(pthreads);
 }
@@ -2970,9 +3011,22 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra)
 	keyed = psys->flag & PSYS_KEYED;
 	baked = psys->pointcache->mem_cache.first && psys->part->type != PART_HAIR;
 
-	/* clear out old and create new empty path cache */
-	psys_free_path_cache(psys, psys->edit);
-	cache = psys->pathcache = psys_alloc_path_cache_buffers(&psys->pathcachebufs, totpart, steps + 1);
+	/* the child cache is kept for psys_cache_child_paths to reuse */
+	psys_free_path_cache(NULL, psys->edit);
+
+	if (psys->pathcache && psys->totcached == totpart &&
+	    psys_path_cache_buffers_match(&psys->pathcachebufs, totpart, steps + 1))
+	{
+		/* unchanged amount of paths and keys, refill the existing cache */
+		psys_clear_path_cache_buffers(&psys->pathcachebufs);
+		cache = psys->pathcache;
+	}
+	else {
+		/* clear out old and create new empty path cache */
+		psys_free_path_cache_buffers(psys->pathcache, &psys->pathcachebufs);
+		cache = psys->pathcache = psys_alloc_path_cache_buffers(&psys->pathcachebufs, totpart, steps + 1);
+	}
+	psys->totcached = 0;
 
 	psys->lattice_deform_data = psys_create_lattice_deform_data(sim);
 	ma = give_current_material(sim->ob, psys->part->omat);
@@ -2194,34 +2194,167 @@ void psys_get_pointcache_start_end(Scene *scene, ParticleSystem *psys, int *sfra
 /************************************************/
 /*			Effectors							*/
 /************************************************/
-static void psys_update_particle_bvhtree(ParticleSystem *psys, float cfra)
+/* Hashed uniform grid over the live particles of a system, for SPH neighbour
+ * search. Points are sorted by bucket, so the candidates of a cell are one
+ * contiguous run of positions. */
+typedef struct SPHGrid {
+	float frame, cellsize, inv_cellsize;
+	unsigned int mask;  /* number of buckets - 1 */
+	int totpoint;
+	int *bucket_start;  /* start of every bucket's points, plus end */
+	int *index;         /* particle index of every point */
+	int (*cell)[3];     /* grid cell of every point */
+	float (*co)[3];
+} SPHGrid;
+
+BLI_INLINE void sph_grid_cell(const SPHGrid *grid, const float co[3], int cell[3])
+{
+	int a;
+
+	for (a = 0; a < 3; a++) {
+		float f = floorf(co[a] * grid->inv_cellsize);
+		CLAMP(f, -1.0e9f, 1.0e9f);
+		cell[a] = (int)f;
+	}
+}
+
+BLI_INLINE unsigned int sph_grid_hash(const SPHGrid *grid, const int cell[3])
+{
+	return (((unsigned int)cell[0] * 73856093u) ^
+	        ((unsigned int)cell[1] * 19349663u) ^
+	        ((unsigned int)cell[2] * 83492791u)) & grid->mask;
+}
+
+void psys_sph_grid_free(SPHGrid *grid)
+{
+	if (grid) {
+		MEM_freeN(grid->bucket_start);
+		MEM_freeN(grid->index);
+		MEM_freeN(grid->cell);
+		MEM_freeN(grid->co);
+		MEM_freeN(grid);
+	}
+}
+
+static void psys_update_particle_sphgrid(ParticleSystem *psys, float cfra, float cellsize)
 {
 	if (psys) {
+		SPHGrid *grid = psys->sphgrid;
 		PARTICLE_P;
-		int totpart = 0;
+		int totpoint = 0, totbucket = 1, i;
+		int (*cell)[3];
+		float (*co)[3];
+		unsigned int *bucket;
+		int *fill;
 
-		if (!psys->bvhtree || psys->bvhtree_frame != cfra) {
-			LOOP_SHOWN_PARTICLES {
-				totpart++;
+		if (grid && grid->frame == cfra && grid->cellsize == cellsize)
+			return;
+
+		psys_sph_grid_free(grid);
+		psys->sphgrid = grid = MEM_callocN(sizeof(SPHGrid), "SPHGrid");
+
+		LOOP_SHOWN_PARTICLES {
+			if (pa->alive == PARS_ALIVE)
+				totpoint++;
+		}
+
+		/* about two buckets per point keeps collisions rare */
+		while (totbucket < 2 * totpoint)
+			totbucket <<= 1;
+
+		grid->frame = cfra;
+		grid->cellsize = cellsize;
+		grid->inv_cellsize = (cellsize > FLT_EPSILON) ? 1.0f / cellsize : 1.0f / FLT_EPSILON;
+		grid->mask = (unsigned int)totbucket - 1;
+		grid->totpoint = totpoint;
+		grid->bucket_start = MEM_callocN(sizeof(int) * (totbucket + 1), "SPHGrid buckets");
+		grid->index = MEM_mallocN(sizeof(int) * MAX2(totpoint, 1), "SPHGrid index");
+		grid->cell = MEM_mallocN(sizeof(int) * 3 * MAX2(totpoint, 1), "SPHGrid cells");
+		grid->co = MEM_mallocN(sizeof(float) * 3 * MAX2(totpoint, 1), "SPHGrid co");
+
+		cell = MEM_mallocN(sizeof(int) * 3 * MAX2(totpoint, 1), "SPHGrid unsorted cells");
+		co = MEM_mallocN(sizeof(float) * 3 * MAX2(totpoint, 1), "SPHGrid unsorted co");
+		bucket = MEM_mallocN(sizeof(unsigned int) * MAX2(totpoint, 1), "SPHGrid unsorted buckets");
+		fill = MEM_mallocN(sizeof(int) * MAX2(totpoint, 1), "SPHGrid unsorted index");
+
+		/* same positions the particle bvhtree was built from */
+		i = 0;
+		LOOP_SHOWN_PARTICLES {
+			if (pa->alive == PARS_ALIVE) {
+				if (pa->state.time == cfra)
+					copy_v3_v3(co[i], pa->prev_state.co);
+				else
+					copy_v3_v3(co[i], pa->state.co);
+
+				sph_grid_cell(grid, co[i], cell[i]);
+				bucket[i] = sph_grid_hash(grid, cell[i]);
+				fill[i] = p;
+				grid->bucket_start[bucket[i] + 1]++;
+				i++;
 			}
-			
-			BLI_bvhtree_free(psys->bvhtree);
-			psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
+		}
 
-			LOOP_SHOWN_PARTICLES {
-				if (pa->alive == PARS_ALIVE) {
-					if (pa->state.time == cfra)
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
-					else
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
+		for (i = 0; i < totbucket; i++)
+			grid->bucket_start[i + 1] += grid->bucket_start[i];
+
+		/* counting sort, keeps particle order within a bucket */
+		for (i = 0; i < totpoint; i++) {
+			int j = grid->bucket_start[bucket[i]]++;
+
+			grid->index[j] = fill[i];
+			copy_v3_v3_int(grid->cell[j], cell[i]);
+			copy_v3_v3(grid->co[j], co[i]);
+		}
+
+		/* the sort advanced every start to the next bucket's */
+		for (i = totbucket; i > 0; i--)
+			grid->bucket_start[i] = grid->bucket_start[i - 1];
+		grid->bucket_start[0] = 0;
+
+		MEM_freeN(cell);
+		MEM_freeN(co);
+		MEM_freeN(bucket);
+		MEM_freeN(fill);
+	}
+}
+
+/* calls back for every point closer than radius, like BLI_bvhtree_range_query */
+static void sph_grid_range_query(SPHGrid *grid, const float co[3], float radius, BVHTree_RangeQuery callback, void *userdata)
+{
+	float radius_sq = radius * radius;
+	float co_min[3], co_max[3];
+	int cmin[3], cmax[3], c[3];
+
+	if (!grid || grid->totpoint == 0)
+		return;
+
+	co_min[0] = co[0] - radius; co_min[1] = co[1] - radius; co_min[2] = co[2] - radius;
+	co_max[0] = co[0] + radius; co_max[1] = co[1] + radius; co_max[2] = co[2] + radius;
+	sph_grid_cell(grid, co_min, cmin);
+	sph_grid_cell(grid, co_max, cmax);
+
+	for (c[2] = cmin[2]; c[2] <= cmax[2]; c[2]++) {
+		for (c[1] = cmin[1]; c[1] <= cmax[1]; c[1]++) {
+			for (c[0] = cmin[0]; c[0] <= cmax[0]; c[0]++) {
+				unsigned int b = sph_grid_hash(grid, c);
+				int i;
+
+				for (i = grid->bucket_start[b]; i < grid->bucket_start[b + 1]; i++) {
+					float dist;
+
+					/* other cells can share the bucket */
+					if (grid->cell[i][0] != c[0] || grid->cell[i][1] != c[1] || grid->cell[i][2] != c[2])
+						continue;
+
+					dist = len_squared_v3v3(co, grid->co[i]);
+					if (dist < radius_sq)
+						callback(userdata, grid->index[i], dist);
 				}
 			}
-			BLI_bvhtree_balance(psys->bvhtree);
-
-			psys->bvhtree_frame = cfra;
 		}
 	}
 }
+
 void psys_update_particle_tree(ParticleSystem *psys, float cfra)
 {
 	if (psys) {
@@ -2426,6 +2559,20 @@ static ParticleSpring *sph_spring_add(ParticleSystem *psys, ParticleSpring *spri
 
 	return psys->fluid_springs + psys->tot_fluidsprings - 1;
 }
+/* order springs by particle pair, for springs added from several threads */
+static int sph_spring_compare(const void *a, const void *b)
+{
+	const ParticleSpring *s1 = a, *s2 = b;
+
+	if (s1->particle_index[0] != s2->particle_index[0])
+		return (s1->particle_index[0] < s2->particle_index[0]) ? -1 : 1;
+	if (s1->particle_index[1] != s2->particle_index[1])
+		return (s1->particle_index[1] < s2->particle_index[1]) ? -1 : 1;
+	if (s1->rest_length != s2->rest_length)
+		return (s1->rest_length < s2->rest_length) ? -1 : 1;
+
+	return 0;
+}
 static void sph_spring_delete(ParticleSystem *psys, int j)
 {
 	if (j != psys->tot_fluidsprings - 1)
@@ -2535,7 +2682,7 @@ static void sph_evaluate_func(BVHTree *tree, ParticleSystem **psys, float co[3],
 			break;
 		}
 		else {
-			BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
+			sph_grid_range_query(psys[i]->sphgrid, co, interaction_radius, callback, pfr);
 		}
 	}
 }
@@ -3939,15 +4086,16 @@ static void psys_update_path_cache(ParticleSimulationData *sim, float cfra)
 		psys_cache_paths(sim, cfra);
 
 		/* for render, child particle paths are computed on the fly */
-		if (part->childtype) {
-			if (!psys->totchild)
-				skip = 1;
-			else if (psys->part->type == PART_HAIR && (psys->flag & PSYS_HAIR_DONE)==0)
-				skip = 1;
+		if (!part->childtype || !psys->totchild)
+			skip = 1;
+		else if (psys->part->type == PART_HAIR && (psys->flag & PSYS_HAIR_DONE)==0)
+			skip = 1;
 
-			if (!skip)
-				psys_cache_child_paths(sim, cfra, 0);
-		}
+		/* psys_cache_paths keeps the child cache around for reuse */
+		if (!skip)
+			psys_cache_child_paths(sim, cfra, 0);
+		else if (psys->childcache)
+			psys_free_child_path_cache(psys);
 	}
 	else if (psys->pathcache)
 		psys_free_path_cache(psys, NULL);
@@ -4219,6 +4367,29 @@ static float update_timestep(ParticleSystem *psys, ParticleSimulationData *sim,
 /*			System Core							*/
 /************************************************/
 /* unbaked particles are calculated dynamically */
+/* particles can be integrated in any order as long as nothing draws from the
+ * shared random generators: brownian motion, noisy effectors and collisions */
+static int dynamics_step_is_threadsafe(ParticleSimulationData *sim)
+{
+	ParticleSystem *psys = sim->psys;
+	EffectorCache *eff;
+
+	if (psys->totpart < 256)
+		return 0;
+
+	if (psys->part->brownfac != 0.0f || sim->colliders)
+		return 0;
+
+	if (psys->effectors) {
+		for (eff = psys->effectors->first; eff; eff = eff->next) {
+			if (eff->pd && eff->pd->f_noise > 0.0f)
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
 static void dynamics_step(ParticleSimulationData *sim, float cfra)
 {
 	ParticleSystem *psys = sim->psys;
@@ -4284,11 +4455,13 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 		case PART_PHYS_FLUID:
 		{
 			ParticleTarget *pt = psys->targets.first;
-			psys_update_particle_bvhtree(psys, cfra);
+			/* cells the size of the interaction radius, so a query visits 3x3x3 of them */
+			float cellsize = part->fluid->radius * (part->fluid->flag & SPH_FAC_RADIUS ? 4.0f * part->size : 1.0f);
+			psys_update_particle_sphgrid(psys, cfra, cellsize);
 			
-			for (; pt; pt=pt->next) {  /* Updating others systems particle tree for fluid-fluid interaction */
+			for (; pt; pt=pt->next) {  /* Updating others systems particle grid for fluid-fluid interaction */
 				if (pt->ob)
-					psys_update_particle_bvhtree(BLI_findlink(&pt->ob->particlesystem, pt->psys-1), cfra);
+					psys_update_particle_sphgrid(BLI_findlink(&pt->ob->particlesystem, pt->psys-1), cfra, cellsize);
 			}
 			break;
 		}
@@ -4339,6 +4512,7 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 	switch (part->phystype) {
 		case PART_PHYS_NEWTON:
 		{
+			#pragma omp parallel for private (pa) schedule(dynamic,5) if (dynamics_step_is_threadsafe(sim))
 			LOOP_DYNAMIC_PARTICLES {
 				/* do global forces & effectors */
 				basic_integrate(sim, p, pa->state.time, cfra);
@@ -4376,6 +4550,8 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 			psys_sph_init(sim, &sphdata);
 
 			if (part->fluid->solver == SPH_SOLVER_DDR) {
+				int tot_springs = psys->tot_fluidsprings;
+
 				/* Apply SPH forces using double-density relaxation algorithm
 				 * (Clavat et. al.) */
 				#pragma omp parallel for firstprivate (sphdata) private (pa) schedule(dynamic,5)
@@ -4398,6 +4574,12 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 						update_courant_num(sim, pa, dtime, &sphdata);
 				}
 
+				/* new springs were added in thread order, make that independent of threading */
+				if (psys->tot_fluidsprings > tot_springs + 1) {
+					qsort(psys->fluid_springs + tot_springs, psys->tot_fluidsprings - tot_springs,
+					      sizeof(ParticleSpring), sph_spring_compare);
+				}
+
 				sph_springs_modify(psys, timestep);
 
 			}
@@ -30,6 +30,8 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_smallhash.h"
+#include "BLI_task.h"
 
 #include "BKE_pbvh.h"
 #include "BKE_ccg.h"
@@ -239,108 +241,159 @@ void pbvh_grow_nodes(PBVH *bvh, int totnode)
 	bvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(PBVH *bvh, GHash *map,
-                           unsigned int *face_verts,
-                           unsigned int *uniq_verts, int vertex)
+static int vert_index_cmp(const void *a_v, const void *b_v)
 {
-	void *key, **value_p;
+	const int a = *(const int *)a_v, b = *(const int *)b_v;
 
-	key = SET_INT_IN_POINTER(vertex);
-	value_p = BLI_ghash_lookup_p(map, key);
+	return (a > b) - (a < b);
+}
 
-	if (value_p == NULL) {
-		void *value;
-		if (BLI_BITMAP_GET(bvh->vert_bitmap, vertex)) {
-			value = SET_INT_IN_POINTER(~(*face_verts));
-			++(*face_verts);
-		}
-		else {
-			BLI_BITMAP_SET(bvh->vert_bitmap, vertex);
-			value = SET_INT_IN_POINTER(*uniq_verts);
-			++(*uniq_verts);
-		}
-		
-		BLI_ghash_insert(map, key, value);
-		return GET_INT_FROM_POINTER(value);
+/* Index of a vertex in a sorted array of unique vertex indices */
+static int vert_index_find(const int *sorted, int tot, int vertex)
+{
+	int lo = 0, hi = tot - 1;
+
+	while (lo < hi) {
+		const int mid = (lo + hi) / 2;
+
+		if (sorted[mid] < vertex)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	else {
-		return GET_INT_FROM_POINTER(*value_p);
+
+	return lo;
+}
+
+/* Assign every vertex to the first leaf node that uses it, the vertex is
+ * part of the unique vertices of that node */
+static void build_mesh_vert_node_map(PBVH *bvh)
+{
+	int n, i, j;
+
+	for (i = 0; i < bvh->totvert; i++)
+		bvh->vert_node_map[i] = -1;
+
+	for (n = 0; n < bvh->totnode; n++) {
+		PBVHNode *node = &bvh->nodes[n];
+
+		if (!(node->flag & PBVH_Leaf))
+			continue;
+
+		for (i = 0; i < node->totprim; i++) {
+			MFace *f = bvh->faces + node->prim_indices[i];
+			int sides = f->v4 ? 4 : 3;
+
+			for (j = 0; j < sides; j++) {
+				int vertex = (&f->v1)[j];
+
+				if (bvh->vert_node_map[vertex] == -1)
+					bvh->vert_node_map[vertex] = n;
+			}
+		}
 	}
 }
 
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node)
+/* Find vertices used by the faces in this node, only reads the vertex to
+ * node map so leaf nodes can be built in parallel */
+static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node, int node_index)
 {
-	GHashIterator *iter;
-	GHash *map;
-	int i, j, totface;
+	int *sorted, *remap;
+	int i, j, totface, totcorner, totvert, uniq, other;
 
-	node->uniq_verts = node->face_verts = 0;
 	totface = node->totprim;
 
-	/* reserve size is rough guess */
-	map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
-
-	node->face_vert_indices = MEM_callocN(sizeof(int) * 4 * totface,
-	                                      "bvh node face vert indices");
+	/* gather all corner vertices, and sort them to find the unique ones */
+	sorted = MEM_mallocN(sizeof(int) * 4 * totface, "bvh node sorted verts");
+	totcorner = 0;
 
 	for (i = 0; i < totface; ++i) {
 		MFace *f = bvh->faces + node->prim_indices[i];
 		int sides = f->v4 ? 4 : 3;
 
-		for (j = 0; j < sides; ++j) {
-			node->face_vert_indices[i][j] =
-			        map_insert_vert(bvh, map, &node->face_verts,
-			                        &node->uniq_verts, (&f->v1)[j]);
-		}
+		for (j = 0; j < sides; ++j)
+			sorted[totcorner++] = (&f->v1)[j];
 	}
 
-	node->vert_indices = MEM_callocN(sizeof(int) *
-	                                 (node->uniq_verts + node->face_verts),
-	                                 "bvh node vert indices");
+	qsort(sorted, totcorner, sizeof(int), vert_index_cmp);
+
+	for (i = 0, totvert = 0; i < totcorner; i++) {
+		if (totvert == 0 || sorted[totvert - 1] != sorted[i])
+			sorted[totvert++] = sorted[i];
+	}
+
+	node->uniq_verts = 0;
+	for (i = 0; i < totvert; i++) {
+		if (bvh->vert_node_map[sorted[i]] == node_index)
+			node->uniq_verts++;
+	}
+	node->face_verts = totvert - node->uniq_verts;
 
 	/* Build the vertex list, unique verts first */
-	for (iter = BLI_ghashIterator_new(map), i = 0;
-	     BLI_ghashIterator_done(iter) == false;
-	     BLI_ghashIterator_step(iter), ++i)
-	{
-		void *value = BLI_ghashIterator_getValue(iter);
-		int ndx = GET_INT_FROM_POINTER(value);
+	node->vert_indices = MEM_mallocN(sizeof(int) * totvert, "bvh node vert indices");
+	remap = MEM_mallocN(sizeof(int) * totvert, "bvh node vert remap");
 
-		if (ndx < 0)
-			ndx = -ndx + node->uniq_verts - 1;
+	for (i = 0, uniq = 0, other = node->uniq_verts; i < totvert; i++) {
+		int ndx = (bvh->vert_node_map[sorted[i]] == node_index) ? uniq++ : other++;
 
-		node->vert_indices[ndx] =
-		    GET_INT_FROM_POINTER(BLI_ghashIterator_getKey(iter));
+		node->vert_indices[ndx] = sorted[i];
+		remap[i] = ndx;
 	}
 
-	BLI_ghashIterator_free(iter);
+	node->face_vert_indices = MEM_callocN(sizeof(int) * 4 * totface,
+	                                      "bvh node face vert indices");
 
 	for (i = 0; i < totface; ++i) {
 		MFace *f = bvh->faces + node->prim_indices[i];
 		int sides = f->v4 ? 4 : 3;
-		
+
 		for (j = 0; j < sides; ++j) {
-			if (node->face_vert_indices[i][j] < 0)
-				node->face_vert_indices[i][j] =
-				        -node->face_vert_indices[i][j] +
-				        node->uniq_verts - 1;
+			node->face_vert_indices[i][j] =
+			        remap[vert_index_find(sorted, totvert, (&f->v1)[j])];
 		}
 	}
 
-	if (!G.background) {
-		node->draw_buffers =
-		        GPU_build_mesh_buffers(node->face_vert_indices,
-		                               bvh->faces, bvh->verts,
-		                               node->prim_indices,
-		                               node->totprim);
+	MEM_freeN(sorted);
+	MEM_freeN(remap);
+}
+
+static void build_mesh_leaf_nodes_range(void *userdata, int start, int stop)
+{
+	PBVH *bvh = userdata;
+	int n;
+
+	for (n = start; n < stop; n++) {
+		if (bvh->nodes[n].flag & PBVH_Leaf)
+			build_mesh_leaf_node(bvh, &bvh->nodes[n], n);
 	}
+}
 
-	node->flag |= PBVH_UpdateDrawBuffers;
+/* Build the vertex lists of all leaf nodes, and then their draw buffers,
+ * which need the OpenGL context of the main thread */
+static void build_mesh_leaf_nodes(PBVH *bvh)
+{
+	int n;
 
-	BLI_ghash_free(map, NULL, NULL);
+	build_mesh_vert_node_map(bvh);
+
+	BLI_task_parallel_range_ex(0, bvh->totnode, bvh, build_mesh_leaf_nodes_range, 2);
+
+	for (n = 0; n < bvh->totnode; n++) {
+		PBVHNode *node = &bvh->nodes[n];
+
+		if (!(node->flag & PBVH_Leaf))
+			continue;
+
+		if (!G.background) {
+			node->draw_buffers =
+			        GPU_build_mesh_buffers(node->face_vert_indices,
+			                               bvh->faces, bvh->verts,
+			                               node->prim_indices,
+			                               node->totprim);
+		}
+
+		node->flag |= PBVH_UpdateDrawBuffers;
+	}
 }
 
 static void build_grids_leaf_node(PBVH *bvh, PBVHNode *node)
@@ -375,10 +428,9 @@ static void build_leaf(PBVH *bvh, int node_index, BBC *prim_bbc,
 
 	/* Still need vb for searches */
 	update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
-		
-	if (bvh->faces)
-		build_mesh_leaf_node(bvh, bvh->nodes + node_index);
-	else
+
+	/* mesh leaf nodes are built all at once after the tree */
+	if (!bvh->faces)
 		build_grids_leaf_node(bvh, bvh->nodes + node_index);
 }
 
@@ -428,6 +480,7 @@ static int leaf_needs_material_split(PBVH *bvh, int offset, int count)
 static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
                       int offset, int count)
 {
+	PBVHNode *node, *children;
 	int i, axis, end, below_leaf_limit;
 	BB cb_backing;
 
@@ -444,9 +497,6 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
 	bvh->nodes[node_index].children_offset = bvh->totnode;
 	pbvh_grow_nodes(bvh, bvh->totnode + 2);
 
-	/* Update parent node bounding box */
-	update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
-
 	if (!below_leaf_limit) {
 		/* Find axis with widest range of primitive centroids */
 		if (!cb) {
@@ -474,6 +524,17 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
 	          prim_bbc, offset, end - offset);
 	build_sub(bvh, bvh->nodes[node_index].children_offset + 1, NULL,
 	          prim_bbc, end, offset + count - end);
+
+	/* Update parent node bounding box from the children, instead of
+	 * looping over all primitives again. Node array may have been
+	 * reallocated while building the children. */
+	node = &bvh->nodes[node_index];
+	children = &bvh->nodes[node->children_offset];
+
+	BB_reset(&node->vb);
+	BB_expand_with_bb(&node->vb, &children[0].vb);
+	BB_expand_with_bb(&node->vb, &children[1].vb);
+	node->orig_vb = node->vb;
 }
 
 static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -501,17 +562,44 @@ static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
 	build_sub(bvh, 0, cb, prim_bbc, 0, totprim);
 }
 
+typedef struct PBVHBuildBBCData {
+	PBVH *bvh;
+	BBC *prim_bbc;
+} PBVHBuildBBCData;
+
+static void build_mesh_prim_bbc_range(void *userdata, int start, int stop)
+{
+	PBVHBuildBBCData *data = userdata;
+	MFace *faces = data->bvh->faces;
+	MVert *verts = data->bvh->verts;
+	int i, j;
+
+	for (i = start; i < stop; ++i) {
+		MFace *f = faces + i;
+		const int sides = f->v4 ? 4 : 3;
+		BBC *bbc = data->prim_bbc + i;
+
+		BB_reset((BB *)bbc);
+
+		for (j = 0; j < sides; ++j)
+			BB_expand((BB *)bbc, verts[(&f->v1)[j]].co);
+
+		BBC_update_centroid(bbc);
+	}
+}
+
 /* Do a full rebuild with on Mesh data structure */
 void BKE_pbvh_build_mesh(PBVH *bvh, MFace *faces, MVert *verts, int totface, int totvert, struct CustomData *vdata)
 {
+	PBVHBuildBBCData data;
 	BBC *prim_bbc = NULL;
 	BB cb;
-	int i, j;
+	int i;
 
 	bvh->type = PBVH_FACES;
 	bvh->faces = faces;
 	bvh->verts = verts;
-	bvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
+	bvh->vert_node_map = MEM_mallocN(sizeof(int) * totvert, "bvh->vert_node_map");
 	bvh->totvert = totvert;
 	bvh->leaf_limit = LEAF_LIMIT;
 	bvh->vdata = vdata;
@@ -521,36 +609,52 @@ void BKE_pbvh_build_mesh(PBVH *bvh, MFace *faces, MVert *verts, int totface, int
 	/* For each face, store the AABB and the AABB centroid */
 	prim_bbc = MEM_mallocN(sizeof(BBC) * totface, "prim_bbc");
 
-	for (i = 0; i < totface; ++i) {
-		MFace *f = faces + i;
-		const int sides = f->v4 ? 4 : 3;
-		BBC *bbc = prim_bbc + i;
+	data.bvh = bvh;
+	data.prim_bbc = prim_bbc;
+	BLI_task_parallel_range_ex(0, totface, &data, build_mesh_prim_bbc_range, 1024);
 
-		BB_reset((BB *)bbc);
+	for (i = 0; i < totface; ++i)
+		BB_expand(&cb, prim_bbc[i].bcentroid);
 
-		for (j = 0; j < sides; ++j)
-			BB_expand((BB *)bbc, verts[(&f->v1)[j]].co);
+	if (totface) {
+		pbvh_build(bvh, &cb, prim_bbc, totface);
+		build_mesh_leaf_nodes(bvh);
+	}
 
-		BBC_update_centroid(bbc);
+	MEM_freeN(prim_bbc);
+	MEM_freeN(bvh->vert_node_map);
+	bvh->vert_node_map = NULL;
+}
 
-		BB_expand(&cb, bbc->bcentroid);
-	}
+static void build_grids_prim_bbc_range(void *userdata, int start, int stop)
+{
+	PBVHBuildBBCData *data = userdata;
+	CCGKey *key = &data->bvh->gridkey;
+	int gridsize = key->grid_size;
+	int i, j;
 
-	if (totface)
-		pbvh_build(bvh, &cb, prim_bbc, totface);
+	for (i = start; i < stop; ++i) {
+		CCGElem *grid = data->bvh->grids[i];
+		BBC *bbc = data->prim_bbc + i;
 
-	MEM_freeN(prim_bbc);
-	MEM_freeN(bvh->vert_bitmap);
+		BB_reset((BB *)bbc);
+
+		for (j = 0; j < gridsize * gridsize; ++j)
+			BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+
+		BBC_update_centroid(bbc);
+	}
 }
 
 /* Do a full rebuild with on Grids data structure */
 void BKE_pbvh_build_grids(PBVH *bvh, CCGElem **grids, DMGridAdjacency *gridadj,
                           int totgrid, CCGKey *key, void **gridfaces, DMFlagMat *flagmats, BLI_bitmap **grid_hidden)
 {
+	PBVHBuildBBCData data;
 	BBC *prim_bbc = NULL;
 	BB cb;
 	int gridsize = key->grid_size;
-	int i, j;
+	int i;
 
 	bvh->type = PBVH_GRIDS;
 	bvh->grids = grids;
@@ -567,19 +671,12 @@ void BKE_pbvh_build_grids(PBVH *bvh, CCGElem **grids, DMGridAdjacency *gridadj,
 	/* For each grid, store the AABB and the AABB centroid */
 	prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-	for (i = 0; i < totgrid; ++i) {
-		CCGElem *grid = grids[i];
-		BBC *bbc = prim_bbc + i;
+	data.bvh = bvh;
+	data.prim_bbc = prim_bbc;
+	BLI_task_parallel_range_ex(0, totgrid, &data, build_grids_prim_bbc_range, 64);
 
-		BB_reset((BB *)bbc);
-
-		for (j = 0; j < gridsize * gridsize; ++j)
-			BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-
-		BBC_update_centroid(bbc);
-
-		BB_expand(&cb, bbc->bcentroid);
-	}
+	for (i = 0; i < totgrid; ++i)
+		BB_expand(&cb, prim_bbc[i].bcentroid);
 
 	if (totgrid)
 		pbvh_build(bvh, &cb, prim_bbc, totgrid);
@@ -1183,13 +1280,13 @@ void BKE_pbvh_get_grid_updates(PBVH *bvh, int clear, void ***gridfaces, int *tot
 {
 	PBVHIter iter;
 	PBVHNode *node;
-	GHashIterator *hiter;
-	GHash *map;
+	SmallHashIter hiter;
+	SmallHash map;
 	void *face, **faces;
 	unsigned i;
 	int tot;
 
-	map = BLI_ghash_ptr_new("pbvh_get_grid_updates gh");
+	BLI_smallhash_init(&map);
 
 	pbvh_iter_begin(&iter, bvh, NULL, NULL);
 
@@ -1197,8 +1294,7 @@ void BKE_pbvh_get_grid_updates(PBVH *bvh, int clear, void ***gridfaces, int *tot
 		if (node->flag & PBVH_UpdateNormals) {
 			for (i = 0; i < node->totprim; ++i) {
 				face = bvh->gridfaces[node->prim_indices[i]];
-				if (!BLI_ghash_lookup(map, face))
-					BLI_ghash_insert(map, face, face);
+				BLI_smallhash_reinsert(&map, (uintptr_t)face, face);
 			}
 
 			if (clear)
@@ -1208,26 +1304,24 @@ void BKE_pbvh_get_grid_updates(PBVH *bvh, int clear, void ***gridfaces, int *tot
 
 	pbvh_iter_end(&iter);
 	
-	tot = BLI_ghash_size(map);
+	tot = BLI_smallhash_count(&map);
 	if (tot == 0) {
 		*totface = 0;
 		*gridfaces = NULL;
-		BLI_ghash_free(map, NULL, NULL);
+		BLI_smallhash_release(&map);
 		return;
 	}
 
 	faces = MEM_callocN(sizeof(void *) * tot, "PBVH Grid Faces");
 
-	for (hiter = BLI_ghashIterator_new(map), i = 0;
-	     BLI_ghashIterator_done(hiter) == false;
-	     BLI_ghashIterator_step(hiter), ++i)
+	for (face = BLI_smallhash_iternew(&map, &hiter, NULL), i = 0;
+	     face;
+	     face = BLI_smallhash_iternext(&hiter, NULL), ++i)
 	{
-		faces[i] = BLI_ghashIterator_getKey(hiter);
+		faces[i] = face;
 	}
 
-	BLI_ghashIterator_free(hiter);
-
-	BLI_ghash_free(map, NULL, NULL);
+	BLI_smallhash_release(&map);
 
 	*totface = tot;
 	*gridfaces = faces;
@@ -1764,45 +1858,40 @@ int BKE_pbvh_isDeformed(PBVH *pbvh)
 }
 /* Proxies */
 
+/* Proxies only touch the node itself, threads may add or free proxies of
+ * different nodes at the same time, a single node must not be shared though */
 PBVHProxyNode *BKE_pbvh_node_add_proxy(PBVH *bvh, PBVHNode *node)
 {
 	int index, totverts;
 
-	#pragma omp critical
-	{
-
-		index = node->proxy_count;
+	index = node->proxy_count;
 
-		node->proxy_count++;
+	node->proxy_count++;
 
-		if (node->proxies)
-			node->proxies = MEM_reallocN(node->proxies, node->proxy_count * sizeof(PBVHProxyNode));
-		else
-			node->proxies = MEM_mallocN(sizeof(PBVHProxyNode), "PBVHNodeProxy");
+	if (node->proxies)
+		node->proxies = MEM_reallocN(node->proxies, node->proxy_count * sizeof(PBVHProxyNode));
+	else
+		node->proxies = MEM_mallocN(sizeof(PBVHProxyNode), "PBVHNodeProxy");
 
-		BKE_pbvh_node_num_verts(bvh, node, &totverts, NULL);
-		node->proxies[index].co = MEM_callocN(sizeof(float[3]) * totverts, "PBVHNodeProxy.co");
-	}
+	BKE_pbvh_node_num_verts(bvh, node, &totverts, NULL);
+	node->proxies[index].co = MEM_callocN(sizeof(float[3]) * totverts, "PBVHNodeProxy.co");
 
 	return node->proxies + index;
 }
 
 void BKE_pbvh_node_free_proxies(PBVHNode *node)
 {
-	#pragma omp critical
-	{
-		int p;
+	int p;
 
-		for (p = 0; p < node->proxy_count; p++) {
-			MEM_freeN(node->proxies[p].co);
-			node->proxies[p].co = NULL;
-		}
+	for (p = 0; p < node->proxy_count; p++) {
+		MEM_freeN(node->proxies[p].co);
+		node->proxies[p].co = NULL;
+	}
 
-		MEM_freeN(node->proxies);
-		node->proxies = NULL;
+	MEM_freeN(node->proxies);
+	node->proxies = NULL;
 
-		node->proxy_count = 0;
-	}
+	node->proxy_count = 0;
 }
 
 void BKE_pbvh_gather_proxies(PBVH *pbvh, PBVHNode ***r_array,  int *r_tot)
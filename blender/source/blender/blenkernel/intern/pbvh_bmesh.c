@@ -29,6 +29,7 @@
 #include "BLI_ghash.h"
 #include "BLI_heap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BKE_ccg.h"
 #include "BKE_DerivedMesh.h"
@@ -513,27 +514,38 @@ static int edge_queue_tri_in_sphere(const EdgeQueue *q, BMFace *f)
 }
 
 /* Return true if the vertex mask is less than 1.0, false otherwise */
-static bool check_mask(EdgeQueueContext *eq_ctx, BMVert *v)
+static bool check_mask(const int cd_vert_mask_offset, BMVert *v)
 {
-	return (BM_ELEM_CD_GET_FLOAT(v, eq_ctx->cd_vert_mask_offset) < 1.0f);
+	return (BM_ELEM_CD_GET_FLOAT(v, cd_vert_mask_offset) < 1.0f);
 }
 
-static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e,
-                              float priority)
+/* Don't let topology update affect fully masked vertices. This used to
+ * have a 50% mask cutoff, with the reasoning that you can't do a 50%
+ * topology update. But this gives an ugly border in the mesh. The mask
+ * should already make the brush move the vertices only 50%, which means
+ * that topology updates will also happen less frequent, that should be
+ * enough. */
+static bool edge_queue_edge_mask_test(const int cd_vert_mask_offset, BMEdge *e)
+{
+	return (check_mask(cd_vert_mask_offset, e->v1) || check_mask(cd_vert_mask_offset, e->v2));
+}
+
+static void edge_queue_insert_pair(EdgeQueueContext *eq_ctx, BMEdge *e,
+                                   float priority)
 {
 	BMVert **pair;
 
-	/* Don't let topology update affect fully masked vertices. This used to
-	 * have a 50% mask cutoff, with the reasoning that you can't do a 50%
-	 * topology update. But this gives an ugly border in the mesh. The mask
-	 * should already make the brush move the vertices only 50%, which means
-	 * that topology updates will also happen less frequent, that should be
-	 * enough. */
-	if (check_mask(eq_ctx, e->v1) || check_mask(eq_ctx, e->v2)) {
-		pair = BLI_mempool_alloc(eq_ctx->pool);
-		pair[0] = e->v1;
-		pair[1] = e->v2;
-		BLI_heap_insert(eq_ctx->q->heap, priority, pair);
+	pair = BLI_mempool_alloc(eq_ctx->pool);
+	pair[0] = e->v1;
+	pair[1] = e->v2;
+	BLI_heap_insert(eq_ctx->q->heap, priority, pair);
+}
+
+static void edge_queue_insert(EdgeQueueContext *eq_ctx, BMEdge *e,
+                              float priority)
+{
+	if (edge_queue_edge_mask_test(eq_ctx->cd_vert_mask_offset, e)) {
+		edge_queue_insert_pair(eq_ctx, e, priority);
 	}
 }
 
@@ -545,14 +557,6 @@ static void long_edge_queue_edge_add(EdgeQueueContext *eq_ctx,
 		edge_queue_insert(eq_ctx, e, 1.0f / len_sq);
 }
 
-static void short_edge_queue_edge_add(EdgeQueueContext *eq_ctx,
-                                      BMEdge *e)
-{
-	const float len_sq = BM_edge_calc_length_squared(e);
-	if (len_sq < eq_ctx->q->limit_len_squared)
-		edge_queue_insert(eq_ctx, e, len_sq);
-}
-
 static void long_edge_queue_face_add(EdgeQueueContext *eq_ctx,
                                      BMFace *f)
 {
@@ -568,19 +572,121 @@ static void long_edge_queue_face_add(EdgeQueueContext *eq_ctx,
 	}
 }
 
-static void short_edge_queue_face_add(EdgeQueueContext *eq_ctx,
-                                      BMFace *f)
+/* Edges found by the threaded queue gathering, one array per node. The
+ * heap, the pair mempool and the BMesh are not thread-safe, so threads
+ * only test the faces of their node, the heap is filled afterwards in node
+ * order, which gives the same queue as a single threaded pass. */
+typedef struct EdgeQueueItem {
+	BMEdge *e;
+	float priority;
+} EdgeQueueItem;
+
+typedef struct EdgeQueueNodeItems {
+	EdgeQueueItem *items;
+	int totitem, allocitem;
+} EdgeQueueNodeItems;
+
+typedef struct EdgeQueueGatherData {
+	const EdgeQueue *q;
+	int cd_vert_mask_offset;
+	bool use_long;
+	PBVHNode **nodes;
+	EdgeQueueNodeItems *node_items;
+} EdgeQueueGatherData;
+
+static void edge_queue_node_item_add(EdgeQueueNodeItems *node_items, BMEdge *e, float priority)
 {
-	if (edge_queue_tri_in_sphere(eq_ctx->q, f)) {
-		BMLoop *l_iter;
-		BMLoop *l_first;
+	EdgeQueueItem *item;
 
-		/* Check each edge of the face */
-		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-		do {
-			short_edge_queue_edge_add(eq_ctx, l_iter->e);
-		} while ((l_iter = l_iter->next) != l_first);
+	if (node_items->totitem == node_items->allocitem) {
+		node_items->allocitem = node_items->allocitem ? node_items->allocitem * 2 : 64;
+		node_items->items = MEM_reallocN(node_items->items, sizeof(EdgeQueueItem) * node_items->allocitem);
+	}
+
+	item = &node_items->items[node_items->totitem++];
+	item->e = e;
+	item->priority = priority;
+}
+
+static void edge_queue_gather_task_cb(void *userdata, int start, int stop)
+{
+	EdgeQueueGatherData *data = userdata;
+	const EdgeQueue *q = data->q;
+	int n;
+
+	for (n = start; n < stop; n++) {
+		EdgeQueueNodeItems *node_items = &data->node_items[n];
+		GHashIterator gh_iter;
+
+		/* Check each face */
+		GHASH_ITER (gh_iter, data->nodes[n]->bm_faces) {
+			BMFace *f = BLI_ghashIterator_getKey(&gh_iter);
+			BMLoop *l_iter;
+			BMLoop *l_first;
+
+			if (!edge_queue_tri_in_sphere(q, f))
+				continue;
+
+			/* Check each edge of the face */
+			l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+			do {
+				BMEdge *e = l_iter->e;
+				const float len_sq = BM_edge_calc_length_squared(e);
+
+				if (data->use_long ?
+				    (len_sq > q->limit_len_squared) :
+				    (len_sq < q->limit_len_squared))
+				{
+					if (edge_queue_edge_mask_test(data->cd_vert_mask_offset, e)) {
+						edge_queue_node_item_add(node_items, e,
+						                         data->use_long ? 1.0f / len_sq : len_sq);
+					}
+				}
+			} while ((l_iter = l_iter->next) != l_first);
+		}
+	}
+}
+
+static void edge_queue_gather(EdgeQueueContext *eq_ctx, PBVH *bvh, bool use_long)
+{
+	EdgeQueueGatherData data;
+	PBVHNode **nodes;
+	int n, i, totnode = 0;
+
+	nodes = MEM_mallocN(sizeof(*nodes) * bvh->totnode, __func__);
+
+	for (n = 0; n < bvh->totnode; n++) {
+		PBVHNode *node = &bvh->nodes[n];
+
+		/* Check leaf nodes marked for topology update */
+		if ((node->flag & PBVH_Leaf) &&
+			(node->flag & PBVH_UpdateTopology))
+		{
+			nodes[totnode++] = node;
+		}
+	}
+
+	data.q = eq_ctx->q;
+	data.cd_vert_mask_offset = eq_ctx->cd_vert_mask_offset;
+	data.use_long = use_long;
+	data.nodes = nodes;
+	data.node_items = MEM_callocN(sizeof(*data.node_items) * totnode, __func__);
+
+	BLI_task_parallel_range_ex(0, totnode, &data, edge_queue_gather_task_cb, 2);
+
+	for (n = 0; n < totnode; n++) {
+		EdgeQueueNodeItems *node_items = &data.node_items[n];
+
+		for (i = 0; i < node_items->totitem; i++) {
+			edge_queue_insert_pair(eq_ctx, node_items->items[i].e, node_items->items[i].priority);
+		}
+
+		if (node_items->items)
+			MEM_freeN(node_items->items);
 	}
+
+	MEM_freeN(data.node_items);
+	MEM_freeN(nodes);
 }
 
 /* Create a priority queue containing vertex pairs connected by a long
@@ -596,30 +702,12 @@ static void long_edge_queue_create(EdgeQueueContext *eq_ctx,
                                    PBVH *bvh, const float center[3],
                                    float radius)
 {
-	int n;
-
 	eq_ctx->q->heap = BLI_heap_new();
 	eq_ctx->q->center = center;
 	eq_ctx->q->radius_squared = radius * radius;
 	eq_ctx->q->limit_len_squared = bvh->bm_max_edge_len * bvh->bm_max_edge_len;
 
-	for (n = 0; n < bvh->totnode; n++) {
-		PBVHNode *node = &bvh->nodes[n];
-
-		/* Check leaf nodes marked for topology update */
-		if ((node->flag & PBVH_Leaf) &&
-			(node->flag & PBVH_UpdateTopology))
-		{
-			GHashIterator gh_iter;
-
-			/* Check each face */
-			GHASH_ITER (gh_iter, node->bm_faces) {
-				BMFace *f = BLI_ghashIterator_getKey(&gh_iter);
-
-				long_edge_queue_face_add(eq_ctx, f);
-			}
-		}
-	}
+	edge_queue_gather(eq_ctx, bvh, true);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -635,30 +723,12 @@ static void short_edge_queue_create(EdgeQueueContext *eq_ctx,
                                     PBVH *bvh, const float center[3],
                                     float radius)
 {
-	int n;
-
 	eq_ctx->q->heap = BLI_heap_new();
 	eq_ctx->q->center = center;
 	eq_ctx->q->radius_squared = radius * radius;
 	eq_ctx->q->limit_len_squared = bvh->bm_min_edge_len * bvh->bm_min_edge_len;
 
-	for (n = 0; n < bvh->totnode; n++) {
-		PBVHNode *node = &bvh->nodes[n];
-
-		/* Check leaf nodes marked for topology update */
-		if ((node->flag & PBVH_Leaf) &&
-			(node->flag & PBVH_UpdateTopology))
-		{
-			GHashIterator gh_iter;
-
-			/* Check each face */
-			GHASH_ITER (gh_iter, node->bm_faces) {
-				BMFace *f = BLI_ghashIterator_getKey(&gh_iter);
-
-				short_edge_queue_face_add(eq_ctx, f);
-			}
-		}
-	}
+	edge_queue_gather(eq_ctx, bvh, false);
 }
 
 /*************************** Topology update **************************/
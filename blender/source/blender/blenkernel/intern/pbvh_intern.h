@@ -146,8 +146,9 @@ struct PBVH {
 	BLI_bitmap **grid_hidden;
 
 	/* Only used during BVH build and update,
-	 * don't need to remain valid after */
-	BLI_bitmap *vert_bitmap;
+	 * don't need to remain valid after. Index of the
+	 * leaf node that has the vertex as unique vertex */
+	int *vert_node_map;
 
 #ifdef PERFCNTRS
 	int perf_modified;
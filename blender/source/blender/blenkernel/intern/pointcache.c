@@ -48,6 +48,8 @@
 #include "DNA_smoke_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
@@ -158,10 +160,10 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
 static int ptcache_basic_header_write(PTCacheFile *pf)
 {
 	/* Custom functions should write these basic elements too! */
-	if (!fwrite(&pf->totpoint, sizeof(unsigned int), 1, pf->fp))
+	if (!ptcache_file_write(pf, &pf->totpoint, 1, sizeof(unsigned int)))
 		return 0;
 	
-	if (!fwrite(&pf->data_types, sizeof(unsigned int), 1, pf->fp))
+	if (!ptcache_file_write(pf, &pf->data_types, 1, sizeof(unsigned int)))
 		return 0;
 
 	return 1;
@@ -1526,10 +1528,241 @@ static int ptcache_filename(PTCacheID *pid, char *filename, int cfra, short do_p
 	return len; /* make sure the above string is always 16 chars */
 }
 
+/* Write behind
+ *
+ * While baking, files written with ptcache_file_open() are collected in
+ * memory and only compressed and written to disk by separate threads once
+ * closed, so the simulation doesn't wait on compression and disk access.
+ * Files still queued count as existing, opening or clearing them first waits
+ * for them to be written, so files always appear in the order they were
+ * closed. */
+
+#define PTCACHE_WRITE_BEHIND_MAX_THREADS  8
+/* pending memory at which closing a file waits for others to be written */
+#define PTCACHE_WRITE_BEHIND_MAX_SIZE     (256 * 1024 * 1024)
+
+/* part of a written file, plain data or data still to be compressed */
+typedef struct PTCacheWriteSegment {
+	struct PTCacheWriteSegment *next, *prev;
+	unsigned char *data;
+	unsigned int len, maxlen;
+	int compress;  /* compression mode, -1 for plain data */
+} PTCacheWriteSegment;
+
+typedef struct PTCacheWriteFile {
+	struct PTCacheWriteFile *next, *prev;
+	PointCache *cache;
+	char filename[MAX_PTCACHE_FILE];
+	ListBase segments;
+	size_t size;
+	bool running;
+} PTCacheWriteFile;
+
+static struct {
+	bool active, stop;
+	ListBase threads;
+	ListBase queue;    /* PTCacheWriteFile, oldest first, also the ones being written */
+	size_t size;
+	ThreadMutex mutex;
+	ThreadCondition cond;  /* notified when a file is queued or written */
+} ptcache_write_behind = {false, false, {NULL, NULL}, {NULL, NULL}, 0, BLI_MUTEX_INITIALIZER};
+
+static void ptcache_write_behind_file_free(PTCacheWriteFile *wf)
+{
+	PTCacheWriteSegment *seg;
+
+	while ((seg = BLI_pophead(&wf->segments))) {
+		MEM_freeN(seg->data);
+		MEM_freeN(seg);
+	}
+
+	MEM_freeN(wf);
+}
+
+static void ptcache_write_behind_file_write(PTCacheWriteFile *wf)
+{
+	PTCacheFile pf = {NULL};
+	PTCacheWriteSegment *seg;
+	int error = 0;
+
+	pf.fp = BLI_fopen(wf->filename, "wb");
+
+	if (pf.fp == NULL) {
+		if (G.debug & G_DEBUG)
+			printf("Error opening disk cache file for writing\n");
+		return;
+	}
+
+	for (seg = wf->segments.first; seg && !error; seg = seg->next) {
+		if (seg->compress == -1) {
+			error = !ptcache_file_write(&pf, seg->data, seg->len, sizeof(unsigned char));
+		}
+		else {
+			unsigned char *out = MEM_callocN(LZO_OUT_LEN(seg->len) * 4, "pointcache_lzo_buffer");
+			ptcache_file_compressed_write(&pf, seg->data, seg->len, out, seg->compress);
+			MEM_freeN(out);
+		}
+	}
+
+	fclose(pf.fp);
+
+	if (error && G.debug & G_DEBUG)
+		printf("Error writing to disk cache\n");
+}
+
+static void *ptcache_write_behind_thread(void *UNUSED(arg))
+{
+	BLI_mutex_lock(&ptcache_write_behind.mutex);
+
+	while (true) {
+		PTCacheWriteFile *wf;
+
+		for (wf = ptcache_write_behind.queue.first; wf; wf = wf->next) {
+			if (!wf->running)
+				break;
+		}
+
+		if (wf == NULL) {
+			if (ptcache_write_behind.stop)
+				break;
+
+			BLI_condition_wait(&ptcache_write_behind.cond, &ptcache_write_behind.mutex);
+			continue;
+		}
+
+		wf->running = true;
+		BLI_mutex_unlock(&ptcache_write_behind.mutex);
+
+		ptcache_write_behind_file_write(wf);
+
+		BLI_mutex_lock(&ptcache_write_behind.mutex);
+		BLI_remlink(&ptcache_write_behind.queue, wf);
+		ptcache_write_behind.size -= wf->size;
+		BLI_condition_notify_all(&ptcache_write_behind.cond);
+
+		ptcache_write_behind_file_free(wf);
+	}
+
+	BLI_mutex_unlock(&ptcache_write_behind.mutex);
+
+	return NULL;
+}
+
+static void ptcache_write_behind_begin(void)
+{
+	int a, totthread = BLI_system_thread_count();
+
+	CLAMP(totthread, 1, PTCACHE_WRITE_BEHIND_MAX_THREADS);
+
+	BLI_condition_init(&ptcache_write_behind.cond);
+	ptcache_write_behind.stop = false;
+	ptcache_write_behind.active = true;
+
+	BLI_init_threads(&ptcache_write_behind.threads, ptcache_write_behind_thread, totthread);
+	for (a = 0; a < totthread; a++)
+		BLI_insert_thread(&ptcache_write_behind.threads, NULL);
+}
+
+/* waits for all queued files to be written */
+static void ptcache_write_behind_end(void)
+{
+	BLI_mutex_lock(&ptcache_write_behind.mutex);
+	ptcache_write_behind.stop = true;
+	BLI_condition_notify_all(&ptcache_write_behind.cond);
+	BLI_mutex_unlock(&ptcache_write_behind.mutex);
+
+	BLI_end_threads(&ptcache_write_behind.threads);
+	BLI_condition_end(&ptcache_write_behind.cond);
+
+	ptcache_write_behind.active = false;
+}
+
+static PTCacheWriteFile *ptcache_write_behind_find(PointCache *cache, const char *filename)
+{
+	PTCacheWriteFile *wf;
+
+	for (wf = ptcache_write_behind.queue.first; wf; wf = wf->next) {
+		if (wf->cache == cache && (filename == NULL || STREQ(wf->filename, filename)))
+			return wf;
+	}
+
+	return NULL;
+}
+
+/* wait until the queued files of the cache are written, only the given file if set */
+static void ptcache_write_behind_wait(PointCache *cache, const char *filename)
+{
+	if (!ptcache_write_behind.active)
+		return;
+
+	BLI_mutex_lock(&ptcache_write_behind.mutex);
+	while (ptcache_write_behind_find(cache, filename))
+		BLI_condition_wait(&ptcache_write_behind.cond, &ptcache_write_behind.mutex);
+	BLI_mutex_unlock(&ptcache_write_behind.mutex);
+}
+
+static bool ptcache_write_behind_queued(PointCache *cache, const char *filename)
+{
+	bool queued;
+
+	if (!ptcache_write_behind.active)
+		return false;
+
+	BLI_mutex_lock(&ptcache_write_behind.mutex);
+	queued = (ptcache_write_behind_find(cache, filename) != NULL);
+	BLI_mutex_unlock(&ptcache_write_behind.mutex);
+
+	return queued;
+}
+
+static void ptcache_write_behind_push(PTCacheWriteFile *wf)
+{
+	BLI_mutex_lock(&ptcache_write_behind.mutex);
+
+	/* bound memory use when writing can't keep up */
+	while (ptcache_write_behind.queue.first &&
+	       ptcache_write_behind.size + wf->size > PTCACHE_WRITE_BEHIND_MAX_SIZE)
+	{
+		BLI_condition_wait(&ptcache_write_behind.cond, &ptcache_write_behind.mutex);
+	}
+
+	BLI_addtail(&ptcache_write_behind.queue, wf);
+	ptcache_write_behind.size += wf->size;
+	BLI_condition_notify_all(&ptcache_write_behind.cond);
+
+	BLI_mutex_unlock(&ptcache_write_behind.mutex);
+}
+
+static void ptcache_write_behind_add(PTCacheFile *pf, const void *data, unsigned int len, int compress)
+{
+	PTCacheWriteFile *wf = pf->write_behind;
+	PTCacheWriteSegment *seg = wf->segments.last;
+
+	if (compress == -1 && seg && seg->compress == -1) {
+		/* append to the last plain segment */
+		if (seg->len + len > seg->maxlen) {
+			seg->maxlen = MAX2(seg->maxlen * 2, seg->len + len);
+			seg->data = MEM_reallocN(seg->data, seg->maxlen);
+		}
+	}
+	else {
+		seg = MEM_callocN(sizeof(PTCacheWriteSegment), "PTCacheWriteSegment");
+		seg->compress = compress;
+		seg->maxlen = MAX2(len, (compress == -1) ? 4096 : 0);
+		seg->data = MEM_mallocN(MAX2(seg->maxlen, 1), "PTCacheWriteSegment data");
+		BLI_addtail(&wf->segments, seg);
+	}
+
+	memcpy(seg->data + seg->len, data, len);
+	seg->len += len;
+	wf->size += len;
+}
+
 /* youll need to close yourself after! */
 static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 {
 	PTCacheFile *pf;
+	PTCacheWriteFile *wf = NULL;
 	FILE *fp = NULL;
 	char filename[FILE_MAX * 2];
 
@@ -1542,6 +1775,9 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 	
 	ptcache_filename(pid, filename, cfra, 1, 1);
 
+	/* the previous version of the file may still be queued */
+	ptcache_write_behind_wait(pid->cache, filename);
+
 	if (mode==PTCACHE_FILE_READ) {
 		if (!BLI_exists(filename)) {
 			return NULL;
@@ -1550,18 +1786,26 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 	}
 	else if (mode==PTCACHE_FILE_WRITE) {
 		BLI_make_existing_file(filename); /* will create the dir if needs be, same as //textures is created */
-		fp = BLI_fopen(filename, "wb");
+
+		if (ptcache_write_behind.active) {
+			wf = MEM_callocN(sizeof(PTCacheWriteFile), "PTCacheWriteFile");
+			wf->cache = pid->cache;
+			BLI_strncpy(wf->filename, filename, sizeof(wf->filename));
+		}
+		else
+			fp = BLI_fopen(filename, "wb");
 	}
 	else if (mode==PTCACHE_FILE_UPDATE) {
 		BLI_make_existing_file(filename);
 		fp = BLI_fopen(filename, "rb+");
 	}
 
-	if (!fp)
+	if (!fp && !wf)
 		return NULL;
 
 	pf= MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
 	pf->fp= fp;
+	pf->write_behind = wf;
 	pf->old_format = 0;
 	pf->frame = cfra;
 
@@ -1570,7 +1814,10 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 static void ptcache_file_close(PTCacheFile *pf)
 {
 	if (pf) {
-		fclose(pf->fp);
+		if (pf->write_behind)
+			ptcache_write_behind_push(pf->write_behind);
+		else
+			fclose(pf->fp);
 		MEM_freeN(pf);
 	}
 }
@@ -1627,9 +1874,17 @@ static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, uns
 	int r = 0;
 	unsigned char compressed = 0;
 	size_t out_len= 0;
-	unsigned char *props = MEM_callocN(16 * sizeof(char), "tmp");
+	unsigned char *props;
 	size_t sizeOfIt = 5;
 
+	/* compressed by the thread writing the file */
+	if (pf->write_behind) {
+		ptcache_write_behind_add(pf, in, in_len, mode);
+		return 0;
+	}
+
+	props = MEM_callocN(16 * sizeof(char), "tmp");
+
 	(void)mode; /* unused when building w/o compression */
 
 #ifdef WITH_LZO
@@ -1682,6 +1937,11 @@ static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigne
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
 {
+	if (pf->write_behind) {
+		ptcache_write_behind_add(pf, f, tot * size, -1);
+		return 1;
+	}
+
 	return (fwrite(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_data_read(PTCacheFile *pf)
@@ -1737,10 +1997,10 @@ static int ptcache_file_header_begin_write(PTCacheFile *pf)
 	const char *bphysics = "BPHYSICS";
 	unsigned int typeflag = pf->type + pf->flag;
 	
-	if (fwrite(bphysics, sizeof(char), 8, pf->fp) != 8)
+	if (!ptcache_file_write(pf, bphysics, 8, sizeof(char)))
 		return 0;
 
-	if (!fwrite(&typeflag, sizeof(unsigned int), 1, pf->fp))
+	if (!ptcache_file_write(pf, &typeflag, 1, sizeof(unsigned int)))
 		return 0;
 	
 	return 1;
@@ -2026,6 +2286,196 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 	
 	return pm;
 }
+
+/* Disk cache frame reading
+ *
+ * Frames read from a disk cache are kept per point cache, so scrubbing back
+ * and forth or interpolating between two cached frames doesn't open and
+ * decompress the same files again. When a frame has to be read from disk,
+ * the next few cached frames in the direction of playback are read along with
+ * it, on all threads, which also spreads the decompression. Frames are dropped
+ * whenever the files of the cache change. */
+
+#define PTCACHE_DISK_FRAMES_MAX  8
+#define PTCACHE_DISK_PREFETCH    4
+
+typedef struct PTCacheDiskFrames {
+	ListBase frames;  /* PTCacheMem, most recently used first */
+	int totframe;
+	int last_frame;   /* last frame asked for, gives the playback direction */
+} PTCacheDiskFrames;
+
+/* PointCache -> PTCacheDiskFrames, only accessed with the lock held. The
+ * frames of one cache are only used by the thread evaluating its owner */
+static GHash *ptcache_disk_frames = NULL;
+static ThreadMutex ptcache_disk_frames_lock = BLI_MUTEX_INITIALIZER;
+
+static void ptcache_mem_free(PTCacheMem *pm)
+{
+	ptcache_data_free(pm);
+	ptcache_extra_free(pm);
+	MEM_freeN(pm);
+}
+
+static void ptcache_disk_frames_clear(PointCache *cache)
+{
+	PTCacheDiskFrames *df = NULL;
+	PTCacheMem *pm;
+
+	BLI_mutex_lock(&ptcache_disk_frames_lock);
+	if (ptcache_disk_frames) {
+		df = BLI_ghash_popkey(ptcache_disk_frames, cache, NULL);
+
+		if (BLI_ghash_size(ptcache_disk_frames) == 0) {
+			BLI_ghash_free(ptcache_disk_frames, NULL, NULL);
+			ptcache_disk_frames = NULL;
+		}
+	}
+	BLI_mutex_unlock(&ptcache_disk_frames_lock);
+
+	if (df) {
+		while ((pm = BLI_pophead(&df->frames)))
+			ptcache_mem_free(pm);
+
+		MEM_freeN(df);
+	}
+}
+
+static PTCacheDiskFrames *ptcache_disk_frames_ensure(PointCache *cache)
+{
+	PTCacheDiskFrames *df;
+
+	BLI_mutex_lock(&ptcache_disk_frames_lock);
+	if (ptcache_disk_frames == NULL)
+		ptcache_disk_frames = BLI_ghash_ptr_new("ptcache_disk_frames");
+
+	df = BLI_ghash_lookup(ptcache_disk_frames, cache);
+	if (df == NULL) {
+		df = MEM_callocN(sizeof(PTCacheDiskFrames), "PTCacheDiskFrames");
+		BLI_ghash_insert(ptcache_disk_frames, cache, df);
+	}
+	BLI_mutex_unlock(&ptcache_disk_frames_lock);
+
+	return df;
+}
+
+static PTCacheMem *ptcache_disk_frames_find(PTCacheDiskFrames *df, int cfra)
+{
+	PTCacheMem *pm;
+
+	for (pm = df->frames.first; pm; pm = pm->next) {
+		if (pm->frame == cfra)
+			return pm;
+	}
+
+	return NULL;
+}
+
+static bool ptcache_disk_frames_has(PointCache *cache, int cfra)
+{
+	PTCacheDiskFrames *df = NULL;
+
+	BLI_mutex_lock(&ptcache_disk_frames_lock);
+	if (ptcache_disk_frames)
+		df = BLI_ghash_lookup(ptcache_disk_frames, cache);
+	BLI_mutex_unlock(&ptcache_disk_frames_lock);
+
+	return df && ptcache_disk_frames_find(df, cfra);
+}
+
+static void ptcache_disk_frames_add(PTCacheDiskFrames *df, PTCacheMem *pm)
+{
+	BLI_addhead(&df->frames, pm);
+	df->totframe++;
+
+	while (df->totframe > PTCACHE_DISK_FRAMES_MAX) {
+		PTCacheMem *pm_last = df->frames.last;
+
+		BLI_remlink(&df->frames, pm_last);
+		ptcache_mem_free(pm_last);
+		df->totframe--;
+	}
+}
+
+typedef struct PTCacheDiskRead {
+	PTCacheID *pid;
+	int *frames;
+	PTCacheMem **mems;
+} PTCacheDiskRead;
+
+static void ptcache_disk_read_range(void *userdata, int start, int stop)
+{
+	PTCacheDiskRead *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++)
+		data->mems[i] = ptcache_disk_frame_to_mem(data->pid, data->frames[i]);
+}
+
+/* get frame cfra of a disk cache, the result is owned by the cache of read
+ * frames and stays valid until the next call for the same point cache */
+static PTCacheMem *ptcache_disk_frame_get(PTCacheID *pid, int cfra)
+{
+	PointCache *cache = pid->cache;
+	PTCacheDiskFrames *df = ptcache_disk_frames_ensure(cache);
+	PTCacheMem *pm = ptcache_disk_frames_find(df, cfra);
+	PTCacheMem *mems[PTCACHE_DISK_PREFETCH + 1];
+	int frames[PTCACHE_DISK_PREFETCH + 1];
+	int dir = (cfra < df->last_frame) ? -1 : 1;
+	int step = max_ii(cache->step, 1);
+	int i, fra, totread = 0;
+
+	df->last_frame = cfra;
+
+	if (pm) {
+		/* move to the front, so it isn't the first frame to be dropped */
+		BLI_remlink(&df->frames, pm);
+		BLI_addhead(&df->frames, pm);
+		return pm;
+	}
+
+	frames[totread++] = cfra;
+
+	/* next cached frames in the playback direction that aren't read yet,
+	 * frames may be missing when caching with a step */
+	for (fra = cfra + dir;
+	     totread <= PTCACHE_DISK_PREFETCH && abs(fra - cfra) <= PTCACHE_DISK_PREFETCH * step;
+	     fra += dir)
+	{
+		if (fra >= cache->startframe && fra <= cache->endframe &&
+		    !ptcache_disk_frames_find(df, fra) && BKE_ptcache_id_exist(pid, fra))
+		{
+			frames[totread++] = fra;
+		}
+	}
+
+	/* the file name may assign the stack index, not something to do from threads */
+	if (cache->index < 0) {
+		char filename[MAX_PTCACHE_FILE];
+		ptcache_filename(pid, filename, cfra, 1, 1);
+	}
+
+	if (totread > 1) {
+		PTCacheDiskRead data;
+
+		data.pid = pid;
+		data.frames = frames;
+		data.mems = mems;
+
+		BLI_task_parallel_range_ex(0, totread, &data, ptcache_disk_read_range, 1);
+	}
+	else {
+		mems[0] = ptcache_disk_frame_to_mem(pid, cfra);
+	}
+
+	/* add prefetched frames first, the asked frame ends up most recently used */
+	for (i = totread - 1; i >= 0; i--) {
+		if (mems[i])
+			ptcache_disk_frames_add(df, mems[i]);
+	}
+
+	return mems[0];
+}
 static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 {
 	PTCacheFile *pf = NULL;
@@ -2164,7 +2614,7 @@ static int ptcache_read(PTCacheID *pid, int cfra)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra);
+		pm = ptcache_disk_frame_get(pid, cfra);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -2199,13 +2649,6 @@ static int ptcache_read(PTCacheID *pid, int cfra)
 
 		if (pid->read_extra_data && pm->extradata.first)
 			pid->read_extra_data(pid->calldata, pm, (float)pm->frame);
-
-		/* clean up temporary memory cache */
-		if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-			ptcache_data_free(pm);
-			ptcache_extra_free(pm);
-			MEM_freeN(pm);
-		}
 	}
 
 	return 1;
@@ -2218,7 +2661,7 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra2);
+		pm = ptcache_disk_frame_get(pid, cfra2);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -2252,13 +2695,6 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
 
 		if (pid->interpolate_extra_data && pm->extradata.first)
 			pid->interpolate_extra_data(pid->calldata, pm, cfra, (float)cfra1, (float)cfra2);
-
-		/* clean up temporary memory cache */
-		if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-			ptcache_data_free(pm);
-			ptcache_extra_free(pm);
-			MEM_freeN(pm);
-		}
 	}
 
 	return 1;
@@ -2553,6 +2989,8 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 	if (pid->cache->flag & PTCACHE_IGNORE_CLEAR)
 		return;
 
+	ptcache_disk_frames_clear(pid->cache);
+
 	sta = pid->cache->startframe;
 	end = pid->cache->endframe;
 
@@ -2570,6 +3008,9 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 	case PTCACHE_CLEAR_BEFORE:
 	case PTCACHE_CLEAR_AFTER:
 		if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+			/* queued files have to be on disk to be found */
+			ptcache_write_behind_wait(pid->cache, NULL);
+
 			ptcache_path(pid, path);
 			
 			len = ptcache_filename(pid, filename, cfra, 0, 0); /* no path */
@@ -2656,6 +3097,7 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 		if (pid->cache->flag & PTCACHE_DISK_CACHE) {
 			if (BKE_ptcache_id_exist(pid, cfra)) {
 				ptcache_filename(pid, filename, cfra, 1, 1); /* no path */
+				ptcache_write_behind_wait(pid->cache, filename);
 				BLI_delete(filename, false, false);
 			}
 		}
@@ -2691,10 +3133,14 @@ int  BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
 	
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
 		char filename[MAX_PTCACHE_FILE];
+
+		/* read already, saves accessing the file system */
+		if (ptcache_disk_frames_has(pid->cache, cfra))
+			return 1;
 		
 		ptcache_filename(pid, filename, cfra, 1, 1);
 
-		return BLI_exists(filename);
+		return ptcache_write_behind_queued(pid->cache, filename) || BLI_exists(filename);
 	}
 	else {
 		PTCacheMem *pm = pid->cache->mem_cache.first;
@@ -3024,6 +3470,7 @@ void BKE_ptcache_free_mem(ListBase *mem_cache)
 }
 void BKE_ptcache_free(PointCache *cache)
 {
+	ptcache_disk_frames_clear(cache);
 	BKE_ptcache_free_mem(&cache->mem_cache);
 	if (cache->edit && cache->free_edit)
 		cache->free_edit(cache->edit);
@@ -3313,6 +3760,8 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
 	old_progress = -1;
 
 	WM_cursor_wait(1);
+
+	ptcache_write_behind_begin();
 	
 	if (G.background) {
 		ptcache_bake_thread((void*)&thread_data);
@@ -3348,6 +3797,9 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
 
 	BLI_end_threads(&threads);
 	}
+
+	ptcache_write_behind_end();
+
 	/* clear baking flag */
 	if (pid) {
 		cache->flag &= ~(PTCACHE_BAKING|PTCACHE_REDO_NEEDED);
@@ -3498,6 +3950,8 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
 	char old_path_full[MAX_PTCACHE_FILE];
 	char ext[MAX_PTCACHE_PATH];
 
+	ptcache_disk_frames_clear(pid->cache);
+
 	/* save old name */
 	BLI_strncpy(old_name, pid->cache->name, sizeof(old_name));
 
@@ -3560,6 +4014,8 @@ void BKE_ptcache_load_external(PTCacheID *pid)
 	if (!cache)
 		return;
 
+	ptcache_disk_frames_clear(cache);
+
 	ptcache_path(pid, path);
 	
 	len = ptcache_filename(pid, filename, 1, 0, 0); /* no path */
@@ -990,7 +990,25 @@ static void rigidbody_update_sim_world(Scene *scene, RigidBodyWorld *rbw)
 	rigidbody_update_ob_array(rbw);
 }
 
-static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo)
+/* Effectors only depend on the layers of the body they act on (bodies which are effectors
+ * themselves are skipped), so the list is shared by all bodies on the same layers instead of
+ * being rebuilt for each of them.
+ * < effectors, effectors_lay: list from the previous body and the layers it was built for
+ */
+static ListBase *rigidbody_get_effectors(Scene *scene, RigidBodyWorld *rbw, Object *ob,
+                                         ListBase **effectors, unsigned int *effectors_lay)
+{
+	if (*effectors_lay != ob->lay) {
+		pdEndEffectors(effectors);
+		*effectors = pdInitEffectors(scene, ob, NULL, rbw->effector_weights);
+		*effectors_lay = ob->lay;
+	}
+
+	return *effectors;
+}
+
+static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo,
+                                    ListBase **effectors_cache, unsigned int *effectors_lay)
 {
 	float loc[3];
 	float rot[4];
@@ -1027,7 +1045,7 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 		ListBase *effectors;
 
 		/* get effectors present in the group specified by effector_weights */
-		effectors = pdInitEffectors(scene, ob, NULL, effector_weights);
+		effectors = rigidbody_get_effectors(scene, rbw, ob, effectors_cache, effectors_lay);
 		if (effectors) {
 			float eff_force[3] = {0.0f, 0.0f, 0.0f};
 			float eff_loc[3], eff_vel[3];
@@ -1052,9 +1070,6 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 		}
 		else if (G.f & G_DEBUG)
 			printf("\tno forces to apply to '%s'\n", ob->id.name + 2);
-
-		/* cleanup */
-		pdEndEffectors(&effectors);
 	}
 	/* NOTE: passive objects don't need to be updated since they don't move */
 
@@ -1069,6 +1084,8 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 static void rigidbody_update_simulation(Scene *scene, RigidBodyWorld *rbw, int rebuild)
 {
 	GroupObject *go;
+	ListBase *effectors = NULL;
+	unsigned int effectors_lay = 0;
 
 	/* update world */
 	if (rebuild)
@@ -1117,9 +1134,11 @@ static void rigidbody_update_simulation(Scene *scene, RigidBodyWorld *rbw, int r
 			}
 
 			/* update simulation object... */
-			rigidbody_update_sim_ob(scene, rbw, ob, rbo);
+			rigidbody_update_sim_ob(scene, rbw, ob, rbo, &effectors, &effectors_lay);
 		}
 	}
+	pdEndEffectors(&effectors);
+
 	/* update constraints */
 	if (rbw->constraints == NULL) /* no constraints, move on */
 		return;
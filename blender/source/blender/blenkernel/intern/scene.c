@@ -44,6 +44,7 @@
 
 #include "DNA_anim_types.h"
 #include "DNA_group_types.h"
+#include "DNA_key_types.h"
 #include "DNA_linestyle_types.h"
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
@@ -58,6 +59,7 @@
 #include "BLI_callbacks.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "BLF_translation.h"
 
@@ -71,6 +73,7 @@
 #include "BKE_global.h"
 #include "BKE_group.h"
 #include "BKE_idprop.h"
+#include "BKE_key.h"
 #include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
@@ -81,6 +84,7 @@
 #include "BKE_pointcache.h"
 #include "BKE_rigidbody.h"
 #include "BKE_scene.h"
+#include "BKE_update_timing.h"
 #include "BKE_sequencer.h"
 #include "BKE_sound.h"
 #include "BKE_world.h"
@@ -1184,6 +1188,120 @@ static void scene_do_rb_simulation_recursive(Scene *scene, float ctime)
 		BKE_rigidbody_do_simulation(scene, ctime);
 }
 
+typedef struct ThreadedObjectUpdateState {
+	Scene *scene;
+	Scene *scene_parent;
+} ThreadedObjectUpdateState;
+
+/* objects sharing their data, and metaballs which are polygonized using
+ * global state, are evaluated one at a time */
+static ThreadMutex object_update_shared_mutex = BLI_MUTEX_INITIALIZER;
+
+static bool animdata_has_python_drivers(AnimData *adt)
+{
+	FCurve *fcu;
+
+	if (adt) {
+		for (fcu = adt->drivers.first; fcu; fcu = fcu->next) {
+			if (fcu->driver && fcu->driver->type == DRIVER_TYPE_PYTHON)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/* python drivers need the interpreter lock, which the thread running the
+ * update may be holding already */
+static bool scene_has_python_drivers(Scene *scene)
+{
+	Base *base;
+
+	for (base = scene->base.first; base; base = base->next) {
+		Object *ob = base->object;
+		Key *key = BKE_key_from_object(ob);
+
+		if (animdata_has_python_drivers(ob->adt))
+			return true;
+		if (ob->data && animdata_has_python_drivers(BKE_animdata_from_id(ob->data)))
+			return true;
+		if (key && animdata_has_python_drivers(key->adt))
+			return true;
+	}
+
+	return false;
+}
+
+static void scene_update_object_add_task(void *node, void *user_data);
+
+static void scene_update_object_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	ThreadedObjectUpdateState *state = (ThreadedObjectUpdateState *) BLI_task_pool_userdata(pool);
+	void *node = taskdata;
+	Object *ob = DAG_get_node_object(node);
+
+	/* only objects of the scene itself, dupli-group objects are updated
+	 * by the serial pass afterwards, taking the group time offset into account */
+	if (ob && (ob->id.flag & LIB_DOIT)) {
+		ID *data_id = (ID *)ob->data;
+		bool shared = (ob->type == OB_MBALL) || (data_id && data_id->us > 1);
+
+		if (shared)
+			BLI_mutex_lock(&object_update_shared_mutex);
+
+		BKE_object_handle_update_ex(state->scene_parent, ob, state->scene->rigidbody_world);
+
+		if (shared)
+			BLI_mutex_unlock(&object_update_shared_mutex);
+	}
+
+	/* schedule children, of which this node was the last pending parent */
+	DAG_threaded_update_handle_node_updated(node, scene_update_object_add_task, pool);
+}
+
+static void scene_update_object_add_task(void *node, void *user_data)
+{
+	TaskPool *task_pool = user_data;
+
+	BLI_task_pool_push(task_pool, scene_update_object_func, node, false, TASK_PRIORITY_LOW);
+}
+
+static void scene_update_objects_threaded(Main *bmain, Scene *scene, Scene *scene_parent)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	ThreadedObjectUpdateState state;
+	TaskPool *task_pool;
+	Base *base;
+
+	/* tag the objects of the scene */
+	tag_main_idcode(bmain, ID_OB, FALSE);
+	for (base = scene->base.first; base; base = base->next)
+		base->object->id.flag |= LIB_DOIT;
+
+	state.scene = scene;
+	state.scene_parent = scene_parent;
+
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	DAG_threaded_update_begin(scene, scene_update_object_add_task, task_pool);
+	BLI_task_pool_work_and_wait(task_pool);
+
+	BLI_task_pool_free(task_pool);
+
+	for (base = scene->base.first; base; base = base->next)
+		base->object->id.flag &= ~LIB_DOIT;
+}
+
+static bool scene_update_use_threads(Scene *scene)
+{
+	if (scene->theDag == NULL || scene->base.first == scene->base.last)
+		return false;
+	if (BLI_task_scheduler_num_threads(BLI_task_scheduler_get()) <= 1)
+		return false;
+
+	return !scene_has_python_drivers(scene);
+}
+
 static void scene_update_tagged_recursive(Main *bmain, Scene *scene, Scene *scene_parent)
 {
 	Base *base;
@@ -1195,7 +1313,13 @@ static void scene_update_tagged_recursive(Main *bmain, Scene *scene, Scene *scen
 	if (scene->set)
 		scene_update_tagged_recursive(bmain, scene->set, scene_parent);
 	
-	/* scene objects */
+	/* independent objects are evaluated in parallel, following the
+	 * dependency graph */
+	if (scene_update_use_threads(scene))
+		scene_update_objects_threaded(bmain, scene, scene_parent);
+
+	/* scene objects, only objects in dependency cycles are still tagged
+	 * for recalc when the threaded update was used */
 	for (base = scene->base.first; base; base = base->next) {
 		Object *ob = base->object;
 		
@@ -1229,6 +1353,8 @@ void BKE_scene_update_tagged(Main *bmain, Scene *scene)
 	/* keep this first */
 	BLI_callback_exec(bmain, &scene->id, BLI_CB_EVT_SCENE_UPDATE_PRE);
 
+	BKE_update_timing_begin();
+
 	/* (re-)build dependency graph if needed */
 	for (sce_iter = scene; sce_iter; sce_iter = sce_iter->set)
 		DAG_scene_relations_update(bmain, sce_iter);
@@ -1259,6 +1385,9 @@ void BKE_scene_update_tagged(Main *bmain, Scene *scene)
 		if (adt && (adt->recalc & ADT_RECALC_ANIM))
 			BKE_animsys_evaluate_animdata(scene, &scene->id, adt, ctime, 0);
 	}
+
+	/* before the handlers, so they can read the timings of this update */
+	BKE_update_timing_end();
 	
 	/* notify editors and python about recalc */
 	BLI_callback_exec(bmain, &scene->id, BLI_CB_EVT_SCENE_UPDATE_POST);
@@ -1270,6 +1399,13 @@ void BKE_scene_update_tagged(Main *bmain, Scene *scene)
 
 /* applies changes right away, does all sets too */
 void BKE_scene_update_for_newframe(Main *bmain, Scene *sce, unsigned int lay)
+{
+	BKE_scene_update_for_newframe_ex(bmain, sce, lay, true);
+}
+
+/* do_clear_recalc: when false, the caller reads the LIB_ID_RECALC flags of
+ * the updated datablocks and clears them with DAG_ids_clear_recalc() */
+void BKE_scene_update_for_newframe_ex(Main *bmain, Scene *sce, unsigned int lay, bool do_clear_recalc)
 {
 	float ctime = BKE_scene_frame_get(sce);
 	Scene *sce_iter;
@@ -1278,6 +1414,8 @@ void BKE_scene_update_for_newframe(Main *bmain, Scene *sce, unsigned int lay)
 	BLI_callback_exec(bmain, &sce->id, BLI_CB_EVT_FRAME_CHANGE_PRE);
 	BLI_callback_exec(bmain, &sce->id, BLI_CB_EVT_SCENE_UPDATE_PRE);
 
+	BKE_update_timing_begin();
+
 	/* update animated image textures for particles, modifiers, gpu, etc,
 	 * call this at the start so modifiers with textures don't lag 1 frame */
 	BKE_image_update_frame(bmain, sce->r.cfra);
@@ -1331,6 +1469,8 @@ void BKE_scene_update_for_newframe(Main *bmain, Scene *sce, unsigned int lay)
 
 	scene_depsgraph_hack(sce, sce);
 
+	BKE_update_timing_end();
+
 	/* notify editors and python about recalc */
 	BLI_callback_exec(bmain, &sce->id, BLI_CB_EVT_SCENE_UPDATE_POST);
 	BLI_callback_exec(bmain, &sce->id, BLI_CB_EVT_FRAME_CHANGE_POST);
@@ -1338,7 +1478,8 @@ void BKE_scene_update_for_newframe(Main *bmain, Scene *sce, unsigned int lay)
 	DAG_ids_check_recalc(bmain, sce, TRUE);
 
 	/* clear recalc flags */
-	DAG_ids_clear_recalc(bmain);
+	if (do_clear_recalc)
+		DAG_ids_clear_recalc(bmain);
 }
 
 /* return default layer, also used to patch old files */
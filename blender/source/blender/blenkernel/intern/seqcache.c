@@ -27,21 +27,37 @@
  */
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "BLI_sys_types.h"  /* for intptr_t */
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_moviecache.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
 #include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_sequencer.h"
 
+#ifdef WITH_LZO
+#  include "minilzo.h"
+#endif
+
 typedef struct SeqCacheKey {
 	struct Sequence *seq;
 	SeqRenderData context;
@@ -68,6 +84,9 @@ static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
 static void preprocessed_cache_destruct(void);
+static void seqcache_create(void);
+static void seq_disk_cache_destruct(void);
+static ImBuf *seq_disk_cache_get(const SeqCacheKey *key);
 
 static int seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -183,13 +202,16 @@ void BKE_sequencer_cache_destruct(void)
 		IMB_moviecache_free(moviecache);
 
 	preprocessed_cache_destruct();
+	seq_disk_cache_destruct();
 }
 
 void BKE_sequencer_cache_cleanup(void)
 {
+	BKE_sequencer_prefetch_stop();
+
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		seqcache_create();
 	}
 
 	BKE_sequencer_preprocessed_cache_cleanup();
@@ -205,21 +227,38 @@ static int seqcache_key_check_seq(void *userkey, void *userdata)
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	BKE_sequencer_prefetch_stop();
+
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
 }
 
 struct ImBuf *BKE_sequencer_cache_get(SeqRenderData context, Sequence *seq, float cfra, seq_stripelem_ibuf_t type)
 {
-	if (moviecache && seq) {
+	if (seq) {
 		SeqCacheKey key;
+		ImBuf *ibuf = NULL;
 
 		key.seq = seq;
 		key.context = context;
 		key.cfra = cfra - seq->start;
 		key.type = type;
 
-		return IMB_moviecache_get(moviecache, &key);
+		if (moviecache)
+			ibuf = IMB_moviecache_get(moviecache, &key);
+
+		if (ibuf == NULL) {
+			ibuf = seq_disk_cache_get(&key);
+
+			if (ibuf) {
+				if (!moviecache)
+					seqcache_create();
+
+				IMB_moviecache_put(moviecache, &key, ibuf);
+			}
+		}
+
+		return ibuf;
 	}
 
 	return NULL;
@@ -234,7 +273,7 @@ void BKE_sequencer_cache_put(SeqRenderData context, Sequence *seq, float cfra, s
 	}
 
 	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		seqcache_create();
 	}
 
 	key.seq = seq;
@@ -341,3 +380,502 @@ void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
 		}
 	}
 }
+
+/* ********************* disk cache *********************
+ *
+ * Second tier for preprocessed strip images: frames the memory limiter evicts
+ * are written compressed to a directory and read back on a memory cache miss,
+ * also in later sessions. Memory cache keys hold pointers, so files are keyed
+ * by a hash of the render settings and of the strip content instead. Strips
+ * depending on data which isn't hashed (scenes, clips, masks, modifiers or
+ * other channels) stay in memory only.
+ */
+
+#define SEQ_DISK_CACHE_VERSION      1
+#define SEQ_DISK_CACHE_MAX_PENDING  8
+#define SEQ_DISK_CACHE_DIRNAME      "blender_sequencer_cache"
+#define SEQ_DISK_CACHE_EXT          ".bseq"
+
+#define SEQ_DISK_CACHE_RECT         (1 << 0)
+#define SEQ_DISK_CACHE_RECT_FLOAT   (1 << 1)
+
+/* strip flags which change the rendered image */
+#define SEQ_DISK_CACHE_SEQ_FLAG (SEQ_FILTERY | SEQ_MUTE | SEQ_REVERSE_FRAMES | SEQ_FLIPX | SEQ_FLIPY | \
+                                 SEQ_MAKE_FLOAT | SEQ_USE_PROXY | SEQ_USE_TRANSFORM | SEQ_USE_CROP | \
+                                 SEQ_USE_PROXY_CUSTOM_DIR | SEQ_USE_PROXY_CUSTOM_FILE | \
+                                 SEQ_USE_EFFECT_DEFAULT_FADE | SEQ_USE_LINEAR_MODIFIERS)
+
+#define SEQ_DISK_HASH_INIT          2166136261u
+#define SEQ_DISK_HASH(h, v)         seq_disk_hash_bytes(h, &(v), sizeof(v))
+
+typedef struct SeqDiskCacheKey {
+	unsigned int render_hash;
+	unsigned int content_hash;
+	float cfra;
+	int type;
+} SeqDiskCacheKey;
+
+typedef struct SeqDiskCacheHeader {
+	char magic[4];
+	int version;
+	SeqDiskCacheKey key;  /* compared on read, file names may collide */
+	int x, y, planes, channels;
+	int flag;
+	char rect_colorspace[64];
+	char float_colorspace[64];
+} SeqDiskCacheHeader;
+
+typedef struct SeqDiskCacheWrite {
+	SeqDiskCacheKey key;
+	ImBuf *ibuf;
+} SeqDiskCacheWrite;
+
+static TaskPool *disk_cache_pool = NULL;
+static ThreadMutex disk_cache_lock = BLI_MUTEX_INITIALIZER;
+static int disk_cache_pending = 0;
+static size_t disk_cache_size = 0;
+static bool disk_cache_size_valid = false;
+
+static bool seq_disk_cache_enabled(void)
+{
+	return U.sequencer_disk_cache_limit > 0;
+}
+
+/* FNV-1a, stable between sessions unlike the pointer hashes above */
+static unsigned int seq_disk_hash_bytes(unsigned int h, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+static unsigned int seq_disk_hash_string(unsigned int h, const char *str)
+{
+	return seq_disk_hash_bytes(h, str, strlen(str));
+}
+
+static unsigned int seq_disk_hash_render_data(const SeqRenderData *context)
+{
+	unsigned int h = SEQ_DISK_HASH_INIT;
+
+	h = SEQ_DISK_HASH(h, context->rectx);
+	h = SEQ_DISK_HASH(h, context->recty);
+	h = SEQ_DISK_HASH(h, context->preview_render_size);
+	h = SEQ_DISK_HASH(h, context->motion_blur_samples);
+	h = SEQ_DISK_HASH(h, context->motion_blur_shutter);
+
+	if (context->scene)
+		h = seq_disk_hash_string(h, context->scene->sequencer_colorspace_settings.name);
+
+	return h;
+}
+
+/* returns false when the strip output depends on data which isn't hashed */
+static bool seq_disk_hash_sequence(const Sequence *seq, unsigned int *r_hash)
+{
+	const Strip *strip = seq->strip;
+	const Sequence *seq_child;
+	unsigned int h = *r_hash;
+	int flag = seq->flag & SEQ_DISK_CACHE_SEQ_FLAG;
+
+	switch (seq->type) {
+		case SEQ_TYPE_SOUND_RAM:
+		case SEQ_TYPE_SOUND_HD:
+			/* no image output, only seen inside meta strips */
+			return true;
+		case SEQ_TYPE_SCENE:
+		case SEQ_TYPE_MOVIECLIP:
+		case SEQ_TYPE_MASK:
+		case SEQ_TYPE_SPEED:
+		case SEQ_TYPE_MULTICAM:
+		case SEQ_TYPE_ADJUSTMENT:
+			return false;
+	}
+
+	if (seq->modifiers.first)
+		return false;
+
+	h = SEQ_DISK_HASH(h, seq->type);
+	h = SEQ_DISK_HASH(h, flag);
+	h = SEQ_DISK_HASH(h, seq->len);
+	h = SEQ_DISK_HASH(h, seq->start);
+	h = SEQ_DISK_HASH(h, seq->startofs);
+	h = SEQ_DISK_HASH(h, seq->endofs);
+	h = SEQ_DISK_HASH(h, seq->startstill);
+	h = SEQ_DISK_HASH(h, seq->endstill);
+	h = SEQ_DISK_HASH(h, seq->anim_startofs);
+	h = SEQ_DISK_HASH(h, seq->anim_endofs);
+	h = SEQ_DISK_HASH(h, seq->anim_preseek);
+	h = SEQ_DISK_HASH(h, seq->streamindex);
+	h = SEQ_DISK_HASH(h, seq->sat);
+	h = SEQ_DISK_HASH(h, seq->mul);
+	h = SEQ_DISK_HASH(h, seq->strobe);
+	h = SEQ_DISK_HASH(h, seq->effect_fader);
+	h = SEQ_DISK_HASH(h, seq->alpha_mode);
+
+	if (strip) {
+		h = seq_disk_hash_string(h, strip->dir);
+		h = seq_disk_hash_string(h, strip->colorspace_settings.name);
+
+		if (strip->stripdata) {
+			h = seq_disk_hash_string(h, strip->stripdata[0].name);
+
+			if (seq->type == SEQ_TYPE_IMAGE && seq->len > 1)
+				h = seq_disk_hash_string(h, strip->stripdata[seq->len - 1].name);
+		}
+
+		if ((seq->flag & SEQ_USE_CROP) && strip->crop)
+			h = seq_disk_hash_bytes(h, strip->crop, sizeof(StripCrop));
+
+		if ((seq->flag & SEQ_USE_TRANSFORM) && strip->transform)
+			h = seq_disk_hash_bytes(h, strip->transform, sizeof(StripTransform));
+
+		if ((seq->flag & SEQ_USE_PROXY) && strip->proxy) {
+			h = seq_disk_hash_string(h, strip->proxy->dir);
+			h = seq_disk_hash_string(h, strip->proxy->file);
+			h = SEQ_DISK_HASH(h, strip->proxy->tc);
+		}
+	}
+
+	/* remaining effect settings have no pointers */
+	if ((seq->type & SEQ_TYPE_EFFECT) && seq->effectdata)
+		h = seq_disk_hash_bytes(h, seq->effectdata, MEM_allocN_len(seq->effectdata));
+
+	if (seq->seq1 && !seq_disk_hash_sequence(seq->seq1, &h))
+		return false;
+	if (seq->seq2 && !seq_disk_hash_sequence(seq->seq2, &h))
+		return false;
+	if (seq->seq3 && !seq_disk_hash_sequence(seq->seq3, &h))
+		return false;
+
+	for (seq_child = seq->seqbase.first; seq_child; seq_child = seq_child->next) {
+		if (!seq_disk_hash_sequence(seq_child, &h))
+			return false;
+	}
+
+	*r_hash = h;
+
+	return true;
+}
+
+static bool seq_disk_cache_key(const SeqCacheKey *key, SeqDiskCacheKey *r_key)
+{
+	if (key->type != SEQ_STRIPELEM_IBUF || key->seq == NULL)
+		return false;
+
+	r_key->content_hash = SEQ_DISK_HASH_INIT;
+	if (!seq_disk_hash_sequence(key->seq, &r_key->content_hash))
+		return false;
+
+	r_key->render_hash = seq_disk_hash_render_data(&key->context);
+	r_key->cfra = key->cfra;
+	r_key->type = key->type;
+
+	return true;
+}
+
+static void seq_disk_cache_dir(char *dir)
+{
+	if (U.sequencer_disk_cache_dir[0])
+		BLI_strncpy(dir, U.sequencer_disk_cache_dir, FILE_MAX);
+	else
+		BLI_join_dirfile(dir, FILE_MAX, BLI_temporary_dir(), SEQ_DISK_CACHE_DIRNAME);
+
+	BLI_add_slash(dir);
+}
+
+static void seq_disk_cache_filepath(const SeqDiskCacheKey *key, char *filepath)
+{
+	char dir[FILE_MAX], name[FILE_MAXFILE];
+
+	seq_disk_cache_dir(dir);
+	BLI_snprintf(name, sizeof(name), "%08x%08x_%08x" SEQ_DISK_CACHE_EXT,
+	             key->render_hash, key->content_hash, *(unsigned int *) &key->cfra);
+	BLI_join_dirfile(filepath, FILE_MAX, dir, name);
+}
+
+static int seq_disk_cache_file_cmp(const void *a_, const void *b_)
+{
+	const struct direntry *a = a_, *b = b_;
+
+	if (a->s.st_mtime < b->s.st_mtime) return -1;
+	else if (a->s.st_mtime > b->s.st_mtime) return 1;
+	return 0;
+}
+
+/* recount the cache directory and remove the oldest files above 90% of the limit,
+ * called with disk_cache_lock held */
+static void seq_disk_cache_trim(void)
+{
+	size_t limit = (size_t)U.sequencer_disk_cache_limit * 1024 * 1024;
+	struct direntry *files;
+	unsigned int totfile, i;
+	char dir[FILE_MAX];
+
+	seq_disk_cache_dir(dir);
+	totfile = BLI_dir_contents(dir, &files);
+
+	qsort(files, totfile, sizeof(struct direntry), seq_disk_cache_file_cmp);
+
+	disk_cache_size = 0;
+	for (i = 0; i < totfile; i++) {
+		if (S_ISREG(files[i].s.st_mode) && BLI_testextensie(files[i].relname, SEQ_DISK_CACHE_EXT))
+			disk_cache_size += files[i].s.st_size;
+	}
+
+	for (i = 0; i < totfile && disk_cache_size > limit / 10 * 9; i++) {
+		if (S_ISREG(files[i].s.st_mode) && BLI_testextensie(files[i].relname, SEQ_DISK_CACHE_EXT)) {
+			if (BLI_delete(files[i].path, false, false) == 0)
+				disk_cache_size -= files[i].s.st_size;
+		}
+	}
+
+	BLI_free_filelist(files, totfile);
+	disk_cache_size_valid = true;
+}
+
+static bool seq_disk_cache_write_buffer(FILE *fp, const void *data, unsigned int len)
+{
+	unsigned char compressed = 0;
+	unsigned int out_len = len;
+	unsigned char *out = NULL;
+	bool ok;
+
+#ifdef WITH_LZO
+	{
+		lzo_uint lzo_len = LZO_OUT_LEN(len);
+		void *wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "seq disk cache lzo");
+
+		out = MEM_mallocN(lzo_len, "seq disk cache compressed");
+
+		if (lzo1x_1_compress((const lzo_bytep)data, len, out, &lzo_len, wrkmem) == LZO_E_OK && lzo_len < len) {
+			compressed = 1;
+			out_len = lzo_len;
+		}
+
+		MEM_freeN(wrkmem);
+	}
+#endif
+
+	ok = fwrite(&compressed, sizeof(compressed), 1, fp) == 1 &&
+	     fwrite(&out_len, sizeof(out_len), 1, fp) == 1 &&
+	     fwrite(compressed ? out : data, 1, out_len, fp) == out_len;
+
+	if (out)
+		MEM_freeN(out);
+
+	return ok;
+}
+
+static bool seq_disk_cache_read_buffer(FILE *fp, void *data, unsigned int len)
+{
+	unsigned char compressed;
+	unsigned int in_len;
+	bool ok = false;
+
+	if (fread(&compressed, sizeof(compressed), 1, fp) != 1 || fread(&in_len, sizeof(in_len), 1, fp) != 1)
+		return false;
+
+	if (compressed == 0)
+		return in_len == len && fread(data, 1, len, fp) == len;
+
+#ifdef WITH_LZO
+	if (compressed == 1 && in_len < len) {
+		unsigned char *in = MEM_mallocN(in_len, "seq disk cache compressed");
+		lzo_uint out_len = len;
+
+		if (fread(in, 1, in_len, fp) == in_len &&
+		    lzo1x_decompress_safe(in, in_len, data, &out_len, NULL) == LZO_E_OK &&
+		    out_len == len)
+		{
+			ok = true;
+		}
+
+		MEM_freeN(in);
+	}
+#endif
+
+	return ok;
+}
+
+static void seq_disk_cache_write_run(TaskPool *UNUSED(pool), void *taskdata, int threadid)
+{
+	SeqDiskCacheWrite *write = taskdata;
+	ImBuf *ibuf = write->ibuf;
+	SeqDiskCacheHeader header = {{0}};
+	char filepath[FILE_MAX], filepath_tmp[FILE_MAX];
+	FILE *fp;
+
+	seq_disk_cache_filepath(&write->key, filepath);
+	BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s.tmp%d", filepath, threadid);
+
+	BLI_make_existing_file(filepath);
+	fp = BLI_fopen(filepath_tmp, "wb");
+
+	if (fp) {
+		unsigned int totpixel = (unsigned int)ibuf->x * (unsigned int)ibuf->y;
+		bool ok;
+
+		memcpy(header.magic, "BSQC", sizeof(header.magic));
+		header.version = SEQ_DISK_CACHE_VERSION;
+		header.key = write->key;
+		header.x = ibuf->x;
+		header.y = ibuf->y;
+		header.planes = ibuf->planes;
+		header.channels = ibuf->channels;
+		header.flag = (ibuf->rect ? SEQ_DISK_CACHE_RECT : 0) | (ibuf->rect_float ? SEQ_DISK_CACHE_RECT_FLOAT : 0);
+
+		if (ibuf->rect_colorspace)
+			BLI_strncpy(header.rect_colorspace, IMB_colormanagement_get_rect_colorspace(ibuf), sizeof(header.rect_colorspace));
+		if (ibuf->float_colorspace)
+			BLI_strncpy(header.float_colorspace, IMB_colormanagement_get_float_colorspace(ibuf), sizeof(header.float_colorspace));
+
+		ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+		if (ok && ibuf->rect)
+			ok = seq_disk_cache_write_buffer(fp, ibuf->rect, totpixel * sizeof(unsigned int));
+		if (ok && ibuf->rect_float)
+			ok = seq_disk_cache_write_buffer(fp, ibuf->rect_float, totpixel * ibuf->channels * sizeof(float));
+
+		fclose(fp);
+
+		/* rename so readers never see a partial file */
+		if (ok && BLI_rename(filepath_tmp, filepath) == 0) {
+			BLI_mutex_lock(&disk_cache_lock);
+			disk_cache_size += BLI_file_size(filepath);
+			if (!disk_cache_size_valid || disk_cache_size > (size_t)U.sequencer_disk_cache_limit * 1024 * 1024)
+				seq_disk_cache_trim();
+			BLI_mutex_unlock(&disk_cache_lock);
+		}
+		else {
+			BLI_delete(filepath_tmp, false, false);
+		}
+	}
+
+	IMB_freeImBuf(ibuf);
+
+	BLI_mutex_lock(&disk_cache_lock);
+	disk_cache_pending--;
+	BLI_mutex_unlock(&disk_cache_lock);
+}
+
+/* evict callback, runs with the memory limiter locked so only queue the write */
+static void seqcache_evict(void *userkey, ImBuf *ibuf)
+{
+	SeqCacheKey *key = (SeqCacheKey *) userkey;
+	SeqDiskCacheKey disk_key;
+	SeqDiskCacheWrite *write;
+	char filepath[FILE_MAX];
+
+	if (!seq_disk_cache_enabled() || !(ibuf->rect || ibuf->rect_float))
+		return;
+
+	if (!seq_disk_cache_key(key, &disk_key))
+		return;
+
+	/* frames read back from disk are still there */
+	seq_disk_cache_filepath(&disk_key, filepath);
+	if (BLI_exists(filepath))
+		return;
+
+	BLI_mutex_lock(&disk_cache_lock);
+	if (disk_cache_pending >= SEQ_DISK_CACHE_MAX_PENDING) {
+		BLI_mutex_unlock(&disk_cache_lock);
+		return;
+	}
+	disk_cache_pending++;
+	BLI_mutex_unlock(&disk_cache_lock);
+
+	write = MEM_callocN(sizeof(SeqDiskCacheWrite), "SeqDiskCacheWrite");
+	write->key = disk_key;
+	write->ibuf = ibuf;
+	IMB_refImBuf(ibuf);
+
+	if (disk_cache_pool == NULL)
+		disk_cache_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+	BLI_task_pool_push(disk_cache_pool, seq_disk_cache_write_run, write, true, TASK_PRIORITY_LOW);
+}
+
+static ImBuf *seq_disk_cache_get(const SeqCacheKey *key)
+{
+	SeqDiskCacheKey disk_key;
+	SeqDiskCacheHeader header;
+	char filepath[FILE_MAX];
+	ImBuf *ibuf = NULL;
+	FILE *fp;
+
+	if (!seq_disk_cache_enabled() || !seq_disk_cache_key(key, &disk_key))
+		return NULL;
+
+	seq_disk_cache_filepath(&disk_key, filepath);
+	fp = BLI_fopen(filepath, "rb");
+
+	if (fp == NULL)
+		return NULL;
+
+	if (fread(&header, sizeof(header), 1, fp) == 1 &&
+	    memcmp(header.magic, "BSQC", sizeof(header.magic)) == 0 &&
+	    header.version == SEQ_DISK_CACHE_VERSION &&
+	    memcmp(&header.key, &disk_key, sizeof(disk_key)) == 0 &&
+	    header.x > 0 && header.y > 0 && header.channels > 0 && header.channels <= 4 &&
+	    (header.flag & (SEQ_DISK_CACHE_RECT | SEQ_DISK_CACHE_RECT_FLOAT)))
+	{
+		unsigned int totpixel = (unsigned int)header.x * (unsigned int)header.y;
+		bool ok;
+
+		ibuf = IMB_allocImBuf(header.x, header.y, header.planes, (header.flag & SEQ_DISK_CACHE_RECT) ? IB_rect : 0);
+		ok = (ibuf != NULL);
+
+		if (ok && (header.flag & SEQ_DISK_CACHE_RECT_FLOAT)) {
+			ibuf->channels = header.channels;
+			ok = imb_addrectfloatImBuf(ibuf);
+		}
+
+		if (ok && ibuf->rect)
+			ok = seq_disk_cache_read_buffer(fp, ibuf->rect, totpixel * sizeof(unsigned int));
+		if (ok && ibuf->rect_float)
+			ok = seq_disk_cache_read_buffer(fp, ibuf->rect_float, totpixel * ibuf->channels * sizeof(float));
+
+		if (ok) {
+			header.rect_colorspace[sizeof(header.rect_colorspace) - 1] = '\0';
+			header.float_colorspace[sizeof(header.float_colorspace) - 1] = '\0';
+
+			if (ibuf->rect && header.rect_colorspace[0])
+				IMB_colormanagement_assign_rect_colorspace(ibuf, header.rect_colorspace);
+			if (ibuf->rect_float && header.float_colorspace[0])
+				IMB_colormanagement_assign_float_colorspace(ibuf, header.float_colorspace);
+		}
+		else if (ibuf) {
+			IMB_freeImBuf(ibuf);
+			ibuf = NULL;
+		}
+	}
+
+	fclose(fp);
+
+	return ibuf;
+}
+
+static void seq_disk_cache_destruct(void)
+{
+	if (disk_cache_pool) {
+		BLI_task_pool_work_and_wait(disk_cache_pool);
+		BLI_task_pool_free(disk_cache_pool);
+		disk_cache_pool = NULL;
+	}
+
+	disk_cache_size_valid = false;
+}
+
+static void seqcache_create(void)
+{
+	moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+	IMB_moviecache_set_evict_callback(moviecache, seqcache_evict);
+}
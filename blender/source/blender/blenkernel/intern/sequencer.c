@@ -51,6 +51,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -71,8 +72,6 @@
 
 #include "RE_pipeline.h"
 
-#include <pthread.h>
-
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
@@ -80,6 +79,8 @@
 #include "BKE_context.h"
 #include "BKE_sound.h"
 
+#include "PIL_time.h"
+
 #ifdef WITH_AUDASPACE
 #  include "AUD_C-API.h"
 #endif
@@ -1553,6 +1554,106 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	}
 }
 
+typedef struct SeqProxyBatchTask {
+	struct SeqProxyBatchTask *next, *prev;
+	ListBase contexts;  /* LinkData, rebuilt one after the other */
+	short *stop, *do_update;
+	int index, tot;
+	float progress;     /* of the context at index */
+	bool done;
+} SeqProxyBatchTask;
+
+static void seq_proxy_batch_task_run(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	SeqProxyBatchTask *task = taskdata;
+	LinkData *link;
+
+	task->tot = BLI_countlist(&task->contexts);
+
+	for (link = task->contexts.first; link && !*task->stop; link = link->next) {
+		task->progress = 0.0f;
+		BKE_sequencer_proxy_rebuild(link->data, task->stop, task->do_update, &task->progress);
+		task->index++;
+	}
+
+	BLI_mutex_lock(BLI_task_pool_user_mutex(pool));
+	task->done = true;
+	BLI_mutex_unlock(BLI_task_pool_user_mutex(pool));
+}
+
+/* rebuild a list of contexts (LinkData), movie strips only decode and encode
+ * their own files and run in parallel, the others render through the
+ * sequencer and share one task */
+void BKE_sequencer_proxy_rebuild_batch(ListBase *contexts, short *stop, short *do_update, float *progress)
+{
+	ListBase tasks = {NULL, NULL};
+	SeqProxyBatchTask *task, *task_render = NULL;
+	TaskPool *pool;
+	LinkData *link;
+	bool done = false;
+	int tot_task;
+
+	for (link = contexts->first; link; link = link->next) {
+		SeqIndexBuildContext *context = link->data;
+
+		if (context == NULL)
+			continue;
+
+		if (context->index_context || task_render == NULL) {
+			task = MEM_callocN(sizeof(SeqProxyBatchTask), "SeqProxyBatchTask");
+			task->stop = stop;
+			task->do_update = do_update;
+			BLI_addtail(&tasks, task);
+
+			if (context->index_context == NULL)
+				task_render = task;
+		}
+		else {
+			task = task_render;
+		}
+
+		BLI_addtail(&task->contexts, BLI_genericNodeN(context));
+	}
+
+	tot_task = BLI_countlist(&tasks);
+	if (tot_task == 0)
+		return;
+
+	pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+	for (task = tasks.first; task; task = task->next)
+		BLI_task_pool_push(pool, seq_proxy_batch_task_run, task, false, TASK_PRIORITY_LOW);
+
+	/* the job thread only reports progress, every task counts the same */
+	while (!done) {
+		float progress_sum = 0.0f;
+
+		PIL_sleep_ms(50);
+
+		done = true;
+
+		BLI_mutex_lock(BLI_task_pool_user_mutex(pool));
+		for (task = tasks.first; task; task = task->next) {
+			if (task->done)
+				progress_sum += 1.0f;
+			else if (task->tot)
+				progress_sum += (task->index + task->progress) / task->tot;
+			done &= task->done;
+		}
+		BLI_mutex_unlock(BLI_task_pool_user_mutex(pool));
+
+		*progress = progress_sum / tot_task;
+		*do_update = TRUE;
+	}
+
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	for (task = tasks.first; task; task = task->next)
+		BLI_freelistN(&task->contexts);
+	BLI_freelistN(&tasks);
+}
+
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, short stop)
 {
 	if (context->index_context) {
@@ -2955,7 +3056,7 @@ static ImBuf *seq_render_strip_stack(SeqRenderData context, ListBase *seqbasep,
  * you have to free after usage!
  */
 
-ImBuf *BKE_sequencer_give_ibuf(SeqRenderData context, float cfra, int chanshown)
+static ImBuf *seq_give_ibuf(SeqRenderData context, float cfra, int chanshown)
 {
 	Editing *ed = BKE_sequencer_editing_get(context.scene, FALSE);
 	int count;
@@ -2975,167 +3076,189 @@ ImBuf *BKE_sequencer_give_ibuf(SeqRenderData context, float cfra, int chanshown)
 	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
 }
 
+ImBuf *BKE_sequencer_give_ibuf(SeqRenderData context, float cfra, int chanshown)
+{
+	BKE_sequencer_prefetch_stop();
+
+	return seq_give_ibuf(context, cfra, chanshown);
+}
+
 ImBuf *BKE_sequencer_give_ibuf_seqbase(SeqRenderData context, float cfra, int chanshown, ListBase *seqbasep)
 {
+	BKE_sequencer_prefetch_stop();
+
 	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
 }
 
 
 ImBuf *BKE_sequencer_give_ibuf_direct(SeqRenderData context, float cfra, Sequence *seq)
 {
+	BKE_sequencer_prefetch_stop();
+
 	return seq_render_strip(context, seq, cfra);
 }
 
-/* *********************** threading api ******************* */
+/* *********************** prefetch ******************* */
 
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
+/* Frames after the last one given for playback are rendered ahead by a
+ * task and land in the sequencer cache, which already holds them within
+ * the memory cache limit. Strips (movie decoders, effect data) are not
+ * thread safe, so playback rendering and prefetch are serialized by
+ * seq_render_lock, and any edit or cache cleanup on the main thread stops
+ * the prefetch before touching sequencer data. */
 
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
+typedef struct SeqPrefetchState {
+	SeqRenderData context;
+	int chanshown;
+	int cfra;       /* last frame given for playback */
+	int offset;     /* next frame to prefetch, relative to cfra */
+	bool running;
+	bool stop;
+} SeqPrefetchState;
 
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
+static TaskPool *seq_prefetch_pool = NULL;
+static SeqPrefetchState seq_prefetch = {{NULL}};
+static ThreadMutex seq_prefetch_lock = BLI_MUTEX_INITIALIZER;
+static ThreadMutex seq_render_lock = BLI_MUTEX_INITIALIZER;
+static bool seq_render_lock_main = false;  /* main thread holds seq_render_lock */
+
+static bool seq_prefetch_context_equal(const SeqRenderData *a, const SeqRenderData *b)
+{
+	return (a->bmain == b->bmain &&
+	        a->scene == b->scene &&
+	        a->rectx == b->rectx &&
+	        a->recty == b->recty &&
+	        a->preview_render_size == b->preview_render_size &&
+	        a->motion_blur_samples == b->motion_blur_samples &&
+	        a->motion_blur_shutter == b->motion_blur_shutter);
+}
 
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
+/* playback loops over the (preview) frame range */
+static int seq_prefetch_frame_wrap(Scene *scene, int frame)
+{
+	const int sfra = PSFRA, efra = PEFRA;
 
-static volatile int seq_thread_shutdown = TRUE; 
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
+	if (frame > efra && efra >= sfra)
+		frame = sfra + (frame - efra - 1) % (efra - sfra + 1);
 
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
-	
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
-	
-} PrefetchThread;
+	return frame;
+}
 
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
-	
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
+static void seq_prefetch_task_run(TaskPool *UNUSED(pool), void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	while (true) {
+		SeqRenderData context;
+		int chanshown, frame;
+		ImBuf *ibuf;
 
-	int monoton_cfra;
+		BLI_mutex_lock(&seq_prefetch_lock);
+		if (seq_prefetch.stop || G.is_rendering || seq_prefetch.offset > U.prefetchframes) {
+			seq_prefetch.running = false;
+			BLI_mutex_unlock(&seq_prefetch_lock);
+			break;
+		}
+		context = seq_prefetch.context;
+		chanshown = seq_prefetch.chanshown;
+		frame = seq_prefetch_frame_wrap(context.scene, seq_prefetch.cfra + seq_prefetch.offset++);
+		BLI_mutex_unlock(&seq_prefetch_lock);
 
-	ImBuf *ibuf;
-} PrefetchQueueElem;
+		BLI_mutex_lock(&seq_render_lock);
+		ibuf = seq_prefetch.stop ? NULL : seq_give_ibuf(context, (float)frame, chanshown);
+		BLI_mutex_unlock(&seq_render_lock);
+
+		if (ibuf)
+			IMB_freeImBuf(ibuf);
+	}
+}
 
 void BKE_sequencer_give_ibuf_prefetch_request(SeqRenderData context, float cfra, int chanshown)
 {
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
+	bool start;
+
+	if (U.prefetchframes <= 0 || G.is_rendering || !BLI_thread_is_main())
 		return;
+
+	BLI_mutex_lock(&seq_prefetch_lock);
+
+	/* keep the frames already prefetched when playback moved forward */
+	if (!seq_prefetch_context_equal(&context, &seq_prefetch.context) ||
+	    chanshown != seq_prefetch.chanshown ||
+	    (int)cfra < seq_prefetch.cfra)
+	{
+		seq_prefetch.offset = 1;
+	}
+	else {
+		seq_prefetch.offset = max_ii(seq_prefetch.offset - ((int)cfra - seq_prefetch.cfra), 1);
 	}
 
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context.rectx;
-	e->recty = context.recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context.preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
+	seq_prefetch.context = context;
+	seq_prefetch.chanshown = chanshown;
+	seq_prefetch.cfra = (int)cfra;
+	seq_prefetch.stop = false;
 
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
-	
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
+	start = !seq_prefetch.running && seq_prefetch.offset <= U.prefetchframes;
+	if (start)
+		seq_prefetch.running = true;
+
+	BLI_mutex_unlock(&seq_prefetch_lock);
+
+	if (start) {
+		if (seq_prefetch_pool == NULL)
+			seq_prefetch_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+		BLI_task_pool_push(seq_prefetch_pool, seq_prefetch_task_run, NULL, false, TASK_PRIORITY_LOW);
+	}
 }
 
-ImBuf *BKE_sequencer_give_ibuf_threaded(SeqRenderData context, float cfra, int chanshown)
+/* only the main thread edits sequencer data, nested renders from the
+ * prefetch itself don't stop it */
+void BKE_sequencer_prefetch_stop(void)
 {
-	PrefetchQueueElem *e = NULL;
-	int found_something = FALSE;
+	if (seq_prefetch_pool == NULL || !BLI_thread_is_main())
+		return;
 
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
-	}
+	BLI_mutex_lock(&seq_prefetch_lock);
+	seq_prefetch.stop = true;
+	BLI_mutex_unlock(&seq_prefetch_lock);
 
-	while (!e) {
-		int success = FALSE;
-		pthread_mutex_lock(&queue_lock);
+	/* nested render during playback (scene strips), the prefetch is
+	 * waiting for the lock and checks the stop flag once it has it */
+	if (seq_render_lock_main)
+		return;
 
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context.rectx == e->rectx &&
-			    context.recty == e->recty &&
-			    context.preview_render_size == e->preview_render_size)
-			{
-				success = TRUE;
-				found_something = TRUE;
-				break;
-			}
-		}
+	BLI_task_pool_work_and_wait(seq_prefetch_pool);
 
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context.rectx == e->rectx &&
-				    context.recty == e->recty &&
-				    context.preview_render_size == e->preview_render_size)
-				{
-					found_something = TRUE;
-					break;
-				}
-			}
-		}
+	/* frames must be prefetched again after data changed */
+	seq_prefetch.context.scene = NULL;
+}
 
-		if (!e) {
-			PrefetchThread *tslot;
+void BKE_sequencer_prefetch_free(void)
+{
+	BKE_sequencer_prefetch_stop();
 
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context.rectx == tslot->current->rectx &&
-				    context.recty == tslot->current->recty &&
-				    context.preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = TRUE;
-					break;
-				}
-			}
-		}
+	if (seq_prefetch_pool) {
+		BLI_task_pool_free(seq_prefetch_pool);
+		seq_prefetch_pool = NULL;
+	}
+}
 
-		/* e->ibuf is unrefed by render thread on next round. */
+ImBuf *BKE_sequencer_give_ibuf_threaded(SeqRenderData context, float cfra, int chanshown)
+{
+	ImBuf *ibuf;
 
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
-		}
+	if (U.prefetchframes <= 0 || !BLI_thread_is_main())
+		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
 
-		pthread_mutex_unlock(&queue_lock);
+	/* mostly a cache hit, otherwise waits for at most one prefetched frame */
+	BLI_mutex_lock(&seq_render_lock);
+	seq_render_lock_main = true;
+	ibuf = seq_give_ibuf(context, cfra, chanshown);
+	seq_render_lock_main = false;
+	BLI_mutex_unlock(&seq_render_lock);
 
-		if (!success) {
-			e = NULL;
+	BKE_sequencer_give_ibuf_prefetch_request(context, cfra, chanshown);
 
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
-		}
-	}
-	
-	return e ? e->ibuf : NULL;
+	return ibuf;
 }
 
 /* Functions to free imbuf and anim data on changes */
@@ -3197,6 +3320,8 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, int invalidat
 {
 	Editing *ed = scene->ed;
 
+	BKE_sequencer_prefetch_stop();
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		if (seq->anim) {
@@ -44,6 +44,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_shrinkwrap.h"
@@ -112,33 +113,41 @@ static void space_transform_invert_normal(const SpaceTransform *data, float no[3
 	normalize_v3(no); /* TODO: could we just determine de scale value from the matrix? */
 }
 
+/* the target trees are cached in the target DerivedMesh, they're only built
+ * again when the target itself gets re-evaluated */
+
+/* below this number of vertices the queries run on the calling thread */
+#define SHRINKWRAP_TASK_THRESHOLD 1024
+
+typedef struct ShrinkwrapCalcCBData {
+	ShrinkwrapCalcData *calc;
+
+	BVHTreeFromMesh *treeData;
+	BVHTreeFromMesh *auxData;
+	SpaceTransform *local2aux;
+
+	float *proj_axis;
+} ShrinkwrapCalcCBData;
+
 /*
  * Shrinkwrap to the nearest vertex
  *
  * it builds a kdtree of vertexs we can attach to and then
  * for each vertex performs a nearest vertex search on the tree
  */
-static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
+static void shrinkwrap_calc_nearest_vertex_cb(void *userdata, int start, int stop)
 {
-	int i;
-
-	BVHTreeFromMesh treeData = NULL_BVHTreeFromMesh;
+	ShrinkwrapCalcCBData *data = userdata;
+	ShrinkwrapCalcData *calc = data->calc;
+	BVHTreeFromMesh *treeData = data->treeData;
 	BVHTreeNearest nearest  = NULL_BVHTreeNearest;
-
-
-	TIMEIT_BENCH(bvhtree_from_mesh_verts(&treeData, calc->target, 0.0, 2, 6), bvhtree_verts);
-	if (treeData.tree == NULL) {
-		OUT_OF_MEMORY();
-		return;
-	}
+	int i;
 
 	/* Setup nearest */
 	nearest.index = -1;
 	nearest.dist = FLT_MAX;
-#ifndef __APPLE__
-#pragma omp parallel for default(none) private(i) firstprivate(nearest) shared(treeData, calc) schedule(static)
-#endif
-	for (i = 0; i < calc->numVerts; ++i) {
+
+	for (i = start; i < stop; ++i) {
 		float *co = calc->vertexCos[i];
 		float tmp_co[3];
 		float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
@@ -166,7 +175,7 @@ static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 		else
 			nearest.dist = FLT_MAX;
 
-		BLI_bvhtree_find_nearest(treeData.tree, tmp_co, &nearest, treeData.nearest_callback, &treeData);
+		BLI_bvhtree_find_nearest(treeData->tree, tmp_co, &nearest, treeData->nearest_callback, treeData);
 
 
 		/* Found the nearest vertex */
@@ -185,6 +194,24 @@ static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 			interp_v3_v3v3(co, co, tmp_co, weight);  /* linear interpolation */
 		}
 	}
+}
+
+static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
+{
+	ShrinkwrapCalcCBData data = {NULL};
+	BVHTreeFromMesh treeData = NULL_BVHTreeFromMesh;
+
+	TIMEIT_BENCH(bvhtree_from_mesh_verts(&treeData, calc->target, 0.0, 2, 6), bvhtree_verts);
+	if (treeData.tree == NULL) {
+		OUT_OF_MEMORY();
+		return;
+	}
+
+	data.calc = calc;
+	data.treeData = &treeData;
+
+	BLI_task_parallel_range_ex(0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb,
+	                           SHRINKWRAP_TASK_THRESHOLD);
 
 	free_bvhtree_from_mesh(&treeData);
 }
@@ -271,21 +298,108 @@ int BKE_shrinkwrap_project_normal(char options, const float vert[3],
 }
 
 
-static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
+static void shrinkwrap_calc_normal_projection_cb(void *userdata, int start, int stop)
 {
-	int i;
+	ShrinkwrapCalcCBData *data = userdata;
+	ShrinkwrapCalcData *calc = data->calc;
+	BVHTreeFromMesh *treeData = data->treeData;
+	BVHTreeFromMesh *auxData = data->auxData;
+	const float *proj_axis = data->proj_axis;
 
-	/* Options about projection direction */
-	const char use_normal   = calc->smd->shrinkOpts;
+	const char use_normal = calc->smd->shrinkOpts;
 	const float proj_limit_squared = calc->smd->projLimit * calc->smd->projLimit;
-	float proj_axis[3]      = {0.0f, 0.0f, 0.0f};
-
-	/* Raycast and tree stuff */
 
 	/** \note 'hit.dist' is kept in the targets space, this is only used
 	 * for finding the best hit, to get the real dist,
 	 * measure the len_v3v3() from the input coord to hit.co */
 	BVHTreeRayHit hit;
+	int i;
+
+	for (i = start; i < stop; ++i) {
+		float *co = calc->vertexCos[i];
+		float tmp_co[3], tmp_no[3];
+		const float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+
+		if (weight == 0.0f) {
+			continue;
+		}
+
+		if (calc->vert) {
+			/* calc->vert contains verts from derivedMesh  */
+			/* this coordinated are deformed by vertexCos only for normal projection (to get correct normals) */
+			/* for other cases calc->varts contains undeformed coordinates and vertexCos should be used */
+			if (calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
+				copy_v3_v3(tmp_co, calc->vert[i].co);
+				normal_short_to_float_v3(tmp_no, calc->vert[i].no);
+			}
+			else {
+				copy_v3_v3(tmp_co, co);
+				copy_v3_v3(tmp_no, proj_axis);
+			}
+		}
+		else {
+			copy_v3_v3(tmp_co, co);
+			copy_v3_v3(tmp_no, proj_axis);
+		}
+
+
+		hit.index = -1;
+		hit.dist = 10000.0f; /* TODO: we should use FLT_MAX here, but sweepsphere code isn't prepared for that */
+
+		/* Project over positive direction of axis */
+		if (use_normal & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
+
+			if (auxData->tree) {
+				BKE_shrinkwrap_project_normal(0, tmp_co, tmp_no,
+				                              data->local2aux, auxData->tree, &hit,
+				                              auxData->raycast_callback, auxData);
+			}
+
+			BKE_shrinkwrap_project_normal(calc->smd->shrinkOpts, tmp_co, tmp_no,
+			                              &calc->local2target, treeData->tree, &hit,
+			                              treeData->raycast_callback, treeData);
+		}
+
+		/* Project over negative direction of axis */
+		if (use_normal & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
+			float inv_no[3];
+			negate_v3_v3(inv_no, tmp_no);
+
+			if (auxData->tree) {
+				BKE_shrinkwrap_project_normal(0, tmp_co, inv_no,
+				                              data->local2aux, auxData->tree, &hit,
+				                              auxData->raycast_callback, auxData);
+			}
+
+			BKE_shrinkwrap_project_normal(calc->smd->shrinkOpts, tmp_co, inv_no,
+			                              &calc->local2target, treeData->tree, &hit,
+			                              treeData->raycast_callback, treeData);
+		}
+
+		/* don't set the initial dist (which is more efficient),
+		 * because its calculated in the targets space, we want the dist in our own space */
+		if (proj_limit_squared != 0.0f) {
+			if (len_squared_v3v3(hit.co, co) > proj_limit_squared) {
+				hit.index = -1;
+			}
+		}
+
+		if (hit.index != -1) {
+			madd_v3_v3v3fl(hit.co, hit.co, tmp_no, calc->keepDist);
+			interp_v3_v3v3(co, co, hit.co, weight);
+		}
+	}
+}
+
+static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
+{
+	ShrinkwrapCalcCBData data = {NULL};
+
+	/* Options about projection direction */
+	const char use_normal   = calc->smd->shrinkOpts;
+	float proj_axis[3]      = {0.0f, 0.0f, 0.0f};
+
+	/* Raycast and tree stuff */
 	BVHTreeFromMesh treeData = NULL_BVHTreeFromMesh;
 
 	/* auxiliary target */
@@ -329,84 +443,14 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
 	if (bvhtree_from_mesh_faces(&treeData, calc->target, 0.0, 4, 6) &&
 	    (auxMesh == NULL || bvhtree_from_mesh_faces(&auxData, auxMesh, 0.0, 4, 6)))
 	{
-
-#ifndef __APPLE__
-#pragma omp parallel for private(i, hit) schedule(static)
-#endif
-		for (i = 0; i < calc->numVerts; ++i) {
-			float *co = calc->vertexCos[i];
-			float tmp_co[3], tmp_no[3];
-			const float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
-
-			if (weight == 0.0f) {
-				continue;
-			}
-
-			if (calc->vert) {
-				/* calc->vert contains verts from derivedMesh  */
-				/* this coordinated are deformed by vertexCos only for normal projection (to get correct normals) */
-				/* for other cases calc->varts contains undeformed coordinates and vertexCos should be used */
-				if (calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
-					copy_v3_v3(tmp_co, calc->vert[i].co);
-					normal_short_to_float_v3(tmp_no, calc->vert[i].no);
-				}
-				else {
-					copy_v3_v3(tmp_co, co);
-					copy_v3_v3(tmp_no, proj_axis);
-				}
-			}
-			else {
-				copy_v3_v3(tmp_co, co);
-				copy_v3_v3(tmp_no, proj_axis);
-			}
-
-
-			hit.index = -1;
-			hit.dist = 10000.0f; /* TODO: we should use FLT_MAX here, but sweepsphere code isn't prepared for that */
-
-			/* Project over positive direction of axis */
-			if (use_normal & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
-
-				if (auxData.tree) {
-					BKE_shrinkwrap_project_normal(0, tmp_co, tmp_no,
-					                              &local2aux, auxData.tree, &hit,
-					                              auxData.raycast_callback, &auxData);
-				}
-
-				BKE_shrinkwrap_project_normal(calc->smd->shrinkOpts, tmp_co, tmp_no,
-				                              &calc->local2target, treeData.tree, &hit,
-				                              treeData.raycast_callback, &treeData);
-			}
-
-			/* Project over negative direction of axis */
-			if (use_normal & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
-				float inv_no[3];
-				negate_v3_v3(inv_no, tmp_no);
-
-				if (auxData.tree) {
-					BKE_shrinkwrap_project_normal(0, tmp_co, inv_no,
-					                              &local2aux, auxData.tree, &hit,
-					                              auxData.raycast_callback, &auxData);
-				}
-
-				BKE_shrinkwrap_project_normal(calc->smd->shrinkOpts, tmp_co, inv_no,
-				                              &calc->local2target, treeData.tree, &hit,
-				                              treeData.raycast_callback, &treeData);
-			}
-
-			/* don't set the initial dist (which is more efficient),
-			 * because its calculated in the targets space, we want the dist in our own space */
-			if (proj_limit_squared != 0.0f) {
-				if (len_squared_v3v3(hit.co, co) > proj_limit_squared) {
-					hit.index = -1;
-				}
-			}
-
-			if (hit.index != -1) {
-				madd_v3_v3v3fl(hit.co, hit.co, tmp_no, calc->keepDist);
-				interp_v3_v3v3(co, co, hit.co, weight);
-			}
-		}
+		data.calc = calc;
+		data.treeData = &treeData;
+		data.auxData = &auxData;
+		data.local2aux = &local2aux;
+		data.proj_axis = proj_axis;
+
+		BLI_task_parallel_range_ex(0, calc->numVerts, &data, shrinkwrap_calc_normal_projection_cb,
+		                           SHRINKWRAP_TASK_THRESHOLD);
 	}
 
 	/* free data structures */
@@ -420,30 +464,20 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc)
  * it builds a BVHTree from the target mesh and then performs a
  * NN matches for each vertex
  */
-static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
+static void shrinkwrap_calc_nearest_surface_point_cb(void *userdata, int start, int stop)
 {
-	int i;
-
-	BVHTreeFromMesh treeData = NULL_BVHTreeFromMesh;
+	ShrinkwrapCalcCBData *data = userdata;
+	ShrinkwrapCalcData *calc = data->calc;
+	BVHTreeFromMesh *treeData = data->treeData;
 	BVHTreeNearest nearest  = NULL_BVHTreeNearest;
-
-	/* Create a bvh-tree of the given target */
-	bvhtree_from_mesh_faces(&treeData, calc->target, 0.0, 2, 6);
-	if (treeData.tree == NULL) {
-		OUT_OF_MEMORY();
-		return;
-	}
+	int i;
 
 	/* Setup nearest */
 	nearest.index = -1;
 	nearest.dist = FLT_MAX;
 
-
 	/* Find the nearest vertex */
-#ifndef __APPLE__
-#pragma omp parallel for default(none) private(i) firstprivate(nearest) shared(calc, treeData) schedule(static)
-#endif
-	for (i = 0; i < calc->numVerts; ++i) {
+	for (i = start; i < stop; ++i) {
 		float *co = calc->vertexCos[i];
 		float tmp_co[3];
 		float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
@@ -468,7 +502,7 @@ static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
 		else
 			nearest.dist = FLT_MAX;
 
-		BLI_bvhtree_find_nearest(treeData.tree, tmp_co, &nearest, treeData.nearest_callback, &treeData);
+		BLI_bvhtree_find_nearest(treeData->tree, tmp_co, &nearest, treeData->nearest_callback, treeData);
 
 		/* Found the nearest vertex */
 		if (nearest.index != -1) {
@@ -494,6 +528,25 @@ static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
 			interp_v3_v3v3(co, co, tmp_co, weight);  /* linear interpolation */
 		}
 	}
+}
+
+static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
+{
+	ShrinkwrapCalcCBData data = {NULL};
+	BVHTreeFromMesh treeData = NULL_BVHTreeFromMesh;
+
+	/* Create a bvh-tree of the given target */
+	bvhtree_from_mesh_faces(&treeData, calc->target, 0.0, 2, 6);
+	if (treeData.tree == NULL) {
+		OUT_OF_MEMORY();
+		return;
+	}
+
+	data.calc = calc;
+	data.treeData = &treeData;
+
+	BLI_task_parallel_range_ex(0, calc->numVerts, &data, shrinkwrap_calc_nearest_surface_point_cb,
+	                           SHRINKWRAP_TASK_THRESHOLD);
 
 	free_bvhtree_from_mesh(&treeData);
 }
@@ -36,6 +36,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_object_types.h"
@@ -63,6 +64,9 @@
 #ifdef WITH_AUDASPACE
 // evil global ;-)
 static int sound_cfra;
+
+/* protects the waveform pointers and loading flags, which are accessed by the preview job */
+static SpinLock waveform_spin;
 #endif
 
 bSound *sound_new_file(struct Main *bmain, const char *filename)
@@ -168,6 +172,7 @@ void sound_force_device(int device)
 void sound_init_once(void)
 {
 	AUD_initOnce();
+	BLI_spin_init(&waveform_spin);
 	atexit(sound_exit_once);
 }
 
@@ -221,6 +226,7 @@ void sound_exit_once(void)
 {
 	AUD_exit();
 	AUD_exitOnce();
+	BLI_spin_end(&waveform_spin);
 }
 
 // XXX unused currently
@@ -655,30 +661,78 @@ int sound_scene_playing(struct Scene *scene)
 
 void sound_free_waveform(bSound *sound)
 {
-	if (sound->waveform) {
-		MEM_freeN(((SoundWaveform *)sound->waveform)->data);
-		MEM_freeN(sound->waveform);
-	}
+	SoundWaveform *waveform;
 
+	BLI_spin_lock(&waveform_spin);
+	waveform = sound->waveform;
 	sound->waveform = NULL;
+	BLI_spin_unlock(&waveform_spin);
+
+	if (waveform) {
+		MEM_freeN(waveform->data);
+		MEM_freeN(waveform);
+	}
 }
 
-void sound_read_waveform(bSound *sound)
+void sound_read_waveform(bSound *sound, short *stop)
 {
 	AUD_SoundInfo info;
+	SoundWaveform *waveform = MEM_mallocN(sizeof(SoundWaveform), "SoundWaveform");
 
 	info = AUD_getInfo(sound->playback_handle);
 
 	if (info.length > 0) {
-		SoundWaveform *waveform = MEM_mallocN(sizeof(SoundWaveform), "SoundWaveform");
 		int length = info.length * SOUND_WAVE_SAMPLES_PER_SECOND;
 
 		waveform->data = MEM_mallocN(length * sizeof(float) * 3, "SoundWaveform.samples");
-		waveform->length = AUD_readSound(sound->playback_handle, waveform->data, length, SOUND_WAVE_SAMPLES_PER_SECOND);
+		waveform->length = AUD_readSound(sound->playback_handle, waveform->data, length, SOUND_WAVE_SAMPLES_PER_SECOND, stop);
+	}
+	else {
+		/* keep an empty waveform, so zero length sounds aren't read again on every redraw */
+		waveform->data = MEM_callocN(sizeof(float) * 3, "SoundWaveform.samples");
+		waveform->length = 0;
+	}
 
-		sound_free_waveform(sound);
+	if (stop && *stop) {
+		MEM_freeN(waveform->data);
+		MEM_freeN(waveform);
+		waveform = NULL;
+	}
+
+	BLI_spin_lock(&waveform_spin);
+	if (waveform && sound->waveform == NULL) {
 		sound->waveform = waveform;
+		waveform = NULL;
 	}
+	sound->flags &= ~SOUND_FLAGS_WAVEFORM_LOADING;
+	BLI_spin_unlock(&waveform_spin);
+
+	/* sound was reloaded or read in the meantime */
+	if (waveform) {
+		MEM_freeN(waveform->data);
+		MEM_freeN(waveform);
+	}
+}
+
+bool sound_request_waveform(bSound *sound)
+{
+	bool request = false;
+
+	BLI_spin_lock(&waveform_spin);
+	if (!sound->waveform && !(sound->flags & SOUND_FLAGS_WAVEFORM_LOADING)) {
+		sound->flags |= SOUND_FLAGS_WAVEFORM_LOADING;
+		request = true;
+	}
+	BLI_spin_unlock(&waveform_spin);
+
+	return request;
+}
+
+void sound_cancel_waveform(bSound *sound)
+{
+	BLI_spin_lock(&waveform_spin);
+	sound->flags &= ~SOUND_FLAGS_WAVEFORM_LOADING;
+	BLI_spin_unlock(&waveform_spin);
 }
 
 void sound_update_scene(struct Scene *scene)
@@ -804,7 +858,9 @@ void sound_stop_scene(struct Scene *UNUSED(scene)) {}
 void sound_seek_scene(struct Main *UNUSED(bmain), struct Scene *UNUSED(scene)) {}
 float sound_sync_scene(struct Scene *UNUSED(scene)) { return NAN_FLT; }
 int sound_scene_playing(struct Scene *UNUSED(scene)) { return -1; }
-void sound_read_waveform(struct bSound *sound) { (void)sound; }
+void sound_read_waveform(struct bSound *sound, short *stop) { (void)sound; (void)stop; }
+bool sound_request_waveform(struct bSound *sound) { (void)sound; return false; }
+void sound_cancel_waveform(struct bSound *sound) { (void)sound; }
 void sound_init_main(struct Main *bmain) { (void)bmain; }
 void sound_set_cfra(int cfra) { (void)cfra; }
 void sound_update_sequencer(struct Main *main, struct bSound *sound) { (void)main; (void)sound; }
@@ -1141,14 +1141,17 @@ static void ccgDM_copyFinalVertArray(DerivedMesh *dm, MVert *mvert)
 	int totvert, totedge, totface;
 	int gridSize = ccgSubSurf_getGridSize(ss);
 	int edgeSize = ccgSubSurf_getEdgeSize(ss);
-	unsigned int i = 0;
 
 	CCG_key_top_level(&key, ss);
 
+	/* every element writes from its own start index, so the faces and
+	 * edges can be converted in parallel */
 	totface = ccgSubSurf_getNumFaces(ss);
+	#pragma omp parallel for private(index, vd) if (totface * gridSize * gridSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
 		int x, y, S, numVerts = ccgSubSurf_getFaceNumVerts(f);
+		unsigned int i = ccgdm->faceMap[index].startVert;
 
 		vd = ccgSubSurf_getFaceCenterData(f);
 		ccgDM_to_MVert(&mvert[i++], &key, vd);
@@ -1171,8 +1174,10 @@ static void ccgDM_copyFinalVertArray(DerivedMesh *dm, MVert *mvert)
 	}
 
 	totedge = ccgSubSurf_getNumEdges(ss);
+	#pragma omp parallel for private(index, vd) if (totedge * edgeSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totedge; index++) {
 		CCGEdge *e = ccgdm->edgeMap[index].edge;
+		unsigned int i = ccgdm->edgeMap[index].startVert;
 		int x;
 
 		for (x = 1; x < edgeSize - 1; x++) {
@@ -1191,7 +1196,7 @@ static void ccgDM_copyFinalVertArray(DerivedMesh *dm, MVert *mvert)
 		CCGVert *v = ccgdm->vertMap[index].vert;
 
 		vd = ccgSubSurf_getVertData(ss, v);
-		ccgDM_to_MVert(&mvert[i++], &key, vd);
+		ccgDM_to_MVert(&mvert[ccgdm->vertMap[index].startVert], &key, vd);
 	}
 }
 
@@ -1213,14 +1218,15 @@ static void ccgDM_copyFinalEdgeArray(DerivedMesh *dm, MEdge *medge)
 	int totedge, totface;
 	int gridSize = ccgSubSurf_getGridSize(ss);
 	int edgeSize = ccgSubSurf_getEdgeSize(ss);
-	unsigned int i = 0;
 	short *edgeFlags = ccgdm->edgeFlags;
 	const short ed_interior_flag = ccgdm->drawInteriorEdges ? (ME_EDGEDRAW | ME_EDGERENDER) : 0;
 
 	totface = ccgSubSurf_getNumFaces(ss);
+	#pragma omp parallel for private(index) if (totface * gridSize * gridSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
 		int x, y, S, numVerts = ccgSubSurf_getFaceNumVerts(f);
+		unsigned int i = ccgdm->faceMap[index].startEdge;
 
 		for (S = 0; S < numVerts; S++) {
 			for (x = 0; x < gridSize - 1; x++) {
@@ -1246,8 +1252,10 @@ static void ccgDM_copyFinalEdgeArray(DerivedMesh *dm, MEdge *medge)
 	}
 
 	totedge = ccgSubSurf_getNumEdges(ss);
+	#pragma omp parallel for private(index) if (totedge * edgeSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totedge; index++) {
 		CCGEdge *e = ccgdm->edgeMap[index].edge;
+		unsigned int i = ccgdm->edgeMap[index].startEdge;
 		short ed_flag = 0;
 		int x;
 		int edgeIdx = GET_INT_FROM_POINTER(ccgSubSurf_getEdgeEdgeHandle(e));
@@ -1282,13 +1290,14 @@ static void ccgDM_copyFinalFaceArray(DerivedMesh *dm, MFace *mface)
 	int totface;
 	int gridSize = ccgSubSurf_getGridSize(ss);
 	int edgeSize = ccgSubSurf_getEdgeSize(ss);
-	int i = 0;
 	DMFlagMat *faceFlags = ccgdm->faceFlags;
 
 	totface = ccgSubSurf_getNumFaces(ss);
+	#pragma omp parallel for private(index) if (totface * gridSize * gridSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
 		int x, y, S, numVerts = ccgSubSurf_getFaceNumVerts(f);
+		int i = ccgdm->faceMap[index].startFace;
 		/* keep types in sync with MFace, avoid many conversions */
 		char flag = (faceFlags) ? faceFlags[index].flag : ME_SMOOTH;
 		short mat_nr = (faceFlags) ? faceFlags[index].mat_nr : 0;
@@ -1324,8 +1333,7 @@ static void ccgDM_copyFinalLoopArray(DerivedMesh *dm, MLoop *mloop)
 	int totface;
 	int gridSize = ccgSubSurf_getGridSize(ss);
 	int edgeSize = ccgSubSurf_getEdgeSize(ss);
-	int i = 0;
-	MLoop *mv;
+	int i;
 	/* DMFlagMat *faceFlags = ccgdm->faceFlags; */ /* UNUSED */
 
 	if (!ccgdm->ehash) {
@@ -1339,11 +1347,13 @@ static void ccgDM_copyFinalLoopArray(DerivedMesh *dm, MLoop *mloop)
 		}
 	}
 
+	/* the edge hash is only read from here on, faces can be converted in parallel */
 	totface = ccgSubSurf_getNumFaces(ss);
-	mv = mloop;
+	#pragma omp parallel for private(index) if (totface * gridSize * gridSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
 		int x, y, S, numVerts = ccgSubSurf_getFaceNumVerts(f);
+		MLoop *mv = &mloop[ccgdm->faceMap[index].startFace * 4];
 		/* int flag = (faceFlags) ? faceFlags[index * 2]: ME_SMOOTH; */ /* UNUSED */
 		/* int mat_nr = (faceFlags) ? faceFlags[index * 2 + 1]: 0; */ /* UNUSED */
 
@@ -1364,19 +1374,19 @@ static void ccgDM_copyFinalLoopArray(DerivedMesh *dm, MLoop *mloop)
 
 					mv->v = v1;
 					mv->e = GET_UINT_FROM_POINTER(BLI_edgehash_lookup(ccgdm->ehash, v1, v2));
-					mv++, i++;
+					mv++;
 
 					mv->v = v2;
 					mv->e = GET_UINT_FROM_POINTER(BLI_edgehash_lookup(ccgdm->ehash, v2, v3));
-					mv++, i++;
+					mv++;
 
 					mv->v = v3;
 					mv->e = GET_UINT_FROM_POINTER(BLI_edgehash_lookup(ccgdm->ehash, v3, v4));
-					mv++, i++;
+					mv++;
 
 					mv->v = v4;
 					mv->e = GET_UINT_FROM_POINTER(BLI_edgehash_lookup(ccgdm->ehash, v4, v1));
-					mv++, i++;
+					mv++;
 				}
 			}
 		}
@@ -1391,13 +1401,14 @@ static void ccgDM_copyFinalPolyArray(DerivedMesh *dm, MPoly *mpoly)
 	int totface;
 	int gridSize = ccgSubSurf_getGridSize(ss);
 	/* int edgeSize = ccgSubSurf_getEdgeSize(ss); */ /* UNUSED */
-	int i = 0, k = 0;
 	DMFlagMat *faceFlags = ccgdm->faceFlags;
 
 	totface = ccgSubSurf_getNumFaces(ss);
+	#pragma omp parallel for private(index) if (totface * gridSize * gridSize * 4 >= CCG_OMP_LIMIT)
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
 		int x, y, S, numVerts = ccgSubSurf_getFaceNumVerts(f);
+		int i = ccgdm->faceMap[index].startFace, k = i * 4;
 		int flag = (faceFlags) ? faceFlags[index].flag : ME_SMOOTH;
 		int mat_nr = (faceFlags) ? faceFlags[index].mat_nr : 0;
 
@@ -3391,37 +3402,38 @@ static CCGDerivedMesh *getCCGDerivedMesh(CCGSubSurf *ss,
 
 		vertNum++;
 
-		/*interpolate per-vert data*/
+		/*interpolate per-vert data, a row of verts at a time since their
+		 * weights are numVerts apart*/
 		for (s = 0; s < numVerts; s++) {
-			for (x = 1; x < gridFaces; x++) {
-				w2 = w + s * numVerts * g2_wid * g2_wid + x * numVerts;
-				DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2,
-				                    numVerts, vertNum);
+			w2 = w + s * numVerts * g2_wid * g2_wid + numVerts;
+			CustomData_interp_strided(&dm->vertData, &ccgdm->dm.vertData, vertidx, w2, numVerts,
+			                          numVerts, vertNum, gridFaces - 1);
 
-				if (vertOrigIndex) {
+			if (vertOrigIndex) {
+				for (x = 1; x < gridFaces; x++) {
 					*vertOrigIndex = ORIGINDEX_NONE;
 					vertOrigIndex++;
 				}
-
-				vertNum++;
 			}
+
+			vertNum += gridFaces - 1;
 		}
 
 		/*interpolate per-vert data*/
 		for (s = 0; s < numVerts; s++) {
 			for (y = 1; y < gridFaces; y++) {
-				for (x = 1; x < gridFaces; x++) {
-					w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-					DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2,
-					                    numVerts, vertNum);
+				w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + 1) * numVerts;
+				CustomData_interp_strided(&dm->vertData, &ccgdm->dm.vertData, vertidx, w2, numVerts,
+				                          numVerts, vertNum, gridFaces - 1);
 
-					if (vertOrigIndex) {
+				if (vertOrigIndex) {
+					for (x = 1; x < gridFaces; x++) {
 						*vertOrigIndex = ORIGINDEX_NONE;
 						vertOrigIndex++;
 					}
-
-					vertNum++;
 				}
+
+				vertNum += gridFaces - 1;
 			}
 		}
 
@@ -50,6 +50,7 @@
 #include "BLI_ghash.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLF_translation.h"
@@ -2497,11 +2498,28 @@ typedef struct TrackContext {
 	float *mask;
 } TrackContext;
 
+/* Frames loaded while tracking, shared by all tracks. Tracks matching the
+ * previous frame use the last destination frame as reference, tracks matching
+ * keyframes keep using the same frame, so they're only read once. */
+typedef struct TrackingFrame {
+	struct TrackingFrame *next, *prev;
+	int framenr;  /* in clip space */
+	ImBuf *ibuf;
+} TrackingFrame;
+
+typedef struct TrackingFrameCache {
+	ListBase frames;
+	ThreadMutex mutex;
+} TrackingFrameCache;
+
 typedef struct MovieTrackingContext {
 	MovieClipUser user;
 	MovieClip *clip;
 	int clip_flag;
 
+	TrackingFrameCache frame_cache;
+	ThreadMutex insert_mutex;
+
 	int frames, first_frame;
 	bool first_time;
 
@@ -2512,6 +2530,8 @@ typedef struct MovieTrackingContext {
 	int sync_frame;
 } MovieTrackingContext;
 
+static void tracking_frame_cache_free(TrackingFrameCache *cache);
+
 static void track_context_free(void *customdata)
 {
 	TrackContext *track_context = (TrackContext *)customdata;
@@ -2601,6 +2621,9 @@ MovieTrackingContext *BKE_tracking_context_new(MovieClip *clip, MovieClipUser *u
 	context->user.render_size = MCLIP_PROXY_RENDER_SIZE_FULL;
 	context->user.render_flag = 0;
 
+	BLI_mutex_init(&context->frame_cache.mutex);
+	BLI_mutex_init(&context->insert_mutex);
+
 	if (!sequence)
 		BLI_begin_threaded_malloc();
 
@@ -2613,6 +2636,9 @@ void BKE_tracking_context_free(MovieTrackingContext *context)
 	if (!context->sequence)
 		BLI_end_threaded_malloc();
 
+	tracking_frame_cache_free(&context->frame_cache);
+	BLI_mutex_end(&context->insert_mutex);
+
 	tracks_map_free(context->tracks_map, track_context_free);
 
 	MEM_freeN(context);
@@ -2712,22 +2738,106 @@ static float *track_get_search_floatbuf(ImBuf *ibuf, MovieTrackingTrack *track,
 	return gray_pixels;
 }
 
-/* Get image boffer for a given frame
+/* Get image boffer for a given frame, from the frame cache when it's given.
+ * The returned buffer is to be freed with IMB_freeImBuf in both cases.
  *
  * Frame is in clip space.
  */
-static ImBuf *tracking_context_get_frame_ibuf(MovieClip *clip, MovieClipUser *user, int clip_flag, int framenr)
+static ImBuf *tracking_context_get_frame_ibuf(TrackingFrameCache *cache, MovieClip *clip, MovieClipUser *user,
+                                              int clip_flag, int framenr)
 {
 	ImBuf *ibuf;
 	MovieClipUser new_user = *user;
+	TrackingFrame *frame;
+
+	if (cache) {
+		BLI_mutex_lock(&cache->mutex);
+		for (frame = cache->frames.first; frame; frame = frame->next) {
+			if (frame->framenr == framenr) {
+				IMB_refImBuf(frame->ibuf);
+				BLI_mutex_unlock(&cache->mutex);
+				return frame->ibuf;
+			}
+		}
+		BLI_mutex_unlock(&cache->mutex);
+	}
 
 	new_user.framenr = BKE_movieclip_remap_clip_to_scene_frame(clip, framenr);
 
+	/* read outside of the lock, so tracks with different keyframes load in parallel */
 	ibuf = BKE_movieclip_get_ibuf_flag(clip, &new_user, clip_flag, MOVIECLIP_CACHE_SKIP);
 
+	if (cache && ibuf) {
+		BLI_mutex_lock(&cache->mutex);
+		for (frame = cache->frames.first; frame; frame = frame->next) {
+			if (frame->framenr == framenr)
+				break;
+		}
+
+		if (frame) {
+			/* loaded by another thread in the meantime */
+			IMB_freeImBuf(ibuf);
+			ibuf = frame->ibuf;
+		}
+		else {
+			frame = MEM_callocN(sizeof(TrackingFrame), "tracking frame");
+			frame->framenr = framenr;
+			frame->ibuf = ibuf;
+			BLI_addtail(&cache->frames, frame);
+		}
+
+		IMB_refImBuf(ibuf);
+		BLI_mutex_unlock(&cache->mutex);
+	}
+
 	return ibuf;
 }
 
+/* Drop cached frames which are not used as reference by any track any more,
+ * keep_framenr is the frame which is going to be tracked from next.
+ */
+static void tracking_frame_cache_trim(TrackingFrameCache *cache, TracksMap *map, int keep_framenr,
+                                      int prefetch_framenr)
+{
+	TrackingFrame *frame, *frame_next;
+	int a, map_size = tracks_map_get_size(map);
+
+	for (frame = cache->frames.first; frame; frame = frame_next) {
+		bool used = ELEM(frame->framenr, keep_framenr, prefetch_framenr);
+
+		frame_next = frame->next;
+
+		for (a = 0; a < map_size && !used; a++) {
+			MovieTrackingTrack *track;
+			TrackContext *track_context;
+
+			tracks_map_get_indexed_element(map, a, &track, (void **)&track_context);
+
+			if (track->pattern_match == TRACK_MATCH_KEYFRAME &&
+			    track_context->reference_marker.framenr == frame->framenr)
+			{
+				used = true;
+			}
+		}
+
+		if (!used) {
+			IMB_freeImBuf(frame->ibuf);
+			BLI_freelinkN(&cache->frames, frame);
+		}
+	}
+}
+
+static void tracking_frame_cache_free(TrackingFrameCache *cache)
+{
+	TrackingFrame *frame;
+
+	for (frame = cache->frames.first; frame; frame = frame->next)
+		IMB_freeImBuf(frame->ibuf);
+
+	BLI_freelistN(&cache->frames);
+	BLI_mutex_end(&cache->mutex);
+}
+
 /* Get previous keyframed marker. */
 static MovieTrackingMarker *tracking_context_get_keyframed_marker(MovieTrackingTrack *track,
                                                                   int curfra, bool backwards)
@@ -2774,8 +2884,8 @@ static MovieTrackingMarker *tracking_context_get_keyframed_marker(MovieTrackingT
 }
 
 /* Get image buffer for previous marker's keyframe. */
-static ImBuf *tracking_context_get_keyframed_ibuf(MovieClip *clip, MovieClipUser *user, int clip_flag,
-                                                  MovieTrackingTrack *track, int curfra, bool backwards,
+static ImBuf *tracking_context_get_keyframed_ibuf(TrackingFrameCache *cache, MovieClip *clip,
+                                                  MovieClipUser *user, int clip_flag, MovieTrackingTrack *track, int curfra, bool backwards,
                                                   MovieTrackingMarker **marker_keyed_r)
 {
 	MovieTrackingMarker *marker_keyed;
@@ -2790,21 +2900,22 @@ static ImBuf *tracking_context_get_keyframed_ibuf(MovieClip *clip, MovieClipUser
 
 	*marker_keyed_r = marker_keyed;
 
-	return tracking_context_get_frame_ibuf(clip, user, clip_flag, keyed_framenr);
+	return tracking_context_get_frame_ibuf(cache, clip, user, clip_flag, keyed_framenr);
 }
 
 /* Get image buffer which si used as referece for track. */
-static ImBuf *tracking_context_get_reference_ibuf(MovieClip *clip, MovieClipUser *user, int clip_flag,
-                                                  MovieTrackingTrack *track, int curfra, bool backwards,
+static ImBuf *tracking_context_get_reference_ibuf(TrackingFrameCache *cache, MovieClip *clip,
+                                                  MovieClipUser *user, int clip_flag, MovieTrackingTrack *track, int curfra, bool backwards,
                                                   MovieTrackingMarker **reference_marker)
 {
 	ImBuf *ibuf = NULL;
 
 	if (track->pattern_match == TRACK_MATCH_KEYFRAME) {
-		ibuf = tracking_context_get_keyframed_ibuf(clip, user, clip_flag, track, curfra, backwards, reference_marker);
+		ibuf = tracking_context_get_keyframed_ibuf(cache, clip, user, clip_flag, track, curfra, backwards,
+		                                           reference_marker);
 	}
 	else {
-		ibuf = tracking_context_get_frame_ibuf(clip, user, clip_flag, curfra);
+		ibuf = tracking_context_get_frame_ibuf(cache, clip, user, clip_flag, curfra);
 
 		/* use current marker as keyframed position */
 		*reference_marker = BKE_tracking_marker_get(track, curfra);
@@ -2826,8 +2937,9 @@ static bool track_context_update_reference(MovieTrackingContext *context, TrackC
 	int width, height;
 
 	/* calculate patch for keyframed position */
-	reference_ibuf = tracking_context_get_reference_ibuf(context->clip, &context->user, context->clip_flag,
-	                                                     track, curfra, context->backwards, &reference_marker);
+	reference_ibuf = tracking_context_get_reference_ibuf(&context->frame_cache, context->clip, &context->user,
+	                                                     context->clip_flag, track, curfra, context->backwards,
+	                                                     &reference_marker);
 
 	if (!reference_ibuf)
 		return false;
@@ -3032,38 +3144,23 @@ static bool configure_and_run_tracker(ImBuf *destination_ibuf, MovieTrackingTrac
 	return tracked;
 }
 
-/* Track all the tracks from context one more frame,
- * returns FALSe if nothing was tracked.
- */
-bool BKE_tracking_context_step(MovieTrackingContext *context)
-{
+typedef struct TrackingStepData {
+	MovieTrackingContext *context;
 	ImBuf *destination_ibuf;
-	int frame_delta = context->backwards ? -1 : 1;
-	int curfra =  BKE_movieclip_remap_scene_to_clip_frame(context->clip, context->user.framenr);
-	int a, map_size;
-	bool ok = false;
-
+	int curfra;
 	int frame_width, frame_height;
+	bool ok;
+} TrackingStepData;
 
-	map_size = tracks_map_get_size(context->tracks_map);
-
-	/* Nothing to track, avoid unneeded frames reading to save time and memory. */
-	if (!map_size)
-		return false;
-
-	/* Get an image buffer for frame we're tracking to. */
-	context->user.framenr += frame_delta;
-
-	destination_ibuf = BKE_movieclip_get_ibuf_flag(context->clip, &context->user,
-	                                               context->clip_flag, MOVIECLIP_CACHE_SKIP);
-	if (!destination_ibuf)
-		return false;
-
-	frame_width = destination_ibuf->x;
-	frame_height = destination_ibuf->y;
+static void tracking_step_tracks(void *userdata, int start, int stop)
+{
+	TrackingStepData *data = userdata;
+	MovieTrackingContext *context = data->context;
+	const int curfra = data->curfra;
+	const int frame_width = data->frame_width, frame_height = data->frame_height;
+	int a;
 
-	#pragma omp parallel for private(a) shared(destination_ibuf, ok) if (map_size > 1)
-	for (a = 0; a < map_size; a++) {
+	for (a = start; a < stop; a++) {
 		TrackContext *track_context = NULL;
 		MovieTrackingTrack *track;
 		MovieTrackingMarker *marker;
@@ -3092,7 +3189,7 @@ bool BKE_tracking_context_step(MovieTrackingContext *context)
 					}
 				}
 
-				tracked = configure_and_run_tracker(destination_ibuf, track,
+				tracked = configure_and_run_tracker(data->destination_ibuf, track,
 				                                    &track_context->reference_marker, marker,
 				                                    track_context->search_area,
 				                                    track_context->search_area_width,
@@ -3101,22 +3198,78 @@ bool BKE_tracking_context_step(MovieTrackingContext *context)
 				                                    dst_pixel_x, dst_pixel_y);
 			}
 
-			#pragma omp critical
-			{
-				tracking_insert_new_marker(context, track, marker, curfra, tracked,
-				                           frame_width, frame_height, dst_pixel_x, dst_pixel_y);
-			}
-
-			ok = true;
+			BLI_mutex_lock(&context->insert_mutex);
+			tracking_insert_new_marker(context, track, marker, curfra, tracked,
+			                           frame_width, frame_height, dst_pixel_x, dst_pixel_y);
+			data->ok = true;
+			BLI_mutex_unlock(&context->insert_mutex);
 		}
 	}
+}
 
-	IMB_freeImBuf(destination_ibuf);
+/* Reads the frame after the one being tracked to into the frame cache. */
+static void tracking_prefetch_frame_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	MovieTrackingContext *context = BLI_task_pool_userdata(pool);
+	int framenr = GET_INT_FROM_POINTER(taskdata);
+	ImBuf *ibuf;
+
+	ibuf = tracking_context_get_frame_ibuf(&context->frame_cache, context->clip, &context->user,
+	                                       context->clip_flag, framenr);
+	if (ibuf)
+		IMB_freeImBuf(ibuf);
+}
+
+/* Track all the tracks from context one more frame,
+ * returns FALSe if nothing was tracked.
+ */
+bool BKE_tracking_context_step(MovieTrackingContext *context)
+{
+	TrackingStepData data;
+	TaskPool *prefetch_pool;
+	int frame_delta = context->backwards ? -1 : 1;
+	int curfra =  BKE_movieclip_remap_scene_to_clip_frame(context->clip, context->user.framenr);
+	int map_size;
+
+	map_size = tracks_map_get_size(context->tracks_map);
+
+	/* Nothing to track, avoid unneeded frames reading to save time and memory. */
+	if (!map_size)
+		return false;
+
+	/* Get an image buffer for frame we're tracking to. */
+	context->user.framenr += frame_delta;
+
+	data.destination_ibuf = tracking_context_get_frame_ibuf(&context->frame_cache, context->clip, &context->user,
+	                                                        context->clip_flag, curfra + frame_delta);
+	if (!data.destination_ibuf)
+		return false;
+
+	data.context = context;
+	data.curfra = curfra;
+	data.frame_width = data.destination_ibuf->x;
+	data.frame_height = data.destination_ibuf->y;
+	data.ok = false;
+
+	/* read the next frame while tracking to this one */
+	prefetch_pool = BLI_task_pool_create(BLI_task_scheduler_get(), context);
+	BLI_task_pool_push(prefetch_pool, tracking_prefetch_frame_func,
+	                   SET_INT_IN_POINTER(curfra + 2 * frame_delta), false, TASK_PRIORITY_HIGH);
+
+	BLI_task_parallel_range_ex(0, map_size, &data, tracking_step_tracks, 2);
+
+	BLI_task_pool_work_and_wait(prefetch_pool);
+	BLI_task_pool_free(prefetch_pool);
+
+	IMB_freeImBuf(data.destination_ibuf);
+
+	tracking_frame_cache_trim(&context->frame_cache, context->tracks_map,
+	                          curfra + frame_delta, curfra + 2 * frame_delta);
 
 	context->first_time = false;
 	context->frames++;
 
-	return ok;
+	return data.ok;
 }
 
 void BKE_tracking_context_finish(MovieTrackingContext *context)
@@ -3188,7 +3341,7 @@ void BKE_tracking_refine_marker(MovieClip *clip, MovieTrackingTrack *track, Movi
 	 * magic with original frame number used to get reference frame for.
 	 */
 	reference_framenr = backwards ? marker->framenr + 1 : marker->framenr - 1;
-	reference_ibuf = tracking_context_get_reference_ibuf(clip, &user, clip_flag, track, reference_framenr,
+	reference_ibuf = tracking_context_get_reference_ibuf(NULL, clip, &user, clip_flag, track, reference_framenr,
 	                                                     backwards, &reference_marker);
 	if (reference_ibuf == NULL) {
 		return;
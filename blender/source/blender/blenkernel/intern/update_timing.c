@@ -0,0 +1,163 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): Blender Foundation 2014
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file update_timing.c
+ *  \ingroup bke
+ *
+ * Timing collector for scene updates.
+ *
+ * Entries are gathered while a scene update is running and moved to the
+ * result list once the outermost update ends, so the result always describes
+ * one complete update, also while the next one is in progress. Updates that
+ * evaluated nothing keep the previous result, the main loop calls an update
+ * on every event.
+ */
+
+#include <stdio.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+#include "BKE_update_timing.h"
+
+static ListBase timing_collect = {NULL, NULL};
+static ListBase timing_result = {NULL, NULL};
+static double timing_start = 0.0;
+static double timing_total = 0.0;
+static int timing_depth = 0;
+static int timing_serial = 0;
+static ThreadMutex timing_mutex = BLI_MUTEX_INITIALIZER;
+
+bool BKE_update_timing_enabled(void)
+{
+	return (G.debug & G_DEBUG_UPDATE_TIMING) != 0;
+}
+
+void BKE_update_timing_begin(void)
+{
+	if (!BKE_update_timing_enabled())
+		return;
+
+	if (timing_depth++ == 0) {
+		BLI_freelistN(&timing_collect);
+		timing_start = PIL_check_seconds_timer();
+	}
+}
+
+static int update_timing_cmp(void *a, void *b)
+{
+	const UpdateTimingEntry *entry_a = a, *entry_b = b;
+
+	if (entry_a->time < entry_b->time) return 1;
+	else if (entry_a->time > entry_b->time) return -1;
+	return 0;
+}
+
+void BKE_update_timing_end(void)
+{
+	/* the flag may have been cleared while updating */
+	if (timing_depth == 0)
+		return;
+
+	if (--timing_depth == 0 && timing_collect.first) {
+		BLI_freelistN(&timing_result);
+		BLI_sortlist(&timing_collect, update_timing_cmp);
+
+		timing_result = timing_collect;
+		timing_collect.first = timing_collect.last = NULL;
+		timing_total = PIL_check_seconds_timer() - timing_start;
+		timing_serial++;
+	}
+}
+
+void BKE_update_timing_add(eUpdateTimingType type, const char *owner, const char *name, double time)
+{
+	UpdateTimingEntry *entry;
+
+	if (timing_depth == 0)
+		return;
+
+	entry = MEM_callocN(sizeof(UpdateTimingEntry), "UpdateTimingEntry");
+	entry->type = type;
+	entry->time = time;
+	BLI_strncpy(entry->owner, owner ? owner : "", sizeof(entry->owner));
+	BLI_strncpy(entry->name, name ? name : "", sizeof(entry->name));
+
+	BLI_mutex_lock(&timing_mutex);
+	BLI_addtail(&timing_collect, entry);
+	BLI_mutex_unlock(&timing_mutex);
+}
+
+ListBase *BKE_update_timing_entries(void)
+{
+	return &timing_result;
+}
+
+double BKE_update_timing_total(void)
+{
+	return timing_total;
+}
+
+int BKE_update_timing_serial(void)
+{
+	return timing_serial;
+}
+
+const char *BKE_update_timing_type_name(eUpdateTimingType type)
+{
+	switch (type) {
+		case UPDATE_TIMING_OBJECT:     return "OBJECT";
+		case UPDATE_TIMING_MODIFIER:   return "MODIFIER";
+		case UPDATE_TIMING_CONSTRAINT: return "CONSTRAINT";
+		case UPDATE_TIMING_DRIVER:     return "DRIVER";
+	}
+
+	return "UNKNOWN";
+}
+
+void BKE_update_timing_print(int max_entries)
+{
+	UpdateTimingEntry *entry;
+	int i = 0;
+
+	printf("Scene update: %.3f ms\n", timing_total * 1000.0);
+
+	for (entry = timing_result.first; entry && i < max_entries; entry = entry->next, i++) {
+		printf("  %8.3f ms  %-10s %s%s%s\n", entry->time * 1000.0,
+		       BKE_update_timing_type_name(entry->type), entry->owner,
+		       entry->name[0] ? " / " : "", entry->name);
+	}
+}
+
+void BKE_update_timing_free(void)
+{
+	BLI_freelistN(&timing_collect);
+	BLI_freelistN(&timing_result);
+	timing_depth = 0;
+	timing_total = 0.0;
+}
@@ -26,6 +26,14 @@
  */
 
 int BLI_cpu_support_sse2(void);
+int BLI_cpu_support_sse41(void);
+int BLI_cpu_support_avx(void);
+int BLI_cpu_support_avx2(void);
+
+void BLI_cpu_dispatch_init(void);
+
+/* per module dispatch, called by BLI_cpu_dispatch_init */
+void BLI_math_dispatch_init(void);
 
 #endif
 
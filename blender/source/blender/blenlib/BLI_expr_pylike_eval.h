@@ -0,0 +1,59 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_EXPR_PYLIKE_EVAL_H__
+#define __BLI_EXPR_PYLIKE_EVAL_H__
+
+/** \file BLI_expr_pylike_eval.h
+ *  \ingroup bli
+ *
+ * Compiler and evaluator for a small subset of Python expressions: floating point
+ * arithmetic, comparisons, boolean operators, conditional expressions and the common
+ * functions of the 'math' module. Evaluation doesn't touch any global state, so it is
+ * safe to use from multiple threads at once.
+ */
+
+typedef struct ExprPyLike_Parsed ExprPyLike_Parsed;
+
+typedef enum eExprPyLike_EvalStatus {
+	EXPR_PYLIKE_SUCCESS = 0,
+	/* the expression couldn't be compiled, or too few parameter values were passed */
+	EXPR_PYLIKE_INVALID,
+	/* a result wasn't a finite number (division by zero, domain error, overflow...),
+	 * Python would raise an exception or give a different result here */
+	EXPR_PYLIKE_MATH_ERROR
+} eExprPyLike_EvalStatus;
+
+/* Compile the expression, parameters are referenced by their index in 'param_names'.
+ * Always returns a handle, use BLI_expr_pylike_is_valid() to check if compiling succeeded. */
+ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression, const char **param_names, int param_names_len);
+
+/* Free a compiled expression */
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr);
+
+/* Returns true if the expression was compiled successfully */
+bool BLI_expr_pylike_is_valid(const ExprPyLike_Parsed *expr);
+
+/* Evaluate the compiled expression with the given parameter values */
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(const ExprPyLike_Parsed *expr,
+                                            const double *param_values, int param_values_len,
+                                            double *r_result);
+
+#endif  /* __BLI_EXPR_PYLIKE_EVAL_H__ */
@@ -33,7 +33,7 @@ typedef struct HeapNode HeapNode;
 
 typedef void (*HeapFreeFP)(void *ptr);
 
-/* Creates a new heap. BLI_memarena is used for allocating nodes. Removed nodes
+/* Creates a new heap. BLI_mempool is used for allocating nodes. Removed nodes
  * are recycled, so memory usage will not shrink. */
 Heap           *BLI_heap_new_ex(unsigned int tot_reserve);
 Heap           *BLI_heap_new(void);
@@ -43,9 +43,16 @@ void            BLI_heap_free(Heap *heap, HeapFreeFP ptrfreefp);
  * duplicate values are allowed. */
 HeapNode       *BLI_heap_insert(Heap *heap, float value, void *ptr);
 
+/* Insert many nodes at once, building the heap in linear time. */
+void            BLI_heap_insert_array(Heap *heap, const float *values, void **ptrs, const unsigned int tot,
+                                      HeapNode **r_nodes);
+
 /* Remove a heap node. */
 void            BLI_heap_remove(Heap *heap, HeapNode *node);
 
+/* Change the value of a heap node, keeping the node valid. */
+void            BLI_heap_node_value_update(Heap *heap, HeapNode *node, float value);
+
 /* Return 0 if the heap is empty, 1 otherwise. */
 bool            BLI_heap_is_empty(Heap *heap);
 
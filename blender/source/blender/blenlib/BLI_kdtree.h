@@ -56,5 +56,13 @@ int BLI_kdtree_find_nearest_n(KDTree *tree, const float co[3], const float nor[3
 int BLI_kdtree_range_search(KDTree *tree, const float co[3], const float nor[3],
                             KDTreeNearest **r_nearest,
                             float range) ATTR_NONNULL(1, 2, 4) ATTR_WARN_UNUSED_RESULT;
+void BLI_kdtree_range_search_cb(KDTree *tree, const float co[3], float range,
+                                bool (*search_cb)(void *user_data, int index, const float co[3], float dist_sq),
+                                void *user_data) ATTR_NONNULL(1, 2, 4);
+
+/* batched queries, run in parallel */
+void BLI_kdtree_find_nearest_n_array(KDTree *tree, const float (*co)[3], unsigned int totco,
+                                     KDTreeNearest *r_nearest, int *r_found,
+                                     unsigned int n) ATTR_NONNULL(1, 2, 4);
 
 #endif  /* __BLI_KDTREE_H__ */
@@ -88,6 +88,7 @@ void mul_serie_m4(float R[4][4],
                   float M5[4][4], float M6[4][4], float M7[4][4], float M8[4][4]);
 
 void mul_m4_v3(float M[4][4], float r[3]);
+void mul_m4_v3_array(float M[4][4], float (*r)[3], const int totvec);
 void mul_v3_m4v3(float r[3], float M[4][4], const float v[3]);
 void mul_v2_m4v3(float r[2], float M[4][4], const float v[3]);
 void mul_v2_m2v2(float r[2], float M[2][2], const float v[2]);
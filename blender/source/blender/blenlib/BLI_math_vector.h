@@ -256,6 +256,7 @@ MINLINE void normal_short_to_float_v3(float r[3], const short n[3]);
 MINLINE void normal_float_to_short_v3(short r[3], const float n[3]);
 
 void minmax_v3v3_v3(float min[3], float max[3], const float vec[3]);
+void minmax_v3_array(float min[3], float max[3], const float (*vecs)[3], const int totvec);
 void minmax_v2v2_v2(float min[2], float max[2], const float vec[2]);
 
 void dist_ensure_v3_v3fl(float v1[3], const float v2[3], const float dist);
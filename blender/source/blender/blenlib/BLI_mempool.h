@@ -50,8 +50,11 @@ typedef struct BLI_mempool BLI_mempool;
  * first four bytes of the elements never contain the character string
  * 'free'.  use with care.*/
 
-BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
-                                unsigned int pchunk, unsigned int flag) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+BLI_mempool *BLI_mempool_create_ex(unsigned int esize, unsigned int totelem,
+                                   unsigned int pchunk, unsigned int flag,
+                                   const char *name) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(5);
+#define BLI_mempool_create(esize, totelem, pchunk, flag) \
+	BLI_mempool_create_ex(esize, totelem, pchunk, flag, __func__)
 void        *BLI_mempool_alloc(BLI_mempool *pool) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 void        *BLI_mempool_calloc(BLI_mempool *pool) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 void         BLI_mempool_free(BLI_mempool *pool, void *addr) ATTR_NONNULL(1, 2);
@@ -82,12 +85,29 @@ typedef struct BLI_mempool_iter {
 /* flag */
 enum {
 	BLI_MEMPOOL_SYSMALLOC  = (1 << 0),
-	BLI_MEMPOOL_ALLOW_ITER = (1 << 1)
+	BLI_MEMPOOL_ALLOW_ITER = (1 << 1),
+	/* alloc and free may be called from multiple threads at once, iterating
+	 * and clearing still need all other threads to be done with the pool */
+	BLI_MEMPOOL_THREADSAFE = (1 << 2)
 };
 
 void  BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL();
 void *BLI_mempool_iterstep(BLI_mempool_iter *iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+/** per thread element cache of a #BLI_MEMPOOL_THREADSAFE pool **/
+/* private structure */
+typedef struct BLI_mempool_tcache {
+	BLI_mempool *pool;
+	void *free;
+	unsigned int totfree;
+} BLI_mempool_tcache;
+
+void  BLI_mempool_tcache_init(BLI_mempool *pool, BLI_mempool_tcache *tcache) ATTR_NONNULL();
+void *BLI_mempool_tcache_alloc(BLI_mempool_tcache *tcache) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void *BLI_mempool_tcache_calloc(BLI_mempool_tcache *tcache) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void  BLI_mempool_tcache_free(BLI_mempool_tcache *tcache, void *addr) ATTR_NONNULL();
+void  BLI_mempool_tcache_end(BLI_mempool_tcache *tcache) ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_POLYFILL2D_H__
+#define __BLI_POLYFILL2D_H__
+
+/** \file BLI_polyfill2d.h
+ *  \ingroup bli
+ *  \brief Triangulate a single simple polygon (no holes), faster than scanfill.
+ */
+
+struct MemArena;
+
+/* r_tris must hold (coords_tot - 2) triangles, which are always written.
+ * coords_sign is the winding of the polygon (1 or -1), 0 to calculate it. */
+void BLI_polyfill_calc_arena(
+        const float (*coords)[2],
+        const unsigned int coords_tot,
+        int coords_sign,
+        unsigned int (*r_tris)[3],
+        struct MemArena *arena);
+
+void BLI_polyfill_calc(
+        const float (*coords)[2],
+        const unsigned int coords_tot,
+        int coords_sign,
+        unsigned int (*r_tris)[3]);
+
+/* fill a 3d polygon, projected along its normal */
+void BLI_polyfill_calc_v3_arena(
+        const float (*coords)[3],
+        const unsigned int coords_tot,
+        const float normal[3],
+        unsigned int (*r_tris)[3],
+        struct MemArena *arena);
+
+/* typically used for arena size */
+#define BLI_POLYFILL_ARENA_SIZE MEM_SIZE_OPTIMAL(1 << 14)
+
+#endif  /* __BLI_POLYFILL2D_H__ */
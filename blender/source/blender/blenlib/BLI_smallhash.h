@@ -32,10 +32,11 @@
  *  \ingroup bli
  */
 
-/* a light stack-friendly hash library,
+/* a light stack-friendly hash library for integer and pointer keys,
  * (it uses stack space for smallish hash tables) */
 
-/* based on a doubling non-chaining approach */
+/* based on an open addressing approach with inline keys and values,
+ * no memory is allocated per entry */
 
 #include "BLI_compiler_attrs.h"
 
@@ -47,29 +48,32 @@ typedef struct {
 /*how much stack space to use before dynamically allocating memory*/
 #define SMSTACKSIZE 64
 typedef struct SmallHash {
-	SmallHashEntry *table;
-	SmallHashEntry _stacktable[SMSTACKSIZE];
-	SmallHashEntry _copytable[SMSTACKSIZE];
-	SmallHashEntry *stacktable, *copytable;
-	unsigned int used;
-	unsigned int curhash;
-	unsigned int size;
+	unsigned int nbuckets;
+	unsigned int nentries;
+	unsigned int cursize;
+
+	SmallHashEntry *buckets;
+	SmallHashEntry buckets_stack[SMSTACKSIZE];
 } SmallHash;
 
 typedef struct {
-	SmallHash *hash;
+	SmallHash *sh;
 	unsigned int i;
 } SmallHashIter;
 
-void    BLI_smallhash_init(SmallHash *hash) ATTR_NONNULL(1);
-void    BLI_smallhash_release(SmallHash *hash) ATTR_NONNULL(1);
-void    BLI_smallhash_insert(SmallHash *hash, uintptr_t key, void *item) ATTR_NONNULL(1);
-void    BLI_smallhash_remove(SmallHash *hash, uintptr_t key) ATTR_NONNULL(1);
-void   *BLI_smallhash_lookup(SmallHash *hash, uintptr_t key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
-int     BLI_smallhash_haskey(SmallHash *hash, uintptr_t key) ATTR_NONNULL(1);
-int     BLI_smallhash_count(SmallHash *hash)  ATTR_NONNULL(1);
+void    BLI_smallhash_init_ex(SmallHash *sh, const unsigned int nentries_reserve) ATTR_NONNULL(1);
+void    BLI_smallhash_init(SmallHash *sh) ATTR_NONNULL(1);
+void    BLI_smallhash_release(SmallHash *sh) ATTR_NONNULL(1);
+void    BLI_smallhash_insert(SmallHash *sh, uintptr_t key, void *val) ATTR_NONNULL(1);
+bool    BLI_smallhash_reinsert(SmallHash *sh, uintptr_t key, void *val) ATTR_NONNULL(1);
+bool    BLI_smallhash_remove(SmallHash *sh, uintptr_t key) ATTR_NONNULL(1);
+void   *BLI_smallhash_lookup(SmallHash *sh, uintptr_t key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
+void  **BLI_smallhash_lookup_p(SmallHash *sh, uintptr_t key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
+bool    BLI_smallhash_haskey(SmallHash *sh, uintptr_t key) ATTR_NONNULL(1);
+int     BLI_smallhash_count(SmallHash *sh)  ATTR_NONNULL(1);
 void   *BLI_smallhash_iternext(SmallHashIter *iter, uintptr_t *key)  ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
-void   *BLI_smallhash_iternew(SmallHash *hash, SmallHashIter *iter, uintptr_t *key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
-/* void BLI_smallhash_print(SmallHash *hash); */ /* UNUSED */
+void  **BLI_smallhash_iternext_p(SmallHashIter *iter, uintptr_t *key)  ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
+void   *BLI_smallhash_iternew(SmallHash *sh, SmallHashIter *iter, uintptr_t *key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
+void  **BLI_smallhash_iternew_p(SmallHash *sh, SmallHashIter *iter, uintptr_t *key) ATTR_NONNULL(1) ATTR_WARN_UNUSED_RESULT;
 
 #endif /* __BLI_SMALLHASH_H__ */
@@ -100,6 +100,51 @@ ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 /* number of tasks done, for stats, don't use this to make decisions */
 size_t BLI_task_pool_tasks_done(TaskPool *pool);
 
+/* Parallel for loop
+ *
+ * Runs func on chunks of the range [start, stop) using the central
+ * TaskScheduler, threads take the next chunk when done with the previous one.
+ * Chunks may run on nested pools, so per thread data should be allocated by
+ * func for each chunk rather than indexed by thread. Ranges smaller than
+ * range_threshold are run on the calling thread. */
+
+typedef void (*TaskParallelRangeFunc)(void *userdata, int start, int stop);
+
+void BLI_task_parallel_range_ex(int start, int stop, void *userdata,
+                                TaskParallelRangeFunc func, const int range_threshold);
+void BLI_task_parallel_range(int start, int stop, void *userdata, TaskParallelRangeFunc func);
+
+/* Parallel for loop with per task data
+ *
+ * Each task running chunks gets its own copy of userdata_chunk, passed to
+ * func for every chunk it runs. Once the whole range is done, func_reduce
+ * is called on the calling thread for every copy, to combine partial results
+ * like sums or bounds into userdata. */
+
+typedef void (*TaskParallelRangeFuncEx)(void *userdata, void *userdata_chunk, int start, int stop);
+typedef void (*TaskParallelReduceFunc)(void *userdata, void *userdata_chunk);
+
+void BLI_task_parallel_range_reduce(int start, int stop, void *userdata,
+                                    void *userdata_chunk, const size_t userdata_chunk_size,
+                                    TaskParallelRangeFuncEx func, TaskParallelReduceFunc func_reduce,
+                                    const int range_threshold);
+
+/* Parallel iteration over the links of a ListBase or the elements of a mempool,
+ * iter_chunk items are handed to a thread at once. Items must not be added or
+ * removed while iterating. */
+
+struct BLI_mempool;
+struct Link;
+struct ListBase;
+
+typedef void (*TaskParallelListbaseFunc)(void *userdata, struct Link *iter, int index);
+typedef void (*TaskParallelMempoolFunc)(void *userdata, void *item);
+
+void BLI_task_parallel_listbase(struct ListBase *listbase, void *userdata,
+                                TaskParallelListbaseFunc func, const int iter_chunk);
+void BLI_task_parallel_mempool(struct BLI_mempool *mempool, void *userdata,
+                               TaskParallelMempoolFunc func, const int iter_chunk);
+
 #ifdef __cplusplus
 }
 #endif
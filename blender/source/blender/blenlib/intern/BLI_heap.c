@@ -24,6 +24,11 @@
  *  \ingroup bli
  *
  * A heap / priority queue ADT.
+ *
+ * A 4-ary heap stored in an array, each array element holds a copy of the
+ * node value so sifting only touches the array. Nodes themselves stay at a
+ * fixed address (allocated from a pool) and store their array index, so they
+ * can be used as handles to remove or update them.
  */
 
 #include <stdlib.h>
@@ -32,7 +37,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_utildefines.h"
-#include "BLI_memarena.h"
+#include "BLI_mempool.h"
 #include "BLI_heap.h"
 #include "BLI_strict_flags.h"
 
@@ -44,77 +49,113 @@ struct HeapNode {
 	unsigned int index;
 };
 
+typedef struct HeapElem {
+	float     value;  /* same as node->value */
+	HeapNode *node;
+} HeapElem;
+
 struct Heap {
 	unsigned int size;
 	unsigned int bufsize;
-	MemArena *arena;
-	HeapNode *freenodes;
-	HeapNode *nodes;
-	HeapNode **tree;
+	BLI_mempool *pool;
+	HeapElem *tree;
 };
 
 /* internal functions */
 
-#define HEAP_PARENT(i) ((i - 1) >> 1)
-#define HEAP_LEFT(i)   ((i << 1) + 1)
-#define HEAP_RIGHT(i)  ((i << 1) + 2)
-#define HEAP_COMPARE(a, b) (a->value < b->value)
+#define HEAP_ARITY 4
 
-#if 0  /* UNUSED */
-#define HEAP_EQUALS(a, b) (a->value == b->value)
-#endif
-
-BLI_INLINE void heap_swap(Heap *heap, const unsigned int i, const unsigned int j)
-{
-
-#if 0
-	SWAP(unsigned int,  heap->tree[i]->index, heap->tree[j]->index);
-	SWAP(HeapNode *,    heap->tree[i],        heap->tree[j]);
-#else
-	HeapNode **tree = heap->tree;
-	union {
-		unsigned int  index;
-		HeapNode     *node;
-	} tmp;
-	SWAP_TVAL(tmp.index, tree[i]->index, tree[j]->index);
-	SWAP_TVAL(tmp.node,  tree[i],        tree[j]);
-#endif
-}
+#define HEAP_PARENT(i) (((i) - 1) / HEAP_ARITY)
+#define HEAP_CHILD(i)  (((i) * HEAP_ARITY) + 1)
 
+/* sift the element at i down, moving the elements in its way up */
 static void heap_down(Heap *heap, unsigned int i)
 {
+	HeapElem *tree = heap->tree;
 	/* size won't change in the loop */
 	const unsigned int size = heap->size;
+	const HeapElem elem = tree[i];
 
 	while (1) {
-		const unsigned int l = HEAP_LEFT(i);
-		const unsigned int r = HEAP_RIGHT(i);
-		unsigned int smallest;
+		const unsigned int c = HEAP_CHILD(i);
+		unsigned int smallest, c_end, j;
 
-		smallest = ((l < size) && HEAP_COMPARE(heap->tree[l], heap->tree[i])) ? l : i;
+		if (c >= size)
+			break;
 
-		if ((r < size) && HEAP_COMPARE(heap->tree[r], heap->tree[smallest]))
-			smallest = r;
+		c_end = MIN2(c + HEAP_ARITY, size);
+		smallest = c;
+		for (j = c + 1; j < c_end; j++) {
+			if (tree[j].value < tree[smallest].value)
+				smallest = j;
+		}
 
-		if (smallest == i)
+		if (!(tree[smallest].value < elem.value))
 			break;
 
-		heap_swap(heap, i, smallest);
+		tree[i] = tree[smallest];
+		tree[i].node->index = i;
 		i = smallest;
 	}
+
+	tree[i] = elem;
+	elem.node->index = i;
 }
 
+/* sift the element at i up, moving the elements in its way down */
 static void heap_up(Heap *heap, unsigned int i)
 {
+	HeapElem *tree = heap->tree;
+	const HeapElem elem = tree[i];
+
 	while (i > 0) {
 		const unsigned int p = HEAP_PARENT(i);
 
-		if (HEAP_COMPARE(heap->tree[p], heap->tree[i]))
+		if (!(elem.value < tree[p].value))
 			break;
 
-		heap_swap(heap, p, i);
+		tree[i] = tree[p];
+		tree[i].node->index = i;
 		i = p;
 	}
+
+	tree[i] = elem;
+	elem.node->index = i;
+}
+
+/* restore the heap after the value at i changed */
+static void heap_update(Heap *heap, unsigned int i)
+{
+	if ((i > 0) && (heap->tree[i].value < heap->tree[HEAP_PARENT(i)].value)) {
+		heap_up(heap, i);
+	}
+	else {
+		heap_down(heap, i);
+	}
+}
+
+static void heap_reserve(Heap *heap, const unsigned int size)
+{
+	if (UNLIKELY(size > heap->bufsize)) {
+		while (heap->bufsize < size) {
+			heap->bufsize *= 2;
+		}
+		heap->tree = MEM_reallocN(heap->tree, heap->bufsize * sizeof(*heap->tree));
+	}
+}
+
+BLI_INLINE HeapNode *heap_node_new(Heap *heap, float value, void *ptr, const unsigned int index)
+{
+	HeapNode *node = BLI_mempool_alloc(heap->pool);
+
+	node->value = value;
+	node->ptr = ptr;
+	node->index = index;
+
+	heap->tree[index].value = value;
+	heap->tree[index].node = node;
+
+	return node;
 }
 
 
@@ -126,8 +167,8 @@ Heap *BLI_heap_new_ex(unsigned int tot_reserve)
 	Heap *heap = (Heap *)MEM_callocN(sizeof(Heap), __func__);
 	/* ensure we have at least one so we can keep doubling it */
 	heap->bufsize = MAX2(1, tot_reserve);
-	heap->tree = (HeapNode **)MEM_mallocN(heap->bufsize * sizeof(HeapNode *), "BLIHeapTree");
-	heap->arena = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 16), "heap arena");
+	heap->tree = (HeapElem *)MEM_mallocN(heap->bufsize * sizeof(HeapElem), "BLIHeapTree");
+	heap->pool = BLI_mempool_create(sizeof(HeapNode), heap->bufsize, 512, 0);
 
 	return heap;
 }
@@ -143,12 +184,12 @@ void BLI_heap_free(Heap *heap, HeapFreeFP ptrfreefp)
 
 	if (ptrfreefp) {
 		for (i = 0; i < heap->size; i++) {
-			ptrfreefp(heap->tree[i]->ptr);
+			ptrfreefp(heap->tree[i].node->ptr);
 		}
 	}
 
 	MEM_freeN(heap->tree);
-	BLI_memarena_free(heap->arena);
+	BLI_mempool_destroy(heap->pool);
 	MEM_freeN(heap);
 }
 
@@ -156,25 +197,9 @@ HeapNode *BLI_heap_insert(Heap *heap, float value, void *ptr)
 {
 	HeapNode *node;
 
-	if (UNLIKELY(heap->size >= heap->bufsize)) {
-		heap->bufsize *= 2;
-		heap->tree = MEM_reallocN(heap->tree, heap->bufsize * sizeof(*heap->tree));
-	}
-
-	if (heap->freenodes) {
-		node = heap->freenodes;
-		heap->freenodes = (HeapNode *)(((HeapNode *)heap->freenodes)->ptr);
-	}
-	else {
-		node = (HeapNode *)BLI_memarena_alloc(heap->arena, sizeof(*node));
-	}
-
-	node->value = value;
-	node->ptr = ptr;
-	node->index = heap->size;
-
-	heap->tree[node->index] = node;
+	heap_reserve(heap, heap->size + 1);
 
+	node = heap_node_new(heap, value, ptr, heap->size);
 	heap->size++;
 
 	heap_up(heap, node->index);
@@ -182,6 +207,45 @@ HeapNode *BLI_heap_insert(Heap *heap, float value, void *ptr)
 	return node;
 }
 
+/**
+ * Insert \a tot nodes at once, faster than inserting them one by one
+ * when \a tot is large compared to the size of the heap.
+ *
+ * \param r_nodes: Optional, filled with the node of each value.
+ */
+void BLI_heap_insert_array(Heap *heap, const float *values, void **ptrs, const unsigned int tot,
+                           HeapNode **r_nodes)
+{
+	const unsigned int size_prev = heap->size;
+	unsigned int i;
+
+	heap_reserve(heap, heap->size + tot);
+
+	for (i = 0; i < tot; i++) {
+		HeapNode *node = heap_node_new(heap, values[i], ptrs[i], heap->size + i);
+		if (r_nodes) {
+			r_nodes[i] = node;
+		}
+	}
+
+	heap->size += tot;
+
+	if (tot >= size_prev) {
+		/* rebuild bottom up, linear in the size of the heap */
+		if (heap->size > 1) {
+			i = HEAP_PARENT(heap->size - 1) + 1;
+			while (i--) {
+				heap_down(heap, i);
+			}
+		}
+	}
+	else {
+		for (i = size_prev; i < heap->size; i++) {
+			heap_up(heap, i);
+		}
+	}
+}
+
 bool BLI_heap_is_empty(Heap *heap)
 {
 	return (heap->size == 0);
@@ -194,25 +258,20 @@ unsigned int BLI_heap_size(Heap *heap)
 
 HeapNode *BLI_heap_top(Heap *heap)
 {
-	return heap->tree[0];
+	return heap->tree[0].node;
 }
 
 void *BLI_heap_popmin(Heap *heap)
 {
-	void *ptr = heap->tree[0]->ptr;
+	HeapNode *node = heap->tree[0].node;
+	void *ptr = node->ptr;
 
 	BLI_assert(heap->size != 0);
 
-	heap->tree[0]->ptr = heap->freenodes;
-	heap->freenodes = heap->tree[0];
-
-	if (UNLIKELY(heap->size == 1)) {
-		heap->size--;
-	}
-	else {
-		heap_swap(heap, 0, heap->size - 1);
-		heap->size--;
+	BLI_mempool_free(heap->pool, node);
 
+	if (--heap->size) {
+		heap->tree[0] = heap->tree[heap->size];
 		heap_down(heap, 0);
 	}
 
@@ -221,18 +280,29 @@ void *BLI_heap_popmin(Heap *heap)
 
 void BLI_heap_remove(Heap *heap, HeapNode *node)
 {
-	unsigned int i = node->index;
+	const unsigned int i = node->index;
 
 	BLI_assert(heap->size != 0);
+	BLI_assert(heap->tree[i].node == node);
 
-	while (i > 0) {
-		unsigned int p = HEAP_PARENT(i);
+	BLI_mempool_free(heap->pool, node);
 
-		heap_swap(heap, p, i);
-		i = p;
+	if (i != --heap->size) {
+		heap->tree[i] = heap->tree[heap->size];
+		heap_update(heap, i);
 	}
+}
+
+/**
+ * Change the value of a node in place, use instead of removing and inserting it again.
+ */
+void BLI_heap_node_value_update(Heap *heap, HeapNode *node, float value)
+{
+	BLI_assert(heap->tree[node->index].node == node);
 
-	BLI_heap_popmin(heap);
+	node->value = value;
+	heap->tree[node->index].value = value;
+	heap_update(heap, node->index);
 }
 
 float BLI_heap_node_value(HeapNode *node)
@@ -244,4 +314,3 @@ void *BLI_heap_node_ptr(HeapNode *node)
 {
 	return node->ptr;
 }
-
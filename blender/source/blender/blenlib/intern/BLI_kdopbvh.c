@@ -31,11 +31,16 @@
 
 #include <assert.h>
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_utildefines.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 
 #ifdef _OPENMP
@@ -44,6 +49,10 @@
 
 #define MAX_TREETYPE 32
 
+/* overlap traversal is split over node pairs when the trees have this many leafs */
+#define BVH_OVERLAP_THREAD_MIN_LEAFS 1024
+#define BVH_OVERLAP_PAIRS_PER_THREAD 4
+
 typedef unsigned char axis_t;
 
 typedef struct BVHNode {
@@ -83,6 +92,13 @@ typedef struct BVHOverlapData {
 	axis_t start_axis, stop_axis;
 } BVHOverlapData;
 
+/* node pairs traversed in parallel, each with its own results */
+typedef struct BVHOverlapThreadData {
+	BVHTree *tree1, *tree2;
+	BVHNode **pairs;        /* two nodes per pair */
+	BVHOverlapData *data;   /* one per pair */
+} BVHOverlapThreadData;
+
 typedef struct BVHNearestData {
 	BVHTree *tree;
 	const float *co;
@@ -1019,6 +1035,21 @@ static int tree_overlap(BVHNode *node1, BVHNode *node2, axis_t start_axis, axis_
 	bv2 += start_axis << 1;
 	
 	/* test all axis if min + max overlap */
+#ifdef __SSE__
+	/* two axes at once, lanes are (min, max, min, max) of both axes,
+	 * swapping the pairs of bv2 compares bv1 min with bv2 max and the other way around */
+	for (; bv1 + 2 < bv1_end; bv1 += 4, bv2 += 4) {
+		const __m128 a = _mm_loadu_ps(bv1);
+		const __m128 b = _mm_shuffle_ps(_mm_loadu_ps(bv2), _mm_loadu_ps(bv2), _MM_SHUFFLE(2, 3, 0, 1));
+
+		if ((_mm_movemask_ps(_mm_cmpgt_ps(a, b)) & 0x5) ||
+		    (_mm_movemask_ps(_mm_cmplt_ps(a, b)) & 0xa))
+		{
+			return 0;
+		}
+	}
+#endif
+
 	for (; bv1 != bv1_end; bv1 += 2, bv2 += 2) {
 		if ((*(bv1) > *(bv2 + 1)) || (*(bv2) > *(bv1 + 1)))
 			return 0;
@@ -1043,13 +1074,8 @@ static void traverse(BVHOverlapData *data, BVHNode *node1, BVHNode *node2)
 
 				if (data->i >= data->max_overlap) {
 					/* try to make alloc'ed memory bigger */
-					data->overlap = realloc(data->overlap, sizeof(BVHTreeOverlap) * (size_t)data->max_overlap * 2);
-					
-					if (!data->overlap) {
-						printf("Out of Memory in traverse\n");
-						return;
-					}
-					data->max_overlap *= 2;
+					data->max_overlap = data->max_overlap ? data->max_overlap * 2 : 64;
+					data->overlap = MEM_reallocN(data->overlap, sizeof(BVHTreeOverlap) * (size_t)data->max_overlap);
 				}
 				
 				/* both leafs, insert overlap! */
@@ -1066,7 +1092,7 @@ static void traverse(BVHOverlapData *data, BVHNode *node1, BVHNode *node2)
 			}
 		}
 		else {
-			for (j = 0; j < data->tree2->tree_type; j++) {
+			for (j = 0; j < data->tree1->tree_type; j++) {
 				if (node1->children[j])
 					traverse(data, node1->children[j], node2);
 			}
@@ -1075,12 +1101,81 @@ static void traverse(BVHOverlapData *data, BVHNode *node1, BVHNode *node2)
 	return;
 }
 
+static void bvhtree_overlap_thread(void *userdata, int start, int stop)
+{
+	BVHOverlapThreadData *thread_data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		traverse(&thread_data->data[i], thread_data->pairs[2 * i], thread_data->pairs[2 * i + 1]);
+	}
+}
+
+/* Split the traversal into overlapping node pairs of the upper levels of both
+ * trees, so each thread has similar sized parts of both to traverse.
+ * pairs must have room for max_pairs * tree_type^2 pairs. */
+static int bvhtree_overlap_pairs_split(BVHNode **pairs, int totpair, const int max_pairs,
+                                       const BVHOverlapData *data)
+{
+	BVHNode **pairs_split = MEM_mallocN(sizeof(BVHNode *) * 2 * (size_t)max_pairs *
+	                                    (size_t)data->tree1->tree_type * (size_t)data->tree2->tree_type, __func__);
+
+	while (totpair < max_pairs) {
+		int totpair_split = 0;
+		bool changed = false;
+		int i, j, k;
+
+		for (i = 0; i < totpair; i++) {
+			BVHNode *node1 = pairs[2 * i], *node2 = pairs[2 * i + 1];
+
+			if (node1->totnode == 0 && node2->totnode == 0) {
+				pairs_split[2 * totpair_split] = node1;
+				pairs_split[2 * totpair_split + 1] = node2;
+				totpair_split++;
+				continue;
+			}
+
+			/* split both nodes of the pair at once, if they're branches */
+			for (j = 0; j < max_ii(node1->totnode, 1); j++) {
+				BVHNode *child1 = node1->totnode ? node1->children[j] : node1;
+
+				for (k = 0; k < max_ii(node2->totnode, 1); k++) {
+					BVHNode *child2 = node2->totnode ? node2->children[k] : node2;
+
+					if (child1 && child2 &&
+					    tree_overlap(child1, child2, data->start_axis, data->stop_axis))
+					{
+						pairs_split[2 * totpair_split] = child1;
+						pairs_split[2 * totpair_split + 1] = child2;
+						totpair_split++;
+					}
+				}
+			}
+
+			changed = true;
+		}
+
+		memcpy(pairs, pairs_split, sizeof(BVHNode *) * 2 * (size_t)totpair_split);
+		totpair = totpair_split;
+
+		if (!changed || totpair == 0) {
+			break;
+		}
+	}
+
+	MEM_freeN(pairs_split);
+
+	return totpair;
+}
+
 BVHTreeOverlap *BLI_bvhtree_overlap(BVHTree *tree1, BVHTree *tree2, unsigned int *result)
 {
-	int j;
+	int j, totpair, max_pairs;
 	unsigned int total = 0;
 	BVHTreeOverlap *overlap = NULL, *to = NULL;
-	BVHOverlapData **data;
+	BVHOverlapData data;
+	BVHOverlapThreadData thread_data;
+	BVHNode **pairs;
 	
 	/* check for compatibility of both trees (can't compare 14-DOP with 18-DOP) */
 	if ((tree1->axis != tree2->axis) && (tree1->axis == 14 || tree2->axis == 14) && (tree1->axis == 18 || tree2->axis == 18))
@@ -1094,41 +1189,57 @@ BVHTreeOverlap *BLI_bvhtree_overlap(BVHTree *tree1, BVHTree *tree2, unsigned int
 		return NULL;
 	}
 
-	data = MEM_callocN(sizeof(BVHOverlapData *) * tree1->tree_type, "BVHOverlapData_star");
-	
-	for (j = 0; j < tree1->tree_type; j++) {
-		data[j] = MEM_callocN(sizeof(BVHOverlapData), "BVHOverlapData");
-		
-		/* init BVHOverlapData */
-		data[j]->overlap = malloc(sizeof(BVHTreeOverlap) * (size_t)max_ii(tree1->totleaf, tree2->totleaf));
-		data[j]->tree1 = tree1;
-		data[j]->tree2 = tree2;
-		data[j]->max_overlap = (unsigned int)max_ii(tree1->totleaf, tree2->totleaf);
-		data[j]->i = 0;
-		data[j]->start_axis = min_axis(tree1->start_axis, tree2->start_axis);
-		data[j]->stop_axis  = min_axis(tree1->stop_axis,  tree2->stop_axis);
+	data.tree1 = tree1;
+	data.tree2 = tree2;
+	data.overlap = NULL;
+	data.i = 0;
+	data.max_overlap = 0;
+	data.start_axis = min_axis(tree1->start_axis, tree2->start_axis);
+	data.stop_axis  = min_axis(tree1->stop_axis,  tree2->stop_axis);
+
+	/* small trees aren't worth splitting */
+	if (tree1->totleaf + tree2->totleaf < BVH_OVERLAP_THREAD_MIN_LEAFS) {
+		max_pairs = 1;
+	}
+	else {
+		max_pairs = BLI_task_scheduler_num_threads(BLI_task_scheduler_get()) * BVH_OVERLAP_PAIRS_PER_THREAD;
 	}
 
-#pragma omp parallel for private(j) schedule(static)
-	for (j = 0; j < MIN2(tree1->tree_type, tree1->nodes[tree1->totleaf]->totnode); j++) {
-		traverse(data[j], tree1->nodes[tree1->totleaf]->children[j], tree2->nodes[tree2->totleaf]);
+	pairs = MEM_mallocN(sizeof(BVHNode *) * 2 * (size_t)max_pairs *
+	                    (size_t)tree1->tree_type * (size_t)tree2->tree_type, "BVHOverlap pairs");
+	pairs[0] = tree1->nodes[tree1->totleaf];
+	pairs[1] = tree2->nodes[tree2->totleaf];
+	totpair = bvhtree_overlap_pairs_split(pairs, 1, max_pairs, &data);
+
+	thread_data.tree1 = tree1;
+	thread_data.tree2 = tree2;
+	thread_data.pairs = pairs;
+	thread_data.data = MEM_mallocN(sizeof(BVHOverlapData) * (size_t)max_ii(totpair, 1), "BVHOverlapData");
+
+	for (j = 0; j < totpair; j++) {
+		thread_data.data[j] = data;
 	}
+
+	BLI_task_parallel_range_ex(0, totpair, &thread_data, bvhtree_overlap_thread, 2);
+
+	/* results are joined in pair order, so they don't depend on threading */
+	for (j = 0; j < totpair; j++)
+		total += thread_data.data[j].i;
 	
-	for (j = 0; j < tree1->tree_type; j++)
-		total += data[j]->i;
-	
-	to = overlap = MEM_callocN(sizeof(BVHTreeOverlap) * total, "BVHTreeOverlap");
-	
-	for (j = 0; j < tree1->tree_type; j++) {
-		memcpy(to, data[j]->overlap, data[j]->i * sizeof(BVHTreeOverlap));
-		to += data[j]->i;
+	if (total) {
+		to = overlap = MEM_mallocN(sizeof(BVHTreeOverlap) * total, "BVHTreeOverlap");
 	}
 	
-	for (j = 0; j < tree1->tree_type; j++) {
-		free(data[j]->overlap);
-		MEM_freeN(data[j]);
+	for (j = 0; j < totpair; j++) {
+		if (thread_data.data[j].overlap) {
+			memcpy(to, thread_data.data[j].overlap, thread_data.data[j].i * sizeof(BVHTreeOverlap));
+			to += thread_data.data[j].i;
+			MEM_freeN(thread_data.data[j].overlap);
+		}
 	}
-	MEM_freeN(data);
+
+	MEM_freeN(thread_data.data);
+	MEM_freeN(pairs);
 	
 	(*result) = total;
 	return overlap;
@@ -1478,37 +1589,44 @@ static void iterative_raycast(BVHRayCastData *data, BVHNode *node)
 }
 #endif
 
-int BLI_bvhtree_ray_cast(BVHTree *tree, const float co[3], const float dir[3], float radius, BVHTreeRayHit *hit,
-                         BVHTree_RayCastCallback callback, void *userdata)
+static void bvhtree_ray_cast_data_init(BVHRayCastData *data, BVHTree *tree,
+                                       const float co[3], const float dir[3], float radius,
+                                       BVHTree_RayCastCallback callback, void *userdata)
 {
 	int i;
-	BVHRayCastData data;
-	BVHNode *root = tree->nodes[tree->totleaf];
 
-	data.tree = tree;
+	data->tree = tree;
 
-	data.callback = callback;
-	data.userdata = userdata;
+	data->callback = callback;
+	data->userdata = userdata;
 
-	copy_v3_v3(data.ray.origin,    co);
-	copy_v3_v3(data.ray.direction, dir);
-	data.ray.radius = radius;
+	copy_v3_v3(data->ray.origin,    co);
+	copy_v3_v3(data->ray.direction, dir);
+	data->ray.radius = radius;
 
-	normalize_v3(data.ray.direction);
+	normalize_v3(data->ray.direction);
 
 	for (i = 0; i < 3; i++) {
-		data.ray_dot_axis[i] = dot_v3v3(data.ray.direction, KDOP_AXES[i]);
-		data.idot_axis[i] = 1.0f / data.ray_dot_axis[i];
+		data->ray_dot_axis[i] = dot_v3v3(data->ray.direction, KDOP_AXES[i]);
+		data->idot_axis[i] = 1.0f / data->ray_dot_axis[i];
 
-		if (fabsf(data.ray_dot_axis[i]) < FLT_EPSILON) {
-			data.ray_dot_axis[i] = 0.0;
+		if (fabsf(data->ray_dot_axis[i]) < FLT_EPSILON) {
+			data->ray_dot_axis[i] = 0.0;
 		}
-		data.index[2 * i] = data.idot_axis[i] < 0.0f ? 1 : 0;
-		data.index[2 * i + 1] = 1 - data.index[2 * i];
-		data.index[2 * i]   += 2 * i;
-		data.index[2 * i + 1] += 2 * i;
+		data->index[2 * i] = data->idot_axis[i] < 0.0f ? 1 : 0;
+		data->index[2 * i + 1] = 1 - data->index[2 * i];
+		data->index[2 * i]   += 2 * i;
+		data->index[2 * i + 1] += 2 * i;
 	}
+}
 
+int BLI_bvhtree_ray_cast(BVHTree *tree, const float co[3], const float dir[3], float radius, BVHTreeRayHit *hit,
+                         BVHTree_RayCastCallback callback, void *userdata)
+{
+	BVHRayCastData data;
+	BVHNode *root = tree->nodes[tree->totleaf];
+
+	bvhtree_ray_cast_data_init(&data, tree, co, dir, radius, callback, userdata);
 
 	if (hit)
 		memcpy(&data.hit, hit, sizeof(*hit));
@@ -1529,6 +1647,66 @@ int BLI_bvhtree_ray_cast(BVHTree *tree, const float co[3], const float dir[3], f
 	return data.hit.index;
 }
 
+typedef struct BVHRayCastThreadData {
+	BVHTree *tree;
+	const BVHTreeRay *rays;
+	BVHTreeRayHit *hits;
+	BVHTree_RayCastCallback callback;
+	void *userdata;
+} BVHRayCastThreadData;
+
+static void bvhtree_ray_cast_thread(void *userdata, int start, int stop)
+{
+	BVHRayCastThreadData *thread_data = userdata;
+	BVHNode *root = thread_data->tree->nodes[thread_data->tree->totleaf];
+	BVHRayCastData data;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		const BVHTreeRay *ray = &thread_data->rays[i];
+
+		bvhtree_ray_cast_data_init(&data, thread_data->tree, ray->origin, ray->direction, ray->radius,
+		                           thread_data->callback, thread_data->userdata);
+		data.hit = thread_data->hits[i];
+
+		if (root) {
+			dfs_raycast(&data, root);
+		}
+
+		thread_data->hits[i] = data.hit;
+	}
+}
+
+/**
+ * Cast many rays at once, spread over threads. hits must be initialized
+ * like for a single #BLI_bvhtree_ray_cast, and the callback must be
+ * thread safe.
+ *
+ * \return the number of rays that hit something.
+ */
+int BLI_bvhtree_ray_cast_n(BVHTree *tree, const BVHTreeRay *rays, BVHTreeRayHit *hits, int totray,
+                           BVHTree_RayCastCallback callback, void *userdata)
+{
+	BVHRayCastThreadData thread_data;
+	int i, tothit = 0;
+
+	thread_data.tree = tree;
+	thread_data.rays = rays;
+	thread_data.hits = hits;
+	thread_data.callback = callback;
+	thread_data.userdata = userdata;
+
+	BLI_task_parallel_range_ex(0, totray, &thread_data, bvhtree_ray_cast_thread, 64);
+
+	for (i = 0; i < totray; i++) {
+		if (hits[i].index != -1) {
+			tothit++;
+		}
+	}
+
+	return tothit;
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6], const float light_start[3], const float light_end[3], float pos[3])
 {
 	BVHRayCastData data;
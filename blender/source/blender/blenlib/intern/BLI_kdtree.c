@@ -29,12 +29,15 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
 
+/* nodes are stored in one array in balanced order, children are referenced
+ * by index, so the tree is compact and can be built by several threads */
 typedef struct KDTreeNode {
-	struct KDTreeNode *left, *right;
+	unsigned int left, right;
 	float co[3], nor[3];
 	int index;
 	unsigned int d;  /* range is only (0-2) */
@@ -43,13 +46,18 @@ typedef struct KDTreeNode {
 struct KDTree {
 	KDTreeNode *nodes;
 	unsigned int totnode;
-	KDTreeNode *root;
+	unsigned int root;
 };
 
 #define KD_STACK_INIT 100      /* initial size for array (on the stack) */
 #define KD_NEAR_ALLOC_INC 100  /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50  /* alloc increment for collecting nearest */
 
+#define KD_NODE_UNSET ((unsigned int)-1)
+
+/* subtrees with more nodes are balanced in a separate task */
+#define KD_BALANCE_THREAD_MIN 10000
+
 /**
  * Creates or free a kdtree
  */
@@ -60,7 +68,7 @@ KDTree *BLI_kdtree_new(unsigned int maxsize)
 	tree = MEM_mallocN(sizeof(KDTree), "KDTree");
 	tree->nodes = MEM_mallocN(sizeof(KDTreeNode) * maxsize, "KDTreeNode");
 	tree->totnode = 0;
-	tree->root = NULL;
+	tree->root = KD_NODE_UNSET;
 
 	return tree;
 }
@@ -83,7 +91,7 @@ void BLI_kdtree_insert(KDTree *tree, int index, const float co[3], const float n
 	/* note, array isn't calloc'd,
 	 * need to initialize all struct members */
 
-	node->left = node->right = NULL;
+	node->left = node->right = KD_NODE_UNSET;
 	copy_v3_v3(node->co, co);
 	if (nor)
 		copy_v3_v3(node->nor, nor);
@@ -94,16 +102,28 @@ void BLI_kdtree_insert(KDTree *tree, int index, const float co[3], const float n
 	node->d = 0;
 }
 
-static KDTreeNode *kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis)
+typedef struct KDTreeBalanceTask {
+	KDTreeNode *nodes;
+	unsigned int totnode;
+	unsigned int axis;
+	unsigned int ofs;
+	unsigned int *r_node;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task(TaskPool *pool, void *taskdata, int UNUSED(threadid));
+
+/* nodes is the part of the array to balance, starting at index ofs */
+static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis,
+                                   const unsigned int ofs, TaskPool *pool)
 {
 	KDTreeNode *node;
 	float co;
 	unsigned int left, right, median, i, j;
 
 	if (totnode <= 0)
-		return NULL;
+		return KD_NODE_UNSET;
 	else if (totnode == 1)
-		return nodes;
+		return 0 + ofs;
 	
 	/* quicksort style sorting around median */
 	left = 0;
@@ -132,18 +152,51 @@ static KDTreeNode *kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsig
 			left = i + 1;
 	}
 
-	/* set node and sort subnodes */
+	/* set node and sort subnodes, the halves don't share any nodes */
 	node = &nodes[median];
 	node->d = axis;
-	node->left = kdtree_balance(nodes, median, (axis + 1) % 3);
-	node->right = kdtree_balance(nodes + median + 1, (totnode - (median + 1)), (axis + 1) % 3);
+	axis = (axis + 1) % 3;
+
+	if (pool && median > KD_BALANCE_THREAD_MIN) {
+		KDTreeBalanceTask *task = MEM_mallocN(sizeof(KDTreeBalanceTask), __func__);
+
+		task->nodes = nodes;
+		task->totnode = median;
+		task->axis = axis;
+		task->ofs = ofs;
+		task->r_node = &node->left;
+
+		BLI_task_pool_push(pool, kdtree_balance_task, task, true, TASK_PRIORITY_HIGH);
+	}
+	else {
+		node->left = kdtree_balance(nodes, median, axis, ofs, pool);
+	}
+
+	node->right = kdtree_balance(nodes + median + 1, (totnode - (median + 1)), axis, (median + 1) + ofs, pool);
+
+	return median + ofs;
+}
+
+static void kdtree_balance_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	KDTreeBalanceTask *task = taskdata;
 
-	return node;
+	*task->r_node = kdtree_balance(task->nodes, task->totnode, task->axis, task->ofs, pool);
 }
 
 void BLI_kdtree_balance(KDTree *tree)
 {
-	tree->root = kdtree_balance(tree->nodes, tree->totnode, 0);
+	if (tree->totnode > KD_BALANCE_THREAD_MIN * 2) {
+		TaskPool *pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0, pool);
+
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0, NULL);
+	}
 }
 
 static float squared_distance(const float v2[3], const float v1[3], const float UNUSED(n1[3]), const float n2[3])
@@ -166,11 +219,13 @@ static float squared_distance(const float v2[3], const float v1[3], const float
 	return dist;
 }
 
-static KDTreeNode **realloc_nodes(KDTreeNode **stack, unsigned int *totstack, const bool is_alloc)
+/* a balanced tree needs one stack entry per level, so this only happens
+ * for trees with more points than fit in memory */
+static unsigned int *realloc_nodes(unsigned int *stack, unsigned int *totstack, const bool is_alloc)
 {
-	KDTreeNode **stack_new = MEM_mallocN((*totstack + KD_NEAR_ALLOC_INC) * sizeof(KDTreeNode *), "KDTree.treestack");
-	memcpy(stack_new, stack, *totstack * sizeof(KDTreeNode *));
-	// memset(stack_new + *totstack, 0, sizeof(KDTreeNode *) * KD_NEAR_ALLOC_INC);
+	unsigned int *stack_new = MEM_mallocN((*totstack + KD_NEAR_ALLOC_INC) * sizeof(unsigned int), "KDTree.treestack");
+	memcpy(stack_new, stack, *totstack * sizeof(unsigned int));
+	// memset(stack_new + *totstack, 0, sizeof(unsigned int) * KD_NEAR_ALLOC_INC);
 	if (is_alloc)
 		MEM_freeN(stack);
 	*totstack += KD_NEAR_ALLOC_INC;
@@ -183,36 +238,37 @@ static KDTreeNode **realloc_nodes(KDTreeNode **stack, unsigned int *totstack, co
 int BLI_kdtree_find_nearest(KDTree *tree, const float co[3], const float nor[3],
                             KDTreeNearest *r_nearest)
 {
-	KDTreeNode *root, *node, *min_node;
-	KDTreeNode **stack, *defaultstack[KD_STACK_INIT];
+	const KDTreeNode *nodes = tree->nodes;
+	const KDTreeNode *root, *min_node;
+	unsigned int *stack, defaultstack[KD_STACK_INIT];
 	float min_dist, cur_dist;
 	unsigned int totstack, cur = 0;
 
-	if (!tree->root)
+	if (UNLIKELY(tree->root == KD_NODE_UNSET))
 		return -1;
 
 	stack = defaultstack;
 	totstack = KD_STACK_INIT;
 
-	root = tree->root;
+	root = &nodes[tree->root];
 	min_node = root;
 	min_dist = squared_distance(root->co, co, root->nor, nor);
 
 	if (co[root->d] < root->co[root->d]) {
-		if (root->right)
+		if (root->right != KD_NODE_UNSET)
 			stack[cur++] = root->right;
-		if (root->left)
+		if (root->left != KD_NODE_UNSET)
 			stack[cur++] = root->left;
 	}
 	else {
-		if (root->left)
+		if (root->left != KD_NODE_UNSET)
 			stack[cur++] = root->left;
-		if (root->right)
+		if (root->right != KD_NODE_UNSET)
 			stack[cur++] = root->right;
 	}
 	
 	while (cur--) {
-		node = stack[cur];
+		const KDTreeNode *node = &nodes[stack[cur]];
 
 		cur_dist = node->co[node->d] - co[node->d];
 
@@ -225,10 +281,10 @@ int BLI_kdtree_find_nearest(KDTree *tree, const float co[3], const float nor[3],
 					min_dist = cur_dist;
 					min_node = node;
 				}
-				if (node->left)
+				if (node->left != KD_NODE_UNSET)
 					stack[cur++] = node->left;
 			}
-			if (node->right)
+			if (node->right != KD_NODE_UNSET)
 				stack[cur++] = node->right;
 		}
 		else {
@@ -240,10 +296,10 @@ int BLI_kdtree_find_nearest(KDTree *tree, const float co[3], const float nor[3],
 					min_dist = cur_dist;
 					min_node = node;
 				}
-				if (node->right)
+				if (node->right != KD_NODE_UNSET)
 					stack[cur++] = node->right;
 			}
-			if (node->left)
+			if (node->left != KD_NODE_UNSET)
 				stack[cur++] = node->left;
 		}
 		if (UNLIKELY(cur + 3 > totstack)) {
@@ -292,38 +348,39 @@ int BLI_kdtree_find_nearest_n(KDTree *tree, const float co[3], const float nor[3
                               KDTreeNearest r_nearest[],
                               unsigned int n)
 {
-	KDTreeNode *root, *node = NULL;
-	KDTreeNode **stack, *defaultstack[KD_STACK_INIT];
+	const KDTreeNode *nodes = tree->nodes;
+	const KDTreeNode *root;
+	unsigned int *stack, defaultstack[KD_STACK_INIT];
 	float cur_dist;
 	unsigned int totstack, cur = 0;
 	unsigned int i, found = 0;
 
-	if (!tree->root || n == 0)
+	if (UNLIKELY(tree->root == KD_NODE_UNSET || n == 0))
 		return 0;
 
 	stack = defaultstack;
 	totstack = KD_STACK_INIT;
 
-	root = tree->root;
+	root = &nodes[tree->root];
 
 	cur_dist = squared_distance(root->co, co, root->nor, nor);
 	add_nearest(r_nearest, &found, n, root->index, cur_dist, root->co);
 	
 	if (co[root->d] < root->co[root->d]) {
-		if (root->right)
+		if (root->right != KD_NODE_UNSET)
 			stack[cur++] = root->right;
-		if (root->left)
+		if (root->left != KD_NODE_UNSET)
 			stack[cur++] = root->left;
 	}
 	else {
-		if (root->left)
+		if (root->left != KD_NODE_UNSET)
 			stack[cur++] = root->left;
-		if (root->right)
+		if (root->right != KD_NODE_UNSET)
 			stack[cur++] = root->right;
 	}
 
 	while (cur--) {
-		node = stack[cur];
+		const KDTreeNode *node = &nodes[stack[cur]];
 
 		cur_dist = node->co[node->d] - co[node->d];
 
@@ -336,10 +393,10 @@ int BLI_kdtree_find_nearest_n(KDTree *tree, const float co[3], const float nor[3
 				if (found < n || cur_dist < r_nearest[found - 1].dist)
 					add_nearest(r_nearest, &found, n, node->index, cur_dist, node->co);
 
-				if (node->left)
+				if (node->left != KD_NODE_UNSET)
 					stack[cur++] = node->left;
 			}
-			if (node->right)
+			if (node->right != KD_NODE_UNSET)
 				stack[cur++] = node->right;
 		}
 		else {
@@ -350,10 +407,10 @@ int BLI_kdtree_find_nearest_n(KDTree *tree, const float co[3], const float nor[3
 				if (found < n || cur_dist < r_nearest[found - 1].dist)
 					add_nearest(r_nearest, &found, n, node->index, cur_dist, node->co);
 
-				if (node->right)
+				if (node->right != KD_NODE_UNSET)
 					stack[cur++] = node->right;
 			}
-			if (node->left)
+			if (node->left != KD_NODE_UNSET)
 				stack[cur++] = node->left;
 		}
 		if (UNLIKELY(cur + 3 > totstack)) {
@@ -370,6 +427,50 @@ int BLI_kdtree_find_nearest_n(KDTree *tree, const float co[3], const float nor[3
 	return (int)found;
 }
 
+typedef struct KDTreeNearestArrayData {
+	KDTree *tree;
+	const float (*co)[3];
+	KDTreeNearest *r_nearest;
+	int *r_found;
+	unsigned int n;
+} KDTreeNearestArrayData;
+
+static void kdtree_find_nearest_n_array_func(void *userdata, int start, int stop)
+{
+	KDTreeNearestArrayData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		const int found = BLI_kdtree_find_nearest_n(data->tree, data->co[i], NULL,
+		                                            &data->r_nearest[(unsigned int)i * data->n], data->n);
+
+		if (data->r_found) {
+			data->r_found[i] = found;
+		}
+	}
+}
+
+/**
+ * Find the n nearest points of many points at once, spread over threads.
+ *
+ * \param r_nearest  An array of nearest, sized at least \a totco * \a n,
+ * the results of each point start at its index * \a n.
+ * \param r_found  Optional array of the number of points found for each point.
+ */
+void BLI_kdtree_find_nearest_n_array(KDTree *tree, const float (*co)[3], unsigned int totco,
+                                     KDTreeNearest *r_nearest, int *r_found, unsigned int n)
+{
+	KDTreeNearestArrayData data;
+
+	data.tree = tree;
+	data.co = co;
+	data.r_nearest = r_nearest;
+	data.r_found = r_found;
+	data.n = n;
+
+	BLI_task_parallel_range_ex(0, (int)totco, &data, kdtree_find_nearest_n_array_func, 1024);
+}
+
 static int range_compare(const void *a, const void *b)
 {
 	const KDTreeNearest *kda = a;
@@ -382,15 +483,17 @@ static int range_compare(const void *a, const void *b)
 	else
 		return 0;
 }
-static void add_in_range(KDTreeNearest **ptn, unsigned int found, unsigned int *totfoundstack, int index, float dist, float *co)
+static void add_in_range(KDTreeNearest **ptn, unsigned int found, unsigned int *totfoundstack, int index, float dist, const float *co)
 {
 	KDTreeNearest *to;
 
 	if (found >= *totfoundstack) {
 		KDTreeNearest *temp = MEM_mallocN((*totfoundstack + KD_FOUND_ALLOC_INC) * sizeof(KDTreeNode), "KDTree.treefoundstack");
-		memcpy(temp, *ptn, *totfoundstack * sizeof(KDTreeNearest));
-		if (*ptn)
+		/* no memcpy from NULL, compilers may drop the NULL check after it */
+		if (*ptn) {
+			memcpy(temp, *ptn, *totfoundstack * sizeof(KDTreeNearest));
 			MEM_freeN(*ptn);
+		}
 		*ptn = temp;
 		*totfoundstack += KD_FOUND_ALLOC_INC;
 	}
@@ -410,48 +513,31 @@ static void add_in_range(KDTreeNearest **ptn, unsigned int found, unsigned int *
 int BLI_kdtree_range_search(KDTree *tree, const float co[3], const float nor[3],
                             KDTreeNearest **r_nearest, float range)
 {
-	KDTreeNode *root, *node = NULL;
-	KDTreeNode **stack, *defaultstack[KD_STACK_INIT];
+	const KDTreeNode *nodes;
+	unsigned int *stack, defaultstack[KD_STACK_INIT];
 	KDTreeNearest *foundstack = NULL;
 	float range2 = range * range, dist2;
 	unsigned int totstack, cur = 0, found = 0, totfoundstack = 0;
 
-	if (!tree || !tree->root)
+	if (!tree || tree->root == KD_NODE_UNSET)
 		return 0;
 
+	nodes = tree->nodes;
+
 	stack = defaultstack;
 	totstack = KD_STACK_INIT;
 
-	root = tree->root;
-
-	if (co[root->d] + range < root->co[root->d]) {
-		if (root->left)
-			stack[cur++] = root->left;
-	}
-	else if (co[root->d] - range > root->co[root->d]) {
-		if (root->right)
-			stack[cur++] = root->right;
-	}
-	else {
-		dist2 = squared_distance(root->co, co, root->nor, nor);
-		if (dist2 <= range2)
-			add_in_range(&foundstack, found++, &totfoundstack, root->index, dist2, root->co);
-
-		if (root->left)
-			stack[cur++] = root->left;
-		if (root->right)
-			stack[cur++] = root->right;
-	}
+	stack[cur++] = tree->root;
 
 	while (cur--) {
-		node = stack[cur];
+		const KDTreeNode *node = &nodes[stack[cur]];
 
 		if (co[node->d] + range < node->co[node->d]) {
-			if (node->left)
+			if (node->left != KD_NODE_UNSET)
 				stack[cur++] = node->left;
 		}
 		else if (co[node->d] - range > node->co[node->d]) {
-			if (node->right)
+			if (node->right != KD_NODE_UNSET)
 				stack[cur++] = node->right;
 		}
 		else {
@@ -459,9 +545,9 @@ int BLI_kdtree_range_search(KDTree *tree, const float co[3], const float nor[3],
 			if (dist2 <= range2)
 				add_in_range(&foundstack, found++, &totfoundstack, node->index, dist2, node->co);
 
-			if (node->left)
+			if (node->left != KD_NODE_UNSET)
 				stack[cur++] = node->left;
-			if (node->right)
+			if (node->right != KD_NODE_UNSET)
 				stack[cur++] = node->right;
 		}
 
@@ -480,3 +566,61 @@ int BLI_kdtree_range_search(KDTree *tree, const float co[3], const float nor[3],
 
 	return (int)found;
 }
+
+/**
+ * Range search without allocating, the callback is called for every point
+ * in range of co, in no particular order, until it returns false.
+ * The distance is squared.
+ */
+void BLI_kdtree_range_search_cb(KDTree *tree, const float co[3], float range,
+                                bool (*search_cb)(void *user_data, int index, const float co[3], float dist_sq),
+                                void *user_data)
+{
+	const KDTreeNode *nodes;
+	unsigned int *stack, defaultstack[KD_STACK_INIT];
+	float range2 = range * range, dist2;
+	unsigned int totstack, cur = 0;
+
+	if (tree->root == KD_NODE_UNSET)
+		return;
+
+	nodes = tree->nodes;
+
+	stack = defaultstack;
+	totstack = KD_STACK_INIT;
+
+	stack[cur++] = tree->root;
+
+	while (cur--) {
+		const KDTreeNode *node = &nodes[stack[cur]];
+
+		if (co[node->d] + range < node->co[node->d]) {
+			if (node->left != KD_NODE_UNSET)
+				stack[cur++] = node->left;
+		}
+		else if (co[node->d] - range > node->co[node->d]) {
+			if (node->right != KD_NODE_UNSET)
+				stack[cur++] = node->right;
+		}
+		else {
+			dist2 = len_squared_v3v3(node->co, co);
+			if (dist2 <= range2) {
+				if (search_cb(user_data, node->index, node->co, dist2) == false) {
+					break;
+				}
+			}
+
+			if (node->left != KD_NODE_UNSET)
+				stack[cur++] = node->left;
+			if (node->right != KD_NODE_UNSET)
+				stack[cur++] = node->right;
+		}
+
+		if (UNLIKELY(cur + 3 > totstack)) {
+			stack = realloc_nodes(stack, &totstack, defaultstack != stack);
+		}
+	}
+
+	if (stack != defaultstack)
+		MEM_freeN(stack);
+}
@@ -36,6 +36,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 
 #include "BLI_mempool.h" /* own include */
 
@@ -109,8 +110,15 @@ struct BLI_mempool {
 #ifdef USE_TOTALLOC
 	unsigned int totalloc;          /* number of elements allocated in total */
 #endif
+
+	SpinLock lock;              /* guards the above when BLI_MEMPOOL_THREADSAFE is set */
+
+	const char *name;           /* chunks are allocated with this name, for memory statistics */
 };
 
+/* number of elements a thread cache takes from or gives back to the pool at once */
+#define MEMPOOL_TCACHE_BATCH 64
+
 #define MEMPOOL_ELEM_SIZE_MIN (sizeof(void *) * 2)
 
 #ifdef USE_DATA_PTR
@@ -137,14 +145,14 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
 	}
 	else {
 		mpchunk = MEM_mallocN(sizeof(BLI_mempool_chunk), "BLI_Mempool Chunk");
-		CHUNK_DATA(mpchunk) = MEM_mallocN((size_t)pool->csize, "BLI Mempool Chunk Data");
+		CHUNK_DATA(mpchunk) = MEM_mallocN((size_t)pool->csize, pool->name);
 	}
 #else
 	if (pool->flag & BLI_MEMPOOL_SYSMALLOC) {
 		mpchunk = malloc(sizeof(BLI_mempool_chunk) + (size_t)pool->csize);
 	}
 	else {
-		mpchunk = MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, "BLI_Mempool Chunk");
+		mpchunk = MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, pool->name);
 	}
 #endif
 
@@ -236,8 +244,13 @@ static void mempool_chunk_free_all(ListBase *chunks, const unsigned int flag)
 	chunks->first = chunks->last = NULL;
 }
 
-BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
-                                unsigned int pchunk, unsigned int flag)
+/**
+ * \param name: Static string used for the chunk allocations, so pool memory
+ * shows up under its owner in memory statistics. #BLI_mempool_create passes
+ * the name of the calling function.
+ */
+BLI_mempool *BLI_mempool_create_ex(unsigned int esize, unsigned int totelem,
+                                   unsigned int pchunk, unsigned int flag, const char *name)
 {
 	BLI_mempool *pool = NULL;
 	BLI_freenode *lasttail = NULL;
@@ -248,7 +261,7 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 		pool = malloc(sizeof(BLI_mempool));
 	}
 	else {
-		pool = MEM_mallocN(sizeof(BLI_mempool), "memory pool");
+		pool = MEM_mallocN(sizeof(BLI_mempool), name);
 	}
 
 	/* set the elem size */
@@ -266,6 +279,7 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 	maxchunks = mempool_maxchunks(totelem, pchunk);
 
 	pool->flag = flag;
+	pool->name = name;
 	pool->pchunk = pchunk;
 	pool->csize = esize * pchunk;
 	pool->chunks.first = pool->chunks.last = NULL;
@@ -276,6 +290,10 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 #endif
 	pool->totused = 0;
 
+	if (flag & BLI_MEMPOOL_THREADSAFE) {
+		BLI_spin_init(&pool->lock);
+	}
+
 	/* allocate the actual chunks */
 	for (i = 0; i < maxchunks; i++) {
 		BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
@@ -289,7 +307,21 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 	return pool;
 }
 
-void *BLI_mempool_alloc(BLI_mempool *pool)
+BLI_INLINE void mempool_lock(BLI_mempool *pool)
+{
+	if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+		BLI_spin_lock(&pool->lock);
+	}
+}
+
+BLI_INLINE void mempool_unlock(BLI_mempool *pool)
+{
+	if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+		BLI_spin_unlock(&pool->lock);
+	}
+}
+
+static void *mempool_alloc(BLI_mempool *pool)
 {
 	void *retval = NULL;
 
@@ -316,6 +348,17 @@ void *BLI_mempool_alloc(BLI_mempool *pool)
 	return retval;
 }
 
+void *BLI_mempool_alloc(BLI_mempool *pool)
+{
+	void *retval;
+
+	mempool_lock(pool);
+	retval = mempool_alloc(pool);
+	mempool_unlock(pool);
+
+	return retval;
+}
+
 void *BLI_mempool_calloc(BLI_mempool *pool)
 {
 	void *retval = BLI_mempool_alloc(pool);
@@ -332,6 +375,8 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 {
 	BLI_freenode *newhead = addr;
 
+	mempool_lock(pool);
+
 #ifndef NDEBUG
 	{
 		BLI_mempool_chunk *chunk;
@@ -370,8 +415,9 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 	VALGRIND_MEMPOOL_FREE(pool, addr);
 #endif
 
-	/* nothing is in use; free all the chunks except the first */
-	if (UNLIKELY(pool->totused == 0)) {
+	/* nothing is in use; free all the chunks except the first,
+	 * thread caches may still hold elements of a thread safe pool */
+	if (UNLIKELY(pool->totused == 0) && !(pool->flag & BLI_MEMPOOL_THREADSAFE)) {
 		BLI_freenode *curnode = NULL;
 		char *tmpaddr = NULL;
 		unsigned int i;
@@ -400,6 +446,132 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 		VALGRIND_MEMPOOL_FREE(pool, CHUNK_DATA(first));
 #endif
 	}
+
+	mempool_unlock(pool);
+}
+
+/**
+ * Initialize a cache for allocating from a #BLI_MEMPOOL_THREADSAFE pool in one thread.
+ *
+ * The cache takes free elements from the pool and gives them back in batches,
+ * so threads allocating and freeing many elements rarely contend for the pool.
+ * Elements held by caches count as used until #BLI_mempool_tcache_end.
+ */
+void BLI_mempool_tcache_init(BLI_mempool *pool, BLI_mempool_tcache *tcache)
+{
+	BLI_assert(pool->flag & BLI_MEMPOOL_THREADSAFE);
+
+	tcache->pool = pool;
+	tcache->free = NULL;
+	tcache->totfree = 0;
+}
+
+void *BLI_mempool_tcache_alloc(BLI_mempool_tcache *tcache)
+{
+	BLI_mempool *pool = tcache->pool;
+	BLI_freenode *retval;
+
+	if (UNLIKELY(tcache->free == NULL)) {
+		/* take a batch of elements, counted as used by the pool */
+		unsigned int i;
+
+		BLI_spin_lock(&pool->lock);
+		for (i = 0; i < MEMPOOL_TCACHE_BATCH; i++) {
+			BLI_freenode *node = mempool_alloc(pool);
+			if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+				node->freeword = FREEWORD;
+			}
+			node->next = tcache->free;
+			tcache->free = node;
+		}
+		BLI_spin_unlock(&pool->lock);
+
+		tcache->totfree += MEMPOOL_TCACHE_BATCH;
+	}
+
+	retval = tcache->free;
+	tcache->free = retval->next;
+	tcache->totfree--;
+
+	if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+		retval->freeword = 0x7FFFFFFF;
+	}
+
+	return retval;
+}
+
+void *BLI_mempool_tcache_calloc(BLI_mempool_tcache *tcache)
+{
+	void *retval = BLI_mempool_tcache_alloc(tcache);
+	memset(retval, 0, (size_t)tcache->pool->esize);
+	return retval;
+}
+
+/**
+ * Free an element of the pool into the cache, it may have been allocated by any thread.
+ */
+void BLI_mempool_tcache_free(BLI_mempool_tcache *tcache, void *addr)
+{
+	BLI_mempool *pool = tcache->pool;
+	BLI_freenode *newhead = addr;
+
+#ifndef NDEBUG
+	if (UNLIKELY(mempool_debug_memset)) {
+		memset(addr, 255, pool->esize);
+	}
+#endif
+
+	if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+#ifndef NDEBUG
+		BLI_assert(newhead->freeword != FREEWORD);
+#endif
+		newhead->freeword = FREEWORD;
+	}
+
+	newhead->next = tcache->free;
+	tcache->free = newhead;
+	tcache->totfree++;
+
+	/* give a batch back, so memory freed by one thread can be used by others */
+	if (UNLIKELY(tcache->totfree >= MEMPOOL_TCACHE_BATCH * 2)) {
+		unsigned int i;
+
+		BLI_spin_lock(&pool->lock);
+		for (i = 0; i < MEMPOOL_TCACHE_BATCH; i++) {
+			BLI_freenode *node = tcache->free;
+			tcache->free = node->next;
+			node->next = pool->free;
+			pool->free = node;
+		}
+		pool->totused -= MEMPOOL_TCACHE_BATCH;
+		BLI_spin_unlock(&pool->lock);
+
+		tcache->totfree -= MEMPOOL_TCACHE_BATCH;
+	}
+}
+
+/**
+ * Give all elements held by the cache back to the pool.
+ */
+void BLI_mempool_tcache_end(BLI_mempool_tcache *tcache)
+{
+	BLI_mempool *pool = tcache->pool;
+	BLI_freenode *node;
+
+	if (tcache->free == NULL) {
+		return;
+	}
+
+	BLI_spin_lock(&pool->lock);
+	while ((node = tcache->free)) {
+		tcache->free = node->next;
+		node->next = pool->free;
+		pool->free = node;
+	}
+	pool->totused -= tcache->totfree;
+	BLI_spin_unlock(&pool->lock);
+
+	tcache->totfree = 0;
 }
 
 int BLI_mempool_count(BLI_mempool *pool)
@@ -620,6 +792,10 @@ void BLI_mempool_destroy(BLI_mempool *pool)
 {
 	mempool_chunk_free_all(&pool->chunks, pool->flag);
 
+	if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+		BLI_spin_end(&pool->lock);
+	}
+
 #ifdef WITH_MEM_VALGRIND
 	VALGRIND_DESTROY_MEMPOOL(pool);
 #endif
@@ -248,6 +248,15 @@ void BLI_box_pack_2d(BoxPack *boxarray, const unsigned int len, float *tot_width
 		box_width = box->w;
 		box_height = box->h;
 
+		/* Drop verts with no free quadrant left, they can't be used for any
+		 * later box either and only make the sort below slower */
+		for (i = 0, j = 0; i < verts_pack_len; i++) {
+			if (vertarray[vertex_pack_indices[i]].free) {
+				vertex_pack_indices[j++] = vertex_pack_indices[i];
+			}
+		}
+		verts_pack_len = j;
+
 		qsort(vertex_pack_indices, (size_t)verts_pack_len, sizeof(int), vertex_sort);
 
 		/* Pack the box in with the others */
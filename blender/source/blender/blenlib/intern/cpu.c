@@ -20,40 +20,135 @@
 
 /** \file blender/blenlib/intern/cpu.c
  *  \ingroup bli
+ *
+ * CPU feature detection, used to pick optimized variants of functions at
+ * startup, see #BLI_cpu_dispatch_init.
  */
 
+#include <string.h>
 
 #include "BLI_cpu.h"
 
-int BLI_cpu_support_sse2(void)
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#endif
+
+typedef struct CPUCapabilities {
+	int sse2;
+	int sse41;
+	int avx;
+	int avx2;
+} CPUCapabilities;
+
+static void cpu_cpuid(unsigned int data[4], const unsigned int leaf)
 {
-#if defined(__x86_64__) || defined(_M_X64)
-	/* x86_64 always has SSE2 instructions */
-	return 1;
-#elif defined(__GNUC__) && defined(i386)
-	/* for GCC x86 we check cpuid */
-	unsigned int d;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	__cpuidex((int *)data, (int)leaf, 0);
+#elif defined(__GNUC__) && defined(__x86_64__)
+	__asm__(
+	    "cpuid"
+		: "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3])
+		: "a" (leaf), "c" (0));
+#elif defined(__GNUC__) && defined(__i386__)
+	/* ebx may be the PIC register */
 	__asm__(
 	    "pushl %%ebx\n\t"
 	    "cpuid\n\t"
+	    "movl %%ebx, %1\n\t"
 	    "popl %%ebx\n\t"
-		: "=d" (d)
-		: "a" (1));
-	return (d & 0x04000000) != 0;
-#elif (defined(_MSC_VER) && defined(_M_IX86))
-	/* also check cpuid for MSVC x86 */
-	unsigned int d;
-	__asm {
-		xor     eax, eax
-		inc eax
-		push ebx
-		cpuid
-		pop ebx
-		mov d, edx
-	}
-	return (d & 0x04000000) != 0;
+		: "=a" (data[0]), "=S" (data[1]), "=c" (data[2]), "=d" (data[3])
+		: "a" (leaf), "c" (0));
+#else
+	(void)leaf;
+	data[0] = data[1] = data[2] = data[3] = 0;
 #endif
+}
 
+/* the OS has to save the AVX registers on context switches too */
+static int cpu_os_support_avx(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	return (_xgetbv(0) & 0x6) == 0x6;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	unsigned int eax, edx;
+	__asm__(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));  /* xgetbv */
+	(void)edx;
+	return (eax & 0x6) == 0x6;
+#else
 	return 0;
+#endif
 }
 
+static const CPUCapabilities *cpu_capabilities(void)
+{
+	/* detecting twice from different threads gives the same result */
+	static CPUCapabilities caps;
+	static int caps_init = 0;
+
+	if (!caps_init) {
+		unsigned int data[4], num;
+
+		memset(&caps, 0, sizeof(caps));
+
+		cpu_cpuid(data, 0);
+		num = data[0];
+
+		if (num >= 1) {
+			cpu_cpuid(data, 1);
+			caps.sse2 = (data[3] & (1u << 26)) != 0;
+			caps.sse41 = (data[2] & (1u << 19)) != 0;
+
+			/* AVX, with OSXSAVE so xgetbv can be used */
+			if ((data[2] & (1u << 28)) && (data[2] & (1u << 27))) {
+				caps.avx = cpu_os_support_avx();
+			}
+		}
+
+		if (num >= 7 && caps.avx) {
+			cpu_cpuid(data, 7);
+			caps.avx2 = (data[1] & (1u << 5)) != 0;
+		}
+
+#if defined(__x86_64__) || defined(_M_X64)
+		/* x86_64 always has SSE2 instructions */
+		caps.sse2 = 1;
+#endif
+
+		caps_init = 1;
+	}
+
+	return &caps;
+}
+
+int BLI_cpu_support_sse2(void)
+{
+	return cpu_capabilities()->sse2;
+}
+
+int BLI_cpu_support_sse41(void)
+{
+	return cpu_capabilities()->sse41;
+}
+
+int BLI_cpu_support_avx(void)
+{
+	return cpu_capabilities()->avx;
+}
+
+int BLI_cpu_support_avx2(void)
+{
+	return cpu_capabilities()->avx2;
+}
+
+/**
+ * Select the optimized variants of blenlib functions for this CPU, called
+ * once at startup before any threads run. Until then, or if nothing better
+ * is supported, the variants of the build's own instruction set are used.
+ *
+ * Modules with their own variants do the same from their init functions
+ * with the BLI_cpu_support queries.
+ */
+void BLI_cpu_dispatch_init(void)
+{
+	BLI_math_dispatch_init();
+}
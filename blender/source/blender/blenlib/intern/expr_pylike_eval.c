@@ -0,0 +1,892 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/expr_pylike_eval.c
+ *  \ingroup bli
+ *
+ * Compiles simple Python-like expressions into a flat list of stack machine
+ * opcodes, which can then be evaluated without any Python interpreter.
+ *
+ * Supported syntax, with Python precedence and semantics:
+ *  - floating point and integer literals, 'True', 'False', 'pi' and 'e'
+ *  - parameters, looked up by name before any of the built-in names (like Python locals)
+ *  - unary '+', '-', binary '+', '-', '*', '/', '**'
+ *  - a single comparison: '==', '!=', '<', '<=', '>', '>=' (no chaining)
+ *  - 'and', 'or', 'not', and 'a if cond else b'
+ *  - calls to the common functions from the 'math' module and the 'abs', 'int', 'min'
+ *    and 'max' built-ins
+ *
+ * Anything else fails to compile, so the caller can fall back to a real interpreter.
+ * Evaluation only deals with finite numbers, any infinite or NaN value (division by zero,
+ * math domain errors...) is reported as EXPR_PYLIKE_MATH_ERROR instead of trying to mimic
+ * the exceptions Python would raise.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_alloca.h"
+#include "BLI_math_base.h"
+#include "BLI_expr_pylike_eval.h"
+
+/* ****************************************************** */
+/* Compiled Expression */
+
+typedef double (*UnaryOpFunc)(double);
+typedef double (*BinaryOpFunc)(double, double);
+
+typedef enum eOpCode {
+	/* push constant argument onto the stack */
+	OPCODE_CONST,
+	/* push the value of the parameter with the given index onto the stack */
+	OPCODE_PARAMETER,
+	/* replace the top of the stack with the result of a unary function */
+	OPCODE_FUNC1,
+	/* replace the two top stack values with the result of a binary function */
+	OPCODE_FUNC2,
+	/* unconditional jump */
+	OPCODE_JMP,
+	/* pop the top of the stack, and jump if it is false */
+	OPCODE_JMP_ELSE,
+	/* jump keeping the top of the stack if it is true (or), or false (and), otherwise pop it */
+	OPCODE_JMP_OR,
+	OPCODE_JMP_AND
+} eOpCode;
+
+typedef struct ExprOp {
+	eOpCode opcode;
+
+	/* jump target, relative to this opcode */
+	int jmp_offset;
+
+	union {
+		int ival;
+		double dval;
+		UnaryOpFunc func1;
+		BinaryOpFunc func2;
+	} arg;
+} ExprOp;
+
+struct ExprPyLike_Parsed {
+	ExprOp *ops;
+	int ops_count;
+
+	/* stack space needed for evaluation */
+	int max_stack;
+	/* number of parameter values evaluation needs */
+	int param_count;
+};
+
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr)
+{
+	if (expr) {
+		if (expr->ops)
+			MEM_freeN(expr->ops);
+
+		MEM_freeN(expr);
+	}
+}
+
+bool BLI_expr_pylike_is_valid(const ExprPyLike_Parsed *expr)
+{
+	return expr && expr->ops_count > 0;
+}
+
+/* ****************************************************** */
+/* Evaluation */
+
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(const ExprPyLike_Parsed *expr,
+                                            const double *param_values, int param_values_len,
+                                            double *r_result)
+{
+	double *stack;
+	int sp = 0, pc = 0;
+
+	*r_result = 0.0;
+
+	if (!BLI_expr_pylike_is_valid(expr) || param_values_len < expr->param_count)
+		return EXPR_PYLIKE_INVALID;
+
+	stack = BLI_array_alloca(stack, expr->max_stack);
+
+	while (pc < expr->ops_count) {
+		const ExprOp *op = &expr->ops[pc];
+
+		switch (op->opcode) {
+			case OPCODE_CONST:
+				stack[sp++] = op->arg.dval;
+				break;
+			case OPCODE_PARAMETER:
+				stack[sp++] = param_values[op->arg.ival];
+				break;
+			case OPCODE_FUNC1:
+				stack[sp - 1] = op->arg.func1(stack[sp - 1]);
+				break;
+			case OPCODE_FUNC2:
+				stack[sp - 2] = op->arg.func2(stack[sp - 2], stack[sp - 1]);
+				sp--;
+				break;
+			case OPCODE_JMP:
+				pc += op->jmp_offset;
+				continue;
+			case OPCODE_JMP_ELSE:
+				if (stack[--sp] == 0.0) {
+					pc += op->jmp_offset;
+					continue;
+				}
+				break;
+			case OPCODE_JMP_OR:
+			case OPCODE_JMP_AND:
+				if ((stack[sp - 1] != 0.0) == (op->opcode == OPCODE_JMP_OR)) {
+					pc += op->jmp_offset;
+					continue;
+				}
+				sp--;
+				break;
+			default:
+				BLI_assert(0);
+				return EXPR_PYLIKE_INVALID;
+		}
+
+		/* every value pushed or computed is checked, so jumps only ever see finite values */
+		if (ELEM3(op->opcode, OPCODE_PARAMETER, OPCODE_FUNC1, OPCODE_FUNC2) && !finite(stack[sp - 1]))
+			return EXPR_PYLIKE_MATH_ERROR;
+
+		pc++;
+	}
+
+	BLI_assert(sp == 1);
+
+	*r_result = stack[0];
+	return EXPR_PYLIKE_SUCCESS;
+}
+
+/* ****************************************************** */
+/* Operators and Functions */
+
+static double op_negate(double arg)
+{
+	return -arg;
+}
+
+static double op_not(double arg)
+{
+	return (arg == 0.0) ? 1.0 : 0.0;
+}
+
+static double op_add(double a, double b)
+{
+	return a + b;
+}
+
+static double op_sub(double a, double b)
+{
+	return a - b;
+}
+
+static double op_mul(double a, double b)
+{
+	return a * b;
+}
+
+static double op_div(double a, double b)
+{
+	return a / b;
+}
+
+static double op_eq(double a, double b)
+{
+	return (a == b) ? 1.0 : 0.0;
+}
+
+static double op_ne(double a, double b)
+{
+	return (a != b) ? 1.0 : 0.0;
+}
+
+static double op_lt(double a, double b)
+{
+	return (a < b) ? 1.0 : 0.0;
+}
+
+static double op_le(double a, double b)
+{
+	return (a <= b) ? 1.0 : 0.0;
+}
+
+static double op_gt(double a, double b)
+{
+	return (a > b) ? 1.0 : 0.0;
+}
+
+static double op_ge(double a, double b)
+{
+	return (a >= b) ? 1.0 : 0.0;
+}
+
+static double op_trunc(double arg)
+{
+	return (arg < 0.0) ? ceil(arg) : floor(arg);
+}
+
+static double op_radians(double arg)
+{
+	return arg * (M_PI / 180.0);
+}
+
+static double op_degrees(double arg)
+{
+	return arg * (180.0 / M_PI);
+}
+
+static double op_log_base(double a, double b)
+{
+	return log(a) / log(b);
+}
+
+static double op_min(double a, double b)
+{
+	return (b < a) ? b : a;
+}
+
+static double op_max(double a, double b)
+{
+	return (b > a) ? b : a;
+}
+
+typedef struct BuiltinFuncDef {
+	const char *name;
+	/* number of arguments, -1 for any number above one (folded with 'func2') */
+	int args;
+	UnaryOpFunc func1;
+	BinaryOpFunc func2;
+} BuiltinFuncDef;
+
+/* entries sharing a name must be next to each other */
+static const BuiltinFuncDef builtin_funcs[] = {
+	{"abs", 1, fabs, NULL},
+	{"fabs", 1, fabs, NULL},
+	{"floor", 1, floor, NULL},
+	{"ceil", 1, ceil, NULL},
+	{"trunc", 1, op_trunc, NULL},
+	{"int", 1, op_trunc, NULL},
+	{"sqrt", 1, sqrt, NULL},
+	{"exp", 1, exp, NULL},
+	{"log", 1, log, NULL},
+	{"log", 2, NULL, op_log_base},
+	{"log10", 1, log10, NULL},
+	{"pow", 2, NULL, pow},
+	{"fmod", 2, NULL, fmod},
+	{"sin", 1, sin, NULL},
+	{"cos", 1, cos, NULL},
+	{"tan", 1, tan, NULL},
+	{"asin", 1, asin, NULL},
+	{"acos", 1, acos, NULL},
+	{"atan", 1, atan, NULL},
+	{"atan2", 2, NULL, atan2},
+	{"sinh", 1, sinh, NULL},
+	{"cosh", 1, cosh, NULL},
+	{"tanh", 1, tanh, NULL},
+	{"radians", 1, op_radians, NULL},
+	{"degrees", 1, op_degrees, NULL},
+	{"min", -1, NULL, op_min},
+	{"max", -1, NULL, op_max},
+	{NULL, 0, NULL, NULL}
+};
+
+typedef struct BuiltinConstDef {
+	const char *name;
+	double value;
+} BuiltinConstDef;
+
+static const BuiltinConstDef builtin_consts[] = {
+	{"pi", M_PI},
+	{"e", M_E},
+	{"True", 1.0},
+	{"False", 0.0},
+	{NULL, 0.0}
+};
+
+/* ****************************************************** */
+/* Tokenizer */
+
+enum {
+	TOKEN_END = 0,
+	/* single character tokens use their own character code */
+	TOKEN_NUMBER = 256,
+	TOKEN_ID,
+	TOKEN_EQ,
+	TOKEN_NE,
+	TOKEN_LE,
+	TOKEN_GE,
+	TOKEN_POW,
+	TOKEN_OR,
+	TOKEN_AND,
+	TOKEN_NOT,
+	TOKEN_IF,
+	TOKEN_ELSE
+};
+
+typedef struct KeywordTokenDef {
+	const char *name;
+	short token;
+} KeywordTokenDef;
+
+static const KeywordTokenDef keyword_list[] = {
+	{"and", TOKEN_AND},
+	{"or", TOKEN_OR},
+	{"not", TOKEN_NOT},
+	{"if", TOKEN_IF},
+	{"else", TOKEN_ELSE},
+	{NULL, TOKEN_END}
+};
+
+typedef struct ExprParseState {
+	const char **param_names;
+	int param_names_len;
+
+	/* tokenizer state */
+	const char *cur;
+	short token;
+	char *tokenbuf;
+	double tokenval;
+
+	/* opcode buffer */
+	ExprOp *ops;
+	int ops_count, max_ops;
+
+	/* stack depth while parsing, and the most it reached */
+	int stack_ptr, max_stack;
+} ExprParseState;
+
+#define IS_ID_START(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_')
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define IS_ID_CHAR(c) (IS_ID_START(c) || IS_DIGIT(c))
+
+/* Parse a number literal, done by hand so the result doesn't depend on the C locale */
+static bool parse_number(ExprParseState *state)
+{
+	const char *p = state->cur;
+	double mantissa = 0.0, scale;
+	int exponent = 0, digits = 0;
+
+	for (; IS_DIGIT(*p); p++, digits++)
+		mantissa = mantissa * 10.0 + (double)(*p - '0');
+
+	if (*p == '.') {
+		for (p++; IS_DIGIT(*p); p++, digits++, exponent--)
+			mantissa = mantissa * 10.0 + (double)(*p - '0');
+	}
+
+	if (digits == 0)
+		return false;
+
+	if (*p == 'e' || *p == 'E') {
+		int sign = 1, value = 0;
+
+		p++;
+		if (*p == '+' || *p == '-')
+			sign = (*p++ == '-') ? -1 : 1;
+
+		if (!IS_DIGIT(*p))
+			return false;
+
+		for (; IS_DIGIT(*p); p++) {
+			if (value < 10000)
+				value = value * 10 + (*p - '0');
+		}
+
+		exponent += sign * value;
+	}
+
+	/* things like '1x', '1.2.3' or '0x10' */
+	if (IS_ID_CHAR(*p) || *p == '.')
+		return false;
+
+	/* dividing keeps 'exact / power of ten' literals (0.1, 2.54...) correctly rounded */
+	scale = pow(10.0, (double)ABS(exponent));
+	state->tokenval = (exponent < 0) ? mantissa / scale : mantissa * scale;
+
+	if (!finite(state->tokenval))
+		return false;
+
+	state->token = TOKEN_NUMBER;
+	state->cur = p;
+	return true;
+}
+
+/* Read the next token, returns false for invalid input */
+static bool parse_next_token(ExprParseState *state)
+{
+	const char *p = state->cur;
+
+	while (*p == ' ' || *p == '\t')
+		p++;
+
+	state->cur = p;
+
+	if (*p == '\0') {
+		state->token = TOKEN_END;
+		return true;
+	}
+
+	if (IS_DIGIT(*p) || (*p == '.' && IS_DIGIT(p[1])))
+		return parse_number(state);
+
+	if (IS_ID_START(*p)) {
+		char *dst = state->tokenbuf;
+		int i;
+
+		while (IS_ID_CHAR(*p))
+			*dst++ = *p++;
+		*dst = '\0';
+
+		state->cur = p;
+		state->token = TOKEN_ID;
+
+		for (i = 0; keyword_list[i].name; i++) {
+			if (STREQ(state->tokenbuf, keyword_list[i].name)) {
+				state->token = keyword_list[i].token;
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	switch (*p) {
+		case '+': case '-': case '/': case '(': case ')': case ',':
+			/* '//' is integer division */
+			if (p[0] == '/' && p[1] == '/')
+				return false;
+
+			state->token = *p;
+			state->cur = p + 1;
+			return true;
+		case '*':
+			state->token = (p[1] == '*') ? TOKEN_POW : '*';
+			state->cur = p + ((p[1] == '*') ? 2 : 1);
+			return true;
+		case '=': case '!':
+			if (p[1] != '=')
+				return false;
+
+			state->token = (p[0] == '=') ? TOKEN_EQ : TOKEN_NE;
+			state->cur = p + 2;
+			return true;
+		case '<': case '>':
+			/* bit shifts */
+			if (p[1] == p[0])
+				return false;
+
+			if (p[1] == '=') {
+				state->token = (p[0] == '<') ? TOKEN_LE : TOKEN_GE;
+				state->cur = p + 2;
+			}
+			else {
+				state->token = *p;
+				state->cur = p + 1;
+			}
+			return true;
+	}
+
+	return false;
+}
+
+/* ****************************************************** */
+/* Recursive Descent Parser */
+
+static bool parse_expr(ExprParseState *state);
+
+/* Make room for 'count' more opcodes */
+static void parse_ensure_ops(ExprParseState *state, int count)
+{
+	if (state->ops_count + count > state->max_ops) {
+		while (state->ops_count + count > state->max_ops)
+			state->max_ops *= 2;
+
+		state->ops = MEM_reallocN(state->ops, state->max_ops * sizeof(ExprOp));
+	}
+}
+
+/* Append an opcode, 'stack_delta' is the change in stack depth it causes.
+ * Returns the index of the new opcode, since the buffer may be reallocated. */
+static int parse_add_op(ExprParseState *state, eOpCode code, int stack_delta)
+{
+	ExprOp *op;
+
+	parse_ensure_ops(state, 1);
+
+	state->stack_ptr += stack_delta;
+	state->max_stack = max_ii(state->max_stack, state->stack_ptr);
+
+	op = &state->ops[state->ops_count];
+	memset(op, 0, sizeof(*op));
+	op->opcode = code;
+
+	return state->ops_count++;
+}
+
+/* Point the jump at 'index' to the end of the opcodes emitted so far */
+static void parse_set_jump(ExprParseState *state, int index)
+{
+	state->ops[index].jmp_offset = state->ops_count - index;
+}
+
+static void parse_add_func(ExprParseState *state, int args, UnaryOpFunc func1, BinaryOpFunc func2)
+{
+	int index;
+
+	/* the buffer may be reallocated, so only index it after adding the opcode */
+	if (args == 1) {
+		index = parse_add_op(state, OPCODE_FUNC1, 0);
+		state->ops[index].arg.func1 = func1;
+	}
+	else {
+		index = parse_add_op(state, OPCODE_FUNC2, -1);
+		state->ops[index].arg.func2 = func2;
+	}
+}
+
+static bool parse_call(ExprParseState *state, int func_index)
+{
+	const char *name = builtin_funcs[func_index].name;
+	int i, args = 0;
+
+	if (!parse_next_token(state) || state->token != '(' || !parse_next_token(state))
+		return false;
+
+	if (state->token != ')') {
+		for (;;) {
+			if (!parse_expr(state))
+				return false;
+
+			args++;
+
+			if (state->token != ',')
+				break;
+
+			if (!parse_next_token(state))
+				return false;
+		}
+	}
+
+	if (state->token != ')' || !parse_next_token(state))
+		return false;
+
+	for (i = func_index; builtin_funcs[i].name && STREQ(builtin_funcs[i].name, name); i++) {
+		const BuiltinFuncDef *def = &builtin_funcs[i];
+
+		if (def->args == args) {
+			parse_add_func(state, args, def->func1, def->func2);
+			return true;
+		}
+		else if (def->args == -1 && args > 1) {
+			for (; args > 1; args--)
+				parse_add_func(state, 2, NULL, def->func2);
+			return true;
+		}
+	}
+
+	/* wrong number of arguments */
+	return false;
+}
+
+static bool parse_atom(ExprParseState *state)
+{
+	int i;
+
+	if (state->token == TOKEN_NUMBER) {
+		int index = parse_add_op(state, OPCODE_CONST, 1);
+		state->ops[index].arg.dval = state->tokenval;
+		return parse_next_token(state);
+	}
+	else if (state->token == '(') {
+		return (parse_next_token(state) &&
+		        parse_expr(state) &&
+		        state->token == ')' &&
+		        parse_next_token(state));
+	}
+	else if (state->token != TOKEN_ID) {
+		return false;
+	}
+
+	/* parameters shadow the built-in names */
+	for (i = 0; i < state->param_names_len; i++) {
+		if (state->param_names[i] && STREQ(state->tokenbuf, state->param_names[i])) {
+			int index = parse_add_op(state, OPCODE_PARAMETER, 1);
+			state->ops[index].arg.ival = i;
+			return parse_next_token(state);
+		}
+	}
+
+	for (i = 0; builtin_consts[i].name; i++) {
+		if (STREQ(state->tokenbuf, builtin_consts[i].name)) {
+			int index = parse_add_op(state, OPCODE_CONST, 1);
+			state->ops[index].arg.dval = builtin_consts[i].value;
+			return parse_next_token(state);
+		}
+	}
+
+	for (i = 0; builtin_funcs[i].name; i++) {
+		if (STREQ(state->tokenbuf, builtin_funcs[i].name))
+			return parse_call(state, i);
+	}
+
+	/* unknown name */
+	return false;
+}
+
+/* power: atom ['**' unary], binds tighter than a unary minus on its left */
+static bool parse_unary(ExprParseState *state);
+
+static bool parse_power(ExprParseState *state)
+{
+	if (!parse_atom(state))
+		return false;
+
+	if (state->token == TOKEN_POW) {
+		if (!parse_next_token(state) || !parse_unary(state))
+			return false;
+
+		parse_add_func(state, 2, NULL, pow);
+	}
+
+	return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+	if (state->token == '-') {
+		if (!parse_next_token(state) || !parse_unary(state))
+			return false;
+
+		parse_add_func(state, 1, op_negate, NULL);
+		return true;
+	}
+	else if (state->token == '+') {
+		return parse_next_token(state) && parse_unary(state);
+	}
+
+	return parse_power(state);
+}
+
+static bool parse_term(ExprParseState *state)
+{
+	if (!parse_unary(state))
+		return false;
+
+	while (ELEM(state->token, '*', '/')) {
+		BinaryOpFunc func = (state->token == '*') ? op_mul : op_div;
+
+		if (!parse_next_token(state) || !parse_unary(state))
+			return false;
+
+		parse_add_func(state, 2, NULL, func);
+	}
+
+	return true;
+}
+
+static bool parse_arith(ExprParseState *state)
+{
+	if (!parse_term(state))
+		return false;
+
+	while (ELEM(state->token, '+', '-')) {
+		BinaryOpFunc func = (state->token == '+') ? op_add : op_sub;
+
+		if (!parse_next_token(state) || !parse_term(state))
+			return false;
+
+		parse_add_func(state, 2, NULL, func);
+	}
+
+	return true;
+}
+
+static BinaryOpFunc parse_compare_func(short token)
+{
+	switch (token) {
+		case TOKEN_EQ: return op_eq;
+		case TOKEN_NE: return op_ne;
+		case '<': return op_lt;
+		case TOKEN_LE: return op_le;
+		case '>': return op_gt;
+		case TOKEN_GE: return op_ge;
+	}
+
+	return NULL;
+}
+
+static bool parse_compare(ExprParseState *state)
+{
+	BinaryOpFunc func;
+
+	if (!parse_arith(state))
+		return false;
+
+	if ((func = parse_compare_func(state->token))) {
+		if (!parse_next_token(state) || !parse_arith(state))
+			return false;
+
+		parse_add_func(state, 2, NULL, func);
+
+		/* chained comparisons aren't supported */
+		if (parse_compare_func(state->token))
+			return false;
+	}
+
+	return true;
+}
+
+static bool parse_not(ExprParseState *state)
+{
+	if (state->token == TOKEN_NOT) {
+		if (!parse_next_token(state) || !parse_not(state))
+			return false;
+
+		parse_add_func(state, 1, op_not, NULL);
+		return true;
+	}
+
+	return parse_compare(state);
+}
+
+static bool parse_and(ExprParseState *state)
+{
+	if (!parse_not(state))
+		return false;
+
+	if (state->token == TOKEN_AND) {
+		int jmp = parse_add_op(state, OPCODE_JMP_AND, -1);
+
+		if (!parse_next_token(state) || !parse_and(state))
+			return false;
+
+		parse_set_jump(state, jmp);
+	}
+
+	return true;
+}
+
+static bool parse_or(ExprParseState *state)
+{
+	if (!parse_and(state))
+		return false;
+
+	if (state->token == TOKEN_OR) {
+		int jmp = parse_add_op(state, OPCODE_JMP_OR, -1);
+
+		if (!parse_next_token(state) || !parse_or(state))
+			return false;
+
+		parse_set_jump(state, jmp);
+	}
+
+	return true;
+}
+
+/* expr: or ['if' or 'else' expr] */
+static bool parse_expr(ExprParseState *state)
+{
+	int start = state->ops_count;
+	int body_count, jmp_else, jmp_end;
+	ExprOp *body;
+	bool ok;
+
+	if (!parse_or(state))
+		return false;
+
+	if (state->token != TOKEN_IF)
+		return true;
+
+	/* Python evaluates the condition before the body, so stash the body opcodes
+	 * and add them back after the condition (jumps are relative, so they still work) */
+	body_count = state->ops_count - start;
+	body = MEM_mallocN(body_count * sizeof(ExprOp), __func__);
+	memcpy(body, state->ops + start, body_count * sizeof(ExprOp));
+
+	state->ops_count = start;
+	state->stack_ptr--;
+
+	ok = parse_next_token(state) && parse_or(state);
+
+	if (ok) {
+		jmp_else = parse_add_op(state, OPCODE_JMP_ELSE, -1);
+
+		parse_ensure_ops(state, body_count);
+		memcpy(state->ops + state->ops_count, body, body_count * sizeof(ExprOp));
+		state->ops_count += body_count;
+		state->stack_ptr++;
+
+		jmp_end = parse_add_op(state, OPCODE_JMP, 0);
+		parse_set_jump(state, jmp_else);
+
+		ok = (state->token == TOKEN_ELSE) && parse_next_token(state) && parse_expr(state);
+
+		if (ok) {
+			parse_set_jump(state, jmp_end);
+
+			/* only one of the branches leaves its value on the stack */
+			state->stack_ptr--;
+		}
+	}
+
+	MEM_freeN(body);
+	return ok;
+}
+
+/* ****************************************************** */
+/* Main Parsing Function */
+
+ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression, const char **param_names, int param_names_len)
+{
+	ExprParseState state = {NULL};
+	ExprPyLike_Parsed *expr = MEM_callocN(sizeof(ExprPyLike_Parsed), "ExprPyLike_Parsed");
+
+	state.param_names = param_names;
+	state.param_names_len = param_names_len;
+
+	state.cur = expression;
+	state.tokenbuf = MEM_mallocN(strlen(expression) + 1, __func__);
+
+	state.max_ops = 16;
+	state.ops = MEM_mallocN(state.max_ops * sizeof(ExprOp), __func__);
+
+	if (parse_next_token(&state) && parse_expr(&state) && state.token == TOKEN_END) {
+		BLI_assert(state.stack_ptr == 1);
+
+		expr->ops = MEM_reallocN(state.ops, state.ops_count * sizeof(ExprOp));
+		expr->ops_count = state.ops_count;
+		expr->max_stack = state.max_stack;
+		expr->param_count = param_names_len;
+	}
+	else {
+		MEM_freeN(state.ops);
+	}
+
+	MEM_freeN(state.tokenbuf);
+
+	return expr;
+}
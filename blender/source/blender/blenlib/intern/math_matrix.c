@@ -31,6 +31,17 @@
 #include <assert.h>
 #include "BLI_math.h"
 
+#include "BLI_cpu.h"
+
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
+#ifdef WITH_BLI_AVX
+/* math_matrix_avx.c, only built with AVX enabled */
+void mul_m4_v3_array_avx(float mat[4][4], float (*vecs)[3], const int totvec);
+#endif
+
 /********************************* Init **************************************/
 
 void zero_m3(float m[3][3])
@@ -367,6 +378,54 @@ void mul_m4_v3(float mat[4][4], float vec[3])
 	vec[2] = x * mat[0][2] + y * mat[1][2] + mat[2][2] * vec[2] + mat[3][2];
 }
 
+/* mul_m4_v3() on an array of vectors, the SSE and AVX versions do the same
+ * operations in the same order so results are identical */
+static void mul_m4_v3_array_default(float mat[4][4], float (*vecs)[3], const int totvec)
+{
+	int i;
+
+#ifdef __SSE__
+	const __m128 m0 = _mm_loadu_ps(mat[0]);
+	const __m128 m1 = _mm_loadu_ps(mat[1]);
+	const __m128 m2 = _mm_loadu_ps(mat[2]);
+	const __m128 m3 = _mm_loadu_ps(mat[3]);
+
+	for (i = 0; i < totvec; i++) {
+		__m128 r = _mm_mul_ps(m0, _mm_set1_ps(vecs[i][0]));
+		r = _mm_add_ps(r, _mm_mul_ps(m1, _mm_set1_ps(vecs[i][1])));
+		r = _mm_add_ps(r, _mm_mul_ps(m2, _mm_set1_ps(vecs[i][2])));
+		r = _mm_add_ps(r, m3);
+
+		/* only write 3 floats, the next vector follows directly */
+		_mm_storel_pi((__m64 *)vecs[i], r);
+		_mm_store_ss(&vecs[i][2], _mm_movehl_ps(r, r));
+	}
+#else
+	for (i = 0; i < totvec; i++) {
+		mul_m4_v3(mat, vecs[i]);
+	}
+#endif
+}
+
+/* selected by BLI_math_dispatch_init() */
+static void (*mul_m4_v3_array_fn)(float mat[4][4], float (*vecs)[3], const int totvec) = mul_m4_v3_array_default;
+
+void mul_m4_v3_array(float mat[4][4], float (*vecs)[3], const int totvec)
+{
+	mul_m4_v3_array_fn(mat, vecs, totvec);
+}
+
+void BLI_math_dispatch_init(void)
+{
+	mul_m4_v3_array_fn = mul_m4_v3_array_default;
+
+#ifdef WITH_BLI_AVX
+	if (BLI_cpu_support_avx()) {
+		mul_m4_v3_array_fn = mul_m4_v3_array_avx;
+	}
+#endif
+}
+
 void mul_v3_m4v3(float r[3], float mat[4][4], const float vec[3])
 {
 	float x, y;
@@ -0,0 +1,72 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/math_matrix_avx.c
+ *  \ingroup bli
+ *
+ * AVX variants of math_matrix.c functions, this file is compiled with AVX
+ * enabled and only called after checking the CPU supports it.
+ */
+
+#include "BLI_math.h"
+
+#ifdef WITH_BLI_AVX  /* set when building this file with AVX */
+#  include <immintrin.h>
+
+/* two vectors per iteration, one in each 128 bit lane */
+void mul_m4_v3_array_avx(float mat[4][4], float (*vecs)[3], const int totvec)
+{
+	const __m256 m0 = _mm256_broadcast_ps((const __m128 *)mat[0]);
+	const __m256 m1 = _mm256_broadcast_ps((const __m128 *)mat[1]);
+	const __m256 m2 = _mm256_broadcast_ps((const __m128 *)mat[2]);
+	const __m256 m3 = _mm256_broadcast_ps((const __m128 *)mat[3]);
+	int i;
+
+	for (i = 0; i + 1 < totvec; i += 2) {
+		const __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(vecs[i][0])), _mm_set1_ps(vecs[i + 1][0]), 1);
+		const __m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(vecs[i][1])), _mm_set1_ps(vecs[i + 1][1]), 1);
+		const __m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(vecs[i][2])), _mm_set1_ps(vecs[i + 1][2]), 1);
+		__m256 r;
+		__m128 r_lo, r_hi;
+
+		/* no FMA, to get the same results as mul_m4_v3() */
+		r = _mm256_mul_ps(m0, x);
+		r = _mm256_add_ps(r, _mm256_mul_ps(m1, y));
+		r = _mm256_add_ps(r, _mm256_mul_ps(m2, z));
+		r = _mm256_add_ps(r, m3);
+
+		r_lo = _mm256_castps256_ps128(r);
+		r_hi = _mm256_extractf128_ps(r, 1);
+
+		/* only write 3 floats each, the vectors are packed */
+		_mm_storel_pi((__m64 *)vecs[i], r_lo);
+		_mm_store_ss(&vecs[i][2], _mm_movehl_ps(r_lo, r_lo));
+		_mm_storel_pi((__m64 *)vecs[i + 1], r_hi);
+		_mm_store_ss(&vecs[i + 1][2], _mm_movehl_ps(r_hi, r_hi));
+	}
+
+	if (i < totvec) {
+		mul_m4_v3(mat, vecs[i]);
+	}
+
+	_mm256_zeroupper();
+}
+
+#endif  /* WITH_BLI_AVX */
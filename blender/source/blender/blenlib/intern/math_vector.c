@@ -31,6 +31,10 @@
 
 #include "BLI_math.h"
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 //******************************* Interpolation *******************************/
 
 void interp_v2_v2v2(float target[2], const float a[2], const float b[2], const float t)
@@ -563,6 +567,36 @@ void minmax_v3v3_v3(float min[3], float max[3], const float vec[3])
 	if (max[2] < vec[2]) max[2] = vec[2];
 }
 
+/* minmax_v3v3_v3() for an array of vectors, min and max need to be initialized */
+void minmax_v3_array(float min[3], float max[3], const float (*vecs)[3], const int totvec)
+{
+	int i = 0;
+
+#ifdef __SSE__
+	if (totvec > 1) {
+		float min_sse[4], max_sse[4];
+		__m128 vmin = _mm_set_ps(0.0f, min[2], min[1], min[0]);
+		__m128 vmax = _mm_set_ps(0.0f, max[2], max[1], max[0]);
+
+		/* loading 4 floats reads past the last vector, that one is done below */
+		for (; i < totvec - 1; i++) {
+			const __m128 v = _mm_loadu_ps(vecs[i]);
+			vmin = _mm_min_ps(vmin, v);
+			vmax = _mm_max_ps(vmax, v);
+		}
+
+		_mm_storeu_ps(min_sse, vmin);
+		_mm_storeu_ps(max_sse, vmax);
+		copy_v3_v3(min, min_sse);
+		copy_v3_v3(max, max_sse);
+	}
+#endif
+
+	for (; i < totvec; i++) {
+		minmax_v3v3_v3(min, max, vecs[i]);
+	}
+}
+
 void minmax_v2v2_v2(float min[2], float max[2], const float vec[2])
 {
 	if (min[0] > vec[0]) min[0] = vec[0];
@@ -0,0 +1,382 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/polyfill2d.c
+ *  \ingroup bli
+ *
+ * Ear clipping tessellation of a single polygon without holes,
+ * for mesh faces where scanfill is much more than we need.
+ *
+ * - Convex polygons are filled as a fan without building any lists.
+ * - Otherwise ears are clipped, only concave vertices need to be checked
+ *   when testing an ear, so near-convex polygons stay close to linear time.
+ * - Degenerate and self intersecting polygons still give (coords_tot - 2)
+ *   triangles, so callers can allocate the output in advance.
+ *
+ * Temporary memory comes from the arena passed in (or the stack), so batch
+ * tessellation can reuse a single arena per thread without allocating.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_alloca.h"
+#include "BLI_math.h"
+#include "BLI_memarena.h"
+
+#include "BLI_polyfill2d.h"  /* own include */
+
+#include "BLI_strict_flags.h"
+
+typedef signed char eSign;
+enum {
+	CONCAVE = -1,
+	TANGENTIAL = 0,
+	CONVEX = 1,
+};
+
+typedef struct PolyIndex {
+	struct PolyIndex *next, *prev;
+	unsigned int index;
+	eSign sign;
+} PolyIndex;
+
+typedef struct PolyFill {
+	PolyIndex *indices;  /* vertex aligned */
+
+	const float (*coords)[2];
+	unsigned int coords_tot;
+	int coords_sign;
+
+	/* remaining vertices, and how many of those aren't convex */
+	unsigned int index_tot;
+	unsigned int concave_tot;
+
+	/* result */
+	unsigned int (*tris)[3];
+	unsigned int tris_tot;
+} PolyFill;
+
+
+BLI_INLINE eSign span_tri_v2_sign(const float v1[2], const float v2[2], const float v3[2], const int coords_sign)
+{
+	const float d = ((v2[0] - v1[0]) * (v3[1] - v1[1]) - (v2[1] - v1[1]) * (v3[0] - v1[0])) * (float)coords_sign;
+	return (d > 0.0f) ? CONVEX : ((d < 0.0f) ? CONCAVE : TANGENTIAL);
+}
+
+static int polyfill_sign_calc(const float (*coords)[2], const unsigned int coords_tot)
+{
+	const float *co_prev = coords[coords_tot - 1];
+	float area = 0.0f;
+	unsigned int i;
+
+	for (i = 0; i < coords_tot; i++) {
+		area += (co_prev[0] * coords[i][1]) - (coords[i][0] * co_prev[1]);
+		co_prev = coords[i];
+	}
+
+	return (area >= 0.0f) ? 1 : -1;
+}
+
+/* fan fill when all vertices are convex, false otherwise */
+static bool polyfill_convex_fill(const float (*coords)[2], const unsigned int coords_tot, const int coords_sign,
+                                 unsigned int (*r_tris)[3])
+{
+	const float *co_prev = coords[coords_tot - 2];
+	const float *co_curr = coords[coords_tot - 1];
+	unsigned int i;
+
+	for (i = 0; i < coords_tot; i++) {
+		if (span_tri_v2_sign(co_prev, co_curr, coords[i], coords_sign) != CONVEX) {
+			return false;
+		}
+		co_prev = co_curr;
+		co_curr = coords[i];
+	}
+
+	for (i = 0; i < coords_tot - 2; i++) {
+		r_tris[i][0] = 0;
+		r_tris[i][1] = i + 1;
+		r_tris[i][2] = i + 2;
+	}
+
+	return true;
+}
+
+static void pf_coord_sign_calc(PolyFill *pf, PolyIndex *pi)
+{
+	pi->sign = span_tri_v2_sign(pf->coords[pi->prev->index],
+	                            pf->coords[pi->index],
+	                            pf->coords[pi->next->index],
+	                            pf->coords_sign);
+}
+
+static bool pf_ear_tip_check(PolyFill *pf, PolyIndex *pi_ear_tip)
+{
+	const float *v1, *v2, *v3;
+	PolyIndex *pi_curr;
+	unsigned int concave_tot;
+
+	if (pi_ear_tip->sign != CONVEX) {
+		return false;
+	}
+
+	/* only concave vertices can be inside the ear */
+	concave_tot = pf->concave_tot;
+	if (concave_tot == 0) {
+		return true;
+	}
+
+	v1 = pf->coords[pi_ear_tip->prev->index];
+	v2 = pf->coords[pi_ear_tip->index];
+	v3 = pf->coords[pi_ear_tip->next->index];
+
+	for (pi_curr = pi_ear_tip->next->next; pi_curr != pi_ear_tip->prev; pi_curr = pi_curr->next) {
+		if (pi_curr->sign != CONVEX) {
+			const float *v = pf->coords[pi_curr->index];
+
+			/* points on the edges count as inside too */
+			if ((span_tri_v2_sign(v1, v2, v, pf->coords_sign) != CONCAVE) &&
+			    (span_tri_v2_sign(v2, v3, v, pf->coords_sign) != CONCAVE) &&
+			    (span_tri_v2_sign(v3, v1, v, pf->coords_sign) != CONCAVE))
+			{
+				return false;
+			}
+
+			/* the remaining vertices are all convex */
+			if (--concave_tot == 0) {
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+static PolyIndex *pf_ear_tip_find(PolyFill *pf, PolyIndex *pi_ear_init)
+{
+	PolyIndex *pi_ear;
+	unsigned int i;
+
+	pi_ear = pi_ear_init;
+	i = pf->index_tot;
+	do {
+		if (pf_ear_tip_check(pf, pi_ear)) {
+			return pi_ear;
+		}
+	} while ((void)(pi_ear = pi_ear->next), --i);
+
+	/* no ear, the polygon is degenerate or self intersecting,
+	 * cut the first vertex that isn't concave so we always finish */
+	pi_ear = pi_ear_init;
+	i = pf->index_tot;
+	do {
+		if (pi_ear->sign != CONCAVE) {
+			return pi_ear;
+		}
+	} while ((void)(pi_ear = pi_ear->next), --i);
+
+	return pi_ear_init;
+}
+
+static void pf_ear_tip_cut(PolyFill *pf, PolyIndex *pi_ear_tip)
+{
+	PolyIndex *pi_prev = pi_ear_tip->prev;
+	PolyIndex *pi_next = pi_ear_tip->next;
+	unsigned int *tri = pf->tris[pf->tris_tot++];
+
+	tri[0] = pi_prev->index;
+	tri[1] = pi_ear_tip->index;
+	tri[2] = pi_next->index;
+
+	pi_prev->next = pi_next;
+	pi_next->prev = pi_prev;
+	pf->index_tot--;
+
+	if (pi_ear_tip->sign != CONVEX) {
+		pf->concave_tot--;
+	}
+
+	/* removing the tip can only change its neighbors */
+	if (pi_prev->sign != CONVEX) {
+		pf_coord_sign_calc(pf, pi_prev);
+		if (pi_prev->sign == CONVEX) {
+			pf->concave_tot--;
+		}
+	}
+	if (pi_next->sign != CONVEX) {
+		pf_coord_sign_calc(pf, pi_next);
+		if (pi_next->sign == CONVEX) {
+			pf->concave_tot--;
+		}
+	}
+}
+
+static void polyfill_calc_ears(PolyFill *pf)
+{
+	PolyIndex *indices = pf->indices;
+	PolyIndex *pi_ear;
+	unsigned int i;
+
+	for (i = 0; i < pf->coords_tot; i++) {
+		indices[i].next = &indices[(i + 1) % pf->coords_tot];
+		indices[i].prev = &indices[(i + pf->coords_tot - 1) % pf->coords_tot];
+		indices[i].index = i;
+	}
+
+	for (i = 0; i < pf->coords_tot; i++) {
+		pf_coord_sign_calc(pf, &indices[i]);
+		if (indices[i].sign != CONVEX) {
+			pf->concave_tot++;
+		}
+	}
+
+	pi_ear = indices;
+	while (pf->index_tot > 3) {
+		PolyIndex *pi_prev;
+
+		pi_ear = pf_ear_tip_find(pf, pi_ear);
+		pi_prev = pi_ear->prev;
+		pf_ear_tip_cut(pf, pi_ear);
+
+		/* the next ear is usually next to the last one */
+		pi_ear = pi_prev;
+	}
+
+	if (pf->index_tot == 3) {
+		unsigned int *tri = pf->tris[pf->tris_tot++];
+		tri[0] = pi_ear->prev->index;
+		tri[1] = pi_ear->index;
+		tri[2] = pi_ear->next->index;
+	}
+}
+
+/* handle the simple cases, false when ear clipping is needed */
+static bool polyfill_init(PolyFill *pf,
+                          const float (*coords)[2], const unsigned int coords_tot, int coords_sign,
+                          unsigned int (*r_tris)[3])
+{
+	BLI_assert(coords_tot >= 3);
+
+	if (coords_tot == 3) {
+		r_tris[0][0] = 0;
+		r_tris[0][1] = 1;
+		r_tris[0][2] = 2;
+		return true;
+	}
+
+	if (coords_sign == 0) {
+		coords_sign = polyfill_sign_calc(coords, coords_tot);
+	}
+
+	if (polyfill_convex_fill(coords, coords_tot, coords_sign, r_tris)) {
+		return true;
+	}
+
+	pf->indices = NULL;
+	pf->coords = coords;
+	pf->coords_tot = coords_tot;
+	pf->coords_sign = coords_sign;
+	pf->index_tot = coords_tot;
+	pf->concave_tot = 0;
+	pf->tris = r_tris;
+	pf->tris_tot = 0;
+
+	return false;
+}
+
+/**
+ * Triangulate a polygon, \a r_tris is filled with (coords_tot - 2) triangles,
+ * using the winding of the polygon.
+ *
+ * \param coords_sign: Pass 1 or -1 when the winding is known, 0 to calculate it.
+ * \param arena: Used for temporary memory, the caller is responsible for clearing it.
+ */
+void BLI_polyfill_calc_arena(
+        const float (*coords)[2],
+        const unsigned int coords_tot,
+        int coords_sign,
+        unsigned int (*r_tris)[3],
+        struct MemArena *arena)
+{
+	PolyFill pf;
+
+	if (polyfill_init(&pf, coords, coords_tot, coords_sign, r_tris)) {
+		return;
+	}
+
+	pf.indices = BLI_memarena_alloc(arena, (int)(sizeof(*pf.indices) * coords_tot));
+	polyfill_calc_ears(&pf);
+
+	BLI_assert(pf.tris_tot == coords_tot - 2);
+}
+
+/**
+ * Same as #BLI_polyfill_calc_arena, using the stack for temporary memory.
+ */
+void BLI_polyfill_calc(
+        const float (*coords)[2],
+        const unsigned int coords_tot,
+        int coords_sign,
+        unsigned int (*r_tris)[3])
+{
+	PolyFill pf;
+
+	if (polyfill_init(&pf, coords, coords_tot, coords_sign, r_tris)) {
+		return;
+	}
+
+	pf.indices = BLI_array_alloca(pf.indices, coords_tot);
+	polyfill_calc_ears(&pf);
+
+	BLI_assert(pf.tris_tot == coords_tot - 2);
+}
+
+/**
+ * Project a 3d polygon along its (unit length) \a normal and triangulate it.
+ */
+void BLI_polyfill_calc_v3_arena(
+        const float (*coords)[3],
+        const unsigned int coords_tot,
+        const float normal[3],
+        unsigned int (*r_tris)[3],
+        struct MemArena *arena)
+{
+	float (*projverts)[2];
+	float axis_mat[3][3];
+	unsigned int i;
+
+	if (coords_tot == 3) {
+		r_tris[0][0] = 0;
+		r_tris[0][1] = 1;
+		r_tris[0][2] = 2;
+		return;
+	}
+
+	projverts = BLI_memarena_alloc(arena, (int)(sizeof(*projverts) * coords_tot));
+
+	axis_dominant_v3_to_m3(axis_mat, normal);
+	for (i = 0; i < coords_tot; i++) {
+		mul_v2_m3v3(projverts[i], axis_mat, coords[i]);
+	}
+
+	/* non planar faces don't have a reliable winding in relation to the normal */
+	BLI_polyfill_calc_arena((const float (*)[2])projverts, coords_tot, 0, r_tris, arena);
+}
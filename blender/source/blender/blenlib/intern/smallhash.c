@@ -27,6 +27,15 @@
 
 /** \file blender/blenlib/intern/smallhash.c
  *  \ingroup bli
+ *
+ * A light stack-friendly hash table for integer and pointer keys.
+ *
+ * Open addressing with linear probing, keys and values are stored inline in
+ * the bucket array, so a lookup only touches one or two cache lines and needs
+ * no allocation per entry. Small tables use the stack memory inside the
+ * #SmallHash struct. Removing shifts the following entries of a run back
+ * (Knuth's algorithm R), so no deleted markers pile up and lookups of missing
+ * keys always end at the first free bucket.
  */
 
 #include <string.h>
@@ -37,242 +46,268 @@
 #include "BLI_smallhash.h"
 #include "BLI_strict_flags.h"
 
-/* SMHASH_CELL_UNUSED means this cell is inside a key series,
- * while SMHASH_CELL_FREE means this cell terminates a key series.
- *
- * no chance of anyone shoving INT32_MAX-2 into a *val pointer, I
- * imagine.  hopefully.
+/* SMHASH_CELL_FREE marks an empty bucket, values can't use it.
  *
- * note: these have the SMHASH suffix because we may want to make them public.
+ * note: this has the SMHASH suffix because we may want to make it public.
  */
-#define SMHASH_CELL_UNUSED  ((void *)0x7FFFFFFF)
 #define SMHASH_CELL_FREE    ((void *)0x7FFFFFFD)
 
-/* typically this re-assigns 'h' */
-#define SMHASH_NEXT(h, hoff)  ( \
-	CHECK_TYPE_INLINE(&(h),    unsigned int *), \
-	CHECK_TYPE_INLINE(&(hoff), unsigned int *), \
-	((h) + (((hoff) = ((hoff) * 2) + 1), (hoff))) \
-	)
+/* grow once more than half of the buckets are used,
+ * runs of used buckets get long quickly with linear probing after that */
+#define SMHASH_NENTRIES_MAX(nbuckets)  ((nbuckets) / 2)
 
 extern const unsigned int hashsizes[];
 
-void BLI_smallhash_init(SmallHash *hash)
+BLI_INLINE bool smallhash_val_is_used(const void *val)
 {
-	unsigned int i;
+	return (val != SMHASH_CELL_FREE);
+}
 
-	memset(hash, 0, sizeof(*hash));
+BLI_INLINE unsigned int smallhash_bucket_index(const SmallHash *sh, const uintptr_t key)
+{
+	return (unsigned int)key % sh->nbuckets;
+}
 
-	hash->table = hash->_stacktable;
-	hash->curhash = 2;
-	hash->size = hashsizes[hash->curhash];
+BLI_INLINE unsigned int smallhash_bucket_next(const SmallHash *sh, const unsigned int h)
+{
+	return (h + 1 == sh->nbuckets) ? 0 : h + 1;
+}
 
-	hash->copytable = hash->_copytable;
-	hash->stacktable = hash->_stacktable;
+static void smallhash_buckets_init(SmallHash *sh, const unsigned int cursize)
+{
+	unsigned int i;
 
-	for (i = 0; i < hash->size; i++) {
-		hash->table[i].val = SMHASH_CELL_FREE;
+	sh->cursize = cursize;
+	sh->nbuckets = hashsizes[cursize];
+
+	if (sh->nbuckets <= SMSTACKSIZE) {
+		sh->buckets = sh->buckets_stack;
+	}
+	else {
+		sh->buckets = MEM_mallocN(sizeof(*sh->buckets) * sh->nbuckets, __func__);
 	}
-}
 
-/*NOTE: does *not* free *hash itself!  only the direct data!*/
-void BLI_smallhash_release(SmallHash *hash)
-{
-	if (hash->table != hash->stacktable) {
-		MEM_freeN(hash->table);
+	for (i = 0; i < sh->nbuckets; i++) {
+		sh->buckets[i].val = SMHASH_CELL_FREE;
 	}
 }
 
-void BLI_smallhash_insert(SmallHash *hash, uintptr_t key, void *item)
+BLI_INLINE SmallHashEntry *smallhash_lookup(SmallHash *sh, const uintptr_t key)
 {
-	unsigned int h, hoff = 1;
-
-	if (hash->size < hash->used * 3) {
-		unsigned int newsize = hashsizes[++hash->curhash];
-		SmallHashEntry *tmp;
-		unsigned int i = 0;
+	unsigned int h = smallhash_bucket_index(sh, key);
+	SmallHashEntry *e;
 
-		if (hash->table != hash->stacktable || newsize > SMSTACKSIZE) {
-			tmp = MEM_callocN(sizeof(*hash->table) * newsize, __func__);
-		}
-		else {
-			SWAP(SmallHashEntry *, hash->stacktable, hash->copytable);
-			tmp = hash->stacktable;
+	while (smallhash_val_is_used((e = &sh->buckets[h])->val)) {
+		if (e->key == key) {
+			return e;
 		}
+		h = smallhash_bucket_next(sh, h);
+	}
+
+	return NULL;
+}
 
-		SWAP(SmallHashEntry *, tmp, hash->table);
+BLI_INLINE SmallHashEntry *smallhash_lookup_first_free(SmallHash *sh, const uintptr_t key)
+{
+	unsigned int h = smallhash_bucket_index(sh, key);
 
-		hash->size = newsize;
+	while (smallhash_val_is_used(sh->buckets[h].val)) {
+		h = smallhash_bucket_next(sh, h);
+	}
 
-		for (i = 0; i < hash->size; i++) {
-			hash->table[i].val = SMHASH_CELL_FREE;
-		}
+	return &sh->buckets[h];
+}
 
-		for (i = 0; i < hashsizes[hash->curhash - 1]; i++) {
-			if (ELEM(tmp[i].val, SMHASH_CELL_UNUSED, SMHASH_CELL_FREE)) {
-				continue;
-			}
+static void smallhash_resize(SmallHash *sh, const unsigned int cursize)
+{
+	SmallHashEntry *buckets_old = sh->buckets;
+	const unsigned int nbuckets_old = sh->nbuckets;
+	unsigned int i;
 
-			h = (unsigned int)(tmp[i].key);
-			hoff = 1;
-			while (!ELEM(hash->table[h % newsize].val, SMHASH_CELL_UNUSED, SMHASH_CELL_FREE)) {
-				h = SMHASH_NEXT(h, hoff);
-			}
+	/* the stack buckets are always used as a whole, growing allocates */
+	BLI_assert(hashsizes[cursize] > SMSTACKSIZE);
 
-			h %= newsize;
+	smallhash_buckets_init(sh, cursize);
 
-			hash->table[h].key = tmp[i].key;
-			hash->table[h].val = tmp[i].val;
+	for (i = 0; i < nbuckets_old; i++) {
+		if (smallhash_val_is_used(buckets_old[i].val)) {
+			*smallhash_lookup_first_free(sh, buckets_old[i].key) = buckets_old[i];
 		}
+	}
 
-		if (tmp != hash->stacktable && tmp != hash->copytable) {
-			MEM_freeN(tmp);
-		}
+	if (buckets_old != sh->buckets_stack) {
+		MEM_freeN(buckets_old);
 	}
+}
 
-	h = (unsigned int)(key);
-	hoff = 1;
+void BLI_smallhash_init_ex(SmallHash *sh, const unsigned int nentries_reserve)
+{
+	unsigned int cursize = 0;
 
-	while (!ELEM(hash->table[h % hash->size].val, SMHASH_CELL_UNUSED, SMHASH_CELL_FREE)) {
-		h = SMHASH_NEXT(h, hoff);
+	/* use all of the stack buckets, then reserve as requested */
+	while (hashsizes[cursize + 1] <= SMSTACKSIZE) {
+		cursize++;
+	}
+	while (SMHASH_NENTRIES_MAX(hashsizes[cursize]) < nentries_reserve) {
+		cursize++;
 	}
 
-	h %= hash->size;
-	hash->table[h].key = key;
-	hash->table[h].val = item;
+	sh->nentries = 0;
+	smallhash_buckets_init(sh, cursize);
+}
+
+void BLI_smallhash_init(SmallHash *sh)
+{
+	BLI_smallhash_init_ex(sh, 0);
+}
 
-	hash->used++;
+/*NOTE: does *not* free *sh itself!  only the direct data!*/
+void BLI_smallhash_release(SmallHash *sh)
+{
+	if (sh->buckets != sh->buckets_stack) {
+		MEM_freeN(sh->buckets);
+	}
 }
 
-void BLI_smallhash_remove(SmallHash *hash, uintptr_t key)
+void BLI_smallhash_insert(SmallHash *sh, uintptr_t key, void *val)
 {
-	unsigned int h, hoff = 1;
+	SmallHashEntry *e;
 
-	h = (unsigned int)(key);
+	BLI_assert(smallhash_val_is_used(val));
+	BLI_assert(BLI_smallhash_haskey(sh, key) == false);
 
-	while ((hash->table[h % hash->size].key != key) ||
-	       (hash->table[h % hash->size].val == SMHASH_CELL_UNUSED))
-	{
-		if (hash->table[h % hash->size].val == SMHASH_CELL_FREE) {
-			return;
-		}
+	if (UNLIKELY(sh->nentries + 1 > SMHASH_NENTRIES_MAX(sh->nbuckets))) {
+		smallhash_resize(sh, sh->cursize + 1);
+	}
+
+	e = smallhash_lookup_first_free(sh, key);
+	e->key = key;
+	e->val = val;
+
+	sh->nentries++;
+}
 
-		h = SMHASH_NEXT(h, hoff);
+/**
+ * Inserts a new value or replaces the value of an existing key.
+ *
+ * \return true if a new key has been added.
+ */
+bool BLI_smallhash_reinsert(SmallHash *sh, uintptr_t key, void *val)
+{
+	SmallHashEntry *e = smallhash_lookup(sh, key);
+
+	if (e) {
+		e->val = val;
+		return false;
 	}
 
-	h %= hash->size;
-	hash->table[h].key = 0;
-	hash->table[h].val = SMHASH_CELL_UNUSED;
+	BLI_smallhash_insert(sh, key, val);
+	return true;
 }
 
-void *BLI_smallhash_lookup(SmallHash *hash, uintptr_t key)
+bool BLI_smallhash_remove(SmallHash *sh, uintptr_t key)
 {
-	unsigned int h, hoff = 1;
-	void *v;
+	SmallHashEntry *e = smallhash_lookup(sh, key);
+	unsigned int h, h_next;
 
-	h = (unsigned int)(key);
+	if (e == NULL) {
+		return false;
+	}
 
-	while ((hash->table[h % hash->size].key != key) ||
-	       (hash->table[h % hash->size].val == SMHASH_CELL_UNUSED))
+	h = (unsigned int)(e - sh->buckets);
+
+	/* move later entries of the run into the gap, unless they'd end up
+	 * before their own bucket (cyclically within ]h, h_next]) */
+	for (h_next = smallhash_bucket_next(sh, h);
+	     smallhash_val_is_used(sh->buckets[h_next].val);
+	     h_next = smallhash_bucket_next(sh, h_next))
 	{
-		if (hash->table[h % hash->size].val == SMHASH_CELL_FREE) {
-			return NULL;
+		const unsigned int h_home = smallhash_bucket_index(sh, sh->buckets[h_next].key);
+
+		if ((h <= h_next) ?
+		    ((h < h_home) && (h_home <= h_next)) :
+		    ((h < h_home) || (h_home <= h_next)))
+		{
+			continue;
 		}
 
-		h = SMHASH_NEXT(h, hoff);
+		sh->buckets[h] = sh->buckets[h_next];
+		h = h_next;
 	}
 
-	v = hash->table[h % hash->size].val;
-	if (ELEM(v, SMHASH_CELL_UNUSED, SMHASH_CELL_FREE)) {
-		return NULL;
-	}
+	sh->buckets[h].val = SMHASH_CELL_FREE;
+	sh->nentries--;
 
-	return v;
+	return true;
 }
 
-
-int BLI_smallhash_haskey(SmallHash *hash, uintptr_t key)
+void *BLI_smallhash_lookup(SmallHash *sh, uintptr_t key)
 {
-	unsigned int h = (unsigned int)(key);
-	unsigned int hoff = 1;
+	SmallHashEntry *e = smallhash_lookup(sh, key);
 
-	while ((hash->table[h % hash->size].key != key) ||
-	       (hash->table[h % hash->size].val == SMHASH_CELL_UNUSED))
-	{
-		if (hash->table[h % hash->size].val == SMHASH_CELL_FREE) {
-			return 0;
-		}
+	return e ? e->val : NULL;
+}
 
-		h = SMHASH_NEXT(h, hoff);
-	}
+void **BLI_smallhash_lookup_p(SmallHash *sh, uintptr_t key)
+{
+	SmallHashEntry *e = smallhash_lookup(sh, key);
 
-	return !ELEM(hash->table[h % hash->size].val, SMHASH_CELL_UNUSED, SMHASH_CELL_FREE);
+	return e ? &e->val : NULL;
 }
 
-int BLI_smallhash_count(SmallHash *hash)
+bool BLI_smallhash_haskey(SmallHash *sh, uintptr_t key)
 {
-	return (int)hash->used;
+	return (smallhash_lookup(sh, key) != NULL);
 }
 
-void *BLI_smallhash_iternext(SmallHashIter *iter, uintptr_t *key)
+int BLI_smallhash_count(SmallHash *sh)
 {
-	while (iter->i < iter->hash->size) {
-		if ((iter->hash->table[iter->i].val != SMHASH_CELL_UNUSED) &&
-		    (iter->hash->table[iter->i].val != SMHASH_CELL_FREE))
-		{
+	return (int)sh->nentries;
+}
+
+BLI_INLINE SmallHashEntry *smallhash_iternext(SmallHashIter *iter, uintptr_t *key)
+{
+	while (iter->i < iter->sh->nbuckets) {
+		SmallHashEntry *e = &iter->sh->buckets[iter->i++];
+
+		if (smallhash_val_is_used(e->val)) {
 			if (key) {
-				*key = iter->hash->table[iter->i].key;
+				*key = e->key;
 			}
 
-			iter->i++;
-
-			return iter->hash->table[iter->i - 1].val;
+			return e;
 		}
-
-		iter->i++;
 	}
 
 	return NULL;
 }
 
-void *BLI_smallhash_iternew(SmallHash *hash, SmallHashIter *iter, uintptr_t *key)
+void *BLI_smallhash_iternext(SmallHashIter *iter, uintptr_t *key)
 {
-	iter->hash = hash;
-	iter->i = 0;
+	SmallHashEntry *e = smallhash_iternext(iter, key);
 
-	return BLI_smallhash_iternext(iter, key);
+	return e ? e->val : NULL;
 }
 
-/* note, this was called _print_smhash in knifetool.c
- * it may not be intended for general use - campbell */
-#if 0
-void BLI_smallhash_print(SmallHash *hash)
+void **BLI_smallhash_iternext_p(SmallHashIter *iter, uintptr_t *key)
 {
-	int i, linecol = 79, c = 0;
+	SmallHashEntry *e = smallhash_iternext(iter, key);
 
-	printf("{");
-	for (i = 0; i < hash->size; i++) {
-		if (hash->table[i].val == SMHASH_CELL_UNUSED) {
-			printf("--u-");
-		}
-		else if (hash->table[i].val == SMHASH_CELL_FREE) {
-			printf("--f-");
-		}
-		else {
-			printf("%2x", (unsigned int)hash->table[i].key);
-		}
+	return e ? &e->val : NULL;
+}
 
-		if (i != hash->size - 1)
-			printf(", ");
+void *BLI_smallhash_iternew(SmallHash *sh, SmallHashIter *iter, uintptr_t *key)
+{
+	iter->sh = sh;
+	iter->i = 0;
 
-		c += 6;
+	return BLI_smallhash_iternext(iter, key);
+}
 
-		if (c >= linecol) {
-			printf("\n ");
-			c = 0;
-		}
-	}
+void **BLI_smallhash_iternew_p(SmallHash *sh, SmallHashIter *iter, uintptr_t *key)
+{
+	iter->sh = sh;
+	iter->i = 0;
 
-	fflush(stdout);
+	return BLI_smallhash_iternext_p(iter, key);
 }
-#endif
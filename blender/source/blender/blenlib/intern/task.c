@@ -19,10 +19,15 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_listBase.h"
+
+#include "BLI_alloca.h"
 #include "BLI_listbase.h"
+#include "BLI_mempool.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
@@ -51,22 +56,102 @@ struct TaskPool {
 	volatile bool do_cancel;
 };
 
+/* Tasks waiting to run. High priority tasks are added at the head, low
+ * priority ones at the tail. The owner takes tasks from the head, others
+ * steal from the tail. */
+typedef struct TaskQueue {
+	ListBase tasks;
+	SpinLock lock;
+} TaskQueue;
+
+typedef struct TaskThread {
+	TaskScheduler *scheduler;
+	int id;
+	TaskQueue queue;  /* tasks pushed by this thread */
+} TaskThread;
+
 struct TaskScheduler {
 	pthread_t *threads;
 	struct TaskThread *task_threads;
 	int num_threads;
 
-	ListBase queue;
+	TaskQueue queue;           /* tasks pushed from threads outside the scheduler */
+	pthread_key_t thread_key;  /* TaskThread of the scheduler thread, if any */
+
+	/* threads without work wait on this, notified whenever tasks are pushed */
 	ThreadMutex queue_mutex;
 	ThreadCondition queue_cond;
 
 	volatile bool do_exit;
 };
 
-typedef struct TaskThread {
-	TaskScheduler *scheduler;
-	int id;
-} TaskThread;
+/* Task Queue */
+
+static void task_queue_init(TaskQueue *queue)
+{
+	queue->tasks.first = queue->tasks.last = NULL;
+	BLI_spin_init(&queue->lock);
+}
+
+static void task_queue_end(TaskQueue *queue)
+{
+	Task *task;
+
+	/* delete leftover tasks */
+	for (task = queue->tasks.first; task; task = task->next) {
+		if (task->free_taskdata)
+			MEM_freeN(task->taskdata);
+	}
+	BLI_freelistN(&queue->tasks);
+
+	BLI_spin_end(&queue->lock);
+}
+
+static void task_queue_push(TaskQueue *queue, Task *task, TaskPriority priority)
+{
+	BLI_spin_lock(&queue->lock);
+
+	if (priority == TASK_PRIORITY_HIGH)
+		BLI_addhead(&queue->tasks, task);
+	else
+		BLI_addtail(&queue->tasks, task);
+
+	BLI_spin_unlock(&queue->lock);
+}
+
+/* take a task from the head, or from the tail when stealing, only of the
+ * given pool if set */
+static Task *task_queue_pop(TaskQueue *queue, TaskPool *pool, bool steal)
+{
+	Task *task;
+
+	/* unlocked check to skip empty queues while stealing, a task pushed
+	 * meanwhile is found later since pushing also wakes up sleeping threads */
+	if (queue->tasks.first == NULL)
+		return NULL;
+
+	BLI_spin_lock(&queue->lock);
+
+	if (steal) {
+		for (task = queue->tasks.last; task; task = task->prev) {
+			if (pool == NULL || task->pool == pool)
+				break;
+		}
+	}
+	else {
+		for (task = queue->tasks.first; task; task = task->next) {
+			if (pool == NULL || task->pool == pool)
+				break;
+		}
+	}
+
+	if (task)
+		BLI_remlink(&queue->tasks, task);
+
+	BLI_spin_unlock(&queue->lock);
+
+	return task;
+}
 
 /* Task Scheduler */
 
@@ -95,49 +180,87 @@ static void task_pool_num_increase(TaskPool *pool)
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+static TaskThread *task_scheduler_thread_get(TaskScheduler *scheduler)
 {
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	return pthread_getspecific(scheduler->thread_key);
+}
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+/* find a task for the thread: its own tasks first, then the ones pushed from
+ * outside the scheduler, then steal from other threads */
+static Task *task_scheduler_pop(TaskScheduler *scheduler, TaskThread *thread, TaskPool *pool)
+{
+	Task *task;
+	int i;
+
+	if (thread && (task = task_queue_pop(&thread->queue, pool, false)))
+		return task;
 
-	if (!scheduler->queue.first) {
+	if ((task = task_queue_pop(&scheduler->queue, pool, false)))
+		return task;
+
+	/* start at the next thread, so thieves spread over victims */
+	for (i = 0; i < scheduler->num_threads; i++) {
+		TaskThread *victim = &scheduler->task_threads[((thread ? thread->id : 0) + i) % scheduler->num_threads];
+
+		if (victim != thread && (task = task_queue_pop(&victim->queue, pool, true)))
+			return task;
+	}
+
+	return NULL;
+}
+
+static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, TaskThread *thread, Task **task)
+{
+	while (true) {
+		if ((*task = task_scheduler_pop(scheduler, thread, NULL)))
+			return true;
+
+		BLI_mutex_lock(&scheduler->queue_mutex);
+
+		if (scheduler->do_exit) {
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			return false;
+		}
+
+		/* tasks are queued before notifying with the mutex held, so looking
+		 * again with the mutex held can't miss a notification */
+		if ((*task = task_scheduler_pop(scheduler, thread, NULL))) {
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			return true;
+		}
+
+		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
 		BLI_mutex_unlock(&scheduler->queue_mutex);
-		BLI_assert(scheduler->do_exit);
-		return false;
 	}
-	
-	*task = scheduler->queue.first;
-	BLI_remlink(&scheduler->queue, *task);
+}
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+static void task_run(Task *task, int thread_id)
+{
+	TaskPool *pool = task->pool;
+
+	/* run task */
+	task->run(pool, task->taskdata, thread_id);
 
-	return true;
+	/* delete task */
+	if (task->free_taskdata)
+		MEM_freeN(task->taskdata);
+	MEM_freeN(task);
+
+	/* notify pool task was done */
+	task_pool_num_decrease(pool, 1);
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
 {
 	TaskThread *thread = (TaskThread *) thread_p;
 	TaskScheduler *scheduler = thread->scheduler;
-	int thread_id = thread->id;
 	Task *task;
 
-	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
-		TaskPool *pool = task->pool;
-
-		/* run task */
-		task->run(pool, task->taskdata, thread_id);
-
-		/* delete task */
-		if (task->free_taskdata)
-			MEM_freeN(task->taskdata);
-		MEM_freeN(task);
+	pthread_setspecific(scheduler->thread_key, thread);
 
-		/* notify pool task was done */
-		task_pool_num_decrease(pool, 1);
-	}
+	/* keep popping off tasks */
+	while (task_scheduler_thread_wait_pop(scheduler, thread, &task))
+		task_run(task, thread->id);
 
 	return NULL;
 }
@@ -150,7 +273,8 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 	 * threads, so we keep track of the number of users. */
 	scheduler->do_exit = false;
 
-	scheduler->queue.first = scheduler->queue.last = NULL;
+	task_queue_init(&scheduler->queue);
+	pthread_key_create(&scheduler->thread_key, NULL);
 	BLI_mutex_init(&scheduler->queue_mutex);
 	BLI_condition_init(&scheduler->queue_cond);
 
@@ -170,14 +294,19 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 		scheduler->threads = MEM_callocN(sizeof(pthread_t) * num_threads, "TaskScheduler threads");
 		scheduler->task_threads = MEM_callocN(sizeof(TaskThread) * num_threads, "TaskScheduler task threads");
 
+		/* all queues exist before any thread can try to steal from them */
 		for (i = 0; i < num_threads; i++) {
 			TaskThread *thread = &scheduler->task_threads[i];
 			thread->scheduler = scheduler;
 			thread->id = i + 1;
+			task_queue_init(&thread->queue);
+		}
+
+		for (i = 0; i < num_threads; i++) {
+			TaskThread *thread = &scheduler->task_threads[i];
 
 			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
 				fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
-				MEM_freeN(thread);
 			}
 		}
 	}
@@ -187,8 +316,6 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 
 void BLI_task_scheduler_free(TaskScheduler *scheduler)
 {
-	Task *task;
-
 	/* stop all waiting threads */
 	BLI_mutex_lock(&scheduler->queue_mutex);
 	scheduler->do_exit = true;
@@ -207,17 +334,18 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 		MEM_freeN(scheduler->threads);
 	}
 
-	/* Delete task thread data */
+	/* Delete task thread data and leftover tasks */
 	if (scheduler->task_threads) {
+		int i;
+
+		for (i = 0; i < scheduler->num_threads; i++)
+			task_queue_end(&scheduler->task_threads[i].queue);
+
 		MEM_freeN(scheduler->task_threads);
 	}
 
-	/* delete leftover tasks */
-	for (task = scheduler->queue.first; task; task = task->next) {
-		if (task->free_taskdata)
-			MEM_freeN(task->taskdata);
-	}
-	BLI_freelistN(&scheduler->queue);
+	task_queue_end(&scheduler->queue);
+	pthread_key_delete(scheduler->thread_key);
 
 	/* delete mutex/condition */
 	BLI_mutex_end(&scheduler->queue_mutex);
@@ -233,42 +361,38 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 
 static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
+	TaskThread *thread = task_scheduler_thread_get(scheduler);
+
 	task_pool_num_increase(task->pool);
 
-	/* add task to queue */
-	BLI_mutex_lock(&scheduler->queue_mutex);
-
-	if (priority == TASK_PRIORITY_HIGH)
-		BLI_addhead(&scheduler->queue, task);
-	else
-		BLI_addtail(&scheduler->queue, task);
+	/* tasks pushed from a scheduler thread, like subtasks of a running
+	 * task, stay local to it unless other threads run out of work */
+	task_queue_push(thread ? &thread->queue : &scheduler->queue, task, priority);
 
+	BLI_mutex_lock(&scheduler->queue_mutex);
 	BLI_condition_notify_one(&scheduler->queue_cond);
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 }
 
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 {
-	Task *task, *nexttask;
+	Task *task;
 	size_t done = 0;
+	int i;
 
-	BLI_mutex_lock(&scheduler->queue_mutex);
-
-	/* free all tasks from this pool from the queue */
-	for (task = scheduler->queue.first; task; task = nexttask) {
-		nexttask = task->next;
+	/* free all tasks from this pool from the queues */
+	for (i = -1; i < scheduler->num_threads; i++) {
+		TaskQueue *queue = (i == -1) ? &scheduler->queue : &scheduler->task_threads[i].queue;
 
-		if (task->pool == pool) {
+		while ((task = task_queue_pop(queue, pool, false))) {
 			if (task->free_taskdata)
 				MEM_freeN(task->taskdata);
-			BLI_freelinkN(&scheduler->queue, task);
+			MEM_freeN(task);
 
 			done++;
 		}
 	}
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
-
 	/* notify done */
 	task_pool_num_decrease(pool, done);
 }
@@ -330,50 +454,30 @@ void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskScheduler *scheduler = pool->scheduler;
+	TaskThread *thread = task_scheduler_thread_get(scheduler);
+	/* a scheduler thread waiting on a nested pool keeps its own id */
+	int thread_id = thread ? thread->id : 0;
 
 	BLI_mutex_lock(&pool->num_mutex);
 
 	while (pool->num != 0) {
-		Task *task, *work_task = NULL;
-		bool found_task = false;
+		Task *task;
 
 		BLI_mutex_unlock(&pool->num_mutex);
 
-		BLI_mutex_lock(&scheduler->queue_mutex);
-
 		/* find task from this pool. if we get a task from another pool,
 		 * we can get into deadlock */
-
-		for (task = scheduler->queue.first; task; task = task->next) {
-			if (task->pool == pool) {
-				work_task = task;
-				found_task = true;
-				BLI_remlink(&scheduler->queue, task);
-				break;
-			}
-		}
-
-		BLI_mutex_unlock(&scheduler->queue_mutex);
+		task = task_scheduler_pop(scheduler, thread, pool);
 
 		/* if found task, do it, otherwise wait until other tasks are done */
-		if (found_task) {
-			/* run task */
-			work_task->run(pool, work_task->taskdata, 0);
-
-			/* delete task */
-			if (work_task->free_taskdata)
-				MEM_freeN(work_task->taskdata);
-			MEM_freeN(work_task);
-
-			/* notify pool task was done */
-			task_pool_num_decrease(pool, 1);
-		}
+		if (task)
+			task_run(task, thread_id);
 
 		BLI_mutex_lock(&pool->num_mutex);
 		if (pool->num == 0)
 			break;
 
-		if (!found_task)
+		if (!task)
 			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
 	}
 
@@ -422,3 +526,315 @@ size_t BLI_task_pool_tasks_done(TaskPool *pool)
 	return pool->done;
 }
 
+
+/* Parallel Range */
+
+/* chunks per thread, so threads finishing early can take more work */
+#define PARALLEL_RANGE_CHUNKS_PER_THREAD 8
+
+typedef struct ParallelRangeState {
+	void *userdata;
+	TaskParallelRangeFunc func;
+
+	int iter;
+	int stop;
+	int chunk_size;
+	SpinLock lock;
+} ParallelRangeState;
+
+static bool parallel_range_next_chunk_get(ParallelRangeState *state, int *r_start, int *r_stop)
+{
+	bool result = false;
+
+	BLI_spin_lock(&state->lock);
+	if (state->iter < state->stop) {
+		*r_start = state->iter;
+		*r_stop = MIN2(state->iter + state->chunk_size, state->stop);
+		state->iter = *r_stop;
+		result = true;
+	}
+	BLI_spin_unlock(&state->lock);
+
+	return result;
+}
+
+static void parallel_range_func(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	ParallelRangeState *state = BLI_task_pool_userdata(pool);
+	int start, stop;
+
+	while (parallel_range_next_chunk_get(state, &start, &stop)) {
+		state->func(state->userdata, start, stop);
+	}
+}
+
+void BLI_task_parallel_range_ex(int start, int stop, void *userdata,
+                                TaskParallelRangeFunc func, const int range_threshold)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelRangeState state;
+	int i, num_threads;
+
+	if (start >= stop)
+		return;
+
+	task_scheduler = BLI_task_scheduler_get();
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	/* not worth the overhead of threading */
+	if (num_threads == 1 || stop - start < range_threshold) {
+		func(userdata, start, stop);
+		return;
+	}
+
+	state.userdata = userdata;
+	state.func = func;
+	state.iter = start;
+	state.stop = stop;
+	state.chunk_size = MAX2(1, (stop - start) / (num_threads * PARALLEL_RANGE_CHUNKS_PER_THREAD));
+	BLI_spin_init(&state.lock);
+
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	/* one task per thread, each running chunks until the range is done */
+	for (i = 0; i < num_threads; i++) {
+		BLI_task_pool_push(task_pool, parallel_range_func, NULL, false, TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
+	BLI_spin_end(&state.lock);
+}
+
+void BLI_task_parallel_range(int start, int stop, void *userdata, TaskParallelRangeFunc func)
+{
+	BLI_task_parallel_range_ex(start, stop, userdata, func, 64);
+}
+
+/* Parallel Range with per task data */
+
+typedef struct ParallelRangeReduceState {
+	ParallelRangeState range;
+	TaskParallelRangeFuncEx func;
+} ParallelRangeReduceState;
+
+static void parallel_range_reduce_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	ParallelRangeReduceState *state = BLI_task_pool_userdata(pool);
+	int start, stop;
+
+	while (parallel_range_next_chunk_get(&state->range, &start, &stop)) {
+		state->func(state->range.userdata, taskdata, start, stop);
+	}
+}
+
+void BLI_task_parallel_range_reduce(int start, int stop, void *userdata,
+                                    void *userdata_chunk, const size_t userdata_chunk_size,
+                                    TaskParallelRangeFuncEx func, TaskParallelReduceFunc func_reduce,
+                                    const int range_threshold)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelRangeReduceState state;
+	char *userdata_chunks;
+	int i, num_threads;
+
+	if (start >= stop)
+		return;
+
+	task_scheduler = BLI_task_scheduler_get();
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	/* not worth the overhead of threading, the chunk data is used as is */
+	if (num_threads == 1 || stop - start < range_threshold) {
+		func(userdata, userdata_chunk, start, stop);
+		if (func_reduce)
+			func_reduce(userdata, userdata_chunk);
+		return;
+	}
+
+	state.range.userdata = userdata;
+	state.range.func = NULL;
+	state.range.iter = start;
+	state.range.stop = stop;
+	state.range.chunk_size = MAX2(1, (stop - start) / (num_threads * PARALLEL_RANGE_CHUNKS_PER_THREAD));
+	state.func = func;
+	BLI_spin_init(&state.range.lock);
+
+	/* a copy of the initial chunk data for each task */
+	userdata_chunks = MEM_mallocN(userdata_chunk_size * (size_t)num_threads, "parallel range chunks");
+	for (i = 0; i < num_threads; i++)
+		memcpy(userdata_chunks + userdata_chunk_size * (size_t)i, userdata_chunk, userdata_chunk_size);
+
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	for (i = 0; i < num_threads; i++) {
+		BLI_task_pool_push(task_pool, parallel_range_reduce_func,
+		                   userdata_chunks + userdata_chunk_size * (size_t)i, false, TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
+	BLI_spin_end(&state.range.lock);
+
+	/* combine in task order, so results don't depend on thread timing
+	 * more than the chunk distribution does */
+	if (func_reduce) {
+		for (i = 0; i < num_threads; i++)
+			func_reduce(userdata, userdata_chunks + userdata_chunk_size * (size_t)i);
+	}
+
+	MEM_freeN(userdata_chunks);
+}
+
+/* Parallel ListBase and Mempool iteration */
+
+typedef struct ParallelIterState {
+	void *userdata;
+	void *func;
+	int iter_chunk;
+
+	/* current position, guarded by lock */
+	Link *link;
+	int index;
+	BLI_mempool_iter mempool_iter;
+	SpinLock lock;
+} ParallelIterState;
+
+static void parallel_listbase_func(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	ParallelIterState *state = BLI_task_pool_userdata(pool);
+	TaskParallelListbaseFunc func = (TaskParallelListbaseFunc)state->func;
+
+	while (true) {
+		Link *link;
+		int i, index;
+
+		BLI_spin_lock(&state->lock);
+		link = state->link;
+		index = state->index;
+		for (i = 0; i < state->iter_chunk && state->link; i++)
+			state->link = state->link->next;
+		state->index += i;
+		BLI_spin_unlock(&state->lock);
+
+		if (link == NULL)
+			break;
+
+		for (; i > 0; i--, index++, link = link->next)
+			func(state->userdata, link, index);
+	}
+}
+
+void BLI_task_parallel_listbase(ListBase *listbase, void *userdata,
+                                TaskParallelListbaseFunc func, const int iter_chunk)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelIterState state;
+	int i, num_threads;
+
+	if (listbase->first == NULL)
+		return;
+
+	task_scheduler = BLI_task_scheduler_get();
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	if (num_threads == 1 || listbase->first == listbase->last) {
+		Link *link;
+
+		for (link = listbase->first, i = 0; link; link = link->next, i++)
+			func(userdata, link, i);
+		return;
+	}
+
+	state.userdata = userdata;
+	state.func = (void *)func;
+	state.iter_chunk = MAX2(1, iter_chunk);
+	state.link = listbase->first;
+	state.index = 0;
+	BLI_spin_init(&state.lock);
+
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	for (i = 0; i < num_threads; i++) {
+		BLI_task_pool_push(task_pool, parallel_listbase_func, NULL, false, TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
+	BLI_spin_end(&state.lock);
+}
+
+static void parallel_mempool_func(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	ParallelIterState *state = BLI_task_pool_userdata(pool);
+	TaskParallelMempoolFunc func = (TaskParallelMempoolFunc)state->func;
+	void **items = BLI_array_alloca(items, (size_t)state->iter_chunk);
+
+	while (true) {
+		int i, totitem = 0;
+
+		BLI_spin_lock(&state->lock);
+		while (totitem < state->iter_chunk &&
+		       (items[totitem] = BLI_mempool_iterstep(&state->mempool_iter)))
+		{
+			totitem++;
+		}
+		BLI_spin_unlock(&state->lock);
+
+		if (totitem == 0)
+			break;
+
+		for (i = 0; i < totitem; i++)
+			func(state->userdata, items[i]);
+	}
+}
+
+void BLI_task_parallel_mempool(BLI_mempool *mempool, void *userdata,
+                               TaskParallelMempoolFunc func, const int iter_chunk)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelIterState state;
+	int i, num_threads;
+
+	if (BLI_mempool_count(mempool) == 0)
+		return;
+
+	task_scheduler = BLI_task_scheduler_get();
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	if (num_threads == 1) {
+		BLI_mempool_iter iter;
+		void *item;
+
+		BLI_mempool_iternew(mempool, &iter);
+		while ((item = BLI_mempool_iterstep(&iter)))
+			func(userdata, item);
+		return;
+	}
+
+	state.userdata = userdata;
+	state.func = (void *)func;
+	state.iter_chunk = MAX2(1, iter_chunk);
+	state.link = NULL;
+	state.index = 0;
+	BLI_mempool_iternew(mempool, &state.mempool_iter);
+	BLI_spin_init(&state.lock);
+
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	for (i = 0; i < num_threads; i++) {
+		BLI_task_pool_push(task_pool, parallel_mempool_func, NULL, false, TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
+	BLI_spin_end(&state.lock);
+}
@@ -44,12 +44,19 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap
+#  include <sys/stat.h> // for fstat
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
 #  include "BLI_winstuff.h"
 #endif
 
+/* read uncompressed files through a memory mapping */
+#ifndef WIN32
+#  define USE_MMAP
+#endif
+
 /* allow readfile to use deprecated functionality */
 #define DNA_DEPRECATED_ALLOW
 
@@ -108,6 +115,7 @@
 #include "BLI_math.h"
 #include "BLI_edgehash.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 #include "BLI_mempool.h"
 
 #include "BLF_translation.h"
@@ -231,11 +239,15 @@ typedef struct OldNew {
 	int nr;
 } OldNew;
 
+/* Entries are kept in insertion order, with an open addressing hash table
+ * of entry indices on the old address for lookups. */
 typedef struct OldNewMap {
 	OldNew *entries;
 	int nentries, entriessize;
-	int sorted;
 	int lasthit;
+
+	int *map;           /* entry indices, -1 for empty slots */
+	unsigned int map_mask;
 } OldNewMap;
 
 
@@ -271,30 +283,84 @@ static void BKE_reportf_wrap(ReportList *reports, ReportType type, const char *f
 	}
 }
 
+/* the map has twice as many slots as there is room for entries */
+#define OLDNEWMAP_SLOTS(entriessize) ((unsigned int)(entriessize) * 2)
+
+static unsigned int oldnewmap_hash(const void *addr)
+{
+	/* old addresses are aligned, mix all bits into the low ones */
+	uint64_t v = (uint64_t)(uintptr_t)addr;
+
+	v ^= v >> 33;
+	v *= 0xff51afd7ed558ccdULL;
+	v ^= v >> 33;
+
+	return (unsigned int)v;
+}
+
+static void oldnewmap_map_insert(OldNewMap *onm, int index)
+{
+	unsigned int slot = oldnewmap_hash(onm->entries[index].old) & onm->map_mask;
+
+	/* linear probing, entries with the same old address stay in insertion order */
+	while (onm->map[slot] != -1)
+		slot = (slot + 1) & onm->map_mask;
+
+	onm->map[slot] = index;
+}
+
+static void oldnewmap_map_alloc(OldNewMap *onm)
+{
+	unsigned int slots = OLDNEWMAP_SLOTS(onm->entriessize);
+	int i;
+
+	onm->map = MEM_mallocN(sizeof(*onm->map) * slots, "OldNewMap.map");
+	onm->map_mask = slots - 1;
+	memset(onm->map, -1, sizeof(*onm->map) * slots);
+
+	for (i = 0; i < onm->nentries; i++)
+		oldnewmap_map_insert(onm, i);
+}
+
 static OldNewMap *oldnewmap_new(void) 
 {
 	OldNewMap *onm= MEM_callocN(sizeof(*onm), "OldNewMap");
 	
 	onm->entriessize = 1024;
 	onm->entries = MEM_mallocN(sizeof(*onm->entries)*onm->entriessize, "OldNewMap.entries");
+	oldnewmap_map_alloc(onm);
 	
 	return onm;
 }
 
-static int verg_oldnewmap(const void *v1, const void *v2)
+/* first entry index for addr, iterate further with oldnewmap_map_next */
+static int oldnewmap_map_find(OldNewMap *onm, const void *addr, unsigned int *r_slot)
 {
-	const struct OldNew *x1=v1, *x2=v2;
-	
-	if (x1->old > x2->old) return 1;
-	else if (x1->old < x2->old) return -1;
-	return 0;
-}
+	unsigned int slot = oldnewmap_hash(addr) & onm->map_mask;
+	int index;
+
+	while ((index = onm->map[slot]) != -1) {
+		if (onm->entries[index].old == addr)
+			break;
+		slot = (slot + 1) & onm->map_mask;
+	}
 
+	*r_slot = slot;
+	return index;
+}
 
-static void oldnewmap_sort(FileData *fd) 
+static int oldnewmap_map_next(OldNewMap *onm, const void *addr, unsigned int *r_slot)
 {
-	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
-	fd->libmap->sorted = 1;
+	unsigned int slot = *r_slot;
+	int index;
+
+	do {
+		slot = (slot + 1) & onm->map_mask;
+		index = onm->map[slot];
+	} while (index != -1 && onm->entries[index].old != addr);
+
+	*r_slot = slot;
+	return index;
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -313,12 +379,17 @@ static void oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int n
 		
 		memcpy(onm->entries, oentries, sizeof(*oentries)*osize);
 		MEM_freeN(oentries);
+
+		MEM_freeN(onm->map);
+		oldnewmap_map_alloc(onm);
 	}
 
-	entry = &onm->entries[onm->nentries++];
+	entry = &onm->entries[onm->nentries];
 	entry->old = oldaddr;
 	entry->newp = newaddr;
 	entry->nr = nr;
+
+	oldnewmap_map_insert(onm, onm->nentries++);
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int nr)
@@ -328,6 +399,7 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newad
 
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_users) 
 {
+	unsigned int slot;
 	int i;
 	
 	if (addr == NULL) return NULL;
@@ -342,16 +414,15 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_
 		}
 	}
 	
-	for (i = 0; i < onm->nentries; i++) {
+	i = oldnewmap_map_find(onm, addr, &slot);
+	if (i != -1) {
 		OldNew *entry = &onm->entries[i];
-		
-		if (entry->old == addr) {
-			onm->lasthit = i;
-			
-			if (increase_users)
-				entry->nr++;
-			return entry->newp;
-		}
+
+		onm->lasthit = i;
+
+		if (increase_users)
+			entry->nr++;
+		return entry->newp;
 	}
 	
 	return NULL;
@@ -360,38 +431,19 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_
 /* for libdata, nr has ID code, no increment */
 static void *oldnewmap_liblookup(OldNewMap *onm, void *addr, void *lib)
 {
+	unsigned int slot;
+	int i;
+
 	if (addr == NULL) {
 		return NULL;
 	}
 
-	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
-	if (onm->sorted) {
-		OldNew entry_s, *entry;
-
-		entry_s.old = addr;
-
-		entry = bsearch(&entry_s, onm->entries, onm->nentries, sizeof(OldNew), verg_oldnewmap);
-		if (entry) {
-			ID *id = entry->newp;
-
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
-		}
-	}
-	else {
-		/* note, this can be a bottle neck when loading some files */
-		unsigned int nentries = (unsigned int)onm->nentries;
-		unsigned int i;
-		OldNew *entry;
+	/* the same address can be in the map more than once, take the first valid one */
+	for (i = oldnewmap_map_find(onm, addr, &slot); i != -1; i = oldnewmap_map_next(onm, addr, &slot)) {
+		ID *id = onm->entries[i].newp;
 
-		for (i = 0, entry = onm->entries; i < nentries; i++, entry++) {
-			if (entry->old == addr) {
-				ID *id = entry->newp;
-				if (id && (!lib || id->lib)) {
-					return id;
-				}
-			}
+		if (id && (!lib || id->lib)) {
+			return id;
 		}
 	}
 
@@ -413,6 +465,24 @@ static void oldnewmap_free_unused(OldNewMap *onm)
 
 static void oldnewmap_clear(OldNewMap *onm) 
 {
+	/* the data map is cleared after every datablock, only reset the
+	 * used slots when the map grew much larger than its contents */
+	if ((unsigned int)onm->nentries * 8 < OLDNEWMAP_SLOTS(onm->entriessize)) {
+		int i;
+
+		for (i = 0; i < onm->nentries; i++) {
+			unsigned int slot = oldnewmap_hash(onm->entries[i].old) & onm->map_mask;
+
+			while (onm->map[slot] != i)
+				slot = (slot + 1) & onm->map_mask;
+
+			onm->map[slot] = -1;
+		}
+	}
+	else {
+		memset(onm->map, -1, sizeof(*onm->map) * OLDNEWMAP_SLOTS(onm->entriessize));
+	}
+
 	onm->nentries = 0;
 	onm->lasthit = 0;
 }
@@ -420,6 +490,7 @@ static void oldnewmap_clear(OldNewMap *onm)
 static void oldnewmap_free(OldNewMap *onm) 
 {
 	MEM_freeN(onm->entries);
+	MEM_freeN(onm->map);
 	MEM_freeN(onm);
 }
 
@@ -696,13 +767,32 @@ static BHeadN *get_bhead(FileData *fd)
 			/* bhead now contains the (converted) bhead structure. Now read
 			 * the associated data and put everything in a BHeadN (creative naming !)
 			 */
-			if (!fd->eof) {
+			if (fd->eof) {
+				/* pass */
+			}
+			else if (fd->mmap_buffer) {
+				/* reference the data in the mapped file, pages are only read
+				 * once a block is actually used */
+				if ((size_t)bhead.len > fd->mmap_size - fd->mmap_seek) {
+					fd->eof = 1;
+				}
+				else {
+					new_bhead = MEM_mallocN(sizeof(BHeadN), "new_bhead");
+					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->data = fd->mmap_buffer + fd->mmap_seek;
+					new_bhead->bhead = bhead;
+
+					fd->mmap_seek += bhead.len;
+				}
+			}
+			else {
 				new_bhead = MEM_mallocN(sizeof(BHeadN) + bhead.len, "new_bhead");
 				if (new_bhead) {
 					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->data = new_bhead + 1;
 					new_bhead->bhead = bhead;
 					
-					readsize = fd->read(fd, new_bhead + 1, bhead.len);
+					readsize = fd->read(fd, new_bhead->data, bhead.len);
 					
 					if (readsize != bhead.len) {
 						fd->eof = 1;
@@ -747,6 +837,14 @@ BHead *blo_firstbhead(FileData *fd)
 	return(bhead);
 }
 
+/* data of the block, use instead of (bhead + 1) */
+void *blo_bhead_data(BHead *bhead)
+{
+	BHeadN *bheadn = (BHeadN *) (((char *) bhead) - offsetof(BHeadN, bhead));
+
+	return bheadn->data;
+}
+
 BHead *blo_prevbhead(FileData *UNUSED(fd), BHead *thisblock)
 {
 	BHeadN *bheadn = (BHeadN *) (((char *) thisblock) - offsetof(BHeadN, bhead));
@@ -831,10 +929,10 @@ static int read_file_dna(FileData *fd)
 		if (bhead->code == DNA1) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
 			
-			fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap);
+			fd->filesdna = DNA_sdna_from_data(blo_bhead_data(bhead), bhead->len, do_endian_swap);
 			if (fd->filesdna) {
 				fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
-				/* used to retrieve ID names from (bhead+1) */
+				/* used to retrieve ID names from the block data */
 				fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 			}
 			
@@ -886,6 +984,19 @@ static int fd_read_from_memory(FileData *filedata, void *buffer, unsigned int si
 	return (readsize);
 }
 
+#ifdef USE_MMAP
+static int fd_read_from_mmap(FileData *filedata, void *buffer, unsigned int size)
+{
+	/* don't read more bytes then there are available in the file */
+	size_t readsize = MIN2((size_t)size, filedata->mmap_size - filedata->mmap_seek);
+
+	memcpy(buffer, filedata->mmap_buffer + filedata->mmap_seek, readsize);
+	filedata->mmap_seek += readsize;
+
+	return (int)readsize;
+}
+#endif
+
 static int fd_read_from_memfile(FileData *filedata, void *buffer, unsigned int size)
 {
 	static unsigned int seek = (1<<30);	/* the current position */
@@ -985,11 +1096,64 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 	return fd;
 }
 
+#ifdef USE_MMAP
+/* Map uncompressed files into memory, so block data is referenced in place
+ * instead of copied, and only read from disk when it is used. Returns NULL
+ * for compressed files or when mapping fails, those are read through zlib. */
+static FileData *blo_openblenderfile_mmap(const char *filepath)
+{
+	FileData *fd;
+	struct stat st;
+	unsigned char magic[2];
+	void *mem;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1)
+		return NULL;
+
+	if (read(file, magic, sizeof(magic)) != sizeof(magic) ||
+	    (magic[0] == 0x1f && magic[1] == 0x8b) ||
+	    fstat(file, &st) == -1 || st.st_size < SIZEOFBLENDERHEADER)
+	{
+		close(file);
+		return NULL;
+	}
+
+	/* private mapping, endian switching writes to the blocks in place */
+	mem = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	if (mem == MAP_FAILED) {
+		close(file);
+		return NULL;
+	}
+
+	fd = filedata_new();
+	fd->filedes = file;
+	fd->mmap_buffer = mem;
+	fd->mmap_size = (size_t)st.st_size;
+	fd->read = fd_read_from_mmap;
+
+	return fd;
+}
+#endif
+
 /* cannot be called with relative paths anymore! */
 /* on each new library added, it now checks for the current FileData and expands relativeness */
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+
+#ifdef USE_MMAP
+	FileData *fd_mmap = blo_openblenderfile_mmap(filepath);
+
+	if (fd_mmap) {
+		/* needed for library_append and read_libraries */
+		BLI_strncpy(fd_mmap->relabase, filepath, sizeof(fd_mmap->relabase));
+
+		return blo_decode_and_check(fd_mmap, reports);
+	}
+#endif
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 	
@@ -1020,6 +1184,12 @@ static int fd_read_gzip_from_memory(FileData *filedata, void *buffer, unsigned i
 	// Inflate another chunk.
 	err = inflate (&filedata->strm, Z_SYNC_FLUSH);
 
+	/* compressed files are written as several concatenated gzip members */
+	while (err == Z_STREAM_END && filedata->strm.avail_in > 0) {
+		inflateReset(&filedata->strm);
+		err = (filedata->strm.avail_out > 0) ? inflate(&filedata->strm, Z_SYNC_FLUSH) : Z_OK;
+	}
+
 	if (err == Z_STREAM_END) {
 		return 0;
 	}
@@ -1108,6 +1278,12 @@ void blo_freefiledata(FileData *fd)
 			gzclose(fd->gzfiledes);
 		}
 		
+#ifdef USE_MMAP
+		if (fd->mmap_buffer) {
+			munmap(fd->mmap_buffer, fd->mmap_size);
+		}
+#endif
+		
 		if (fd->strm.next_in) {
 			if (inflateEnd (&fd->strm) != Z_OK) {
 				printf("close gzip stream error\n");
@@ -1542,7 +1718,7 @@ static void switch_endian_structs(struct SDNA *filesdna, BHead *bhead)
 	int blocksize, nblocks;
 	char *data;
 	
-	data = (char *)(bhead+1);
+	data = blo_bhead_data(bhead);
 	blocksize = filesdna->typelens[ filesdna->structs[bhead->SDNAnr][0] ];
 	
 	nblocks = bhead->nr;
@@ -1564,11 +1740,11 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 		
 		if (fd->compflags[bh->SDNAnr]) {	/* flag==0: doesn't exist anymore */
 			if (fd->compflags[bh->SDNAnr] == 2) {
-				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh+1));
+				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, blo_bhead_data(bh));
 			}
 			else {
 				temp = MEM_mallocN(bh->len, blockname);
-				memcpy(temp, (bh+1), bh->len);
+				memcpy(temp, blo_bhead_data(bh), bh->len);
 			}
 		}
 	}
@@ -2099,6 +2275,7 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
 			
 			/* compiled expression data will need to be regenerated (old pointer may still be set here) */
 			driver->expr_comp = NULL;
+			driver->expr_simple = NULL;
 			
 			/* give the driver a fresh chance - the operating environment may be different now 
 			 * (addons, etc. may be different) so the driver namespace may be sane now [#32155]
@@ -3903,6 +4080,7 @@ static void direct_link_particlesystems(FileData *fd, ListBase *particles)
 		
 		psys->tree = NULL;
 		psys->bvhtree = NULL;
+		psys->sphgrid = NULL;
 	}
 	return;
 }
@@ -4291,6 +4469,7 @@ static void lib_link_object(FileData *fd, Main *main)
 	bSensor *sens;
 	bController *cont;
 	bActuator *act;
+	LodLevel *lod;
 	void *poin;
 	int warn=0, a;
 	
@@ -4522,6 +4701,13 @@ static void lib_link_object(FileData *fd, Main *main)
 				ob->rigidbody_constraint->ob1 = newlibadr(fd, ob->id.lib, ob->rigidbody_constraint->ob1);
 				ob->rigidbody_constraint->ob2 = newlibadr(fd, ob->id.lib, ob->rigidbody_constraint->ob2);
 			}
+
+			for (lod = ob->lodlevels.first; lod; lod = lod->next) {
+				lod->source = newlibadr(fd, ob->id.lib, lod->source);
+				/* the base level always draws the object itself */
+				if (lod->source == NULL && lod == ob->lodlevels.first)
+					lod->source = ob;
+			}
 		}
 	}
 	
@@ -5035,9 +5221,13 @@ static void direct_link_object(FileData *fd, Object *ob)
 	ob->bb = NULL;
 	ob->derivedDeform = NULL;
 	ob->derivedFinal = NULL;
+	ob->modifier_cache = NULL;
 	ob->gpulamp.first= ob->gpulamp.last = NULL;
 	link_list(fd, &ob->pc_ids);
 
+	link_list(fd, &ob->lodlevels);
+	ob->currentlod = ob->lodlevels.first;
+
 	/* Runtime curve data  */
 	ob->curve_cache = NULL;
 
@@ -6618,6 +6808,7 @@ static void direct_link_sound(FileData *fd, bSound *sound)
 	sound->handle = NULL;
 	sound->playback_handle = NULL;
 	sound->waveform = NULL;
+	sound->flags &= ~SOUND_FLAGS_WAVEFORM_LOADING;
 
 	// versioning stuff, if there was a cache, then we enable caching:
 	if (sound->cache) {
@@ -7096,8 +7287,75 @@ static const char *dataname(short id_code)
 	
 }
 
+/* threads convert the blocks of a datablock when there is this much data */
+#define READ_STRUCTS_PARALLEL_SIZE (1 << 18)
+
+typedef struct ReadStructsData {
+	FileData *fd;
+	BHead **bheads;
+	void **data;
+	const char *allocname;
+} ReadStructsData;
+
+static void read_structs_range(void *userdata, int start, int stop)
+{
+	ReadStructsData *data = userdata;
+	int i;
+
+	/* only reads the file SDNA, and endian switching writes to each block itself */
+	for (i = start; i < stop; i++)
+		data->data[i] = read_struct(data->fd, data->bheads[i], data->allocname);
+}
+
+/* Convert all data blocks following the ID block with threads, and set
+ * r_bhead to the block after them. Returns false without doing anything when
+ * there is too little data to be worth it. */
+static bool read_data_into_oldnewmap_parallel(FileData *fd, BHead *bhead, const char *allocname, BHead **r_bhead)
+{
+	ReadStructsData data;
+	BHead *bh;
+	size_t totlen = 0;
+	int totblock = 0, i;
+
+	/* reading the headers is sequential, the blocks are in memory after this */
+	for (bh = blo_nextbhead(fd, bhead); bh && bh->code == DATA; bh = blo_nextbhead(fd, bh)) {
+		totlen += (size_t)bh->len;
+		totblock++;
+	}
+
+	if (totblock < 2 || totlen < READ_STRUCTS_PARALLEL_SIZE)
+		return false;
+
+	data.fd = fd;
+	data.bheads = MEM_mallocN(sizeof(*data.bheads) * totblock, "read_structs bheads");
+	data.data = MEM_mallocN(sizeof(*data.data) * totblock, "read_structs data");
+	data.allocname = allocname;
+
+	for (bh = blo_nextbhead(fd, bhead), i = 0; i < totblock; bh = blo_nextbhead(fd, bh), i++)
+		data.bheads[i] = bh;
+
+	BLI_task_parallel_range_ex(0, totblock, &data, read_structs_range, 2);
+
+	/* insert in file order, lookups rely on it */
+	for (i = 0; i < totblock; i++) {
+		if (data.data[i])
+			oldnewmap_insert(fd->datamap, data.bheads[i]->old, data.data[i], 0);
+	}
+
+	MEM_freeN(data.bheads);
+	MEM_freeN(data.data);
+
+	*r_bhead = bh;
+	return true;
+}
+
 static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *allocname)
 {
+	BHead *bhead_next;
+
+	if (read_data_into_oldnewmap_parallel(fd, bhead, allocname, &bhead_next))
+		return bhead_next;
+
 	bhead = blo_nextbhead(fd, bhead);
 	
 	while (bhead && bhead->code==DATA) {
@@ -9850,8 +10108,6 @@ static void do_versions_after_linking(FileData *fd, Library *lib, Main *main)
 
 static void lib_link_all(FileData *fd, Main *main)
 {
-	oldnewmap_sort(fd);
-	
 	/* No load UI for undo memfiles */
 	if (fd->memfile == NULL) {
 		lib_link_windowmanager(fd, main);
@@ -10132,7 +10388,7 @@ static BHead *find_bhead(FileData *fd, void *old)
 
 char *bhead_id_name(FileData *fd, BHead *bhead)
 {
-	return ((char *)(bhead+1)) + fd->id_name_offs;
+	return ((char *)blo_bhead_data(bhead)) + fd->id_name_offs;
 }
 
 static ID *is_yet_read(FileData *fd, Main *mainvar, BHead *bhead)
@@ -10674,10 +10930,16 @@ static void expand_object(FileData *fd, Main *mainvar, Object *ob)
 	bActuator *act;
 	bActionStrip *strip;
 	PartEff *paf;
+	LodLevel *lod;
 	int a;
 	
 	expand_doit(fd, mainvar, ob->data);
 	
+	for (lod = ob->lodlevels.first; lod; lod = lod->next) {
+		if (lod->source != ob)
+			expand_doit(fd, mainvar, lod->source);
+	}
+	
 	/* expand_object_expandModifier() */
 	if (ob->modifiers.first) {
 		struct { FileData *fd; Main *mainvar; } data;
@@ -11463,11 +11725,108 @@ static int mainvar_count_libread_blocks(Main *mainvar)
 	return tot;
 }
 
+/* library files opened ahead of read_libraries() reading from them */
+typedef struct LibraryPreopen {
+	Main **mains;
+	FileData **fds;
+	int tot;
+} LibraryPreopen;
+
+static void library_preopen_cb(void *userdata, int start, int stop)
+{
+	LibraryPreopen *preopen = userdata;
+	int i;
+	
+	for (i = start; i < stop; i++) {
+		const char *filepath = preopen->mains[i]->curlib->filepath;
+		
+		/* missing files are reported by read_libraries() */
+		if (BLI_exists(filepath))
+			preopen->fds[i] = blo_openblenderfile(filepath, NULL);
+	}
+}
+
+/* Opens the files of all libraries up to 'mainlast' which have blocks to read
+ * but weren't opened yet. This reads their headers and DNA at the same time, so
+ * with many libraries (on network storage especially) the waiting overlaps. */
+static void library_preopen_begin(LibraryPreopen *preopen, Main *mainl, Main *mainlast)
+{
+	Main *mainptr;
+	
+	preopen->tot = 0;
+	preopen->mains = NULL;
+	preopen->fds = NULL;
+	
+	for (mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+		if (mainptr->curlib->filedata == NULL && mainptr->curlib->packedfile == NULL &&
+		    mainvar_count_libread_blocks(mainptr))
+		{
+			preopen->tot++;
+		}
+		if (mainptr == mainlast)
+			break;
+	}
+	
+	/* not worth it for a single file */
+	if (preopen->tot < 2) {
+		preopen->tot = 0;
+		return;
+	}
+	
+	preopen->mains = MEM_mallocN(sizeof(*preopen->mains) * preopen->tot, "library preopen mains");
+	preopen->fds = MEM_callocN(sizeof(*preopen->fds) * preopen->tot, "library preopen fds");
+	preopen->tot = 0;
+	
+	for (mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+		if (mainptr->curlib->filedata == NULL && mainptr->curlib->packedfile == NULL &&
+		    mainvar_count_libread_blocks(mainptr))
+		{
+			preopen->mains[preopen->tot++] = mainptr;
+		}
+		if (mainptr == mainlast)
+			break;
+	}
+	
+	/* threshold of 1, each file is opened as a task of its own */
+	BLI_task_parallel_range_ex(0, preopen->tot, preopen, library_preopen_cb, 1);
+}
+
+/* returns the opened file of this library, NULL if it wasn't opened ahead */
+static FileData *library_preopen_take(LibraryPreopen *preopen, Main *mainptr)
+{
+	int i;
+	
+	for (i = 0; i < preopen->tot; i++) {
+		if (preopen->mains[i] == mainptr) {
+			FileData *fd = preopen->fds[i];
+			preopen->fds[i] = NULL;
+			return fd;
+		}
+	}
+	
+	return NULL;
+}
+
+static void library_preopen_end(LibraryPreopen *preopen)
+{
+	int i;
+	
+	for (i = 0; i < preopen->tot; i++) {
+		if (preopen->fds[i])
+			blo_freefiledata(preopen->fds[i]);
+	}
+	
+	MEM_SAFE_FREE(preopen->mains);
+	MEM_SAFE_FREE(preopen->fds);
+	preopen->tot = 0;
+}
+
 static void read_libraries(FileData *basefd, ListBase *mainlist)
 {
 	Main *mainl = mainlist->first;
-	Main *mainptr;
+	Main *mainptr, *mainlast;
 	ListBase *lbarray[MAX_LIBARRAY];
+	LibraryPreopen preopen;
 	int a, do_it = TRUE;
 	
 	/* expander now is callback function */
@@ -11476,6 +11835,11 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 	while (do_it) {
 		do_it = FALSE;
 		
+		/* libraries found while expanding are added at the end of the list, they
+		 * are read in the next pass, so they can be opened together */
+		mainlast = mainlist->last;
+		library_preopen_begin(&preopen, mainl, mainlast);
+		
 		/* test 1: read libdata */
 		mainptr= mainl->next;
 		while (mainptr) {
@@ -11504,7 +11868,11 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 					else {
 						BKE_reportf_wrap(basefd->reports, RPT_INFO, TIP_("Read library:  '%s', '%s'"),
 						                 mainptr->curlib->filepath, mainptr->curlib->name);
-						fd = blo_openblenderfile(mainptr->curlib->filepath, basefd->reports);
+						fd = library_preopen_take(&preopen, mainptr);
+						
+						/* opens again when opening ahead failed, to report the error */
+						if (fd == NULL)
+							fd = blo_openblenderfile(mainptr->curlib->filepath, basefd->reports);
 					}
 					/* allow typing in a new lib path */
 					if (G.debug_value == -666) {
@@ -11592,8 +11960,13 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 				}
 			}
 			
+			if (mainptr == mainlast)
+				break;
+			
 			mainptr = mainptr->next;
 		}
+		
+		library_preopen_end(&preopen);
 	}
 	
 	/* test if there are unread libblocks */
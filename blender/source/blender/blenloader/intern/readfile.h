@@ -62,6 +62,11 @@ typedef struct FileData {
 	int filedes;
 	gzFile gzfiledes;
 
+	// variables needed for reading from a memory mapped file
+	char *mmap_buffer;
+	size_t mmap_size;
+	size_t mmap_seek;
+
 	// now only in use for library appending
 	char relabase[FILE_MAX];
 	
@@ -102,6 +107,7 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	void *data;  /* follows the BHeadN, or points into the memory mapped file */
 	struct BHead bhead;
 } BHeadN;
 
@@ -141,6 +147,7 @@ BHead *blo_firstbhead(FileData *fd);
 BHead *blo_nextbhead(FileData *fd, BHead *thisblock);
 BHead *blo_prevbhead(FileData *fd, BHead *thisblock);
 
+void *blo_bhead_data(BHead *bhead);
 char *bhead_id_name(FileData *fd, BHead *bhead);
 
 /* do versions stuff */
@@ -38,9 +38,11 @@
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
+#include "DNA_sdna_types.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
+#include "BLI_ghash.h"
 
 #include "BLO_undofile.h"
 
@@ -95,18 +97,51 @@ static int my_memcmp(const int *mem1, const int *mem2, const int len)
 	return 0;
 }
 
+/* Undo writing starts every datablock in a new chunk, which begins with the
+ * BHead of the ID. Returns the BHead when the chunk looks like one. */
+static const BHead *memfilechunk_id_bhead(const char *buf, unsigned int size)
+{
+	const BHead *bhead = (const BHead *)buf;
+
+	/* ID codes are two characters */
+	if (size >= sizeof(BHead) && bhead->code != 0 && (bhead->code & ~0xFFFF) == 0 && bhead->old) {
+		return bhead;
+	}
+
+	return NULL;
+}
+
 void add_memfilechunk(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
 {
 	static MemFileChunk *compchunk = NULL;
+	/* chunks of the compare file by the address of the ID they start */
+	static GHash *compchunk_map = NULL;
 	MemFileChunk *curchunk;
+	const BHead *bhead;
 	
-	/* this function inits when compare != NULL or when current == NULL  */
+	/* this function inits when compare != NULL or ends when current == NULL  */
+	if (compare || current == NULL) {
+		compchunk = NULL;
+
+		if (compchunk_map) {
+			BLI_ghash_free(compchunk_map, NULL, NULL);
+			compchunk_map = NULL;
+		}
+	}
 	if (compare) {
+		MemFileChunk *chunk;
+
 		compchunk = compare->chunks.first;
+		compchunk_map = BLI_ghash_ptr_new("add_memfilechunk map");
+
+		for (chunk = compare->chunks.first; chunk; chunk = chunk->next) {
+			if ((bhead = memfilechunk_id_bhead(chunk->buf, chunk->size))) {
+				BLI_ghash_reinsert(compchunk_map, bhead->old, chunk, NULL, NULL);
+			}
+		}
 		return;
 	}
 	if (current == NULL) {
-		compchunk = NULL;
 		return;
 	}
 	
@@ -115,6 +150,16 @@ void add_memfilechunk(MemFile *compare, MemFile *current, const char *buf, unsig
 	curchunk->buf = NULL;
 	curchunk->ident = 0;
 	BLI_addtail(&current->chunks, curchunk);
+
+	/* continue comparing at the same datablock, so adding or removing
+	 * datablocks doesn't make all chunks after it differ */
+	if (compchunk_map && (bhead = memfilechunk_id_bhead(buf, size))) {
+		MemFileChunk *chunk = BLI_ghash_lookup(compchunk_map, bhead->old);
+
+		if (chunk) {
+			compchunk = chunk;
+		}
+	}
 	
 	/* we compare compchunk with buf */
 	if (compchunk) {
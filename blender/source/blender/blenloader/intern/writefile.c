@@ -147,6 +147,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BKE_action.h"
 #include "BKE_blender.h"
@@ -187,6 +188,16 @@
 #define MYWRITE_BUFFER_SIZE	100000
 #define MYWRITE_MAX_CHUNK	32768
 
+/* compressed files are written as concatenated gzip members of this much
+ * uncompressed data each, which are compressed in parallel */
+#define WRITE_GZIP_CHUNK_SIZE	(1 << 22)
+
+typedef struct WriteGzipChunk {
+	unsigned char *in, *out;
+	unsigned int in_len, out_len, out_size;
+	int error;
+} WriteGzipChunk;
+
 typedef struct {
 	struct SDNA *sdna;
 
@@ -196,6 +207,11 @@ typedef struct {
 	
 	int tot, count, error, memsize;
 
+	/* compressed writing, chunks are filled in order and compressed
+	 * together once they are all full */
+	WriteGzipChunk *gzip_chunks;
+	int gzip_tot, gzip_used;
+
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	char use_mesh_compat; /* option to save with older mesh format */
 #endif
@@ -220,6 +236,94 @@ static WriteData *writedata_new(int file)
 	return wd;
 }
 
+static void writedata_gzip_init(WriteData *wd)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	/* compressBound covers the zlib wrapper, the gzip one is a few bytes larger */
+	unsigned int out_size = (unsigned int)compressBound(WRITE_GZIP_CHUNK_SIZE) + 32;
+	int i;
+
+	wd->gzip_tot = 2 * BLI_task_scheduler_num_threads(task_scheduler);
+	wd->gzip_chunks = MEM_callocN(sizeof(*wd->gzip_chunks) * wd->gzip_tot, "gzip_chunks");
+
+	for (i = 0; i < wd->gzip_tot; i++) {
+		WriteGzipChunk *chunk = &wd->gzip_chunks[i];
+
+		chunk->in = MEM_mallocN(WRITE_GZIP_CHUNK_SIZE, "gzip_chunk_in");
+		chunk->out = MEM_mallocN(out_size, "gzip_chunk_out");
+		chunk->out_size = out_size;
+	}
+}
+
+static void writedata_gzip_compress_range(void *userdata, int start, int stop)
+{
+	WriteData *wd = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		WriteGzipChunk *chunk = &wd->gzip_chunks[i];
+		z_stream strm = {NULL};
+
+		/* level 1 is very close to 3 (the default) in terms of file size,
+		 * but about twice as fast, best use for speedy saving - campbell */
+		if (deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			chunk->error = 1;
+			continue;
+		}
+
+		strm.next_in = chunk->in;
+		strm.avail_in = chunk->in_len;
+		strm.next_out = chunk->out;
+		strm.avail_out = chunk->out_size;
+
+		if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+			chunk->error = 1;
+
+		chunk->out_len = chunk->out_size - strm.avail_out;
+		deflateEnd(&strm);
+	}
+}
+
+/* compress and write all chunks that have data */
+static void writedata_gzip_flush(WriteData *wd)
+{
+	int i, totchunk = wd->gzip_used;
+
+	if (totchunk < wd->gzip_tot && wd->gzip_chunks[totchunk].in_len)
+		totchunk++;
+
+	BLI_task_parallel_range_ex(0, totchunk, wd, writedata_gzip_compress_range, 2);
+
+	for (i = 0; i < totchunk; i++) {
+		WriteGzipChunk *chunk = &wd->gzip_chunks[i];
+
+		if (chunk->error || write(wd->file, chunk->out, chunk->out_len) != chunk->out_len)
+			wd->error = 1;
+
+		chunk->in_len = 0;
+	}
+
+	wd->gzip_used = 0;
+}
+
+static void writedata_gzip_write(WriteData *wd, const unsigned char *mem, unsigned int memlen)
+{
+	while (memlen) {
+		WriteGzipChunk *chunk = &wd->gzip_chunks[wd->gzip_used];
+		unsigned int len = MIN2(memlen, WRITE_GZIP_CHUNK_SIZE - chunk->in_len);
+
+		memcpy(chunk->in + chunk->in_len, mem, len);
+		chunk->in_len += len;
+		mem += len;
+		memlen -= len;
+
+		if (chunk->in_len == WRITE_GZIP_CHUNK_SIZE) {
+			if (++wd->gzip_used == wd->gzip_tot)
+				writedata_gzip_flush(wd);
+		}
+	}
+}
+
 static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 {
 	if ((wd == NULL) || wd->error || (mem == NULL) || memlen < 1) return;
@@ -229,6 +333,9 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 	if (wd->current) {
 		add_memfilechunk(NULL, wd->current, mem, memlen);
 	}
+	else if (wd->gzip_chunks) {
+		writedata_gzip_write(wd, mem, (unsigned int)memlen);
+	}
 	else {
 		if (write(wd->file, mem, memlen) != memlen)
 			wd->error= 1;
@@ -238,6 +345,16 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 
 static void writedata_free(WriteData *wd)
 {
+	if (wd->gzip_chunks) {
+		int i;
+
+		for (i = 0; i < wd->gzip_tot; i++) {
+			MEM_freeN(wd->gzip_chunks[i].in);
+			MEM_freeN(wd->gzip_chunks[i].out);
+		}
+		MEM_freeN(wd->gzip_chunks);
+	}
+
 	DNA_sdna_free(wd->sdna);
 
 	MEM_freeN(wd->buf);
@@ -334,6 +451,15 @@ static int endwrite(WriteData *wd)
 		writedata_do_write(wd, wd->buf, wd->count);
 		wd->count= 0;
 	}
+
+	if (wd->gzip_chunks && !wd->error) {
+		writedata_gzip_flush(wd);
+	}
+
+	/* this ends comparing */
+	if (wd->current) {
+		add_memfilechunk(NULL, NULL, NULL, 0);
+	}
 	
 	err= wd->error;
 	writedata_free(wd);
@@ -366,6 +492,11 @@ static void writestruct_at_address(WriteData *wd, int filecode, const char *stru
 
 	if (bh.len==0) return;
 
+	/* undo: start each datablock in a new chunk, so unchanged datablocks
+	 * are written as chunks identical to the previous undo step */
+	if (wd->current && filecode != DATA)
+		mywrite(wd, MYWRITE_FLUSH, 0);
+
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, data, bh.len);
 }
@@ -1532,6 +1663,8 @@ static void write_objects(WriteData *wd, ListBase *idbase)
 
 			write_particlesystems(wd, &ob->particlesystem);
 			write_modifiers(wd, &ob->modifiers);
+
+			writelist(wd, DATA, "LodLevel", &ob->lodlevels);
 		}
 		ob= ob->id.next;
 	}
@@ -3320,6 +3453,10 @@ static int write_file_handle(Main *mainvar, int handle, MemFile *compare, MemFil
 
 	wd= bgnwrite(handle, compare, current);
 
+	if (!current && (write_flags & G_FILE_COMPRESS)) {
+		writedata_gzip_init(wd);
+	}
+
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	wd->use_mesh_compat = (write_flags & G_FILE_MESH_COMPAT) != 0;
 #endif
@@ -3518,34 +3655,9 @@ int BLO_write_file(Main *mainvar, const char *filepath, int write_flags, ReportL
 		}
 	}
 
-	if (write_flags & G_FILE_COMPRESS) {
-		/* compressed files have the same ending as regular files... only from 2.4!!! */
-		char gzname[FILE_MAX+4];
-		int ret;
-
-		/* first write compressed to separate @.gz */
-		BLI_snprintf(gzname, sizeof(gzname), "%s@.gz", filepath);
-		ret = BLI_file_gzip(tempname, gzname);
-		
-		if (0==ret) {
-			/* now rename to real file name, and delete temp @ file too */
-			if (BLI_rename(gzname, filepath) != 0) {
-				BKE_report(reports, RPT_ERROR, "Cannot change old file (file saved with @)");
-				return 0;
-			}
-
-			BLI_delete(tempname, false, false);
-		}
-		else if (-1==ret) {
-			BKE_report(reports, RPT_ERROR, "Failed opening .gz file");
-			return 0;
-		}
-		else if (-2==ret) {
-			BKE_report(reports, RPT_ERROR, "Failed opening .blend file for compression");
-			return 0;
-		}
-	}
-	else if (BLI_rename(tempname, filepath) != 0) {
+	/* compressed files were compressed while writing, and have the same
+	 * ending as regular files... only from 2.4!!! */
+	if (BLI_rename(tempname, filepath) != 0) {
 		BKE_report(reports, RPT_ERROR, "Cannot change old file (file saved with @)");
 		return 0;
 	}
@@ -32,7 +32,9 @@
 #include "DNA_object_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_array.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cdderivedmesh.h"
@@ -271,106 +273,215 @@ void BM_mesh_free(BMesh *bm)
 	MEM_freeN(bm);
 }
 
+typedef struct BMNormalsData {
+	BMesh *bm;
+	float (*edgevec)[3];
+} BMNormalsData;
+
+static void bm_mesh_normals_faces_range(void *userdata, int start, int stop)
+{
+	BMNormalsData *data = userdata;
+	BMFace **ftable = data->bm->ftable;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BM_face_normal_update(ftable[i]);
+	}
+}
+
+static void bm_mesh_normals_edges_range(void *userdata, int start, int stop)
+{
+	BMNormalsData *data = userdata;
+	BMEdge **etable = data->bm->etable;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BMEdge *e = etable[i];
+		if (e->l) {
+			sub_v3_v3v3(data->edgevec[i], e->v2->co, e->v1->co);
+			normalize_v3(data->edgevec[i]);
+		}
+		else {
+			/* the edge vector will not be needed when the edge has no radial */
+		}
+	}
+}
+
+static void bm_mesh_normals_verts_range(void *userdata, int start, int stop)
+{
+	BMNormalsData *data = userdata;
+	BMVert **vtable = data->bm->vtable;
+	const float (*edgevec)[3] = (const float (*)[3])data->edgevec;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BMVert *v = vtable[i];
+		BMIter liter;
+		BMLoop *l;
+
+		zero_v3(v->no);
+
+		/* add weighted face normals, gathering from the loops of this vertex
+		 * means no other thread writes into its normal */
+		BM_ITER_ELEM (l, &liter, v, BM_LOOPS_OF_VERT) {
+			const float *e1diff, *e2diff;
+			float dotprod;
+			float fac;
+
+			/* calculate the dot product of the two edges that
+			 * meet at the loop's vertex */
+			e1diff = edgevec[BM_elem_index_get(l->prev->e)];
+			e2diff = edgevec[BM_elem_index_get(l->e)];
+			dotprod = dot_v3v3(e1diff, e2diff);
+
+			/* edge vectors are calculated from e->v1 to e->v2, so
+			 * adjust the dot product if one but not both loops
+			 * actually runs from from e->v2 to e->v1 */
+			if ((l->prev->e->v1 == l->prev->v) ^ (l->e->v1 == l->v)) {
+				dotprod = -dotprod;
+			}
+
+			fac = saacos(-dotprod);
+
+			/* accumulate weighted face normal into the vertex's normal */
+			madd_v3_v3fl(v->no, l->f->no, fac);
+		}
+
+		/* normalize the accumulated vertex normal */
+		if (UNLIKELY(normalize_v3(v->no) == 0.0f)) {
+			normalize_v3_v3(v->no, v->co);
+		}
+	}
+}
+
 /**
  * \brief BMesh Compute Normals
  *
  * Updates the normals of a mesh.
+ *
+ * Each pass walks an element table, so it runs over stable indices and splits
+ * into ranges for threading. Vertex normals are gathered per vertex
+ * instead of scattered per face loop to avoid write conflicts.
  */
 void BM_mesh_normals_update(BMesh *bm)
 {
-	float (*edgevec)[3] = MEM_mallocN(sizeof(*edgevec) * bm->totedge, __func__);
+	BMNormalsData data;
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-#pragma omp section
-		{
-			/* calculate all face normals */
-			BMIter fiter;
-			BMFace *f;
+	data.bm = bm;
+	data.edgevec = MEM_mallocN(sizeof(*data.edgevec) * bm->totedge, __func__);
 
-			BM_ITER_MESH (f, &fiter, bm, BM_FACES_OF_MESH) {
-				BM_face_normal_update(f);
-			}
-		}
-#pragma omp section
-		{
-			/* Zero out vertex normals */
-			BMIter viter;
-			BMVert *v;
-			BM_ITER_MESH (v, &viter, bm, BM_VERTS_OF_MESH) {
-				zero_v3(v->no);
-			}
-		}
-#pragma omp section
-		{
-			/* compute normalized direction vectors for each edge. directions will be
-			 * used below for calculating the weights of the face normals on the vertex
-			 * normals */
-			BMIter eiter;
-			BMEdge *e;
-			int index;
-			BM_ITER_MESH_INDEX (e, &eiter, bm, BM_EDGES_OF_MESH, index) {
-				BM_elem_index_set(e, index); /* set_inline */
-
-				if (e->l) {
-					sub_v3_v3v3(edgevec[index], e->v2->co, e->v1->co);
-					normalize_v3(edgevec[index]);
-				}
-				else {
-					/* the edge vector will not be needed when the edge has no radial */
-				}
-			}
-			bm->elem_index_dirty &= ~BM_EDGE;
-		}
+	BM_mesh_elem_index_ensure(bm, BM_EDGE);
+	BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+	/* calculate all face normals */
+	BLI_task_parallel_range_ex(0, bm->totface, &data, bm_mesh_normals_faces_range, BM_OMP_LIMIT);
+
+	/* compute normalized direction vectors for each edge. directions will be
+	 * used below for calculating the weights of the face normals on the vertex
+	 * normals */
+	BLI_task_parallel_range_ex(0, bm->totedge, &data, bm_mesh_normals_edges_range, BM_OMP_LIMIT);
+
+	/* needs both of the above */
+	BLI_task_parallel_range_ex(0, bm->totvert, &data, bm_mesh_normals_verts_range, BM_OMP_LIMIT);
+
+	MEM_freeN(data.edgevec);
+}
+
+/* same weighting as bm_mesh_normals_verts_range, from the vertex coordinates directly */
+static void bm_vert_normal_update_from_faces(BMVert *v)
+{
+	BMIter liter;
+	BMLoop *l;
+
+	zero_v3(v->no);
+
+	BM_ITER_ELEM (l, &liter, v, BM_LOOPS_OF_VERT) {
+		float e1diff[3], e2diff[3];
+		float fac;
+
+		/* the angle between the two edges that meet at the loop's vertex */
+		sub_v3_v3v3(e1diff, l->prev->v->co, v->co);
+		sub_v3_v3v3(e2diff, l->next->v->co, v->co);
+		normalize_v3(e1diff);
+		normalize_v3(e2diff);
+		fac = saacos(dot_v3v3(e1diff, e2diff));
+
+		madd_v3_v3fl(v->no, l->f->no, fac);
 	}
-	/* end omp */
 
+	if (UNLIKELY(normalize_v3(v->no) == 0.0f)) {
+		normalize_v3_v3(v->no, v->co);
+	}
+}
 
-	/* add weighted face normals to vertices */
-	{
+/**
+ * \brief BMesh Compute Normals, Partial
+ *
+ * For when only the coordinates of \a verts changed, updates the normals of the faces
+ * using them and of all vertices of those faces.
+ * The cost depends on the size of the moved region, not on the size of the mesh.
+ *
+ * \param r_faces: Optional, the faces whose normals were updated, the caller frees the array.
+ */
+void BM_mesh_normals_update_verts(BMesh *UNUSED(bm), BMVert **verts, const int verts_len,
+                                  BMFace ***r_faces, int *r_faces_len)
+{
+	BMFace **faces = NULL;
+	BMVert **verts_update = NULL;
+	BLI_array_declare(faces);
+	BLI_array_declare(verts_update);
+	int i;
+
+	for (i = 0; i < verts_len; i++) {
+		BMVert *v = verts[i];
 		BMIter fiter;
 		BMFace *f;
-		BM_ITER_MESH (f, &fiter, bm, BM_FACES_OF_MESH) {
-			BMLoop *l_first, *l_iter;
-			l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-			do {
-				const float *e1diff, *e2diff;
-				float dotprod;
-				float fac;
-
-				/* calculate the dot product of the two edges that
-				 * meet at the loop's vertex */
-				e1diff = edgevec[BM_elem_index_get(l_iter->prev->e)];
-				e2diff = edgevec[BM_elem_index_get(l_iter->e)];
-				dotprod = dot_v3v3(e1diff, e2diff);
-
-				/* edge vectors are calculated from e->v1 to e->v2, so
-				 * adjust the dot product if one but not both loops
-				 * actually runs from from e->v2 to e->v1 */
-				if ((l_iter->prev->e->v1 == l_iter->prev->v) ^ (l_iter->e->v1 == l_iter->v)) {
-					dotprod = -dotprod;
-				}
 
-				fac = saacos(-dotprod);
+		/* also for loose verts, which have no faces to find them */
+		if (!BM_ELEM_API_FLAG_TEST(v, _FLAG_NORMALS)) {
+			BM_ELEM_API_FLAG_ENABLE(v, _FLAG_NORMALS);
+			BLI_array_append(verts_update, v);
+		}
 
-				/* accumulate weighted face normal into the vertex's normal */
-				madd_v3_v3fl(l_iter->v->no, f->no, fac);
-			} while ((l_iter = l_iter->next) != l_first);
+		BM_ITER_ELEM (f, &fiter, v, BM_FACES_OF_VERT) {
+			if (!BM_ELEM_API_FLAG_TEST(f, _FLAG_NORMALS)) {
+				BM_ELEM_API_FLAG_ENABLE(f, _FLAG_NORMALS);
+				BLI_array_append(faces, f);
+			}
 		}
-		MEM_freeN(edgevec);
 	}
 
+	/* vertex normals use the normals of all surrounding faces */
+	for (i = 0; i < BLI_array_count(faces); i++) {
+		BMFace *f = faces[i];
+		BMLoop *l_iter, *l_first;
 
-	/* normalize the accumulated vertex normals */
-	{
-		BMIter viter;
-		BMVert *v;
+		BM_face_normal_update(f);
+		BM_ELEM_API_FLAG_DISABLE(f, _FLAG_NORMALS);
 
-		BM_ITER_MESH (v, &viter, bm, BM_VERTS_OF_MESH) {
-			if (UNLIKELY(normalize_v3(v->no) == 0.0f)) {
-				normalize_v3_v3(v->no, v->co);
+		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+		do {
+			if (!BM_ELEM_API_FLAG_TEST(l_iter->v, _FLAG_NORMALS)) {
+				BM_ELEM_API_FLAG_ENABLE(l_iter->v, _FLAG_NORMALS);
+				BLI_array_append(verts_update, l_iter->v);
 			}
-		}
+		} while ((l_iter = l_iter->next) != l_first);
+	}
+
+	for (i = 0; i < BLI_array_count(verts_update); i++) {
+		BMVert *v = verts_update[i];
+		bm_vert_normal_update_from_faces(v);
+		BM_ELEM_API_FLAG_DISABLE(v, _FLAG_NORMALS);
+	}
+
+	BLI_array_free(verts_update);
+
+	if (r_faces) {
+		*r_faces = faces;
+		*r_faces_len = BLI_array_count(faces);
+	}
+	else {
+		BLI_array_free(faces);
 	}
 }
 
@@ -38,6 +38,8 @@ void   BM_mesh_data_free(BMesh *bm);
 void   BM_mesh_clear(BMesh *bm);
 
 void BM_mesh_normals_update(BMesh *bm);
+void BM_mesh_normals_update_verts(BMesh *bm, BMVert **verts, const int verts_len,
+                                  BMFace ***r_faces, int *r_faces_len);
 
 void bmesh_edit_begin(BMesh *bm, const BMOpTypeFlag type_flag);
 void bmesh_edit_end(BMesh *bm, const BMOpTypeFlag type_flag);
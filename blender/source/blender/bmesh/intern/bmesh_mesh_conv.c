@@ -86,6 +86,7 @@
 #include "BLI_listbase.h"
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_mesh.h"
 #include "BKE_customdata.h"
@@ -216,6 +217,114 @@ static BMFace *bm_face_create_from_mpoly(MPoly *mp, MLoop *ml,
 }
 
 
+/**
+ * Elements are created in order on a single thread (they share the mempools and
+ * the disk/radial cycles), their custom-data blocks are allocated there too.
+ * Filling in per element data only touches the element itself,
+ * so that runs in parallel afterwards.
+ */
+typedef struct BMFromMeData {
+	BMesh *bm;
+	Mesh *me;
+	BMVert **vtable;
+	BMEdge **etable;
+	BMFace **ftable;  /* NULL for skipped faces */
+
+	int cd_vert_bweight_offset;
+	int cd_edge_bweight_offset;
+	int cd_edge_crease_offset;
+	int cd_shape_keyindex_offset;
+
+	/* shape key layers, in key-block order */
+	int *shape_offsets;
+	float **shape_coords;
+	int shape_tot;
+
+	bool calc_face_normal;
+} BMFromMeData;
+
+static void bm_from_me_verts_range(void *userdata, int start, int stop)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i, j;
+
+	for (i = start; i < stop; i++) {
+		BMVert *v = data->vtable[i];
+		const MVert *mvert = &me->mvert[i];
+
+		normal_short_to_float_v3(v->no, mvert->no);
+
+		/* Copy Custom Data */
+		CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+
+		if (data->cd_vert_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+
+		/* set shape key original index */
+		if (data->cd_shape_keyindex_offset != -1) {
+			*((int *)BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_keyindex_offset)) = i;
+		}
+
+		/* set shapekey data */
+		for (j = 0; j < data->shape_tot; j++) {
+			if (data->shape_offsets[j] != -1) {
+				copy_v3_v3(BM_ELEM_CD_GET_VOID_P(v, data->shape_offsets[j]), data->shape_coords[j] + 3 * i);
+			}
+		}
+	}
+}
+
+static void bm_from_me_edges_range(void *userdata, int start, int stop)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BMEdge *e = data->etable[i];
+		const MEdge *medge = &me->medge[i];
+
+		/* Copy Custom Data */
+		CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+
+		if (data->cd_edge_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+		if (data->cd_edge_crease_offset  != -1) BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset,  (float)medge->crease  / 255.0f);
+	}
+}
+
+static void bm_from_me_faces_range(void *userdata, int start, int stop)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i, j;
+
+	for (i = start; i < stop; i++) {
+		BMFace *f = data->ftable[i];
+		BMLoop *l_iter, *l_first;
+
+		if (f == NULL) {
+			continue;
+		}
+
+		j = me->mpoly[i].loopstart;
+		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+		do {
+			/* Save index of correspsonding MLoop */
+			CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+		} while ((l_iter = l_iter->next) != l_first);
+
+		/* Copy Custom Data */
+		CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+		if (data->calc_face_normal) {
+			BM_face_normal_update(f);
+		}
+	}
+}
+
 /**
  * \brief Mesh -> BMesh
  *
@@ -231,15 +340,11 @@ void BM_mesh_bm_from_me(BMesh *bm, Mesh *me,
 	KeyBlock *actkey, *block;
 	BMVert *v, **vtable = NULL;
 	BMEdge *e, **etable = NULL;
-	BMFace *f;
+	BMFace *f, **ftable = NULL;
 	float (*keyco)[3] = NULL;
-	int *keyi;
+	BMFromMeData data = {NULL};
 	int totuv, i, j;
 
-	int cd_vert_bweight_offset;
-	int cd_edge_bweight_offset;
-	int cd_edge_crease_offset;
-
 	/* free custom data */
 	/* this isnt needed in most cases but do just incase */
 	CustomData_free(&bm->vdata, bm->totvert);
@@ -322,9 +427,25 @@ void BM_mesh_bm_from_me(BMesh *bm, Mesh *me,
 
 	BM_mesh_cd_flag_apply(bm, me->cd_flag);
 
-	cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-	cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-	cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
+	data.bm = bm;
+	data.me = me;
+	data.calc_face_normal = calc_face_normal;
+
+	data.cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+	data.cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
+	data.cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
+	data.cd_shape_keyindex_offset = -1;
+
+	if (me->key) {
+		data.cd_shape_keyindex_offset = CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX);
+		data.shape_tot = BLI_countlist(&me->key->block);
+		data.shape_offsets = MEM_mallocN(sizeof(*data.shape_offsets) * (size_t)data.shape_tot, __func__);
+		data.shape_coords = MEM_mallocN(sizeof(*data.shape_coords) * (size_t)data.shape_tot, __func__);
+		for (j = 0, block = me->key->block.first; block; block = block->next, j++) {
+			data.shape_offsets[j] = CustomData_get_n_offset(&bm->vdata, CD_SHAPEKEY, j);
+			data.shape_coords[j] = block->data;
+		}
+	}
 
 	for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
 		v = vtable[i] = BM_vert_create(bm, keyco && set_key ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
@@ -338,33 +459,20 @@ void BM_mesh_bm_from_me(BMesh *bm, Mesh *me,
 			BM_vert_select_set(bm, v, true);
 		}
 
-		normal_short_to_float_v3(v->no, mvert->no);
-
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-		if (cd_vert_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+		/* filled in by bm_from_me_verts_range */
+		CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
+	}
 
-		/* set shapekey data */
-		if (me->key) {
-			/* set shape key original index */
-			keyi = CustomData_bmesh_get(&bm->vdata, v->head.data, CD_SHAPE_KEYINDEX);
-			if (keyi) {
-				*keyi = i;
-			}
+	bm->elem_index_dirty &= ~BM_VERT; /* added in order, clear dirty flag */
 
-			for (block = me->key->block.first, j = 0; block; block = block->next, j++) {
-				float *co = CustomData_bmesh_get_n(&bm->vdata, v->head.data, CD_SHAPEKEY, j);
+	data.vtable = vtable;
+	BLI_task_parallel_range_ex(0, me->totvert, &data, bm_from_me_verts_range, BM_OMP_LIMIT);
 
-				if (co) {
-					copy_v3_v3(co, ((float *)block->data) + 3 * i);
-				}
-			}
-		}
+	if (data.shape_offsets) {
+		MEM_freeN(data.shape_offsets);
+		MEM_freeN(data.shape_coords);
 	}
 
-	bm->elem_index_dirty &= ~BM_VERT; /* added in order, clear dirty flag */
-
 	if (!me->totedge) {
 		MEM_freeN(vtable);
 		return;
@@ -385,24 +493,25 @@ void BM_mesh_bm_from_me(BMesh *bm, Mesh *me,
 			BM_edge_select_set(bm, e, true);
 		}
 
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-		if (cd_edge_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-		if (cd_edge_crease_offset  != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset,  (float)medge->crease  / 255.0f);
-
+		/* filled in by bm_from_me_edges_range */
+		CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
 	}
 
 	bm->elem_index_dirty &= ~BM_EDGE; /* added in order, clear dirty flag */
 
+	data.etable = etable;
+	BLI_task_parallel_range_ex(0, me->totedge, &data, bm_from_me_edges_range, BM_OMP_LIMIT);
+
+	ftable = MEM_mallocN(sizeof(*ftable) * (size_t)me->totpoly, "mesh to bmesh ftable");
+
 	mloop = me->mloop;
 	mp = me->mpoly;
 	for (i = 0; i < me->totpoly; i++, mp++) {
 		BMLoop *l_iter;
 		BMLoop *l_first;
 
-		f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart,
-		                              bm, vtable, etable);
+		f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart,
+		                                          bm, vtable, etable);
 
 		if (UNLIKELY(f == NULL)) {
 			printf("%s: Warning! Bad face in mesh"
@@ -425,23 +534,22 @@ void BM_mesh_bm_from_me(BMesh *bm, Mesh *me,
 		f->mat_nr = mp->mat_nr;
 		if (i == me->act_face) bm->act_face = f;
 
-		j = mp->loopstart;
+		/* filled in by bm_from_me_faces_range */
 		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
 		do {
-			/* Save index of correspsonding MLoop */
-			CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+			CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
 		} while ((l_iter = l_iter->next) != l_first);
 
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-		if (calc_face_normal) {
-			BM_face_normal_update(f);
-		}
+		CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
 	}
 
 	bm->elem_index_dirty &= ~BM_FACE; /* added in order, clear dirty flag */
 
+	data.ftable = ftable;
+	BLI_task_parallel_range_ex(0, me->totpoly, &data, bm_from_me_faces_range, BM_OMP_LIMIT);
+
+	MEM_freeN(ftable);
+
 	if (me->mselect && me->totselect != 0) {
 
 		BMVert **vert_array = MEM_mallocN(sizeof(BMVert *) * bm->totvert, "VSelConv");
@@ -575,21 +683,128 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
 	}
 }
 
+/**
+ * Element indices and tables are ensured up front,
+ * each pass then only writes the mesh elements at its own indices.
+ */
+typedef struct BMToMeData {
+	BMesh *bm;
+	Mesh *me;
+
+	int cd_vert_bweight_offset;
+	int cd_edge_bweight_offset;
+	int cd_edge_crease_offset;
+} BMToMeData;
+
+static void bm_to_me_verts_range(void *userdata, int start, int stop)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BMVert *v = bm->vtable[i];
+		MVert *mvert = &me->mvert[i];
+
+		copy_v3_v3(mvert->co, v->co);
+		normal_float_to_short_v3(mvert->no, v->no);
+
+		mvert->flag = BM_vert_flag_to_mflag(v);
+
+		/* copy over customdat */
+		CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+
+		if (data->cd_vert_bweight_offset != -1) mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+
+		BM_CHECK_ELEMENT(v);
+	}
+}
+
+static void bm_to_me_edges_range(void *userdata, int start, int stop)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		BMEdge *e = bm->etable[i];
+		MEdge *med = &me->medge[i];
+
+		med->v1 = BM_elem_index_get(e->v1);
+		med->v2 = BM_elem_index_get(e->v2);
+
+		med->flag = BM_edge_flag_to_mflag(e);
+
+		/* copy over customdata */
+		CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+
+		bmesh_quick_edgedraw_flag(med, e);
+
+		if (data->cd_edge_crease_offset  != -1) med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+		if (data->cd_edge_bweight_offset != -1) med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+
+		BM_CHECK_ELEMENT(e);
+	}
+}
+
+/* expects MPoly.loopstart and MPoly.totloop to be set */
+static void bm_to_me_faces_range(void *userdata, int start, int stop)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	int i, j;
+
+	for (i = start; i < stop; i++) {
+		BMFace *f = bm->ftable[i];
+		MPoly *mpoly = &me->mpoly[i];
+		MLoop *mloop = &me->mloop[mpoly->loopstart];
+		BMLoop *l_iter, *l_first;
+
+		mpoly->mat_nr = f->mat_nr;
+		mpoly->flag = BM_face_flag_to_mflag(f);
+
+		j = mpoly->loopstart;
+		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+		do {
+			mloop->e = BM_elem_index_get(l_iter->e);
+			mloop->v = BM_elem_index_get(l_iter->v);
+
+			/* copy over customdata */
+			CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+			j++;
+			mloop++;
+			BM_CHECK_ELEMENT(l_iter);
+			BM_CHECK_ELEMENT(l_iter->e);
+			BM_CHECK_ELEMENT(l_iter->v);
+		} while ((l_iter = l_iter->next) != l_first);
+
+		/* copy over customdata */
+		CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
+
+		BM_CHECK_ELEMENT(f);
+	}
+}
+
 void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 {
 	MLoop *mloop;
 	MPoly *mpoly;
 	MVert *mvert, *oldverts;
-	MEdge *med, *medge;
-	BMVert *v, *eve;
-	BMEdge *e;
-	BMFace *f;
+	MEdge *medge;
+	BMVert *eve;
 	BMIter iter;
+	BMToMeData data;
 	int i, j, ototvert;
 
-	const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-	const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-	const int cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
+	data.bm = bm;
+	data.me = me;
+	data.cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+	data.cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
+	data.cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
 
 	ototvert = me->totvert;
 
@@ -650,85 +865,24 @@ void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 	/* this is called again, 'dotess' arg is used there */
 	BKE_mesh_update_customdata_pointers(me, 0);
 
-	i = 0;
-	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-		copy_v3_v3(mvert->co, v->co);
-		normal_float_to_short_v3(mvert->no, v->no);
-
-		mvert->flag = BM_vert_flag_to_mflag(v);
-
-		BM_elem_index_set(v, i); /* set_inline */
-
-		/* copy over customdat */
-		CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-		if (cd_vert_bweight_offset != -1) mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-
-		i++;
-		mvert++;
-
-		BM_CHECK_ELEMENT(v);
-	}
-	bm->elem_index_dirty &= ~BM_VERT;
-
-	med = medge;
-	i = 0;
-	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-		med->v1 = BM_elem_index_get(e->v1);
-		med->v2 = BM_elem_index_get(e->v2);
-
-		med->flag = BM_edge_flag_to_mflag(e);
-
-		BM_elem_index_set(e, i); /* set_inline */
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-		bmesh_quick_edgedraw_flag(med, e);
+	/* vertex indices are needed for edges and loops, the passes below run in index order */
+	BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+	BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
-		if (cd_edge_crease_offset  != -1) med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-		if (cd_edge_bweight_offset != -1) med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
+	BLI_task_parallel_range_ex(0, bm->totvert, &data, bm_to_me_verts_range, BM_OMP_LIMIT);
+	BLI_task_parallel_range_ex(0, bm->totedge, &data, bm_to_me_edges_range, BM_OMP_LIMIT);
 
-		i++;
-		med++;
-		BM_CHECK_ELEMENT(e);
-	}
-	bm->elem_index_dirty &= ~BM_EDGE;
-
-	i = 0;
-	j = 0;
-	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-		BMLoop *l_iter, *l_first;
+	for (i = 0, j = 0; i < bm->totface; i++, mpoly++) {
+		BMFace *f = bm->ftable[i];
 		mpoly->loopstart = j;
 		mpoly->totloop = f->len;
-		mpoly->mat_nr = f->mat_nr;
-		mpoly->flag = BM_face_flag_to_mflag(f);
-
-		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-		do {
-			mloop->e = BM_elem_index_get(l_iter->e);
-			mloop->v = BM_elem_index_get(l_iter->v);
-
-			/* copy over customdata */
-			CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-			j++;
-			mloop++;
-			BM_CHECK_ELEMENT(l_iter);
-			BM_CHECK_ELEMENT(l_iter->e);
-			BM_CHECK_ELEMENT(l_iter->v);
-		} while ((l_iter = l_iter->next) != l_first);
+		j += f->len;
 
 		if (f == bm->act_face) me->act_face = i;
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-		i++;
-		mpoly++;
-		BM_CHECK_ELEMENT(f);
 	}
 
+	BLI_task_parallel_range_ex(0, bm->totface, &data, bm_to_me_faces_range, BM_OMP_LIMIT);
+
 	/* patch hook indices and vertex parents */
 	if (ototvert > 0) {
 		Object *ob;
@@ -896,8 +1050,10 @@ void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 			int *keyi;
 			float (*ofs_pt)[3] = ofs;
 			float *newkey, *oldkey, *fp;
+			int cd_shape_offset;
 
 			j = bm_to_mesh_shape_layer_index_from_kb(bm, currkey);
+			cd_shape_offset = (j != -1) ? CustomData_get_n_offset(&bm->vdata, CD_SHAPEKEY, j) : -1;
 
 
 			fp = newkey = MEM_callocN(me->key->elemsize * bm->totvert,  "currkey->data");
@@ -920,7 +1076,7 @@ void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 				}
 				else if (j != -1) {
 					/* in most cases this runs */
-					copy_v3_v3(fp, CustomData_bmesh_get_n(&bm->vdata, eve->head.data, CD_SHAPEKEY, j));
+					copy_v3_v3(fp, BM_ELEM_CD_GET_VOID_P(eve, cd_shape_offset));
 				}
 				else if (oldkey &&
 				         (keyi = CustomData_bmesh_get(&bm->vdata, eve->head.data, CD_SHAPE_KEYINDEX)) &&
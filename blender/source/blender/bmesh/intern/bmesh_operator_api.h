@@ -402,6 +402,13 @@ void *BMO_slot_buffer_get_single(BMOpSlot *slot);
 int BMO_slot_buffer_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name);
 int BMO_slot_map_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name);
 
+/* runs func on ranges of a slot array using threads, for read-only phases of operators.
+ * func may only write to the elements in its own range (their tool flags included)
+ * or to its own index in user arrays. */
+typedef void (*BMOSlotBufferRangeFunc)(void *userdata, void **buf, int start, int stop);
+void BMO_slot_buffer_parallel_range(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name,
+                                    void *userdata, BMOSlotBufferRangeFunc func);
+
 void BMO_slot_map_insert(BMOperator *op, BMOpSlot *slot,
                          const void *element, const void *data);
 
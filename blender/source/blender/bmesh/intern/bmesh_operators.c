@@ -34,6 +34,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "BLF_translation.h"
 
@@ -652,6 +653,43 @@ int BMO_slot_buffer_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot
 	return slot->len;
 }
 
+typedef struct BMOSlotBufferRangeData {
+	void **buf;
+	void *userdata;
+	BMOSlotBufferRangeFunc func;
+} BMOSlotBufferRangeData;
+
+static void bmo_slot_buffer_range_cb(void *userdata, int start, int stop)
+{
+	BMOSlotBufferRangeData *data = userdata;
+	data->func(data->userdata, data->buf, start, stop);
+}
+
+/**
+ * Split the elements of a buffer slot in ranges and run \a func on them in parallel.
+ *
+ * Meant for the read phase of operators, typically filling an array
+ * by slot index which is applied afterwards.
+ * Small buffers run on the calling thread.
+ */
+void BMO_slot_buffer_parallel_range(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name,
+                                    void *userdata, BMOSlotBufferRangeFunc func)
+{
+	BMOpSlot *slot = BMO_slot_get(slot_args, slot_name);
+	BMOSlotBufferRangeData data;
+
+	BLI_assert(slot->slot_type == BMO_OP_SLOT_ELEMENT_BUF);
+
+	if (slot->slot_type != BMO_OP_SLOT_ELEMENT_BUF || slot->len == 0)
+		return;
+
+	data.buf = slot->data.buf;
+	data.userdata = userdata;
+	data.func = func;
+
+	BLI_task_parallel_range_ex(0, slot->len, &data, bmo_slot_buffer_range_cb, BM_OMP_LIMIT);
+}
+
 int BMO_slot_map_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name)
 {
 	BMOpSlot *slot = BMO_slot_get(slot_args, slot_name);
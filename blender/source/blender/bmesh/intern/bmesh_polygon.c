@@ -28,6 +28,8 @@
  * tessellation, etc)
  */
 
+#include "MEM_guardedalloc.h"
+
 #include "DNA_listBase.h"
 #include "DNA_modifier_types.h"
 
@@ -35,7 +37,9 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_scanfill.h"
+#include "BLI_polyfill2d.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "bmesh.h"
 #include "bmesh_tools.h"
@@ -207,62 +211,160 @@ int BM_face_calc_tessellation(const BMFace *f, BMLoop **r_loops, int (*_r_index)
 		totfilltri = 2;
 	}
 	else {
+		unsigned int (*tris)[3] = BLI_array_alloca(tris, f->len - 2);
+		float (*projverts)[2] = BLI_array_alloca(projverts, f->len);
+		float axis_mat[3][3];
 		int j;
 
-		ScanFillContext sf_ctx;
-		ScanFillVert *sf_vert, *sf_vert_last = NULL, *sf_vert_first = NULL;
-		/* ScanFillEdge *e; */ /* UNUSED */
-		ScanFillFace *sf_tri;
-
-		BLI_scanfill_begin(&sf_ctx);
+		axis_dominant_v3_to_m3(axis_mat, f->no);
 
 		j = 0;
 		l_iter = l_first;
 		do {
-			sf_vert = BLI_scanfill_vert_add(&sf_ctx, l_iter->v->co);
-			sf_vert->tmp.p = l_iter;
+			r_loops[j] = l_iter;
+			mul_v2_m3v3(projverts[j], axis_mat, l_iter->v->co);
+			j++;
+		} while ((l_iter = l_iter->next) != l_first);
 
-			if (sf_vert_last) {
-				/* e = */ BLI_scanfill_edge_add(&sf_ctx, sf_vert_last, sf_vert);
-			}
+		BLI_polyfill_calc((const float (*)[2])projverts, (unsigned int)f->len, 0, tris);
 
-			sf_vert_last = sf_vert;
-			if (sf_vert_first == NULL) {
-				sf_vert_first = sf_vert;
-			}
+		totfilltri = f->len - 2;
+		for (j = 0; j < totfilltri; j++) {
+			*r_index++ = (int)tris[j][0];
+			*r_index++ = (int)tris[j][1];
+			*r_index++ = (int)tris[j][2];
+		}
+	}
 
-			r_loops[j] = l_iter;
+	return totfilltri;
+}
 
-			/* mark order */
-			BM_elem_index_set(l_iter, j++); /* set_loop */
+/* meshes with fewer faces are tessellated on a single thread */
+#define BM_TESSELLATE_THREAD_MIN 1024
 
-		} while ((l_iter = l_iter->next) != l_first);
+/**
+ * Write the (f->len - 2) triangles of a face in the order #BM_bmesh_calc_tessellation uses.
+ *
+ * \param arena_p: only needed for ngons, created on first use and cleared before returning,
+ * the caller frees it.
+ */
+void BM_face_calc_looptris(BMFace *f, BMLoop *(*looptris)[3], MemArena **arena_p)
+{
+	BMLoop *l;
 
-		/* complete the loop */
-		BLI_scanfill_edge_add(&sf_ctx, sf_vert_first, sf_vert);
+	if (f->len == 3) {
+		BMLoop **l_ptr = looptris[0];
+		l_ptr[0] = l = BM_FACE_FIRST_LOOP(f);
+		l_ptr[1] = l = l->next;
+		l_ptr[2] = l->next;
+	}
+	else if (f->len == 4) {
+		BMLoop **l_ptr_a = looptris[0];
+		BMLoop **l_ptr_b = looptris[1];
+		(l_ptr_a[0] = l_ptr_b[0] = l = BM_FACE_FIRST_LOOP(f));
+		(l_ptr_a[1]              = l = l->next);
+		(l_ptr_a[2] = l_ptr_b[1] = l = l->next);
+		(             l_ptr_b[2] = l->next);
+	}
+	else {
+		MemArena *arena = *arena_p;
+		const unsigned int len = (unsigned int)f->len;
+		BMLoop **l_arr;
+		float (*projverts)[2];
+		unsigned int (*tris)[3];
+		float axis_mat[3][3];
+		BMLoop *l_first;
+		unsigned int j;
+
+		if (UNLIKELY(arena == NULL)) {
+			arena = *arena_p = BLI_memarena_new(BLI_POLYFILL_ARENA_SIZE, __func__);
+		}
 
-		totfilltri = BLI_scanfill_calc_ex(&sf_ctx, 0, f->no);
-		BLI_assert(totfilltri <= f->len - 2);
-		BLI_assert(totfilltri == BLI_countlist(&sf_ctx.fillfacebase));
+		l_arr     = BLI_memarena_alloc(arena, (int)(sizeof(*l_arr) * len));
+		projverts = BLI_memarena_alloc(arena, (int)(sizeof(*projverts) * len));
+		tris      = BLI_memarena_alloc(arena, (int)(sizeof(*tris) * (len - 2)));
 
-		for (sf_tri = sf_ctx.fillfacebase.first; sf_tri; sf_tri = sf_tri->next) {
-			int i1 = BM_elem_index_get((BMLoop *)sf_tri->v1->tmp.p);
-			int i2 = BM_elem_index_get((BMLoop *)sf_tri->v2->tmp.p);
-			int i3 = BM_elem_index_get((BMLoop *)sf_tri->v3->tmp.p);
+		axis_dominant_v3_to_m3(axis_mat, f->no);
+
+		j = 0;
+		l = l_first = BM_FACE_FIRST_LOOP(f);
+		do {
+			l_arr[j] = l;
+			mul_v2_m3v3(projverts[j], axis_mat, l->v->co);
+			j++;
+		} while ((l = l->next) != l_first);
+
+		BLI_polyfill_calc_arena((const float (*)[2])projverts, len, 0, tris, arena);
+
+		for (j = 0; j < len - 2; j++) {
+			BMLoop **l_ptr = looptris[j];
+			l_ptr[0] = l_arr[tris[j][0]];
+			l_ptr[1] = l_arr[tris[j][1]];
+			l_ptr[2] = l_arr[tris[j][2]];
+		}
 
-			if (i1 > i2) { SWAP(int, i1, i2); }
-			if (i2 > i3) { SWAP(int, i2, i3); }
-			if (i1 > i2) { SWAP(int, i1, i2); }
+		BLI_memarena_clear(arena);
+	}
+}
+
+typedef struct BMTessellateData {
+	BMFace **ftable;
+	const int *tri_offsets;
+	BMLoop *(*looptris)[3];
+} BMTessellateData;
+
+static void bm_mesh_calc_tessellation_range(void *userdata, int start, int stop)
+{
+	BMTessellateData *data = userdata;
+	MemArena *arena = NULL;
+	int i;
 
-			*r_index++ = i1;
-			*r_index++ = i2;
-			*r_index++ = i3;
+	for (i = start; i < stop; i++) {
+		BMFace *f = data->ftable[i];
+		/* don't consider two-edged faces */
+		if (LIKELY(f->len >= 3)) {
+			BM_face_calc_looptris(f, &data->looptris[data->tri_offsets[i]], &arena);
 		}
+	}
 
-		BLI_scanfill_end(&sf_ctx);
+	if (arena) {
+		BLI_memarena_free(arena);
 	}
+}
 
-	return totfilltri;
+/**
+ * Tessellate all faces of the mesh into \a looptris, which needs room for
+ * poly_to_tri_count(bm->totface, bm->totloop) triangles.
+ * Triangles are in face order, large meshes are tessellated in parallel.
+ *
+ * \note Ensures the face table, face normals are used to project ngons.
+ */
+void BM_bmesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot)
+{
+	BMTessellateData data;
+	int *tri_offsets;
+	int i, tot = 0;
+
+	BM_mesh_elem_table_ensure(bm, BM_FACE);
+
+	tri_offsets = MEM_mallocN(sizeof(*tri_offsets) * (size_t)bm->totface, __func__);
+	for (i = 0; i < bm->totface; i++) {
+		const int len = bm->ftable[i]->len;
+		tri_offsets[i] = tot;
+		if (LIKELY(len >= 3)) {
+			tot += len - 2;
+		}
+	}
+
+	data.ftable = bm->ftable;
+	data.tri_offsets = tri_offsets;
+	data.looptris = looptris;
+
+	BLI_task_parallel_range_ex(0, bm->totface, &data, bm_mesh_calc_tessellation_range, BM_TESSELLATE_THREAD_MIN);
+
+	MEM_freeN(tri_offsets);
+
+	*r_looptris_tot = tot;
 }
 
 /**
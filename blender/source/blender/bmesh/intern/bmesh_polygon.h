@@ -30,6 +30,8 @@
 #include "BLI_compiler_attrs.h"
 
 int   BM_face_calc_tessellation(const BMFace *f, BMLoop **r_loops, int (*r_index)[3]) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void  BM_bmesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot) ATTR_NONNULL();
+void  BM_face_calc_looptris(BMFace *f, BMLoop *(*looptris)[3], struct MemArena **arena_p) ATTR_NONNULL();
 void  BM_face_calc_normal(const BMFace *f, float r_no[3]) ATTR_NONNULL();
 void  BM_face_calc_normal_vcos(BMesh *bm, BMFace *f, float r_no[3],
                                float const (*vertexCos)[3]) ATTR_NONNULL();
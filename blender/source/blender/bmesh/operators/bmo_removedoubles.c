@@ -30,6 +30,7 @@
 
 #include "BLI_math.h"
 #include "BLI_array.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 
@@ -479,13 +480,131 @@ void bmo_collapse_uvs_exec(BMesh *bm, BMOperator *op)
 	}
 }
 
+/* matches stored per vertex by the threaded search,
+ * vertices with more matches are searched again on the main thread */
+#define DOUBLES_CANDIDATE_MAX 4
+
+typedef struct FindDoublesData {
+	BMesh *bm;
+	BMVert **verts;
+	int verts_len;
+	float dist, dist3;
+	bool keepvert;
+
+	/* indices into 'verts' of the matches following each vertex,
+	 * a length of -1 means there were too many to store */
+	int (*candidates)[DOUBLES_CANDIDATE_MAX];
+	int *candidates_len;
+} FindDoublesData;
+
+/**
+ * Compare sort values of the verts using 3x tolerance (allowing for the tolerance
+ * on each of the three axes). This avoids the more expensive length comparison
+ * for most vertex pairs.
+ *
+ * Since the verts are sorted, all following verts are out of range too.
+ */
+BLI_INLINE bool bmesh_find_doubles_out_of_range(const BMVert *v_check, const BMVert *v_other, const float dist3)
+{
+	return ((v_other->co[0] + v_other->co[1] + v_other->co[2]) -
+	        (v_check->co[0] + v_check->co[1] + v_check->co[2]) > dist3);
+}
+
+/* the part of the test which doesn't depend on matches found so far */
+BLI_INLINE bool bmesh_find_doubles_test(BMesh *bm, const BMVert *v_check, const BMVert *v_other,
+                                        const float dist, const bool keepvert)
+{
+	if (keepvert) {
+		if (BMO_elem_flag_test(bm, v_other, VERT_KEEP) == BMO_elem_flag_test(bm, v_check, VERT_KEEP))
+			return false;
+	}
+
+	return compare_len_v3v3(v_check->co, v_other->co, dist);
+}
+
+/* read-only, runs in parallel before any vertex is flagged as double or target */
+static void bmesh_find_doubles_candidates_range(void *userdata, int start, int stop)
+{
+	FindDoublesData *data = userdata;
+	int i, j;
+
+	for (i = start; i < stop; i++) {
+		const BMVert *v_check = data->verts[i];
+		int *candidates = data->candidates[i];
+		int len = 0;
+
+		for (j = i + 1; j < data->verts_len; j++) {
+			const BMVert *v_other = data->verts[j];
+
+			if (bmesh_find_doubles_out_of_range(v_check, v_other, data->dist3)) {
+				break;
+			}
+
+			if (bmesh_find_doubles_test(data->bm, v_check, v_other, data->dist, data->keepvert)) {
+				if (len == DOUBLES_CANDIDATE_MAX) {
+					len = -1;
+					break;
+				}
+				candidates[len++] = j;
+			}
+		}
+
+		data->candidates_len[i] = len;
+	}
+}
+
+/* returns the vertex to use as target for following matches */
+static BMVert *bmesh_find_doubles_match(BMesh *bm, BMVert *v_check, BMVert *v_other,
+                                        BMOperator *optarget, BMOpSlot *optarget_slot)
+{
+	/* If one vert is marked as keep, make sure it will be the target */
+	if (BMO_elem_flag_test(bm, v_other, VERT_KEEP)) {
+		SWAP(BMVert *, v_check, v_other);
+	}
+
+	BMO_elem_flag_enable(bm, v_other, VERT_DOUBLE);
+	BMO_elem_flag_enable(bm, v_check, VERT_TARGET);
+
+	BMO_slot_map_elem_insert(optarget, optarget_slot, v_other, v_check);
+
+	return v_check;
+}
+
+static void bmesh_find_doubles_search(FindDoublesData *data, BMVert *v_check, int j,
+                                      BMOperator *optarget, BMOpSlot *optarget_slot)
+{
+	BMesh *bm = data->bm;
+
+	for (; j < data->verts_len; j++) {
+		BMVert *v_other = data->verts[j];
+
+		/* a match has already been found, (we could check which is best, for now don't) */
+		if (BMO_elem_flag_test(bm, v_other, VERT_DOUBLE | VERT_TARGET)) {
+			continue;
+		}
+
+		if (bmesh_find_doubles_out_of_range(v_check, v_other, data->dist3)) {
+			break;
+		}
+
+		if (bmesh_find_doubles_test(bm, v_check, v_other, data->dist, data->keepvert)) {
+			v_check = bmesh_find_doubles_match(bm, v_check, v_other, optarget, optarget_slot);
+		}
+	}
+}
+
+/**
+ * Matches are searched in parallel first, then flagged in sort order on the main thread,
+ * which gives the same result as searching in order.
+ */
 static void bmesh_find_doubles_common(BMesh *bm, BMOperator *op,
                                       BMOperator *optarget, BMOpSlot *optarget_slot)
 {
+	FindDoublesData data;
 	BMVert  **verts;
 	int       verts_len;
 
-	int i, j, keepvert = 0;
+	int i, k, keepvert = 0;
 
 	const float dist  = BMO_slot_float_get(op->slots_in, "dist");
 	const float dist3 = dist * 3.0f;
@@ -507,6 +626,17 @@ static void bmesh_find_doubles_common(BMesh *bm, BMOperator *op,
 		BMO_slot_buffer_flag_enable(bm, op->slots_in, "keep_verts", BM_VERT, VERT_KEEP);
 	}
 
+	data.bm = bm;
+	data.verts = verts;
+	data.verts_len = verts_len;
+	data.dist = dist;
+	data.dist3 = dist3;
+	data.keepvert = keepvert != 0;
+	data.candidates = MEM_mallocN(sizeof(*data.candidates) * (size_t)verts_len, __func__);
+	data.candidates_len = MEM_mallocN(sizeof(*data.candidates_len) * (size_t)verts_len, __func__);
+
+	BLI_task_parallel_range_ex(0, verts_len, &data, bmesh_find_doubles_candidates_range, BM_OMP_LIMIT);
+
 	for (i = 0; i < verts_len; i++) {
 		BMVert *v_check = verts[i];
 
@@ -514,7 +644,13 @@ static void bmesh_find_doubles_common(BMesh *bm, BMOperator *op,
 			continue;
 		}
 
-		for (j = i + 1; j < verts_len; j++) {
+		if (data.candidates_len[i] == -1) {
+			bmesh_find_doubles_search(&data, v_check, i + 1, optarget, optarget_slot);
+			continue;
+		}
+
+		for (k = 0; k < data.candidates_len[i]; k++) {
+			const int j = data.candidates[i][k];
 			BMVert *v_other = verts[j];
 
 			/* a match has already been found, (we could check which is best, for now don't) */
@@ -522,35 +658,16 @@ static void bmesh_find_doubles_common(BMesh *bm, BMOperator *op,
 				continue;
 			}
 
-			/* Compare sort values of the verts using 3x tolerance (allowing for the tolerance
-			 * on each of the three axes). This avoids the more expensive length comparison
-			 * for most vertex pairs. */
-			if ((v_other->co[0] + v_other->co[1] + v_other->co[2]) -
-			    (v_check->co[0] + v_check->co[1] + v_check->co[2]) > dist3)
-			{
+			if (bmesh_find_doubles_match(bm, v_check, v_other, optarget, optarget_slot) != v_check) {
+				/* the target changed, so did the range to search */
+				bmesh_find_doubles_search(&data, v_other, j + 1, optarget, optarget_slot);
 				break;
 			}
-
-			if (keepvert) {
-				if (BMO_elem_flag_test(bm, v_other, VERT_KEEP) == BMO_elem_flag_test(bm, v_check, VERT_KEEP))
-					continue;
-			}
-
-			if (compare_len_v3v3(v_check->co, v_other->co, dist)) {
-
-				/* If one vert is marked as keep, make sure it will be the target */
-				if (BMO_elem_flag_test(bm, v_other, VERT_KEEP)) {
-					SWAP(BMVert *, v_check, v_other);
-				}
-
-				BMO_elem_flag_enable(bm, v_other, VERT_DOUBLE);
-				BMO_elem_flag_enable(bm, v_check, VERT_TARGET);
-
-				BMO_slot_map_elem_insert(optarget, optarget_slot, v_other, v_check);
-			}
 		}
 	}
 
+	MEM_freeN(data.candidates);
+	MEM_freeN(data.candidates_len);
 	MEM_freeN(verts);
 }
 
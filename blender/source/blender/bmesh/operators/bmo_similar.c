@@ -33,6 +33,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -41,6 +42,25 @@
 
 #include "intern/bmesh_operators_private.h"  /* own include */
 
+#define FACE_MARK	1
+#define EDGE_MARK	1
+#define VERT_MARK	1
+
+/*
+ * shared by the threaded comparison passes,
+ * each element is compared against the selection and only marks itself
+ */
+typedef struct SimSel_Data {
+	BMesh *bm;
+	void *ext;              /* SimSel_FaceExt, SimSel_EdgeExt or SimSel_VertExt array */
+	const int *indices;     /* indices of the selected elements in 'ext' */
+	int num_sels;
+	int type;
+	float thresh;
+	float thresh_radians;
+	int compare;
+} SimSel_Data;
+
 /* in fact these could all be the same */
 
 /*
@@ -87,102 +107,26 @@ static int bm_sel_similar_cmp_i(const int delta, const int compare)
 	}
 }
 
-/*
- * Select similar faces, the choices are in the enum in source/blender/bmesh/bmesh_operators.h
- * We select either similar faces based on material, image, area, perimeter, normal, or the coplanar faces
- */
-void bmo_similar_faces_exec(BMesh *bm, BMOperator *op)
+static void bm_similar_faces_range(void *userdata, int start, int stop)
 {
-#define FACE_MARK	1
-
-	BMIter fm_iter;
+	SimSel_Data *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_FaceExt *f_ext = data->ext;
+	const int *indices = data->indices;
+	const int num_sels = data->num_sels;
+	const int type = data->type;
+	const float thresh = data->thresh;
+	const float thresh_radians = data->thresh_radians;
+	const int compare = data->compare;
 	BMFace *fs, *fm;
-	BMOIter fs_iter;
-	int num_sels = 0, num_total = 0, i = 0, idx = 0;
-	float angle = 0.0f;
-	SimSel_FaceExt *f_ext = NULL;
-	int *indices = NULL;
-	float t_no[3];	/* temporary normal */
-	const int type = BMO_slot_int_get(op->slots_in, "type");
-	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
-	const float thresh_radians = thresh * (float)M_PI;
-	const int compare = BMO_slot_int_get(op->slots_in, "compare");
+	float angle;
+	int i, idx;
 
 	/* initial_elem - other_elem */
 	float delta_fl;
 	int   delta_i;
 
-	num_total = BM_mesh_elem_count(bm, BM_FACE);
-
-	/*
-	 * The first thing to do is to iterate through all the the selected items and mark them since
-	 * they will be in the selection anyway.
-	 * This will increase performance, (especially when the number of originally selected faces is high)
-	 * so the overall complexity will be less than $O(mn)$ where is the total number of selected faces,
-	 * and n is the total number of faces
-	 */
-	BMO_ITER (fs, &fs_iter, op->slots_in, "faces", BM_FACE) {
-		if (!BMO_elem_flag_test(bm, fs, FACE_MARK)) {	/* is this really needed ? */
-			BMO_elem_flag_enable(bm, fs, FACE_MARK);
-			num_sels++;
-		}
-	}
-
-	/* allocate memory for the selected faces indices and for all temporary faces */
-	indices = (int *)MEM_callocN(sizeof(int) * num_sels, "face indices util.c");
-	f_ext = (SimSel_FaceExt *)MEM_callocN(sizeof(SimSel_FaceExt) * num_total, "f_ext util.c");
-
-	/* loop through all the faces and fill the faces/indices structure */
-	BM_ITER_MESH (fm, &fm_iter, bm, BM_FACES_OF_MESH) {
-		f_ext[i].f = fm;
-		if (BMO_elem_flag_test(bm, fm, FACE_MARK)) {
-			indices[idx] = i;
-			idx++;
-		}
-		i++;
-	}
-
-	/*
-	 * Save us some computation burden: In case of perimeter/area/coplanar selection we compute
-	 * only once.
-	 */
-	if (type == SIMFACE_PERIMETER || type == SIMFACE_AREA || type == SIMFACE_COPLANAR || type == SIMFACE_IMAGE) {
-		for (i = 0; i < num_total; i++) {
-			switch (type) {
-				case SIMFACE_PERIMETER:
-					/* set the perimeter */
-					f_ext[i].perim = BM_face_calc_perimeter(f_ext[i].f);
-					break;
-
-				case SIMFACE_COPLANAR:
-					/* compute the center of the polygon */
-					BM_face_calc_center_mean(f_ext[i].f, f_ext[i].c);
-
-					/* normalize the polygon normal */
-					copy_v3_v3(t_no, f_ext[i].f->no);
-					normalize_v3(t_no);
-
-					/* compute the plane distance */
-					f_ext[i].d = dot_v3v3(t_no, f_ext[i].c);
-					break;
-
-				case SIMFACE_AREA:
-					f_ext[i].area = BM_face_calc_area(f_ext[i].f);
-					break;
-
-				case SIMFACE_IMAGE:
-					f_ext[i].t = NULL;
-					if (CustomData_has_layer(&(bm->pdata), CD_MTEXPOLY)) {
-						MTexPoly *mtpoly = CustomData_bmesh_get(&bm->pdata, f_ext[i].f->head.data, CD_MTEXPOLY);
-						f_ext[i].t = mtpoly->tpage;
-					}
-					break;
-			}
-		}
-	}
-
-	/* now select the rest (if any) */
-	for (i = 0; i < num_total; i++) {
+	for (i = start; i < stop; i++) {
 		fm = f_ext[i].f;
 		if (!BMO_elem_flag_test(bm, fm, FACE_MARK) && !BM_elem_flag_test(fm, BM_ELEM_HIDDEN)) {
 			bool cont = true;
@@ -267,13 +211,112 @@ void bmo_similar_faces_exec(BMesh *bm, BMOperator *op)
 			}
 		}
 	}
+}
+
+/*
+ * Select similar faces, the choices are in the enum in source/blender/bmesh/bmesh_operators.h
+ * We select either similar faces based on material, image, area, perimeter, normal, or the coplanar faces
+ */
+void bmo_similar_faces_exec(BMesh *bm, BMOperator *op)
+{
+	BMIter fm_iter;
+	BMFace *fs, *fm;
+	BMOIter fs_iter;
+	int num_sels = 0, num_total = 0, i = 0, idx = 0;
+	SimSel_FaceExt *f_ext = NULL;
+	SimSel_Data data;
+	int *indices = NULL;
+	float t_no[3];	/* temporary normal */
+	const int type = BMO_slot_int_get(op->slots_in, "type");
+	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
+	const float thresh_radians = thresh * (float)M_PI;
+	const int compare = BMO_slot_int_get(op->slots_in, "compare");
+
+	num_total = BM_mesh_elem_count(bm, BM_FACE);
+
+	/*
+	 * The first thing to do is to iterate through all the the selected items and mark them since
+	 * they will be in the selection anyway.
+	 * This will increase performance, (especially when the number of originally selected faces is high)
+	 * so the overall complexity will be less than $O(mn)$ where is the total number of selected faces,
+	 * and n is the total number of faces
+	 */
+	BMO_ITER (fs, &fs_iter, op->slots_in, "faces", BM_FACE) {
+		if (!BMO_elem_flag_test(bm, fs, FACE_MARK)) {	/* is this really needed ? */
+			BMO_elem_flag_enable(bm, fs, FACE_MARK);
+			num_sels++;
+		}
+	}
+
+	/* allocate memory for the selected faces indices and for all temporary faces */
+	indices = (int *)MEM_callocN(sizeof(int) * num_sels, "face indices util.c");
+	f_ext = (SimSel_FaceExt *)MEM_callocN(sizeof(SimSel_FaceExt) * num_total, "f_ext util.c");
+
+	/* loop through all the faces and fill the faces/indices structure */
+	BM_ITER_MESH (fm, &fm_iter, bm, BM_FACES_OF_MESH) {
+		f_ext[i].f = fm;
+		if (BMO_elem_flag_test(bm, fm, FACE_MARK)) {
+			indices[idx] = i;
+			idx++;
+		}
+		i++;
+	}
+
+	/*
+	 * Save us some computation burden: In case of perimeter/area/coplanar selection we compute
+	 * only once.
+	 */
+	if (type == SIMFACE_PERIMETER || type == SIMFACE_AREA || type == SIMFACE_COPLANAR || type == SIMFACE_IMAGE) {
+		for (i = 0; i < num_total; i++) {
+			switch (type) {
+				case SIMFACE_PERIMETER:
+					/* set the perimeter */
+					f_ext[i].perim = BM_face_calc_perimeter(f_ext[i].f);
+					break;
+
+				case SIMFACE_COPLANAR:
+					/* compute the center of the polygon */
+					BM_face_calc_center_mean(f_ext[i].f, f_ext[i].c);
+
+					/* normalize the polygon normal */
+					copy_v3_v3(t_no, f_ext[i].f->no);
+					normalize_v3(t_no);
+
+					/* compute the plane distance */
+					f_ext[i].d = dot_v3v3(t_no, f_ext[i].c);
+					break;
+
+				case SIMFACE_AREA:
+					f_ext[i].area = BM_face_calc_area(f_ext[i].f);
+					break;
+
+				case SIMFACE_IMAGE:
+					f_ext[i].t = NULL;
+					if (CustomData_has_layer(&(bm->pdata), CD_MTEXPOLY)) {
+						MTexPoly *mtpoly = CustomData_bmesh_get(&bm->pdata, f_ext[i].f->head.data, CD_MTEXPOLY);
+						f_ext[i].t = mtpoly->tpage;
+					}
+					break;
+			}
+		}
+	}
+
+	/* now select the rest (if any) */
+	data.bm = bm;
+	data.ext = f_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh = thresh;
+	data.thresh_radians = thresh_radians;
+	data.compare = compare;
+	BLI_task_parallel_range_ex(0, num_total, &data, bm_similar_faces_range, BM_OMP_LIMIT);
 
 	MEM_freeN(f_ext);
 	MEM_freeN(indices);
 
 	/* transfer all marked faces to the output slot */
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "faces.out", BM_FACE, FACE_MARK);
-#undef FACE_MARK
 }
 
 /**************************************************************************** *
@@ -296,97 +339,25 @@ typedef struct SimSel_EdgeExt {
 	};
 } SimSel_EdgeExt;
 
-/*
- * select similar edges: the choices are in the enum in source/blender/bmesh/bmesh_operators.h
- * choices are length, direction, face, ...
- */
-void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
+static void bm_similar_edges_range(void *userdata, int start, int stop)
 {
-#define EDGE_MARK	1
-
-	BMOIter es_iter;	/* selected edges iterator */
-	BMIter e_iter;		/* mesh edges iterator */
-	BMEdge *es;		/* selected edge */
-	BMEdge *e;		/* mesh edge */
-	int idx = 0, i = 0 /* , f = 0 */;
-	int *indices = NULL;
-	SimSel_EdgeExt *e_ext = NULL;
-	// float *angles = NULL;
+	SimSel_Data *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_EdgeExt *e_ext = data->ext;
+	const int *indices = data->indices;
+	const int num_sels = data->num_sels;
+	const int type = data->type;
+	const float thresh = data->thresh;
+	const int compare = data->compare;
+	BMEdge *es, *e;
 	float angle;
-
-	int num_sels = 0, num_total = 0;
-	const int type = BMO_slot_int_get(op->slots_in, "type");
-	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
-	const int compare = BMO_slot_int_get(op->slots_in, "compare");
+	int i, idx;
 
 	/* initial_elem - other_elem */
 	float delta_fl;
 	int   delta_i;
 
-	/* sanity checks that the data we need is available */
-	switch (type) {
-		case SIMEDGE_CREASE:
-			if (!CustomData_has_layer(&bm->edata, CD_CREASE)) {
-				return;
-			}
-			break;
-		case SIMEDGE_BEVEL:
-			if (!CustomData_has_layer(&bm->edata, CD_BWEIGHT)) {
-				return;
-			}
-			break;
-	}
-
-	num_total = BM_mesh_elem_count(bm, BM_EDGE);
-
-	/* iterate through all selected edges and mark them */
-	BMO_ITER (es, &es_iter, op->slots_in, "edges", BM_EDGE) {
-		BMO_elem_flag_enable(bm, es, EDGE_MARK);
-		num_sels++;
-	}
-
-	/* allocate memory for the selected edges indices and for all temporary edges */
-	indices = (int *)MEM_callocN(sizeof(int) * num_sels, __func__);
-	e_ext = (SimSel_EdgeExt *)MEM_callocN(sizeof(SimSel_EdgeExt) * num_total, __func__);
-
-	/* loop through all the edges and fill the edges/indices structure */
-	BM_ITER_MESH (e, &e_iter, bm, BM_EDGES_OF_MESH) {
-		e_ext[i].e = e;
-		if (BMO_elem_flag_test(bm, e, EDGE_MARK)) {
-			indices[idx] = i;
-			idx++;
-		}
-		i++;
-	}
-
-	/* save us some computation time by doing heavy computation once */
-	if (type == SIMEDGE_LENGTH || type == SIMEDGE_FACE || type == SIMEDGE_DIR || type == SIMEDGE_FACE_ANGLE) {
-		for (i = 0; i < num_total; i++) {
-			switch (type) {
-				case SIMEDGE_LENGTH:	/* compute the length of the edge */
-					e_ext[i].length = len_v3v3(e_ext[i].e->v1->co, e_ext[i].e->v2->co);
-					break;
-
-				case SIMEDGE_DIR:		/* compute the direction */
-					sub_v3_v3v3(e_ext[i].dir, e_ext[i].e->v1->co, e_ext[i].e->v2->co);
-					normalize_v3(e_ext[i].dir);
-					break;
-
-				case SIMEDGE_FACE:		/* count the faces around the edge */
-					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
-					break;
-
-				case SIMEDGE_FACE_ANGLE:
-					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
-					if (e_ext[i].faces == 2)
-						e_ext[i].angle = BM_edge_calc_face_angle(e_ext[i].e);
-					break;
-			}
-		}
-	}
-
-	/* select the edges if any */
-	for (i = 0; i < num_total; i++) {
+	for (i = start; i < stop; i++) {
 		e = e_ext[i].e;
 		if (!BMO_elem_flag_test(bm, e, EDGE_MARK) && !BM_elem_flag_test(e, BM_ELEM_HIDDEN)) {
 			bool cont = true;
@@ -501,6 +472,99 @@ void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
 			}
 		}
 	}
+}
+
+/*
+ * select similar edges: the choices are in the enum in source/blender/bmesh/bmesh_operators.h
+ * choices are length, direction, face, ...
+ */
+void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
+{
+	BMOIter es_iter;	/* selected edges iterator */
+	BMIter e_iter;		/* mesh edges iterator */
+	BMEdge *es;		/* selected edge */
+	BMEdge *e;		/* mesh edge */
+	int idx = 0, i = 0 /* , f = 0 */;
+	int *indices = NULL;
+	SimSel_EdgeExt *e_ext = NULL;
+	SimSel_Data data;
+
+	int num_sels = 0, num_total = 0;
+	const int type = BMO_slot_int_get(op->slots_in, "type");
+	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
+	const int compare = BMO_slot_int_get(op->slots_in, "compare");
+
+	/* sanity checks that the data we need is available */
+	switch (type) {
+		case SIMEDGE_CREASE:
+			if (!CustomData_has_layer(&bm->edata, CD_CREASE)) {
+				return;
+			}
+			break;
+		case SIMEDGE_BEVEL:
+			if (!CustomData_has_layer(&bm->edata, CD_BWEIGHT)) {
+				return;
+			}
+			break;
+	}
+
+	num_total = BM_mesh_elem_count(bm, BM_EDGE);
+
+	/* iterate through all selected edges and mark them */
+	BMO_ITER (es, &es_iter, op->slots_in, "edges", BM_EDGE) {
+		BMO_elem_flag_enable(bm, es, EDGE_MARK);
+		num_sels++;
+	}
+
+	/* allocate memory for the selected edges indices and for all temporary edges */
+	indices = (int *)MEM_callocN(sizeof(int) * num_sels, __func__);
+	e_ext = (SimSel_EdgeExt *)MEM_callocN(sizeof(SimSel_EdgeExt) * num_total, __func__);
+
+	/* loop through all the edges and fill the edges/indices structure */
+	BM_ITER_MESH (e, &e_iter, bm, BM_EDGES_OF_MESH) {
+		e_ext[i].e = e;
+		if (BMO_elem_flag_test(bm, e, EDGE_MARK)) {
+			indices[idx] = i;
+			idx++;
+		}
+		i++;
+	}
+
+	/* save us some computation time by doing heavy computation once */
+	if (type == SIMEDGE_LENGTH || type == SIMEDGE_FACE || type == SIMEDGE_DIR || type == SIMEDGE_FACE_ANGLE) {
+		for (i = 0; i < num_total; i++) {
+			switch (type) {
+				case SIMEDGE_LENGTH:	/* compute the length of the edge */
+					e_ext[i].length = len_v3v3(e_ext[i].e->v1->co, e_ext[i].e->v2->co);
+					break;
+
+				case SIMEDGE_DIR:		/* compute the direction */
+					sub_v3_v3v3(e_ext[i].dir, e_ext[i].e->v1->co, e_ext[i].e->v2->co);
+					normalize_v3(e_ext[i].dir);
+					break;
+
+				case SIMEDGE_FACE:		/* count the faces around the edge */
+					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
+					break;
+
+				case SIMEDGE_FACE_ANGLE:
+					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
+					if (e_ext[i].faces == 2)
+						e_ext[i].angle = BM_edge_calc_face_angle(e_ext[i].e);
+					break;
+			}
+		}
+	}
+
+	/* select the edges if any */
+	data.bm = bm;
+	data.ext = e_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh = thresh;
+	data.compare = compare;
+	BLI_task_parallel_range_ex(0, num_total, &data, bm_similar_edges_range, BM_OMP_LIMIT);
 
 	MEM_freeN(e_ext);
 	MEM_freeN(indices);
@@ -508,7 +572,6 @@ void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
 	/* transfer all marked edges to the output slot */
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "edges.out", BM_EDGE, EDGE_MARK);
 
-#undef EDGE_MARK
 }
 
 /**************************************************************************** *
@@ -524,20 +587,83 @@ typedef struct SimSel_VertExt {
 	};
 } SimSel_VertExt;
 
+static void bm_similar_verts_range(void *userdata, int start, int stop)
+{
+	SimSel_Data *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_VertExt *v_ext = data->ext;
+	const int *indices = data->indices;
+	const int num_sels = data->num_sels;
+	const int type = data->type;
+	const float thresh_radians = data->thresh_radians;
+	const int compare = data->compare;
+	BMVert *vs, *v;
+	int i, idx;
+
+	/* initial_elem - other_elem */
+	int   delta_i;
+
+	for (i = start; i < stop; i++) {
+		v = v_ext[i].v;
+		if (!BMO_elem_flag_test(bm, v, VERT_MARK) && !BM_elem_flag_test(v, BM_ELEM_HIDDEN)) {
+			bool cont = true;
+			for (idx = 0; idx < num_sels && cont == true; idx++) {
+				vs = v_ext[indices[idx]].v;
+				switch (type) {
+					case SIMVERT_NORMAL:
+						/* compare the angle between the normals */
+						if (angle_normalized_v3v3(v->no, vs->no) <= thresh_radians) {
+							BMO_elem_flag_enable(bm, v, VERT_MARK);
+							cont = false;
+						}
+						break;
+					case SIMVERT_FACE:
+						/* number of adjacent faces */
+						delta_i = v_ext[i].num_faces - v_ext[indices[idx]].num_faces;
+						if (bm_sel_similar_cmp_i(delta_i, compare)) {
+							BMO_elem_flag_enable(bm, v, VERT_MARK);
+							cont = false;
+						}
+						break;
+
+					case SIMVERT_VGROUP:
+						if (v_ext[i].dvert != NULL && v_ext[indices[idx]].dvert != NULL) {
+							if (defvert_find_shared(v_ext[i].dvert, v_ext[indices[idx]].dvert) != -1) {
+								BMO_elem_flag_enable(bm, v, VERT_MARK);
+								cont = false;
+							}
+						}
+						break;
+					case SIMVERT_EDGE:
+						/* number of adjacent edges */
+						delta_i = v_ext[i].num_edges - v_ext[indices[idx]].num_edges;
+						if (bm_sel_similar_cmp_i(delta_i, compare)) {
+							BMO_elem_flag_enable(bm, v, VERT_MARK);
+							cont = false;
+						}
+						break;
+					default:
+						BLI_assert(0);
+						break;
+				}
+			}
+		}
+	}
+}
+
 /*
  * select similar vertices: the choices are in the enum in source/blender/bmesh/bmesh_operators.h
  * choices are normal, face, vertex group...
  */
 void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 {
-#define VERT_MARK	1
-
 	const int cd_dvert_offset = CustomData_get_offset(&bm->vdata, CD_MDEFORMVERT);
 	BMOIter vs_iter;	/* selected verts iterator */
 	BMIter v_iter;		/* mesh verts iterator */
 	BMVert *vs;		/* selected vertex */
 	BMVert *v;			/* mesh vertex */
 	SimSel_VertExt *v_ext = NULL;
+	SimSel_Data data;
 	int *indices = NULL;
 	int num_total = 0, num_sels = 0, i = 0, idx = 0;
 	const int type = BMO_slot_int_get(op->slots_in, "type");
@@ -545,10 +671,6 @@ void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 	const float thresh_radians = thresh * (float)M_PI;
 	const int compare = BMO_slot_int_get(op->slots_in, "compare");
 
-	/* initial_elem - other_elem */
-//	float delta_fl;
-	int   delta_i;
-
 	num_total = BM_mesh_elem_count(bm, BM_VERT);
 
 	/* iterate through all selected edges and mark them */
@@ -588,57 +710,19 @@ void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 	}
 
 	/* select the vertices if any */
-	for (i = 0; i < num_total; i++) {
-		v = v_ext[i].v;
-		if (!BMO_elem_flag_test(bm, v, VERT_MARK) && !BM_elem_flag_test(v, BM_ELEM_HIDDEN)) {
-			bool cont = true;
-			for (idx = 0; idx < num_sels && cont == true; idx++) {
-				vs = v_ext[indices[idx]].v;
-				switch (type) {
-					case SIMVERT_NORMAL:
-						/* compare the angle between the normals */
-						if (angle_normalized_v3v3(v->no, vs->no) <= thresh_radians) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
-					case SIMVERT_FACE:
-						/* number of adjacent faces */
-						delta_i = v_ext[i].num_faces - v_ext[indices[idx]].num_faces;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
-
-					case SIMVERT_VGROUP:
-						if (v_ext[i].dvert != NULL && v_ext[indices[idx]].dvert != NULL) {
-							if (defvert_find_shared(v_ext[i].dvert, v_ext[indices[idx]].dvert) != -1) {
-								BMO_elem_flag_enable(bm, v, VERT_MARK);
-								cont = false;
-							}
-						}
-						break;
-					case SIMVERT_EDGE:
-						/* number of adjacent edges */
-						delta_i = v_ext[i].num_edges - v_ext[indices[idx]].num_edges;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
-					default:
-						BLI_assert(0);
-						break;
-				}
-			}
-		}
-	}
+	data.bm = bm;
+	data.ext = v_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh = thresh;
+	data.thresh_radians = thresh_radians;
+	data.compare = compare;
+	BLI_task_parallel_range_ex(0, num_total, &data, bm_similar_verts_range, BM_OMP_LIMIT);
 
 	MEM_freeN(indices);
 	MEM_freeN(v_ext);
 
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "verts.out", BM_VERT, VERT_MARK);
 
-#undef VERT_MARK
 }
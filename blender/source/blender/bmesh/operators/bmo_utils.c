@@ -283,56 +283,70 @@ void bmo_region_extend_exec(BMesh *bm, BMOperator *op)
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "geom.out", BM_ALL_NOLOOP, SEL_FLAG);
 }
 
-void bmo_smooth_vert_exec(BMesh *UNUSED(bm), BMOperator *op)
-{
-	BMOIter siter;
-	BMIter iter;
-	BMVert *v;
-	BMEdge *e;
-	float (*cos)[3] = MEM_mallocN(sizeof(*cos) * BMO_slot_buffer_count(op->slots_in, "verts"), __func__);
-	float *co, *co2, clip_dist = BMO_slot_float_get(op->slots_in, "clip_dist");
-	int i, j, clipx, clipy, clipz;
-	int xaxis, yaxis, zaxis;
-	
-	clipx = BMO_slot_bool_get(op->slots_in, "mirror_clip_x");
-	clipy = BMO_slot_bool_get(op->slots_in, "mirror_clip_y");
-	clipz = BMO_slot_bool_get(op->slots_in, "mirror_clip_z");
+typedef struct SmoothVertData {
+	float (*cos)[3];
+	float clip_dist;
+	int clipx, clipy, clipz;
+} SmoothVertData;
 
-	xaxis = BMO_slot_bool_get(op->slots_in, "use_axis_x");
-	yaxis = BMO_slot_bool_get(op->slots_in, "use_axis_y");
-	zaxis = BMO_slot_bool_get(op->slots_in, "use_axis_z");
+static void bmo_smooth_vert_range(void *userdata, void **buf, int start, int stop)
+{
+	SmoothVertData *data = userdata;
+	const float clip_dist = data->clip_dist;
+	int i;
 
-	i = 0;
-	BMO_ITER (v, &siter, op->slots_in, "verts", BM_VERT) {
+	for (i = start; i < stop; i++) {
+		BMVert *v = buf[i];
+		float *co = data->cos[i];
+		BMIter iter;
+		BMEdge *e;
+		int j = 0;
 
-		co = cos[i];
 		zero_v3(co);
 
-		j = 0;
 		BM_ITER_ELEM (e, &iter, v, BM_EDGES_OF_VERT) {
-			co2 = BM_edge_other_vert(e, v)->co;
-			add_v3_v3v3(co, co, co2);
+			add_v3_v3(co, BM_edge_other_vert(e, v)->co);
 			j += 1;
 		}
-		
+
 		if (!j) {
 			copy_v3_v3(co, v->co);
-			i++;
 			continue;
 		}
 
 		mul_v3_fl(co, 1.0f / (float)j);
 		mid_v3_v3v3(co, co, v->co);
 
-		if (clipx && fabsf(v->co[0]) <= clip_dist)
+		if (data->clipx && fabsf(v->co[0]) <= clip_dist)
 			co[0] = 0.0f;
-		if (clipy && fabsf(v->co[1]) <= clip_dist)
+		if (data->clipy && fabsf(v->co[1]) <= clip_dist)
 			co[1] = 0.0f;
-		if (clipz && fabsf(v->co[2]) <= clip_dist)
+		if (data->clipz && fabsf(v->co[2]) <= clip_dist)
 			co[2] = 0.0f;
-
-		i++;
 	}
+}
+
+void bmo_smooth_vert_exec(BMesh *UNUSED(bm), BMOperator *op)
+{
+	BMOIter siter;
+	BMVert *v;
+	SmoothVertData data;
+	float (*cos)[3] = MEM_mallocN(sizeof(*cos) * BMO_slot_buffer_count(op->slots_in, "verts"), __func__);
+	int i;
+	int xaxis, yaxis, zaxis;
+
+	data.cos = cos;
+	data.clip_dist = BMO_slot_float_get(op->slots_in, "clip_dist");
+	data.clipx = BMO_slot_bool_get(op->slots_in, "mirror_clip_x");
+	data.clipy = BMO_slot_bool_get(op->slots_in, "mirror_clip_y");
+	data.clipz = BMO_slot_bool_get(op->slots_in, "mirror_clip_z");
+
+	xaxis = BMO_slot_bool_get(op->slots_in, "use_axis_x");
+	yaxis = BMO_slot_bool_get(op->slots_in, "use_axis_y");
+	zaxis = BMO_slot_bool_get(op->slots_in, "use_axis_z");
+
+	/* all new locations are based on the old ones, calculate them first */
+	BMO_slot_buffer_parallel_range(op->slots_in, "verts", &data, bmo_smooth_vert_range);
 
 	i = 0;
 	BMO_ITER (v, &siter, op->slots_in, "verts", BM_VERT) {
@@ -301,11 +301,9 @@ static void bm_edge_update_beauty_cost_single(BMEdge *e, Heap *eheap, HeapNode *
 	if (BM_elem_flag_test(e, BM_ELEM_TAG)) {
 		const int i = BM_elem_index_get(e);
 		GSet *e_state_set = edge_state_arr[i];
-
-		if (eheap_table[i]) {
-			BLI_heap_remove(eheap, eheap_table[i]);
-			eheap_table[i] = NULL;
-		}
+		/* only negative costs are kept in the heap */
+		float cost = 0.0f;
+		bool is_state_known = false;
 
 		/* check if we can add it back */
 		BLI_assert(BM_edge_is_manifold(e) == true);
@@ -318,20 +316,27 @@ static void bm_edge_update_beauty_cost_single(BMEdge *e, Heap *eheap, HeapNode *
 			erot_state_alternate(e, &e_state_alt);
 			if (BLI_gset_haskey(e_state_set, (void *)&e_state_alt)) {
 				// printf("  skipping, we already have this state\n");
-				return;
+				is_state_known = true;
 			}
 		}
 
-		{
+		if (!is_state_known) {
 			/* recalculate edge */
-			const float cost = bm_edge_calc_rotate_beauty(e, flag, method);
-			if (cost < 0.0f) {
-				eheap_table[i] = BLI_heap_insert(eheap, cost, e);
+			cost = bm_edge_calc_rotate_beauty(e, flag, method);
+		}
+
+		if (cost < 0.0f) {
+			if (eheap_table[i]) {
+				BLI_heap_node_value_update(eheap, eheap_table[i], cost);
 			}
 			else {
-				eheap_table[i] = NULL;
+				eheap_table[i] = BLI_heap_insert(eheap, cost, e);
 			}
 		}
+		else if (eheap_table[i]) {
+			BLI_heap_remove(eheap, eheap_table[i]);
+			eheap_table[i] = NULL;
+		}
 	}
 }
 
@@ -380,15 +385,31 @@ void BM_mesh_beautify_fill(BMesh *bm, BMEdge **edge_array, const int edge_array_
 	eheap_table = MEM_mallocN(sizeof(HeapNode *) * (size_t)edge_array_len, __func__);
 
 	/* build heap */
-	for (i = 0; i < edge_array_len; i++) {
-		BMEdge *e = edge_array[i];
-		const float cost = bm_edge_calc_rotate_beauty(e, flag, method);
-		if (cost < 0.0f) {
-			eheap_table[i] = BLI_heap_insert(eheap, cost, e);
-		}
-		else {
+	{
+		float *costs = MEM_mallocN(sizeof(*costs) * (size_t)edge_array_len, __func__);
+		void **edges = MEM_mallocN(sizeof(*edges) * (size_t)edge_array_len, __func__);
+		HeapNode **nodes = MEM_mallocN(sizeof(*nodes) * (size_t)edge_array_len, __func__);
+		unsigned int j, tot = 0;
+
+		for (i = 0; i < edge_array_len; i++) {
+			BMEdge *e = edge_array[i];
+			const float cost = bm_edge_calc_rotate_beauty(e, flag, method);
 			eheap_table[i] = NULL;
+			if (cost < 0.0f) {
+				costs[tot] = cost;
+				edges[tot++] = e;
+			}
+		}
+
+		BLI_heap_insert_array(eheap, costs, edges, tot, nodes);
+
+		for (j = 0; j < tot; j++) {
+			eheap_table[BM_elem_index_get((BMEdge *)edges[j])] = nodes[j];
 		}
+
+		MEM_freeN(costs);
+		MEM_freeN(edges);
+		MEM_freeN(nodes);
 	}
 
 	while (BLI_heap_is_empty(eheap) == false) {
@@ -184,17 +184,13 @@ static bool bm_edge_collapse_is_degenerate_flip(BMEdge *e, const float optimize_
 	return false;
 }
 
-static void bm_decim_build_edge_cost_single(BMEdge *e,
-                                            const Quadric *vquadrics, const float *vweights,
-                                            Heap *eheap, HeapNode **eheap_table)
+/* calculate the cost of collapsing an edge, false when it can't be collapsed */
+static bool bm_decim_edge_cost_calc(BMEdge *e,
+                                    const Quadric *vquadrics, const float *vweights,
+                                    float *r_cost)
 {
 	const Quadric *q1, *q2;
 	float optimize_co[3];
-	float cost;
-
-	if (eheap_table[BM_elem_index_get(e)]) {
-		BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
-	}
 
 	/* check we can collapse, some edges we better not touch */
 	if (BM_edge_is_boundary(e)) {
@@ -203,8 +199,7 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
 		}
 		else {
 			/* only collapse tri's */
-			eheap_table[BM_elem_index_get(e)] = NULL;
-			return;
+			return false;
 		}
 	}
 	else if (BM_edge_is_manifold(e)) {
@@ -213,13 +208,11 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
 		}
 		else {
 			/* only collapse tri's */
-			eheap_table[BM_elem_index_get(e)] = NULL;
-			return;
+			return false;
 		}
 	}
 	else {
-		eheap_table[BM_elem_index_get(e)] = NULL;
-		return;
+		return false;
 	}
 
 	if (vweights) {
@@ -227,8 +220,7 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
 		    (vweights[BM_elem_index_get(e->v2)] >= BM_MESH_DECIM_WEIGHT_MAX))
 		{
 			/* skip collapsing this edge */
-			eheap_table[BM_elem_index_get(e)] = NULL;
-			return;
+			return false;
 		}
 	}
 	/* end sanity check */
@@ -240,17 +232,39 @@ static void bm_decim_build_edge_cost_single(BMEdge *e,
 	q2 = &vquadrics[BM_elem_index_get(e->v2)];
 
 	if (vweights == NULL) {
-		cost = (BLI_quadric_evaluate(q1, optimize_co) +
-		        BLI_quadric_evaluate(q2, optimize_co));
+		*r_cost = (BLI_quadric_evaluate(q1, optimize_co) +
+		           BLI_quadric_evaluate(q2, optimize_co));
 	}
 	else {
 		/* add 1.0 so planar edges are still weighted against */
-		cost = (((BLI_quadric_evaluate(q1, optimize_co) + 1.0f) * vweights[BM_elem_index_get(e->v1)]) +
-		        ((BLI_quadric_evaluate(q2, optimize_co) + 1.0f) * vweights[BM_elem_index_get(e->v2)]));
+		*r_cost = (((BLI_quadric_evaluate(q1, optimize_co) + 1.0f) * vweights[BM_elem_index_get(e->v1)]) +
+		           ((BLI_quadric_evaluate(q2, optimize_co) + 1.0f) * vweights[BM_elem_index_get(e->v2)]));
 	}
 	// print("COST %.12f\n");
 
-	eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, cost, e);
+	return true;
+}
+
+static void bm_decim_build_edge_cost_single(BMEdge *e,
+                                            const Quadric *vquadrics, const float *vweights,
+                                            Heap *eheap, HeapNode **eheap_table)
+{
+	const int i = BM_elem_index_get(e);
+	float cost;
+
+	if (bm_decim_edge_cost_calc(e, vquadrics, vweights, &cost)) {
+		/* update in place when the edge is already in the heap */
+		if (eheap_table[i]) {
+			BLI_heap_node_value_update(eheap, eheap_table[i], cost);
+		}
+		else {
+			eheap_table[i] = BLI_heap_insert(eheap, cost, e);
+		}
+	}
+	else if (eheap_table[i]) {
+		BLI_heap_remove(eheap, eheap_table[i]);
+		eheap_table[i] = NULL;
+	}
 }
 
 
@@ -267,14 +281,43 @@ static void bm_decim_build_edge_cost(BMesh *bm,
                                      const Quadric *vquadrics, const float *vweights,
                                      Heap *eheap, HeapNode **eheap_table)
 {
-	BMIter iter;
-	BMEdge *e;
-	unsigned int i;
+	const int totedge = bm->totedge;
+	float *costs = MEM_mallocN(sizeof(*costs) * (size_t)totedge, __func__);
+	char *is_valid = MEM_mallocN(sizeof(*is_valid) * (size_t)totedge, __func__);
+	void **edges = MEM_mallocN(sizeof(*edges) * (size_t)totedge, __func__);
+	HeapNode **nodes = MEM_mallocN(sizeof(*nodes) * (size_t)totedge, __func__);
+	unsigned int tot = 0;
+	int i;
+
+	BM_mesh_elem_table_ensure(bm, BM_EDGE);
+
+	/* edge costs only read the mesh and quadrics, so they can be calculated in parallel */
+#pragma omp parallel for if (totedge >= BM_OMP_LIMIT)
+	for (i = 0; i < totedge; i++) {
+		BMEdge *e = BM_edge_at_index(bm, i);
+		is_valid[i] = bm_decim_edge_cost_calc(e, vquadrics, vweights, &costs[i]);
+	}
 
-	BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
+	/* compact valid edges in place and build the heap in one go,
+	 * much faster than inserting edges one by one */
+	for (i = 0; i < totedge; i++) {
 		eheap_table[i] = NULL;  /* keep sanity check happy */
-		bm_decim_build_edge_cost_single(e, vquadrics, vweights, eheap, eheap_table);
+		if (is_valid[i]) {
+			costs[tot] = costs[i];
+			edges[tot++] = BM_edge_at_index(bm, i);
+		}
 	}
+
+	BLI_heap_insert_array(eheap, costs, edges, tot, nodes);
+
+	for (i = 0; i < (int)tot; i++) {
+		eheap_table[BM_elem_index_get((BMEdge *)edges[i])] = nodes[i];
+	}
+
+	MEM_freeN(costs);
+	MEM_freeN(is_valid);
+	MEM_freeN(edges);
+	MEM_freeN(nodes);
 }
 
 #ifdef USE_TRIANGULATE
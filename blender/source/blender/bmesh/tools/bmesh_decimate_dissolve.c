@@ -170,8 +170,7 @@ void BM_mesh_decimate_dissolve_ex(BMesh *bm, const float angle_limit, const bool
 						const int j = BM_elem_index_get(l_iter->e);
 						if (j != -1 && eheap_table[j]) {
 							const float cost = bm_edge_calc_dissolve_error(l_iter->e, delimit);
-							BLI_heap_remove(eheap, eheap_table[j]);
-							eheap_table[j] = BLI_heap_insert(eheap, cost, l_iter->e);
+							BLI_heap_node_value_update(eheap, eheap_table[j], cost);
 						}
 					} while ((l_iter = l_iter->next) != l_first);
 				}
@@ -181,8 +180,7 @@ void BM_mesh_decimate_dissolve_ex(BMesh *bm, const float angle_limit, const bool
 			}
 
 			if (UNLIKELY(f_new == NULL)) {
-				BLI_heap_remove(eheap, enode_top);
-				eheap_table[i] = BLI_heap_insert(eheap, COST_INVALID, e);
+				BLI_heap_node_value_update(eheap, enode_top, COST_INVALID);
 			}
 		}
 
@@ -297,16 +295,14 @@ void BM_mesh_decimate_dissolve_ex(BMesh *bm, const float angle_limit, const bool
 						const int j = BM_elem_index_get(v_iter);
 						if (j != -1 && vheap_table[j]) {
 							const float cost = bm_vert_edge_face_angle(v_iter);
-							BLI_heap_remove(vheap, vheap_table[j]);
-							vheap_table[j] = BLI_heap_insert(vheap, cost, v_iter);
+							BLI_heap_node_value_update(vheap, vheap_table[j], cost);
 						}
 					}
 				}
 			}
 
 			if (UNLIKELY(e_new == NULL)) {
-				BLI_heap_remove(vheap, vnode_top);
-				vheap_table[i] = BLI_heap_insert(vheap, COST_INVALID, v);
+				BLI_heap_node_value_update(vheap, vnode_top, COST_INVALID);
 			}
 		}
 
@@ -67,7 +67,8 @@ static float step_cost_3_v3(const float v1[3], const float v2[3], const float v3
 /* -------------------------------------------------------------------- */
 /* BM_mesh_calc_path_vert */
 
-static void verttag_add_adjacent(Heap *heap, BMVert *v_a, BMVert **verts_prev, float *cost, const bool use_length)
+static void verttag_add_adjacent(Heap *heap, HeapNode **heap_nodes, BMVert *v_a, BMVert **verts_prev,
+                                 float *cost, const bool use_length)
 {
 	BMIter eiter;
 	BMEdge *e;
@@ -87,7 +88,12 @@ static void verttag_add_adjacent(Heap *heap, BMVert *v_a, BMVert **verts_prev, f
 			if (cost[v_b_index] > cost_new) {
 				cost[v_b_index] = cost_new;
 				verts_prev[v_b_index] = v_a;
-				BLI_heap_insert(heap, cost_new, v_b);
+				if (heap_nodes[v_b_index]) {
+					BLI_heap_node_value_update(heap, heap_nodes[v_b_index], cost_new);
+				}
+				else {
+					heap_nodes[v_b_index] = BLI_heap_insert(heap, cost_new, v_b);
+				}
 			}
 		}
 	}
@@ -102,6 +108,7 @@ LinkNode *BM_mesh_calc_path_vert(
 	BMVert *v;
 	BMIter viter;
 	Heap *heap;
+	HeapNode **heap_nodes;
 	float *cost;
 	BMVert **verts_prev;
 	int i, totvert;
@@ -125,6 +132,7 @@ LinkNode *BM_mesh_calc_path_vert(
 	totvert = bm->totvert;
 	verts_prev = MEM_callocN(sizeof(*verts_prev) * totvert, __func__);
 	cost = MEM_mallocN(sizeof(*cost) * totvert, __func__);
+	heap_nodes = MEM_callocN(sizeof(*heap_nodes) * totvert, __func__);
 
 	fill_vn_fl(cost, totvert, 1e20f);
 
@@ -136,23 +144,25 @@ LinkNode *BM_mesh_calc_path_vert(
 	 * cost[n] will contain the length of the shortest
 	 * path to face n found so far, Finally, heap is a priority heap which is built on the
 	 * the same data as the cost array, but inverted: it is a worklist of faces prioritized
-	 * by the shortest path found so far to the face.
+	 * by the shortest path found so far to the face. heap_nodes[n] is the heap node of
+	 * vertex n while it's in the heap, so its cost can be lowered in place.
 	 */
 
 	/* regular dijkstra shortest path, but over faces instead of vertices */
 	heap = BLI_heap_new();
-	BLI_heap_insert(heap, 0.0f, v_src);
+	heap_nodes[BM_elem_index_get(v_src)] = BLI_heap_insert(heap, 0.0f, v_src);
 	cost[BM_elem_index_get(v_src)] = 0.0f;
 
 	while (!BLI_heap_is_empty(heap)) {
 		v = BLI_heap_popmin(heap);
+		heap_nodes[BM_elem_index_get(v)] = NULL;
 
 		if (v == v_dst)
 			break;
 
 		if (!BM_elem_flag_test(v, BM_ELEM_TAG)) {
 			BM_elem_flag_enable(v, BM_ELEM_TAG);
-			verttag_add_adjacent(heap, v, verts_prev, cost, use_length);
+			verttag_add_adjacent(heap, heap_nodes, v, verts_prev, cost, use_length);
 		}
 	}
 
@@ -164,6 +174,7 @@ LinkNode *BM_mesh_calc_path_vert(
 
 	MEM_freeN(verts_prev);
 	MEM_freeN(cost);
+	MEM_freeN(heap_nodes);
 	BLI_heap_free(heap, NULL);
 
 	return path;
@@ -182,7 +193,8 @@ static float edgetag_cut_cost(BMEdge *e1, BMEdge *e2, BMVert *v)
 	return step_cost_3_v3(v1->co, v->co, v2->co);
 }
 
-static void edgetag_add_adjacent(Heap *heap, BMEdge *e1, BMEdge **edges_prev, float *cost, const bool use_length)
+static void edgetag_add_adjacent(Heap *heap, HeapNode **heap_nodes, BMEdge *e1, BMEdge **edges_prev,
+                                 float *cost, const bool use_length)
 {
 	BMIter viter;
 	BMVert *v;
@@ -203,7 +215,12 @@ static void edgetag_add_adjacent(Heap *heap, BMEdge *e1, BMEdge **edges_prev, fl
 				if (cost[e2_index] > cost_new) {
 					cost[e2_index] = cost_new;
 					edges_prev[e2_index] = e1;
-					BLI_heap_insert(heap, cost_new, e2);
+					if (heap_nodes[e2_index]) {
+						BLI_heap_node_value_update(heap, heap_nodes[e2_index], cost_new);
+					}
+					else {
+						heap_nodes[e2_index] = BLI_heap_insert(heap, cost_new, e2);
+					}
 				}
 			}
 		}
@@ -220,6 +237,7 @@ LinkNode *BM_mesh_calc_path_edge(
 	BMEdge *e;
 	BMIter eiter;
 	Heap *heap;
+	HeapNode **heap_nodes;
 	float *cost;
 	BMEdge **edges_prev;
 	int i, totedge;
@@ -243,6 +261,7 @@ LinkNode *BM_mesh_calc_path_edge(
 	totedge = bm->totedge;
 	edges_prev = MEM_callocN(sizeof(*edges_prev) * totedge, "SeamPathPrevious");
 	cost = MEM_mallocN(sizeof(*cost) * totedge, "SeamPathCost");
+	heap_nodes = MEM_callocN(sizeof(*heap_nodes) * totedge, "SeamPathHeapNodes");
 
 	fill_vn_fl(cost, totedge, 1e20f);
 
@@ -254,23 +273,25 @@ LinkNode *BM_mesh_calc_path_edge(
 	 * cost[n] will contain the length of the shortest
 	 * path to edge n found so far, Finally, heap is a priority heap which is built on the
 	 * the same data as the cost array, but inverted: it is a worklist of edges prioritized
-	 * by the shortest path found so far to the edge.
+	 * by the shortest path found so far to the edge. heap_nodes[n] is the heap node of
+	 * edge n while it's in the heap, so its cost can be lowered in place.
 	 */
 
 	/* regular dijkstra shortest path, but over edges instead of vertices */
 	heap = BLI_heap_new();
-	BLI_heap_insert(heap, 0.0f, e_src);
+	heap_nodes[BM_elem_index_get(e_src)] = BLI_heap_insert(heap, 0.0f, e_src);
 	cost[BM_elem_index_get(e_src)] = 0.0f;
 
 	while (!BLI_heap_is_empty(heap)) {
 		e = BLI_heap_popmin(heap);
+		heap_nodes[BM_elem_index_get(e)] = NULL;
 
 		if (e == e_dst)
 			break;
 
 		if (!BM_elem_flag_test(e, BM_ELEM_TAG)) {
 			BM_elem_flag_enable(e, BM_ELEM_TAG);
-			edgetag_add_adjacent(heap, e, edges_prev, cost, use_length);
+			edgetag_add_adjacent(heap, heap_nodes, e, edges_prev, cost, use_length);
 		}
 	}
 
@@ -282,6 +303,7 @@ LinkNode *BM_mesh_calc_path_edge(
 
 	MEM_freeN(edges_prev);
 	MEM_freeN(cost);
+	MEM_freeN(heap_nodes);
 	BLI_heap_free(heap, NULL);
 
 	return path;
@@ -305,7 +327,8 @@ static float facetag_cut_cost(BMFace *f_a, BMFace *f_b, BMEdge *e)
 	return step_cost_3_v3(f_a_cent, e_cent, f_b_cent);
 }
 
-static void facetag_add_adjacent(Heap *heap, BMFace *f_a, BMFace **faces_prev, float *cost, const bool use_length)
+static void facetag_add_adjacent(Heap *heap, HeapNode **heap_nodes, BMFace *f_a, BMFace **faces_prev,
+                                 float *cost, const bool use_length)
 {
 	BMIter liter;
 	BMLoop *l_a;
@@ -330,7 +353,12 @@ static void facetag_add_adjacent(Heap *heap, BMFace *f_a, BMFace **faces_prev, f
 				if (cost[f_b_index] > cost_new) {
 					cost[f_b_index] = cost_new;
 					faces_prev[f_b_index] = f_a;
-					BLI_heap_insert(heap, cost_new, f_b);
+					if (heap_nodes[f_b_index]) {
+						BLI_heap_node_value_update(heap, heap_nodes[f_b_index], cost_new);
+					}
+					else {
+						heap_nodes[f_b_index] = BLI_heap_insert(heap, cost_new, f_b);
+					}
 				}
 			}
 		} while ((l_iter = l_iter->radial_next) != l_first);
@@ -346,6 +374,7 @@ LinkNode *BM_mesh_calc_path_face(
 	BMFace *f;
 	BMIter fiter;
 	Heap *heap;
+	HeapNode **heap_nodes;
 	float *cost;
 	BMFace **faces_prev;
 	int i, totface;
@@ -369,6 +398,7 @@ LinkNode *BM_mesh_calc_path_face(
 	totface = bm->totface;
 	faces_prev = MEM_callocN(sizeof(*faces_prev) * totface, __func__);
 	cost = MEM_mallocN(sizeof(*cost) * totface, __func__);
+	heap_nodes = MEM_callocN(sizeof(*heap_nodes) * totface, __func__);
 
 	fill_vn_fl(cost, totface, 1e20f);
 
@@ -380,23 +410,25 @@ LinkNode *BM_mesh_calc_path_face(
 	 * cost[n] will contain the length of the shortest
 	 * path to face n found so far, Finally, heap is a priority heap which is built on the
 	 * the same data as the cost array, but inverted: it is a worklist of faces prioritized
-	 * by the shortest path found so far to the face.
+	 * by the shortest path found so far to the face. heap_nodes[n] is the heap node of
+	 * face n while it's in the heap, so its cost can be lowered in place.
 	 */
 
 	/* regular dijkstra shortest path, but over faces instead of vertices */
 	heap = BLI_heap_new();
-	BLI_heap_insert(heap, 0.0f, f_src);
+	heap_nodes[BM_elem_index_get(f_src)] = BLI_heap_insert(heap, 0.0f, f_src);
 	cost[BM_elem_index_get(f_src)] = 0.0f;
 
 	while (!BLI_heap_is_empty(heap)) {
 		f = BLI_heap_popmin(heap);
+		heap_nodes[BM_elem_index_get(f)] = NULL;
 
 		if (f == f_dst)
 			break;
 
 		if (!BM_elem_flag_test(f, BM_ELEM_TAG)) {
 			BM_elem_flag_enable(f, BM_ELEM_TAG);
-			facetag_add_adjacent(heap, f, faces_prev, cost, use_length);
+			facetag_add_adjacent(heap, heap_nodes, f, faces_prev, cost, use_length);
 		}
 	}
 
@@ -408,6 +440,7 @@ LinkNode *BM_mesh_calc_path_face(
 
 	MEM_freeN(faces_prev);
 	MEM_freeN(cost);
+	MEM_freeN(heap_nodes);
 	BLI_heap_free(heap, NULL);
 
 	return path;
@@ -229,6 +229,12 @@ extern "C" {
  * for a specific Device.
  * the work-scheduler will find work for the device and the device will be asked to execute the WorkPackage
  *
+ * Every CPU thread has its own queue, ordered by the priority of the WorkPackages. A thread with an empty queue
+ * steals the most important WorkPackage of the other queues. The priority of a chunk is its position in the
+ * chunk order of the output ExecutionGroup, so the chunks around the hotspots of the viewer are finished first.
+ * When a WorkPackage is finished the ExecutionGroup is woken up to schedule the chunks that depend on it
+ * [@ref WorkScheduler.waitForProgress]
+ *
  * @subsection singlethread Single threaded
  * For debugging reasons the multi-threading can be disabled. This is done by changing the COM_CURRENT_THREADING_MODEL
  * to COM_TM_NOTHREAD. When compiling the work-scheduler
@@ -343,6 +349,16 @@ void COM_startReadHighlights(void);
  */
 int COM_isHighlightedbNode(bNode *bnode);
 
+/**
+ * @brief get the timings of a node in the last execution, for the timings overlay
+ * @param bnode node of the editing tree
+ * @param r_time time spent calculating the node in seconds, summed over all threads
+ * @param r_factor share of the node in the total time of the execution
+ * @param r_memory memory of the buffers the node writes to, in bytes
+ * @return false if the node was not executed
+ */
+int COM_getNodeTimings(bNode *bnode, double *r_time, float *r_factor, size_t *r_memory);
+
 #ifdef __cplusplus
 }
 #endif
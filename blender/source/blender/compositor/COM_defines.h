@@ -107,6 +107,16 @@ typedef enum OrderOfChunks {
 
 #define COM_NUMBER_OF_CHANNELS 4
 
+/* maximum number of pixels in a row span calculated by SocketReader::executeRow,
+ * so operations can hold the rows of their inputs on the stack */
+#define COM_ROW_SPAN_SIZE 64
+
+/* memory budget for results of complex operations cached across executions while editing */
+#define COM_RESULT_CACHE_LIMIT (512 * 1024 * 1024)
+
+/* kernel radius in pixels from which convolution through the FFT is faster than direct convolution */
+#define COM_FFT_CONVOLUTION_MIN_RADIUS 16
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
 #endif  /* __COM_DEFINES_H__ */
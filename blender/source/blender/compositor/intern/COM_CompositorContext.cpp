@@ -30,6 +30,8 @@ CompositorContext::CompositorContext()
 	this->m_quality = COM_QUALITY_HIGH;
 	this->m_hasActiveOpenCLDevices = false;
 	this->m_fastCalculation = false;
+	this->m_resultCacheLimit = 0;
+	this->m_resolutionDivider = 1;
 	this->m_viewSettings = NULL;
 	this->m_displaySettings = NULL;
 }
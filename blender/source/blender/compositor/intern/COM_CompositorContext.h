@@ -81,6 +81,17 @@ private:
 	 */
 	bool m_fastCalculation;
 
+	/**
+	 * @brief memory budget in bytes for results cached across executions, 0 disables the cache
+	 * @see ResultCache
+	 */
+	size_t m_resultCacheLimit;
+
+	/**
+	 * @brief the resolution of the tree is divided by this value in draft mode
+	 */
+	int m_resolutionDivider;
+
 	/* @brief color management settings */
 	const ColorManagedViewSettings *m_viewSettings;
 	const ColorManagedDisplaySettings *m_displaySettings;
@@ -151,6 +162,16 @@ public:
 	 */
 	const ColorManagedDisplaySettings *getDisplaySettings() const { return this->m_displaySettings; }
 
+	/**
+	 * @brief set the memory budget of the result cache
+	 */
+	void setResultCacheLimit(size_t limit) { this->m_resultCacheLimit = limit; }
+
+	/**
+	 * @brief get the memory budget of the result cache
+	 */
+	size_t getResultCacheLimit() const { return this->m_resultCacheLimit; }
+
 	/**
 	 * @brief set the quality
 	 */
@@ -161,6 +182,21 @@ public:
 	 */
 	const CompositorQuality getQuality() const { return this->m_quality; }
 
+	/**
+	 * @brief set the divider of the resolution, 1 for full resolution
+	 */
+	void setResolutionDivider(int divider) { this->m_resolutionDivider = divider; }
+
+	/**
+	 * @brief get the divider of the resolution, 1 for full resolution
+	 */
+	int getResolutionDivider() const { return this->m_resolutionDivider; }
+
+	/**
+	 * @brief get the factor sizes in pixels, like blur radii, are multiplied with to match the resolution
+	 */
+	float getResolutionScale() const { return 1.0f / this->m_resolutionDivider; }
+
 	/**
 	 * @brief get the current framenumber of the scene in this context
 	 */
@@ -179,7 +215,7 @@ public:
 	int getChunksize() { return this->getbNodeTree()->chunksize; }
 	
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
-	bool isFastCalculation() {return this->m_fastCalculation;}
+	bool isFastCalculation() const {return this->m_fastCalculation;}
 	inline bool isGroupnodeBufferEnabled() {return this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER;}
 };
 
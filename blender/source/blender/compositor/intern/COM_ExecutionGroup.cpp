@@ -183,6 +183,28 @@ void ExecutionGroup::initExecution()
 
 }
 
+void ExecutionGroup::setExecuted()
+{
+	unsigned int index;
+
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+	this->m_chunksFinished = this->m_numberOfChunks;
+}
+
+bool ExecutionGroup::isExecuted() const
+{
+	unsigned int index;
+
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return this->m_numberOfChunks != 0;
+}
+
 void ExecutionGroup::deinitExecution()
 {
 	if (this->m_chunkExecutionStates != NULL) {
@@ -363,7 +385,10 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 			int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
 			const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
 			if (state == COM_ES_NOT_SCHEDULED) {
-				scheduleChunkWhenPossible(graph, xChunk, yChunk);
+				/* the position in the chunk order is the priority, so chunks
+				 * close to the hotspots of the viewer and their inputs are
+				 * executed first */
+				scheduleChunkWhenPossible(graph, xChunk, yChunk, index);
 				finished = false;
 				startEvaluated = true;
 				numberEvaluated++;
@@ -381,12 +406,17 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 			}
 		}
 
-		WorkScheduler::finish();
+		/* wake up as soon as any chunk has finished, so chunks depending on
+		 * it are scheduled right away instead of after all current work */
+		if (!finished) {
+			WorkScheduler::waitForProgress();
+		}
 
 		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
 			breaked = true;
 		}
 	}
+	WorkScheduler::finish();
 	DebugInfo::execution_group_finished(this);
 	DebugInfo::graphviz(graph);
 
@@ -406,8 +436,15 @@ MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 	for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
 		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
 		MemoryProxy *memoryProxy = readOperation->getMemoryProxy();
+		ExecutionGroup *group = memoryProxy->getExecutor();
+		if (group->isExecuted()) {
+			/* use completely calculated buffers as a whole, the device keeps them resident
+			 * instead of uploading a copy of the area of interest for every chunk */
+			memoryBuffers[readOperation->getOffset()] = memoryProxy->getBuffer();
+			continue;
+		}
 		this->determineDependingAreaOfInterest(&rect, readOperation, &output);
-		MemoryBuffer *memoryBuffer = memoryProxy->getExecutor()->constructConsolidatedMemoryBuffer(memoryProxy, &output);
+		MemoryBuffer *memoryBuffer = group->constructConsolidatedMemoryBuffer(memoryProxy, &output);
 		memoryBuffers[readOperation->getOffset()] = memoryBuffer;
 	}
 	return memoryBuffers;
@@ -516,10 +553,10 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int chunkNumber, rcti *rect)
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area, unsigned int priority)
 {
 	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
+		return scheduleChunkWhenPossible(graph, 0, 0, priority);
 	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -541,7 +578,7 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	bool result = true;
 	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
 		for (indexy = minychunk; indexy < maxychunk; indexy++) {
-			if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
+			if (!scheduleChunkWhenPossible(graph, indexx, indexy, priority)) {
 				result = false;
 			}
 		}
@@ -550,17 +587,17 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	return result;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber, unsigned int priority)
 {
 	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
 		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-		WorkScheduler::schedule(this, chunkNumber);
+		WorkScheduler::schedule(this, chunkNumber, priority);
 		return true;
 	}
 	return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk, unsigned int priority)
 {
 	if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
 		return true;
@@ -597,7 +634,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 		ExecutionGroup *group = memoryProxy->getExecutor();
 
 		if (group != NULL) {
-			if (!group->scheduleAreaWhenPossible(graph, &area)) {
+			if (!group->scheduleAreaWhenPossible(graph, &area, priority)) {
 				canBeExecuted = false;
 			}
 		}
@@ -607,7 +644,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 	}
 
 	if (canBeExecuted) {
-		scheduleChunk(chunkNumber);
+		scheduleChunk(chunkNumber, priority);
 	}
 
 	return false;
@@ -208,11 +208,12 @@ private:
 	 * @param graph
 	 * @param xChunk
 	 * @param yChunk
+	 * @param priority priority of the scheduled packages, depending packages inherit it
 	 * @return [true:false]
 	 * true: package(s) are scheduled
 	 * false: scheduling is deferred (depending workpackages are scheduled)
 	 */
-	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk, unsigned int priority);
 
 	/**
 	 * @brief try to schedule a specific area.
@@ -220,17 +221,19 @@ private:
 	 * @note This method is called from other ExecutionGroup's.
 	 * @param graph
 	 * @param rect
+	 * @param priority priority of the scheduled packages
 	 * @return [true:false]
 	 * true: package(s) are scheduled
 	 * false: scheduling is deferred (depending workpackages are scheduled)
 	 */
-	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
+	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect, unsigned int priority);
 
 	/**
 	 * @brief add a chunk to the WorkScheduler.
 	 * @param chunknumber
+	 * @param priority priority of the package, lower values are executed first
 	 */
-	bool scheduleChunk(unsigned int chunkNumber);
+	bool scheduleChunk(unsigned int chunkNumber, unsigned int priority);
 	
 	/**
 	 * @brief determine the area of interest of a certain input area
@@ -405,6 +408,17 @@ public:
 
 	void setChunksize(int chunksize) { this->m_chunkSize = chunksize; }
 
+	/**
+	 * @brief mark all chunks as executed, when the result is already available
+	 * @note only call after initExecution
+	 */
+	void setExecuted();
+
+	/**
+	 * @brief have all chunks of this ExecutionGroup been executed
+	 */
+	bool isExecuted() const;
+
 	/**
 	 * @brief get the Render priority of this ExecutionGroup
 	 * @see ExecutionSystem.execute
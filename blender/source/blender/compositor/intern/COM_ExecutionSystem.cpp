@@ -22,6 +22,9 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <typeinfo>
+#include <string.h>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
 extern "C" {
@@ -38,7 +41,9 @@ extern "C" {
 #include "COM_WriteBufferOperation.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_ExecutionSystemHelper.h"
+#include "COM_DownscaleOperation.h"
 #include "COM_Debug.h"
+#include "COM_Profiler.h"
 
 #include "BKE_global.h"
 
@@ -58,8 +63,11 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool re
 	}
 	else {
 		this->m_context.setQuality((CompositorQuality)editingtree->edit_quality);
+		this->m_context.setResolutionDivider(1 << CLAMPIS(editingtree->edit_resolution, 0, NTREE_RESOLUTION_EIGHTH));
 	}
 	this->m_context.setRendering(rendering);
+	/* results are only reused while editing, a render composites every frame once */
+	this->m_context.setResultCacheLimit((rendering) ? 0 : COM_RESULT_CACHE_LIMIT);
 	this->m_context.setHasActiveOpenCLDevices(WorkScheduler::hasGPUDevices() && (editingtree->flag & NTREE_COM_OPENCL));
 
 	ExecutionSystemHelper::addbNodeTree(*this, 0, editingtree, NODE_INSTANCE_KEY_BASE);
@@ -131,6 +139,7 @@ ExecutionSystem::~ExecutionSystem()
 void ExecutionSystem::execute()
 {
 	DebugInfo::execute_started(this);
+	Profiler::executionStarted(this);
 	
 	unsigned int order = 0;
 	for (vector<NodeOperation *>::iterator iter = this->m_operations.begin(); iter != this->m_operations.end(); ++iter) {
@@ -144,6 +153,13 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
+	this->determineMemoryProxyDataTypes();
+
+	/* bound memory usage of renders, while editing all buffers are kept for the result cache */
+	if (this->m_context.isRendering()) {
+		this->initAllocateOnDemand();
+	}
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->setbNodeTree(this->m_context.getbNodeTree());
@@ -162,6 +178,8 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	this->restoreCachedResults();
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -173,6 +191,10 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	Profiler::executionFinished(this);
+
+	this->storeCachedResults();
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->deinitExecution();
@@ -191,7 +213,111 @@ void ExecutionSystem::executeGroups(CompositorPriority priority)
 
 	for (index = 0; index < executionGroups.size(); index++) {
 		ExecutionGroup *group = executionGroups[index];
+		this->allocateMemoryProxies(group);
 		group->execute(this);
+		this->freeMemoryProxies(group);
+	}
+}
+
+void ExecutionSystem::findDependingMemoryProxies(ExecutionGroup *group, set<MemoryProxy *> *result) const
+{
+	vector<MemoryProxy *> memoryProxies;
+	unsigned int index;
+
+	group->determineDependingMemoryProxies(&memoryProxies);
+
+	for (index = 0; index < memoryProxies.size(); index++) {
+		MemoryProxy *memoryProxy = memoryProxies[index];
+		if (result->insert(memoryProxy).second && memoryProxy->getExecutor()) {
+			findDependingMemoryProxies(memoryProxy->getExecutor(), result);
+		}
+	}
+}
+
+void ExecutionSystem::initAllocateOnDemand()
+{
+	vector<ExecutionGroup *> outputGroups;
+	unsigned int index;
+
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			writeOperation->getMemoryProxy()->setAllocateOnDemand(true);
+		}
+	}
+
+	this->findOutputExecutionGroup(&outputGroups);
+	for (index = 0; index < outputGroups.size(); index++) {
+		set<MemoryProxy *> memoryProxies;
+		this->findDependingMemoryProxies(outputGroups[index], &memoryProxies);
+
+		for (set<MemoryProxy *>::iterator iter = memoryProxies.begin(); iter != memoryProxies.end(); ++iter) {
+			this->m_memoryProxyUsers[*iter]++;
+		}
+	}
+}
+
+void ExecutionSystem::allocateMemoryProxies(ExecutionGroup *group)
+{
+	if (this->m_memoryProxyUsers.empty()) {
+		return;
+	}
+
+	set<MemoryProxy *> memoryProxies;
+	bool allocated = false;
+	unsigned int index;
+
+	this->findDependingMemoryProxies(group, &memoryProxies);
+
+	for (set<MemoryProxy *>::iterator iter = memoryProxies.begin(); iter != memoryProxies.end(); ++iter) {
+		MemoryProxy *memoryProxy = *iter;
+		if (!memoryProxy->getBuffer()) {
+			WriteBufferOperation *writeOperation = memoryProxy->getWriteBufferOperation();
+			memoryProxy->allocate(writeOperation->getWidth(), writeOperation->getHeight());
+			allocated = true;
+		}
+	}
+
+	if (allocated) {
+		for (index = 0; index < this->m_operations.size(); index++) {
+			NodeOperation *operation = this->m_operations[index];
+			if (operation->isReadBufferOperation()) {
+				ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+				readOperation->updateMemoryBuffer();
+			}
+		}
+	}
+}
+
+void ExecutionSystem::freeMemoryProxies(ExecutionGroup *group)
+{
+	if (this->m_memoryProxyUsers.empty()) {
+		return;
+	}
+
+	set<MemoryProxy *> memoryProxies;
+	bool freed = false;
+	unsigned int index;
+
+	this->findDependingMemoryProxies(group, &memoryProxies);
+
+	for (set<MemoryProxy *>::iterator iter = memoryProxies.begin(); iter != memoryProxies.end(); ++iter) {
+		MemoryProxy *memoryProxy = *iter;
+		if (--this->m_memoryProxyUsers[memoryProxy] == 0) {
+			memoryProxy->free();
+			freed = true;
+		}
+	}
+
+	if (freed) {
+		for (index = 0; index < this->m_operations.size(); index++) {
+			NodeOperation *operation = this->m_operations[index];
+			if (operation->isReadBufferOperation()) {
+				ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+				readOperation->updateMemoryBuffer();
+			}
+		}
 	}
 }
 
@@ -201,6 +327,164 @@ void ExecutionSystem::addOperation(NodeOperation *operation)
 	DebugInfo::operation_added(operation);
 }
 
+void ExecutionSystem::determineMemoryProxyDataTypes()
+{
+	unsigned int index;
+
+	/* store the channels of the data written to the buffer */
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			InputSocket *inputSocket = writeOperation->getInputSocket(0);
+			DataType datatype = COM_DT_COLOR;
+			if (inputSocket->isConnected()) {
+				SocketConnection *connection = inputSocket->getConnection();
+				NodeOperation *inputOperation = (NodeOperation *)connection->getFromNode();
+				/* OpenCL execution reads back color images */
+				if (!inputOperation->isOpenCL()) {
+					datatype = connection->getFromSocket()->getDataType();
+				}
+			}
+			writeOperation->getMemoryProxy()->setDataType(datatype);
+		}
+	}
+
+	/* complex and OpenCL operations access the buffers of their inputs directly as colors */
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isReadBufferOperation()) {
+			ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+			OutputSocket *outputSocket = readOperation->getOutputSocket();
+			for (int i = 0; i < outputSocket->getNumberOfConnections(); i++) {
+				NodeOperation *readingOperation = (NodeOperation *)outputSocket->getConnection(i)->getToNode();
+				if (readingOperation->isComplex() || readingOperation->isOpenCL()) {
+					readOperation->getMemoryProxy()->setDataType(COM_DT_COLOR);
+				}
+			}
+		}
+	}
+}
+
+bool ExecutionSystem::determineResultCacheKey(NodeOperation *operation, map<NodeOperation *, ResultCacheKey> &keys,
+                                              ResultCacheKey *r_key)
+{
+	map<NodeOperation *, ResultCacheKey>::iterator found = keys.find(operation);
+	if (found != keys.end()) {
+		*r_key = found->second;
+		return (*r_key != 0);
+	}
+
+	ResultCacheKey key = ResultCache::keyInit(&this->m_context);
+	const char *name = typeid(*operation).name();
+	unsigned int resolution[2] = {operation->getWidth(), operation->getHeight()};
+	bool cacheable = true;
+
+	ResultCache::keyAdd(&key, name, strlen(name));
+	ResultCache::keyAdd(&key, resolution, sizeof(resolution));
+
+	/* operations added by converters only depend on their inputs and resolution */
+	map<NodeOperation *, bNode *>::iterator node = this->m_operationNodes.find(operation);
+	if (node != this->m_operationNodes.end()) {
+		cacheable = ResultCache::keyAddNode(&key, node->second);
+	}
+
+	if (operation->isReadBufferOperation()) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		ResultCacheKey inputKey = 0;
+		cacheable &= determineResultCacheKey(readOperation->getMemoryProxy()->getWriteBufferOperation(), keys, &inputKey);
+		ResultCache::keyAdd(&key, &inputKey, sizeof(inputKey));
+	}
+
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+		InputSocket *inputSocket = operation->getInputSocket(index);
+		int resizeMode = inputSocket->getResizeMode();
+
+		ResultCache::keyAdd(&key, &resizeMode, sizeof(resizeMode));
+
+		if (inputSocket->isConnected()) {
+			SocketConnection *connection = inputSocket->getConnection();
+			NodeOperation *inputOperation = (NodeOperation *)connection->getFromNode();
+			ResultCacheKey inputKey = 0;
+
+			cacheable &= determineResultCacheKey(inputOperation, keys, &inputKey);
+			ResultCache::keyAdd(&key, &inputKey, sizeof(inputKey));
+
+			for (unsigned int output = 0; output < inputOperation->getNumberOfOutputSockets(); output++) {
+				if (inputOperation->getOutputSocket(output) == connection->getFromSocket()) {
+					ResultCache::keyAdd(&key, &output, sizeof(output));
+				}
+			}
+		}
+	}
+
+	/* 0 marks results that can't be cached */
+	if (!cacheable) {
+		key = 0;
+	}
+	else if (key == 0) {
+		key = 1;
+	}
+
+	keys[operation] = key;
+	*r_key = key;
+	return cacheable;
+}
+
+void ExecutionSystem::restoreCachedResults()
+{
+	if (this->m_context.getResultCacheLimit() == 0) {
+		return;
+	}
+
+	map<NodeOperation *, ResultCacheKey> keys;
+	unsigned int index;
+
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+			ResultCacheKey key;
+
+			if (!memoryProxy->getExecutor() || !determineResultCacheKey(writeOperation, keys, &key)) {
+				continue;
+			}
+
+			this->m_resultCacheKeys[writeOperation] = key;
+
+			if (ResultCache::restore(key, memoryProxy->getBuffer())) {
+				memoryProxy->getBuffer()->setCreatedState();
+				memoryProxy->getExecutor()->setExecuted();
+			}
+		}
+	}
+}
+
+void ExecutionSystem::storeCachedResults()
+{
+	const bNodeTree *tree = this->m_context.getbNodeTree();
+	size_t limit = this->m_context.getResultCacheLimit();
+
+	/* results of a cancelled execution may be incomplete */
+	if (limit == 0 || tree->test_break(tree->tbh)) {
+		return;
+	}
+
+	for (map<NodeOperation *, ResultCacheKey>::iterator iter = this->m_resultCacheKeys.begin();
+	     iter != this->m_resultCacheKeys.end();
+	     ++iter)
+	{
+		WriteBufferOperation *writeOperation = (WriteBufferOperation *)iter->first;
+		MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+
+		/* groups only calculate the chunks needed, with borders or fast calculation */
+		if (memoryProxy->getExecutor()->isExecuted()) {
+			ResultCache::store(iter->second, memoryProxy->getBuffer(), limit);
+		}
+	}
+}
+
 void ExecutionSystem::addReadWriteBufferOperations(NodeOperation *operation)
 {
 	DebugInfo::operation_read_write_buffer(operation);
@@ -287,9 +571,14 @@ void ExecutionSystem::convertToOperations()
 
 	for (index = 0; index < this->m_nodes.size(); index++) {
 		Node *node = (Node *)this->m_nodes[index];
+		unsigned int firstOperation = this->m_operations.size();
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(this, &this->m_context);
 
+		for (unsigned int i = firstOperation; i < this->m_operations.size(); i++) {
+			this->m_operationNodes[this->m_operations[i]] = node->getbNode();
+		}
+
 		debug_check_node_connections(node);
 	}
 
@@ -302,6 +591,11 @@ void ExecutionSystem::convertToOperations()
 		}
 	}
 
+	/* in draft mode images are downscaled once, the rest of the tree runs at the lower resolution */
+	if (this->m_context.getResolutionDivider() > 1) {
+		this->addDownscaleOperations();
+	}
+
 	// determine all resolutions of the operations (Width/Height)
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -333,6 +627,32 @@ void ExecutionSystem::convertToOperations()
 	}
 }
 
+void ExecutionSystem::addDownscaleOperations()
+{
+	const unsigned int numberOfOperations = this->m_operations.size();
+	unsigned int index;
+
+	for (index = 0; index < numberOfOperations; index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (!operation->isImageSourceOperation()) {
+			continue;
+		}
+
+		for (unsigned int output = 0; output < operation->getNumberOfOutputSockets(); output++) {
+			OutputSocket *outputSocket = operation->getOutputSocket(output);
+			if (!outputSocket->isConnected()) {
+				continue;
+			}
+
+			DownscaleOperation *downscale = new DownscaleOperation(outputSocket->getDataType());
+			downscale->setDivider(this->m_context.getResolutionDivider());
+			outputSocket->relinkConnections(downscale->getOutputSocket());
+			ExecutionSystemHelper::addLink(this->getConnections(), outputSocket, downscale->getInputSocket(0));
+			this->addOperation(downscale);
+		}
+	}
+}
+
 void ExecutionSystem::groupOperations()
 {
 	vector<NodeOperation *> outputOperations;
@@ -28,11 +28,14 @@ class ExecutionGroup;
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
 #include <vector>
+#include <map>
+#include <set>
 #include "COM_Node.h"
 #include "COM_SocketConnection.h"
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_NodeOperation.h"
+#include "COM_ResultCache.h"
 
 using namespace std;
 
@@ -141,6 +144,22 @@ private:
 	 */
 	vector<SocketConnection *> m_connections;
 
+	/**
+	 * @brief editor node each operation was created for, to key cached results
+	 */
+	map<NodeOperation *, bNode *> m_operationNodes;
+
+	/**
+	 * @brief keys of the results of WriteBufferOperations that can be cached
+	 */
+	map<NodeOperation *, ResultCacheKey> m_resultCacheKeys;
+
+	/**
+	 * @brief number of output ExecutionGroups still to be executed that depend on a MemoryProxy,
+	 * only filled when buffers are allocated on demand
+	 */
+	map<MemoryProxy *, int> m_memoryProxyUsers;
+
 private: //methods
 	/**
 	 * @brief add ReadBufferOperation and WriteBufferOperation around an operation
@@ -148,6 +167,54 @@ private: //methods
 	 */
 	void addReadWriteBufferOperations(NodeOperation *operation);
 
+	/**
+	 * @brief determine the datatypes of the MemoryProxies, so buffers of values and vectors
+	 * store less channels when only read per pixel
+	 */
+	void determineMemoryProxyDataTypes();
+
+	/**
+	 * @brief determine the key of the result of an operation, from the settings and
+	 * resolutions of all operations upstream of it
+	 * @return false if the result depends on data that can't be hashed
+	 */
+	bool determineResultCacheKey(NodeOperation *operation, map<NodeOperation *, ResultCacheKey> &keys, ResultCacheKey *r_key);
+
+	/**
+	 * @brief fill buffers with results cached by a previous execution, and skip their ExecutionGroups
+	 * @note called after the initialization of operations and groups
+	 */
+	void restoreCachedResults();
+
+	/**
+	 * @brief store the buffers of completely executed ExecutionGroups in the result cache
+	 */
+	void storeCachedResults();
+
+	/**
+	 * @brief find the MemoryProxies an ExecutionGroup reads, directly or through the groups writing them
+	 */
+	void findDependingMemoryProxies(ExecutionGroup *group, set<MemoryProxy *> *result) const;
+
+	/**
+	 * @brief let the buffers of all MemoryProxies be allocated when an output ExecutionGroup needs them
+	 * and freed as soon as none of the output groups still to be executed depends on them.
+	 * Peak memory is then bounded by the buffers of a single output group and the ones they share,
+	 * instead of all buffers of the tree.
+	 * @note called before the initialization of the operations
+	 */
+	void initAllocateOnDemand();
+
+	/**
+	 * @brief allocate the buffers an output ExecutionGroup depends on
+	 */
+	void allocateMemoryProxies(ExecutionGroup *group);
+
+	/**
+	 * @brief free the buffers no output ExecutionGroup still to be executed depends on
+	 * @param group the output ExecutionGroup that finished executing
+	 */
+	void freeMemoryProxies(ExecutionGroup *group);
 
 	/**
 	 * find all execution group with output nodes
@@ -208,6 +275,12 @@ public:
 	 */
 	void convertToOperations();
 
+	/**
+	 * @brief downscale the outputs of image sources in draft mode
+	 * @see CompositorContext.getResolutionDivider
+	 */
+	void addDownscaleOperations();
+
 	/**
 	 * @brief group operations in ExecutionGroup's
 	 * @see ExecutionGroup
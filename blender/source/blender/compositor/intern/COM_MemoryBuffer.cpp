@@ -24,11 +24,30 @@
 #include "MEM_guardedalloc.h"
 //#include "BKE_global.h"
 
+extern "C" {
+	#include "BLI_threads.h"
+}
+
+/* guards creation of pyramid levels, which happens while sampling threads read the buffer */
+static ThreadMutex g_pyramidMutex = BLI_MUTEX_INITIALIZER;
+
 unsigned int MemoryBuffer::determineBufferSize()
 {
 	return getWidth() * getHeight();
 }
 
+static unsigned int determine_number_of_channels(DataType datatype)
+{
+	switch (datatype) {
+		case COM_DT_VALUE:
+			return 1;
+		case COM_DT_VECTOR:
+			return 3;
+		default:
+			return COM_NUMBER_OF_CHANNELS;
+	}
+}
+
 int MemoryBuffer::getWidth() const
 {
 	return this->m_rect.xmax - this->m_rect.xmin;
@@ -43,10 +62,12 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = (memoryProxy) ? memoryProxy->getDataType() : COM_DT_COLOR;
+	this->m_numberOfChannels = determine_number_of_channels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_numberOfChannels, "COM_MemoryBuffer");
 	this->m_state = COM_MB_ALLOCATED;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
+	this->m_pyramid = NULL;
 }
 
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
@@ -54,20 +75,22 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = -1;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = (memoryProxy) ? memoryProxy->getDataType() : COM_DT_COLOR;
+	this->m_numberOfChannels = determine_number_of_channels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_numberOfChannels, "COM_MemoryBuffer");
 	this->m_state = COM_MB_TEMPORARILY;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
+	this->m_pyramid = NULL;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
 	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_numberOfChannels * sizeof(float));
 	return result;
 }
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	memset(this->m_buffer, 0, this->determineBufferSize() * this->m_numberOfChannels * sizeof(float));
 }
 
 float *MemoryBuffer::convertToValueBuffer()
@@ -80,7 +103,7 @@ float *MemoryBuffer::convertToValueBuffer()
 	const float *fp_src = this->m_buffer;
 	float       *fp_dst = result;
 
-	for (i = 0; i < size; i++, fp_dst++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_dst++, fp_src += this->m_numberOfChannels) {
 		*fp_dst = *fp_src;
 	}
 
@@ -95,7 +118,7 @@ float MemoryBuffer::getMaximumValue()
 
 	const float *fp_src = this->m_buffer;
 
-	for (i = 0; i < size; i++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_src += this->m_numberOfChannels) {
 		float value = *fp_src;
 		if (value > result) {
 			result = value;
@@ -131,6 +154,47 @@ MemoryBuffer::~MemoryBuffer()
 		MEM_freeN(this->m_buffer);
 		this->m_buffer = NULL;
 	}
+	if (this->m_pyramid) {
+		delete this->m_pyramid;
+		this->m_pyramid = NULL;
+	}
+}
+
+MemoryBuffer *MemoryBuffer::getPyramidLevel()
+{
+	if (this->m_pyramid == NULL) {
+		BLI_mutex_lock(&g_pyramidMutex);
+		if (this->m_pyramid == NULL) {
+			const int width = this->getWidth(), height = this->getHeight();
+			const unsigned int channels = this->m_numberOfChannels;
+			rcti rect;
+			BLI_rcti_init(&rect, 0, (width + 1) / 2, 0, (height + 1) / 2);
+
+			MemoryBuffer *level = new MemoryBuffer(this->m_memoryProxy, this->m_chunkNumber, &rect);
+			float *dst = level->m_buffer;
+
+			/* 2x2 box filter, odd sizes repeat the last row and column */
+			for (int y = 0; y < rect.ymax; y++) {
+				const float *row1 = &this->m_buffer[(2 * y) * this->m_chunkWidth * channels];
+				const float *row2 = &this->m_buffer[min_ii(2 * y + 1, height - 1) * this->m_chunkWidth * channels];
+
+				for (int x = 0; x < rect.xmax; x++, dst += channels) {
+					const int x1 = 2 * x * channels;
+					const int x2 = min_ii(2 * x + 1, width - 1) * channels;
+
+					for (unsigned int c = 0; c < channels; c++) {
+						dst[c] = 0.25f * (row1[x1 + c] + row1[x2 + c] + row2[x1 + c] + row2[x2 + c]);
+					}
+				}
+			}
+
+			level->setCreatedState();
+			this->m_pyramid = level;
+		}
+		BLI_mutex_unlock(&g_pyramidMutex);
+	}
+
+	return this->m_pyramid;
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -139,6 +203,7 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 		BLI_assert(0);
 		return;
 	}
+	BLI_assert(this->m_numberOfChannels == otherBuffer->m_numberOfChannels);
 	unsigned int otherY;
 	unsigned int minX = max(this->m_rect.xmin, otherBuffer->m_rect.xmin);
 	unsigned int maxX = min(this->m_rect.xmax, otherBuffer->m_rect.xmax);
@@ -149,9 +214,9 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 
 
 	for (otherY = minY; otherY < maxY; otherY++) {
-		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * this->m_numberOfChannels;
+		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * this->m_numberOfChannels;
+		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * this->m_numberOfChannels * sizeof(float));
 	}
 }
 
@@ -160,8 +225,8 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		copy_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_numberOfChannels;
+		memcpy(&this->m_buffer[offset], color, this->m_numberOfChannels * sizeof(float));
 	}
 }
 
@@ -170,8 +235,10 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		add_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_numberOfChannels;
+		for (unsigned int i = 0; i < this->m_numberOfChannels; i++) {
+			this->m_buffer[offset + i] += color[i];
+		}
 	}
 }
 
@@ -179,6 +246,9 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 // table of (exp(ar) - exp(a)) / (1 - exp(a)) for r in range [0, 1] and a = -2
 // used instead of actual gaussian, otherwise at high texture magnifications circular artifacts are visible
 #define EWA_MAXIDX 255
+/* footprints with a radius in texels larger than this are filtered at a
+ * coarser pyramid level, limiting the number of texels visited per sample */
+#define EWA_MAX_RADIUS 4.0f
 static const float EWA_WTS[EWA_MAXIDX + 1] = {
 	1.f, 0.990965f, 0.982f, 0.973105f, 0.96428f, 0.955524f, 0.946836f, 0.938216f, 0.929664f,
 	0.921178f, 0.912759f, 0.904405f, 0.896117f, 0.887893f, 0.879734f, 0.871638f, 0.863605f,
@@ -311,6 +381,15 @@ void MemoryBuffer::readEWA(float result[4], float fx, float fy, float dx, float
 	B *= d;
 	C *= d;
 
+	/* large footprint, filter the half resolution level instead. dx and dy are
+	 * relative to the buffer size so they are the same for that level */
+	if (min_ff(ue, ve) > EWA_MAX_RADIUS && width > 1 && height > 1 &&
+	    !this->isTemporarily() && this->m_rect.xmin == 0 && this->m_rect.ymin == 0)
+	{
+		this->getPyramidLevel()->readEWA(result, fx * 0.5f, fy * 0.5f, dx, dy, sampler);
+		return;
+	}
+
 	U0 = fx;
 	V0 = fy;
 	u1 = (int)(floorf(U0 - ue));
@@ -326,6 +405,34 @@ void MemoryBuffer::readEWA(float result[4], float fx, float fy, float dx, float
 	BU = B * U;
 
 	d = result[0] = result[1] = result[2] = result[3] = 0.f;
+
+#ifdef __SSE__
+	/* accumulate all channels at once for color buffers */
+	if (this->m_numberOfChannels == COM_NUMBER_OF_CHANNELS && this->m_rect.xmin == 0 && this->m_rect.ymin == 0) {
+		__m128 accum = _mm_setzero_ps();
+
+		for (v = v1; v <= v2; ++v) {
+			const float V = v - V0;
+			const float *row = &this->m_buffer[(int)clipuv(v, height) * this->m_chunkWidth * COM_NUMBER_OF_CHANNELS];
+			float DQ = ac1 + B * V;
+			float Q = (C * V + BU) * V + ac2;
+			for (u = u1; u <= u2; ++u) {
+				if (Q < (float)(EWA_MAXIDX + 1)) {
+					const float wt = EWA_WTS[(Q < 0.f) ? 0 : (unsigned int)Q];
+					const __m128 tc = _mm_loadu_ps(&row[(int)clipuv(u, width) * COM_NUMBER_OF_CHANNELS]);
+					accum = _mm_add_ps(accum, _mm_mul_ps(tc, _mm_set1_ps(wt)));
+					d += wt;
+				}
+				Q += DQ;
+				DQ += DDQ;
+			}
+		}
+
+		_mm_storeu_ps(result, _mm_mul_ps(accum, _mm_set1_ps(1.f / d)));
+		return;
+	}
+#endif
+
 	for (v = v1; v <= v2; ++v) {
 		const float V = v - V0;
 		float DQ = ac1 + B * V;
@@ -33,6 +33,10 @@ extern "C" {
 	#include "BLI_rect.h"
 }
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 /**
  * @brief state of a memory buffer
  * @ingroup Memory
@@ -68,6 +72,11 @@ private:
 	 * @brief the type of buffer COM_DT_VALUE, COM_DT_VECTOR, COM_DT_COLOR
 	 */
 	DataType m_datatype;
+
+	/**
+	 * @brief number of floats stored per pixel, 1, 3 or 4 depending on the datatype
+	 */
+	unsigned int m_numberOfChannels;
 	
 	
 	/**
@@ -96,6 +105,17 @@ private:
 	 */
 	float *m_buffer;
 
+	/**
+	 * @brief half resolution copy of this buffer, used by EWA filtering of large footprints
+	 * @note created on first use by readEWA, each level owns the next coarser one
+	 */
+	MemoryBuffer *volatile m_pyramid;
+
+	/**
+	 * @brief get the half resolution level of this buffer, creating it when needed
+	 */
+	MemoryBuffer *getPyramidLevel();
+
 public:
 	/**
 	 * @brief construct new MemoryBuffer for a chunk
@@ -122,6 +142,31 @@ public:
 	 * @note buffer should already be available in memory
 	 */
 	float *getBuffer() { return this->m_buffer; }
+
+	/**
+	 * @brief get the number of floats stored per pixel
+	 * @note only COM_DT_COLOR buffers can be accessed as float4 through getBuffer
+	 */
+	unsigned int getNumberOfChannels() const { return this->m_numberOfChannels; }
+	DataType getDataType() const { return this->m_datatype; }
+	
+	/**
+	 * @brief read the stored channels of a pixel to a float4
+	 */
+	inline void readChannels(float result[4], const float *buffer)
+	{
+		if (this->m_numberOfChannels == COM_NUMBER_OF_CHANNELS) {
+			copy_v4_v4(result, buffer);
+		}
+		else if (this->m_numberOfChannels == 1) {
+			result[0] = buffer[0];
+			result[1] = result[2] = result[3] = 0.0f;
+		}
+		else {
+			copy_v3_v3(result, buffer);
+			result[3] = 0.0f;
+		}
+	}
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -175,8 +220,8 @@ public:
 		}
 		else {
 			wrap_pixel(x, y, extend_x, extend_y);
-			const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
-			copy_v4_v4(result, &this->m_buffer[offset]);
+			const int offset = (this->m_chunkWidth * y + x) * this->m_numberOfChannels;
+			readChannels(result, &this->m_buffer[offset]);
 		}
 	}
 
@@ -185,20 +230,20 @@ public:
 	                        MemoryBufferExtend extend_y = COM_MB_CLIP)
 	{
 		wrap_pixel(x, y, extend_x, extend_y);
-		const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
+		const int offset = (this->m_chunkWidth * y + x) * this->m_numberOfChannels;
 
 		BLI_assert(offset >= 0);
-		BLI_assert(offset < this->determineBufferSize() * COM_NUMBER_OF_CHANNELS);
+		BLI_assert(offset < this->determineBufferSize() * this->m_numberOfChannels);
 		BLI_assert(!(extend_x == COM_MB_CLIP && (x < m_rect.xmin || x >= m_rect.xmax)) &&
 		           !(extend_y == COM_MB_CLIP && (y < m_rect.ymin || y >= m_rect.ymax)));
 
 #if 0
 		/* always true */
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
-		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
+		           (int)(this->determineBufferSize() * this->m_numberOfChannels));
 #endif
 
-		copy_v4_v4(result, &this->m_buffer[offset]);
+		readChannels(result, &this->m_buffer[offset]);
 	}
 	
 	void writePixel(int x, int y, const float color[4]);
@@ -209,6 +254,32 @@ public:
 	{
 		int x1 = floor(x);
 		int y1 = floor(y);
+
+#ifdef __SSE__
+		/* fast path for color buffers when all four pixels are inside the buffer,
+		 * interpolating all channels at once */
+		if (this->m_numberOfChannels == COM_NUMBER_OF_CHANNELS &&
+		    x1 >= this->m_rect.xmin && x1 + 1 < this->m_rect.xmax &&
+		    y1 >= this->m_rect.ymin && y1 + 1 < this->m_rect.ymax)
+		{
+			const float *row1 = &this->m_buffer[((y1 - this->m_rect.ymin) * this->m_chunkWidth +
+			                                     (x1 - this->m_rect.xmin)) * COM_NUMBER_OF_CHANNELS];
+			const float *row2 = row1 + this->m_chunkWidth * COM_NUMBER_OF_CHANNELS;
+			const __m128 valuex = _mm_set1_ps(x - x1);
+			const __m128 valuey = _mm_set1_ps(y - y1);
+			const __m128 mvaluex = _mm_set1_ps(1.0f - (x - x1));
+			const __m128 mvaluey = _mm_set1_ps(1.0f - (y - y1));
+
+			const __m128 color1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row1), mvaluey),
+			                                 _mm_mul_ps(_mm_loadu_ps(row2), valuey));
+			const __m128 color3 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row1 + COM_NUMBER_OF_CHANNELS), mvaluey),
+			                                 _mm_mul_ps(_mm_loadu_ps(row2 + COM_NUMBER_OF_CHANNELS), valuey));
+
+			_mm_storeu_ps(result, _mm_add_ps(_mm_mul_ps(color1, mvaluex), _mm_mul_ps(color3, valuex)));
+			return;
+		}
+#endif
+
 		int x2 = x1 + 1;
 		int y2 = y1 + 1;
 		wrap_pixel(x1, y1, extend_x, extend_y);
@@ -251,6 +322,11 @@ public:
 	 * @brief is this MemoryBuffer a temporarily buffer (based on an area, not on a chunk)
 	 */
 	inline const bool isTemporarily() const { return this->m_state == COM_MB_TEMPORARILY; }
+
+	/**
+	 * @brief get the MemoryProxy this MemoryBuffer stores data of
+	 */
+	MemoryProxy *getMemoryProxy() { return this->m_memoryProxy; }
 	
 	/**
 	 * @brief add the content from otherBuffer to this MemoryBuffer
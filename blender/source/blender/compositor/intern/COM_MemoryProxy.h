@@ -48,9 +48,9 @@ private:
 	ExecutionGroup *m_executor;
 	
 	/**
-	 * @brief datatype of this MemoryProxy
+	 * @brief datatype of this MemoryProxy, determines the number of channels stored
 	 */
-	/* DataType m_datatype; */ /* UNUSED */
+	DataType m_datatype;
 	
 	/**
 	 * @brief channel information of this buffer
@@ -62,6 +62,12 @@ private:
 	 */
 	MemoryBuffer *m_buffer;
 
+	/**
+	 * @brief memory is allocated by the ExecutionSystem when an ExecutionGroup needs it,
+	 * instead of during the initialization of the WriteBufferOperation
+	 */
+	bool m_allocateOnDemand;
+
 public:
 	MemoryProxy();
 	
@@ -98,11 +104,33 @@ public:
 	 */
 	void free();
 
+	/**
+	 * @brief set if the memory is allocated when needed by an ExecutionGroup
+	 * @see ExecutionSystem.allocateMemoryProxies
+	 */
+	void setAllocateOnDemand(bool allocateOnDemand) { this->m_allocateOnDemand = allocateOnDemand; }
+
+	/**
+	 * @brief is the memory allocated when needed by an ExecutionGroup
+	 */
+	bool isAllocatedOnDemand() const { return this->m_allocateOnDemand; }
+
 	/**
 	 * @brief get the allocated memory
 	 */
 	inline MemoryBuffer *getBuffer() { return this->m_buffer; }
 
+	/**
+	 * @brief set the datatype of the data written to this MemoryProxy
+	 * @note buffers read directly by complex or OpenCL operations must stay COM_DT_COLOR
+	 */
+	void setDataType(DataType datatype) { this->m_datatype = datatype; }
+
+	/**
+	 * @brief get the datatype of this MemoryProxy
+	 */
+	DataType getDataType() const { return this->m_datatype; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
@@ -248,6 +248,13 @@ public:
 	
 	virtual bool isViewerOperation() { return false; }
 	virtual bool isPreviewOperation() { return false; }
+
+	/**
+	 * @brief is this operation reading an image at the resolution of the image, like image and render layer inputs.
+	 * In draft mode their outputs are downscaled.
+	 * @see DownscaleOperation
+	 */
+	virtual bool isImageSourceOperation() const { return false; }
 	virtual bool isFileOutputOperation() { return false; }
 	
 	inline bool isBreaked() {
@@ -65,6 +65,43 @@ void OpenCLDevice::execute(WorkPackage *work)
 	
 	executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
 }
+
+cl_mem OpenCLDevice::getResidentImage(MemoryBuffer *memoryBuffer)
+{
+	MemoryProxy *memoryProxy = memoryBuffer->getMemoryProxy();
+	map<MemoryProxy *, cl_mem>::iterator found = this->m_residentImages.find(memoryProxy);
+	cl_int error;
+
+	if (found != this->m_residentImages.end()) {
+		return found->second;
+	}
+
+	const cl_image_format imageFormat = {
+		CL_RGBA,
+		CL_FLOAT
+	};
+
+	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, &imageFormat, memoryBuffer->getWidth(),
+	                                  memoryBuffer->getHeight(), 0, memoryBuffer->getBuffer(), &error);
+
+	if (error != CL_SUCCESS) {
+		printf("CLERROR[%d]: %s\n", error, clewErrorString(error));
+		return NULL;
+	}
+
+	this->m_residentImages[memoryProxy] = clBuffer;
+	return clBuffer;
+}
+
+void OpenCLDevice::releaseResidentImages()
+{
+	for (map<MemoryProxy *, cl_mem>::iterator iter = this->m_residentImages.begin(); iter != this->m_residentImages.end(); ++iter) {
+		cl_int error = clReleaseMemObject(iter->second);
+		if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error)); }
+	}
+	this->m_residentImages.clear();
+}
+
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel, int parameterIndex, int offsetIndex,
                                                                list<cl_mem> *cleanup, MemoryBuffer **inputMemoryBuffers,
                                                                SocketReader *reader)
@@ -79,17 +116,24 @@ cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
 	cl_int error;
 	
 	MemoryBuffer *result = reader->getInputMemoryBuffer(inputMemoryBuffers);
+	cl_mem clBuffer;
 
-	const cl_image_format imageFormat = {
-		CL_RGBA,
-		CL_FLOAT
-	};
+	if (!result->isTemporarily()) {
+		/* complete buffers are shared by all chunks, only upload them once */
+		clBuffer = getResidentImage(result);
+	}
+	else {
+		const cl_image_format imageFormat = {
+			CL_RGBA,
+			CL_FLOAT
+		};
 
-	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, &imageFormat, result->getWidth(),
-	                                  result->getHeight(), 0, result->getBuffer(), &error);
+		clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, &imageFormat, result->getWidth(),
+		                           result->getHeight(), 0, result->getBuffer(), &error);
 
-	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
-	if (error == CL_SUCCESS) cleanup->push_back(clBuffer);
+		if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
+		if (error == CL_SUCCESS) cleanup->push_back(clBuffer);
+	}
 
 	error = clSetKernelArg(kernel, parameterIndex, sizeof(cl_mem), &clBuffer);
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
@@ -25,6 +25,7 @@ class OpenCLDevice;
 #ifndef _COM_OpenCLDevice_h
 #define _COM_OpenCLDevice_h
 
+#include <map>
 #include "COM_Device.h"
 #include "OCL_opencl.h"
 #include "COM_WorkScheduler.h"
@@ -61,6 +62,17 @@ private:
 	 */
 	cl_int m_vendorID;
 
+	/**
+	 * @brief images of completely calculated buffers, uploaded once and kept on the device
+	 * for all chunks reading them
+	 */
+	map<MemoryProxy *, cl_mem> m_residentImages;
+
+	/**
+	 * @brief get the image of a completely calculated buffer, uploading it when used the first time
+	 */
+	cl_mem getResidentImage(MemoryBuffer *memoryBuffer);
+
 public:
 	/**
 	 * @brief constructor with opencl device
@@ -92,6 +104,12 @@ public:
 	 */
 	void execute(WorkPackage *work);
 
+	/**
+	 * @brief release the images kept on the device
+	 * @note called when the execution stops, buffers can change between executions
+	 */
+	void releaseResidentImages();
+
 	cl_context getContext() { return this->m_context; }
 
 	cl_command_queue getQueue() { return this->m_queue; }
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <stdio.h>
+
+#include "COM_Profiler.h"
+#include "COM_compositor.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_MemoryProxy.h"
+#include "COM_WriteBufferOperation.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BKE_node.h"
+#include "PIL_time.h"
+}
+#include "BKE_global.h"
+
+typedef struct GroupStatistics {
+	/* time spent on chunks, summed over all threads */
+	double executionTime;
+	/* time chunks waited in the queues before being executed */
+	double waitTime;
+	/* first start and last end of a chunk, the wall time of the group */
+	double firstStart;
+	double lastEnd;
+	int chunks;
+} GroupStatistics;
+
+typedef struct NodeStatistics {
+	double executionTime;
+	double waitTime;
+	size_t memory;
+	int chunks;
+} NodeStatistics;
+
+typedef std::map<ExecutionGroup *, GroupStatistics> GroupStatisticsMap;
+typedef std::map<bNode *, NodeStatistics> NodeStatisticsMap;
+
+/* only the statistics of the groups are modified, the map itself is filled
+ * before the device threads start, so lookups don't need the lock */
+static GroupStatisticsMap g_groupStatistics;
+static ThreadMutex g_groupMutex = BLI_MUTEX_INITIALIZER;
+
+/* statistics of the last execution, read by the node editor */
+static NodeStatisticsMap g_nodeStatistics;
+static double g_nodeTotalTime = 0.0;
+static ThreadMutex g_nodeMutex = BLI_MUTEX_INITIALIZER;
+
+/**
+ * @brief the node a group is attributed to
+ */
+static bNode *group_node(ExecutionGroup *group)
+{
+	NodeOperation *operation = group->getOutputNodeOperation();
+	bNode *node;
+
+	if (operation->isWriteBufferOperation()) {
+		NodeOperation *input = ((WriteBufferOperation *)operation)->getInput();
+		if (input && input->getbNode()) {
+			operation = input;
+		}
+	}
+
+	node = operation->getbNode();
+	if (node && node->original) {
+		node = node->original;
+	}
+	return node;
+}
+
+/**
+ * @brief memory of the buffer a group writes to
+ */
+static size_t group_memory(ExecutionGroup *group)
+{
+	NodeOperation *operation = group->getOutputNodeOperation();
+	MemoryProxy *memoryProxy;
+	size_t channels;
+
+	if (!operation->isWriteBufferOperation()) {
+		return 0;
+	}
+
+	memoryProxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+	switch (memoryProxy->getDataType()) {
+		case COM_DT_VALUE:
+			channels = 1;
+			break;
+		case COM_DT_VECTOR:
+			channels = 3;
+			break;
+		default:
+			channels = COM_NUMBER_OF_CHANNELS;
+			break;
+	}
+	return (size_t)operation->getWidth() * operation->getHeight() * channels * sizeof(float);
+}
+
+static bool group_statistics_compare(const std::pair<ExecutionGroup *, GroupStatistics>& a,
+                                     const std::pair<ExecutionGroup *, GroupStatistics>& b)
+{
+	return a.second.executionTime > b.second.executionTime;
+}
+
+static void print_report(ExecutionSystem *system, double totalTime)
+{
+	std::vector<std::pair<ExecutionGroup *, GroupStatistics> > groups(g_groupStatistics.begin(), g_groupStatistics.end());
+	const bNodeTree *ntree = system->getContext().getbNodeTree();
+
+	std::sort(groups.begin(), groups.end(), group_statistics_compare);
+
+	printf("Compositor timings of %s, %.2f ms over %d groups:\n",
+	       ntree->id.name + 2, totalTime * 1000.0, (int)groups.size());
+	printf("  %-24s %10s %6s %10s %10s %7s %9s\n",
+	       "Node", "Time", "Share", "Wall", "Wait", "Chunks", "Memory");
+
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index].first;
+		const GroupStatistics& stats = groups[index].second;
+		bNode *node = group_node(group);
+
+		if (stats.chunks == 0) {
+			continue;
+		}
+
+		printf("  %-24s %8.2fms %5.1f%% %8.2fms %8.2fms %7d %8.2fM\n",
+		       (node) ? node->name : "(internal)",
+		       stats.executionTime * 1000.0,
+		       (totalTime > 0.0) ? 100.0 * stats.executionTime / totalTime : 0.0,
+		       (stats.lastEnd - stats.firstStart) * 1000.0,
+		       stats.waitTime * 1000.0,
+		       stats.chunks,
+		       group_memory(group) / (1024.0 * 1024.0));
+	}
+
+	fflush(stdout);
+}
+
+void Profiler::executionStarted(ExecutionSystem *system)
+{
+	vector<ExecutionGroup *>& groups = system->getExecutionGroups();
+	GroupStatistics empty = {0.0, 0.0, 0.0, 0.0, 0};
+
+	g_groupStatistics.clear();
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		g_groupStatistics[groups[index]] = empty;
+	}
+}
+
+void Profiler::chunkExecuted(ExecutionGroup *group, double waitTime, double executionTime)
+{
+	GroupStatisticsMap::iterator it = g_groupStatistics.find(group);
+	double end = PIL_check_seconds_timer();
+	double start = end - executionTime;
+
+	if (it == g_groupStatistics.end()) {
+		return;
+	}
+
+	BLI_mutex_lock(&g_groupMutex);
+	GroupStatistics& stats = it->second;
+	if (stats.chunks == 0 || start < stats.firstStart) {
+		stats.firstStart = start;
+	}
+	if (stats.chunks == 0 || end > stats.lastEnd) {
+		stats.lastEnd = end;
+	}
+	stats.executionTime += executionTime;
+	stats.waitTime += waitTime;
+	stats.chunks++;
+	BLI_mutex_unlock(&g_groupMutex);
+}
+
+void Profiler::executionFinished(ExecutionSystem *system)
+{
+	NodeStatisticsMap nodeStatistics;
+	double totalTime = 0.0;
+
+	for (GroupStatisticsMap::iterator it = g_groupStatistics.begin(); it != g_groupStatistics.end(); ++it) {
+		const GroupStatistics& stats = it->second;
+		bNode *node;
+
+		/* results restored from the cache are not executed */
+		if (stats.chunks == 0) {
+			continue;
+		}
+
+		totalTime += stats.executionTime;
+
+		node = group_node(it->first);
+		if (node) {
+			NodeStatistics& nodeStats = nodeStatistics[node];
+			nodeStats.executionTime += stats.executionTime;
+			nodeStats.waitTime += stats.waitTime;
+			nodeStats.memory += group_memory(it->first);
+			nodeStats.chunks += stats.chunks;
+		}
+	}
+
+	if (G.background) {
+		print_report(system, totalTime);
+	}
+
+	BLI_mutex_lock(&g_nodeMutex);
+	g_nodeStatistics.swap(nodeStatistics);
+	g_nodeTotalTime = totalTime;
+	BLI_mutex_unlock(&g_nodeMutex);
+
+	g_groupStatistics.clear();
+}
+
+extern "C" {
+int COM_getNodeTimings(bNode *bnode, double *r_time, float *r_factor, size_t *r_memory)
+{
+	int found = false;
+
+	BLI_mutex_lock(&g_nodeMutex);
+	NodeStatisticsMap::const_iterator it = g_nodeStatistics.find(bnode);
+	if (it != g_nodeStatistics.end()) {
+		*r_time = it->second.executionTime;
+		*r_factor = (g_nodeTotalTime > 0.0) ? (float)(it->second.executionTime / g_nodeTotalTime) : 0.0f;
+		*r_memory = it->second.memory;
+		found = true;
+	}
+	BLI_mutex_unlock(&g_nodeMutex);
+
+	return found;
+}
+} // end extern "C"
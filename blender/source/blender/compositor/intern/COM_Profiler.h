@@ -0,0 +1,62 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#ifndef _COM_Profiler_h_
+#define _COM_Profiler_h_
+
+class ExecutionSystem;
+class ExecutionGroup;
+
+/**
+ * @brief Collects execution statistics of the compositor.
+ * The time spent on chunks and the time chunks waited in the queues are
+ * accumulated per ExecutionGroup over all threads. When the execution finishes
+ * the statistics are attributed to the nodes of the groups, together with the
+ * memory of the buffers they write to, for the timings overlay of the node editor
+ * (COM_getNodeTimings) and the report of background renders.
+ *
+ * Time is measured per chunk, so the operations inside a group are not timed
+ * separately. A group is attributed to the node of its complex operation, or to
+ * the node of its output operation when it contains no complex operation.
+ * @ingroup Execution
+ */
+class Profiler {
+public:
+	/**
+	 * @brief clear the statistics of the groups, before execution starts
+	 */
+	static void executionStarted(ExecutionSystem *system);
+
+	/**
+	 * @brief add the timings of an executed chunk to its group
+	 * @note called from the device threads
+	 * @param group the group the chunk belongs to
+	 * @param waitTime time between scheduling the chunk and the start of its execution
+	 * @param executionTime time spent executing the chunk
+	 */
+	static void chunkExecuted(ExecutionGroup *group, double waitTime, double executionTime);
+
+	/**
+	 * @brief attribute the statistics to the nodes and publish them to the node editor,
+	 * in background mode a report is printed
+	 */
+	static void executionFinished(ExecutionSystem *system);
+};
+
+#endif
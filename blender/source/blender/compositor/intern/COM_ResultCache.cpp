@@ -0,0 +1,247 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include <map>
+#include <string.h>
+
+#include "COM_ResultCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+
+extern "C" {
+	#include "DNA_camera_types.h"
+	#include "DNA_node_types.h"
+	#include "DNA_object_types.h"
+	#include "DNA_scene_types.h"
+	#include "BKE_node.h"
+	#include "RE_pipeline.h"
+}
+
+#include "BKE_global.h"
+#include "MEM_guardedalloc.h"
+
+typedef struct ResultCacheEntry {
+	float *buffer;
+	int width;
+	int height;
+	unsigned int numberOfChannels;
+	size_t size;
+	unsigned int lastUsed;
+} ResultCacheEntry;
+
+using std::map;
+
+static map<ResultCacheKey, ResultCacheEntry> s_results;
+static size_t s_resultsSize = 0;
+static unsigned int s_useCounter = 0;
+
+ResultCacheKey ResultCache::keyInit(const CompositorContext *context)
+{
+	/* FNV-1a offset basis */
+	ResultCacheKey key = 14695981039346656037ULL;
+	const RenderData *rd = context->getRenderData();
+	int settings[4] = {context->getQuality(), context->isRendering(), context->isFastCalculation(),
+	                   context->getResolutionDivider()};
+
+	keyAdd(&key, settings, sizeof(settings));
+
+	if (rd) {
+		int render[4] = {rd->cfra, rd->size, rd->xsch, rd->ysch};
+		keyAdd(&key, render, sizeof(render));
+	}
+
+	return key;
+}
+
+void ResultCache::keyAdd(ResultCacheKey *key, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	ResultCacheKey hash = *key;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	*key = hash;
+}
+
+static bool key_add_scene_camera(ResultCacheKey *key, Scene *scene)
+{
+	Object *camob = scene->camera;
+
+	ResultCache::keyAdd(key, &camob, sizeof(camob));
+
+	if (camob) {
+		ResultCache::keyAdd(key, camob->obmat, sizeof(camob->obmat));
+
+		if (camob->type == OB_CAMERA) {
+			Camera *cam = (Camera *)camob->data;
+			ResultCache::keyAdd(key, (char *)cam + sizeof(ID), sizeof(Camera) - sizeof(ID));
+
+			if (cam->dof_ob) {
+				ResultCache::keyAdd(key, cam->dof_ob->obmat, sizeof(cam->dof_ob->obmat));
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool key_add_render_layers(ResultCacheKey *key, Scene *scene)
+{
+	/* render results change while rendering, without a new render starting */
+	if (G.is_rendering) {
+		return false;
+	}
+
+	Render *re = RE_GetRender(scene->id.name);
+	if (re) {
+		RenderStats *stats = RE_GetStats(re);
+		double times[2] = {stats->starttime, stats->lastframetime};
+		ResultCache::keyAdd(key, times, sizeof(times));
+	}
+
+	return true;
+}
+
+bool ResultCache::keyAddNode(ResultCacheKey *key, bNode *node)
+{
+	if (node == NULL) {
+		return true;
+	}
+
+	int settings[3] = {node->type, node->custom1, node->custom2};
+	float values[2] = {node->custom3, node->custom4};
+	short muted = node->flag & NODE_MUTED;
+
+	keyAdd(key, settings, sizeof(settings));
+	keyAdd(key, values, sizeof(values));
+	keyAdd(key, &muted, sizeof(muted));
+
+	if (node->storage) {
+		keyAdd(key, node->storage, MEM_allocN_len(node->storage));
+	}
+
+	for (bNodeSocket *sock = (bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			keyAdd(key, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+
+	if (node->id) {
+		keyAdd(key, &node->id, sizeof(node->id));
+
+		/* images, movie clips, masks and textures can change without the tree noticing,
+		 * only scenes are known well enough to hash what is used of them */
+		if (GS(node->id->name) != ID_SCE) {
+			return false;
+		}
+
+		Scene *scene = (Scene *)node->id;
+		if (node->type == CMP_NODE_R_LAYERS) {
+			return key_add_render_layers(key, scene);
+		}
+		else {
+			return key_add_scene_camera(key, scene);
+		}
+	}
+
+	return true;
+}
+
+static void result_cache_free_entry(map<ResultCacheKey, ResultCacheEntry>::iterator iter)
+{
+	s_resultsSize -= iter->second.size;
+	MEM_freeN(iter->second.buffer);
+	s_results.erase(iter);
+}
+
+bool ResultCache::restore(ResultCacheKey key, MemoryBuffer *buffer)
+{
+	map<ResultCacheKey, ResultCacheEntry>::iterator iter = s_results.find(key);
+
+	if (iter == s_results.end()) {
+		return false;
+	}
+
+	ResultCacheEntry& entry = iter->second;
+
+	if (entry.width != buffer->getWidth() || entry.height != buffer->getHeight() ||
+	    entry.numberOfChannels != buffer->getNumberOfChannels())
+	{
+		return false;
+	}
+
+	memcpy(buffer->getBuffer(), entry.buffer, entry.size);
+	entry.lastUsed = ++s_useCounter;
+
+	return true;
+}
+
+void ResultCache::store(ResultCacheKey key, MemoryBuffer *buffer, size_t limit)
+{
+	size_t size = sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels();
+
+	if (size == 0 || size > limit) {
+		return;
+	}
+
+	map<ResultCacheKey, ResultCacheEntry>::iterator iter = s_results.find(key);
+	if (iter != s_results.end()) {
+		/* same key, same result */
+		if (iter->second.size == size) {
+			iter->second.lastUsed = ++s_useCounter;
+			return;
+		}
+		result_cache_free_entry(iter);
+	}
+
+	/* free least recently used results until the new one fits */
+	while (s_resultsSize + size > limit && !s_results.empty()) {
+		map<ResultCacheKey, ResultCacheEntry>::iterator oldest = s_results.begin();
+
+		for (iter = s_results.begin(); iter != s_results.end(); ++iter) {
+			if (iter->second.lastUsed < oldest->second.lastUsed) {
+				oldest = iter;
+			}
+		}
+
+		result_cache_free_entry(oldest);
+	}
+
+	ResultCacheEntry entry;
+	entry.buffer = (float *)MEM_mallocN(size, "COM_ResultCache");
+	entry.width = buffer->getWidth();
+	entry.height = buffer->getHeight();
+	entry.numberOfChannels = buffer->getNumberOfChannels();
+	entry.size = size;
+	entry.lastUsed = ++s_useCounter;
+	memcpy(entry.buffer, buffer->getBuffer(), size);
+
+	s_results[key] = entry;
+	s_resultsSize += size;
+}
+
+void ResultCache::clear()
+{
+	while (!s_results.empty()) {
+		result_cache_free_entry(s_results.begin());
+	}
+}
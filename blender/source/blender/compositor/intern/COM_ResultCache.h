@@ -0,0 +1,78 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef _COM_ResultCache_h_
+#define _COM_ResultCache_h_
+
+extern "C" {
+	#include "BLI_sys_types.h"
+}
+
+class CompositorContext;
+class MemoryBuffer;
+struct bNode;
+
+typedef uint64_t ResultCacheKey;
+
+/**
+ * @brief Cache of WriteBufferOperation results across executions.
+ * Results are keyed by a hash of the settings and resolutions of all operations
+ * upstream of the buffer, so when editing nodes further down the tree the
+ * unchanged complex operations are not calculated again.
+ * @note only used while editing, the compositor mutex guards access
+ * @ingroup Memory
+ */
+class ResultCache {
+public:
+	/**
+	 * @brief start a new key, with the settings of the context results depend on
+	 */
+	static ResultCacheKey keyInit(const CompositorContext *context);
+
+	/**
+	 * @brief add data to a key
+	 */
+	static void keyAdd(ResultCacheKey *key, const void *data, size_t size);
+
+	/**
+	 * @brief add the settings of a node to a key
+	 * @return false when the result of the node depends on data that can not be
+	 * hashed, like the contents of images, so results depending on it can't be cached
+	 */
+	static bool keyAddNode(ResultCacheKey *key, bNode *node);
+
+	/**
+	 * @brief copy a cached result into a buffer
+	 * @return false if no result with matching size is cached for the key
+	 */
+	static bool restore(ResultCacheKey key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief store a copy of a buffer for the key
+	 * least recently used results are freed to keep the cache within the limit
+	 */
+	static void store(ResultCacheKey key, MemoryBuffer *buffer, size_t limit);
+
+	/**
+	 * @brief free all cached results
+	 */
+	static void clear();
+};
+
+#endif
@@ -90,6 +90,22 @@ protected:
 	 */
 	virtual void executePixel(float output[4], float x, float y, float dx, float dy, PixelSampler sampler) {}
 
+	/**
+	 * @brief calculate a span of pixels in a row at once
+	 * @note this method is called for non-complex, with nearest sampling.
+	 * the default implementation calls executePixel for each pixel, simple operations
+	 * override it to read the rows of their inputs and process them in one loop.
+	 * @param output array of length * COM_NUMBER_OF_CHANNELS floats to store the result
+	 * @param x the x-coordinate of the first pixel in image space
+	 * @param y the y-coordinate of the row in image space
+	 * @param length number of pixels to calculate, at most COM_ROW_SPAN_SIZE
+	 */
+	virtual void executeRow(float *output, int x, int y, int length) {
+		for (int i = 0; i < length; i++) {
+			executePixel(&output[i * COM_NUMBER_OF_CHANNELS], x + i, y, COM_PS_NEAREST);
+		}
+	}
+
 public:
 	inline void read(float result[4], float x, float y, PixelSampler sampler) {
 		executePixel(result, x, y, sampler);
@@ -100,6 +116,9 @@ public:
 	inline void read(float result[4], float x, float y, float dx, float dy, PixelSampler sampler) {
 		executePixel(result, x, y, dx, dy, sampler);
 	}
+	inline void readRow(float *result, int x, int y, int length) {
+		executeRow(result, x, y, length);
+	}
 
 	virtual void *initializeTileData(rcti *rect) { return 0; }
 	virtual void deinitializeTileData(rcti *rect, void *data) {
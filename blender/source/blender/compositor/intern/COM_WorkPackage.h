@@ -42,13 +42,24 @@ private:
 	 * @brief number of the chunk to be executed
 	 */
 	unsigned int m_chunkNumber;
+
+	/**
+	 * @brief priority of the package, lower values are executed first
+	 */
+	unsigned int m_priority;
+
+	/**
+	 * @brief time the package was scheduled, for the wait time statistics
+	 */
+	double m_scheduleTime;
 public:
 	/**
 	 * constructor
 	 * @param group the ExecutionGroup
 	 * @param chunkNumber the number of the chunk
+	 * @param priority the priority of the package, lower values are executed first
 	 */
-	WorkPackage(ExecutionGroup *group, unsigned int chunkNumber);
+	WorkPackage(ExecutionGroup *group, unsigned int chunkNumber, unsigned int priority);
 
 	/**
 	 * @brief get the ExecutionGroup
@@ -60,6 +71,16 @@ public:
 	 */
 	unsigned int getChunkNumber() const { return this->m_chunkNumber; }
 
+	/**
+	 * @brief get the priority of the package
+	 */
+	unsigned int getPriority() const { return this->m_priority; }
+
+	/**
+	 * @brief get the time the package was scheduled
+	 */
+	double getScheduleTime() const { return this->m_scheduleTime; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
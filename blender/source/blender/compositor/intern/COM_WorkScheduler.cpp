@@ -20,6 +20,7 @@
  *		Monique Dewanchand
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
 
@@ -30,6 +31,7 @@
 #include "COM_OpenCLKernels.cl.h"
 #include "OCL_opencl.h"
 #include "COM_WriteBufferOperation.h"
+#include "COM_Profiler.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -56,8 +58,32 @@ static vector<CPUDevice *> g_cpudevices;
 /// @brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// @brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+
+/// @brief scheduled work of a single cpu thread, sorted by priority
+typedef struct CPUQueue {
+	deque<WorkPackage *> packages;
+	SpinLock lock;
+} CPUQueue;
+
+/// @brief all scheduled work for the cpu, a queue for every CPUDevice in cpudevices
+static vector<CPUQueue *> g_cpuqueues;
+/// @brief queue the next package is added to, packages are spread over the queues
+static unsigned int g_cpuqueueNext;
+/// @brief idle cpu threads wait for g_cpuqueued to be increased
+static ThreadMutex g_cpumutex;
+static ThreadCondition g_cpucondition;
+/// @brief number of packages in all cpu queues not yet taken by a thread
+static int g_cpuqueued;
+static bool g_cpustopping;
+
+/// @brief the thread executing the groups waits for work to finish
+static ThreadMutex g_progressmutex;
+static ThreadCondition g_progresscondition;
+/// @brief number of scheduled packages not yet executed
+static int g_pendingPackages;
+/// @brief number of packages executed since the last waitForProgress
+static int g_finishedPackages;
+
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -141,15 +167,118 @@ int COM_isHighlightedbNode(bNode *bnode)
 } // end extern "C"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static void cpu_queue_push(CPUQueue *queue, WorkPackage *package)
+{
+	BLI_spin_lock(&queue->lock);
+
+	/* packages are mostly scheduled in order of priority, so search from the back */
+	deque<WorkPackage *>::iterator position = queue->packages.end();
+	while (position != queue->packages.begin() && (*(position - 1))->getPriority() > package->getPriority()) {
+		position--;
+	}
+	queue->packages.insert(position, package);
+
+	BLI_spin_unlock(&queue->lock);
+}
+
+static WorkPackage *cpu_queue_pop_front(CPUQueue *queue)
+{
+	WorkPackage *package = NULL;
+
+	BLI_spin_lock(&queue->lock);
+	if (!queue->packages.empty()) {
+		package = queue->packages.front();
+		queue->packages.pop_front();
+	}
+	BLI_spin_unlock(&queue->lock);
+
+	return package;
+}
+
+/* take the most important package of the other queues */
+static WorkPackage *cpu_queue_steal(unsigned int thiefIndex)
+{
+	CPUQueue *victim = NULL;
+	unsigned int victimPriority = 0;
+
+	for (unsigned int index = 0; index < g_cpuqueues.size(); index++) {
+		CPUQueue *queue = g_cpuqueues[index];
+
+		if (index == thiefIndex) {
+			continue;
+		}
+
+		BLI_spin_lock(&queue->lock);
+		if (!queue->packages.empty()) {
+			unsigned int priority = queue->packages.front()->getPriority();
+			if (victim == NULL || priority < victimPriority) {
+				victim = queue;
+				victimPriority = priority;
+			}
+		}
+		BLI_spin_unlock(&queue->lock);
+	}
+
+	return (victim) ? cpu_queue_pop_front(victim) : NULL;
+}
+
+static WorkPackage *cpu_queue_pop(unsigned int index)
+{
+	BLI_mutex_lock(&g_cpumutex);
+	while (g_cpuqueued == 0 && !g_cpustopping) {
+		BLI_condition_wait(&g_cpucondition, &g_cpumutex);
+	}
+	if (g_cpuqueued == 0) {
+		BLI_mutex_unlock(&g_cpumutex);
+		return NULL;
+	}
+	g_cpuqueued--;
+	BLI_mutex_unlock(&g_cpumutex);
+
+	/* a package is reserved for this thread, there are always at least as
+	 * many packages in the queues as reservations, so this loop ends */
+	WorkPackage *package = cpu_queue_pop_front(g_cpuqueues[index]);
+	while (package == NULL) {
+		package = cpu_queue_steal(index);
+	}
+
+	return package;
+}
+
+static void package_finished()
+{
+	BLI_mutex_lock(&g_progressmutex);
+	g_pendingPackages--;
+	g_finishedPackages++;
+	BLI_condition_notify_all(&g_progresscondition);
+	BLI_mutex_unlock(&g_progressmutex);
+}
+
+static void execute_work(Device *device, WorkPackage *work)
+{
+	double start = PIL_check_seconds_timer();
+
+	device->execute(work);
+
+	Profiler::chunkExecuted(work->getExecutionGroup(), start - work->getScheduleTime(),
+	                        PIL_check_seconds_timer() - start);
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
 	Device *device = (Device *)data;
 	WorkPackage *work;
+	unsigned int queueIndex = 0;
+
+	while (g_cpudevices[queueIndex] != device) {
+		queueIndex++;
+	}
 	
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+	while ((work = cpu_queue_pop(queueIndex))) {
 		HIGHLIGHT(work);
-		device->execute(work);
+		execute_work(device, work);
 		delete work;
+		package_finished();
 	}
 	
 	return NULL;
@@ -162,8 +291,9 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 	
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
 		HIGHLIGHT(work);
-		device->execute(work);
+		execute_work(device, work);
 		delete work;
+		package_finished();
 	}
 	
 	return NULL;
@@ -172,24 +302,32 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 
 
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber, unsigned int priority)
 {
-	WorkPackage *package = new WorkPackage(group, chunkNumber);
+	WorkPackage *package = new WorkPackage(group, chunkNumber, priority);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
 	CPUDevice device;
 	device.execute(package);
 	delete package;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_progressmutex);
+	g_pendingPackages++;
+	BLI_mutex_unlock(&g_progressmutex);
+
 #ifdef COM_OPENCL_ENABLED
 	if (group->isOpenCL() && g_openclActive) {
 		BLI_thread_queue_push(g_gpuqueue, package);
+		return;
 	}
-	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
-	}
-#else
-	BLI_thread_queue_push(cpuqueue, package);
 #endif
+
+	cpu_queue_push(g_cpuqueues[g_cpuqueueNext], package);
+	g_cpuqueueNext = (g_cpuqueueNext + 1) % g_cpuqueues.size();
+
+	BLI_mutex_lock(&g_cpumutex);
+	g_cpuqueued++;
+	BLI_condition_notify_one(&g_cpucondition);
+	BLI_mutex_unlock(&g_cpumutex);
 #endif
 }
 
@@ -197,7 +335,20 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
+	BLI_mutex_init(&g_cpumutex);
+	BLI_condition_init(&g_cpucondition);
+	BLI_mutex_init(&g_progressmutex);
+	BLI_condition_init(&g_progresscondition);
+	g_cpuqueued = 0;
+	g_cpuqueueNext = 0;
+	g_cpustopping = false;
+	g_pendingPackages = 0;
+	g_finishedPackages = 0;
+	for (index = 0; index < g_cpudevices.size(); index++) {
+		CPUQueue *queue = new CPUQueue();
+		BLI_spin_init(&queue->lock);
+		g_cpuqueues.push_back(queue);
+	}
 	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
 	for (index = 0; index < g_cpudevices.size(); index++) {
 		Device *device = g_cpudevices[index];
@@ -222,32 +373,54 @@ void WorkScheduler::start(CompositorContext &context)
 void WorkScheduler::finish()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#ifdef COM_OPENCL_ENABLED
-	if (g_openclActive) {
-		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
+	BLI_mutex_lock(&g_progressmutex);
+	while (g_pendingPackages > 0) {
+		BLI_condition_wait(&g_progresscondition, &g_progressmutex);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
+	g_finishedPackages = 0;
+	BLI_mutex_unlock(&g_progressmutex);
 #endif
+}
+void WorkScheduler::waitForProgress()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_progressmutex);
+	while (g_finishedPackages == 0 && g_pendingPackages > 0) {
+		BLI_condition_wait(&g_progresscondition, &g_progressmutex);
+	}
+	g_finishedPackages = 0;
+	BLI_mutex_unlock(&g_progressmutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
+	BLI_mutex_lock(&g_cpumutex);
+	g_cpustopping = true;
+	BLI_condition_notify_all(&g_cpucondition);
+	BLI_mutex_unlock(&g_cpumutex);
 	BLI_end_threads(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+
+	while (g_cpuqueues.size() > 0) {
+		CPUQueue *queue = g_cpuqueues.back();
+		g_cpuqueues.pop_back();
+		BLI_spin_end(&queue->lock);
+		delete queue;
+	}
+	BLI_condition_end(&g_cpucondition);
+	BLI_mutex_end(&g_cpumutex);
+	BLI_condition_end(&g_progresscondition);
+	BLI_mutex_end(&g_progressmutex);
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
 		BLI_end_threads(&g_gputhreads);
 		BLI_thread_queue_free(g_gpuqueue);
 		g_gpuqueue = NULL;
+
+		for (unsigned int index = 0; index < g_gpudevices.size(); index++) {
+			g_gpudevices[index]->releaseResidentImages();
+		}
 	}
 #endif
 #endif
@@ -44,7 +44,8 @@ class WorkScheduler {
 
 	/**
 	 * @brief main thread loop for cpudevices
-	 * inside this loop new work is queried and being executed
+	 * inside this loop new work is queried and being executed.
+	 * every cpu thread has its own queue, when it is empty work is stolen from the other threads
 	 */
 	static void *thread_execute_cpu(void *data);
 
@@ -63,8 +64,9 @@ public:
 	 * @see ExecutionGroup.execute
 	 * @param group the execution group
 	 * @param chunkNumber the number of the chunk in the group to be executed
+	 * @param priority the priority of the chunk, lower values are executed first
 	 */
-	static void schedule(ExecutionGroup *group, int chunkNumber);
+	static void schedule(ExecutionGroup *group, int chunkNumber, unsigned int priority);
 
 	/**
 	 * @brief initialize the WorkScheduler
@@ -105,6 +107,12 @@ public:
 	 */
 	static void finish();
 
+	/**
+	 * @brief wait until a scheduled chunk has been executed.
+	 * returns right away when a chunk finished since the previous call, or when no work is scheduled.
+	 */
+	static void waitForProgress();
+
 	/**
 	 * @brief Are there OpenCL capable GPU devices initialized?
 	 * the result of this method is stored in the CompositorContext
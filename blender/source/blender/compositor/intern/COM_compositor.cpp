@@ -33,6 +33,7 @@ extern "C" {
 #include "COM_WorkScheduler.h"
 #include "OCL_opencl.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 
 static ThreadMutex s_compositorMutex;
 static char is_compositorMutex_init = FALSE;
@@ -40,6 +41,7 @@ static char is_compositorMutex_init = FALSE;
 static void intern_freeCompositorCaches()
 {
 	deintializeDistortionCache();
+	ResultCache::clear();
 }
 
 void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
@@ -50,6 +50,15 @@ void BlurNode::convertToOperations(ExecutionSystem *graph, CompositorContext *co
 	CompositorQuality quality = context->getQuality();
 	NodeOperation *input_operation = NULL, *output_operation = NULL;
 
+	/* in draft mode sizes in pixels are scaled to the lower resolution,
+	 * relative sizes follow the resolution of the image already */
+	if (context->getResolutionDivider() > 1 && !data->relative) {
+		this->m_draftData = *data;
+		this->m_draftData.sizex = (int)(data->sizex * context->getResolutionScale() + 0.5f);
+		this->m_draftData.sizey = (int)(data->sizey * context->getResolutionScale() + 0.5f);
+		data = &this->m_draftData;
+	}
+
 	if (data->filtertype == R_FILTER_FAST_GAUSS) {
 		FastGaussianBlurOperation *operationfgb = new FastGaussianBlurOperation();
 		operationfgb->setData(data);
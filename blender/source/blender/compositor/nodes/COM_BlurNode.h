@@ -30,6 +30,8 @@
  * @ingroup Node
  */
 class BlurNode : public Node {
+private:
+	NodeBlurData m_draftData; /* settings with sizes scaled to the draft resolution */
 public:
 	BlurNode(bNode *editorNode);
 	void convertToOperations(ExecutionSystem *graph, CompositorContext *context);
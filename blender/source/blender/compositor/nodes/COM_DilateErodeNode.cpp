@@ -37,10 +37,14 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 {
 	
 	bNode *editorNode = this->getbNode();
+	/* in draft mode distances are scaled to the lower resolution */
+	const float scale = context->getResolutionScale();
+	const int distance = (int)(editorNode->custom2 * scale + ((editorNode->custom2 < 0) ? -0.5f : 0.5f));
+
 	if (editorNode->custom1 == CMP_NODE_DILATEERODE_DISTANCE_THRESH) {
 		DilateErodeThresholdOperation *operation = new DilateErodeThresholdOperation();
 		operation->setbNode(editorNode);
-		operation->setDistance(editorNode->custom2);
+		operation->setDistance(editorNode->custom2 * scale);
 		operation->setInset(editorNode->custom3);
 		
 		this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
@@ -60,7 +64,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		if (editorNode->custom2 > 0) {
 			DilateDistanceOperation *operation = new DilateDistanceOperation();
 			operation->setbNode(editorNode);
-			operation->setDistance(editorNode->custom2);
+			operation->setDistance(distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -68,7 +72,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		else {
 			ErodeDistanceOperation *operation = new ErodeDistanceOperation();
 			operation->setbNode(editorNode);
-			operation->setDistance(-editorNode->custom2);
+			operation->setDistance(-distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -84,10 +88,10 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		data->filtertype = R_FILTER_GAUSS;
 
 		if (editorNode->custom2 > 0) {
-			data->sizex = data->sizey = editorNode->custom2;
+			data->sizex = data->sizey = distance;
 		}
 		else {
-			data->sizex = data->sizey = -editorNode->custom2;
+			data->sizex = data->sizey = -distance;
 
 		}
 
@@ -134,7 +138,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		if (editorNode->custom2 > 0) {
 			DilateStepOperation *operation = new DilateStepOperation();
 			operation->setbNode(editorNode);
-			operation->setIterations(editorNode->custom2);
+			operation->setIterations(distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -142,7 +146,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		else {
 			ErodeStepOperation *operation = new ErodeStepOperation();
 			operation->setbNode(editorNode);
-			operation->setIterations(-editorNode->custom2);
+			operation->setIterations(-distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -48,19 +48,24 @@ void MaskNode::convertToOperations(ExecutionSystem *graph, CompositorContext *co
 	MaskOperation *operation = new MaskOperation();
 	operation->setbNode(editorNode);
 
+	int width, height;
 	if (editorNode->custom1 & CMP_NODEFLAG_MASK_FIXED) {
-		operation->setMaskWidth(data->size_x);
-		operation->setMaskHeight(data->size_y);
+		width = data->size_x;
+		height = data->size_y;
 	}
 	else if (editorNode->custom1 & CMP_NODEFLAG_MASK_FIXED_SCENE) {
-		operation->setMaskWidth(data->size_x * (rd->size / 100.0f));
-		operation->setMaskHeight(data->size_y * (rd->size / 100.0f));
+		width = data->size_x * (rd->size / 100.0f);
+		height = data->size_y * (rd->size / 100.0f);
 	}
 	else {
-		operation->setMaskWidth(rd->xsch * rd->size / 100.0f);
-		operation->setMaskHeight(rd->ysch * rd->size / 100.0f);
+		width = rd->xsch * rd->size / 100.0f;
+		height = rd->ysch * rd->size / 100.0f;
 	}
 
+	/* in draft mode the mask is rasterized at the lower resolution */
+	operation->setMaskWidth(max(width / context->getResolutionDivider(), 1));
+	operation->setMaskHeight(max(height / context->getResolutionDivider(), 1));
+
 	if (outputMask->isConnected()) {
 		outputMask->relinkConnections(operation->getOutputSocket());
 	}
@@ -22,7 +22,9 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 	#include "RE_pipeline.h"
@@ -43,6 +45,7 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	this->m_cachedInstance = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti *rect)
@@ -52,10 +55,65 @@ void *BokehBlurOperation::initializeTileData(rcti *rect)
 		updateSize();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (!this->m_cachedInstance && useFFTConvolution()) {
+		this->m_cachedInstance = convolveFFT((MemoryBuffer *)buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
 
+int BokehBlurOperation::getPixelSize() const
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	return this->m_size * max_dim / 100.0f;
+}
+
+/* direct convolution gets slow for large sizes, then the whole image is convolved at
+ * once through the FFT. while the size is not known yet this is assumed, so the whole
+ * input is requested */
+bool BokehBlurOperation::useFFTConvolution() const
+{
+	if (!this->m_sizeavailable) {
+		const float max_dim = max(this->getWidth(), this->getHeight());
+		return FFTConvolution::isFasterThanDirect(10.0f * max_dim / 100.0f);
+	}
+	return FFTConvolution::isFasterThanDirect(getPixelSize());
+}
+
+float *BokehBlurOperation::convolveFFT(MemoryBuffer *inputBuffer)
+{
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+	const int pixelSize = getPixelSize();
+	const int kernelSize = 2 * pixelSize + 1;
+	const float m = this->m_bokehDimension / pixelSize;
+	float *kernel = (float *)MEM_callocN(sizeof(float) * kernelSize * kernelSize * COM_NUMBER_OF_CHANNELS, "bokeh blur kernel");
+	float *result = (float *)MEM_mallocN(sizeof(float) * width * height * COM_NUMBER_OF_CHANNELS, "bokeh blur result");
+	float *weights = (float *)MEM_mallocN(sizeof(float) * width * height * COM_NUMBER_OF_CHANNELS, "bokeh blur weights");
+
+	/* the same bokeh samples as the direct convolution, which covers offsets from -pixelSize
+	 * up to but not including pixelSize. the kernel is mirrored by the convolution */
+	for (int ky = 1; ky < kernelSize; ky++) {
+		for (int kx = 1; kx < kernelSize; kx++) {
+			float u = this->m_bokehMidX - (pixelSize - kx) * m;
+			float v = this->m_bokehMidY - (pixelSize - ky) * m;
+			this->m_inputBokehProgram->read(&kernel[(ky * kernelSize + kx) * COM_NUMBER_OF_CHANNELS], u, v, COM_PS_NEAREST);
+		}
+	}
+
+	/* normalize with the bokeh weights covering the image, like the direct convolution */
+	FFTConvolution::convolve(result, inputBuffer->getBuffer(), width, height, kernel, kernelSize, kernelSize, COM_NUMBER_OF_CHANNELS);
+	FFTConvolution::convolve(weights, NULL, width, height, kernel, kernelSize, kernelSize, COM_NUMBER_OF_CHANNELS);
+
+	for (int index = 0; index < width * height * COM_NUMBER_OF_CHANNELS; index++) {
+		result[index] = result[index] * (1.0f / weights[index]);
+	}
+
+	MEM_freeN(weights);
+	MEM_freeN(kernel);
+	return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -81,15 +139,19 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->read(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_cachedInstance) {
+		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+		int bufferindex = ((x - inputBuffer->getRect()->xmin) + (y - inputBuffer->getRect()->ymin) * inputBuffer->getWidth()) * COM_NUMBER_OF_CHANNELS;
+		copy_v4_v4(output, &this->m_cachedInstance[bufferindex]);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
 		int bufferwidth = inputBuffer->getWidth();
 		int bufferstartx = inputBuffer->getRect()->xmin;
 		int bufferstarty = inputBuffer->getRect()->ymin;
-		const float max_dim = max(this->getWidth(), this->getHeight());
-		int pixelSize = this->m_size * max_dim / 100.0f;
+		int pixelSize = getPixelSize();
 		zero_v4(color_accum);
 
 		if (pixelSize < 2) {
@@ -140,6 +202,10 @@ void BokehBlurOperation::deinitExecution()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	if (this->m_cachedInstance) {
+		MEM_freeN(this->m_cachedInstance);
+		this->m_cachedInstance = NULL;
+	}
 }
 
 bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
@@ -148,7 +214,14 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (useFFTConvolution()) {
+		NodeOperation *operation = getInputOperation(0);
+		newInput.xmin = 0;
+		newInput.ymin = 0;
+		newInput.xmax = operation->getWidth();
+		newInput.ymax = operation->getHeight();
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
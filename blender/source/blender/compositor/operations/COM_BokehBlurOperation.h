@@ -37,6 +37,15 @@ private:
 	float m_bokehMidX;
 	float m_bokehMidY;
 	float m_bokehDimension;
+
+	/**
+	 * @brief the whole image convolved through the FFT, for large sizes
+	 */
+	float *m_cachedInstance;
+
+	int getPixelSize() const;
+	bool useFFTConvolution() const;
+	float *convolveFFT(MemoryBuffer *inputBuffer);
 public:
 	BokehBlurOperation();
 
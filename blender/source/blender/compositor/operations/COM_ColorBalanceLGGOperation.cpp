@@ -73,6 +73,26 @@ void ColorBalanceLGGOperation::executePixel(float output[4], float x, float y, P
 
 }
 
+void ColorBalanceLGGOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputColor[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float value[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	this->m_inputValueOperation->readRow(value, x, y, length);
+	this->m_inputColorOperation->readRow(inputColor, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float *color = &inputColor[i];
+		float fac = min(1.0f, value[i]);
+		const float mfac = 1.0f - fac;
+
+		output[i] = mfac * color[0] + fac * colorbalance_lgg(color[0], this->m_lift[0], this->m_gamma_inv[0], this->m_gain[0]);
+		output[i + 1] = mfac * color[1] + fac * colorbalance_lgg(color[1], this->m_lift[1], this->m_gamma_inv[1], this->m_gain[1]);
+		output[i + 2] = mfac * color[2] + fac * colorbalance_lgg(color[2], this->m_lift[2], this->m_gamma_inv[2], this->m_gain[2]);
+		output[i + 3] = color[3];
+	}
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
@@ -51,6 +51,9 @@ CompositorOperation::CompositorOperation() : NodeOperation()
 
 	this->m_ignoreAlpha = false;
 	this->m_active = false;
+	this->m_resolutionDivider = 1;
+	this->m_bufferWidth = 0;
+	this->m_bufferHeight = 0;
 
 	this->m_sceneName[0] = '\0';
 }
@@ -64,11 +67,11 @@ void CompositorOperation::initExecution()
 	this->m_imageInput = getInputSocketReader(0);
 	this->m_alphaInput = getInputSocketReader(1);
 	this->m_depthInput = getInputSocketReader(2);
-	if (this->getWidth() * this->getHeight() != 0) {
-		this->m_outputBuffer = (float *) MEM_callocN(this->getWidth() * this->getHeight() * 4 * sizeof(float), "CompositorOperation");
+	if (this->m_bufferWidth * this->m_bufferHeight != 0) {
+		this->m_outputBuffer = (float *) MEM_callocN(this->m_bufferWidth * this->m_bufferHeight * 4 * sizeof(float), "CompositorOperation");
 	}
 	if (this->m_depthInput != NULL) {
-		this->m_depthBuffer = (float *) MEM_callocN(this->getWidth() * this->getHeight() * sizeof(float), "CompositorOperation");
+		this->m_depthBuffer = (float *) MEM_callocN(this->m_bufferWidth * this->m_bufferHeight * sizeof(float), "CompositorOperation");
 	}
 }
 
@@ -129,17 +132,16 @@ void CompositorOperation::deinitExecution()
 void CompositorOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 {
 	float color[8]; // 7 is enough
+	float depth[4];
 	float *buffer = this->m_outputBuffer;
 	float *zbuffer = this->m_depthBuffer;
 
 	if (!buffer) return;
+	const int divider = this->m_resolutionDivider;
 	int x1 = rect->xmin;
 	int y1 = rect->ymin;
 	int x2 = rect->xmax;
 	int y2 = rect->ymax;
-	int offset = (y1 * this->getWidth() + x1);
-	int add = (this->getWidth() - (x2 - x1));
-	int offset4 = offset * COM_NUMBER_OF_CHANNELS;
 	int x;
 	int y;
 	bool breaked = false;
@@ -198,20 +200,31 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 				}
 			}
 
-			copy_v4_v4(buffer + offset4, color);
-
 			if (this->m_depthInput != NULL) {
-				this->m_depthInput->read(color, input_x, input_y, COM_PS_NEAREST);
-				zbuffer[offset] = color[0];
+				this->m_depthInput->read(depth, input_x, input_y, COM_PS_NEAREST);
+			}
+
+			/* in draft mode every pixel covers a block of the render, the last row and
+			 * column extend to the border when the render size is not a multiple of the divider */
+			const int bx1 = x * divider;
+			const int by1 = y * divider;
+			const int bx2 = (x == (int)this->getWidth() - 1) ? this->m_bufferWidth : min(bx1 + divider, this->m_bufferWidth);
+			const int by2 = (y == (int)this->getHeight() - 1) ? this->m_bufferHeight : min(by1 + divider, this->m_bufferHeight);
+
+			for (int by = by1; by < by2; by++) {
+				for (int bx = bx1; bx < bx2; bx++) {
+					const int offset = by * this->m_bufferWidth + bx;
+					copy_v4_v4(buffer + offset * COM_NUMBER_OF_CHANNELS, color);
+					if (this->m_depthInput != NULL) {
+						zbuffer[offset] = depth[0];
+					}
+				}
 			}
-			offset4 += COM_NUMBER_OF_CHANNELS;
-			offset++;
+
 			if (isBreaked()) {
 				breaked = true;
 			}
 		}
-		offset += add;
-		offset4 += add * COM_NUMBER_OF_CHANNELS;
 	}
 }
 
@@ -232,6 +245,15 @@ void CompositorOperation::determineResolution(unsigned int resolution[2], unsign
 		RE_ReleaseResult(re);
 	}
 
+	this->m_bufferWidth = width;
+	this->m_bufferHeight = height;
+
+	/* in draft mode the tree runs at a lower resolution, and the result is upscaled */
+	if (this->m_resolutionDivider > 1) {
+		width = max(width / this->m_resolutionDivider, 1);
+		height = max(height / this->m_resolutionDivider, 1);
+	}
+
 	preferredResolution[0] = width;
 	preferredResolution[1] = height;
 
@@ -75,6 +75,17 @@ private:
 	 * @brief operation is active for calculating final compo result
 	 */
 	bool m_active;
+
+	/**
+	 * @brief in draft mode the result is upscaled to the render size by this divider
+	 */
+	int m_resolutionDivider;
+
+	/**
+	 * @brief size of the output buffers, the render size
+	 */
+	int m_bufferWidth;
+	int m_bufferHeight;
 public:
 	CompositorOperation();
 	const bool isActiveCompositorOutput() const { return this->m_active; }
@@ -88,6 +99,7 @@ public:
 	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 	void setIgnoreAlpha(bool value) { this->m_ignoreAlpha = value; }
 	void setActive(bool active) { this->m_active = active; }
+	void setResolutionDivider(int divider) { this->m_resolutionDivider = divider; }
 };
 #endif
 
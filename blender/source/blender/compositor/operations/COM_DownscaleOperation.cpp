@@ -0,0 +1,103 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#include "COM_DownscaleOperation.h"
+
+DownscaleOperation::DownscaleOperation(DataType datatype) : NodeOperation()
+{
+	this->addInputSocket(datatype, COM_SC_NO_RESIZE);
+	this->addOutputSocket(datatype);
+	this->setResolutionInputSocketIndex(0);
+	this->m_inputOperation = NULL;
+	this->m_divider = 1;
+
+	switch (datatype) {
+		case COM_DT_VALUE:
+			this->m_numberOfChannels = 1;
+			break;
+		case COM_DT_VECTOR:
+			this->m_numberOfChannels = 3;
+			break;
+		default:
+			this->m_numberOfChannels = COM_NUMBER_OF_CHANNELS;
+			break;
+	}
+}
+
+void DownscaleOperation::initExecution()
+{
+	this->m_inputOperation = this->getInputSocketReader(0);
+}
+
+void DownscaleOperation::deinitExecution()
+{
+	this->m_inputOperation = NULL;
+}
+
+void DownscaleOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
+{
+	const int divider = this->m_divider;
+	const float inputX = x * divider;
+	const float inputY = y * divider;
+	const float weight = 1.0f / (divider * divider);
+	float color[4];
+	int channel;
+
+	zero_v4(output);
+
+	for (int j = 0; j < divider; j++) {
+		for (int i = 0; i < divider; i++) {
+			this->m_inputOperation->read(color, inputX + i, inputY + j, COM_PS_NEAREST);
+			for (channel = 0; channel < this->m_numberOfChannels; channel++) {
+				output[channel] += color[channel];
+			}
+		}
+	}
+
+	for (channel = 0; channel < this->m_numberOfChannels; channel++) {
+		output[channel] *= weight;
+	}
+}
+
+bool DownscaleOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
+{
+	rcti newInput;
+
+	newInput.xmin = input->xmin * this->m_divider;
+	newInput.xmax = input->xmax * this->m_divider;
+	newInput.ymin = input->ymin * this->m_divider;
+	newInput.ymax = input->ymax * this->m_divider;
+
+	return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
+
+void DownscaleOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
+{
+	unsigned int inputPreferredResolution[2];
+
+	inputPreferredResolution[0] = preferredResolution[0] * this->m_divider;
+	inputPreferredResolution[1] = preferredResolution[1] * this->m_divider;
+
+	NodeOperation::determineResolution(resolution, inputPreferredResolution);
+
+	if (resolution[0] && resolution[1]) {
+		resolution[0] = max(resolution[0] / this->m_divider, 1u);
+		resolution[1] = max(resolution[1] / this->m_divider, 1u);
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#ifndef _COM_DownscaleOperation_h_
+#define _COM_DownscaleOperation_h_
+
+#include "COM_NodeOperation.h"
+
+/**
+ * @brief Downscale an input by an integer divider, averaging the pixels of every block.
+ * Added behind image inputs in draft mode, so the rest of the tree runs at the lower resolution.
+ * @see CompositorContext.getResolutionDivider
+ */
+class DownscaleOperation : public NodeOperation {
+private:
+	SocketReader *m_inputOperation;
+	int m_divider;
+	int m_numberOfChannels;
+public:
+	DownscaleOperation(DataType datatype);
+
+	void initExecution();
+	void deinitExecution();
+	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
+	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+
+	void setDivider(int divider) { this->m_divider = divider; }
+};
+
+#endif
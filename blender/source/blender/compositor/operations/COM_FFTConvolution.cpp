@@ -0,0 +1,396 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#include <string.h>
+
+#include "COM_FFTConvolution.h"
+#include "COM_defines.h"
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+	#include "BLI_math.h"
+	#include "BLI_task.h"
+}
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+typedef float fREAL;
+
+// returns next highest power of 2 of x, as well it's log2 in L2
+static unsigned int nextPow2(unsigned int x, unsigned int *L2)
+{
+	unsigned int pw, x_notpow2 = x & (x - 1);
+	*L2 = 0;
+	while (x >>= 1) ++(*L2);
+	pw = 1 << (*L2);
+	if (x_notpow2) { (*L2)++;  pw <<= 1; }
+	return pw;
+}
+
+//------------------------------------------------------------------------------
+
+// from FXT library by Joerg Arndt, faster in order bitreversal
+// use: r = revbin_upd(r, h) where h = N>>1
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+	while (!((r ^= h) & h)) h >>= 1;
+	return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+	double tt, fc, dc, fs, ds, a = M_PI;
+	fREAL t1, t2;
+	int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+	int i, j = 0;
+	unsigned int Nh = len >> 1;
+	for (i = 1; i < (len - 1); ++i) {
+		j = revbin_upd(j, Nh);
+		if (j > i) {
+			t1 = data[i];
+			data[i] = data[j];
+			data[j] = t1;
+		}
+	}
+
+	do {
+		fREAL *data_n = &data[n];
+
+		istep = n << 1;
+		for (k = 0; k < len; k += istep) {
+			t1 = data_n[k];
+			data_n[k] = data[k] - t1;
+			data[k] += t1;
+		}
+
+		n2 = n >> 1;
+		if (n > 2) {
+			fc = dc = cos(a);
+			fs = ds = sqrt(1.0 - fc * fc); //sin(a);
+			bd = n - 2;
+			for (bl = 1; bl < n2; bl++) {
+				fREAL *data_nbd = &data_n[bd];
+				fREAL *data_bd = &data[bd];
+				for (k = bl; k < len; k += istep) {
+					t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+					t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+					data_n[k] = data[k] - t1;
+					data_nbd[k] = data_bd[k] - t2;
+					data[k] += t1;
+					data_bd[k] += t2;
+				}
+				tt = fc * dc - fs * ds;
+				fs = fs * dc + fc * ds;
+				fc = tt;
+				bd -= 2;
+			}
+		}
+
+		if (n > 1) {
+			for (k = n2; k < len; k += istep) {
+				t1 = data_n[k];
+				data_n[k] = data[k] - t1;
+				data[k] += t1;
+			}
+		}
+
+		n = istep;
+		a *= 0.5;
+	} while (n < len);
+
+	if (inverse) {
+		fREAL sc = (fREAL)1 / (fREAL)len;
+		for (k = 0; k < len; ++k)
+			data[k] *= sc;
+	}
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above */
+static void FHT2D(fREAL *data, unsigned int Mx, unsigned int My,
+                  unsigned int nzp, unsigned int inverse)
+{
+	unsigned int i, j, Nx, Ny, maxy;
+	fREAL t;
+
+	Nx = 1 << Mx;
+	Ny = 1 << My;
+
+	// rows (forward transform skips 0 pad data)
+	maxy = inverse ? Ny : nzp;
+	for (j = 0; j < maxy; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// transpose data
+	if (Nx == Ny) {  // square
+		for (j = 0; j < Ny; ++j)
+			for (i = j + 1; i < Nx; ++i) {
+				unsigned int op = i + (j << Mx), np = j + (i << My);
+				t = data[op], data[op] = data[np], data[np] = t;
+			}
+	}
+	else {  // rectangular
+		unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+		for (i = 0; stm > 0; i++) {
+			#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+			for (j = PRED(i); j > i; j = PRED(j)) ;
+			if (j < i) continue;
+			for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+				t = data[j], data[j] = data[k], data[k] = t;
+			}
+			#undef PRED
+			stm--;
+		}
+	}
+	// swap Mx/My & Nx/Ny
+	i = Nx, Nx = Ny, Ny = i;
+	i = Mx, Mx = My, My = i;
+
+	// now columns == transposed rows
+	for (j = 0; j < Ny; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// finalize
+	for (j = 0; j <= (Ny >> 1); j++) {
+		unsigned int jm = (Ny - j) & (Ny - 1);
+		unsigned int ji = j << Mx;
+		unsigned int jmi = jm << Mx;
+		for (i = 0; i <= (Nx >> 1); i++) {
+			unsigned int im = (Nx - i) & (Nx - 1);
+			fREAL A = data[ji + i];
+			fREAL B = data[jmi + i];
+			fREAL C = data[ji + im];
+			fREAL D = data[jmi + im];
+			fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+			data[ji + i] = A - E;
+			data[jmi + i] = B + E;
+			data[ji + im] = C + E;
+			data[jmi + im] = D - E;
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
+static void fht_convolve(fREAL *d1, fREAL *d2, unsigned int M, unsigned int N)
+{
+	fREAL a, b;
+	unsigned int i, j, k, L, mj, mL;
+	unsigned int m = 1 << M, n = 1 << N;
+	unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+	unsigned int mn2 = m << (N - 1);
+
+	d1[0] *= d2[0];
+	d1[mn2] *= d2[mn2];
+	d1[m2] *= d2[m2];
+	d1[m2 + mn2] *= d2[m2 + mn2];
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		a = d1[i] * d2[i] - d1[k] * d2[k];
+		b = d1[k] * d2[i] + d1[i] * d2[k];
+		d1[i] = (b + a) * (fREAL)0.5;
+		d1[k] = (b - a) * (fREAL)0.5;
+		a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+		b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+		d1[i + mn2] = (b + a) * (fREAL)0.5;
+		d1[k + mn2] = (b - a) * (fREAL)0.5;
+	}
+	for (j = 1; j < n2; j++) {
+		L = n - j;
+		mj = j << M;
+		mL = L << M;
+		a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+		b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+		d1[mj] = (b + a) * (fREAL)0.5;
+		d1[mL] = (b - a) * (fREAL)0.5;
+		a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+		b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+		d1[m2 + mj] = (b + a) * (fREAL)0.5;
+		d1[m2 + mL] = (b - a) * (fREAL)0.5;
+	}
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		for (j = 1; j < n2; j++) {
+			L = n - j;
+			mj = j << M;
+			mL = L << M;
+			a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+			b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+			d1[i + mj] = (b + a) * (fREAL)0.5;
+			d1[k + mL] = (b - a) * (fREAL)0.5;
+			a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+			b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+			d1[i + mL] = (b + a) * (fREAL)0.5;
+			d1[k + mj] = (b - a) * (fREAL)0.5;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+
+typedef struct FFTConvolutionData {
+	float *output;
+	const float *image;
+	int imageWidth, imageHeight;
+	int kernelWidth, kernelHeight;
+
+	/* transformed kernel, a block of w2 * h2 for every channel */
+	fREAL *kernelData;
+	unsigned int w2, h2, log2_w, log2_h;
+
+	/* size and number of the image blocks */
+	int xbsz, ybsz, nxb;
+} FFTConvolutionData;
+
+typedef struct FFTConvolutionTask {
+	int channel;
+	int blockRow;
+} FFTConvolutionTask;
+
+/* convolve one channel of a row of blocks, and add the results to the output */
+static void fft_convolve_block_row(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)BLI_task_pool_userdata(pool);
+	FFTConvolutionTask *task = (FFTConvolutionTask *)taskdata;
+	const int ch = task->channel;
+	const int ybl = task->blockRow;
+	const unsigned int w2 = data->w2, h2 = data->h2;
+	const int hw = data->kernelWidth >> 1;
+	const int hh = data->kernelHeight >> 1;
+	fREAL *kernelData = &data->kernelData[ch * w2 * h2];
+	fREAL *blockData = (fREAL *)MEM_mallocN(w2 * h2 * sizeof(fREAL), "FFT convolution block");
+	int x, y, xbl;
+
+	for (xbl = 0; xbl < data->nxb; xbl++) {
+		// image, channel ch -> block data
+		memset(blockData, 0, w2 * h2 * sizeof(fREAL));
+		for (y = 0; y < data->ybsz; y++) {
+			const int yy = ybl * data->ybsz + y;
+			if (yy >= data->imageHeight) break;
+			fREAL *fp = &blockData[y * w2];
+			for (x = 0; x < data->xbsz; x++) {
+				const int xx = xbl * data->xbsz + x;
+				if (xx >= data->imageWidth) break;
+				fp[x] = (data->image) ? data->image[(yy * data->imageWidth + xx) * COM_NUMBER_OF_CHANNELS + ch] : 1.0f;
+			}
+		}
+
+		// forward FHT, rows after the image data are zero
+		FHT2D(blockData, data->log2_w, data->log2_h, data->ybsz, 0);
+
+		// FHT2D transposed data, row/col now swapped
+		// convolve & inverse FHT
+		fht_convolve(blockData, kernelData, data->log2_h, data->log2_w);
+		FHT2D(blockData, data->log2_h, data->log2_w, 0, 1);
+		// data again transposed, so in order again
+
+		// overlap-add result
+		for (y = 0; y < (int)h2; y++) {
+			const int yy = ybl * data->ybsz + y - hh;
+			if ((yy < 0) || (yy >= data->imageHeight)) continue;
+			fREAL *fp = &blockData[y * w2];
+			float *colp = &data->output[yy * data->imageWidth * COM_NUMBER_OF_CHANNELS];
+			for (x = 0; x < (int)w2; x++) {
+				const int xx = xbl * data->xbsz + x - hw;
+				if ((xx < 0) || (xx >= data->imageWidth)) continue;
+				colp[xx * COM_NUMBER_OF_CHANNELS + ch] += fp[x];
+			}
+		}
+	}
+
+	MEM_freeN(blockData);
+}
+
+void FFTConvolution::convolve(float *output, const float *image, int imageWidth, int imageHeight,
+                              const float *kernel, int kernelWidth, int kernelHeight, int numberOfChannels)
+{
+	FFTConvolutionData data;
+	int x, y, ch, ybl, parity;
+
+	data.output = output;
+	data.image = image;
+	data.imageWidth = imageWidth;
+	data.imageHeight = imageHeight;
+	data.kernelWidth = kernelWidth;
+	data.kernelHeight = kernelHeight;
+
+	// convolution result width & height
+	// FFT pow2 required size & log2
+	data.w2 = nextPow2(2 * kernelWidth - 1, &data.log2_w);
+	data.h2 = nextPow2(2 * kernelHeight - 1, &data.log2_h);
+
+	// block add-overlap
+	data.xbsz = (data.w2 + 1) - kernelWidth;
+	data.ybsz = (data.h2 + 1) - kernelHeight;
+	data.nxb = (imageWidth + data.xbsz - 1) / data.xbsz;
+	const int nyb = (imageHeight + data.ybsz - 1) / data.ybsz;
+
+	// only need to calc fht data of the kernel once, can re-use for every block
+	data.kernelData = (fREAL *)MEM_callocN(numberOfChannels * data.w2 * data.h2 * sizeof(fREAL), "FFT convolution kernel");
+	for (ch = 0; ch < numberOfChannels; ch++) {
+		fREAL *kernelData = &data.kernelData[ch * data.w2 * data.h2];
+
+		for (y = 0; y < kernelHeight; y++) {
+			fREAL *fp = &kernelData[y * data.w2];
+			const float *colp = &kernel[y * kernelWidth * COM_NUMBER_OF_CHANNELS];
+			for (x = 0; x < kernelWidth; x++)
+				fp[x] = colp[x * COM_NUMBER_OF_CHANNELS + ch];
+		}
+
+		// zero pad data start is different for each == height+1
+		FHT2D(kernelData, data.log2_w, data.log2_h, kernelHeight + 1, 0);
+	}
+
+	for (y = 0; y < imageHeight; y++) {
+		for (x = 0; x < imageWidth; x++) {
+			for (ch = 0; ch < numberOfChannels; ch++)
+				output[(y * imageWidth + x) * COM_NUMBER_OF_CHANNELS + ch] = 0.0f;
+		}
+	}
+
+	// the result of a block row only overlaps with the neighbouring block rows,
+	// so all even rows are added at once, and then all odd rows
+	TaskScheduler *scheduler = BLI_task_scheduler_get();
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+
+	for (parity = 0; parity < 2; parity++) {
+		for (ybl = parity; ybl < nyb; ybl += 2) {
+			for (ch = 0; ch < numberOfChannels; ch++) {
+				FFTConvolutionTask *task = (FFTConvolutionTask *)MEM_mallocN(sizeof(FFTConvolutionTask), "FFT convolution task");
+				task->channel = ch;
+				task->blockRow = ybl;
+				BLI_task_pool_push(pool, fft_convolve_block_row, task, true, TASK_PRIORITY_LOW);
+			}
+		}
+		BLI_task_pool_work_and_wait(pool);
+	}
+
+	BLI_task_pool_free(pool);
+	MEM_freeN(data.kernelData);
+}
+
+bool FFTConvolution::isFasterThanDirect(int radius)
+{
+	return radius >= COM_FFT_CONVOLUTION_MIN_RADIUS;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2014, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+ */
+
+#ifndef _COM_FFTConvolution_h
+#define _COM_FFTConvolution_h
+
+/**
+ * @brief Convolution of images with large kernels using the Fast Hartley Transform.
+ * The image is split in blocks that are convolved separately and overlap-added,
+ * the blocks are spread over the task scheduler threads.
+ * Cost only grows with the logarithm of the kernel size, where direct convolution grows with its area.
+ * Buffers are interleaved with COM_NUMBER_OF_CHANNELS floats per pixel.
+ */
+class FFTConvolution {
+public:
+	/**
+	 * @brief convolve the first channels of an image with a kernel
+	 * the kernel is centered on every pixel, pixels outside of the image are zero.
+	 * @param output buffer of the size of the image, receives the convolved channels. other channels are untouched
+	 * @param image the image, when NULL the image is one everywhere, the result is the sum of the
+	 * kernel weights covering the image. use this to normalize at the image borders
+	 * @param numberOfChannels number of channels to convolve, starting at the first
+	 */
+	static void convolve(float *output, const float *image, int imageWidth, int imageHeight,
+	                     const float *kernel, int kernelWidth, int kernelHeight, int numberOfChannels);
+
+	/**
+	 * @brief is FFT convolution faster than direct convolution for a kernel of this radius
+	 */
+	static bool isFasterThanDirect(int radius);
+};
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include "COM_GaussianXBlurOperation.h"
+#include "COM_OpenCLDevice.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 
@@ -32,6 +33,7 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
 {
 	this->m_gausstab = NULL;
 	this->m_rad = 0;
+	this->setOpenCL(true);
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti *rect)
@@ -101,6 +103,38 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianXBlurOperation::executeOpenCL(OpenCLDevice *device,
+                                           MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
+                                           MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
+                                           list<cl_kernel> *clKernelsToCleanUp)
+{
+	cl_kernel gaussianXBlurOperationKernel = device->COM_clCreateKernel("gaussianXBlurOperationKernel", clKernelsToCleanUp);
+	cl_int error;
+
+	lockMutex();
+	if (!this->m_sizeavailable) {
+		updateGauss();
+	}
+	unlockMutex();
+
+	cl_int filter_size = this->m_rad;
+	cl_int step = this->getStep();
+	cl_mem gausstab = clCreateBuffer(device->getContext(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+	                                 sizeof(float) * (this->m_rad * 2 + 1), this->m_gausstab, &error);
+	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error)); }
+	else clMemToCleanUp->push_back(gausstab);
+
+	device->COM_clAttachMemoryBufferToKernelParameter(gaussianXBlurOperationKernel, 0, 1, clMemToCleanUp, inputMemoryBuffers, this->m_inputProgram);
+	device->COM_clAttachOutputMemoryBufferToKernelParameter(gaussianXBlurOperationKernel, 2, clOutputBuffer);
+	device->COM_clAttachMemoryBufferOffsetToKernelParameter(gaussianXBlurOperationKernel, 3, outputMemoryBuffer);
+	clSetKernelArg(gaussianXBlurOperationKernel, 4, sizeof(cl_int), &filter_size);
+	clSetKernelArg(gaussianXBlurOperationKernel, 5, sizeof(cl_int), &step);
+	device->COM_clAttachSizeToKernelParameter(gaussianXBlurOperationKernel, 6, this);
+	clSetKernelArg(gaussianXBlurOperationKernel, 7, sizeof(cl_mem), &gausstab);
+
+	device->COM_clEnqueueRange(gaussianXBlurOperationKernel, outputMemoryBuffer, 8, this);
+}
+
 void GaussianXBlurOperation::deinitExecution()
 {
 	BlurBaseOperation::deinitExecution();
@@ -66,6 +66,8 @@ public:
 	void setImageUser(ImageUser *imageuser) { this->m_imageUser = imageuser; }
 
 	void setFramenumber(int framenumber) { this->m_framenumber = framenumber; }
+
+	bool isImageSourceOperation() const { return true; }
 };
 class ImageOperation : public BaseImageOperation {
 public:
@@ -72,6 +72,12 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::readRowInputs(float *inputValue1, float *inputValue2, int x, int y, int length)
+{
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, length);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, length);
+}
+
 void MathAddOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +91,20 @@ void MathAddOperation::executePixel(float output[4], float x, float y, PixelSamp
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = inputValue1[i] + inputValue2[i];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathSubtractOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +118,20 @@ void MathSubtractOperation::executePixel(float output[4], float x, float y, Pixe
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = inputValue1[i] - inputValue2[i];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathMultiplyOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +145,20 @@ void MathMultiplyOperation::executePixel(float output[4], float x, float y, Pixe
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = inputValue1[i] * inputValue2[i];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathDivideOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
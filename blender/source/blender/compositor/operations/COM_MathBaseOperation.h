@@ -46,6 +46,11 @@ protected:
 	MathBaseOperation();
 
 	void clampIfNeeded(float color[4]);
+
+	/**
+	 * read a row span of both inputs, for the executeRow implementations
+	 */
+	void readRowInputs(float *inputValue1, float *inputValue2, int x, int y, int length);
 public:
 	/**
 	 * the inner loop of this program
@@ -74,16 +79,19 @@ class MathAddOperation : public MathBaseOperation {
 public:
 	MathAddOperation() : MathBaseOperation() {}
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 class MathSubtractOperation : public MathBaseOperation {
 public:
 	MathSubtractOperation() : MathBaseOperation() {}
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 class MathMultiplyOperation : public MathBaseOperation {
 public:
 	MathMultiplyOperation() : MathBaseOperation() {}
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 class MathDivideOperation : public MathBaseOperation {
 public:
@@ -69,6 +69,19 @@ void MixBaseOperation::executePixel(float output[4], float x, float y, PixelSamp
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readRowInputs(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int length)
+{
+	this->m_inputValueOperation->readRow(inputValue, x, y, length);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, length);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, length);
+
+	if (this->useValueAlphaMultiply()) {
+		for (int i = 0; i < length; i++) {
+			inputValue[i * COM_NUMBER_OF_CHANNELS] *= inputColor2[i * COM_NUMBER_OF_CHANNELS + 3];
+		}
+	}
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	InputSocket *socket;
@@ -129,6 +142,25 @@ void MixAddOperation::executePixel(float output[4], float x, float y, PixelSampl
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputColor1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		output[i] = inputColor1[i] + value * inputColor2[i];
+		output[i + 1] = inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] + value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +192,26 @@ void MixBlendOperation::executePixel(float output[4], float x, float y, PixelSam
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputColor1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		float valuem = 1.0f - value;
+		output[i] = valuem * inputColor1[i] + value * inputColor2[i];
+		output[i + 1] = valuem * inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = valuem * inputColor1[i + 2] + value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -631,6 +683,26 @@ void MixMultiplyOperation::executePixel(float output[4], float x, float y, Pixel
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputColor1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		float valuem = 1.0f - value;
+		output[i] = inputColor1[i] * (valuem + value * inputColor2[i]);
+		output[i + 1] = inputColor1[i + 1] * (valuem + value * inputColor2[i + 1]);
+		output[i + 2] = inputColor1[i + 2] * (valuem + value * inputColor2[i + 2]);
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -814,6 +886,25 @@ void MixSubtractOperation::executePixel(float output[4], float x, float y, Pixel
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, int x, int y, int length)
+{
+	float inputColor1[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputValue[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readRowInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		output[i] = inputColor1[i] - value * inputColor2[i];
+		output[i + 1] = inputColor1[i + 1] - value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] - value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+
+		clampIfNeeded(&output[i]);
+	}
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
@@ -50,6 +50,12 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	/**
+	 * read a row span of all inputs, and apply the alpha multiply to the values,
+	 * for the executeRow implementations of the mix operations
+	 */
+	void readRowInputs(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int length);
 	
 public:
 	/**
@@ -84,12 +90,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -156,6 +164,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -186,6 +195,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
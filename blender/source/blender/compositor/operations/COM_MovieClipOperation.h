@@ -57,6 +57,7 @@ public:
 	void setCacheFrame(bool value) { this->m_cacheFrame = value; }
 
 	void setFramenumber(int framenumber) { this->m_framenumber = framenumber; }
+	bool isImageSourceOperation() const { return true; }
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
 };
 
@@ -246,3 +246,66 @@ __kernel void directionalBlurKernel(__read_only image2d_t inputImage,  __write_o
 
 	write_imagef(output, coords, col);
 }
+
+// KERNEL --- GAUSSIAN BLUR ---
+__kernel void gaussianXBlurOperationKernel(__read_only image2d_t inputImage,
+                                           int2 offsetInput,
+                                           __write_only image2d_t output,
+                                           int2 offsetOutput,
+                                           int filter_size,
+                                           int step,
+                                           int2 dimension,
+                                           __constant float *gausstab,
+                                           int2 offset)
+{
+	float4 color = {0.0f, 0.0f, 0.0f, 0.0f};
+	int2 coords = {get_global_id(0), get_global_id(1)};
+	coords += offset;
+	const int2 realCoordinate = coords + offsetOutput;
+	int2 inputCoordinate = realCoordinate - offsetInput;
+	float weight = 0.0f;
+
+	int xmin = max(realCoordinate.s0 - filter_size,    0) - offsetInput.s0;
+	int xmax = min(realCoordinate.s0 + filter_size, dimension.s0 - 1) - offsetInput.s0;
+
+	for (int nx = xmin, i = max(filter_size - realCoordinate.s0, 0); nx <= xmax; nx += step, i += step) {
+		float w = gausstab[i];
+		inputCoordinate.s0 = nx;
+		color += read_imagef(inputImage, SAMPLER_NEAREST, inputCoordinate) * w;
+		weight += w;
+	}
+
+	color *= (1.0f / weight);
+	write_imagef(output, coords, color);
+}
+
+__kernel void gaussianYBlurOperationKernel(__read_only image2d_t inputImage,
+                                           int2 offsetInput,
+                                           __write_only image2d_t output,
+                                           int2 offsetOutput,
+                                           int filter_size,
+                                           int step,
+                                           int2 dimension,
+                                           __constant float *gausstab,
+                                           int2 offset)
+{
+	float4 color = {0.0f, 0.0f, 0.0f, 0.0f};
+	int2 coords = {get_global_id(0), get_global_id(1)};
+	coords += offset;
+	const int2 realCoordinate = coords + offsetOutput;
+	int2 inputCoordinate = realCoordinate - offsetInput;
+	float weight = 0.0f;
+
+	int ymin = max(realCoordinate.s1 - filter_size,    0) - offsetInput.s1;
+	int ymax = min(realCoordinate.s1 + filter_size, dimension.s1 - 1) - offsetInput.s1;
+
+	for (int ny = ymin, i = max(filter_size - realCoordinate.s1, 0); ny <= ymax; ny += step, i += step) {
+		float w = gausstab[i];
+		inputCoordinate.s1 = ny;
+		color += read_imagef(inputImage, SAMPLER_NEAREST, inputCoordinate) * w;
+		weight += w;
+	}
+
+	color *= (1.0f / weight);
+	write_imagef(output, coords, color);
+}
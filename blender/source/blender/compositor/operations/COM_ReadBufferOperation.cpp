@@ -66,6 +66,22 @@ void ReadBufferOperation::executePixel(float output[4], float x, float y, PixelS
 	}
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int length)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		m_buffer->read(output, 0, 0);
+		for (int i = 1; i < length; i++) {
+			copy_v4_v4(&output[i * COM_NUMBER_OF_CHANNELS], output);
+		}
+	}
+	else {
+		for (int i = 0; i < length; i++) {
+			m_buffer->read(&output[i * COM_NUMBER_OF_CHANNELS], x + i, y);
+		}
+	}
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
@@ -44,6 +44,7 @@ public:
 	void executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
 	                        MemoryBufferExtend extend_x, MemoryBufferExtend extend_y);
 	void executePixel(float output[4], float x, float y, float dx, float dy, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
 	const bool isReadBufferOperation() const { return true; }
 	void setOffset(unsigned int offset) { this->m_offset = offset; }
 	unsigned int getOffset() const { return this->m_offset; }
@@ -97,6 +97,7 @@ public:
 	void setRenderData(const RenderData *rd) { this->m_rd = rd; }
 	void setLayerId(short layerId) { this->m_layerId = layerId; }
 	short getLayerId() { return this->m_layerId; }
+	bool isImageSourceOperation() const { return true; }
 	void initExecution();
 	void deinitExecution();
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
@@ -32,6 +32,13 @@ void SetValueOperation::executePixel(float output[4], float x, float y, PixelSam
 	output[0] = this->m_value;
 }
 
+void SetValueOperation::executeRow(float *output, int x, int y, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i * COM_NUMBER_OF_CHANNELS] = this->m_value;
+	}
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -50,6 +50,7 @@ ViewerOperation::ViewerOperation() : NodeOperation()
 	this->m_viewSettings = NULL;
 	this->m_displaySettings = NULL;
 	this->m_ignoreAlpha = false;
+	this->m_resolutionDivider = 1;
 	
 	this->addInputSocket(COM_DT_COLOR);
 	this->addInputSocket(COM_DT_VALUE);
@@ -86,46 +87,52 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 	float *buffer = this->m_outputBuffer;
 	float *depthbuffer = this->m_depthBuffer;
 	if (!buffer) return;
+	const int divider = this->m_resolutionDivider;
+	const int bufferWidth = this->getWidth() * divider;
 	const int x1 = rect->xmin;
 	const int y1 = rect->ymin;
 	const int x2 = rect->xmax;
 	const int y2 = rect->ymax;
-	const int offsetadd = (this->getWidth() - (x2 - x1));
-	const int offsetadd4 = offsetadd * 4;
-	int offset = (y1 * this->getWidth() + x1);
-	int offset4 = offset * 4;
-	float alpha[4], depth[4];
+	float color[4], alpha[4], depth[4];
+	rcti bufferRect;
 	int x;
 	int y;
 	bool breaked = false;
 
 	for (y = y1; y < y2 && (!breaked); y++) {
 		for (x = x1; x < x2; x++) {
-			this->m_imageInput->read(&(buffer[offset4]), x, y, COM_PS_NEAREST);
+			this->m_imageInput->read(color, x, y, COM_PS_NEAREST);
 			if (this->m_ignoreAlpha) {
-				buffer[offset4 + 3] = 1.0f;
+				color[3] = 1.0f;
 			}
 			else {
 				if (this->m_alphaInput != NULL) {
 					this->m_alphaInput->read(alpha, x, y, COM_PS_NEAREST);
-					buffer[offset4 + 3] = alpha[0];
+					color[3] = alpha[0];
 				}
 			}
 			if (m_depthInput) {
 				this->m_depthInput->read(depth, x, y, COM_PS_NEAREST);
-				depthbuffer[offset] = depth[0];
 			}
 
-			offset ++;
-			offset4 += 4;
+			/* in draft mode every pixel covers a block of the full resolution image */
+			for (int j = 0; j < divider; j++) {
+				int offset = (y * divider + j) * bufferWidth + x * divider;
+				for (int i = 0; i < divider; i++, offset++) {
+					copy_v4_v4(&buffer[offset * 4], color);
+					if (m_depthInput) {
+						depthbuffer[offset] = depth[0];
+					}
+				}
+			}
 		}
 		if (isBreaked()) {
 			breaked = true;
 		}
-		offset += offsetadd;
-		offset4 += offsetadd4;
 	}
-	updateImage(rect);
+
+	BLI_rcti_init(&bufferRect, x1 * divider, x2 * divider, y1 * divider, y2 * divider);
+	updateImage(&bufferRect);
 }
 
 void ViewerOperation::initImage()
@@ -136,13 +143,15 @@ void ViewerOperation::initImage()
 
 	if (!ibuf) return;
 	BLI_lock_thread(LOCK_DRAW_IMAGE);
-	if (ibuf->x != (int)getWidth() || ibuf->y != (int)getHeight()) {
+	if (ibuf->x != (int)(getWidth() * this->m_resolutionDivider) ||
+	    ibuf->y != (int)(getHeight() * this->m_resolutionDivider))
+	{
 
 		imb_freerectImBuf(ibuf);
 		imb_freerectfloatImBuf(ibuf);
 		IMB_freezbuffloatImBuf(ibuf);
-		ibuf->x = getWidth();
-		ibuf->y = getHeight();
+		ibuf->x = getWidth() * this->m_resolutionDivider;
+		ibuf->y = getHeight() * this->m_resolutionDivider;
 		imb_addrectfloatImBuf(ibuf);
 		ima->ok = IMA_OK_LOADED;
 
@@ -171,7 +180,7 @@ void ViewerOperation::initImage()
 
 void ViewerOperation::updateImage(rcti *rect)
 {
-	IMB_partial_display_buffer_update(this->m_ibuf, this->m_outputBuffer, NULL, getWidth(), 0, 0,
+	IMB_partial_display_buffer_update(this->m_ibuf, this->m_outputBuffer, NULL, getWidth() * this->m_resolutionDivider, 0, 0,
 	                                  this->m_viewSettings, this->m_displaySettings,
 	                                  rect->xmin, rect->ymin, rect->xmax, rect->ymax, false);
 
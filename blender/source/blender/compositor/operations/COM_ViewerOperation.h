@@ -40,6 +40,7 @@ private:
 	bool m_doDepthBuffer;
 	ImBuf *m_ibuf;
 	bool m_ignoreAlpha;
+	int m_resolutionDivider;
 	
 	const ColorManagedViewSettings *m_viewSettings;
 	const ColorManagedDisplaySettings *m_displaySettings;
@@ -68,6 +69,11 @@ public:
 	bool isViewerOperation() { return true; }
 	void setIgnoreAlpha(bool value) { this->m_ignoreAlpha = value; }
 
+	/**
+	 * @brief in draft mode the image is upscaled to full resolution by this divider
+	 */
+	void setResolutionDivider(int divider) { this->m_resolutionDivider = divider; }
+
 	void setViewSettings(const ColorManagedViewSettings *viewSettings) { this->m_viewSettings = viewSettings; }
 	void setDisplaySettings(const ColorManagedDisplaySettings *displaySettings) { this->m_displaySettings = displaySettings; }
 
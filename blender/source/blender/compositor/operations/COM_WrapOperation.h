@@ -32,6 +32,8 @@ public:
 	WrapOperation();
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	/* wrapped coordinates are not contiguous, read per pixel */
+	void executeRow(float *output, int x, int y, int length) { SocketReader::executeRow(output, x, y, length); }
 
 	void setWrapping(int wrapping_type);
 	float getWrappedOriginalXPos(float x);
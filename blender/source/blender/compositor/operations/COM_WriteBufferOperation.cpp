@@ -48,7 +48,9 @@ void WriteBufferOperation::executePixel(float output[4], float x, float y, Pixel
 void WriteBufferOperation::initExecution()
 {
 	this->m_input = this->getInputOperation(0);
-	this->m_memoryProxy->allocate(this->m_width, this->m_height);
+	if (!this->m_memoryProxy->isAllocatedOnDemand()) {
+		this->m_memoryProxy->allocate(this->m_width, this->m_height);
+	}
 }
 
 void WriteBufferOperation::deinitExecution()
@@ -61,7 +63,45 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 {
 	MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
 	float *buffer = memoryBuffer->getBuffer();
-	if (this->m_input->isComplex()) {
+	const int numberOfChannels = memoryBuffer->getNumberOfChannels();
+	if (numberOfChannels != COM_NUMBER_OF_CHANNELS) {
+		/* only store the channels of the data type, via a float4 row span */
+		float span[COM_ROW_SPAN_SIZE * COM_NUMBER_OF_CHANNELS];
+		void *data = (this->m_input->isComplex()) ? this->m_input->initializeTileData(rect) : NULL;
+		int x1 = rect->xmin;
+		int y1 = rect->ymin;
+		int x2 = rect->xmax;
+		int y2 = rect->ymax;
+		int x;
+		int y;
+		bool breaked = false;
+		for (y = y1; y < y2 && (!breaked); y++) {
+			int offset = (y * memoryBuffer->getWidth() + x1) * numberOfChannels;
+			for (x = x1; x < x2; x += COM_ROW_SPAN_SIZE) {
+				int length = min_ii(x2 - x, COM_ROW_SPAN_SIZE);
+				if (data) {
+					for (int i = 0; i < length; i++) {
+						this->m_input->read(&span[i * COM_NUMBER_OF_CHANNELS], x + i, y, data);
+					}
+				}
+				else {
+					this->m_input->readRow(span, x, y, length);
+				}
+				for (int i = 0; i < length; i++) {
+					memcpy(&buffer[offset], &span[i * COM_NUMBER_OF_CHANNELS], numberOfChannels * sizeof(float));
+					offset += numberOfChannels;
+				}
+			}
+			if (isBreaked()) {
+				breaked = true;
+			}
+		}
+		if (data) {
+			this->m_input->deinitializeTileData(rect, data);
+			data = NULL;
+		}
+	}
+	else if (this->m_input->isComplex()) {
 		void *data = this->m_input->initializeTileData(rect);
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
@@ -97,9 +137,11 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
 			int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
-			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += COM_NUMBER_OF_CHANNELS;
+			/* calculate the row in spans, instead of a read per pixel up the whole chain */
+			for (x = x1; x < x2; x += COM_ROW_SPAN_SIZE) {
+				int length = min_ii(x2 - x, COM_ROW_SPAN_SIZE);
+				this->m_input->readRow(&(buffer[offset4]), x, y, length);
+				offset4 += length * COM_NUMBER_OF_CHANNELS;
 			}
 			if (isBreaked()) {
 				breaked = true;
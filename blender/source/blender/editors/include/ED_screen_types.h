@@ -42,6 +42,7 @@ typedef struct ScreenAnimData {
 	int sfra;               /* frame that playback was started from */
 	int nextfra;            /* next frame to go to (when ANIMPLAY_FLAG_USE_NEXT_FRAME is set) */
 	double last_duration;   /* used for frame dropping */
+	double last_passive_redraw;  /* timer duration at the last redraw of throttled regions */
 } ScreenAnimData;
 
 /* for animplayer */
@@ -62,6 +63,10 @@ enum {
 
 #define REDRAW_FRAME_AVERAGE 8
 
+/* during playback, regions which only show the frame indicator or values at the current
+ * frame are redrawn at most at this rate, see screen_animation_step() */
+#define ANIMPLAY_PASSIVE_REDRAW_FPS 15.0
+
 /* for playback framerate info 
  * stored during runtime as scene->fps_info
  */
@@ -30,6 +30,7 @@
  *  \ingroup edobj
  */
 
+#include <stddef.h>
 #include <string.h>
 
 #include "MEM_guardedalloc.h"
@@ -54,6 +55,7 @@
 #include "BKE_context.h"
 #include "BKE_global.h"
 #include "BKE_image.h"
+#include "BKE_library.h"
 #include "BKE_main.h"
 #include "BKE_multires.h"
 #include "BKE_report.h"
@@ -65,6 +67,8 @@
 #include "BKE_mesh.h"
 #include "BKE_scene.h"
 
+#include "RE_bake.h"
+#include "RE_engine.h"
 #include "RE_pipeline.h"
 #include "RE_shader_ext.h"
 #include "RE_multires_bake.h"
@@ -778,12 +782,141 @@ static int is_multires_bake(Scene *scene)
 	return 0;
 }
 
+/* ****************** external engine BAKING ********************** */
+
+/* bake one image of an object with the render engine, all texels of the
+ * image are shaded in a single call so the engine can batch them */
+static bool bake_object_image_engine(Render *re, Main *bmain, Scene *scene, Object *ob, DerivedMesh *dm,
+                                     Image *ima, const int pass_type)
+{
+	const int depth = 4;
+	ImBuf *ibuf = BKE_image_acquire_ibuf(ima, NULL, NULL);
+	BakePixel *pixel_array;
+	float *result;
+	int num_pixels;
+	bool ok;
+
+	if (ibuf == NULL)
+		return false;
+
+	num_pixels = ibuf->x * ibuf->y;
+	pixel_array = MEM_mallocN(sizeof(BakePixel) * num_pixels, "bake pixels");
+	result = MEM_callocN(sizeof(float) * depth * num_pixels, "bake result");
+
+	RE_bake_pixels_populate(dm, pixel_array, ibuf->x, ibuf->y, ima);
+
+	ok = RE_engine_bake(re, bmain, scene, ob, pass_type, pixel_array, num_pixels, depth, result);
+
+	if (ok && !G.is_break) {
+		RE_bake_ibuf_write(ibuf, pixel_array, result, pass_type, scene->r.bake_filter);
+
+		/* force OpenGL reload and mipmap recalc */
+		GPU_free_image(ima);
+		imb_freemipmapImBuf(ibuf);
+		ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
+	}
+
+	BKE_image_release_ibuf(ima, ibuf, NULL);
+
+	MEM_freeN(pixel_array);
+	MEM_freeN(result);
+
+	return ok;
+}
+
+static int bake_image_exec_engine(bContext *C, wmOperator *op)
+{
+	Main *bmain = CTX_data_main(C);
+	Scene *scene = CTX_data_scene(C);
+	const int pass_type = RE_bake_pass_type_from_mode(scene->r.bake_mode);
+	const ClearFlag clear_flag = (scene->r.bake_mode == RE_BAKE_NORMALS) ? CLEAR_TANGENT_NORMAL : 0;
+	Render *re;
+	bool done = false;
+
+	if (pass_type == 0) {
+		BKE_report(op->reports, RPT_ERROR, "Bake type not supported by the render engine");
+		return OPERATOR_CANCELLED;
+	}
+
+	/* get editmode results */
+	ED_object_editmode_load(CTX_data_edit_object(C));
+
+	re = RE_NewRender("_Bake View_");
+	RE_SetReports(re, op->reports);
+
+	G.is_break = FALSE;
+	G.is_rendering = TRUE;
+
+	/* images are cleared once, even when shared by multiple objects */
+	tag_main_lb(&bmain->image, FALSE);
+
+	CTX_DATA_BEGIN (C, Object *, ob, selected_editable_objects)
+	{
+		DerivedMesh *dm;
+		MTFace *mtface;
+		ListBase images = {NULL, NULL};
+		LinkData *link;
+		int a, totface;
+
+		if (ob->type != OB_MESH)
+			continue;
+
+		dm = mesh_create_derived_render(scene, ob, CD_MASK_BAREMESH | CD_MASK_MTFACE);
+		DM_ensure_tessface(dm);
+
+		mtface = dm->getTessFaceDataArray(dm, CD_MTFACE);
+		totface = dm->getNumTessFaces(dm);
+
+		/* images used by the faces of this object */
+		for (a = 0; mtface && a < totface; a++) {
+			Image *ima = mtface[a].tpage;
+
+			if (ima && !BLI_findptr(&images, ima, offsetof(LinkData, data)))
+				BLI_addtail(&images, BLI_genericNodeN(ima));
+		}
+
+		for (link = images.first; link && !G.is_break; link = link->next) {
+			Image *ima = link->data;
+
+			if (scene->r.bake_flag & R_BAKE_CLEAR)
+				clear_single_image(ima, clear_flag);
+
+			if (bake_object_image_engine(re, bmain, scene, ob, dm, ima, pass_type))
+				done = true;
+		}
+
+		BLI_freelistN(&images);
+		dm->release(dm);
+
+		if (G.is_break)
+			break;
+	}
+	CTX_DATA_END;
+
+	tag_main_lb(&bmain->image, FALSE);
+
+	RE_SetReports(re, NULL);
+	G.is_rendering = FALSE;
+
+	if (!done && !G.is_break)
+		BKE_report(op->reports, RPT_ERROR, "No valid images found to bake to");
+
+	WM_event_add_notifier(C, NC_SCENE | ND_RENDER_RESULT, scene);
+	WM_event_add_notifier(C, NC_IMAGE, NULL);
+
+	return (done) ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
 static int objects_bake_render_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(_event))
 {
 	Scene *scene = CTX_data_scene(C);
 	int result = OPERATOR_CANCELLED;
 
-	if (is_multires_bake(scene)) {
+	if (RE_engine_has_bake(scene)) {
+		/* external engines bake in a single blocking call */
+		result = bake_image_exec_engine(C, op);
+	}
+	else if (is_multires_bake(scene)) {
 		result = multiresbake_image_exec(C, op);
 	}
 	else {
@@ -834,7 +967,10 @@ static int bake_image_exec(bContext *C, wmOperator *op)
 	Scene *scene = CTX_data_scene(C);
 	int result = OPERATOR_CANCELLED;
 
-	if (is_multires_bake(scene)) {
+	if (RE_engine_has_bake(scene)) {
+		result = bake_image_exec_engine(C, op);
+	}
+	else if (is_multires_bake(scene)) {
 		result = multiresbake_image_exec_locked(C, op);
 	}
 	else {
@@ -457,6 +457,9 @@ static void screen_opengl_render_end(bContext *C, OGLRender *oglrender)
 	Main *bmain = CTX_data_main(C);
 	Scene *scene = oglrender->scene;
 
+	/* finish writing queued frames before the movie is closed */
+	RE_AsyncWriteEnd(oglrender, oglrender->reports);
+
 	if (oglrender->mh) {
 		if (BKE_imtype_is_movie(scene->r.im_format.imtype))
 			oglrender->mh->end_movie();
@@ -509,6 +512,9 @@ static int screen_opengl_render_anim_initialize(bContext *C, wmOperator *op)
 		}
 	}
 
+	if (scene->r.mode & R_WRITE_ASYNC)
+		RE_AsyncWriteBegin(oglrender, BKE_imtype_is_movie(scene->r.im_format.imtype));
+
 	oglrender->cfrao = scene->r.cfra;
 	oglrender->nfra = PSFRA;
 	scene->r.cfra = PSFRA;
@@ -621,7 +627,24 @@ static bool screen_opengl_render_anim_step(bContext *C, wmOperator *op)
 			ibuf_save = ibuf_cpy;
 		}
 
-		if (is_movie) {
+		if (RE_AsyncWriteActive(oglrender)) {
+			/* the queue gets its own copy, buffers here are reused by the next frame */
+			ImBuf *ibuf_copy = IMB_dupImBuf(ibuf_save);
+			ibuf_copy->planes = ibuf_save->planes;
+
+			if (is_movie) {
+				RE_AsyncWriteMovie(ibuf_copy, oglrender->mh, &scene->r, PSFRA, CFRA);
+			}
+			else {
+				if (scene->r.stamp & R_STAMP_ALL)
+					BKE_imbuf_stamp_info(scene, camera, ibuf_copy);
+
+				RE_AsyncWriteImage(ibuf_copy, name, &scene->r.im_format);
+			}
+
+			ok = !RE_AsyncWriteFailed(oglrender);
+		}
+		else if (is_movie) {
 			ok = oglrender->mh->append_movie(&scene->r, PSFRA, CFRA, (int *)ibuf_save->rect,
 			                                 oglrender->sizex, oglrender->sizey, oglrender->reports);
 			if (ok) {
@@ -1806,6 +1806,9 @@ void ED_screen_animation_timer(bContext *C, int redraws, int refresh, int sync,
 	if (stopscreen) {
 		WM_event_remove_timer(wm, win, stopscreen->animtimer);
 		stopscreen->animtimer = NULL;
+
+		/* playback may have skipped redraws of some regions, make sure they show the final frame */
+		WM_event_add_notifier(C, NC_SCENE | ND_FRAME, scene);
 	}
 	
 	if (enable) {
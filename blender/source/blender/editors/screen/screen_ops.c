@@ -3155,6 +3155,24 @@ static int match_region_with_redraws(int spacetype, int regiontype, int redraws)
 	return 0;
 }
 
+/* regions which don't display the animated result itself, redrawing these at the full
+ * playback rate on every editor costs more than it's worth */
+static int region_redraw_is_throttled(int spacetype, int regiontype)
+{
+	if (regiontype == RGN_TYPE_WINDOW) {
+		switch (spacetype) {
+			case SPACE_VIEW3D:
+			case SPACE_IMAGE:
+			case SPACE_CLIP:
+				return 0;
+		}
+	}
+	else if (regiontype == RGN_TYPE_PREVIEW) {
+		return 0;
+	}
+	return 1;
+}
+
 static int screen_animation_step(bContext *C, wmOperator *UNUSED(op), const wmEvent *event)
 {
 	bScreen *screen = CTX_wm_screen(C);
@@ -3167,7 +3185,7 @@ static int screen_animation_step(bContext *C, wmOperator *UNUSED(op), const wmEv
 		wmWindowManager *wm = CTX_wm_manager(C);
 		wmWindow *window;
 		ScrArea *sa;
-		int sync;
+		int sync, redraw_passive;
 		float time;
 		
 		/* sync, don't sync, or follow scene setting */
@@ -3252,6 +3270,12 @@ static int screen_animation_step(bContext *C, wmOperator *UNUSED(op), const wmEv
 		/* since we follow drawflags, we can't send notifier but tag regions ourselves */
 		ED_update_for_newframe(bmain, scene, 1);
 
+		/* the region playback was started from is always redrawn, others only at a capped rate */
+		redraw_passive = (sad->flag & ANIMPLAY_FLAG_JUMPED) ||
+		                 (wt->duration - sad->last_passive_redraw >= 1.0 / ANIMPLAY_PASSIVE_REDRAW_FPS);
+		if (redraw_passive)
+			sad->last_passive_redraw = wt->duration;
+
 		for (window = wm->windows.first; window; window = window->next) {
 			for (sa = window->screen->areabase.first; sa; sa = sa->next) {
 				ARegion *ar;
@@ -3260,7 +3284,8 @@ static int screen_animation_step(bContext *C, wmOperator *UNUSED(op), const wmEv
 						ED_region_tag_redraw(ar);
 					}
 					else if (match_region_with_redraws(sa->spacetype, ar->regiontype, sad->redraws)) {
-						ED_region_tag_redraw(ar);
+						if (redraw_passive || !region_redraw_is_throttled(sa->spacetype, ar->regiontype))
+							ED_region_tag_redraw(ar);
 					}
 				}
 				
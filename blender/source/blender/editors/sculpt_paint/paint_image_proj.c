@@ -45,6 +45,7 @@
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -4079,6 +4080,11 @@ static void *do_projectpaint_thread(void *ph_v)
 	return NULL;
 }
 
+static void do_projectpaint_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	do_projectpaint_thread(taskdata);
+}
+
 static bool project_paint_op(void *state, const float lastpos[2], const float pos[2])
 {
 	/* First unpack args from the struct */
@@ -4086,7 +4092,7 @@ static bool project_paint_op(void *state, const float lastpos[2], const float po
 	bool touch_any = false;
 
 	ProjectHandle handles[BLENDER_MAX_THREADS];
-	ListBase threads;
+	TaskPool *task_pool = NULL;
 	int a, i;
 
 	struct ImagePool *pool;
@@ -4095,8 +4101,10 @@ static bool project_paint_op(void *state, const float lastpos[2], const float po
 		return 0;
 	}
 
+	/* the scheduler's worker threads are kept alive between dabs,
+	 * each handle fills buckets until none are left */
 	if (ps->thread_tot > 1)
-		BLI_init_threads(&threads, do_projectpaint_thread, ps->thread_tot);
+		task_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
 
 	pool = BKE_image_pool_new();
 
@@ -4125,12 +4133,14 @@ static bool project_paint_op(void *state, const float lastpos[2], const float po
 
 		handles[a].pool = pool;
 
-		if (ps->thread_tot > 1)
-			BLI_insert_thread(&threads, &handles[a]);
+		if (task_pool)
+			BLI_task_pool_push(task_pool, do_projectpaint_task, &handles[a], false, TASK_PRIORITY_HIGH);
 	}
 
-	if (ps->thread_tot > 1) /* wait for everything to be done */
-		BLI_end_threads(&threads);
+	if (task_pool) { /* wait for everything to be done */
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
 	else
 		do_projectpaint_thread(&handles[0]);
 
@@ -42,6 +42,7 @@
 #include "BLI_math_geom.h"
 #include "BLI_utildefines.h"
 #include "BLI_lasso.h"
+#include "BLI_task.h"
 
 #include "BKE_pbvh.h"
 #include "BKE_ccg.h"
@@ -66,6 +67,7 @@
 #include "paint_intern.h"
 #include "sculpt_intern.h" /* for undo push */
 
+#include <limits.h>
 #include <stdlib.h>
 
 static void mask_flood_fill_set_elem(float *elem,
@@ -122,7 +124,7 @@ static int mask_flood_fill_exec(bContext *C, wmOperator *op)
 			multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
 	}
 	
-	sculpt_undo_push_end();
+	sculpt_undo_push_end(ob);
 
 	if (nodes)
 		MEM_freeN(nodes);
@@ -163,11 +165,57 @@ static int is_effected(float planes[4][4], const float co[3])
 	return isect_point_planes_v3(planes, 4, co);
 }
 
+/* Shared by the threaded box and lasso fills */
+typedef struct MaskTaskData {
+	Object *ob;
+	PBVH *pbvh;
+	PBVHNode **nodes;
+	PaintMaskFloodMode mode;
+	float value;
+	float (*clip_planes)[4];
+	struct LassoMaskData *lasso;
+} MaskTaskData;
+
+/* With dynamic topology the nodes are pushed before, the BMLog isn't thread safe */
+static void mask_task_undo_push_nodes(Object *ob, PBVHNode **nodes, int totnode)
+{
+	if (ob->sculpt->bm) {
+		int i;
+
+		for (i = 0; i < totnode; i++)
+			sculpt_undo_push_node(ob, nodes[i], SCULPT_UNDO_MASK);
+	}
+}
+
+static int mask_task_threshold(Sculpt *sd)
+{
+	return (sd->flags & SCULPT_USE_OPENMP) ? 1 : INT_MAX;
+}
+
+static void mask_box_select_task_cb(void *userdata, int start, int stop)
+{
+	MaskTaskData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		PBVHVertexIter vi;
+
+		if (!data->ob->sculpt->bm)
+			sculpt_undo_push_node(data->ob, data->nodes[i], SCULPT_UNDO_MASK);
+
+		BKE_pbvh_vertex_iter_begin(data->pbvh, data->nodes[i], vi, PBVH_ITER_UNIQUE) {
+			if (is_effected(data->clip_planes, vi.co))
+				mask_flood_fill_set_elem(vi.mask, data->mode, data->value);
+		} BKE_pbvh_vertex_iter_end;
+
+		BKE_pbvh_node_mark_update(data->nodes[i]);
+	}
+}
+
 int do_sculpt_mask_box_select(ViewContext *vc, rcti *rect, bool select, bool UNUSED(extend))
 {
-#ifdef _OPENMP
 	Sculpt *sd = vc->scene->toolsettings->sculpt;
-#endif
+	MaskTaskData task_data = {NULL};
 	BoundBox bb;
 	bglMats mats = {{0}};
 	float clip_planes[4][4];
@@ -180,7 +228,7 @@ int do_sculpt_mask_box_select(ViewContext *vc, rcti *rect, bool select, bool UNU
 	DerivedMesh *dm;
 	PBVH *pbvh;
 	PBVHNode **nodes;
-	int totnode, i;
+	int totnode;
 
 	mode = PAINT_MASK_FLOOD_VALUE;
 	value = select ? 1.0 : 0.0;
@@ -200,23 +248,20 @@ int do_sculpt_mask_box_select(ViewContext *vc, rcti *rect, bool select, bool UNU
 
 	sculpt_undo_push_begin("Mask box fill");
 
-#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (i = 0; i < totnode; i++) {
-		PBVHVertexIter vi;
-
-		sculpt_undo_push_node(ob, nodes[i], SCULPT_UNDO_MASK);
+	task_data.ob = ob;
+	task_data.pbvh = pbvh;
+	task_data.nodes = nodes;
+	task_data.mode = mode;
+	task_data.value = value;
+	task_data.clip_planes = clip_planes;
 
-		BKE_pbvh_vertex_iter_begin(pbvh, nodes[i], vi, PBVH_ITER_UNIQUE) {
-			if (is_effected(clip_planes, vi.co))
-				mask_flood_fill_set_elem(vi.mask, mode, value);
-		} BKE_pbvh_vertex_iter_end;
+	mask_task_undo_push_nodes(ob, nodes, totnode);
+	BLI_task_parallel_range_ex(0, totnode, &task_data, mask_box_select_task_cb, mask_task_threshold(sd));
 
-		BKE_pbvh_node_mark_update(nodes[i]);
-		if (BKE_pbvh_type(pbvh) == PBVH_GRIDS)
-			multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
-	}
+	if (totnode && BKE_pbvh_type(pbvh) == PBVH_GRIDS)
+		multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
 
-	sculpt_undo_push_end();
+	sculpt_undo_push_end(ob);
 
 	if (nodes)
 		MEM_freeN(nodes);
@@ -259,6 +304,26 @@ static bool is_effected_lasso(LassoMaskData *data, float co[3])
 	return data->px[scr_co_s[1] * data->width + scr_co_s[0]];
 }
 
+static void mask_lasso_task_cb(void *userdata, int start, int stop)
+{
+	MaskTaskData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		PBVHVertexIter vi;
+
+		if (!data->ob->sculpt->bm)
+			sculpt_undo_push_node(data->ob, data->nodes[i], SCULPT_UNDO_MASK);
+
+		BKE_pbvh_vertex_iter_begin(data->pbvh, data->nodes[i], vi, PBVH_ITER_UNIQUE) {
+			if (is_effected_lasso(data->lasso, vi.co))
+				mask_flood_fill_set_elem(vi.mask, data->mode, data->value);
+		} BKE_pbvh_vertex_iter_end;
+
+		BKE_pbvh_node_mark_update(data->nodes[i]);
+	}
+}
+
 static void mask_lasso_px_cb(int x, int y, void *user_data)
 {
 	struct LassoMaskData *data = user_data;
@@ -277,14 +342,13 @@ static int paint_mask_gesture_lasso_exec(bContext *C, wmOperator *op)
 		Object *ob;
 		ViewContext vc;
 		LassoMaskData data;
-#ifdef _OPENMP
+		MaskTaskData task_data = {NULL};
 		Sculpt *sd = CTX_data_tool_settings(C)->sculpt;
-#endif
 		struct MultiresModifierData *mmd;
 		DerivedMesh *dm;
 		PBVH *pbvh;
 		PBVHNode **nodes;
-		int totnode, i;
+		int totnode;
 		PaintMaskFloodMode mode = PAINT_MASK_FLOOD_VALUE;
 		bool select = true; /* TODO: see how to implement deselection */
 		float value = select ? 1.0 : 0.0;
@@ -323,23 +387,20 @@ static int paint_mask_gesture_lasso_exec(bContext *C, wmOperator *op)
 
 		sculpt_undo_push_begin("Mask lasso fill");
 
-#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-		for (i = 0; i < totnode; i++) {
-			PBVHVertexIter vi;
+		task_data.ob = ob;
+		task_data.pbvh = pbvh;
+		task_data.nodes = nodes;
+		task_data.mode = mode;
+		task_data.value = value;
+		task_data.lasso = &data;
 
-			sculpt_undo_push_node(ob, nodes[i], SCULPT_UNDO_MASK);
-
-			BKE_pbvh_vertex_iter_begin(pbvh, nodes[i], vi, PBVH_ITER_UNIQUE) {
-				if (is_effected_lasso(&data, vi.co))
-					mask_flood_fill_set_elem(vi.mask, mode, value);
-			} BKE_pbvh_vertex_iter_end;
+		mask_task_undo_push_nodes(ob, nodes, totnode);
+		BLI_task_parallel_range_ex(0, totnode, &task_data, mask_lasso_task_cb, mask_task_threshold(sd));
 
-			BKE_pbvh_node_mark_update(nodes[i]);
-			if (BKE_pbvh_type(pbvh) == PBVH_GRIDS)
-				multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
-		}
+		if (totnode && BKE_pbvh_type(pbvh) == PBVH_GRIDS)
+			multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
 
-		sculpt_undo_push_end();
+		sculpt_undo_push_end(ob);
 
 		if (nodes)
 			MEM_freeN(nodes);
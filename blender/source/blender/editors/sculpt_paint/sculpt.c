@@ -41,6 +41,7 @@
 #include "BLI_dynstr.h"
 #include "BLI_ghash.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "BLF_translation.h"
 
@@ -98,10 +99,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
-
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <limits.h>
 
 void ED_sculpt_force_update(bContext *C)
 {
@@ -246,11 +244,6 @@ typedef struct StrokeCache {
 	float clip_tolerance[3];
 	float initial_mouse[2];
 
-	/* Pre-allocated temporary storage used during smoothing */
-	int num_threads;
-	float (**tmpgrid_co)[3], (**tmprow_co)[3];
-	float **tmpgrid_mask, **tmprow_mask;
-
 	/* Variants */
 	float radius;
 	float radius_squared;
@@ -320,6 +313,59 @@ typedef struct StrokeCache {
 	rcti previous_r; /* previous redraw rectangle */
 } StrokeCache;
 
+/************************ Threaded node loops *************************/
+
+/* Sums for the area normal and flatten center, one per task */
+typedef struct SculptAreaAccum {
+	float an[3], an_flip[3];
+	float fc[3], fc_flip[3];
+	int count, count_flip;
+} SculptAreaAccum;
+
+/* Shared by the threaded loops over PBVH nodes, most fields are only
+ * used by some brushes. The nodes are split into chunks by BLI_task,
+ * every node is handled by a single task, so per node data like proxies
+ * and update flags can be written without locking. */
+typedef struct SculptThreadedTaskData {
+	Sculpt *sd;
+	Object *ob;
+	Brush *brush;
+	PBVHNode **nodes;
+
+	SculptUndoType undo_type;
+	int smooth_mask;
+	int flip;
+	int original;
+	float bstrength;
+	float strength;
+	float flippedbstrength;
+	float angle;
+	float lim;
+
+	float offset[3];
+	float grab_delta[3];
+	float cono[3];
+	float an[3];
+	float sn[3];
+	float fc[3];
+	float mat[4][4];
+
+	float (*vertCos)[3];
+	SculptAreaAccum *area_total;
+} SculptThreadedTaskData;
+
+/* Threaded loops only run when enabled in the sculpt settings */
+static int sculpt_task_threshold(Sculpt *sd)
+{
+	return (sd->flags & SCULPT_USE_OPENMP) ? 1 : INT_MAX;
+}
+
+static void sculpt_task_parallel_nodes(Sculpt *sd, SculptThreadedTaskData *data, int totnode,
+                                       TaskParallelRangeFunc func)
+{
+	BLI_task_parallel_range_ex(0, totnode, data, func, sculpt_task_threshold(sd));
+}
+
 /************** Access to original unmodified vertex data *************/
 
 typedef struct {
@@ -366,7 +412,7 @@ static void sculpt_orig_vert_data_init(SculptOrigVertData *data,
                                        PBVHNode *node)
 {
 	SculptUndoNode *unode;
-	unode = sculpt_undo_push_node(ob, node, SCULPT_UNDO_COORDS);
+	unode = sculpt_undo_get_pushed_node(ob, node);
 	sculpt_orig_vert_data_unode_init(data, ob, unode);
 }
 
@@ -437,45 +483,28 @@ static int sculpt_stroke_dynamic_topology(const SculptSession *ss,
 
 /*** paint mesh ***/
 
-static void paint_mesh_restore_co(Sculpt *sd, Object *ob)
+static void paint_mesh_restore_co_task_cb(void *userdata, int start, int stop)
 {
-	SculptSession *ss = ob->sculpt;
-	StrokeCache *cache = ss->cache;
-	const Brush *brush = BKE_paint_brush(&sd->paint);
-	int i;
-
-	PBVHNode **nodes;
-	int n, totnode;
-
-#ifndef _OPENMP
-	(void)sd; /* quied unused warning */
-#endif
-
-	BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	int n;
 
-	/* Disable OpenMP when dynamic-topology is enabled. Otherwise, new
-	 * entries might be inserted by sculpt_undo_push_node() into the
-	 * GHash used internally by BM_log_original_vert_co() by a
-	 * different thread. [#33787] */
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP && !ss->bm)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		SculptUndoNode *unode;
-		SculptUndoType type = (brush->sculpt_tool == SCULPT_TOOL_MASK ?
-		                       SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
 
 		if (ss->bm) {
-			unode = sculpt_undo_push_node(ob, nodes[n], type);
+			unode = sculpt_undo_get_pushed_node(data->ob, data->nodes[n]);
 		}
 		else {
-			unode = sculpt_undo_get_node(nodes[n]);
+			unode = sculpt_undo_get_node(data->nodes[n]);
 		}
 		if (unode) {
 			PBVHVertexIter vd;
 			SculptOrigVertData orig_data;
 
-			sculpt_orig_vert_data_unode_init(&orig_data, ob, unode);
+			sculpt_orig_vert_data_unode_init(&orig_data, data->ob, unode);
 		
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				sculpt_orig_vert_data_update(&orig_data, &vd);
 
@@ -491,9 +520,41 @@ static void paint_mesh_restore_co(Sculpt *sd, Object *ob)
 			}
 			BKE_pbvh_vertex_iter_end;
 
-			BKE_pbvh_node_mark_update(nodes[n]);
+			BKE_pbvh_node_mark_update(data->nodes[n]);
 		}
 	}
+}
+
+static void paint_mesh_restore_co(Sculpt *sd, Object *ob)
+{
+	SculptSession *ss = ob->sculpt;
+	StrokeCache *cache = ss->cache;
+	const Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
+	int i;
+
+	PBVHNode **nodes;
+	int n, totnode;
+
+	BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
+
+	/* With dynamic-topology the original coordinates are logged first,
+	 * sculpt_undo_push_node() inserts into the GHash used internally by
+	 * BM_log_original_vert_co(), which isn't safe while other threads
+	 * read it. [#33787] */
+	if (ss->bm) {
+		for (n = 0; n < totnode; n++) {
+			sculpt_undo_push_node(ob, nodes[n],
+			                      brush->sculpt_tool == SCULPT_TOOL_MASK ?
+			                      SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
+		}
+	}
+
+	data.sd = sd;
+	data.ob = ob;
+	data.nodes = nodes;
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, paint_mesh_restore_co_task_cb);
 
 	if (ss->face_normals) {
 		float *fn = ss->face_normals;
@@ -1077,84 +1138,114 @@ static void add_norm_if(float view_vec[3], float out[3], float out_flip[3], floa
 	}
 }
 
-static void calc_area_normal(Sculpt *sd, Object *ob, float an[3], PBVHNode **nodes, int totnode)
+static void sculpt_area_accum_reduce(void *userdata, void *userdata_chunk)
 {
-	float out_flip[3] = {0.0f, 0.0f, 0.0f};
+	SculptThreadedTaskData *data = userdata;
+	SculptAreaAccum *accum = userdata_chunk;
+	SculptAreaAccum *total = data->area_total;
 
-	SculptSession *ss = ob->sculpt;
-	const Brush *brush = BKE_paint_brush(&sd->paint);
-	int n, original;
+	add_v3_v3(total->an, accum->an);
+	add_v3_v3(total->an_flip, accum->an_flip);
+	add_v3_v3(total->fc, accum->fc);
+	add_v3_v3(total->fc_flip, accum->fc_flip);
+	total->count += accum->count;
+	total->count_flip += accum->count_flip;
+}
 
-	/* Grab brush requires to test on original data (see r33888 and
-	 * bug #25371) */
-	original = (BKE_paint_brush(&sd->paint)->sculpt_tool == SCULPT_TOOL_GRAB ?
-	            TRUE : ss->cache->original);
+static void sculpt_area_accum_parallel(Sculpt *sd, SculptThreadedTaskData *data, int totnode,
+                                       TaskParallelRangeFuncEx func, SculptAreaAccum *r_total)
+{
+	SculptAreaAccum accum = {{0.0f}};
 
-	/* In general the original coords are not available with dynamic
-	 * topology
-	 *
-	 * Mask tool could not use undo nodes to get coordinates from
-	 * since the coordinates are not stored in those odes.
-	 * And mask tool is not gonna to modify vertex coordinates,
-	 * so we don't actually need to use modified coords.
-	 */
-	if (ss->bm || brush->sculpt_tool == SCULPT_TOOL_MASK)
-		original = FALSE;
+	memset(r_total, 0, sizeof(*r_total));
+	data->area_total = r_total;
 
-	(void)sd; /* unused w/o openmp */
-	
-	zero_v3(an);
+	BLI_task_parallel_range_reduce(0, totnode, data, &accum, sizeof(accum),
+	                               func, sculpt_area_accum_reduce, sculpt_task_threshold(sd));
+}
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+static void calc_area_normal_task_cb(void *userdata, void *userdata_chunk, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptAreaAccum *accum = userdata_chunk;
+	SculptSession *ss = data->ob->sculpt;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptUndoNode *unode;
-		float private_an[3] = {0.0f, 0.0f, 0.0f};
-		float private_out_flip[3] = {0.0f, 0.0f, 0.0f};
 
-		unode = sculpt_undo_push_node(ob, nodes[n], SCULPT_UNDO_COORDS);
+		unode = sculpt_undo_get_pushed_node(data->ob, data->nodes[n]);
 		sculpt_brush_test_init(ss, &test);
 
-		if (original) {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		if (data->original) {
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, unode->co[vd.i])) {
 					float fno[3];
 
 					normal_short_to_float_v3(fno, unode->no[vd.i]);
-					add_norm_if(ss->cache->view_normal, private_an, private_out_flip, fno);
+					add_norm_if(ss->cache->view_normal, accum->an, accum->an_flip, fno);
 				}
 			}
 			BKE_pbvh_vertex_iter_end;
 		}
 		else {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, vd.co)) {
 					if (vd.no) {
 						float fno[3];
 
 						normal_short_to_float_v3(fno, vd.no);
-						add_norm_if(ss->cache->view_normal, private_an, private_out_flip, fno);
+						add_norm_if(ss->cache->view_normal, accum->an, accum->an_flip, fno);
 					}
 					else {
-						add_norm_if(ss->cache->view_normal, private_an, private_out_flip, vd.fno);
+						add_norm_if(ss->cache->view_normal, accum->an, accum->an_flip, vd.fno);
 					}
 				}
 			}
 			BKE_pbvh_vertex_iter_end;
 		}
-
-		#pragma omp critical
-		{
-			add_v3_v3(an, private_an);
-			add_v3_v3(out_flip, private_out_flip);
-		}
 	}
+}
+
+static void calc_area_normal(Sculpt *sd, Object *ob, float an[3], PBVHNode **nodes, int totnode)
+{
+	SculptSession *ss = ob->sculpt;
+	const Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
+	SculptAreaAccum total;
+	int original;
+
+	/* Grab brush requires to test on original data (see r33888 and
+	 * bug #25371) */
+	original = (BKE_paint_brush(&sd->paint)->sculpt_tool == SCULPT_TOOL_GRAB ?
+	            TRUE : ss->cache->original);
+
+	/* In general the original coords are not available with dynamic
+	 * topology
+	 *
+	 * Mask tool could not use undo nodes to get coordinates from
+	 * since the coordinates are not stored in those odes.
+	 * And mask tool is not gonna to modify vertex coordinates,
+	 * so we don't actually need to use modified coords.
+	 */
+	if (ss->bm || brush->sculpt_tool == SCULPT_TOOL_MASK)
+		original = FALSE;
+
+	data.sd = sd;
+	data.ob = ob;
+	data.nodes = nodes;
+	data.original = original;
+
+	sculpt_area_accum_parallel(sd, &data, totnode, calc_area_normal_task_cb, &total);
+
+	copy_v3_v3(an, total.an);
 
 	if (is_zero_v3(an))
-		copy_v3_v3(an, out_flip);
+		copy_v3_v3(an, total.an_flip);
 
 	normalize_v3(an);
 }
@@ -1532,8 +1623,39 @@ static void do_bmesh_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *node,
 	BKE_pbvh_vertex_iter_end;
 }
 
+/* Temporary storage used during multires smoothing, one per task */
+typedef struct SculptSmoothGridTmp {
+	float (*grid_co)[3], (*row_co)[3];
+	float *grid_mask, *row_mask;
+} SculptSmoothGridTmp;
+
+static void sculpt_smooth_grid_tmp_alloc(SculptSession *ss, SculptSmoothGridTmp *tmp)
+{
+	int gridsize;
+	size_t row_size, co_row_size;
+
+	BKE_pbvh_node_get_grids(ss->pbvh, NULL, NULL, NULL, NULL,
+	                        &gridsize, NULL, NULL);
+
+	row_size = sizeof(float) * gridsize;
+	co_row_size = 3 * row_size;
+
+	tmp->row_co = MEM_mallocN(co_row_size, "tmprow_co");
+	tmp->grid_co = MEM_mallocN(co_row_size * gridsize, "tmpgrid_co");
+	tmp->row_mask = MEM_mallocN(row_size, "tmprow_mask");
+	tmp->grid_mask = MEM_mallocN(row_size * gridsize, "tmpgrid_mask");
+}
+
+static void sculpt_smooth_grid_tmp_free(SculptSmoothGridTmp *tmp)
+{
+	MEM_freeN(tmp->row_co);
+	MEM_freeN(tmp->grid_co);
+	MEM_freeN(tmp->row_mask);
+	MEM_freeN(tmp->grid_mask);
+}
+
 static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *node,
-                                     float bstrength, int smooth_mask)
+                                     float bstrength, int smooth_mask, SculptSmoothGridTmp *tmp)
 {
 	Brush *brush = BKE_paint_brush(&sd->paint);
 	SculptBrushTest test;
@@ -1543,7 +1665,6 @@ static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *no
 	float (*tmpgrid_co)[3], (*tmprow_co)[3];
 	float *tmpgrid_mask, *tmprow_mask;
 	int v1, v2, v3, v4;
-	int thread_num;
 	BLI_bitmap **grid_hidden;
 	int *grid_indices, totgrid, gridsize, i, x, y;
 
@@ -1557,15 +1678,10 @@ static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *no
 
 	grid_hidden = BKE_pbvh_grid_hidden(ss->pbvh);
 
-	thread_num = 0;
-#ifdef _OPENMP
-	if (sd->flags & SCULPT_USE_OPENMP)
-		thread_num = omp_get_thread_num();
-#endif
-	tmpgrid_co = ss->cache->tmpgrid_co[thread_num];
-	tmprow_co = ss->cache->tmprow_co[thread_num];
-	tmpgrid_mask = ss->cache->tmpgrid_mask[thread_num];
-	tmprow_mask = ss->cache->tmprow_mask[thread_num];
+	tmpgrid_co = tmp->grid_co;
+	tmprow_co = tmp->row_co;
+	tmpgrid_mask = tmp->grid_mask;
+	tmprow_mask = tmp->row_mask;
 
 	for (i = 0; i < totgrid; ++i) {
 		int gi = grid_indices[i];
@@ -1690,6 +1806,37 @@ static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *no
 	}
 }
 
+static void smooth_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	SculptSmoothGridTmp tmp;
+	int n;
+
+	switch (BKE_pbvh_type(ss->pbvh)) {
+		case PBVH_GRIDS:
+			sculpt_smooth_grid_tmp_alloc(ss, &tmp);
+			for (n = start; n < stop; n++) {
+				do_multires_smooth_brush(data->sd, ss, data->nodes[n], data->strength,
+				                         data->smooth_mask, &tmp);
+			}
+			sculpt_smooth_grid_tmp_free(&tmp);
+			break;
+		case PBVH_FACES:
+			for (n = start; n < stop; n++) {
+				do_mesh_smooth_brush(data->sd, ss, data->nodes[n], data->strength,
+				                     data->smooth_mask);
+			}
+			break;
+		case PBVH_BMESH:
+			for (n = start; n < stop; n++) {
+				do_bmesh_smooth_brush(data->sd, ss, data->nodes[n], data->strength,
+				                      data->smooth_mask);
+			}
+			break;
+	}
+}
+
 static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
                    float bstrength, int smooth_mask)
 {
@@ -1697,7 +1844,8 @@ static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
 	const int max_iterations = 4;
 	const float fract = 1.0f / max_iterations;
 	PBVHType type = BKE_pbvh_type(ss->pbvh);
-	int iteration, n, count;
+	SculptThreadedTaskData data = {NULL};
+	int iteration, count;
 	float last;
 
 	CLAMP(bstrength, 0, 1);
@@ -1710,25 +1858,15 @@ static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
 		return;
 	}
 
+	data.sd = sd;
+	data.ob = ob;
+	data.nodes = nodes;
+	data.smooth_mask = smooth_mask;
+
 	for (iteration = 0; iteration <= count; ++iteration) {
-		float strength = (iteration != count) ? 1.0f : last;
+		data.strength = (iteration != count) ? 1.0f : last;
 
-		#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-		for (n = 0; n < totnode; n++) {
-			switch (type) {
-				case PBVH_GRIDS:
-					do_multires_smooth_brush(sd, ss, nodes[n], strength,
-					                         smooth_mask);
-					break;
-				case PBVH_FACES:
-					do_mesh_smooth_brush(sd, ss, nodes[n], strength,
-					                     smooth_mask);
-					break;
-				case PBVH_BMESH:
-					do_bmesh_smooth_brush(sd, ss, nodes[n], strength, smooth_mask);
-					break;
-			}
-		}
+		sculpt_task_parallel_nodes(sd, &data, totnode, smooth_task_cb);
 
 		if (ss->multires)
 			multires_stitch_grids(ob);
@@ -1741,22 +1879,21 @@ static void do_smooth_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	smooth(sd, ob, nodes, totnode, ss->cache->bstrength, FALSE);
 }
 
-static void do_mask_brush_draw(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_mask_brush_draw_task_cb(void *userdata, int start, int stop)
 {
-	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
 	int n;
 
-	/* threaded loop over nodes */
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				float fade = tex_strength(ss, brush, vd.co, test.dist,
@@ -1773,6 +1910,21 @@ static void do_mask_brush_draw(Sculpt *sd, Object *ob, PBVHNode **nodes, int tot
 	}
 }
 
+static void do_mask_brush_draw(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+{
+	SculptSession *ss = ob->sculpt;
+	SculptThreadedTaskData data = {NULL};
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
+
+	/* threaded loop over nodes */
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_mask_brush_draw_task_cb);
+}
+
 static void do_mask_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
@@ -1788,31 +1940,23 @@ static void do_mask_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	}
 }
 
-static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_draw_brush_task_cb(void *userdata, int start, int stop)
 {
-	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float offset[3];
-	float bstrength = ss->cache->bstrength;
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
 	int n;
 
-	/* offset with as much as possible factored in already */
-	mul_v3_v3fl(offset, ss->cache->sculpt_normal_symm, ss->cache->radius);
-	mul_v3_v3(offset, ss->cache->scale);
-	mul_v3_fl(offset, bstrength);
-
-	/* threaded loop over nodes */
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				/* offset vertex */
@@ -1820,7 +1964,7 @@ static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 				                          ss->cache->sculpt_normal_symm, vd.no,
 				                          vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-				mul_v3_v3fl(proxy[vd.i], offset, fade);
+				mul_v3_v3fl(proxy[vd.i], data->offset, fade);
 
 				if (vd.mvert)
 					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
@@ -1830,45 +1974,44 @@ static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	}
 }
 
-static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	const Scene *scene = ss->cache->vc->scene;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float offset[3];
+	SculptThreadedTaskData data = {NULL};
 	float bstrength = ss->cache->bstrength;
-	float flippedbstrength, crease_correction;
-	float brush_alpha;
-	int n;
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
 
 	/* offset with as much as possible factored in already */
-	mul_v3_v3fl(offset, ss->cache->sculpt_normal_symm, ss->cache->radius);
-	mul_v3_v3(offset, ss->cache->scale);
-	mul_v3_fl(offset, bstrength);
-	
-	/* we divide out the squared alpha and multiply by the squared crease to give us the pinch strength */
-	crease_correction = brush->crease_pinch_factor * brush->crease_pinch_factor;
-	brush_alpha = BKE_brush_alpha_get(scene, brush);
-	if (brush_alpha > 0.0f)
-		crease_correction /= brush_alpha * brush_alpha;
+	mul_v3_v3fl(data.offset, ss->cache->sculpt_normal_symm, ss->cache->radius);
+	mul_v3_v3(data.offset, ss->cache->scale);
+	mul_v3_fl(data.offset, bstrength);
 
-	/* we always want crease to pinch or blob to relax even when draw is negative */
-	flippedbstrength = (bstrength < 0) ? -crease_correction * bstrength : crease_correction * bstrength;
+	/* threaded loop over nodes */
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_draw_brush_task_cb);
+}
 
-	if (brush->sculpt_tool == SCULPT_TOOL_BLOB) flippedbstrength *= -1.0f;
+static void do_crease_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float flippedbstrength = data->flippedbstrength;
+	int n;
 
-	/* threaded loop over nodes */
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				/* offset vertex */
@@ -1883,7 +2026,7 @@ static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 				mul_v3_fl(val1, fade * flippedbstrength);
 
 				/* then we draw */
-				mul_v3_v3fl(val2, offset, fade);
+				mul_v3_v3fl(val2, data->offset, fade);
 
 				add_v3_v3v3(proxy[vd.i], val1, val2);
 
@@ -1895,24 +2038,60 @@ static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	}
 }
 
-static void do_pinch_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
+	const Scene *scene = ss->cache->vc->scene;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 	float bstrength = ss->cache->bstrength;
+	float flippedbstrength, crease_correction;
+	float brush_alpha;
+
+	/* offset with as much as possible factored in already */
+	mul_v3_v3fl(data.offset, ss->cache->sculpt_normal_symm, ss->cache->radius);
+	mul_v3_v3(data.offset, ss->cache->scale);
+	mul_v3_fl(data.offset, bstrength);
+	
+	/* we divide out the squared alpha and multiply by the squared crease to give us the pinch strength */
+	crease_correction = brush->crease_pinch_factor * brush->crease_pinch_factor;
+	brush_alpha = BKE_brush_alpha_get(scene, brush);
+	if (brush_alpha > 0.0f)
+		crease_correction /= brush_alpha * brush_alpha;
+
+	/* we always want crease to pinch or blob to relax even when draw is negative */
+	flippedbstrength = (bstrength < 0) ? -crease_correction * bstrength : crease_correction * bstrength;
+
+	if (brush->sculpt_tool == SCULPT_TOOL_BLOB) flippedbstrength *= -1.0f;
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.flippedbstrength = flippedbstrength;
+
+	/* threaded loop over nodes */
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_crease_brush_task_cb);
+}
+
+static void do_pinch_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
 	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
@@ -1931,39 +2110,41 @@ static void do_pinch_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 	}
 }
 
-static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_pinch_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	float grab_delta[3];
-	int n;
-	float len;
+	SculptThreadedTaskData data = {NULL};
 
-	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
 
-	len = len_v3(grab_delta);
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_pinch_brush_task_cb);
+}
 
-	if (brush->normal_weight > 0) {
-		mul_v3_fl(ss->cache->sculpt_normal_symm, len * brush->normal_weight);
-		mul_v3_fl(grab_delta, 1.0f - brush->normal_weight);
-		add_v3_v3(grab_delta, ss->cache->sculpt_normal_symm);
-	}
+static void do_grab_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptOrigVertData orig_data;
 		float (*proxy)[3];
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+		sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			sculpt_orig_vert_data_update(&orig_data, &vd);
 
@@ -1975,7 +2156,7 @@ static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 				                                            orig_data.no,
 				                                            NULL, vd.mask ? *vd.mask : 0.0f);
 
-				mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+				mul_v3_v3fl(proxy[vd.i], data->grab_delta, fade);
 
 				if (vd.mvert)
 					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
@@ -1985,38 +2166,57 @@ static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	}
 }
 
-static void do_nudge_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	float grab_delta[3];
-	float tmp[3], cono[3];
-	int n;
+	SculptThreadedTaskData data = {NULL};
+	float len;
 
-	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
+	copy_v3_v3(data.grab_delta, ss->cache->grab_delta_symmetry);
 
-	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
-	cross_v3_v3v3(cono, tmp, ss->cache->sculpt_normal_symm);
+	len = len_v3(data.grab_delta);
+
+	if (brush->normal_weight > 0) {
+		mul_v3_fl(ss->cache->sculpt_normal_symm, len * brush->normal_weight);
+		mul_v3_fl(data.grab_delta, 1.0f - brush->normal_weight);
+		add_v3_v3(data.grab_delta, ss->cache->sculpt_normal_symm);
+	}
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_grab_brush_task_cb);
+}
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+static void do_nudge_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
 				                                            ss->cache->sculpt_normal_symm,
 				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-				mul_v3_v3fl(proxy[vd.i], cono, fade);
+				mul_v3_v3fl(proxy[vd.i], data->cono, fade);
 
 				if (vd.mvert)
 					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
@@ -2026,46 +2226,52 @@ static void do_nudge_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 	}
 }
 
-static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_nudge_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
+	SculptThreadedTaskData data = {NULL};
 	float grab_delta[3];
-	int n;
-	float len;
+	float tmp[3];
 
 	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
 
-	len = len_v3(grab_delta);
+	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
+	cross_v3_v3v3(data.cono, tmp, ss->cache->sculpt_normal_symm);
 
-	if (bstrength < 0)
-		negate_v3(grab_delta);
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
 
-	if (brush->normal_weight > 0) {
-		mul_v3_fl(ss->cache->sculpt_normal_symm, len * brush->normal_weight);
-		mul_v3_fl(grab_delta, 1.0f - brush->normal_weight);
-		add_v3_v3(grab_delta, ss->cache->sculpt_normal_symm);
-	}
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_nudge_brush_task_cb);
+}
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+static void do_snake_hook_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
 				                                            ss->cache->sculpt_normal_symm,
 				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-				mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+				mul_v3_v3fl(proxy[vd.i], data->grab_delta, fade);
 
 				if (vd.mvert)
 					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
@@ -2075,34 +2281,57 @@ static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int to
 	}
 }
 
-static void do_thumb_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 	float bstrength = ss->cache->bstrength;
-	float grab_delta[3];
-	float tmp[3], cono[3];
-	int n;
+	float len;
 
-	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
+	copy_v3_v3(data.grab_delta, ss->cache->grab_delta_symmetry);
 
-	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
-	cross_v3_v3v3(cono, tmp, ss->cache->sculpt_normal_symm);
+	len = len_v3(data.grab_delta);
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	if (bstrength < 0)
+		negate_v3(data.grab_delta);
+
+	if (brush->normal_weight > 0) {
+		mul_v3_fl(ss->cache->sculpt_normal_symm, len * brush->normal_weight);
+		mul_v3_fl(data.grab_delta, 1.0f - brush->normal_weight);
+		add_v3_v3(data.grab_delta, ss->cache->sculpt_normal_symm);
+	}
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_snake_hook_brush_task_cb);
+}
+
+static void do_thumb_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptOrigVertData orig_data;
 		float (*proxy)[3];
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+		sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			sculpt_orig_vert_data_update(&orig_data, &vd);
 
@@ -2114,7 +2343,7 @@ static void do_thumb_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 				                                            orig_data.no,
 				                                            NULL, vd.mask ? *vd.mask : 0.0f);
 
-				mul_v3_v3fl(proxy[vd.i], cono, fade);
+				mul_v3_v3fl(proxy[vd.i], data->cono, fade);
 
 				if (vd.mvert)
 					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
@@ -2124,29 +2353,49 @@ static void do_thumb_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 	}
 }
 
-static void do_rotate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_thumb_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
+	SculptThreadedTaskData data = {NULL};
+	float grab_delta[3];
+	float tmp[3];
+
+	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
+
+	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
+	cross_v3_v3v3(data.cono, tmp, ss->cache->sculpt_normal_symm);
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_thumb_brush_task_cb);
+}
+
+static void do_rotate_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	const float angle = data->angle;
 	int n;
-	static const int flip[8] = { 1, -1, -1, 1, -1, 1, 1, -1 };
-	float angle = ss->cache->vertex_rotation * flip[ss->cache->mirror_symmetry_pass];
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptOrigVertData orig_data;
 		float (*proxy)[3];
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+		sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			sculpt_orig_vert_data_update(&orig_data, &vd);
 
@@ -2173,22 +2422,33 @@ static void do_rotate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	}
 }
 
-static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_rotate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	float offset[3];
-	float lim = brush->height;
-	int n;
+	SculptThreadedTaskData data = {NULL};
+	static const int flip[8] = { 1, -1, -1, 1, -1, 1, 1, -1 };
 
-	if (bstrength < 0)
-		lim = -lim;
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
+	data.angle = ss->cache->vertex_rotation * flip[ss->cache->mirror_symmetry_pass];
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_rotate_brush_task_cb);
+}
 
-	mul_v3_v3v3(offset, ss->cache->scale, ss->cache->sculpt_normal_symm);
+static void do_layer_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	Sculpt *sd = data->sd;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	const float lim = data->lim;
+	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptOrigVertData orig_data;
@@ -2196,16 +2456,13 @@ static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 		/* XXX: layer brush needs conversion to proxy but its more complicated */
 		/* proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co; */
 		
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+		sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-		#pragma omp critical
-		{
-			layer_disp = BKE_pbvh_node_layer_disp_get(ss->pbvh, nodes[n]);
-		}
+		layer_disp = BKE_pbvh_node_layer_disp_get(ss->pbvh, data->nodes[n]);
 		
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			sculpt_orig_vert_data_update(&orig_data, &vd);
 
@@ -2222,7 +2479,7 @@ static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 				if ((lim < 0 && *disp < lim) || (lim >= 0 && *disp > lim))
 					*disp = lim;
 
-				mul_v3_v3fl(val, offset, *disp);
+				mul_v3_v3fl(val, data->offset, *disp);
 
 				if (ss->layer_co && (brush->flag & BRUSH_PERSISTENT)) {
 					int index = vd.vert_indices[vd.i];
@@ -2244,24 +2501,47 @@ static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 	}
 }
 
-static void do_inflate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 	float bstrength = ss->cache->bstrength;
+	float lim = brush->height;
+
+	if (bstrength < 0)
+		lim = -lim;
+
+	mul_v3_v3v3(data.offset, ss->cache->scale, ss->cache->sculpt_normal_symm);
+
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	data.lim = lim;
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_layer_brush_task_cb);
+}
+
+static void do_inflate_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
 	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test(&test, vd.co)) {
 				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
@@ -2283,54 +2563,56 @@ static void do_inflate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 	}
 }
 
-static void calc_flatten_center(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode, float fc[3])
+static void do_inflate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
-	int n;
+	SculptThreadedTaskData data = {NULL};
 
-	int count = 0;
-	int count_flip = 0;
-
-	float fc_flip[3] = {0.0, 0.0, 0.0};
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = BKE_paint_brush(&sd->paint);
+	data.nodes = nodes;
+	data.bstrength = ss->cache->bstrength;
 
-	(void)sd; /* unused w/o openmp */
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_inflate_brush_task_cb);
+}
 
-	zero_v3(fc);
+static void calc_flatten_center_task_cb(void *userdata, void *userdata_chunk, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptAreaAccum *accum = userdata_chunk;
+	SculptSession *ss = data->ob->sculpt;
+	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptUndoNode *unode;
-		float private_fc[3] = {0.0f, 0.0f, 0.0f};
-		float private_fc_flip[3] = {0.0f, 0.0f, 0.0f};
-		int private_count = 0;
-		int private_count_flip = 0;
 
-		unode = sculpt_undo_push_node(ob, nodes[n], SCULPT_UNDO_COORDS);
+		unode = sculpt_undo_get_pushed_node(data->ob, data->nodes[n]);
 		sculpt_brush_test_init(ss, &test);
 
 		if (ss->cache->original && unode->co) {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, unode->co[vd.i])) {
 					float fno[3];
 
 					normal_short_to_float_v3(fno, unode->no[vd.i]);
 					if (dot_v3v3(ss->cache->view_normal, fno) > 0) {
-						add_v3_v3(private_fc, unode->co[vd.i]);
-						private_count++;
+						add_v3_v3(accum->fc, unode->co[vd.i]);
+						accum->count++;
 					}
 					else {
-						add_v3_v3(private_fc_flip, unode->co[vd.i]);
-						private_count_flip++;
+						add_v3_v3(accum->fc_flip, unode->co[vd.i]);
+						accum->count_flip++;
 					}
 				}
 			}
 			BKE_pbvh_vertex_iter_end;
 		}
 		else {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, vd.co)) {
 					/* for area normal */
@@ -2340,87 +2622,68 @@ static void calc_flatten_center(Sculpt *sd, Object *ob, PBVHNode **nodes, int to
 						normal_short_to_float_v3(fno, vd.no);
 
 						if (dot_v3v3(ss->cache->view_normal, fno) > 0) {
-							add_v3_v3(private_fc, vd.co);
-							private_count++;
+							add_v3_v3(accum->fc, vd.co);
+							accum->count++;
 						}
 						else {
-							add_v3_v3(private_fc_flip, vd.co);
-							private_count_flip++;
+							add_v3_v3(accum->fc_flip, vd.co);
+							accum->count_flip++;
 						}
 					}
 					else {
 						if (dot_v3v3(ss->cache->view_normal, vd.fno) > 0) {
-							add_v3_v3(private_fc, vd.co);
-							private_count++;
+							add_v3_v3(accum->fc, vd.co);
+							accum->count++;
 						}
 						else {
-							add_v3_v3(private_fc_flip, vd.co);
-							private_count_flip++;
+							add_v3_v3(accum->fc_flip, vd.co);
+							accum->count_flip++;
 						}
 					}
 				}
 			}
 			BKE_pbvh_vertex_iter_end;
 		}
-
-		#pragma omp critical
-		{
-			add_v3_v3(fc, private_fc);
-			add_v3_v3(fc_flip, private_fc_flip);
-			count += private_count;
-			count_flip += private_count_flip;
-		}
 	}
-	if (count != 0)
-		mul_v3_fl(fc, 1.0f / count);
-	else if (count_flip != 0)
-		mul_v3_v3fl(fc, fc_flip, 1.0f / count_flip);
-	else
-		zero_v3(fc);
 }
 
-/* this calculates flatten center and area normal together, 
- * amortizing the memory bandwidth and loop overhead to calculate both at the same time */
-static void calc_area_normal_and_flatten_center(Sculpt *sd, Object *ob,
-                                                PBVHNode **nodes, int totnode,
-                                                float an[3], float fc[3])
+static void calc_flatten_center(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode, float fc[3])
 {
-	SculptSession *ss = ob->sculpt;
-	int n;
+	SculptThreadedTaskData data = {NULL};
+	SculptAreaAccum total;
 
-	/* for area normal */
-	float out_flip[3] = {0.0f, 0.0f, 0.0f};
-	float fc_flip[3] = {0.0f, 0.0f, 0.0f};
+	data.sd = sd;
+	data.ob = ob;
+	data.nodes = nodes;
 
-	/* for flatten center */
-	int count = 0;
-	int count_flipped = 0;
+	sculpt_area_accum_parallel(sd, &data, totnode, calc_flatten_center_task_cb, &total);
 
-	(void)sd; /* unused w/o openmp */
-	
-	/* for area normal */
-	zero_v3(an);
+	if (total.count != 0)
+		mul_v3_v3fl(fc, total.fc, 1.0f / total.count);
+	else if (total.count_flip != 0)
+		mul_v3_v3fl(fc, total.fc_flip, 1.0f / total.count_flip);
+	else
+		zero_v3(fc);
+}
 
-	/* for flatten center */
-	zero_v3(fc);
+static void calc_area_normal_and_flatten_center_task_cb(void *userdata, void *userdata_chunk,
+                                                        int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptAreaAccum *accum = userdata_chunk;
+	SculptSession *ss = data->ob->sculpt;
+	int n;
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		SculptUndoNode *unode;
-		float private_an[3] = {0.0f, 0.0f, 0.0f};
-		float private_out_flip[3] = {0.0f, 0.0f, 0.0f};
-		float private_fc[3] = {0.0f, 0.0f, 0.0f};
-		float private_fc_flip[3] = {0.0f, 0.0f, 0.0f};
-		int private_count = 0;
-		int private_count_flip = 0;
-
-		unode = sculpt_undo_push_node(ob, nodes[n], SCULPT_UNDO_COORDS);
+
+		unode = sculpt_undo_get_pushed_node(data->ob, data->nodes[n]);
 		sculpt_brush_test_init(ss, &test);
 
 		if (ss->cache->original && unode->co) {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, unode->co[vd.i])) {
 					/* for area normal */
@@ -2429,21 +2692,21 @@ static void calc_area_normal_and_flatten_center(Sculpt *sd, Object *ob,
 					normal_short_to_float_v3(fno, unode->no[vd.i]);
 
 					if (dot_v3v3(ss->cache->view_normal, fno) > 0) {
-						add_v3_v3(private_an, fno);
-						add_v3_v3(private_fc, unode->co[vd.i]);
-						private_count++;
+						add_v3_v3(accum->an, fno);
+						add_v3_v3(accum->fc, unode->co[vd.i]);
+						accum->count++;
 					}
 					else {
-						add_v3_v3(private_out_flip, fno);
-						add_v3_v3(private_fc_flip, unode->co[vd.i]);
-						private_count_flip++;
+						add_v3_v3(accum->an_flip, fno);
+						add_v3_v3(accum->fc_flip, unode->co[vd.i]);
+						accum->count_flip++;
 					}
 				}
 			}
 			BKE_pbvh_vertex_iter_end;
 		}
 		else {
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+			BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 			{
 				if (sculpt_brush_test_fast(&test, vd.co)) {
 					/* for area normal */
@@ -2453,58 +2716,63 @@ static void calc_area_normal_and_flatten_center(Sculpt *sd, Object *ob,
 						normal_short_to_float_v3(fno, vd.no);
 
 						if (dot_v3v3(ss->cache->view_normal, fno) > 0) {
-							add_v3_v3(private_an, fno);
-							add_v3_v3(private_fc, vd.co);
-							private_count++;
+							add_v3_v3(accum->an, fno);
+							add_v3_v3(accum->fc, vd.co);
+							accum->count++;
 						}
 						else {
-							add_v3_v3(private_out_flip, fno);
-							add_v3_v3(private_fc_flip, vd.co);
-							private_count_flip++;
+							add_v3_v3(accum->an_flip, fno);
+							add_v3_v3(accum->fc_flip, vd.co);
+							accum->count_flip++;
 						}
 					}
 					else {
 						if (dot_v3v3(ss->cache->view_normal, vd.fno) > 0) {
-							add_v3_v3(private_an, vd.fno);
-							add_v3_v3(private_fc, vd.co);
-							private_count++;
+							add_v3_v3(accum->an, vd.fno);
+							add_v3_v3(accum->fc, vd.co);
+							accum->count++;
 						}
 						else {
-							add_v3_v3(private_out_flip, vd.fno);
-							add_v3_v3(private_fc_flip, vd.co);
-							private_count_flip++;
+							add_v3_v3(accum->an_flip, vd.fno);
+							add_v3_v3(accum->fc_flip, vd.co);
+							accum->count_flip++;
 						}
 					}
 				}
-			}
-			BKE_pbvh_vertex_iter_end;
-		}
-
-		#pragma omp critical
-		{
-			/* for area normal */
-			add_v3_v3(an, private_an);
-			add_v3_v3(out_flip, private_out_flip);
-
-			/* for flatten center */
-			add_v3_v3(fc, private_fc);
-			add_v3_v3(fc_flip, private_fc_flip);
-			count += private_count;
-			count_flipped += private_count_flip;
+			}
+			BKE_pbvh_vertex_iter_end;
 		}
 	}
+}
+
+/* this calculates flatten center and area normal together, 
+ * amortizing the memory bandwidth and loop overhead to calculate both at the same time */
+static void calc_area_normal_and_flatten_center(Sculpt *sd, Object *ob,
+                                                PBVHNode **nodes, int totnode,
+                                                float an[3], float fc[3])
+{
+	SculptThreadedTaskData data = {NULL};
+	SculptAreaAccum total;
+
+	data.sd = sd;
+	data.ob = ob;
+	data.nodes = nodes;
+
+	sculpt_area_accum_parallel(sd, &data, totnode, calc_area_normal_and_flatten_center_task_cb, &total);
 
 	/* for area normal */
-	if (is_zero_v3(an))
-		copy_v3_v3(an, out_flip);
+	if (is_zero_v3(total.an))
+		copy_v3_v3(an, total.an_flip);
+	else
+		copy_v3_v3(an, total.an);
 
 	normalize_v3(an);
 
 	/* for flatten center */
-	if (count != 0)
-		mul_v3_fl(fc, 1.0f / count);
-	else if (count_flipped != 0)
-		mul_v3_v3fl(fc, fc_flip, 1.0f / count_flipped);
+	if (total.count != 0)
+		mul_v3_v3fl(fc, total.fc, 1.0f / total.count);
+	else if (total.count_flip != 0)
+		mul_v3_v3fl(fc, total.fc_flip, 1.0f / total.count_flip);
 	else
 		zero_v3(fc);
 }
@@ -2629,10 +2897,55 @@ static float get_offset(Sculpt *sd, SculptSession *ss)
 	return rv;
 }
 
+static void do_flatten_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	float *an = data->an;
+	float *fc = data->fc;
+	int n;
+
+	for (n = start; n < stop; n++) {
+		PBVHVertexIter vd;
+		SculptBrushTest test;
+		float (*proxy)[3];
+
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+		sculpt_brush_test_init(ss, &test);
+
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+		{
+			if (sculpt_brush_test_sq(&test, vd.co)) {
+				float intr[3];
+				float val[3];
+
+				point_plane_project(intr, vd.co, an, fc);
+
+				sub_v3_v3v3(val, intr, vd.co);
+
+				if (plane_trim(ss->cache, brush, val)) {
+					const float fade = bstrength * tex_strength(ss, brush, vd.co, sqrt(test.dist),
+					                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+					mul_v3_v3fl(proxy[vd.i], val, fade);
+
+					if (vd.mvert)
+						vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+				}
+			}
+		}
+		BKE_pbvh_vertex_iter_end;
+	}
+}
+
 static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 
 	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
@@ -2644,8 +2957,6 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 
 	float displace;
 
-	int n;
-
 	float temp[3];
 
 	calc_sculpt_plane(sd, ob, nodes, totnode, an, fc);
@@ -2656,34 +2967,58 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 	mul_v3_fl(temp, displace);
 	add_v3_v3(fc, temp);
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	copy_v3_v3(data.an, an);
+	copy_v3_v3(data.fc, fc);
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_flatten_brush_task_cb);
+}
+
+static void do_clay_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	float *an = data->an;
+	float *fc = data->fc;
+	const int flip = data->flip;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test_sq(&test, vd.co)) {
-				float intr[3];
-				float val[3];
+				if (plane_point_side_flip(vd.co, an, fc, flip)) {
+					float intr[3];
+					float val[3];
 
-				point_plane_project(intr, vd.co, an, fc);
+					point_plane_project(intr, vd.co, an, fc);
 
-				sub_v3_v3v3(val, intr, vd.co);
+					sub_v3_v3v3(val, intr, vd.co);
 
-				if (plane_trim(ss->cache, brush, val)) {
-					const float fade = bstrength * tex_strength(ss, brush, vd.co, sqrt(test.dist),
-					                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+					if (plane_trim(ss->cache, brush, val)) {
+						const float fade = bstrength * tex_strength(ss, brush, vd.co,
+						                                            sqrt(test.dist),
+						                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-					mul_v3_v3fl(proxy[vd.i], val, fade);
+						mul_v3_v3fl(proxy[vd.i], val, fade);
 
-					if (vd.mvert)
-						vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+						if (vd.mvert)
+							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+					}
 				}
 			}
 		}
@@ -2695,6 +3030,7 @@ static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 
 	float bstrength = ss->cache->bstrength;
 	float radius    = ss->cache->radius;
@@ -2705,8 +3041,6 @@ static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	float an[3];
 	float fc[3];
 
-	int n;
-
 	float temp[3];
 
 	int flip;
@@ -2728,30 +3062,53 @@ static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 
 	/* add_v3_v3v3(p, ss->cache->location, an); */
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	data.flip = flip;
+	copy_v3_v3(data.an, an);
+	copy_v3_v3(data.fc, fc);
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_clay_brush_task_cb);
+}
+
+static void do_clay_strips_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	float *an = data->an;
+	float *fc = data->fc;
+	float *sn = data->sn;
+	const int flip = data->flip;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (plane_point_side_flip(vd.co, an, fc, flip)) {
+			if (sculpt_brush_test_cube(&test, vd.co, data->mat)) {
+				if (plane_point_side_flip(vd.co, sn, fc, flip)) {
 					float intr[3];
 					float val[3];
 
-					point_plane_project(intr, vd.co, an, fc);
+					point_plane_project(intr, vd.co, sn, fc);
 
 					sub_v3_v3v3(val, intr, vd.co);
 
 					if (plane_trim(ss->cache, brush, val)) {
 						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            sqrt(test.dist),
+						                                            ss->cache->radius * test.dist,
 						                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
 						mul_v3_v3fl(proxy[vd.i], val, fade);
@@ -2770,6 +3127,7 @@ static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int t
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 
 	float bstrength = ss->cache->bstrength;
 	float radius    = ss->cache->radius;
@@ -2781,8 +3139,6 @@ static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int t
 	float an[3];
 	float fc[3];
 
-	int n;
-
 	float temp[3];
 	float mat[4][4];
 	float scale[4][4];
@@ -2830,30 +3186,53 @@ static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int t
 	mul_m4_m4m4(tmat, mat, scale);
 	invert_m4_m4(mat, tmat);
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	data.flip = flip;
+	copy_v3_v3(data.an, an);
+	copy_v3_v3(data.sn, sn);
+	copy_v3_v3(data.fc, fc);
+	copy_m4_m4(data.mat, mat);
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_clay_strips_brush_task_cb);
+}
+
+static void do_fill_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	float *an = data->an;
+	float *fc = data->fc;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
-			if (sculpt_brush_test_cube(&test, vd.co, mat)) {
-				if (plane_point_side_flip(vd.co, sn, fc, flip)) {
+			if (sculpt_brush_test_sq(&test, vd.co)) {
+				if (plane_point_side(vd.co, an, fc)) {
 					float intr[3];
 					float val[3];
 
-					point_plane_project(intr, vd.co, sn, fc);
+					point_plane_project(intr, vd.co, an, fc);
 
 					sub_v3_v3v3(val, intr, vd.co);
 
 					if (plane_trim(ss->cache, brush, val)) {
 						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            ss->cache->radius * test.dist,
+						                                            sqrt(test.dist),
 						                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
 						mul_v3_v3fl(proxy[vd.i], val, fade);
@@ -2872,6 +3251,7 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 
 	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
@@ -2882,8 +3262,6 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 
 	float displace;
 
-	int n;
-
 	float temp[3];
 
 	calc_sculpt_plane(sd, ob, nodes, totnode, an, fc);
@@ -2894,20 +3272,40 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	mul_v3_fl(temp, displace);
 	add_v3_v3(fc, temp);
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	copy_v3_v3(data.an, an);
+	copy_v3_v3(data.fc, fc);
+
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_fill_brush_task_cb);
+}
+
+static void do_scrape_brush_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = data->bstrength;
+	float *an = data->an;
+	float *fc = data->fc;
+	int n;
+
+	for (n = start; n < stop; n++) {
 		PBVHVertexIter vd;
 		SculptBrushTest test;
 		float (*proxy)[3];
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
 		sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
 		{
 			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (plane_point_side(vd.co, an, fc)) {
+				if (!plane_point_side(vd.co, an, fc)) {
 					float intr[3];
 					float val[3];
 
@@ -2936,6 +3334,7 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData data = {NULL};
 
 	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
@@ -2946,8 +3345,6 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 
 	float displace;
 
-	int n;
-
 	float temp[3];
 
 	calc_sculpt_plane(sd, ob, nodes, totnode, an, fc);
@@ -2958,42 +3355,15 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	mul_v3_fl(temp, displace);
 	add_v3_v3(fc, temp);
 
-	#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
-
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
-
-		sculpt_brush_test_init(ss, &test);
-
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (!plane_point_side(vd.co, an, fc)) {
-					float intr[3];
-					float val[3];
-
-					point_plane_project(intr, vd.co, an, fc);
-
-					sub_v3_v3v3(val, intr, vd.co);
-
-					if (plane_trim(ss->cache, brush, val)) {
-						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            sqrt(test.dist),
-						                                            an, vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
-
-						mul_v3_v3fl(proxy[vd.i], val, fade);
+	data.sd = sd;
+	data.ob = ob;
+	data.brush = brush;
+	data.nodes = nodes;
+	data.bstrength = bstrength;
+	copy_v3_v3(data.an, an);
+	copy_v3_v3(data.fc, fc);
 
-						if (vd.mvert)
-							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-					}
-				}
-			}
-		}
-		BKE_pbvh_vertex_iter_end;
-	}
+	sculpt_task_parallel_nodes(sd, &data, totnode, do_scrape_brush_task_cb);
 }
 
 void sculpt_vertcos_to_key(Object *ob, KeyBlock *kb, float (*vertCos)[3])
@@ -3114,6 +3484,17 @@ static void sculpt_topology_update(Sculpt *sd, Object *ob, Brush *brush)
 	}
 }
 
+static void do_brush_action_undo_push_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	int n;
+
+	for (n = start; n < stop; n++) {
+		sculpt_undo_push_node(data->ob, data->nodes[n], data->undo_type);
+		BKE_pbvh_node_mark_update(data->nodes[n]);
+	}
+}
+
 static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush)
 {
 	SculptSession *ss = ob->sculpt;
@@ -3134,14 +3515,25 @@ static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush)
 
 	/* Only act if some verts are inside the brush area */
 	if (totnode) {
+		SculptThreadedTaskData task_data = {NULL};
 		float location[3];
 
-		#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-		for (n = 0; n < totnode; n++) {
-			sculpt_undo_push_node(ob, nodes[n],
-			                      brush->sculpt_tool == SCULPT_TOOL_MASK ?
-			                      SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
-			BKE_pbvh_node_mark_update(nodes[n]);
+		task_data.sd = sd;
+		task_data.ob = ob;
+		task_data.nodes = nodes;
+		task_data.undo_type = (brush->sculpt_tool == SCULPT_TOOL_MASK ?
+		                       SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
+
+		/* The BMLog isn't thread safe, with dynamic topology the nodes
+		 * are logged here once, brush threads only read the log */
+		if (ss->bm) {
+			for (n = 0; n < totnode; n++) {
+				sculpt_undo_push_node(ob, nodes[n], task_data.undo_type);
+				BKE_pbvh_node_mark_update(nodes[n]);
+			}
+		}
+		else {
+			sculpt_task_parallel_nodes(sd, &task_data, totnode, do_brush_action_undo_push_task_cb);
 		}
 
 		if (brush_needs_sculpt_normal(brush))
@@ -3249,61 +3641,77 @@ static void sculpt_flush_pbvhvert_deform(Object *ob, PBVHVertexIter *vd)
 		copy_v3_v3(me->mvert[index].co, newco);
 }
 
-static void sculpt_combine_proxies(Sculpt *sd, Object *ob)
+static void sculpt_combine_proxies_task_cb(void *userdata, int start, int stop)
 {
+	SculptThreadedTaskData *data = userdata;
+	Sculpt *sd = data->sd;
+	Object *ob = data->ob;
 	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	PBVHNode **nodes;
-	int totnode, n;
+	const int use_orco = data->original;
+	int n;
 
-	BKE_pbvh_gather_proxies(ss->pbvh, &nodes, &totnode);
+	for (n = start; n < stop; n++) {
+		PBVHVertexIter vd;
+		PBVHProxyNode *proxies;
+		int proxy_count;
+		float (*orco)[3] = NULL;
 
-	if (!ELEM(brush->sculpt_tool, SCULPT_TOOL_SMOOTH, SCULPT_TOOL_LAYER)) {
-		/* these brushes start from original coordinates */
-		const int use_orco = (ELEM3(brush->sculpt_tool, SCULPT_TOOL_GRAB,
-		                            SCULPT_TOOL_ROTATE, SCULPT_TOOL_THUMB));
+		if (use_orco && !ss->bm)
+			orco = sculpt_undo_push_node(ob, data->nodes[n], SCULPT_UNDO_COORDS)->co;
 
-		#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-		for (n = 0; n < totnode; n++) {
-			PBVHVertexIter vd;
-			PBVHProxyNode *proxies;
-			int proxy_count;
-			float (*orco)[3] = NULL;
+		BKE_pbvh_node_get_proxies(data->nodes[n], &proxies, &proxy_count);
 
-			if (use_orco && !ss->bm)
-				orco = sculpt_undo_push_node(ob, nodes[n], SCULPT_UNDO_COORDS)->co;
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+		{
+			float val[3];
+			int p;
+
+			if (use_orco) {
+				if (ss->bm) {
+					copy_v3_v3(val,
+					           BM_log_original_vert_co(ss->bm_log,
+					           vd.bm_vert));
+				}
+				else
+					copy_v3_v3(val, orco[vd.i]);
+			}
+			else
+				copy_v3_v3(val, vd.co);
 
-			BKE_pbvh_node_get_proxies(nodes[n], &proxies, &proxy_count);
+			for (p = 0; p < proxy_count; p++)
+				add_v3_v3(val, proxies[p].co[vd.i]);
 
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-			{
-				float val[3];
-				int p;
+			sculpt_clip(sd, ss, vd.co, val);
 
-				if (use_orco) {
-					if (ss->bm) {
-						copy_v3_v3(val,
-						           BM_log_original_vert_co(ss->bm_log,
-						           vd.bm_vert));
-					}
-					else
-						copy_v3_v3(val, orco[vd.i]);
-				}
-				else
-					copy_v3_v3(val, vd.co);
+			if (ss->modifiers_active)
+				sculpt_flush_pbvhvert_deform(ob, &vd);
+		}
+		BKE_pbvh_vertex_iter_end;
 
-				for (p = 0; p < proxy_count; p++)
-					add_v3_v3(val, proxies[p].co[vd.i]);
+		BKE_pbvh_node_free_proxies(data->nodes[n]);
+	}
+}
 
-				sculpt_clip(sd, ss, vd.co, val);
+static void sculpt_combine_proxies(Sculpt *sd, Object *ob)
+{
+	SculptSession *ss = ob->sculpt;
+	Brush *brush = BKE_paint_brush(&sd->paint);
+	PBVHNode **nodes;
+	int totnode;
 
-				if (ss->modifiers_active)
-					sculpt_flush_pbvhvert_deform(ob, &vd);
-			}
-			BKE_pbvh_vertex_iter_end;
+	BKE_pbvh_gather_proxies(ss->pbvh, &nodes, &totnode);
 
-			BKE_pbvh_node_free_proxies(nodes[n]);
-		}
+	if (!ELEM(brush->sculpt_tool, SCULPT_TOOL_SMOOTH, SCULPT_TOOL_LAYER)) {
+		SculptThreadedTaskData data = {NULL};
+
+		data.sd = sd;
+		data.ob = ob;
+		data.nodes = nodes;
+		/* these brushes start from original coordinates */
+		data.original = (ELEM3(brush->sculpt_tool, SCULPT_TOOL_GRAB,
+		                       SCULPT_TOOL_ROTATE, SCULPT_TOOL_THUMB));
+
+		sculpt_task_parallel_nodes(sd, &data, totnode, sculpt_combine_proxies_task_cb);
 	}
 
 	if (nodes)
@@ -3329,6 +3737,30 @@ static void sculpt_update_keyblock(Object *ob)
 	}
 }
 
+static void sculpt_flush_stroke_deform_task_cb(void *userdata, int start, int stop)
+{
+	SculptThreadedTaskData *data = userdata;
+	Object *ob = data->ob;
+	SculptSession *ss = ob->sculpt;
+	float (*vertCos)[3] = data->vertCos;
+	int n;
+
+	for (n = start; n < stop; n++) {
+		PBVHVertexIter vd;
+
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+		{
+			sculpt_flush_pbvhvert_deform(ob, &vd);
+
+			if (vertCos) {
+				int index = vd.vert_indices[vd.i];
+				copy_v3_v3(vertCos[index], ss->orig_cos[index]);
+			}
+		}
+		BKE_pbvh_vertex_iter_end;
+	}
+}
+
 /* flush displacement from deformed PBVH to original layer */
 static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 {
@@ -3339,7 +3771,8 @@ static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 		/* this brushes aren't using proxies, so sculpt_combine_proxies() wouldn't
 		 * propagate needed deformation to original base */
 
-		int n, totnode;
+		SculptThreadedTaskData data = {NULL};
+		int totnode;
 		Mesh *me = (Mesh *)ob->data;
 		PBVHNode **nodes;
 		float (*vertCos)[3] = NULL;
@@ -3356,21 +3789,12 @@ static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 
 		BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
 
-		#pragma omp parallel for schedule(guided) if (sd->flags & SCULPT_USE_OPENMP)
-		for (n = 0; n < totnode; n++) {
-			PBVHVertexIter vd;
-
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-			{
-				sculpt_flush_pbvhvert_deform(ob, &vd);
+		data.sd = sd;
+		data.ob = ob;
+		data.nodes = nodes;
+		data.vertCos = vertCos;
 
-				if (vertCos) {
-					int index = vd.vert_indices[vd.i];
-					copy_v3_v3(vertCos[index], ss->orig_cos[index]);
-				}
-			}
-			BKE_pbvh_vertex_iter_end;
-		}
+		sculpt_task_parallel_nodes(sd, &data, totnode, sculpt_flush_stroke_deform_task_cb);
 
 		if (vertCos) {
 			sculpt_vertcos_to_key(ob, ss->kb, vertCos);
@@ -3728,69 +4152,6 @@ static void sculpt_init_mirror_clipping(Object *ob, SculptSession *ss)
 	}
 }
 
-static void sculpt_omp_start(Sculpt *sd, SculptSession *ss)
-{
-	StrokeCache *cache = ss->cache;
-
-#ifdef _OPENMP
-	/* If using OpenMP then create a number of threads two times the
-	 * number of processor cores.
-	 * Justification: Empirically I've found that two threads per
-	 * processor gives higher throughput. */
-	if (sd->flags & SCULPT_USE_OPENMP) {
-		cache->num_threads = 2 * omp_get_num_procs();
-		omp_set_num_threads(cache->num_threads);
-	}
-	else
-#endif
-	{
-		(void)sd;
-		cache->num_threads = 1;
-	}
-
-	if (ss->multires) {
-		int i, gridsize, array_mem_size;
-		BKE_pbvh_node_get_grids(ss->pbvh, NULL, NULL, NULL, NULL,
-		                        &gridsize, NULL, NULL);
-
-		array_mem_size = cache->num_threads * sizeof(void *);
-
-		cache->tmpgrid_co = MEM_mallocN(array_mem_size, "tmpgrid_co array");
-		cache->tmprow_co = MEM_mallocN(array_mem_size, "tmprow_co array");
-		cache->tmpgrid_mask = MEM_mallocN(array_mem_size, "tmpgrid_mask array");
-		cache->tmprow_mask = MEM_mallocN(array_mem_size, "tmprow_mask array");
-
-		for (i = 0; i < cache->num_threads; i++) {
-			const size_t row_size = sizeof(float) * gridsize;
-			const size_t co_row_size = 3 * row_size;
-
-			cache->tmprow_co[i] = MEM_mallocN(co_row_size, "tmprow_co");
-			cache->tmpgrid_co[i] = MEM_mallocN(co_row_size * gridsize, "tmpgrid_co");
-			cache->tmprow_mask[i] = MEM_mallocN(row_size, "tmprow_mask");
-			cache->tmpgrid_mask[i] = MEM_mallocN(row_size * gridsize, "tmpgrid_mask");
-		}
-	}
-}
-
-static void sculpt_omp_done(SculptSession *ss)
-{
-	if (ss->multires) {
-		int i;
-
-		for (i = 0; i < ss->cache->num_threads; i++) {
-			MEM_freeN(ss->cache->tmpgrid_co[i]);
-			MEM_freeN(ss->cache->tmprow_co[i]);
-			MEM_freeN(ss->cache->tmpgrid_mask[i]);
-			MEM_freeN(ss->cache->tmprow_mask[i]);
-		}
-
-		MEM_freeN(ss->cache->tmpgrid_co);
-		MEM_freeN(ss->cache->tmprow_co);
-		MEM_freeN(ss->cache->tmpgrid_mask);
-		MEM_freeN(ss->cache->tmprow_mask);
-	}
-}
-
 /* Initialize the stroke cache invariants from operator properties */
 static void sculpt_update_cache_invariants(bContext *C, Sculpt *sd, SculptSession *ss, wmOperator *op, const float mouse[2])
 {
@@ -3937,8 +4298,6 @@ static void sculpt_update_cache_invariants(bContext *C, Sculpt *sd, SculptSessio
 	cache->num_vertex_turns = 0;
 	cache->previous_vertex_rotation = 0;
 	cache->init_dir_set = false;
-
-	sculpt_omp_start(sd, ss);
 }
 
 static void sculpt_update_brush_delta(UnifiedPaintSettings *ups, Object *ob, Brush *brush)
@@ -4459,8 +4818,6 @@ static void sculpt_stroke_done(const bContext *C, struct PaintStroke *UNUSED(str
 	SculptSession *ss = ob->sculpt;
 	Sculpt *sd = CTX_data_tool_settings(C)->sculpt;
 
-	sculpt_omp_done(ss);
-
 	/* reset values used to draw brush after completing the stroke */
 	ups->draw_anchored = 0;
 	ups->draw_pressure = 0;
@@ -4495,7 +4852,7 @@ static void sculpt_stroke_done(const bContext *C, struct PaintStroke *UNUSED(str
 		sculpt_cache_free(ss->cache);
 		ss->cache = NULL;
 
-		sculpt_undo_push_end();
+		sculpt_undo_push_end(ob);
 
 		BKE_pbvh_update(ss->pbvh, PBVH_UpdateOriginalBB, NULL);
 		
@@ -4795,7 +5152,7 @@ static int sculpt_dynamic_topology_toggle_exec(bContext *C, wmOperator *UNUSED(o
 		sculpt_dynamic_topology_enable(C);
 		sculpt_undo_push_node(ob, NULL, SCULPT_UNDO_DYNTOPO_BEGIN);
 	}
-	sculpt_undo_push_end();
+	sculpt_undo_push_end(ob);
 
 	return OPERATOR_FINISHED;
 }
@@ -4901,7 +5258,7 @@ static int sculpt_symmetrize_exec(bContext *C, wmOperator *UNUSED(op))
 
 	/* Finish undo */
 	BM_log_all_added(ss->bm, ss->bm_log);
-	sculpt_undo_push_end();
+	sculpt_undo_push_end(ob);
 
 	/* Redraw */
 	sculpt_pbvh_clear(ob);
@@ -42,6 +42,7 @@
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
@@ -527,6 +528,22 @@ SculptUndoNode *sculpt_undo_get_node(PBVHNode *node)
 	return BLI_findptr(lb, node, offsetof(SculptUndoNode, node));
 }
 
+/* Undo node for a PBVH node that was pushed already, for brush threads.
+ * With dynamic topology all PBVH nodes share one undo node, it's returned
+ * without logging the node's vertices again, so the BMLog isn't modified
+ * while other threads read original coordinates from it. */
+SculptUndoNode *sculpt_undo_get_pushed_node(Object *ob, PBVHNode *node)
+{
+	if (ob->sculpt->bm) {
+		ListBase *lb = undo_paint_push_get_list(UNDO_PAINT_MESH);
+
+		if (lb && lb->first)
+			return lb->first;
+	}
+
+	return sculpt_undo_push_node(ob, node, SCULPT_UNDO_COORDS);
+}
+
 static void sculpt_undo_alloc_and_store_hidden(PBVH *pbvh,
                                                SculptUndoNode *unode)
 {
@@ -575,15 +592,12 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node,
 	
 	/* we will use this while sculpting, is mapalloc slow to access then? */
 
-	/* general TODO, fix count_alloc */
+	/* memory is counted in sculpt_undo_push_end, after unchanged
+	 * elements were removed */
 	switch (type) {
 		case SCULPT_UNDO_COORDS:
 			unode->co = MEM_mapallocN(sizeof(float) * 3 * allvert, "SculptUndoNode.co");
 			unode->no = MEM_mapallocN(sizeof(short) * 3 * allvert, "SculptUndoNode.no");
-			undo_paint_push_count_alloc(UNDO_PAINT_MESH,
-			                            (sizeof(float) * 3 +
-			                             sizeof(short) * 3 +
-			                             sizeof(int)) * allvert);
 			break;
 		case SCULPT_UNDO_HIDDEN:
 			if (maxgrid)
@@ -594,7 +608,6 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node,
 			break;
 		case SCULPT_UNDO_MASK:
 			unode->mask = MEM_mapallocN(sizeof(float) * allvert, "SculptUndoNode.mask");
-			undo_paint_push_count_alloc(UNDO_PAINT_MESH, (sizeof(float) * sizeof(int)) * allvert);
 			break;
 		case SCULPT_UNDO_DYNTOPO_BEGIN:
 		case SCULPT_UNDO_DYNTOPO_END:
@@ -823,10 +836,201 @@ void sculpt_undo_push_begin(const char *name)
 	                      sculpt_undo_restore, sculpt_undo_free);
 }
 
-void sculpt_undo_push_end(void)
+/* Shrink an undo array to the first len bytes, freeing it when empty. */
+static void *sculpt_undo_array_shrink(void *array, size_t len)
+{
+	if (array == NULL || len == MEM_allocN_len(array))
+		return array;
+
+	if (len == 0) {
+		MEM_freeN(array);
+		return NULL;
+	}
+
+	return MEM_reallocN(array, len);
+}
+
+/* Drop the vertices of a regular mesh undo node that weren't changed by
+ * the operation, restoring them is a no-op. Stored vertices keep their
+ * order so the index array still maps them into the mesh. */
+static void sculpt_undo_compact_verts(SculptSession *ss, SculptUndoNode *unode)
+{
+	PBVHVertexIter vd;
+	BLI_bitmap *changed = BLI_BITMAP_NEW(unode->totvert, "sculpt_undo_compact_verts");
+	int i, totchanged = 0;
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, unode->node, vd, PBVH_ITER_UNIQUE)
+	{
+		if ((unode->co && !equals_v3v3(unode->co[vd.i], vd.co)) ||
+		    (unode->mask && unode->mask[vd.i] != *vd.mask))
+		{
+			BLI_BITMAP_SET(changed, vd.i);
+			totchanged++;
+		}
+	}
+	BKE_pbvh_vertex_iter_end;
+
+	if (totchanged != unode->totvert) {
+		for (i = 0, totchanged = 0; i < unode->totvert; i++) {
+			if (BLI_BITMAP_GET(changed, i)) {
+				unode->index[totchanged] = unode->index[i];
+				if (unode->co)
+					copy_v3_v3(unode->co[totchanged], unode->co[i]);
+				if (unode->orig_co)
+					copy_v3_v3(unode->orig_co[totchanged], unode->orig_co[i]);
+				if (unode->mask)
+					unode->mask[totchanged] = unode->mask[i];
+				totchanged++;
+			}
+		}
+
+		unode->totvert = totchanged;
+		unode->index = sculpt_undo_array_shrink(unode->index, sizeof(*unode->index) * totchanged);
+		unode->co = sculpt_undo_array_shrink(unode->co, sizeof(*unode->co) * totchanged);
+		unode->orig_co = sculpt_undo_array_shrink(unode->orig_co, sizeof(*unode->orig_co) * totchanged);
+		unode->mask = sculpt_undo_array_shrink(unode->mask, sizeof(*unode->mask) * totchanged);
+	}
+
+	MEM_freeN(changed);
+}
+
+/* Same for multires, per grid since grids are restored as a whole. */
+static void sculpt_undo_compact_grids(SculptSession *ss, SculptUndoNode *unode)
+{
+	CCGElem **griddata;
+	CCGKey key;
+	int i, j, gridsize, grid_area, totchanged = 0;
+
+	BKE_pbvh_node_get_grids(ss->pbvh, unode->node, NULL, NULL, NULL,
+	                        &gridsize, &griddata, NULL);
+	if (gridsize != unode->gridsize)
+		return;
+
+	BKE_pbvh_get_grid_key(ss->pbvh, &key);
+	grid_area = gridsize * gridsize;
+
+	for (j = 0; j < unode->totgrid; j++) {
+		CCGElem *grid = griddata[unode->grids[j]];
+		const int offset = j * grid_area;
+		bool changed = false;
+
+		for (i = 0; i < grid_area && !changed; i++) {
+			if (unode->co && !equals_v3v3(unode->co[offset + i], CCG_elem_offset_co(&key, grid, i)))
+				changed = true;
+			else if (unode->mask && unode->mask[offset + i] != *CCG_elem_offset_mask(&key, grid, i))
+				changed = true;
+		}
+
+		if (changed) {
+			if (totchanged != j) {
+				const int new_offset = totchanged * grid_area;
+
+				unode->grids[totchanged] = unode->grids[j];
+				if (unode->co)
+					memcpy(unode->co[new_offset], unode->co[offset], sizeof(*unode->co) * grid_area);
+				if (unode->mask)
+					memcpy(&unode->mask[new_offset], &unode->mask[offset], sizeof(*unode->mask) * grid_area);
+			}
+			totchanged++;
+		}
+	}
+
+	if (totchanged != unode->totgrid) {
+		unode->totgrid = totchanged;
+		unode->totvert = totchanged * grid_area;
+		unode->grids = sculpt_undo_array_shrink(unode->grids, sizeof(*unode->grids) * totchanged);
+		unode->co = sculpt_undo_array_shrink(unode->co, sizeof(*unode->co) * grid_area * totchanged);
+		unode->mask = sculpt_undo_array_shrink(unode->mask, sizeof(*unode->mask) * grid_area * totchanged);
+	}
+}
+
+typedef struct SculptUndoCompactData {
+	SculptSession *ss;
+	SculptUndoNode **unodes;
+} SculptUndoCompactData;
+
+static void sculpt_undo_compact_task_cb(void *userdata, int start, int stop)
+{
+	SculptUndoCompactData *data = userdata;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		SculptUndoNode *unode = data->unodes[i];
+
+		if (unode->maxvert)
+			sculpt_undo_compact_verts(data->ss, unode);
+		else if (unode->maxgrid)
+			sculpt_undo_compact_grids(data->ss, unode);
+	}
+}
+
+/* Remove unchanged data of coordinate and mask undo nodes, only the
+ * elements an operation modified stay in the undo stack. Nodes are
+ * compared against the current state, so this runs while their PBVH
+ * nodes are still valid. */
+static void sculpt_undo_compact(Object *ob, ListBase *lb)
+{
+	SculptSession *ss = ob->sculpt;
+	SculptUndoCompactData data;
+	SculptUndoNode *unode;
+	int totnode = 0;
+
+	if (!ss || !ss->pbvh || ss->bm)
+		return;
+
+	data.ss = ss;
+	data.unodes = MEM_mallocN(sizeof(*data.unodes) * BLI_countlist(lb), "sculpt_undo_compact");
+
+	for (unode = lb->first; unode; unode = unode->next) {
+		if (unode->node &&
+		    ELEM(unode->type, SCULPT_UNDO_COORDS, SCULPT_UNDO_MASK) &&
+		    STREQ(unode->idname, ob->id.name) &&
+		    !(unode->maxgrid && unode->orig_co))
+		{
+			data.unodes[totnode++] = unode;
+		}
+	}
+
+	BLI_task_parallel_range_ex(0, totnode, &data, sculpt_undo_compact_task_cb, 8);
+
+	MEM_freeN(data.unodes);
+}
+
+static size_t sculpt_undo_node_size(SculptUndoNode *unode)
+{
+	size_t size = sizeof(*unode);
+	int i;
+
+	if (unode->co)
+		size += MEM_allocN_len(unode->co);
+	if (unode->orig_co)
+		size += MEM_allocN_len(unode->orig_co);
+	if (unode->no)
+		size += MEM_allocN_len(unode->no);
+	if (unode->mask)
+		size += MEM_allocN_len(unode->mask);
+	if (unode->index)
+		size += MEM_allocN_len(unode->index);
+	if (unode->grids)
+		size += MEM_allocN_len(unode->grids);
+	if (unode->vert_hidden)
+		size += MEM_allocN_len(unode->vert_hidden);
+	if (unode->grid_hidden) {
+		size += MEM_allocN_len(unode->grid_hidden);
+		for (i = 0; i < unode->totgrid; i++) {
+			if (unode->grid_hidden[i])
+				size += MEM_allocN_len(unode->grid_hidden[i]);
+		}
+	}
+
+	return size;
+}
+
+void sculpt_undo_push_end(Object *ob)
 {
 	ListBase *lb = undo_paint_push_get_list(UNDO_PAINT_MESH);
 	SculptUndoNode *unode;
+	size_t size = 0;
 
 	/* we don't need normals in the undo stack */
 	for (unode = lb->first; unode; unode = unode->next) {
@@ -834,10 +1038,19 @@ void sculpt_undo_push_end(void)
 			MEM_freeN(unode->no);
 			unode->no = NULL;
 		}
+	}
+
+	sculpt_undo_compact(ob, lb);
 
+	for (unode = lb->first; unode; unode = unode->next) {
 		if (unode->node)
 			BKE_pbvh_node_layer_disp_free(unode->node);
+
+		size += sculpt_undo_node_size(unode);
 	}
 
+	/* the undo memory limit is applied to the stack with this size */
+	undo_paint_push_count_alloc(UNDO_PAINT_MESH, (int)size);
+
 	undo_paint_push_end(UNDO_PAINT_MESH);
 }
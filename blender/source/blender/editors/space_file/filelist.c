@@ -46,6 +46,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "BLI_fileops_types.h"
@@ -72,8 +73,6 @@
 #include "IMB_imbuf_types.h"
 #include "IMB_thumbs.h"
 
-#include "PIL_time.h"
-
 #include "WM_api.h"
 #include "WM_types.h"
 
@@ -1313,32 +1312,49 @@ static void thumbnail_joblist_free(ThumbnailJob *tj)
 	BLI_freelistN(&tj->loadimages);
 }
 
+/* images and .blend thumbnails, these can be loaded from several threads at once */
+static void thumbnails_load_cb(void *userdata, Link *link, int UNUSED(index))
+{
+	ThumbnailJob *tj = userdata;
+	FileImage *limg = (FileImage *)link;
+
+	if (*tj->stop)
+		return;
+
+	if (limg->flags & IMAGEFILE) {
+		limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_IMAGE);
+	}
+	else if (limg->flags & (BLENDERFILE | BLENDERFILE_BACKUP)) {
+		limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_BLEND);
+	}
+	else {
+		return;
+	}
+
+	*tj->do_update = TRUE;
+}
+
 static void thumbnails_startjob(void *tjv, short *stop, short *do_update, float *UNUSED(progress))
 {
 	ThumbnailJob *tj = tjv;
-	FileImage *limg = tj->loadimages.first;
+	FileImage *limg;
 
 	tj->stop = stop;
 	tj->do_update = do_update;
 
-	while ( (*stop == 0) && (limg) ) {
-		if (limg->flags & IMAGEFILE) {
-			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_IMAGE);
-		}
-		else if (limg->flags & (BLENDERFILE | BLENDERFILE_BACKUP)) {
-			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_BLEND);
-		}
-		else if (limg->flags & MOVIEFILE) {
+	BLI_task_parallel_listbase(&tj->loadimages, tj, thumbnails_load_cb, 1);
+
+	/* opening movies goes through ffmpeg which isn't safe to use from several threads */
+	for (limg = tj->loadimages.first; (*stop == 0) && (limg); limg = limg->next) {
+		if (limg->flags & MOVIEFILE) {
 			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_MOVIE);
 			if (!limg->img) {
 				/* remember that file can't be loaded via IMB_open_anim */
 				limg->flags &= ~MOVIEFILE;
 				limg->flags |= MOVIEFILE_ICON;
 			}
+			*do_update = TRUE;
 		}
-		*do_update = TRUE;
-		PIL_sleep_ms(10);
-		limg = limg->next;
 	}
 }
 
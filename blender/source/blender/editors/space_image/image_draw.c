@@ -40,6 +40,7 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_brush_types.h"
+#include "DNA_userdef_types.h"
 
 #include "PIL_time.h"
 
@@ -66,6 +67,7 @@
 #include "ED_gpencil.h"
 #include "ED_image.h"
 #include "ED_screen.h"
+#include "ED_screen_types.h"
 
 #include "UI_interface.h"
 #include "UI_resources.h"
@@ -768,6 +770,64 @@ static void draw_image_paint_helpers(const bContext *C, ARegion *ar, Scene *scen
 
 /* draw main image area */
 
+/* ******** read-ahead of image sequences during playback ******** */
+
+typedef struct ImagePrefetchJob {
+	Image *ima;
+	ImageUser iuser;
+	int cfra;
+	int direction;
+} ImagePrefetchJob;
+
+static void image_prefetch_startjob(void *pjv, short *stop, short *UNUSED(do_update), float *UNUSED(progress))
+{
+	ImagePrefetchJob *pj = pjv;
+
+	/* no notifiers needed, playback redraws once it reaches the loaded frames */
+	BKE_image_sequence_prefetch(pj->ima, &pj->iuser, pj->cfra, U.prefetchframes, pj->direction, stop);
+}
+
+static void image_prefetch_freejob(void *pjv)
+{
+	MEM_freeN(pjv);
+}
+
+static void image_start_prefetch_job(const bContext *C, Image *ima, ImageUser *iuser)
+{
+	wmWindowManager *wm = CTX_wm_manager(C);
+	ScrArea *sa = CTX_wm_area(C);
+	bScreen *animscreen;
+	ScreenAnimData *sad;
+	ImagePrefetchJob *pj;
+	wmJob *wm_job;
+
+	if (U.prefetchframes <= 0 || ima->source != IMA_SRC_SEQUENCE || ima->type != IMA_TYPE_IMAGE)
+		return;
+
+	animscreen = ED_screen_animation_playing(wm);
+	if (animscreen == NULL)
+		return;
+
+	/* previous read-ahead still busy */
+	if (WM_jobs_test(wm, sa, WM_JOB_TYPE_IMAGE_PREFETCH))
+		return;
+
+	sad = animscreen->animtimer->customdata;
+
+	pj = MEM_callocN(sizeof(ImagePrefetchJob), "image prefetch job");
+	pj->ima = ima;
+	pj->iuser = *iuser;
+	pj->cfra = CTX_data_scene(C)->r.cfra;
+	pj->direction = (sad->flag & ANIMPLAY_FLAG_REVERSE) ? -1 : 1;
+
+	wm_job = WM_jobs_get(wm, CTX_wm_window(C), sa, "Prefetching", 0, WM_JOB_TYPE_IMAGE_PREFETCH);
+	WM_jobs_customdata_set(wm_job, pj, image_prefetch_freejob);
+	WM_jobs_timer(wm_job, 0.2, 0, 0);
+	WM_jobs_callbacks(wm_job, image_prefetch_startjob, NULL, NULL, NULL);
+
+	WM_jobs_start(wm, wm_job);
+}
+
 void draw_image_main(const bContext *C, ARegion *ar)
 {
 	SpaceImage *sima = CTX_wm_space_image(C);
@@ -854,6 +914,10 @@ void draw_image_main(const bContext *C, ARegion *ar)
 		BLI_unlock_thread(LOCK_DRAW_IMAGE);
 	}
 
+	/* load the next frames of image sequences in the background */
+	if (ima && ibuf)
+		image_start_prefetch_job(C, ima, &sima->iuser);
+
 	/* render info */
 	if (ima && show_render)
 		draw_render_info(scene, ima, ar, zoomx, zoomy);
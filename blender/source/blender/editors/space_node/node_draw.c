@@ -758,6 +758,38 @@ void node_draw_shadow(SpaceNode *snode, bNode *node, float radius, float alpha)
 	}
 }
 
+/* time and memory of the last compositor execution, below the node */
+static void node_draw_timings(SpaceNode *snode, bNodeTree *ntree, bNode *node)
+{
+#ifdef WITH_COMPOSITOR
+	rctf *rct = &node->totr;
+	double time;
+	float factor;
+	size_t memory;
+	char str[64];
+
+	if (ntree->type != NTREE_COMPOSIT || !(snode->flag & SNODE_SHOW_TIMINGS))
+		return;
+	if (!COM_getNodeTimings(node, &time, &factor, &memory))
+		return;
+
+	if (memory)
+		BLI_snprintf(str, sizeof(str), "%.1f ms (%d%%), %.1f MB",
+		             time * 1000.0, (int)(factor * 100.0f + 0.5f), memory / (1024.0 * 1024.0));
+	else
+		BLI_snprintf(str, sizeof(str), "%.1f ms (%d%%)", time * 1000.0, (int)(factor * 100.0f + 0.5f));
+
+	uiDefBut(node->block, LABEL, 0, str,
+	         (int)rct->xmin, (int)(rct->ymin - NODE_DY),
+	         (short)max_ff(BLI_rctf_size_x(rct), 8.0f * U.widget_unit), (short)NODE_DY,
+	         NULL, 0, 0, 0, 0, "");
+#else
+	(void)snode;
+	(void)ntree;
+	(void)node;
+#endif
+}
+
 static void node_draw_basis(const bContext *C, ARegion *ar, SpaceNode *snode, bNodeTree *ntree, bNode *node, bNodeInstanceKey key)
 {
 	bNodeInstanceHash *previews = CTX_data_pointer_get(C, "node_previews").data;
@@ -939,6 +971,8 @@ static void node_draw_basis(const bContext *C, ARegion *ar, SpaceNode *snode, bN
 		}
 	}
 	
+	node_draw_timings(snode, ntree, node);
+
 	UI_ThemeClearColor(color_id);
 		
 	uiEndBlock(C, node->block);
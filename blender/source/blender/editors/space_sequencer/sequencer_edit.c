@@ -148,12 +148,24 @@ static void proxy_freejob(void *pjv)
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
 	ProxyJob *pj = pjv;
-	LinkData *link;
+	LinkData *link = pj->queue.first;
 
-	for (link = pj->queue.first; link; link = link->next) {
-		struct SeqIndexBuildContext *context = link->data;
+	/* strips can be queued while the job runs, build them in another batch */
+	while (link && !*stop) {
+		ListBase batch = {NULL, NULL};
+		LinkData *last = pj->queue.last;
+
+		for (; link; link = link->next) {
+			BLI_addtail(&batch, BLI_genericNodeN(link->data));
+
+			if (link == last)
+				break;
+		}
+
+		BKE_sequencer_proxy_rebuild_batch(&batch, stop, do_update, progress);
+		BLI_freelistN(&batch);
 
-		BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
+		link = last->next;
 	}
 
 	if (*stop) {
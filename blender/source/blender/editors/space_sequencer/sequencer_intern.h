@@ -168,6 +168,9 @@ enum {
 /* defines used internally */
 #define SCE_MARKERS 0 // XXX - dummy
 
+/* sequencer_preview.c */
+void sequencer_preview_add_sound(const struct bContext *C, struct Sequence *seq);
+
 /* sequencer_ops.c */
 void sequencer_operatortypes(void);
 void sequencer_keymap(struct wmKeyConfig *keyconf);
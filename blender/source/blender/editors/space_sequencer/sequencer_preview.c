@@ -0,0 +1,159 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2013 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): Blender Foundation
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+
+/** \file blender/editors/space_sequencer/sequencer_preview.c
+ *  \ingroup spseq
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_sound_types.h"
+
+#include "BKE_context.h"
+#include "BKE_global.h"
+#include "BKE_sound.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "ED_screen.h"
+
+/* own include */
+#include "sequencer_intern.h"
+
+typedef struct PreviewJob {
+	ListBase previews;
+	ThreadMutex *mutex;
+	Scene *scene;
+	int total;
+	int processed;
+} PreviewJob;
+
+typedef struct PreviewJobAudio {
+	struct PreviewJobAudio *next, *prev;
+	bSound *sound;
+} PreviewJobAudio;
+
+static void preview_freejob(void *data)
+{
+	PreviewJob *pj = data;
+	PreviewJobAudio *previewjb;
+
+	/* sounds which were queued after the job stopped, they get requested again on the next redraw */
+	while ((previewjb = BLI_pophead(&pj->previews))) {
+		sound_cancel_waveform(previewjb->sound);
+		MEM_freeN(previewjb);
+	}
+
+	BLI_mutex_free(pj->mutex);
+	MEM_freeN(pj);
+}
+
+static void preview_startjob(void *data, short *stop, short *do_update, float *progress)
+{
+	PreviewJob *pj = data;
+
+	while (true) {
+		PreviewJobAudio *previewjb;
+
+		BLI_mutex_lock(pj->mutex);
+		previewjb = BLI_pophead(&pj->previews);
+		BLI_mutex_unlock(pj->mutex);
+
+		if (!previewjb)
+			break;
+
+		if (*stop)
+			sound_cancel_waveform(previewjb->sound);
+		else
+			sound_read_waveform(previewjb->sound, stop);
+
+		MEM_freeN(previewjb);
+
+		BLI_mutex_lock(pj->mutex);
+		pj->processed++;
+		*progress = (float)pj->processed / (float)pj->total;
+		BLI_mutex_unlock(pj->mutex);
+
+		*do_update = TRUE;
+	}
+}
+
+static void preview_endjob(void *data)
+{
+	PreviewJob *pj = data;
+
+	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, pj->scene);
+}
+
+void sequencer_preview_add_sound(const bContext *C, Sequence *seq)
+{
+	wmJob *wm_job;
+	PreviewJob *pj;
+	PreviewJobAudio *audiojob;
+	ScrArea *sa = CTX_wm_area(C);
+
+	/* already loaded or queued */
+	if (!sound_request_waveform(seq->sound))
+		return;
+
+	wm_job = WM_jobs_get(CTX_wm_manager(C), CTX_wm_window(C), sa, "Strip Previews",
+	                     WM_JOB_PROGRESS, WM_JOB_TYPE_SEQ_BUILD_PREVIEW);
+
+	pj = WM_jobs_customdata_get(wm_job);
+
+	if (!pj) {
+		pj = MEM_callocN(sizeof(PreviewJob), "preview rebuild job");
+
+		pj->mutex = BLI_mutex_alloc();
+		pj->scene = CTX_data_scene(C);
+
+		WM_jobs_customdata_set(wm_job, pj, preview_freejob);
+		WM_jobs_timer(wm_job, 0.1, NC_SCENE | ND_SEQUENCER, NC_SCENE | ND_SEQUENCER);
+		WM_jobs_callbacks(wm_job, preview_startjob, NULL, NULL, preview_endjob);
+	}
+
+	audiojob = MEM_callocN(sizeof(PreviewJobAudio), "preview_audio");
+	audiojob->sound = seq->sound;
+
+	BLI_mutex_lock(pj->mutex);
+	BLI_addtail(&pj->previews, audiojob);
+	pj->total++;
+	BLI_mutex_unlock(pj->mutex);
+
+	if (!WM_jobs_is_running(wm_job)) {
+		G.is_break = FALSE;
+		WM_jobs_start(CTX_wm_manager(C), wm_job);
+	}
+
+	ED_area_tag_redraw(sa);
+}
@@ -869,32 +869,32 @@ void view3d_cached_text_draw_end(View3D *v3d, ARegion *ar, bool depth_write, flo
 
 /* ******************** primitive drawing ******************* */
 
+/* edges of a box with corners ordered like BoundBox.vec */
+static const GLubyte box_edge_indices[12][2] = {
+	{0, 1}, {1, 2}, {2, 3}, {3, 0},
+	{4, 5}, {5, 6}, {6, 7}, {7, 4},
+	{0, 4}, {1, 5}, {2, 6}, {3, 7}
+};
+
+/* draws the edges of a box in one call, used for bounds and empties */
+static void draw_box(float vec[8][3])
+{
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vec);
+	glDrawElements(GL_LINES, 24, GL_UNSIGNED_BYTE, box_edge_indices);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 /* draws a cube on given the scaling of the cube, assuming that
  * all required matrices have been set (used for drawing empties)
  */
 static void drawcube_size(float size)
 {
-	glBegin(GL_LINE_STRIP);
-	glVertex3f(-size, -size, -size); glVertex3f(-size, -size, size);
-	glVertex3f(-size, size, size); glVertex3f(-size, size, -size);
+	const float min[3] = {-size, -size, -size}, max[3] = {size, size, size};
+	BoundBox bb;
 
-	glVertex3f(-size, -size, -size); glVertex3f(size, -size, -size);
-	glVertex3f(size, -size, size); glVertex3f(size, size, size);
-
-	glVertex3f(size, size, -size); glVertex3f(size, -size, -size);
-	glEnd();
-
-	glBegin(GL_LINE_STRIP);
-	glVertex3f(-size, -size, size); glVertex3f(size, -size, size);
-	glEnd();
-
-	glBegin(GL_LINE_STRIP);
-	glVertex3f(-size, size, size); glVertex3f(size, size, size);
-	glEnd();
-
-	glBegin(GL_LINE_STRIP);
-	glVertex3f(-size, size, -size); glVertex3f(size, size, -size);
-	glEnd();
+	BKE_boundbox_init_from_minmax(&bb, min, max);
+	draw_box(bb.vec);
 }
 
 /* this is an unused (old) cube-drawing function based on a given size */
@@ -3358,6 +3358,43 @@ static void draw_mesh_object_outline(View3D *v3d, Object *ob, DerivedMesh *dm)
 	}
 }
 
+/* level of detail: meshes smaller than U.lodsize pixels on screen are
+ * drawn from a decimated proxy with this share of the faces */
+#define DRAW_LOD_FACE_RATIO 0.1f
+#define DRAW_LOD_MIN_FACES 5000
+
+static DerivedMesh *draw_mesh_lod_proxy(Scene *scene, RegionView3D *rv3d, Object *ob, DerivedMesh *dm, const char dt)
+{
+	BoundBox *bb;
+	float min[3], max[3], center[3], size, pixsize;
+
+	if (U.lodsize == 0 || !ELEM(dt, OB_WIRE, OB_SOLID))
+		return NULL;
+
+	/* paint and edit modes need the original mapping */
+	if (ob->mode != OB_MODE_OBJECT || ob == scene->obedit)
+		return NULL;
+
+	if (dm->getNumPolys(dm) < DRAW_LOD_MIN_FACES)
+		return NULL;
+
+	/* dupli display lists are compiled with a unit matrix */
+	bb = BKE_object_boundbox_get(ob);
+	if (!bb || (bb->flag & BOUNDBOX_DISABLED))
+		return NULL;
+
+	mul_v3_m4v3(min, ob->obmat, bb->vec[0]);
+	mul_v3_m4v3(max, ob->obmat, bb->vec[6]);
+	mid_v3_v3v3(center, min, max);
+	size = len_v3v3(min, max);
+
+	pixsize = fabsf(ED_view3d_pixel_size(rv3d, center));
+	if (pixsize == 0.0f || size / pixsize >= (float)U.lodsize)
+		return NULL;
+
+	return DM_get_lod_proxy(dm, DRAW_LOD_FACE_RATIO);
+}
+
 static void draw_mesh_fancy(Scene *scene, ARegion *ar, View3D *v3d, RegionView3D *rv3d, Base *base,
                             const char dt, const unsigned char ob_wire_col[4], const short dflag)
 {
@@ -3368,12 +3405,18 @@ static void draw_mesh_fancy(Scene *scene, ARegion *ar, View3D *v3d, RegionView3D
 	eWireDrawMode draw_wire = OBDRAW_WIRE_OFF;
 	int /* totvert,*/ totedge, totface;
 	DerivedMesh *dm = mesh_get_derived_final(scene, ob, scene->customdata_mask);
+	DerivedMesh *dm_full = NULL, *dm_lod;
 	const bool is_obact = (ob == OBACT);
 	int draw_flags = (is_obact && paint_facesel_test(ob)) ? DRAW_FACE_SELECT : 0;
 
 	if (!dm)
 		return;
 
+	if ((dm_lod = draw_mesh_lod_proxy(scene, rv3d, ob, dm, dt))) {
+		dm_full = dm;
+		dm = dm_lod;
+	}
+
 	/* Check to draw dynamic paint colors (or weights from WeightVG modifiers).
 	 * Note: Last "preview-active" modifier in stack will win! */
 	if (DM_get_tessface_data_layer(dm, CD_PREVIEW_MCOL) && modifiers_isPreview(ob))
@@ -3593,6 +3636,8 @@ static void draw_mesh_fancy(Scene *scene, ARegion *ar, View3D *v3d, RegionView3D
 		glPointSize(1.0f);
 	}
 	dm->release(dm);
+	if (dm_full)
+		dm_full->release(dm_full);
 }
 
 /* returns 1 if nothing was drawn, for detecting to draw an object center */
@@ -6165,21 +6210,6 @@ static void draw_forcefield(Object *ob, RegionView3D *rv3d,
 	setlinestyle(0);
 }
 
-static void draw_box(float vec[8][3])
-{
-	glBegin(GL_LINE_STRIP);
-	glVertex3fv(vec[0]); glVertex3fv(vec[1]); glVertex3fv(vec[2]); glVertex3fv(vec[3]);
-	glVertex3fv(vec[0]); glVertex3fv(vec[4]); glVertex3fv(vec[5]); glVertex3fv(vec[6]);
-	glVertex3fv(vec[7]); glVertex3fv(vec[4]);
-	glEnd();
-
-	glBegin(GL_LINES);
-	glVertex3fv(vec[1]); glVertex3fv(vec[5]);
-	glVertex3fv(vec[2]); glVertex3fv(vec[6]);
-	glVertex3fv(vec[3]); glVertex3fv(vec[7]);
-	glEnd();
-}
-
 /* uses boundbox, function used by Ketsji */
 #if 0
 static void get_local_bounds(Object *ob, float center[3], float size[3])
@@ -28,6 +28,7 @@
  *  \ingroup spview3d
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
@@ -62,6 +63,7 @@
 #include "BKE_screen.h"
 #include "BKE_unit.h"
 #include "BKE_movieclip.h"
+#include "BKE_update_timing.h"
 
 #include "RE_engine.h"
 #include "RE_pipeline.h"  /* make_stars */
@@ -91,6 +93,7 @@
 #include "UI_resources.h"
 
 #include "GPU_draw.h"
+#include "GPU_draw_timing.h"
 #include "GPU_material.h"
 #include "GPU_extensions.h"
 
@@ -1979,17 +1982,49 @@ static void view3d_draw_xraytransp(Scene *scene, ARegion *ar, View3D *v3d, int c
  * we need to force the color
  */
 
-#if 0
-int dupli_ob_sort(void *arg1, void *arg2)
+typedef struct DupliSortItem {
+	DupliObject *dob;
+	int index;
+} DupliSortItem;
+
+static int dupli_ob_sort(const void *arg1, const void *arg2)
 {
-	void *p1 = ((DupliObject *)arg1)->ob;
-	void *p2 = ((DupliObject *)arg2)->ob;
-	int val = 0;
-	if (p1 < p2) val = -1;
-	else if (p1 > p2) val = 1;
-	return val;
+	const DupliSortItem *item1 = arg1, *item2 = arg2;
+	const void *p1 = item1->dob->ob;
+	const void *p2 = item2->dob->ob;
+
+	if (p1 < p2) return -1;
+	else if (p1 > p2) return 1;
+	/* keep the original order for the same object, free_object_duplilist
+	 * restores from the first instance */
+	return (item1->index > item2->index) - (item1->index < item2->index);
+}
+
+/* group the dupli list by object, so all instances of an object are drawn
+ * from one display list, particle and group duplis are often interleaved */
+static void dupli_list_sort(ListBase *lb)
+{
+	DupliSortItem *items;
+	DupliObject *dob;
+	int i, tot = BLI_countlist(lb);
+
+	if (tot < 3)
+		return;
+
+	items = MEM_mallocN(sizeof(*items) * tot, __func__);
+	for (dob = lb->first, i = 0; dob; dob = dob->next, i++) {
+		items[i].dob = dob;
+		items[i].index = i;
+	}
+
+	qsort(items, tot, sizeof(*items), dupli_ob_sort);
+
+	lb->first = lb->last = NULL;
+	for (i = 0; i < tot; i++)
+		BLI_addtail(lb, items[i].dob);
+
+	MEM_freeN(items);
 }
-#endif
 
 
 static DupliObject *dupli_step(DupliObject *dob)
@@ -2015,7 +2050,7 @@ static void draw_dupli_objects_color(Scene *scene, ARegion *ar, View3D *v3d, Bas
 	
 	tbase.flag = OB_FROMDUPLI | base->flag;
 	lb = object_duplilist(scene, base->object, false);
-	// BLI_sortlist(lb, dupli_ob_sort); /* might be nice to have if we have a dupli list with mixed objects. */
+	dupli_list_sort(lb);
 
 	dob = dupli_step(lb->first);
 	if (dob) dob_next = dupli_step(dob->next);
@@ -2301,7 +2336,8 @@ void draw_depth(Scene *scene, ARegion *ar, View3D *v3d, int (*func)(void *), boo
 		for (SETLOOPER(scene->set, sce_iter, base)) {
 			if (v3d->lay & base->lay) {
 				if (func == NULL || func(base)) {
-					draw_object(scene, ar, v3d, base, 0);
+					if (view3d_object_boundbox_clip(scene, v3d, rv3d, base->object, base->object->obmat))
+						draw_object(scene, ar, v3d, base, 0);
 					if (base->object->transflag & OB_DUPLI) {
 						draw_dupli_objects_color(scene, ar, v3d, base, TH_WIRE);
 					}
@@ -2317,7 +2353,8 @@ void draw_depth(Scene *scene, ARegion *ar, View3D *v3d, int (*func)(void *), boo
 				if (base->object->transflag & OB_DUPLI) {
 					draw_dupli_objects(scene, ar, v3d, base);
 				}
-				draw_object(scene, ar, v3d, base, 0);
+				if (view3d_object_boundbox_clip(scene, v3d, rv3d, base->object, base->object->obmat))
+					draw_object(scene, ar, v3d, base, 0);
 			}
 		}
 	}
@@ -3234,6 +3271,8 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 	Base *base;
 	unsigned int lay_used;
 
+	GPU_draw_timing_phase(GPU_DRAW_TIMING_SETUP);
+
 	/* shadow buffers, before we setup matrices */
 	if (draw_glsl_material(scene, NULL, v3d, v3d->drawtype))
 		gpu_update_lamps_shadows(scene, v3d);
@@ -3302,6 +3341,8 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 	if (rv3d->rflag & RV3D_CLIPPING)
 		ED_view3d_clipping_set(rv3d);
 
+	GPU_draw_timing_phase(GPU_DRAW_TIMING_OBJECTS);
+
 	/* draw set first */
 	if (scene->set) {
 		Scene *sce_iter;
@@ -3309,8 +3350,10 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 			
 			if (v3d->lay & base->lay) {
 				
-				UI_ThemeColorBlend(TH_WIRE, TH_BACK, 0.6f);
-				draw_object(scene, ar, v3d, base, DRAW_CONSTCOLOR | DRAW_SCENESET);
+				if (view3d_object_boundbox_clip(scene, v3d, rv3d, base->object, base->object->obmat)) {
+					UI_ThemeColorBlend(TH_WIRE, TH_BACK, 0.6f);
+					draw_object(scene, ar, v3d, base, DRAW_CONSTCOLOR | DRAW_SCENESET);
+				}
 				
 				if (base->object->transflag & OB_DUPLI) {
 					draw_dupli_objects_color(scene, ar, v3d, base, TH_WIRE);
@@ -3334,8 +3377,11 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 				draw_dupli_objects(scene, ar, v3d, base);
 			}
 			if ((base->flag & SELECT) == 0) {
-				if (base->object != scene->obedit)
+				if (base->object != scene->obedit &&
+				    view3d_object_boundbox_clip(scene, v3d, rv3d, base->object, base->object->obmat))
+				{
 					draw_object(scene, ar, v3d, base, 0);
+				}
 			}
 		}
 	}
@@ -3351,8 +3397,10 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 	/* draw selected and editmode */
 	for (base = scene->base.first; base; base = base->next) {
 		if (v3d->lay & base->lay) {
-			if (base->object == scene->obedit || (base->flag & SELECT) )
-				draw_object(scene, ar, v3d, base, 0);
+			if (base->object == scene->obedit || (base->flag & SELECT)) {
+				if (view3d_object_boundbox_clip(scene, v3d, rv3d, base->object, base->object->obmat))
+					draw_object(scene, ar, v3d, base, 0);
+			}
 		}
 	}
 
@@ -3365,11 +3413,15 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 		if (v3d->zbuf) glEnable(GL_DEPTH_TEST);
 	}
 
+	GPU_draw_timing_phase(GPU_DRAW_TIMING_AFTERDRAW);
+
 	/* Transp and X-ray afterdraw stuff */
 	if (v3d->afterdraw_transp.first) view3d_draw_transp(scene, ar, v3d);
 	if (v3d->afterdraw_xray.first) view3d_draw_xray(scene, ar, v3d, 1);  /* clears zbuffer if it is used! */
 	if (v3d->afterdraw_xraytransp.first) view3d_draw_xraytransp(scene, ar, v3d, 1);
 	
+	GPU_draw_timing_phase(GPU_DRAW_TIMING_EXTRAS);
+
 	ED_region_draw_cb_draw(C, ar, REGION_DRAW_POST_VIEW);
 
 	if (rv3d->rflag & RV3D_CLIPPING)
@@ -3401,6 +3453,47 @@ static void view3d_main_area_draw_objects(const bContext *C, ARegion *ar, const
 
 }
 
+/* times of the previous draw of this region, top right */
+static void draw_viewport_timing(ARegion *ar, rcti *rect)
+{
+	double cpu[GPU_DRAW_TIMING_TOT], gpu[GPU_DRAW_TIMING_TOT];
+	double cpu_total = 0.0, gpu_total = 0.0;
+	const int xco = rect->xmax - 12 * U.widget_unit;
+	int yco = rect->ymax - U.widget_unit;
+	char info[64];
+	int i;
+
+	if (!GPU_draw_timing_get(ar, cpu, gpu))
+		return;
+
+	UI_ThemeColor(TH_TEXT_HI);
+
+	if (G.debug & G_DEBUG_UPDATE_TIMING) {
+		BLI_snprintf(info, sizeof(info), "%-10s %7.2f ms", "UPDATE", BKE_update_timing_total() * 1000.0);
+		BLF_draw_default_ascii(xco, yco, 0.0f, info, sizeof(info));
+		yco -= U.widget_unit;
+	}
+
+	for (i = 0; i < GPU_DRAW_TIMING_TOT; i++) {
+		cpu_total += cpu[i];
+		gpu_total += gpu[i];
+
+		if (gpu[i] < 0.0)
+			BLI_snprintf(info, sizeof(info), "%-10s %7.2f ms", GPU_draw_timing_phase_name(i), cpu[i] * 1000.0);
+		else
+			BLI_snprintf(info, sizeof(info), "%-10s %7.2f ms  GPU %7.2f ms", GPU_draw_timing_phase_name(i),
+			             cpu[i] * 1000.0, gpu[i] * 1000.0);
+		BLF_draw_default_ascii(xco, yco, 0.0f, info, sizeof(info));
+		yco -= U.widget_unit;
+	}
+
+	if (gpu_total < 0.0)
+		BLI_snprintf(info, sizeof(info), "%-10s %7.2f ms", "TOTAL", cpu_total * 1000.0);
+	else
+		BLI_snprintf(info, sizeof(info), "%-10s %7.2f ms  GPU %7.2f ms", "TOTAL", cpu_total * 1000.0, gpu_total * 1000.0);
+	BLF_draw_default_ascii(xco, yco, 0.0f, info, sizeof(info));
+}
+
 static void view3d_main_area_draw_info(const bContext *C, ARegion *ar, const char *grid_unit, bool render_border)
 {
 	wmWindowManager *wm = CTX_wm_manager(C);
@@ -3447,6 +3540,9 @@ static void view3d_main_area_draw_info(const bContext *C, ARegion *ar, const cha
 			draw_selected_name(scene, ob, &rect);
 	}
 
+	if (GPU_draw_timing_enabled())
+		draw_viewport_timing(ar, &rect);
+
 	if (rv3d->render_engine) {
 		view3d_main_area_draw_engine_info(v3d, rv3d, ar, render_border);
 		return;
@@ -3488,6 +3584,8 @@ void view3d_main_area_draw(const bContext *C, ARegion *ar)
 	render_border = ED_view3d_calc_render_border(scene, v3d, ar, &border_rect);
 	clip_border = (render_border && !BLI_rcti_compare(&ar->drawrct, &border_rect));
 
+	GPU_draw_timing_begin(ar);
+
 	/* draw viewport using opengl */
 	if (v3d->drawtype != OB_RENDER || !view3d_main_area_do_render_draw(scene) || clip_border) {
 		view3d_main_area_draw_objects(C, ar, &grid_unit);
@@ -3498,11 +3596,16 @@ void view3d_main_area_draw(const bContext *C, ARegion *ar)
 	}
 
 	/* draw viewport using external renderer */
-	if (v3d->drawtype == OB_RENDER)
+	if (v3d->drawtype == OB_RENDER) {
+		GPU_draw_timing_phase(GPU_DRAW_TIMING_ENGINE);
 		view3d_main_area_draw_engine(C, ar, clip_border, &border_rect);
+	}
 	
+	GPU_draw_timing_phase(GPU_DRAW_TIMING_INFO);
 	view3d_main_area_draw_info(C, ar, grid_unit, render_border);
 
+	GPU_draw_timing_end();
+
 	v3d->flag |= V3D_INVALID_BACKBUF;
 }
 
@@ -186,6 +186,7 @@ void VIEW3D_OT_game_start(struct wmOperatorType *ot);
 
 
 bool ED_view3d_boundbox_clip(RegionView3D *rv3d, float obmat[4][4], const struct BoundBox *bb);
+bool view3d_object_boundbox_clip(Scene *scene, View3D *v3d, RegionView3D *rv3d, struct Object *ob, float obmat[4][4]);
 
 void ED_view3d_smooth_view(struct bContext *C, struct View3D *v3d, struct ARegion *ar, struct Object *, struct Object *,
                            float *ofs, float *quat, float *dist, float *lens,
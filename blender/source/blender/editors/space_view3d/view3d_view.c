@@ -32,6 +32,7 @@
 #include "DNA_camera_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_object_types.h"
+#include "DNA_object_force.h"
 #include "DNA_lamp_types.h"
 
 #include "MEM_guardedalloc.h"
@@ -50,6 +51,7 @@
 #include "BKE_object.h"
 #include "BKE_global.h"
 #include "BKE_main.h"
+#include "BKE_modifier.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -874,6 +876,47 @@ void setviewmatrixview3d(Scene *scene, View3D *v3d, RegionView3D *rv3d)
 	}
 }
 
+/* Test if an object has to be drawn, only geometry that draws nothing
+ * outside its bounds and origin can be skipped when those are outside the
+ * view, anything else is always drawn. Used for drawing and picking. */
+bool view3d_object_boundbox_clip(Scene *scene, View3D *v3d, RegionView3D *rv3d, Object *ob, float obmat[4][4])
+{
+	BoundBox bb;
+	float min[3], max[3];
+	int a;
+
+	if (!ELEM5(ob->type, OB_MESH, OB_CURVE, OB_SURF, OB_FONT, OB_MBALL))
+		return true;
+	if (ob == scene->obedit || ob->bb == NULL || (ob->bb->flag & BOUNDBOX_DIRTY))
+		return true;
+	if (ob->particlesystem.first || (ob->pd && ob->pd->forcefield) || ob->mpath)
+		return true;
+	if (ob->dtx & (OB_AXIS | OB_TEXSPACE | OB_DRAWNAME))
+		return true;
+	if (((ob->dtx & OB_DRAWBOUNDOX) && ob->boundtype != OB_BOUND_BOX) || (ob->gameflag & OB_BOUNDS))
+		return true;
+
+	/* relationship lines */
+	if ((v3d->flag & V3D_HIDE_HELPLINES) == 0) {
+		if (ob->parent || ob->constraints.first || ob->rigidbody_constraint ||
+		    modifiers_findByType(ob, eModifierType_Hook))
+		{
+			return true;
+		}
+	}
+
+	/* the origin is drawn as well */
+	zero_v3(min);
+	zero_v3(max);
+	for (a = 0; a < 8; a++)
+		minmax_v3v3_v3(min, max, ob->bb->vec[a]);
+
+	BKE_boundbox_init_from_minmax(&bb, min, max);
+	bb.flag = 0;
+
+	return ED_view3d_boundbox_clip(rv3d, obmat, &bb);
+}
+
 /**
  * \warning be sure to account for a negative return value
  * This is an error, "Too many objects in select buffer"
@@ -946,7 +989,8 @@ short view3d_opengl_select(ViewContext *vc, unsigned int *buffer, unsigned int b
 				else {
 					base->selcol = code;
 					glLoadName(code);
-					draw_object(scene, ar, v3d, base, DRAW_PICKING | DRAW_CONSTCOLOR);
+					if (view3d_object_boundbox_clip(scene, v3d, vc->rv3d, base->object, base->object->obmat))
+						draw_object(scene, ar, v3d, base, DRAW_PICKING | DRAW_CONSTCOLOR);
 					
 					/* we draw duplicators for selection too */
 					if ((base->object->transflag & OB_DUPLI)) {
@@ -959,6 +1003,10 @@ short view3d_opengl_select(ViewContext *vc, unsigned int *buffer, unsigned int b
 						
 						for (dob = lb->first; dob; dob = dob->next) {
 							tbase.object = dob->ob;
+
+							if (!view3d_object_boundbox_clip(scene, v3d, vc->rv3d, dob->ob, dob->mat))
+								continue;
+
 							copy_m4_m4(dob->ob->obmat, dob->mat);
 							
 							/* extra service: draw the duplicator in drawtype of parent */
@@ -59,6 +59,7 @@
 
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
+#include "BLI_kdtree.h"
 #include "BLI_smallhash.h"
 #include "BLI_listbase.h"
 #include "BLI_linklist_stack.h"
@@ -214,6 +215,80 @@ static void sort_trans_data(TransInfo *t)
 
 /* distance calculated from not-selected vertex to nearest selected vertex
  * warning; this is loops inside loop, has minor N^2 issues, but by sorting list it is OK */
+/* Position of a TransData in the space distances are measured in. */
+static void prop_dist_co(float r_co[3], const TransData *td, const float *proj_vec)
+{
+	mul_v3_m3v3(r_co, td->mtx, td->center);
+
+	if (proj_vec) {
+		float vec_p[3];
+		project_v3_v3v3(vec_p, r_co, proj_vec);
+		sub_v3_v3(r_co, vec_p);
+	}
+}
+
+/* Nearest selected element of all unselected ones, using a kd-tree.
+ * Only valid when all elements share one matrix, true for edit-mode data,
+ * distances are then the same as measured in set_prop_dist. */
+static bool set_prop_dist_kdtree(TransInfo *t, const float *proj_vec)
+{
+	TransData *td;
+	KDTree *tree;
+	KDTreeNearest *nearest;
+	float (*co)[3];
+	int *found;
+	int a, totsel, totunsel;
+
+	for (a = 1, td = t->data + 1; a < t->total; a++, td++) {
+		if (memcmp(td->mtx, t->data->mtx, sizeof(td->mtx)) != 0)
+			return false;
+	}
+
+	/* by definition transdata has selected items in beginning */
+	for (totsel = 0, td = t->data; totsel < t->total && (td->flag & TD_SELECTED); totsel++, td++) {
+		/* pass */
+	}
+
+	totunsel = t->total - totsel;
+	if (totsel == 0 || totunsel == 0)
+		return false;
+
+	tree = BLI_kdtree_new(totsel);
+	for (a = 0, td = t->data; a < totsel; a++, td++) {
+		float sel_co[3];
+		prop_dist_co(sel_co, td, proj_vec);
+		BLI_kdtree_insert(tree, a, sel_co, NULL);
+	}
+	BLI_kdtree_balance(tree);
+
+	co = MEM_mallocN(sizeof(*co) * totunsel, __func__);
+	nearest = MEM_mallocN(sizeof(*nearest) * totunsel, __func__);
+	found = MEM_mallocN(sizeof(*found) * totunsel, __func__);
+
+	for (a = 0, td = t->data + totsel; a < totunsel; a++, td++) {
+		prop_dist_co(co[a], td, proj_vec);
+	}
+
+	BLI_kdtree_find_nearest_n_array(tree, (const float (*)[3])co, totunsel, nearest, found, 1);
+
+	for (a = 0, td = t->data; a < totsel; a++, td++) {
+		td->rdist = 0.0f;
+	}
+	for (a = 0; a < totunsel; a++, td++) {
+		if (td->flag & TD_SELECTED)
+			td->rdist = 0.0f;
+		else
+			td->rdist = found[a] ? nearest[a].dist : -1.0f;
+	}
+
+	MEM_freeN(co);
+	MEM_freeN(nearest);
+	MEM_freeN(found);
+	BLI_kdtree_free(tree);
+
+	return true;
+}
+
 static void set_prop_dist(TransInfo *t, const bool with_dist)
 {
 	TransData *tob;
@@ -230,6 +305,17 @@ static void set_prop_dist(TransInfo *t, const bool with_dist)
 		}
 	}
 
+	if (set_prop_dist_kdtree(t, proj_vec)) {
+		if (with_dist) {
+			for (a = 0, tob = t->data; a < t->total; a++, tob++) {
+				if ((tob->flag & TD_SELECTED) == 0) {
+					tob->dist = tob->rdist;
+				}
+			}
+		}
+		return;
+	}
+
 	for (a = 0, tob = t->data; a < t->total; a++, tob++) {
 
 		tob->rdist = 0.0f; // init, it was mallocced
@@ -690,6 +690,36 @@ static void recalcData_spaceclip(TransInfo *t)
 }
 
 /* helper for recalcData() - for 3d-view transforms */
+/* normals and tessellation of the edit-mesh, only around the transformed vertices when possible */
+static void recalcData_editmesh_update(TransInfo *t, BMEditMesh *em)
+{
+	BMVert **verts;
+	TransData *td;
+	int verts_len = 0;
+	int i;
+
+	/* mirror editing moves vertices that have no TransData */
+	if (((t->options & CTX_NO_MIRROR) == 0 && (t->flag & T_MIRROR)) ||
+	    (t->total > em->bm->totvert / 8))
+	{
+		EDBM_mesh_normals_update(em);
+		BKE_editmesh_tessface_calc(em);
+		return;
+	}
+
+	verts = MEM_mallocN(sizeof(*verts) * (size_t)t->total, __func__);
+	for (i = 0, td = t->data; i < t->total; i++, td++) {
+		if (td->loc && !(td->flag & TD_SKIP)) {
+			/* TransData.loc points to BMVert.co, see VertsToTransData */
+			verts[verts_len++] = (BMVert *)((char *)td->loc - offsetof(BMVert, co));
+		}
+	}
+
+	BKE_editmesh_update_verts_moved(em, verts, verts_len);
+
+	MEM_freeN(verts);
+}
+
 static void recalcData_view3d(TransInfo *t)
 {
 	Base *base = t->scene->basact;
@@ -746,8 +776,7 @@ static void recalcData_view3d(TransInfo *t)
 				
 			DAG_id_tag_update(t->obedit->data, 0);  /* sets recalc flags */
 			
-			EDBM_mesh_normals_update(em);
-			BKE_editmesh_tessface_calc(em);
+			recalcData_editmesh_update(t, em);
 		}
 		else if (t->obedit->type == OB_ARMATURE) { /* no recalc flag, does pose */
 			bArmature *arm = t->obedit->data;
@@ -4545,15 +4545,11 @@ void param_pack(ParamHandle *handle, float margin, bool do_rotate)
 		
 		box = boxarray + (i - unpacked);
 		
-		p_chart_uv_bbox(chart, trans, chart->u.pack.size);
+		/* chart->u.pack.size holds the bounds max, trans the bounds min */
+		p_chart_uv_bbox(chart, chart->u.pack.trans, chart->u.pack.size);
 		
-		trans[0] = -trans[0];
-		trans[1] = -trans[1];
-		
-		p_chart_uv_translate(chart, trans);
-		
-		box->w =  chart->u.pack.size[0] + trans[0];
-		box->h =  chart->u.pack.size[1] + trans[1];
+		box->w = chart->u.pack.size[0] - chart->u.pack.trans[0];
+		box->h = chart->u.pack.size[1] - chart->u.pack.trans[1];
 		box->index = i; /* warning this index skips PCHART_NOPACK boxes */
 		
 		if (margin > 0.0f)
@@ -4565,22 +4561,29 @@ void param_pack(ParamHandle *handle, float margin, bool do_rotate)
 		 * ...Without using the area running pack multiple times also gives a bad feedback loop.
 		 * multiply by 0.1 so the margin value from the UI can be from 0.0 to 1.0 but not give a massive margin */
 		margin = (margin * (float)area) * 0.1f;
-		unpacked = 0;
-		for (i = 0; i < phandle->ncharts; i++) {
-			chart = phandle->charts[i];
-			
-			if (chart->flag & PCHART_NOPACK) {
-				unpacked++;
-				continue;
-			}
-			
-			box = boxarray + (i - unpacked);
-			trans[0] = margin;
-			trans[1] = margin;
-			p_chart_uv_translate(chart, trans);
-			box->w += margin * 2;
-			box->h += margin * 2;
+	}
+	else {
+		margin = 0.0f;
+	}
+	
+	/* move every chart to the origin (plus margin) in a single pass over its UV's */
+	unpacked = 0;
+	for (i = 0; i < phandle->ncharts; i++) {
+		chart = phandle->charts[i];
+		
+		if (chart->flag & PCHART_NOPACK) {
+			unpacked++;
+			continue;
 		}
+		
+		box = boxarray + (i - unpacked);
+		
+		box->w += margin * 2;
+		box->h += margin * 2;
+		
+		trans[0] = margin - chart->u.pack.trans[0];
+		trans[1] = margin - chart->u.pack.trans[1];
+		p_chart_uv_translate(chart, trans);
 	}
 	
 	BLI_box_pack_2d(boxarray, phandle->ncharts - unpacked, &tot_width, &tot_height);
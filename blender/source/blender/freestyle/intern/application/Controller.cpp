@@ -104,6 +104,11 @@ Controller::Controller()
 	_bboxDiag = 0;
 
 	_ViewMap = 0;
+	_meshKey = 0;
+	_viewMapMeshKey = 0;
+	_viewMapSettingsKey = 0;
+	_pendingRender = NULL;
+	_pendingRenderLayer = NULL;
 
 	_Canvas = 0;
 
@@ -209,6 +214,29 @@ void Controller::setContext(bContext *C)
 }
 
 int Controller::LoadMesh(Render *re, SceneRenderLayer *srl)
+{
+	BlenderFileLoader fingerprinter(re, srl);
+
+	_meshKey = fingerprinter.Fingerprint();
+	if (_ViewMap && _meshKey == _viewMapMeshKey) {
+		// Same mesh data as the kept view map was built from: the import is only needed
+		// if ComputeViewMap() finds that the view map settings changed.
+		if (G.debug & G_DEBUG_FREESTYLE) {
+			cout << "Scene unchanged since the last view map" << endl;
+		}
+		_pendingRender = re;
+		_pendingRenderLayer = srl;
+		_ListOfModels.push_back("Blender_models");
+		return 0;
+	}
+
+	DeleteViewMap();
+	_viewMapMeshKey = 0;
+
+	return ImportMesh(re, srl);
+}
+
+int Controller::ImportMesh(Render *re, SceneRenderLayer *srl)
 {
 	BlenderFileLoader loader(re, srl);
 
@@ -307,11 +335,14 @@ void Controller::CloseFile()
 {
 	WShape::setCurrentId(0);
 	_ListOfModels.clear();
+	_pendingRender = NULL;
+	_pendingRenderLayer = NULL;
 
-	// We deallocate the memory:
+	// We deallocate the memory (a complete view map is kept for the next render):
 	ClearRootNode();
 	DeleteWingedEdge();
-	DeleteViewMap();
+	if (!_viewMapMeshKey)
+		DeleteViewMap();
 
 	// clears the canvas
 	_Canvas->Clear();
@@ -387,11 +418,52 @@ void Controller::DeleteViewMap()
 	}
 }
 
+unsigned int Controller::ViewMapSettingsKey()
+{
+	unsigned int hash = 2166136261u;
+	bool flags[5] = {_EnableQI, _EnableFaceSmoothness, _ComputeRidges, _ComputeSuggestive, _ComputeMaterialBoundaries};
+	real params[6] = {_creaseAngle, _sphereRadius, _suggestiveContourKrDerivativeEpsilon, _EPSILON,
+	                  _pView->GetAspect(), _pView->GetFovyRadian()};
+
+	hash = BlenderFileLoader::hashData(hash, flags, sizeof(flags));
+	hash = BlenderFileLoader::hashData(hash, params, sizeof(params));
+	hash = BlenderFileLoader::hashData(hash, &_VisibilityAlgo, sizeof(_VisibilityAlgo));
+	hash = BlenderFileLoader::hashData(hash, freestyle_viewpoint, sizeof(freestyle_viewpoint));
+	hash = BlenderFileLoader::hashData(hash, freestyle_mv, sizeof(freestyle_mv));
+	hash = BlenderFileLoader::hashData(hash, freestyle_proj, sizeof(freestyle_proj));
+	hash = BlenderFileLoader::hashData(hash, freestyle_viewport, sizeof(freestyle_viewport));
+	return hash;
+}
+
 void Controller::ComputeViewMap()
 {
 	if (!_ListOfModels.size())
 		return;
 
+	unsigned int settingsKey = ViewMapSettingsKey();
+
+	if (_pendingRender) {
+		Render *re = _pendingRender;
+		SceneRenderLayer *srl = _pendingRenderLayer;
+		_pendingRender = NULL;
+		_pendingRenderLayer = NULL;
+
+		if (_ViewMap && settingsKey == _viewMapSettingsKey) {
+			if (G.debug & G_DEBUG_FREESTYLE) {
+				cout << "View map reused" << endl;
+			}
+			resetModified(true);
+			return;
+		}
+
+		DeleteViewMap();
+		_viewMapMeshKey = 0;
+		_ListOfModels.clear();
+		if (ImportMesh(re, srl))
+			return;
+	}
+	_viewMapMeshKey = 0;
+
 	if (NULL != _ViewMap) {
 		delete _ViewMap;
 		_ViewMap = NULL;
@@ -581,6 +653,12 @@ void Controller::ComputeViewMap()
 	// Reset Style modules modification flags
 	resetModified(true);
 
+	// Only a view map that was built to completion may be reused by the next render
+	if (!_pRenderMonitor->testBreak()) {
+		_viewMapMeshKey = _meshKey;
+		_viewMapSettingsKey = settingsKey;
+	}
+
 	DeleteWingedEdge();
 }
 
@@ -828,7 +906,8 @@ void Controller::DrawStrokes()
 		cout << "Stroke count  : " << _Canvas->stroke_count << endl;
 	}
 	resetModified();
-	DeleteViewMap();
+	if (!_viewMapMeshKey)
+		DeleteViewMap();
 }
 
 void Controller::ResetRenderCount()
@@ -154,6 +154,9 @@ public:
 	AppCanvas *_Canvas;
 
 private:
+	int ImportMesh(Render *re, SceneRenderLayer *srl);
+	unsigned int ViewMapSettingsKey();
+
 	// Main Window:
 	//AppMainWindow *_pMainWindow;
 
@@ -219,6 +222,14 @@ private:
 
 	int _render_count;
 
+	// View map reuse: a complete view map is kept by CloseFile() and reused by the next render as
+	// long as neither the imported mesh data nor the view map settings changed in between.
+	unsigned int _meshKey;
+	unsigned int _viewMapMeshKey; // 0 if _ViewMap cannot be reused
+	unsigned int _viewMapSettingsKey;
+	Render *_pendingRender; // mesh import deferred by LoadMesh()
+	SceneRenderLayer *_pendingRenderLayer;
+
 	//AppStyleWindow *_pStyleWindow;
 	//AppOptionsWindow *_pOptionsWindow;
 	//AppDensityCurvesWindow *_pDensityCurvesWindow;
@@ -107,6 +107,72 @@ NodeGroup *BlenderFileLoader::Load()
 	return _Scene;
 }
 
+unsigned int BlenderFileLoader::hashData(unsigned int hash, const void *data, size_t size)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= 16777619u; // FNV-1a prime
+	}
+	return hash;
+}
+
+unsigned int BlenderFileLoader::Fingerprint()
+{
+	unsigned int hash = 2166136261u; // FNV-1a offset basis
+	short ortho = (_re->r.mode & R_ORTHO) != 0;
+	short preview = (_re->r.scemode & R_VIEWPORT_PREVIEW) != 0;
+
+	// View frustum used for clipping
+	hash = hashData(hash, &_re->viewplane, sizeof(_re->viewplane));
+	hash = hashData(hash, &_re->clipsta, sizeof(_re->clipsta));
+	hash = hashData(hash, &_re->clipend, sizeof(_re->clipend));
+	hash = hashData(hash, &ortho, sizeof(ortho));
+	hash = hashData(hash, &preview, sizeof(preview));
+	hash = hashData(hash, &_srl->lay, sizeof(_srl->lay));
+	hash = hashData(hash, &_smooth, sizeof(_smooth));
+
+	// Everything insertShapeNode() reads from the render database
+	for (ObjectInstanceRen *obi = (ObjectInstanceRen *)_re->instancetable.first; obi; obi = obi->next) {
+		if (!(obi->lay & _srl->lay))
+			continue;
+		ObjectRen *obr = obi->obr;
+		hash = hashData(hash, &obi->ob, sizeof(obi->ob));
+		hash = hashData(hash, obi->ob->id.name, strlen(obi->ob->id.name));
+		hash = hashData(hash, &obr->totvlak, sizeof(obr->totvlak));
+		if (obi->flag & R_TRANSFORMED) {
+			hash = hashData(hash, obi->mat, sizeof(obi->mat));
+			hash = hashData(hash, obi->nmat, sizeof(obi->nmat));
+		}
+		VlakRen *vlr = NULL;
+		for (int a = 0; a < obr->totvlak; a++) {
+			if ((a & 255) == 0)
+				vlr = obr->vlaknodes[a>>8].vlak;
+			else
+				vlr++;
+			VertRen *verts[4] = {vlr->v1, vlr->v2, vlr->v3, vlr->v4};
+			for (int i = 0; i < 4 && verts[i]; i++) {
+				hash = hashData(hash, verts[i]->co, sizeof(verts[i]->co));
+				hash = hashData(hash, verts[i]->n, sizeof(verts[i]->n));
+			}
+			hash = hashData(hash, &vlr->flag, sizeof(vlr->flag));
+			hash = hashData(hash, &vlr->freestyle_face_mark, sizeof(vlr->freestyle_face_mark));
+			hash = hashData(hash, &vlr->freestyle_edge_mark, sizeof(vlr->freestyle_edge_mark));
+			Material *mat = vlr->mat;
+			if (mat) {
+				hash = hashData(hash, &mat->material_type, sizeof(mat->material_type));
+				hash = hashData(hash, &mat->r, 3 * sizeof(float));
+				hash = hashData(hash, &mat->specr, 3 * sizeof(float));
+				hash = hashData(hash, &mat->alpha, sizeof(mat->alpha));
+				hash = hashData(hash, &mat->spectra, sizeof(mat->spectra));
+				hash = hashData(hash, &mat->har, sizeof(mat->har));
+			}
+		}
+	}
+
+	return hash;
+}
+
 #define CLIPPED_BY_NEAR -1
 #define NOT_CLIPPED      0
 #define CLIPPED_BY_FAR   1
@@ -90,6 +90,13 @@ public:
 	/*! Gets the smallest edge size read */
 	inline real minEdgeSize() {return _minEdgeSize;}
 
+	/*! Returns a key identifying the mesh data Load() would import, so that results computed from an
+	 *  earlier import can be reused when nothing changed in between */
+	unsigned int Fingerprint();
+
+	/*! Folds size bytes of data into an FNV-1a hash */
+	static unsigned int hashData(unsigned int hash, const void *data, size_t size);
+
 	/*! Modifiers */
 	inline void setRenderMonitor(RenderMonitor *iRenderMonitor) {_pRenderMonitor = iRenderMonitor;}
 
@@ -299,9 +299,11 @@ static char module_docstring[] =
 "- :class:`StrokeAttribute`\n"
 "- :class:`StrokeShader`\n"
 "\n"
+"  - :class:`AlphaModifierShader`\n"
 "  - :class:`BackboneStretcherShader`\n"
 "  - :class:`BezierCurveShader`\n"
 "  - :class:`CalligraphicShader`\n"
+"  - :class:`ColorModifierShader`\n"
 "  - :class:`ColorNoiseShader`\n"
 "  - :class:`ColorVariationPatternShader`\n"
 "  - :class:`ConstantColorShader`\n"
@@ -316,6 +318,7 @@ static char module_docstring[] =
 "  - :class:`SpatialNoiseShader`\n"
 "  - :class:`StrokeTextureShader`\n"
 "  - :class:`TextureAssignerShader`\n"
+"  - :class:`ThicknessModifierShader`\n"
 "  - :class:`ThicknessNoiseShader`\n"
 "  - :class:`ThicknessVariationPatternShader`\n"
 "  - :class:`TipRemoverShader`\n"
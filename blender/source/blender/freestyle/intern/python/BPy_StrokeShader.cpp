@@ -27,9 +27,11 @@
 #include "BPy_Convert.h"
 #include "Interface1D/BPy_Stroke.h"
 
+#include "StrokeShader/BPy_AlphaModifierShader.h"
 #include "StrokeShader/BPy_BackboneStretcherShader.h"
 #include "StrokeShader/BPy_BezierCurveShader.h"
 #include "StrokeShader/BPy_CalligraphicShader.h"
+#include "StrokeShader/BPy_ColorModifierShader.h"
 #include "StrokeShader/BPy_ColorNoiseShader.h"
 #include "StrokeShader/BPy_ColorVariationPatternShader.h"
 #include "StrokeShader/BPy_ConstantColorShader.h"
@@ -46,6 +48,7 @@
 #include "StrokeShader/BPy_streamShader.h"
 #include "StrokeShader/BPy_StrokeTextureShader.h"
 #include "StrokeShader/BPy_TextureAssignerShader.h"
+#include "StrokeShader/BPy_ThicknessModifierShader.h"
 #include "StrokeShader/BPy_ThicknessNoiseShader.h"
 #include "StrokeShader/BPy_ThicknessVariationPatternShader.h"
 #include "StrokeShader/BPy_TipRemoverShader.h"
@@ -67,6 +70,11 @@ int StrokeShader_Init(PyObject *module)
 	Py_INCREF(&StrokeShader_Type);
 	PyModule_AddObject(module, "StrokeShader", (PyObject *)&StrokeShader_Type);
 
+	if (PyType_Ready(&AlphaModifierShader_Type) < 0)
+		return -1;
+	Py_INCREF(&AlphaModifierShader_Type);
+	PyModule_AddObject(module, "AlphaModifierShader", (PyObject *)&AlphaModifierShader_Type);
+
 	if (PyType_Ready(&BackboneStretcherShader_Type) < 0)
 		return -1;
 	Py_INCREF(&BackboneStretcherShader_Type);
@@ -82,6 +90,11 @@ int StrokeShader_Init(PyObject *module)
 	Py_INCREF(&CalligraphicShader_Type);
 	PyModule_AddObject(module, "CalligraphicShader", (PyObject *)&CalligraphicShader_Type);
 
+	if (PyType_Ready(&ColorModifierShader_Type) < 0)
+		return -1;
+	Py_INCREF(&ColorModifierShader_Type);
+	PyModule_AddObject(module, "ColorModifierShader", (PyObject *)&ColorModifierShader_Type);
+
 	if (PyType_Ready(&ColorNoiseShader_Type) < 0)
 		return -1;
 	Py_INCREF(&ColorNoiseShader_Type);
@@ -163,6 +176,11 @@ int StrokeShader_Init(PyObject *module)
 	Py_INCREF(&TextureAssignerShader_Type);
 	PyModule_AddObject(module, "TextureAssignerShader", (PyObject *)&TextureAssignerShader_Type);
 
+	if (PyType_Ready(&ThicknessModifierShader_Type) < 0)
+		return -1;
+	Py_INCREF(&ThicknessModifierShader_Type);
+	PyModule_AddObject(module, "ThicknessModifierShader", (PyObject *)&ThicknessModifierShader_Type);
+
 	if (PyType_Ready(&ThicknessNoiseShader_Type) < 0)
 		return -1;
 	Py_INCREF(&ThicknessNoiseShader_Type);
@@ -0,0 +1,131 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file source/blender/freestyle/intern/python/StrokeShader/BPy_ColorModifierShader.cpp
+ *  \ingroup freestyle
+ */
+
+#include "BPy_ColorModifierShader.h"
+
+#include "../../stroke/BasicStrokeShaders.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DNA_linestyle_types.h"
+
+#include "RNA_access.h"
+#include "bpy_rna.h" /* pyrna_struct_Type */
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+//------------------------INSTANCE METHODS ----------------------------------
+
+static char ColorModifierShader___doc__[] =
+"Class hierarchy: :class:`StrokeShader` > :class:`ColorModifierShader`\n"
+"\n"
+"[Color shader]\n"
+"\n"
+".. method:: __init__(modifier)\n"
+"\n"
+"   Builds a ColorModifierShader object.\n"
+"\n"
+"   :arg modifier: An Along Stroke or Distance from Camera color modifier\n"
+"      of a line style.\n"
+"   :type modifier: :class:`bpy.types.LineStyleColorModifier`\n"
+"\n"
+".. method:: shade(stroke)\n"
+"\n"
+"   Blends the color of the stroke vertices with the color ramp of the\n"
+"   modifier, as the parameter editor does.\n"
+"\n"
+"   :arg stroke: A Stroke object.\n"
+"   :type stroke: :class:`Stroke`\n";
+
+static int ColorModifierShader___init__(BPy_ColorModifierShader *self, PyObject *args, PyObject *kwds)
+{
+	static const char *kwlist[] = {"modifier", NULL};
+	BPy_StructRNA *py_srna;
+	LineStyleModifier *modifier;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", (char **)kwlist, &pyrna_struct_Type, &py_srna))
+		return -1;
+	if (!RNA_struct_is_a(py_srna->ptr.type, &RNA_LineStyleColorModifier)) {
+		PyErr_SetString(PyExc_TypeError, "argument 1 is not a LineStyleColorModifier object");
+		return -1;
+	}
+	modifier = (LineStyleModifier *)py_srna->ptr.data;
+	if (!StrokeShaders::ColorModifierShader::isSupported(modifier->type)) {
+		PyErr_SetString(PyExc_ValueError, "argument 1 is not an Along Stroke or Distance from Camera modifier");
+		return -1;
+	}
+	self->py_ss.ss = new StrokeShaders::ColorModifierShader(modifier);
+	return 0;
+}
+
+/*-----------------------BPy_ColorModifierShader type definition ------------------------------*/
+
+PyTypeObject ColorModifierShader_Type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"ColorModifierShader", /* tp_name */
+	sizeof(BPy_ColorModifierShader), /* tp_basicsize */
+	0,                              /* tp_itemsize */
+	0,                              /* tp_dealloc */
+	0,                              /* tp_print */
+	0,                              /* tp_getattr */
+	0,                              /* tp_setattr */
+	0,                              /* tp_reserved */
+	0,                              /* tp_repr */
+	0,                              /* tp_as_number */
+	0,                              /* tp_as_sequence */
+	0,                              /* tp_as_mapping */
+	0,                              /* tp_hash  */
+	0,                              /* tp_call */
+	0,                              /* tp_str */
+	0,                              /* tp_getattro */
+	0,                              /* tp_setattro */
+	0,                              /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+	ColorModifierShader___doc__,       /* tp_doc */
+	0,                              /* tp_traverse */
+	0,                              /* tp_clear */
+	0,                              /* tp_richcompare */
+	0,                              /* tp_weaklistoffset */
+	0,                              /* tp_iter */
+	0,                              /* tp_iternext */
+	0,                              /* tp_methods */
+	0,                              /* tp_members */
+	0,                              /* tp_getset */
+	&StrokeShader_Type,             /* tp_base */
+	0,                              /* tp_dict */
+	0,                              /* tp_descr_get */
+	0,                              /* tp_descr_set */
+	0,                              /* tp_dictoffset */
+	(initproc)ColorModifierShader___init__, /* tp_init */
+	0,                              /* tp_alloc */
+	0,                              /* tp_new */
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+}
+#endif
@@ -49,6 +49,13 @@
 extern "C" {
 #  include "IMB_imbuf.h"
 #  include "IMB_imbuf_types.h"
+
+#  include "DNA_color_types.h"
+#  include "DNA_linestyle_types.h"
+
+#  include "BKE_colortools.h" /* curvemapping_evaluateF() */
+#  include "BKE_material.h" /* ramp_blend() */
+#  include "BKE_texture.h" /* do_colorband() */
 }
 
 namespace Freestyle {
@@ -1130,6 +1137,273 @@ int fstreamShader::shade(Stroke& stroke) const
 	return 0;
 }
 
+/////////////////////////////////////////
+//
+//  LINE STYLE MODIFIERS
+//
+/////////////////////////////////////////
+
+// Yields, vertex after vertex, the [0, 1] parameter at which the Along Stroke and Distance
+// from Camera modifiers evaluate their ramp or curve (see parameter_editor.py).
+class ModifierParameter
+{
+public:
+	ModifierParameter(int type, float rangeMin, float rangeMax, const Stroke& stroke)
+	: _type(type), _rangeMin(rangeMin), _rangeMax(rangeMax), _length(stroke.getLength2D()), _distance(0.0),
+	  _first(true)
+	{
+	}
+
+	float next(const StrokeVertex& sv)
+	{
+		if (_type == LS_MODIFIER_ALONG_STROKE) {
+			Vec2r p(sv.x(), sv.y());
+			if (!_first)
+				_distance += (p - _prev).norm();
+			_prev = p;
+			_first = false;
+			return (_length > 0.0) ? min(_distance / _length, 1.0) : 0.0f;
+		}
+		// LS_MODIFIER_DISTANCE_FROM_CAMERA: 3D points are in the camera coordinate system
+		real distance = sv.getPoint3D().norm();
+		if (distance < _rangeMin)
+			return 0.0f;
+		if (distance > _rangeMax)
+			return 1.0f;
+		return (distance - _rangeMin) / (_rangeMax - _rangeMin);
+	}
+
+private:
+	int _type;
+	float _rangeMin, _rangeMax;
+	real _length, _distance;
+	Vec2r _prev;
+	bool _first;
+};
+
+static void initializeCurve(CurveMapping *curve)
+{
+	curvemapping_initialize(curve);
+	// disable extrapolation if enabled
+	if (curve->cm[0].flag & CUMA_EXTEND_EXTRAPOLATE) {
+		curve->cm[0].flag &= ~(CUMA_EXTEND_EXTRAPOLATE);
+		curvemapping_changed(curve, 0);
+	}
+}
+
+static float evaluateCurve(CurveMapping *curve, int flags, float t)
+{
+	if (!(flags & LS_MODIFIER_USE_CURVE))
+		return (flags & LS_MODIFIER_INVERT) ? 1.0f - t : t;
+	return curvemapping_evaluateF(curve, 0, t);
+}
+
+static float blendValue(int blend, float influence, float v1, float v2)
+{
+	float fac = influence;
+	float facm = 1.0f - fac;
+	float tmp;
+
+	switch (blend) {
+		case LS_VALUE_BLEND:
+			return facm * v1 + fac * v2;
+		case LS_VALUE_ADD:
+			return v1 + fac * v2;
+		case LS_VALUE_MULT:
+			return v1 * (facm + fac * v2);
+		case LS_VALUE_SUB:
+			return v1 - fac * v2;
+		case LS_VALUE_DIV:
+			return (v2 != 0.0f) ? facm * v1 + fac * v1 / v2 : v1;
+		case LS_VALUE_DIFF:
+			return facm * v1 + fac * fabs(v1 - v2);
+		case LS_VALUE_MIN:
+			tmp = fac * v2;
+			return (v1 > tmp) ? tmp : v1;
+		case LS_VALUE_MAX:
+			tmp = fac * v2;
+			return (v1 < tmp) ? tmp : v1;
+	}
+	return v1;
+}
+
+// Assigns the outer and inner thickness of a stroke vertex, swapping them on the edges whose
+// back side is visible (ThicknessModifierMixIn.set_thickness() in parameter_editor.py).
+static void setThickness(StrokeVertex& sv, float outer, float inner, bool perspective)
+{
+	FEdge *fe = (sv.A() && sv.B()) ? sv.A()->getFEdge(*sv.B()) : NULL;
+	Nature::EdgeNature nature = fe ? fe->getNature() : Nature::NO_FEATURE;
+
+	if (nature & Nature::BORDER) {
+		FEdgeSharp *fes = dynamic_cast<FEdgeSharp*>(fe);
+		real dir = 0.0;
+		if (fes) {
+			if (perspective) {
+				Vec3r point(sv.getPoint3D());
+				point.normalize();
+				dir = -(point * fes->normalB()); // direction towards the viewpoint
+			}
+			else {
+				dir = fes->normalB()[2];
+			}
+		}
+		if (dir < 0.0) // the back side is visible
+			swap(outer, inner);
+	}
+	else if (nature & Nature::SILHOUETTE) {
+		if (fe->isSmooth())
+			swap(outer, inner);
+	}
+	else {
+		outer = inner = (outer + inner) / 2;
+	}
+	sv.attribute().setThickness(outer, inner);
+}
+
+bool ColorModifierShader::isSupported(int type)
+{
+	return (type == LS_MODIFIER_ALONG_STROKE || type == LS_MODIFIER_DISTANCE_FROM_CAMERA);
+}
+
+ColorModifierShader::ColorModifierShader(LineStyleModifier *modifier) : StrokeShader()
+{
+	_modifier = modifier;
+}
+
+int ColorModifierShader::shade(Stroke& stroke) const
+{
+	ColorBand *ramp;
+	float rangeMin = 0.0f, rangeMax = 0.0f;
+
+	if (_modifier->type == LS_MODIFIER_ALONG_STROKE) {
+		ramp = ((LineStyleColorModifier_AlongStroke *)_modifier)->color_ramp;
+	}
+	else {
+		LineStyleColorModifier_DistanceFromCamera *m = (LineStyleColorModifier_DistanceFromCamera *)_modifier;
+		ramp = m->color_ramp;
+		rangeMin = m->range_min;
+		rangeMax = m->range_max;
+	}
+
+	ModifierParameter param(_modifier->type, rangeMin, rangeMax, stroke);
+	float a[3], b[4];
+	for (StrokeInternal::StrokeVertexIterator v = stroke.strokeVerticesBegin(), vend = stroke.strokeVerticesEnd();
+	     v != vend;
+	     ++v)
+	{
+		float t = param.next(*v);
+		if (!do_colorband(ramp, t, b))
+			continue;
+		copy_v3_v3(a, v->attribute().getColor());
+		ramp_blend(_modifier->blend, a, _modifier->influence, b);
+		v->attribute().setColor(a[0], a[1], a[2]);
+	}
+	return 0;
+}
+
+AlphaModifierShader::AlphaModifierShader(LineStyleModifier *modifier) : StrokeShader()
+{
+	_modifier = modifier;
+	initializeCurve(((LineStyleAlphaModifier_AlongStroke *)_modifier)->curve);
+}
+
+int AlphaModifierShader::shade(Stroke& stroke) const
+{
+	CurveMapping *curve;
+	int flags;
+	float rangeMin = 0.0f, rangeMax = 0.0f;
+
+	if (_modifier->type == LS_MODIFIER_ALONG_STROKE) {
+		LineStyleAlphaModifier_AlongStroke *m = (LineStyleAlphaModifier_AlongStroke *)_modifier;
+		curve = m->curve;
+		flags = m->flags;
+	}
+	else {
+		LineStyleAlphaModifier_DistanceFromCamera *m = (LineStyleAlphaModifier_DistanceFromCamera *)_modifier;
+		curve = m->curve;
+		flags = m->flags;
+		rangeMin = m->range_min;
+		rangeMax = m->range_max;
+	}
+
+	ModifierParameter param(_modifier->type, rangeMin, rangeMax, stroke);
+	for (StrokeInternal::StrokeVertexIterator v = stroke.strokeVerticesBegin(), vend = stroke.strokeVerticesEnd();
+	     v != vend;
+	     ++v)
+	{
+		float b = evaluateCurve(curve, flags, param.next(*v));
+		v->attribute().setAlpha(blendValue(_modifier->blend, _modifier->influence, v->attribute().getAlpha(), b));
+	}
+	return 0;
+}
+
+ThicknessModifierShader::ThicknessModifierShader(LineStyleModifier *modifier, int position, float ratio,
+                                                 bool perspective)
+: StrokeShader()
+{
+	_modifier = modifier;
+	_position = position;
+	_ratio = ratio;
+	_perspective = perspective;
+	initializeCurve(((LineStyleThicknessModifier_AlongStroke *)_modifier)->curve);
+}
+
+int ThicknessModifierShader::shade(Stroke& stroke) const
+{
+	CurveMapping *curve;
+	int flags;
+	float rangeMin = 0.0f, rangeMax = 0.0f, valueMin, valueMax;
+
+	if (_modifier->type == LS_MODIFIER_ALONG_STROKE) {
+		LineStyleThicknessModifier_AlongStroke *m = (LineStyleThicknessModifier_AlongStroke *)_modifier;
+		curve = m->curve;
+		flags = m->flags;
+		valueMin = m->value_min;
+		valueMax = m->value_max;
+	}
+	else {
+		LineStyleThicknessModifier_DistanceFromCamera *m =
+		        (LineStyleThicknessModifier_DistanceFromCamera *)_modifier;
+		curve = m->curve;
+		flags = m->flags;
+		rangeMin = m->range_min;
+		rangeMax = m->range_max;
+		valueMin = m->value_min;
+		valueMax = m->value_max;
+	}
+
+	ModifierParameter param(_modifier->type, rangeMin, rangeMax, stroke);
+	for (StrokeInternal::StrokeVertexIterator v = stroke.strokeVerticesBegin(), vend = stroke.strokeVerticesEnd();
+	     v != vend;
+	     ++v)
+	{
+		const float *a = v->attribute().getThickness();
+		float b = valueMin + evaluateCurve(curve, flags, param.next(*v)) * (valueMax - valueMin);
+		float value = blendValue(_modifier->blend, _modifier->influence, a[0] + a[1], b);
+		float outer, inner;
+		switch (_position) {
+			case LS_THICKNESS_INSIDE:
+				outer = 0.0f;
+				inner = value;
+				break;
+			case LS_THICKNESS_OUTSIDE:
+				outer = value;
+				inner = 0.0f;
+				break;
+			case LS_THICKNESS_RELATIVE:
+				outer = value * _ratio;
+				inner = value - outer;
+				break;
+			default: // LS_THICKNESS_CENTER
+				outer = value * 0.5f;
+				inner = value - outer;
+				break;
+		}
+		setThickness(*v, outer, inner, _perspective);
+	}
+	return 0;
+}
+
 } // end of namespace StrokeShaders
 
 } /* namespace Freestyle */
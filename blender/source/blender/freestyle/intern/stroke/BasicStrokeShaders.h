@@ -36,6 +36,10 @@
 #include "../geometry/Bezier.h"
 #include "../geometry/Geom.h"
 
+extern "C" {
+struct LineStyleModifier;
+}
+
 using namespace std;
 
 namespace Freestyle {
@@ -894,6 +898,98 @@ public:
 	virtual int shade(Stroke& stroke) const;
 };
 
+//
+//  Line style modifiers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/*! [ Color Shader ].
+ *  Native version of the parameter editor's Along Stroke and Distance from Camera color modifiers.
+ */
+class LIB_STROKE_EXPORT ColorModifierShader : public StrokeShader
+{
+public:
+	/*! Builds the shader.
+	 *  \param modifier
+	 *    The line style color modifier to apply. Its type must satisfy isSupported().
+	 */
+	ColorModifierShader(LineStyleModifier *modifier);
+
+	/*! Returns the string "ColorModifierShader".*/
+	virtual string getName() const
+	{
+		return "ColorModifierShader";
+	}
+
+	/*! The shading method. */
+	virtual int shade(Stroke& stroke) const;
+
+	/*! Returns true if modifiers of the given type can be applied by the modifier shaders */
+	static bool isSupported(int type);
+
+protected:
+	LineStyleModifier *_modifier;
+};
+
+/*! [ Color Shader ].
+ *  Native version of the parameter editor's Along Stroke and Distance from Camera alpha modifiers.
+ */
+class LIB_STROKE_EXPORT AlphaModifierShader : public StrokeShader
+{
+public:
+	/*! Builds the shader.
+	 *  \param modifier
+	 *    The line style alpha modifier to apply. Its type must satisfy ColorModifierShader::isSupported().
+	 */
+	AlphaModifierShader(LineStyleModifier *modifier);
+
+	/*! Returns the string "AlphaModifierShader".*/
+	virtual string getName() const
+	{
+		return "AlphaModifierShader";
+	}
+
+	/*! The shading method. */
+	virtual int shade(Stroke& stroke) const;
+
+protected:
+	LineStyleModifier *_modifier;
+};
+
+/*! [ Thickness Shader ].
+ *  Native version of the parameter editor's Along Stroke and Distance from Camera thickness modifiers.
+ */
+class LIB_STROKE_EXPORT ThicknessModifierShader : public StrokeShader
+{
+public:
+	/*! Builds the shader.
+	 *  \param modifier
+	 *    The line style thickness modifier to apply. Its type must satisfy ColorModifierShader::isSupported().
+	 *  \param position
+	 *    The thickness position (one of the LS_THICKNESS_* values).
+	 *  \param ratio
+	 *    The ratio of the outer thickness, used with LS_THICKNESS_RELATIVE.
+	 *  \param perspective
+	 *    True if the scene camera uses a perspective projection.
+	 */
+	ThicknessModifierShader(LineStyleModifier *modifier, int position, float ratio, bool perspective);
+
+	/*! Returns the string "ThicknessModifierShader".*/
+	virtual string getName() const
+	{
+		return "ThicknessModifierShader";
+	}
+
+	/*! The shading method. */
+	virtual int shade(Stroke& stroke) const;
+
+protected:
+	LineStyleModifier *_modifier;
+	int _position;
+	float _ratio;
+	bool _perspective;
+};
+
 } // end of namespace StrokeShaders
 
 } /* namespace Freestyle */
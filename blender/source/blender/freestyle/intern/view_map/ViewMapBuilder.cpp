@@ -46,6 +46,8 @@
 
 #include "BKE_global.h"
 
+#include "BLI_task.h"
+
 namespace Freestyle {
 
 // XXX Grmll... G is used as template's typename parameter :/
@@ -396,384 +398,261 @@ static int computeVisibility(ViewMap *viewMap, FEdge *fe, G& grid, real epsilon,
 	return qi;
 }
 
-// computeCumulativeVisibility returns the lowest x such that the majority of FEdges have QI <= x
-//
-// This was probably the original intention of the "normal" algorithm on which computeDetailedVisibility is based.
-// But because the "normal" algorithm chooses the most popular QI, without considering any other values, a ViewEdge
-// with FEdges having QIs of 0, 21, 22, 23, 24 and 25 will end up having a total QI of 0, even though most of the
-// FEdges are heavily occluded. computeCumulativeVisibility will treat this case as a QI of 22 because 3 out of
-// 6 occluders have QI <= 22.
-
+// Computes the QI, occluders and occludee of one ViewEdge. Only the ViewEdge and its own FEdges are written and
+// the grid is only read through a per call iterator, so ViewEdges can be processed concurrently.
+// cumulative selects the QI rule of computeCumulativeVisibility, otherwise the one of computeDetailedVisibility.
 template <typename G, typename I>
-static void computeCumulativeVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+static void computeViewEdgeVisibility(ViewMap *ioViewMap, ViewEdge *ve, G& grid, real epsilon, bool cumulative)
 {
-	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
-
 	FEdge *fe, *festart;
 	int nSamples = 0;
 	vector<WFace*> wFaces;
 	WFace *wFace = NULL;
-	unsigned cnt = 0;
-	unsigned cntStep = (unsigned)ceil(0.01f * vedges.size());
 	unsigned tmpQI = 0;
 	unsigned qiClasses[256];
 	unsigned maxIndex, maxCard;
 	unsigned qiMajority;
-	for (vector<ViewEdge*>::iterator ve = vedges.begin(), veend = vedges.end(); ve != veend; ve++) {
-		if (iRenderMonitor) {
-			if (iRenderMonitor->testBreak())
-				break;
-			if (cnt % cntStep == 0) {
-				stringstream ss;
-				ss << "Freestyle: Visibility computations " << (100 * cnt / vedges.size()) << "%";
-				iRenderMonitor->setInfo(ss.str());
-				iRenderMonitor->progress((float)cnt / vedges.size());
-			}
-			cnt++;
-		}
+
+#if LOGGING
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "Processing ViewEdge " << ve->getId() << endl;
+	}
+#endif
+	// Find an edge to test
+	if (!ve->isInImage()) {
+		// This view edge has been proscenium culled
+		ve->setQI(255);
+		ve->setaShape(0);
 #if LOGGING
 		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "Processing ViewEdge " << (*ve)->getId() << endl;
+			cout << "\tCulled." << endl;
 		}
 #endif
-		// Find an edge to test
-		if (!(*ve)->isInImage()) {
-			// This view edge has been proscenium culled
-			(*ve)->setQI(255);
-			(*ve)->setaShape(0);
+		return;
+	}
+
+	// Test edge
+	festart = ve->fedgeA();
+	fe = ve->fedgeA();
+	qiMajority = 0;
+	do {
+		if (fe != NULL && fe->isInImage()) {
+			qiMajority++;
+		}
+		fe = fe->nextEdge();
+	} while (fe && fe != festart);
+
+	if (qiMajority == 0) {
+		// There are no occludable FEdges on this ViewEdge
+		// This should be impossible.
+		if (_global.debug & G_DEBUG_FREESTYLE) {
+			cout << "View Edge in viewport without occludable FEdges: " << ve->getId() << endl;
+		}
+		// We can recover from this error:
+		// Treat this edge as fully visible with no occludee
+		ve->setQI(0);
+		ve->setaShape(0);
+		return;
+	}
+	else {
+		++qiMajority;
+		qiMajority >>= 1;
+	}
 #if LOGGING
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "\tCulled." << endl;
-			}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tqiMajority: " << qiMajority << endl;
+	}
 #endif
-			continue;
-		}
 
-		// Test edge
-		festart = (*ve)->fedgeA();
-		fe = (*ve)->fedgeA();
-		qiMajority = 0;
-		do {
-			if (fe != NULL && fe->isInImage()) {
-				qiMajority++;
-			}
-			fe = fe->nextEdge();
-		} while (fe && fe != festart);
+	tmpQI = 0;
+	maxIndex = 0;
+	maxCard = 0;
+	nSamples = 0;
+	memset(qiClasses, 0, 256 * sizeof(*qiClasses));
+	set<ViewShape*> foundOccluders;
 
-		if (qiMajority == 0) {
-			// There are no occludable FEdges on this ViewEdge
-			// This should be impossible.
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "View Edge in viewport without occludable FEdges: " << (*ve)->getId() << endl;
-			}
-			// We can recover from this error:
-			// Treat this edge as fully visible with no occludee
-			(*ve)->setQI(0);
-			(*ve)->setaShape(0);
+	fe = ve->fedgeA();
+	do {
+		if (!fe || !fe->isInImage()) {
+			fe = fe->nextEdge();
 			continue;
 		}
-		else {
-			++qiMajority;
-			qiMajority >>= 1;
-		}
+		if ((maxCard < qiMajority)) {
+			//ARB: change &wFace to wFace and use reference in called function
+			tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, ve, &wFace, &foundOccluders);
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tqiMajority: " << qiMajority << endl;
-		}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: visibility " << tmpQI << endl;
+			}
 #endif
 
-		tmpQI = 0;
-		maxIndex = 0;
-		maxCard = 0;
-		nSamples = 0;
-		memset(qiClasses, 0, 256 * sizeof(*qiClasses));
-		set<ViewShape*> foundOccluders;
+			//ARB: This is an error condition, not an alert condition.
+			// Some sort of recovery or abort is necessary.
+			if (tmpQI >= 256) {
+				cerr << "Warning: too many occluding levels" << endl;
+				//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
+				tmpQI = 255;
+			}
 
-		fe = (*ve)->fedgeA();
-		do {
-			if (!fe || !fe->isInImage()) {
-				fe = fe->nextEdge();
-				continue;
+			if (++qiClasses[tmpQI] > maxCard) {
+				maxCard = qiClasses[tmpQI];
+				maxIndex = tmpQI;
 			}
-			if ((maxCard < qiMajority)) {
-				//ARB: change &wFace to wFace and use reference in called function
-				tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, *ve, &wFace, &foundOccluders);
+		}
+		else {
+			//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
+			//ARB: change &wFace to wFace and use reference in called function
+			findOccludee<G, I>(fe, grid, epsilon, ve, &wFace);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: visibility " << tmpQI << endl;
-				}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
+			}
 #endif
+		}
 
-				//ARB: This is an error condition, not an alert condition.
-				// Some sort of recovery or abort is necessary.
-				if (tmpQI >= 256) {
-					cerr << "Warning: too many occluding levels" << endl;
-					//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
-					tmpQI = 255;
-				}
-
-				if (++qiClasses[tmpQI] > maxCard) {
-					maxCard = qiClasses[tmpQI];
-					maxIndex = tmpQI;
-				}
+		// Store test results
+		if (wFace) {
+			vector<Vec3r> vertices;
+			for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
+				vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
 			}
-			else {
-				//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
-				//ARB: change &wFace to wFace and use reference in called function
-				findOccludee<G, I>(fe, grid, epsilon, *ve, &wFace);
+			Polygon3r poly(vertices, wFace->GetNormal());
+			poly.userdata = (void *)wFace;
+			fe->setaFace(poly);
+			wFaces.push_back(wFace);
+			fe->setOccludeeEmpty(false);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
-				}
-#endif
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFound occludee" << endl;
 			}
-
-			// Store test results
-			if (wFace) {
-				vector<Vec3r> vertices;
-				for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
-					vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
-				}
-				Polygon3r poly(vertices, wFace->GetNormal());
-				poly.userdata = (void *)wFace;
-				fe->setaFace(poly);
-				wFaces.push_back(wFace);
-				fe->setOccludeeEmpty(false);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFound occludee" << endl;
-				}
 #endif
-			}
-			else {
-				fe->setOccludeeEmpty(true);
-			}
+		}
+		else {
+			fe->setOccludeeEmpty(true);
+		}
 
-			++nSamples;
-			fe = fe->nextEdge();
-		} while ((maxCard < qiMajority) && (fe) && (fe != festart));
+		++nSamples;
+		fe = fe->nextEdge();
+	} while ((maxCard < qiMajority) && (fe) && (fe != festart));
 
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
-		}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
+	}
 #endif
 
-		// ViewEdge
-		// qi --
+	// ViewEdge
+	// qi --
+	if (cumulative) {
 		// Find the minimum value that is >= the majority of the QI
 		for (unsigned count = 0, i = 0; i < 256; ++i) {
 			count += qiClasses[i];
 			if (count >= qiMajority) {
-				(*ve)->setQI(i);
+				ve->setQI(i);
 				break;
 			}
 		}
-		// occluders --
-		// I would rather not have to go through the effort of creating this set and then copying out its contents.
-		// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
-		for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
-			(*ve)->AddOccluder((*o));
-		}
-#if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tConclusion: QI = " << maxIndex << ", " << (*ve)->occluders_size() << " occluders." << endl;
-		}
-#else
-		(void)maxIndex;
-#endif
-		// occludee --
-		if (!wFaces.empty()) {
-			if (wFaces.size() <= (float)nSamples / 2.0f) {
-				(*ve)->setaShape(0);
-			}
-			else {
-				ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
-				(*ve)->setaShape(vshape);
-			}
-		}
-
-		wFaces.clear();
 	}
-	if (iRenderMonitor && vedges.size()) {
-		stringstream ss;
-		ss << "Freestyle: Visibility computations " << (100 * cnt / vedges.size()) << "%";
-		iRenderMonitor->setInfo(ss.str());
-		iRenderMonitor->progress((float)cnt / vedges.size());
+	else {
+		ve->setQI(maxIndex);
+	}
+	// occluders --
+	// I would rather not have to go through the effort of creating this set and then copying out its contents.
+	// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
+	for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
+		ve->AddOccluder((*o));
 	}
-}
-
-template <typename G, typename I>
-static void computeDetailedVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
-{
-	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
-
-	FEdge *fe, *festart;
-	int nSamples = 0;
-	vector<WFace*> wFaces;
-	WFace *wFace = NULL;
-	unsigned tmpQI = 0;
-	unsigned qiClasses[256];
-	unsigned maxIndex, maxCard;
-	unsigned qiMajority;
-	for (vector<ViewEdge*>::iterator ve = vedges.begin(), veend = vedges.end(); ve != veend; ve++) {
-		if (iRenderMonitor && iRenderMonitor->testBreak())
-			break;
-#if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "Processing ViewEdge " << (*ve)->getId() << endl;
-		}
-#endif
-		// Find an edge to test
-		if (!(*ve)->isInImage()) {
-			// This view edge has been proscenium culled
-			(*ve)->setQI(255);
-			(*ve)->setaShape(0);
 #if LOGGING
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "\tCulled." << endl;
-			}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tConclusion: QI = " << maxIndex << ", " << ve->occluders_size() << " occluders." << endl;
+	}
 #endif
-			continue;
-		}
-
-		// Test edge
-		festart = (*ve)->fedgeA();
-		fe = (*ve)->fedgeA();
-		qiMajority = 0;
-		do {
-			if (fe != NULL && fe->isInImage()) {
-				qiMajority++;
-			}
-			fe = fe->nextEdge();
-		} while (fe && fe != festart);
-
-		if (qiMajority == 0) {
-			// There are no occludable FEdges on this ViewEdge
-			// This should be impossible.
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "View Edge in viewport without occludable FEdges: " << (*ve)->getId() << endl;
-			}
-			// We can recover from this error:
-			// Treat this edge as fully visible with no occludee
-			(*ve)->setQI(0);
-			(*ve)->setaShape(0);
-			continue;
+	// occludee --
+	if (!wFaces.empty()) {
+		if (wFaces.size() <= (float)nSamples / 2.0f) {
+			ve->setaShape(0);
 		}
 		else {
-			++qiMajority;
-			qiMajority >>= 1;
+			ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
+			ve->setaShape(vshape);
 		}
-#if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tqiMajority: " << qiMajority << endl;
-		}
-#endif
-
-		tmpQI = 0;
-		maxIndex = 0;
-		maxCard = 0;
-		nSamples = 0;
-		memset(qiClasses, 0, 256 * sizeof(*qiClasses));
-		set<ViewShape*> foundOccluders;
-
-		fe = (*ve)->fedgeA();
-		do {
-			if (fe == NULL || ! fe->isInImage()) {
-				fe = fe->nextEdge();
-				continue;
-			}
-			if ((maxCard < qiMajority)) {
-				//ARB: change &wFace to wFace and use reference in called function
-				tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, *ve, &wFace, &foundOccluders);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: visibility " << tmpQI << endl;
-				}
-#endif
-
-				//ARB: This is an error condition, not an alert condition.
-				// Some sort of recovery or abort is necessary.
-				if (tmpQI >= 256) {
-					cerr << "Warning: too many occluding levels" << endl;
-					//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
-					tmpQI = 255;
-				}
+	}
+}
 
-				if (++qiClasses[tmpQI] > maxCard) {
-					maxCard = qiClasses[tmpQI];
-					maxIndex = tmpQI;
-				}
-			}
-			else {
-				//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
-				//ARB: change &wFace to wFace and use reference in called function
-				findOccludee<G, I>(fe, grid, epsilon, *ve, &wFace);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
-				}
-#endif
-			}
+template <typename G>
+struct ViewEdgeVisibilityData {
+	ViewMap *viewMap;
+	vector<ViewEdge*> *vedges;
+	G *grid;
+	real epsilon;
+	bool cumulative;
+};
 
-			// Store test results
-			if (wFace) {
-				vector<Vec3r> vertices;
-				for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
-					vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
-				}
-				Polygon3r poly(vertices, wFace->GetNormal());
-				poly.userdata = (void *)wFace;
-				fe->setaFace(poly);
-				wFaces.push_back(wFace);
-				fe->setOccludeeEmpty(false);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFound occludee" << endl;
-				}
-#endif
-			}
-			else {
-				fe->setOccludeeEmpty(true);
-			}
+template <typename G, typename I>
+static void computeViewEdgeVisibilityRange(void *userdata, int start, int stop)
+{
+	ViewEdgeVisibilityData<G> *data = (ViewEdgeVisibilityData<G> *)userdata;
 
-			++nSamples;
-			fe = fe->nextEdge();
-		} while ((maxCard < qiMajority) && (fe) && (fe != festart));
+	for (int i = start; i < stop; ++i)
+		computeViewEdgeVisibility<G, I>(data->viewMap, (*data->vedges)[i], *data->grid, data->epsilon, data->cumulative);
+}
 
-#if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
+// Runs computeViewEdgeVisibility over all ViewEdges on the task scheduler, in slices of 1% so the render
+// monitor can still report progress and cancel between slices.
+template <typename G, typename I>
+static void computeVisibilityParallel(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor,
+                                      bool cumulative)
+{
+	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
+	int size = (int)vedges.size();
+	int step = max(1, (int)ceil(0.01f * size));
+	int start;
+
+	ViewEdgeVisibilityData<G> data;
+	data.viewMap = ioViewMap;
+	data.vedges = &vedges;
+	data.grid = &grid;
+	data.epsilon = epsilon;
+	data.cumulative = cumulative;
+
+	for (start = 0; start < size; start += step) {
+		if (iRenderMonitor) {
+			if (iRenderMonitor->testBreak())
+				break;
+			stringstream ss;
+			ss << "Freestyle: Visibility computations " << (100 * start / size) << "%";
+			iRenderMonitor->setInfo(ss.str());
+			iRenderMonitor->progress((float)start / size);
 		}
-#endif
+		BLI_task_parallel_range_ex(start, min(start + step, size), &data, computeViewEdgeVisibilityRange<G, I>, 16);
+	}
+	if (iRenderMonitor && size) {
+		start = min(start, size);
+		stringstream ss;
+		ss << "Freestyle: Visibility computations " << (100 * start / size) << "%";
+		iRenderMonitor->setInfo(ss.str());
+		iRenderMonitor->progress((float)start / size);
+	}
+}
 
-		// ViewEdge
-		// qi --
-		(*ve)->setQI(maxIndex);
-		// occluders --
-		// I would rather not have to go through the effort of creating this this set and then copying out its contents.
-		// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
-		for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
-			(*ve)->AddOccluder((*o));
-		}
-#if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tConclusion: QI = " << maxIndex << ", " << (*ve)->occluders_size() << " occluders." << endl;
-		}
-#endif
-		// occludee --
-		if (!wFaces.empty()) {
-			if (wFaces.size() <= (float)nSamples / 2.0f) {
-				(*ve)->setaShape(0);
-			}
-			else {
-				ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
-				(*ve)->setaShape(vshape);
-			}
-		}
+// computeCumulativeVisibility returns the lowest x such that the majority of FEdges have QI <= x
+//
+// This was probably the original intention of the "normal" algorithm on which computeDetailedVisibility is based.
+// But because the "normal" algorithm chooses the most popular QI, without considering any other values, a ViewEdge
+// with FEdges having QIs of 0, 21, 22, 23, 24 and 25 will end up having a total QI of 0, even though most of the
+// FEdges are heavily occluded. computeCumulativeVisibility will treat this case as a QI of 22 because 3 out of
+// 6 occluders have QI <= 22.
 
-		wFaces.clear();
-	}
+template <typename G, typename I>
+static void computeCumulativeVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+{
+	computeVisibilityParallel<G, I>(ioViewMap, grid, epsilon, iRenderMonitor, true);
+}
+
+template <typename G, typename I>
+static void computeDetailedVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+{
+	computeVisibilityParallel<G, I>(ioViewMap, grid, epsilon, iRenderMonitor, false);
 }
 
 template <typename G, typename I>
@@ -91,6 +91,8 @@ typedef struct GPUDrawObject {
 
 	/* for each triangle, the original MFace index */
 	int *triangle_to_mface;
+	/* for each original MFace, the index of its first point */
+	int *mface_to_point;
 
 	/* for each original vertex, the list of related points */
 	struct GPUVertPointLink *vert_points;
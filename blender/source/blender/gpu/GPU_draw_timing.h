@@ -0,0 +1,69 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): Blender Foundation 2014
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file GPU_draw_timing.h
+ *  \ingroup gpu
+ *
+ * CPU and GPU time per phase of a viewport draw, enabled with
+ * G_DEBUG_DRAW_TIMING. GPU times come from timer queries and are read
+ * back when the same region draws again, so they lag one redraw.
+ */
+
+#ifndef __GPU_DRAW_TIMING_H__
+#define __GPU_DRAW_TIMING_H__
+
+#include "BLI_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* phases must be entered in this order, each at most once per draw */
+typedef enum eGPUDrawTimingPhase {
+	GPU_DRAW_TIMING_SETUP     = 0,  /* shadow buffers, matrices, background, grid */
+	GPU_DRAW_TIMING_OBJECTS   = 1,  /* scene set, objects and duplis */
+	GPU_DRAW_TIMING_AFTERDRAW = 2,  /* transparent and x-ray passes */
+	GPU_DRAW_TIMING_EXTRAS    = 3,  /* draw callbacks, manipulator, sketches */
+	GPU_DRAW_TIMING_ENGINE    = 4,  /* external render engine */
+	GPU_DRAW_TIMING_INFO      = 5,  /* 2D overlays and text */
+	GPU_DRAW_TIMING_TOT
+} eGPUDrawTimingPhase;
+
+bool GPU_draw_timing_enabled(void);
+
+/* owner identifies the drawn region, results are kept per owner */
+void GPU_draw_timing_begin(const void *owner);
+void GPU_draw_timing_phase(eGPUDrawTimingPhase phase);
+void GPU_draw_timing_end(void);
+
+/* results of the last finished draw of owner, or of any owner when NULL,
+ * gpu times are negative when timer queries are not supported */
+bool GPU_draw_timing_get(const void *owner, double r_cpu[GPU_DRAW_TIMING_TOT], double r_gpu[GPU_DRAW_TIMING_TOT]);
+const char *GPU_draw_timing_phase_name(eGPUDrawTimingPhase phase);
+
+void GPU_draw_timing_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __GPU_DRAW_TIMING_H__ */
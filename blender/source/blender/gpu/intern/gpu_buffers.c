@@ -42,6 +42,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "DNA_meshdata_types.h"
@@ -429,6 +430,7 @@ static void gpu_drawobject_init_vert_points(GPUDrawObject *gdo, MFace *f, int to
 
 	for (i = 0; i < totface; i++, f++) {
 		mat = &gdo->materials[mat_orig_to_new[f->mat_nr]];
+		gdo->mface_to_point[i] = mat->start + mat->totpoint;
 
 		/* add triangle */
 		gpu_drawobject_add_triangle(gdo, mat->start + mat->totpoint,
@@ -502,6 +504,8 @@ GPUDrawObject *GPU_drawobject_new(DerivedMesh *dm)
 
 	gdo->triangle_to_mface = MEM_mallocN(sizeof(int) * (gdo->tot_triangle_point / 3),
 	                                     "GPUDrawObject.triangle_to_mface");
+	gdo->mface_to_point = MEM_mallocN(sizeof(int) * totface,
+	                                  "GPUDrawObject.mface_to_point");
 
 	gpu_drawobject_init_vert_points(gdo, mface, totface);
 
@@ -517,6 +521,7 @@ void GPU_drawobject_free(DerivedMesh *dm)
 
 	MEM_freeN(gdo->materials);
 	MEM_freeN(gdo->triangle_to_mface);
+	MEM_freeN(gdo->mface_to_point);
 	MEM_freeN(gdo->vert_points);
 	MEM_freeN(gdo->vert_points_mem);
 	GPU_buffer_free(gdo->points);
@@ -530,19 +535,18 @@ void GPU_drawobject_free(DerivedMesh *dm)
 	dm->drawObject = NULL;
 }
 
-typedef void (*GPUBufferCopyFunc)(DerivedMesh *dm, float *varray, int *index,
-                                  int *mat_orig_to_new, void *user_data);
+typedef void (*GPUBufferCopyFunc)(DerivedMesh *dm, float *varray, void *user_data);
 
-static GPUBuffer *gpu_buffer_setup(DerivedMesh *dm, GPUDrawObject *object,
-                                   int vector_size, int size, GLenum target,
+/* faces are copied in parallel above this count, each face writes its
+ * points at a fixed offset given by GPUDrawObject.mface_to_point */
+#define GPU_BUFFER_COPY_THRESHOLD 10000
+
+static GPUBuffer *gpu_buffer_setup(DerivedMesh *dm, int size, GLenum target,
                                    void *user, GPUBufferCopyFunc copy_f)
 {
 	GPUBufferPool *pool;
 	GPUBuffer *buffer;
 	float *varray;
-	int mat_orig_to_new[MAX_MATERIALS];
-	int *cur_index_per_mat;
-	int i;
 	int success;
 	GLboolean uploaded;
 
@@ -560,17 +564,6 @@ static GPUBuffer *gpu_buffer_setup(DerivedMesh *dm, GPUDrawObject *object,
 		return NULL;
 	}
 
-	cur_index_per_mat = MEM_mallocN(sizeof(int) * object->totmaterial,
-	                                "GPU_buffer_setup.cur_index_per_mat");
-	for (i = 0; i < object->totmaterial; i++) {
-		/* for each material, the current index to copy data to */
-		cur_index_per_mat[i] = object->materials[i].start * vector_size;
-
-		/* map from original material index to new
-		 * GPUBufferMaterial index */
-		mat_orig_to_new[object->materials[i].mat_nr] = i;
-	}
-
 	if (useVBOs) {
 		success = 0;
 
@@ -611,7 +604,7 @@ static GPUBuffer *gpu_buffer_setup(DerivedMesh *dm, GPUDrawObject *object,
 			uploaded = GL_FALSE;
 			/* attempt to upload the data to the VBO */
 			while (uploaded == GL_FALSE) {
-				(*copy_f)(dm, varray, cur_index_per_mat, mat_orig_to_new, user);
+				(*copy_f)(dm, varray, user);
 				/* glUnmapBuffer returns GL_FALSE if
 				 * the data store is corrupted; retry
 				 * in that case */
@@ -624,97 +617,113 @@ static GPUBuffer *gpu_buffer_setup(DerivedMesh *dm, GPUDrawObject *object,
 		/* VBO not supported, use vertex array fallback */
 		if (buffer->pointer) {
 			varray = buffer->pointer;
-			(*copy_f)(dm, varray, cur_index_per_mat, mat_orig_to_new, user);
+			(*copy_f)(dm, varray, user);
 		}
 		else {
 			dm->drawObject->legacy = 1;
 		}
 	}
 
-	MEM_freeN(cur_index_per_mat);
-
 	BLI_mutex_unlock(&buffer_mutex);
 
 	return buffer;
 }
 
-static void GPU_buffer_copy_vertex(DerivedMesh *dm, float *varray, int *index, int *mat_orig_to_new, void *UNUSED(user))
+typedef struct GPUBufferCopyData {
+	void *varray;
+	const MFace *mface;
+	const MVert *mvert;
+	const int *mface_to_point;
+	const float *nors;
+	const MTFace *mtface;
+	const unsigned char *mcol;
+} GPUBufferCopyData;
+
+static void gpu_buffer_copy_faces(DerivedMesh *dm, GPUBufferCopyData *data, TaskParallelRangeFunc func)
 {
-	MVert *mvert;
-	MFace *f;
-	int i, j, start, totface;
+	data->mface = dm->getTessFaceArray(dm);
+	data->mface_to_point = dm->drawObject->mface_to_point;
 
-	mvert = dm->getVertArray(dm);
-	f = dm->getTessFaceArray(dm);
+	BLI_task_parallel_range_ex(0, dm->getNumTessFaces(dm), data, func, GPU_BUFFER_COPY_THRESHOLD);
+}
 
-	totface = dm->getNumTessFaces(dm);
-	for (i = 0; i < totface; i++, f++) {
-		start = index[mat_orig_to_new[f->mat_nr]];
+static void gpu_buffer_copy_vertex_cb(void *userdata, int start, int stop)
+{
+	GPUBufferCopyData *data = userdata;
+	const MVert *mvert = data->mvert;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		const MFace *f = &data->mface[i];
+		float *varray = (float *)data->varray + data->mface_to_point[i] * 3;
 
 		/* v1 v2 v3 */
-		copy_v3_v3(&varray[start], mvert[f->v1].co);
-		copy_v3_v3(&varray[start + 3], mvert[f->v2].co);
-		copy_v3_v3(&varray[start + 6], mvert[f->v3].co);
-		index[mat_orig_to_new[f->mat_nr]] += 9;
+		copy_v3_v3(&varray[0], mvert[f->v1].co);
+		copy_v3_v3(&varray[3], mvert[f->v2].co);
+		copy_v3_v3(&varray[6], mvert[f->v3].co);
 
 		if (f->v4) {
 			/* v3 v4 v1 */
-			copy_v3_v3(&varray[start + 9], mvert[f->v3].co);
-			copy_v3_v3(&varray[start + 12], mvert[f->v4].co);
-			copy_v3_v3(&varray[start + 15], mvert[f->v1].co);
-			index[mat_orig_to_new[f->mat_nr]] += 9;
+			copy_v3_v3(&varray[9], mvert[f->v3].co);
+			copy_v3_v3(&varray[12], mvert[f->v4].co);
+			copy_v3_v3(&varray[15], mvert[f->v1].co);
 		}
 	}
+}
+
+static void GPU_buffer_copy_vertex(DerivedMesh *dm, float *varray, void *UNUSED(user))
+{
+	GPUBufferCopyData data = {NULL};
+	GPUVertPointLink *vert_points = dm->drawObject->vert_points;
+	int i;
+
+	data.varray = varray;
+	data.mvert = dm->getVertArray(dm);
+	gpu_buffer_copy_faces(dm, &data, gpu_buffer_copy_vertex_cb);
 
 	/* copy loose points */
-	j = dm->drawObject->tot_triangle_point * 3;
 	for (i = 0; i < dm->drawObject->totvert; i++) {
-		if (dm->drawObject->vert_points[i].point_index >= dm->drawObject->tot_triangle_point) {
-			copy_v3_v3(&varray[j], mvert[i].co);
-			j += 3;
+		if (vert_points[i].point_index >= dm->drawObject->tot_triangle_point) {
+			copy_v3_v3(&varray[vert_points[i].point_index * 3], data.mvert[i].co);
 		}
 	}
 }
 
-static void GPU_buffer_copy_normal(DerivedMesh *dm, float *varray, int *index, int *mat_orig_to_new, void *UNUSED(user))
+static void gpu_buffer_copy_normal_cb(void *userdata, int start, int stop)
 {
-	int i, totface;
-	int start;
+	GPUBufferCopyData *data = userdata;
+	const MVert *mvert = data->mvert;
+	const float *nors = data->nors;
 	float f_no[3];
+	int i;
 
-	float *nors = dm->getTessFaceDataArray(dm, CD_NORMAL);
-	MVert *mvert = dm->getVertArray(dm);
-	MFace *f = dm->getTessFaceArray(dm);
-
-	totface = dm->getNumTessFaces(dm);
-	for (i = 0; i < totface; i++, f++) {
+	for (i = start; i < stop; i++) {
+		const MFace *f = &data->mface[i];
 		const int smoothnormal = (f->flag & ME_SMOOTH);
-
-		start = index[mat_orig_to_new[f->mat_nr]];
-		index[mat_orig_to_new[f->mat_nr]] += f->v4 ? 18 : 9;
+		float *varray = (float *)data->varray + data->mface_to_point[i] * 3;
 
 		if (smoothnormal) {
 			/* copy vertex normal */
-			normal_short_to_float_v3(&varray[start], mvert[f->v1].no);
-			normal_short_to_float_v3(&varray[start + 3], mvert[f->v2].no);
-			normal_short_to_float_v3(&varray[start + 6], mvert[f->v3].no);
+			normal_short_to_float_v3(&varray[0], mvert[f->v1].no);
+			normal_short_to_float_v3(&varray[3], mvert[f->v2].no);
+			normal_short_to_float_v3(&varray[6], mvert[f->v3].no);
 
 			if (f->v4) {
-				normal_short_to_float_v3(&varray[start + 9], mvert[f->v3].no);
-				normal_short_to_float_v3(&varray[start + 12], mvert[f->v4].no);
-				normal_short_to_float_v3(&varray[start + 15], mvert[f->v1].no);
+				normal_short_to_float_v3(&varray[9], mvert[f->v3].no);
+				normal_short_to_float_v3(&varray[12], mvert[f->v4].no);
+				normal_short_to_float_v3(&varray[15], mvert[f->v1].no);
 			}
 		}
 		else if (nors) {
 			/* copy cached face normal */
-			copy_v3_v3(&varray[start], &nors[i * 3]);
-			copy_v3_v3(&varray[start + 3], &nors[i * 3]);
-			copy_v3_v3(&varray[start + 6], &nors[i * 3]);
+			copy_v3_v3(&varray[0], &nors[i * 3]);
+			copy_v3_v3(&varray[3], &nors[i * 3]);
+			copy_v3_v3(&varray[6], &nors[i * 3]);
 
 			if (f->v4) {
-				copy_v3_v3(&varray[start + 9], &nors[i * 3]);
-				copy_v3_v3(&varray[start + 12], &nors[i * 3]);
-				copy_v3_v3(&varray[start + 15], &nors[i * 3]);
+				copy_v3_v3(&varray[9], &nors[i * 3]);
+				copy_v3_v3(&varray[12], &nors[i * 3]);
+				copy_v3_v3(&varray[15], &nors[i * 3]);
 			}
 		}
 		else {
@@ -724,87 +733,106 @@ static void GPU_buffer_copy_normal(DerivedMesh *dm, float *varray, int *index, i
 			else
 				normal_tri_v3(f_no, mvert[f->v1].co, mvert[f->v2].co, mvert[f->v3].co);
 
-			copy_v3_v3(&varray[start], f_no);
-			copy_v3_v3(&varray[start + 3], f_no);
-			copy_v3_v3(&varray[start + 6], f_no);
+			copy_v3_v3(&varray[0], f_no);
+			copy_v3_v3(&varray[3], f_no);
+			copy_v3_v3(&varray[6], f_no);
 
 			if (f->v4) {
-				copy_v3_v3(&varray[start + 9], f_no);
-				copy_v3_v3(&varray[start + 12], f_no);
-				copy_v3_v3(&varray[start + 15], f_no);
+				copy_v3_v3(&varray[9], f_no);
+				copy_v3_v3(&varray[12], f_no);
+				copy_v3_v3(&varray[15], f_no);
 			}
 		}
 	}
 }
 
-static void GPU_buffer_copy_uv(DerivedMesh *dm, float *varray, int *index, int *mat_orig_to_new, void *UNUSED(user))
+static void GPU_buffer_copy_normal(DerivedMesh *dm, float *varray, void *UNUSED(user))
 {
-	int start;
-	int i, totface;
+	GPUBufferCopyData data = {NULL};
 
-	MTFace *mtface;
-	MFace *f;
+	data.varray = varray;
+	data.mvert = dm->getVertArray(dm);
+	data.nors = dm->getTessFaceDataArray(dm, CD_NORMAL);
+	gpu_buffer_copy_faces(dm, &data, gpu_buffer_copy_normal_cb);
+}
 
-	if (!(mtface = DM_get_tessface_data_layer(dm, CD_MTFACE)))
-		return;
-	f = dm->getTessFaceArray(dm);
-		
-	totface = dm->getNumTessFaces(dm);
-	for (i = 0; i < totface; i++, f++) {
-		start = index[mat_orig_to_new[f->mat_nr]];
+static void gpu_buffer_copy_uv_cb(void *userdata, int start, int stop)
+{
+	GPUBufferCopyData *data = userdata;
+	const MTFace *mtface = data->mtface;
+	int i;
+
+	for (i = start; i < stop; i++) {
+		const MFace *f = &data->mface[i];
+		float *varray = (float *)data->varray + data->mface_to_point[i] * 2;
 
 		/* v1 v2 v3 */
-		copy_v2_v2(&varray[start], mtface[i].uv[0]);
-		copy_v2_v2(&varray[start + 2], mtface[i].uv[1]);
-		copy_v2_v2(&varray[start + 4], mtface[i].uv[2]);
-		index[mat_orig_to_new[f->mat_nr]] += 6;
+		copy_v2_v2(&varray[0], mtface[i].uv[0]);
+		copy_v2_v2(&varray[2], mtface[i].uv[1]);
+		copy_v2_v2(&varray[4], mtface[i].uv[2]);
 
 		if (f->v4) {
 			/* v3 v4 v1 */
-			copy_v2_v2(&varray[start + 6], mtface[i].uv[2]);
-			copy_v2_v2(&varray[start + 8], mtface[i].uv[3]);
-			copy_v2_v2(&varray[start + 10], mtface[i].uv[0]);
-			index[mat_orig_to_new[f->mat_nr]] += 6;
+			copy_v2_v2(&varray[6], mtface[i].uv[2]);
+			copy_v2_v2(&varray[8], mtface[i].uv[3]);
+			copy_v2_v2(&varray[10], mtface[i].uv[0]);
 		}
 	}
 }
 
-static void copy_mcol_uc3(unsigned char *v, unsigned char *col)
+static void GPU_buffer_copy_uv(DerivedMesh *dm, float *varray, void *UNUSED(user))
+{
+	GPUBufferCopyData data = {NULL};
+
+	if (!(data.mtface = DM_get_tessface_data_layer(dm, CD_MTFACE)))
+		return;
+
+	data.varray = varray;
+	gpu_buffer_copy_faces(dm, &data, gpu_buffer_copy_uv_cb);
+}
+
+static void copy_mcol_uc3(unsigned char *v, const unsigned char *col)
 {
 	v[0] = col[3];
 	v[1] = col[2];
 	v[2] = col[1];
 }
 
-/* treat varray_ as an array of MCol, four MCol's per face */
-static void GPU_buffer_copy_mcol(DerivedMesh *dm, float *varray_, int *index, int *mat_orig_to_new, void *user)
+static void gpu_buffer_copy_mcol_cb(void *userdata, int start, int stop)
 {
-	int i, totface;
-	unsigned char *varray = (unsigned char *)varray_;
-	unsigned char *mcol = (unsigned char *)user;
-	MFace *f = dm->getTessFaceArray(dm);
+	GPUBufferCopyData *data = userdata;
+	const unsigned char *mcol = data->mcol;
+	int i;
 
-	totface = dm->getNumTessFaces(dm);
-	for (i = 0; i < totface; i++, f++) {
-		int start = index[mat_orig_to_new[f->mat_nr]];
+	for (i = start; i < stop; i++) {
+		const MFace *f = &data->mface[i];
+		unsigned char *varray = (unsigned char *)data->varray + data->mface_to_point[i] * 3;
 
 		/* v1 v2 v3 */
-		copy_mcol_uc3(&varray[start], &mcol[i * 16]);
-		copy_mcol_uc3(&varray[start + 3], &mcol[i * 16 + 4]);
-		copy_mcol_uc3(&varray[start + 6], &mcol[i * 16 + 8]);
-		index[mat_orig_to_new[f->mat_nr]] += 9;
+		copy_mcol_uc3(&varray[0], &mcol[i * 16]);
+		copy_mcol_uc3(&varray[3], &mcol[i * 16 + 4]);
+		copy_mcol_uc3(&varray[6], &mcol[i * 16 + 8]);
 
 		if (f->v4) {
 			/* v3 v4 v1 */
-			copy_mcol_uc3(&varray[start + 9], &mcol[i * 16 + 8]);
-			copy_mcol_uc3(&varray[start + 12], &mcol[i * 16 + 12]);
-			copy_mcol_uc3(&varray[start + 15], &mcol[i * 16]);
-			index[mat_orig_to_new[f->mat_nr]] += 9;
+			copy_mcol_uc3(&varray[9], &mcol[i * 16 + 8]);
+			copy_mcol_uc3(&varray[12], &mcol[i * 16 + 12]);
+			copy_mcol_uc3(&varray[15], &mcol[i * 16]);
 		}
 	}
 }
 
-static void GPU_buffer_copy_edge(DerivedMesh *dm, float *varray_, int *UNUSED(index), int *UNUSED(mat_orig_to_new), void *UNUSED(user))
+/* treat varray_ as an array of MCol, four MCol's per face */
+static void GPU_buffer_copy_mcol(DerivedMesh *dm, float *varray, void *user)
+{
+	GPUBufferCopyData data = {NULL};
+
+	data.varray = varray;
+	data.mcol = user;
+	gpu_buffer_copy_faces(dm, &data, gpu_buffer_copy_mcol_cb);
+}
+
+static void GPU_buffer_copy_edge(DerivedMesh *dm, float *varray_, void *UNUSED(user))
 {
 	MEdge *medge;
 	unsigned int *varray = (unsigned int *)varray_;
@@ -819,7 +847,7 @@ static void GPU_buffer_copy_edge(DerivedMesh *dm, float *varray_, int *UNUSED(in
 	}
 }
 
-static void GPU_buffer_copy_uvedge(DerivedMesh *dm, float *varray, int *UNUSED(index), int *UNUSED(mat_orig_to_new), void *UNUSED(user))
+static void GPU_buffer_copy_uvedge(DerivedMesh *dm, float *varray, void *UNUSED(user))
 {
 	MTFace *tf = DM_get_tessface_data_layer(dm, CD_MTFACE);
 	int i, j = 0;
@@ -943,8 +971,7 @@ static GPUBuffer *gpu_buffer_setup_type(DerivedMesh *dm, GPUBufferType type)
 			return NULL;
 	}
 
-	buf = gpu_buffer_setup(dm, dm->drawObject, ts->vector_size,
-	                       gpu_buffer_size_from_type(dm, type),
+	buf = gpu_buffer_setup(dm, gpu_buffer_size_from_type(dm, type),
 	                       ts->gl_buffer_type, user_data, ts->copy);
 
 	return buf;
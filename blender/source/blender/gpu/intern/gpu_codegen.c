@@ -62,6 +62,18 @@ extern char datatoc_gpu_shader_vertex_glsl[];
 
 static char *glsl_material_library = NULL;
 
+/* compiled shaders shared between passes with identical generated code,
+ * materials built from the same node setup only differ in their inputs,
+ * which are set per pass when binding */
+typedef struct GPUShaderCacheEntry {
+	char *vertexcode;
+	char *fragmentcode;
+	GPUShader *shader;
+	int users;
+} GPUShaderCacheEntry;
+
+static GHash *gpu_shader_cache = NULL;
+
 
 /* structs and defines */
 
@@ -242,6 +254,81 @@ GPUFunction *GPU_lookup_function(const char *name)
 	return (GPUFunction*)BLI_ghash_lookup(FUNCTION_HASH, (void *)name);
 }
 
+/* Shader cache */
+
+static unsigned int gpu_shader_cache_hash(const void *key)
+{
+	const GPUShaderCacheEntry *entry = key;
+
+	return BLI_ghashutil_strhash(entry->vertexcode) * 37 + BLI_ghashutil_strhash(entry->fragmentcode);
+}
+
+static int gpu_shader_cache_cmp(const void *a, const void *b)
+{
+	const GPUShaderCacheEntry *entry_a = a, *entry_b = b;
+
+	return !(STREQ(entry_a->vertexcode, entry_b->vertexcode) &&
+	         STREQ(entry_a->fragmentcode, entry_b->fragmentcode));
+}
+
+static void gpu_shader_cache_entry_free(void *val)
+{
+	GPUShaderCacheEntry *entry = val;
+
+	GPU_shader_free(entry->shader);
+	MEM_freeN(entry->vertexcode);
+	MEM_freeN(entry->fragmentcode);
+	MEM_freeN(entry);
+}
+
+static GPUShader *gpu_shader_cache_acquire(const char *vertexcode, const char *fragmentcode)
+{
+	GPUShaderCacheEntry key, *entry;
+
+	if (!gpu_shader_cache)
+		gpu_shader_cache = BLI_ghash_new(gpu_shader_cache_hash, gpu_shader_cache_cmp, "GPU shader cache");
+
+	key.vertexcode = (char *)vertexcode;
+	key.fragmentcode = (char *)fragmentcode;
+	entry = BLI_ghash_lookup(gpu_shader_cache, &key);
+
+	if (!entry) {
+		/* failed compiles are not cached, same as before they are retried */
+		GPUShader *shader = GPU_shader_create(vertexcode, fragmentcode, glsl_material_library, NULL);
+
+		if (!shader)
+			return NULL;
+
+		entry = MEM_callocN(sizeof(GPUShaderCacheEntry), "GPUShaderCacheEntry");
+		entry->vertexcode = BLI_strdup(vertexcode);
+		entry->fragmentcode = BLI_strdup(fragmentcode);
+		entry->shader = shader;
+		BLI_ghash_insert(gpu_shader_cache, entry, entry);
+	}
+
+	entry->users++;
+	return entry->shader;
+}
+
+static void gpu_shader_cache_release(const char *vertexcode, const char *fragmentcode, GPUShader *shader)
+{
+	GPUShaderCacheEntry key, *entry = NULL;
+
+	if (gpu_shader_cache) {
+		key.vertexcode = (char *)vertexcode;
+		key.fragmentcode = (char *)fragmentcode;
+		entry = BLI_ghash_lookup(gpu_shader_cache, &key);
+	}
+
+	if (entry && entry->shader == shader) {
+		if (--entry->users == 0)
+			BLI_ghash_remove(gpu_shader_cache, entry, NULL, gpu_shader_cache_entry_free);
+	}
+	else {
+		GPU_shader_free(shader);
+	}
+}
+
 void GPU_codegen_init(void)
 {
 	GPU_code_generate_glsl_lib();
@@ -261,6 +348,11 @@ void GPU_codegen_exit(void)
 
 	GPU_shader_free_builtin_shaders();
 
+	if (gpu_shader_cache) {
+		BLI_ghash_free(gpu_shader_cache, NULL, gpu_shader_cache_entry_free);
+		gpu_shader_cache = NULL;
+	}
+
 	if (glsl_material_library) {
 		MEM_freeN(glsl_material_library);
 		glsl_material_library = NULL;
@@ -1369,7 +1461,7 @@ GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink, GPUVertexAttri
 	/* generate code and compile with opengl */
 	fragmentcode = code_generate_fragment(nodes, outlink->output, name);
 	vertexcode = code_generate_vertex(nodes);
-	shader = GPU_shader_create(vertexcode, fragmentcode, glsl_material_library, NULL);
+	shader = gpu_shader_cache_acquire(vertexcode, fragmentcode);
 
 	/* failed? */
 	if (!shader) {
@@ -1397,7 +1489,8 @@ GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink, GPUVertexAttri
 
 void GPU_pass_free(GPUPass *pass)
 {
-	GPU_shader_free(pass->shader);
+	if (pass->shader)
+		gpu_shader_cache_release(pass->vertexcode, pass->fragmentcode, pass->shader);
 	GPU_inputs_free(&pass->inputs);
 	if (pass->fragmentcode)
 		MEM_freeN(pass->fragmentcode);
@@ -52,6 +52,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
@@ -233,6 +235,9 @@ static struct GPUTextureState {
 	MTFace *lasttface;
 } GTS = {0, 0, 0, 0, 0, 0, 0, 0, NULL, NULL, 1, 0, 0, -1, 1.f, 0, NULL};
 
+/* set when a texture was created, the memory limit is only checked then */
+static bool gpu_texture_memory_dirty = false;
+
 /* Mipmap settings */
 
 void GPU_set_gpu_mipmapping(int gpu_mipmap)
@@ -650,6 +655,8 @@ int GPU_verify_image(Image *ima, ImageUser *iuser, int tftile, int compare, int
 	
 	/* mark as non-color data texture */
 	if (*bind) {
+		gpu_texture_memory_dirty = true;
+
 		if (is_data)
 			ima->tpageflag |= IMA_GLBIND_IS_DATA;	
 		else
@@ -1278,6 +1285,110 @@ void GPU_free_image(Image *ima)
 	ima->tpageflag &= ~(IMA_MIPMAP_COMPLETE|IMA_GLBIND_IS_DATA);
 }
 
+typedef struct GPUImageMemory {
+	Image *ima;
+	size_t size;
+} GPUImageMemory;
+
+static size_t gpu_texture_memory_size(GLuint bindcode, bool mipmap)
+{
+	GLint w, h, internalformat;
+	size_t size;
+
+	glBindTexture(GL_TEXTURE_2D, bindcode);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalformat);
+
+	size = (size_t)w * (size_t)h * ((internalformat == GL_RGBA16) ? 8 : 4);
+
+	/* a full mipmap chain adds a third */
+	if (mipmap)
+		size += size / 3;
+
+	return size;
+}
+
+static size_t gpu_image_memory_size(Image *ima)
+{
+	const bool mipmap = (ima->tpageflag & IMA_MIPMAP_COMPLETE) != 0;
+	size_t size = 0;
+	int a;
+
+	if (ima->bindcode)
+		size += gpu_texture_memory_size(ima->bindcode, mipmap);
+
+	if (ima->repbind) {
+		for (a = 0; a < ima->totbind; a++) {
+			if (ima->repbind[a])
+				size += gpu_texture_memory_size(ima->repbind[a], mipmap);
+		}
+	}
+
+	return size;
+}
+
+static int gpu_image_memory_cmp(const void *a, const void *b)
+{
+	const GPUImageMemory *mem_a = a, *mem_b = b;
+
+	if (mem_a->ima->lastused < mem_b->ima->lastused) return -1;
+	else if (mem_a->ima->lastused > mem_b->ima->lastused) return 1;
+	return 0;
+}
+
+/* Free the least recently used image textures while the textures of all
+ * images use more than the memory limit from the user preferences. */
+void GPU_free_images_memory_limit(void)
+{
+	GPUImageMemory *images;
+	Image *ima;
+	GLint bound;
+	size_t limit, total = 0;
+	const int ctime = (int)PIL_check_seconds_timer();
+	int a, totimage = 0;
+
+	if (U.texmemlimit == 0 || !gpu_texture_memory_dirty || !G.main || !BLI_thread_is_main())
+		return;
+
+	gpu_texture_memory_dirty = false;
+
+	images = MEM_mallocN(sizeof(*images) * BLI_countlist(&G.main->image), __func__);
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+
+	for (ima = G.main->image.first; ima; ima = ima->id.next) {
+		if (ima->bindcode || ima->repbind) {
+			images[totimage].ima = ima;
+			images[totimage].size = gpu_image_memory_size(ima);
+			total += images[totimage].size;
+			totimage++;
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D, bound);
+
+	limit = (size_t)U.texmemlimit * 1024 * 1024;
+
+	if (total > limit) {
+		qsort(images, totimage, sizeof(*images), gpu_image_memory_cmp);
+
+		for (a = 0; a < totimage && total > limit; a++) {
+			ima = images[a].ima;
+
+			/* textures used in the last second stay, so images that are drawn
+			 * every redraw don't get freed and uploaded again */
+			if ((ima->flag & IMA_NOCOLLECT) || ima == GTS.curima || ctime - ima->lastused < 1)
+				continue;
+
+			GPU_free_image(ima);
+			total -= images[a].size;
+		}
+	}
+
+	MEM_freeN(images);
+}
+
 void GPU_free_images(void)
 {
 	Image* ima;
@@ -0,0 +1,253 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): Blender Foundation 2014
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gpu_draw_timing.c
+ *  \ingroup gpu
+ *
+ * Viewport draw timing.
+ *
+ * Every drawn region (owner) gets a slot with one GL_TIME_ELAPSED query per
+ * phase. Query results are only read at the next draw of the same owner,
+ * by then the previous frame has been swapped so reading does not stall.
+ * Only a few slots exist, the least recently drawn owner is replaced.
+ */
+
+#include <string.h>
+
+#include "GL/glew.h"
+
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+
+#include "GPU_draw_timing.h"
+
+#define GPU_DRAW_TIMING_SLOTS 8
+
+typedef struct GPUDrawTimingSlot {
+	const void *owner;
+	int lastused;
+
+	GLuint queries[GPU_DRAW_TIMING_TOT];
+	bool queries_used[GPU_DRAW_TIMING_TOT];
+	bool queries_pending;
+
+	double cpu_collect[GPU_DRAW_TIMING_TOT];
+	double cpu[GPU_DRAW_TIMING_TOT];
+	double gpu[GPU_DRAW_TIMING_TOT];
+	bool has_result;
+} GPUDrawTimingSlot;
+
+static GPUDrawTimingSlot timing_slots[GPU_DRAW_TIMING_SLOTS];
+static GPUDrawTimingSlot *timing_active = NULL;
+static GPUDrawTimingSlot *timing_last = NULL;
+static int timing_phase = -1;
+static double timing_phase_start = 0.0;
+static int timing_counter = 0;
+
+static bool gpu_draw_timing_use_queries(void)
+{
+	return GLEW_ARB_timer_query != 0;
+}
+
+bool GPU_draw_timing_enabled(void)
+{
+	return (G.debug & G_DEBUG_DRAW_TIMING) != 0;
+}
+
+static void gpu_draw_timing_read_queries(GPUDrawTimingSlot *slot)
+{
+	int i;
+
+	for (i = 0; i < GPU_DRAW_TIMING_TOT; i++) {
+		if (slot->queries_used[i]) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(slot->queries[i], GL_QUERY_RESULT, &elapsed);
+			slot->gpu[i] = (double)elapsed * 1e-9;
+		}
+		else {
+			slot->gpu[i] = gpu_draw_timing_use_queries() ? 0.0 : -1.0;
+		}
+	}
+
+	slot->queries_pending = false;
+}
+
+static GPUDrawTimingSlot *gpu_draw_timing_slot(const void *owner)
+{
+	GPUDrawTimingSlot *slot = NULL;
+	int i;
+
+	for (i = 0; i < GPU_DRAW_TIMING_SLOTS; i++) {
+		if (timing_slots[i].owner == owner)
+			return &timing_slots[i];
+
+		if (!slot || timing_slots[i].lastused < slot->lastused)
+			slot = &timing_slots[i];
+	}
+
+	/* replace the least recently drawn owner, pending results are dropped */
+	if (slot->queries_pending)
+		gpu_draw_timing_read_queries(slot);
+
+	if (timing_last == slot)
+		timing_last = NULL;
+
+	slot->owner = owner;
+	slot->has_result = false;
+
+	return slot;
+}
+
+void GPU_draw_timing_begin(const void *owner)
+{
+	GPUDrawTimingSlot *slot;
+
+	/* nested draws are part of the outer one */
+	if (timing_active || !GPU_draw_timing_enabled())
+		return;
+
+	slot = gpu_draw_timing_slot(owner);
+	slot->lastused = ++timing_counter;
+
+	if (slot->queries_pending)
+		gpu_draw_timing_read_queries(slot);
+
+	if (gpu_draw_timing_use_queries() && slot->queries[0] == 0)
+		glGenQueries(GPU_DRAW_TIMING_TOT, slot->queries);
+
+	memset(slot->queries_used, 0, sizeof(slot->queries_used));
+	memset(slot->cpu_collect, 0, sizeof(slot->cpu_collect));
+
+	timing_active = slot;
+	timing_phase = -1;
+}
+
+static void gpu_draw_timing_phase_end(void)
+{
+	if (timing_phase == -1)
+		return;
+
+	timing_active->cpu_collect[timing_phase] += PIL_check_seconds_timer() - timing_phase_start;
+
+	if (timing_active->queries_used[timing_phase])
+		glEndQuery(GL_TIME_ELAPSED);
+
+	timing_phase = -1;
+}
+
+void GPU_draw_timing_phase(eGPUDrawTimingPhase phase)
+{
+	if (!timing_active)
+		return;
+
+	gpu_draw_timing_phase_end();
+
+	/* a GPU query can only measure one span per draw */
+	if (gpu_draw_timing_use_queries() && !timing_active->queries_used[phase]) {
+		glBeginQuery(GL_TIME_ELAPSED, timing_active->queries[phase]);
+		timing_active->queries_used[phase] = true;
+	}
+
+	timing_phase = phase;
+	timing_phase_start = PIL_check_seconds_timer();
+}
+
+void GPU_draw_timing_end(void)
+{
+	if (!timing_active)
+		return;
+
+	gpu_draw_timing_phase_end();
+
+	memcpy(timing_active->cpu, timing_active->cpu_collect, sizeof(timing_active->cpu));
+	timing_active->queries_pending = true;
+
+	/* GPU times of the first draw are only known at the next one */
+	if (!timing_active->has_result) {
+		int i;
+		for (i = 0; i < GPU_DRAW_TIMING_TOT; i++)
+			timing_active->gpu[i] = gpu_draw_timing_use_queries() ? 0.0 : -1.0;
+		timing_active->has_result = true;
+	}
+
+	timing_last = timing_active;
+	timing_active = NULL;
+}
+
+bool GPU_draw_timing_get(const void *owner, double r_cpu[GPU_DRAW_TIMING_TOT], double r_gpu[GPU_DRAW_TIMING_TOT])
+{
+	GPUDrawTimingSlot *slot = NULL;
+	int i;
+
+	if (owner == NULL) {
+		slot = timing_last;
+	}
+	else {
+		for (i = 0; i < GPU_DRAW_TIMING_SLOTS; i++) {
+			if (timing_slots[i].owner == owner) {
+				slot = &timing_slots[i];
+				break;
+			}
+		}
+	}
+
+	if (!slot || !slot->has_result)
+		return false;
+
+	memcpy(r_cpu, slot->cpu, sizeof(slot->cpu));
+	memcpy(r_gpu, slot->gpu, sizeof(slot->gpu));
+
+	return true;
+}
+
+const char *GPU_draw_timing_phase_name(eGPUDrawTimingPhase phase)
+{
+	switch (phase) {
+		case GPU_DRAW_TIMING_SETUP:     return "SETUP";
+		case GPU_DRAW_TIMING_OBJECTS:   return "OBJECTS";
+		case GPU_DRAW_TIMING_AFTERDRAW: return "AFTERDRAW";
+		case GPU_DRAW_TIMING_EXTRAS:    return "EXTRAS";
+		case GPU_DRAW_TIMING_ENGINE:    return "ENGINE";
+		case GPU_DRAW_TIMING_INFO:      return "INFO";
+		case GPU_DRAW_TIMING_TOT:       break;
+	}
+
+	return "UNKNOWN";
+}
+
+void GPU_draw_timing_exit(void)
+{
+	int i;
+
+	for (i = 0; i < GPU_DRAW_TIMING_SLOTS; i++) {
+		if (timing_slots[i].queries[0])
+			glDeleteQueries(GPU_DRAW_TIMING_TOT, timing_slots[i].queries);
+	}
+
+	memset(timing_slots, 0, sizeof(timing_slots));
+	timing_active = NULL;
+	timing_last = NULL;
+	timing_counter = 0;
+}
@@ -43,6 +43,7 @@
 #include "BKE_global.h"
 
 #include "GPU_draw.h"
+#include "GPU_draw_timing.h"
 #include "GPU_extensions.h"
 #include "GPU_simple_shader.h"
 #include "gpu_codegen.h"
@@ -228,6 +229,7 @@ void GPU_extensions_exit(void)
 	gpu_extensions_init = 0;
 	GPU_codegen_exit();
 	GPU_simple_shaders_exit();
+	GPU_draw_timing_exit();
 }
 
 int GPU_glsl_support(void)
@@ -1124,12 +1126,24 @@ int GPU_offscreen_height(GPUOffScreen *ofs)
 
 /* GPUShader */
 
+/* uniform values last uploaded to a program, uniforms keep their value in the
+ * program object so re-sending an unchanged value is redundant. Only the low
+ * locations are cached, drivers hand out locations sequentially in practice */
+#define GPU_SHADER_UNIFORM_CACHE_SIZE 64
+
+typedef struct GPUUniformCache {
+	float value[16];
+	short length;			/* number of values, 0 when unset */
+	short isint;			/* value holds an int bit pattern */
+} GPUUniformCache;
+
 struct GPUShader {
 	GLhandleARB object;		/* handle for full shader */
 	GLhandleARB vertex;		/* handle for vertex shader */
 	GLhandleARB fragment;	/* handle for fragment shader */
 	GLhandleARB lib;		/* handle for libment shader */
 	int totattrib;			/* total number of attributes */
+	GPUUniformCache *uniforms;	/* lazily allocated, see GPU_SHADER_UNIFORM_CACHE_SIZE */
 };
 
 static void shader_print_errors(const char *task, char *log, const char *code)
@@ -1339,19 +1353,50 @@ void GPU_shader_free(GPUShader *shader)
 		glDeleteObjectARB(shader->fragment);
 	if (shader->object)
 		glDeleteObjectARB(shader->object);
+	if (shader->uniforms)
+		MEM_freeN(shader->uniforms);
 	MEM_freeN(shader);
 }
 
+/* returns 0 when value is already set for this uniform, else stores it */
+static int gpu_shader_uniform_changed(GPUShader *shader, int location, int length, int isint, const float *value)
+{
+	GPUUniformCache *cache;
+
+	if (!shader || location >= GPU_SHADER_UNIFORM_CACHE_SIZE)
+		return 1;
+
+	if (!shader->uniforms)
+		shader->uniforms = MEM_callocN(sizeof(GPUUniformCache) * GPU_SHADER_UNIFORM_CACHE_SIZE, "GPUUniformCache");
+
+	cache = &shader->uniforms[location];
+
+	if (cache->length == length && cache->isint == isint &&
+	    memcmp(cache->value, value, sizeof(float) * length) == 0)
+	{
+		return 0;
+	}
+
+	memcpy(cache->value, value, sizeof(float) * length);
+	cache->length = length;
+	cache->isint = isint;
+
+	return 1;
+}
+
 int GPU_shader_get_uniform(GPUShader *shader, const char *name)
 {
 	return glGetUniformLocationARB(shader->object, name);
 }
 
-void GPU_shader_uniform_vector(GPUShader *UNUSED(shader), int location, int length, int arraysize, float *value)
+void GPU_shader_uniform_vector(GPUShader *shader, int location, int length, int arraysize, float *value)
 {
 	if (location == -1)
 		return;
 
+	if (arraysize == 1 && length <= 16 && !gpu_shader_uniform_changed(shader, location, length, FALSE, value))
+		return;
+
 	GPU_print_error("Pre Uniform Vector");
 
 	if (length == 1) glUniform1fvARB(location, arraysize, value);
@@ -1364,17 +1409,24 @@ void GPU_shader_uniform_vector(GPUShader *UNUSED(shader), int location, int leng
 	GPU_print_error("Post Uniform Vector");
 }
 
-void GPU_shader_uniform_int(GPUShader *UNUSED(shader), int location, int value)
+void GPU_shader_uniform_int(GPUShader *shader, int location, int value)
 {
+	float fvalue;
+
 	if (location == -1)
 		return;
 
+	/* ints are cached by bit pattern */
+	memcpy(&fvalue, &value, sizeof(float));
+	if (!gpu_shader_uniform_changed(shader, location, 1, TRUE, &fvalue))
+		return;
+
 	GPU_print_error("Pre Uniform Int");
 	glUniform1iARB(location, value);
 	GPU_print_error("Post Uniform Int");
 }
 
-void GPU_shader_uniform_texture(GPUShader *UNUSED(shader), int location, GPUTexture *tex)
+void GPU_shader_uniform_texture(GPUShader *shader, int location, GPUTexture *tex)
 {
 	GLenum arbnumber;
 
@@ -1395,7 +1447,7 @@ void GPU_shader_uniform_texture(GPUShader *UNUSED(shader), int location, GPUText
 
 	if (tex->number != 0) glActiveTextureARB(arbnumber);
 	glBindTexture(tex->target, tex->bindcode);
-	glUniform1iARB(location, tex->number);
+	GPU_shader_uniform_int(shader, location, tex->number);
 	glEnable(tex->target);
 	if (tex->number != 0) glActiveTextureARB(GL_TEXTURE0_ARB);
 
@@ -111,6 +111,17 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Load a lower resolution level stored in the file (mipmaps of tiled OpenEXR),
+ * the smallest one with its larger side still at least min_size.
+ * Full resolution of the image is returned in r_width and r_height.
+ * Returns NULL when the file has no such levels, it has to be loaded in full then.
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_loadiffname_level(const char *filepath, int flags, char colorspace[IM_MAX_SPACE],
+                                    int min_size, int *r_width, int *r_height);
+
 /**
  *
  * \attention Defined in allocimbuf.c
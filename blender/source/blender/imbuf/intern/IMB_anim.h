@@ -119,9 +119,22 @@
 
 #define MAXNUMSTREAMS       50
 
+/* decoded frames kept for scrubbing backwards within a GOP */
+#define FFMPEG_FRAME_CACHE_MAX   16
+#define FFMPEG_FRAME_CACHE_MEM   (128 * 1024 * 1024)
+/* one color conversion context per thread, BLENDER_MAX_THREADS */
+#define FFMPEG_CONVERT_BANDS_MAX 64
+
 struct _AviMovie;
 struct anim_index;
 
+#ifdef WITH_FFMPEG
+struct anim_frame_cache_item {
+	struct ImBuf *ibuf;
+	int64_t pts, next_pts;  /* frame covers pts up to, not including next_pts */
+};
+#endif
+
 struct anim {
 	int ib_flags;
 	int curtype;
@@ -179,6 +192,12 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	struct anim_frame_cache_item frame_cache[FFMPEG_FRAME_CACHE_MAX];
+	int frame_cache_size, frame_cache_next;
+
+	struct SwsContext *img_convert_ctx_band[FFMPEG_CONVERT_BANDS_MAX];
+	int img_convert_band_lines[FFMPEG_CONVERT_BANDS_MAX];
 #endif
 
 #ifdef WITH_REDCODE
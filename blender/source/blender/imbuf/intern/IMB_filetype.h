@@ -49,6 +49,10 @@ typedef struct ImFileType {
 	int flag;
 	int filetype;
 	int default_save_role;
+
+	/* optional, loads a lower resolution level stored in the file, see IMB_loadiffname_level */
+	struct ImBuf *(*load_level)(unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE],
+	                            int min_size, int *r_width, int *r_height);
 } ImFileType;
 
 extern ImFileType IMB_FILE_TYPES[];
@@ -68,6 +68,7 @@
 #include "BLI_string.h"
 #include "BLI_path_util.h"
 #include "BLI_math_base.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -459,6 +460,51 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+#define FFMPEG_SWS_FLAGS (SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT)
+
+static struct SwsContext *ffmpeg_get_convert_context(struct anim *anim, int lines, int sws_flags)
+{
+	return sws_getContext(
+	        anim->x,
+	        lines,
+	        anim->pCodecCtx->pix_fmt,
+	        anim->x,
+	        lines,
+	        PIX_FMT_RGBA,
+	        sws_flags,
+	        NULL, NULL, NULL);
+}
+
+static void ffmpeg_setup_colorspace_details(struct anim *anim, struct SwsContext *img_convert_ctx)
+{
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* The following for color space determination */
+	int srcRange, dstRange, brightness, contrast, saturation;
+	int *table;
+	const int *inv_table;
+
+	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+	if (!sws_getColorspaceDetails(img_convert_ctx, (int **)&inv_table, &srcRange,
+	                              &table, &dstRange, &brightness, &contrast, &saturation))
+	{
+		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+		if (sws_setColorspaceDetails(img_convert_ctx, (int *)inv_table, srcRange,
+		                             table, dstRange, brightness, contrast, saturation))
+		{
+			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		}
+	}
+	else {
+		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+	}
+#else
+	(void)anim;
+	(void)img_convert_ctx;
+#endif
+}
+
 static int startffmpeg(struct anim *anim)
 {
 	int i, videoStream;
@@ -470,13 +516,6 @@ static int startffmpeg(struct anim *anim)
 	double frs_den;
 	int streamcount;
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* The following for color space determination */
-	int srcRange, dstRange, brightness, contrast, saturation;
-	int *table;
-	const int *inv_table;
-#endif
-
 	if (anim == 0) return(-1);
 
 	streamcount = anim->streamindex;
@@ -522,6 +561,13 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+	/* frame threading adds a few frames of decoder delay, which decoding
+	 * already handles by reading packets until a frame is complete */
+	pCodecCtx->thread_count = BLI_system_thread_count();
+#ifdef FF_THREAD_FRAME
+	pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		av_close_input_file(pFormatCtx);
 		return -1;
@@ -564,6 +610,9 @@ static int startffmpeg(struct anim *anim)
 	anim->next_pts = -1;
 	anim->next_packet.stream_index = -1;
 
+	anim->frame_cache_size = CLAMPIS(FFMPEG_FRAME_CACHE_MEM / anim->framesize, 2, FFMPEG_FRAME_CACHE_MAX);
+	anim->frame_cache_next = 0;
+
 	anim->pFrame = avcodec_alloc_frame();
 	anim->pFrameComplete = FALSE;
 	anim->pFrameDeinterlaced = avcodec_alloc_frame();
@@ -602,16 +651,8 @@ static int startffmpeg(struct anim *anim)
 		anim->preseek = 0;
 	}
 	
-	anim->img_convert_ctx = sws_getContext(
-	        anim->x,
-	        anim->y,
-	        anim->pCodecCtx->pix_fmt,
-	        anim->x,
-	        anim->y,
-	        PIX_FMT_RGBA,
-	        SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-	        NULL, NULL, NULL);
-		
+	anim->img_convert_ctx = ffmpeg_get_convert_context(anim, anim->y, FFMPEG_SWS_FLAGS | SWS_PRINT_INFO);
+
 	if (!anim->img_convert_ctx) {
 		fprintf(stderr,
 		        "Can't transform color space??? Bailing out...\n");
@@ -624,38 +665,126 @@ static int startffmpeg(struct anim *anim)
 		return -1;
 	}
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-	if (!sws_getColorspaceDetails(anim->img_convert_ctx, (int **)&inv_table, &srcRange,
-	                              &table, &dstRange, &brightness, &contrast, &saturation))
-	{
-		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+	ffmpeg_setup_colorspace_details(anim, anim->img_convert_ctx);
+		
+	return (0);
+}
 
-		if (sws_setColorspaceDetails(anim->img_convert_ctx, (int *)inv_table, srcRange,
-		                             table, dstRange, brightness, contrast, saturation))
-		{
-			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-		}
+typedef struct ConvertBandInitData {
+	struct anim *anim;
+	AVFrame *input;
+	int v_shift;
+	int band;
+} ConvertBandInitData;
+
+typedef struct ConvertBandThread {
+	struct anim *anim;
+	AVFrame *input;
+	int v_shift;
+	int band;
+	int start_line, tot_line;
+} ConvertBandThread;
+
+static void ffmpeg_convert_band_init(void *handle_v, int start_line, int tot_line, void *init_data_v)
+{
+	ConvertBandThread *handle = (ConvertBandThread *) handle_v;
+	ConvertBandInitData *init_data = (ConvertBandInitData *) init_data_v;
+
+	/* lines are counted in chroma rows so bands never split subsampled chroma */
+	handle->anim = init_data->anim;
+	handle->input = init_data->input;
+	handle->v_shift = init_data->v_shift;
+	handle->band = init_data->band++;
+	handle->start_line = start_line << init_data->v_shift;
+	handle->tot_line = tot_line << init_data->v_shift;
+}
+
+static void *ffmpeg_convert_band_thread(void *handle_v)
+{
+	ConvertBandThread *handle = (ConvertBandThread *) handle_v;
+	struct anim *anim = handle->anim;
+	AVFrame *input = handle->input;
+	struct SwsContext *img_convert_ctx;
+	const uint8_t *src[4];
+	int *dstStride = anim->pFrameRGB->linesize;
+	int dstStride2[4] = { -dstStride[0], 0, 0, 0 };
+	uint8_t *dst2[4] = { anim->pFrameRGB->data[0] + (anim->y - 1 - handle->start_line) * dstStride[0],
+	                     0, 0, 0 };
+	int i;
+
+	if (handle->tot_line == 0)
+		return NULL;
+
+	/* each band converts with its own context, swscale contexts aren't thread safe */
+	if (anim->img_convert_band_lines[handle->band] != handle->tot_line) {
+		if (anim->img_convert_ctx_band[handle->band])
+			sws_freeContext(anim->img_convert_ctx_band[handle->band]);
+
+		anim->img_convert_ctx_band[handle->band] = ffmpeg_get_convert_context(anim, handle->tot_line, FFMPEG_SWS_FLAGS);
+		anim->img_convert_band_lines[handle->band] = handle->tot_line;
+
+		if (anim->img_convert_ctx_band[handle->band])
+			ffmpeg_setup_colorspace_details(anim, anim->img_convert_ctx_band[handle->band]);
 	}
-	else {
-		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+
+	img_convert_ctx = anim->img_convert_ctx_band[handle->band];
+
+	if (img_convert_ctx == NULL)
+		return NULL;
+
+	for (i = 0; i < 4; i++) {
+		/* chroma planes 1 and 2 are subsampled, luma and alpha aren't */
+		int line = (i == 1 || i == 2) ? handle->start_line >> handle->v_shift : handle->start_line;
+
+		src[i] = input->data[i] ? input->data[i] + line * input->linesize[i] : NULL;
 	}
-#endif
-		
-	return (0);
+
+	sws_scale(img_convert_ctx,
+	          src,
+	          input->linesize,
+	          0,
+	          handle->tot_line,
+	          dst2,
+	          dstStride2);
+
+	return NULL;
+}
+
+/* convert in horizontal bands on all threads, 4K frames spend most of their
+ * fetch time here otherwise */
+static bool ffmpeg_convert_threaded(struct anim *anim, AVFrame *input)
+{
+	ConvertBandInitData init_data;
+	int h_shift, v_shift;
+
+	if (BLI_system_thread_count() < 2 || anim->x * anim->y < 1280 * 720)
+		return false;
+
+	avcodec_get_chroma_sub_sample(anim->pCodecCtx->pix_fmt, &h_shift, &v_shift);
+
+	if (anim->y % (1 << v_shift))
+		return false;
+
+	init_data.anim = anim;
+	init_data.input = input;
+	init_data.v_shift = v_shift;
+	init_data.band = 0;
+
+	IMB_processor_apply_threaded(anim->y >> v_shift, sizeof(ConvertBandThread), &init_data,
+	                             ffmpeg_convert_band_init, ffmpeg_convert_band_thread);
+
+	return true;
 }
 
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
 	AVFrame *input = anim->pFrame;
-	ImBuf *ibuf = anim->last_frame;
 	int filter_y = 0;
 
 	if (!anim->pFrameComplete) {
@@ -746,7 +875,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 			top -= 8 * w;
 		}
 	}
-	else {
+	else if (!ffmpeg_convert_threaded(anim, input)) {
 		int *dstStride   = anim->pFrameRGB->linesize;
 		uint8_t **dst     = anim->pFrameRGB->data;
 		int dstStride2[4] = { -dstStride[0], 0, 0, 0 };
@@ -870,11 +999,60 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 	return (rval >= 0);
 }
 
+static void ffmpeg_frame_cache_add(struct anim *anim, ImBuf *ibuf, int64_t pts, int64_t next_pts)
+{
+	struct anim_frame_cache_item *item = &anim->frame_cache[anim->frame_cache_next];
+
+	if (item->ibuf)
+		IMB_freeImBuf(item->ibuf);
+
+	item->ibuf = ibuf;
+	item->pts = pts;
+	item->next_pts = next_pts;
+
+	anim->frame_cache_next = (anim->frame_cache_next + 1) % anim->frame_cache_size;
+}
+
+static ImBuf *ffmpeg_frame_cache_get(struct anim *anim, int64_t pts)
+{
+	int i;
+
+	for (i = 0; i < anim->frame_cache_size; i++) {
+		struct anim_frame_cache_item *item = &anim->frame_cache[i];
+
+		if (item->ibuf && item->pts <= pts && item->next_pts > pts) {
+			IMB_refImBuf(item->ibuf);
+			return item->ibuf;
+		}
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_frame_cache_free(struct anim *anim)
+{
+	int i;
+
+	for (i = 0; i < FFMPEG_FRAME_CACHE_MAX; i++) {
+		if (anim->frame_cache[i].ibuf) {
+			IMB_freeImBuf(anim->frame_cache[i].ibuf);
+			anim->frame_cache[i].ibuf = NULL;
+		}
+	}
+
+	anim->frame_cache_next = 0;
+}
+
+/* decode up to pts_to_search, frames from pts_cache_start on are converted and
+ * kept in the frame cache, so scrubbing backwards doesn't seek for every frame */
+
 static void ffmpeg_decode_video_frame_scan(
-        struct anim *anim, int64_t pts_to_search)
+        struct anim *anim, int64_t pts_to_search, int64_t pts_cache_start)
 {
 	/* there seem to exist *very* silly GOP lengths out in the wild... */
 	int count = 1000;
+	int64_t pts;
+	ImBuf *ibuf;
 
 	av_log(anim->pFormatCtx,
 	       AV_LOG_DEBUG, 
@@ -886,9 +1064,28 @@ static void ffmpeg_decode_video_frame_scan(
 		       AV_LOG_DEBUG, 
 		       "  WHILE: pts=%lld in search of %lld\n", 
 		       (long long int)anim->next_pts, (long long int)pts_to_search);
+
+		ibuf = NULL;
+		pts = anim->next_pts;
+
+		if (anim->pFrameComplete && pts >= pts_cache_start) {
+			ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+
+			if (ibuf) {
+				ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+				ffmpeg_postprocess(anim, ibuf);
+			}
+		}
+
 		if (!ffmpeg_decode_video_frame(anim)) {
+			if (ibuf)
+				IMB_freeImBuf(ibuf);
 			break;
 		}
+
+		if (ibuf)
+			ffmpeg_frame_cache_add(anim, ibuf, pts, anim->next_pts);
+
 		count--;
 	}
 	if (count == 0) {
@@ -959,6 +1156,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	AVStream *v_st;
 	int new_frame_index = 0; /* To quiet gcc barking... */
 	int old_frame_index = 0; /* To quiet gcc barking... */
+	int64_t pts_cache_start = INT64_MAX;
+	ImBuf *ibuf;
 
 	if (anim == 0) return (0);
 
@@ -1009,6 +1208,27 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		anim->curposition = position;
 		return anim->last_frame;
 	}
+
+	/* decoder state stays at curposition, the next frame may still
+	 * be decoded without seeking */
+	ibuf = ffmpeg_frame_cache_get(anim, pts_to_search);
+	if (ibuf) {
+		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
+		       "FETCH: frame cache hit\n");
+		return ibuf;
+	}
+
+	/* scrubbing backwards, keep the frames before the one searched for */
+	if (position < anim->curposition) {
+		if (tc_index) {
+			pts_cache_start = IMB_indexer_get_pts(
+			        tc_index, max_ii(new_frame_index - anim->frame_cache_size, 0));
+		}
+		else {
+			pts_cache_start = pts_to_search -
+			                  (int64_t)(anim->frame_cache_size / pts_time_base / frame_rate + 0.5);
+		}
+	}
 	 
 	if (position > anim->curposition + 1 &&
 	    anim->preseek &&
@@ -1018,7 +1238,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		av_log(anim->pFormatCtx, AV_LOG_DEBUG, 
 		       "FETCH: within preseek interval (no index)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
 	}
 	else if (tc_index &&
 	         IMB_indexer_can_scan(tc_index, old_frame_index,
@@ -1028,7 +1248,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		       "FETCH: within preseek interval "
 		       "(index tells us)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
 	}
 	else if (position != anim->curposition + 1) {
 		long long pos;
@@ -1107,7 +1327,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		/* memset(anim->pFrame, ...) ?? */
 
 		if (ret >= 0) {
-			ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+			ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_cache_start);
 		}
 	}
 	else if (position == 0 && anim->curposition == -1) {
@@ -1123,7 +1343,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
 	anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-	ffmpeg_postprocess(anim);
+	ffmpeg_postprocess(anim, anim->last_frame);
 
 	anim->last_pts = anim->next_pts;
 	
@@ -1138,6 +1358,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 static void free_anim_ffmpeg(struct anim *anim)
 {
+	int i;
+
 	if (anim == NULL) return;
 
 	if (anim->pCodecCtx) {
@@ -1151,6 +1373,16 @@ static void free_anim_ffmpeg(struct anim *anim)
 		}
 		av_free(anim->pFrameDeinterlaced);
 		sws_freeContext(anim->img_convert_ctx);
+
+		for (i = 0; i < FFMPEG_CONVERT_BANDS_MAX; i++) {
+			if (anim->img_convert_ctx_band[i]) {
+				sws_freeContext(anim->img_convert_ctx_band[i]);
+				anim->img_convert_ctx_band[i] = NULL;
+				anim->img_convert_band_lines[i] = 0;
+			}
+		}
+
+		ffmpeg_frame_cache_free(anim);
 		IMB_freeImBuf(anim->last_frame);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
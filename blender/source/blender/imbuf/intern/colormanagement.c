@@ -38,6 +38,10 @@
 #include <string.h>
 #include <math.h>
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 #include "DNA_color_types.h"
 #include "DNA_image_types.h"
 #include "DNA_movieclip_types.h"
@@ -108,6 +112,8 @@ typedef struct ColormanageProcessor {
 	bool is_data_result;
 } ColormanageProcessor;
 
+static void display_lut_free_all(void);
+
 static struct global_glsl_state {
 	/* Actual processor used for GLSL baked LUTs. */
 	OCIO_ConstProcessorRcPtr *processor;
@@ -680,6 +686,8 @@ void colormanagement_exit(void)
 	if (global_glsl_state.transform_ocio_glsl_state)
 		OCIO_freeOGLState(global_glsl_state.transform_ocio_glsl_state);
 
+	display_lut_free_all();
+
 	colormanage_free_config();
 }
 
@@ -1220,10 +1228,299 @@ const char *IMB_colormanagement_get_rect_colorspace(ImBuf *ibuf)
 	return ibuf->rect_colorspace->name;
 }
 
+/*********************** Baked display transform LUT *************************/
+
+/* Display transform of large float buffers goes via a 3D LUT baked from the
+ * full processor (curves, look, view, exposure, gamma and display), running
+ * OCIO for every pixel is what makes viewing big EXRs slow.
+ *
+ * The LUT is indexed through a log shaper which keeps black exact and covers
+ * DISPLAY_LUT_LOG_MAX stops above white, values outside of this range are
+ * clamped. Interpolation isn't exact, so LUT is only used for byte display
+ * buffers where the error is below quantization.
+ */
+
+#define DISPLAY_LUT_SIZE 65
+#define DISPLAY_LUT_LOG_MIN -10.0f
+#define DISPLAY_LUT_LOG_MAX 7.0f
+#define DISPLAY_LUT_CACHE_MAX 4
+/* baking transforms a quarter of this many pixels, smaller images aren't worth it */
+#define DISPLAY_LUT_MIN_PIXELS (4 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE)
+
+typedef struct DisplayLUT {
+	struct DisplayLUT *next, *prev;
+
+	/* settings the LUT was baked for */
+	char look[MAX_COLORSPACE_NAME];
+	char view[MAX_COLORSPACE_NAME];
+	char display[MAX_COLORSPACE_NAME];
+	float exposure, gamma;
+	CurveMapping *orig_curve_mapping;
+	int curve_mapping_timestamp;
+
+	int users;
+
+	/* RGB padded to 4 floats, so every entry is loaded with a single SSE load */
+	float *table;
+} DisplayLUT;
+
+static ListBase global_display_luts = {NULL, NULL};
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+BLI_INLINE float display_lut_shaper(float value)
+{
+	const float offset = exp2f(DISPLAY_LUT_LOG_MIN);
+
+	if (value <= 0.0f)
+		return 0.0f;
+
+	value = (log2f(value + offset) - DISPLAY_LUT_LOG_MIN) / (DISPLAY_LUT_LOG_MAX - DISPLAY_LUT_LOG_MIN);
+
+	return min_ff(value, 1.0f);
+}
+
+static float display_lut_shaper_inverse(float value)
+{
+	const float offset = exp2f(DISPLAY_LUT_LOG_MIN);
+
+	return exp2f(DISPLAY_LUT_LOG_MIN + value * (DISPLAY_LUT_LOG_MAX - DISPLAY_LUT_LOG_MIN)) - offset;
+}
+
+static float *display_lut_bake(ColormanageProcessor *cm_processor)
+{
+	const int size = DISPLAY_LUT_SIZE;
+	float axis[DISPLAY_LUT_SIZE];
+	float *table, *fp;
+	int r, g, b;
+
+	table = MEM_mallocN(sizeof(float) * 4 * size * size * size, "display transform LUT");
+
+	for (r = 0; r < size; r++)
+		axis[r] = display_lut_shaper_inverse((float) r / (size - 1));
+
+	/* red changes fastest, matches lookup in display_lut_evaluate */
+	for (b = 0, fp = table; b < size; b++) {
+		for (g = 0; g < size; g++) {
+			for (r = 0; r < size; r++, fp += 4) {
+				fp[0] = axis[r];
+				fp[1] = axis[g];
+				fp[2] = axis[b];
+				fp[3] = 1.0f;
+			}
+		}
+	}
+
+	IMB_colormanagement_processor_apply(cm_processor, table, size * size * size, 1, 4, false);
+
+	return table;
+}
+
+static void display_lut_evaluate(const float *table, const float in[3], float out[3])
+{
+	const int size = DISPLAY_LUT_SIZE;
+	const int dr = 4, dg = 4 * size, db = 4 * size * size;
+	const float *p;
+	float fac[3];
+	int index[3], i;
+
+	for (i = 0; i < 3; i++) {
+		float co = display_lut_shaper(in[i]) * (size - 1);
+
+		/* also catches NaN, which fails all comparisons */
+		if (!(co >= 0.0f))
+			co = 0.0f;
+
+		index[i] = min_ii((int) co, size - 2);
+		fac[i] = co - index[i];
+	}
+
+	p = table + index[0] * dr + index[1] * dg + index[2] * db;
+
+#ifdef __SSE__
+	{
+		const __m128 fac_r = _mm_set1_ps(fac[0]);
+		const __m128 fac_g = _mm_set1_ps(fac[1]);
+		const __m128 fac_b = _mm_set1_ps(fac[2]);
+		__m128 c00, c01, c10, c11, c0, c1, c;
+		float result[4];
+
+		c00 = _mm_loadu_ps(p);
+		c00 = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p + dr), c00), fac_r));
+		c10 = _mm_loadu_ps(p + dg);
+		c10 = _mm_add_ps(c10, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p + dg + dr), c10), fac_r));
+		c01 = _mm_loadu_ps(p + db);
+		c01 = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p + db + dr), c01), fac_r));
+		c11 = _mm_loadu_ps(p + db + dg);
+		c11 = _mm_add_ps(c11, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p + db + dg + dr), c11), fac_r));
+
+		c0 = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), fac_g));
+		c1 = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), fac_g));
+		c = _mm_add_ps(c0, _mm_mul_ps(_mm_sub_ps(c1, c0), fac_b));
+
+		_mm_storeu_ps(result, c);
+		copy_v3_v3(out, result);
+	}
+#else
+	{
+		float c00[3], c01[3], c10[3], c11[3], c0[3], c1[3];
+
+		interp_v3_v3v3(c00, p, p + dr, fac[0]);
+		interp_v3_v3v3(c10, p + dg, p + dg + dr, fac[0]);
+		interp_v3_v3v3(c01, p + db, p + db + dr, fac[0]);
+		interp_v3_v3v3(c11, p + db + dg, p + db + dg + dr, fac[0]);
+
+		interp_v3_v3v3(c0, c00, c10, fac[1]);
+		interp_v3_v3v3(c1, c01, c11, fac[1]);
+		interp_v3_v3v3(out, c0, c1, fac[2]);
+	}
+#endif
+}
+
+static void display_lut_apply(DisplayLUT *lut, ColormanageProcessor *cm_processor, float *buffer,
+                              int width, int height, int channels, bool predivide)
+{
+	size_t i, tot = (size_t) width * height;
+	float *pixel;
+
+	for (i = 0, pixel = buffer; i < tot; i++, pixel += channels) {
+		if (predivide && channels == 4 && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+			if (cm_processor->curve_mapping) {
+				/* curves are applied before alpha is divided, this isn't in the LUT */
+				IMB_colormanagement_processor_apply_v4_predivide(cm_processor, pixel);
+			}
+			else {
+				float alpha = pixel[3];
+
+				mul_v3_fl(pixel, 1.0f / alpha);
+				display_lut_evaluate(lut->table, pixel, pixel);
+				mul_v3_fl(pixel, alpha);
+			}
+		}
+		else {
+			display_lut_evaluate(lut->table, pixel, pixel);
+		}
+	}
+}
+
+static void display_lut_free(DisplayLUT *lut)
+{
+	MEM_freeN(lut->table);
+	MEM_freeN(lut);
+}
+
+/* get a LUT for given settings, baking it from cm_processor if it's not cached yet */
+static DisplayLUT *display_lut_acquire(const ColorManagedViewSettings *view_settings,
+                                       const ColorManagedDisplaySettings *display_settings,
+                                       ColormanageProcessor *cm_processor)
+{
+	CurveMapping *curve_mapping = NULL;
+	int curve_mapping_timestamp = 0;
+	DisplayLUT *lut;
+
+	if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+		curve_mapping = view_settings->curve_mapping;
+		curve_mapping_timestamp = curve_mapping->changed_timestamp;
+	}
+
+	BLI_mutex_lock(&display_lut_lock);
+
+	for (lut = global_display_luts.first; lut; lut = lut->next) {
+		if (STREQ(lut->look, view_settings->look) &&
+		    STREQ(lut->view, view_settings->view_transform) &&
+		    STREQ(lut->display, display_settings->display_device) &&
+		    lut->exposure == view_settings->exposure &&
+		    lut->gamma == view_settings->gamma &&
+		    lut->orig_curve_mapping == curve_mapping &&
+		    lut->curve_mapping_timestamp == curve_mapping_timestamp)
+		{
+			break;
+		}
+	}
+
+	if (lut) {
+		/* keep most recently used first */
+		BLI_remlink(&global_display_luts, lut);
+	}
+	else {
+		DisplayLUT *lut_iter, *lut_prev;
+		int tot_lut = BLI_countlist(&global_display_luts);
+
+		/* LUTs which are being applied by other threads are kept */
+		for (lut_iter = global_display_luts.last; lut_iter && tot_lut >= DISPLAY_LUT_CACHE_MAX; lut_iter = lut_prev) {
+			lut_prev = lut_iter->prev;
+
+			if (lut_iter->users == 0) {
+				BLI_remlink(&global_display_luts, lut_iter);
+				display_lut_free(lut_iter);
+				tot_lut--;
+			}
+		}
+
+		lut = MEM_callocN(sizeof(DisplayLUT), "display transform LUT cache");
+
+		BLI_strncpy(lut->look, view_settings->look, sizeof(lut->look));
+		BLI_strncpy(lut->view, view_settings->view_transform, sizeof(lut->view));
+		BLI_strncpy(lut->display, display_settings->display_device, sizeof(lut->display));
+		lut->exposure = view_settings->exposure;
+		lut->gamma = view_settings->gamma;
+		lut->orig_curve_mapping = curve_mapping;
+		lut->curve_mapping_timestamp = curve_mapping_timestamp;
+
+		lut->table = display_lut_bake(cm_processor);
+	}
+
+	BLI_addhead(&global_display_luts, lut);
+	lut->users++;
+
+	BLI_mutex_unlock(&display_lut_lock);
+
+	return lut;
+}
+
+static void display_lut_release(DisplayLUT *lut)
+{
+	BLI_mutex_lock(&display_lut_lock);
+	lut->users--;
+	BLI_mutex_unlock(&display_lut_lock);
+}
+
+static void display_lut_free_all(void)
+{
+	DisplayLUT *lut, *lut_next;
+
+	for (lut = global_display_luts.first; lut; lut = lut_next) {
+		lut_next = lut->next;
+		display_lut_free(lut);
+	}
+
+	global_display_luts.first = global_display_luts.last = NULL;
+}
+
+static bool display_lut_supported(ImBuf *ibuf, float *display_buffer,
+                                  const ColorManagedViewSettings *view_settings,
+                                  ColormanageProcessor *cm_processor)
+{
+	/* float display buffers are expected to be exact */
+	if (view_settings == NULL || display_buffer != NULL)
+		return false;
+
+	if (ibuf->rect_float == NULL || ibuf->channels < 3)
+		return false;
+
+	if ((ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA) || cm_processor->is_data_result)
+		return false;
+
+	if (cm_processor->processor == NULL)
+		return false;
+
+	return (size_t) ibuf->x * ibuf->y >= DISPLAY_LUT_MIN_PIXELS;
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
 	ColormanageProcessor *cm_processor;
+	DisplayLUT *display_lut;
 
 	float *buffer;
 	unsigned char *byte_buffer;
@@ -1246,6 +1543,7 @@ typedef struct DisplayBufferThread {
 typedef struct DisplayBufferInitData {
 	ImBuf *ibuf;
 	ColormanageProcessor *cm_processor;
+	DisplayLUT *display_lut;
 	float *buffer;
 	unsigned char *byte_buffer;
 
@@ -1274,6 +1572,7 @@ static void display_buffer_init_handle(void *handle_v, int start_line, int tot_l
 	memset(handle, 0, sizeof(DisplayBufferThread));
 
 	handle->cm_processor = init_data->cm_processor;
+	handle->display_lut = init_data->display_lut;
 
 	if (init_data->buffer)
 		handle->buffer = init_data->buffer + offset;
@@ -1419,6 +1718,10 @@ static void *do_display_buffer_apply_thread(void *handle_v)
 			 * only generate byte buffers
 			 */
 		}
+		else if (handle->display_lut) {
+			display_lut_apply(handle->display_lut, cm_processor, linear_buffer, width, height, channels,
+			                  predivide);
+		}
 		else {
 			/* apply processor */
 			IMB_colormanagement_processor_apply(cm_processor, linear_buffer, width, height, channels,
@@ -1456,12 +1759,14 @@ static void *do_display_buffer_apply_thread(void *handle_v)
 }
 
 static void display_buffer_apply_threaded(ImBuf *ibuf, float *buffer, unsigned char *byte_buffer, float *display_buffer,
-                                          unsigned char *display_buffer_byte, ColormanageProcessor *cm_processor)
+                                          unsigned char *display_buffer_byte, ColormanageProcessor *cm_processor,
+                                          DisplayLUT *display_lut)
 {
 	DisplayBufferInitData init_data;
 
 	init_data.ibuf = ibuf;
 	init_data.cm_processor = cm_processor;
+	init_data.display_lut = display_lut;
 	init_data.buffer = buffer;
 	init_data.byte_buffer = byte_buffer;
 	init_data.display_buffer = display_buffer;
@@ -1511,6 +1816,7 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
                                                   const ColorManagedDisplaySettings *display_settings)
 {
 	ColormanageProcessor *cm_processor = NULL;
+	DisplayLUT *display_lut = NULL;
 	bool skip_transform = false;
 
 	/* if we're going to transform byte buffer, check whether transformation would
@@ -1522,11 +1828,18 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
 		skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
 	}
 
-	if (skip_transform == false)
+	if (skip_transform == false) {
 		cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
 
+		if (display_lut_supported(ibuf, display_buffer, view_settings, cm_processor))
+			display_lut = display_lut_acquire(view_settings, display_settings, cm_processor);
+	}
+
 	display_buffer_apply_threaded(ibuf, ibuf->rect_float, (unsigned char *) ibuf->rect,
-	                              display_buffer, display_buffer_byte, cm_processor);
+	                              display_buffer, display_buffer_byte, cm_processor, display_lut);
+
+	if (display_lut)
+		display_lut_release(display_lut);
 
 	if (cm_processor)
 		IMB_colormanagement_processor_free(cm_processor);
@@ -48,6 +48,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /**************************** Interlace/Deinterlace **************************/
 
 void IMB_de_interlace(ImBuf *ibuf)
@@ -190,6 +194,78 @@ MINLINE void float_to_byte_dither_v4(uchar b[4], const float f[4], DitherContext
 	ushort_to_byte_dither_v4(b, us, di);
 }
 
+#ifdef __SSE2__
+
+/* RGBA rows, four pixels at a time, clamping and rounding match FTOCHAR */
+static void float_to_byte_row_sse2(uchar *to, const float *from, int width, bool predivide)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	__m128i pixels[4];
+	int x, i;
+
+	for (x = 0; x + 4 <= width; x += 4, from += 16, to += 16) {
+		for (i = 0; i < 4; i++) {
+			__m128 v = _mm_loadu_ps(from + 4 * i);
+
+			if (predivide) {
+				/* same as premul_to_straight_v4_v4, zero alpha is kept as is */
+				__m128 alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 mask = _mm_cmpneq_ps(alpha, zero);
+				__m128 straight = _mm_mul_ps(v, _mm_div_ps(one, alpha));
+
+				straight = _mm_or_ps(_mm_and_ps(mask, straight), _mm_andnot_ps(mask, v));
+				/* restore alpha channel */
+				v = _mm_shuffle_ps(straight, _mm_unpackhi_ps(straight, v), _MM_SHUFFLE(3, 0, 1, 0));
+			}
+
+			v = _mm_min_ps(_mm_max_ps(v, zero), one);
+			pixels[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+		}
+
+		_mm_storeu_si128((__m128i *) to, _mm_packus_epi16(_mm_packs_epi32(pixels[0], pixels[1]),
+		                                                  _mm_packs_epi32(pixels[2], pixels[3])));
+	}
+
+	for (; x < width; x++, from += 4, to += 4) {
+		if (predivide) {
+			float straight[4];
+
+			premul_to_straight_v4_v4(straight, from);
+			rgba_float_to_uchar(to, straight);
+		}
+		else {
+			rgba_float_to_uchar(to, from);
+		}
+	}
+}
+
+/* RGBA rows, four pixels at a time, same as rgba_uchar_to_float */
+static void byte_to_float_row_sse2(float *to, const uchar *from, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+	int x;
+
+	for (x = 0; x + 4 <= width; x += 4, from += 16, to += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *) from);
+		__m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+		_mm_storeu_ps(to, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(to + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+
+	for (; x < width; x++, from += 4, to += 4)
+		rgba_uchar_to_float(to, from);
+}
+
+#endif  /* __SSE2__ */
+
 /* float to byte pixels, output 4-channel RGBA */
 void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
                                 int channels_from, float dither, int profile_to, int profile_from, int predivide,
@@ -264,14 +340,23 @@ void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
 						float_to_byte_dither_v4(to, from, di);
 				}
 				else if (predivide) {
+#ifdef __SSE2__
+					float_to_byte_row_sse2(to, from, width, true);
+					(void)straight;
+#else
 					for (x = 0; x < width; x++, from += 4, to += 4) {
 						premul_to_straight_v4_v4(straight, from);
 						rgba_float_to_uchar(to, straight);
 					}
+#endif
 				}
 				else {
+#ifdef __SSE2__
+					float_to_byte_row_sse2(to, from, width, false);
+#else
 					for (x = 0; x < width; x++, from += 4, to += 4)
 						rgba_float_to_uchar(to, from);
+#endif
 				}
 			}
 			else if (profile_to == IB_PROFILE_SRGB) {
@@ -362,8 +447,12 @@ void IMB_buffer_float_from_byte(float *rect_to, const uchar *rect_from,
 
 		if (profile_to == profile_from) {
 			/* no color space conversion */
+#ifdef __SSE2__
+			byte_to_float_row_sse2(to, from, width);
+#else
 			for (x = 0; x < width; x++, from += 4, to += 4)
 				rgba_uchar_to_float(to, from);
+#endif
 		}
 		else if (profile_to == IB_PROFILE_LINEAR_RGB) {
 			/* convert sRGB to linear */
@@ -542,10 +631,92 @@ void IMB_buffer_byte_from_byte(uchar *rect_to, const uchar *rect_from,
 
 /****************************** ImBuf Conversion *****************************/
 
-void IMB_rect_from_float(ImBuf *ibuf)
+/* Conversion of whole buffers is split into chunks of lines which are
+ * converted on their own, threaded for big buffers. */
+
+typedef struct ConvertRectInitData {
+	ImBuf *ibuf;
+	float *rect_float;
+	struct ColormanageProcessor *cm_processor;
+} ConvertRectInitData;
+
+typedef struct ConvertRectThread {
+	ImBuf *ibuf;
+	float *rect_float;
+	struct ColormanageProcessor *cm_processor;
+
+	int start_line;
+	int tot_line;
+} ConvertRectThread;
+
+static void convert_rect_init_handle(void *handle_v, int start_line, int tot_line, void *init_data_v)
+{
+	ConvertRectThread *handle = (ConvertRectThread *) handle_v;
+	ConvertRectInitData *init_data = (ConvertRectInitData *) init_data_v;
+
+	handle->ibuf = init_data->ibuf;
+	handle->rect_float = init_data->rect_float;
+	handle->cm_processor = init_data->cm_processor;
+
+	handle->start_line = start_line;
+	handle->tot_line = tot_line;
+}
+
+static void convert_rect_apply(ConvertRectInitData *init_data, void (*convert_lines) (ConvertRectThread *handle),
+                               void *(do_thread) (void *))
 {
+	ImBuf *ibuf = init_data->ibuf;
+
+	if ((size_t) ibuf->x * ibuf->y < IMB_THREADED_MIN_PIXELS) {
+		ConvertRectThread handle;
+
+		convert_rect_init_handle(&handle, 0, ibuf->y, init_data);
+		convert_lines(&handle);
+	}
+	else {
+		IMB_processor_apply_threaded(ibuf->y, sizeof(ConvertRectThread), init_data,
+		                             convert_rect_init_handle, do_thread);
+	}
+}
+
+static void rect_from_float_lines(ConvertRectThread *handle)
+{
+	ImBuf *ibuf = handle->ibuf;
+	size_t offset = (size_t) ibuf->x * handle->start_line;
+	size_t buffer_size = (size_t) ibuf->channels * ibuf->x * handle->tot_line;
 	float *buffer;
-	const char *from_colorspace;
+
+	if (handle->tot_line == 0)
+		return;
+
+	buffer = MEM_mallocN(buffer_size * sizeof(float), "IMB_rect_from_float buffer");
+	memcpy(buffer, ibuf->rect_float + ibuf->channels * offset, buffer_size * sizeof(float));
+
+	/* first make float buffer in byte space */
+	if (handle->cm_processor)
+		IMB_colormanagement_processor_apply(handle->cm_processor, buffer, ibuf->x, handle->tot_line, ibuf->channels, true);
+
+	/* convert from float's premul alpha to byte's straight alpha */
+	IMB_unpremultiply_rect_float(buffer, ibuf->planes, ibuf->x, handle->tot_line);
+
+	/* convert float to byte */
+	IMB_buffer_byte_from_float((unsigned char *) ibuf->rect + 4 * offset, buffer, ibuf->channels, ibuf->dither,
+	                           IB_PROFILE_SRGB, IB_PROFILE_SRGB, FALSE, ibuf->x, handle->tot_line, ibuf->x, ibuf->x);
+
+	MEM_freeN(buffer);
+}
+
+static void *do_rect_from_float_thread(void *handle_v)
+{
+	rect_from_float_lines((ConvertRectThread *) handle_v);
+
+	return NULL;
+}
+
+void IMB_rect_from_float(ImBuf *ibuf)
+{
+	ConvertRectInitData init_data = {NULL};
+	const char *from_colorspace, *to_colorspace;
 
 	/* verify we have a float buffer */
 	if (ibuf->rect_float == NULL)
@@ -562,19 +733,18 @@ void IMB_rect_from_float(ImBuf *ibuf)
 	else
 		from_colorspace = ibuf->float_colorspace->name;
 
-	buffer = MEM_dupallocN(ibuf->rect_float);
+	to_colorspace = ibuf->rect_colorspace->name;
 
-	/* first make float buffer in byte space */
-	IMB_colormanagement_transform(buffer, ibuf->x, ibuf->y, ibuf->channels, from_colorspace, ibuf->rect_colorspace->name, true);
+	init_data.ibuf = ibuf;
 
-	/* convert from float's premul alpha to byte's straight alpha */
-	IMB_unpremultiply_rect_float(buffer, ibuf->planes, ibuf->x, ibuf->y);
+	/* same early outs as IMB_colormanagement_transform, processor is shared by all threads */
+	if (from_colorspace[0] != '\0' && !STREQ(from_colorspace, to_colorspace))
+		init_data.cm_processor = IMB_colormanagement_colorspace_processor_new(from_colorspace, to_colorspace);
 
-	/* convert float to byte */
-	IMB_buffer_byte_from_float((unsigned char *) ibuf->rect, buffer, ibuf->channels, ibuf->dither, IB_PROFILE_SRGB, IB_PROFILE_SRGB,
-	                           FALSE, ibuf->x, ibuf->y, ibuf->x, ibuf->x);
+	convert_rect_apply(&init_data, rect_from_float_lines, do_rect_from_float_thread);
 
-	MEM_freeN(buffer);
+	if (init_data.cm_processor)
+		IMB_colormanagement_processor_free(init_data.cm_processor);
 
 	/* ensure user flag is reset */
 	ibuf->userflags &= ~IB_RECT_INVALID;
@@ -625,8 +795,37 @@ void IMB_partial_rect_from_float(ImBuf *ibuf, float *buffer, int x, int y, int w
 	ibuf->userflags &= ~IB_RECT_INVALID;
 }
 
+static void float_from_rect_lines(ConvertRectThread *handle)
+{
+	ImBuf *ibuf = handle->ibuf;
+	size_t offset = (size_t) 4 * ibuf->x * handle->start_line;
+	float *rect_float = handle->rect_float + offset;
+
+	if (handle->tot_line == 0)
+		return;
+
+	/* first, create float buffer in non-linear space */
+	IMB_buffer_float_from_byte(rect_float, (unsigned char *) ibuf->rect + offset, IB_PROFILE_SRGB, IB_PROFILE_SRGB,
+	                           FALSE, ibuf->x, handle->tot_line, ibuf->x, ibuf->x);
+
+	/* then make float be in linear space */
+	IMB_colormanagement_colorspace_to_scene_linear(rect_float, ibuf->x, handle->tot_line, ibuf->channels,
+	                                               ibuf->rect_colorspace, false);
+
+	/* byte buffer is straight alpha, float should always be premul */
+	IMB_premultiply_rect_float(rect_float, ibuf->channels, ibuf->x, handle->tot_line);
+}
+
+static void *do_float_from_rect_thread(void *handle_v)
+{
+	float_from_rect_lines((ConvertRectThread *) handle_v);
+
+	return NULL;
+}
+
 void IMB_float_from_rect(ImBuf *ibuf)
 {
+	ConvertRectInitData init_data = {NULL};
 	float *rect_float;
 
 	/* verify if we byte and float buffers */
@@ -651,17 +850,10 @@ void IMB_float_from_rect(ImBuf *ibuf)
 			return;
 	}
 
-	/* first, create float buffer in non-linear space */
-	IMB_buffer_float_from_byte(rect_float, (unsigned char *) ibuf->rect, IB_PROFILE_SRGB, IB_PROFILE_SRGB,
-	                           FALSE, ibuf->x, ibuf->y, ibuf->x, ibuf->x);
-
-	/* then make float be in linear space */
-	IMB_colormanagement_colorspace_to_scene_linear(rect_float, ibuf->x, ibuf->y, ibuf->channels,
-	                                               ibuf->rect_colorspace, false);
-
-	/* byte buffer is straight alpha, float should always be premul */
-	IMB_premultiply_rect_float(rect_float, ibuf->channels, ibuf->x, ibuf->y);
+	init_data.ibuf = ibuf;
+	init_data.rect_float = rect_float;
 
+	convert_rect_apply(&init_data, float_from_rect_lines, do_float_from_rect_thread);
 
 	if (ibuf->rect_float == NULL) {
 		ibuf->rect_float = rect_float;
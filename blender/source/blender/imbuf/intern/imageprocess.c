@@ -41,6 +41,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_utildefines.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
@@ -284,21 +285,35 @@ void nearest_interpolation(ImBuf *in, ImBuf *out, float x, float y, int xout, in
 
 /*********************** Threaded image processing *************************/
 
+typedef struct ProcessorApplyData {
+	void *(*do_thread) (void *);
+} ProcessorApplyData;
+
+static void processor_apply_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	ProcessorApplyData *data = (ProcessorApplyData *) BLI_task_pool_userdata(pool);
+
+	data->do_thread(taskdata);
+}
+
+/* Splits buffer lines into a chunk per thread and runs do_thread on every chunk,
+ * init_handle is called for all chunks from the calling thread first.
+ * Chunks are executed by the central task scheduler, so this may also be used
+ * from threads which are already running a task. */
 void IMB_processor_apply_threaded(int buffer_lines, int handle_size, void *init_customdata,
                                   void (init_handle) (void *handle, int start_line, int tot_line,
                                                       void *customdata),
                                   void *(do_thread) (void *))
 {
 	void *handles;
-	ListBase threads;
 
 	int i, tot_thread = BLI_system_thread_count();
 	int start_line, tot_line;
 
-	handles = MEM_callocN(handle_size * tot_thread, "processor apply threaded handles");
+	/* no use in chunks without lines */
+	tot_thread = max_ii(1, min_ii(tot_thread, buffer_lines));
 
-	if (tot_thread > 1)
-		BLI_init_threads(&threads, do_thread, tot_thread);
+	handles = MEM_callocN(handle_size * tot_thread, "processor apply threaded handles");
 
 	start_line = 0;
 	tot_line = ((float)(buffer_lines / tot_thread)) + 0.5f;
@@ -314,16 +329,25 @@ void IMB_processor_apply_threaded(int buffer_lines, int handle_size, void *init_
 
 		init_handle(handle, start_line, cur_tot_line, init_customdata);
 
-		if (tot_thread > 1)
-			BLI_insert_thread(&threads, handle);
-
 		start_line += tot_line;
 	}
 
-	if (tot_thread > 1)
-		BLI_end_threads(&threads);
-	else
+	if (tot_thread > 1) {
+		TaskPool *task_pool;
+		ProcessorApplyData data;
+
+		data.do_thread = do_thread;
+		task_pool = BLI_task_pool_create(BLI_task_scheduler_get(), &data);
+
+		for (i = 0; i < tot_thread; i++)
+			BLI_task_pool_push(task_pool, processor_apply_func, ((char *) handles) + handle_size * i, false, TASK_PRIORITY_HIGH);
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
+	else {
 		do_thread(handles);
+	}
 
 	MEM_freeN(handles);
 }
@@ -74,5 +74,8 @@ typedef unsigned char uchar;
 
 #define IMB_DPI_DEFAULT 72.0f
 
+/* smaller buffers are processed on the calling thread, threading overhead isn't worth it */
+#define IMB_THREADED_MIN_PIXELS (256 * 256)
+
 #endif	/* __IMBUF_H__ */
 
@@ -37,6 +37,8 @@
 #include "BLI_path_util.h"
 #include "BLI_fileops.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -720,6 +722,10 @@ typedef struct FFmpegIndexBuilderContext {
 	struct proxy_output_ctx *proxy_ctx[IMB_PROXY_MAX_SLOT];
 	anim_index_builder *indexer[IMB_TC_MAX_SLOT];
 
+	/* encodes all proxy sizes of a decoded frame in parallel */
+	TaskPool *proxy_pool;
+	AVFrame *proxy_in_frame;
+
 	IMB_Timecode_Type tcs_in_use;
 	IMB_Proxy_Size proxy_sizes_in_use;
 
@@ -795,6 +801,11 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 
 	context->iCodecCtx->workaround_bugs = 1;
 
+	context->iCodecCtx->thread_count = BLI_system_thread_count();
+#ifdef FF_THREAD_FRAME
+	context->iCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+
 	if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
 		av_close_input_file(context->iFormatCtx);
 		MEM_freeN(context);
@@ -853,6 +864,14 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+static void index_rebuild_ffmpeg_proxy_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	FFmpegIndexBuilderContext *context = BLI_task_pool_userdata(pool);
+	struct proxy_output_ctx *proxy_ctx = taskdata;
+
+	add_to_proxy_output_ffmpeg(proxy_ctx, context->proxy_in_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
 	FFmpegIndexBuilderContext *context, 
 	AVPacket * curr_packet,
@@ -863,8 +882,22 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+	/* every size has its own scaler, encoder and file; the decoder
+	 * reuses in_frame, so they are all done before returning */
+	if (context->proxy_pool) {
+		context->proxy_in_frame = in_frame;
+
+		for (i = 0; i < context->num_proxy_sizes; i++) {
+			if (context->proxy_ctx[i]) {
+				BLI_task_pool_push(context->proxy_pool, index_rebuild_ffmpeg_proxy_task,
+				                   context->proxy_ctx[i], false, TASK_PRIORITY_HIGH);
+			}
+		}
+	}
+	else {
+		for (i = 0; i < context->num_proxy_sizes; i++) {
+			add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+		}
 	}
 
 	if (!context->start_pts_set) {
@@ -903,6 +936,11 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 				s_pos, s_dts, pts);
 		}
 	}
+
+	if (context->proxy_pool) {
+		BLI_task_pool_work_and_wait(context->proxy_pool);
+		context->proxy_in_frame = NULL;
+	}
 	
 	context->frameno_gapless++;
 }
@@ -913,9 +951,20 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 	AVFrame *in_frame = 0;
 	AVPacket next_packet;
 	uint64_t stream_size;
+	int i, num_proxies = 0;
 
 	memset(&next_packet, 0, sizeof(AVPacket));
 
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			num_proxies++;
+		}
+	}
+
+	if (num_proxies > 1) {
+		context->proxy_pool = BLI_task_pool_create(BLI_task_scheduler_get(), context);
+	}
+
 	in_frame = avcodec_alloc_frame();
 
 	stream_size = avio_size(context->iFormatCtx->pb);
@@ -986,6 +1035,11 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 
 	av_free(in_frame);
 
+	if (context->proxy_pool) {
+		BLI_task_pool_free(context->proxy_pool);
+		context->proxy_pool = NULL;
+	}
+
 	return 1;
 }
 
@@ -73,6 +73,8 @@ typedef struct MovieCache {
 	MovieCacheGetItemPriorityFP getitempriorityfp;
 	MovieCachePriorityDeleterFP prioritydeleterfp;
 
+	MovieCacheEvictFP evictfp;
+
 	struct BLI_mempool *keys_pool;
 	struct BLI_mempool *items_pool;
 	struct BLI_mempool *userkeys_pool;
@@ -95,6 +97,7 @@ typedef struct MovieCacheItem {
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
+	void *userkey;  /* owned by the key, for the evict callback */
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -181,6 +184,9 @@ static void IMB_moviecache_destructor(void *p)
 
 		PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
+		if (cache->evictfp)
+			cache->evictfp(item->userkey, item->ibuf);
+
 		IMB_freeImBuf(item->ibuf);
 
 		item->ibuf = NULL;
@@ -306,6 +312,11 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGe
 	cache->prioritydeleterfp = prioritydeleterfp;
 }
 
+void IMB_moviecache_set_evict_callback(MovieCache *cache, MovieCacheEvictFP evictfp)
+{
+	cache->evictfp = evictfp;
+}
+
 static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, int need_lock)
 {
 	MovieCacheKey *key;
@@ -329,6 +340,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, int
 	item->cache_owner = cache;
 	item->c_handle = NULL;
 	item->priority_data = NULL;
+	item->userkey = key->userkey;
 
 	if (cache->getprioritydatafp) {
 		item->priority_data = cache->getprioritydatafp(userkey);
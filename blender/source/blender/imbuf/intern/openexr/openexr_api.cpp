@@ -81,6 +81,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include <ImfChannelList.h>
 #include <ImfPixelType.h>
 #include <ImfInputFile.h>
+#include <ImfTiledInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfCompression.h>
 #include <ImfCompressionAttribute.h>
@@ -269,6 +270,27 @@ typedef struct _RGBAZ RGBAZ;
 extern "C"
 {
 
+/* OpenEXR decompresses and compresses line blocks in its own global thread
+ * pool, keep it in sync with the thread count set by the user, this can change
+ * at runtime (render settings, command line) after imb_initopenexr */
+static int exr_thread_count = -1;
+static ThreadMutex exr_thread_count_lock = BLI_MUTEX_INITIALIZER;
+
+static void imb_exr_thread_count_update(void)
+{
+	int num_threads = BLI_system_thread_count();
+
+	if (num_threads == exr_thread_count)
+		return;
+
+	BLI_mutex_lock(&exr_thread_count_lock);
+	if (num_threads != exr_thread_count) {
+		setGlobalThreadCount(num_threads);
+		exr_thread_count = num_threads;
+	}
+	BLI_mutex_unlock(&exr_thread_count_lock);
+}
+
 int imb_is_a_openexr(unsigned char *mem)
 {
 	return Imf::isImfMagic((const char *)mem);
@@ -465,6 +487,8 @@ static int imb_save_openexr_float(struct ImBuf *ibuf, const char *name, int flag
 
 int imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags)
 {
+	imb_exr_thread_count_update();
+
 	if (flags & IB_mem) {
 		printf("OpenEXR-save: Create EXR in memory CURRENTLY NOT SUPPORTED !\n");
 		imb_addencodedbufferImBuf(ibuf);
@@ -586,6 +610,8 @@ int IMB_exr_begin_write(void *handle, const char *filename, int width, int heigh
 	data->width = width;
 	data->height = height;
 
+	imb_exr_thread_count_update();
+
 	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next)
 		header.channels().insert(echan->name, Channel(Imf::FLOAT));
 
@@ -626,6 +652,8 @@ void IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap, int
 	data->height = height;
 	data->mipmap = mipmap;
 
+	imb_exr_thread_count_update();
+
 	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next)
 		header.channels().insert(echan->name, Channel(Imf::FLOAT));
 
@@ -655,6 +683,8 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
 {
 	ExrHandle *data = (ExrHandle *)handle;
 
+	imb_exr_thread_count_update();
+
 	if (BLI_exists(filename) && BLI_file_size(filename) > 32) {   /* 32 is arbitrary, but zero length files crashes exr */
 		/* avoid crash/abort when we don't have permission to write here */
 		try {
@@ -771,9 +801,20 @@ void IMB_exr_write_channels(void *handle)
 	}
 }
 
-void IMB_exr_read_channels(void *handle)
+static void imb_exr_insert_channel(ExrHandle *data, FrameBuffer &frameBuffer, ExrChannel *echan, short flip)
+{
+	if (flip)
+		frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)echan->rect,
+		                                      echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
+	else
+		frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
+		                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+}
+
+/* reads all channels with a rect set, or only the channels of one pass,
+ * channels not in the frame buffer are skipped by OpenEXR */
+static void imb_exr_read_channels_ex(ExrHandle *data, ExrPass *only_pass)
 {
-	ExrHandle *data = (ExrHandle *)handle;
 	FrameBuffer frameBuffer;
 	ExrChannel *echan;
 
@@ -781,18 +822,19 @@ void IMB_exr_read_channels(void *handle)
 	const StringAttribute *ta = data->ifile->header().findTypedAttribute <StringAttribute> ("BlenderMultiChannel");
 	short flip = (ta && strncmp(ta->value().c_str(), "Blender V2.43", 13) == 0); /* 'previous multilayer attribute, flipped */
 
-	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+	if (only_pass) {
+		int a;
 
-		if (echan->rect) {
-			if (flip)
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)echan->rect,
-				                                      echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
+		for (a = 0; a < only_pass->totchan; a++)
+			imb_exr_insert_channel(data, frameBuffer, only_pass->chan[a], flip);
+	}
+	else {
+		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+			if (echan->rect)
+				imb_exr_insert_channel(data, frameBuffer, echan, flip);
 			else
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
-				                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+				printf("warning, channel with no rect set %s\n", echan->name);
 		}
-		else
-			printf("warning, channel with no rect set %s\n", echan->name);
 	}
 
 	data->ifile->setFrameBuffer(frameBuffer);
@@ -805,6 +847,35 @@ void IMB_exr_read_channels(void *handle)
 	}
 }
 
+void IMB_exr_read_channels(void *handle)
+{
+	imb_exr_read_channels_ex((ExrHandle *)handle, NULL);
+}
+
+static ExrPass *imb_exr_find_pass(ExrHandle *data, const char *layname, const char *passname)
+{
+	ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+
+	if (lay == NULL)
+		return NULL;
+
+	return (ExrPass *)BLI_findstring(&lay->passes, passname, offsetof(ExrPass, name));
+}
+
+/* only reads the channels of one pass, for handles with layers (multilayer image
+ * loading), the other passes keep their unused buffers and are not decoded */
+int IMB_exr_read_layer_pass(void *handle, const char *layname, const char *passname)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+	ExrPass *pass = imb_exr_find_pass(data, layname, passname);
+
+	if (pass == NULL || pass->rect == NULL)
+		return 0;
+
+	imb_exr_read_channels_ex(data, pass);
+	return 1;
+}
+
 void IMB_exr_multilayer_convert(void *handle, void *base,
                                 void * (*addlayer)(void *base, const char *str),
                                 void (*addpass)(void *base, void *lay, const char *str,
@@ -863,6 +934,115 @@ void IMB_exr_close(void *handle)
 	MEM_freeN(data);
 }
 
+/* scanlines per band when merging files, bounds the memory used */
+#define EXR_MERGE_BAND  16
+
+/* copy all channels of several render tile files of the same size into one
+ * multilayer file, streaming a band of scanlines at a time so the full image
+ * never has to be in memory. tile files are written flipped ("Blender V2.43"),
+ * so input scanlines are read bottom to top while output is written top to bottom */
+int IMB_exr_merge_files(const char *filename, const char **inputs, int totinput, int compress)
+{
+	ExrHandle *out = (ExrHandle *)IMB_exr_get_handle();
+	ExrHandle **in = (ExrHandle **)MEM_callocN(sizeof(ExrHandle *) * totinput, "exr merge inputs");
+	ExrChannel *echan, *ochan;
+	float *band = NULL;
+	int width = 0, height = 0, totchan = 0;
+	int a, chan, ok = (totinput > 0);
+
+	imb_exr_thread_count_update();
+
+	for (a = 0; a < totinput && ok; a++) {
+		int w, h;
+
+		in[a] = (ExrHandle *)IMB_exr_get_handle();
+
+		if (!IMB_exr_begin_read(in[a], inputs[a], &w, &h)) {
+			printf("IMB_exr_merge_files: cannot read %s\n", inputs[a]);
+			ok = 0;
+		}
+		else if (a != 0 && (w != width || h != height)) {
+			printf("IMB_exr_merge_files: size mismatch in %s\n", inputs[a]);
+			ok = 0;
+		}
+		else {
+			width = w;
+			height = h;
+
+			for (echan = (ExrChannel *)in[a]->channels.first; echan; echan = echan->next) {
+				IMB_exr_add_channel(out, NULL, echan->name, 1, width, NULL);
+				totchan++;
+			}
+		}
+	}
+
+	if (ok && totchan) {
+		/* one row band per channel, in and out channels share them in the same order */
+		band = (float *)MEM_mapallocN(sizeof(float) * totchan * width * EXR_MERGE_BAND, "exr merge band");
+
+		ochan = (ExrChannel *)out->channels.first;
+		for (a = 0, chan = 0; a < totinput; a++) {
+			for (echan = (ExrChannel *)in[a]->channels.first; echan; echan = echan->next, ochan = ochan->next, chan++) {
+				echan->rect = band + (size_t)chan * width * EXR_MERGE_BAND;
+				ochan->rect = echan->rect;
+			}
+		}
+
+		ok = IMB_exr_begin_write(out, filename, width, height, compress);
+	}
+	else {
+		ok = 0;
+	}
+
+	if (ok) {
+		int o0;
+
+		try {
+			for (o0 = 0; o0 < height; o0 += EXR_MERGE_BAND) {
+				int o1 = MIN2(o0 + EXR_MERGE_BAND, height) - 1;
+				int i0 = height - 1 - o1, i1 = height - 1 - o0;
+				FrameBuffer outBuffer;
+
+				for (a = 0; a < totinput; a++) {
+					FrameBuffer inBuffer;
+
+					/* band row k holds output scanline o0 + k, which is input scanline i1 - k */
+					for (echan = (ExrChannel *)in[a]->channels.first; echan; echan = echan->next) {
+						inBuffer.insert(echan->name, Slice(Imf::FLOAT, (char *)(echan->rect + (size_t)i1 * width),
+						                                   sizeof(float), -width * sizeof(float)));
+					}
+
+					in[a]->ifile->setFrameBuffer(inBuffer);
+					in[a]->ifile->readPixels(i0, i1);
+				}
+
+				for (ochan = (ExrChannel *)out->channels.first; ochan; ochan = ochan->next) {
+					outBuffer.insert(ochan->name, Slice(Imf::FLOAT, (char *)(ochan->rect - (size_t)o0 * width),
+					                                    sizeof(float), width * sizeof(float)));
+				}
+
+				out->ofile->setFrameBuffer(outBuffer);
+				out->ofile->writePixels(o1 - o0 + 1);
+			}
+		}
+		catch (const std::exception &exc) {
+			std::cerr << "IMB_exr_merge_files: ERROR: " << exc.what() << std::endl;
+			ok = 0;
+		}
+	}
+
+	for (a = 0; a < totinput; a++)
+		if (in[a])
+			IMB_exr_close(in[a]);
+	IMB_exr_close(out);
+
+	if (band)
+		MEM_freeN(band);
+	MEM_freeN(in);
+
+	return ok;
+}
+
 /* ********* */
 
 /* get a substring from the end of the name, separated by '.' */
@@ -1112,6 +1292,32 @@ static const char *exr_rgba_channelname(InputFile *file, const char *chan)
 	return chan;
 }
 
+/* RGBA slices reading into rect, which covers data window dw */
+static void exr_rgba_framebuffer(InputFile *file, FrameBuffer &frameBuffer, float *rect, const Box2i &dw)
+{
+	const int width  = dw.max.x - dw.min.x + 1;
+	const int height = dw.max.y - dw.min.y + 1;
+	int xstride = sizeof(float) * 4;
+	int ystride = -xstride * width;
+	float *first;
+
+	/* inverse correct first pixel for datawindow coordinates (- dw.min.y because of y flip) */
+	first = rect - 4 * (dw.min.x - dw.min.y * width);
+	/* but, since we read y-flipped (negative y stride) we move to last scanline */
+	first += 4 * (height - 1) * width;
+
+	frameBuffer.insert(exr_rgba_channelname(file, "R"),
+	                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+	frameBuffer.insert(exr_rgba_channelname(file, "G"),
+	                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
+	frameBuffer.insert(exr_rgba_channelname(file, "B"),
+	                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
+
+	/* 1.0 is fill value, this still needs to be assigned even when (is_alpha == 0) */
+	frameBuffer.insert(exr_rgba_channelname(file, "A"),
+	                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+}
+
 static int exr_has_zbuffer(InputFile *file)
 {
 	return !(file->header().channels().findChannel("Z") == NULL);
@@ -1154,6 +1360,54 @@ static int exr_is_multilayer(InputFile *file)
 	return 0;
 }
 
+/* finds the combined RGBA pass of the first layer that has one */
+static ExrPass *imb_exr_find_combined_pass(ExrHandle *data)
+{
+	ExrLayer *lay;
+	ExrPass *pass;
+
+	for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
+		pass = (ExrPass *)BLI_findstring(&lay->passes, "Combined", offsetof(ExrPass, name));
+		if (pass && pass->totchan == 4 && pass->rect)
+			return pass;
+	}
+
+	return NULL;
+}
+
+static struct ImBuf *imb_load_openexr_combined(InputFile *file, int width, int height)
+{
+	ExrHandle *handle = imb_exr_begin_read_mem(file, width, height);
+	struct ImBuf *ibuf = NULL;
+	ExrPass *pass;
+
+	if (handle == NULL)
+		return NULL;
+
+	pass = imb_exr_find_combined_pass(handle);
+
+	if (pass) {
+		imb_exr_read_channels_ex(handle, pass);
+
+		ibuf = IMB_allocImBuf(width, height, 32, 0);
+		ibuf->ftype = OPENEXR;
+		ibuf->rect_float = pass->rect;
+		ibuf->flags |= IB_rectfloat;
+		ibuf->mall |= IB_rectfloat;
+		pass->rect = NULL;
+
+		if (hasXDensity(file->header())) {
+			ibuf->ppm[0] = xDensity(file->header()) * 39.3700787f;
+			ibuf->ppm[1] = ibuf->ppm[0] * (double)file->header().pixelAspectRatio();
+		}
+	}
+
+	/* also deletes the file */
+	IMB_exr_close(handle);
+
+	return ibuf;
+}
+
 struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE])
 {
 	struct ImBuf *ibuf = NULL;
@@ -1163,6 +1417,8 @@ struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char
 
 	colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
 
+	imb_exr_thread_count_update();
+
 	try
 	{
 		Mem_IStream *membuf = new Mem_IStream(mem, size);
@@ -1181,9 +1437,19 @@ struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char
 
 		is_multi = exr_is_multilayer(file);
 
-		/* do not make an ibuf when */
+		/* without render result support (sequencer, clips, textures) only
+		 * the RGBA combined pass is needed, read just its channels */
 		if (is_multi && !(flags & IB_test) && !(flags & IB_multilayer)) {
-			printf("Error: can't process EXR multilayer file\n");
+			ibuf = imb_load_openexr_combined(file, width, height);
+
+			/* file is closed with the handle */
+			file = NULL;
+			delete membuf;
+
+			if (ibuf == NULL)
+				printf("Error: can't process EXR multilayer file\n");
+			else if (flags & IB_alphamode_detect)
+				ibuf->flags |= IB_alphamode_premul;
 		}
 		else {
 			const int is_alpha = exr_has_alpha(file);
@@ -1208,27 +1474,10 @@ struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char
 				}
 				else {
 					FrameBuffer frameBuffer;
-					float *first;
-					int xstride = sizeof(float) * 4;
-					int ystride = -xstride * width;
 
 					imb_addrectfloatImBuf(ibuf);
 
-					/* inverse correct first pixel for datawindow coordinates (- dw.min.y because of y flip) */
-					first = ibuf->rect_float - 4 * (dw.min.x - dw.min.y * width);
-					/* but, since we read y-flipped (negative y stride) we move to last scanline */
-					first += 4 * (height - 1) * width;
-
-					frameBuffer.insert(exr_rgba_channelname(file, "R"),
-					                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
-					frameBuffer.insert(exr_rgba_channelname(file, "G"),
-					                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
-					frameBuffer.insert(exr_rgba_channelname(file, "B"),
-					                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
-
-					/* 1.0 is fill value, this still needs to be assigned even when (is_alpha == 0) */
-					frameBuffer.insert(exr_rgba_channelname(file, "A"),
-					                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+					exr_rgba_framebuffer(file, frameBuffer, ibuf->rect_float, dw);
 
 					if (exr_has_zbuffer(file)) {
 						float *firstz;
@@ -1273,11 +1522,86 @@ struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char
 
 }
 
-void imb_initopenexr(void)
+/* Reads a mipmap level of tiled multi-resolution files directly, the smallest
+ * one with larger side still at least min_size. Returns NULL for other files,
+ * these have to be loaded at full resolution with imb_load_openexr. */
+struct ImBuf *imb_load_openexr_level(unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE],
+                                     int min_size, int *r_width, int *r_height)
 {
-	int num_threads = BLI_system_thread_count();
+	struct ImBuf *ibuf = NULL;
+	Mem_IStream *membuf = NULL, *tiled_membuf = NULL;
+	InputFile *file = NULL;
+	TiledInputFile *tiled = NULL;
+
+	if (imb_is_a_openexr(mem) == 0) return(NULL);
+
+	/* multilayer files are handled by render results, only loaded in full */
+	if (flags & (IB_test | IB_multilayer)) return(NULL);
+
+	imb_exr_thread_count_update();
+
+	try
+	{
+		membuf = new Mem_IStream(mem, size);
+		file = new InputFile(*membuf);
+
+		if (file->header().hasTileDescription() &&
+		    file->header().tileDescription().mode != ONE_LEVEL &&
+		    !exr_is_multilayer(file))
+		{
+			Box2i full_dw = file->header().dataWindow();
+			FrameBuffer frameBuffer;
+			int level;
+
+			tiled_membuf = new Mem_IStream(mem, size);
+			tiled = new TiledInputFile(*tiled_membuf);
+
+			/* ripmaps have levels of every aspect, only use the ones of mipmaps */
+			level = (tiled->numXLevels() < tiled->numYLevels() ? tiled->numXLevels() : tiled->numYLevels()) - 1;
+			while (level > 0 && tiled->levelWidth(level) < min_size && tiled->levelHeight(level) < min_size)
+				level--;
+
+			Box2i dw = tiled->dataWindowForLevel(level, level);
+			const int width  = dw.max.x - dw.min.x + 1;
+			const int height = dw.max.y - dw.min.y + 1;
+
+			colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+			ibuf = IMB_allocImBuf(width, height, exr_has_alpha(file) ? 32 : 24, 0);
+			ibuf->ftype = OPENEXR;
 
-	setGlobalThreadCount(num_threads);
+			imb_addrectfloatImBuf(ibuf);
+
+			exr_rgba_framebuffer(file, frameBuffer, ibuf->rect_float, dw);
+
+			tiled->setFrameBuffer(frameBuffer);
+			tiled->readTiles(0, tiled->numXTiles(level) - 1, 0, tiled->numYTiles(level) - 1, level, level);
+
+			if (flags & IB_alphamode_detect)
+				ibuf->flags |= IB_alphamode_premul;
+
+			*r_width = full_dw.max.x - full_dw.min.x + 1;
+			*r_height = full_dw.max.y - full_dw.min.y + 1;
+		}
+	}
+	catch (const std::exception &exc)
+	{
+		std::cerr << exc.what() << std::endl;
+		if (ibuf) IMB_freeImBuf(ibuf);
+		ibuf = NULL;
+	}
+
+	delete tiled;
+	delete tiled_membuf;
+	delete file;
+	delete membuf;
+
+	return(ibuf);
+}
+
+void imb_initopenexr(void)
+{
+	imb_exr_thread_count_update();
 }
 
 } // export "C"
@@ -52,6 +52,9 @@ int		imb_save_openexr			(struct ImBuf *ibuf, const char *name, int flags);
 
 struct ImBuf *imb_load_openexr		(unsigned char *mem, size_t size, int flags, char *colorspace);
 
+struct ImBuf *imb_load_openexr_level	(unsigned char *mem, size_t size, int flags, char *colorspace,
+                                     int min_size, int *r_width, int *r_height);
+
 #ifdef __cplusplus
 }
 #endif
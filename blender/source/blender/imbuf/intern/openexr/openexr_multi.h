@@ -57,6 +57,7 @@ void    IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap,
 void    IMB_exr_set_channel(void *handle, const char *layname, const char *passname, int xstride, int ystride, float *rect);
 
 void    IMB_exr_read_channels(void *handle);
+int     IMB_exr_read_layer_pass(void *handle, const char *layname, const char *passname);
 void    IMB_exr_write_channels(void *handle);
 void    IMB_exrtile_write_channels(void *handle, int partx, int party, int level);
 void    IMB_exrtile_clear_channels(void *handle);
@@ -67,6 +68,8 @@ void    IMB_exr_multilayer_convert(void *handle, void *base,
 
 void    IMB_exr_close(void *handle);
 
+int     IMB_exr_merge_files(const char *filename, const char **inputs, int totinput, int compress);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -43,6 +43,7 @@ void    IMB_exrtile_begin_write     (void *handle, const char *filename, int mip
 void    IMB_exr_set_channel         (void *handle, const char *layname, const char *channame, int xstride, int ystride, float *rect) { (void)handle; (void)layname; (void)channame; (void)xstride; (void)ystride; (void)rect; }
 
 void    IMB_exr_read_channels       (void *handle) { (void)handle; }
+int     IMB_exr_read_layer_pass     (void *handle, const char *layname, const char *passname) { (void)handle; (void)layname; (void)passname; return 0; }
 void    IMB_exr_write_channels      (void *handle) { (void)handle; }
 void    IMB_exrtile_write_channels  (void *handle, int partx, int party, int level) { (void)handle; (void)partx; (void)party; (void)level; }
 void    IMB_exrtile_clear_channels  (void *handle) { (void)handle; }
@@ -55,3 +56,5 @@ void    IMB_exr_multilayer_convert  (void *handle, void *base,
 }
 
 void    IMB_exr_close               (void *handle) { (void)handle; }
+
+int     IMB_exr_merge_files         (const char *filename, const char **inputs, int totinput, int compress) { (void)filename; (void)inputs; (void)totinput; (void)compress; return 0; }
@@ -232,6 +232,54 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
 	return ibuf;
 }
 
+ImBuf *IMB_loadiffname_level(const char *filepath, int flags, char colorspace[IM_MAX_SPACE],
+                             int min_size, int *r_width, int *r_height)
+{
+	ImBuf *ibuf = NULL;
+	ImFileType *type;
+	unsigned char *mem;
+	size_t size;
+	int file;
+	char effective_colorspace[IM_MAX_SPACE] = "";
+
+	if (imb_is_filepath_format(filepath))
+		return NULL;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file < 0) return NULL;
+
+	size = BLI_file_descriptor_size(file);
+
+	mem = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+	if (mem == (unsigned char *) -1) {
+		fprintf(stderr, "%s: couldn't get mapping %s\n", __func__, filepath);
+		close(file);
+		return NULL;
+	}
+
+	if (colorspace)
+		BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+
+	for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
+		if (type->load_level && type->is_a && type->is_a(mem)) {
+			ibuf = type->load_level(mem, size, flags, effective_colorspace, min_size, r_width, r_height);
+			break;
+		}
+	}
+
+	if (ibuf) {
+		imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+		BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
+	}
+
+	if (munmap(mem, size))
+		fprintf(stderr, "%s: couldn't unmap file %s\n", __func__, filepath);
+
+	close(file);
+
+	return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
 	ImBuf *ibuf;
@@ -856,48 +856,99 @@ static int q_scale_linear_interpolation(
 	return TRUE;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+/* Separable scaling passes process every line (a row for passes along x, a column
+ * for passes along y) on its own, so lines of big buffers are split over threads. */
+
+typedef struct ScaleLinesData {
+	ImBuf *ibuf;
+	int newsize;
+	float add;
+
+	uchar *newrect;
+	float *newrectf;
+} ScaleLinesData;
+
+typedef void (*ScaleLinesFunc)(const ScaleLinesData *data, int start_line, int tot_line);
+
+typedef struct ScaleLinesInitData {
+	ScaleLinesFunc func;
+	const ScaleLinesData *data;
+} ScaleLinesInitData;
+
+typedef struct ScaleLinesThread {
+	ScaleLinesFunc func;
+	const ScaleLinesData *data;
+
+	int start_line;
+	int tot_line;
+} ScaleLinesThread;
+
+static void scale_lines_init_handle(void *handle_v, int start_line, int tot_line, void *init_data_v)
 {
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
+	ScaleLinesThread *handle = (ScaleLinesThread *) handle_v;
+	ScaleLinesInitData *init_data = (ScaleLinesInitData *) init_data_v;
 
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
+	handle->func = init_data->func;
+	handle->data = init_data->data;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+	handle->start_line = start_line;
+	handle->tot_line = tot_line;
+}
 
-	if (!do_rect && !do_float) return (ibuf);
+static void *do_scale_lines_thread(void *handle_v)
+{
+	ScaleLinesThread *handle = (ScaleLinesThread *) handle_v;
 
-	if (do_rect) {
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-		if (_newrect == NULL) return(ibuf);
+	handle->func(handle->data, handle->start_line, handle->tot_line);
+
+	return NULL;
+}
+
+static void scale_lines_apply(ScaleLinesFunc func, const ScaleLinesData *data, int tot_lines)
+{
+	ImBuf *ibuf = data->ibuf;
+
+	if ((size_t) ibuf->x * ibuf->y < IMB_THREADED_MIN_PIXELS) {
+		func(data, 0, tot_lines);
 	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
+	else {
+		ScaleLinesInitData init_data;
+
+		init_data.func = func;
+		init_data.data = data;
+
+		IMB_processor_apply_threaded(tot_lines, sizeof(ScaleLinesThread), &init_data,
+		                             scale_lines_init_handle, do_scale_lines_thread);
 	}
+}
 
-	add = (ibuf->x - 0.01) / newx;
+static void scaledownx_lines(const ScaleLinesData *data, int start_line, int tot_line)
+{
+	ImBuf *ibuf = data->ibuf;
+	const int newx = data->newsize;
+	const float add = data->add;
+	const int do_rect = (data->newrect != NULL);
+	const int do_float = (data->newrectf != NULL);
+	const size_t rect_size = (size_t) 4 * ibuf->x * (start_line + tot_line);
+
+	uchar *rect = NULL, *newrect = NULL;
+	float *rectf = NULL, *newrectf = NULL;
+	float sample, val[4], nval[4], valf[4], nvalf[4];
+	int x, y;
+
+	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
+	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
 	if (do_rect) {
-		rect = (uchar *) ibuf->rect;
-		newrect = _newrect;
+		rect = ((uchar *) ibuf->rect) + (size_t) 4 * ibuf->x * start_line;
+		newrect = data->newrect + (size_t) 4 * newx * start_line;
 	}
 	if (do_float) {
-		rectf = ibuf->rect_float;
-		newrectf = _newrectf;
+		rectf = ibuf->rect_float + (size_t) 4 * ibuf->x * start_line;
+		newrectf = data->newrectf + (size_t) 4 * newx * start_line;
 	}
-		
-	for (y = ibuf->y; y > 0; y--) {
+
+	for (y = tot_line; y > 0; y--) {
 		sample = 0.0f;
 		val[0] =  val[1] = val[2] = val[3] = 0.0f;
 		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
@@ -965,68 +1016,80 @@ static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
 		}
 	}
 
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
+	/* see bug [#26502] */
+	BLI_assert(!do_rect || (size_t)(rect - ((uchar *) ibuf->rect)) == rect_size);
+	BLI_assert(!do_float || (size_t)(rectf - ibuf->rect_float) == rect_size);
+	(void)rect_size; /* UNUSED in release builds */
+}
+
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+	ScaleLinesData data = {NULL};
+
+	if (ibuf == NULL) return(NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+
+	data.ibuf = ibuf;
+	data.newsize = newx;
+
+	if (ibuf->rect) {
+		data.newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
+		if (data.newrect == NULL) return(ibuf);
+	}
+	if (ibuf->rect_float) {
+		data.newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
+			return(ibuf);
+		}
+	}
+
+	data.add = (ibuf->x - 0.01) / newx;
+
+	scale_lines_apply(scaledownx_lines, &data, ibuf->y);
+
+	if (data.newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
+	if (data.newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
+
 	ibuf->x = newx;
 	return(ibuf);
 }
 
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+static void scaledowny_lines(const ScaleLinesData *data, int start_line, int tot_line)
 {
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
+	ImBuf *ibuf = data->ibuf;
+	const int newy = data->newsize;
+	const float add = data->add;
+	const int do_rect = (data->newrect != NULL);
+	const int do_float = (data->newrectf != NULL);
+	const size_t rect_size = (size_t) 4 * ibuf->x * ibuf->y;
+	const int skipx = 4 * ibuf->x;
+
+	uchar *rect = NULL, *newrect = NULL;
+	float *rectf = NULL, *newrectf = NULL;
+	float sample, val[4], nval[4], valf[4], nvalf[4];
+	int x, y;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
 	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
 	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
-	if (!do_rect && !do_float) return (ibuf);
-
-	if (do_rect) {
-		_newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->y - 0.01) / newy;
-	skipx = 4 * ibuf->x;
-
-	for (x = skipx - 4; x >= 0; x -= 4) {
+	for (x = start_line; x < start_line + tot_line; x++) {
 		if (do_rect) {
-			rect = ((uchar *) ibuf->rect) + x;
-			newrect = _newrect + x;
+			rect = ((uchar *) ibuf->rect) + 4 * x;
+			newrect = data->newrect + 4 * x;
 		}
 		if (do_float) {
-			rectf = ibuf->rect_float + x;
-			newrectf = _newrectf + x;
+			rectf = ibuf->rect_float + 4 * x;
+			newrectf = data->newrectf + 4 * x;
 		}
 		
 		sample = 0.0f;
@@ -1094,34 +1157,67 @@ static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 			
 			sample -= 1.0f;
 		}
+
+		/* see bug [#26502] */
+		BLI_assert(!do_rect || (size_t)(rect - ((uchar *) ibuf->rect + 4 * x)) == rect_size);
+		BLI_assert(!do_float || (size_t)(rectf - (ibuf->rect_float + 4 * x)) == rect_size);
 	}
+	(void)rect_size; /* UNUSED in release builds */
+}
 
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
+static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+{
+	ScaleLinesData data = {NULL};
+
+	if (ibuf == NULL) return(NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+
+	data.ibuf = ibuf;
+	data.newsize = newy;
+
+	if (ibuf->rect) {
+		data.newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
+		if (data.newrect == NULL) return(ibuf);
+	}
+	if (ibuf->rect_float) {
+		data.newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
+			return(ibuf);
+		}
+	}
+
+	data.add = (ibuf->y - 0.01) / newy;
+
+	scale_lines_apply(scaledowny_lines, &data, ibuf->x);
+
+	if (data.newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
+	if (data.newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
+
 	ibuf->y = newy;
 	return(ibuf);
 }
 
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void scaleupx_lines(const ScaleLinesData *data, int start_line, int tot_line)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
+	ImBuf *ibuf = data->ibuf;
+	const int newx = data->newsize;
+	const float add = data->add;
+	const int do_rect = (data->newrect != NULL);
+	const int do_float = (data->newrectf != NULL);
+
+	uchar *rect = NULL, *newrect = NULL;
+	float *rectf = NULL, *newrectf = NULL;
+	float sample;
 	float val_a, nval_a, diff_a;
 	float val_b, nval_b, diff_b;
 	float val_g, nval_g, diff_g;
@@ -1130,37 +1226,23 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 	float val_bf, nval_bf, diff_bf;
 	float val_gf, nval_gf, diff_gf;
 	float val_rf, nval_rf, diff_rf;
-	int x, y, do_rect = FALSE, do_float = FALSE;
+	int x, y;
 
 	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
 	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
 	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
 	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
-	if (ibuf->rect) {
-		do_rect = TRUE;
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-		if (_newrect == NULL) return(ibuf);
+	if (do_rect) {
+		rect = ((uchar *) ibuf->rect) + (size_t) 4 * ibuf->x * start_line;
+		newrect = data->newrect + (size_t) 4 * newx * start_line;
 	}
-	if (ibuf->rect_float) {
-		do_float = TRUE;
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
+	if (do_float) {
+		rectf = ibuf->rect_float + (size_t) 4 * ibuf->x * start_line;
+		newrectf = data->newrectf + (size_t) 4 * newx * start_line;
 	}
 
-	add = (ibuf->x - 1.001) / (newx - 1.0);
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (y = ibuf->y; y > 0; y--) {
+	for (y = tot_line; y > 0; y--) {
 
 		sample = 0;
 		
@@ -1268,27 +1350,61 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 			sample += add;
 		}
 	}
+}
 
-	if (do_rect) {
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+	ScaleLinesData data = {NULL};
+
+	if (ibuf == NULL) return(NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+
+	data.ibuf = ibuf;
+	data.newsize = newx;
+
+	if (ibuf->rect) {
+		data.newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
+		if (data.newrect == NULL) return(ibuf);
+	}
+	if (ibuf->rect_float) {
+		data.newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
+			return(ibuf);
+		}
+	}
+
+	data.add = (ibuf->x - 1.001) / (newx - 1.0);
+
+	scale_lines_apply(scaleupx_lines, &data, ibuf->y);
+
+	if (data.newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
-	if (do_float) {
+	if (data.newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	
+
 	ibuf->x = newx;
 	return(ibuf);
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static void scaleupy_lines(const ScaleLinesData *data, int start_line, int tot_line)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
+	ImBuf *ibuf = data->ibuf;
+	const int newy = data->newsize;
+	const float add = data->add;
+	const int do_rect = (data->newrect != NULL);
+	const int do_float = (data->newrectf != NULL);
+	const int skipx = 4 * ibuf->x;
+
+	uchar *rect = NULL, *newrect = NULL;
+	float *rectf = NULL, *newrectf = NULL;
+	float sample;
 	float val_a, nval_a, diff_a;
 	float val_b, nval_b, diff_b;
 	float val_g, nval_g, diff_g;
@@ -1297,43 +1413,19 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 	float val_bf, nval_bf, diff_bf;
 	float val_gf, nval_gf, diff_gf;
 	float val_rf, nval_rf, diff_rf;
-	int x, y, do_rect = FALSE, do_float = FALSE, skipx;
+	int x, y;
 
 	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
 	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
 	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
 	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
-
-	if (ibuf->rect) {
-		do_rect = TRUE;
-		_newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (ibuf->rect_float) {
-		do_float = TRUE;
-		_newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->y - 1.001) / (newy - 1.0);
-	skipx = 4 * ibuf->x;
 
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (x = ibuf->x; x > 0; x--) {
+	for (x = start_line; x < start_line + tot_line; x++) {
 
 		sample = 0;
 		if (do_rect) {
-			rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-			newrect = _newrect + 4 * (x - 1);
+			rect = ((uchar *)ibuf->rect) + 4 * x;
+			newrect = data->newrect + 4 * x;
 
 			val_a = rect[0];
 			nval_a = rect[skipx];
@@ -1351,15 +1443,15 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 			val_g += 0.5f;
 
 			val_r = rect[3];
-			nval_r = rect[skipx + 4];
+			nval_r = rect[skipx + 3];
 			diff_r = nval_r - val_r;
 			val_r += 0.5f;
 
 			rect += 2 * skipx;
 		}
 		if (do_float) {
-			rectf = ibuf->rect_float + 4 * (x - 1);
-			newrectf = _newrectf + 4 * (x - 1);
+			rectf = ibuf->rect_float + 4 * x;
+			newrectf = data->newrectf + 4 * x;
 
 			val_af = rectf[0];
 			nval_af = rectf[skipx];
@@ -1442,18 +1534,45 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 			sample += add;
 		}
 	}
+}
 
-	if (do_rect) {
+static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+{
+	ScaleLinesData data = {NULL};
+
+	if (ibuf == NULL) return(NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+
+	data.ibuf = ibuf;
+	data.newsize = newy;
+
+	if (ibuf->rect) {
+		data.newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
+		if (data.newrect == NULL) return(ibuf);
+	}
+	if (ibuf->rect_float) {
+		data.newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
+			return(ibuf);
+		}
+	}
+
+	data.add = (ibuf->y - 1.001) / (newy - 1.0);
+
+	scale_lines_apply(scaleupy_lines, &data, ibuf->x);
+
+	if (data.newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
-	if (do_float) {
+	if (data.newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	
+
 	ibuf->y = newy;
 	return(ibuf);
 }
@@ -271,6 +271,7 @@ ImBuf *IMB_thumb_create(const char *path, ThumbSize size, ThumbSource source, Im
 	char thumb[40];
 	short tsize = 128;
 	short ex, ey;
+	int image_width = 0, image_height = 0;
 	float scaledx, scaledy;
 	struct stat info;
 
@@ -319,15 +320,28 @@ ImBuf *IMB_thumb_create(const char *path, ThumbSize size, ThumbSource source, Im
 						img = IMB_loadblend_thumb(path);
 					}
 					else {
-						img = IMB_loadiffname(path, IB_rect | IB_metadata, NULL);
+						/* files with stored mipmaps don't need to be read in full */
+						img = IMB_loadiffname_level(path, IB_rect | IB_metadata, NULL, tsize, &image_width, &image_height);
+
+						if (img == NULL) {
+							img = IMB_loadiffname(path, IB_rect | IB_metadata, NULL);
+							if (img) {
+								image_width = img->x;
+								image_height = img->y;
+							}
+						}
 					}
 				}
+				else {
+					image_width = img->x;
+					image_height = img->y;
+				}
 
 				if (img != NULL) {
 					BLI_stat(path, &info);
 					BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
-					BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-					BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+					BLI_snprintf(cwidth, sizeof(cwidth), "%d", image_width);
+					BLI_snprintf(cheight, sizeof(cheight), "%d", image_height);
 				}
 			}
 			else if (THB_SOURCE_MOVIE == source) {
@@ -377,6 +377,7 @@ typedef struct ChannelDriver {
 	 */
 	char expression[256];	/* expression to compile for evaluation */
 	void *expr_comp; 		/* PyObject - compiled expression, don't save this */
+	void *expr_simple;		/* DriverSimpleExpr - expression compiled for native evaluation, don't save this */
 	
 	float curval;		/* result of previous evaluation */
 	float influence;	/* influence of driver on result */ // XXX to be implemented... this is like the constraint influence setting
@@ -312,6 +312,12 @@ typedef struct bNodeLink {
 #define NTREE_QUALITY_MEDIUM  1
 #define NTREE_QUALITY_LOW     2
 
+/* tree->edit_resolution */
+#define NTREE_RESOLUTION_FULL     0
+#define NTREE_RESOLUTION_HALF     1
+#define NTREE_RESOLUTION_QUARTER  2
+#define NTREE_RESOLUTION_EIGHTH   3
+
 /* tree->chunksize */
 #define NTREE_CHUNCKSIZE_32 32
 #define NTREE_CHUNCKSIZE_64 64
@@ -343,7 +349,8 @@ typedef struct bNodeTree {
 	int update;						/* update flags */
 	short is_updating;				/* flag to prevent reentrant update calls */
 	short done;						/* generic temporary flag for recursion check (DFS/BFS) */
-	int pad2;
+	short edit_resolution;			/* resolution when editing, the render size is divided by 2^edit_resolution */
+	short pad2;
 	
 	int nodetype DNA_DEPRECATED;	/* specific node type this tree is used for */
 
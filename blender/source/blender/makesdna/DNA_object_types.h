@@ -105,6 +105,15 @@ enum {
 	BOUNDBOX_DIRTY  = (1 << 1),
 };
 
+/* Level of detail, the game engine switches to the mesh of 'source'
+ * once the camera is further away than 'distance' */
+typedef struct LodLevel {
+	struct LodLevel *next, *prev;
+	struct Object *source;
+	float distance;
+	int pad;
+} LodLevel;
+
 typedef struct Object {
 	ID id;
 	struct AnimData *adt;		/* animation data (must be immediately after id for utilities to use it) */ 
@@ -264,7 +273,7 @@ typedef struct Object {
 	struct FluidsimSettings *fluidsimSettings; /* if fluidsim enabled, store additional settings */
 
 	struct DerivedMesh *derivedDeform, *derivedFinal;
-	int *pad;
+	struct ModifierStackCache *modifier_cache;	/* runtime, stack results of expensive modifiers */
 	uint64_t lastDataMask;   /* the custom data layer mask that was last used to calculate derivedDeform and derivedFinal */
 	uint64_t customdata_mask; /* (extra) custom data layer mask to use for creating derivedmesh, set by depsgraph */
 	unsigned int state;			/* bit masks of game controllers that are active */
@@ -281,6 +290,9 @@ typedef struct Object {
 
 	/* Runtime valuated curve-specific data, not stored in the file */
 	struct CurveCache *curve_cache;
+
+	ListBase lodlevels;		/* levels of detail, the first level is the object itself */
+	struct LodLevel *currentlod;	/* runtime, level currently in use */
 } Object;
 
 /* Warning, this is not used anymore because hooks are now modifiers */
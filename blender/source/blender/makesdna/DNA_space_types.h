@@ -972,6 +972,7 @@ typedef enum eSpaceNode_Flag {
 	SNODE_USE_HIDDEN_PREVIEW = (1 << 10),
 	SNODE_NEW_SHADERS = (1 << 11),
 	SNODE_PIN            = (1 << 12),
+	SNODE_SHOW_TIMINGS   = (1 << 13),
 } eSpaceNode_Flag;
 
 /* snode->texfrom */
@@ -469,7 +469,8 @@ typedef struct UserDef {
 	short autokey_mode;		/* autokeying mode */
 	short autokey_flag;		/* flags for autokeying */
 	
-	short text_render, pad9;		/* options for text rendering */
+	short text_render;		/* options for text rendering */
+	short texmemlimit;		/* GL texture memory limit in MB, 0 for no limit */
 
 	struct ColorBand coba_weight;	/* from texture.h */
 
@@ -477,7 +478,7 @@ typedef struct UserDef {
 	float gpencil_new_layer_col[4]; /* default color for newly created Grease Pencil layers */
 
 	short tweak_threshold;
-	short pad3;
+	short lodsize;			/* viewport level of detail, meshes below this size in pixels use a proxy, 0 disables */
 
 	char author[80];	/* author name for file formats supporting it */
 
@@ -486,6 +487,10 @@ typedef struct UserDef {
 	
 	float fcu_inactive_alpha;	/* opacity of inactive F-Curves in F-Curve Editor */
 	float pixelsize;			/* private, set by GHOST, to multiply DPI with */
+
+	char sequencer_disk_cache_dir[768];	/* FILE_MAXDIR length, empty uses the temporary directory */
+	int sequencer_disk_cache_limit;		/* sequencer disk cache size in megabytes, 0 disables it */
+	int pad4;
 } UserDef;
 
 extern UserDef U; /* from blenkernel blender.c */
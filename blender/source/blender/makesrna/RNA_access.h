@@ -72,6 +72,7 @@ extern StructRNA RNA_ArmatureModifier;
 extern StructRNA RNA_ArmatureSensor;
 extern StructRNA RNA_ArrayModifier;
 extern StructRNA RNA_BackgroundImage;
+extern StructRNA RNA_BakePixel;
 extern StructRNA RNA_BevelModifier;
 extern StructRNA RNA_SplinePoint;
 extern StructRNA RNA_BezierSplinePoint;
@@ -337,6 +338,7 @@ extern StructRNA RNA_LineStyleThicknessModifier_DistanceFromCamera;
 extern StructRNA RNA_LineStyleThicknessModifier_DistanceFromObject;
 extern StructRNA RNA_LineStyleThicknessModifier_Material;
 extern StructRNA RNA_LockedTrackConstraint;
+extern StructRNA RNA_LodLevel;
 extern StructRNA RNA_Macro;
 extern StructRNA RNA_MagicTexture;
 extern StructRNA RNA_MarbleTexture;
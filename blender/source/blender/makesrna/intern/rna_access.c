@@ -74,7 +74,11 @@ void RNA_init(void)
 	StructRNA *srna;
 	PropertyRNA *prop;
 
+	BLENDER_RNA.structs_map = BLI_ghash_str_new_ex(__func__, 2048);
+
 	for (srna = BLENDER_RNA.structs.first; srna; srna = srna->cont.next) {
+		BLI_ghash_insert(BLENDER_RNA.structs_map, (void *)srna->identifier, srna);
+
 		if (!srna->cont.prophash) {
 			srna->cont.prophash = BLI_ghash_str_new("RNA_init gh");
 
@@ -99,6 +103,9 @@ void RNA_exit(void)
 	}
 
 	RNA_free(&BLENDER_RNA);
+
+	BLI_ghash_free(BLENDER_RNA.structs_map, NULL, NULL);
+	BLENDER_RNA.structs_map = NULL;
 }
 
 /* Pointer */
@@ -509,6 +516,9 @@ StructRNA *RNA_struct_find(const char *identifier)
 {
 	StructRNA *type;
 	if (identifier) {
+		if (BLENDER_RNA.structs_map)
+			return BLI_ghash_lookup(BLENDER_RNA.structs_map, identifier);
+
 		for (type = BLENDER_RNA.structs.first; type; type = type->cont.next)
 			if (strcmp(type->identifier, identifier) == 0)
 				return type;
@@ -3302,6 +3312,14 @@ static int rna_raw_access(ReportList *reports, PointerRNA *ptr, PropertyRNA *pro
 
 				size = RNA_raw_type_sizeof(out.type) * arraylen;
 
+				/* tightly packed, copy in one go */
+				if (out.stride == size) {
+					if (set) memcpy(outp, inp, (size_t)size * out.len);
+					else memcpy(inp, outp, (size_t)size * out.len);
+
+					return 1;
+				}
+
 				for (a = 0; a < out.len; a++) {
 					if (set) memcpy(outp, inp, size);
 					else memcpy(inp, outp, size);
@@ -3312,9 +3330,32 @@ static int rna_raw_access(ReportList *reports, PointerRNA *ptr, PropertyRNA *pro
 
 				return 1;
 			}
+			/* non-matching raw types (e.g. doubles for float properties),
+			 * still walk the raw array but convert each element */
+			else {
+				RawArray item;
+				double value;
+				int a, j, k = 0;
+
+				item.type = out.type;
+
+				for (a = 0; a < out.len; a++) {
+					item.array = (char *)out.array + (size_t)out.stride * a;
+
+					for (j = 0; j < arraylen; j++, k++) {
+						if (set) {
+							RAW_GET(double, value, in, k);
+							RAW_SET(double, item, j, value);
+						}
+						else {
+							RAW_GET(double, value, item, j);
+							RAW_SET(double, in, k, value);
+						}
+					}
+				}
 
-			/* could also be faster with non-matching types,
-			 * for now we just do slower loop .. */
+				return 1;
+			}
 		}
 	}
 
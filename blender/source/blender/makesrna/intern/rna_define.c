@@ -598,6 +598,25 @@ void RNA_struct_free_extension(StructRNA *srna, ExtensionRNA *ext)
 #endif
 }
 
+/* Keep BlenderRNA.structs_map in sync, the identifier pointer of the struct is used as key,
+ * so the entry must be removed before the identifier changes or gets freed */
+static void rna_brna_structs_add(BlenderRNA *brna, StructRNA *srna)
+{
+	/* operators are defined with an empty identifier, RNA_def_struct_identifier() sets it later */
+	if (brna->structs_map && srna->identifier && srna->identifier[0] != '\0')
+		BLI_ghash_reinsert(brna->structs_map, (void *)srna->identifier, srna, NULL, NULL);
+}
+
+static void rna_brna_structs_remove(BlenderRNA *brna, StructRNA *srna)
+{
+	/* don't remove the entry of another struct using the same identifier */
+	if (brna->structs_map && srna->identifier && srna->identifier[0] != '\0' &&
+	    BLI_ghash_lookup(brna->structs_map, srna->identifier) == srna)
+	{
+		BLI_ghash_remove(brna->structs_map, (void *)srna->identifier, NULL, NULL);
+	}
+}
+
 void RNA_struct_free(BlenderRNA *brna, StructRNA *srna)
 {
 #ifdef RNA_RUNTIME
@@ -605,6 +624,8 @@ void RNA_struct_free(BlenderRNA *brna, StructRNA *srna)
 	PropertyRNA *prop, *nextprop;
 	PropertyRNA *parm, *nextparm;
 
+	rna_brna_structs_remove(brna, srna);
+
 #if 0
 	if (srna->flag & STRUCT_RUNTIME) {
 		if (RNA_struct_py_type_get(srna)) {
@@ -640,7 +661,7 @@ void RNA_struct_free(BlenderRNA *brna, StructRNA *srna)
 			rna_freelinkN(&srna->functions, func);
 	}
 
-	RNA_def_struct_free_pointers(srna);
+	RNA_def_struct_free_pointers(brna, srna);
 
 	if (srna->flag & STRUCT_RUNTIME)
 		rna_freelinkN(&brna->structs, srna);
@@ -748,6 +769,7 @@ StructRNA *RNA_def_struct_ptr(BlenderRNA *brna, const char *identifier, StructRN
 		srna->icon = ICON_DOT;
 
 	rna_addtail(&brna->structs, srna);
+	rna_brna_structs_add(brna, srna);
 
 	if (DefRNA.preprocess) {
 		ds = MEM_callocN(sizeof(StructDefRNA), "StructDefRNA");
@@ -961,14 +983,16 @@ void RNA_def_struct_path_func(StructRNA *srna, const char *path)
 	if (path) srna->path = (StructPathFunc)path;
 }
 
-void RNA_def_struct_identifier(StructRNA *srna, const char *identifier)
+void RNA_def_struct_identifier(BlenderRNA *brna, StructRNA *srna, const char *identifier)
 {
 	if (DefRNA.preprocess) {
 		fprintf(stderr, "%s: only at runtime.\n", __func__);
 		return;
 	}
 
+	rna_brna_structs_remove(brna, srna);
 	srna->identifier = identifier;
+	rna_brna_structs_add(brna, srna);
 }
 
 void RNA_def_struct_ui_text(StructRNA *srna, const char *name, const char *description)
@@ -3194,21 +3218,30 @@ void RNA_enum_item_end(EnumPropertyItem **items, int *totitem)
 /* Memory management */
 
 #ifdef RNA_RUNTIME
-void RNA_def_struct_duplicate_pointers(StructRNA *srna)
+void RNA_def_struct_duplicate_pointers(BlenderRNA *brna, StructRNA *srna)
 {
+	rna_brna_structs_remove(brna, srna);
+
 	if (srna->identifier) srna->identifier = BLI_strdup(srna->identifier);
 	if (srna->name) srna->name = BLI_strdup(srna->name);
 	if (srna->description) srna->description = BLI_strdup(srna->description);
 
 	srna->flag |= STRUCT_FREE_POINTERS;
+
+	rna_brna_structs_add(brna, srna);
 }
 
-void RNA_def_struct_free_pointers(StructRNA *srna)
+void RNA_def_struct_free_pointers(BlenderRNA *brna, StructRNA *srna)
 {
 	if (srna->flag & STRUCT_FREE_POINTERS) {
+		rna_brna_structs_remove(brna, srna);
+
 		if (srna->identifier) MEM_freeN((void *)srna->identifier);
 		if (srna->name) MEM_freeN((void *)srna->name);
 		if (srna->description) MEM_freeN((void *)srna->description);
+
+		/* may be set again, see RNA_def_struct_identifier() */
+		srna->identifier = srna->name = srna->description = NULL;
 	}
 }
 
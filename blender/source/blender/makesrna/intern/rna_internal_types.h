@@ -399,6 +399,8 @@ struct StructRNA {
 
 struct BlenderRNA {
 	ListBase structs;
+	/* identifier -> StructRNA, only at runtime (created by RNA_init) */
+	struct GHash *structs_map;
 };
 
 #define CONTAINER_RNA_ID(cont) (*(const char **)(((ContainerRNA *)(cont))+1))
@@ -90,6 +90,14 @@ static EnumPropertyItem node_quality_items[] = {
 	{0, NULL, 0, NULL, NULL}
 };
 
+static EnumPropertyItem node_resolution_items[] = {
+	{NTREE_RESOLUTION_FULL,    "FULL",    0, "Full",    "Full resolution"},
+	{NTREE_RESOLUTION_HALF,    "HALF",    0, "1/2",     "Half resolution"},
+	{NTREE_RESOLUTION_QUARTER, "QUARTER", 0, "1/4",     "Quarter resolution"},
+	{NTREE_RESOLUTION_EIGHTH,  "EIGHTH",  0, "1/8",     "Eighth resolution"},
+	{0, NULL, 0, NULL, NULL}
+};
+
 static EnumPropertyItem node_chunksize_items[] = {
 	{NTREE_CHUNCKSIZE_32,   "32",     0,    "32x32",     "Chunksize of 32x32"},
 	{NTREE_CHUNCKSIZE_64,   "64",     0,    "64x64",     "Chunksize of 64x64"},
@@ -7506,6 +7514,12 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_enum_items(prop, node_quality_items);
 	RNA_def_property_ui_text(prop, "Edit Quality", "Quality when editing");
 
+	prop = RNA_def_property(srna, "edit_resolution", PROP_ENUM, PROP_NONE);
+	RNA_def_property_enum_sdna(prop, NULL, "edit_resolution");
+	RNA_def_property_enum_items(prop, node_resolution_items);
+	RNA_def_property_ui_text(prop, "Edit Resolution",
+	                         "Resolution when editing, lower resolutions give faster feedback on large images");
+
 	prop = RNA_def_property(srna, "chunk_size", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "chunksize");
 	RNA_def_property_enum_items(prop, node_chunksize_items);
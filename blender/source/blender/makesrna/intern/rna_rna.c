@@ -996,8 +996,21 @@ static int rna_BlenderRNA_structs_lookup_int(PointerRNA *ptr, int index, Pointer
 }
 static int rna_BlenderRNA_structs_lookup_string(PointerRNA *ptr, const char *key, PointerRNA *r_ptr)
 {
-	StructRNA *srna = ((BlenderRNA *)ptr->data)->structs.first;
-	for (; srna; srna = srna->cont.next) {
+	BlenderRNA *brna = ptr->data;
+	StructRNA *srna;
+
+	if (brna->structs_map) {
+		srna = BLI_ghash_lookup(brna->structs_map, key);
+
+		if (srna) {
+			RNA_pointer_create(NULL, &RNA_Struct, srna, r_ptr);
+			return TRUE;
+		}
+
+		return FALSE;
+	}
+
+	for (srna = brna->structs.first; srna; srna = srna->cont.next) {
 		if (key[0] == srna->identifier[0] && strcmp(key, srna->identifier) == 0) {
 			RNA_pointer_create(NULL, &RNA_Struct, srna, r_ptr);
 			return TRUE;
@@ -3568,6 +3568,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
 	RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+	prop = RNA_def_property(srna, "sequencer_disk_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "sequencer_disk_cache_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 1024 * 256, 1024, -1);
+	RNA_def_property_ui_text(prop, "Disk Cache Limit",
+	                         "Disk space used to keep sequencer frames evicted from the memory cache, "
+	                         "0 disables the disk cache (in megabytes)");
+
 	prop = RNA_def_property(srna, "frame_server_port", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "frameserverport");
 	RNA_def_property_range(prop, 0, 32727);
@@ -3637,6 +3645,21 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Texture Collection Rate",
 	                         "Number of seconds between each run of the GL texture garbage collector");
 
+	prop = RNA_def_property(srna, "texture_memory_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "texmemlimit");
+	RNA_def_property_range(prop, 0, 32767);
+	RNA_def_property_ui_text(prop, "Texture Memory Limit",
+	                         "Maximum GL memory in megabytes used by image textures, the least recently used "
+	                         "ones are freed when it's exceeded (0 for no limit)");
+
+	prop = RNA_def_property(srna, "viewport_lod_size", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "lodsize");
+	RNA_def_property_range(prop, 0, 1000);
+	RNA_def_property_ui_text(prop, "Viewport LOD Size",
+	                         "Draw meshes smaller than this many pixels in object mode from a decimated copy "
+	                         "built in the background (0 to disable)");
+	RNA_def_property_update(prop, 0, "rna_userdef_update");
+
 	prop = RNA_def_property(srna, "window_draw_method", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "wmdrawmethod");
 	RNA_def_property_enum_items(prop, draw_method_items);
@@ -4008,6 +4031,12 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Temporary Directory", "The directory for storing temporary save files");
 	RNA_def_property_update(prop, 0, "rna_userdef_temp_update");
 
+	prop = RNA_def_property(srna, "sequencer_cache_directory", PROP_STRING, PROP_DIRPATH);
+	RNA_def_property_string_sdna(prop, NULL, "sequencer_disk_cache_dir");
+	RNA_def_property_ui_text(prop, "Sequencer Cache Directory",
+	                         "The directory for storing sequencer frames evicted from the memory cache, "
+	                         "uses the temporary directory when empty");
+
 	prop = RNA_def_property(srna, "image_editor", PROP_STRING, PROP_FILEPATH);
 	RNA_def_property_string_sdna(prop, NULL, "image_editor");
 	RNA_def_property_ui_text(prop, "Image Editor", "Path to an image editor");
@@ -328,12 +328,84 @@ static void merge_first_last(BMesh *bm,
 	BMO_op_finish(bm, &find_op);
 }
 
+/* Without merging and caps the copies don't interact, so the result can be written
+ * directly, avoiding the conversion to BMesh and a duplicate operator per copy. */
+static DerivedMesh *arrayModifier_doArray_direct(DerivedMesh *dm, float offset[4][4], int count)
+{
+	DerivedMesh *result;
+	const int totvert = dm->getNumVerts(dm);
+	const int totedge = dm->getNumEdges(dm);
+	const int totloop = dm->getNumLoops(dm);
+	const int totpoly = dm->getNumPolys(dm);
+	MVert *mvert;
+	MEdge *medge;
+	MLoop *mloop;
+	MPoly *mpoly;
+	float current_offset[4][4];
+	int c, i;
+
+	result = CDDM_from_template(dm, totvert * count, totedge * count, 0, totloop * count, totpoly * count);
+
+	mvert = CDDM_get_verts(result);
+	medge = CDDM_get_edges(result);
+	mloop = CDDM_get_loops(result);
+	mpoly = CDDM_get_polys(result);
+
+	/* the source isn't necessarily a CDDM, so get the base layers through the callbacks */
+	dm->copyVertArray(dm, mvert);
+	dm->copyEdgeArray(dm, medge);
+	dm->copyLoopArray(dm, mloop);
+	dm->copyPolyArray(dm, mpoly);
+
+	unit_m4(current_offset);
+
+	for (c = 0; c < count; c++) {
+		DM_copy_vert_data(dm, result, 0, c * totvert, totvert);
+		DM_copy_edge_data(dm, result, 0, c * totedge, totedge);
+		DM_copy_loop_data(dm, result, 0, c * totloop, totloop);
+		DM_copy_poly_data(dm, result, 0, c * totpoly, totpoly);
+
+		if (c != 0) {
+			MVert *mv = mvert + c * totvert;
+			MEdge *me = medge + c * totedge;
+			MLoop *ml = mloop + c * totloop;
+			MPoly *mp = mpoly + c * totpoly;
+			float tmp_mat[4][4];
+
+			mul_m4_m4m4(tmp_mat, offset, current_offset);
+			copy_m4_m4(current_offset, tmp_mat);
+
+			memcpy(mv, mvert, sizeof(*mv) * totvert);
+			memcpy(me, medge, sizeof(*me) * totedge);
+			memcpy(ml, mloop, sizeof(*ml) * totloop);
+			memcpy(mp, mpoly, sizeof(*mp) * totpoly);
+
+			for (i = 0; i < totvert; i++, mv++) {
+				mul_m4_v3(current_offset, mv->co);
+			}
+			for (i = 0; i < totedge; i++, me++) {
+				me->v1 += c * totvert;
+				me->v2 += c * totvert;
+			}
+			for (i = 0; i < totloop; i++, ml++) {
+				ml->v += c * totvert;
+				ml->e += c * totedge;
+			}
+			for (i = 0; i < totpoly; i++, mp++) {
+				mp->loopstart += c * totloop;
+			}
+		}
+	}
+
+	return result;
+}
+
 static DerivedMesh *arrayModifier_doArray(ArrayModifierData *amd,
                                           Scene *scene, Object *ob, DerivedMesh *dm,
                                           int UNUSED(initFlags))
 {
 	DerivedMesh *result;
-	BMesh *bm = DM_to_bmesh(dm, false);
+	BMesh *bm;
 	BMOperator first_dupe_op, dupe_op, old_dupe_op, weld_op;
 	BMVert **first_geom = NULL;
 	int i, j;
@@ -425,6 +497,21 @@ static DerivedMesh *arrayModifier_doArray(ArrayModifierData *amd,
 		copy_m4_m4(final_offset, tmp_mat);
 	}
 
+	if (!(amd->flags & MOD_ARR_MERGE) && !start_cap && !end_cap) {
+		result = arrayModifier_doArray_direct(dm, offset, count);
+
+		if ((dm->dirty & DM_DIRTY_NORMALS) ||
+		    ((amd->offset_type & MOD_ARR_OFF_OBJ) && (amd->offset_ob)))
+		{
+			/* Update normals in case offset object has rotation. */
+			result->dirty |= DM_DIRTY_NORMALS;
+		}
+
+		return result;
+	}
+
+	bm = DM_to_bmesh(dm, false);
+
 	/* BMESH_TODO: bumping up the stack level avoids computing the normals
 	 * after every top-level operator execution (and this modifier has the
 	 * potential to execute a *lot* of top-level BMOps. There should be a
@@ -36,12 +36,14 @@
 
 #include "DNA_object_types.h"
 
+#include "BLI_math.h"
 #include "BLI_utildefines.h"
 
 #include "BLF_translation.h"
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_modifier.h"
+#include "BKE_object.h"
 
 #include "depsgraph_private.h"
 
@@ -92,7 +94,39 @@ static void updateDepgraph(ModifierData *md, DagForest *forest,
 }
 
 #ifdef WITH_MOD_BOOLEAN
-static DerivedMesh *get_quick_derivedMesh(DerivedMesh *derivedData, DerivedMesh *dm, int operation)
+/* world space bounds of a derived mesh */
+static void dm_minmax_world(DerivedMesh *dm, float obmat[4][4], float r_min[3], float r_max[3])
+{
+	BoundBox bb;
+	float min[3], max[3];
+	int i;
+
+	INIT_MINMAX(min, max);
+	dm->getMinMax(dm, min, max);
+	BKE_boundbox_init_from_minmax(&bb, min, max);
+
+	INIT_MINMAX(r_min, r_max);
+	for (i = 0; i < 8; i++) {
+		float co[3];
+		mul_v3_m4v3(co, obmat, bb.vec[i]);
+		minmax_v3v3_v3(r_min, r_max, co);
+	}
+}
+
+/* the objects can't intersect if their bounds don't, touching bounds still count */
+static bool dm_bounds_overlap(DerivedMesh *dm_a, Object *ob_a, DerivedMesh *dm_b, Object *ob_b)
+{
+	float min_a[3], max_a[3], min_b[3], max_b[3];
+
+	dm_minmax_world(dm_a, ob_a->obmat, min_a, max_a);
+	dm_minmax_world(dm_b, ob_b->obmat, min_b, max_b);
+
+	return (min_a[0] <= max_b[0] && min_a[1] <= max_b[1] && min_a[2] <= max_b[2] &&
+	        min_b[0] <= max_a[0] && min_b[1] <= max_a[1] && min_b[2] <= max_a[2]);
+}
+
+static DerivedMesh *get_quick_derivedMesh(DerivedMesh *derivedData, Object *ob,
+                                          DerivedMesh *dm, Object *ob_operand, int operation)
 {
 	DerivedMesh *result = NULL;
 
@@ -113,6 +147,16 @@ static DerivedMesh *get_quick_derivedMesh(DerivedMesh *derivedData, DerivedMesh
 				break;
 		}
 	}
+	else if (ELEM(operation, eBooleanModifierOp_Intersect, eBooleanModifierOp_Difference) &&
+	         !dm_bounds_overlap(derivedData, ob, dm, ob_operand))
+	{
+		/* disjoint operands, skip converting both meshes for carve,
+		 * union still goes through carve to merge the meshes and their data layers */
+		if (operation == eBooleanModifierOp_Intersect)
+			result = CDDM_new(0, 0, 0, 0, 0);
+		else
+			result = derivedData;
+	}
 
 	return result;
 }
@@ -150,10 +194,10 @@ static DerivedMesh *applyModifier(ModifierData *md, Object *ob,
 	if (dm) {
 		DerivedMesh *result;
 
-		/* when one of objects is empty (has got no faces) we could speed up
-		 * calculation a bit returning one of objects' derived meshes (or empty one)
-		 * Returning mesh is depended on modifiers operation (sergey) */
-		result = get_quick_derivedMesh(derivedData, dm, bmd->operation);
+		/* when one of objects is empty (has got no faces) or the objects don't overlap
+		 * we could speed up calculation a bit returning one of objects' derived meshes
+		 * (or empty one). Returning mesh is depended on modifiers operation (sergey) */
+		result = get_quick_derivedMesh(derivedData, ob, dm, bmd->object, bmd->operation);
 
 		if (result == NULL) {
 
@@ -323,9 +323,7 @@ static void cuboid_do(
 			}
 		}
 		else {
-			for (i = 0; i < numVerts; i++) {
-				minmax_v3v3_v3(min, max, vertexCos[i]);
-			}
+			minmax_v3_array(min, max, (const float (*)[3])vertexCos, numVerts);
 		}
 
 		/* we want a symmetric bound box around the origin */
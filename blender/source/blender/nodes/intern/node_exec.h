@@ -35,6 +35,7 @@
 
 #include "DNA_listBase.h"
 
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_node.h"
@@ -66,6 +67,7 @@ typedef struct bNodeTreeExec {
 	struct bNodeStack *stack;		/* socket data stack */
 	/* only used by material and texture trees to keep one stack for each thread */
 	ListBase *threadstack;			/* one instance of the stack for each thread */
+	SpinLock threadstack_lock;		/* texture trees only, callers may share a thread index */
 } bNodeTreeExec;
 
 /* stores one stack copy for each thread (material and texture trees) */
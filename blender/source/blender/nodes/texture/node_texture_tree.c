@@ -215,6 +215,7 @@ bNodeTreeExec *ntreeTexBeginExecTree_internal(bNodeExecContext *context, bNodeTr
 	
 	/* allocate the thread stack listbase array */
 	exec->threadstack = MEM_callocN(BLENDER_MAX_THREADS * sizeof(ListBase), "thread stack array");
+	BLI_spin_init(&exec->threadstack_lock);
 	
 	for (node = exec->nodetree->nodes.first; node; node = node->next)
 		node->need_exec = 1;
@@ -275,6 +276,7 @@ void ntreeTexEndExecTree_internal(bNodeTreeExec *exec)
 		
 		MEM_freeN(exec->threadstack);
 		exec->threadstack = NULL;
+		BLI_spin_end(&exec->threadstack_lock);
 	}
 	
 	ntree_exec_end(exec);
@@ -334,9 +336,18 @@ int ntreeTexExecTree(
 		exec = nodes->execdata;
 	}
 	
+	/* brushes and modifiers evaluate from several threads at once, all passing
+	 * thread 0, so taking a stack from the list has to be locked. Each caller
+	 * still gets its own stack and runs the nodes without holding the lock */
+	BLI_spin_lock(&exec->threadstack_lock);
 	nts = ntreeGetThreadStack(exec, thread);
+	BLI_spin_unlock(&exec->threadstack_lock);
+
 	ntreeExecThreadNodes(exec, nts, &data, thread);
+
+	BLI_spin_lock(&exec->threadstack_lock);
 	ntreeReleaseThreadStack(nts);
+	BLI_spin_unlock(&exec->threadstack_lock);
 
 	if (texres->nor) retval |= TEX_NOR;
 	retval |= TEX_RGB;
@@ -146,13 +146,17 @@ static void group_execute(void *data, int thread, struct bNode *node, bNodeExecD
 			inode->need_exec = 1;
 	}
 	
+	BLI_spin_lock(&exec->threadstack_lock);
 	nts = ntreeGetThreadStack(exec, thread);
+	BLI_spin_unlock(&exec->threadstack_lock);
 	
 	group_copy_inputs(node, in, nts->stack);
 	ntreeExecThreadNodes(exec, nts, data, thread);
 	group_copy_outputs(node, out, nts->stack);
 	
+	BLI_spin_lock(&exec->threadstack_lock);
 	ntreeReleaseThreadStack(nts);
+	BLI_spin_unlock(&exec->threadstack_lock);
 }
 
 void register_node_type_tex_group(void)
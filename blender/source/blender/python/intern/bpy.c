@@ -212,6 +212,64 @@ static PyObject *bpy_resource_path(PyObject *UNUSED(self), PyObject *args, PyObj
 	return PyUnicode_DecodeFSDefault(path ? path : "");
 }
 
+PyDoc_STRVAR(bpy_memory_serial_doc,
+".. function:: memory_serial()\n"
+"\n"
+"   Return the number of memory allocations made so far,\n"
+"   pass it to :func:`memory_stats` later to see what was allocated since.\n"
+"\n"
+"   :return: the allocation serial, always 0 unless started with --debug-memory.\n"
+"   :rtype: int\n"
+);
+static PyObject *bpy_memory_serial(PyObject *UNUSED(self))
+{
+	return PyLong_FromSize_t(MEM_get_memory_serial());
+}
+
+static void bpy_memory_stats_cb(void *userdata, const MEM_StatsEntry *entry)
+{
+	PyObject *list = userdata;
+	PyObject *item = Py_BuildValue("(sInInn)",
+	                               entry->name,
+	                               entry->items, (Py_ssize_t)entry->len,
+	                               entry->items_new, (Py_ssize_t)entry->len_new,
+	                               (Py_ssize_t)entry->age_max);
+	PyList_Append(list, item);
+	Py_DECREF(item);
+}
+
+PyDoc_STRVAR(bpy_memory_stats_doc,
+".. function:: memory_stats(since=0)\n"
+"\n"
+"   Return memory in use grouped by allocation name, largest first.\n"
+"   Memory pool and arena chunks are named after the function that created them.\n"
+"\n"
+"   :arg since: an allocation serial from :func:`memory_serial`,\n"
+"      blocks allocated after it are counted separately as new.\n"
+"   :type since: int\n"
+"   :return: (name, blocks, bytes, new_blocks, new_bytes, age) tuples, where age is the number of\n"
+"      allocations made since the oldest block, or None unless started with --debug-memory.\n"
+"   :rtype: list\n"
+);
+static PyObject *bpy_memory_stats(PyObject *UNUSED(self), PyObject *args, PyObject *kw)
+{
+	Py_ssize_t since = 0;
+	static const char *kwlist[] = {"since", NULL};
+	PyObject *list;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kw, "|n:memory_stats", (char **)kwlist, &since))
+		return NULL;
+
+	list = PyList_New(0);
+
+	if (!MEM_get_memory_stats((size_t)MAX2(since, 0), bpy_memory_stats_cb, list)) {
+		Py_DECREF(list);
+		Py_RETURN_NONE;
+	}
+
+	return list;
+}
+
 static PyMethodDef meth_bpy_script_paths =
 	{"script_paths", (PyCFunction)bpy_script_paths, METH_NOARGS, bpy_script_paths_doc};
 static PyMethodDef meth_bpy_blend_paths =
@@ -220,6 +278,10 @@ static PyMethodDef meth_bpy_user_resource =
 	{"user_resource", (PyCFunction)bpy_user_resource, METH_VARARGS | METH_KEYWORDS, NULL};
 static PyMethodDef meth_bpy_resource_path =
 	{"resource_path", (PyCFunction)bpy_resource_path, METH_VARARGS | METH_KEYWORDS, bpy_resource_path_doc};
+static PyMethodDef meth_bpy_memory_serial =
+	{"memory_serial", (PyCFunction)bpy_memory_serial, METH_NOARGS, bpy_memory_serial_doc};
+static PyMethodDef meth_bpy_memory_stats =
+	{"memory_stats", (PyCFunction)bpy_memory_stats, METH_VARARGS | METH_KEYWORDS, bpy_memory_stats_doc};
 
 
 static PyObject *bpy_import_test(const char *modname)
@@ -307,6 +369,8 @@ void BPy_init_modules(void)
 	PyModule_AddObject(mod, meth_bpy_blend_paths.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_blend_paths, NULL));
 	PyModule_AddObject(mod, meth_bpy_user_resource.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_user_resource, NULL));
 	PyModule_AddObject(mod, meth_bpy_resource_path.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_resource_path, NULL));
+	PyModule_AddObject(mod, meth_bpy_memory_serial.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_memory_serial, NULL));
+	PyModule_AddObject(mod, meth_bpy_memory_stats.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_memory_stats, NULL));
 
 	/* register funcs (bpy_rna.c) */
 	PyModule_AddObject(mod, meth_bpy_register_class.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_register_class, NULL));
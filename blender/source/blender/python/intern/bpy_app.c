@@ -42,10 +42,14 @@
 #include "bpy_driver.h"
 
 #include "BLI_utildefines.h"
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 
 #include "BKE_blender.h"
 #include "BKE_global.h"
+#include "BKE_update_timing.h"
+
+#include "GPU_draw_timing.h"
 #include "structseq.h"
 
 #include "../generic/py_capi_utils.h"
@@ -257,6 +261,47 @@ static PyObject *bpy_app_driver_dict_get(PyObject *UNUSED(self), void *UNUSED(cl
 	return bpy_pydriver_Dict;
 }
 
+PyDoc_STRVAR(bpy_app_update_timing_doc,
+"List of (type, owner, name, seconds) tuples, evaluation times of the last scene update, "
+"slowest first, recorded while debug_update_timing is enabled (read-only)"
+);
+static PyObject *bpy_app_update_timing_get(PyObject *UNUSED(self), void *UNUSED(closure))
+{
+	ListBase *entries = BKE_update_timing_entries();
+	UpdateTimingEntry *entry;
+	PyObject *list = PyList_New(BLI_countlist(entries));
+	int i = 0;
+
+	for (entry = entries->first; entry; entry = entry->next, i++) {
+		PyList_SET_ITEM(list, i, Py_BuildValue("(sssd)",
+		                                       BKE_update_timing_type_name(entry->type),
+		                                       entry->owner, entry->name, entry->time));
+	}
+
+	return list;
+}
+
+PyDoc_STRVAR(bpy_app_draw_timing_doc,
+"List of (phase, cpu_seconds, gpu_seconds) tuples of the last 3D view draw, "
+"recorded while debug_draw_timing is enabled, gpu_seconds is -1 without timer query support (read-only)"
+);
+static PyObject *bpy_app_draw_timing_get(PyObject *UNUSED(self), void *UNUSED(closure))
+{
+	double cpu[GPU_DRAW_TIMING_TOT], gpu[GPU_DRAW_TIMING_TOT];
+	PyObject *list;
+	int i;
+
+	if (!GPU_draw_timing_get(NULL, cpu, gpu))
+		return PyList_New(0);
+
+	list = PyList_New(GPU_DRAW_TIMING_TOT);
+	for (i = 0; i < GPU_DRAW_TIMING_TOT; i++) {
+		PyList_SET_ITEM(list, i, Py_BuildValue("(sdd)", GPU_draw_timing_phase_name(i), cpu[i], gpu[i]));
+	}
+
+	return list;
+}
+
 static PyObject *bpy_app_autoexec_fail_message_get(PyObject *UNUSED(self), void *UNUSED(closure))
 {
 	return PyC_UnicodeFromByte(G.autoexec_fail);
@@ -271,10 +316,14 @@ static PyGetSetDef bpy_app_getsets[] = {
 	{(char *)"debug_events",    bpy_app_debug_get, bpy_app_debug_set, (char *)bpy_app_debug_doc, (void *)G_DEBUG_EVENTS},
 	{(char *)"debug_handlers",  bpy_app_debug_get, bpy_app_debug_set, (char *)bpy_app_debug_doc, (void *)G_DEBUG_HANDLERS},
 	{(char *)"debug_wm",        bpy_app_debug_get, bpy_app_debug_set, (char *)bpy_app_debug_doc, (void *)G_DEBUG_WM},
+	{(char *)"debug_update_timing", bpy_app_debug_get, bpy_app_debug_set, (char *)bpy_app_debug_doc, (void *)G_DEBUG_UPDATE_TIMING},
+	{(char *)"debug_draw_timing", bpy_app_debug_get, bpy_app_debug_set, (char *)bpy_app_debug_doc, (void *)G_DEBUG_DRAW_TIMING},
 
 	{(char *)"debug_value", bpy_app_debug_value_get, bpy_app_debug_value_set, (char *)bpy_app_debug_value_doc, NULL},
 	{(char *)"tempdir", bpy_app_tempdir_get, NULL, (char *)bpy_app_tempdir_doc, NULL},
 	{(char *)"driver_namespace", bpy_app_driver_dict_get, NULL, (char *)bpy_app_driver_dict_doc, NULL},
+	{(char *)"update_timing", bpy_app_update_timing_get, NULL, (char *)bpy_app_update_timing_doc, NULL},
+	{(char *)"draw_timing", bpy_app_draw_timing_get, NULL, (char *)bpy_app_draw_timing_doc, NULL},
 
 	/* security */
 	{(char *)"autoexec_fail", bpy_app_global_flag_get, NULL, NULL, (void *)G_SCRIPT_AUTOEXEC_FAIL},
@@ -4375,14 +4375,25 @@ static int foreach_parse_args(BPy_PropertyRNA *self, PyObject *args,
 		return -1;
 	}
 
-	if (!PySequence_Check(*seq) && PyObject_CheckBuffer(*seq)) {
+	if (!PySequence_Check(*seq) && !PyObject_CheckBuffer(*seq)) {
 		PyErr_Format(PyExc_TypeError,
 		             "foreach_get/set expected second argument to be a sequence or buffer, not a %.200s",
 		             Py_TYPE(*seq)->tp_name);
 		return -1;
 	}
 
-	*tot = PySequence_Size(*seq); /* TODO - buffer may not be a sequence! array.array() is tho. */
+	if (PyObject_CheckBuffer(*seq)) {
+		/* use the element count, multi-dimensional buffers (NumPy arrays) aren't flattened by the sequence API */
+		Py_buffer buf;
+		if (PyObject_GetBuffer(*seq, &buf, PyBUF_STRIDES | PyBUF_FORMAT) == -1) {
+			return -1;
+		}
+		*tot = (buf.itemsize > 0) ? (int)(buf.len / buf.itemsize) : 0;
+		PyBuffer_Release(&buf);
+	}
+	else {
+		*tot = PySequence_Size(*seq);
+	}
 
 	if (*tot > 0) {
 		if (!foreach_attr_type(self, *attr, raw_type, attr_tot, attr_signed)) {
@@ -4424,6 +4435,31 @@ static int foreach_parse_args(BPy_PropertyRNA *self, PyObject *args,
 	return 0;
 }
 
+/* raw type of a buffer's elements, so RNA can convert non-matching buffers without going through Python */
+static RawPropertyType foreach_buffer_raw_type(const char *format, Py_ssize_t itemsize)
+{
+	char f = format ? *format : 'B'; /* B is assumed when not set */
+
+	if (ELEM(f, '@', '=')) {
+		f = format[1];
+	}
+
+	switch (f) {
+		case 'b': case 'B': case '?':
+			return (itemsize == sizeof(char)) ? PROP_RAW_CHAR : PROP_RAW_UNSET;
+		case 'h': case 'H':
+			return (itemsize == sizeof(short)) ? PROP_RAW_SHORT : PROP_RAW_UNSET;
+		case 'i': case 'I': case 'l': case 'L':
+			return (itemsize == sizeof(int)) ? PROP_RAW_INT : PROP_RAW_UNSET;
+		case 'f':
+			return (itemsize == sizeof(float)) ? PROP_RAW_FLOAT : PROP_RAW_UNSET;
+		case 'd':
+			return (itemsize == sizeof(double)) ? PROP_RAW_DOUBLE : PROP_RAW_UNSET;
+	}
+
+	return PROP_RAW_UNSET;
+}
+
 static bool foreach_compat_buffer(RawPropertyType raw_type, int attr_signed, const char *format)
 {
 	char f = format ? *format : 'B'; /* B is assumed when not set */
@@ -4475,17 +4511,22 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 		buffer_is_compat = false;
 		if (PyObject_CheckBuffer(seq)) {
 			Py_buffer buf;
-			PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT);
-
-			/* check if the buffer matches */
-
-			buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
+			if (PyObject_GetBuffer(seq, &buf, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+				/* check if the buffer matches, otherwise let RNA convert from the buffer's own type */
+				RawPropertyType buf_type = foreach_compat_buffer(raw_type, attr_signed, buf.format) ?
+				                           raw_type : foreach_buffer_raw_type(buf.format, buf.itemsize);
+
+				if (buf_type != PROP_RAW_UNSET) {
+					buffer_is_compat = true;
+					ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, buf_type, tot);
+				}
 
-			if (buffer_is_compat) {
-				ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
+				PyBuffer_Release(&buf);
+			}
+			else {
+				/* not contiguous, fallback to sequence */
+				PyErr_Clear();
 			}
-
-			PyBuffer_Release(&buf);
 		}
 
 		/* could not use the buffer, fallback to sequence */
@@ -4526,17 +4567,22 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 		buffer_is_compat = false;
 		if (PyObject_CheckBuffer(seq)) {
 			Py_buffer buf;
-			PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT);
-
-			/* check if the buffer matches, TODO - signed/unsigned types */
-
-			buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
+			if (PyObject_GetBuffer(seq, &buf, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) == 0) {
+				/* check if the buffer matches, otherwise let RNA convert to the buffer's own type */
+				RawPropertyType buf_type = foreach_compat_buffer(raw_type, attr_signed, buf.format) ?
+				                           raw_type : foreach_buffer_raw_type(buf.format, buf.itemsize);
+
+				if (buf_type != PROP_RAW_UNSET) {
+					buffer_is_compat = true;
+					ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, buf_type, tot);
+				}
 
-			if (buffer_is_compat) {
-				ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
+				PyBuffer_Release(&buf);
+			}
+			else {
+				/* read-only or not contiguous, fallback to sequence */
+				PyErr_Clear();
 			}
-
-			PyBuffer_Release(&buf);
 		}
 
 		/* could not use the buffer, fallback to sequence */
@@ -4600,6 +4646,8 @@ PyDoc_STRVAR(pyrna_prop_collection_foreach_get_doc,
 ".. method:: foreach_get(attr, seq)\n"
 "\n"
 "   This is a function to give fast access to attributes within a collection.\n"
+"   Contiguous writable buffers (``array.array``, NumPy arrays of any shape) of\n"
+"   int, float or double items are filled directly, without a Python object per item.\n"
 );
 static PyObject *pyrna_prop_collection_foreach_get(BPy_PropertyRNA *self, PyObject *args)
 {
@@ -4612,6 +4660,8 @@ PyDoc_STRVAR(pyrna_prop_collection_foreach_set_doc,
 ".. method:: foreach_set(attr, seq)\n"
 "\n"
 "   This is a function to give fast access to attributes within a collection.\n"
+"   Contiguous buffers (``array.array``, NumPy arrays of any shape) of int, float\n"
+"   or double items are read directly, without a Python object per item.\n"
 );
 static PyObject *pyrna_prop_collection_foreach_set(BPy_PropertyRNA *self, PyObject *args)
 {
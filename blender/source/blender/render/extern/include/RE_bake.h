@@ -0,0 +1,58 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2013 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file RE_bake.h
+ *  \ingroup render
+ */
+
+#ifndef __RE_BAKE_H__
+#define __RE_BAKE_H__
+
+struct DerivedMesh;
+struct Image;
+struct ImBuf;
+
+/* Texel of an image to bake with an external render engine, as a point on
+ * a triangle of the render mesh. Triangles are numbered in the order render
+ * engines that split quads export them, -1 for texels not covered by any
+ * face. The barycentric coordinates are the weights of the first and second
+ * vertex of the triangle. */
+typedef struct BakePixel {
+	int primitive_id;
+	float uv[2];
+} BakePixel;
+
+/* bake_api.c */
+int RE_bake_pass_type_from_mode(const int bake_mode);
+
+void RE_bake_pixels_populate(struct DerivedMesh *dm, struct BakePixel pixel_array[],
+                             const int width, const int height, struct Image *image);
+
+void RE_bake_ibuf_write(struct ImBuf *ibuf, struct BakePixel pixel_array[], float *result,
+                        const int pass_type, const int margin);
+
+#endif /* __RE_BAKE_H__ */
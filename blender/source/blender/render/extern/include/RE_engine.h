@@ -36,8 +36,10 @@
 #include "DNA_scene_types.h"
 #include "RNA_types.h"
 
+struct BakePixel;
 struct bNode;
 struct bNodeTree;
+struct Main;
 struct Object;
 struct Render;
 struct RenderData;
@@ -85,6 +87,8 @@ typedef struct RenderEngineType {
 
 	void (*update)(struct RenderEngine *engine, struct Main *bmain, struct Scene *scene);
 	void (*render)(struct RenderEngine *engine, struct Scene *scene);
+	void (*bake)(struct RenderEngine *engine, struct Scene *scene, struct Object *object, const int pass_type,
+	             struct BakePixel *pixel_array, const int num_pixels, const int depth, void *result);
 
 	void (*view_update)(struct RenderEngine *engine, const struct bContext *context);
 	void (*view_draw)(struct RenderEngine *engine, const struct bContext *context);
@@ -142,6 +146,11 @@ void RE_engine_report(RenderEngine *engine, int type, const char *msg);
 
 int RE_engine_render(struct Render *re, int do_all);
 
+bool RE_engine_has_bake(struct Scene *scene);
+bool RE_engine_bake(struct Render *re, struct Main *bmain, struct Scene *scene, struct Object *object,
+                    const int pass_type, struct BakePixel *pixel_array, const int num_pixels,
+                    const int depth, float result[]);
+
 int RE_engine_is_external(struct Render *re);
 
 /* Engine Types */
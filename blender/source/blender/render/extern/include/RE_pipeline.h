@@ -35,8 +35,11 @@
 #include "DNA_listBase.h"
 #include "DNA_vec_types.h"
 
+struct bMovieHandle;
 struct bNodeTree;
 struct Image;
+struct ImageFormatData;
+struct ImBuf;
 struct Main;
 struct NodeBlurData;
 struct Object;
@@ -209,6 +212,7 @@ void RE_GetViewPlane(struct Render *re, rctf *viewplane, rcti *disprect);
 void RE_Database_FromScene(struct Render *re, struct Main *bmain, struct Scene *scene, unsigned int lay, int use_camera_view);
 void RE_Database_Preprocess(struct Render *re);
 void RE_Database_Free(struct Render *re);
+void RE_Database_FreePersistent(struct Render *re);
 
 /* project dbase again, when viewplane/perspective changed */
 void RE_DataBase_ApplyWindow(struct Render *re);
@@ -239,6 +243,14 @@ void RE_PreviewRender(struct Render *re, struct Main *bmain, struct Scene *scene
 
 int RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
 int RE_WriteRenderResult(struct ReportList *reports, RenderResult *rr, const char *filename, int compress);
+
+/* asynchronous writing of animation frames, queued buffers are owned by the queue */
+bool RE_AsyncWriteBegin(const void *owner, bool is_movie);
+bool RE_AsyncWriteActive(const void *owner);
+void RE_AsyncWriteImage(struct ImBuf *ibuf, const char *name, const struct ImageFormatData *imf);
+void RE_AsyncWriteMovie(struct ImBuf *ibuf, struct bMovieHandle *mh, struct RenderData *rd, int start_frame, int frame);
+bool RE_AsyncWriteFailed(const void *owner);
+bool RE_AsyncWriteEnd(const void *owner, struct ReportList *reports);
 struct RenderResult *RE_MultilayerConvert(void *exrhandle, const char *colorspace, int predivide, int rectx, int recty);
 
 extern const float default_envmap_layout[];
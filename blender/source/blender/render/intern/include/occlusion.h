@@ -43,6 +43,7 @@ struct ObjectRen;
 
 void make_occ_tree(struct Render *re);
 void free_occ(struct Render *re);
+void free_occ_persistent(struct Render *re);
 void sample_occ(struct Render *re, struct ShadeInput *shi);
 
 void cache_occ_samples(struct Render *re, struct RenderPart *pa, struct ShadeSample *ssamp);
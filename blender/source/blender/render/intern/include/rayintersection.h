@@ -43,6 +43,7 @@ struct RayObject;
 /* Ray Hints */
 
 #define RE_RAY_LCTS_MAX_SIZE	256
+#define RE_RAY_PACKET_SIZE		32		/* rays traversed together, one bit each in a mask */
 #define RT_USE_LAST_HIT			/* last shadow hit is reused before raycasting on whole tree */
 //#define RT_USE_HINT			/* last hit object is reused before raycasting on whole tree */
 
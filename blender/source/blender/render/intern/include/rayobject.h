@@ -53,6 +53,11 @@ typedef struct RayObject RayObject;
 
 int RE_rayobject_raycast(RayObject *r, struct Isect *i);
 
+/* Cast a bundle of rays, e.g. the samples of one shading point. Rays are
+ * traversed together in packets of RE_RAY_PACKET_SIZE, r_hit is set per ray
+ * and the number of hits is returned. */
+int RE_rayobject_raycast_n(RayObject *r, struct Isect *isec, int *r_hit, int tot);
+
 /* Acceleration Structures */
 
 RayObject *RE_rayobject_octree_create(int ocres, int size);
@@ -83,6 +83,7 @@ void render_result_exr_file_merge(struct RenderResult *rr, struct RenderResult *
 void render_result_exr_file_path(struct Scene *scene, const char *layname, int sample, char *filepath);
 int render_result_exr_file_read(struct Render *re, int sample);
 int render_result_exr_file_read_path(struct RenderResult *rr, struct RenderLayer *rl_single, const char *filepath);
+int render_result_exr_file_write_stream(struct Render *re, const char *filepath, int compress);
 
 /* Combined Pixel Rect */
 
@@ -111,6 +111,8 @@ typedef struct RenderPart {
 	short sample, nr;				/* sample can be used by zbuffers, nr is partnr */
 	short thread;					/* thread id */
 	
+	float cost;						/* estimated render cost, to pick parts to split */
+	
 	char *clipflag;					/* clipflags for part zbuffering */
 } RenderPart;
 
@@ -205,7 +207,9 @@ struct Render
 
 	/* occlusion tree */
 	void *occlusiontree;
+	void *occlusiontree_persistent;	/* kept for the next frame with persistent data */
 	ListBase strandsurface;
+	struct StrandBins *strandbins;	/* strand segments per screen area, during tile processing */
 	
 	/* use this instead of R.r.cfra */
 	float mblur_offs, field_offs;
@@ -218,6 +222,8 @@ struct Render
 	ListBase lampren;	/* storage, for free */
 	
 	ListBase objecttable;
+	ListBase objectpost;	/* ObjectRenPost, threaded post-processing during conversion */
+	struct GHash *persistent_objects;	/* Object -> ObjectRen kept for the next frame */
 
 	struct ObjectInstanceRen *objectinstance;
 	ListBase instancetable;
@@ -329,6 +335,10 @@ typedef struct ObjectRen {
 
 	float obmat[4][4];	/* only used in convertblender.c, for instancing */
 
+	/* persistent data, object to view space at conversion and its orco */
+	float persmat[4][4];
+	float *persorco;
+
 	/* used on makeraytree */
 	struct RayObject *raytree;
 	struct RayFace *rayfaces;
@@ -470,8 +480,7 @@ typedef struct StrandBuffer {
 typedef struct StrandRen {
 	StrandVert *vert;
 	StrandBuffer *buffer;
-	int totvert, flag;
-	int clip, index;
+	int totvert, index;
 	float orco[3];
 } StrandRen;
 
@@ -621,6 +630,9 @@ typedef struct LampRen {
 #define R_BAKING		64
 #define R_ANIMATION		128
 #define R_NEED_VCOL		256
+#define R_PERSISTENT_OBJECTS	512
+#define R_EXR_STREAM	1024
+#define R_SCENE_UNCHANGED	2048
 
 /* vlakren->flag (vlak = face in dutch) char!!! */
 #define R_SMOOTH		1
@@ -650,6 +662,8 @@ typedef struct LampRen {
 
 /* objectren->flag */
 #define R_INSTANCEABLE		1
+#define R_PERSISTENT		2
+#define R_PERSISTENT_REUSED	4
 
 /* objectinstance->flag */
 #define R_DUPLI_TRANSFORMED	1
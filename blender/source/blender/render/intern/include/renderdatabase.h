@@ -88,6 +88,8 @@ typedef struct StrandTableNode {
 
 /* renderdatabase.c */
 void free_renderdata_tables(struct Render *re);
+void free_renderdata_object(struct ObjectRen *obr);
+void free_renderdata_object_raytree(struct ObjectRen *obr);
 void free_renderdata_vertnodes(struct VertTableNode *vertnodes);
 void free_renderdata_vlaknodes(struct VlakTableNode *vlaknodes);
 
@@ -86,10 +86,16 @@ typedef struct StrandSegment {
 struct StrandShadeCache;
 typedef struct StrandShadeCache StrandShadeCache;
 
+struct StrandBins;
+typedef struct StrandBins StrandBins;
+
 void strand_eval_point(StrandSegment *sseg, StrandPoint *spoint);
 void render_strand_segment(struct Render *re, float winmat[4][4], struct StrandPart *spart, struct ZSpan *zspan, int totzspan, StrandSegment *sseg);
 void strand_minmax(struct StrandRen *strand, float min[3], float max[3], const float width);
 
+struct StrandBins *strand_bins_build(struct Render *re);
+void strand_bins_free(struct StrandBins *bins);
+
 struct StrandSurface *cache_strand_surface(struct Render *re, struct ObjectRen *obr, struct DerivedMesh *dm, float mat[4][4], int timeoffset);
 void free_strand_surface(struct Render *re);
 
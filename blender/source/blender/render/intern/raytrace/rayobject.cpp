@@ -366,12 +366,10 @@ MALWAYS_INLINE int intersect_rayface(RayObject *hit_obj, RayFace *face, Isect *i
 
 /* Intersection */
 
-int RE_rayobject_raycast(RayObject *r, Isect *isec)
+static void rayobject_raycast_init(Isect *isec)
 {
 	int i;
 
-	RE_RC_COUNT(isec->raycounter->raycast.test);
-
 	/* setup vars used on raycast */
 	for (i = 0; i < 3; i++) {
 		isec->idot_axis[i]          = 1.0f / isec->dir[i];
@@ -382,6 +380,13 @@ int RE_rayobject_raycast(RayObject *r, Isect *isec)
 		isec->bv_index[2 * i]       = i + 3 * isec->bv_index[2 * i];
 		isec->bv_index[2 * i + 1]   = i + 3 * isec->bv_index[2 * i + 1];
 	}
+}
+
+int RE_rayobject_raycast(RayObject *r, Isect *isec)
+{
+	RE_RC_COUNT(isec->raycounter->raycast.test);
+
+	rayobject_raycast_init(isec);
 
 #ifdef RT_USE_LAST_HIT	
 	/* last hit heuristic */
@@ -435,6 +440,101 @@ int RE_rayobject_intersect(RayObject *r, Isect *i)
 	}
 }
 
+/* Packet Intersection */
+
+int RE_rayobject_raycast_n(RayObject *r, Isect *isec, int *r_hit, int tot)
+{
+	int a, i, tothit = 0;
+
+	for (a = 0; a < tot; a += RE_RAY_PACKET_SIZE) {
+		Isect *packet = isec + a;
+		int totpacket = min_ii(tot - a, RE_RAY_PACKET_SIZE);
+		unsigned int mask = 0, hit = 0;
+
+		for (i = 0; i < totpacket; i++) {
+			RE_RC_COUNT(packet[i].raycounter->raycast.test);
+
+			rayobject_raycast_init(&packet[i]);
+
+#ifdef RT_USE_LAST_HIT
+			/* last hit heuristic */
+			if (packet[i].mode == RE_RAY_SHADOW && packet[i].last_hit) {
+				RE_RC_COUNT(packet[i].raycounter->rayshadow_last_hit.test);
+
+				if (RE_rayobject_intersect(packet[i].last_hit, &packet[i])) {
+					RE_RC_COUNT(packet[i].raycounter->rayshadow_last_hit.hit);
+					hit |= (1u << i);
+					continue;
+				}
+			}
+#endif
+
+#ifdef RT_USE_HINT
+			packet[i].hit_hint = 0;
+#endif
+			mask |= (1u << i);
+		}
+
+		if (mask)
+			hit |= RE_rayobject_intersect_n(r, packet, mask);
+
+		for (i = 0; i < totpacket; i++) {
+			r_hit[a + i] = (hit & (1u << i)) != 0;
+
+			if (r_hit[a + i]) {
+				RE_RC_COUNT(packet[i].raycounter->raycast.hit);
+
+#ifdef RT_USE_HINT
+				if (mask & (1u << i))
+					packet[i].hint = packet[i].hit_hint;
+#endif
+				tothit++;
+			}
+		}
+	}
+
+	return tothit;
+}
+
+unsigned int RE_rayobject_intersect_n(RayObject *r, Isect *isec, unsigned int mask)
+{
+	unsigned int hit = 0;
+	int i;
+
+	if (RE_rayobject_isRayFace(r)) {
+		RayFace *face = (RayFace *) RE_rayobject_align(r);
+
+		for (i = 0; i < RE_RAY_PACKET_SIZE; i++)
+			if ((mask & (1u << i)) && intersect_rayface(r, face, &isec[i]))
+				hit |= (1u << i);
+	}
+	else if (RE_rayobject_isVlakPrimitive(r)) {
+		/* convert once, shared by all rays of the packet */
+		VlakPrimitive *face = (VlakPrimitive *) RE_rayobject_align(r);
+		RayFace nface;
+		rayface_from_vlak(&nface, face->ob, face->face);
+
+		for (i = 0; i < RE_RAY_PACKET_SIZE; i++)
+			if ((mask & (1u << i)) && intersect_rayface(r, &nface, &isec[i]))
+				hit |= (1u << i);
+	}
+	else if (RE_rayobject_isRayAPI(r)) {
+		r = RE_rayobject_align(r);
+
+		if (r->api->raycast_n)
+			return r->api->raycast_n(r, isec, mask);
+
+		for (i = 0; i < RE_RAY_PACKET_SIZE; i++)
+			if ((mask & (1u << i)) && r->api->raycast(r, &isec[i]))
+				hit |= (1u << i);
+	}
+	else {
+		assert(0);
+	}
+
+	return hit;
+}
+
 /* Building */
 
 void RE_rayobject_add(RayObject *r, RayObject *o)
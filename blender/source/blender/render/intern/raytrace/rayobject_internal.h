@@ -127,6 +127,7 @@ typedef void (*RE_rayobject_free_callback)(RayObject *);
 typedef void (*RE_rayobject_merge_bb_callback)(RayObject *, float min[3], float max[3]);
 typedef float (*RE_rayobject_cost_callback)(RayObject *);
 typedef void (*RE_rayobject_hint_bb_callback)(RayObject *, struct RayHint *, float min[3], float max[3]);
+typedef unsigned int (*RE_rayobject_raycast_n_callback)(RayObject *, struct Isect *, unsigned int mask);
 
 typedef struct RayObjectAPI {
 	RE_rayobject_raycast_callback	raycast;
@@ -136,6 +137,7 @@ typedef struct RayObjectAPI {
 	RE_rayobject_merge_bb_callback	bb;
 	RE_rayobject_cost_callback		cost;
 	RE_rayobject_hint_bb_callback	hint_bb;
+	RE_rayobject_raycast_n_callback	raycast_n;	/* optional, NULL casts the rays one by one */
 } RayObjectAPI;
 
 /*
@@ -150,6 +152,12 @@ float RE_rayobject_cost(RayObject *r);
  */
 int RE_rayobject_intersect(RayObject *r, struct Isect *i);
 
+/*
+ * Packet version of RE_rayobject_intersect, intersects the rays of isec
+ * whose bit is set in mask and returns the mask of rays that hit
+ */
+unsigned int RE_rayobject_intersect_n(RayObject *r, struct Isect *isec, unsigned int mask);
+
 #ifdef __cplusplus
 }
 #endif
@@ -139,6 +139,15 @@ static int intersect(SVBVHTree *obj, Isect *isec)
 		return RE_rayobject_intersect( (RayObject *) obj->root, isec);
 }
 
+template<int StackSize>
+static unsigned int intersect_n(SVBVHTree *obj, Isect *isec, unsigned int mask)
+{
+	if (RE_rayobject_isAligned(obj->root))
+		return svbvh_node_stack_raycast_n<StackSize>(obj->root, isec, mask);
+	else
+		return RE_rayobject_intersect_n((RayObject *)obj->root, isec, mask);
+}
+
 template<class Tree>
 static void bvh_hint_bb(Tree *tree, LCTSHint *hint, float *UNUSED(min), float *UNUSED(max))
 {
@@ -160,7 +169,8 @@ static RayObjectAPI make_api()
 		(RE_rayobject_free_callback)    ((void  (*)(Tree *))       & bvh_free<Tree>),
 		(RE_rayobject_merge_bb_callback)((void  (*)(Tree *, float *, float *)) & bvh_bb<Tree>),
 		(RE_rayobject_cost_callback)    ((float (*)(Tree *))      & bvh_cost<Tree>),
-		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>)
+		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>),
+		(RE_rayobject_raycast_n_callback) ((unsigned int (*)(Tree *, Isect *, unsigned int)) & intersect_n<STACK_SIZE>)
 	};
 	
 	return api;
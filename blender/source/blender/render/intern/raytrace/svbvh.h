@@ -153,6 +153,83 @@ static int svbvh_node_stack_raycast(SVBVHNode *root, Isect *isec)
 	return hit;
 }
 
+/* Packet traversal: every node is fetched once for all rays in the packet
+ * that reach it, each stack entry carries the mask of rays still active in
+ * that subtree. Shadow rays drop out of the packet on their first hit. */
+template<int MAX_STACK_SIZE>
+static unsigned int svbvh_node_stack_raycast_n(SVBVHNode *root, Isect *isec, unsigned int mask)
+{
+	SVBVHNode *stack[MAX_STACK_SIZE], *node;
+	unsigned int stack_mask[MAX_STACK_SIZE];
+	unsigned int hit = 0, shadow = 0, done = 0;
+	int i, stack_pos = 0;
+
+	for (i = 0; i < RE_RAY_PACKET_SIZE; i++)
+		if ((mask & (1u << i)) && isec[i].mode == RE_RAY_SHADOW)
+			shadow |= (1u << i);
+
+	stack[stack_pos] = root;
+	stack_mask[stack_pos++] = mask;
+
+	while (stack_pos) {
+		node = stack[--stack_pos];
+		mask = stack_mask[stack_pos] & ~done;
+
+		if (!mask)
+			continue;
+
+		if (!svbvh_node_is_leaf(node)) {
+			int nchilds = node->nchilds;
+			float *child_bb = node->child_bb;
+			SVBVHNode **child = node->child;
+
+			if (nchilds == 4) {
+				unsigned int child_mask[4] = {0, 0, 0, 0};
+
+				for (i = 0; i < RE_RAY_PACKET_SIZE; i++) {
+					if (mask & (1u << i)) {
+						int res = svbvh_bb_intersect_test_simd4(&isec[i], ((__m128 *) (child_bb)));
+
+						RE_RC_COUNT(isec[i].raycounter->simd_bb.test);
+
+						if (res & 1) child_mask[0] |= (1u << i);
+						if (res & 2) child_mask[1] |= (1u << i);
+						if (res & 4) child_mask[2] |= (1u << i);
+						if (res & 8) child_mask[3] |= (1u << i);
+					}
+				}
+
+				for (int c = 0; c < 4; c++) {
+					if (child_mask[c]) {
+						stack[stack_pos] = child[c];
+						stack_mask[stack_pos++] = child_mask[c];
+					}
+				}
+			}
+			else {
+				for (int c = 0; c < nchilds; c++) {
+					unsigned int cmask = 0;
+
+					for (i = 0; i < RE_RAY_PACKET_SIZE; i++)
+						if ((mask & (1u << i)) && svbvh_bb_intersect_test(&isec[i], (float *)child_bb + 6 * c))
+							cmask |= (1u << i);
+
+					if (cmask) {
+						stack[stack_pos] = child[c];
+						stack_mask[stack_pos++] = cmask;
+					}
+				}
+			}
+		}
+		else {
+			hit |= RE_rayobject_intersect_n((RayObject *)node, isec, mask);
+			done |= hit & shadow;
+		}
+	}
+
+	return hit;
+}
+
 
 template<>
 inline void bvh_node_merge_bb<SVBVHNode>(SVBVHNode *node, float min[3], float max[3])
@@ -0,0 +1,240 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2013 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/render/intern/source/bake_api.c
+ *  \ingroup render
+ *
+ * Baking with external render engines. The texels of an image are mapped to
+ * points on the triangles of the render mesh here, the engine shades all of
+ * them at once and the results are written back into the image.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_image_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_DerivedMesh.h"
+
+#include "IMB_imbuf_types.h"
+#include "IMB_imbuf.h"
+
+#include "RE_bake.h"
+#include "RE_pipeline.h"
+#include "RE_shader_ext.h"
+
+/* local include */
+#include "render_types.h"
+#include "zbuf.h"
+
+typedef struct BakeDataZSpan {
+	BakePixel *pixel_array;
+	int primitive_id;
+	int width;
+	ZSpan zspan;
+} BakeDataZSpan;
+
+int RE_bake_pass_type_from_mode(const int bake_mode)
+{
+	switch (bake_mode) {
+		case RE_BAKE_ALL:
+			return SCE_PASS_COMBINED;
+		case RE_BAKE_AO:
+			return SCE_PASS_AO;
+		case RE_BAKE_NORMALS:
+			return SCE_PASS_NORMAL;
+		case RE_BAKE_TEXTURE:
+			return SCE_PASS_DIFFUSE_COLOR;
+		case RE_BAKE_EMIT:
+			return SCE_PASS_EMIT;
+		default:
+			return 0;
+	}
+}
+
+static void store_bake_pixel(void *handle, int x, int y, float u, float v)
+{
+	BakeDataZSpan *bd = (BakeDataZSpan *)handle;
+	BakePixel *pixel = &bd->pixel_array[y * bd->width + x];
+
+	pixel->primitive_id = bd->primitive_id;
+	pixel->uv[0] = u;
+	pixel->uv[1] = v;
+}
+
+/* quads are split along the other diagonal when the default split would
+ * give a degenerate triangle, same test as the Cycles mesh export */
+static bool is_quad_split_alternate(MVert *mvert, MFace *mface)
+{
+	float e1[3], e2[3], e3[3], c[3];
+
+	sub_v3_v3v3(e1, mvert[mface->v2].co, mvert[mface->v1].co);
+	sub_v3_v3v3(e2, mvert[mface->v3].co, mvert[mface->v1].co);
+	sub_v3_v3v3(e3, mvert[mface->v4].co, mvert[mface->v1].co);
+
+	cross_v3_v3v3(c, e1, e2);
+	if (len_squared_v3(c) == 0.0f)
+		return true;
+
+	cross_v3_v3v3(c, e2, e3);
+	return (len_squared_v3(c) == 0.0f);
+}
+
+static void bake_scanconvert_triangle(BakeDataZSpan *bd, MTFace *mtface, const int a, const int b, const int c,
+                                      const int width, const int height)
+{
+	float vec[3][2];
+	const int index[3] = {a, b, c};
+	int i;
+
+	/* same texel centers as the internal bake */
+	for (i = 0; i < 3; i++) {
+		vec[i][0] = mtface->uv[index[i]][0] * (float)width - (0.5f + 0.001f);
+		vec[i][1] = mtface->uv[index[i]][1] * (float)height - (0.5f + 0.002f);
+	}
+
+	zspan_scanconvert(&bd->zspan, (void *)bd, vec[0], vec[1], vec[2], store_bake_pixel);
+}
+
+void RE_bake_pixels_populate(DerivedMesh *dm, BakePixel pixel_array[],
+                             const int width, const int height, Image *image)
+{
+	BakeDataZSpan bd;
+	MVert *mvert;
+	MFace *mface;
+	MTFace *mtface;
+	int i, totface, num_pixels = width * height;
+	int primitive_id = 0;
+
+	for (i = 0; i < num_pixels; i++) {
+		pixel_array[i].primitive_id = -1;
+		pixel_array[i].uv[0] = 0.0f;
+		pixel_array[i].uv[1] = 0.0f;
+	}
+
+	DM_ensure_tessface(dm);
+
+	mvert = dm->getVertArray(dm);
+	mface = dm->getTessFaceArray(dm);
+	mtface = dm->getTessFaceDataArray(dm, CD_MTFACE);
+	totface = dm->getNumTessFaces(dm);
+
+	if (mtface == NULL)
+		return;
+
+	bd.pixel_array = pixel_array;
+	bd.width = width;
+	zbuf_alloc_span(&bd.zspan, width, height, 1.0f);
+
+	for (i = 0; i < totface; i++, mface++, mtface++) {
+		const bool is_quad = (mface->v4 != 0);
+
+		/* keep primitive ids in sync with the triangles of all faces */
+		if (mtface->tpage != image) {
+			primitive_id += (is_quad) ? 2 : 1;
+			continue;
+		}
+
+		if (!is_quad) {
+			bd.primitive_id = primitive_id++;
+			bake_scanconvert_triangle(&bd, mtface, 0, 1, 2, width, height);
+		}
+		else if (is_quad_split_alternate(mvert, mface)) {
+			bd.primitive_id = primitive_id++;
+			bake_scanconvert_triangle(&bd, mtface, 0, 1, 3, width, height);
+			bd.primitive_id = primitive_id++;
+			bake_scanconvert_triangle(&bd, mtface, 2, 3, 1, width, height);
+		}
+		else {
+			bd.primitive_id = primitive_id++;
+			bake_scanconvert_triangle(&bd, mtface, 0, 1, 2, width, height);
+			bd.primitive_id = primitive_id++;
+			bake_scanconvert_triangle(&bd, mtface, 0, 2, 3, width, height);
+		}
+	}
+
+	zbuf_free_span(&bd.zspan);
+}
+
+void RE_bake_ibuf_write(ImBuf *ibuf, BakePixel pixel_array[], float *result,
+                        const int pass_type, const int margin)
+{
+	const int num_pixels = ibuf->x * ibuf->y;
+	const bool is_normal = (pass_type == SCE_PASS_NORMAL);
+	char *mask = MEM_callocN(sizeof(char) * num_pixels, "Bake Mask");
+	int i;
+
+	for (i = 0; i < num_pixels; i++) {
+		float *col = &result[i * 4];
+
+		if (pixel_array[i].primitive_id == -1)
+			continue;
+
+		mask[i] = FILTER_MASK_USED;
+
+		/* map normals from [-1, 1] to [0, 1] */
+		if (is_normal) {
+			col[0] = col[0] * 0.5f + 0.5f;
+			col[1] = col[1] * 0.5f + 0.5f;
+			col[2] = col[2] * 0.5f + 0.5f;
+		}
+
+		if (ibuf->rect_float) {
+			copy_v4_v4(ibuf->rect_float + i * 4, col);
+		}
+		else {
+			unsigned char *rrgb = (unsigned char *)(ibuf->rect + i);
+			float srgb[4];
+
+			/* normals are data, colors are stored in sRGB */
+			if (is_normal)
+				copy_v3_v3(srgb, col);
+			else
+				linearrgb_to_srgb_v3_v3(srgb, col);
+			srgb[3] = col[3];
+
+			rgba_float_to_uchar(rrgb, srgb);
+		}
+	}
+
+	/* margin and alpha */
+	RE_bake_ibuf_filter(ibuf, mask, margin);
+
+	ibuf->userflags |= IB_BITMAPDIRTY;
+	if (ibuf->rect_float)
+		ibuf->userflags |= IB_RECT_INVALID;
+
+	MEM_freeN(mask);
+}
@@ -42,6 +42,8 @@
 #include "BLI_memarena.h"
 #include "BLI_ghash.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #ifdef WITH_FREESTYLE
 #  include "BLI_edgehash.h"
 #endif
@@ -79,6 +81,7 @@
 #include "BKE_constraint.h"
 #include "BKE_displist.h"
 #include "BKE_deform.h"
+#include "BKE_depsgraph.h"
 #include "BKE_DerivedMesh.h"
 #include "BKE_effect.h"
 #include "BKE_global.h"
@@ -2299,7 +2302,7 @@ static void displace_render_vert(Render *re, ObjectRen *obr, ShadeInput *shi, Ve
 	return;
 }
 
-static void displace_render_face(Render *re, ObjectRen *obr, VlakRen *vlr, float *scale, float mat[4][4], float imat[3][3])
+static void displace_render_face(Render *re, ObjectRen *obr, VlakRen *vlr, float *scale, float mat[4][4], float imat[3][3], int thread)
 {
 	ShadeInput shi;
 
@@ -2316,7 +2319,7 @@ static void displace_render_face(Render *re, ObjectRen *obr, VlakRen *vlr, float
 	shi.obr= obr;
 	shi.vlr= vlr;		/* current render face */
 	shi.mat= vlr->mat;		/* current input material */
-	shi.thread= 0;
+	shi.thread= thread;
 	
 	/* TODO, assign these, displacement with new bumpmap is skipped without - campbell */
 #if 0
@@ -2354,7 +2357,7 @@ static void displace_render_face(Render *re, ObjectRen *obr, VlakRen *vlr, float
 	}
 }
 
-static void do_displacement(Render *re, ObjectRen *obr, float mat[4][4], float imat[3][3])
+static void do_displacement(Render *re, ObjectRen *obr, float mat[4][4], float imat[3][3], int thread)
 {
 	VertRen *vr;
 	VlakRen *vlr;
@@ -2379,7 +2382,7 @@ static void do_displacement(Render *re, ObjectRen *obr, float mat[4][4], float i
 
 	for (i=0; i<obr->totvlak; i++) {
 		vlr=RE_findOrAddVlak(obr, i);
-		displace_render_face(re, obr, vlr, scale, mat, imat);
+		displace_render_face(re, obr, vlr, scale, mat, imat, thread);
 	}
 	
 	/* Recalc vertex normals */
@@ -3230,6 +3233,9 @@ static void init_camera_inside_volumes(Render *re)
 	 * they will be close together. */
 	float co[3] = {0.f, 0.f, -re->clipsta};
 
+	/* build the raytrees for the inside tests in parallel */
+	volume_precache_raytrees(re);
+
 	for (vo= re->volumes.first; vo; vo= vo->next) {
 		for (obi= re->instancetable.first; obi; obi= obi->next) {
 			if (obi->obr == vo->obr) {
@@ -3312,7 +3318,31 @@ static int has_freestyle_edge_mark(EdgeHash *edge_hash, int v1, int v2)
 }
 #endif
 
-static void init_render_mesh(Render *re, ObjectRen *obr, int timeoffset)
+/* Post-processing of a converted object. Once the geometry is created,
+ * displacement, autosmooth, normals, tangents, quad splitting and bounds
+ * only touch the ObjectRen itself, so they are recorded here and run for
+ * all objects in parallel by database_objects_post(). */
+typedef struct ObjectRenPost {
+	struct ObjectRenPost *next, *prev;
+	ObjectRen *obr;
+	int timeoffset;
+
+	/* init_render_mesh */
+	short mesh_post, do_autosmooth, recalc_normals;
+	short need_tangent, need_nmap_tangent;
+	int smoothresh_degr;
+	float mat[4][4], imat[3][3];
+
+	/* finalize_render_object */
+	short do_displace, quad_split;
+	short apply_smoothresh;
+	float smoothresh;
+
+	/* element counts before post-processing, for the render totals */
+	int totvert, totvlak;
+} ObjectRenPost;
+
+static void init_render_mesh(Render *re, ObjectRen *obr, ObjectRenPost *post, int timeoffset)
 {
 	Object *ob= obr->ob;
 	Mesh *me;
@@ -3327,7 +3357,7 @@ static void init_render_mesh(Render *re, ObjectRen *obr, int timeoffset)
 	float *orco = NULL;
 	int need_orco=0, need_stress=0, need_nmap_tangent=0, need_tangent=0, need_origindex=0;
 	int a, a1, ok, vertofs;
-	int end, do_autosmooth = FALSE, totvert = 0;
+	int end, do_autosmooth = FALSE, do_displace = FALSE, totvert = 0;
 	int use_original_normals = FALSE;
 	int recalc_normals = 0;	/* false by default */
 	int negative_scale;
@@ -3386,7 +3416,8 @@ static void init_render_mesh(Render *re, ObjectRen *obr, int timeoffset)
 	do_autosmooth |= (me->flag & ME_AUTOSMOOTH);
 	if (do_autosmooth)
 		timeoffset= 0;
-	if (test_for_displace(re, ob ) )
+	do_displace = test_for_displace(re, ob);
+	if (do_displace)
 		timeoffset= 0;
 	
 	mask= CD_MASK_BAREMESH|CD_MASK_MTFACE|CD_MASK_MCOL;
@@ -3481,9 +3512,14 @@ static void init_render_mesh(Render *re, ObjectRen *obr, int timeoffset)
 			/* store customdata names, because DerivedMesh is freed */
 			RE_set_customdata_names(obr, &dm->faceData);
 
-			/* add tangent layer if we need one */
-			if (need_nmap_tangent!=0 && CustomData_get_layer_index(&dm->faceData, CD_TANGENT) == -1)
+			/* add tangent layer if we need one, unless init_render_mesh_post() recomputes
+			 * the normal map tangents on the render mesh anyway (normals change on displacement
+			 * and autosmooth, need_tangent always goes through calc_vertexnormals) */
+			if (need_nmap_tangent!=0 && need_tangent==0 && do_displace==0 && do_autosmooth==0 &&
+			    CustomData_get_layer_index(&dm->faceData, CD_TANGENT) == -1)
+			{
 				DM_add_tangent_layer(dm);
+			}
 			
 			/* still to do for keys: the correct local texture coordinate */
 
@@ -3708,28 +3744,46 @@ static void init_render_mesh(Render *re, ObjectRen *obr, int timeoffset)
 	}
 	
 	if (!timeoffset) {
+		/* stress modifies the orco array shared by all conversions of
+		 * this object, so it can't be part of the threaded post-process */
 		if (need_stress)
 			calc_edge_stress(re, obr, me);
 
-		if (test_for_displace(re, ob ) ) {
-			recalc_normals= 1;
-			calc_vertexnormals(re, obr, 0, 0);
-			if (do_autosmooth)
-				do_displacement(re, obr, mat, imat);
-			else
-				do_displacement(re, obr, NULL, NULL);
-		}
+		post->mesh_post= TRUE;
+		post->do_displace= do_displace;
+		post->do_autosmooth= do_autosmooth;
+		post->recalc_normals= recalc_normals;
+		post->need_tangent= need_tangent;
+		post->need_nmap_tangent= need_nmap_tangent;
+		post->smoothresh_degr= me->smoothresh;
+		copy_m4_m4(post->mat, mat);
+		copy_m3_m3(post->imat, imat);
+	}
 
-		if (do_autosmooth) {
-			recalc_normals= 1;
-			autosmooth(re, obr, mat, me->smoothresh);
-		}
+	dm->release(dm);
+}
+
+static void init_render_mesh_post(Render *re, ObjectRenPost *post, int thread)
+{
+	ObjectRen *obr= post->obr;
+	int recalc_normals= post->recalc_normals;
 
-		if (recalc_normals!=0 || need_tangent!=0)
-			calc_vertexnormals(re, obr, need_tangent, need_nmap_tangent);
+	if (post->do_displace) {
+		recalc_normals= 1;
+		calc_vertexnormals(re, obr, 0, 0);
+		if (post->do_autosmooth)
+			do_displacement(re, obr, post->mat, post->imat, thread);
+		else
+			do_displacement(re, obr, NULL, NULL, thread);
 	}
 
-	dm->release(dm);
+	if (post->do_autosmooth) {
+		recalc_normals= 1;
+		autosmooth(re, obr, post->mat, post->smoothresh_degr);
+	}
+
+	if (recalc_normals!=0 || post->need_tangent!=0)
+		calc_vertexnormals(re, obr, post->need_tangent, post->need_nmap_tangent);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -4220,7 +4274,7 @@ void init_render_world(Render *re)
 /* ------------------------------------------------------------------------- */
 
 /* prevent phong interpolation for giving ray shadow errors (terminator problem) */
-static void set_phong_threshold(ObjectRen *obr)
+static float set_phong_threshold(ObjectRen *obr)
 {
 //	VertRen *ver;
 	VlakRen *vlr;
@@ -4263,8 +4317,10 @@ static void set_phong_threshold(ObjectRen *obr)
 	
 	if (tot) {
 		thresh/= (float)tot;
-		obr->ob->smoothresh= cosf(0.5f*(float)M_PI-saacos(thresh));
+		return cosf(0.5f*(float)M_PI-saacos(thresh));
 	}
+
+	return 0.0f;
 }
 
 /* per face check if all samples should be taken.
@@ -4505,8 +4561,9 @@ static void check_non_flat_quads(ObjectRen *obr)
 	}
 }
 
-static void finalize_render_object(Render *re, ObjectRen *obr, int timeoffset)
+static void finalize_render_object(Render *re, ObjectRenPost *post, int thread)
 {
+	ObjectRen *obr= post->obr;
 	Object *ob= obr->ob;
 	VertRen *ver= NULL;
 	StrandRen *strand= NULL;
@@ -4518,22 +4575,19 @@ static void finalize_render_object(Render *re, ObjectRen *obr, int timeoffset)
 		/* the exception below is because displace code now is in init_render_mesh call, 
 		 * I will look at means to have autosmooth enabled for all object types
 		 * and have it as general postprocess, like displace */
-		if (ob->type!=OB_MESH && test_for_displace(re, ob))
-			do_displacement(re, obr, NULL, NULL);
+		if (ob->type!=OB_MESH && post->do_displace)
+			do_displacement(re, obr, NULL, NULL, thread);
 	
-		if (!timeoffset) {
+		if (!post->timeoffset) {
 			/* phong normal interpolation can cause error in tracing
-			 * (terminator problem) */
-			ob->smoothresh= 0.0;
+			 * (terminator problem), ob->smoothresh is set after the threads */
+			post->apply_smoothresh= TRUE;
+			post->smoothresh= 0.0f;
 			if ((re->r.mode & R_RAYTRACE) && (re->r.mode & R_SHADOW))
-				set_phong_threshold(obr);
+				post->smoothresh= set_phong_threshold(obr);
 			
-			if (re->flag & R_BAKING && re->r.bake_quad_split != 0) {
-				/* Baking lets us define a quad split order */
-				split_quads(obr, re->r.bake_quad_split);
-			}
-			else if (BKE_object_is_animated(re->scene, ob))
-				split_quads(obr, 1);
+			if (post->quad_split)
+				split_quads(obr, post->quad_split);
 			else {
 				if ((re->r.mode & R_SIMPLIFY && re->r.simplify_flag & R_SIMPLE_NO_TRIANGULATE) == 0)
 					check_non_flat_quads(obr);
@@ -4584,6 +4638,51 @@ static void finalize_render_object(Render *re, ObjectRen *obr, int timeoffset)
 	}
 }
 
+static void database_object_post_task(TaskPool *pool, void *taskdata, int threadid)
+{
+	Render *re= BLI_task_pool_userdata(pool);
+	ObjectRenPost *post= taskdata;
+
+	if (post->mesh_post)
+		init_render_mesh_post(re, post, threadid);
+
+	finalize_render_object(re, post, threadid);
+}
+
+/* run the post-processing of all converted objects, one task per object */
+static void database_objects_post(Render *re)
+{
+	TaskPool *task_pool;
+	ObjectRenPost *post;
+	ObjectRen *obr;
+
+	if (re->objectpost.first && !re->test_break(re->tbh)) {
+		BLI_begin_threaded_malloc();
+
+		task_pool= BLI_task_pool_create(BLI_task_scheduler_get(), re);
+		for (post= re->objectpost.first; post; post= post->next)
+			BLI_task_pool_push(task_pool, database_object_post_task, post, false, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+
+		BLI_end_threaded_malloc();
+
+		/* in conversion order, so the last object wins like before */
+		for (post= re->objectpost.first; post; post= post->next) {
+			obr= post->obr;
+
+			if (post->apply_smoothresh)
+				obr->ob->smoothresh= post->smoothresh;
+
+			/* autosmooth and quad splitting add vertices and faces */
+			re->totvert += obr->totvert - post->totvert;
+			re->totvlak += obr->totvlak - post->totvlak;
+		}
+	}
+
+	BLI_freelistN(&re->objectpost);
+}
+
 /* ------------------------------------------------------------------------- */
 /* Database																	 */
 /* ------------------------------------------------------------------------- */
@@ -4733,6 +4832,7 @@ static void set_dupli_tex_mat(Render *re, ObjectInstanceRen *obi, DupliObject *d
 static void init_render_object_data(Render *re, ObjectRen *obr, int timeoffset)
 {
 	Object *ob= obr->ob;
+	ObjectRenPost *post= MEM_callocN(sizeof(ObjectRenPost), "ObjectRenPost");
 	ParticleSystem *psys;
 	int i;
 
@@ -4759,12 +4859,29 @@ static void init_render_object_data(Render *re, ObjectRen *obr, int timeoffset)
 		else if (ob->type==OB_SURF)
 			init_render_surf(re, obr, timeoffset);
 		else if (ob->type==OB_MESH)
-			init_render_mesh(re, obr, timeoffset);
+			init_render_mesh(re, obr, post, timeoffset);
 		else if (ob->type==OB_MBALL)
 			init_render_mball(re, obr);
 	}
 
-	finalize_render_object(re, obr, timeoffset);
+	post->obr= obr;
+	post->timeoffset= timeoffset;
+	post->totvert= obr->totvert;
+	post->totvlak= obr->totvlak;
+
+	if (ob->type!=OB_MESH)
+		post->do_displace= test_for_displace(re, ob);
+
+	if (!timeoffset && (obr->totvert || obr->totvlak || obr->tothalo || obr->totstrand)) {
+		if (re->flag & R_BAKING && re->r.bake_quad_split != 0) {
+			/* Baking lets us define a quad split order */
+			post->quad_split= re->r.bake_quad_split;
+		}
+		else if (BKE_object_is_animated(re->scene, ob))
+			post->quad_split= 1;
+	}
+
+	BLI_addtail(&re->objectpost, post);
 
 	re->totvert += obr->totvert;
 	re->totvlak += obr->totvlak;
@@ -4772,6 +4889,190 @@ static void init_render_object_data(Render *re, ObjectRen *obr, int timeoffset)
 	re->totstrand += obr->totstrand;
 }
 
+/* ------------------------------------------------------------------------- */
+/* Persistent data															 */
+/* ------------------------------------------------------------------------- */
+
+/* With persistent data, objects that don't change keep their ObjectRen between
+ * the frames of an animation render. The data is in view space of the frame it
+ * was converted in, so a moved object or camera only gets a new instance matrix.
+ * Objects are kept only within one animation, changes made in between renders
+ * are not tracked. */
+
+static int persistent_object_allowed(Render *re, ObjectRen *obr)
+{
+	Object *ob= obr->ob;
+	int a;
+
+	if (obr->par || obr->index || obr->psysindex || (obr->flag & R_INSTANCEABLE))
+		return 0;
+	if (!ELEM4(ob->type, OB_MESH, OB_CURVE, OB_SURF, OB_FONT))
+		return 0;
+	if (ob->particlesystem.first || obr->tothalo || obr->totstrand)
+		return 0;
+
+	/* displacement textures may be animated */
+	if (test_for_displace(re, ob))
+		return 0;
+
+	for (a=1; a<=ob->totcol; a++) {
+		Material *ma= give_render_material(re, ob, a);
+		if (ma && ma->material_type == MA_TYPE_VOLUME)
+			return 0;
+	}
+
+	return 1;
+}
+
+/* recalc flags are left set by the frame update in RE_Database_FromScene */
+static int persistent_object_changed(Object *ob)
+{
+	ID *data= ob->data;
+	int a;
+
+	if (ob->id.flag & LIB_ID_RECALC_DATA)
+		return 1;
+	if (data && (data->flag & (LIB_ID_RECALC|LIB_ID_RECALC_DATA)))
+		return 1;
+
+	for (a=1; a<=ob->totcol; a++) {
+		Material *ma= give_current_material(ob, a);
+
+		if (ma) {
+			if (ma->id.flag & (LIB_ID_RECALC|LIB_ID_RECALC_DATA))
+				return 1;
+			if (ma->nodetree && (ma->nodetree->id.flag & (LIB_ID_RECALC|LIB_ID_RECALC_DATA)))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void persistent_object_free(void *obr_v)
+{
+	ObjectRen *obr= obr_v;
+
+	free_renderdata_object(obr);
+	if (obr->persorco)
+		MEM_freeN(obr->persorco);
+	MEM_freeN(obr);
+}
+
+static void persistent_objects_free(Render *re)
+{
+	if (re->persistent_objects) {
+		BLI_ghash_free(re->persistent_objects, NULL, persistent_object_free);
+		re->persistent_objects= NULL;
+	}
+}
+
+void RE_Database_FreePersistent(Render *re)
+{
+	persistent_objects_free(re);
+	free_occ_persistent(re);
+}
+
+/* nothing but the camera changed since the previous frame, all objects were
+ * reused and no other datablock is tagged. must be called before the recalc
+ * flags are cleared */
+static int persistent_scene_unchanged(Render *re)
+{
+	Main *bmain= re->main;
+	ObjectRen *obr;
+	Object *ob;
+
+	if (re->objecttable.first == NULL)
+		return 0;
+
+	for (obr= re->objecttable.first; obr; obr= obr->next)
+		if ((obr->flag & R_PERSISTENT_REUSED)==0)
+			return 0;
+
+	/* moved objects, lamps and envmap objects included */
+	for (ob= bmain->object.first; ob; ob= ob->id.next)
+		if (ob != re->scene->camera && (ob->id.flag & (LIB_ID_RECALC|LIB_ID_RECALC_DATA)))
+			return 0;
+
+	/* shading datablocks, node trees tag their users too */
+	if (DAG_id_type_tagged(bmain, ID_LA) || DAG_id_type_tagged(bmain, ID_MA) ||
+	    DAG_id_type_tagged(bmain, ID_TE) || DAG_id_type_tagged(bmain, ID_WO) ||
+	    DAG_id_type_tagged(bmain, ID_IM))
+		return 0;
+
+	return 1;
+}
+
+/* move the objects to keep out of the database that is being freed */
+static void persistent_objects_store(Render *re)
+{
+	ObjectRen *obr, *next;
+
+	if ((re->flag & R_PERSISTENT_OBJECTS)==0 || re->test_break(re->tbh))
+		return;
+
+	if (re->persistent_objects == NULL)
+		re->persistent_objects= BLI_ghash_ptr_new("persistent_objects gh");
+
+	for (obr= re->objecttable.first; obr; obr= next) {
+		next= obr->next;
+
+		if ((obr->flag & R_PERSISTENT) && !BLI_ghash_haskey(re->persistent_objects, obr->ob)) {
+			BLI_remlink(&re->objecttable, obr);
+			free_renderdata_object_raytree(obr);
+
+			if (re->orco_hash)
+				obr->persorco= BLI_ghash_popkey(re->orco_hash, obr->ob, NULL);
+
+			BLI_ghash_insert(re->persistent_objects, obr->ob, obr);
+		}
+	}
+}
+
+/* add the ObjectRen kept from the previous frame, returns 0 if the object
+ * needs to be converted again */
+static int persistent_object_reuse(Render *re, Object *ob)
+{
+	ObjectRen *obr;
+	float mat[4][4], imat[4][4], unit[4][4];
+
+	if (re->persistent_objects == NULL)
+		return 0;
+
+	obr= BLI_ghash_popkey(re->persistent_objects, ob, NULL);
+	if (obr == NULL)
+		return 0;
+
+	if (obr->lay != ob->lay || persistent_object_changed(ob)) {
+		persistent_object_free(obr);
+		return 0;
+	}
+
+	BLI_addtail(&re->objecttable, obr);
+	obr->flag |= R_PERSISTENT_REUSED;
+
+	if (obr->persorco) {
+		set_object_orco(re, ob, obr->persorco);
+		obr->persorco= NULL;
+	}
+
+	/* from the view space the object was converted in to the current one */
+	invert_m4_m4(imat, obr->persmat);
+	mul_m4_m4m4(mat, re->viewmat, ob->obmat);
+	mul_m4_m4m4(mat, mat, imat);
+
+	unit_m4(unit);
+	if (compare_m4m4(mat, unit, 1e-6f))
+		RE_addRenderInstance(re, obr, ob, NULL, 0, 0, NULL, ob->lay);
+	else
+		RE_addRenderInstance(re, obr, ob, NULL, 0, 0, mat, ob->lay);
+
+	re->totvert += obr->totvert;
+	re->totvlak += obr->totvlak;
+
+	return 1;
+}
+
 static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *dob, int timeoffset)
 {
 	ObjectRen *obr;
@@ -4796,6 +5097,10 @@ static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *
 			allow_render= 0;
 	}
 
+	/* persistent objects have no particles, so nothing else to add */
+	if ((re->flag & R_PERSISTENT_OBJECTS) && !dob && persistent_object_reuse(re, ob))
+		return;
+
 	/* one render object for the data itself */
 	if (allow_render) {
 		obr= RE_addRenderObject(re, ob, par, index, 0, ob->lay);
@@ -4805,6 +5110,11 @@ static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *
 		}
 		init_render_object_data(re, obr, timeoffset);
 
+		if ((re->flag & R_PERSISTENT_OBJECTS) && !dob && persistent_object_allowed(re, obr)) {
+			obr->flag |= R_PERSISTENT;
+			mul_m4_m4m4(obr->persmat, re->viewmat, ob->obmat);
+		}
+
 		/* only add instance for objects that have not been used for dupli */
 		if (!(ob->transflag & OB_RENDER_DUPLI)) {
 			obi= RE_addRenderInstance(re, obr, ob, par, index, 0, NULL, ob->lay);
@@ -4913,7 +5223,9 @@ void RE_Database_Free(Render *re)
 	BLI_freelistN(&re->lampren);
 	BLI_freelistN(&re->lights);
 
+	persistent_objects_store(re);
 	free_renderdata_tables(re);
+	BLI_freelistN(&re->objectpost);
 
 	/* free orco */
 	free_mesh_orco_hash(re);
@@ -5267,6 +5579,8 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 	for (group= re->main->group.first; group; group=group->id.next)
 		add_group_render_dupli_obs(re, group, nolamps, onlyselected, actob, timeoffset, 0);
 
+	database_objects_post(re);
+
 	if (!re->test_break(re->tbh))
 		RE_makeRenderInstances(re);
 }
@@ -5308,9 +5622,17 @@ void RE_Database_FromScene(Render *re, Main *bmain, Scene *scene, unsigned int l
 	if (re->lay & 0xFF000000)
 		lay &= 0xFF000000;
 	
-	/* applies changes fully */
+	/* keep objects between frames of an animation, not when speed vectors
+	 * compare the databases of other frames */
+	re->flag &= ~(R_PERSISTENT_OBJECTS | R_SCENE_UNCHANGED);
+	if ((re->r.mode & R_PERSISTENT_DATA) && (re->flag & R_ANIMATION) && !(re->flag & R_BAKING))
+		if ((re->r.scemode & (R_NO_FRAME_UPDATE|R_BUTS_PREVIEW|R_VIEWPORT_PREVIEW))==0)
+			if (get_vector_renderlayers(re->scene)==0)
+				re->flag |= R_PERSISTENT_OBJECTS;
+
+	/* applies changes fully, persistent data needs the recalc flags */
 	if ((re->r.scemode & (R_NO_FRAME_UPDATE|R_BUTS_PREVIEW|R_VIEWPORT_PREVIEW))==0)
-		BKE_scene_update_for_newframe(re->main, re->scene, lay);
+		BKE_scene_update_for_newframe_ex(re->main, re->scene, lay, (re->flag & R_PERSISTENT_OBJECTS)==0);
 	
 	/* if no camera, viewmat should have been set! */
 	if (use_camera_view && camera) {
@@ -5345,6 +5667,15 @@ void RE_Database_FromScene(Render *re, Main *bmain, Scene *scene, unsigned int l
 
 	/* MAKE RENDER DATA */
 	database_init_objects(re, lay, 0, 0, NULL, 0);
+
+	if (re->flag & R_PERSISTENT_OBJECTS) {
+		/* objects not rendered in this frame */
+		persistent_objects_free(re);
+
+		if (persistent_scene_unchanged(re))
+			re->flag |= R_SCENE_UNCHANGED;
+		DAG_ids_clear_recalc(re->main);
+	}
 	
 	if (!re->test_break(re->tbh)) {
 		set_material_lightgroups(re);
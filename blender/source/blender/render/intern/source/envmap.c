@@ -35,6 +35,7 @@
 
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -151,8 +152,8 @@ static Render *envmap_render_copy(Render *re, EnvMap *env)
 	envre->r.mode &= ~(R_BORDER | R_PANORAMA | R_ORTHO | R_MBLUR);
 	envre->r.layers.first = envre->r.layers.last = NULL;
 	envre->r.filtertype = 0;
-	envre->r.tilex = envre->r.xsch / 2;
-	envre->r.tiley = envre->r.ysch / 2;
+	/* faces are rendered one after another, split each in enough parts for all threads */
+	envre->r.tilex = envre->r.tiley = max_ii(cuberes / 4, 16);
 	envre->r.size = 100;
 	envre->r.yasp = envre->r.xasp = 1;
 	
@@ -529,6 +530,45 @@ static void render_envmap(Render *re, EnvMap *env)
 
 /* ------------------------------------------------------------------------- */
 
+static void envmap_mipmap_faces(void *userdata, int start, int stop)
+{
+	Tex *tex = userdata;
+	int part;
+
+	for (part = start; part < stop; part++)
+		if (tex->env->cube[part])
+			IMB_makemipmap(tex->env->cube[part], tex->imaflag & TEX_GAUSS_MIP);
+}
+
+/* make the mipmaps of all faces up front, instead of one by one under
+ * the image lock when the first sample in a render thread needs them */
+static void envmap_make_mipmaps(Tex *tex)
+{
+	if (tex->imaflag & TEX_MIPMAP)
+		BLI_task_parallel_range_ex(0, 6, tex, envmap_mipmap_faces, 1);
+}
+
+/* animated envmaps are kept from the previous frame of an animation when
+ * nothing in the scene changed, only the camera, which doesn't affect them */
+static int envmap_reuse(Render *re, EnvMap *env)
+{
+	float orthmat[4][4], mat[4][4], tmat[4][4];
+
+	if ((re->flag & R_SCENE_UNCHANGED) == 0 || env->object == re->scene->camera)
+		return FALSE;
+
+	/* the cube is in object space, only the texture lookup matrix changes */
+	copy_m4_m4(orthmat, env->object->obmat);
+	normalize_m4(orthmat);
+	mul_m4_m4m4(mat, re->viewmat, orthmat);
+	invert_m4_m4(tmat, mat);
+	copy_m3_m4(env->obimat, tmat);
+
+	env->lastframe = re->scene->r.cfra;
+
+	return TRUE;
+}
+
 void make_envmaps(Render *re)
 {
 	Tex *tex;
@@ -571,6 +611,11 @@ void make_envmaps(Render *re)
 								
 								/* set 'recalc' to make sure it does an entire loop of recalcs */
 								
+								/* animated maps are kept for persistent data, see init_render_texture */
+								if (env->ok && env->stype == ENV_ANIM && depth == 0)
+									if (!envmap_reuse(re, env))
+										BKE_free_envmapdata(env);
+								
 								if (env->ok) {
 									/* free when OSA, and old one isn't OSA */
 									if ((re->r.mode & R_OSA) && env->ok == ENV_NORMAL)
@@ -589,6 +634,9 @@ void make_envmaps(Render *re)
 									do_init = TRUE;
 									render_envmap(re, env);
 									
+									if (env->ok)
+										envmap_make_mipmaps(tex);
+									
 									if (depth == env->depth) env->recalc = 0;
 								}
 							}
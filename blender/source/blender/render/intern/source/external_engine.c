@@ -55,6 +55,7 @@
 #include "BPY_extern.h"
 #endif
 
+#include "RE_bake.h"
 #include "RE_engine.h"
 #include "RE_pipeline.h"
 
@@ -392,6 +393,74 @@ RenderData *RE_engine_get_render_data(Render *re)
 	return &re->r;
 }
 
+/* Bake */
+
+bool RE_engine_has_bake(Scene *scene)
+{
+	RenderEngineType *type = RE_engines_find(scene->r.engine);
+	return (type->bake != NULL);
+}
+
+bool RE_engine_bake(Render *re, Main *bmain, Scene *scene, Object *object, const int pass_type,
+                    BakePixel pixel_array[], const int num_pixels, const int depth, float result[])
+{
+	RenderEngineType *type = RE_engines_find(scene->r.engine);
+	RenderEngine *engine;
+	int persistent_data = scene->r.mode & R_PERSISTENT_DATA;
+	int winx = (scene->r.size * scene->r.xsch) / 100;
+	int winy = (scene->r.size * scene->r.ysch) / 100;
+
+	/* verify if we can bake */
+	if (!type->bake)
+		return false;
+
+	RE_InitState(re, NULL, &scene->r, NULL, winx, winy, NULL);
+	re->main = bmain;
+	re->scene = scene;
+	re->lay = scene->lay;
+
+	/* set render info */
+	re->i.cfra = re->scene->r.cfra;
+	BLI_strncpy(re->i.scene_name, re->scene->id.name + 2, sizeof(re->i.scene_name));
+	re->i.totface = re->i.totvert = re->i.totstrand = re->i.totlamp = re->i.tothalo = 0;
+
+	/* render */
+	engine = re->engine;
+
+	if (!engine) {
+		engine = RE_engine_create(type);
+		re->engine = engine;
+	}
+
+	engine->flag |= RE_ENGINE_RENDERING;
+
+	/* TODO: actually link to a parent which shouldn't happen */
+	engine->re = re;
+
+	engine->resolution_x = re->winx;
+	engine->resolution_y = re->winy;
+
+	if (type->update)
+		type->update(engine, bmain, scene);
+
+	type->bake(engine, scene, object, pass_type, pixel_array, num_pixels, depth, result);
+
+	engine->tile_x = 0;
+	engine->tile_y = 0;
+	engine->flag &= ~RE_ENGINE_RENDERING;
+
+	/* re->engine becomes zero if user changed active render engine during render */
+	if (!persistent_data || !re->engine) {
+		RE_engine_free(engine);
+		re->engine = NULL;
+	}
+
+	if (BKE_reports_contain(re->reports, RPT_ERROR))
+		G.is_break = TRUE;
+
+	return true;
+}
+
 /* Render */
 
 static bool render_layer_exclude_animated(Scene *scene, SceneRenderLayer *srl)
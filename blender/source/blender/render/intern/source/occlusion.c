@@ -41,6 +41,7 @@
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -67,6 +68,9 @@
 #define TOTCHILD 8
 #define CACHE_STEP 3
 
+/* nodes up to this depth build their children as parallel tasks */
+#define OCC_BUILD_TASK_DEPTH 2
+
 typedef struct OcclusionCacheSample {
 	float co[3], n[3], ao[3], env[3], indirect[3], intensity, dist2;
 	int x, y, filled;
@@ -114,10 +118,15 @@ typedef struct OcclusionTree {
 	float distfac;
 
 	int dothreadedbuild;
-	int totbuildthread;
 	int doindirect;
 
 	OcclusionCache *cache;
+
+	/* with persistent data, the instances and settings the tree was built
+	 * for, to reuse it in the next frame if nothing changed */
+	struct ObjectRen **persobr;
+	float (*persmat)[4][4];
+	int totpersinstance, totperspass;
 } OcclusionTree;
 
 typedef struct OcclusionThread {
@@ -130,11 +139,12 @@ typedef struct OcclusionThread {
 	int thread;
 } OcclusionThread;
 
-typedef struct OcclusionBuildThread {
+typedef struct OcclusionBuildData {
 	OcclusionTree *tree;
-	int begin, end, depth;
 	OccNode *node;
-} OcclusionBuildThread;
+	int offset[TOTCHILD], count[TOTCHILD];
+	int depth;
+} OcclusionBuildData;
 
 /* ------------------------- Shading --------------------------- */
 
@@ -515,22 +525,25 @@ static void occ_build_8_split(OcclusionTree *tree, int begin, int end, int *offs
 
 static void occ_build_recursive(OcclusionTree *tree, OccNode *node, int begin, int end, int depth);
 
-static void *exec_occ_build(void *data)
+static void occ_build_children(void *userdata, int start, int stop)
 {
-	OcclusionBuildThread *othread = (OcclusionBuildThread *)data;
-
-	occ_build_recursive(othread->tree, othread->node, othread->begin, othread->end, othread->depth);
+	OcclusionBuildData *data = userdata;
+	int b;
 
-	return NULL;
+	for (b = start; b < stop; b++) {
+		if (!(data->node->childflag & (1 << b)) && data->node->child[b].node) {
+			occ_build_recursive(data->tree, data->node->child[b].node,
+			                    data->offset[b], data->offset[b] + data->count[b], data->depth + 1);
+		}
+	}
 }
 
 static void occ_build_recursive(OcclusionTree *tree, OccNode *node, int begin, int end, int depth)
 {
-	ListBase threads;
-	OcclusionBuildThread othreads[BLENDER_MAX_THREADS];
+	OcclusionBuildData data;
 	OccNode *child, tmpnode;
 	/* OccFace *face; */
-	int a, b, totthread = 0, offset[TOTCHILD], count[TOTCHILD];
+	int a, b;
 
 	/* add a new node */
 	node->occlusion = 1.0f;
@@ -545,18 +558,15 @@ static void occ_build_recursive(OcclusionTree *tree, OccNode *node, int begin, i
 	}
 	else {
 		/* order faces */
-		occ_build_8_split(tree, begin, end, offset, count);
-
-		if (depth == 1 && tree->dothreadedbuild)
-			BLI_init_threads(&threads, exec_occ_build, tree->totbuildthread);
+		occ_build_8_split(tree, begin, end, data.offset, data.count);
 
 		for (b = 0; b < TOTCHILD; b++) {
-			if (count[b] == 0) {
+			if (data.count[b] == 0) {
 				node->child[b].node = NULL;
 			}
-			else if (count[b] == 1) {
+			else if (data.count[b] == 1) {
 				/* face= &tree->face[offset[b]]; */
-				node->child[b].face = offset[b];
+				node->child[b].face = data.offset[b];
 				node->childflag |= (1 << b);
 			}
 			else {
@@ -572,23 +582,18 @@ static void occ_build_recursive(OcclusionTree *tree, OccNode *node, int begin, i
 
 				if (tree->dothreadedbuild)
 					BLI_unlock_thread(LOCK_CUSTOM1);
-
-				if (depth == 1 && tree->dothreadedbuild) {
-					othreads[totthread].tree = tree;
-					othreads[totthread].node = child;
-					othreads[totthread].begin = offset[b];
-					othreads[totthread].end = offset[b] + count[b];
-					othreads[totthread].depth = depth + 1;
-					BLI_insert_thread(&threads, &othreads[totthread]);
-					totthread++;
-				}
-				else
-					occ_build_recursive(tree, child, offset[b], offset[b] + count[b], depth + 1);
 			}
 		}
 
-		if (depth == 1 && tree->dothreadedbuild)
-			BLI_end_threads(&threads);
+		/* build the children, in parallel near the root */
+		data.tree = tree;
+		data.node = node;
+		data.depth = depth;
+
+		if (depth <= OCC_BUILD_TASK_DEPTH && tree->dothreadedbuild)
+			BLI_task_parallel_range_ex(0, TOTCHILD, &data, occ_build_children, 1);
+		else
+			occ_build_children(&data, 0, TOTCHILD);
 	}
 
 	/* combine area, position and sh */
@@ -705,8 +710,7 @@ static OcclusionTree *occ_tree_build(Render *re)
 	}
 
 	/* threads */
-	tree->totbuildthread = (re->r.threads > 1 && totface > 10000) ? 8 : 1;
-	tree->dothreadedbuild = (tree->totbuildthread > 1);
+	tree->dothreadedbuild = (re->r.threads > 1 && totface > 10000);
 
 	/* recurse */
 	tree->root = BLI_memarena_alloc(tree->arena, sizeof(OccNode));
@@ -742,6 +746,8 @@ static void occ_free_tree(OcclusionTree *tree)
 		if (tree->cache) MEM_freeN(tree->cache);
 		if (tree->face) MEM_freeN(tree->face);
 		if (tree->rad) MEM_freeN(tree->rad);
+		if (tree->persobr) MEM_freeN(tree->persobr);
+		if (tree->persmat) MEM_freeN(tree->persmat);
 		MEM_freeN(tree);
 	}
 }
@@ -799,10 +805,10 @@ static float occ_form_factor(OccFace *face, float *p, float *n)
 	return contrib;
 }
 
-static void occ_lookup(OcclusionTree *tree, int thread, OccFace *exclude,
+static void occ_lookup(OcclusionTree *tree, OccNode **stack, OccFace *exclude,
                        const float pp[3], const float pn[3], float *occ, float rad[3], float bentn[3])
 {
-	OccNode *node, **stack;
+	OccNode *node;
 	OccFace *face;
 	float resultocc, resultrad[3], v[3], p[3], n[3], co[3], invd2;
 	float distfac, fac, error, d2, weight, emitarea;
@@ -823,7 +829,6 @@ static void occ_lookup(OcclusionTree *tree, int thread, OccFace *exclude,
 	zero_v3(resultrad);
 
 	/* init stack */
-	stack = tree->stack[thread];
 	stack[0] = tree->root;
 	totstack = 1;
 
@@ -920,28 +925,61 @@ static void occ_lookup(OcclusionTree *tree, int thread, OccFace *exclude,
 	if (bentn) normalize_v3(bentn);
 }
 
+/* faces in the bounce and pass loops only read the values of the previous
+ * iteration, so they are computed in parallel */
+typedef struct OcclusionPassData {
+	Render *re;
+	OcclusionTree *tree;
+	float *occ;
+	float (*rad)[3], (*sum)[3];
+} OcclusionPassData;
+
+static OccNode **occ_stack_alloc(OcclusionTree *tree)
+{
+	return MEM_mallocN(sizeof(OccNode *) * TOTCHILD * (tree->maxdepth + 1), "OccStack");
+}
+
+static void occ_compute_bounce_faces(void *userdata, int start, int stop)
+{
+	OcclusionPassData *data = userdata;
+	OcclusionTree *tree = data->tree;
+	float (*rad)[3] = data->rad, co[3], n[3], occ;
+	OccNode **stack = occ_stack_alloc(tree);
+	int i;
+
+	for (i = start; i < stop; i++) {
+		occ_face(&tree->face[i], co, n, NULL);
+		madd_v3_v3fl(co, n, 1e-8f);
+
+		occ_lookup(tree, stack, &tree->face[i], co, n, &occ, rad[i], NULL);
+		rad[i][0] = MAX2(rad[i][0], 0.0f);
+		rad[i][1] = MAX2(rad[i][1], 0.0f);
+		rad[i][2] = MAX2(rad[i][2], 0.0f);
+		add_v3_v3(data->sum[i], rad[i]);
+
+		if (data->re->test_break(data->re->tbh))
+			break;
+	}
+
+	MEM_freeN(stack);
+}
+
 static void occ_compute_bounces(Render *re, OcclusionTree *tree, int totbounce)
 {
-	float (*rad)[3], (*sum)[3], (*tmp)[3], co[3], n[3], occ;
-	int bounce, i;
+	OcclusionPassData data;
+	float (*rad)[3], (*sum)[3], (*tmp)[3];
+	int bounce;
 
 	rad = MEM_callocN(sizeof(float) * 3 * tree->totface, "OcclusionBounceRad");
 	sum = MEM_dupallocN(tree->rad);
 
-	for (bounce = 1; bounce < totbounce; bounce++) {
-		for (i = 0; i < tree->totface; i++) {
-			occ_face(&tree->face[i], co, n, NULL);
-			madd_v3_v3fl(co, n, 1e-8f);
+	data.re = re;
+	data.tree = tree;
+	data.sum = sum;
 
-			occ_lookup(tree, 0, &tree->face[i], co, n, &occ, rad[i], NULL);
-			rad[i][0] = MAX2(rad[i][0], 0.0f);
-			rad[i][1] = MAX2(rad[i][1], 0.0f);
-			rad[i][2] = MAX2(rad[i][2], 0.0f);
-			add_v3_v3(sum[i], rad[i]);
-
-			if (re->test_break(re->tbh))
-				break;
-		}
+	for (bounce = 1; bounce < totbounce; bounce++) {
+		data.rad = rad;
+		BLI_task_parallel_range_ex(0, tree->totface, &data, occ_compute_bounce_faces, 1024);
 
 		if (re->test_break(re->tbh))
 			break;
@@ -961,23 +999,41 @@ static void occ_compute_bounces(Render *re, OcclusionTree *tree, int totbounce)
 		occ_sum_occlusion(tree, tree->root);
 }
 
+static void occ_compute_pass_faces(void *userdata, int start, int stop)
+{
+	OcclusionPassData *data = userdata;
+	OcclusionTree *tree = data->tree;
+	OccNode **stack = occ_stack_alloc(tree);
+	float co[3], n[3];
+	int i;
+
+	for (i = start; i < stop; i++) {
+		occ_face(&tree->face[i], co, n, NULL);
+		negate_v3(n);
+		madd_v3_v3fl(co, n, 1e-8f);
+
+		occ_lookup(tree, stack, &tree->face[i], co, n, &data->occ[i], NULL, NULL);
+		if (data->re->test_break(data->re->tbh))
+			break;
+	}
+
+	MEM_freeN(stack);
+}
+
 static void occ_compute_passes(Render *re, OcclusionTree *tree, int totpass)
 {
-	float *occ, co[3], n[3];
+	OcclusionPassData data;
+	float *occ;
 	int pass, i;
 	
 	occ = MEM_callocN(sizeof(float) * tree->totface, "OcclusionPassOcc");
 
-	for (pass = 0; pass < totpass; pass++) {
-		for (i = 0; i < tree->totface; i++) {
-			occ_face(&tree->face[i], co, n, NULL);
-			negate_v3(n);
-			madd_v3_v3fl(co, n, 1e-8f);
+	data.re = re;
+	data.tree = tree;
+	data.occ = occ;
 
-			occ_lookup(tree, 0, &tree->face[i], co, n, &occ[i], NULL, NULL);
-			if (re->test_break(re->tbh))
-				break;
-		}
+	for (pass = 0; pass < totpass; pass++) {
+		BLI_task_parallel_range_ex(0, tree->totface, &data, occ_compute_pass_faces, 1024);
 
 		if (re->test_break(re->tbh))
 			break;
@@ -1007,7 +1063,7 @@ static void sample_occ_tree(Render *re, OcclusionTree *tree, OccFace *exclude,
 
 	negate_v3_v3(nn, n);
 
-	occ_lookup(tree, thread, exclude, co, nn, &occ, (tree->doindirect) ? rad : NULL, (env && envcolor) ? bn : NULL);
+	occ_lookup(tree, tree->stack[thread], exclude, co, nn, &occ, (tree->doindirect) ? rad : NULL, (env && envcolor) ? bn : NULL);
 
 	correction = re->wrld.ao_approx_correction;
 
@@ -1210,6 +1266,95 @@ static void sample_occ_surface(ShadeInput *shi)
 	}
 }
 
+/* ------------------------- Persistent Data --------------------------- */
+
+/* With persistent data, the tree is kept for the next frame of an animation.
+ * Faces are stored by instance index and the tree is in view space, so it
+ * can only be reused when all instances kept their ObjectRen and matrix,
+ * which means static objects and camera. Indirect lighting depends on the
+ * lamps too and is always computed again. */
+
+static void occ_instance_mat(ObjectInstanceRen *obi, float mat[4][4])
+{
+	if (obi->flag & R_TRANSFORMED)
+		copy_m4_m4(mat, obi->mat);
+	else
+		unit_m4(mat);
+}
+
+static void occ_tree_store_instances(Render *re, OcclusionTree *tree)
+{
+	ObjectInstanceRen *obi;
+	int a;
+
+	tree->totpersinstance = BLI_countlist(&re->instancetable);
+	tree->totperspass = re->wrld.ao_approx_passes;
+	tree->persobr = MEM_mallocN(sizeof(ObjectRen *) * tree->totpersinstance, "OcclusionPersObr");
+	tree->persmat = MEM_mallocN(sizeof(float) * 16 * tree->totpersinstance, "OcclusionPersMat");
+
+	for (a = 0, obi = re->instancetable.first; obi; obi = obi->next, a++) {
+		tree->persobr[a] = obi->obr;
+		occ_instance_mat(obi, tree->persmat[a]);
+	}
+}
+
+static int occ_tree_persistent_valid(Render *re, OcclusionTree *tree)
+{
+	ObjectInstanceRen *obi;
+	float mat[4][4];
+	int a;
+
+	if (re->wrld.ao_indirect_energy > 0.0f && re->wrld.ao_indirect_bounces > 0)
+		return 0;
+	if (tree->error != get_render_aosss_error(&re->r, re->wrld.ao_approx_error))
+		return 0;
+	if (tree->distfac != ((re->wrld.aomode & WO_AODIST) ? re->wrld.aodistfac : 0.0f))
+		return 0;
+	if (tree->totperspass != re->wrld.ao_approx_passes)
+		return 0;
+	if ((tree->cache != NULL) != ((re->wrld.aomode & WO_AOCACHE) != 0))
+		return 0;
+
+	for (a = 0, obi = re->instancetable.first; obi; obi = obi->next, a++) {
+		if (a >= tree->totpersinstance || obi->obr != tree->persobr[a])
+			return 0;
+		/* converted again in this frame, possibly at the same address */
+		if (!(obi->obr->flag & R_PERSISTENT_REUSED))
+			return 0;
+
+		occ_instance_mat(obi, mat);
+		if (!compare_m4m4(mat, tree->persmat[a], 1e-6f))
+			return 0;
+	}
+
+	return (a == tree->totpersinstance);
+}
+
+/* returns the tree of the previous frame if it can be used for this one */
+static OcclusionTree *occ_tree_reuse(Render *re)
+{
+	OcclusionTree *tree = re->occlusiontree_persistent;
+
+	if (tree == NULL)
+		return NULL;
+
+	re->occlusiontree_persistent = NULL;
+
+	if ((re->flag & R_PERSISTENT_OBJECTS) && occ_tree_persistent_valid(re, tree))
+		return tree;
+
+	occ_free_tree(tree);
+	return NULL;
+}
+
+void free_occ_persistent(Render *re)
+{
+	if (re->occlusiontree_persistent) {
+		occ_free_tree(re->occlusiontree_persistent);
+		re->occlusiontree_persistent = NULL;
+	}
+}
+
 /* ------------------------- External Functions --------------------------- */
 
 static void *exec_strandsurface_sample(void *data)
@@ -1262,13 +1407,25 @@ void make_occ_tree(Render *re)
 	re->i.infostr = IFACE_("Occlusion preprocessing");
 	re->stats_draw(re->sdh, &re->i);
 	
-	re->occlusiontree = tree = occ_tree_build(re);
+	tree = occ_tree_reuse(re);
+
+	if (tree == NULL) {
+		tree = occ_tree_build(re);
+
+		if (tree) {
+			if (re->wrld.ao_approx_passes > 0)
+				occ_compute_passes(re, tree, re->wrld.ao_approx_passes);
+			if (tree->doindirect && (re->wrld.mode & WO_INDIRECT_LIGHT))
+				occ_compute_bounces(re, tree, re->wrld.ao_indirect_bounces);
+
+			if ((re->flag & R_PERSISTENT_OBJECTS) && !tree->doindirect)
+				occ_tree_store_instances(re, tree);
+		}
+	}
+
+	re->occlusiontree = tree;
 	
 	if (tree) {
-		if (re->wrld.ao_approx_passes > 0)
-			occ_compute_passes(re, tree, re->wrld.ao_approx_passes);
-		if (tree->doindirect && (re->wrld.mode & WO_INDIRECT_LIGHT))
-			occ_compute_bounces(re, tree, re->wrld.ao_indirect_bounces);
 
 		for (mesh = re->strandsurface.first; mesh; mesh = mesh->next) {
 			if (!mesh->face || !mesh->co || !mesh->ao)
@@ -1350,8 +1507,18 @@ void make_occ_tree(Render *re)
 
 void free_occ(Render *re)
 {
-	if (re->occlusiontree) {
-		occ_free_tree(re->occlusiontree);
+	OcclusionTree *tree = re->occlusiontree;
+
+	if (tree) {
+		/* keep for the next frame, unless the render was cancelled
+		 * during the passes */
+		if (tree->persobr && (re->flag & R_PERSISTENT_OBJECTS) && !re->test_break(re->tbh)) {
+			free_occ_persistent(re);
+			re->occlusiontree_persistent = tree;
+		}
+		else
+			occ_free_tree(tree);
+
 		re->occlusiontree = NULL;
 	}
 }
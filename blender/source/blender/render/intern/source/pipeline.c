@@ -37,6 +37,7 @@
 
 #include "DNA_group_types.h"
 #include "DNA_image_types.h"
+#include "DNA_material_types.h"
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
@@ -62,6 +63,7 @@
 #include "BKE_global.h"
 #include "BKE_image.h"
 #include "BKE_main.h"
+#include "BKE_material.h"
 #include "BKE_node.h"
 #include "BKE_pointcache.h"
 #include "BKE_report.h"
@@ -91,6 +93,7 @@
 #include "initrender.h"
 #include "shadbuf.h"
 #include "pixelblending.h"
+#include "strand.h"
 #include "zbuf.h"
 
 /* render flow
@@ -414,6 +417,7 @@ void RE_FreeRender(Render *re)
 	re->scene = NULL;
 	
 	RE_Database_Free(re);	/* view render can still have full database */
+	RE_Database_FreePersistent(re);
 	free_sample_tables(re);
 	
 	render_result_free(re->result);
@@ -926,6 +930,221 @@ static RenderPart *find_next_part(Render *re, int minx)
 	return best;
 }
 
+/* ********* part scheduling ******** */
+
+/* smallest width or height a part is split into */
+#define PART_SPLIT_MIN_SIZE		16
+
+/* parts queued per thread ahead of the ones rendering */
+#define PART_QUEUE_AHEAD		2
+
+/* relative shading cost of an object, from its materials */
+static float part_object_weight(ObjectRen *obr)
+{
+	float weight = 1.0f;
+	int a;
+
+	if (obr->ob == NULL)
+		return weight;
+
+	for (a = 1; a <= obr->ob->totcol; a++) {
+		Material *ma = give_current_material(obr->ob, a);
+
+		if (ma == NULL)
+			continue;
+
+		if (ma->mode & (MA_RAYMIRROR | MA_RAYTRANSP))
+			weight += 2.0f;
+		if (ma->sss_flag & MA_DIFF_SSS)
+			weight += 1.0f;
+		if (ma->material_type == MA_TYPE_VOLUME)
+			weight += 4.0f;
+	}
+
+	return weight;
+}
+
+/* cheap pre-pass at part resolution: projects the bounds of every object
+ * instance and spreads its faces and material weight over the parts it
+ * covers, on top of a small cost for every pixel */
+static void parts_estimate_cost(Render *re)
+{
+	ObjectInstanceRen *obi;
+	RenderPart *pa;
+	float obwinmat[4][4], vec[4];
+	int a;
+
+	for (pa = re->parts.first; pa; pa = pa->next)
+		pa->cost = 0.25f * (float)(pa->rectx * pa->recty);
+
+	for (obi = re->instancetable.first; obi; obi = obi->next) {
+		ObjectRen *obr = obi->obr;
+		rctf bounds;
+		float weight, faces, area;
+		bool behind = false;
+
+		if (obr->totvlak == 0 && obr->totstrand == 0)
+			continue;
+
+		if (obi->flag & R_TRANSFORMED)
+			mul_m4_m4m4(obwinmat, re->winmat, obi->mat);
+		else
+			copy_m4_m4(obwinmat, re->winmat);
+
+		BLI_rctf_init_minmax(&bounds);
+
+		for (a = 0; a < 8; a++) {
+			float co[2];
+
+			vec[0] = (a & 1) ? obr->boundbox[0][0] : obr->boundbox[1][0];
+			vec[1] = (a & 2) ? obr->boundbox[0][1] : obr->boundbox[1][1];
+			vec[2] = (a & 4) ? obr->boundbox[0][2] : obr->boundbox[1][2];
+			vec[3] = 1.0f;
+			mul_m4_v4(obwinmat, vec);
+
+			if (vec[3] <= FLT_EPSILON) {
+				behind = true;
+				break;
+			}
+
+			co[0] = 0.5f * re->winx * (1.0f + vec[0] / vec[3]);
+			co[1] = 0.5f * re->winy * (1.0f + vec[1] / vec[3]);
+			BLI_rctf_do_minmax_v(&bounds, co);
+		}
+
+		/* crossing the camera plane, assume it covers everything */
+		if (behind)
+			BLI_rctf_init(&bounds, 0.0f, (float)re->winx, 0.0f, (float)re->winy);
+
+		area = max_ff(BLI_rctf_size_x(&bounds) * BLI_rctf_size_y(&bounds), 1.0f);
+		weight = part_object_weight(obr);
+		faces = (float)(obr->totvlak + obr->totstrand);
+
+		for (pa = re->parts.first; pa; pa = pa->next) {
+			rctf rect, isect;
+
+			BLI_rctf_init(&rect, pa->disprect.xmin, pa->disprect.xmax, pa->disprect.ymin, pa->disprect.ymax);
+
+			if (BLI_rctf_isect(&rect, &bounds, &isect)) {
+				float overlap = BLI_rctf_size_x(&isect) * BLI_rctf_size_y(&isect);
+				pa->cost += overlap * weight + faces * (overlap / area);
+			}
+		}
+	}
+}
+
+static bool part_is_pending(Render *re, RenderPart *pa, int minx)
+{
+	if (pa->status != PART_STATUS_NONE || pa->nr != 0)
+		return false;
+
+	/* panorama renders one column of parts at a time */
+	if ((re->r.mode & R_PANORAMA) && pa->disprect.xmin != minx)
+		return false;
+
+	return true;
+}
+
+/* split a part that is not queued yet in two halves, along its longest side.
+ * panorama parts keep their width, it defines the camera rotation */
+static bool split_part(Render *re, RenderPart *pa)
+{
+	RenderPart *npa;
+	rcti rect = pa->disprect;
+	int sizex, sizey;
+
+	/* remove crop, it is added again to both halves */
+	rect.xmin += pa->crop;
+	rect.ymin += pa->crop;
+	rect.xmax -= pa->crop;
+	rect.ymax -= pa->crop;
+
+	sizex = BLI_rcti_size_x(&rect);
+	sizey = BLI_rcti_size_y(&rect);
+
+	npa = MEM_callocN(sizeof(RenderPart), "new part");
+	npa->crop = pa->crop;
+	npa->disprect = rect;
+
+	if (sizex >= sizey && !(re->r.mode & R_PANORAMA)) {
+		if (sizex < 2 * PART_SPLIT_MIN_SIZE) {
+			MEM_freeN(npa);
+			return false;
+		}
+		rect.xmax = npa->disprect.xmin = rect.xmin + sizex / 2;
+	}
+	else {
+		if (sizey < 2 * PART_SPLIT_MIN_SIZE) {
+			MEM_freeN(npa);
+			return false;
+		}
+		rect.ymax = npa->disprect.ymin = rect.ymin + sizey / 2;
+	}
+
+	rect.xmin -= pa->crop;
+	rect.ymin -= pa->crop;
+	rect.xmax += pa->crop;
+	rect.ymax += pa->crop;
+
+	pa->disprect = rect;
+	pa->rectx = BLI_rcti_size_x(&rect);
+	pa->recty = BLI_rcti_size_y(&rect);
+	pa->cost *= 0.5f;
+
+	npa->disprect.xmin -= npa->crop;
+	npa->disprect.ymin -= npa->crop;
+	npa->disprect.xmax += npa->crop;
+	npa->disprect.ymax += npa->crop;
+	npa->rectx = BLI_rcti_size_x(&npa->disprect);
+	npa->recty = BLI_rcti_size_y(&npa->disprect);
+	npa->cost = pa->cost;
+
+	BLI_insertlinkafter(&re->parts, pa, npa);
+	re->i.totpart++;
+
+	return true;
+}
+
+/* queue parts for the render threads, called from the main thread only so
+ * the parts list is never modified while threads read it. When fewer parts
+ * are pending than there are threads, the most expensive pending parts are
+ * split so the last parts of the frame are spread over all threads */
+static void queue_next_parts(Render *re, ThreadQueue *workqueue, int minx, bool do_split,
+                             int *totqueued, int *partnr)
+{
+	RenderPart *pa;
+
+	while (*totqueued < re->r.threads + PART_QUEUE_AHEAD) {
+		if (do_split) {
+			while (1) {
+				RenderPart *costliest = NULL;
+				int totpending = 0;
+
+				for (pa = re->parts.first; pa; pa = pa->next) {
+					if (part_is_pending(re, pa, minx)) {
+						totpending++;
+						if (costliest == NULL || pa->cost > costliest->cost)
+							costliest = pa;
+					}
+				}
+
+				if (costliest == NULL || totpending >= re->r.threads)
+					break;
+				if (!split_part(re, costliest))
+					break;
+			}
+		}
+
+		pa = find_next_part(re, minx);
+		if (pa == NULL)
+			break;
+
+		pa->nr = ++(*partnr); /* for nicest part, and for stats */
+		(*totqueued)++;
+		BLI_thread_queue_push(workqueue, pa);
+	}
+}
+
 static void print_part_stats(Render *re, RenderPart *pa)
 {
 	char str[64];
@@ -968,7 +1187,8 @@ static void threaded_tile_processor(Render *re)
 	RenderPart *pa;
 	rctf viewplane = re->viewplane;
 	double lastdraw, elapsed, redrawtime = 1.0f;
-	int totpart = 0, minx = 0, slice = 0, a, wait;
+	int totpart = 0, partnr = 0, minx = 0, slice = 0, a, wait;
+	bool do_split;
 	
 	BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
 
@@ -996,6 +1216,15 @@ static void threaded_tile_processor(Render *re)
 
 	if (re->result->do_exr_tile)
 		render_result_exr_file_begin(re);
+
+	/* exr tile files need parts to match the tile grid */
+	do_split = !re->result->do_exr_tile && re->r.threads > 1;
+	if (do_split)
+		parts_estimate_cost(re);
+
+	/* bin strand segments by screen area, pano parts each have their own view */
+	if (re->totstrand && !(re->r.mode & R_PANORAMA))
+		re->strandbins = strand_bins_build(re);
 	
 	/* assuming no new data gets added to dbase... */
 	R = *re;
@@ -1003,20 +1232,13 @@ static void threaded_tile_processor(Render *re)
 	/* set threadsafe break */
 	R.test_break = thread_break;
 	
-	/* create and fill work queue */
-	workqueue = BLI_thread_queue_init();
 	donequeue = BLI_thread_queue_init();
 	
 	/* for panorama we loop over slices */
 	while (find_next_pano_slice(re, &slice, &minx, &viewplane)) {
-		/* gather parts into queue */
-		while ((pa = find_next_part(re, minx))) {
-			pa->nr = totpart + 1; /* for nicest part, and for stats */
-			totpart++;
-			BLI_thread_queue_push(workqueue, pa);
-		}
-		
-		BLI_thread_queue_nowait(workqueue);
+		/* parts are queued while rendering, as long as threads need work */
+		workqueue = BLI_thread_queue_init();
+		queue_next_parts(re, workqueue, minx, do_split, &totpart, &partnr);
 		
 		/* start all threads */
 		BLI_init_threads(&threads, do_render_thread, re->r.threads);
@@ -1037,6 +1259,11 @@ static void threaded_tile_processor(Render *re)
 			
 			/* handle finished part */
 			if ((pa=BLI_thread_queue_pop_timeout(donequeue, wait))) {
+				totpart--;
+				
+				/* refill the queue first, so threads don't wait on drawing */
+				queue_next_parts(re, workqueue, minx, do_split, &totpart, &partnr);
+				
 				if (pa->result) {
 					if (render_display_draw_enabled(re))
 						re->display_draw(re->ddh, pa->result, NULL);
@@ -1047,8 +1274,6 @@ static void threaded_tile_processor(Render *re)
 					re->i.partsdone++;
 					re->progress(re->prh, re->i.partsdone / (float)re->i.totpart);
 				}
-				
-				totpart--;
 			}
 			
 			/* check for render cancel */
@@ -1059,6 +1284,10 @@ static void threaded_tile_processor(Render *re)
 			if (totpart == 0)
 				break;
 			
+			/* nothing left to queue, let threads finish when the queue is empty */
+			if (find_next_part(re, minx) == NULL)
+				BLI_thread_queue_nowait(workqueue);
+			
 			/* redraw in progress parts */
 			elapsed = PIL_check_seconds_timer() - lastdraw;
 			if (elapsed > redrawtime) {
@@ -1071,7 +1300,9 @@ static void threaded_tile_processor(Render *re)
 			}
 		}
 		
+		BLI_thread_queue_nowait(workqueue);
 		BLI_end_threads(&threads);
+		BLI_thread_queue_free(workqueue);
 		
 		if ((g_break=re->test_break(re->tbh)))
 			break;
@@ -1091,7 +1322,6 @@ static void threaded_tile_processor(Render *re)
 	}
 
 	BLI_thread_queue_free(donequeue);
-	BLI_thread_queue_free(workqueue);
 	
 	if (re->result->do_exr_tile) {
 		BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
@@ -1101,6 +1331,11 @@ static void threaded_tile_processor(Render *re)
 	
 	/* unset threadsafety */
 	g_break = 0;
+
+	if (re->strandbins) {
+		strand_bins_free(re->strandbins);
+		re->strandbins = R.strandbins = NULL;
+	}
 	
 	RE_parts_free(re);
 	re->viewplane = viewplane; /* restore viewplane, modified by pano render */
@@ -2477,6 +2712,32 @@ void RE_SetReports(Render *re, ReportList *reports)
 	re->reports = reports;
 }
 
+/* huge multilayer renders with save buffers don't need the result in memory when
+ * nothing post-processes it, the output file is then merged from the tile files */
+static void render_exr_stream_update(Render *re, int write)
+{
+	RenderData *rd = &re->r;
+
+	re->flag &= ~R_EXR_STREAM;
+
+	if (!write || !G.background)
+		return;
+	if (rd->im_format.imtype != R_IMF_IMTYPE_MULTILAYER)
+		return;
+	if ((rd->scemode & R_EXR_TILE_FILE) == 0 || (rd->scemode & (R_FULL_SAMPLE | R_SINGLE_LAYER)))
+		return;
+	if (rd->mode & (R_BORDER | R_FIELDS | R_MBLUR | R_EDGE | R_EDGE_FRS))
+		return;
+	if ((rd->stamp & R_STAMP_ALL) && (rd->stamp & R_STAMP_DRAW))
+		return;
+	if (re->scene->nodetree && re->scene->use_nodes && (rd->scemode & R_DOCOMP))
+		return;
+	if (RE_seq_render_active(re->scene, rd) || RE_engine_is_external(re))
+		return;
+
+	re->flag |= R_EXR_STREAM;
+}
+
 /* general Blender frame render call */
 void RE_BlenderFrame(Render *re, Main *bmain, Scene *scene, SceneRenderLayer *srl, Object *camera_override, unsigned int lay_override, int frame, const short write_still)
 {
@@ -2490,6 +2751,8 @@ void RE_BlenderFrame(Render *re, Main *bmain, Scene *scene, SceneRenderLayer *sr
 
 		BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_PRE);
 
+		render_exr_stream_update(re, write_still && !BKE_imtype_is_movie(scene->r.im_format.imtype));
+
 		do_render_all_options(re);
 
 		if (write_still && !G.is_break) {
@@ -2507,6 +2770,8 @@ void RE_BlenderFrame(Render *re, Main *bmain, Scene *scene, SceneRenderLayer *sr
 		}
 
 		BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_POST); /* keep after file save */
+
+		re->flag &= ~R_EXR_STREAM;
 	}
 
 	BLI_callback_exec(re->main, (ID *)scene, G.is_break ? BLI_CB_EVT_RENDER_CANCEL : BLI_CB_EVT_RENDER_COMPLETE);
@@ -2527,6 +2792,211 @@ void RE_RenderFreestyleStrokes(Render *re, Main *bmain, Scene *scene, int render
 }
 #endif
 
+/* ********** asynchronous writing of animation frames ********** */
+
+/* Finished frames are color managed and stamped on the render thread, then
+ * handed over to writer threads as their own copies, so the next frame renders
+ * while the previous one is compressed or encoded. Movie frames have to be
+ * appended in order by a single thread, image files use several threads. */
+
+#define RENDER_WRITE_MAX_THREADS  4
+
+typedef struct RenderWriteFrame {
+	struct RenderWriteFrame *next, *prev;
+	ImBuf *ibuf;
+	char name[FILE_MAX];
+	ImageFormatData imf;
+
+	/* movies only */
+	bMovieHandle *mh;
+	RenderData rd;
+	int start_frame, frame;
+
+	bool running;
+} RenderWriteFrame;
+
+static struct {
+	bool active, stop, failed;
+	const void *owner;  /* one render at a time writes through the queue */
+	int totthread;
+	ListBase threads;
+	ListBase queue;  /* RenderWriteFrame, oldest first, also the ones being written */
+	ThreadMutex mutex;
+	ThreadCondition cond;  /* notified when a frame is queued or written */
+} render_write = {false, false, false, NULL, 0, {NULL, NULL}, {NULL, NULL}, BLI_MUTEX_INITIALIZER};
+
+static bool render_write_frame(RenderWriteFrame *wf)
+{
+	bool ok;
+
+	if (wf->mh) {
+		/* reports are not thread safe, errors go to the console */
+		ok = wf->mh->append_movie(&wf->rd, wf->start_frame, wf->frame, (int *)wf->ibuf->rect,
+		                          wf->ibuf->x, wf->ibuf->y, NULL);
+	}
+	else {
+		ok = BKE_imbuf_write(wf->ibuf, wf->name, &wf->imf);
+
+		if (ok)
+			printf("Saved: %s\n", wf->name);
+		else
+			printf("Render error: cannot save %s\n", wf->name);
+	}
+
+	return ok;
+}
+
+static void *render_write_thread(void *UNUSED(arg))
+{
+	BLI_mutex_lock(&render_write.mutex);
+
+	while (true) {
+		RenderWriteFrame *wf;
+
+		for (wf = render_write.queue.first; wf; wf = wf->next) {
+			if (!wf->running)
+				break;
+		}
+
+		if (wf == NULL) {
+			if (render_write.stop)
+				break;
+
+			BLI_condition_wait(&render_write.cond, &render_write.mutex);
+			continue;
+		}
+
+		wf->running = true;
+		BLI_mutex_unlock(&render_write.mutex);
+
+		/* skip remaining frames after an error, like synchronous writing stops */
+		if (!render_write.failed && !render_write_frame(wf))
+			render_write.failed = true;
+
+		IMB_freeImBuf(wf->ibuf);
+
+		BLI_mutex_lock(&render_write.mutex);
+		BLI_freelinkN(&render_write.queue, wf);
+		BLI_condition_notify_all(&render_write.cond);
+	}
+
+	BLI_mutex_unlock(&render_write.mutex);
+
+	return NULL;
+}
+
+/* returns false when the queue is in use by another render, its frames are then written directly */
+bool RE_AsyncWriteBegin(const void *owner, bool is_movie)
+{
+	int a;
+
+	if (render_write.active)
+		return false;
+
+	render_write.totthread = is_movie ? 1 : min_ii(BLI_system_thread_count(), RENDER_WRITE_MAX_THREADS);
+
+	BLI_condition_init(&render_write.cond);
+	render_write.stop = false;
+	render_write.failed = false;
+	render_write.active = true;
+	render_write.owner = owner;
+
+	BLI_init_threads(&render_write.threads, render_write_thread, render_write.totthread);
+	for (a = 0; a < render_write.totthread; a++)
+		BLI_insert_thread(&render_write.threads, NULL);
+
+	return true;
+}
+
+bool RE_AsyncWriteActive(const void *owner)
+{
+	return render_write.active && render_write.owner == owner;
+}
+
+static void render_write_push(RenderWriteFrame *wf)
+{
+	BLI_mutex_lock(&render_write.mutex);
+
+	/* bound memory use, with each thread busy only one more frame may wait */
+	while (BLI_countlist(&render_write.queue) > render_write.totthread)
+		BLI_condition_wait(&render_write.cond, &render_write.mutex);
+
+	BLI_addtail(&render_write.queue, wf);
+	BLI_condition_notify_all(&render_write.cond);
+
+	BLI_mutex_unlock(&render_write.mutex);
+}
+
+void RE_AsyncWriteImage(ImBuf *ibuf, const char *name, const ImageFormatData *imf)
+{
+	RenderWriteFrame *wf = MEM_callocN(sizeof(RenderWriteFrame), "RenderWriteFrame");
+
+	wf->ibuf = ibuf;
+	BLI_strncpy(wf->name, name, sizeof(wf->name));
+	wf->imf = *imf;
+
+	render_write_push(wf);
+}
+
+void RE_AsyncWriteMovie(ImBuf *ibuf, bMovieHandle *mh, RenderData *rd, int start_frame, int frame)
+{
+	RenderWriteFrame *wf = MEM_callocN(sizeof(RenderWriteFrame), "RenderWriteFrame");
+
+	wf->ibuf = ibuf;
+	wf->mh = mh;
+	wf->rd = *rd;
+	wf->start_frame = start_frame;
+	wf->frame = frame;
+
+	render_write_push(wf);
+}
+
+bool RE_AsyncWriteFailed(const void *owner)
+{
+	return RE_AsyncWriteActive(owner) && render_write.failed;
+}
+
+/* waits for all queued frames to be written, returns false if one failed */
+bool RE_AsyncWriteEnd(const void *owner, ReportList *reports)
+{
+	bool failed;
+
+	if (!RE_AsyncWriteActive(owner))
+		return true;
+
+	BLI_mutex_lock(&render_write.mutex);
+	render_write.stop = true;
+	BLI_condition_notify_all(&render_write.cond);
+	BLI_mutex_unlock(&render_write.mutex);
+
+	BLI_end_threads(&render_write.threads);
+	BLI_condition_end(&render_write.cond);
+
+	failed = render_write.failed;
+	render_write.active = false;
+	render_write.owner = NULL;
+
+	if (failed)
+		BKE_report(reports, RPT_ERROR, "Could not write all rendered frames, see the console for details");
+
+	return !failed;
+}
+
+/* copy of the prepared frame for the writer threads, with stamp metadata */
+static ImBuf *render_write_ibuf_copy(Scene *scene, Object *camera, ImBuf *ibuf)
+{
+	ImBuf *ibuf_copy = IMB_dupImBuf(ibuf);
+
+	ibuf_copy->planes = ibuf->planes;
+	ibuf_copy->ppm[0] = ibuf->ppm[0];
+	ibuf_copy->ppm[1] = ibuf->ppm[1];
+
+	if (scene->r.stamp & R_STAMP_ALL)
+		BKE_imbuf_stamp_info(scene, camera, ibuf_copy);
+
+	return ibuf_copy;
+}
+
 static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovieHandle *mh, const char *name_override)
 {
 	char name[FILE_MAX];
@@ -2534,6 +3004,8 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 	Object *camera = RE_GetCamera(re);
 	double render_time;
 	int ok = 1;
+	/* single frames (name_override) are expected on disk when this returns */
+	const bool use_async = (name_override == NULL) && RE_AsyncWriteActive(re);
 	
 	RE_AcquireResultImage(re, &rres);
 
@@ -2554,8 +3026,17 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 		IMB_colormanagement_imbuf_for_write(ibuf, true, false, &scene->view_settings,
 		                                    &scene->display_settings, &scene->r.im_format);
 
-		ok = mh->append_movie(&re->r, scene->r.sfra, scene->r.cfra, (int *) ibuf->rect,
-		                      ibuf->x, ibuf->y, re->reports);
+		if (use_async) {
+			/* encoders only use the byte buffer */
+			ImBuf *ibuf_copy = IMB_allocImBuf(ibuf->x, ibuf->y, ibuf->planes, IB_rect);
+
+			memcpy(ibuf_copy->rect, ibuf->rect, sizeof(int) * ibuf->x * ibuf->y);
+			RE_AsyncWriteMovie(ibuf_copy, mh, &re->r, scene->r.sfra, scene->r.cfra);
+		}
+		else {
+			ok = mh->append_movie(&re->r, scene->r.sfra, scene->r.cfra, (int *) ibuf->rect,
+			                      ibuf->x, ibuf->y, re->reports);
+		}
 		if (do_free) {
 			MEM_freeN(ibuf->rect);
 			ibuf->rect = NULL;
@@ -2575,7 +3056,10 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 		
 		if (re->r.im_format.imtype == R_IMF_IMTYPE_MULTILAYER) {
 			if (re->result) {
-				RE_WriteRenderResult(re->reports, re->result, name, scene->r.im_format.exr_codec);
+				if (re->flag & R_EXR_STREAM)
+					ok = render_result_exr_file_write_stream(re, name, scene->r.im_format.exr_codec);
+				else
+					RE_WriteRenderResult(re->reports, re->result, name, scene->r.im_format.exr_codec);
 				printf("Saved: %s", name);
 			}
 		}
@@ -2585,12 +3069,18 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 			IMB_colormanagement_imbuf_for_write(ibuf, true, false, &scene->view_settings,
 			                                    &scene->display_settings, &scene->r.im_format);
 
-			ok = BKE_imbuf_write_stamp(scene, camera, ibuf, name, &scene->r.im_format);
-			
-			if (ok == 0) {
-				printf("Render error: cannot save %s\n", name);
+			if (use_async) {
+				RE_AsyncWriteImage(render_write_ibuf_copy(scene, camera, ibuf), name, &scene->r.im_format);
+				printf("Queued: %s", name);
+			}
+			else {
+				ok = BKE_imbuf_write_stamp(scene, camera, ibuf, name, &scene->r.im_format);
+
+				if (ok == 0) {
+					printf("Render error: cannot save %s\n", name);
+				}
+				else printf("Saved: %s", name);
 			}
-			else printf("Saved: %s", name);
 			
 			/* optional preview images for exr */
 			if (ok && scene->r.im_format.imtype == R_IMF_IMTYPE_OPENEXR && (scene->r.im_format.flag & R_IMF_FLAG_PREVIEW_JPG)) {
@@ -2605,8 +3095,14 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 				IMB_colormanagement_imbuf_for_write(ibuf, true, false, &scene->view_settings,
 				                                    &scene->display_settings, &imf);
 
-				BKE_imbuf_write_stamp(scene, camera, ibuf, name, &imf);
-				printf("\nSaved: %s", name);
+				if (use_async) {
+					RE_AsyncWriteImage(render_write_ibuf_copy(scene, camera, ibuf), name, &imf);
+					printf("\nQueued: %s", name);
+				}
+				else {
+					BKE_imbuf_write_stamp(scene, camera, ibuf, name, &imf);
+					printf("\nSaved: %s", name);
+				}
 			}
 			
 			/* imbuf knows which rects are not part of ibuf */
@@ -2654,6 +3150,10 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 		if (!mh->start_movie(scene, &re->r, re->rectx, re->recty, re->reports))
 			G.is_break = TRUE;
 
+	/* multilayer files are written from the render result, which the next frame reuses */
+	if ((scene->r.mode & R_WRITE_ASYNC) && scene->r.im_format.imtype != R_IMF_IMTYPE_MULTILAYER)
+		RE_AsyncWriteBegin(re, BKE_imtype_is_movie(scene->r.im_format.imtype));
+
 	if (mh->get_next_frame) {
 		while (!(G.is_break == 1)) {
 			int nf = mh->get_next_frame(&re->r, re->reports);
@@ -2666,7 +3166,7 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 				totrendered++;
 
 				if (re->test_break(re->tbh) == 0) {
-					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL))
+					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL) || RE_AsyncWriteFailed(re))
 						G.is_break = TRUE;
 				}
 
@@ -2728,13 +3228,14 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 			/* run callbacs before rendering, before the scene is updated */
 			BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_PRE);
 
+			render_exr_stream_update(re, TRUE);
 			
 			do_render_all_options(re);
 			totrendered++;
 			
 			if (re->test_break(re->tbh) == 0) {
 				if (!G.is_break)
-					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL))
+					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL) || RE_AsyncWriteFailed(re))
 						G.is_break = TRUE;
 			}
 			else
@@ -2757,6 +3258,10 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 		}
 	}
 	
+	/* finish writing queued frames, also when cancelled */
+	if (!RE_AsyncWriteEnd(re, re->reports))
+		G.is_break = TRUE;
+
 	/* end movie */
 	if (BKE_imtype_is_movie(scene->r.im_format.imtype))
 		mh->end_movie();
@@ -2766,7 +3271,8 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 
 	scene->r.cfra = cfrao;
 
-	re->flag &= ~R_ANIMATION;
+	re->flag &= ~(R_ANIMATION | R_EXR_STREAM);
+	RE_Database_FreePersistent(re);
 
 	BLI_callback_exec(re->main, (ID *)scene, G.is_break ? BLI_CB_EVT_RENDER_CANCEL : BLI_CB_EVT_RENDER_COMPLETE);
 
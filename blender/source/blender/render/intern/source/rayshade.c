@@ -1853,11 +1853,13 @@ static float *sphere_sampler(int type, int resol, int thread, int xs, int ys, in
 
 static void ray_ao_qmc(ShadeInput *shi, float ao[3], float env[3])
 {
-	Isect isec;
+	Isect isec, packet[RE_RAY_PACKET_SIZE];
 	RayHint point_hint;
 	QMCSampler *qsa=NULL;
 	float samp3d[3];
 	float up[3], side[3], dir[3], nrm[3];
+	float packet_dir[RE_RAY_PACKET_SIZE][3];
+	int packet_hit[RE_RAY_PACKET_SIZE];
 	
 	float maxdist = R.wrld.aodist;
 	float fac=0.0f, prev=0.0f;
@@ -1933,66 +1935,89 @@ static void ray_ao_qmc(ShadeInput *shi, float ao[3], float env[3])
 	QMC_initPixel(qsa, shi->thread);
 	
 	while (samples < max_samples) {
+		int a, last, totpacket;
 
-		/* sampling, returns quasi-random vector in unit hemisphere */
-		QMC_sampleHemi(samp3d, qsa, shi->thread, samples);
+		/* samples up to the first adaptive sampling test are cast together */
+		if (qsa && qsa->type == SAMP_TYPE_HALTON && adapt_thresh > 0.0f)
+			last = max_ii(samples + 1, max_samples/2 + 1);
+		else
+			last = max_samples;
 
-		dir[0] = (samp3d[0]*up[0] + samp3d[1]*side[0] + samp3d[2]*nrm[0]);
-		dir[1] = (samp3d[0]*up[1] + samp3d[1]*side[1] + samp3d[2]*nrm[1]);
-		dir[2] = (samp3d[0]*up[2] + samp3d[1]*side[2] + samp3d[2]*nrm[2]);
-		
-		normalize_v3(dir);
-		
-		isec.dir[0] = -dir[0];
-		isec.dir[1] = -dir[1];
-		isec.dir[2] = -dir[2];
-		isec.dist = maxdist;
-		
-		if (shi->obi->flag & R_ENV_TRANSFORMED)
-			ray_env_rotate_dir(&isec, shi->obi->imat);
-		
-		prev = fac;
-		
-		if (RE_rayobject_raycast(R.raytree, &isec)) {
-			if (R.wrld.aomode & WO_AODIST) fac+= expf(-isec.dist*R.wrld.aodistfac);
-			else fac+= 1.0f;
-		}
-		else if (envcolor!=WO_AOPLAIN) {
-			float skycol[4];
-			float view[3];
+		totpacket = min_ii(last - samples, RE_RAY_PACKET_SIZE);
+
+		for (a = 0; a < totpacket; a++) {
+			/* sampling, returns quasi-random vector in unit hemisphere */
+			QMC_sampleHemi(samp3d, qsa, shi->thread, samples + a);
+
+			dir[0] = (samp3d[0]*up[0] + samp3d[1]*side[0] + samp3d[2]*nrm[0]);
+			dir[1] = (samp3d[0]*up[1] + samp3d[1]*side[1] + samp3d[2]*nrm[1]);
+			dir[2] = (samp3d[0]*up[2] + samp3d[1]*side[2] + samp3d[2]*nrm[2]);
 			
-			view[0]= -dir[0];
-			view[1]= -dir[1];
-			view[2]= -dir[2];
-			normalize_v3(view);
+			normalize_v3(dir);
+			copy_v3_v3(packet_dir[a], dir);
 			
-			if (envcolor==WO_AOSKYCOL) {
-				const float skyfac= 0.5f * (1.0f + dot_v3v3(view, R.grvec));
-				env[0]+= (1.0f-skyfac)*R.wrld.horr + skyfac*R.wrld.zenr;
-				env[1]+= (1.0f-skyfac)*R.wrld.horg + skyfac*R.wrld.zeng;
-				env[2]+= (1.0f-skyfac)*R.wrld.horb + skyfac*R.wrld.zenb;
-			}
-			else {	/* WO_AOSKYTEX */
-				shadeSkyView(skycol, isec.start, view, dxyview, shi->thread);
-				shadeSunView(skycol, shi->view);
-				env[0]+= skycol[0];
-				env[1]+= skycol[1];
-				env[2]+= skycol[2];
-			}
-			skyadded++;
+			packet[a] = isec;
+			packet[a].dir[0] = -dir[0];
+			packet[a].dir[1] = -dir[1];
+			packet[a].dir[2] = -dir[2];
+			packet[a].dist = maxdist;
+			
+			if (shi->obi->flag & R_ENV_TRANSFORMED)
+				ray_env_rotate_dir(&packet[a], shi->obi->imat);
 		}
-		
-		samples++;
-		
-		if (qsa && qsa->type == SAMP_TYPE_HALTON) {
-			/* adaptive sampling - consider samples below threshold as in shadow (or vice versa) and exit early */
-			if (adapt_thresh > 0.0f && (samples > max_samples/2) ) {
+
+		RE_rayobject_raycast_n(R.raytree, packet, packet_hit, totpacket);
+
+		/* keep the last hit heuristic going for the next packet */
+		isec.last_hit = packet[totpacket - 1].last_hit;
+
+		for (a = 0; a < totpacket; a++) {
+			prev = fac;
+			
+			if (packet_hit[a]) {
+				if (R.wrld.aomode & WO_AODIST) fac+= expf(-packet[a].dist*R.wrld.aodistfac);
+				else fac+= 1.0f;
+			}
+			else if (envcolor!=WO_AOPLAIN) {
+				float skycol[4];
+				float view[3];
+				
+				view[0]= -packet_dir[a][0];
+				view[1]= -packet_dir[a][1];
+				view[2]= -packet_dir[a][2];
+				normalize_v3(view);
 				
-				if (adaptive_sample_contrast_val(samples, prev, fac, adapt_thresh)) {
-					break;
+				if (envcolor==WO_AOSKYCOL) {
+					const float skyfac= 0.5f * (1.0f + dot_v3v3(view, R.grvec));
+					env[0]+= (1.0f-skyfac)*R.wrld.horr + skyfac*R.wrld.zenr;
+					env[1]+= (1.0f-skyfac)*R.wrld.horg + skyfac*R.wrld.zeng;
+					env[2]+= (1.0f-skyfac)*R.wrld.horb + skyfac*R.wrld.zenb;
+				}
+				else {	/* WO_AOSKYTEX */
+					shadeSkyView(skycol, isec.start, view, dxyview, shi->thread);
+					shadeSunView(skycol, shi->view);
+					env[0]+= skycol[0];
+					env[1]+= skycol[1];
+					env[2]+= skycol[2];
+				}
+				skyadded++;
+			}
+			
+			samples++;
+			
+			if (qsa && qsa->type == SAMP_TYPE_HALTON) {
+				/* adaptive sampling - consider samples below threshold as in shadow (or vice versa) and exit early */
+				if (adapt_thresh > 0.0f && (samples > max_samples/2) ) {
+					
+					if (adaptive_sample_contrast_val(samples, prev, fac, adapt_thresh)) {
+						break;
+					}
 				}
 			}
 		}
+
+		if (a < totpacket)
+			break;
 	}
 	
 	/* average color times distances/hits formula */
@@ -2194,18 +2219,89 @@ static void ray_shadow_jittered_coords(ShadeInput *shi, int max, float jitco[RE_
 	}
 }
 
+/* set up the ray of one soft shadow sample towards the lamp */
+static void ray_shadow_qmc_sample(ShadeInput *shi, LampRen *lar, QMCSampler *qsa, const float lampco[3],
+                                  float jitco[RE_MAX_OSA][3], int totjitco, int do_soft, int sample, Isect *isec)
+{
+	float samp3d[3], start[3], end[3];
+
+	isec->orig.ob   = shi->obi;
+	isec->orig.face = shi->vlr;
+
+	/* manually jitter the start shading co-ord per sample
+	 * based on the pre-generated OSA texture sampling offsets, 
+	 * for anti-aliasing sharp shadow edges. */
+	copy_v3_v3(start, jitco[sample % totjitco]);
+
+	if (do_soft) {
+		/* sphere shadow source */
+		if (lar->type == LA_LOCAL) {
+			float ru[3], rv[3], v[3], s[3];
+			
+			/* calc tangent plane vectors */
+			sub_v3_v3v3(v, start, lampco);
+			normalize_v3(v);
+			ortho_basis_v3v3_v3(ru, rv, v);
+			
+			/* sampling, returns quasi-random vector in area_size disc */
+			QMC_sampleDisc(samp3d, qsa, shi->thread, sample, lar->area_size);
+
+			/* distribute disc samples across the tangent plane */
+			s[0] = samp3d[0]*ru[0] + samp3d[1]*rv[0];
+			s[1] = samp3d[0]*ru[1] + samp3d[1]*rv[1];
+			s[2] = samp3d[0]*ru[2] + samp3d[1]*rv[2];
+			
+			copy_v3_v3(samp3d, s);
+		}
+		else {
+			/* sampling, returns quasi-random vector in [sizex,sizey]^2 plane */
+			QMC_sampleRect(samp3d, qsa, shi->thread, sample, lar->area_size, lar->area_sizey);
+							
+			/* align samples to lamp vector */
+			mul_m3_v3(lar->mat, samp3d);
+		}
+		end[0] = lampco[0]+samp3d[0];
+		end[1] = lampco[1]+samp3d[1];
+		end[2] = lampco[2]+samp3d[2];
+	}
+	else {
+		copy_v3_v3(end, lampco);
+	}
+
+	if (shi->strand) {
+		/* bias away somewhat to avoid self intersection */
+		float jitbias= 0.5f*(len_v3(shi->dxco) + len_v3(shi->dyco));
+		float v[3];
+
+		sub_v3_v3v3(v, start, end);
+		normalize_v3(v);
+
+		start[0] -= jitbias*v[0];
+		start[1] -= jitbias*v[1];
+		start[2] -= jitbias*v[2];
+	}
+	
+	copy_v3_v3(isec->start, start);
+	sub_v3_v3v3(isec->dir, end, start);
+	isec->dist = normalize_v3(isec->dir);
+	
+	if (shi->obi->flag & R_ENV_TRANSFORMED)
+		ray_env_rotate(isec, shi->obi->imat);
+}
+
 static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3], float shadfac[4], Isect *isec)
 {
 	QMCSampler *qsa=NULL;
 	int samples=0;
-	float samp3d[3];
 
-	float fac=0.0f, vec[3], end[3];
+	float fac=0.0f;
 	float colsq[4];
 	float adapt_thresh = lar->adapt_thresh;
 	int min_adapt_samples=4, max_samples = lar->ray_totsamp;
-	float start[3];
-	int do_soft = TRUE, full_osa = FALSE, i;
+	int do_soft = TRUE, full_osa = FALSE, do_adapt, i;
+
+	Isect packet[RE_RAY_PACKET_SIZE];
+	int packet_hit[RE_RAY_PACKET_SIZE];
 
 	float min[3], max[3];
 	RayHint bb_hint;
@@ -2256,77 +2352,17 @@ static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3],
 	isec->hint = &bb_hint;
 	isec->check = RE_CHECK_VLR_RENDER;
 	isec->skip = RE_SKIP_VLR_NEIGHBOUR;
-	copy_v3_v3(vec, lampco);
+	
+	do_adapt = (lar->ray_samp_method == LA_SAMP_HALTON) && (max_samples > min_adapt_samples) && (adapt_thresh > 0.0f);
 	
 	while (samples < max_samples) {
 
-		isec->orig.ob   = shi->obi;
-		isec->orig.face = shi->vlr;
-
-		/* manually jitter the start shading co-ord per sample
-		 * based on the pre-generated OSA texture sampling offsets, 
-		 * for anti-aliasing sharp shadow edges. */
-		copy_v3_v3(start, jitco[samples % totjitco]);
-
-		if (do_soft) {
-			/* sphere shadow source */
-			if (lar->type == LA_LOCAL) {
-				float ru[3], rv[3], v[3], s[3];
-				
-				/* calc tangent plane vectors */
-				sub_v3_v3v3(v, start, lampco);
-				normalize_v3(v);
-				ortho_basis_v3v3_v3(ru, rv, v);
-				
-				/* sampling, returns quasi-random vector in area_size disc */
-				QMC_sampleDisc(samp3d, qsa, shi->thread, samples, lar->area_size);
-
-				/* distribute disc samples across the tangent plane */
-				s[0] = samp3d[0]*ru[0] + samp3d[1]*rv[0];
-				s[1] = samp3d[0]*ru[1] + samp3d[1]*rv[1];
-				s[2] = samp3d[0]*ru[2] + samp3d[1]*rv[2];
-				
-				copy_v3_v3(samp3d, s);
-			}
-			else {
-				/* sampling, returns quasi-random vector in [sizex,sizey]^2 plane */
-				QMC_sampleRect(samp3d, qsa, shi->thread, samples, lar->area_size, lar->area_sizey);
-								
-				/* align samples to lamp vector */
-				mul_m3_v3(lar->mat, samp3d);
-			}
-			end[0] = vec[0]+samp3d[0];
-			end[1] = vec[1]+samp3d[1];
-			end[2] = vec[2]+samp3d[2];
-		}
-		else {
-			copy_v3_v3(end, vec);
-		}
-
-		if (shi->strand) {
-			/* bias away somewhat to avoid self intersection */
-			float jitbias= 0.5f*(len_v3(shi->dxco) + len_v3(shi->dyco));
-			float v[3];
-
-			sub_v3_v3v3(v, start, end);
-			normalize_v3(v);
-
-			start[0] -= jitbias*v[0];
-			start[1] -= jitbias*v[1];
-			start[2] -= jitbias*v[2];
-		}
-		
-		copy_v3_v3(isec->start, start);
-		sub_v3_v3v3(isec->dir, end, start);
-		isec->dist = normalize_v3(isec->dir);
-		
-		if (shi->obi->flag & R_ENV_TRANSFORMED)
-			ray_env_rotate(isec, shi->obi->imat);
-
 		/* trace the ray */
 		if (isec->mode==RE_RAY_SHADOW_TRA) {
 			float col[4] = {1.0f, 1.0f, 1.0f, 1.0f};
 			
+			ray_shadow_qmc_sample(shi, lar, qsa, lampco, jitco, totjitco, do_soft, samples, isec);
+			
 			ray_trace_shadow_tra(isec, shi, DEPTH_SHADOW_TRA, 0, col);
 			shadfac[0] += col[0];
 			shadfac[1] += col[1];
@@ -2337,17 +2373,31 @@ static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3],
 			colsq[0] += col[0]*col[0];
 			colsq[1] += col[1]*col[1];
 			colsq[2] += col[2]*col[2];
+			
+			samples++;
 		}
 		else {
-			if ( RE_rayobject_raycast(R.raytree, isec) ) fac+= 1.0f;
+			/* samples up to the first adaptive sampling test are cast together */
+			int a, last = (do_adapt) ? max_ii(samples + 1, max_samples / 3 + 1) : max_samples;
+			int totpacket = min_ii(last - samples, RE_RAY_PACKET_SIZE);
+			
+			for (a = 0; a < totpacket; a++) {
+				packet[a] = *isec;
+				ray_shadow_qmc_sample(shi, lar, qsa, lampco, jitco, totjitco, do_soft, samples + a, &packet[a]);
+			}
+			
+			fac += RE_rayobject_raycast_n(R.raytree, packet, packet_hit, totpacket);
+			
+			/* keep the last hit heuristic going for the next packet */
+			isec->last_hit = packet[totpacket - 1].last_hit;
+			
+			samples += totpacket;
 		}
 		
-		samples++;
-		
-		if (lar->ray_samp_method == LA_SAMP_HALTON) {
+		if (do_adapt) {
 		
 			/* adaptive sampling - consider samples below threshold as in shadow (or vice versa) and exit early */
-			if ((max_samples > min_adapt_samples) && (adapt_thresh > 0.0f) && (samples > max_samples / 3)) {
+			if (samples > max_samples / 3) {
 				if (isec->mode==RE_RAY_SHADOW_TRA) {
 					if ((shadfac[3] / samples > (1.0f-adapt_thresh)) || (shadfac[3] / samples < adapt_thresh))
 						break;
@@ -2382,6 +2432,8 @@ static void ray_shadow_jitter(ShadeInput *shi, LampRen *lar, const float lampco[
 	float fac=0.0f, div=0.0f, vec[3];
 	int a, j= -1, mask;
 	RayHint point_hint;
+	Isect packet[RE_RAY_PACKET_SIZE];
+	int packet_hit[RE_RAY_PACKET_SIZE], totpacket = 0;
 	
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
 		shadfac[0]= shadfac[1]= shadfac[2]= shadfac[3]= 0.0f;
@@ -2445,10 +2497,24 @@ static void ray_shadow_jitter(ShadeInput *shi, LampRen *lar, const float lampco[
 			shadfac[2] += col[2];
 			shadfac[3] += col[3];
 		}
-		else if ( RE_rayobject_raycast(R.raytree, isec) ) fac+= 1.0f;
+		else {
+			/* rays share the shading point, cast them together */
+			packet[totpacket++] = *isec;
+		}
 		
 		div+= 1.0f;
 		jitlamp+= 2;
+		
+		if (totpacket == RE_RAY_PACKET_SIZE) {
+			fac += RE_rayobject_raycast_n(R.raytree, packet, packet_hit, totpacket);
+			isec->last_hit = packet[totpacket - 1].last_hit;
+			totpacket = 0;
+		}
+	}
+	
+	if (totpacket) {
+		fac += RE_rayobject_raycast_n(R.raytree, packet, packet_hit, totpacket);
+		isec->last_hit = packet[totpacket - 1].last_hit;
 	}
 	
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
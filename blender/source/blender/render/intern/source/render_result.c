@@ -1001,6 +1001,16 @@ void render_result_exr_file_end(Render *re)
 		rr->do_exr_tile = FALSE;
 	}
 	
+	/* streamed results stay on disk, the result keeps its layers without buffers
+	 * and the output file is written from the tile files directly. halo flares
+	 * are drawn into the full result afterwards, so those read it back */
+	if (re->flag & R_EXR_STREAM) {
+		if ((re->flag & R_HALO) == 0)
+			return;
+
+		re->flag &= ~R_EXR_STREAM;
+	}
+
 	render_result_free_list(&re->fullresult, re->result);
 	re->result = NULL;
 
@@ -1053,6 +1063,39 @@ int render_result_exr_file_read(Render *re, int sample)
 	return success;
 }
 
+/* write a streamed render result to a multilayer file, the tile files of all
+ * layers are copied into it a band of scanlines at a time */
+int render_result_exr_file_write_stream(Render *re, const char *filepath, int compress)
+{
+	RenderLayer *rl;
+	char (*paths)[FILE_MAX];
+	const char **inputs;
+	int a, totlayer = BLI_countlist(&re->result->layers);
+	int success;
+
+	if (totlayer == 0)
+		return FALSE;
+
+	paths = MEM_mallocN(sizeof(*paths) * totlayer, "exr stream paths");
+	inputs = MEM_mallocN(sizeof(*inputs) * totlayer, "exr stream inputs");
+
+	for (rl = re->result->layers.first, a = 0; rl; rl = rl->next, a++) {
+		render_result_exr_file_path(re->scene, rl->name, 0, paths[a]);
+		inputs[a] = paths[a];
+	}
+
+	BLI_make_existing_file(filepath);
+	success = IMB_exr_merge_files(filepath, inputs, totlayer, compress);
+
+	if (!success)
+		BKE_report(re->reports, RPT_ERROR, "Error writing render result (see console)");
+
+	MEM_freeN(inputs);
+	MEM_freeN(paths);
+
+	return success;
+}
+
 /* called for reading temp files, and for external engines */
 int render_result_exr_file_read_path(RenderResult *rr, RenderLayer *rl_single, const char *filepath)
 {
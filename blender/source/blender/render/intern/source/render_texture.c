@@ -111,10 +111,11 @@ static void init_render_texture(Render *re, Tex *tex)
 			if (tex->env->type==ENV_PLANE)
 				tex->extend= TEX_EXTEND;
 			
-			/* only free envmap when rendermode was set to render envmaps, for previewrender */
+			/* only free envmap when rendermode was set to render envmaps, for previewrender,
+			 * with persistent data make_envmaps decides if it can be reused */
 			if (G.is_rendering && re) {
 				if (re->r.mode & R_ENVMAP)
-					if (tex->env->stype==ENV_ANIM)
+					if (tex->env->stype==ENV_ANIM && (re->flag & R_PERSISTENT_OBJECTS)==0)
 						BKE_free_envmapdata(tex->env);
 			}
 		}
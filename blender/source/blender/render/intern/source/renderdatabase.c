@@ -830,71 +830,89 @@ static void free_renderdata_strandnodes(StrandTableNode *strandnodes)
 	MEM_freeN(strandnodes);
 }
 
-void free_renderdata_tables(Render *re)
+void free_renderdata_object(ObjectRen *obr)
 {
-	ObjectInstanceRen *obi;
-	ObjectRen *obr;
 	StrandBuffer *strandbuf;
-	int a=0;
-	
-	for (obr=re->objecttable.first; obr; obr=obr->next) {
-		if (obr->vertnodes) {
-			free_renderdata_vertnodes(obr->vertnodes);
-			obr->vertnodes= NULL;
-			obr->vertnodeslen= 0;
-		}
+	int a;
 
-		if (obr->vlaknodes) {
-			free_renderdata_vlaknodes(obr->vlaknodes);
-			obr->vlaknodes= NULL;
-			obr->vlaknodeslen= 0;
-			obr->totvlak= 0;
-		}
+	if (obr->vertnodes) {
+		free_renderdata_vertnodes(obr->vertnodes);
+		obr->vertnodes= NULL;
+		obr->vertnodeslen= 0;
+	}
 
-		if (obr->bloha) {
-			for (a=0; obr->bloha[a]; a++)
-				MEM_freeN(obr->bloha[a]);
+	if (obr->vlaknodes) {
+		free_renderdata_vlaknodes(obr->vlaknodes);
+		obr->vlaknodes= NULL;
+		obr->vlaknodeslen= 0;
+		obr->totvlak= 0;
+	}
 
-			MEM_freeN(obr->bloha);
-			obr->bloha= NULL;
-			obr->blohalen= 0;
-		}
+	if (obr->bloha) {
+		for (a=0; obr->bloha[a]; a++)
+			MEM_freeN(obr->bloha[a]);
 
-		if (obr->strandnodes) {
-			free_renderdata_strandnodes(obr->strandnodes);
-			obr->strandnodes= NULL;
-			obr->strandnodeslen= 0;
-		}
+		MEM_freeN(obr->bloha);
+		obr->bloha= NULL;
+		obr->blohalen= 0;
+	}
 
-		strandbuf= obr->strandbuf;
-		if (strandbuf) {
-			if (strandbuf->vert) MEM_freeN(strandbuf->vert);
-			if (strandbuf->bound) MEM_freeN(strandbuf->bound);
-			MEM_freeN(strandbuf);
-		}
+	if (obr->strandnodes) {
+		free_renderdata_strandnodes(obr->strandnodes);
+		obr->strandnodes= NULL;
+		obr->strandnodeslen= 0;
+	}
 
-		if (obr->mtface)
-			MEM_freeN(obr->mtface);
+	strandbuf= obr->strandbuf;
+	if (strandbuf) {
+		if (strandbuf->vert) MEM_freeN(strandbuf->vert);
+		if (strandbuf->bound) MEM_freeN(strandbuf->bound);
+		MEM_freeN(strandbuf);
+		obr->strandbuf= NULL;
+	}
 
-		if (obr->mcol)
-			MEM_freeN(obr->mcol);
-			
-		if (obr->rayfaces) {
-			MEM_freeN(obr->rayfaces);
-			obr->rayfaces = NULL;
-		}
+	if (obr->mtface) {
+		MEM_freeN(obr->mtface);
+		obr->mtface= NULL;
+	}
 
-		if (obr->rayprimitives) {
-			MEM_freeN(obr->rayprimitives);
-			obr->rayprimitives = NULL;
-		}
+	if (obr->mcol) {
+		MEM_freeN(obr->mcol);
+		obr->mcol= NULL;
+	}
 
-		if (obr->raytree) {
-			RE_rayobject_free(obr->raytree);
-			obr->raytree = NULL;
-		}
+	free_renderdata_object_raytree(obr);
+}
+
+/* raytrace data of an object points to its instances, it's rebuilt with them */
+void free_renderdata_object_raytree(ObjectRen *obr)
+{
+	if (obr->rayfaces) {
+		MEM_freeN(obr->rayfaces);
+		obr->rayfaces = NULL;
+	}
+
+	if (obr->rayprimitives) {
+		MEM_freeN(obr->rayprimitives);
+		obr->rayprimitives = NULL;
+	}
+
+	if (obr->raytree) {
+		RE_rayobject_free(obr->raytree);
+		obr->raytree = NULL;
 	}
 
+	obr->rayobi = NULL;
+}
+
+void free_renderdata_tables(Render *re)
+{
+	ObjectInstanceRen *obi;
+	ObjectRen *obr;
+
+	for (obr=re->objecttable.first; obr; obr=obr->next)
+		free_renderdata_object(obr);
+
 	if (re->objectinstance) {
 		for (obi=re->instancetable.first; obi; obi=obi->next) {
 			if (obi->vectors)
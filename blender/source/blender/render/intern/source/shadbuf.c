@@ -43,6 +43,7 @@
 #include "BLI_jitter.h"
 #include "BLI_memarena.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -305,9 +306,10 @@ static float deep_alpha(Render *re, int obinr, int facenr, int strand)
 	return ma->shad_alpha;
 }
 
-static void compress_deepshadowbuf(Render *re, ShadBuf *shb, APixstr *apixbuf, APixstrand *apixbufstrand)
+/* compresses rows ystart to yend, apixbuf and apixbufstrand only hold these rows */
+static void compress_deepshadowbuf(Render *re, ShadBuf *shb, ShadSampleBuf *shsample, APixstr *apixbuf, APixstrand *apixbufstrand,
+                                   int ystart, int yend)
 {
-	ShadSampleBuf *shsample;
 	DeepSample *ds[RE_MAX_OSA], *sampleds[RE_MAX_OSA], *dsb, *newbuf;
 	APixstr *ap, *apn;
 	APixstrand *aps, *apns;
@@ -318,18 +320,14 @@ static void compress_deepshadowbuf(Render *re, ShadBuf *shb, APixstr *apixbuf, A
 	const float totbuf_f_inv= 1.0f/totbuf_f;
 	const int size= shb->size;
 
-	int a, b, c, tot, minz, found, prevtot, newtot;
-	int sampletot[RE_MAX_OSA], totsample = 0, totsamplec = 0;
-	
-	shsample= MEM_callocN(sizeof(ShadSampleBuf), "shad sample buf");
-	BLI_addtail(&shb->buffers, shsample);
+	const int end= yend*size;
 
-	shsample->totbuf = MEM_callocN(sizeof(int) * size * size, "deeptotbuf");
-	shsample->deepbuf = MEM_callocN(sizeof(DeepSample *) * size * size, "deepbuf");
+	int a, b, c, tot, minz, found, prevtot, newtot;
+	int sampletot[RE_MAX_OSA];
 
 	ap= apixbuf;
 	aps= apixbufstrand;
-	for (a=0; a<size*size; a++, ap++, aps++) {
+	for (a=ystart*size; a<end; a++, ap++, aps++) {
 		/* count number of samples */
 		for (c=0; c<totbuf; c++)
 			sampletot[c]= 0;
@@ -484,11 +482,9 @@ static void compress_deepshadowbuf(Render *re, ShadBuf *shb, APixstr *apixbuf, A
 		}
 
 		prevtot= shsample->totbuf[a];
-		totsample += prevtot;
 
 		newtot= compress_deepsamples(shsample->deepbuf[a], prevtot, shb->compressthresh);
 		shsample->totbuf[a]= newtot;
-		totsamplec += newtot;
 
 		if (newtot < prevtot) {
 			newbuf= MEM_mallocN(sizeof(DeepSample)*newtot, "cdeepsample");
@@ -499,33 +495,25 @@ static void compress_deepshadowbuf(Render *re, ShadBuf *shb, APixstr *apixbuf, A
 
 		MEM_freeN(sampleds[0]);
 	}
-
-	//printf("%d -> %d, ratio %f\n", totsample, totsamplec, (float)totsamplec/(float)totsample);
 }
 
-/* create Z tiles (for compression): this system is 24 bits!!! */
-static void compress_shadowbuf(ShadBuf *shb, int *rectz, int square)
+/* create Z tiles (for compression): this system is 24 bits!!!
+ * only rows ystart to yend are compressed, ystart is a multiple of the tile size */
+static void compress_shadowbuf(ShadBuf *shb, ShadSampleBuf *shsample, int *rectz, int square, int ystart, int yend)
 {
-	ShadSampleBuf *shsample;
 	float dist;
 	uintptr_t *ztile;
 	int *rz, *rz1, verg, verg1, size= shb->size;
 	int a, x, y, minx, miny, byt1, byt2;
 	char *rc, *rcline, *ctile, *zt;
 	
-	shsample= MEM_callocN(sizeof(ShadSampleBuf), "shad sample buf");
-	BLI_addtail(&shb->buffers, shsample);
-	
-	shsample->zbuf= MEM_mallocN(sizeof(uintptr_t)*(size*size)/256, "initshadbuf2");
-	shsample->cbuf= MEM_callocN((size*size)/256, "initshadbuf3");
-	
-	ztile= (uintptr_t *)shsample->zbuf;
-	ctile= shsample->cbuf;
+	ztile= (uintptr_t *)shsample->zbuf + (ystart/16)*(size/16);
+	ctile= shsample->cbuf + (ystart/16)*(size/16);
 	
 	/* help buffer */
 	rcline= MEM_mallocN(256*4+sizeof(int), "makeshadbuf2");
 	
-	for (y=0; y<size; y+=16) {
+	for (y=ystart; y<yend; y+=16) {
 		if (y< size/2) miny= y+15-size/2;
 		else miny= y-size/2;
 		
@@ -717,18 +705,102 @@ static void shadowbuf_autoclip(Render *re, LampRen *lar)
 	}
 }
 
+/* a band of rows of one shadow buffer, rasterized and compressed as a task */
+typedef struct ShadowBufBand {
+	Render *re;
+	LampRen *lar;
+	ShadSampleBuf *shsample;
+	int *rectz;
+	float *jitbuf;
+	int ystart, yend;
+} ShadowBufBand;
+
+static int shadowbuf_use_threads(Render *re)
+{
+	/* same condition as threaded_makeshadowbufs(), test_break is only threadsafe then */
+	return (G.is_rendering && re->r.threads > 1);
+}
+
+static int shadowbuf_init_bands(Render *re, LampRen *lar, ShadSampleBuf *shsample, float *jitbuf, ShadowBufBand **r_bands)
+{
+	ShadowBufBand *bands;
+	const int size= lar->shb->size;
+	/* bands are made of whole rows of 16x16 compression tiles */
+	const int tottile= size/16;
+	int a, totband= 1;
+
+	if (shadowbuf_use_threads(re))
+		totband= max_ii(1, min_ii(tottile, 4*re->r.threads));
+
+	bands= MEM_callocN(sizeof(ShadowBufBand)*totband, "ShadowBufBand");
+
+	for (a=0; a<totband; a++) {
+		bands[a].re= re;
+		bands[a].lar= lar;
+		bands[a].shsample= shsample;
+		bands[a].jitbuf= jitbuf;
+		bands[a].ystart= 16*((tottile*a)/totband);
+		bands[a].yend= (a == totband-1)? size: 16*((tottile*(a+1))/totband);
+	}
+
+	*r_bands= bands;
+	return totband;
+}
+
+static void shadowbuf_run_bands(ShadowBufBand *bands, int totband, TaskRunFunction run)
+{
+	if (totband == 1) {
+		run(NULL, &bands[0], 0);
+	}
+	else {
+		/* threaded malloc is already enabled by the lamp threads */
+		TaskPool *task_pool= BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+		int a;
+
+		for (a=0; a<totband; a++)
+			BLI_task_pool_push(task_pool, run, &bands[a], false, TASK_PRIORITY_HIGH);
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
+}
+
+static void makeflatshadowbuf_band(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ShadowBufBand *band= taskdata;
+	LampRen *lar= band->lar;
+	ShadBuf *shb= lar->shb;
+
+	zbuffer_shadow(band->re, shb->persmat, lar, band->rectz, shb->size, band->ystart, band->yend,
+	               band->jitbuf[0], band->jitbuf[1]);
+	/* create Z tiles (for compression): this system is 24 bits!!! */
+	compress_shadowbuf(shb, band->shsample, band->rectz, lar->mode & LA_SQUARE, band->ystart, band->yend);
+}
+
 static void makeflatshadowbuf(Render *re, LampRen *lar, float *jitbuf)
 {
 	ShadBuf *shb= lar->shb;
-	int *rectz, samples;
+	ShadSampleBuf *shsample;
+	ShadowBufBand *bands;
+	int *rectz, samples, a, totband;
+	const int size= shb->size;
 
 	/* zbuffering */
-	rectz= MEM_mapallocN(sizeof(int)*shb->size*shb->size, "makeshadbuf");
+	rectz= MEM_mapallocN(sizeof(int)*size*size, "makeshadbuf");
 	
 	for (samples=0; samples<shb->totbuf; samples++) {
-		zbuffer_shadow(re, shb->persmat, lar, rectz, shb->size, jitbuf[2*samples], jitbuf[2*samples+1]);
-		/* create Z tiles (for compression): this system is 24 bits!!! */
-		compress_shadowbuf(shb, rectz, lar->mode & LA_SQUARE);
+		shsample= MEM_callocN(sizeof(ShadSampleBuf), "shad sample buf");
+		BLI_addtail(&shb->buffers, shsample);
+
+		shsample->zbuf= MEM_mallocN(sizeof(uintptr_t)*(size*size)/256, "initshadbuf2");
+		shsample->cbuf= MEM_callocN((size*size)/256, "initshadbuf3");
+
+		totband= shadowbuf_init_bands(re, lar, shsample, jitbuf + 2*samples, &bands);
+		for (a=0; a<totband; a++)
+			bands[a].rectz= rectz;
+
+		shadowbuf_run_bands(bands, totband, makeflatshadowbuf_band);
+		MEM_freeN(bands);
 
 		if (re->test_break(re->tbh))
 			break;
@@ -737,23 +809,27 @@ static void makeflatshadowbuf(Render *re, LampRen *lar, float *jitbuf)
 	MEM_freeN(rectz);
 }
 
-static void makedeepshadowbuf(Render *re, LampRen *lar, float *jitbuf)
+static void makedeepshadowbuf_band(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
 {
+	ShadowBufBand *band= taskdata;
+	Render *re= band->re;
+	LampRen *lar= band->lar;
 	ShadBuf *shb= lar->shb;
 	APixstr *apixbuf;
 	APixstrand *apixbufstrand= NULL;
 	ListBase apsmbase= {NULL, NULL};
+	const int totpixel= shb->size*(band->yend - band->ystart);
 
-	/* zbuffering */
-	apixbuf= MEM_callocN(sizeof(APixstr)*shb->size*shb->size, "APixbuf");
+	/* zbuffering, each band has its own buffers so memory stays bounded */
+	apixbuf= MEM_callocN(sizeof(APixstr)*totpixel, "APixbuf");
 	if (re->totstrand)
-		apixbufstrand= MEM_callocN(sizeof(APixstrand)*shb->size*shb->size, "APixbufstrand");
+		apixbufstrand= MEM_callocN(sizeof(APixstrand)*totpixel, "APixbufstrand");
 
 	zbuffer_abuf_shadow(re, lar, shb->persmat, apixbuf, apixbufstrand, &apsmbase, shb->size,
-		shb->totbuf, (float(*)[2])jitbuf);
+		band->ystart, band->yend, shb->totbuf, (float(*)[2])band->jitbuf);
 
 	/* create Z tiles (for compression): this system is 24 bits!!! */
-	compress_deepshadowbuf(re, shb, apixbuf, apixbufstrand);
+	compress_deepshadowbuf(re, shb, band->shsample, apixbuf, apixbufstrand, band->ystart, band->yend);
 	
 	MEM_freeN(apixbuf);
 	if (apixbufstrand)
@@ -761,6 +837,25 @@ static void makedeepshadowbuf(Render *re, LampRen *lar, float *jitbuf)
 	freepsA(&apsmbase);
 }
 
+static void makedeepshadowbuf(Render *re, LampRen *lar, float *jitbuf)
+{
+	ShadBuf *shb= lar->shb;
+	ShadSampleBuf *shsample;
+	ShadowBufBand *bands;
+	const int size= shb->size;
+	int totband;
+
+	shsample= MEM_callocN(sizeof(ShadSampleBuf), "shad sample buf");
+	BLI_addtail(&shb->buffers, shsample);
+
+	shsample->totbuf = MEM_callocN(sizeof(int) * size * size, "deeptotbuf");
+	shsample->deepbuf = MEM_callocN(sizeof(DeepSample *) * size * size, "deepbuf");
+
+	totband= shadowbuf_init_bands(re, lar, shsample, jitbuf, &bands);
+	shadowbuf_run_bands(bands, totband, makedeepshadowbuf_band);
+	MEM_freeN(bands);
+}
+
 void makeshadowbuf(Render *re, LampRen *lar)
 {
 	ShadBuf *shb= lar->shb;
@@ -860,7 +955,9 @@ void threaded_makeshadowbufs(Render *re)
 	else
 		totthread = 1; /* preview render */
 
-	if (totthread <= 1) {
+	/* a single lamp still gets a thread, its buffer is split in bands that
+	 * are rasterized in parallel */
+	if (totthread == 0 || !shadowbuf_use_threads(re)) {
 		for (lar=re->lampren.first; lar; lar= lar->next) {
 			if (re->test_break(re->tbh)) break;
 			if (lar->shb) {
@@ -54,6 +54,8 @@
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BLF_translation.h"
 
@@ -95,6 +97,11 @@
 #define MAX_OCTREE_NODE_POINTS	8
 #define MAX_OCTREE_DEPTH		15
 
+/* trees with fewer points are built on a single thread, the root is split
+ * in PARALLEL_OCTREE_BLOCKS blocks of points to partition it in parallel */
+#define PARALLEL_OCTREE_MIN_POINTS	8192
+#define PARALLEL_OCTREE_BLOCKS		64
+
 /* Struct Definitions */
 
 struct ScatterSettings {
@@ -142,6 +149,7 @@ typedef struct ScatterNode {
 
 struct ScatterTree {
 	MemArena *arena;
+	MemArena *subarena[8];	/* per root octant, for threaded builds */
 
 	ScatterSettings *ss[3];
 	float error, scale;
@@ -652,10 +660,11 @@ static void subnode_middle(int i, float *mid, float *subsize, float *submid)
 	submid[2]= mid[2] + ((z)? subsize[2]: -subsize[2]);
 }
 
-static void create_octree_node(ScatterTree *tree, ScatterNode *node, float *mid, float *size, ScatterPoint **refpoints, int depth)
+static void create_octree_node(MemArena *arena, ScatterNode *node, float *mid, float *size,
+                               ScatterPoint **refpoints, ScatterPoint **tmppoints, int depth)
 {
 	ScatterNode *subnode;
-	ScatterPoint **subrefpoints, **tmppoints= tree->tmppoints;
+	ScatterPoint **subrefpoints;
 	int index, nsize[8], noffset[8], i, subco, used_nodes, usedi;
 	float submid[3], subsize[3];
 
@@ -699,7 +708,7 @@ static void create_octree_node(ScatterTree *tree, ScatterNode *node, float *mid,
 	
 	if (used_nodes <= 1) {
 		subnode_middle(usedi, mid, subsize, submid);
-		create_octree_node(tree, node, submid, subsize, refpoints, depth+1);
+		create_octree_node(arena, node, submid, subsize, refpoints, tmppoints, depth+1);
 		return;
 	}
 
@@ -713,7 +722,7 @@ static void create_octree_node(ScatterTree *tree, ScatterNode *node, float *mid,
 	/* create subnodes */
 	for (subco=0, i=0; i<8; subco+=nsize[i], i++) {
 		if (nsize[i] > 0) {
-			subnode= BLI_memarena_alloc(tree->arena, sizeof(ScatterNode));
+			subnode= BLI_memarena_alloc(arena, sizeof(ScatterNode));
 			node->child[i]= subnode;
 			subnode->points= node->points + subco;
 			subnode->totpoint= nsize[i];
@@ -721,8 +730,8 @@ static void create_octree_node(ScatterTree *tree, ScatterNode *node, float *mid,
 
 			subnode_middle(i, mid, subsize, submid);
 
-			create_octree_node(tree, subnode, submid, subsize, subrefpoints,
-				depth+1);
+			create_octree_node(arena, subnode, submid, subsize, subrefpoints,
+				tmppoints + subco, depth+1);
 		}
 		else
 			node->child[i]= NULL;
@@ -732,6 +741,164 @@ static void create_octree_node(ScatterTree *tree, ScatterNode *node, float *mid,
 	node->totpoint= 0;
 }
 
+/* Threaded build: the points of the root node are partitioned into octants
+ * in fixed blocks, each block counting its octant sizes in parallel. A prefix
+ * sum over the blocks then gives every block its own output offsets, so the
+ * scatter runs in parallel too and keeps the point order of a serial build.
+ * The eight octants are built as independent subtrees, each with its own
+ * memory arena, and only the root radiance is summed afterwards. */
+
+typedef struct OctreeBuildData {
+	ScatterTree *tree;
+	ScatterNode *root;
+	ScatterPoint **refpoints;
+	ScatterPoint **tmppoints;
+	int blocksize;
+	int (*blockoffset)[8];
+	int nsize[8], noffset[8];
+	float mid[3], size[3];
+} OctreeBuildData;
+
+static void octree_block_count(void *userdata, int start, int stop)
+{
+	OctreeBuildData *data = userdata;
+	ScatterNode *root = data->root;
+	int block, i;
+
+	for (block = start; block < stop; block++) {
+		int *count = data->blockoffset[block];
+		int first = block * data->blocksize;
+		int last = min_ii(first + data->blocksize, root->totpoint);
+
+		memset(count, 0, sizeof(int) * 8);
+
+		for (i = first; i < last; i++) {
+			data->tmppoints[i] = data->refpoints[i];
+			count[SUBNODE_INDEX(data->refpoints[i]->co, root->split)]++;
+		}
+	}
+}
+
+static void octree_block_scatter(void *userdata, int start, int stop)
+{
+	OctreeBuildData *data = userdata;
+	ScatterNode *root = data->root;
+	int block, i, index;
+
+	for (block = start; block < stop; block++) {
+		int *offset = data->blockoffset[block];
+		int first = block * data->blocksize;
+		int last = min_ii(first + data->blocksize, root->totpoint);
+
+		for (i = first; i < last; i++) {
+			index = SUBNODE_INDEX(data->tmppoints[i]->co, root->split);
+			data->refpoints[offset[index]++] = data->tmppoints[i];
+		}
+	}
+}
+
+static void octree_build_subtree(void *userdata, int start, int stop)
+{
+	OctreeBuildData *data = userdata;
+	ScatterTree *tree = data->tree;
+	ScatterNode *subnode;
+	float subsize[3], submid[3];
+	int i, subco;
+
+	mul_v3_v3fl(subsize, data->size, 0.5f);
+
+	for (i = start; i < stop; i++) {
+		if (data->nsize[i] == 0) {
+			data->root->child[i] = NULL;
+			continue;
+		}
+
+		subco = data->noffset[i];
+
+		tree->subarena[i] = BLI_memarena_new(0x1000 * sizeof(ScatterNode), "sss subtree arena");
+		BLI_memarena_use_calloc(tree->subarena[i]);
+
+		subnode = BLI_memarena_alloc(tree->subarena[i], sizeof(ScatterNode));
+		subnode->points = data->root->points + subco;
+		subnode->totpoint = data->nsize[i];
+
+		subnode_middle(i, data->mid, subsize, submid);
+		create_octree_node(tree->subarena[i], subnode, submid, subsize,
+		                   data->refpoints + subco, data->tmppoints + subco, 1);
+
+		sum_radiance(tree, subnode);
+		data->root->child[i] = subnode;
+	}
+}
+
+/* returns false if the root has only one used octant, in which case the
+ * caller falls back to the serial build */
+static bool create_octree_root_threaded(ScatterTree *tree, float *mid, float *size)
+{
+	OctreeBuildData data;
+	ScatterNode *root = tree->root;
+	int totblock, block, i, used_nodes;
+
+	memset(&data, 0, sizeof(data));
+	data.tree = tree;
+	data.root = root;
+	data.refpoints = tree->refpoints;
+	data.tmppoints = tree->tmppoints;
+	data.blocksize = (root->totpoint + PARALLEL_OCTREE_BLOCKS - 1) / PARALLEL_OCTREE_BLOCKS;
+	copy_v3_v3(data.mid, mid);
+	copy_v3_v3(data.size, size);
+
+	totblock = (root->totpoint + data.blocksize - 1) / data.blocksize;
+	data.blockoffset = MEM_mallocN(sizeof(*data.blockoffset) * totblock, "sss octree blocks");
+
+	copy_v3_v3(root->split, mid);
+
+	/* count points in subnodes, per block */
+	BLI_task_parallel_range_ex(0, totblock, &data, octree_block_count, 1);
+
+	for (block = 0; block < totblock; block++)
+		for (i = 0; i < 8; i++)
+			data.nsize[i] += data.blockoffset[block][i];
+
+	for (used_nodes = 0, i = 0; i < 8; i++) {
+		if (data.nsize[i])
+			used_nodes++;
+		if (i != 0)
+			data.noffset[i] = data.noffset[i-1] + data.nsize[i-1];
+	}
+
+	if (used_nodes <= 1) {
+		MEM_freeN(data.blockoffset);
+		return false;
+	}
+
+	/* turn block counts into output offsets, in block order */
+	for (i = 0; i < 8; i++) {
+		int offset = data.noffset[i], count;
+
+		for (block = 0; block < totblock; block++) {
+			count = data.blockoffset[block][i];
+			data.blockoffset[block][i] = offset;
+			offset += count;
+		}
+	}
+
+	/* reorder refpoints by subnode */
+	BLI_task_parallel_range_ex(0, totblock, &data, octree_block_scatter, 1);
+	MEM_freeN(data.blockoffset);
+
+	/* create and sum subtrees */
+	BLI_task_parallel_range_ex(0, 8, &data, octree_build_subtree, 1);
+
+	/* only now the leaves are copied, as the subtrees read refpoints */
+	root->points = NULL;
+	root->totpoint = 0;
+
+	sum_branch_radiance(tree, root);
+
+	return true;
+}
+
 /* public functions */
 
 ScatterTree *scatter_tree_new(ScatterSettings *ss[3], float scale, float error,
@@ -780,6 +947,7 @@ void scatter_tree_build(ScatterTree *tree)
 	ScatterPoint *newpoints, **tmppoints;
 	float mid[3], size[3];
 	int totpoint= tree->totpoint;
+	bool threaded = false;
 
 	newpoints = MEM_callocN(sizeof(ScatterPoint) * totpoint, "ScatterPoints");
 	tmppoints = MEM_callocN(sizeof(ScatterPoint *) * totpoint, "ScatterTmpPoints");
@@ -801,7 +969,11 @@ void scatter_tree_build(ScatterTree *tree)
 	size[1]= (tree->max[1]-tree->min[1])*0.5f;
 	size[2]= (tree->max[2]-tree->min[2])*0.5f;
 
-	create_octree_node(tree, tree->root, mid, size, tree->refpoints, 0);
+	if (totpoint >= PARALLEL_OCTREE_MIN_POINTS && BLI_system_thread_count() > 1)
+		threaded = create_octree_root_threaded(tree, mid, size);
+
+	if (!threaded)
+		create_octree_node(tree->arena, tree->root, mid, size, tree->refpoints, tree->tmppoints, 0);
 
 	MEM_freeN(tree->points);
 	MEM_freeN(tree->refpoints);
@@ -810,8 +982,9 @@ void scatter_tree_build(ScatterTree *tree)
 	tree->tmppoints= NULL;
 	tree->points= newpoints;
 	
-	/* sum radiance at nodes */
-	sum_radiance(tree, tree->root);
+	/* sum radiance at nodes, already done by the threaded build */
+	if (!threaded)
+		sum_radiance(tree, tree->root);
 }
 
 void scatter_tree_sample(ScatterTree *tree, const float co[3], float color[3])
@@ -826,7 +999,11 @@ void scatter_tree_sample(ScatterTree *tree, const float co[3], float color[3])
 
 void scatter_tree_free(ScatterTree *tree)
 {
+	int i;
+
 	if (tree->arena) BLI_memarena_free(tree->arena);
+	for (i = 0; i < 8; i++)
+		if (tree->subarena[i]) BLI_memarena_free(tree->subarena[i]);
 	if (tree->points) MEM_freeN(tree->points);
 	if (tree->refpoints) MEM_freeN(tree->refpoints);
 		
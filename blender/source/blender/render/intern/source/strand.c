@@ -26,6 +26,7 @@
 
 
 #include <math.h>
+#include <float.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -41,6 +42,7 @@
 #include "BLI_ghash.h"
 #include "BLI_memarena.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 
 #include "BKE_DerivedMesh.h"
 #include "BKE_key.h"
@@ -778,6 +780,386 @@ void render_strand_segment(Render *re, float winmat[4][4], StrandPart *spart, ZS
 }
 
 /* render call to fill in strands */
+/* ********** Screen space binning ********** */
+
+/* Before the parts are rendered, all strand segments are projected once and
+ * stored in bins of STRAND_BIN_SIZE pixels they may overlap, so a part only
+ * looks at the segments of its own bins instead of all strands in the scene.
+ * Segments covering many bins, or crossing the camera plane, go into one
+ * extra bin visited by every part. The bins are conservative, parts still do
+ * the exact clip test on the segments they find. */
+
+#define STRAND_BIN_SIZE			32
+#define STRAND_BIN_MAX_CELLS	16
+#define STRAND_BIN_BLOCK		1024
+
+typedef struct StrandBinSegment {
+	int obi, strand, segment;
+	short cellx, celly;		/* first bin of the segment, to visit it once per part */
+} StrandBinSegment;
+
+typedef struct StrandBinRecord {
+	StrandBinSegment seg;
+	short maxx, maxy;		/* last bin, or -1 for all bins */
+} StrandBinRecord;
+
+typedef struct StrandBinInstance {
+	float obwinmat[4][4];
+	float widthx, widthy;
+} StrandBinInstance;
+
+struct StrandBins {
+	int totx, toty;
+	int *start;					/* first segment per bin, the last bin is for all parts */
+	StrandBinSegment *segment;
+	StrandBinInstance *instance;
+	int totinstance;
+};
+
+typedef struct StrandBinBlock {
+	int obi, start, end;
+	StrandBinRecord *record;
+	int totrecord;
+} StrandBinBlock;
+
+typedef struct StrandBinBuildData {
+	Render *re;
+	StrandBins *bins;
+	StrandBinBlock *block;
+} StrandBinBuildData;
+
+/* pixel space extent of a projected point, with a margin for subpixel
+ * offsets; returns 0 if the point is not in front of the camera */
+static int strand_bin_point(Render *re, StrandBinInstance *inst, const float co[3], float min[2], float max[2])
+{
+	float hoco[4], invw;
+
+	projectvert(co, inst->obwinmat, hoco);
+
+	if (hoco[3] <= 1e-6f)
+		return 0;
+
+	invw = 1.0f / hoco[3];
+	min[0] = 0.5f * re->winx * (1.0f + (hoco[0] - inst->widthx) * invw) - 1.0f;
+	max[0] = 0.5f * re->winx * (1.0f + (hoco[0] + inst->widthx) * invw) + 1.0f;
+	min[1] = 0.5f * re->winy * (1.0f + (hoco[1] - inst->widthy) * invw) - 1.0f;
+	max[1] = 0.5f * re->winy * (1.0f + (hoco[1] + inst->widthy) * invw) + 1.0f;
+
+	return 1;
+}
+
+static void strand_bins_block(void *userdata, int start, int stop)
+{
+	StrandBinBuildData *data = userdata;
+	Render *re = data->re;
+	StrandBins *bins = data->bins;
+	int blocknr, a, b, c, x0, x1, y0, y1;
+
+	for (blocknr = start; blocknr < stop; blocknr++) {
+		StrandBinBlock *block = &data->block[blocknr];
+		StrandBinInstance *inst = &bins->instance[block->obi];
+		ObjectRen *obr = re->objectinstance[block->obi].obr;
+		float (*pmin)[2] = NULL, (*pmax)[2] = NULL;
+		int *pvalid = NULL, totpoint = 0, totrecord = 0;
+
+		for (a = block->start; a < block->end; a++)
+			totrecord += max_ii(RE_findOrAddStrand(obr, a)->totvert - 1, 0);
+
+		block->record = MEM_mallocN(sizeof(StrandBinRecord) * max_ii(totrecord, 1), "StrandBinRecord");
+
+		for (a = block->start; a < block->end; a++) {
+			StrandRen *strand = RE_findOrAddStrand(obr, a);
+			StrandVert *svert = strand->vert;
+
+			if (strand->totvert < 2)
+				continue;
+
+			if (strand->totvert > totpoint) {
+				if (pmin) {
+					MEM_freeN(pmin);
+					MEM_freeN(pmax);
+					MEM_freeN(pvalid);
+				}
+				totpoint = strand->totvert;
+				pmin = MEM_mallocN(sizeof(*pmin) * totpoint, "StrandBinMin");
+				pmax = MEM_mallocN(sizeof(*pmax) * totpoint, "StrandBinMax");
+				pvalid = MEM_mallocN(sizeof(int) * totpoint, "StrandBinValid");
+			}
+
+			for (b = 0; b < strand->totvert; b++)
+				pvalid[b] = strand_bin_point(re, inst, svert[b].co, pmin[b], pmax[b]);
+
+			/* same 4 control points as the clip test in zbuffer_strands_abuf */
+			for (b = 0; b < strand->totvert - 1; b++) {
+				int first = max_ii(b - 1, 0), last = min_ii(b + 2, strand->totvert - 1);
+				float min[2] = {FLT_MAX, FLT_MAX}, max[2] = {-FLT_MAX, -FLT_MAX};
+				StrandBinRecord *rec;
+				int valid = 1;
+
+				for (c = first; c <= last; c++) {
+					if (!pvalid[c]) {
+						valid = 0;
+						break;
+					}
+					min[0] = min_ff(min[0], pmin[c][0]);
+					min[1] = min_ff(min[1], pmin[c][1]);
+					max[0] = max_ff(max[0], pmax[c][0]);
+					max[1] = max_ff(max[1], pmax[c][1]);
+				}
+
+				if (valid) {
+					/* not on screen */
+					if (max[0] < 0.0f || max[1] < 0.0f || min[0] >= re->winx || min[1] >= re->winy)
+						continue;
+
+					x0 = (int)max_ff(min[0], 0.0f) / STRAND_BIN_SIZE;
+					y0 = (int)max_ff(min[1], 0.0f) / STRAND_BIN_SIZE;
+					x1 = min_ii((int)min_ff(max[0], (float)re->winx) / STRAND_BIN_SIZE, bins->totx - 1);
+					y1 = min_ii((int)min_ff(max[1], (float)re->winy) / STRAND_BIN_SIZE, bins->toty - 1);
+
+					if ((x1 - x0 + 1) * (y1 - y0 + 1) > STRAND_BIN_MAX_CELLS)
+						valid = 0;
+				}
+
+				rec = &block->record[block->totrecord++];
+				rec->seg.obi = block->obi;
+				rec->seg.strand = a;
+				rec->seg.segment = b;
+
+				if (valid) {
+					rec->seg.cellx = x0;
+					rec->seg.celly = y0;
+					rec->maxx = x1;
+					rec->maxy = y1;
+				}
+				else {
+					rec->seg.cellx = rec->seg.celly = 0;
+					rec->maxx = rec->maxy = -1;
+				}
+			}
+		}
+
+		if (pmin) {
+			MEM_freeN(pmin);
+			MEM_freeN(pmax);
+			MEM_freeN(pvalid);
+		}
+	}
+}
+
+StrandBins *strand_bins_build(Render *re)
+{
+	StrandBinBuildData data;
+	StrandBins *bins;
+	StrandBinBlock *block;
+	StrandBinRecord *rec;
+	ObjectInstanceRen *obi;
+	ObjectRen *obr;
+	StrandBound *sbound;
+	float winmat[4][4];
+	int a, b, c, i, x, y, totblock, totbin, offset, *count;
+
+	bins = MEM_callocN(sizeof(StrandBins), "StrandBins");
+	bins->totx = (re->winx + STRAND_BIN_SIZE - 1) / STRAND_BIN_SIZE;
+	bins->toty = (re->winy + STRAND_BIN_SIZE - 1) / STRAND_BIN_SIZE;
+	bins->totinstance = re->totinstance;
+	bins->instance = MEM_callocN(sizeof(StrandBinInstance) * max_ii(re->totinstance, 1), "StrandBinInstance");
+	totbin = bins->totx * bins->toty + 1;
+
+	zbuf_make_winmat(re, winmat);
+
+	/* blocks of strands, from the bounds used in zbuffer_strands_abuf */
+	totblock = 0;
+	for (obi = re->instancetable.first; obi; obi = obi->next) {
+		obr = obi->obr;
+		if (!obr->strandbuf || (obr->strandbuf->ma->mode & MA_ONLYCAST))
+			continue;
+
+		sbound = obr->strandbuf->bound;
+		for (c = 0; c < obr->strandbuf->totbound; c++, sbound++)
+			totblock += (sbound->end - sbound->start + STRAND_BIN_BLOCK - 1) / STRAND_BIN_BLOCK;
+	}
+
+	block = MEM_callocN(sizeof(StrandBinBlock) * max_ii(totblock, 1), "StrandBinBlock");
+
+	for (obi = re->instancetable.first, i = 0, b = 0; obi; obi = obi->next, i++) {
+		StrandBinInstance *inst = &bins->instance[i];
+
+		obr = obi->obr;
+		if (!obr->strandbuf || (obr->strandbuf->ma->mode & MA_ONLYCAST))
+			continue;
+
+		if (obi->flag & R_TRANSFORMED)
+			mul_m4_m4m4(inst->obwinmat, winmat, obi->mat);
+		else
+			copy_m4_m4(inst->obwinmat, winmat);
+
+		inst->widthx = obr->strandbuf->maxwidth * inst->obwinmat[0][0];
+		inst->widthy = obr->strandbuf->maxwidth * inst->obwinmat[1][1];
+
+		sbound = obr->strandbuf->bound;
+		for (c = 0; c < obr->strandbuf->totbound; c++, sbound++) {
+			for (a = sbound->start; a < sbound->end; a += STRAND_BIN_BLOCK, b++) {
+				block[b].obi = i;
+				block[b].start = a;
+				block[b].end = min_ii(a + STRAND_BIN_BLOCK, sbound->end);
+			}
+		}
+	}
+
+	/* project strands in parallel */
+	data.re = re;
+	data.bins = bins;
+	data.block = block;
+	BLI_task_parallel_range_ex(0, totblock, &data, strand_bins_block, 1);
+
+	/* count segments per bin, and fill in block order */
+	count = MEM_callocN(sizeof(int) * totbin, "StrandBinCount");
+
+	for (b = 0; b < totblock; b++) {
+		for (a = 0, rec = block[b].record; a < block[b].totrecord; a++, rec++) {
+			if (rec->maxx == -1)
+				count[totbin - 1]++;
+			else
+				for (y = rec->seg.celly; y <= rec->maxy; y++)
+					for (x = rec->seg.cellx; x <= rec->maxx; x++)
+						count[y * bins->totx + x]++;
+		}
+	}
+
+	bins->start = MEM_mallocN(sizeof(int) * (totbin + 1), "StrandBinStart");
+	for (a = 0, offset = 0; a < totbin; a++) {
+		bins->start[a] = offset;
+		offset += count[a];
+		count[a] = bins->start[a];
+	}
+	bins->start[totbin] = offset;
+
+	bins->segment = MEM_mallocN(sizeof(StrandBinSegment) * max_ii(offset, 1), "StrandBinSegment");
+
+	for (b = 0; b < totblock; b++) {
+		for (a = 0, rec = block[b].record; a < block[b].totrecord; a++, rec++) {
+			if (rec->maxx == -1)
+				bins->segment[count[totbin - 1]++] = rec->seg;
+			else
+				for (y = rec->seg.celly; y <= rec->maxy; y++)
+					for (x = rec->seg.cellx; x <= rec->maxx; x++)
+						bins->segment[count[y * bins->totx + x]++] = rec->seg;
+		}
+
+		if (block[b].record)
+			MEM_freeN(block[b].record);
+	}
+
+	MEM_freeN(count);
+	MEM_freeN(block);
+
+	return bins;
+}
+
+void strand_bins_free(StrandBins *bins)
+{
+	MEM_freeN(bins->start);
+	MEM_freeN(bins->segment);
+	MEM_freeN(bins->instance);
+	MEM_freeN(bins);
+}
+
+/* exact clip test of one segment, like the strand loop in zbuffer_strands_abuf */
+static int strand_segment_clip(float obwinmat[4][4], ZSpan *zspan, float *bounds, StrandRen *strand, int segment,
+                               float widthx, float widthy, float *zcomp)
+{
+	StrandVert *svert = strand->vert + segment;
+	float z[4];
+	int clip[4];
+
+	clip[1] = strand_test_clip(obwinmat, zspan, bounds, svert->co, &z[1], widthx, widthy);
+	clip[2] = strand_test_clip(obwinmat, zspan, bounds, (svert + 1)->co, &z[2], widthx, widthy);
+
+	if (segment > 0)
+		clip[0] = strand_test_clip(obwinmat, zspan, bounds, (svert - 1)->co, &z[0], widthx, widthy);
+	else
+		clip[0] = clip[1];
+
+	if (segment < strand->totvert - 2)
+		clip[3] = strand_test_clip(obwinmat, zspan, bounds, (svert + 2)->co, &z[3], widthx, widthy);
+	else
+		clip[3] = clip[2];
+
+	*zcomp = 0.5f * (z[1] + z[2]);
+
+	return (clip[0] & clip[1] & clip[2] & clip[3]);
+}
+
+/* add the segments binned for this part to the sort list */
+static int strand_bins_gather(Render *re, StrandBins *bins, RenderPart *pa, ZSpan *zspan, float *bounds,
+                              unsigned int lay, MemArena *memarena, StrandSortSegment **firstseg)
+{
+	StrandBinSegment *bseg;
+	StrandSortSegment *sortseg;
+	int x, y, x0, y0, x1, y1, a, bin, totsegment = 0;
+
+	x0 = max_ii(pa->disprect.xmin / STRAND_BIN_SIZE, 0);
+	y0 = max_ii(pa->disprect.ymin / STRAND_BIN_SIZE, 0);
+	x1 = min_ii(pa->disprect.xmax / STRAND_BIN_SIZE, bins->totx - 1);
+	y1 = min_ii(pa->disprect.ymax / STRAND_BIN_SIZE, bins->toty - 1);
+
+	for (y = y0; y <= y1 + 1; y++) {
+		for (x = x0; x <= x1; x++) {
+			/* the extra bin with segments for all parts is done last */
+			if (y == y1 + 1) {
+				if (x != x0)
+					break;
+				bin = bins->totx * bins->toty;
+			}
+			else
+				bin = y * bins->totx + x;
+
+			for (a = bins->start[bin]; a < bins->start[bin + 1]; a++) {
+				ObjectInstanceRen *obi;
+				StrandBinInstance *inst;
+				StrandRen *strand;
+				float z;
+
+				bseg = &bins->segment[a];
+
+				/* segments in several bins of this part are added once */
+				if (bin != bins->totx * bins->toty)
+					if (x != max_ii(x0, bseg->cellx) || y != max_ii(y0, bseg->celly))
+						continue;
+
+				obi = &re->objectinstance[bseg->obi];
+				if (!(obi->obr->strandbuf->lay & lay))
+					continue;
+
+				inst = &bins->instance[bseg->obi];
+				strand = RE_findOrAddStrand(obi->obr, bseg->strand);
+
+				if (strand_segment_clip(inst->obwinmat, zspan, bounds, strand, bseg->segment,
+				                        inst->widthx, inst->widthy, &z))
+				{
+					continue;
+				}
+
+				sortseg = BLI_memarena_alloc(memarena, sizeof(StrandSortSegment));
+				sortseg->obi = bseg->obi;
+				sortseg->strand = strand->index;
+				sortseg->segment = bseg->segment;
+				sortseg->z = z;
+
+				sortseg->next = *firstseg;
+				*firstseg = sortseg;
+				totsegment++;
+			}
+
+			if (re->test_break(re->tbh))
+				return totsegment;
+		}
+	}
+
+	return totsegment;
+}
+
 int zbuffer_strands_abuf(Render *re, RenderPart *pa, APixstrand *apixbuf, ListBase *apsmbase, unsigned int lay, int UNUSED(negzmask), float winmat[4][4], int winx, int winy, int samples, float (*jit)[2], float clipcrop, int shadow, StrandShadeCache *cache)
 {
 	ObjectRen *obr;
@@ -841,79 +1223,85 @@ int zbuffer_strands_abuf(Render *re, RenderPart *pa, APixstrand *apixbuf, ListBa
 	firstseg= NULL;
 	totsegment= 0;
 
-	/* for all object instances */
-	for (obi=re->instancetable.first, i=0; obi; obi=obi->next, i++) {
-		Material *ma;
-		float widthx, widthy;
-
-		obr= obi->obr;
-
-		if (!obr->strandbuf || !(obr->strandbuf->lay & lay))
-			continue;
-
-		/* compute matrix and try clipping whole object */
-		if (obi->flag & R_TRANSFORMED)
-			mul_m4_m4m4(obwinmat, winmat, obi->mat);
-		else
-			copy_m4_m4(obwinmat, winmat);
-
-		/* test if we should skip it */
-		ma = obr->strandbuf->ma;
-
-		if (shadow && !(ma->mode & MA_SHADBUF))
-			continue;
-		else if (!shadow && (ma->mode & MA_ONLYCAST))
-			continue;
+	if (!shadow && re->strandbins) {
+		/* segments binned for this part, see strand_bins_build() */
+		totsegment= strand_bins_gather(re, re->strandbins, pa, &zspan, bounds, lay, memarena, &firstseg);
+	}
+	else {
+		/* for all object instances */
+		for (obi=re->instancetable.first, i=0; obi; obi=obi->next, i++) {
+			Material *ma;
+			float widthx, widthy;
 
-		if (clip_render_object(obi->obr->boundbox, bounds, obwinmat))
-			continue;
-		
-		widthx= obr->strandbuf->maxwidth*obwinmat[0][0];
-		widthy= obr->strandbuf->maxwidth*obwinmat[1][1];
+			obr= obi->obr;
 
-		/* for each bounding box containing a number of strands */
-		sbound= obr->strandbuf->bound;
-		for (c=0; c<obr->strandbuf->totbound; c++, sbound++) {
-			if (clip_render_object(sbound->boundbox, bounds, obwinmat))
+			if (!obr->strandbuf || !(obr->strandbuf->lay & lay))
 				continue;
 
-			/* for each strand in this bounding box */
-			for (a=sbound->start; a<sbound->end; a++) {
-				strand= RE_findOrAddStrand(obr, a);
-				svert= strand->vert;
+			/* compute matrix and try clipping whole object */
+			if (obi->flag & R_TRANSFORMED)
+				mul_m4_m4m4(obwinmat, winmat, obi->mat);
+			else
+				copy_m4_m4(obwinmat, winmat);
 
-				/* keep clipping and z depth for 4 control points */
-				clip[1]= strand_test_clip(obwinmat, &zspan, bounds, svert->co, &z[1], widthx, widthy);
-				clip[2]= strand_test_clip(obwinmat, &zspan, bounds, (svert+1)->co, &z[2], widthx, widthy);
-				clip[0]= clip[1]; z[0]= z[1];
+			/* test if we should skip it */
+			ma = obr->strandbuf->ma;
 
-				for (b=0; b<strand->totvert-1; b++, svert++) {
-					/* compute 4th point clipping and z depth */
-					if (b < strand->totvert-2) {
-						clip[3]= strand_test_clip(obwinmat, &zspan, bounds, (svert+2)->co, &z[3], widthx, widthy);
-					}
-					else {
-						clip[3]= clip[2]; z[3]= z[2];
-					}
-
-					/* check clipping and add to sortsegments buffer */
-					if (!(clip[0] & clip[1] & clip[2] & clip[3])) {
-						sortseg= BLI_memarena_alloc(memarena, sizeof(StrandSortSegment));
-						sortseg->obi= i;
-						sortseg->strand= strand->index;
-						sortseg->segment= b;
+			if (shadow && !(ma->mode & MA_SHADBUF))
+				continue;
+			else if (!shadow && (ma->mode & MA_ONLYCAST))
+				continue;
 
-						sortseg->z= 0.5f*(z[1] + z[2]);
+			if (clip_render_object(obi->obr->boundbox, bounds, obwinmat))
+				continue;
+		
+			widthx= obr->strandbuf->maxwidth*obwinmat[0][0];
+			widthy= obr->strandbuf->maxwidth*obwinmat[1][1];
+
+			/* for each bounding box containing a number of strands */
+			sbound= obr->strandbuf->bound;
+			for (c=0; c<obr->strandbuf->totbound; c++, sbound++) {
+				if (clip_render_object(sbound->boundbox, bounds, obwinmat))
+					continue;
+
+				/* for each strand in this bounding box */
+				for (a=sbound->start; a<sbound->end; a++) {
+					strand= RE_findOrAddStrand(obr, a);
+					svert= strand->vert;
+
+					/* keep clipping and z depth for 4 control points */
+					clip[1]= strand_test_clip(obwinmat, &zspan, bounds, svert->co, &z[1], widthx, widthy);
+					clip[2]= strand_test_clip(obwinmat, &zspan, bounds, (svert+1)->co, &z[2], widthx, widthy);
+					clip[0]= clip[1]; z[0]= z[1];
 
-						sortseg->next= firstseg;
-						firstseg= sortseg;
-						totsegment++;
+					for (b=0; b<strand->totvert-1; b++, svert++) {
+						/* compute 4th point clipping and z depth */
+						if (b < strand->totvert-2) {
+							clip[3]= strand_test_clip(obwinmat, &zspan, bounds, (svert+2)->co, &z[3], widthx, widthy);
+						}
+						else {
+							clip[3]= clip[2]; z[3]= z[2];
+						}
+
+						/* check clipping and add to sortsegments buffer */
+						if (!(clip[0] & clip[1] & clip[2] & clip[3])) {
+							sortseg= BLI_memarena_alloc(memarena, sizeof(StrandSortSegment));
+							sortseg->obi= i;
+							sortseg->strand= strand->index;
+							sortseg->segment= b;
+
+							sortseg->z= 0.5f*(z[1] + z[2]);
+
+							sortseg->next= firstseg;
+							firstseg= sortseg;
+							totsegment++;
+						}
+
+						/* shift clipping and z depth */
+						clip[0]= clip[1]; z[0]= z[1];
+						clip[1]= clip[2]; z[1]= z[2];
+						clip[2]= clip[3]; z[2]= z[3];
 					}
-
-					/* shift clipping and z depth */
-					clip[0]= clip[1]; z[0]= z[1];
-					clip[1]= clip[2]; z[1]= z[2];
-					clip[2]= clip[3]; z[2]= z[3];
 				}
 			}
 		}
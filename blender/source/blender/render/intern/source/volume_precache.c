@@ -330,28 +330,53 @@ static float total_ms_energy(Render *re, int do_test_break, float *sr, float *sg
 	return energy;
 }
 
+typedef struct MSDiffuseData {
+	Render *re;
+	int do_test_break;
+	float *x0, *x;
+	float a;
+	int *n;
+} MSDiffuseData;
+
+static void ms_diffuse_slices(void *userdata, int start, int stop)
+{
+	MSDiffuseData *data = userdata;
+	const float *x0 = data->x0;
+	float *x = data->x;
+	const float a = data->a;
+	int *n = data->n;
+	int i, j, k;
+
+	for (k=start; k<stop; k++) {
+		for (j=1; j<=n[1]; j++) {
+			for (i=1; i<=n[0]; i++) {
+			   x[v_I_pad(i, j, k, n)] = (x0[v_I_pad(i, j, k, n)]) + a*(	x0[v_I_pad(i-1, j, k, n)]+ x0[v_I_pad(i+1, j, k, n)]+ x0[v_I_pad(i, j-1, k, n)]+
+																	x0[v_I_pad(i, j+1, k, n)]+ x0[v_I_pad(i, j, k-1, n)]+x0[v_I_pad(i, j, k+1, n)]
+																	) / (1+6*a);
+			}
+		}
+
+		if (data->do_test_break && data->re->test_break(data->re->tbh)) break;
+	}
+}
+
+/* x is only written from x0, so slices are independent and run in parallel.
+ * this used to loop 20 times over the same update, which always gave the
+ * result of the first pass, so it is done once now. */
 static void ms_diffuse(Render *re, int do_test_break, float *x0, float *x, float diff, int *n) //n is the unpadded resolution
 {
-	int i, j, k, l;
+	MSDiffuseData data;
 	const float dt = VOL_MS_TIMESTEP;
 	size_t size = n[0]*n[1]*n[2];
-	const float a = dt*diff*size;
-	
-	for (l=0; l<20; l++) {
-		for (k=1; k<=n[2]; k++) {
-			for (j=1; j<=n[1]; j++) {
-				for (i=1; i<=n[0]; i++) {
-				   x[v_I_pad(i, j, k, n)] = (x0[v_I_pad(i, j, k, n)]) + a*(	x0[v_I_pad(i-1, j, k, n)]+ x0[v_I_pad(i+1, j, k, n)]+ x0[v_I_pad(i, j-1, k, n)]+
-																		x0[v_I_pad(i, j+1, k, n)]+ x0[v_I_pad(i, j, k-1, n)]+x0[v_I_pad(i, j, k+1, n)]
-																		) / (1+6*a);
-				}
-			}
 
-			if (do_test_break && re->test_break(re->tbh)) break;
-		}
+	data.re = re;
+	data.do_test_break = do_test_break;
+	data.x0 = x0;
+	data.x = x;
+	data.a = dt*diff*size;
+	data.n = n;
 
-		if (re->test_break(re->tbh)) break;
-	}
+	BLI_task_parallel_range_ex(1, n[2]+1, &data, ms_diffuse_slices, 2);
 }
 
 static void multiple_scattering_diffusion(Render *re, VolumePrecache *vp, Material *ma)
@@ -588,12 +613,10 @@ static void precache_setup_shadeinput(Render *re, ObjectInstanceRen *obi, Materi
 	shi->lay = re->lay;
 }
 
-static void precache_launch_parts(Render *re, RayObject *tree, ShadeInput *shi, ObjectInstanceRen *obi)
+static void precache_launch_parts(Render *re, TaskPool *task_pool, RayObject *tree, ShadeInput *shi, ObjectInstanceRen *obi)
 {
-	TaskScheduler *task_scheduler;
-	TaskPool *task_pool;
+	VolPrecacheState *state = BLI_task_pool_userdata(task_pool);
 	VolumePrecache *vp = obi->volume_precache;
-	VolPrecacheState state;
 	int i=0, x, y, z;
 	float voxel[3];
 	int sizex, sizey, sizez;
@@ -611,13 +634,7 @@ static void precache_launch_parts(Render *re, RayObject *tree, ShadeInput *shi,
 	parts[0] = parts[1] = parts[2] = totthread;
 	res = vp->res;
 	
-	/* setup task scheduler */
-	memset(&state, 0, sizeof(state));
-	state.totparts = parts[0]*parts[1]*parts[2];
-	state.lasttime = PIL_check_seconds_timer();
-	
-	task_scheduler = BLI_task_scheduler_create(totthread);
-	task_pool = BLI_task_pool_create(task_scheduler, &state);
+	state->totparts += parts[0]*parts[1]*parts[2];
 
 	/* using boundbox in worldspace */
 	global_bounds_obi(re, obi, bbmin, bbmax);
@@ -668,13 +685,6 @@ static void precache_launch_parts(Render *re, RayObject *tree, ShadeInput *shi,
 			}
 		}
 	}
-
-	/* work and wait until tasks are done */
-	BLI_task_pool_work_and_wait(task_pool);
-
-	/* free */
-	BLI_task_pool_free(task_pool);
-	BLI_task_scheduler_free(task_scheduler);
 }
 
 /* calculate resolution from bounding box in world space */
@@ -706,27 +716,36 @@ static int precache_resolution(Render *re, VolumePrecache *vp, ObjectInstanceRen
  * The voxel grid is stored in the ObjectInstanceRen, 
  * in camera space, aligned with the ObjectRen's bounding box.
  * Resolution is defined by the user.
+ *
+ * All instances are precached at once: their parts go into one task pool,
+ * so small volumes don't leave threads idle waiting for each other, and
+ * the raytrees used for the inside test are built in parallel beforehand.
  */
-static void vol_precache_objectinstance_threads(Render *re, ObjectInstanceRen *obi, Material *ma)
-{
-	VolumePrecache *vp;
+typedef struct VolPrecacheObject {
+	struct VolPrecacheObject *next, *prev;
+	ObjectInstanceRen *obi;
+	Material *ma;
 	RayObject *tree;
 	ShadeInput shi;
-	
-	R = *re;
+} VolPrecacheObject;
+
+static int vol_precache_objectinstance_init(Render *re, VolPrecacheObject *vpo)
+{
+	ObjectInstanceRen *obi = vpo->obi;
+	Material *ma = vpo->ma;
+	VolumePrecache *vp;
 
-	/* create a raytree with just the faces of the instanced ObjectRen, 
-	 * used for checking if the cached point is inside or outside. */
-	tree = makeraytree_object(&R, obi);
-	if (!tree) return;
+	/* a raytree with just the faces of the instanced ObjectRen, built by
+	 * volume_precache_raytrees(), used for checking if the cached point
+	 * is inside or outside. */
+	vpo->tree = makeraytree_object(&R, obi);
+	if (!vpo->tree) return 0;
 
 	vp = MEM_callocN(sizeof(VolumePrecache), "volume light cache");
-	obi->volume_precache = vp;
 	
 	if (!precache_resolution(re, vp, obi, ma->vol.precache_resolution)) {
 		MEM_freeN(vp);
-		vp = NULL;
-		return;
+		return 0;
 	}
 
 	vp->data_r = MEM_callocN(sizeof(float)*vp->res[0]*vp->res[1]*vp->res[2], "volume light cache data red channel");
@@ -734,27 +753,28 @@ static void vol_precache_objectinstance_threads(Render *re, ObjectInstanceRen *o
 	vp->data_b = MEM_callocN(sizeof(float)*vp->res[0]*vp->res[1]*vp->res[2], "volume light cache data blue channel");
 	if (vp->data_r==NULL || vp->data_g==NULL || vp->data_b==NULL) {
 		MEM_freeN(vp);
-		return;
+		return 0;
 	}
 
+	obi->volume_precache = vp;
+
 	/* Need a shadeinput to calculate scattering */
-	precache_setup_shadeinput(re, obi, ma, &shi);
-	
-	precache_launch_parts(re, tree, &shi, obi);
+	precache_setup_shadeinput(re, obi, ma, &vpo->shi);
 
-	if (tree) {
-		/* TODO: makeraytree_object creates a tree and saves it on OBI,
-		 * if we free this tree we should also clear other pointers to it */
-		//RE_rayobject_free(tree);
-		//tree= NULL;
-	}
-	
-	if (ELEM(ma->vol.shade_type, MA_VOL_SHADE_MULTIPLE, MA_VOL_SHADE_SHADEDPLUSMULTIPLE)) {
+	return 1;
+}
+
+static void vol_precache_objectinstance_finish(Render *re, VolPrecacheObject *vpo)
+{
+	/* TODO: makeraytree_object creates a tree and saves it on OBI,
+	 * if we free this tree we should also clear other pointers to it */
+
+	if (ELEM(vpo->ma->vol.shade_type, MA_VOL_SHADE_MULTIPLE, MA_VOL_SHADE_SHADEDPLUSMULTIPLE)) {
 		/* this should be before the filtering */
-		multiple_scattering_diffusion(re, obi->volume_precache, ma);
+		multiple_scattering_diffusion(re, vpo->obi->volume_precache, vpo->ma);
 	}
 		
-	lightcache_filter(obi->volume_precache);
+	lightcache_filter(vpo->obi->volume_precache);
 }
 
 static int using_lightcache(Material *ma)
@@ -763,31 +783,119 @@ static int using_lightcache(Material *ma)
 	        (ELEM(ma->vol.shade_type, MA_VOL_SHADE_MULTIPLE, MA_VOL_SHADE_SHADEDPLUSMULTIPLE)));
 }
 
+static void vol_raytree_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	Render *re = BLI_task_pool_userdata(pool);
+	ObjectInstanceRen *obi = taskdata;
+
+	makeraytree_object(re, obi);
+}
+
+/* build the raytrees of all volume objects in parallel, one task per ObjectRen.
+ * makeraytree_object() caches them on the ObjectRen, so the inside tests
+ * for the camera and the precache only look them up afterwards. */
+void volume_precache_raytrees(Render *re)
+{
+	TaskPool *task_pool;
+	ObjectInstanceRen *obi;
+	VolumeOb *vo, *prev;
+
+	task_pool = BLI_task_pool_create(BLI_task_scheduler_get(), re);
+
+	for (vo= re->volumes.first; vo; vo= vo->next) {
+		if (vo->obr->raytree)
+			continue;
+
+		/* several materials can share an ObjectRen */
+		for (prev= re->volumes.first; prev != vo; prev= prev->next)
+			if (prev->obr == vo->obr)
+				break;
+		if (prev != vo)
+			continue;
+
+		for (obi= re->instancetable.first; obi; obi= obi->next) {
+			if (obi->obr == vo->obr) {
+				BLI_task_pool_push(task_pool, vol_raytree_task, obi, false, TASK_PRIORITY_HIGH);
+				break;
+			}
+		}
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+}
+
 /* loop through all objects (and their associated materials)
  * marked for pre-caching in convertblender.c, and pre-cache them */
 void volume_precache(Render *re)
 {
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	VolPrecacheState state;
+	ListBase objects = {NULL, NULL};
+	VolPrecacheObject *vpo;
 	ObjectInstanceRen *obi;
 	VolumeOb *vo;
 
 	re->i.infostr = IFACE_("Volume preprocessing");
 	re->stats_draw(re->sdh, &re->i);
 
+	R = *re;
+
 	for (vo= re->volumes.first; vo; vo= vo->next) {
 		if (using_lightcache(vo->ma)) {
 			for (obi= re->instancetable.first; obi; obi= obi->next) {
 				if (obi->obr == vo->obr) {
-					vol_precache_objectinstance_threads(re, obi, vo->ma);
-
-					if (re->test_break && re->test_break(re->tbh))
-						break;
+					/* one cache per instance, the last material wins */
+					for (vpo= objects.first; vpo; vpo= vpo->next)
+						if (vpo->obi == obi)
+							break;
+
+					if (vpo == NULL) {
+						vpo = MEM_callocN(sizeof(VolPrecacheObject), "volume precache object");
+						vpo->obi = obi;
+						BLI_addtail(&objects, vpo);
+					}
+					vpo->ma = vo->ma;
 				}
 			}
-
-			if (re->test_break && re->test_break(re->tbh))
-				break;
 		}
 	}
+
+	if (objects.first)
+		volume_precache_raytrees(&R);
+
+	/* setup task scheduler */
+	memset(&state, 0, sizeof(state));
+	state.lasttime = PIL_check_seconds_timer();
+
+	task_scheduler = BLI_task_scheduler_create(re->r.threads);
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+	for (vpo= objects.first; vpo; vpo= vpo->next) {
+		if (re->test_break && re->test_break(re->tbh))
+			break;
+
+		if (vol_precache_objectinstance_init(re, vpo))
+			precache_launch_parts(re, task_pool, vpo->tree, &vpo->shi, vpo->obi);
+	}
+
+	/* work and wait until tasks are done */
+	BLI_task_pool_work_and_wait(task_pool);
+
+	/* free */
+	BLI_task_pool_free(task_pool);
+	BLI_task_scheduler_free(task_scheduler);
+
+	for (vpo= objects.first; vpo; vpo= vpo->next) {
+		if (re->test_break && re->test_break(re->tbh))
+			break;
+
+		if (vpo->obi->volume_precache)
+			vol_precache_objectinstance_finish(re, vpo);
+	}
+
+	BLI_freelistN(&objects);
 	
 	re->i.infostr = NULL;
 	re->stats_draw(re->sdh, &re->i);
@@ -2303,7 +2303,9 @@ void zbuffer_solid(RenderPart *pa, RenderLayer *rl, void(*fillfunc)(RenderPart *
 	}
 }
 
-void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, int size, float jitx, float jity)
+/* fills rows ystart to yend of the size*size buffer rectz, so bands of one
+ * shadow buffer can be rasterized in parallel */
+void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, int size, int ystart, int yend, float jitx, float jity)
 {
 	ZbufProjectCache cache[ZBUF_PROJECT_CACHE_SIZE];
 	ZSpan zspan;
@@ -2315,25 +2317,33 @@ void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, in
 	StrandRen *strand= NULL;
 	StrandVert *svert;
 	StrandBound *sbound;
-	float obwinmat[4][4], ho1[4], ho2[4], ho3[4], ho4[4];
+	float obwinmat[4][4], bounds[4], ho1[4], ho2[4], ho3[4], ho4[4];
 	int a, b, c, i, c1, c2, c3, c4, ok=1, lay= -1;
+	const int recty= yend - ystart;
 
 	if (lar->mode & (LA_LAYER|LA_LAYER_SHADOW)) lay= lar->lay;
 
+	/* skip objects outside of the band, same as zbuffer_part_bounds() */
+	bounds[0]= -1.0f;
+	bounds[1]= 1.0f;
+	bounds[2]= (2*ystart - size-1)/(float)size;
+	bounds[3]= (2*yend - size+1)/(float)size;
+
 	/* 1.0f for clipping in clippyra()... bad stuff actually */
-	zbuf_alloc_span(&zspan, size, size, 1.0f);
+	zbuf_alloc_span(&zspan, size, recty, 1.0f);
 	zspan.zmulx=  ((float)size)/2.0f;
 	zspan.zmuly=  ((float)size)/2.0f;
 	/* -0.5f to center the sample position */
 	zspan.zofsx= jitx - 0.5f;
-	zspan.zofsy= jity - 0.5f;
+	zspan.zofsy= jity - 0.5f - (float)ystart;
 	
 	/* the buffers */
+	rectz += ystart*size;
 	zspan.rectz= rectz;
-	fillrect(rectz, size, size, 0x7FFFFFFE);
+	fillrect(rectz, size, recty, 0x7FFFFFFE);
 	if (lar->buftype==LA_SHADBUF_HALFWAY) {
-		zspan.rectz1= MEM_mallocN(size*size*sizeof(int), "seconday z buffer");
-		fillrect(zspan.rectz1, size, size, 0x7FFFFFFE);
+		zspan.rectz1= MEM_mallocN(size*recty*sizeof(int), "seconday z buffer");
+		fillrect(zspan.rectz1, size, recty, 0x7FFFFFFE);
 	}
 	
 	/* filling methods */
@@ -2353,7 +2363,7 @@ void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, in
 		else
 			copy_m4_m4(obwinmat, winmat);
 
-		if (clip_render_object(obi->obr->boundbox, NULL, obwinmat))
+		if (clip_render_object(obi->obr->boundbox, bounds, obwinmat))
 			continue;
 
 		zbuf_project_cache_clear(cache, obr->totvert);
@@ -2403,7 +2413,7 @@ void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, in
 			/* for each bounding box containing a number of strands */
 			sbound= obr->strandbuf->bound;
 			for (c=0; c<obr->strandbuf->totbound; c++, sbound++) {
-				if (clip_render_object(sbound->boundbox, NULL, obwinmat))
+				if (clip_render_object(sbound->boundbox, bounds, obwinmat))
 					continue;
 
 				/* for each strand in this bounding box */
@@ -2455,7 +2465,7 @@ void zbuffer_shadow(Render *re, float winmat[4][4], LampRen *lar, int *rectz, in
 	
 	/* merge buffers */
 	if (lar->buftype==LA_SHADBUF_HALFWAY) {
-		for (a=size*size -1; a>=0; a--)
+		for (a=size*recty -1; a>=0; a--)
 			rectz[a]= (rectz[a]>>1) + (zspan.rectz1[a]>>1);
 		
 		MEM_freeN(zspan.rectz1);
@@ -3466,7 +3476,8 @@ static int zbuffer_abuf_render(RenderPart *pa, APixstr *APixbuf, APixstrand *APi
 	return doztra;
 }
 
-void zbuffer_abuf_shadow(Render *re, LampRen *lar, float winmat[4][4], APixstr *APixbuf, APixstrand *APixbufstrand, ListBase *apsmbase, int size, int samples, float (*jit)[2])
+/* like zbuffer_shadow(), APixbuf and APixbufstrand hold rows ystart to yend */
+void zbuffer_abuf_shadow(Render *re, LampRen *lar, float winmat[4][4], APixstr *APixbuf, APixstrand *APixbufstrand, ListBase *apsmbase, int size, int ystart, int yend, int samples, float (*jit)[2])
 {
 	RenderPart pa;
 	int lay= -1;
@@ -3475,11 +3486,11 @@ void zbuffer_abuf_shadow(Render *re, LampRen *lar, float winmat[4][4], APixstr *
 
 	memset(&pa, 0, sizeof(RenderPart));
 	pa.rectx= size;
-	pa.recty= size;
+	pa.recty= yend - ystart;
 	pa.disprect.xmin = 0;
-	pa.disprect.ymin = 0;
+	pa.disprect.ymin = ystart;
 	pa.disprect.xmax = size;
-	pa.disprect.ymax = size;
+	pa.disprect.ymax = yend;
 
 	zbuffer_abuf(re, &pa, APixbuf, apsmbase, lay, 0, winmat, size, size, samples, jit, 1.0f, 1);
 	if (APixbufstrand)
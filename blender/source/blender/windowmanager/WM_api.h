@@ -369,7 +369,10 @@ enum {
 	WM_JOB_TYPE_CLIP_TRACK_MARKERS,
 	WM_JOB_TYPE_CLIP_SOLVE_CAMERA,
 	WM_JOB_TYPE_CLIP_PREFETCH,
+	WM_JOB_TYPE_IMAGE_PREFETCH,
 	WM_JOB_TYPE_SEQ_BUILD_PROXY,
+	WM_JOB_TYPE_SEQ_BUILD_PREVIEW,
+	WM_JOB_TYPE_AUTOSAVE,
 	/* add as needed, screencast, seq proxy build
 	 * if having hard coded values is a problem */
 };
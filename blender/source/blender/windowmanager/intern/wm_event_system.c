@@ -57,6 +57,7 @@
 #include "BKE_screen.h"
 
 #include "BKE_sound.h"
+#include "BKE_update_timing.h"
 
 #include "ED_fileselect.h"
 #include "ED_info.h"
@@ -232,6 +233,24 @@ static void wm_notifier_clear(wmNotifier *note)
 	memset(((char *)note) + sizeof(Link), 0, sizeof(*note) - sizeof(Link));
 }
 
+/* report the slowest evaluation of a scene update that evaluated anything,
+ * the full list is printed and available as bpy.app.update_timing */
+static void wm_update_timing_report(bContext *C)
+{
+	static int last_serial = 0;
+	UpdateTimingEntry *entry = BKE_update_timing_entries()->first;
+
+	if (entry == NULL || BKE_update_timing_serial() == last_serial)
+		return;
+
+	last_serial = BKE_update_timing_serial();
+
+	BKE_update_timing_print(10);
+	WM_reportf(C, RPT_INFO, "Scene update %.2f ms, slowest %s %s%s%s %.2f ms",
+	           BKE_update_timing_total() * 1000.0, BKE_update_timing_type_name(entry->type),
+	           entry->owner, entry->name[0] ? " / " : "", entry->name, entry->time * 1000.0);
+}
+
 /* called in mainloop */
 void wm_event_do_notifiers(bContext *C)
 {
@@ -371,6 +390,9 @@ void wm_event_do_notifiers(bContext *C)
 			win->screen->scene->customdata_mask |= win->screen->scene->customdata_mask_modal;
 
 			BKE_scene_update_tagged(bmain, win->screen->scene);
+
+			if (G.debug & G_DEBUG_UPDATE_TIMING)
+				wm_update_timing_report(C);
 		}
 	}
 
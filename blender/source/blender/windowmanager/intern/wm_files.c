@@ -34,6 +34,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h> /* for open flags */
 
 #include "zlib.h" /* wm_read_exotic() */
 
@@ -45,9 +46,10 @@
 #  include <shlobj.h>  /* for SHGetSpecialFolderPath, has to be done before BLI_winstuff
                         * because 'near' is disabled through BLI_windstuff */
 #  include <process.h> /* getpid */
+#  include <io.h> /* write close */
 #  include "BLI_winstuff.h"
 #else
-#  include <unistd.h> /* getpid */
+#  include <unistd.h> /* getpid write close */
 #endif
 
 #include "MEM_guardedalloc.h"
@@ -89,6 +91,7 @@
 
 #include "BLO_readfile.h"
 #include "BLO_writefile.h"
+#include "BLO_undofile.h"
 
 #include "RNA_access.h"
 
@@ -1008,6 +1011,99 @@ void WM_autosave_init(wmWindowManager *wm)
 		wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
 }
 
+/* Autosave writes a snapshot of the file in memory to disk in a job, so
+ * the UI only waits for the snapshot. */
+typedef struct AutosaveJob {
+	MemFile memfile;
+	char filepath[FILE_MAX];
+} AutosaveJob;
+
+static void wm_autosave_job_free(void *customdata)
+{
+	AutosaveJob *aj = customdata;
+
+	BLO_free_memfile(&aj->memfile);
+	MEM_freeN(aj);
+}
+
+static void wm_autosave_job_startjob(void *customdata, short *stop, short *do_update, float *progress)
+{
+	AutosaveJob *aj = customdata;
+	MemFileChunk *chunk;
+	char tempname[FILE_MAX + 1];
+	size_t written = 0;
+	int file;
+
+	/* write to a temporary file, so a stopped or failed save keeps the previous one */
+	BLI_snprintf(tempname, sizeof(tempname), "%s@", aj->filepath);
+
+	/* always create a new file, to avoid writing to a symlink (CVE-2008-1103) */
+	BLI_delete(tempname, false, false);
+	file = BLI_open(tempname, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC | O_EXCL, 0666);
+	if (file == -1) {
+		fprintf(stderr, "Unable to autosave '%s': %s\n", tempname, strerror(errno));
+		return;
+	}
+
+	for (chunk = aj->memfile.chunks.first; chunk; chunk = chunk->next) {
+		if (*stop || write(file, chunk->buf, chunk->size) != chunk->size) {
+			break;
+		}
+
+		written += chunk->size;
+		*progress = (float)written / (float)MAX2(aj->memfile.size, 1);
+		*do_update = true;
+	}
+
+	close(file);
+
+	if (chunk) {
+		if (!*stop) {
+			fprintf(stderr, "Unable to autosave '%s': %s\n", aj->filepath,
+			        errno ? strerror(errno) : "Unknown error writing file");
+		}
+		BLI_delete(tempname, false, false);
+	}
+	else if (BLI_rename(tempname, aj->filepath) != 0) {
+		fprintf(stderr, "Unable to autosave '%s': cannot replace the old file\n", aj->filepath);
+	}
+}
+
+/* returns false when there was no snapshot to write in the background */
+static bool wm_autosave_write_job(const bContext *C, wmWindowManager *wm, Scene *scene, const char *filepath)
+{
+	AutosaveJob *aj;
+	wmJob *wm_job;
+	bool ok;
+
+	aj = MEM_callocN(sizeof(AutosaveJob), "AutosaveJob");
+	BLI_strncpy(aj->filepath, filepath, sizeof(aj->filepath));
+
+	if (U.uiflag & USER_GLOBALUNDO) {
+		/* copy of the last undobuffer, now with UI */
+		ok = BKE_undo_memfile_copy(&aj->memfile);
+	}
+	else {
+		/* same as an undo push, without comparing to a previous step */
+		int fileflags = G.fileflags & ~(G_FILE_COMPRESS | G_FILE_AUTOPLAY | G_FILE_LOCK | G_FILE_SIGN | G_FILE_HISTORY);
+
+		ok = BLO_write_file_mem(CTX_data_main(C), NULL, &aj->memfile, fileflags);
+	}
+
+	if (!ok) {
+		wm_autosave_job_free(aj);
+		return false;
+	}
+
+	wm_job = WM_jobs_get(wm, NULL, scene, "Autosave", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+	WM_jobs_customdata_set(wm_job, aj, wm_autosave_job_free);
+	WM_jobs_timer(wm_job, 0.5, 0, 0);
+	WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+	WM_jobs_start(wm, wm_job);
+
+	return true;
+}
+
 void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(wt))
 {
 	wmWindow *win;
@@ -1018,6 +1114,12 @@ void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(w
 
 	WM_event_remove_timer(wm, NULL, wm->autosavetimer);
 
+	/* the previous autosave is still being written, try again in 10 seconds */
+	if (scene && WM_jobs_test(wm, scene, WM_JOB_TYPE_AUTOSAVE)) {
+		wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, 10.0);
+		return;
+	}
+
 	/* if a modal operator is running, don't autosave, but try again in 10 seconds */
 	for (win = wm->windows.first; win; win = win->next) {
 		for (handler = win->modalhandlers.first; handler; handler = handler->next) {
@@ -1037,7 +1139,10 @@ void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(w
 
 	wm_autosave_location(filepath);
 
-	if (U.uiflag & USER_GLOBALUNDO) {
+	if (scene && wm_autosave_write_job(C, wm, scene, filepath)) {
+		/* written in the background */
+	}
+	else if (U.uiflag & USER_GLOBALUNDO) {
 		/* fast save of last undobuffer, now with UI */
 		BKE_undo_save_file(filepath);
 	}
@@ -167,7 +167,7 @@ void WM_operatortype_append(void (*opfunc)(wmOperatorType *))
 
 	/* XXX All ops should have a description but for now allow them not to. */
 	RNA_def_struct_ui_text(ot->srna, ot->name, ot->description ? ot->description : UNDOCUMENTED_OPERATOR_TIP);
-	RNA_def_struct_identifier(ot->srna, ot->idname);
+	RNA_def_struct_identifier(&BLENDER_RNA, ot->srna, ot->idname);
 
 	BLI_ghash_insert(global_ops_hash, (void *)ot->idname, ot);
 }
@@ -182,7 +182,7 @@ void WM_operatortype_append_ptr(void (*opfunc)(wmOperatorType *, void *), void *
 	RNA_def_struct_translation_context(ot->srna, BLF_I18NCONTEXT_OPERATOR_DEFAULT);
 	opfunc(ot, userdata);
 	RNA_def_struct_ui_text(ot->srna, ot->name, ot->description ? ot->description : UNDOCUMENTED_OPERATOR_TIP);
-	RNA_def_struct_identifier(ot->srna, ot->idname);
+	RNA_def_struct_identifier(&BLENDER_RNA, ot->srna, ot->idname);
 
 	BLI_ghash_insert(global_ops_hash, (void *)ot->idname, ot);
 }
@@ -379,7 +379,7 @@ wmOperatorType *WM_operatortype_append_macro(const char *idname, const char *nam
 		ot->description = UNDOCUMENTED_OPERATOR_TIP;
 	
 	RNA_def_struct_ui_text(ot->srna, ot->name, ot->description);
-	RNA_def_struct_identifier(ot->srna, ot->idname);
+	RNA_def_struct_identifier(&BLENDER_RNA, ot->srna, ot->idname);
 	/* Use i18n context from ext.srna if possible (py operators). */
 	RNA_def_struct_translation_context(ot->srna, ot->ext.srna ? RNA_struct_translation_context(ot->ext.srna) :
 	                                                            BLF_I18NCONTEXT_OPERATOR_DEFAULT);
@@ -411,7 +411,7 @@ void WM_operatortype_append_macro_ptr(void (*opfunc)(wmOperatorType *, void *),
 	opfunc(ot, userdata);
 
 	RNA_def_struct_ui_text(ot->srna, ot->name, ot->description);
-	RNA_def_struct_identifier(ot->srna, ot->idname);
+	RNA_def_struct_identifier(&BLENDER_RNA, ot->srna, ot->idname);
 
 	BLI_ghash_insert(global_ops_hash, (void *)ot->idname, ot);
 }
@@ -4110,9 +4110,66 @@ static void WM_OT_redraw_timer(wmOperatorType *ot)
 
 /* ************************** memory statistics for testing ***************** */
 
-static int memory_statistics_exec(bContext *UNUSED(C), wmOperator *UNUSED(op))
+/* number of allocation names reported in the info editor */
+#define MEMORY_STATISTICS_REPORT_MAX 10
+
+/* allocation serial of the last run, to report what was allocated since */
+static size_t memory_statistics_serial = 0;
+
+typedef struct MemoryStatisticsData {
+	ReportList *reports;
+	bool use_since_last;
+	int tot;
+} MemoryStatisticsData;
+
+static void memory_statistics_report_cb(void *userdata, const MEM_StatsEntry *entry)
+{
+	MemoryStatisticsData *data = userdata;
+
+	if (data->tot >= MEMORY_STATISTICS_REPORT_MAX) {
+		return;
+	}
+
+	if (data->use_since_last) {
+		if (entry->items_new == 0) {
+			return;
+		}
+		BKE_reportf(data->reports, RPT_INFO, "%s: %u new blocks, %.3f MiB",
+		            entry->name, entry->items_new, (double)entry->len_new / (1024.0 * 1024.0));
+	}
+	else {
+		BKE_reportf(data->reports, RPT_INFO, "%s: %u blocks, %.3f MiB",
+		            entry->name, entry->items, (double)entry->len / (1024.0 * 1024.0));
+	}
+
+	data->tot++;
+}
+
+static int memory_statistics_exec(bContext *UNUSED(C), wmOperator *op)
 {
+	MemoryStatisticsData data;
+	size_t serial;
+
 	MEM_printmemlist_stats();
+
+	data.reports = op->reports;
+	data.use_since_last = RNA_boolean_get(op->ptr, "use_since_last");
+	data.tot = 0;
+
+	serial = MEM_get_memory_serial();
+
+	BKE_reportf(op->reports, RPT_INFO, "Memory in use: %.3f MiB, peak %.3f MiB",
+	            (double)MEM_get_memory_in_use() / (1024.0 * 1024.0),
+	            (double)MEM_get_peak_memory() / (1024.0 * 1024.0));
+
+	if (!MEM_get_memory_stats(data.use_since_last ? memory_statistics_serial : 0,
+	                          memory_statistics_report_cb, &data))
+	{
+		BKE_report(op->reports, RPT_INFO, "Start with --debug-memory for statistics per allocation");
+	}
+
+	memory_statistics_serial = serial;
+
 	return OPERATOR_FINISHED;
 }
 
@@ -4120,9 +4177,12 @@ static void WM_OT_memory_statistics(wmOperatorType *ot)
 {
 	ot->name = "Memory Statistics";
 	ot->idname = "WM_OT_memory_statistics";
-	ot->description = "Print memory statistics to the console";
+	ot->description = "Print memory statistics to the console and report the largest users";
 	
 	ot->exec = memory_statistics_exec;
+
+	RNA_def_boolean(ot->srna, "use_since_last", false, "Since Last",
+	                "Only report memory allocated since the last time statistics were shown");
 }
 
 /* ************************** memory statistics for testing ***************** */
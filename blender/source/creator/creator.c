@@ -63,6 +63,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 /* This little block needed for linking to Blender... */
 
@@ -73,6 +74,7 @@
 #endif
 
 #include "BLI_args.h"
+#include "BLI_cpu.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "BLI_callbacks.h"
@@ -256,6 +258,7 @@ static int print_help(int UNUSED(argc), const char **UNUSED(argv), void *data)
 	BLI_argsPrintArgDoc(ba, "--frame-start");
 	BLI_argsPrintArgDoc(ba, "--frame-end");
 	BLI_argsPrintArgDoc(ba, "--frame-jump");
+	BLI_argsPrintArgDoc(ba, "--render-jobs");
 	BLI_argsPrintArgDoc(ba, "--render-output");
 	BLI_argsPrintArgDoc(ba, "--engine");
 	BLI_argsPrintArgDoc(ba, "--threads");
@@ -311,6 +314,8 @@ static int print_help(int UNUSED(argc), const char **UNUSED(argv), void *data)
 #endif
 	BLI_argsPrintArgDoc(ba, "--debug-memory");
 	BLI_argsPrintArgDoc(ba, "--debug-jobs");
+	BLI_argsPrintArgDoc(ba, "--debug-update-timing");
+	BLI_argsPrintArgDoc(ba, "--debug-draw-timing");
 	BLI_argsPrintArgDoc(ba, "--debug-python");
 
 	BLI_argsPrintArgDoc(ba, "--debug-wm");
@@ -1045,6 +1050,106 @@ static int render_animation(int UNUSED(argc), const char **UNUSED(argv), void *d
 	return 0;
 }
 
+static int load_file(int argc, const char **argv, void *data);
+
+static int render_jobs(int UNUSED(argc), const char **UNUSED(argv), void *data)
+{
+	bContext *C = data;
+	char line[FILE_MAX + 64];
+	char loaded_filepath[FILE_MAX] = "";
+	time_t loaded_mtime = 0;
+
+	/* a file loaded by the arguments before, with their changes applied, is used
+	 * as long as the jobs ask for it */
+	if (G.file_loaded && G.relbase_valid) {
+		Main *bmain = CTX_data_main(C);
+		struct stat st;
+
+		if (BLI_stat(bmain->name, &st) != -1) {
+			BLI_strncpy(loaded_filepath, bmain->name, sizeof(loaded_filepath));
+			loaded_mtime = st.st_mtime;
+		}
+	}
+
+	printf("Waiting for render jobs...\n");
+	fflush(stdout);
+
+	while (fgets(line, sizeof(line), stdin)) {
+		char filepath[FILE_MAX];
+		struct stat st;
+		Scene *scene;
+		int sfra, efra, ofs = 0;
+
+		/* strip the newline */
+		line[strcspn(line, "\r\n")] = '\0';
+
+		if (line[0] == '\0')
+			continue;
+		if (STREQ(line, "quit"))
+			break;
+
+		if (sscanf(line, "%d %d %n", &sfra, &efra, &ofs) < 2 || line[ofs] == '\0') {
+			printf("\nError: render job must be '<start frame> <end frame> <file>', got '%s'.\n", line);
+			fflush(stdout);
+			continue;
+		}
+
+		BLI_strncpy(filepath, line + ofs, sizeof(filepath));
+		BLI_path_cwd(filepath);
+
+		if (BLI_stat(filepath, &st) == -1) {
+			printf("\nError: cannot open render job file '%s'.\n", filepath);
+			fflush(stdout);
+			continue;
+		}
+
+		/* only read the file again when it changed, so everything which is still
+		 * loaded (images, persistent render data) is reused for the next frames */
+		if (!STREQ(filepath, loaded_filepath) || st.st_mtime != loaded_mtime) {
+			const char *load_argv[1];
+
+			/* the persistent data points into the Main which is freed now */
+			RE_FreePersistentData();
+
+			load_argv[0] = filepath;
+			if (load_file(1, load_argv, C) == -1) {
+				printf("\nError: failed to load render job file '%s'.\n", filepath);
+				fflush(stdout);
+				loaded_filepath[0] = '\0';
+				continue;
+			}
+
+			BLI_strncpy(loaded_filepath, filepath, sizeof(loaded_filepath));
+			loaded_mtime = st.st_mtime;
+		}
+
+		scene = CTX_data_scene(C);
+		if (scene) {
+			Main *bmain = CTX_data_main(C);
+			Render *re = RE_NewRender(scene->id.name);
+			ReportList reports;
+
+			sfra = CLAMPIS(sfra, MINAFRAME, MAXFRAME);
+			efra = CLAMPIS(efra, sfra, MAXFRAME);
+
+			scene->r.mode |= R_PERSISTENT_DATA;
+
+			BKE_reports_init(&reports, RPT_PRINT);
+			RE_SetReports(re, &reports);
+			RE_BlenderAnim(re, bmain, scene, NULL, scene->lay, sfra, efra, scene->r.frame_step);
+			RE_SetReports(re, NULL);
+		}
+
+		/* lets the process feeding the jobs know it can send the next one */
+		printf("Render job done: %d %d %s\n", sfra, efra, filepath);
+		fflush(stdout);
+	}
+
+	RE_FreePersistentData();
+
+	return 0;
+}
+
 static int set_scene(int argc, const char **argv, void *data)
 {
 	if (argc > 1) {
@@ -1408,6 +1513,8 @@ static void setupArguments(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 
 	BLI_argsAdd(ba, 1, NULL, "--debug-value", "<value>\n\tSet debug value of <value> on startup\n", set_debug_value, NULL);
 	BLI_argsAdd(ba, 1, NULL, "--debug-jobs",  "\n\tEnable time profiling for background jobs.", debug_mode_generic, (void *)G_DEBUG_JOBS);
+	BLI_argsAdd(ba, 1, NULL, "--debug-update-timing",  "\n\tEnable time profiling of objects, modifiers, constraints and drivers in scene updates.", debug_mode_generic, (void *)G_DEBUG_UPDATE_TIMING);
+	BLI_argsAdd(ba, 1, NULL, "--debug-draw-timing",  "\n\tEnable CPU and GPU time profiling of 3D viewport draw phases.", debug_mode_generic, (void *)G_DEBUG_DRAW_TIMING);
 
 	BLI_argsAdd(ba, 1, NULL, "--verbose", "<verbose>\n\tSet logging verbosity level.", set_verbosity, NULL);
 
@@ -1437,6 +1544,9 @@ static void setupArguments(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	BLI_argsAdd(ba, 4, "-g", NULL, game_doc, set_ge_parameters, syshandle);
 	BLI_argsAdd(ba, 4, "-f", "--render-frame", "<frame>\n\tRender frame <frame> and save it.\n\t+<frame> start frame relative, -<frame> end frame relative.", render_frame, C);
 	BLI_argsAdd(ba, 4, "-a", "--render-anim", "\n\tRender frames from start to end (inclusive)", render_animation, C);
+	BLI_argsAdd(ba, 4, NULL, "--render-jobs", "\n\tRead render jobs from stdin until it closes or a line reads 'quit'"
+	            "\n\tEach line is '<start frame> <end frame> <file>', the file is kept loaded between jobs"
+	            "\n\tand only read again when it changed. Use in background mode.", render_jobs, C);
 	BLI_argsAdd(ba, 4, "-S", "--scene", "<name>\n\tSet the active scene <name> for rendering", set_scene, C);
 	BLI_argsAdd(ba, 4, "-s", "--frame-start", "<frame>\n\tSet start to frame <frame> (use before the -a argument)", set_start_frame, C);
 	BLI_argsAdd(ba, 4, "-e", "--frame-end", "<frame>\n\tSet end to frame <frame> (use before the -a argument)", set_end_frame, C);
@@ -1563,6 +1673,7 @@ int main(int argc, const char **argv)
 	BLI_init_program_path(argv[0]);
 
 	BLI_threadapi_init();
+	BLI_cpu_dispatch_init();
 
 	initglobals();  /* blender.c */
 
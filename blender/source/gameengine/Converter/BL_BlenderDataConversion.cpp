@@ -1851,6 +1851,21 @@ static KX_GameObject *gameobject_from_blenderobject(
 	
 		// set transformation
 		gameobj->AddMesh(meshobj);
+
+		// levels of detail, the first level is always the object's own mesh
+		if (ob->lodlevels.first && ((LodLevel *)ob->lodlevels.first)->next) {
+			gameobj->AddLodMesh(meshobj, 0.0f);
+
+			for (LodLevel *lod = ((LodLevel *)ob->lodlevels.first)->next; lod; lod = lod->next) {
+				if (!lod->source || lod->source->type != OB_MESH)
+					continue;
+
+				RAS_MeshObject *lodmeshobj = BL_ConvertMesh((Mesh *)lod->source->data, lod->source, kxscene, converter, libloading);
+				kxscene->GetLogicManager()->RegisterMeshName(lodmeshobj->GetName(), lodmeshobj);
+				kxscene->GetLogicManager()->RegisterGameMeshName(lodmeshobj->GetName(), lod->source);
+				gameobj->AddLodMesh(lodmeshobj, lod->distance);
+			}
+		}
 	
 		// for all objects: check whether they want to
 		// respond to updates
@@ -2282,6 +2297,7 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 	kxscene->SetActivityCulling( (blenderscene->gm.mode & WO_ACTIVITY_CULLING) != 0);
 	kxscene->SetActivityCullingRadius(blenderscene->gm.activityBoxRadius);
 	kxscene->SetDbvtCulling((blenderscene->gm.mode & WO_DBVT_CULLING) != 0);
+	kxscene->SetDbvtOcclusionQuery((blenderscene->gm.flag & GAME_USE_OCCLUSION_QUERIES) != 0);
 	
 	// no occlusion culling by default
 	kxscene->SetDbvtOcclusionRes(0);
@@ -62,6 +62,7 @@ extern "C"{
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #define __NLA_DEFNORMALS
 //#undef __NLA_DEFNORMALS
@@ -231,47 +232,38 @@ void BL_SkinDeformer::BlenderDeformVerts()
 #endif
 }
 
-void BL_SkinDeformer::BGEDeformVerts()
-{
-	Object *par_arma = m_armobj->GetArmatureObject();
-	MDeformVert *dverts = m_bmesh->dvert;
-	bDeformGroup *dg;
-	int defbase_tot = BLI_countlist(&m_objMesh->defbase);
-	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
-
-	if (!dverts)
-		return;
-
-	if (m_dfnrToPC == NULL)
-	{
-		m_dfnrToPC = new bPoseChannel*[defbase_tot];
-		int i;
-		for (i=0, dg=(bDeformGroup*)m_objMesh->defbase.first;
-			dg;
-			++i, dg = dg->next)
-		{
-			m_dfnrToPC[i] = BKE_pose_channel_find_name(par_arma->pose, dg->name);
-
-			if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM)
-				m_dfnrToPC[i] = NULL;
-		}
-	}
+/* vertices are skinned independently, below this many the calling thread does all of them */
+#define BGE_DEFORM_VERTS_TASK_LIMIT 1024
+
+struct BGEDeformVertsData {
+	MDeformVert *dverts;
+	bPoseChannel **dfnrToPC;
+	int defbase_tot;
+	float (*transverts)[3];
+	float (*transnors)[3];
+	const Eigen::Matrix4f *pre_mat;
+	const Eigen::Matrix4f *post_mat;
+};
 
-	post_mat = Eigen::Matrix4f::Map((float*)m_obmat).inverse() * Eigen::Matrix4f::Map((float*)m_armobj->GetArmatureObject()->obmat);
-	pre_mat = post_mat.inverse();
+static void bge_deform_verts_range(void *userdata, int start, int stop)
+{
+	BGEDeformVertsData *data = (BGEDeformVertsData *)userdata;
+	const Eigen::Matrix4f &pre_mat = *data->pre_mat;
+	const Eigen::Matrix4f &post_mat = *data->post_mat;
+	Eigen::Matrix4f chan_mat, norm_chan_mat = Eigen::Matrix4f::Identity();
 
-	MDeformVert *dv= dverts;
+	MDeformVert *dv= data->dverts + start;
 	MDeformWeight *dw;
 
-	for (int i=0; i<m_bmesh->totvert; ++i, dv++)
+	for (int i=start; i<stop; ++i, dv++)
 	{
 		float contrib = 0.f, weight, max_weight=-1.f;
 		bPoseChannel *pchan=NULL;
-		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(m_transnors[i]);
+		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(data->transnors[i]);
 		Eigen::Vector4f vec(0, 0, 0, 1);
-		Eigen::Vector4f co(m_transverts[i][0],
-							m_transverts[i][1],
-							m_transverts[i][2],
+		Eigen::Vector4f co(data->transverts[i][0],
+							data->transverts[i][1],
+							data->transverts[i][2],
 							1.f);
 
 		if (!dv->totweight)
@@ -285,7 +277,7 @@ void BL_SkinDeformer::BGEDeformVerts()
 		{
 			const int index = dw->def_nr;
 
-			if (index < defbase_tot && (pchan=m_dfnrToPC[index]))
+			if (index < data->defbase_tot && (pchan=data->dfnrToPC[index]))
 			{
 				weight = dw->weight;
 
@@ -316,10 +308,52 @@ void BL_SkinDeformer::BGEDeformVerts()
 
 		co = post_mat * co;
 
-		m_transverts[i][0] = co[0];
-		m_transverts[i][1] = co[1];
-		m_transverts[i][2] = co[2];
+		data->transverts[i][0] = co[0];
+		data->transverts[i][1] = co[1];
+		data->transverts[i][2] = co[2];
+	}
+}
+
+void BL_SkinDeformer::BGEDeformVerts()
+{
+	Object *par_arma = m_armobj->GetArmatureObject();
+	MDeformVert *dverts = m_bmesh->dvert;
+	bDeformGroup *dg;
+	int defbase_tot = BLI_countlist(&m_objMesh->defbase);
+	Eigen::Matrix4f pre_mat, post_mat;
+	BGEDeformVertsData data;
+
+	if (!dverts)
+		return;
+
+	if (m_dfnrToPC == NULL)
+	{
+		m_dfnrToPC = new bPoseChannel*[defbase_tot];
+		int i;
+		for (i=0, dg=(bDeformGroup*)m_objMesh->defbase.first;
+			dg;
+			++i, dg = dg->next)
+		{
+			m_dfnrToPC[i] = BKE_pose_channel_find_name(par_arma->pose, dg->name);
+
+			if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM)
+				m_dfnrToPC[i] = NULL;
+		}
 	}
+
+	post_mat = Eigen::Matrix4f::Map((float*)m_obmat).inverse() * Eigen::Matrix4f::Map((float*)m_armobj->GetArmatureObject()->obmat);
+	pre_mat = post_mat.inverse();
+
+	data.dverts = dverts;
+	data.dfnrToPC = m_dfnrToPC;
+	data.defbase_tot = defbase_tot;
+	data.transverts = m_transverts;
+	data.transnors = m_transnors;
+	data.pre_mat = &pre_mat;
+	data.post_mat = &post_mat;
+
+	BLI_task_parallel_range_ex(0, m_bmesh->totvert, &data, bge_deform_verts_range, BGE_DEFORM_VERTS_TASK_LIMIT);
+
 	m_copyNormals = true;
 }
 
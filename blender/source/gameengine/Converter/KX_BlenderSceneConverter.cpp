@@ -985,31 +985,50 @@ Main* KX_BlenderSceneConverter::GetMainDynamicPath(const char *path)
 	return NULL;
 }
 
+/* Merging a converted scene (bucket merge, material shader construction) runs on
+ * the main thread, so only merge as many scenes per frame as fit in this budget. */
+#define MERGE_TIME_BUDGET 0.004
+
 void KX_BlenderSceneConverter::MergeAsyncLoads()
 {
 	vector<KX_Scene*> *merge_scenes;
+	KX_LibLoadStatus *status;
+	KX_Scene *scene;
 
-	vector<KX_LibLoadStatus*>::iterator mit;
-	vector<KX_Scene*>::iterator sit;
+	double starttime = PIL_check_seconds_timer();
+	bool merged = false;
 
 	pthread_mutex_lock(&m_threadinfo->merge_lock);
 
-	for (mit=m_mergequeue.begin(); mit!=m_mergequeue.end(); ++mit) {
-		merge_scenes = (vector<KX_Scene*>*)(*mit)->GetData();
+	while (!m_mergequeue.empty()) {
+		status = m_mergequeue.front();
+		merge_scenes = (vector<KX_Scene*>*)status->GetData();
 
-		for (sit=merge_scenes->begin(); sit!=merge_scenes->end(); ++sit) {
-			(*mit)->GetMergeScene()->MergeScene(*sit);
-			delete (*sit);
-		}
+		while (!merge_scenes->empty()) {
+			/* always merge at least one scene per frame so the queue drains */
+			if (merged && PIL_check_seconds_timer() - starttime > MERGE_TIME_BUDGET) {
+				pthread_mutex_unlock(&m_threadinfo->merge_lock);
+				return;
+			}
+
+			scene = merge_scenes->front();
+			merge_scenes->erase(merge_scenes->begin());
 
+			status->GetMergeScene()->MergeScene(scene);
+			delete scene;
+			merged = true;
+
+			// Split what is left of the merging 10% evenly over the remaining scenes
+			status->AddProgress((1.f - status->GetProgress()) / (merge_scenes->size() + 1));
+		}
 
 		delete merge_scenes;
-		(*mit)->SetData(NULL);
+		status->SetData(NULL);
 
-		(*mit)->Finish();
-	}
+		status->Finish();
 
-	m_mergequeue.clear();
+		m_mergequeue.erase(m_mergequeue.begin());
+	}
 
 	pthread_mutex_unlock(&m_threadinfo->merge_lock);
 }
@@ -464,8 +464,8 @@ void BL_ConvertSensors(struct Object* blenderobject,
 			{
 				bRaySensor* blenderraysensor = (bRaySensor*) sens->data;
 				
-				//blenderradarsensor->angle;
-				SCA_EventManager* eventmgr = logicmgr->FindEventManager(SCA_EventManager::BASIC_EVENTMGR);
+				// ray sensors get their rays cast together, ahead of evaluation
+				SCA_EventManager* eventmgr = logicmgr->FindEventManager(SCA_EventManager::RAY_EVENTMGR);
 				if (eventmgr)
 				{
 					bool bFindMaterial = (blenderraysensor->mode & SENS_COLLISION_MATERIAL);
@@ -36,6 +36,7 @@
 #include "PyObjectPlus.h"
 
 SCA_LogicManager* SCA_ILogicBrick::m_sCurrentLogicManager = NULL;
+bool SCA_ILogicBrick::m_sProfileLogic = false;
 
 SCA_ILogicBrick::SCA_ILogicBrick(SCA_IObject* gameobj)
 	:
@@ -44,7 +45,9 @@ SCA_ILogicBrick::SCA_ILogicBrick(SCA_IObject* gameobj)
 	m_Execute_Priority(0),
 	m_Execute_Ueber_Priority(0),
 	m_bActive(false),
-	m_eventval(0)
+	m_eventval(0),
+	m_profileTime(0.0),
+	m_profileCalls(0)
 {
 	m_text = "KX_LogicBrick";
 }
@@ -58,6 +61,14 @@ SCA_ILogicBrick::~SCA_ILogicBrick()
 
 
 
+void SCA_ILogicBrick::ProcessReplica()
+{
+	CValue::ProcessReplica();
+	ResetProfile();
+}
+
+
+
 void SCA_ILogicBrick::SetExecutePriority(int execute_Priority)
 {
 	m_Execute_Priority = execute_Priority;
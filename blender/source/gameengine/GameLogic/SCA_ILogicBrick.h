@@ -54,6 +54,11 @@ protected:
 	STR_String			m_text;
 	STR_String			m_name;
 	//unsigned long		m_drawcolor;
+
+	/* time spent in this brick and number of runs, see m_sProfileLogic */
+	double				m_profileTime;
+	int					m_profileCalls;
+
 	void RegisterEvent(CValue* eventval);
 	void RemoveEvent();
 	CValue* GetEvent();
@@ -70,6 +75,7 @@ public:
 	virtual void	ReParent(SCA_IObject* parent);
 	virtual void	Relink(CTR_Map<CTR_HashedPtr, void*> *obj_map);
 	virtual void Delete() { Release(); }
+	virtual void	ProcessReplica();
 
 	// act as a BoolValue (with value IsPositiveTrigger)
 	virtual CValue*	Calc(VALUE_OPERATOR op, CValue *val);
@@ -127,6 +133,22 @@ public:
 
 	virtual	bool		LessComparedTo(SCA_ILogicBrick* other);
 
+	void				AddProfileTime(double time)
+	{
+		m_profileTime += time;
+		m_profileCalls++;
+	}
+	double				GetProfileTime() { return m_profileTime; }
+	int					GetProfileCalls() { return m_profileCalls; }
+	void				ResetProfile()
+	{
+		m_profileTime = 0.0;
+		m_profileCalls = 0;
+	}
+
+	/* when set, the logic manager and sensors time each brick they run */
+	static bool			m_sProfileLogic;
+
 	/* runtime variable, set when Triggering the python controller */
 	static class SCA_LogicManager*	m_sCurrentLogicManager;
 
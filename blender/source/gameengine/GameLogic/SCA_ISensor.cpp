@@ -43,6 +43,8 @@
 
 #include <stdio.h>
 
+#include "PIL_time.h"
+
 /* Native functions */
 void	SCA_ISensor::ReParent(SCA_IObject* parent)
 {
@@ -241,7 +243,15 @@ void SCA_ISensor::Activate(class SCA_LogicManager* logicmgr)
 	// calculate if a __triggering__ is wanted
 	// don't evaluate a sensor that is not connected to any controller
 	if (m_links && !m_suspended) {
-		bool result = this->Evaluate();
+		bool result;
+		if (m_sProfileLogic) {
+			double starttime = PIL_check_seconds_timer();
+			result = this->Evaluate();
+			AddProfileTime(PIL_check_seconds_timer() - starttime);
+		}
+		else {
+			result = this->Evaluate();
+		}
 		// store the state for the rest of the logic system
 		m_prev_state = m_state;
 		m_state = this->IsPositiveTrigger();
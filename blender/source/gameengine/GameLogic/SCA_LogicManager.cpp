@@ -39,6 +39,8 @@
 #include "SCA_PythonController.h"
 #include <set>
 
+#include "PIL_time.h"
+
 
 SCA_LogicManager::SCA_LogicManager()
 {
@@ -197,7 +199,14 @@ void SCA_LogicManager::BeginFrame(double curtime, double fixedtime)
 			contr != NULL;
 			contr = (SCA_IController*)obj->QRemove())
 		{
-			contr->Trigger(this);
+			if (SCA_ILogicBrick::m_sProfileLogic) {
+				double starttime = PIL_check_seconds_timer();
+				contr->Trigger(this);
+				contr->AddProfileTime(PIL_check_seconds_timer() - starttime);
+			}
+			else {
+				contr->Trigger(this);
+			}
 			contr->ClrJustActivated();
 		}
 	}
@@ -222,7 +231,16 @@ void SCA_LogicManager::UpdateFrame(double curtime, bool frame)
 			SCA_IActuator* actua = *ia;
 			// increment first to allow removal of inactive actuators.
 			++ia;
-			if (!actua->Update(curtime, frame))
+			bool active;
+			if (SCA_ILogicBrick::m_sProfileLogic) {
+				double starttime = PIL_check_seconds_timer();
+				active = actua->Update(curtime, frame);
+				actua->AddProfileTime(PIL_check_seconds_timer() - starttime);
+			}
+			else {
+				active = actua->Update(curtime, frame);
+			}
+			if (!active)
 			{
 				// this actuator is not active anymore, remove
 				actua->QDelink(); 
@@ -95,6 +95,7 @@ KX_GameObject::KX_GameObject(
     : SCA_IObject(),
       m_bDyna(false),
       m_layer(0),
+      m_currentLodLevel(0),
       m_pBlenderObject(NULL),
       m_pBlenderGroupObject(NULL),
       m_bSuspendDynamics(false),
@@ -104,6 +105,10 @@ KX_GameObject::KX_GameObject(
       m_bVisible(true),
       m_bCulled(true),
       m_bOccluder(false),
+      m_occlusionQuery(0),
+      m_occlusionFrame(-1),
+      m_bOcclusionQueryPending(false),
+      m_bOccluded(false),
       m_pPhysicsController(NULL),
       m_pGraphicController(NULL),
       m_xray(false),
@@ -501,6 +506,12 @@ void KX_GameObject::ProcessReplica()
 	m_actionManager = NULL;
 	m_state = 0;
 
+	// queries belong to the scene pool, the replica gets its own
+	m_occlusionQuery = 0;
+	m_occlusionFrame = -1;
+	m_bOcclusionQueryPending = false;
+	m_bOccluded = false;
+
 	KX_Scene* scene = KX_GetActiveScene();
 	KX_ObstacleSimulation* obssimulation = scene->GetObstacleSimulation();
 	struct Object* blenderobject = GetBlenderObject();
@@ -731,6 +742,37 @@ void KX_GameObject::RemoveMeshes()
 	m_meshes.clear();
 }
 
+/* fraction of a level distance the camera has to move past it before
+ * switching, avoids popping back and forth around the threshold */
+#define KX_LOD_HYSTERESIS 0.1f
+
+void KX_GameObject::UpdateLod(const MT_Point3& cam_pos)
+{
+	if (m_lodmeshes.size() < 2)
+		return;
+
+	const MT_Scalar distance2 = NodeGetWorldPosition().distance2(cam_pos);
+	int level = 0;
+
+	for (int i = 1; i < (int)m_lodmeshes.size(); i++) {
+		MT_Scalar threshold = m_loddistances[i];
+
+		if (i > m_currentLodLevel)
+			threshold *= 1.0f + KX_LOD_HYSTERESIS;
+		else
+			threshold *= 1.0f - KX_LOD_HYSTERESIS;
+
+		if (distance2 < threshold * threshold)
+			break;
+		level = i;
+	}
+
+	if (level != m_currentLodLevel) {
+		m_currentLodLevel = level;
+		GetScene()->ReplaceMesh(this, m_lodmeshes[level], true, false);
+	}
+}
+
 void KX_GameObject::UpdateTransform()
 {
 	// HACK: saves function call for dynamic object, they are handled differently
@@ -87,6 +87,9 @@ protected:
 	STR_String							m_text;
 	int									m_layer;
 	std::vector<RAS_MeshObject*>		m_meshes;
+	std::vector<RAS_MeshObject*>		m_lodmeshes;	// level of detail meshes, first is the base mesh
+	std::vector<float>					m_loddistances;
+	int									m_currentLodLevel;
 	SG_QList							m_meshSlots;	// head of mesh slots of this 
 	struct Object*						m_pBlenderObject;
 	struct Object*						m_pBlenderGroupObject;
@@ -106,6 +109,12 @@ protected:
 	bool       							m_bCulled; 
 	bool								m_bOccluder;
 
+	// hardware occlusion query, the result always comes from an earlier frame
+	unsigned int						m_occlusionQuery;
+	int									m_occlusionFrame;
+	bool								m_bOcclusionQueryPending;
+	bool								m_bOccluded;
+
 	PHY_IPhysicsController*				m_pPhysicsController;
 	PHY_IGraphicController*				m_pGraphicController;
 	STR_String							m_testPropName;
@@ -756,6 +765,29 @@ public:
 		m_meshes.push_back(mesh);
 	}
 
+	/**
+	 * Add a level of detail mesh, used from the given distance
+	 * to the camera on. Levels must be added in increasing distance,
+	 * the first one being the object's own mesh.
+	 */
+		void
+	AddLodMesh(
+		RAS_MeshObject* mesh,
+		float distance
+	) {
+		m_lodmeshes.push_back(mesh);
+		m_loddistances.push_back(distance);
+	}
+
+	/**
+	 * Switch to the level of detail mesh matching the distance
+	 * to the camera position.
+	 */
+		void
+	UpdateLod(
+		const MT_Point3& cam_pos
+	);
+
 	/**
 	 * Pick out a mesh associated with the integer 'num'.
 	 */
@@ -826,6 +858,58 @@ public:
 		bool c
 	) { m_bCulled = c; }
 	
+	/**
+	 * Hardware occlusion query owned by this object, 0 if none yet.
+	 */
+	inline unsigned int
+	GetOcclusionQuery(
+		void
+	) { return m_occlusionQuery; }
+
+	inline void
+	SetOcclusionQuery(
+		unsigned int query
+	) { m_occlusionQuery = query; }
+
+	/**
+	 * Is a query issued and its result not read back yet?
+	 */
+	inline bool
+	GetOcclusionQueryPending(
+		void
+	) { return m_bOcclusionQueryPending; }
+
+	inline void
+	SetOcclusionQueryPending(
+		bool pending
+	) { m_bOcclusionQueryPending = pending; }
+
+	/**
+	 * Did the last query find the object hidden behind others?
+	 */
+	inline bool
+	GetOccluded(
+		void
+	) { return m_bOccluded; }
+
+	inline void
+	SetOccluded(
+		bool occluded
+	) { m_bOccluded = occluded; }
+
+	/**
+	 * Scene occlusion frame in which the object was last inside the frustum.
+	 */
+	inline int
+	GetOcclusionFrame(
+		void
+	) { return m_occlusionFrame; }
+
+	inline void
+	SetOcclusionFrame(
+		int frame
+	) { m_occlusionFrame = frame; }
+
 	/**
 	 * Is this object an occluder?
 	 */
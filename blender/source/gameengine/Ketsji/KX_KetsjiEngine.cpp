@@ -36,6 +36,7 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <algorithm>
 
 #include "KX_KetsjiEngine.h"
 
@@ -52,6 +53,9 @@
 #include "MT_Vector3.h"
 #include "MT_Transform.h"
 #include "SCA_IInputDevice.h"
+#include "SCA_ISensor.h"
+#include "SCA_IController.h"
+#include "SCA_IActuator.h"
 #include "KX_Camera.h"
 #include "KX_Dome.h"
 #include "KX_Light.h"
@@ -81,6 +85,10 @@
 // not valid, skip rendering this frame.
 //#define NZC_GUARDED_OUTPUT
 #define DEFAULT_LOGIC_TIC_RATE 60.0
+// number of frames logic brick timings are accumulated over before they are shown
+#define LOGIC_PROFILE_FRAMES 25
+// number of logic bricks listed in the on screen profile
+#define LOGIC_PROFILE_DISPLAY 5
 //#define DEFAULT_PHYSICS_TIC_RATE 60.0
 
 #ifdef FREE_WINDOWS /* XXX mingw64 (gcc 4.7.0) defines a macro for DrawText that translates to DrawTextA. Not good */
@@ -159,6 +167,8 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem* system)
 	// Set up timing info display variables
 	m_show_framerate(false),
 	m_show_profile(false),
+	m_logicProfileRequested(false),
+	m_logicProfileFrames(0),
 	m_showProperties(false),
 	m_showBackground(false),
 	m_show_debug_properties(false),
@@ -183,6 +193,7 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem* system)
 
 #ifdef WITH_PYTHON
 	m_pyprofiledict = PyDict_New();
+	m_pylogicprofiledict = PyDict_New();
 #endif
 }
 
@@ -199,6 +210,7 @@ KX_KetsjiEngine::~KX_KetsjiEngine()
 
 #ifdef WITH_PYTHON
 	Py_CLEAR(m_pyprofiledict);
+	Py_CLEAR(m_pylogicprofiledict);
 #endif
 }
 
@@ -257,6 +269,15 @@ PyObject* KX_KetsjiEngine::GetPyProfileDict()
 	Py_INCREF(m_pyprofiledict);
 	return m_pyprofiledict;
 }
+
+PyObject* KX_KetsjiEngine::GetPyLogicProfileDict()
+{
+	/* logic bricks are only timed on demand, start now if the profile isn't shown */
+	m_logicProfileRequested = true;
+
+	Py_INCREF(m_pylogicprofiledict);
+	return m_pylogicprofiledict;
+}
 #endif
 
 
@@ -502,6 +523,7 @@ void KX_KetsjiEngine::EndFrame()
 
 	// Show profiling info
 	m_logger->StartLog(tc_overhead, m_kxsystem->GetTimeInSeconds(), true);
+	UpdateLogicProfile();
 	if (m_show_framerate || m_show_profile || (m_show_debug_properties))
 	{
 		RenderDebugProperties();
@@ -1313,6 +1335,7 @@ void KX_KetsjiEngine::RenderFrame(KX_Scene* scene, KX_Camera* cam)
 	m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
 	SG_SetActiveStage(SG_STAGE_CULLING);
 
+	scene->UpdateObjectLods(cam);
 	scene->CalculateVisibleMeshes(m_rasterizer,cam);
 
 	m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
@@ -1325,6 +1348,9 @@ void KX_KetsjiEngine::RenderFrame(KX_Scene* scene, KX_Camera* cam)
 
 	scene->RenderBuckets(camtrans, m_rasterizer);
 
+	// boxes are tested against the depth of what was just drawn
+	scene->RenderOcclusionQueries(m_rasterizer, cam);
+
 	//render all the font objects for this scene
 	scene->RenderFonts();
 	
@@ -1434,6 +1460,65 @@ void KX_KetsjiEngine::PostProcessScene(KX_Scene* scene)
 
 
 
+template <class T>
+static void add_logic_profile(vector<KX_LogicBrickProfile>& profile, vector<T*>& bricks)
+{
+	for (typename vector<T*>::iterator it = bricks.begin(); it != bricks.end(); ++it) {
+		SCA_ILogicBrick *brick = *it;
+
+		if (brick->GetProfileCalls()) {
+			KX_LogicBrickProfile entry;
+			entry.name.Format("%s:%s", brick->GetParent()->GetName().ReadPtr(), brick->GetName().ReadPtr());
+			entry.time = brick->GetProfileTime() / LOGIC_PROFILE_FRAMES;
+			entry.calls = (float)brick->GetProfileCalls() / LOGIC_PROFILE_FRAMES;
+			profile.push_back(entry);
+		}
+		brick->ResetProfile();
+	}
+}
+
+static bool logic_profile_greater(const KX_LogicBrickProfile& a, const KX_LogicBrickProfile& b)
+{
+	return a.time > b.time;
+}
+
+void KX_KetsjiEngine::UpdateLogicProfile()
+{
+	SCA_ILogicBrick::m_sProfileLogic = (m_show_profile || m_logicProfileRequested);
+
+	if (!SCA_ILogicBrick::m_sProfileLogic || ++m_logicProfileFrames < LOGIC_PROFILE_FRAMES)
+		return;
+
+	m_logicProfileFrames = 0;
+	m_logicProfile.clear();
+
+	for (KX_SceneList::iterator sceneit = m_scenes.begin(); sceneit != m_scenes.end(); ++sceneit) {
+		CListValue *objectlist = (*sceneit)->GetObjectList();
+
+		for (int i = 0; i < objectlist->GetCount(); i++) {
+			SCA_IObject *gameobj = (SCA_IObject *)objectlist->GetValue(i);
+
+			add_logic_profile(m_logicProfile, gameobj->GetSensors());
+			add_logic_profile(m_logicProfile, gameobj->GetControllers());
+			add_logic_profile(m_logicProfile, gameobj->GetActuators());
+		}
+	}
+
+	std::sort(m_logicProfile.begin(), m_logicProfile.end(), logic_profile_greater);
+
+#ifdef WITH_PYTHON
+	PyDict_Clear(m_pylogicprofiledict);
+	for (vector<KX_LogicBrickProfile>::iterator it = m_logicProfile.begin(); it != m_logicProfile.end(); ++it) {
+		PyObject *val = PyTuple_New(2);
+		PyTuple_SetItem(val, 0, PyFloat_FromDouble(it->time*1000.f));
+		PyTuple_SetItem(val, 1, PyFloat_FromDouble(it->calls));
+
+		PyDict_SetItemString(m_pylogicprofiledict, it->name.ReadPtr(), val);
+		Py_DECREF(val);
+	}
+#endif
+}
+
 void KX_KetsjiEngine::RenderDebugProperties()
 {
 	STR_String debugtxt;
@@ -1515,6 +1600,27 @@ void KX_KetsjiEngine::RenderDebugProperties()
 			m_rasterizer->RenderBox2D(xcoord + (int)(2.2 * profile_indent), ycoord, m_canvas->GetWidth(), m_canvas->GetHeight(), time/tottime);
 			ycoord += const_ysize;
 		}
+
+		/* Most expensive logic bricks, as object:brick */
+		for (unsigned int j = 0; j < m_logicProfile.size() && j < LOGIC_PROFILE_DISPLAY; j++) {
+			const KX_LogicBrickProfile& brickprofile = m_logicProfile[j];
+
+			debugtxt.Format("%5.2fms | %.1fx", brickprofile.time*1000.f, brickprofile.calls);
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                            debugtxt.ReadPtr(),
+			                            xcoord + const_xindent,
+			                            ycoord,
+			                            m_canvas->GetWidth(),
+			                            m_canvas->GetHeight());
+
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                            brickprofile.name.ReadPtr(),
+			                            xcoord + const_xindent + profile_indent + 24,
+			                            ycoord,
+			                            m_canvas->GetWidth(),
+			                            m_canvas->GetHeight());
+			ycoord += const_ysize;
+		}
 	}
 	// Add the ymargin for titles below the other section of debug info
 	ycoord += title_y_top_margin;
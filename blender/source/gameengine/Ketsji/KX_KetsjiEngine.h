@@ -64,6 +64,13 @@ typedef struct {
 	short glslflag;
 }	GlobalSettings;
 
+/** Time spent in one logic brick, per frame averaged over a profile period. */
+typedef struct {
+	STR_String	name;
+	double		time;
+	float		calls;
+}	KX_LogicBrickProfile;
+
 /**
  * KX_KetsjiEngine is the core game engine class.
  */
@@ -80,6 +87,7 @@ private:
 	/* borrowed from sys.modules["__main__"], don't manage ref's */
 	PyObject*					m_pythondictionary;
 	PyObject*					m_pyprofiledict;
+	PyObject*					m_pylogicprofiledict;
 #endif
 	class SCA_IInputDevice*				m_keyboarddevice;
 	class SCA_IInputDevice*				m_mousedevice;
@@ -175,6 +183,12 @@ private:
 	bool					m_show_framerate;
 	/** Show profiling info on the game display? */
 	bool					m_show_profile;
+	/** Logic brick timings were asked for from python, keep profiling them. */
+	bool					m_logicProfileRequested;
+	/** Frames accumulated in the logic bricks since the last profile update. */
+	int						m_logicProfileFrames;
+	/** Logic brick timings of the last profile period, most expensive first. */
+	std::vector<KX_LogicBrickProfile>	m_logicProfile;
 	/** Show any debug (scene) object properties on the game display? */
 	bool					m_showProperties;
 	/** Show background behind text for readability? */
@@ -203,6 +217,7 @@ private:
 	void					RenderFrame(KX_Scene* scene, KX_Camera* cam);
 	void					PostRenderScene(KX_Scene* scene);
 	void					RenderDebugProperties();
+	void					UpdateLogicProfile();
 	void					RenderShadowBuffers(KX_Scene *scene);
 	void					SetBackGround(KX_WorldInfo* worldinfo);
 
@@ -221,6 +236,7 @@ public:
 	void			SetPyNamespace(PyObject *pythondictionary);
 	PyObject*		GetPyNamespace() { return m_pythondictionary; }
 	PyObject*		GetPyProfileDict();
+	PyObject*		GetPyLogicProfileDict();
 #endif
 	void			SetSceneConverter(KX_ISceneConverter* sceneconverter);
 	void			SetAnimRecordMode(bool animation_record, int startFrame);
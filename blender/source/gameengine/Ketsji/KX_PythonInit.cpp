@@ -379,6 +379,15 @@ static PyObject *gPyGetProfileInfo(PyObject *)
 	return gp_KetsjiEngine->GetPyProfileDict();
 }
 
+static char gPyGetLogicProfileInfo_doc[] =
+"getLogicProfileInfo()\n"
+"returns a dictionary with the time spent in each logic brick";
+
+static PyObject *gPyGetLogicProfileInfo(PyObject *)
+{
+	return gp_KetsjiEngine->GetPyLogicProfileDict();
+}
+
 static char gPySendMessage_doc[] = 
 "sendMessage(subject, [body, to, from])\n\
 sends a message in same manner as a message actuator\
@@ -867,6 +876,7 @@ static struct PyMethodDef game_methods[] = {
 	{"PrintMemInfo", (PyCFunction)pyPrintStats, METH_NOARGS, (const char *)"Print engine statistics"},
 	{"NextFrame", (PyCFunction)gPyNextFrame, METH_NOARGS, (const char *)"Render next frame (if Python has control)"},
 	{"getProfileInfo", (PyCFunction)gPyGetProfileInfo, METH_NOARGS, gPyGetProfileInfo_doc},
+	{"getLogicProfileInfo", (PyCFunction)gPyGetLogicProfileInfo, METH_NOARGS, gPyGetLogicProfileInfo_doc},
 	/* library functions */
 	{"LibLoad", (PyCFunction)gLibLoad, METH_VARARGS|METH_KEYWORDS, (const char *)""},
 	{"LibNew", (PyCFunction)gLibNew, METH_VARARGS, (const char *)""},
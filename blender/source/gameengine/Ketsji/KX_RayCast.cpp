@@ -58,7 +58,7 @@ void KX_RayCast::reportHit(PHY_RayCastResult* result)
 	m_hitPolygon = result->m_polygon;
 }
 
-bool KX_RayCast::RayTest(PHY_IPhysicsEnvironment* physics_environment, const MT_Point3& _frompoint, const MT_Point3& topoint, KX_RayCast& callback)
+bool KX_RayCast::RayTest(PHY_IPhysicsEnvironment* physics_environment, const MT_Point3& _frompoint, const MT_Point3& topoint, KX_RayCast& callback, bool concurrent)
 {
 	if (physics_environment==NULL) return false; /* prevents crashing in some cases */
 	
@@ -75,9 +75,13 @@ bool KX_RayCast::RayTest(PHY_IPhysicsEnvironment* physics_environment, const MT_
 	
 	PHY_IPhysicsController* hit_controller;
 
-	while ((hit_controller = physics_environment->RayTest(callback,
-	                                                      frompoint.x(),frompoint.y(),frompoint.z(),
-	                                                      topoint.x(),topoint.y(),topoint.z())) != NULL)
+	while ((hit_controller = (concurrent) ?
+	        physics_environment->RayTestConcurrent(callback,
+	                                               frompoint.x(),frompoint.y(),frompoint.z(),
+	                                               topoint.x(),topoint.y(),topoint.z()) :
+	        physics_environment->RayTest(callback,
+	                                     frompoint.x(),frompoint.y(),frompoint.z(),
+	                                     topoint.x(),topoint.y(),topoint.z())) != NULL)
 	{
 		KX_ClientObjectInfo *info = static_cast<KX_ClientObjectInfo*>(hit_controller->GetNewClientInfo());
 		
@@ -87,11 +87,14 @@ public:
 	
 	/// Public interface.
 	/// Implement bool RayHit in your class to receive ray callbacks.
+	/// With concurrent set, several ray tests may run at once from different
+	/// threads, only valid if the environment SupportsConcurrentRayTest().
 	static bool RayTest(
 		PHY_IPhysicsEnvironment* physics_environment, 
 		const MT_Point3& frompoint, 
 		const MT_Point3& topoint, 
-		KX_RayCast& callback);
+		KX_RayCast& callback,
+		bool concurrent = false);
 	
 	
 #ifdef WITH_CXX_GUARDEDALLOC
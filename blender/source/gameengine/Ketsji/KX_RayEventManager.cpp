@@ -33,18 +33,52 @@
  */
 
 #include "KX_RayEventManager.h"
+#include "KX_RaySensor.h"
+#include "KX_Scene.h"
 #include "SCA_LogicManager.h"
 #include "SCA_ISensor.h"
+#include "PHY_IPhysicsEnvironment.h"
 #include <vector>
 
+#include "BLI_task.h"
+
 using namespace std;
 
 #include <iostream>
 #include <stdio.h>
 
+/* below this many sensors the rays are cast on the calling thread */
+#define KX_RAY_CAST_TASK_LIMIT 4
+
+static void ray_cast_range(void *userdata, int start, int stop)
+{
+	vector<KX_RaySensor*>& sensors = *(vector<KX_RaySensor*>*)userdata;
+
+	for (int i = start; i < stop; i++)
+		sensors[i]->CastRay(true);
+}
+
 void KX_RayEventManager::NextFrame()
 {
 	SG_DList::iterator<SCA_ISensor> it(m_sensors);
+	PHY_IPhysicsEnvironment* physics_environment = m_scene->GetPhysicsEnvironment();
+
+	// Cast the rays of all the sensors about to be evaluated in parallel, the
+	// world can't change before the logic runs. Preparing the rays touches
+	// reference counts so it stays on this thread.
+	if (physics_environment && physics_environment->SupportsConcurrentRayTest())
+	{
+		m_castSensors.clear();
+		for (it.begin();!it.end();++it)
+		{
+			KX_RaySensor* sensor = static_cast<KX_RaySensor*>(*it);
+			if (!sensor->IsNoLink() && !sensor->IsSuspended() && sensor->PrepareRay())
+				m_castSensors.push_back(sensor);
+		}
+
+		BLI_task_parallel_range_ex(0, m_castSensors.size(), &m_castSensors, ray_cast_range, KX_RAY_CAST_TASK_LIMIT);
+	}
+
 	for (it.begin();!it.end();++it)
 	{
 		(*it)->Activate(m_logicmgr);
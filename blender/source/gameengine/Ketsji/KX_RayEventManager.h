@@ -38,9 +38,13 @@ using namespace std;
 
 class KX_RayEventManager : public SCA_EventManager
 {
+	class KX_Scene* m_scene;
+	vector<class KX_RaySensor*> m_castSensors;
+
 public:
-	KX_RayEventManager(class SCA_LogicManager* logicmgr)
-		: SCA_EventManager(logicmgr, RAY_EVENTMGR)
+	KX_RayEventManager(class SCA_LogicManager* logicmgr, class KX_Scene* scene)
+		: SCA_EventManager(logicmgr, RAY_EVENTMGR),
+		m_scene(scene)
 	{}
 	virtual void NextFrame();
 
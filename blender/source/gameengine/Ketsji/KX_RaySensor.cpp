@@ -76,6 +76,8 @@ void KX_RaySensor::Init()
 	m_bTriggered = (m_invert)?true:false;
 	m_rayHit = false;
 	m_hitObject = NULL;
+	m_rayIgnoreController = NULL;
+	m_rayCast = false;
 	m_reset = true;
 }
 
@@ -179,10 +181,8 @@ bool KX_RaySensor::NeedRayCast(KX_ClientObjectInfo *client)
 	return true;
 }
 
-bool KX_RaySensor::Evaluate()
+bool KX_RaySensor::PrepareRay()
 {
-	bool result = false;
-	bool reset = m_reset && m_level;
 	m_rayHit = false; 
 	m_hitObject = NULL;
 	m_hitPosition[0] = 0;
@@ -199,7 +199,6 @@ bool KX_RaySensor::Evaluate()
 	MT_Matrix3x3 invmat = matje.inverse();
 	
 	MT_Vector3 todir;
-	m_reset = false;
 	switch (m_axis)
 	{
 	case SENS_RAY_X_AXIS: // X
@@ -250,7 +249,8 @@ bool KX_RaySensor::Evaluate()
 	m_rayDirection[1] = todir[1];
 	m_rayDirection[2] = todir[2];
 
-	MT_Point3 topoint = frompoint + (m_distance) * todir;
+	m_rayFrom = frompoint;
+	m_rayTo = frompoint + (m_distance) * todir;
 	PHY_IPhysicsEnvironment* pe = m_scene->GetPhysicsEnvironment();
 
 	if (!pe)
@@ -267,13 +267,34 @@ bool KX_RaySensor::Evaluate()
 	
 	if (parent)
 		parent->Release();
-	
 
+	m_rayIgnoreController = spc;
+	return true;
+}
+
+void KX_RaySensor::CastRay(bool concurrent)
+{
 	PHY_IPhysicsEnvironment* physics_environment = this->m_scene->GetPhysicsEnvironment();
-	
 
-	KX_RayCast::Callback<KX_RaySensor> callback(this, spc);
-	KX_RayCast::RayTest(physics_environment, frompoint, topoint, callback);
+	KX_RayCast::Callback<KX_RaySensor> callback(this, m_rayIgnoreController);
+	KX_RayCast::RayTest(physics_environment, m_rayFrom, m_rayTo, callback, concurrent);
+
+	m_rayCast = true;
+}
+
+bool KX_RaySensor::Evaluate()
+{
+	bool result = false;
+	bool reset = m_reset && m_level;
+	m_reset = false;
+
+	// the event manager may have cast the ray already
+	if (!m_rayCast) {
+		if (!PrepareRay())
+			return false;
+		CastRay(false);
+	}
+	m_rayCast = false;
 
 	/* now pass this result to some controller */
 
@@ -57,6 +57,13 @@ class KX_RaySensor : public SCA_ISensor
 	float			m_hitNormal[3];
 	float			m_rayDirection[3];
 
+	// ray of the current frame, it may be cast ahead of Evaluate()
+	// by the event manager, together with the other ray sensors
+	MT_Point3		m_rayFrom;
+	MT_Point3		m_rayTo;
+	class PHY_IPhysicsController* m_rayIgnoreController;
+	bool			m_rayCast;
+
 public:
 	KX_RaySensor(class SCA_EventManager* eventmgr,
 					SCA_IObject* gameobj,
@@ -73,6 +80,17 @@ public:
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
 
+	/**
+	 * Compute the ray for this frame, must run on the main thread.
+	 * Returns false when there is no physics environment to cast in.
+	 */
+	bool PrepareRay();
+	/**
+	 * Cast the prepared ray, with concurrent set several sensors
+	 * may cast at once. Evaluate() then uses the result.
+	 */
+	void CastRay(bool concurrent);
+
 	bool RayHit(KX_ClientObjectInfo* client, KX_RayCast* result, void * const data);
 	bool NeedRayCast(KX_ClientObjectInfo* client);
 
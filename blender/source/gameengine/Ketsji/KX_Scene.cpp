@@ -47,7 +47,7 @@
 #include "SCA_TimeEventManager.h"
 //#include "SCA_AlwaysEventManager.h"
 //#include "SCA_RandomEventManager.h"
-//#include "KX_RayEventManager.h"
+#include "KX_RayEventManager.h"
 #include "SCA_2DFilterActuator.h"
 #include "KX_TouchEventManager.h"
 #include "SCA_KeyboardManager.h"
@@ -101,6 +101,7 @@
 #include "KX_Light.h"
 
 #include <stdio.h>
+#include <algorithm>
 
 static void *KX_SceneReplicationFunc(SG_IObject* node,void* gameobj,void* scene)
 {
@@ -162,6 +163,8 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 
 	m_dbvt_culling = false;
 	m_dbvt_occlusion_res = 0;
+	m_dbvt_occlusion_query = false;
+	m_occlusion_frame = 0;
 	m_activity_culling = false;
 	m_suspend = false;
 	m_isclearingZbuffer = true;
@@ -184,7 +187,7 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 	SCA_ActuatorEventManager* actmgr = new SCA_ActuatorEventManager(m_logicmgr);
 	//SCA_RandomEventManager* rndmgr = new SCA_RandomEventManager(m_logicmgr);
 	SCA_BasicEventManager* basicmgr = new SCA_BasicEventManager(m_logicmgr);
-	//KX_RayEventManager* raymgr = new KX_RayEventManager(m_logicmgr);
+	KX_RayEventManager* raymgr = new KX_RayEventManager(m_logicmgr, this);
 
 	KX_NetworkEventManager* netmgr = new KX_NetworkEventManager(m_logicmgr, ndi);
 	
@@ -197,7 +200,7 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 	m_logicmgr->RegisterEventManager(m_mousemgr);
 	m_logicmgr->RegisterEventManager(m_timemgr);
 	//m_logicmgr->RegisterEventManager(rndmgr);
-	//m_logicmgr->RegisterEventManager(raymgr);
+	m_logicmgr->RegisterEventManager(raymgr);
 	m_logicmgr->RegisterEventManager(netmgr);
 	m_logicmgr->RegisterEventManager(basicmgr);
 
@@ -252,6 +255,12 @@ KX_Scene::~KX_Scene()
 		this->RemoveObject(parentobj);
 	}
 
+	if (!m_occlusion_query_pool.empty()) {
+		RAS_IRasterizer *rasty = KX_GetActiveEngine()->GetRasterizer();
+		for (size_t i = 0; i < m_occlusion_query_pool.size(); i++)
+			rasty->DeleteOcclusionQuery(m_occlusion_query_pool[i]);
+	}
+
 	if (m_obstacleSimulation)
 		delete m_obstacleSimulation;
 
@@ -1027,6 +1036,14 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	// as only the deletion of the original object must be recorded
 	m_logicmgr->UnregisterGameObj(newobj->GetBlenderObject(), gameobj);
 
+	if (newobj->GetOcclusionQuery()) {
+		m_occlusion_query_pool.push_back(newobj->GetOcclusionQuery());
+		newobj->SetOcclusionQuery(0);
+	}
+	m_occlusion_candidates.erase(
+	        std::remove(m_occlusion_candidates.begin(), m_occlusion_candidates.end(), newobj),
+	        m_occlusion_candidates.end());
+
 	//todo: look at this
 	//GetPhysicsEnvironment()->RemovePhysicsController(gameobj->getPhysicsController());
 
@@ -1516,6 +1533,12 @@ void KX_Scene::PhysicsCullingCallback(KX_ClientObjectInfo *objectInfo, void* cul
 		// used for shadow: object is not in shadow layer
 		return;
 
+	if (((CullingInfo*)cullingInfo)->m_candidates) {
+		// visibility is decided once the occlusion results are known
+		((CullingInfo*)cullingInfo)->m_candidates->push_back(gameobj);
+		return;
+	}
+
 	// make object visible
 	gameobj->SetCulled(false);
 	gameobj->UpdateBuckets(false);
@@ -1538,15 +1561,31 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 		planes[4].setValue(cplanes[2].getValue());	// top
 		planes[5].setValue(cplanes[3].getValue());	// bottom
 		CullingInfo info(layer);
+		int occlusion_res = m_dbvt_occlusion_res;
+
+		// hardware queries only follow the active camera, shadow passes
+		// and other viewports just get frustum culling
+		m_occlusion_candidates.clear();
+		if (m_dbvt_occlusion_query && layer == 0 && cam == m_active_camera && rasty->QueryOcclusion()) {
+			info.m_candidates = &m_occlusion_candidates;
+			occlusion_res = 0;
+		}
 
 		double mvmat[16] = {0};
 		cam->GetModelviewMatrix().getValue(mvmat);
 		double pmat[16] = {0};
 		cam->GetProjectionMatrix().getValue(pmat);
 
-		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,5,m_dbvt_occlusion_res,
+		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,5,occlusion_res,
 		                                                 KX_GetActiveEngine()->GetCanvas()->GetViewPort(),
 		                                                 mvmat, pmat);
+
+		if (info.m_candidates) {
+			if (dbvt_culling)
+				MarkOccludedObjects(rasty, cam);
+			else
+				m_occlusion_candidates.clear();
+		}
 	}
 	if (!dbvt_culling) {
 		// the physics engine couldn't help us, do it the hard way
@@ -1557,6 +1596,92 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 	}
 }
 
+/* Read back the queries issued on earlier frames, without waiting, and
+ * hide the frustum visible objects whose box was entirely covered. */
+void KX_Scene::MarkOccludedObjects(RAS_IRasterizer* rasty, KX_Camera* cam)
+{
+	const MT_Point3 cam_pos = cam->NodeGetWorldPosition();
+
+	m_occlusion_frame++;
+
+	for (size_t i = 0; i < m_occlusion_candidates.size(); i++) {
+		KX_GameObject *gameobj = m_occlusion_candidates[i];
+		bool visible;
+
+		// an object coming back into the frustum has no valid result
+		if (gameobj->GetOcclusionFrame() != m_occlusion_frame - 1)
+			gameobj->SetOccluded(false);
+		gameobj->SetOcclusionFrame(m_occlusion_frame);
+
+		if (gameobj->GetOcclusionQueryPending() &&
+		    rasty->GetOcclusionQueryResult(gameobj->GetOcclusionQuery(), visible))
+		{
+			gameobj->SetOcclusionQueryPending(false);
+			gameobj->SetOccluded(!visible);
+		}
+
+		// the box is clipped by the near plane when the camera is inside
+		if (gameobj->GetOccluded() && gameobj->GetSGNode()->inside(cam_pos))
+			gameobj->SetOccluded(false);
+
+		if (!gameobj->GetOccluded()) {
+			gameobj->SetCulled(false);
+			gameobj->UpdateBuckets(false);
+		}
+	}
+}
+
+/* Issue a query for the box of every object that was inside the frustum,
+ * against the depth buffer of the frame just drawn. Hidden objects are
+ * queried as well, that is how they become visible again. */
+void KX_Scene::RenderOcclusionQueries(RAS_IRasterizer* rasty, KX_Camera* cam)
+{
+	if (m_occlusion_candidates.empty())
+		return;
+
+	const MT_Point3 cam_pos = cam->NodeGetWorldPosition();
+	MT_Point3 box[8];
+
+	rasty->BeginOcclusionQueries();
+
+	for (size_t i = 0; i < m_occlusion_candidates.size(); i++) {
+		KX_GameObject *gameobj = m_occlusion_candidates[i];
+
+		if (gameobj->GetOcclusionQueryPending() || gameobj->GetSGNode()->inside(cam_pos))
+			continue;
+
+		if (!gameobj->GetOcclusionQuery()) {
+			if (!m_occlusion_query_pool.empty()) {
+				gameobj->SetOcclusionQuery(m_occlusion_query_pool.back());
+				m_occlusion_query_pool.pop_back();
+			}
+			else {
+				gameobj->SetOcclusionQuery(rasty->CreateOcclusionQuery());
+			}
+		}
+
+		gameobj->GetSGNode()->getBBox(box);
+		rasty->RenderOcclusionBox(gameobj->GetOcclusionQuery(), box);
+		gameobj->SetOcclusionQueryPending(true);
+	}
+
+	rasty->EndOcclusionQueries();
+
+	m_occlusion_candidates.clear();
+}
+
+/* switch every object with levels of detail to the mesh matching
+ * its distance to the camera, before the camera culls and draws */
+void KX_Scene::UpdateObjectLods(KX_Camera *cam)
+{
+	const MT_Point3 cam_pos = cam->NodeGetWorldPosition();
+
+	for (int i = 0; i < m_objectlist->GetCount(); i++) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject*>(m_objectlist->GetValue(i));
+		gameobj->UpdateLod(cam_pos);
+	}
+}
+
 // logic stuff
 void KX_Scene::LogicBeginFrame(double curtime)
 {
@@ -1671,7 +1796,7 @@ void KX_Scene::UpdateParents(double curtime)
 
 	while ((node = SG_Node::GetNextScheduled(m_sghead)) != NULL)
 	{
-		node->UpdateWorldData(curtime);
+		node->UpdateScheduledWorldData(curtime);
 	}
 
 	//for (int i=0; i<GetRootParentList()->GetCount(); i++)
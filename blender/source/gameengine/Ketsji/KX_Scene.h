@@ -111,7 +111,9 @@ class KX_Scene : public PyObjectPlus, public SCA_IScene
 
 	struct CullingInfo {
 		int m_layer;
-		CullingInfo(int layer) : m_layer(layer) {}
+		/* when set, frustum visible objects are collected for occlusion queries */
+		std::vector<KX_GameObject*> *m_candidates;
+		CullingInfo(int layer) : m_layer(layer), m_candidates(NULL) {}
 	};
 
 protected:
@@ -266,6 +268,21 @@ protected:
 	 */ 
 	int m_dbvt_occlusion_res;
 
+	/**
+	 * Toggle to use hardware occlusion queries on top of DBVT culling,
+	 * the software occlusion buffer is used when they aren't supported.
+	 */
+	bool m_dbvt_occlusion_query;
+
+	/**
+	 * Objects inside the frustum this frame, boxes are queried for
+	 * them once the frame is drawn. Queries of removed objects are
+	 * kept in the pool for reuse.
+	 */
+	std::vector<KX_GameObject*> m_occlusion_candidates;
+	std::vector<unsigned int> m_occlusion_query_pool;
+	int m_occlusion_frame;
+
 	/**
 	 * The framing settings used by this scene
 	 */
@@ -284,6 +301,7 @@ protected:
 	void MarkVisible(SG_Tree *node, RAS_IRasterizer* rasty, KX_Camera*cam,int layer=0);
 	void MarkSubTreeVisible(SG_Tree *node, RAS_IRasterizer* rasty, bool visible, KX_Camera*cam,int layer=0);
 	void MarkVisible(RAS_IRasterizer* rasty, KX_GameObject* gameobj, KX_Camera*cam, int layer=0);
+	void MarkOccludedObjects(RAS_IRasterizer* rasty, KX_Camera* cam);
 	static void PhysicsCullingCallback(KX_ClientObjectInfo* objectInfo, void* cullingInfo);
 
 	double				m_suspendedtime;
@@ -524,6 +542,8 @@ public:
 	void SetWorldInfo(class KX_WorldInfo* wi);
 	KX_WorldInfo* GetWorldInfo();
 	void CalculateVisibleMeshes(RAS_IRasterizer* rasty, KX_Camera *cam, int layer=0);
+	void UpdateObjectLods(KX_Camera *cam);
+	void RenderOcclusionQueries(RAS_IRasterizer* rasty, KX_Camera *cam);
 	void UpdateMeshTransformations();
 	KX_Camera* GetpCamera();
 	NG_NetworkDeviceInterface* GetNetworkDeviceInterface();
@@ -561,6 +581,8 @@ public:
 	bool GetDbvtCulling() { return m_dbvt_culling; }
 	void SetDbvtOcclusionRes(int i) { m_dbvt_occlusion_res = i; }
 	int GetDbvtOcclusionRes() { return m_dbvt_occlusion_res; }
+	void SetDbvtOcclusionQuery(bool b) { m_dbvt_occlusion_query = b; }
+	bool GetDbvtOcclusionQuery() { return m_dbvt_occlusion_query; }
 	
 	void SetSceneConverter(class KX_BlenderSceneConverter* sceneConverter);
 
@@ -1087,11 +1087,53 @@ static bool GetHitTriangle(btCollisionShape* shape, CcdShapeConstructionInfo* sh
 	return true;
 }
 
+/* Walks the broadphase with the re-entrant btDbvt::rayTest(), the world ray
+ * test shares a traversal stack between calls and can't run in parallel */
+struct ConcurrentRayTestCollide : btDbvt::ICollide
+{
+	btTransform m_rayFromTrans;
+	btTransform m_rayToTrans;
+	btCollisionWorld::RayResultCallback& m_resultCallback;
+
+	ConcurrentRayTestCollide(const btVector3& rayFrom, const btVector3& rayTo, btCollisionWorld::RayResultCallback& resultCallback)
+		: m_resultCallback(resultCallback)
+	{
+		m_rayFromTrans.setIdentity();
+		m_rayFromTrans.setOrigin(rayFrom);
+		m_rayToTrans.setIdentity();
+		m_rayToTrans.setOrigin(rayTo);
+	}
+
+	void Process(const btDbvtNode* leaf)
+	{
+		btBroadphaseProxy* proxy = (btBroadphaseProxy*)leaf->data;
+		btCollisionObject* collisionObject = (btCollisionObject*)proxy->m_clientObject;
+
+		// terminate further ray tests, once the closestHitFraction reached zero
+		if (m_resultCallback.m_closestHitFraction == btScalar(0.f))
+			return;
+
+		if (m_resultCallback.needsCollision(collisionObject->getBroadphaseHandle())) {
+			btSoftRigidDynamicsWorld::rayTestSingle(m_rayFromTrans, m_rayToTrans, collisionObject,
+			                                        collisionObject->getCollisionShape(),
+			                                        collisionObject->getWorldTransform(),
+			                                        m_resultCallback);
+		}
+	}
+};
+
 PHY_IPhysicsController* CcdPhysicsEnvironment::RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ)
 {
-	btVector3 rayFrom(fromX,fromY,fromZ);
-	btVector3 rayTo(toX,toY,toZ);
+	return RayTestInternal(filterCallback, btVector3(fromX,fromY,fromZ), btVector3(toX,toY,toZ), false);
+}
+
+PHY_IPhysicsController* CcdPhysicsEnvironment::RayTestConcurrent(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ)
+{
+	return RayTestInternal(filterCallback, btVector3(fromX,fromY,fromZ), btVector3(toX,toY,toZ), true);
+}
 
+PHY_IPhysicsController* CcdPhysicsEnvironment::RayTestInternal(PHY_IRayCastFilterCallback &filterCallback, const btVector3& rayFrom, const btVector3& rayTo, bool concurrent)
+{
 	btVector3	hitPointWorld,normalWorld;
 
 	//Either Ray Cast with or without filtering
@@ -1107,7 +1149,17 @@ PHY_IPhysicsController* CcdPhysicsEnvironment::RayTest(PHY_IRayCastFilterCallbac
 	rayCallback.m_collisionFilterMask = CcdConstructionInfo::AllFilter ^ CcdConstructionInfo::SensorFilter;
 	//, ,filterCallback.m_faceNormal);
 
-	m_dynamicsWorld->rayTest(rayFrom,rayTo,rayCallback);
+	if (concurrent) {
+		btDbvtBroadphase* broadphase = static_cast<btDbvtBroadphase*>(m_broadphase);
+		ConcurrentRayTestCollide collide(rayFrom, rayTo, rayCallback);
+
+		btDbvt::rayTest(broadphase->m_sets[0].m_root, rayFrom, rayTo, collide);
+		btDbvt::rayTest(broadphase->m_sets[1].m_root, rayFrom, rayTo, collide);
+	}
+	else {
+		m_dynamicsWorld->rayTest(rayFrom,rayTo,rayCallback);
+	}
+
 	if (rayCallback.hasHit())
 	{
 		CcdPhysicsController* controller = static_cast<CcdPhysicsController*>(rayCallback.m_collisionObject->getUserPointer());
@@ -190,7 +190,14 @@ protected:
 
 		btTypedConstraint*	GetConstraintById(int constraintId);
 
+	protected:
+		PHY_IPhysicsController* RayTestInternal(PHY_IRayCastFilterCallback &filterCallback, const btVector3& rayFrom, const btVector3& rayTo, bool concurrent);
+
+	public:
+
 		virtual PHY_IPhysicsController* RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ);
+		virtual bool SupportsConcurrentRayTest() { return true; }
+		virtual PHY_IPhysicsController* RayTestConcurrent(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ);
 		virtual bool CullingTest(PHY_CullingCallback callback, void* userData, MT_Vector4* planes, int nplanes, int occlusionRes, const int *viewport, double modelview[16], double projection[16]);
 
 
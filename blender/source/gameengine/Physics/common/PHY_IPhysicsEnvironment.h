@@ -167,6 +167,14 @@ class PHY_IPhysicsEnvironment
 
 		virtual PHY_IPhysicsController* RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ)=0;
 
+		// same as RayTest but safe to run from several threads at once, as long as
+		// the world doesn't change meanwhile. Only valid when SupportsConcurrentRayTest()
+		virtual bool SupportsConcurrentRayTest() { return false; }
+		virtual PHY_IPhysicsController* RayTestConcurrent(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ)
+		{
+			return RayTest(filterCallback, fromX, fromY, fromZ, toX, toY, toZ);
+		}
+
 		//culling based on physical broad phase
 		// the plane number must be set as follow: near, far, left, right, top, botton
 		// the near plane must be the first one and must always be present, it is used to get the direction of the view
@@ -81,6 +81,25 @@ struct RAS_BucketManager::fronttoback
 	}
 };
 
+/* order solid buckets so materials using the same kind of shader and the
+ * same textures are drawn after each other, the shader program and texture
+ * binds then mostly change state to what is already current */
+struct RAS_BucketManager::statesort
+{
+	bool operator()(RAS_MaterialBucket *a, RAS_MaterialBucket *b) const
+	{
+		const unsigned int shaderflag = RAS_BLENDERGLSL | RAS_GLSHADER | RAS_BLENDERMAT | RAS_MULTITEX | RAS_MULTILIGHT;
+		RAS_IPolyMaterial *ma = a->GetPolyMaterial(), *mb = b->GetPolyMaterial();
+		unsigned int fa = ma->GetFlag() & shaderflag, fb = mb->GetFlag() & shaderflag;
+
+		if (fa != fb)
+			return fa < fb;
+		if (ma->hash() != mb->hash())
+			return ma->hash() < mb->hash();
+		return ma->GetDrawingMode() < mb->GetDrawingMode();
+	}
+};
+
 /* bucket manager */
 
 RAS_BucketManager::RAS_BucketManager()
@@ -288,6 +307,9 @@ void RAS_BucketManager::OptimizeBuckets(MT_Scalar distance)
 	
 	distance = 10.0;
 
+	/* alpha buckets are depth sorted each frame, only solid ones keep their order */
+	stable_sort(m_SolidBuckets.begin(), m_SolidBuckets.end(), statesort());
+
 	for (bit = m_SolidBuckets.begin(); bit != m_SolidBuckets.end(); ++bit)
 		(*bit)->Optimize(distance);
 	for (bit = m_AlphaBuckets.begin(); bit != m_AlphaBuckets.end(); ++bit)
@@ -46,6 +46,7 @@ class RAS_BucketManager
 	struct sortedmeshslot;
 	struct backtofront;
 	struct fronttoback;
+	struct statesort;
 
 public:
 	RAS_BucketManager();
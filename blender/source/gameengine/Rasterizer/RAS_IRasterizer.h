@@ -419,6 +419,21 @@ public:
 
 	virtual bool	QueryLists() { return false; }
 	virtual bool	QueryArrays() { return false; }
+
+	/**
+	 * Hardware occlusion queries: a box is drawn against the depth buffer
+	 * of the frame just rendered, counting the samples that pass. Results
+	 * are read back on a later frame and never wait for the GPU.
+	 */
+	virtual bool	QueryOcclusion() { return false; }
+	virtual unsigned int	CreateOcclusionQuery()=0;
+	virtual void	DeleteOcclusionQuery(unsigned int query)=0;
+	virtual void	BeginOcclusionQueries()=0;
+	virtual void	EndOcclusionQueries()=0;
+	/** Box corners in the order of SG_BBox::get(). */
+	virtual void	RenderOcclusionBox(unsigned int query, const MT_Point3 *box)=0;
+	/** Returns false while the result isn't available yet. */
+	virtual bool	GetOcclusionQueryResult(unsigned int query, bool &visible)=0;
 	
 	virtual void	EnableMotionBlur(float motionblurvalue)=0;
 	virtual void	DisableMotionBlur()=0;
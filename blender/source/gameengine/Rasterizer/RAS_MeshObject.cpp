@@ -103,6 +103,7 @@ STR_String RAS_MeshObject::s_emptyname = "";
 RAS_MeshObject::RAS_MeshObject(Mesh* mesh)
 	: m_bModified(true),
 	m_bMeshModified(true),
+	m_meshModifiedCount(0),
 	m_mesh(mesh)
 {
 	if (m_mesh && m_mesh->key)
@@ -551,6 +552,6 @@ void RAS_MeshObject::SchedulePolygons(int drawingmode)
 	if (m_bModified)
 	{
 		m_bModified = false;
-		m_bMeshModified = true;
+		SetMeshModified(true);
 	} 
 }
@@ -59,6 +59,7 @@ private:
 
 	bool						m_bModified;
 	bool						m_bMeshModified;
+	unsigned int				m_meshModifiedCount;	/* bumped on every modification, lets vertex buffers skip redundant uploads */
 
 	STR_String					m_name;
 	static STR_String			s_emptyname;
@@ -101,7 +102,8 @@ public:
 
 	/* modification state */
 	bool				MeshModified();
-	void				SetMeshModified(bool v) { m_bMeshModified = v; }
+	void				SetMeshModified(bool v) { m_bMeshModified = v; if (v) m_meshModifiedCount++; }
+	unsigned int		GetMeshModifiedCount() { return m_meshModifiedCount; }
 
 	/* original blender mesh */
 	Mesh*				GetMesh() { return m_mesh; }
@@ -1124,6 +1124,82 @@ bool RAS_OpenGLRasterizer::GetUsingOverrideShader()
 	return m_usingoverrideshader;
 }
 
+bool RAS_OpenGLRasterizer::QueryOcclusion()
+{
+	return GLEW_ARB_occlusion_query;
+}
+
+unsigned int RAS_OpenGLRasterizer::CreateOcclusionQuery()
+{
+	GLuint query = 0;
+	glGenQueriesARB(1, &query);
+	return query;
+}
+
+void RAS_OpenGLRasterizer::DeleteOcclusionQuery(unsigned int query)
+{
+	GLuint glquery = query;
+	glDeleteQueriesARB(1, &glquery);
+}
+
+void RAS_OpenGLRasterizer::BeginOcclusionQueries()
+{
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT);
+
+	/* only the depth test matters, nothing is written */
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LEQUAL);
+
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+	glDisable(GL_ALPHA_TEST);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	if (GLEW_ARB_shader_objects)
+		glUseProgramObjectARB(0);
+}
+
+void RAS_OpenGLRasterizer::EndOcclusionQueries()
+{
+	glPopAttrib();
+}
+
+void RAS_OpenGLRasterizer::RenderOcclusionBox(unsigned int query, const MT_Point3 *box)
+{
+	/* faces of the box, corners indexed as x * 4 + y * 2 + z */
+	static const int faces[6][4] = {
+		{0, 1, 3, 2}, {4, 6, 7, 5},
+		{0, 4, 5, 1}, {2, 3, 7, 6},
+		{0, 2, 6, 4}, {1, 5, 7, 3},
+	};
+
+	glBeginQueryARB(GL_SAMPLES_PASSED_ARB, query);
+	glBegin(GL_QUADS);
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 4; j++)
+			glVertex3dv(box[faces[i][j]].getValue());
+	glEnd();
+	glEndQueryARB(GL_SAMPLES_PASSED_ARB);
+}
+
+bool RAS_OpenGLRasterizer::GetOcclusionQueryResult(unsigned int query, bool &visible)
+{
+	GLint available = 0;
+	GLuint samples = 0;
+
+	glGetQueryObjectivARB(query, GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+	if (!available)
+		return false;
+
+	glGetQueryObjectuivARB(query, GL_QUERY_RESULT_ARB, &samples);
+	visible = (samples > 0);
+	return true;
+}
+
 /**
  * Render Tools
  */
@@ -346,6 +346,14 @@ public:
 	virtual void	SetUsingOverrideShader(bool val);
 	virtual bool	GetUsingOverrideShader();
 
+	virtual bool	QueryOcclusion();
+	virtual unsigned int	CreateOcclusionQuery();
+	virtual void	DeleteOcclusionQuery(unsigned int query);
+	virtual void	BeginOcclusionQueries();
+	virtual void	EndOcclusionQueries();
+	virtual void	RenderOcclusionBox(unsigned int query, const MT_Point3 *box);
+	virtual bool	GetOcclusionQueryResult(unsigned int query, bool &visible);
+
 	/**
 	 * Render Tools
 	 */
@@ -36,6 +36,9 @@ VBO::VBO(RAS_DisplayArray *data, unsigned int indices)
 	this->size = data->m_vertex.size();
 	this->indices = indices;
 	this->stride = sizeof(RAS_TexVert);
+	this->uploaded = false;
+	this->dynamic = false;
+	this->modified_count = 0;
 
 	//	Determine drawmode
 	if (data->m_type == data->QUAD)
@@ -70,7 +73,19 @@ VBO::~VBO()
 void VBO::UpdateData()
 {
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
-	glBufferData(GL_ARRAY_BUFFER, this->stride*this->size, &this->data->m_vertex[0], GL_STATIC_DRAW);
+
+	if (this->dynamic) {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, this->stride*this->size, &this->data->m_vertex[0]);
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, this->stride*this->size, &this->data->m_vertex[0],
+		             this->uploaded ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+
+		// Updates after the initial upload mean the mesh is deformed or edited, from then
+		// on the buffer is dynamic and further updates are written in place
+		this->dynamic = this->uploaded;
+		this->uploaded = true;
+	}
 }
 
 void VBO::UpdateIndices()
@@ -224,12 +239,15 @@ void RAS_StorageVBO::IndexPrimitivesInternal(RAS_MeshSlot& ms, bool multi)
 	{
 		vbo = m_vbo_lookup[it.array];
 
-		if (vbo == 0)
+		if (vbo == 0) {
 			m_vbo_lookup[it.array] = vbo = new VBO(it.array, it.totindex);
-
-		// Update the vbo
-		if (ms.m_mesh->MeshModified())
+			vbo->SetModifiedCount(ms.m_mesh->GetMeshModifiedCount());
+		}
+		// Update the vbo, but only once per modification since the mesh stays
+		// flagged as modified for all passes drawn in a frame (shadows, main)
+		else if (ms.m_mesh->MeshModified() && vbo->GetModifiedCount() != ms.m_mesh->GetMeshModifiedCount())
 		{
+			vbo->SetModifiedCount(ms.m_mesh->GetMeshModifiedCount());
 			vbo->UpdateData();
 		}
 
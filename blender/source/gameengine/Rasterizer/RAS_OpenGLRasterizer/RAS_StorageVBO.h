@@ -46,6 +46,9 @@ public:
 
 	void	UpdateData();
 	void	UpdateIndices();
+
+	unsigned int	GetModifiedCount() { return modified_count; }
+	void			SetModifiedCount(unsigned int count) { modified_count = count; }
 private:
 	RAS_DisplayArray*	data;
 	GLuint			size;
@@ -54,6 +57,9 @@ private:
 	GLenum			mode;
 	GLuint			ibo;
 	GLuint			vbo_id;
+	bool			uploaded;
+	bool			dynamic;
+	unsigned int	modified_count;
 
 	void*			vertex_offset;
 	void*			normal_offset;
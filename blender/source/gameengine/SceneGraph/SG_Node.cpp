@@ -207,6 +207,26 @@ void SG_Node::UpdateWorldData(double time, bool parentUpdated)
 
 
 
+void SG_Node::UpdateScheduledWorldData(double time, bool parentUpdated)
+{
+	if (UpdateSpatialData(GetSGParent(),time,parentUpdated))
+		ActivateUpdateTransformCallback();
+
+	// The node is updated, remove it from the update list
+	Delink();
+
+	// an unchanged node leaves the world data of its children as they are
+	if (!parentUpdated)
+		return;
+
+	for (NodeList::iterator it = m_children.begin();it!=m_children.end();++it)
+	{
+		(*it)->UpdateScheduledWorldData(time, parentUpdated);
+	}
+}
+
+
+
 void SG_Node::SetSimulatedTime(double time,bool recurse)
 {
 
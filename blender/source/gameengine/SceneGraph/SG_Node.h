@@ -193,6 +193,20 @@ public:
 		bool parentUpdated=false
 	);
 
+	/**
+	 * Same as UpdateWorldData() but only descends into the children
+	 * when the world data of this node changed. Children that are
+	 * modified themselves are on the schedule list and get updated
+	 * from there, so unchanged subtrees are not visited at all.
+	 * Used for the scheduled scenegraph update.
+	 */
+
+		void
+	UpdateScheduledWorldData(
+		double time,
+		bool parentUpdated=false
+	);
+
 	/**
 	 * Update the simulation time of this node. Iterate through
 	 * the children nodes and update their simulated time.
@@ -0,0 +1,381 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Times a set of stress cases and writes the results as JSON, so the numbers
+# of different builds can be compared. Scenes are generated by the script,
+# no external .blend files are needed.
+#
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python source/tests/bl_benchmark.py -- \
+#     --json=/tmp/benchmarks.json --baseline=/tmp/benchmarks_old.json
+#
+# Arguments (all optional):
+#   --json=FILE        write the results to FILE
+#   --baseline=FILE    compare against results written by an earlier run,
+#                      exit with an error when a case got slower
+#   --tolerance=FAC    allowed slowdown relative to the baseline (0.25)
+#   --repeat=NUM       number of timed runs per case, the fastest counts (3)
+#   --filter=TEXT      only run cases which have TEXT in their name
+
+import bpy
+import bmesh
+import os
+import sys
+import json
+import time
+import tempfile
+
+# -----------------------------------------------------------------------------
+# utility functions
+
+
+def scene_clear():
+    scene = bpy.context.scene
+
+    for ob in list(scene.objects):
+        scene.objects.unlink(ob)
+        bpy.data.objects.remove(ob)
+
+    for me in list(bpy.data.meshes):
+        if me.users == 0:
+            bpy.data.meshes.remove(me)
+
+    scene.use_nodes = False
+    if scene.sequence_editor:
+        scene.sequence_editor_clear()
+
+    scene.render.engine = 'BLENDER_RENDER'
+    scene.render.resolution_x = 320
+    scene.render.resolution_y = 240
+    scene.render.resolution_percentage = 100
+    scene.frame_set(1)
+
+
+def mesh_sphere(name, segments, rings):
+    bpy.ops.mesh.primitive_uv_sphere_add(segments=segments, ring_count=rings)
+    ob = bpy.context.active_object
+    ob.name = name
+    return ob
+
+
+def mesh_grid(name, subdivisions):
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=subdivisions,
+                                    y_subdivisions=subdivisions)
+    ob = bpy.context.active_object
+    ob.name = name
+    return ob
+
+
+def mesh_eval(ob):
+    """Evaluates the modifier stack of the object."""
+    me = ob.to_mesh(bpy.context.scene, True, 'PREVIEW')
+    bpy.data.meshes.remove(me)
+
+
+def add_camera_and_lamp():
+    scene = bpy.context.scene
+
+    bpy.ops.object.camera_add(location=(0.0, -8.0, 2.0), rotation=(1.35, 0.0, 0.0))
+    scene.camera = bpy.context.active_object
+    bpy.ops.object.lamp_add(type='SUN', location=(2.0, -2.0, 6.0))
+
+
+def has_render_engine(engine):
+    scene = bpy.context.scene
+    old = scene.render.engine
+    try:
+        scene.render.engine = engine
+    except TypeError:
+        return False
+    scene.render.engine = old
+    return True
+
+
+# -----------------------------------------------------------------------------
+# benchmark cases
+#
+# Each case function builds its scene (not timed) and returns the function
+# which gets timed, or None when the case can't run with this build.
+
+CASES = []
+
+
+def benchmark(func):
+    CASES.append((func.__name__, func))
+    return func
+
+
+@benchmark
+def file_save_load():
+    for i in range(20):
+        ob = mesh_sphere("Sphere%d" % i, 128, 64)
+        ob.location.x = i * 2.5
+        ob.modifiers.new("Subsurf", 'SUBSURF')
+
+    filepath = os.path.join(tempfile.gettempdir(), "bl_benchmark_%d.blend" % os.getpid())
+
+    def run():
+        bpy.ops.wm.save_as_mainfile(filepath=filepath, check_existing=False, copy=True)
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        os.remove(filepath)
+
+    return run
+
+
+@benchmark
+def scene_update_objects():
+    scene = bpy.context.scene
+    obs = []
+
+    for i in range(400):
+        bpy.ops.mesh.primitive_cube_add(location=((i % 20) * 3.0, (i // 20) * 3.0, 0.0))
+        ob = bpy.context.active_object
+        ob.modifiers.new("Bevel", 'BEVEL')
+        obs.append(ob)
+
+    def run():
+        for frame in range(10):
+            for ob in obs:
+                ob.location.z = frame * 0.1
+            scene.update()
+
+    return run
+
+
+@benchmark
+def modifier_subsurf():
+    ob = mesh_sphere("Sphere", 64, 32)
+    mod = ob.modifiers.new("Subsurf", 'SUBSURF')
+    mod.levels = 3
+
+    return lambda: mesh_eval(ob)
+
+
+@benchmark
+def modifier_boolean():
+    ob_a = mesh_sphere("SphereA", 128, 64)
+    ob_b = mesh_sphere("SphereB", 128, 64)
+    ob_b.location.x = 0.7
+    mod = ob_a.modifiers.new("Boolean", 'BOOLEAN')
+    mod.object = ob_b
+    mod.operation = 'DIFFERENCE'
+
+    return lambda: mesh_eval(ob_a)
+
+
+@benchmark
+def modifier_remesh():
+    ob = mesh_sphere("Sphere", 64, 32)
+    mod = ob.modifiers.new("Remesh", 'REMESH')
+    mod.octree_depth = 7
+
+    return lambda: mesh_eval(ob)
+
+
+@benchmark
+def modifier_array():
+    ob = mesh_sphere("Sphere", 64, 32)
+    mod = ob.modifiers.new("Array", 'ARRAY')
+    mod.count = 200
+    mod.use_merge_vertices = True
+
+    return lambda: mesh_eval(ob)
+
+
+@benchmark
+def bmesh_operators():
+    ob = mesh_grid("Grid", 300)
+    me = ob.data
+
+    def run():
+        bm = bmesh.new()
+        bm.from_mesh(me)
+        bmesh.ops.subdivide_edges(bm, edges=bm.edges[:], cuts=1, use_grid_fill=True)
+        bmesh.ops.triangulate(bm, faces=bm.faces[:])
+        bmesh.ops.remove_doubles(bm, verts=bm.verts[:], dist=0.0001)
+        bmesh.ops.recalc_face_normals(bm, faces=bm.faces[:])
+        bm.free()
+
+    return run
+
+
+@benchmark
+def render_internal():
+    for i in range(10):
+        ob = mesh_sphere("Sphere%d" % i, 64, 32)
+        ob.location.x = (i - 5) * 1.2
+    add_camera_and_lamp()
+
+    return lambda: bpy.ops.render.render()
+
+
+@benchmark
+def render_cycles():
+    if not has_render_engine('CYCLES'):
+        return None
+
+    scene = bpy.context.scene
+    scene.render.engine = 'CYCLES'
+    scene.cycles.samples = 16
+
+    for i in range(10):
+        ob = mesh_sphere("Sphere%d" % i, 64, 32)
+        ob.location.x = (i - 5) * 1.2
+    add_camera_and_lamp()
+
+    return lambda: bpy.ops.render.render()
+
+
+@benchmark
+def compositor_tree():
+    scene = bpy.context.scene
+
+    mesh_sphere("Sphere", 64, 32)
+    add_camera_and_lamp()
+
+    scene.use_nodes = True
+    tree = scene.node_tree
+    nodes = tree.nodes
+    links = tree.links
+    nodes.clear()
+
+    node_prev = nodes.new("CompositorNodeRLayers")
+    for i in range(8):
+        node = nodes.new("CompositorNodeBlur")
+        node.size_x = node.size_y = 10
+        links.new(node_prev.outputs[0], node.inputs[0])
+        node_prev = node
+    node = nodes.new("CompositorNodeComposite")
+    links.new(node_prev.outputs[0], node.inputs[0])
+
+    return lambda: bpy.ops.render.render()
+
+
+@benchmark
+def sequencer_playback():
+    scene = bpy.context.scene
+    scene.render.use_sequencer = True
+    scene.frame_start = 1
+    scene.frame_end = 25
+
+    seq_ed = scene.sequence_editor_create()
+    strips = []
+    for channel in range(1, 5):
+        strip = seq_ed.sequences.new_effect("Color%d" % channel, 'COLOR', channel,
+                                            frame_start=1, frame_end=26)
+        strip.color = (channel * 0.2, 0.5, 0.5)
+        strip.blend_type = 'ALPHA_OVER'
+        strips.append(strip)
+    seq_ed.sequences.new_effect("Transform", 'TRANSFORM', 5,
+                                frame_start=1, frame_end=26, seq1=strips[-1])
+
+    def run():
+        for frame in range(scene.frame_start, scene.frame_end + 1):
+            scene.frame_set(frame)
+            bpy.ops.render.render()
+
+    return run
+
+
+# -----------------------------------------------------------------------------
+# runner
+
+
+def run_case(name, func, repeat):
+    scene_clear()
+    run = func()
+
+    if run is None:
+        print("  %-24s skipped" % name)
+        return None
+
+    times = []
+    for i in range(repeat):
+        time_start = time.time()
+        run()
+        times.append(time.time() - time_start)
+
+    print("  %-24s %8.3fs" % (name, min(times)))
+
+    return {"time": min(times), "times": times}
+
+
+def main():
+    argv = sys.argv
+    argv = argv[argv.index("--") + 1:] if "--" in argv else []
+
+    def arg_extract_prefix(prefix, default=None):
+        for arg in argv:
+            if arg.startswith(prefix):
+                return arg[len(prefix):]
+        return default
+
+    json_path = arg_extract_prefix("--json=")
+    baseline_path = arg_extract_prefix("--baseline=")
+    tolerance = float(arg_extract_prefix("--tolerance=", "0.25"))
+    repeat = int(arg_extract_prefix("--repeat=", "3"))
+    name_filter = arg_extract_prefix("--filter=", "")
+
+    build_hash = bpy.app.build_hash
+    if isinstance(build_hash, bytes):
+        build_hash = build_hash.decode("utf-8", "replace")
+
+    print("Running benchmarks...")
+
+    results = {}
+    for name, func in CASES:
+        if name_filter in name:
+            result = run_case(name, func, repeat)
+            if result is not None:
+                results[name] = result
+
+    report = {
+        "version": bpy.app.version_string,
+        "build_hash": build_hash,
+        "platform": sys.platform,
+        "results": results,
+        }
+
+    if json_path:
+        with open(json_path, "w") as f:
+            json.dump(report, f, indent=4, sort_keys=True)
+        print("Results written to %r" % json_path)
+
+    if baseline_path:
+        with open(baseline_path, "r") as f:
+            baseline = json.load(f)["results"]
+
+        regressions = []
+        for name, result in sorted(results.items()):
+            if name in baseline:
+                time_old = baseline[name]["time"]
+                if result["time"] > time_old * (1.0 + tolerance):
+                    regressions.append((name, time_old, result["time"]))
+
+        for name, time_old, time_new in regressions:
+            print("  regression: %s %.3fs -> %.3fs" % (name, time_old, time_new))
+
+        if regressions:
+            # so the ctest fails
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()